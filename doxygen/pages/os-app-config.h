@@ -258,6 +258,10 @@
  * is more dynamic, but be sure it tolerates restarts due to
  * fragmentation.
  *
+ * Redefine it to `os::memory::tlsf` if allocations and deallocations
+ * are performed in random order and must be deterministic; both
+ * execute in constant time, and free blocks are immediately coalesced.
+ *
  * @par Default
  *   The default memory manager is `os::memory::lifo`.
  */
@@ -269,16 +273,171 @@
  *
  * @details
  * The default memory manager is `os::memory::first_fit_top`, which
- * is not deterministic, but reasonably fast.
+ * is not deterministic, but reasonably fast; the search is limited
+ * to the segregated list of the requested size, and deallocation
+ * coalesces in constant time.
  *
  * If your application is very active with random allocation, be sure
  * tolerates restarts due to fragmentation.
  *
+ * Redefine it to `os::memory::tlsf` if the allocation time must be
+ * bounded; both allocation and deallocation execute in constant time.
+ *
  * @par Default
  *   The default memory manager is `os::memory::first_fit_top`.
  */
 #define OS_TYPE_APPLICATION_MEMORY_RESOURCE
 
+/**
+ * @brief Record the operations performed on the system memory managers.
+ *
+ * @details
+ * Wrap the application free store, the RTOS system memory manager
+ * and the object pools in `os::memory::profiler` objects, which
+ * record the caller, the size and the time of the most recent
+ * allocations and deallocations, and keep a table of the blocks
+ * not yet deallocated, for leak detection.
+ *
+ * @par Default
+ *   Do not profile the memory managers; there is no overhead.
+ */
+#define OS_INCLUDE_MEMORY_PROFILER
+
+/**
+ * @brief Define the number of operations recorded by each profiler.
+ *
+ * @par Default
+ *   64 records.
+ */
+#define OS_INTEGER_MEMORY_PROFILER_RECORDS
+
+/**
+ * @brief Define the number of live allocations tracked by each profiler.
+ *
+ * @par Default
+ *   64 entries.
+ */
+#define OS_INTEGER_MEMORY_PROFILER_LIVE_ALLOCATIONS
+
+/**
+ * @brief Check the integrity of the free store in the idle thread.
+ *
+ * @details
+ * On each iteration, the idle thread calls `verify()` for the
+ * default memory resource, with the scheduler locked, to check
+ * this number of chunks; if a damaged chunk is found,
+ * `os_rtos_memory_corruption_hook()` is called.
+ *
+ * For `first_fit_top` and `lifo`, each chunk is checked in
+ * constant time, so the latency added to the idle thread is bounded.
+ *
+ * @par Default
+ *   Do not check the free store in the background.
+ */
+#define OS_INTEGER_MEMORY_IDLE_VERIFY_CHUNKS
+
+/**
+ * @brief Reserve a guard word at the end of each allocated block.
+ *
+ * @details
+ * With this option, `first_fit_top` and `lifo` write a guard word,
+ * which depends on the chunk address, after the payload of each
+ * allocated chunk, and check it when the block is freed and when
+ * the chunk is verified; writes past the end of a block are
+ * detected and reported to `os_rtos_memory_corruption_hook()`.
+ *
+ * @par Default
+ *   No guard words; there is no overhead.
+ */
+#define OS_INCLUDE_MEMORY_GUARD_WORDS
+
+/**
+ * @brief Give `malloc()` a private arena, locked by a mutex.
+ *
+ * @details
+ * By default the C allocation functions share the application free
+ * store and lock the scheduler while it is searched.
+ *
+ * With this option, on first use, a block of this size is allocated
+ * from the free store and managed by a separate
+ * `OS_TYPE_APPLICATION_MEMORY_RESOURCE` object, serialised by a
+ * priority inheritance mutex, so threads that do not use `malloc()`
+ * are no longer delayed by it.
+ *
+ * @par Default
+ *   Undefined; `malloc()` uses the free store and the scheduler lock.
+ */
+#define OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES
+
+/**
+ * @brief Serve small `new` requests from lock free block pools.
+ *
+ * @details
+ * Define the number of blocks in each of the 16, 32 and 64 bytes
+ * size classes. Requests that fit are taken from these pools
+ * without locking the scheduler; larger requests, or requests
+ * for an exhausted class, use the default resource, as usual.
+ *
+ * Requires `OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE`.
+ *
+ * @par Default
+ *  Undefined; all requests use the default resource.
+ */
+#define OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS
+
+/**
+ * @brief Define the number of workers running the `estd::async()` tasks.
+ *
+ * @details
+ * The tasks are not given a thread each, but are run by a pool
+ * of workers, created on first use.
+ *
+ * @par Default
+ *  2.
+ */
+#define OS_INTEGER_ESTD_ASYNC_WORKERS (2)
+
+/**
+ * @brief Define the maximum number of pending `estd::async()` tasks.
+ *
+ * @details
+ * When the queue is full, `launch::async` tasks wait for a free slot,
+ * while tasks launched with the default policy are deferred.
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_ESTD_ASYNC_JOBS (8)
+
+/**
+ * @brief Define the stack size of the `estd::async()` workers, in bytes.
+ *
+ * @par Default
+ *  `os::rtos::port::stack::default_size_bytes`.
+ */
+#define OS_INTEGER_ESTD_ASYNC_STACK_SIZE_BYTES
+
+/**
+ * @brief Define the number of preallocated `estd::async()` states.
+ *
+ * @details
+ * Each state holds the task, its arguments and its result;
+ * larger states, or all when the pool is exhausted, are allocated
+ * from the default resource.
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_ESTD_ASYNC_STATES (8)
+
+/**
+ * @brief Define the size of the preallocated `estd::async()` states, in bytes.
+ *
+ * @par Default
+ *  128.
+ */
+#define OS_INTEGER_ESTD_ASYNC_STATE_SIZE_BYTES (128)
+
 /**
  * @}
  */
@@ -354,6 +513,45 @@
  */
 #define OS_INTEGER_RTOS_IDLE_STACK_SIZE_BYTES
 
+/**
+ * @brief Define the gap that ends the incremental stack scans.
+ *
+ * @details
+ * `thread::stack::peak()` resumes the scan from the deepest level
+ * found by the previous calls, and stops after this many consecutive
+ * words with the magic still there.
+ *
+ * Larger values detect larger unwritten areas in the stack frames,
+ * at the cost of this many words read by each call.
+ *
+ * @par Default
+ * 16 words.
+ */
+#define OS_INTEGER_RTOS_THREAD_STACK_WATERMARK_GAP_WORDS    (16)
+
+/**
+ * @brief Use the hardware stack limit registers.
+ *
+ * @details
+ * On ARMv8-M Mainline cores (like Cortex-M33/M55), the port programs
+ * PSPLIM from `thread::stack::limit()` in
+ * `port::scheduler::switch_stacks()`, on each context switch, and the
+ * startup code programs MSPLIM from the interrupts stack; a stack
+ * overflow is then an immediate UsageFault (STKOF), instead of a
+ * corrupted magic word found later.
+ *
+ * The limit is set above the bottom magic word, so the software
+ * checks remain valid.
+ *
+ * Ignored on cores without stack limit registers.
+ *
+ * @see os::rtos::thread::stack::limit()
+ *
+ * @par Default
+ * Disable. Only the software checks are used.
+ */
+#define OS_USE_RTOS_THREAD_STACK_LIMIT
+
 /**
  * @brief Include statistics to count thread CPU cycles.
  *
@@ -379,6 +577,49 @@
  */
 #define OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES	(1)
 
+/**
+ * @brief Include the CPU load averages.
+ *
+ * @details
+ * Add support to compute, for each thread and for the entire CPU,
+ * exponential moving averages of the load over about 1 second,
+ * 10 seconds and 1 minute, from the thread CPU cycles
+ * (this option also enables
+ * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES).
+ *
+ * The averages are updated by
+ * os::rtos::scheduler::statistics::sample_cpu_load(), which the
+ * application must call periodically, from a thread.
+ *
+ * The RAM overhead is a uint64_t variable and three uint32_t
+ * variables for each thread.
+ *
+ * The time overhead is a pass through all threads, with a few
+ * integer multiplications per thread, every
+ * @ref OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS milliseconds.
+ *
+ * @see os::rtos::scheduler::statistics::sample_cpu_load()
+ * @see os::rtos::scheduler::statistics::cpu_load()
+ * @see os::rtos::thread::statistics::cpu_load()
+ *
+ * @par Default
+ * Disable. Do not include the CPU load averages.
+ */
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD
+
+/**
+ * @brief Define the CPU load sampling period, in milliseconds.
+ *
+ * @details
+ * Shorter periods make the one second average smoother, at the
+ * cost of more frequent passes through the threads. The period
+ * must not exceed one second.
+ *
+ * @par Default
+ * 250 milliseconds.
+ */
+#define OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS (250)
+
 /**
  * @brief Include statistics to count thread context switches.
  *
@@ -402,172 +643,1486 @@
 #define OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES
 
 /**
- * @brief Add a user defined storage to each thread.
+ * @brief Include statistics about the thread ready latency.
+ *
+ * @details
+ * Add support to measure, for each thread, the time between the
+ * moment it becomes ready (is linked to the ready list) and the
+ * moment it is selected to run, using the high resolution clock.
+ *
+ * The shortest and the longest latencies are kept, and a histogram
+ * with logarithmic bins counts all samples.
+ *
+ * The RAM overhead is three uint64_t variables and
+ * `OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS` uint32_t
+ * counters for each thread.
+ *
+ * The time overhead is two high resolution clock samplings per
+ * context switch.
+ *
+ * @see os::rtos::thread::statistics::ready_latency_min()
+ * @see os::rtos::thread::statistics::ready_latency_max()
+ * @see os::rtos::thread::statistics::ready_latency_histogram()
+ *
+ * @par Default
+ * Disable. Do not include ready latency statistics.
  */
-#define OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY
 
 /**
- * @brief Extend the message size to 16 bits.
+ * @brief Define the number of bins in the thread ready latency histogram.
  *
  * @details
- * For embedded applications the message queues are
- * optimised for small messages, up to 256 bytes.
+ * Bin 0 counts latencies of 0 cycles, bin `n` counts latencies
+ * between 2^(n-1) and 2^n-1 cycles; the last bin also counts all
+ * longer latencies.
  *
- * If larger messages are needed, this option extends the
- * message size to 65536 bytes.
+ * @par Default
+ * 16 bins.
+ */
+#define OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS (16)
+
+/**
+ * @brief Include statistics about the thread FPU context.
+ *
+ * @details
+ * On cores with a floating point unit and lazy FPU stacking
+ * (like Cortex-M4F/M7), the extended frame is saved and restored
+ * only for threads that actually used the FPU; integer only threads
+ * are switched with basic frames.
+ *
+ * With this option, the port records in `port::scheduler::switch_stacks()`
+ * whether the outgoing thread carried an extended frame, and how
+ * many times this happened.
+ *
+ * The RAM overhead is a uint64_t and a bool for each thread.
+ *
+ * Not available when `OS_USE_RTOS_PORT_SCHEDULER` is defined.
+ *
+ * @see os::rtos::thread::context::fpu_context_live()
+ * @see os::rtos::thread::context::fpu_context_switches()
  *
  * @par Default
- *  False (short messages).
+ * Disable. Do not include FPU context statistics.
  */
-#define OS_BOOL_RTOS_MESSAGE_QUEUE_SIZE_16BITS  (false)
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT
 
 /**
- * @brief Push down the idle thread priority.
+ * @brief Include contention statistics for synchronisation objects.
  *
  * @details
- * Normally the applications should not create threads with
- * the idle priority.
+ * Each mutex, semaphore, condition variable and event flags object
+ * counts the acquisitions and the contended ones (which had
+ * to block), the total and maximum wait time and, for mutexes,
+ * the maximum hold time; durations are in high resolution
+ * clock cycles.
  *
- * However, some applications, like the ARM CMSIS RTOS validator,
- * need to test the behaviour of idle threads. For such cases,
- * to guarantee that the idle thread is the lowest priority
- * thread, its priority can be lowered one additional step.
+ * All live objects are linked in a list, which can be iterated
+ * to report the most contended ones.
+ *
+ * The RAM overhead is 64 bytes for each object.
+ *
+ * @see os::rtos::statistics::sync
+ * @see os::rtos::statistics::sync_objects()
  *
  * @par Default
- *  False (the idle thread has the idle priority).
+ * Disable. Do not include synchronisation statistics.
  */
-#define OS_BOOL_RTOS_THREAD_IDLE_PRIORITY_BELOW_IDLE (false)
+#define OS_INCLUDE_RTOS_STATISTICS_SYNC
 
 /**
- * @brief Force the stack trace to start with a 0x0.
+ * @brief Include depth and latency statistics for message queues.
  *
  * @details
- * This option has no functional consequences, it is only
- * cosmetic, affecting how a debugger displays the stack trace.
+ * Each message queue records the maximum depth, the number
+ * of sends and receives which had to block, and the time
+ * each message spent in the queue, from the moment it was
+ * enqueued to the moment it was dequeued; durations are in high
+ * resolution clock cycles.
  *
- * If your debugger has difficulties to properly display the
- * thread stack trace, enable this option and the stack will
- * always start with a 0x0.
+ * The RAM overhead is 48 bytes for each queue, plus a 32-bit
+ * timestamp for each message, stored in the queue storage.
+ *
+ * @see os::rtos::message_queue::statistics
  *
  * @par Default
- *  False (the stack trace starts with the first function).
+ * Disable. Do not include message queue statistics.
  */
-#define OS_BOOL_RTOS_PORT_CONTEXT_CREATE_ZERO_LR (false)
+#define OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE
 
 /**
- * @brief Default definition for the preemption flag.
+ * @brief Include statistics for the clock timeouts.
  *
  * @details
- * This option sets the initial value of the
- * `scheduler::preemptive()` flag. It can be changed
- * at any time.
+ * Each clock records the maximum number of thread timeouts
+ * and timers expired by a single tick, which bounds the
+ * duration of the tick interrupt.
+ *
+ * @see os::rtos::clock::max_expired_per_tick
  *
  * @par Default
- *  True (preemption is enabled).
+ * Disable. Do not include clock statistics.
  */
-#define OS_BOOL_RTOS_SCHEDULER_PREEMPTIVE (true)
+#define OS_INCLUDE_RTOS_STATISTICS_CLOCK
 
 /**
- * @brief Do not enter sleep in the idle thread.
+ * @brief Include scheduler and interrupt events, for timeline tools.
  *
  * @details
- * Very fast debuggers need direct access to a RAM buffer, which
- * in turn need the clock that powers the bus where the RAM is
- * connected to be permanently on.
+ * Call the `os::rtos::events` functions on each context switch,
+ * when threads become ready, when they start waiting on, or are
+ * released from, a synchronisation object, on each clock tick,
+ * and on the SysTick interrupt entry and exit.
  *
- * Unfortunately, most devices disable this clock when entering
- * even the shallow sleep mode, disabling the debugger access to
- * the device.
+ * The default implementations are weak and empty, to be redefined
+ * by the application, unless
+ * @ref OS_USE_RTOS_EVENTS_SEGGER_SYSTEMVIEW is also defined.
  *
- * To prevent this, usually for the debug configurations,
- * it is possible to exclude the code that puts the device to sleep.
+ * Not available when `OS_USE_RTOS_PORT_SCHEDULER` is defined.
+ *
+ * @par Default
+ * Disable. The calls are inlined to empty bodies.
  */
-#define OS_EXCLUDE_RTOS_IDLE_SLEEP
+#define OS_INCLUDE_RTOS_EVENTS
 
 /**
- * @}
+ * @brief Forward the scheduler events to SEGGER SystemView.
+ *
+ * @details
+ * The context switches, ready threads and interrupts are passed
+ * to the native SystemView calls; waits, posts and ticks are
+ * recorded as events of a `uOS++` module, with the address
+ * of the object waiting list and of the thread. The thread list
+ * is sent with the names, priorities and stacks.
+ *
+ * The timestamps are `hrclock` cycles, via a weak
+ * `SEGGER_SYSVIEW_X_GetTimestamp()`, unless the SystemView
+ * configuration reads the DWT cycle counter, which counts the
+ * same input clock. The SEGGER SystemView sources
+ * and the RTT channel must be added to the project.
+ *
+ * @see OS_INCLUDE_RTOS_EVENTS
  */
+#define OS_USE_RTOS_EVENTS_SEGGER_SYSTEMVIEW
 
-// ----------------------------------------------------------------------------
 /**
- * @ingroup cmsis-plus-app-config-startup
- * @{
+ * @brief Add a user defined storage to each thread.
  */
+#define OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE
 
 /**
- * @brief Initialise multiple RAM sections.
+ * @brief Define the number of thread local storage slots.
+ *
+ * @details
+ * Each thread includes an array of this many pointers, accessed
+ * by key via `thread::tls::get()` and `thread::tls::set()`.
+ * Keys are allocated with `thread::tls::create_key()`, which
+ * also registers an optional destructor, called when the thread
+ * exits.
+ *
+ * The RAM overhead is one pointer per slot for each thread.
+ *
+ * @see os::rtos::thread::tls
+ *
+ * @par Default
+ * 0, no thread local storage.
  */
-#define OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS
+#define OS_INTEGER_RTOS_THREAD_TLS_SLOTS                    (0)
 
 /**
- * @brief Enable guard checks for .bss and .data sections.
+ * @brief Include the thread notifications.
  *
  * @details
- * Sometimes mistakes in the liner script prevent the .bss area
- * to be initialised to zero, and/or the .data area to be fully
- * initialised with content from flash.
+ * Each thread includes a notification value, updated by
+ * `thread::notify()`, usually from an interrupt handler, and
+ * consumed by the thread with `this_thread::notify_wait()` or
+ * `this_thread::notify_take()`.
  *
- * To validate that the start-up properly initialised these areas,
- * some guard words are defined at the begin/end of the .bss and
- * .data areas, and are explicitly checked.
+ * The notifier resumes the thread only if it waits for a
+ * notification, by linking it directly to the ready list, without
+ * any waiting list or separate synchronisation object.
  *
- * @note This option is available only if DEBUG is also defined.
+ * The RAM overhead is a word and two booleans for each thread.
+ *
+ * @see os::rtos::thread::notify()
+ *
+ * @par Default
+ *  Undefined (no thread notifications).
  */
-#define OS_BOOL_STARTUP_GUARD_CHECKS (true)
+#define OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS
 
 /**
- * @brief Always initialise the hardware FPU.
+ * @brief Destroy the terminated threads before creating new ones.
+ *
+ * @details
+ * The terminated threads which are not joined are destroyed by the
+ * idle thread, which may not run for a long time if the CPU is busy,
+ * so their stacks are not freed and the new allocations may fail.
+ *
+ * With this option, the constructors which allocate a stack first
+ * destroy all terminated threads, in the context of the creating
+ * thread. The joined threads are always destroyed by the joiner.
+ *
+ * @par Default
+ * Disable. The idle thread destroys the terminated threads.
  */
-#define OS_INCLUDE_STARTUP_INIT_FP
+#define OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE
 
 /**
- * @brief Make the application a fully semihosted application.
+ * @brief Define the number of stacks kept for reuse.
  *
  * @details
- * When writing test applications it is necessary to use some
- * of the resources available from the host system (STDOUT/STDERR,
- * file system, time, exit code, etc).
+ * When a thread with a stack allocated by the default thread
+ * allocator is destroyed, its stack is kept in a cache of up
+ * to this many entries, instead of being freed; the next thread
+ * created with the same stack size takes it from the cache.
+ * This makes spawning short lived threads faster and avoids
+ * fragmenting the free store.
  *
- * This requires the entire behaviour of the system calls to be
- * changed and most calls to be forwarded to the host. The
- * application is transformed into a 'fully semihosted' application.
+ * The stacks taken from a memory manager (like a stack pool)
+ * or allocated by `thread_allocated<>` are not cached.
+ *
+ * @see os::rtos::thread::stack::cache_hits()
+ * @see os::rtos::thread::stack::cache_misses()
+ * @see os::rtos::thread::stack::cache_flush()
+ *
+ * @par Default
+ * 0, no stack cache.
+ */
+#define OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES          (0)
+
+/**
+ * @brief Define the number of blocks in the per thread allocation caches.
+ *
+ * @details
+ * Each thread includes a cache of up to this many recently freed
+ * small blocks. The global `operator new()` and the sized
+ * `operator delete()` use the cache of the current thread
+ * without locking the scheduler, and access the default memory
+ * resource only when the cache is empty or full.
+ *
+ * All requests smaller than
+ * `OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCK_SIZE_BYTES` are
+ * rounded up to this size. The cache is flushed when the thread
+ * is destroyed.
+ *
+ * The RAM overhead is one pointer per block for each thread;
+ * the cached blocks are not available to other threads.
+ *
+ * @see os::rtos::thread::allocation_cache
+ *
+ * @par Default
+ * 0, no allocation caches.
+ */
+#define OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS      (0)
+
+/**
+ * @brief Define the size of the blocks in the per thread allocation caches.
+ *
+ * @par Default
+ * 32 bytes.
+ */
+#define OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCK_SIZE_BYTES (32)
+
+/**
+ * @brief Define the number of named memory regions.
+ *
+ * @details
+ * Memory regions (like CCM, TCM or external SRAM) are registered
+ * at startup with `os::rtos::memory::set_region()`, and referred
+ * by name in the `th_stack_region`, `mp_pool_region` and
+ * `mq_queue_region` attributes, to place the dynamically allocated
+ * storage of those objects in a specific memory.
+ *
+ * @see os::rtos::memory::set_region()
+ *
+ * @par Default
+ * 4 regions.
+ */
+#define OS_INTEGER_RTOS_MEMORY_REGIONS                      (4)
+
+/**
+ * @brief Extend the message size to 16 bits.
+ *
+ * @details
+ * For embedded applications the message queues are
+ * optimised for small messages, up to 256 bytes.
+ *
+ * If larger messages are needed, this option extends the
+ * message size to 65536 bytes.
+ *
+ * @par Default
+ *  False (short messages).
+ */
+#define OS_BOOL_RTOS_MESSAGE_QUEUE_SIZE_16BITS  (false)
+
+/**
+ * @brief Define the number of message priorities.
+ *
+ * @details
+ * When defined, each message queue keeps, for each priority,
+ * the index of its last message, and a bitmap of the priorities
+ * present in the queue, so that messages are inserted in
+ * constant time, instead of walking the queue from the tail.
+ * The order of the messages is not changed.
+ *
+ * Messages must have priorities lower than this value;
+ * sending a message with a higher priority fails with `EINVAL`.
+ *
+ * Each queue grows by one index per priority, plus one 32-bit
+ * word for each 32 priorities.
+ *
+ * Not used when `OS_USE_RTOS_PORT_MESSAGE_QUEUE` is defined.
+ *
+ * @par Default
+ *  Undefined (linear insertion, all 256 priorities).
+ */
+#define OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES            (8)
+
+/**
+ * @brief Push down the idle thread priority.
+ *
+ * @details
+ * Normally the applications should not create threads with
+ * the idle priority.
+ *
+ * However, some applications, like the ARM CMSIS RTOS validator,
+ * need to test the behaviour of idle threads. For such cases,
+ * to guarantee that the idle thread is the lowest priority
+ * thread, its priority can be lowered one additional step.
+ *
+ * @par Default
+ *  False (the idle thread has the idle priority).
+ */
+#define OS_BOOL_RTOS_THREAD_IDLE_PRIORITY_BELOW_IDLE (false)
+
+/**
+ * @brief Force the stack trace to start with a 0x0.
+ *
+ * @details
+ * This option has no functional consequences, it is only
+ * cosmetic, affecting how a debugger displays the stack trace.
+ *
+ * If your debugger has difficulties to properly display the
+ * thread stack trace, enable this option and the stack will
+ * always start with a 0x0.
+ *
+ * @par Default
+ *  False (the stack trace starts with the first function).
+ */
+#define OS_BOOL_RTOS_PORT_CONTEXT_CREATE_ZERO_LR (false)
+
+/**
+ * @brief Default definition for the preemption flag.
+ *
+ * @details
+ * This option sets the initial value of the
+ * `scheduler::preemptive()` flag. It can be changed
+ * at any time.
+ *
+ * @par Default
+ *  True (preemption is enabled).
+ */
+#define OS_BOOL_RTOS_SCHEDULER_PREEMPTIVE (true)
+
+/**
+ * @brief Coalesce the reschedule requests of interrupt handlers.
+ *
+ * @details
+ * Normally each thread resumed by an interrupt handler (a semaphore
+ * post, a message queue send, etc) requests a reschedule. With
+ * this option, in handler mode the requests only mark a reschedule
+ * as needed, and `interrupts::handler_exit()`, called as the last
+ * action of the handler, issues a single one.
+ *
+ * The RTOS handlers (SysTick, RTC, high resolution compare) call it;
+ * the application handlers which may resume threads also must call
+ * it, `os_irq_handler_exit()` in C, otherwise the resumed threads
+ * run only after the next reschedule.
+ *
+ * The requests served by an already requested switch are counted
+ * by `scheduler::statistics::coalesced_reschedules()`.
+ *
+ * Not available with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Undefined (each resume requests a reschedule).
+ */
+#define OS_USE_RTOS_COALESCED_RESCHEDULE
+
+/**
+ * @brief Include the uncontended mutex fast path.
+ *
+ * @details
+ * Lock a free mutex with an atomic compare and swap on the owner,
+ * without entering the scheduler critical section. Only mutexes
+ * which are not recursive, use no protocol and are not robust
+ * take the fast path; contention and all other mutexes use the
+ * regular path. Unlocking always uses the regular path.
+ *
+ * Requires a core with exclusive access instructions
+ * (LDREX/STREX, for example ARMv7-M), or native atomics.
+ *
+ * Not available when `OS_USE_RTOS_PORT_MUTEX` is defined.
+ *
+ * @par Default
+ * Disable. Always lock via the scheduler critical section.
+ */
+#define OS_INCLUDE_RTOS_MUTEX_FAST_PATH
+
+/**
+ * @brief Include the mutex spin-then-block support.
+ *
+ * @details
+ * Add the `mx_spin_count` attribute to mutexes. When the mutex
+ * is locked by a thread running on another core, the locker
+ * checks the mutex up to this many times before linking to the
+ * waiting list, possibly avoiding two context switches for short
+ * hold times. If the owner is not running, the locker blocks at once.
+ *
+ * The number of successful and failed spins is available via
+ * `mutex::spin_successes()` and `mutex::spin_failures()`.
+ *
+ * Useful only on multi-core ports; not available when
+ * `OS_USE_RTOS_PORT_MUTEX` is defined.
+ *
+ * @par Default
+ * Disable. Block at once.
+ */
+#define OS_INCLUDE_RTOS_MUTEX_SPIN
+
+/**
+ * @brief Include the semaphore post fast path.
+ *
+ * @details
+ * Increment the semaphore count with an atomic compare and swap,
+ * without entering the interrupts critical section, and enter
+ * it to resume a thread only if the waiting list is not empty.
+ * Useful for semaphores posted at high rates from interrupts,
+ * when the consumer is usually busy and not waiting.
+ *
+ * Requires a core with exclusive access instructions
+ * (LDREX/STREX, for example ARMv7-M), or native atomics.
+ *
+ * Not available when `OS_USE_RTOS_PORT_SEMAPHORE` is defined.
+ *
+ * @par Default
+ * Disable. Always post via the interrupts critical section.
+ */
+#define OS_INCLUDE_RTOS_SEMAPHORE_FAST_PATH
+
+/**
+ * @brief Use lock free lists of free blocks in the memory pools.
+ *
+ * @details
+ * Keep the free blocks of `rtos::memory_pool` and
+ * `memory::block_pool` in a lock free list, with a tagged
+ * head updated by compare and swap; allocations and deallocations
+ * do not mask interrupts, and are wait free when not contended.
+ * Useful for blocks allocated and freed at high rates from
+ * interrupts, for example DMA descriptors.
+ *
+ * The interrupts critical section is still entered when a
+ * `memory_pool` is empty and threads must wait, or are resumed.
+ *
+ * The number of blocks in each pool is limited to 65535.
+ *
+ * Requires a core with exclusive access instructions
+ * (LDREX/STREX, for example ARMv7-M), or native atomics.
+ *
+ * @par Default
+ * Disable. Always use the interrupts critical section.
+ */
+#define OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE
+
+/**
+ * @brief Define the size of a data cache line, in bytes.
+ *
+ * @details
+ * Used to keep data written by different contexts in separate
+ * cache lines, like the indices of `os::rtos::spsc_queue`.
+ *
+ * @par Default
+ *  32, the Cortex-M7 cache line.
+ */
+#define OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES               (32)
+
+/**
+ * @brief Define the maximum number of objects in a wait set.
+ *
+ * @details
+ * Each wait set includes an array of this many entries, each
+ * with a waiting node, used to link the waiting thread to the
+ * lists of all objects at once.
+ *
+ * @see os::rtos::wait_set
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_RTOS_WAIT_SET_MAX_SIZE                   (8)
+
+/**
+ * @brief Define the maximum number of pools in a memory pool set.
+ *
+ * @details
+ * Each memory pool set includes an array of this many pool
+ * pointers and usage counters; the waiting threads also use
+ * this many waiting nodes, on their stack.
+ *
+ * @see os::rtos::memory_pool_set
+ *
+ * @par Default
+ *  4.
+ */
+#define OS_INTEGER_RTOS_MEMORY_POOL_SET_MAX_SIZE            (4)
+
+/**
+ * @brief Default thread time slice, in scheduler ticks.
+ *
+ * @details
+ * Threads with a non zero quantum are time sliced: when
+ * the running thread used its quantum, the SysTick handler
+ * moves it to the back of the threads with the same priority,
+ * so compute bound threads do not starve their peers.
+ *
+ * The value can be set for each thread, via
+ * `thread::attributes::th_quantum_ticks`; this option
+ * defines the default value.
+ *
+ * If 0, threads are not time sliced and the SysTick handler
+ * requests a reschedule on every tick.
+ *
+ * @par Default
+ *  0 (no time slicing).
+ */
+#define OS_INTEGER_RTOS_THREAD_QUANTUM_TICKS (0)
+
+/**
+ * @brief Default priority of the work queues worker threads.
+ *
+ * @details
+ * The work items are posted by interrupt handlers, so
+ * the worker threads should run with a high priority.
+ *
+ * @par Default
+ *  `os::rtos::thread::priority::high`.
+ */
+#define OS_INTEGER_RTOS_WORK_QUEUE_PRIORITY (os::rtos::thread::priority::high)
+
+/**
+ * @brief Default priority of the coroutine executor threads.
+ *
+ * @details
+ * The coroutines are usually state machines, which replace
+ * application threads.
+ *
+ * @par Default
+ *  `os::rtos::thread::priority::normal`.
+ */
+#define OS_INTEGER_RTOS_COROUTINE_EXECUTOR_PRIORITY (os::rtos::thread::priority::normal)
+
+/**
+ * @brief Default priority of the SRP dispatcher threads.
+ *
+ * @details
+ * All run-to-completion tasks of a dispatcher run with
+ * this priority, relative to the regular threads.
+ *
+ * @par Default
+ *  `os::rtos::thread::priority::high`.
+ */
+#define OS_INTEGER_RTOS_SRP_DISPATCHER_PRIORITY (os::rtos::thread::priority::high)
+
+/**
+ * @brief Number of SRP task priority levels.
+ *
+ * @details
+ * The tasks priorities are from 1 to this value, at most 32;
+ * each level takes one list in the dispatcher.
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_RTOS_SRP_PRIORITIES (8)
+
+/**
+ * @brief Use a compare channel for the high resolution clock.
+ *
+ * @details
+ * By default the timeouts and the timers on `hrclock` are checked
+ * only on SysTick, so they have tick resolution.
+ *
+ * With this option, the deadlines that fall inside the current tick
+ * are programmed in a hardware compare channel, so they expire on
+ * the exact cycle; the port must implement
+ * `port::clock_highres::start_compare()` and call
+ * `os_hrclock_compare_handler()` from the channel interrupt.
+ *
+ * @par Default
+ *  Undefined (`hrclock` deadlines have tick resolution).
+ */
+#define OS_USE_RTOS_CLOCK_HIGHRES_COMPARE
+
+/**
+ * @brief Include the timer daemon.
+ *
+ * @details
+ * By default the timer functions are called from the clock
+ * interrupt. With this option, a work queue is created at startup
+ * and the timers created with `tm_run_in_thread` set have their
+ * functions called from its thread, so they may block and use the
+ * full RTOS API; the other timers still run in the interrupt.
+ *
+ * Not available with `OS_USE_RTOS_PORT_TIMER`.
+ *
+ * @par Default
+ *  Undefined (timer functions always run in the interrupt).
+ */
+#define OS_INCLUDE_RTOS_TIMER_DAEMON
+
+/**
+ * @brief Priority of the timer daemon thread.
+ *
+ * @par Default
+ *  `os::rtos::thread::priority::high`.
+ */
+#define OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY (os::rtos::thread::priority::high)
+
+/**
+ * @brief Number of timer expirations the daemon can keep pending.
+ *
+ * @details
+ * Each deferred timer takes at most one entry, regardless of how
+ * many times it expired before the daemon got to it.
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_RTOS_TIMER_DAEMON_QUEUE_SIZE (8)
+
+/**
+ * @brief Size of the timer daemon thread stack, in bytes.
+ *
+ * @par Default
+ *  `os::rtos::port::stack::default_size_bytes`.
+ */
+#define OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES (os::rtos::port::stack::default_size_bytes)
+
+/**
+ * @brief Run the deferred initialisations after the scheduler starts.
+ *
+ * @details
+ * With this option, the functions registered with
+ * `OS_DEFERRED_INIT()` are run by the `init` thread, created
+ * before the scheduler starts, level by level, with the functions
+ * of the same level in parallel on a thread pool, while `os_main()`
+ * runs; use `os::rtos::deferred_init::wait()` to synchronise.
+ *
+ * Without it, the functions are called by the static constructors,
+ * sequentially, before `main()`.
+ */
+#define OS_INCLUDE_RTOS_DEFERRED_INIT
+
+/**
+ * @brief Number of threads running deferred initialisations in parallel.
+ *
+ * @par Default
+ *  2.
+ */
+#define OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS (2)
+
+/**
+ * @brief Priority of the deferred initialisations threads.
+ *
+ * @par Default
+ *  `os::rtos::thread::priority::normal`.
+ */
+#define OS_INTEGER_RTOS_DEFERRED_INIT_PRIORITY (os::rtos::thread::priority::normal)
+
+/**
+ * @brief Size of the deferred initialisations threads stacks, in bytes.
+ *
+ * @par Default
+ *  `os::rtos::port::stack::default_size_bytes`.
+ */
+#define OS_INTEGER_RTOS_DEFERRED_INIT_STACK_SIZE_BYTES (os::rtos::port::stack::default_size_bytes)
+
+/**
+ * @brief Use a bitmap indexed ready threads list.
+ *
+ * @details
+ * By default the scheduler keeps the ready threads in a single
+ * list, ordered by priority; inserting a thread walks the list,
+ * so the duration depends on the number of ready threads.
+ *
+ * This option replaces it with one list per priority level plus
+ * a bitmap of the non-empty levels, searched with `CLZ`, so that
+ * making a thread ready and selecting the next thread to run
+ * take constant time. The price is about 2 KB of RAM for the
+ * 256 level lists.
+ *
+ * @par Default
+ *  Undefined (use the priority ordered list).
+ */
+#define OS_USE_RTOS_READY_THREADS_BITMAP
+
+/**
+ * @brief Run the kernel hot paths from RAM.
+ *
+ * @details
+ * On fast devices, the flash wait states and the flash accelerator
+ * or cache misses make the duration of the kernel code variable.
+ * This option places the functions on the context switch, SysTick
+ * and interrupt post paths (`scheduler::internal_switch_threads()`,
+ * the ready list operations, `waiting_threads_list::resume_one()`,
+ * `thread::resume()`, `os_systick_handler()`, the clock list
+ * checks and `semaphore::post()`) in the `.ramfunc` section,
+ * via `OS_ATTRIBUTE_HOT_PATH`.
+ *
+ * The linker script must place the section in RAM or ITCM, with
+ * the load address in flash, and add it to the
+ * `__data_regions_array` (with
+ * `OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS`), for example:
+ *
+ * @code{.unparsed}
+ * .itcm : ALIGN(4)
+ * {
+ *   FILL(0xFF)
+ *   __itcm_start__ = . ;
+ *   *(.ramfunc*)
+ *   . = ALIGN(4) ;
+ *   __itcm_end__ = . ;
+ * } >ITCM AT>FLASH
+ * @endcode
+ *
+ * The port context switch handler, if written in assembly, should
+ * be placed in the same section.
+ *
+ * @par Default
+ *  Undefined (run from flash).
+ */
+#define OS_USE_RTOS_HOT_PATHS_IN_RAM
+
+/**
+ * @brief Include the data cache maintenance for DMA buffers.
+ *
+ * @details
+ * On devices with a data cache, the functions in `os::rtos::dcache`
+ * call the `os_dcache_clean()`, `os_dcache_invalidate()` and
+ * `os_dcache_clean_invalidate()` hooks, which the application
+ * implements with the core specific calls (on Cortex-M7 the CMSIS
+ * `SCB_*DCache_by_Addr()` functions); the default ones do nothing.
+ *
+ * The buffered serial devices, the USB device and host wrappers
+ * and the block devices marked as using DMA call them around the
+ * transfers; the block device caches allocate their buffers
+ * aligned to `OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES` regardless.
+ *
+ * @par Default
+ *  Undefined (no maintenance, for parts without a data cache
+ *  or with the DMA buffers in non cacheable memory).
+ */
+#define OS_INCLUDE_RTOS_DCACHE_MAINTENANCE
+
+/**
+ * @brief Include the earliest deadline first scheduling class.
+ *
+ * @details
+ * Threads created with a non zero `th_period_ticks` attribute
+ * belong to the EDF class; each job has an absolute deadline,
+ * the release time plus `th_deadline_ticks` (or the period, if 0).
+ * The first job is released when the thread is created, the
+ * next ones by `this_thread::periodic::wait_next_period()`,
+ * with a `periodic` object using the scheduler clock.
+ *
+ * The EDF threads are placed in a band, the priority given by
+ * `th_priority`; within it, the ready threads are ordered by
+ * absolute deadline, so the earliest one runs first, and a newly
+ * released job with an earlier deadline preempts the running one.
+ * The fixed priority threads above the band preempt it, the
+ * ones below run only when no EDF job is ready; fixed priority
+ * threads with the band priority run after the EDF ones.
+ *
+ * The jobs that complete after their deadline are counted by
+ * `thread::statistics::deadline_misses()`.
+ *
+ * The RAM overhead is two durations and one time stamp for each
+ * thread, plus the statistics counter. Inserting a thread in the
+ * ready list also compares the deadlines of the threads with
+ * the same priority.
+ *
+ * Not available with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Undefined (fixed priority scheduling only).
+ */
+#define OS_INCLUDE_RTOS_SCHEDULER_EDF
+
+/**
+ * @brief Include support for thread CPU budgets.
+ *
+ * @details
+ * A thread may get, with `thread::cpu_budget()`, a number of
+ * high resolution clock cycles it is allowed to run in each
+ * period of scheduler ticks. The cycles are charged at each context
+ * switch, from the CPU cycles statistics, which are enabled by this
+ * option; the SysTick handler also checks the running thread,
+ * and starts the new periods.
+ *
+ * When the budget is exhausted, the overrun is counted, as
+ * `thread::cpu_budget_overruns()`, and
+ * `os_rtos_thread_cpu_budget_overrun_hook()` is called; until the
+ * end of the period, the thread keeps running, runs with a lower
+ * priority, or is suspended, so a runaway thread cannot starve
+ * the lower priority threads.
+ *
+ * The RAM overhead is a list node, two time stamps, three
+ * counters and a few bytes for each thread. With no budgets set,
+ * the context switch adds a test and the SysTick handler an empty
+ * list walk.
+ *
+ * Not available with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Undefined (no CPU budgets).
+ */
+#define OS_INCLUDE_RTOS_THREAD_CPU_BUDGET
+
+/**
+ * @brief Include support for snapshots.
+ *
+ * @details
+ * The `snapshot` objects share read-mostly data; the readers get
+ * the current version with a single load and no locks, the writers
+ * publish new copies, and the replaced versions are reused after
+ * the idle thread ran, when no reader can still use them.
+ *
+ * The grace periods are tracked with the idle thread context
+ * switches, so this option enables
+ * `OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES`.
+ *
+ * Not available with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Undefined (no snapshots).
+ */
+#define OS_INCLUDE_RTOS_SNAPSHOT
+
+/**
+ * @brief Use a hierarchical timing wheel for the clock lists.
+ *
+ * @details
+ * By default the clocks keep the timeouts and the timers in a
+ * list ordered by time stamp; inserting a node walks the list,
+ * in a critical section, so the duration depends on the number
+ * of active timeouts.
+ *
+ * This option replaces the ordered lists with hierarchical
+ * timing wheels, so that inserting and removing a node take
+ * constant time, and expiry takes amortised constant time.
+ * Getting the earliest time stamp, used by the tickless idle,
+ * may traverse one slot. Setting an adjustable clock backwards
+ * places all its nodes again.
+ *
+ * The price is the RAM for the slot lists, two pointers for each
+ * of the `OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS` *
+ * 2^`OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS` slots, for
+ * each clock list.
+ *
+ * @par Default
+ *  Undefined (use the time stamp ordered lists).
+ */
+#define OS_USE_RTOS_CLOCK_TIMING_WHEEL
+
+/**
+ * @brief Define the number of bits of the timing wheel slot index.
+ *
+ * @details
+ * Each wheel has 2^`OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS`
+ * slots; at most 5.
+ *
+ * @par Default
+ *  4 (16 slots).
+ */
+#define OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS        (4)
+
+/**
+ * @brief Define the number of timing wheels.
+ *
+ * @details
+ * The wheels cover 2^(`OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS` *
+ * `OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS`) clock units; time stamps
+ * further away are kept in an unordered list, and checked each
+ * time the last wheel turns.
+ *
+ * @par Default
+ *  4 (65536 ticks with 16 slots).
+ */
+#define OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS           (4)
+
+/**
+ * @brief Do not enter sleep in the idle thread.
+ *
+ * @details
+ * Very fast debuggers need direct access to a RAM buffer, which
+ * in turn need the clock that powers the bus where the RAM is
+ * connected to be permanently on.
+ *
+ * Unfortunately, most devices disable this clock when entering
+ * even the shallow sleep mode, disabling the debugger access to
+ * the device.
+ *
+ * To prevent this, usually for the debug configurations,
+ * it is possible to exclude the code that puts the device to sleep.
+ */
+#define OS_EXCLUDE_RTOS_IDLE_SLEEP
+
+/**
+ * @brief Suppress the SysTick interrupts in the idle thread.
+ *
+ * @details
+ * Normally the idle thread wakes up on every SysTick, even when
+ * the next clock deadline is far away.
+ *
+ * With this option, the idle thread computes the number of ticks
+ * up to the earliest timestamp of `sysclock` and `hrclock`, and
+ * passes it to `os_rtos_idle_enter_tickless_sleep_hook()`, which
+ * must program a one-shot wake-up and put the device to sleep.
+ * When back, the clocks are advanced with the slept ticks and
+ * the timestamps are processed once.
+ *
+ * The port or the application must provide the hook; the default
+ * one does nothing and the idle thread behaves as usual.
+ *
+ * This option is ignored if `OS_EXCLUDE_RTOS_IDLE_SLEEP` is defined.
+ */
+#define OS_INCLUDE_RTOS_TICKLESS_IDLE
+
+/**
+ * @brief Define the shortest tickless sleep, in ticks.
+ *
+ * @details
+ * If the next deadline is closer, sleeping with the SysTick
+ * suppressed is not worth the overhead, and the idle thread
+ * simply waits for the next interrupt.
+ *
+ * @par Default
+ *  2 ticks.
+ */
+#define OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS (2)
+
+/**
+ * @brief Let the idle thread select low power states.
+ *
+ * @details
+ * With this option, the idle thread computes the time up to the
+ * earliest clock timestamp and passes it, together with the
+ * strictest latency constraint requested by the threads via
+ * `os::rtos::power::latency_request` objects, to
+ * `os_rtos_idle_select_power_state_hook()`. The default hook selects
+ * the deepest state enabled with `os::rtos::power::enable_state()`
+ * whose exit latency and minimum residency fit.
+ *
+ * The states deeper than `sleep` are entered by
+ * `os_rtos_idle_enter_power_state_hook()`, which the port or the
+ * application must provide; the `sleep` state uses the tickless
+ * sleep, if enabled, or waits for the next interrupt.
+ *
+ * The number of entries and the time spent in each state are
+ * recorded, and are available via `os::rtos::power::statistics`.
+ *
+ * This option is ignored if `OS_EXCLUDE_RTOS_IDLE_SLEEP` is defined.
+ *
+ * @par Default
+ * Disable. The idle thread uses only the `sleep` state.
+ */
+#define OS_INCLUDE_RTOS_IDLE_POWER_STATES
+
+/**
+ * @brief Enable the RAM footprint report.
+ *
+ * @details
+ * The memory pools, message queues, mutexes and block device
+ * caches are linked in a list while they exist, and, together
+ * with the threads and the memory resources, can be listed with
+ * `os::rtos::footprint::report()`, with their sizes and the
+ * storage they use.
+ *
+ * Each registered object grows by four pointers.
+ *
+ * @par Default
+ * Disable.
+ */
+#define OS_INCLUDE_RTOS_FOOTPRINT
+
+/**
+ * @}
+ */
+
+// ----------------------------------------------------------------------------
+/**
+ * @ingroup cmsis-plus-app-config-startup
+ * @{
+ */
+
+/**
+ * @brief Initialise multiple RAM sections.
+ *
+ * @details
+ * The regions are described by the `__data_regions_array` and
+ * `__bss_regions_array` tables, created by the linker script;
+ * the optional `__bss_lazy_regions_array` lists the regions
+ * skipped by the startup and cleared later by
+ * `os_startup_initialize_lazy_bss()`.
+ */
+#define OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS
+
+/**
+ * @brief Enable guard checks for .bss and .data sections.
+ *
+ * @details
+ * Sometimes mistakes in the liner script prevent the .bss area
+ * to be initialised to zero, and/or the .data area to be fully
+ * initialised with content from flash.
+ *
+ * To validate that the start-up properly initialised these areas,
+ * some guard words are defined at the begin/end of the .bss and
+ * .data areas, and are explicitly checked.
+ *
+ * @note This option is available only if DEBUG is also defined.
+ */
+#define OS_BOOL_STARTUP_GUARD_CHECKS (true)
+
+/**
+ * @brief Always initialise the hardware FPU.
+ */
+#define OS_INCLUDE_STARTUP_INIT_FP
+
+/**
+ * @brief Display the startup checkpoints.
+ *
+ * @details
+ * Count the core cycles from `Reset_Handler()`, with the DWT
+ * cycle counter on ARMv7-M devices, or with SysTick (24-bits,
+ * so the long intervals wrap) on ARMv6-M devices, and record the
+ * cycles at the end of each startup step, the stack fill, the
+ * early hardware initialisation, the .data copy, the .bss clear,
+ * the hardware initialisation, the free store initialisation
+ * and the static constructors, and the slowest constructors.
+ *
+ * They are kept in the no-init RAM, displayed before calling
+ * `main()`, and can be displayed again later with
+ * `os_startup_report_checkpoints()`.
+ *
+ * @see OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS
+ */
+#define OS_INCLUDE_STARTUP_CHECKPOINTS
+
+/**
+ * @brief Define the number of slowest static constructors recorded.
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS (8)
+
+/**
+ * @brief Use DMA to initialise huge RAM regions.
+ *
+ * @details
+ * The .data and .bss regions of at least this number of bytes are
+ * passed to the application hooks `os_startup_copy_region_dma()`
+ * and `os_startup_clear_region_dma()`; when they return false,
+ * the regions are initialised by the CPU, as usual.
+ *
+ * @par Default
+ *  Not defined, the CPU initialises all regions.
+ */
+#define OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES (64 * 1024)
+
+/**
+ * @brief Make the application a fully semihosted application.
+ *
+ * @details
+ * When writing test applications it is necessary to use some
+ * of the resources available from the host system (STDOUT/STDERR,
+ * file system, time, exit code, etc).
+ *
+ * This requires the entire behaviour of the system calls to be
+ * changed and most calls to be forwarded to the host. The
+ * application is transformed into a 'fully semihosted' application.
+ *
+ * One major difference from a regular embedded application is that
+ * a fully semihosted test application does not run in an endless
+ * loop, but terminates, and the test result must be passed back
+ * to the host system, via the exit code and optionally via a
+ * detailed status file.
+ */
+#define OS_USE_SEMIHOSTING_SYSCALLS
+
+/**
+ * @brief Define the maximum number of semihosting open files.
+ *
+ * @details
+ * The implementation of the semihosting file support requires
+ * an array of open files, to keep track of the host files.
+ *
+ * To simplify the implementation and avoid dynamic allocations, a static
+ * array is used. This option defines the size of this array.
+ *
+ * @par Default
+ *  20.
+ */
+#define OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES (20)
+
+/**
+ * @brief Buffer the semihosting file descriptors.
+ *
+ * @details
+ * Define the size of the buffers used to group the small
+ * `read()` and `write()` calls, since each host call halts
+ * the core until the debugger services it.
+ *
+ * Output to terminals is flushed on newline; all output is
+ * flushed when the buffer is full, on `fsync()`, `sync()`,
+ * `close()`, seek and exit. Input from files is read ahead,
+ * in blocks of this size; terminal input and requests
+ * larger than the buffer are not buffered. `stderr` is
+ * not buffered.
+ *
+ * Write errors may be reported by a later call.
+ *
+ * @par Default
+ *  Undefined; each call is forwarded to the host.
+ */
+#define OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES
+
+/**
+ * @brief Define the number of semihosting file buffers.
+ *
+ * @details
+ * Buffers are assigned to `stdin`, `stdout` and to the files
+ * when opened; when none is free, the file is not buffered.
+ *
+ * @par Default
+ *  4.
+ */
+#define OS_INTEGER_SEMIHOSTING_BUFFERS (4)
+
+/**
+ * @brief Include definitions for the standard POSIX system calls.
+ *
+ * @todo update after POSIX I/O is updated.
+ */
+#define OS_INCLUDE_STANDARD_POSIX_FUNCTIONS
+
+/**
+ * @brief Include definitions for the newlib system calls.
+ *
+ * @todo update after POSIX I/O is updated.
+ */
+#define OS_INCLUDE_NEWLIB_POSIX_FUNCTIONS
+
+/**
+ * @brief Give each thread its own newlib reentrancy structure.
+ *
+ * @details
+ * Define the number of `struct _reent` kept in a pool. A thread
+ * takes one on its first access to the reentrant data (via
+ * `__getreent()`) and returns it when it exits, so threads that
+ * never use `errno` or stdio take no RAM.
+ *
+ * Requires a newlib built with `__DYNAMIC_REENT__` and
+ * `OS_INTEGER_RTOS_THREAD_TLS_SLOTS` to reserve one slot. Threads
+ * that find the pool empty share the global structure.
+ *
+ * @par Default
+ *  Undefined; all threads share the global structure.
+ */
+#define OS_INTEGER_NEWLIB_REENT_POOL_SIZE
+
+/**
+ * @brief Include the asynchronous I/O functions.
+ *
+ * @details
+ * Add `io::aio_read()` and `io::aio_write()`. Implementations
+ * without native support run the requests on a shared I/O
+ * worker thread, created on first use.
+ *
+ * @par Default
+ *  Undefined (no asynchronous I/O).
+ */
+#define OS_INCLUDE_POSIX_IO_AIO
+
+/**
+ * @brief Priority of the shared I/O worker thread.
+ *
+ * @par Default
+ *  `os::rtos::thread::priority::normal`.
+ */
+#define OS_INTEGER_POSIX_IO_AIO_PRIORITY (os::rtos::thread::priority::normal)
+
+/**
+ * @brief Number of requests the I/O worker can keep pending.
+ *
+ * @par Default
+ *  4.
+ */
+#define OS_INTEGER_POSIX_IO_AIO_QUEUE_SIZE (4)
+
+/**
+ * @brief Size of the I/O worker thread stack, in bytes.
+ *
+ * @par Default
+ *  `os::rtos::port::stack::default_size_bytes`.
+ */
+#define OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES (os::rtos::port::stack::default_size_bytes)
+
+/**
+ * @brief Size of the `sendfile()` copy buffer, in bytes.
+ *
+ * @details
+ * Used by the implementations without a direct path; allocated
+ * on the caller stack. With block devices it must hold at least
+ * one block.
+ *
+ * @par Default
+ *  128.
+ */
+#define OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE_BYTES (128)
+
+/**
+ * @brief Default size of the `pipe()` buffers, in bytes.
+ *
+ * @details
+ * The buffer is allocated from the default memory resource
+ * when the pipe is created. FIFOs define their own size.
+ *
+ * @par Default
+ *  512.
+ */
+#define OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES (512)
+
+/**
+ * @brief Size of the network interface packet rings.
+ *
+ * @details
+ * The number of `pbuf` chains each of the receive and the
+ * transmit rings of a `net_interface` can hold; must be a
+ * power of 2.
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_POSIX_IO_NET_INTERFACE_RING_SIZE (8)
+
+/**
+ * @brief Number of hash buckets in the device registry.
+ *
+ * @details
+ * The devices are linked in the bucket of their name, so
+ * `open()` compares only the names in a single bucket, instead
+ * of all the registered devices. Each bucket is two pointers.
+ *
+ * @par Default
+ *  16.
+ */
+#define OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS (16)
+
+/**
+ * @brief Number of file objects in the pool of each file type.
+ *
+ * @details
+ * The files are constructed in a static pool, in constant
+ * time and without fragmenting the free store; when all are
+ * in use, the next ones are allocated on the free store.
+ * The pool usage is available with
+ * `file_system::files_pool<T>::get()`; 0 disables the pool.
+ *
+ * @par Default
+ *  4.
+ */
+#define OS_INTEGER_POSIX_IO_FILES_POOL_SIZE (4)
+
+/**
+ * @brief Number of directory objects in the pool of each directory type.
+ *
+ * @details
+ * As for `OS_INTEGER_POSIX_IO_FILES_POOL_SIZE`, with
+ * `file_system::directories_pool<T>::get()`.
+ *
+ * @par Default
+ *  2.
+ */
+#define OS_INTEGER_POSIX_IO_DIRECTORIES_POOL_SIZE (2)
+
+/**
+ * @brief Number of socket objects in the pool of each socket type.
+ *
+ * @details
+ * As for `OS_INTEGER_POSIX_IO_FILES_POOL_SIZE`, with
+ * `net_stack::sockets_pool<T>::get()`.
+ *
+ * @par Default
+ *  4.
+ */
+#define OS_INTEGER_POSIX_IO_SOCKETS_POOL_SIZE (4)
+
+/**
+ * @brief Minimum thread priority for urgent block device reads.
+ *
+ * @details
+ * In `block_device_queued`, reads issued by threads with
+ * this priority or higher are served before the requests
+ * ordered by block number.
+ *
+ * @par Default
+ *  `os::rtos::thread::priority::high`.
+ */
+#define OS_INTEGER_POSIX_IO_BLOCK_DEVICE_QUEUE_URGENT_PRIORITY (os::rtos::thread::priority::high)
+
+/**
+ * @brief Include the I/O statistics.
+ *
+ * @details
+ * Count the operations, the bytes, the errors and the
+ * `hrclock` latencies of each device, file and socket, and
+ * of each file system. The counters are read with
+ * `statistics().snapshot()` and printed with
+ * `statistics().dump()`.
+ *
+ * @par Default
+ *  Undefined (no statistics, no overhead).
+ */
+#define OS_INCLUDE_POSIX_IO_STATISTICS
+
+/**
+ * @brief Include the file system attributes cache.
+ *
+ * @details
+ * Keep the results of recent `stat()` calls, including failed
+ * lookups, in each file system. Any change of the file system
+ * invalidates the whole cache.
+ *
+ * @par Default
+ *  Undefined (no cache).
+ */
+#define OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE
+
+/**
+ * @brief Number of entries in the file system attributes cache.
+ *
+ * @par Default
+ *  8.
+ */
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_SIZE (8)
+
+/**
+ * @brief Size of the longest cached path, including the terminator.
+ *
+ * @details
+ * Longer paths are not cached.
+ *
+ * @par Default
+ *  64.
+ */
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_PATH_SIZE (64)
+
+/**
+ * @brief Number of inodes of the log structured file systems.
+ *
+ * @details
+ * The files and the folders of a `file_system_log`, including
+ * the root folder; the inode table is part of the file system
+ * object.
+ *
+ * @par Default
+ *  16.
+ */
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_INODES (16)
+
+/**
+ * @brief Size of the names in the log structured file systems.
+ *
+ * @details
+ * Including the terminator; longer names fail with `ENAMETOOLONG`.
+ * Each inode record must fit in a block, after the header.
+ *
+ * @par Default
+ *  24.
+ */
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_NAME_SIZE (24)
+
+/**
+ * @brief Include the background flusher.
+ *
+ * @details
+ * Add the `flusher` device; while open, its thread calls `sync()`
+ * on the file systems with changes older than the expire time,
+ * or with too many dirty bytes. The file systems keep track of
+ * their changes.
+ *
+ * @par Default
+ *  Undefined (no flusher).
+ */
+#define OS_INCLUDE_POSIX_IO_FLUSHER
+
+/**
+ * @brief Initial priority of the flusher thread.
+ *
+ * @details
+ * Can be changed with the `FLSSETPRIO` ioctl.
  *
- * One major difference from a regular embedded application is that
- * a fully semihosted test application does not run in an endless
- * loop, but terminates, and the test result must be passed back
- * to the host system, via the exit code and optionally via a
- * detailed status file.
+ * @par Default
+ *  `os::rtos::thread::priority::below_normal`.
  */
-#define OS_USE_SEMIHOSTING_SYSCALLS
+#define OS_INTEGER_POSIX_IO_FLUSHER_PRIORITY (os::rtos::thread::priority::below_normal)
 
 /**
- * @brief Define the maximum number of semihosting open files.
+ * @brief Size of the flusher thread stack, in bytes.
  *
  * @details
- * The implementation of the semihosting file support requires
- * an array of open files, to keep track of the host files.
+ * It must also fit the `sync()` of the file systems.
  *
- * To simplify the implementation and avoid dynamic allocations, a static
- * array is used. This option defines the size of this array.
+ * @par Default
+ *  `os::rtos::port::stack::default_size_bytes`.
+ */
+#define OS_INTEGER_POSIX_IO_FLUSHER_STACK_SIZE_BYTES (os::rtos::port::stack::default_size_bytes)
+
+/**
+ * @brief Initial period of the flusher scans, in milliseconds.
+ *
+ * @details
+ * Can be changed with the `FLSSETPERIOD` ioctl.
  *
  * @par Default
- *  20.
+ *  500.
  */
-#define OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES (20)
+#define OS_INTEGER_POSIX_IO_FLUSHER_PERIOD_MS (500)
 
 /**
- * @brief Include definitions for the standard POSIX system calls.
+ * @brief Initial age of the changes written back, in milliseconds.
  *
- * @todo update after POSIX I/O is updated.
+ * @details
+ * Can be changed with the `FLSSETEXPIRE` ioctl.
+ *
+ * @par Default
+ *  3000.
  */
-#define OS_INCLUDE_STANDARD_POSIX_FUNCTIONS
+#define OS_INTEGER_POSIX_IO_FLUSHER_EXPIRE_MS (3000)
 
 /**
- * @brief Include definitions for the newlib system calls.
+ * @brief Initial dirty bytes that force a write back.
  *
- * @todo update after POSIX I/O is updated.
+ * @details
+ * Can be changed with the `FLSSETDIRTY` ioctl; 0 to write
+ * back only by age.
+ *
+ * @par Default
+ *  16384.
  */
-#define OS_INCLUDE_NEWLIB_POSIX_FUNCTIONS
+#define OS_INTEGER_POSIX_IO_FLUSHER_DIRTY_BYTES (16 * 1024)
 
 /**
  * @brief Disable setting MSP during startup.
@@ -626,6 +2181,46 @@
  */
 #define OS_INTEGER_DIRENT_NAME_MAX  (256)
 
+/**
+ * @brief Include the floating point conversions in the format engine.
+ *
+ * @details
+ * Add the `%%f`, `%%e` and `%%g` conversions to `os::format::vprint()`
+ * and the functions using it, like `trace::printf()`; they need
+ * the double precision support, which is large without an FPU.
+ *
+ * @par Default
+ *  Undefined (the conversions are written unchanged).
+ */
+#define OS_INCLUDE_FORMAT_FLOAT
+
+/**
+ * @brief Define the size of the os::format::dprintf() buffer.
+ *
+ * @details
+ * Allocated on the stack; the output is passed to `write()`
+ * in fragments of this size.
+ *
+ * @par Default
+ *  32.
+ */
+#define OS_INTEGER_FORMAT_DPRINTF_BUFFER_SIZE (32)
+
+/**
+ * @brief Use the library memcpy() and memset() for the payload copies.
+ *
+ * @details
+ * The message queues, the inter-core channels, the serial buffers
+ * and the CMSIS OS memory pool clearing use `os::utils::copy_bytes()`
+ * and `os::utils::fill_bytes()`, which copy words (with LDM/STM on
+ * ARM) or, on ARMv8.1-M with the Helium extension, vectors, instead
+ * of the byte oriented functions of the small C libraries.
+ *
+ * With this option they call the library functions, for libraries
+ * which provide optimised ones.
+ */
+#define OS_USE_UTILS_LIBC_COPY
+
 
 /**
  * @}
@@ -690,6 +2285,44 @@
  */
 #define OS_USE_RTOS_PORT_TIMER
 
+/**
+ * @brief Define the C API object accessors inline.
+ *
+ * @details
+ * The C functions that only read a member of an object, like
+ * `os_mutex_get_owner()` or `os_semaphore_get_value()`, are
+ * defined in `os-c-api.h` as `static inline` functions,
+ * reading directly the C structures, whose layout is
+ * checked at compile time against the C++ classes.
+ *
+ * The functions that implement the object behaviour, like
+ * `os_mutex_lock()` or `os_sysclock_now()`, remain calls
+ * into the C++ implementation.
+ *
+ * @par Default
+ *  Undefined; all C API functions are called out of line.
+ */
+#define OS_USE_RTOS_C_API_INLINE
+
+/**
+ * @brief Use the CMSIS-RTOS v2 API instead of the legacy v1 API.
+ *
+ * @details
+ * Build the `cmsis_os2.h` functions, implemented directly over
+ * the C++ objects. All objects can be created with statically
+ * allocated control blocks (`cb_mem`) and storage (`stack_mem`,
+ * `mp_mem`, `mq_mem`), sized with the `os*CbSize` and
+ * `os*MemSize()` definitions, in which case no dynamic memory
+ * is used.
+ *
+ * Since the two APIs share many names, the legacy `cmsis_os.h`
+ * functions are not available when this option is defined.
+ *
+ * @par Default
+ *  Undefined; the legacy CMSIS-RTOS v1 API is built.
+ */
+#define OS_USE_CMSIS_OS2
+
 /**
  * @}
  */
@@ -797,6 +2430,203 @@
  */
 #define OS_USE_TRACE_SEGGER_RTT
 
+/**
+ * @brief Overwrite the oldest bytes when the RTT buffer is full.
+ *
+ * @details
+ * By default, writes that do not fit in the RTT up buffer are
+ * dropped (or trimmed, depending on @ref OS_INTEGER_TRACE_SEGGER_RTT_MODE).
+ * With this option, the oldest unread bytes are discarded instead,
+ * so the buffer always keeps the most recent output, for post
+ * mortem analysis.
+ *
+ * The read offset is changed by the target, which races with a
+ * host reading at the same time; use it when no debugger is
+ * attached or with an occasional reader.
+ *
+ * The discarded bytes are counted by `trace::dropped_bytes()`.
+ */
+#define OS_USE_TRACE_SEGGER_RTT_OVERWRITE
+
+/**
+ * @brief Write binary trace records, formatted on the host.
+ *
+ * @details
+ * With this option, the messages written with `OS_TRACE_BPRINTF()`
+ * are not formatted on the target; only the address of the format
+ * string and the raw arguments are written to the trace channel,
+ * and `scripts/trace-decode.py` formats them on the host, using
+ * the strings from the ELF file.
+ *
+ * This reduces the cost of a message from a `vsnprintf()` call to
+ * a few word copies, and is less intrusive when tracing time
+ * sensitive code. Text and binary output can be mixed in the
+ * same channel.
+ *
+ * @see OS_INTEGER_TRACE_BINARY_MAX_WORDS
+ */
+#define OS_USE_TRACE_BINARY
+
+/**
+ * @brief Buffer the trace output in a lock-free ring buffer.
+ *
+ * @details
+ * With this option `trace::write()` only stores the bytes in
+ * a ring buffer, and never blocks; it can be used by multiple
+ * threads and interrupts at the same time. The idle thread passes
+ * the buffered output to the backend, via `trace::drain()`;
+ * applications that keep the idle thread busy can call it from a
+ * low priority thread instead (but from a single place).
+ *
+ * When the buffer is full the new messages are dropped, unless
+ * @ref OS_USE_TRACE_RING_BUFFER_OVERWRITE is defined; the
+ * number of dropped records is returned by `trace::dropped()`.
+ *
+ * The implementation uses atomic compare and exchange, thus
+ * requires an ARMv7-M or higher core.
+ *
+ * @see OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES
+ * @see OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES
+ */
+#define OS_USE_TRACE_RING_BUFFER
+
+/**
+ * @brief Discard the oldest trace messages when the ring buffer is full.
+ *
+ * @details
+ * By default, the new messages are dropped.
+ */
+#define OS_USE_TRACE_RING_BUFFER_OVERWRITE
+
+/**
+ * @brief Filter the trace messages by channel and level, at run time.
+ *
+ * @details
+ * The messages written with `trace::printf (channel, ...)` are
+ * formatted only if the channel is enabled at their level; the check
+ * is a single load and test. The channels are enabled with
+ * `trace::enable()` and disabled with `trace::disable()`.
+ *
+ * The POSIX I/O traces use one channel per subsystem, at the
+ * debug level. They must still be compiled in, by defining the
+ * `OS_TRACE_POSIX_IO_*` options, but with this option they stay
+ * silent until enabled, so they can be switched on in the field
+ * without rebuilding the application.
+ *
+ * Without this option, all channels are enabled.
+ *
+ * @see OS_INTEGER_TRACE_CHANNELS_ERROR_MASK
+ */
+#define OS_USE_TRACE_CHANNELS
+
+/**
+ * @brief Format the trace messages with the library vsnprintf().
+ *
+ * @details
+ * By default, `trace::printf()` uses the built-in
+ * `os::format::vprint()` engine, which does not allocate memory
+ * and needs less stack than the library functions.
+ *
+ * @see OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE
+ */
+#define OS_USE_TRACE_PRINTF_LIBC
+
+/**
+ * @brief Include the code span profiling probes.
+ *
+ * @details
+ * With this option, `OS_PROFILE_SCOPE("name")` defines a static
+ * probe that accumulates the count, the minimum, the maximum and
+ * the sum of the durations of the rest of the enclosing block;
+ * `os::profile::dump()` displays them on the trace device and
+ * `os::profile::reset_all()` clears them.
+ *
+ * Without this option the macro expands to nothing.
+ *
+ * The message queue send functions and the SysTick handler
+ * are instrumented.
+ *
+ * @see OS_USE_PROFILE_DWT
+ */
+#define OS_INCLUDE_PROFILE_PROBES
+
+/**
+ * @brief Use the DWT cycle counter for the profiling probes.
+ *
+ * @details
+ * On Cortex-M3/M4/M7 devices, measure the probes in CPU cycles,
+ * with the DWT `CYCCNT` register, enabled when the first probe
+ * is used. Without this option, the `hrclock` is used.
+ */
+#define OS_USE_PROFILE_DWT
+
+/**
+ * @brief Measure the interrupts critical sections.
+ *
+ * @details
+ * With this option, the outermost interrupts critical sections
+ * are timed with the DWT cycle counter, and the durations are
+ * accounted to the address of the code that disabled the
+ * interrupts; with @ref OS_INTEGER_RTOS_CRITICAL_SECTION_INTERRUPT_PRIORITY
+ * these are the windows when the interrupts below the given
+ * priority are masked.
+ *
+ * `os::profile::critical_sections::dump()` displays the windows
+ * on the trace device; the addresses can be resolved with
+ * `addr2line`. Windows that include an uncritical section are
+ * accounted as a whole, and the critical sections entered via
+ * the C API are accounted to `os_irq_critical_enter()`.
+ *
+ * Requires @ref OS_INCLUDE_PROFILE_PROBES and
+ * @ref OS_USE_PROFILE_DWT. Each critical section is longer by
+ * two function calls, so use it only for measurements.
+ *
+ * @see OS_INTEGER_PROFILE_CRITICAL_SECTIONS_SITES
+ */
+#define OS_INCLUDE_PROFILE_CRITICAL_SECTIONS
+
+/**
+ * @brief Define the number of critical section sites.
+ *
+ * @details
+ * The size of the table of addresses accounted by
+ * @ref OS_INCLUDE_PROFILE_CRITICAL_SECTIONS. The windows entered
+ * from new addresses when the table is full are only counted.
+ *
+ * @par Default
+ *  64
+ */
+#define OS_INTEGER_PROFILE_CRITICAL_SECTIONS_SITES
+
+/**
+ * @brief Capture a crash dump on faults.
+ *
+ * @details
+ * The HardFault, BusFault and UsageFault handlers store a compact
+ * image, with the fault registers, the exception frame, all threads
+ * with their stack pointers and the top of their stacks, and the
+ * recent trace ring buffer content, to a RAM area in the `.noinit`
+ * section; the linker script must place it in a `NOLOAD` region,
+ * not cleared by the startup code.
+ *
+ * After the reset, `os::crash_dump::save()` copies it to a block
+ * device partition; `scripts/crash-decode.py` displays it on the host.
+ *
+ * @see OS_INTEGER_CRASH_DUMP_SIZE_BYTES
+ * @see OS_INTEGER_CRASH_DUMP_STACK_WORDS
+ */
+#define OS_USE_CRASH_DUMP
+
+/**
+ * @brief Enable trace messages for RTOS inter-core channels functions.
+ */
+#define OS_TRACE_RTOS_AMP_CHANNEL
+
+/**
+ * @brief Enable trace messages for RTOS barrier functions.
+ */
+#define OS_TRACE_RTOS_BARRIER
+
 /**
  * @brief Enable trace messages for RTOS clocks functions.
  */
@@ -817,6 +2647,26 @@
  */
 #define OS_TRACE_RTOS_EVFLAGS
 
+/**
+ * @brief Enable trace messages for RTOS latch functions.
+ */
+#define OS_TRACE_RTOS_LATCH
+
+/**
+ * @brief Enable trace messages for RTOS mailbox functions.
+ */
+#define OS_TRACE_RTOS_MAILBOX
+
+/**
+ * @brief Enable trace messages for RTOS topics functions.
+ */
+#define OS_TRACE_RTOS_TOPIC
+
+/**
+ * @brief Enable trace messages for RTOS snapshots functions.
+ */
+#define OS_TRACE_RTOS_SNAPSHOT
+
 /**
  * @brief Enable trace messages for RTOS memory pools functions.
  */
@@ -837,6 +2687,11 @@
  */
 #define OS_TRACE_RTOS_RTC_TICK
 
+/**
+ * @brief Enable trace messages for RTOS read-write lock functions.
+ */
+#define OS_TRACE_RTOS_RWLOCK
+
 /**
  * @brief Enable trace messages for RTOS scheduler functions.
  */
@@ -877,6 +2732,31 @@
  */
 #define OS_TRACE_RTOS_TIMER
 
+/**
+ * @brief Enable trace messages for RTOS wait set functions.
+ */
+#define OS_TRACE_RTOS_WAITSET
+
+/**
+ * @brief Enable trace messages for RTOS work queue functions.
+ */
+#define OS_TRACE_RTOS_WORKQUEUE
+
+/**
+ * @brief Enable trace messages for RTOS coroutine executor functions.
+ */
+#define OS_TRACE_RTOS_COROUTINE
+
+/**
+ * @brief Enable trace messages for RTOS SRP task functions.
+ */
+#define OS_TRACE_RTOS_SRP
+
+/**
+ * @brief Enable trace messages for RTOS thread pool functions.
+ */
+#define OS_TRACE_RTOS_THREADPOOL
+
 /**
  * @brief Enable trace messages for RTOS list functions.
  *
@@ -940,6 +2820,141 @@
  */
 #define OS_INTEGER_TRACE_SEMIHOSTING_BUFF_ARRAY_SIZE (16)
 
+/**
+ * @brief Define the SEGGER RTT up buffer mode.
+ *
+ * @details
+ * One of `SEGGER_RTT_MODE_NO_BLOCK_SKIP` (drop the writes that
+ * do not fit), `SEGGER_RTT_MODE_NO_BLOCK_TRIM` (write as much as
+ * fits) or `SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL` (wait for the
+ * host). Only the blocking mode waits in `trace::flush()`; the
+ * others are safe with a detached debugger.
+ *
+ * @par Default
+ *  SEGGER_RTT_MODE_NO_BLOCK_SKIP.
+ */
+#define OS_INTEGER_TRACE_SEGGER_RTT_MODE (SEGGER_RTT_MODE_NO_BLOCK_SKIP)
+
+/**
+ * @brief Define the number of SEGGER RTT up buffers used for trace.
+ *
+ * @details
+ * Channel 0 uses the buffer configured in `SEGGER_RTT_Conf.h`
+ * (`BUFFER_SIZE_UP`); the other channels, available via
+ * `trace::write_channel()`, for example one per subsystem, use
+ * buffers of @ref OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFER_SIZE_BYTES.
+ *
+ * @par Default
+ *  1.
+ */
+#define OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS (1)
+
+/**
+ * @brief Define the size of the additional SEGGER RTT up buffers.
+ *
+ * @par Default
+ *  BUFFER_SIZE_UP.
+ */
+#define OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFER_SIZE_BYTES (1024)
+
+/**
+ * @brief Define the maximum number of argument words in a binary trace record.
+ *
+ * @details
+ * Arguments are stored in 32-bit words; `long long` and
+ * `double` take two words. The excess words are dropped.
+ *
+ * @par Default
+ *  16.
+ *
+ * @see OS_USE_TRACE_BINARY
+ */
+#define OS_INTEGER_TRACE_BINARY_MAX_WORDS (16)
+
+/**
+ * @brief Define the size of the trace ring buffer.
+ *
+ * @details
+ * Must be a power of 2, between 64 and 65536.
+ *
+ * @par Default
+ *  1024.
+ *
+ * @see OS_USE_TRACE_RING_BUFFER
+ */
+#define OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES (1024)
+
+/**
+ * @brief Define the maximum size of a trace ring buffer record.
+ *
+ * @details
+ * Longer writes are split into several records; this is also
+ * the size of the buffer allocated on the stack by `trace::drain()`.
+ *
+ * @par Default
+ *  64.
+ *
+ * @see OS_USE_TRACE_RING_BUFFER
+ */
+#define OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES (64)
+
+/**
+ * @brief Define the channels initially enabled for errors.
+ *
+ * @details
+ * At startup, only the error messages of these channels are
+ * written; all other levels are disabled.
+ *
+ * @par Default
+ *  0xFFFFFFFF (all channels).
+ *
+ * @see OS_USE_TRACE_CHANNELS
+ */
+#define OS_INTEGER_TRACE_CHANNELS_ERROR_MASK (0xFFFFFFFF)
+
+/**
+ * @brief Define the size of the trace printf() buffer.
+ *
+ * @details
+ * Allocated on the stack of the thread calling `trace::printf()`.
+ * With the built-in engine the buffer is written when full, so
+ * it can be small; with `OS_USE_TRACE_PRINTF_LIBC` the messages
+ * are truncated to this size.
+ *
+ * @par Default
+ *  200.
+ */
+#define OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE (200)
+
+/**
+ * @brief Define the size of the crash dump area.
+ *
+ * @details
+ * A multiple of the block size of the partition used to save it.
+ * The threads that do not fit are not recorded, and the trace
+ * content is limited to the remaining space.
+ *
+ * @par Default
+ *  2048 bytes.
+ *
+ * @see OS_USE_CRASH_DUMP
+ */
+#define OS_INTEGER_CRASH_DUMP_SIZE_BYTES (2048)
+
+/**
+ * @brief Define the number of stack words saved for each thread.
+ *
+ * @details
+ * The words above the stack pointer, where the most recent
+ * frames are.
+ *
+ * @par Default
+ *  32 words.
+ *
+ * @see OS_USE_CRASH_DUMP
+ */
+#define OS_INTEGER_CRASH_DUMP_STACK_WORDS (32)
+
 /**
  * @}
  */
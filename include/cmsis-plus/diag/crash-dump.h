@@ -0,0 +1,232 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_DIAG_CRASH_DUMP_H_
+#define CMSIS_PLUS_DIAG_CRASH_DUMP_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <stdint.h>
+
+#if defined(OS_USE_CRASH_DUMP)
+
+#include <cmsis-plus/cortexm/exception-handlers.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+  /**
+   * @brief Capture a crash dump.
+   * @param [in] frame Pointer to the exception stack frame.
+   * @param [in] exc_return The EXC_RETURN value of the fault handler.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * Called by the fault handlers, before anything else is
+   * displayed; only the first fault after a clear is recorded.
+   */
+  void
+  os_crash_dump_capture (exception_stack_frame_t* frame, uint32_t exc_return);
+
+#if defined(__cplusplus)
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/posix-io/block-device.h>
+
+#include <cstddef>
+
+namespace os
+{
+  /**
+   * @brief Post-mortem crash dump namespace.
+   * @ingroup cmsis-plus-diag
+   * @details
+   * On faults, a compact image with the fault registers, the
+   * exception frame, all threads with their saved stack pointers
+   * and the top of their stacks, and the recent trace ring buffer
+   * content, is written to a RAM area placed in the `.noinit`
+   * section, which must not be initialised by the startup code.
+   *
+   * After the reset, the application checks it with `valid()`,
+   * stores it with `save()` to a reserved block device partition,
+   * and releases it with `clear()`. The image is decoded on the
+   * host with `scripts/crash-decode.py`.
+   */
+  namespace crash_dump
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Image magic, `CRSH`.
+     */
+    constexpr uint32_t magic = 0x48535243;
+
+    /**
+     * @brief Image layout version.
+     */
+    constexpr uint16_t version = 1;
+
+    /**
+     * @brief Maximum length of the saved thread names.
+     */
+    constexpr std::size_t name_size = 16;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Crash dump image header.
+     */
+    struct header
+    {
+      uint32_t magic;
+      uint16_t version;
+      uint16_t threads;
+      // Total bytes, including the header.
+      uint32_t size;
+      // Sum of all image words, with this field zero.
+      uint32_t checksum;
+      uint32_t timestamp;
+
+      // Fault status.
+      uint32_t exc_return;
+      uint32_t cfsr;
+      uint32_t hfsr;
+      uint32_t mmfar;
+      uint32_t bfar;
+
+      // Exception frame.
+      uint32_t frame;
+      uint32_t r0;
+      uint32_t r1;
+      uint32_t r2;
+      uint32_t r3;
+      uint32_t r12;
+      uint32_t lr;
+      uint32_t pc;
+      uint32_t psr;
+
+      uint32_t current_thread;
+      uint32_t trace_bytes;
+    };
+
+    /**
+     * @brief Crash dump thread record.
+     * @details
+     * Followed by `stack_words` words, copied from the stack pointer up.
+     */
+    struct thread_record
+    {
+      uint32_t id;
+      char name[name_size];
+      uint8_t state;
+      uint8_t priority;
+      uint16_t stack_words;
+      uint32_t stack_pointer;
+      uint32_t stack_bottom;
+      uint32_t stack_size;
+    };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief Check if the area holds a crash dump.
+     * @par Parameters
+     *  None.
+     * @retval true The image is complete and its checksum matches.
+     * @retval false There is no crash dump.
+     */
+    bool
+    valid (void);
+
+    /**
+     * @brief Get the crash dump image.
+     * @par Parameters
+     *  None.
+     * @return Pointer to the image header.
+     */
+    const header*
+    image (void);
+
+    /**
+     * @brief Get the crash dump area size.
+     * @par Parameters
+     *  None.
+     * @return The number of bytes.
+     */
+    std::size_t
+    capacity (void);
+
+    /**
+     * @brief Write the crash dump to a block device.
+     * @param [in] device Reference to an open block device.
+     * @param [in] blknum The first block number.
+     * @return The number of blocks written or -1 if an error occurred.
+     *
+     * @par Errors
+     * - `ENOENT` - there is no valid crash dump.
+     * - `EINVAL` - the area is not a multiple of the block size.
+     * - the errors of `block_device::write_block()`.
+     */
+    ssize_t
+    save (posix::block_device& device, posix::block_device::blknum_t blknum);
+
+    /**
+     * @brief Invalidate the crash dump.
+     * @par Parameters
+     *  None.
+     * @par Returns
+     *  Nothing.
+     */
+    void
+    clear (void);
+
+  } /* namespace crash_dump */
+} /* namespace os */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* defined(OS_USE_CRASH_DUMP) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_DIAG_CRASH_DUMP_H_ */
@@ -0,0 +1,190 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_DIAG_FORMAT_H_
+#define CMSIS_PLUS_DIAG_FORMAT_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(__cplusplus)
+#include <cstddef>
+#include <cstdarg>
+#else
+#include <stddef.h>
+#include <stdarg.h>
+#endif
+
+#include <sys/types.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Check the printf() like arguments at compile time.
+ * @param f The position of the format parameter.
+ * @param a The position of the first variable argument, or 0.
+ *
+ * @details
+ * Enabled where `size_t` has the size of `int`, since the
+ * existing traces use `%u` for sizes, which is correct on the
+ * 32-bit targets but not on the 64-bit hosts.
+ */
+#if !defined(OS_ATTRIBUTE_PRINTF_FORMAT)
+#if (__SIZEOF_SIZE_T__ == __SIZEOF_INT__)
+#define OS_ATTRIBUTE_PRINTF_FORMAT(f, a) __attribute__((format (printf, f, a)))
+#else
+#define OS_ATTRIBUTE_PRINTF_FORMAT(f, a)
+#endif
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+namespace os
+{
+  /**
+   * @brief Formatted output namespace.
+   * @ingroup cmsis-plus-diag
+   *
+   * @details
+   * A small `printf()` engine, which does not allocate memory, does
+   * not use static variables and needs little stack, so it can be
+   * used from any thread and from interrupt handlers.
+   *
+   * The output is passed to a sink function, in fragments, as it is
+   * produced, without an intermediate buffer.
+   *
+   * The conversions are `d i u o x X c s p %`, with the flags
+   * `- + space # 0`, the width and precision (also as `*`) and the
+   * length modifiers `hh h l ll j z t`; with
+   * `OS_INCLUDE_FORMAT_FLOAT`, also `f F e E g G` (with `L`),
+   * with at most 17 decimals, computed in double precision, so
+   * the digits beyond the 15th may differ from the C library;
+   * `%%f` of values above 1e19 uses the `%%e` form. `%%n` is
+   * not supported.
+   */
+  namespace format
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Type of the output sink functions.
+     * @param [in] ctx The context passed to the engine.
+     * @param [in] buf Pointer to the characters.
+     * @param [in] nbyte Number of characters.
+     * @return The number of characters written, or -1 if error,
+     *  which stops the formatting.
+     */
+    using sink_t = ssize_t (*) (void* ctx, const char* buf, std::size_t nbyte);
+
+    /**
+     * @brief Format a variable arguments list to a sink.
+     * @param [in] sink Pointer to the sink function.
+     * @param [in] ctx The context passed to the sink.
+     * @param [in] fmt A null terminated string with the format.
+     * @param [in] args A variable arguments list.
+     * @return The number of characters written, or -1 if the sink
+     *  returned an error.
+     */
+    int
+    vprint (sink_t sink, void* ctx, const char* fmt, std::va_list args)
+        OS_ATTRIBUTE_PRINTF_FORMAT(3, 0);
+
+    /**
+     * @brief Format the arguments to a sink.
+     * @param [in] sink Pointer to the sink function.
+     * @param [in] ctx The context passed to the sink.
+     * @param [in] fmt A null terminated string with the format.
+     * @return The number of characters written, or -1 if the sink
+     *  returned an error.
+     */
+    int
+    print (sink_t sink, void* ctx, const char* fmt, ...)
+        OS_ATTRIBUTE_PRINTF_FORMAT(3, 4);
+
+    /**
+     * @brief Format a variable arguments list to a buffer.
+     * @param [out] buf Pointer to the buffer.
+     * @param [in] size The buffer size, including the terminator.
+     * @param [in] fmt A null terminated string with the format.
+     * @param [in] args A variable arguments list.
+     * @return The number of characters of the entire output,
+     *  not counting the terminator, as `vsnprintf()`.
+     */
+    int
+    vsnprintf (char* buf, std::size_t size, const char* fmt,
+               std::va_list args) OS_ATTRIBUTE_PRINTF_FORMAT(3, 0);
+
+    /**
+     * @brief Format the arguments to a buffer.
+     * @param [out] buf Pointer to the buffer.
+     * @param [in] size The buffer size, including the terminator.
+     * @param [in] fmt A null terminated string with the format.
+     * @return The number of characters of the entire output,
+     *  not counting the terminator, as `snprintf()`.
+     */
+    int
+    snprintf (char* buf, std::size_t size, const char* fmt, ...)
+        OS_ATTRIBUTE_PRINTF_FORMAT(3, 4);
+
+    /**
+     * @brief Format a variable arguments list to a file descriptor.
+     * @param [in] fd The file descriptor.
+     * @param [in] fmt A null terminated string with the format.
+     * @param [in] args A variable arguments list.
+     * @return The number of characters written, or -1 if error.
+     *
+     * @details
+     * The output is passed to `write()` in small fragments,
+     * so it can be used as a `printf()` replacement in threads
+     * with small stacks.
+     */
+    int
+    vdprintf (int fd, const char* fmt, std::va_list args)
+        OS_ATTRIBUTE_PRINTF_FORMAT(2, 0);
+
+    /**
+     * @brief Format the arguments to a file descriptor.
+     * @param [in] fd The file descriptor.
+     * @param [in] fmt A null terminated string with the format.
+     * @return The number of characters written, or -1 if error.
+     */
+    int
+    dprintf (int fd, const char* fmt, ...) OS_ATTRIBUTE_PRINTF_FORMAT(2, 3);
+
+  } /* namespace format */
+} /* namespace os */
+
+#endif /* defined(__cplusplus) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_DIAG_FORMAT_H_ */
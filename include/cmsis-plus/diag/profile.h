@@ -0,0 +1,514 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_DIAG_PROFILE_H_
+#define CMSIS_PLUS_DIAG_PROFILE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS)
+#if !defined(OS_INCLUDE_PROFILE_PROBES) || !defined(OS_USE_PROFILE_DWT)
+#error "OS_INCLUDE_PROFILE_CRITICAL_SECTIONS requires OS_INCLUDE_PROFILE_PROBES and OS_USE_PROFILE_DWT"
+#endif
+#endif
+
+#if defined(OS_INCLUDE_PROFILE_PROBES)
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstdint>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  /**
+   * @brief Code span profiling support namespace.
+   * @ingroup cmsis-plus-diag
+   * @details
+   * Probes are named static objects that accumulate the number,
+   * the minimum, the maximum and the sum of the durations of a
+   * code span, in CPU cycles (the DWT cycle counter, with
+   * @ref OS_USE_PROFILE_DWT) or `hrclock` cycles.
+   *
+   * The usual way to use them is via `OS_PROFILE_SCOPE()`, which
+   * measures from the definition to the end of the enclosing
+   * block, and compiles to nothing when
+   * @ref OS_INCLUDE_PROFILE_PROBES is not defined.
+   */
+  namespace profile
+  {
+    // ------------------------------------------------------------------------
+
+    using cycles_t = uint32_t;
+
+    /**
+     * @brief Get the current cycle count.
+     * @par Parameters
+     *  None.
+     * @return The free running cycle counter.
+     */
+    inline cycles_t
+    __attribute__((always_inline))
+    now (void)
+    {
+#if defined(OS_USE_PROFILE_DWT)
+      // DWT->CYCCNT.
+      return *reinterpret_cast<volatile uint32_t*> (0xE0001004);
+#else
+      return static_cast<cycles_t> (rtos::hrclock.now ());
+#endif
+    }
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Statistics of a code span.
+     * @headerfile profile.h <cmsis-plus/diag/profile.h>
+     * @ingroup cmsis-plus-diag
+     *
+     * @details
+     * The constructor is `constexpr`, so static probes, including
+     * the function local ones, are constant initialised and need
+     * no guard. A probe is added to the list of probes when it
+     * records the first duration.
+     */
+    class probe
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a probe.
+       * @param [in] name Probe name, a static string.
+       */
+      constexpr
+      probe (const char* name) :
+          name_ (name)
+      {
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      probe (const probe&) = delete;
+      probe (probe&&) = delete;
+      probe&
+      operator= (const probe&) = delete;
+      probe&
+      operator= (probe&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~probe () = default;
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Account a duration.
+       * @param [in] cycles The duration, in cycles.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      record (cycles_t cycles);
+
+      /**
+       * @brief Clear the statistics.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      reset (void);
+
+      /**
+       * @brief Get the probe name.
+       */
+      const char*
+      name (void) const;
+
+      /**
+       * @brief Get the number of recorded durations.
+       */
+      uint32_t
+      count (void) const;
+
+      /**
+       * @brief Get the shortest duration.
+       */
+      cycles_t
+      min (void) const;
+
+      /**
+       * @brief Get the longest duration.
+       */
+      cycles_t
+      max (void) const;
+
+      /**
+       * @brief Get the sum of all durations.
+       */
+      uint64_t
+      sum (void) const;
+
+      /**
+       * @brief Get the next probe in the list.
+       * @return Pointer to the probe or nullptr.
+       */
+      probe*
+      next (void) const;
+
+      /**
+       * @}
+       */
+
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      const char* name_;
+      probe* next_ = nullptr;
+      uint64_t sum_ = 0;
+      uint32_t count_ = 0;
+      cycles_t min_ = 0;
+      cycles_t max_ = 0;
+      bool linked_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Measure the lifetime of the object.
+     * @headerfile profile.h <cmsis-plus/diag/profile.h>
+     * @ingroup cmsis-plus-diag
+     */
+    class scope
+    {
+    public:
+
+      scope (probe& p) :
+          probe_ (p), //
+          begin_ (now ())
+      {
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      scope (const scope&) = delete;
+      scope (scope&&) = delete;
+      scope&
+      operator= (const scope&) = delete;
+      scope&
+      operator= (scope&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~scope ()
+      {
+        probe_.record (now () - begin_);
+      }
+
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      probe& probe_;
+      cycles_t begin_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    /**
+     * @brief Initialise the cycle counter.
+     * @par Parameters
+     *  None.
+     * @par Returns
+     *  Nothing.
+     *
+     * @details
+     * With @ref OS_USE_PROFILE_DWT, enable the DWT cycle counter;
+     * called automatically when the first probe is used.
+     */
+    void
+    initialize (void);
+
+    /**
+     * @brief Get the first probe.
+     * @par Parameters
+     *  None.
+     * @return Pointer to the most recently used new probe, or nullptr.
+     */
+    probe*
+    first (void);
+
+    /**
+     * @brief Clear the statistics of all probes.
+     * @par Parameters
+     *  None.
+     * @par Returns
+     *  Nothing.
+     */
+    void
+    reset_all (void);
+
+    /**
+     * @brief Display the statistics of all probes on the trace device.
+     * @par Parameters
+     *  None.
+     * @par Returns
+     *  Nothing.
+     */
+    void
+    dump (void);
+
+#if defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS)
+
+    /**
+     * @brief Interrupts critical sections profiling.
+     * @ingroup cmsis-plus-diag
+     * @details
+     * With @ref OS_INCLUDE_PROFILE_CRITICAL_SECTIONS, the outermost
+     * `interrupts::critical_section` windows are measured, from
+     * the moment the interrupts are disabled to the moment they
+     * are restored, and accounted to the address of the code
+     * that entered the window, in a small table.
+     *
+     * The addresses can be resolved to kernel functions and
+     * lines with `addr2line -f -e app.elf`.
+     */
+    namespace critical_sections
+    {
+      /**
+       * @brief Statistics of the windows entered at one address.
+       */
+      struct site
+      {
+        /**
+         * @brief Address of the code that entered the window.
+         */
+        const void* pc;
+
+        /**
+         * @brief Number of windows.
+         */
+        uint32_t count;
+
+        /**
+         * @brief Longest window, in cycles.
+         */
+        cycles_t max;
+
+        /**
+         * @brief Sum of all windows, in cycles.
+         */
+        uint64_t sum;
+      };
+
+      /**
+       * @brief Get the sites table.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the array of sites; unused entries have
+       *  a null `pc`.
+       */
+      const site*
+      sites (void);
+
+      /**
+       * @brief Get the size of the sites table.
+       * @par Parameters
+       *  None.
+       * @return The number of entries, used or not.
+       */
+      std::size_t
+      capacity (void);
+
+      /**
+       * @brief Get the longest window, from any site.
+       * @par Parameters
+       *  None.
+       * @return The duration, in cycles.
+       */
+      cycles_t
+      max (void);
+
+      /**
+       * @brief Get the number of windows with no free site.
+       * @par Parameters
+       *  None.
+       * @return The number of windows not accounted in a site.
+       */
+      uint32_t
+      dropped (void);
+
+      /**
+       * @brief Clear the statistics.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      reset (void);
+
+      /**
+       * @brief Display the statistics on the trace device.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      dump (void);
+
+    } /* namespace critical_sections */
+
+#endif /* defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS) */
+
+  } /* namespace profile */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace profile
+  {
+    // ========================================================================
+
+    inline const char*
+    probe::name (void) const
+    {
+      return name_;
+    }
+
+    inline uint32_t
+    probe::count (void) const
+    {
+      return count_;
+    }
+
+    inline cycles_t
+    probe::min (void) const
+    {
+      return min_;
+    }
+
+    inline cycles_t
+    probe::max (void) const
+    {
+      return max_;
+    }
+
+    inline uint64_t
+    probe::sum (void) const
+    {
+      return sum_;
+    }
+
+    inline probe*
+    probe::next (void) const
+    {
+      return next_;
+    }
+
+  } /* namespace profile */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#define OS_PROFILE_CONCAT_(a, b) a##b
+#define OS_PROFILE_CONCAT(a, b) OS_PROFILE_CONCAT_(a, b)
+
+/**
+ * @brief Measure the rest of the enclosing block with a named probe.
+ * @param name A string literal with the probe name.
+ */
+#define OS_PROFILE_SCOPE(name) \
+  static os::profile::probe OS_PROFILE_CONCAT(os_profile_probe_, __LINE__) \
+    { name }; \
+  os::profile::scope OS_PROFILE_CONCAT(os_profile_scope_, __LINE__) \
+    { OS_PROFILE_CONCAT(os_profile_probe_, __LINE__) }
+
+#else /* !defined(OS_INCLUDE_PROFILE_PROBES) */
+
+#define OS_PROFILE_SCOPE(name)
+
+#endif /* defined(OS_INCLUDE_PROFILE_PROBES) */
+
+#endif /* defined(__cplusplus) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_DIAG_PROFILE_H_ */
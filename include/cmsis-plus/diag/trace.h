@@ -30,11 +30,17 @@
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
 #if defined(__cplusplus)
 #include <cstdint>
 #include <cstddef>
 #include <cstdarg>
 #include <cstdlib>
+#include <cstring>
+#include <type_traits>
 #else
 #include <stdint.h>
 #include <stdarg.h>
@@ -43,6 +49,8 @@
 
 #include <sys/types.h>
 
+#include <cmsis-plus/diag/format.h>
+
 #if defined(__cplusplus)
 
 // To be effective, <stdio.h> must be included *before* this patch.
@@ -71,6 +79,77 @@ trace_dbg_bkpt (void)
 #endif
 }
 
+#if defined(__cplusplus)
+
+namespace os
+{
+  namespace trace
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Trace channels.
+     * @ingroup cmsis-plus-diag
+     *
+     * @details
+     * Each channel is a bit; the bits from `user` up are
+     * available to the application.
+     */
+    enum channel : uint32_t
+    {
+      posix_io_io = 1u << 0, //
+      posix_io_device = 1u << 1, //
+      posix_io_char_device = 1u << 2, //
+      posix_io_block_device = 1u << 3, //
+      posix_io_block_device_partition = 1u << 4, //
+      posix_io_block_device_cache = 1u << 5, //
+      posix_io_file = 1u << 6, //
+      posix_io_directory = 1u << 7, //
+      posix_io_file_system = 1u << 8, //
+      posix_io_file_descriptors_manager = 1u << 9, //
+      posix_io_event_poll = 1u << 10, //
+      posix_io_socket = 1u << 11, //
+      posix_io_net_stack = 1u << 12, //
+      posix_io_tty = 1u << 13, //
+      posix_io_pipe = 1u << 14, //
+      posix_io_shared_memory = 1u << 15, //
+
+      user = 1u << 16, //
+
+      all = 0xFFFFFFFFu
+    };
+
+    /**
+     * @brief Trace message severity levels.
+     * @ingroup cmsis-plus-diag
+     */
+    enum class level : uint8_t
+    {
+      error = 0, //
+      warning = 1, //
+      info = 2, //
+      debug = 3, //
+    };
+
+    /**
+     * @cond ignore
+     */
+
+    constexpr std::size_t levels = 4;
+
+    // For each level, the mask of the channels enabled at
+    // that level.
+    extern uint32_t volatile channels_masks_[levels];
+
+    /**
+     * @endcond
+     */
+
+  } /* namespace trace */
+} /* namespace os */
+
+#endif /* defined(__cplusplus) */
+
 #if defined(TRACE)
 
 #if defined(__cplusplus)
@@ -113,6 +192,78 @@ namespace os
     ssize_t
     write (const void* buf, std::size_t nbyte);
 
+    /**
+     * @brief Write directly to the trace backend.
+     * @param [in] buf Pointer to the bytes.
+     * @param [in] nbyte Number of bytes.
+     * @return The number of bytes written, or -1 if error.
+     *
+     * @details
+     * With @ref OS_USE_TRACE_RING_BUFFER, the backends implement
+     * this function and `write()` only stores the bytes in the
+     * ring buffer.
+     */
+    ssize_t
+    write_direct (const void* buf, std::size_t nbyte);
+
+    /**
+     * @brief Write to a specific channel of the trace backend.
+     * @param [in] channel The backend channel (like the RTT up buffer).
+     * @param [in] buf Pointer to the bytes.
+     * @param [in] nbyte Number of bytes.
+     * @return The number of bytes written, or -1 if error.
+     *
+     * @details
+     * Allows subsystems to use separate channels; with backends
+     * that have a single channel it is the same as `write()`.
+     */
+    ssize_t
+    write_channel (std::size_t channel, const void* buf, std::size_t nbyte);
+
+    /**
+     * @brief Get the number of bytes dropped by the trace backend.
+     * @par Parameters
+     *  None.
+     * @return The number of bytes not written since startup.
+     */
+    std::size_t
+    dropped_bytes (void);
+
+    /**
+     * @brief Pass the buffered trace output to the backend.
+     * @par Parameters
+     *  None.
+     * @return The number of bytes passed to the backend.
+     *
+     * @details
+     * Available with @ref OS_USE_TRACE_RING_BUFFER; called from
+     * the idle thread, or from a single low priority thread.
+     */
+    std::size_t
+    drain (void);
+
+    /**
+     * @brief Get the number of dropped ring buffer records.
+     * @par Parameters
+     *  None.
+     * @return The number of records dropped since startup.
+     */
+    std::size_t
+    dropped (void);
+
+    /**
+     * @brief Copy the most recent ring buffer contents.
+     * @param [out] buf Pointer to the destination buffer.
+     * @param [in] nbyte Size of the destination buffer.
+     * @return The number of bytes copied.
+     *
+     * @details
+     * Available with @ref OS_USE_TRACE_RING_BUFFER; the records
+     * are not consumed. Used by the crash dump, from fault handlers.
+     */
+    std::size_t
+    snapshot (void* buf, std::size_t nbyte);
+
     // ----------------------------------------------------------------------
 
     /**
@@ -123,7 +274,7 @@ namespace os
      * @ingroup cmsis-plus-diag
      */
     int
-    printf (const char* format, ...);
+    printf (const char* format, ...) OS_ATTRIBUTE_PRINTF_FORMAT(1, 2);
 
     /**
      * @brief Write a formatted variable arguments list to the trace device.
@@ -134,7 +285,8 @@ namespace os
      * @ingroup cmsis-plus-diag
      */
     int
-    vprintf (const char* format, std::va_list args);
+    vprintf (const char* format, std::va_list args)
+        OS_ATTRIBUTE_PRINTF_FORMAT(1, 0);
 
     /**
      * @brief Write the string and a line terminator to the trace device.
@@ -178,6 +330,208 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+    /**
+     * @brief Write a binary trace record.
+     * @param [in] format The format string, used as the record ID.
+     * @param [in] args Array of raw argument words.
+     * @param [in] nwords Number of words in the array.
+     * @return The number of bytes written, or -1 if error.
+     *
+     * @details
+     * The record is a header word (0xB7 in the most significant byte
+     * and the number of argument words in the low bits), the format
+     * address and the argument words, all in target byte order,
+     * passed to `write()` in a single call.
+     *
+     * @ingroup cmsis-plus-diag
+     */
+    ssize_t
+    write_binary (const char* format, const uint32_t* args,
+                  std::size_t nwords);
+
+    /**
+     * @cond ignore
+     */
+
+    namespace detail
+    {
+      // Apply the default argument promotions, like printf().
+      template<typename T>
+        using promoted_t =
+        typename std::conditional<std::is_floating_point<T>::value, double,
+        typename std::conditional<(std::is_integral<T>::value
+            && sizeof(T) < sizeof(int)), int, T>::type>::type;
+
+      template<typename T>
+        constexpr std::size_t
+        words (void)
+        {
+          return (sizeof(promoted_t<T>) + sizeof(uint32_t) - 1)
+              / sizeof(uint32_t);
+        }
+
+      template<typename ... Args>
+        struct count_words;
+
+      template<>
+        struct count_words<>
+        {
+          static constexpr std::size_t value = 0;
+        };
+
+      template<typename T, typename ... Args>
+        struct count_words<T, Args...>
+        {
+          static constexpr std::size_t value = words<T> ()
+              + count_words<Args...>::value;
+        };
+
+      inline void
+      pack (uint32_t*)
+      {
+      }
+
+      template<typename T, typename ... Args>
+        inline void
+        pack (uint32_t* p, T v, Args ... args)
+        {
+          promoted_t<T> pv = static_cast<promoted_t<T>> (v);
+          std::memcpy (p, &pv, sizeof(pv));
+          pack (p + words<T> (), args...);
+        }
+    } /* namespace detail */
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @brief Write a trace message, possibly formatted on the host.
+     * @param [in] format A null terminate string with the format.
+     * @param [in] args The arguments.
+     * @return A nonnegative number for success.
+     *
+     * @details
+     * With @ref OS_USE_TRACE_BINARY the arguments are only copied
+     * into a binary record, with the format address as ID, and the
+     * formatting is done by the host decoder
+     * (`scripts/trace-decode.py`); otherwise this is `printf()`.
+     *
+     * Use it via `OS_TRACE_BPRINTF()`, which places the format string
+     * in the `.trace_fmt` section. `%%s` arguments are decoded only
+     * if they point to constant strings in the ELF file.
+     *
+     * @ingroup cmsis-plus-diag
+     */
+    template<typename ... Args>
+      inline int
+      bprintf (const char* format, Args ... args)
+      {
+#if defined(OS_USE_TRACE_BINARY)
+        constexpr std::size_t nwords = detail::count_words<Args...>::value;
+        uint32_t words[nwords + 1];
+        detail::pack (words, args...);
+        return static_cast<int> (write_binary (format, words, nwords));
+#else
+        return os::trace::printf (format, args...);
+#endif
+      }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Enable trace channels.
+     * @param [in] channels Mask of channels.
+     * @param [in] lvl The least severe level to be written.
+     * @par Returns
+     *  Nothing.
+     *
+     * @details
+     * Available with @ref OS_USE_TRACE_CHANNELS; the more severe
+     * levels are also enabled, the less severe are disabled.
+     *
+     * @ingroup cmsis-plus-diag
+     */
+    void
+    enable (uint32_t channels, level lvl = level::debug);
+
+    /**
+     * @brief Disable trace channels, at all levels.
+     * @param [in] channels Mask of channels.
+     * @par Returns
+     *  Nothing.
+     *
+     * @ingroup cmsis-plus-diag
+     */
+    void
+    disable (uint32_t channels);
+
+    /**
+     * @brief Check if a trace channel is enabled.
+     * @param [in] ch The channel.
+     * @param [in] lvl The message level.
+     * @retval true Messages of the channel at the level are written.
+     * @retval false The messages are discarded.
+     *
+     * @details
+     * A single load and test, intended to be checked before
+     * formatting; without @ref OS_USE_TRACE_CHANNELS all channels
+     * are always enabled.
+     *
+     * @ingroup cmsis-plus-diag
+     */
+    inline bool
+    __attribute__((always_inline))
+    enabled (channel ch, level lvl = level::debug)
+    {
+#if defined(OS_USE_TRACE_CHANNELS)
+      return (channels_masks_[static_cast<std::size_t> (lvl)] & ch) != 0;
+#else
+      (void) ch;
+      (void) lvl;
+      return true;
+#endif
+    }
+
+    /**
+     * @brief Write a formatted string, if the channel is enabled.
+     * @param [in] ch The channel.
+     * @param [in] lvl The message level.
+     * @param [in] format A null terminate string with the format.
+     * @param [in] args The arguments.
+     * @return A nonnegative number for success, 0 if disabled.
+     *
+     * @ingroup cmsis-plus-diag
+     */
+    template<typename ... Args>
+      inline int
+      printf (channel ch, level lvl, const char* format, Args ... args)
+      {
+        if (!enabled (ch, lvl))
+          {
+            return 0;
+          }
+        return os::trace::printf (format, args...);
+      }
+
+    /**
+     * @brief Write a debug formatted string, if the channel is enabled.
+     * @param [in] ch The channel.
+     * @param [in] format A null terminate string with the format.
+     * @param [in] args The arguments.
+     * @return A nonnegative number for success, 0 if disabled.
+     *
+     * @ingroup cmsis-plus-diag
+     */
+    template<typename ... Args>
+      inline int
+      printf (channel ch, const char* format, Args ... args)
+      {
+        return os::trace::printf (ch, level::debug, format, args...);
+      }
+
+    // ------------------------------------------------------------------------
+
     /**
      * @brief Insert a BKPT0 for debugger usage.
      */
@@ -216,10 +570,11 @@ extern "C"
   // ----- Portable -----
 
   int
-  trace_printf (const char* format, ...);
+  trace_printf (const char* format, ...) OS_ATTRIBUTE_PRINTF_FORMAT(1, 2);
 
   int
-  trace_vprintf (const char* format, va_list args);
+  trace_vprintf (const char* format, va_list args)
+      OS_ATTRIBUTE_PRINTF_FORMAT(1, 0);
 
   int
   trace_puts (const char* s);
@@ -255,10 +610,11 @@ namespace os
         // ----------------------------------------------------------------
 
         inline int
-        printf (const char* format, ...);
+        printf (const char* format, ...) OS_ATTRIBUTE_PRINTF_FORMAT(1, 2);
 
         inline int
-        vprintf (const char* format, std::va_list args);
+        vprintf (const char* format, std::va_list args)
+            OS_ATTRIBUTE_PRINTF_FORMAT(1, 0);
 
         inline int
         puts (const char* s);
@@ -320,6 +676,43 @@ namespace os
           {
           }
 
+        template<typename ... Args>
+          inline int __attribute__((always_inline))
+          bprintf (const char* format, Args ... args)
+            {
+              return 0;
+            }
+
+        inline void __attribute__((always_inline))
+        enable (uint32_t channels, level lvl = level::debug)
+          {
+          }
+
+        inline void __attribute__((always_inline))
+        disable (uint32_t channels)
+          {
+          }
+
+        inline bool __attribute__((always_inline))
+        enabled (channel ch, level lvl = level::debug)
+          {
+            return false;
+          }
+
+        template<typename ... Args>
+          inline int __attribute__((always_inline))
+          printf (channel ch, level lvl, const char* format, Args ... args)
+            {
+              return 0;
+            }
+
+        template<typename ... Args>
+          inline int __attribute__((always_inline))
+          printf (channel ch, const char* format, Args ... args)
+            {
+              return 0;
+            }
+
 #pragma GCC diagnostic pop
 
       } /* namespace trace */
@@ -343,10 +736,11 @@ extern "C"
     trace_flush (void);
 
     inline int
-    trace_printf (const char* format, ...);
+    trace_printf (const char* format, ...) OS_ATTRIBUTE_PRINTF_FORMAT(1, 2);
 
     inline int
-    trace_vprintf (const char* format, va_list args);
+    trace_vprintf (const char* format, va_list args)
+        OS_ATTRIBUTE_PRINTF_FORMAT(1, 0);
 
     inline int
     trace_puts (const char* s);
@@ -432,4 +826,33 @@ trace_dump_args (int argc, char* argv[])
 
 // ----------------------------------------------------------------------------
 
+#if defined(__cplusplus)
+
+/**
+ * @brief Write a trace message with the format stored apart.
+ * @details
+ * The format must be a string literal. On embedded platforms it is
+ * placed in the `.trace_fmt` section, which the linker script should
+ * keep out of the image, for example with
+ * `.trace_fmt 0 (INFO) : { KEEP(*(.trace_fmt)) }`;
+ * the host decoder reads it from the ELF file.
+ */
+#if defined(TRACE) && defined(__ARM_EABI__)
+#define OS_TRACE_BPRINTF(format, ...) \
+  do \
+    { \
+      static const char os_trace_fmt_[] \
+        __attribute__((section(".trace_fmt"), used)) = format; \
+      os::trace::bprintf (os_trace_fmt_, ##__VA_ARGS__); \
+    } \
+  while (0)
+#else
+#define OS_TRACE_BPRINTF(format, ...) \
+  os::trace::bprintf (format, ##__VA_ARGS__)
+#endif
+
+#endif /* defined(__cplusplus) */
+
+// ----------------------------------------------------------------------------
+
 #endif /* CMSIS_PLUS_DIAG_TRACE_H_ */
@@ -43,6 +43,8 @@
 #include <cstdint>
 #include <cstddef>
 
+struct iovec;
+
 namespace os
 {
   namespace driver
@@ -207,6 +209,11 @@ namespace os
         ///< Abort @ref Serial::transfer()
         abort_transfer = (0x1AUL << CONFIG_Pos),
 
+        ///< Make @ref Serial::receive() circular; when the buffer is
+        ///< full, reception continues from its start and
+        ///< @ref Serial::get_rx_count() returns the current position.
+        enable_receive_circular = (0x1BUL << CONFIG_Pos),
+
         ///< Disable Transmitter
         disable_tx = (0x25UL << CONFIG_Pos),
 
@@ -214,7 +221,10 @@ namespace os
         disable_rx = (0x26UL << CONFIG_Pos),
 
         ///< Disable Continuous Break transmission;
-        disable_break = (0x27UL << CONFIG_Pos)
+        disable_break = (0x27UL << CONFIG_Pos),
+
+        ///< Make @ref Serial::receive() stop when the buffer is full.
+        disable_receive_circular = (0x2BUL << CONFIG_Pos)
       };
 
       // --------------------------------------------------------------------
@@ -432,6 +442,12 @@ namespace os
 
         ///< RI  state changed (optional)
         ri = (1UL << 13),
+
+        ///< Half of the circular receive buffer filled (optional)
+        rx_half_complete = (1UL << 14),
+
+        ///< Receive line idle after a burst (optional)
+        rx_idle = (1UL << 15),
       };
 
       // ====================================================================
@@ -511,6 +527,16 @@ namespace os
 
         ///< Signal RI change event.
         bool event_ri :1;
+
+        ///< Circular receive (DMA) available.
+        bool circular_receive :1;
+
+        ///< Signal receive line idle event.
+        bool event_rx_idle :1;
+
+        ///< Descriptor lists transferred by DMA, without chaining
+        ///< the segments in software.
+        bool scatter_gather :1;
       };
 
 #pragma GCC diagnostic pop
@@ -593,6 +619,30 @@ namespace os
       return_t
       transfer (const void* data_out, void* data_in, std::size_t num) noexcept;
 
+      /**
+       * @brief       Start a scatter-gather transfer.
+       * @param [in] out  Array of segments to send, or `nullptr` to
+       *  only receive.
+       * @param [in] in   Array of segments to receive into, or
+       *  `nullptr` to only send.
+       * @param [in] count Number of segments.
+       * @return      Execution status
+       *
+       * @details
+       * When both arrays are given, the segments with the same index
+       * must have the same length. The completion event is signalled
+       * once, after the last segment, and the counts include all
+       * segments.
+       *
+       * Drivers with `scatter_gather` map the arrays onto DMA
+       * linked-list descriptors; for the others the segments are
+       * chained in software, from `signal_event()`, which must
+       * receive the driver events.
+       */
+      return_t
+      transfer_sg (const struct iovec* out, const struct iovec* in,
+                   std::size_t count) noexcept;
+
       /**
        * @brief       Get transmitted bytes count.
        * @return      number of bytes transmitted
@@ -696,6 +746,20 @@ namespace os
       virtual serial::Modem_status&
       do_get_modem_status (void) noexcept = 0;
 
+      // Chains the segments in software; drivers with
+      // DMA descriptors override it.
+      virtual return_t
+      do_transfer_sg (const struct iovec* out, const struct iovec* in,
+                      std::size_t count) noexcept;
+
+    private:
+
+      return_t
+      sg_start_ (void) noexcept;
+
+      event_t
+      sg_next_ (event_t event) noexcept;
+
     protected:
 
       /// Pointer to static function that implements the callback.
@@ -707,6 +771,15 @@ namespace os
       serial::Status status_;
       serial::Modem_status modem_status_;
 
+      // The software scatter-gather transfer in progress.
+      const struct iovec* sg_out_ = nullptr;
+      const struct iovec* sg_in_ = nullptr;
+      std::size_t sg_count_ = 0;
+      std::size_t sg_index_ = 0;
+      // Bytes of the completed segments.
+      std::size_t sg_tx_done_ = 0;
+      std::size_t sg_rx_done_ = 0;
+
     };
 
 #pragma GCC diagnostic pop
@@ -798,13 +871,13 @@ namespace os
     inline std::size_t
     Serial::get_tx_count (void) noexcept
     {
-      return do_get_tx_count ();
+      return sg_tx_done_ + do_get_tx_count ();
     }
 
     inline std::size_t
     Serial::get_rx_count (void) noexcept
     {
-      return do_get_rx_count ();
+      return sg_rx_done_ + do_get_rx_count ();
     }
 
     inline return_t
@@ -840,7 +913,12 @@ namespace os
     inline void /* __attribute__((always_inline)) */
     Serial::signal_event (event_t event) noexcept
     {
-      if (cb_func_ != nullptr)
+      if (sg_count_ != 0)
+        {
+          // Start the next segment, if any, and hide its completion.
+          event = sg_next_ (event);
+        }
+      if (event != 0 && cb_func_ != nullptr)
         {
           // Forward event to registered callback.
           cb_func_ (cb_object_, event);
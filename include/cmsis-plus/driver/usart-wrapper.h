@@ -77,6 +77,36 @@ namespace os
 
       // --------------------------------------------------------------------
 
+      /**
+       * @brief CMSIS callback bound at compile time to a handler.
+       * @tparam T Type of the handler object.
+       * @tparam Object Handler object, with static storage duration.
+       * @tparam Func Handler function, called with the object address.
+       * @param [in] event The CMSIS USART event.
+       * @return Nothing.
+       *
+       * @details
+       * An alternative to `register_callback()`; the address of an
+       * instance of this template is passed to the constructor as
+       * `c_cb_func`, and the CMSIS driver calls it directly from
+       * the interrupt. Since both the object and the function are
+       * template parameters, the handler can be inlined, avoiding
+       * the `cb_func_`/`cb_object_` indirection of `signal_event()`.
+       *
+       * @par Example
+       * @code{.cpp}
+       * extern my_handler handler;
+       * usart_wrapper usart2 { &Driver_USART2,
+       *   usart_wrapper::signal_event_static<my_handler, handler,
+       *     my_handler::signal_event> };
+       * @endcode
+       */
+      template<typename T, T& Object, signal_event_t Func>
+        static void
+        signal_event_static (uint32_t event) noexcept;
+
+      // --------------------------------------------------------------------
+
     protected:
 
       virtual const Version&
@@ -148,6 +178,15 @@ namespace os
 
 #pragma GCC diagnostic pop
 
+    // ======================================================================
+
+    template<typename T, T& Object, signal_event_t Func>
+      inline void
+      usart_wrapper::signal_event_static (uint32_t event) noexcept
+      {
+        Func (&Object, event);
+      }
+
   } /* namespace driver */
 } /* namespace os */
 
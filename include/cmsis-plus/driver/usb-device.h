@@ -76,6 +76,9 @@ namespace os
           ///< Signal VBUS Off event
           bool event_vbus_off :1;
 
+          ///< Endpoints accept a second transfer while one is active
+          bool double_buffering :1;
+
         };
 
 #pragma GCC diagnostic pop
@@ -181,6 +184,46 @@ namespace os
         (*signal_endpoint_event_t) (const void* object, endpoint_t ep_addr,
                                     event_t event);
 
+        // ==================================================================
+        // ----- USB Device Queued Transfers -----
+
+        ///< Number of endpoint numbers, each with IN and OUT.
+        constexpr std::size_t max_endpoints = 16;
+
+        /**
+         * @brief Queued endpoint transfer, owned by the caller until
+         *  it is returned by the completion callback.
+         */
+        struct Transfer
+        {
+          ///< Buffer for the data to read or with the data to write.
+          uint8_t* data;
+
+          ///< Number of bytes to transfer.
+          std::size_t num;
+
+          ///< Number of bytes actually transferred, set on completion.
+          std::size_t count;
+
+          ///< RETURN_OK, or the error of the aborted transfer.
+          return_t status;
+
+          ///< User data, passed through unchanged.
+          void* args;
+
+          ///< Managed by the driver.
+          Transfer* next;
+        };
+
+        /**
+         * @brief Type of completion callbacks; _done_ is the list of
+         *  the transfers completed since the previous call, linked
+         *  via `next`, in submission order.
+         */
+        typedef void
+        (*signal_transfers_t) (const void* object, endpoint_t ep_addr,
+                               Transfer* done);
+
       } /* namespace device */
 
       // ====================================================================
@@ -226,6 +269,16 @@ namespace os
         register_endpoint_callback (device::signal_endpoint_event_t cb_func,
                                     const void* cb_object = nullptr) noexcept;
 
+        /**
+         * @brief       Register the queued transfers completion callback.
+         * @param [in]   cb_func  Pointer to function.
+         * @param [in] cb_object Pointer to object passed to the function.
+         * @return      none
+         */
+        void
+        register_transfers_callback (device::signal_transfers_t cb_func,
+                                     const void* cb_object = nullptr) noexcept;
+
         // ------------------------------------------------------------------
 
         /**
@@ -354,6 +407,39 @@ namespace os
         return_t
         abort_transfer (endpoint_t ep_addr) noexcept;
 
+        /**
+         * @brief       Queue a transfer on an USB Endpoint.
+         * @param [in]   ep_addr  Endpoint Address
+         *                - ep_addr.0..3: Address
+         *                - ep_addr.7:    Direction
+         * @param [in]   xfer  Pointer to the transfer.
+         * @return      Execution status.
+         *
+         * @details
+         * The transfer is started immediately if the endpoint is idle
+         * (or, with double buffering, has only one active transfer),
+         * otherwise when the previous ones complete, from the endpoint
+         * interrupt, without waiting for the application. Completed
+         * transfers are returned via the transfers callback, instead
+         * of the `in`/`out` endpoint events.
+         */
+        return_t
+        queue_transfer (endpoint_t ep_addr, device::Transfer* xfer) noexcept;
+
+        /**
+         * @brief       Abort all queued transfers of an USB Endpoint.
+         * @param [in]   ep_addr  Endpoint Address
+         *                - ep_addr.0..3: Address
+         *                - ep_addr.7:    Direction
+         * @return      Execution status.
+         *
+         * @details
+         * The transfers are returned via the transfers callback,
+         * with `status` set to `ERROR`.
+         */
+        return_t
+        abort_queued_transfers (endpoint_t ep_addr) noexcept;
+
         /**
          * @brief       Signal device events.
          * @param [in]  event
@@ -421,6 +507,20 @@ namespace os
 
       private:
 
+        struct Queue
+        {
+          // Pending transfers; the first `active` ones are in hardware.
+          device::Transfer* head;
+          device::Transfer* tail;
+          std::size_t active;
+        };
+
+        Queue&
+        queue_ (endpoint_t ep_addr) noexcept;
+
+        void
+        start_queued_ (endpoint_t ep_addr, Queue& q) noexcept;
+
         /// Pointer to static function that implements the device callback.
         device::signal_device_event_t cb_device_func_;
 
@@ -433,6 +533,14 @@ namespace os
         /// Pointer to object instance associated with the endpoint callback.
         const void* cb_endpoint_object_;
 
+        /// Pointer to static function that implements the transfers callback.
+        device::signal_transfers_t cb_transfers_func_;
+
+        /// Pointer to object instance associated with the transfers callback.
+        const void* cb_transfers_object_;
+
+        Queue queues_[device::max_endpoints * 2];
+
       protected:
 
         device::Status status_;
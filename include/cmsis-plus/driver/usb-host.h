@@ -81,6 +81,9 @@ namespace os
 
           ///< Signal Overcurrent event
           bool event_overcurrent :1;
+
+          ///< Pipes accept a second transfer while one is active
+          bool chained_transfers :1;
         };
 
 #pragma GCC diagnostic pop
@@ -200,6 +203,49 @@ namespace os
         typedef void
         (*signal_pipe_event_t) (const void* object, pipe_t pipe, event_t event);
 
+        // ==================================================================
+        // ----- USB Host Queued Transfers -----
+
+        ///< Number of pipes that may have queued transfers at the same time.
+        constexpr std::size_t max_queued_pipes = 16;
+
+        /**
+         * @brief Queued pipe transfer, owned by the caller until
+         *  it is returned by the completion callback.
+         */
+        struct Transfer
+        {
+          ///< Packet information (token, data toggle, ...).
+          uint32_t packet;
+
+          ///< Buffer for the data to read or with the data to write.
+          uint8_t* data;
+
+          ///< Number of bytes to transfer.
+          std::size_t num;
+
+          ///< Number of bytes actually transferred, set on completion.
+          std::size_t count;
+
+          ///< RETURN_OK, or the error of the failed or aborted transfer.
+          return_t status;
+
+          ///< User data, passed through unchanged.
+          void* args;
+
+          ///< Managed by the driver.
+          Transfer* next;
+        };
+
+        /**
+         * @brief Type of completion callbacks; _done_ is the list of
+         *  the transfers completed since the previous call, linked
+         *  via `next`, in submission order.
+         */
+        typedef void
+        (*signal_transfers_t) (const void* object, pipe_t pipe,
+                               Transfer* done);
+
       } /* namespace host */
 
       // ====================================================================
@@ -244,6 +290,16 @@ namespace os
         register_pipe_callback (host::signal_pipe_event_t cb_func,
                                 const void* cb_object = nullptr) noexcept;
 
+        /**
+         * @brief       Register the queued transfers completion callback.
+         * @param [in]   cb_func  Pointer to function.
+         * @param [in] cb_object Pointer to object passed to the function.
+         * @return      none
+         */
+        void
+        register_transfers_callback (host::signal_transfers_t cb_func,
+                                     const void* cb_object = nullptr) noexcept;
+
         // ------------------------------------------------------------------
 
         const host::Capabilities&
@@ -292,6 +348,41 @@ namespace os
         return_t
         abort_transfer (pipe_t pipe) noexcept;
 
+        /**
+         * @brief       Queue transfers on a pipe.
+         * @param [in]   pipe  Pipe handle.
+         * @param [in]   xfers  Pointer to the first transfer of a list,
+         *  linked via `next`.
+         * @return      Execution status.
+         *
+         * @details
+         * The transfers are appended to the pipe queue, in order, so
+         * a class driver can submit a batch with a single call. The
+         * first one is started immediately if the pipe is idle (or,
+         * with chained transfers, has only one active transfer),
+         * the others when the previous ones complete, from the pipe
+         * interrupt, without waiting for the application. Completed
+         * transfers are returned via the transfers callback, instead
+         * of the `transfer_complete` pipe event.
+         *
+         * If all `max_queued_pipes` queues are in use by other pipes,
+         * return `ERROR_BUSY`.
+         */
+        return_t
+        queue_transfers (pipe_t pipe, host::Transfer* xfers) noexcept;
+
+        /**
+         * @brief       Abort all queued transfers of a pipe.
+         * @param [in]   pipe  Pipe handle.
+         * @return      Execution status.
+         *
+         * @details
+         * The transfers are returned via the transfers callback,
+         * with `status` set to `ERROR`.
+         */
+        return_t
+        abort_queued_transfers (pipe_t pipe) noexcept;
+
         uint16_t
         get_frame_number (void) noexcept;
 
@@ -355,6 +446,22 @@ namespace os
 
       private:
 
+        struct Queue
+        {
+          pipe_t pipe;
+          // Pending transfers; the first `active` ones are in hardware.
+          // The queue is free when empty.
+          host::Transfer* head;
+          host::Transfer* tail;
+          std::size_t active;
+        };
+
+        Queue*
+        queue_ (pipe_t pipe, bool create) noexcept;
+
+        void
+        start_queued_ (pipe_t pipe, Queue& q) noexcept;
+
         /// Pointer to static function that implements the port callback.
         host::signal_port_event_t cb_port_func_;
 
@@ -367,6 +474,14 @@ namespace os
         /// Pointer to object instance associated with the pipe callback.
         const void* cb_pipe_object_;
 
+        /// Pointer to static function that implements the transfers callback.
+        host::signal_transfers_t cb_transfers_func_;
+
+        /// Pointer to object instance associated with the transfers callback.
+        const void* cb_transfers_object_;
+
+        Queue queues_[host::max_queued_pipes];
+
       protected:
 
         host::Status status_;
@@ -459,12 +574,6 @@ namespace os
                                ep_max_packet_size);
       }
 
-      inline return_t
-      Host::delete_pipe (pipe_t pipe) noexcept
-      {
-        return do_delete_pipe (pipe);
-      }
-
       inline return_t
       Host::reset_pipe (pipe_t pipe) noexcept
       {
@@ -0,0 +1,304 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * The protocol follows the USB Mass Storage Class Bulk-Only
+ * Transport specification, Revision 1.0, with the SCSI commands
+ * used by the common hosts.
+ */
+
+#ifndef CMSIS_PLUS_DRIVER_USB_MSC_DEVICE_H_
+#define CMSIS_PLUS_DRIVER_USB_MSC_DEVICE_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+
+#include <cmsis-plus/driver/usb-device.h>
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstdint>
+#include <cstddef>
+
+namespace os
+{
+  namespace driver
+  {
+    namespace usb
+    {
+      // ====================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief USB Mass Storage device class, on a block device.
+       *
+       * @details
+       * The Bulk-Only Transport commands are served by `run()`,
+       * in the thread that calls it, directly from and to the
+       * block device; with a `block_device_cache`, the reads and
+       * writes go through the cache.
+       *
+       * The buffer passed to the constructor is split in two
+       * halves; multi-block `READ(10)` and `WRITE(10)` commands are
+       * pipelined with queued endpoint transfers, so one half is
+       * transferred on the bus while the other is read from or
+       * written to the block device.
+       *
+       * The class registers the transfers callback of the USB device;
+       * if other classes also use queued transfers, the application
+       * must register its own callback and pass the transfers of
+       * the MSC endpoints to `signal_transfers()`.
+       *
+       * The application handles the standard requests; after
+       * SET_CONFIGURATION it calls `configure()`, for the class
+       * requests it calls `reset()` and `max_lun()`, and after
+       * a CLEAR_FEATURE(ENDPOINT_HALT) on one of the endpoints it
+       * clears the stall with `Device::stall_endpoint()`.
+       */
+      class Msc_device
+      {
+      public:
+
+        // ------------------------------------------------------------------
+
+        /**
+         * @brief Construct the class.
+         * @param [in] device The USB device.
+         * @param [in] storage The block device, already opened.
+         * @param [in] ep_in The bulk IN endpoint address.
+         * @param [in] ep_out The bulk OUT endpoint address.
+         * @param [in] buffer Pointer to the transfer buffer, aligned
+         *  as required by the USB controller.
+         * @param [in] buffer_bytes The buffer size, at least two blocks.
+         */
+        Msc_device (Device& device, posix::block_device& storage,
+                    endpoint_t ep_in, endpoint_t ep_out, void* buffer,
+                    std::size_t buffer_bytes) noexcept;
+
+        Msc_device (const Msc_device&) = delete;
+
+        Msc_device (Msc_device&&) = delete;
+
+        Msc_device&
+        operator= (const Msc_device&) = delete;
+
+        Msc_device&
+        operator= (Msc_device&&) = delete;
+
+        ~Msc_device () noexcept;
+
+        // ------------------------------------------------------------------
+
+        /**
+         * @brief Set the INQUIRY strings.
+         * @param [in] vendor Up to 8 characters.
+         * @param [in] product Up to 16 characters.
+         * @param [in] revision Up to 4 characters.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        identification (const char* vendor, const char* product,
+                        const char* revision) noexcept;
+
+        /**
+         * @brief Configure the bulk endpoints.
+         * @param [in] max_packet_size The bulk max packet size,
+         *  64 for full speed, 512 for high speed.
+         * @return Execution status.
+         */
+        return_t
+        configure (packet_size_t max_packet_size) noexcept;
+
+        /**
+         * @brief Serve the commands, until `stop()`.
+         * @par Parameters
+         *  None.
+         * @retval RETURN_OK The class was stopped.
+         * @retval ERROR The block device cannot be used.
+         */
+        return_t
+        run (void) noexcept;
+
+        /**
+         * @brief Make `run()` return.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        stop (void) noexcept;
+
+        /**
+         * @brief Handle the Bulk-Only Mass Storage Reset request.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         *
+         * @details
+         * The transfers in progress are aborted and `run()`
+         * waits for the next command. It can be called from
+         * the control endpoint interrupt.
+         */
+        void
+        reset (void) noexcept;
+
+        /**
+         * @brief Get the answer to the Get Max LUN request.
+         * @par Parameters
+         *  None.
+         * @return The index of the last logical unit, always 0.
+         */
+        uint8_t
+        max_lun (void) const noexcept;
+
+        /**
+         * @brief Queued transfers completion callback.
+         * @param [in] object Pointer to the class instance.
+         * @param [in] ep_addr The endpoint address.
+         * @param [in] done The list of completed transfers.
+         * @par Returns
+         *  Nothing.
+         */
+        static void
+        signal_transfers (const void* object, endpoint_t ep_addr,
+                          device::Transfer* done) noexcept;
+
+        // ------------------------------------------------------------------
+
+      protected:
+
+        struct Slot
+        {
+          device::Transfer xfer;
+          volatile bool busy;
+          std::size_t blocks;
+        };
+
+        // The command block, in host order.
+        struct Command
+        {
+          uint32_t tag;
+          uint32_t length;
+          bool data_in;
+          uint8_t cb[16];
+        };
+
+        bool
+        receive_command_ (Command& cmd) noexcept;
+
+        uint8_t
+        execute_ (const Command& cmd, uint32_t* residue) noexcept;
+
+        uint8_t
+        send_response_ (const Command& cmd, std::size_t bytes,
+                        uint32_t* residue) noexcept;
+
+        uint8_t
+        read_ (const Command& cmd, uint32_t* residue) noexcept;
+
+        uint8_t
+        write_ (const Command& cmd, uint32_t* residue) noexcept;
+
+        void
+        send_status_ (uint32_t tag, uint32_t residue, uint8_t status) noexcept;
+
+        uint8_t
+        fail_ (uint8_t key, uint8_t asc) noexcept;
+
+        bool
+        queue_ (Slot& slot, endpoint_t ep_addr, uint8_t* data,
+                std::size_t num) noexcept;
+
+        bool
+        wait_ (Slot& slot) noexcept;
+
+        void
+        abort_ (void) noexcept;
+
+        // ------------------------------------------------------------------
+
+        Device& device_;
+        posix::block_device& storage_;
+
+        endpoint_t ep_in_;
+        endpoint_t ep_out_;
+
+        uint8_t* buffer_;
+        std::size_t buffer_bytes_;
+
+        // Data halves, and one slot for commands, statuses and
+        // short responses.
+        Slot slots_[2];
+        Slot cmd_slot_;
+
+        // Signalled on each completion, reset or stop.
+        rtos::semaphore_counting completed_
+          { "msc", 0x7FFF, 0 };
+
+        // Set from interrupts.
+        volatile bool stopped_ = false;
+        volatile bool reset_ = false;
+
+        // Cleared by REQUEST SENSE.
+        uint8_t sense_key_ = 0;
+        uint8_t sense_asc_ = 0;
+
+        const char* vendor_ = "uOS++";
+        const char* product_ = "Mass Storage";
+        const char* revision_ = "1.0";
+
+        // Commands, statuses and short responses; large enough
+        // for the INQUIRY data.
+        alignas(32) uint8_t cmd_buffer_[64];
+      };
+
+#pragma GCC diagnostic pop
+
+      // --------------------------------------------------------------------
+
+      inline uint8_t
+      Msc_device::max_lun (void) const noexcept
+      {
+        return 0;
+      }
+
+    } /* namespace usb */
+  } /* namespace driver */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_DRIVER_USB_MSC_DEVICE_H_ */
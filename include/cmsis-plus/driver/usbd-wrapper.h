@@ -80,6 +80,47 @@ namespace os
 
       // ----------------------------------------------------------------------
 
+      /**
+       * @brief CMSIS device callback bound at compile time to a handler.
+       * @tparam T Type of the handler object.
+       * @tparam Object Handler object, with static storage duration.
+       * @tparam Func Handler function, called with the object address.
+       * @param [in] event The CMSIS USBD device event.
+       * @return Nothing.
+       *
+       * @details
+       * Passed to the constructor as `c_cb_device_func`, instead of
+       * a function calling `signal_device_event()`; the handler
+       * is called directly and can be inlined.
+       */
+      template<typename T, T& Object, usb::device::signal_device_event_t Func>
+        static void
+        signal_device_event_static (uint32_t event) noexcept;
+
+      /**
+       * @brief CMSIS endpoint callback bound at compile time to a handler.
+       * @tparam T Type of the handler object.
+       * @tparam Object Handler object, with static storage duration.
+       * @tparam Func Handler function, called with the object address.
+       * @param [in] ep_addr The endpoint address.
+       * @param [in] event The CMSIS USBD endpoint event.
+       * @return Nothing.
+       *
+       * @details
+       * Passed to the constructor as `c_cb_endpoint_func`, instead of
+       * a function calling `signal_endpoint_event()`.
+       *
+       * @warning This path bypasses `signal_endpoint_event()`, so
+       * transfers submitted with `queue_transfer()` are not advanced;
+       * do not combine the two.
+       */
+      template<typename T, T& Object,
+          usb::device::signal_endpoint_event_t Func>
+        static void
+        signal_endpoint_event_static (uint8_t ep_addr, uint32_t event) noexcept;
+
+      // ----------------------------------------------------------------------
+
     protected:
 
       virtual const Version&
@@ -146,6 +187,11 @@ namespace os
       ARM_USBD_SignalDeviceEvent_t c_cb_device_func_;
       ARM_USBD_SignalEndpointEvent_t c_cb_endpoint_func_;
 
+      /// The buffers of the OUT transfers in progress, invalidated
+      /// when the transfer count is read.
+      uint8_t* rx_data_[usb::ENDPOINT_NUMBER_MASK + 1]
+        { };
+
       // Attempts to somehow use && failed, since the Keil driver
       // functions return temporary objects. So the only portable
       // solution was to copy these objects here and return
@@ -162,6 +208,23 @@ namespace os
 
 #pragma GCC diagnostic pop
 
+    // ========================================================================
+
+    template<typename T, T& Object, usb::device::signal_device_event_t Func>
+      inline void
+      usbd_wrapper::signal_device_event_static (uint32_t event) noexcept
+      {
+        Func (&Object, event);
+      }
+
+    template<typename T, T& Object, usb::device::signal_endpoint_event_t Func>
+      inline void
+      usbd_wrapper::signal_endpoint_event_static (uint8_t ep_addr,
+                                                  uint32_t event) noexcept
+      {
+        Func (&Object, ep_addr, event);
+      }
+
   } /* namespace driver */
 } /* namespace os */
 
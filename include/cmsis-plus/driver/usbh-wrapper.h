@@ -83,6 +83,44 @@ namespace os
 
       // --------------------------------------------------------------------
 
+      /**
+       * @brief CMSIS port callback bound at compile time to a handler.
+       * @tparam T Type of the handler object.
+       * @tparam Object Handler object, with static storage duration.
+       * @tparam Func Handler function, called with the object address.
+       * @param [in] port The root hub port number.
+       * @param [in] event The CMSIS USBH port event.
+       * @return Nothing.
+       *
+       * @details
+       * Passed to the constructor as `c_cb_port_func`, instead of
+       * a function calling `signal_port_event()`; the handler
+       * is called directly and can be inlined.
+       */
+      template<typename T, T& Object, usb::host::signal_port_event_t Func>
+        static void
+        signal_port_event_static (uint8_t port, uint32_t event) noexcept;
+
+      /**
+       * @brief CMSIS pipe callback bound at compile time to a handler.
+       * @tparam T Type of the handler object.
+       * @tparam Object Handler object, with static storage duration.
+       * @tparam Func Handler function, called with the object address.
+       * @param [in] pipe_hndl The pipe handle.
+       * @param [in] event The CMSIS USBH pipe event.
+       * @return Nothing.
+       *
+       * @details
+       * Passed to the constructor as `c_cb_pipe_func`, instead of
+       * a function calling `signal_pipe_event()`.
+       */
+      template<typename T, T& Object, usb::host::signal_pipe_event_t Func>
+        static void
+        signal_pipe_event_static (ARM_USBH_PIPE_HANDLE pipe_hndl,
+                                  uint32_t event) noexcept;
+
+      // --------------------------------------------------------------------
+
     protected:
 
       virtual const Version&
@@ -153,6 +191,15 @@ namespace os
       ARM_USBH_SignalPortEvent_t c_cb_port_func_;
       ARM_USBH_SignalPipeEvent_t c_cb_pipe_func_;
 
+      /// The buffers of the IN transfers in progress, invalidated
+      /// when the transfer count is read.
+      struct
+      {
+        usb::pipe_t pipe;
+        uint8_t* data;
+      } rx_data_[16]
+        { };
+
       // Attempts to somehow use && failed, since the Keil driver
       // functions return temporary objects. So the only portable
       // solution was to copy these objects here and return
@@ -169,6 +216,24 @@ namespace os
 
 #pragma GCC diagnostic pop
 
+    // ======================================================================
+
+    template<typename T, T& Object, usb::host::signal_port_event_t Func>
+      inline void
+      usbh_wrapper::signal_port_event_static (uint8_t port,
+                                              uint32_t event) noexcept
+      {
+        Func (&Object, port, event);
+      }
+
+    template<typename T, T& Object, usb::host::signal_pipe_event_t Func>
+      inline void
+      usbh_wrapper::signal_pipe_event_static (ARM_USBH_PIPE_HANDLE pipe_hndl,
+                                              uint32_t event) noexcept
+      {
+        Func (&Object, pipe_hndl, event);
+      }
+
   } /* namespace driver */
 } /* namespace os */
 
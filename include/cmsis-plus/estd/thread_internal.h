@@ -463,8 +463,8 @@ namespace this_thread
 
       if (rel_time > duration<Rep_T, Period_T>::zero ())
         {
-          sleep_rep d = static_cast<sleep_rep> (os::estd::chrono::ceil<
-              typename clock::duration> (rel_time).count ());
+          sleep_rep d = static_cast<sleep_rep> (os::estd::chrono::ceil_count<
+              typename clock::duration> (rel_time));
 
           clock::sleep_for (d);
         }
@@ -507,8 +507,8 @@ namespace this_thread
       auto now = clock::now ();
       while (now < abs_time)
         {
-          typename clock::sleep_rep d = (os::estd::chrono::ceil<
-              typename clock::sleep_duration> (abs_time - now)).count ();
+          typename clock::sleep_rep d = os::estd::chrono::ceil_count<
+              typename clock::sleep_duration> (abs_time - now);
           clock::sleep_for (d);
           now = clock::now ();
         }
@@ -531,8 +531,8 @@ namespace this_thread
       auto now = clock::now ();
       while (now < abs_time)
         {
-          typename clock::sleep_rep d = (os::estd::chrono::ceil<
-              typename clock::sleep_duration> (abs_time - now)).count ();
+          typename clock::sleep_rep d = os::estd::chrono::ceil_count<
+              typename clock::sleep_duration> (abs_time - now);
           clock::sleep_for (d);
           now = clock::now ();
         }
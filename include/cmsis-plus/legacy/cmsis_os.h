@@ -217,10 +217,12 @@ extern "C"
   typedef os_mqueue_t osMessageQ;
   typedef os_mqueue_attr_t osMessageQAttr;
 
+  // The mail blocks are allocated from the pool and
+  // their addresses are passed through the mailbox.
   typedef struct os_mail_queue_s
   {
     os_mempool_t pool;
-    os_mqueue_t queue;
+    os_mailbox_t mailbox;
   } os_mail_queue_t;
 
   typedef os_mail_queue_t osMailQ;
@@ -1189,8 +1191,6 @@ struct { \
     } pool_storage; \
     struct { \
       void* queue[items]; \
-      os_mqueue_index_t links[2 * items]; \
-      os_mqueue_prio_t prios[items]; \
     } queue_storage; \
 } os_mailQ_##name; \
 const osMailQDef_t os_mailQ_def_##name = { \
@@ -1200,8 +1200,8 @@ const osMailQDef_t os_mailQ_def_##name = { \
     sizeof (void*), \
     0, \
     0, \
-    0, \
-    0, \
+    &os_mailQ_##name.queue_storage, \
+    sizeof(os_mailQ_##name.queue_storage), \
     &os_mailQ_##name.data \
 }
 #define osMailQStaticDef(name, items, type) \
@@ -1212,8 +1212,6 @@ struct { \
     } pool_storage; \
     struct { \
       void* queue[items]; \
-      os_mqueue_index_t links[2 * items]; \
-      os_mqueue_prio_t prios[items]; \
     } queue_storage; \
 } os_mailQ_##name; \
 const osMailQDef_t os_mailQ_def_##name = { \
@@ -58,6 +58,12 @@ namespace os
      * The only drawback is that the maximum number of objects must be
      * known before the first allocations, but usually this is
      * not a problem.
+     *
+     * When `OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE` is defined, the
+     * free blocks are kept in a lock free list, and allocations and
+     * deallocations can be performed from interrupt handlers
+     * without masking interrupts; the maximum allocated size
+     * is then only approximate.
      */
     class block_pool : public rtos::memory::memory_resource
     {
@@ -185,6 +191,16 @@ namespace os
       virtual std::size_t
       do_max_size (void) const noexcept override;
 
+      /**
+       * @brief Implementation of the function to get the size
+       *  of the largest free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes, or 0 if none.
+       */
+      virtual std::size_t
+      do_max_free_chunk (void) noexcept override;
+
       /**
        * @brief Implementation of the function to reset the memory manager.
        * @par Parameters
@@ -211,11 +227,22 @@ namespace os
        */
       void* pool_addr_ = nullptr;
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      /**
+       * @brief The list of free blocks.
+       */
+      rtos::internal::free_list free_list_;
+
+#else
+
       /**
        * @brief Pointer to the first free block, or nullptr.
        */
       void* volatile first_ = nullptr;
 
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
       /**
        * @brief The number of blocks in the pool.
        */
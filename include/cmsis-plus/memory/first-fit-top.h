@@ -53,8 +53,16 @@ namespace os
      * This memory manager was inspired by the **newlib nano**
      * implementation of `malloc()` & `free()`.
      *
-     * Neither allocation nor deallocation are deterministic, but are
-     * reasonably fast.
+     * Free chunks are kept in segregated lists, one for each power of
+     * two size range, with a bitmap of the non empty lists; the search
+     * starts with the list of the requested size, and is limited to
+     * this list.
+     *
+     * The chunks use boundary tags, so deallocation coalesces the
+     * adjacent free chunks without walking any list, in constant time.
+     *
+     * Allocation is not strictly deterministic, but the search
+     * time is bounded by the number of chunks of the same size range.
      */
     class first_fit_top : public rtos::memory::memory_resource
     {
@@ -122,6 +130,26 @@ namespace os
        * @}
        */
 
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Get the number of bytes lost to alignment.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes.
+       */
+      std::size_t
+      alignment_lost_bytes (void) const noexcept;
+
+      /**
+       * @}
+       */
+
     protected:
 
       /**
@@ -132,20 +160,24 @@ namespace os
 #pragma GCC diagnostic ignored "-Wpadded"
 
       // A 'chunk' is where the user block resides; it keeps track of size,
-      // it accommodates alignment and helps maintain the free list.
+      // it accommodates alignment and helps maintain the free lists.
       typedef struct chunk_s
       {
         // The actual chunk size, in bytes;
         // the next chunk starts exactly after this number of bytes.
         // This is the only overhead that applies to all allocated blocks.
+        // The lowest bits are flags (chunk_free_bit, chunk_prev_free_bit).
         std::size_t size;
 
         // For allocated chunks, here, or at the next address that
         // satisfies the required alignment, starts the payload.
 
-        // When the chunk is in the free list, instead of the
-        // payload, here is a pointer to the next chunk.
+        // When the chunk is in a free list, instead of the
+        // payload, here are the pointers to the next and previous
+        // chunks in the list; the last word of a free chunk
+        // is a copy of the size (the boundary tag).
         struct chunk_s* next;
+        struct chunk_s* prev;
       } chunk_t;
 
 #pragma GCC diagnostic pop
@@ -187,6 +219,48 @@ namespace os
       void*
       internal_align_ (chunk_t* chunk, std::size_t bytes, std::size_t alignment);
 
+      /**
+       * @brief Internal function to link a free chunk to its list.
+       * @param [in] chunk Pointer to chunk.
+       * @param [in] size Size of chunk, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_insert_free_ (chunk_t* chunk, std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to unlink a free chunk from its list.
+       * @param [in] chunk Pointer to chunk.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_remove_free_ (chunk_t* chunk) noexcept;
+
+      /**
+       * @brief Internal function to split the top part of a chunk.
+       * @param [in] chunk Pointer to chunk, already removed from the list.
+       * @param [in] alloc_size The size of the top part.
+       * @param [in] minchunk The minimum size of the remaining part.
+       * @return Pointer to the allocated chunk.
+       */
+      chunk_t*
+      internal_split_top_ (chunk_t* chunk, std::size_t alloc_size,
+                           std::size_t minchunk) noexcept;
+
+      /**
+       * @brief Internal function to carve an aligned chunk.
+       * @param [in] chunk Pointer to chunk, already removed from the list.
+       * @param [in] alloc_size The size of the aligned chunk.
+       * @param [in] alignment Power of two.
+       * @return Pointer to the allocated chunk, or `nullptr` if
+       *  the chunk cannot be carved.
+       */
+      chunk_t*
+      internal_carve_aligned_ (chunk_t* chunk, std::size_t alloc_size,
+                               std::size_t alignment) noexcept;
+
       /**
        * @brief Implementation of the memory allocator.
        * @param [in] bytes Number of bytes to allocate.
@@ -217,6 +291,16 @@ namespace os
       virtual std::size_t
       do_max_size (void) const noexcept override;
 
+      /**
+       * @brief Implementation of the function to get the size
+       *  of the largest free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes, or 0 if none.
+       */
+      virtual std::size_t
+      do_max_free_chunk (void) noexcept override;
+
       /**
        * @brief Implementation of the function to reset the memory manager.
        * @par Parameters
@@ -227,6 +311,69 @@ namespace os
       virtual void
       do_reset (void) noexcept override;
 
+      /**
+       * @brief Implementation of the function to resize a block in place.
+       * @param [in] addr Address of a previously allocated block.
+       * @param [in] bytes Number of bytes originally requested
+       *  (may be 0 if unknown).
+       * @param [in] new_bytes The new number of bytes.
+       * @retval true The block was resized.
+       * @retval false The block cannot be resized in place.
+       */
+      virtual bool
+      do_try_resize (void* addr, std::size_t bytes, std::size_t new_bytes)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to verify the
+       *  integrity of the managed chunks.
+       * @param [in] chunks Maximum number of chunks to check.
+       * @return Address of the first damaged chunk, or `nullptr`.
+       */
+      virtual const void*
+      do_verify (std::size_t chunks) noexcept override;
+
+      /**
+       * @brief Internal function to check a chunk and its neighbours.
+       * @param [in] chunk Pointer to chunk.
+       * @retval true The chunk is consistent.
+       * @retval false The chunk is damaged.
+       */
+      bool
+      internal_verify_chunk_ (const chunk_t* chunk) const noexcept;
+
+      /**
+       * @brief Internal function to keep the verify position valid
+       *  when a chunk is merged into the chunk before it.
+       * @param [in] removed Pointer to the chunk that is merged.
+       * @param [in] survivor Pointer to the resulting chunk.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_verify_merge_ (const chunk_t* removed,
+                              chunk_t* survivor) noexcept;
+
+      /**
+       * @brief Internal function to write the guard word of an
+       *  allocated chunk.
+       * @param [in] chunk Pointer to chunk.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_set_guard_ (chunk_t* chunk) noexcept;
+
+      /**
+       * @brief Internal function to check the guard word of an
+       *  allocated chunk.
+       * @param [in] chunk Pointer to chunk.
+       * @retval true The guard word is intact, or not used.
+       * @retval false The guard word was overwritten.
+       */
+      bool
+      internal_check_guard_ (const chunk_t* chunk) const noexcept;
+
       /**
        * @}
        */
@@ -240,10 +387,43 @@ namespace os
       // Offset of payload inside the chunk.
       static constexpr std::size_t chunk_offset = offsetof(chunk_t, next);
       static constexpr std::size_t chunk_align = sizeof(void*);
-      static constexpr std::size_t chunk_minsize = sizeof(chunk_t);
+      // Free chunks must fit the list links and the boundary tag.
+      static constexpr std::size_t chunk_minsize = sizeof(chunk_t)
+          + sizeof(std::size_t);
 
       static constexpr std::size_t block_minsize = sizeof(void *);
 
+      // Flags stored in the lowest bits of the chunk size.
+      static constexpr std::size_t chunk_free_bit = 1;
+      static constexpr std::size_t chunk_prev_free_bit = 2;
+      static constexpr std::size_t chunk_flags_mask = (chunk_free_bit
+          | chunk_prev_free_bit);
+
+#if defined(OS_INCLUDE_MEMORY_GUARD_WORDS)
+      // The last word of each allocated chunk, after the payload.
+      static constexpr std::size_t guard_size = sizeof(std::size_t);
+#else
+      static constexpr std::size_t guard_size = 0;
+#endif
+      static constexpr std::size_t guard_magic =
+          static_cast<std::size_t> (0xFEEDFACEDEADBEEFULL);
+
+      // One free list for each power of two.
+      static constexpr std::size_t bins_count = 32;
+
+      static constexpr std::size_t max_free_unknown =
+          ~static_cast<std::size_t> (0);
+
+      static constexpr std::size_t
+      chunk_size (const chunk_t* chunk)
+      {
+        return chunk->size & ~chunk_flags_mask;
+      }
+
+      // The index of the free list for a given size.
+      static std::size_t
+      bin_index (std::size_t size) noexcept;
+
       // Extra padding from chunk to block.
       static constexpr std::size_t
       calc_block_padding (std::size_t block_align)
@@ -255,13 +435,28 @@ namespace os
       static constexpr std::size_t
       calc_block_minchunk (std::size_t block_padding)
       {
-        return chunk_offset + block_minsize + block_padding;
+        return os::rtos::memory::max (
+            chunk_offset + block_minsize + block_padding, chunk_minsize);
       }
 
       void* arena_addr_ = nullptr;
       // No need for arena_size_bytes_, use total_bytes_.
 
-      chunk_t* free_list_ = nullptr;
+      // Bitmap of non empty free lists.
+      uint32_t bins_bitmap_ = 0;
+
+      // Heads of the free lists.
+      chunk_t* bins_[bins_count];
+
+      // The size of the largest free chunk, or max_free_unknown
+      // if it must be recomputed.
+      std::size_t max_free_size_ = 0;
+
+      // The bytes allocated in excess for aligned blocks, since reset.
+      std::size_t alignment_lost_bytes_ = 0;
+
+      // The next chunk to be checked by verify().
+      chunk_t* verify_next_ = nullptr;
 
       /**
        * @endcond
@@ -512,6 +707,12 @@ namespace os
       internal_construct_ (addr, bytes);
     }
 
+    inline std::size_t
+    first_fit_top::alignment_lost_bytes (void) const noexcept
+    {
+      return alignment_lost_bytes_;
+    }
+
     // ========================================================================
 
     template<std::size_t N>
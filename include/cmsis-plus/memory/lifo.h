@@ -53,21 +53,13 @@ namespace os
      * This memory manager is a variant of `first_fit_top` that
      * guarantees a deterministic, fragmentation free, allocation.
      *
-     * Deallocation is guaranteed to be deterministic only when
-     * deallocating the last allocated block (strict LIFO policy).
+     * Deallocation is deterministic, the freed chunks are
+     * coalesced with their neighbours using the boundary tags.
      *
-     * However this class does not enforce the strict LIFO policy,
-     * deallocating older block is allowed, but generally it is
-     * no longer deterministic, since a traversal of the free list
-     * is required. On the other side, with block always allocated
-     * from top to down, and the free list ordered, deallocating
-     * older block is predictable if the age of the block
-     * is known, in other words deallocating the last allocated block
-     * inserts it after the head block, deallocating the second last
-     * allocated block inserts it before the second element in the list,
-     * and generally deallocating the n-th last allocated block
-     * inserts it somewhere up to the n-th element in the free list,
-     * possibly sooner, so the behaviour is somehow deterministic.
+     * The strict LIFO policy is not enforced; deallocating older
+     * blocks is allowed, but the memory is not reused until all more
+     * recently allocated blocks are freed, and the first chunk
+     * grows back.
      *
      * This memory manager is ideal for one-time allocations of
      * objects during startup, objects to be kept alive for the
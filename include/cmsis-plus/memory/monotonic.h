@@ -0,0 +1,548 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_MONOTONIC_H_
+#define CMSIS_PLUS_MEMORY_MONOTONIC_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the monotonic allocation
+     *  policy, using an existing arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile monotonic.h <cmsis-plus/memory/monotonic.h>
+     *
+     * @details
+     * This memory manager is similar to the standard
+     * `std::pmr::monotonic_buffer_resource`; allocation is a simple
+     * pointer increment, and deallocation has no effect.
+     *
+     * The memory is reclaimed in bulk, either entirely, with `release()`,
+     * or back to a previously remembered position, with `mark()`
+     * and `release_to()`.
+     *
+     * When the arena is exhausted, additional buffers are requested
+     * from the upstream memory resource, if any, with geometrically
+     * increasing sizes; they are returned when released.
+     *
+     * The common use case is to allocate temporary objects for a
+     * single request, using `estd::pmr::polymorphic_allocator<T>`, and
+     * release them all at once at the end of the request.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * char buf[512];
+     * os::memory::monotonic mr { buf, sizeof(buf) };
+     *
+     * auto m = mr.mark ();
+     *   {
+     *     estd::pmr::polymorphic_allocator<int> a { &mr };
+     *     std::vector<int, estd::pmr::polymorphic_allocator<int>> v { a };
+     *     // ...
+     *   }
+     * mr.release_to (m);
+     * @endcode
+     */
+    class monotonic : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @brief Type of a position in the arena.
+       * @details
+       * An opaque object, returned by `mark()` and used by
+       * `release_to()`.
+       */
+      typedef struct
+      {
+        /**
+         * @cond ignore
+         */
+
+        void* buffer;
+        char* position;
+        std::size_t allocated_bytes;
+        std::size_t allocated_chunks;
+
+        /**
+         * @endcond
+         */
+      } mark_t;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @param [in] upstream Pointer to the memory resource used
+       *  when the arena is exhausted, or `nullptr`.
+       */
+      monotonic (void* addr, std::size_t bytes,
+                 rtos::memory::memory_resource* upstream = nullptr);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @param [in] upstream Pointer to the memory resource used
+       *  when the arena is exhausted, or `nullptr`.
+       */
+      monotonic (const char* name, void* addr, std::size_t bytes,
+                 rtos::memory::memory_resource* upstream = nullptr);
+
+    protected:
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       */
+      monotonic (const char* name);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      monotonic (const monotonic&) = delete;
+      monotonic (monotonic&&) = delete;
+      monotonic&
+      operator= (const monotonic&) = delete;
+      monotonic&
+      operator= (monotonic&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~monotonic () override;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Remember the current position.
+       * @par Parameters
+       *  None.
+       * @return An opaque object, to be passed to `release_to()`.
+       */
+      mark_t
+      mark (void) const noexcept;
+
+      /**
+       * @brief Release all memory allocated after a mark.
+       * @param [in] m A position previously returned by `mark()`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      release_to (const mark_t& m) noexcept;
+
+      /**
+       * @brief Release all allocated memory.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      release (void) noexcept;
+
+      /**
+       * @brief Get the upstream memory resource.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the upstream memory resource, or `nullptr`.
+       */
+      rtos::memory::memory_resource*
+      upstream_resource (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // Header of the buffers allocated from upstream.
+      typedef struct buffer_s
+      {
+        // The previously used buffer, or nullptr for the arena.
+        struct buffer_s* prev;
+
+        // The buffer size, in bytes, including this header.
+        std::size_t size;
+      } buffer_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to construct the memory resource.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @param [in] upstream Pointer to the memory resource used
+       *  when the arena is exhausted, or `nullptr`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_construct_ (void* addr, std::size_t bytes,
+                           rtos::memory::memory_resource* upstream);
+
+      /**
+       * @brief Internal function to get a new buffer from upstream.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @retval true A new buffer is available.
+       * @retval false The upstream allocation failed.
+       */
+      bool
+      internal_grow_ (std::size_t bytes, std::size_t alignment);
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      void* arena_addr_ = nullptr;
+      // No need for arena_size_bytes_, use total_bytes_.
+
+      rtos::memory::memory_resource* upstream_ = nullptr;
+
+      // The current upstream buffer, or nullptr for the arena.
+      buffer_t* buffer_ = nullptr;
+
+      // The next free byte and the end of the current buffer.
+      char* position_ = nullptr;
+      char* end_ = nullptr;
+
+      // The size of the last buffer, used to compute the next one.
+      std::size_t next_buffer_size_ = 0;
+
+      /**
+       * @endcond
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the monotonic allocation
+     *  policy, using an internal arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile monotonic.h <cmsis-plus/memory/monotonic.h>
+     *
+     * @details
+     * This class template is a convenience class that includes
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define local memory managers,
+     * for example on the stack of a thread processing requests.
+     */
+    template<std::size_t N>
+      class monotonic_inclusive : public monotonic
+      {
+      public:
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t bytes = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] upstream Pointer to the memory resource used
+         *  when the arena is exhausted, or `nullptr`.
+         */
+        monotonic_inclusive (rtos::memory::memory_resource* upstream =
+                                 nullptr);
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] upstream Pointer to the memory resource used
+         *  when the arena is exhausted, or `nullptr`.
+         */
+        monotonic_inclusive (const char* name,
+                             rtos::memory::memory_resource* upstream =
+                                 nullptr);
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        monotonic_inclusive (const monotonic_inclusive&) = delete;
+        monotonic_inclusive (monotonic_inclusive&&) = delete;
+        monotonic_inclusive&
+        operator= (const monotonic_inclusive&) = delete;
+        monotonic_inclusive&
+        operator= (monotonic_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~monotonic_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The allocation arena is an array of bytes.
+         */
+        char arena_[bytes];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+
+  namespace estd
+  {
+    namespace pmr
+    {
+      /**
+       * @brief Standard name for the monotonic memory resource.
+       * @ingroup cmsis-plus-rtos-memres
+       */
+      using monotonic_buffer_resource = memory::monotonic;
+
+    } /* namespace pmr */
+  } /* namespace estd */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    monotonic::monotonic (const char* name) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      ;
+    }
+
+    inline
+    monotonic::monotonic (void* addr, std::size_t bytes,
+                          rtos::memory::memory_resource* upstream) :
+        monotonic
+          { nullptr, addr, bytes, upstream }
+    {
+      ;
+    }
+
+    inline
+    monotonic::monotonic (const char* name, void* addr, std::size_t bytes,
+                          rtos::memory::memory_resource* upstream) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, addr, bytes, this,
+                     this->name ());
+
+      internal_construct_ (addr, bytes, upstream);
+    }
+
+    /**
+     * @details
+     * Deterministic, it only copies the current position.
+     */
+    inline monotonic::mark_t
+    monotonic::mark (void) const noexcept
+    {
+      return mark_t
+        { buffer_, position_, allocated_bytes_, allocated_chunks_ };
+    }
+
+    inline rtos::memory::memory_resource*
+    monotonic::upstream_resource (void) const
+    {
+      return upstream_;
+    }
+
+    // ========================================================================
+
+    template<std::size_t N>
+      inline
+      monotonic_inclusive<N>::monotonic_inclusive (
+          rtos::memory::memory_resource* upstream) :
+          monotonic_inclusive (nullptr, upstream)
+      {
+        ;
+      }
+
+    template<std::size_t N>
+      inline
+      monotonic_inclusive<N>::monotonic_inclusive (
+          const char* name, rtos::memory::memory_resource* upstream) :
+          monotonic
+            { name }
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        internal_construct_ (&arena_[0], bytes, upstream);
+      }
+
+    template<std::size_t N>
+      monotonic_inclusive<N>::~monotonic_inclusive ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_MONOTONIC_H_ */
@@ -0,0 +1,654 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_POOL_H_
+#define CMSIS_PLUS_MEMORY_POOL_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/memory/block-pool.h>
+
+#include <mutex>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Configuration of the pool memory resources.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile pool.h <cmsis-plus/memory/pool.h>
+     *
+     * @details
+     * Similar to the standard `std::pmr::pool_options`.
+     */
+    struct pool_options
+    {
+      /**
+       * @brief The maximum number of blocks allocated
+       *  at once from upstream.
+       */
+      std::size_t max_blocks_per_chunk = 32;
+
+      /**
+       * @brief The largest block size served from the pools;
+       *  larger requests go directly upstream.
+       */
+      std::size_t largest_required_pool_block = 256;
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource keeping pools of blocks of
+     *  several sizes, with chunks grown from an upstream resource.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile pool.h <cmsis-plus/memory/pool.h>
+     *
+     * @details
+     * This memory manager is similar to the standard
+     * `std::pmr::unsynchronized_pool_resource`.
+     *
+     * Requests are served by the pool with the smallest power of 2
+     * block size that fits both the size and the alignment; each pool
+     * is a list of `block_pool` chunks, allocated from the upstream
+     * memory resource when all existing chunks are full. The number
+     * of blocks of each new chunk is doubled, up to
+     * `max_blocks_per_chunk`.
+     *
+     * Requests larger than `largest_required_pool_block` are
+     * forwarded to the upstream memory resource.
+     *
+     * Chunks are not returned to upstream when their blocks are
+     * freed, but only by `release()`, `reset()` or when the object
+     * is destroyed.
+     *
+     * The common use case is for standard containers with many
+     * small nodes, like `std::map` or `std::list`, which would
+     * otherwise fragment the application free store.
+     *
+     * This class is not thread safe; for use from multiple threads,
+     * use `pool_synchronized`.
+     */
+    class pool : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @brief The maximum number of pools.
+       */
+      static constexpr std::size_t max_pools = 16;
+
+      /**
+       * @brief The size of the blocks of the first pool.
+       */
+      static constexpr std::size_t min_block_size_bytes = 2 * sizeof(void*);
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] opts Reference to the configuration.
+       * @param [in] upstream Pointer to the memory resource used
+       *  to allocate the chunks, or `nullptr` for the default resource.
+       */
+      pool (const pool_options& opts = pool_options
+              { },
+            rtos::memory::memory_resource* upstream = nullptr);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] opts Reference to the configuration.
+       * @param [in] upstream Pointer to the memory resource used
+       *  to allocate the chunks, or `nullptr` for the default resource.
+       */
+      pool (const char* name, const pool_options& opts = pool_options
+              { },
+            rtos::memory::memory_resource* upstream = nullptr);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pool (const pool&) = delete;
+      pool (pool&&) = delete;
+      pool&
+      operator= (const pool&) = delete;
+      pool&
+      operator= (pool&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~pool () override;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Return all chunks to the upstream memory resource.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      release (void) noexcept;
+
+      /**
+       * @brief Get the configuration.
+       * @par Parameters
+       *  None.
+       * @return The actual configuration, after adjustments.
+       */
+      pool_options
+      options (void) const;
+
+      /**
+       * @brief Get the upstream memory resource.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the upstream memory resource.
+       */
+      rtos::memory::memory_resource*
+      upstream_resource (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // Header of the chunks allocated from upstream, followed
+      // by the blocks.
+      typedef struct chunk_s
+      {
+        // The next chunk of the same pool.
+        struct chunk_s* next;
+
+        // The chunk size, in bytes, including this header.
+        std::size_t size;
+
+        // The block pool, constructed in place.
+        typename std::aligned_storage<sizeof(block_pool), alignof(block_pool)>::type storage;
+      } chunk_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Get the block pool of a chunk.
+       * @param [in] chunk Pointer to chunk.
+       * @return Reference to the block pool.
+       */
+      static block_pool&
+      chunk_pool (chunk_t* chunk);
+
+      /**
+       * @brief Internal function to select the pool for a request.
+       * @param [in] bytes Number of bytes.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return The pool index, or `pools_count_` if the request
+       *  must be forwarded upstream.
+       */
+      std::size_t
+      internal_pool_index_ (std::size_t bytes, std::size_t alignment) const
+          noexcept;
+
+      /**
+       * @brief Internal function to find the chunk owning a block.
+       * @param [in] index The pool index.
+       * @param [in] addr Address of the block.
+       * @return Pointer to the chunk, or `nullptr`.
+       */
+      chunk_t*
+      internal_find_chunk_ (std::size_t index, void* addr) const noexcept;
+
+      /**
+       * @brief Internal function to add a new chunk to a pool.
+       * @param [in] index The pool index.
+       * @return Pointer to the new chunk, or `nullptr`.
+       */
+      chunk_t*
+      internal_grow_ (std::size_t index);
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pool_options options_;
+
+      rtos::memory::memory_resource* upstream_ = nullptr;
+
+      std::size_t pools_count_ = 0;
+
+      // The list of chunks of each pool, most recent first.
+      chunk_t* chunks_[max_pools];
+
+      // The number of blocks of the next chunk of each pool.
+      std::size_t next_blocks_[max_pools];
+
+      /**
+       * @endcond
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource keeping pools of blocks of
+     *  several sizes, safe to use from multiple threads.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile pool.h <cmsis-plus/memory/pool.h>
+     * @tparam L Type of lockable object.
+     *
+     * @details
+     * This memory manager is similar to the standard
+     * `std::pmr::synchronized_pool_resource`; all operations are
+     * performed with the lockable object locked.
+     *
+     * The default lockable locks the scheduler, which is
+     * appropriate for the short critical sections of the pools;
+     * a mutex can also be used.
+     */
+    template<typename L = rtos::scheduler::lockable>
+      class pool_synchronized : public pool
+      {
+      public:
+
+        using lockable_type = L;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] opts Reference to the configuration.
+         * @param [in] upstream Pointer to the memory resource used
+         *  to allocate the chunks, or `nullptr` for the default resource.
+         */
+        pool_synchronized (const pool_options& opts = pool_options
+                             { },
+                           rtos::memory::memory_resource* upstream = nullptr);
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] opts Reference to the configuration.
+         * @param [in] upstream Pointer to the memory resource used
+         *  to allocate the chunks, or `nullptr` for the default resource.
+         */
+        pool_synchronized (const char* name, const pool_options& opts =
+                               pool_options
+                                 { },
+                           rtos::memory::memory_resource* upstream = nullptr);
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        pool_synchronized (const pool_synchronized&) = delete;
+        pool_synchronized (pool_synchronized&&) = delete;
+        pool_synchronized&
+        operator= (const pool_synchronized&) = delete;
+        pool_synchronized&
+        operator= (pool_synchronized&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~pool_synchronized () override;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Return all chunks to the upstream memory resource.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        release (void) noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Implementation of the memory allocator.
+         * @param [in] bytes Number of bytes to allocate.
+         * @param [in] alignment Alignment constraint (power of 2).
+         * @return Pointer to newly allocated block, or `nullptr`.
+         */
+        virtual void*
+        do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+        /**
+         * @brief Implementation of the memory deallocator.
+         * @param [in] addr Address of a previously allocated block to free.
+         * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+         * @param [in] alignment Alignment constraint (power of 2).
+         * @par Returns
+         *  Nothing.
+         */
+        virtual void
+        do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+            noexcept override;
+
+        /**
+         * @brief Implementation of the function to reset the memory manager.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        virtual void
+        do_reset (void) noexcept override;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        lockable_type lockable_;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+
+  namespace estd
+  {
+    namespace pmr
+    {
+      /**
+       * @brief Standard name for the pool memory resources configuration.
+       * @ingroup cmsis-plus-rtos-memres
+       */
+      using pool_options = memory::pool_options;
+
+      /**
+       * @brief Standard name for the pool memory resource.
+       * @ingroup cmsis-plus-rtos-memres
+       */
+      using unsynchronized_pool_resource = memory::pool;
+
+      /**
+       * @brief Standard name for the thread safe pool memory resource.
+       * @ingroup cmsis-plus-rtos-memres
+       */
+      using synchronized_pool_resource = memory::pool_synchronized<>;
+
+    } /* namespace pmr */
+  } /* namespace estd */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    pool::pool (const pool_options& opts,
+                rtos::memory::memory_resource* upstream) :
+        pool
+          { nullptr, opts, upstream }
+    {
+      ;
+    }
+
+    inline block_pool&
+    pool::chunk_pool (chunk_t* chunk)
+    {
+      return *reinterpret_cast<block_pool*> (&chunk->storage);
+    }
+
+    inline pool_options
+    pool::options (void) const
+    {
+      return options_;
+    }
+
+    inline rtos::memory::memory_resource*
+    pool::upstream_resource (void) const
+    {
+      return upstream_;
+    }
+
+    // ========================================================================
+
+    template<typename L>
+      inline
+      pool_synchronized<L>::pool_synchronized (
+          const pool_options& opts, rtos::memory::memory_resource* upstream) :
+          pool_synchronized
+            { nullptr, opts, upstream }
+      {
+        ;
+      }
+
+    template<typename L>
+      inline
+      pool_synchronized<L>::pool_synchronized (
+          const char* name, const pool_options& opts,
+          rtos::memory::memory_resource* upstream) :
+          pool
+            { name, opts, upstream }
+      {
+        ;
+      }
+
+    template<typename L>
+      pool_synchronized<L>::~pool_synchronized ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      }
+
+    template<typename L>
+      void
+      pool_synchronized<L>::release (void) noexcept
+      {
+        std::lock_guard<lockable_type> ulk
+          { lockable_ };
+
+        pool::release ();
+      }
+
+    template<typename L>
+      void*
+      pool_synchronized<L>::do_allocate (std::size_t bytes,
+                                         std::size_t alignment)
+      {
+        std::lock_guard<lockable_type> ulk
+          { lockable_ };
+
+        return pool::do_allocate (bytes, alignment);
+      }
+
+    template<typename L>
+      void
+      pool_synchronized<L>::do_deallocate (void* addr, std::size_t bytes,
+                                           std::size_t alignment) noexcept
+      {
+        std::lock_guard<lockable_type> ulk
+          { lockable_ };
+
+        pool::do_deallocate (addr, bytes, alignment);
+      }
+
+    template<typename L>
+      void
+      pool_synchronized<L>::do_reset (void) noexcept
+      {
+        std::lock_guard<lockable_type> ulk
+          { lockable_ };
+
+        pool::do_reset ();
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_POOL_H_ */
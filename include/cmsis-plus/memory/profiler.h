@@ -0,0 +1,519 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_PROFILER_H_
+#define CMSIS_PLUS_MEMORY_PROFILER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+#if defined(OS_INCLUDE_MEMORY_PROFILER)
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_MEMORY_PROFILER_RECORDS)
+#define OS_INTEGER_MEMORY_PROFILER_RECORDS (64)
+#endif
+
+#if !defined(OS_INTEGER_MEMORY_PROFILER_LIVE_ALLOCATIONS)
+#define OS_INTEGER_MEMORY_PROFILER_LIVE_ALLOCATIONS (64)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    class io;
+  } /* namespace posix */
+
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource recording the operations performed
+     *  on another memory resource.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile profiler.h <cmsis-plus/memory/profiler.h>
+     *
+     * @details
+     * This class wraps an existing memory resource, forwarding all
+     * requests to it; for each allocation and deallocation, the
+     * caller address, the size and the high resolution timestamp
+     * are stored in a ring buffer of the most recent
+     * `OS_INTEGER_MEMORY_PROFILER_RECORDS` operations.
+     *
+     * The blocks not yet deallocated are also kept in a table
+     * of `OS_INTEGER_MEMORY_PROFILER_LIVE_ALLOCATIONS` entries,
+     * which, at the end of a test, identifies the leaks.
+     *
+     * The caller is the return address of the virtual call; when
+     * compiled with optimisations, this is the code that
+     * calls `allocate()` or `deallocate()`, for example
+     * `operator new()` or a `polymorphic_allocator<T>`.
+     *
+     * The content can be displayed on the trace device, or
+     * written to a POSIX file, for further processing on the host.
+     *
+     * When `OS_INCLUDE_MEMORY_PROFILER` is not defined, this class
+     * is not available, and the system memory resources are
+     * not wrapped, so there is no overhead.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * static os::memory::profiler prof
+     *   { "prof", estd::pmr::get_default_resource () };
+     * estd::pmr::set_default_resource (&prof);
+     * // ...
+     * prof.dump ();
+     * @endcode
+     */
+    class profiler : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @brief The number of operation records.
+       */
+      static constexpr std::size_t max_records =
+      OS_INTEGER_MEMORY_PROFILER_RECORDS;
+
+      /**
+       * @brief The number of live allocation entries.
+       */
+      static constexpr std::size_t max_live_allocations =
+      OS_INTEGER_MEMORY_PROFILER_LIVE_ALLOCATIONS;
+
+      /**
+       * @brief Type of operations.
+       */
+      typedef enum
+      {
+        /**
+         * @brief Successful allocation.
+         */
+        allocation = 1,
+
+        /**
+         * @brief Failed allocation.
+         */
+        failed_allocation = 2,
+
+        /**
+         * @brief Deallocation.
+         */
+        deallocation = 3
+      } operation_t;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Type of the operation records.
+       */
+      typedef struct
+      {
+        /**
+         * @brief The time of the operation.
+         */
+        rtos::clock::timestamp_t timestamp;
+
+        /**
+         * @brief The address of the caller.
+         */
+        void* caller;
+
+        /**
+         * @brief The address of the block.
+         */
+        void* addr;
+
+        /**
+         * @brief The number of bytes.
+         */
+        std::size_t bytes;
+
+        /**
+         * @brief The type of operation.
+         */
+        operation_t operation;
+      } record_t;
+
+      /**
+       * @brief Type of the live allocation entries.
+       */
+      typedef struct
+      {
+        /**
+         * @brief The time of the allocation.
+         */
+        rtos::clock::timestamp_t timestamp;
+
+        /**
+         * @brief The address of the caller.
+         */
+        void* caller;
+
+        /**
+         * @brief The address of the block, or `nullptr` if not used.
+         */
+        void* addr;
+
+        /**
+         * @brief The number of bytes.
+         */
+        std::size_t bytes;
+      } live_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] resource Pointer to the memory resource to wrap.
+       */
+      profiler (rtos::memory::memory_resource* resource);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] resource Pointer to the memory resource to wrap.
+       */
+      profiler (const char* name, rtos::memory::memory_resource* resource);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      profiler (const profiler&) = delete;
+      profiler (profiler&&) = delete;
+      profiler&
+      operator= (const profiler&) = delete;
+      profiler&
+      operator= (profiler&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~profiler () override;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Get the wrapped memory resource.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the wrapped memory resource.
+       */
+      rtos::memory::memory_resource*
+      resource (void) const;
+
+      /**
+       * @brief Get the number of available records.
+       * @par Parameters
+       *  None.
+       * @return Integer, at most `max_records`.
+       */
+      std::size_t
+      records (void) const;
+
+      /**
+       * @brief Get a record.
+       * @param [in] index The record index, 0 for the oldest.
+       * @return Reference to the record.
+       */
+      const record_t&
+      record (std::size_t index) const;
+
+      /**
+       * @brief Get the number of live allocations.
+       * @par Parameters
+       *  None.
+       * @return Integer, at most `max_live_allocations`.
+       */
+      std::size_t
+      live_allocations (void) const;
+
+      /**
+       * @brief Get the number of allocations not tracked
+       *  because the table was full.
+       * @par Parameters
+       *  None.
+       * @return Integer.
+       */
+      std::size_t
+      untracked_allocations (void) const;
+
+      /**
+       * @brief Clear the records and the live allocations.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clear (void) noexcept;
+
+      /**
+       * @brief Display the records and the live allocations
+       *  on the trace device.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      dump (void);
+
+      /**
+       * @brief Write the records and the live allocations to a file.
+       * @param [in] out Reference to an open POSIX file or device.
+       * @retval 0 The content was written.
+       * @retval -1 Error, with `errno` set by `write()`.
+       */
+      int
+      dump (posix::io& out);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to add a record.
+       * @param [in] operation The type of operation.
+       * @param [in] caller The address of the caller.
+       * @param [in] addr The address of the block.
+       * @param [in] bytes The number of bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_record_ (operation_t operation, void* caller, void* addr,
+                        std::size_t bytes) noexcept;
+
+      /**
+       * @brief Internal function to format a record or an entry.
+       * @param [out] buf Pointer to the output buffer.
+       * @param [in] size The size of the output buffer.
+       * @param [in] index The index; the records are first, followed
+       *  by the live allocation entries.
+       * @return The number of characters, or 0 if the entry is not used.
+       */
+      int
+      internal_format_ (char* buf, std::size_t size, std::size_t index) const;
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+      /**
+       * @brief Implementation of the function to coalesce free blocks.
+       * @par Parameters
+       *  None.
+       * @retval true if the operation resulted in larger blocks.
+       * @retval false if the operation was ineffective.
+       */
+      virtual bool
+      do_coalesce (void) noexcept override;
+
+      /**
+       * @brief Implementation of the function to resize a block in place.
+       * @param [in] addr Address of a previously allocated block.
+       * @param [in] bytes Number of bytes of the block (may be 0 if unknown).
+       * @param [in] new_bytes The requested number of bytes.
+       * @retval true The block was resized.
+       * @retval false The block cannot be resized in place.
+       */
+      virtual bool
+      do_try_resize (void* addr, std::size_t bytes, std::size_t new_bytes)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to verify the
+       *  integrity of the managed chunks.
+       * @param [in] chunks Maximum number of chunks to check.
+       * @return Address of the first damaged chunk, or `nullptr`.
+       */
+      virtual const void*
+      do_verify (std::size_t chunks) noexcept override;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::memory::memory_resource* resource_ = nullptr;
+
+      // Ring buffer; the next record is written at index
+      // (records_count_ % max_records).
+      record_t records_[max_records];
+      std::size_t records_count_ = 0;
+
+      live_t live_[max_live_allocations];
+      std::size_t live_count_ = 0;
+      std::size_t untracked_count_ = 0;
+
+      /**
+       * @endcond
+       */
+
+    };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    profiler::profiler (rtos::memory::memory_resource* resource) :
+        profiler
+          { nullptr, resource }
+    {
+      ;
+    }
+
+    inline rtos::memory::memory_resource*
+    profiler::resource (void) const
+    {
+      return resource_;
+    }
+
+    inline std::size_t
+    profiler::records (void) const
+    {
+      return (records_count_ < max_records) ? records_count_ : max_records;
+    }
+
+    inline std::size_t
+    profiler::live_allocations (void) const
+    {
+      return live_count_;
+    }
+
+    inline std::size_t
+    profiler::untracked_allocations (void) const
+    {
+      return untracked_count_;
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_MEMORY_PROFILER) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_PROFILER_H_ */
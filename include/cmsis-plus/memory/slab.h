@@ -0,0 +1,608 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_SLAB_H_
+#define CMSIS_PLUS_MEMORY_SLAB_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/memory/block-pool.h>
+
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource routing allocations to a set of
+     *  block pools of increasing sizes, using an existing arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile slab.h <cmsis-plus/memory/slab.h>
+     *
+     * @details
+     * This memory manager is intended for applications that allocate
+     * many small objects of a few sizes. The arena is split between
+     * several `block_pool` size classes; each allocation is served
+     * by the smallest class that fits, in constant time and
+     * without fragmentation.
+     *
+     * Requests larger than the largest class, or requests for
+     * which the selected class is exhausted, are forwarded to the
+     * upstream memory resource, if any.
+     *
+     * The statistics of the object itself cover the size classes;
+     * the statistics of each class are available via `size_class()`.
+     */
+    class slab : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @brief The maximum number of size classes.
+       */
+      static constexpr std::size_t max_size_classes = 8;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] sizes Array of block sizes, in ascending order.
+       * @param [in] blocks Array with the number of blocks for each size.
+       * @param [in] count The number of size classes.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @param [in] upstream Pointer to the memory resource used for
+       *  large requests, or `nullptr`.
+       */
+      slab (const std::size_t* sizes, const std::size_t* blocks,
+            std::size_t count, void* addr, std::size_t bytes,
+            rtos::memory::memory_resource* upstream = nullptr);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] sizes Array of block sizes, in ascending order.
+       * @param [in] blocks Array with the number of blocks for each size.
+       * @param [in] count The number of size classes.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @param [in] upstream Pointer to the memory resource used for
+       *  large requests, or `nullptr`.
+       */
+      slab (const char* name, const std::size_t* sizes,
+            const std::size_t* blocks, std::size_t count, void* addr,
+            std::size_t bytes,
+            rtos::memory::memory_resource* upstream = nullptr);
+
+    protected:
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       */
+      slab (const char* name);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      slab (const slab&) = delete;
+      slab (slab&&) = delete;
+      slab&
+      operator= (const slab&) = delete;
+      slab&
+      operator= (slab&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~slab () override;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Calculator for the arena size.
+       * @param [in] sizes Array of block sizes, in ascending order.
+       * @param [in] blocks Array with the number of blocks for each size.
+       * @param [in] count The number of size classes.
+       * @return Total size in bytes, including the alignment padding.
+       */
+      static constexpr std::size_t
+      compute_allocated_size_bytes (const std::size_t* sizes,
+                                    const std::size_t* blocks,
+                                    std::size_t count);
+
+      /**
+       * @brief Get the number of size classes.
+       * @par Parameters
+       *  None.
+       * @return The number of size classes.
+       */
+      std::size_t
+      size_classes (void) const;
+
+      /**
+       * @brief Get a size class.
+       * @param [in] index The index of the size class.
+       * @return Reference to the block pool implementing the class;
+       *  used to access the per class statistics.
+       */
+      block_pool&
+      size_class (std::size_t index);
+
+      /**
+       * @brief Get the upstream memory resource.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the upstream memory resource, or `nullptr`.
+       */
+      rtos::memory::memory_resource*
+      upstream_resource (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to construct the memory resource.
+       * @param [in] sizes Array of block sizes, in ascending order.
+       * @param [in] blocks Array with the number of blocks for each size.
+       * @param [in] count The number of size classes.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @param [in] upstream Pointer to the memory resource used for
+       *  large requests, or `nullptr`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_construct_ (const std::size_t* sizes, const std::size_t* blocks,
+                           std::size_t count, void* addr, std::size_t bytes,
+                           rtos::memory::memory_resource* upstream);
+
+      /**
+       * @brief Internal function to reset the memory resource.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_reset_ (void) noexcept;
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Storage for the block pools.
+       * @details
+       * The pools are constructed in place by `internal_construct_()`.
+       */
+      typename std::aligned_storage<sizeof(block_pool), alignof(block_pool)>::type classes_[max_size_classes];
+
+      /**
+       * @brief The block size of each class, in bytes.
+       */
+      std::size_t sizes_[max_size_classes];
+
+      /**
+       * @brief The end address of the arena slice of each class.
+       */
+      void* ends_[max_size_classes];
+
+      /**
+       * @brief The number of size classes.
+       */
+      std::size_t count_ = 0;
+
+      /**
+       * @brief The arena address.
+       */
+      void* arena_addr_ = nullptr;
+
+      /**
+       * @brief The memory resource used for large requests.
+       */
+      rtos::memory::memory_resource* upstream_ = nullptr;
+
+      /**
+       * @endcond
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource routing allocations to a set of
+     *  block pools of increasing sizes, using a dynamically
+     *  allocated arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile slab.h <cmsis-plus/memory/slab.h>
+     *
+     * @details
+     * This class template is a convenience class that allocates
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define dynamically allocated memory managers.
+     */
+    template<typename A = os::rtos::memory::allocator<char>>
+      class slab_allocated : public slab
+      {
+      public:
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using value_type = char;
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using allocator_type = A;
+
+        /**
+         * @brief Standard allocator traits definition.
+         */
+        using allocator_traits = std::allocator_traits<A>;
+
+        // It is recommended to have the same type, but at least the types
+        // should have the same size.
+        static_assert(sizeof(value_type) == sizeof(typename allocator_traits::value_type),
+            "The allocator must be parametrised with a type of same size.");
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] sizes Array of block sizes, in ascending order.
+         * @param [in] blocks Array with the number of blocks for each size.
+         * @param [in] count The number of size classes.
+         * @param [in] upstream Pointer to the memory resource used for
+         *  large requests, or `nullptr`.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        slab_allocated (const std::size_t* sizes, const std::size_t* blocks,
+                        std::size_t count,
+                        rtos::memory::memory_resource* upstream = nullptr,
+                        const allocator_type& allocator = allocator_type ());
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] sizes Array of block sizes, in ascending order.
+         * @param [in] blocks Array with the number of blocks for each size.
+         * @param [in] count The number of size classes.
+         * @param [in] upstream Pointer to the memory resource used for
+         *  large requests, or `nullptr`.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        slab_allocated (const char* name, const std::size_t* sizes,
+                        const std::size_t* blocks, std::size_t count,
+                        rtos::memory::memory_resource* upstream = nullptr,
+                        const allocator_type& allocator = allocator_type ());
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        slab_allocated (const slab_allocated&) = delete;
+        slab_allocated (slab_allocated&&) = delete;
+        slab_allocated&
+        operator= (const slab_allocated&) = delete;
+        slab_allocated&
+        operator= (slab_allocated&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~slab_allocated ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief Pointer to allocator.
+         * @details
+         * The allocator is remembered because deallocation
+         * must be performed during destruction.
+         */
+        allocator_type* allocator_ = nullptr;
+
+        /**
+         * @brief Size of the allocated arena, in bytes.
+         */
+        std::size_t allocated_bytes_arena_ = 0;
+
+        /**
+         * @brief Address of the allocated arena.
+         */
+        void* allocated_arena_ = nullptr;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    slab::slab (const char* name) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      ;
+    }
+
+    inline
+    slab::slab (const std::size_t* sizes, const std::size_t* blocks,
+                std::size_t count, void* addr, std::size_t bytes,
+                rtos::memory::memory_resource* upstream) :
+        slab
+          { nullptr, sizes, blocks, count, addr, bytes, upstream }
+    {
+      ;
+    }
+
+    inline
+    slab::slab (const char* name, const std::size_t* sizes,
+                const std::size_t* blocks, std::size_t count, void* addr,
+                std::size_t bytes, rtos::memory::memory_resource* upstream) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, addr, bytes, this,
+                     this->name ());
+
+      internal_construct_ (sizes, blocks, count, addr, bytes, upstream);
+    }
+
+    /**
+     * @details
+     * Each class slice is aligned to `max_align`, and the block
+     * sizes are rounded up to the pointer size.
+     */
+    constexpr std::size_t
+    slab::compute_allocated_size_bytes (const std::size_t* sizes,
+                                        const std::size_t* blocks,
+                                        std::size_t count)
+    {
+      std::size_t bytes = max_align;
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          bytes += rtos::memory::align_size (
+              rtos::memory::align_size (sizes[i], sizeof(void*)) * blocks[i],
+              max_align);
+        }
+      return bytes;
+    }
+
+    inline std::size_t
+    slab::size_classes (void) const
+    {
+      return count_;
+    }
+
+    inline block_pool&
+    slab::size_class (std::size_t index)
+    {
+      assert(index < count_);
+
+      return *reinterpret_cast<block_pool*> (&classes_[index]);
+    }
+
+    inline rtos::memory::memory_resource*
+    slab::upstream_resource (void) const
+    {
+      return upstream_;
+    }
+
+    // ========================================================================
+
+    template<typename A>
+      inline
+      slab_allocated<A>::slab_allocated (
+          const std::size_t* sizes, const std::size_t* blocks,
+          std::size_t count, rtos::memory::memory_resource* upstream,
+          const allocator_type& allocator) :
+          slab_allocated (nullptr, sizes, blocks, count, upstream, allocator)
+      {
+        ;
+      }
+
+    template<typename A>
+      slab_allocated<A>::slab_allocated (
+          const char* name, const std::size_t* sizes,
+          const std::size_t* blocks, std::size_t count,
+          rtos::memory::memory_resource* upstream,
+          const allocator_type& allocator) :
+          slab
+            { name }
+      {
+        trace::printf ("%s(%u) @%p %s\n", __func__, count, this, this->name ());
+
+        // Remember the allocator, it'll be used by the destructor.
+        allocator_ =
+            static_cast<allocator_type*> (&const_cast<allocator_type&> (allocator));
+
+        std::size_t bytes = compute_allocated_size_bytes (sizes, blocks, count);
+
+        void* addr = allocator_->allocate (bytes);
+        if (addr == nullptr)
+          {
+            estd::__throw_bad_alloc ();
+          }
+
+        allocated_arena_ = addr;
+        allocated_bytes_arena_ = bytes;
+
+        internal_construct_ (sizes, blocks, count, addr, bytes, upstream);
+      }
+
+    template<typename A>
+      slab_allocated<A>::~slab_allocated ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        // Skip in case a derived class did the deallocation.
+        if (allocator_ != nullptr)
+          {
+            allocator_->deallocate (
+                static_cast<typename allocator_traits::pointer> (allocated_arena_),
+                allocated_bytes_arena_);
+
+            // Prevent another deallocation.
+            allocator_ = nullptr;
+          }
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_SLAB_H_ */
@@ -0,0 +1,654 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_TLSF_H_
+#define CMSIS_PLUS_MEMORY_TLSF_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the Two-Level Segregated Fit
+     *  allocation policy, using an existing arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile tlsf.h <cmsis-plus/memory/tlsf.h>
+     *
+     * @details
+     * This memory manager implements the TLSF algorithm by
+     * M. Masmano, I. Ripoll et al.
+     *
+     * The free blocks are kept in segregated lists, selected by
+     * two levels of bitmaps; both allocation and deallocation are
+     * deterministic, with constant execution time, regardless of
+     * the number of free blocks or the fragmentation.
+     */
+    class tlsf : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       */
+      tlsf (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       */
+      tlsf (const char* name, void* addr, std::size_t bytes);
+
+    protected:
+
+      /**
+       * @brief Default constructor. Construct a memory resource
+       *  object instance.
+       */
+      tlsf () = default;
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name
+       */
+      tlsf (const char* name);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      tlsf (const tlsf&) = delete;
+      tlsf (tlsf&&) = delete;
+      tlsf&
+      operator= (const tlsf&) = delete;
+      tlsf&
+      operator= (tlsf&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~tlsf () override;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // A 'block' is where the user payload resides; all blocks
+      // are physically linked, to coalesce neighbours in constant time.
+      typedef struct block_s
+      {
+        // The previous physical block, or nullptr for the first one.
+        struct block_s* prev_phys;
+
+        // The block size, in bytes, including this header;
+        // the lowest bit is set for free blocks.
+        std::size_t size;
+
+        // For allocated blocks, here starts the payload.
+
+        // When the block is free, instead of the payload,
+        // here are the links in the segregated free list.
+        struct block_s* next_free;
+        struct block_s* prev_free;
+      } block_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to construct the memory resource.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_construct_ (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Internal function to reset the memory resource.
+       * @par Parameters
+       *  None.
+       */
+      void
+      internal_reset_ (void) noexcept;
+
+      /**
+       * @brief Internal function to link a free block to its list.
+       * @param [in] block Pointer to block.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_insert_ (block_t* block) noexcept;
+
+      /**
+       * @brief Internal function to unlink a free block from its list.
+       * @param [in] block Pointer to block.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_remove_ (block_t* block) noexcept;
+
+      /**
+       * @brief Internal function to find and unlink a free block.
+       * @param [in] size Minimum block size, in bytes.
+       * @return Pointer to block, or `nullptr`.
+       */
+      block_t*
+      internal_find_ (std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to split a block.
+       * @param [in] block Pointer to block.
+       * @param [in] size Size of the first part, in bytes.
+       * @return Pointer to the second part, which is not linked
+       *  to any list.
+       */
+      block_t*
+      internal_split_ (block_t* block, std::size_t size) noexcept;
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // All sizes are multiple of the pointer size.
+      static constexpr std::size_t block_align = sizeof(void*);
+      static constexpr std::size_t block_align_log2 =
+          (sizeof(void*) == 8) ? 3 : 2;
+
+      // Each first level list is split in 16 second level lists.
+      static constexpr std::size_t sl_index_count_log2 = 4;
+      static constexpr std::size_t sl_index_count = (1u
+          << sl_index_count_log2);
+
+      // Blocks smaller than this size are kept in the first list,
+      // linearly split in second level lists.
+      static constexpr std::size_t fl_index_shift = (sl_index_count_log2
+          + block_align_log2);
+      static constexpr std::size_t small_block_size = (1u << fl_index_shift);
+
+      // Blocks must be smaller than 2^fl_index_max (16 MB).
+      static constexpr std::size_t fl_index_max = 24;
+      static constexpr std::size_t fl_index_count = (fl_index_max
+          - fl_index_shift + 1);
+
+      // Offset of payload inside the block.
+      static constexpr std::size_t block_offset = offsetof(block_t, next_free);
+      static constexpr std::size_t block_minsize = sizeof(block_t);
+      static constexpr std::size_t block_maxsize = (1u << fl_index_max)
+          - block_align;
+
+      static constexpr std::size_t block_free_bit = 1;
+
+      void* arena_addr_ = nullptr;
+      // No need for arena_size_bytes_, use total_bytes_.
+
+      // Bitmap of non empty first level lists.
+      uint32_t fl_bitmap_ = 0;
+      // Bitmaps of non empty second level lists.
+      uint32_t sl_bitmap_[fl_index_count];
+
+      // Heads of the segregated free lists.
+      block_t* blocks_[fl_index_count][sl_index_count];
+
+      /**
+       * @endcond
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the Two-Level Segregated Fit
+     *  allocation policy, using an internal arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile tlsf.h <cmsis-plus/memory/tlsf.h>
+     *
+     * @details
+     * This class template is a convenience class that includes
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define statically allocated memory managers.
+     */
+    template<std::size_t N>
+      class tlsf_inclusive : public tlsf
+      {
+      public:
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t bytes = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @par Parameters
+         *  None.
+         */
+        tlsf_inclusive (void);
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         */
+        tlsf_inclusive (const char* name);
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        tlsf_inclusive (const tlsf_inclusive&) = delete;
+        tlsf_inclusive (tlsf_inclusive&&) = delete;
+        tlsf_inclusive&
+        operator= (const tlsf_inclusive&) = delete;
+        tlsf_inclusive&
+        operator= (tlsf_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~tlsf_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The allocation arena is an array of bytes.
+         */
+        char arena_[bytes];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the Two-Level Segregated Fit
+     *  allocation policy, using a dynamically allocated arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile tlsf.h <cmsis-plus/memory/tlsf.h>
+     *
+     * @details
+     * This class template is a convenience class that allocates
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define dynamically allocated memory managers.
+     */
+    template<typename A = os::rtos::memory::allocator<char>>
+      class tlsf_allocated : public tlsf
+      {
+      public:
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using value_type = char;
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using allocator_type = A;
+
+        /**
+         * @brief Standard allocator traits definition.
+         */
+        using allocator_traits = std::allocator_traits<A>;
+
+        // It is recommended to have the same type, but at least the types
+        // should have the same size.
+        static_assert(sizeof(value_type) == sizeof(typename allocator_traits::value_type),
+            "The allocator must be parametrised with a type of same size.");
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] bytes The size of the allocation arena.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        tlsf_allocated (std::size_t bytes, const allocator_type& allocator =
+                            allocator_type ());
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] bytes The size of the allocation arena.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        tlsf_allocated (const char* name, std::size_t bytes,
+                        const allocator_type& allocator = allocator_type ());
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        tlsf_allocated (const tlsf_allocated&) = delete;
+        tlsf_allocated (tlsf_allocated&&) = delete;
+        tlsf_allocated&
+        operator= (const tlsf_allocated&) = delete;
+        tlsf_allocated&
+        operator= (tlsf_allocated&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~tlsf_allocated ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief Pointer to allocator.
+         * @details
+         * The allocator is remembered because deallocation
+         * must be performed during destruction.
+         */
+        allocator_type* allocator_ = nullptr;
+
+        /**
+         * @brief Size of the allocated arena, in bytes.
+         */
+        std::size_t allocated_bytes_arena_ = 0;
+
+        /**
+         * @brief Address of the allocated arena.
+         */
+        void* allocated_arena_ = nullptr;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    tlsf::tlsf (const char* name) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      ;
+    }
+
+    inline
+    tlsf::tlsf (void* addr, std::size_t bytes) :
+        tlsf
+          { nullptr, addr, bytes }
+    {
+      ;
+    }
+
+    inline
+    tlsf::tlsf (const char* name, void* addr, std::size_t bytes) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, addr, bytes, this,
+                     this->name ());
+
+      internal_construct_ (addr, bytes);
+    }
+
+    // ========================================================================
+
+    template<std::size_t N>
+      inline
+      tlsf_inclusive<N>::tlsf_inclusive () :
+          tlsf_inclusive (nullptr)
+      {
+        ;
+      }
+
+    template<std::size_t N>
+      inline
+      tlsf_inclusive<N>::tlsf_inclusive (const char* name) :
+          tlsf
+            { name }
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        internal_construct_ (&arena_[0], bytes);
+      }
+
+    template<std::size_t N>
+      tlsf_inclusive<N>::~tlsf_inclusive ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      }
+
+    // ========================================================================
+
+    template<typename A>
+      inline
+      tlsf_allocated<A>::tlsf_allocated (std::size_t bytes,
+                                         const allocator_type& allocator) :
+          tlsf_allocated (nullptr, bytes, allocator)
+      {
+        ;
+      }
+
+    template<typename A>
+      tlsf_allocated<A>::tlsf_allocated (const char* name, std::size_t bytes,
+                                         const allocator_type& allocator) :
+          tlsf
+            { name }
+      {
+        trace::printf ("%s(%u) @%p %s\n", __func__, bytes, this, this->name ());
+
+        // Remember the allocator, it'll be used by the destructor.
+        allocator_ =
+            static_cast<allocator_type*> (&const_cast<allocator_type&> (allocator));
+
+        void* addr = allocator_->allocate (bytes);
+        if (addr == nullptr)
+          {
+            estd::__throw_bad_alloc ();
+          }
+
+        // The arena may be adjusted for alignment; remember the original.
+        allocated_arena_ = addr;
+        allocated_bytes_arena_ = bytes;
+
+        internal_construct_ (addr, bytes);
+      }
+
+    template<typename A>
+      tlsf_allocated<A>::~tlsf_allocated ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        // Skip in case a derived class did the deallocation.
+        if (allocator_ != nullptr)
+          {
+            allocator_->deallocate (
+                static_cast<typename allocator_traits::pointer> (allocated_arena_),
+                allocated_bytes_arena_);
+
+            // Prevent another deallocation.
+            allocator_ = nullptr;
+          }
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_TLSF_H_ */
@@ -34,6 +34,10 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
+#include <atomic>
+
+#include <cmsis-plus/utils/copy.h>
 
 // ----------------------------------------------------------------------------
 
@@ -211,6 +215,175 @@ namespace os
      */
     using circular_buffer_bytes = circular_buffer<uint8_t>;
 
+    // ========================================================================
+
+    /**
+     * @brief Lock-free single producer, single consumer circular buffer.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     *
+     * @details
+     * A variant of `circular_buffer` that can be shared without
+     * critical sections between exactly one producer, calling the
+     * `push_back()`/`back_contiguous_buffer()`/`advance_back()`
+     * functions, and one consumer, calling the `pop_front()`/
+     * `front_contiguous_buffer()`/`advance_front()` functions;
+     * typically an interrupt and a thread.
+     *
+     * Each side writes only its own index, with release semantics,
+     * after accessing the elements, and reads the other index with
+     * acquire semantics. The indices run over twice the size, to
+     * tell a full buffer from an empty one without a separate
+     * length and without wasting an element.
+     *
+     * `clear()` is not thread safe; call it when neither side
+     * is active.
+     */
+    template<typename T>
+      class circular_buffer_spsc
+      {
+        // ----------------------------------------------------------------------
+
+      public:
+
+        /**
+         * @brief Standard type definition.
+         */
+        using value_type = T;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        circular_buffer_spsc (value_type* buf, std::size_t size,
+                              std::size_t high_water_mark,
+                              std::size_t low_water_mark = 0);
+
+        circular_buffer_spsc (value_type* buf, std::size_t size);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        circular_buffer_spsc (const circular_buffer_spsc&) = delete;
+        circular_buffer_spsc (circular_buffer_spsc&&) = delete;
+        circular_buffer_spsc&
+        operator= (const circular_buffer_spsc&) = delete;
+        circular_buffer_spsc&
+        operator= (circular_buffer_spsc&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~circular_buffer_spsc () = default;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        void
+        clear (void);
+
+        // Producer side.
+        std::size_t
+        push_back (value_type v);
+
+        std::size_t
+        push_back (const value_type* buf, std::size_t count);
+
+        std::size_t
+        back_contiguous_buffer (value_type** ppbuf);
+
+        std::size_t
+        advance_back (std::size_t count);
+
+        // Consumer side.
+        std::size_t
+        pop_front (value_type* buf);
+
+        std::size_t
+        pop_front (value_type* buf, std::size_t size);
+
+        std::size_t
+        front_contiguous_buffer (value_type** ppbuf);
+
+        std::size_t
+        advance_front (std::size_t count);
+
+        // Either side; the result may be stale when returned.
+        bool
+        empty (void) const;
+
+        bool
+        full (void) const;
+
+        bool
+        above_high_water_mark (void) const;
+
+        bool
+        below_low_water_mark (void) const;
+
+        std::size_t
+        length (void) const;
+
+        std::size_t
+        size (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      private:
+
+        /**
+         * @cond ignore
+         */
+
+        std::size_t
+        length_ (std::size_t back, std::size_t front) const;
+
+        std::size_t
+        index_ (std::size_t pos) const;
+
+        std::size_t
+        next_ (std::size_t pos, std::size_t count) const;
+
+        value_type* const buf_;
+        std::size_t const size_;
+        std::size_t const high_water_mark_;
+        std::size_t const low_water_mark_;
+
+        // Both in [0, 2 * size); written only by the producer and
+        // the consumer, respectively.
+        std::atomic<std::size_t> back_;
+        std::atomic<std::size_t> front_;
+
+        /**
+         * @endcond
+         */
+      };
+
+    /**
+     * @brief Lock-free circular buffer of bytes.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     */
+    using circular_buffer_spsc_bytes = circular_buffer_spsc<uint8_t>;
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -373,7 +546,7 @@ namespace os
             - static_cast<std::size_t> (back_ - buf_));
         if (len <= sizeToEnd)
           {
-            std::memcpy (back_, buf, len);
+            os::utils::copy_bytes (back_, buf, len * sizeof(value_type));
             back_ += len;
             if (static_cast<std::size_t> (back_ - buf_) >= size_)
               {
@@ -384,9 +557,11 @@ namespace os
           }
         else
           {
-            std::memcpy (back_, buf, sizeToEnd);
+            os::utils::copy_bytes (back_, buf,
+                                   sizeToEnd * sizeof(value_type));
             back_ = const_cast<value_type* volatile > (buf_);
-            std::memcpy (back_, buf + sizeToEnd, len - sizeToEnd);
+            os::utils::copy_bytes (back_, buf + sizeToEnd,
+                                   (len - sizeToEnd) * sizeof(value_type));
             back_ += (len - sizeToEnd);
             len_ += len;
           }
@@ -475,7 +650,7 @@ namespace os
             - static_cast<std::size_t> (front_ - buf_);
         if (len <= sizeToEnd)
           {
-            std::memcpy (buf, front_, len);
+            os::utils::copy_bytes (buf, front_, len * sizeof(value_type));
             front_ += len;
             if (static_cast<std::size_t> (front_ - buf_) >= size_)
               {
@@ -485,9 +660,11 @@ namespace os
           }
         else
           {
-            std::memcpy (buf, front_, sizeToEnd);
+            os::utils::copy_bytes (buf, front_,
+                                   sizeToEnd * sizeof(value_type));
             front_ = const_cast<value_type* volatile > (buf_);
-            std::memcpy (buf + sizeToEnd, front_, len - sizeToEnd);
+            os::utils::copy_bytes (buf + sizeToEnd, front_,
+                                   (len - sizeToEnd) * sizeof(value_type));
             front_ += (len - sizeToEnd);
             len_ -= len;
           }
@@ -566,6 +743,262 @@ namespace os
                            high_water_mark_, low_water_mark_);
       }
 
+    // ========================================================================
+
+    template<typename T>
+      circular_buffer_spsc<T>::circular_buffer_spsc (
+          value_type* buf, std::size_t siz, std::size_t high_water_mark,
+          std::size_t low_water_mark) :
+          buf_ (buf), //
+          size_ (siz), //
+          high_water_mark_ (high_water_mark <= siz ? high_water_mark : siz), //
+          low_water_mark_ (low_water_mark), //
+          back_ (0), //
+          front_ (0)
+      {
+        assert (buf_ != nullptr && size_ > 0);
+        assert (low_water_mark_ <= high_water_mark_);
+      }
+
+    template<typename T>
+      circular_buffer_spsc<T>::circular_buffer_spsc (value_type* buf,
+                                                     std::size_t siz) :
+          circular_buffer_spsc
+            { buf, siz, siz, 0 }
+      {
+        ;
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer_spsc<T>::length_ (std::size_t back,
+                                        std::size_t front) const
+      {
+        return (back >= front) ? (back - front) : (back + 2 * size_ - front);
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer_spsc<T>::index_ (std::size_t pos) const
+      {
+        return (pos < size_) ? pos : (pos - size_);
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer_spsc<T>::next_ (std::size_t pos, std::size_t count) const
+      {
+        pos += count;
+        return (pos < 2 * size_) ? pos : (pos - 2 * size_);
+      }
+
+    template<typename T>
+      void
+      circular_buffer_spsc<T>::clear (void)
+      {
+        back_.store (0, std::memory_order_relaxed);
+        front_.store (0, std::memory_order_release);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::empty (void) const
+      {
+        return (length () == 0);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::full (void) const
+      {
+        return (length () >= size_);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::above_high_water_mark (void) const
+      {
+        return (length () >= high_water_mark_);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::below_low_water_mark (void) const
+      {
+        return (length () <= low_water_mark_);
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer_spsc<T>::length (void) const
+      {
+        return length_ (back_.load (std::memory_order_acquire),
+                        front_.load (std::memory_order_acquire));
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer_spsc<T>::size (void) const
+      {
+        return size_;
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::push_back (value_type v)
+      {
+        return push_back (&v, 1);
+      }
+
+    // Return the actual number of elements, if not enough space for all.
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::push_back (const value_type* buf,
+                                          std::size_t count)
+      {
+        assert (buf != nullptr);
+
+        std::size_t back = back_.load (std::memory_order_relaxed);
+        std::size_t front = front_.load (std::memory_order_acquire);
+
+        std::size_t len = size_ - length_ (back, front);
+        if (count < len)
+          {
+            len = count;
+          }
+
+        // At most two segments, split at the wrap point.
+        std::size_t idx = index_ (back);
+        std::size_t first = size_ - idx;
+        if (first > len)
+          {
+            first = len;
+          }
+        os::utils::copy_bytes (&buf_[idx], buf, first * sizeof(value_type));
+        os::utils::copy_bytes (&buf_[0], buf + first,
+                               (len - first) * sizeof(value_type));
+
+        // Publish the elements to the consumer.
+        back_.store (next_ (back, len), std::memory_order_release);
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::back_contiguous_buffer (value_type** ppbuf)
+      {
+        assert (ppbuf != nullptr);
+
+        std::size_t back = back_.load (std::memory_order_relaxed);
+        std::size_t front = front_.load (std::memory_order_acquire);
+
+        std::size_t idx = index_ (back);
+        *ppbuf = &buf_[idx];
+
+        std::size_t len = size_ - length_ (back, front);
+        if (len > size_ - idx)
+          {
+            len = size_ - idx;
+          }
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::advance_back (std::size_t count)
+      {
+        std::size_t back = back_.load (std::memory_order_relaxed);
+        std::size_t front = front_.load (std::memory_order_acquire);
+
+        std::size_t adjust = size_ - length_ (back, front);
+        if (count < adjust)
+          {
+            adjust = count;
+          }
+
+        back_.store (next_ (back, adjust), std::memory_order_release);
+        return adjust;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::pop_front (value_type* buf)
+      {
+        return pop_front (buf, 1);
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::pop_front (value_type* buf, std::size_t siz)
+      {
+        assert (buf != nullptr);
+
+        std::size_t front = front_.load (std::memory_order_relaxed);
+        std::size_t back = back_.load (std::memory_order_acquire);
+
+        std::size_t len = length_ (back, front);
+        if (siz < len)
+          {
+            len = siz;
+          }
+
+        // At most two segments, split at the wrap point.
+        std::size_t idx = index_ (front);
+        std::size_t first = size_ - idx;
+        if (first > len)
+          {
+            first = len;
+          }
+        os::utils::copy_bytes (buf, &buf_[idx], first * sizeof(value_type));
+        os::utils::copy_bytes (buf + first, &buf_[0],
+                               (len - first) * sizeof(value_type));
+
+        // Return the space to the producer.
+        front_.store (next_ (front, len), std::memory_order_release);
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::front_contiguous_buffer (value_type** ppbuf)
+      {
+        assert (ppbuf != nullptr);
+
+        std::size_t front = front_.load (std::memory_order_relaxed);
+        std::size_t back = back_.load (std::memory_order_acquire);
+
+        std::size_t idx = index_ (front);
+        *ppbuf = &buf_[idx];
+
+        std::size_t len = length_ (back, front);
+        if (len > size_ - idx)
+          {
+            len = size_ - idx;
+          }
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::advance_front (std::size_t count)
+      {
+        std::size_t front = front_.load (std::memory_order_relaxed);
+        std::size_t back = back_.load (std::memory_order_acquire);
+
+        std::size_t adjust = length_ (back, front);
+        if (count < adjust)
+          {
+            adjust = count;
+          }
+
+        front_.store (next_ (front, adjust), std::memory_order_release);
+        return adjust;
+      }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -38,6 +38,9 @@
 #include <cmsis-plus/posix-driver/circular-buffer.h>
 #include <cmsis-plus/driver/serial.h>
 
+#include <algorithm>
+#include <cstring>
+
 // ----------------------------------------------------------------------------
 
 // TODO: (multiline)
@@ -58,6 +61,13 @@ namespace os
      * @brief Buffered serial driver class template.
      * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
      * @ingroup cmsis-plus-posix-io-driver
+     *
+     * @details
+     * The driver may use DMA; the buffer segments passed to it
+     * are cleaned before the transfers and invalidated when the
+     * bytes arrive, so, with a data cache, the circular buffers
+     * should use storage aligned to the cache line, like
+     * `os::rtos::dcache::dma_buffer`.
      */
     template<typename CS>
       class device_serial_buffered : public os::posix::device_char
@@ -115,6 +125,60 @@ namespace os
         static void
         signal_event (device_serial_buffered* object, uint32_t event);
 
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        /**
+         * @brief Get the received bytes in place.
+         * @param [out] pbuf Pointer to the location where to store
+         *  the address of the first received byte.
+         * @return The number of contiguous bytes available at _*pbuf_,
+         *  or -1 with `errno` set.
+         *
+         * @details
+         * Wait for at least one byte, like `read()`, but do not copy
+         * the data out of the receive buffer. The bytes stay valid
+         * until they are released with `consume()`. If the data wraps
+         * around the end of the buffer, only the first part is
+         * returned; consume it and call again for the rest.
+         */
+        ssize_t
+        read_view (const uint8_t** pbuf);
+
+        /**
+         * @brief Release bytes obtained with `read_view()`.
+         * @param [in] nbyte The number of bytes to release.
+         * @return The number of bytes actually released.
+         */
+        std::size_t
+        consume (std::size_t nbyte);
+
+        /**
+         * @brief Enable or disable the canonical (line) mode.
+         * @param [in] enable `true` to deliver complete lines.
+         * @param [in] eol The end of line character.
+         * @return Nothing.
+         *
+         * @details
+         * In canonical mode the interrupt handler counts the end of
+         * line characters as the bytes arrive, and wakes the readers
+         * only when a complete line is available, or when the buffer
+         * is full. `read()` returns at most one line, including the
+         * end of line character, so interactive shells no longer
+         * read byte by byte and re-scan the input for newlines.
+         */
+        void
+        canonical (bool enable, uint8_t eol = '\n');
+
         /**
          * @}
          */
@@ -139,10 +203,10 @@ namespace os
         virtual ssize_t
         do_write (const void* buf, std::size_t nbyte) override;
 
-#if 0
         virtual ssize_t
         do_writev (const struct iovec* iov, int iovcnt) override;
 
+#if 0
         virtual int
         do_vioctl (int request, std::va_list args) override;
 
@@ -156,6 +220,9 @@ namespace os
         virtual bool
         do_is_connected (void) override;
 
+        virtual int
+        do_poll_register (int events, os::rtos::semaphore* sem) override;
+
         /**
          * @}
          */
@@ -167,6 +234,21 @@ namespace os
          * @cond ignore
          */
 
+        // Count the end of line characters in the _count_ bytes
+        // stored from the _pos_ index in rx_buf_, wrapping around.
+        std::size_t
+        count_eol_ (std::size_t pos, std::size_t count) const;
+
+        // Make the bytes stored by the driver since _pos_ visible
+        // to the CPU, wrapping at the end of the buffer.
+        void
+        rx_complete_ (std::size_t pos, std::size_t count);
+
+        // Move at most one line to _buf_. Must be called in
+        // a critical section.
+        std::size_t
+        pop_line_ (uint8_t* buf, std::size_t nbyte);
+
         // Pointer to actual CMSIS-like serial driver (usart or usb cdc acm)
         os::driver::Serial* driver_ = nullptr;
 
@@ -180,7 +262,14 @@ namespace os
         os::posix::circular_buffer_bytes* rx_buf_ = nullptr;
         os::posix::circular_buffer_bytes* tx_buf_ = nullptr;
 
+        // In circular mode, the position in rx_buf_ where the
+        // driver will store the next byte.
         std::size_t rx_count_ = 0; //
+        // In canonical mode, the number of complete lines in rx_buf_.
+        std::size_t volatile rx_lines_ = 0;
+        bool rx_circular_ = false;
+        bool rx_canonical_ = false;
+        uint8_t rx_eol_ = '\n';
         bool volatile tx_busy_ = false;
         bool volatile is_connected_ = false;
         bool volatile is_opened_ = false;
@@ -267,6 +356,7 @@ namespace os
             // Clear buffers.
             rx_buf_->clear ();
             rx_count_ = 0;
+            rx_lines_ = 0;
 
             if (tx_buf_ != nullptr)
               {
@@ -327,10 +417,29 @@ namespace os
               }
           }
 
-        uint8_t* pbuf;
-        std::size_t nbyte = rx_buf_->back_contiguous_buffer (&pbuf);
+        // If possible, receive continuously in the entire buffer (like
+        // circular DMA); the interrupts come only for the half/full
+        // buffer and the idle line, not for each transfer.
+        rx_circular_ = capa.circular_receive
+            && (driver_->control (
+                os::driver::serial::Control::enable_receive_circular)
+                == os::driver::RETURN_OK);
+
+        if (rx_circular_)
+          {
+            os::rtos::dcache::prepare_receive (
+                const_cast<uint8_t*> (&(*rx_buf_)[0]), rx_buf_->size ());
+            result = driver_->receive (
+                const_cast<uint8_t*> (&(*rx_buf_)[0]), rx_buf_->size ());
+          }
+        else
+          {
+            uint8_t* pbuf;
+            std::size_t nbyte = rx_buf_->back_contiguous_buffer (&pbuf);
 
-        result = driver_->receive (pbuf, nbyte);
+            os::rtos::dcache::prepare_receive (pbuf, nbyte);
+            result = driver_->receive (pbuf, nbyte);
+          }
         if (result != os::driver::RETURN_OK)
           {
             errno = EIO;
@@ -357,6 +466,46 @@ namespace os
         return is_connected_;
       }
 
+    /**
+     * @details
+     * The receive path notifies the poller when bytes arrive,
+     * the transmit path when the buffer drains below the low
+     * water mark, and both on disconnect.
+     */
+    template<typename CS>
+      int
+      device_serial_buffered<CS>::do_poll_register (int events,
+                                                    os::rtos::semaphore* sem)
+      {
+        // Register before checking, to not miss a change in between.
+        poll_sem_ = sem;
+
+        int ready = 0;
+          {
+            // ----- Enter critical section -----------------------------------
+            critical_section cs;
+
+            if ((events & (POLLIN | POLLRDNORM))
+                && (rx_canonical_ ?
+                    (rx_lines_ > 0 || rx_buf_->full ()) : !rx_buf_->empty ()))
+              {
+                ready |= (events & (POLLIN | POLLRDNORM));
+              }
+            if ((events & POLLOUT)
+                && (tx_buf_ == nullptr ?
+                    !tx_busy_ : tx_buf_->below_high_water_mark ()))
+              {
+                ready |= POLLOUT;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+        if (!is_connected_)
+          {
+            ready |= POLLHUP;
+          }
+        return ready;
+      }
+
     template<typename CS>
       int
       device_serial_buffered<CS>::do_close (void)
@@ -397,6 +546,14 @@ namespace os
         ret = driver_->control (os::driver::serial::Control::disable_break);
         assert (ret == os::driver::RETURN_OK);
 
+        if (rx_circular_)
+          {
+            ret = driver_->control (
+                os::driver::serial::Control::disable_receive_circular);
+            assert (ret == os::driver::RETURN_OK);
+            rx_circular_ = false;
+          }
+
         is_opened_ = false;
         is_connected_ = false;
 
@@ -417,7 +574,20 @@ namespace os
                 // ----- Enter critical section -------------------------------
                 critical_section cs;
 
-                count = rx_buf_->pop_front (static_cast<uint8_t*> (buf), nbyte);
+                if (!rx_canonical_)
+                  {
+                    count = rx_buf_->pop_front (static_cast<uint8_t*> (buf),
+                                                nbyte);
+                  }
+                else if (rx_lines_ > 0 || rx_buf_->full ())
+                  {
+                    count = pop_line_ (static_cast<uint8_t*> (buf), nbyte);
+                  }
+                else
+                  {
+                    // Wait for the line to be completed.
+                    count = 0;
+                  }
                 // ----- Exit critical section --------------------------------
               }
             if (count > 0)
@@ -431,8 +601,162 @@ namespace os
                 return -1;
               }
             // Block and wait for bytes to arrive.
-            rx_sem_.wait ();
+            if (wait_for_io (rx_sem_, false) < 0)
+              {
+                return -1;
+              }
+          }
+      }
+
+    template<typename CS>
+      ssize_t
+      device_serial_buffered<CS>::read_view (const uint8_t** pbuf)
+      {
+        assert (pbuf != nullptr);
+
+        if (!is_opened_)
+          {
+            errno = EBADF; // Not opened.
+            return -1;
+          }
+
+        while (true)
+          {
+            uint8_t* p;
+            std::size_t count;
+              {
+                // ----- Enter critical section -------------------------------
+                critical_section cs;
+
+                count = rx_buf_->front_contiguous_buffer (&p);
+                // ----- Exit critical section --------------------------------
+              }
+            if (count > 0)
+              {
+                *pbuf = p;
+                return static_cast<ssize_t> (count);
+              }
+            if (!is_connected_)
+              {
+                errno = EIO;
+                return -1;
+              }
+            // Block and wait for bytes to arrive.
+            if (wait_for_io (rx_sem_, false) < 0)
+              {
+                return -1;
+              }
+          }
+      }
+
+    template<typename CS>
+      std::size_t
+      device_serial_buffered<CS>::consume (std::size_t nbyte)
+      {
+        // ----- Enter critical section ---------------------------------------
+        critical_section cs;
+
+        return rx_buf_->advance_front (nbyte);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    template<typename CS>
+      void
+      device_serial_buffered<CS>::canonical (bool enable, uint8_t eol)
+      {
+        // ----- Enter critical section ---------------------------------------
+        critical_section cs;
+
+        rx_canonical_ = enable;
+        rx_eol_ = eol;
+
+        // Count the lines already in the buffer.
+        uint8_t* p;
+        rx_buf_->front_contiguous_buffer (&p);
+        rx_lines_ = count_eol_ (
+            static_cast<std::size_t> (p - &(*rx_buf_)[0]), rx_buf_->length ());
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    template<typename CS>
+      std::size_t
+      device_serial_buffered<CS>::count_eol_ (std::size_t pos,
+                                              std::size_t count) const
+      {
+        if (!rx_canonical_)
+          {
+            return 0;
+          }
+
+        const uint8_t* buf = &(*rx_buf_)[0];
+        std::size_t size = rx_buf_->size ();
+        std::size_t lines = 0;
+        while (count > 0)
+          {
+            // Scan in at most two contiguous segments.
+            std::size_t n = std::min (count, size - pos);
+            const uint8_t* q = buf + pos;
+            const uint8_t* end = q + n;
+            while ((q = static_cast<const uint8_t*> (std::memchr (
+                q, rx_eol_, static_cast<std::size_t> (end - q)))) != nullptr)
+              {
+                ++lines;
+                ++q;
+              }
+            count -= n;
+            pos = 0;
+          }
+        return lines;
+      }
+
+    template<typename CS>
+      void
+      device_serial_buffered<CS>::rx_complete_ (std::size_t pos,
+                                                std::size_t count)
+      {
+        uint8_t* buf = const_cast<uint8_t*> (&(*rx_buf_)[0]);
+        std::size_t size = rx_buf_->size ();
+        while (count > 0)
+          {
+            std::size_t n = std::min (count, size - pos);
+            os::rtos::dcache::complete_receive (buf + pos, n);
+            count -= n;
+            pos = 0;
+          }
+      }
+
+    template<typename CS>
+      std::size_t
+      device_serial_buffered<CS>::pop_line_ (uint8_t* buf, std::size_t nbyte)
+      {
+        std::size_t count = 0;
+        while (count < nbyte)
+          {
+            uint8_t* p;
+            std::size_t n = rx_buf_->front_contiguous_buffer (&p);
+            if (n == 0)
+              {
+                break;
+              }
+            n = std::min (n, nbyte - count);
+            const uint8_t* q = static_cast<const uint8_t*> (std::memchr (
+                p, rx_eol_, n));
+            if (q != nullptr)
+              {
+                n = static_cast<std::size_t> (q - p) + 1;
+              }
+            count += rx_buf_->pop_front (buf + count, n);
+            if (q != nullptr)
+              {
+                // Overruns may have dropped counted lines.
+                if (rx_lines_ > 0)
+                  {
+                    --rx_lines_;
+                  }
+                break;
+              }
           }
+        return count;
       }
 
     template<typename CS>
@@ -483,6 +807,7 @@ namespace os
                       }
                     if (nb > 0)
                       {
+                        os::rtos::dcache::prepare_transmit (pbuf, nb);
                         if (driver_->send (pbuf, nb) != os::driver::RETURN_OK)
                           {
                             errno = EIO;
@@ -514,7 +839,10 @@ namespace os
                   }
 
                 // Block and wait for buffer to be freed.
-                tx_sem_.wait ();
+                if (wait_for_io (tx_sem_, true) < 0)
+                  {
+                    return (count > 0) ? static_cast<ssize_t> (count) : -1;
+                  }
 
                 if (count < nbyte)
                   {
@@ -549,9 +877,15 @@ namespace os
                   {
                     break;
                   }
-                tx_sem_.wait ();
+                if (wait_for_io (tx_sem_, true) < 0)
+                  {
+                    return -1;
+                  }
               }
 
+            // Once started, the transfer from the user buffer
+            // must complete, regardless of O_NONBLOCK.
+            os::rtos::dcache::prepare_transmit (buf, nbyte);
             if ((driver_->send (buf, nbyte)) == os::driver::RETURN_OK)
               {
                 for (;;)
@@ -582,15 +916,141 @@ namespace os
         return count;
       }
 
-#if 0
+    /**
+     * @details
+     * All segments that fit are pushed into the transmit buffer
+     * in a single critical section and the transmitter is started
+     * once, instead of once per segment. If the buffer fills up,
+     * the rest is written with `do_write()`, which waits for space.
+     *
+     * Without a transmit buffer, the segments are sent directly from
+     * the user buffers, with a single scatter-gather transfer.
+     */
     template<typename CS>
-    ssize_t
-    device_serial_buffered<CS>::do_writev (const struct iovec* iov, int iovcnt)
+      ssize_t
+      device_serial_buffered<CS>::do_writev (const struct iovec* iov,
+                                             int iovcnt)
       {
-        errno = ENOSYS; // Not implemented
-        return -1;
+        if (tx_buf_ == nullptr)
+          {
+            // Wait for the previous transfer.
+            for (;;)
+              {
+                if (!is_connected_)
+                  {
+                    errno = EIO;
+                    return -1;
+                  }
+
+                if (!driver_->get_status ().is_tx_busy ())
+                  {
+                    break;
+                  }
+                if (wait_for_io (tx_sem_, true) < 0)
+                  {
+                    return -1;
+                  }
+              }
+
+            for (int i = 0; i < iovcnt; ++i)
+              {
+                os::rtos::dcache::prepare_transmit (iov[i].iov_base,
+                                                    iov[i].iov_len);
+              }
+
+            // Once started, the transfer from the user buffers
+            // must complete, regardless of O_NONBLOCK.
+            if (driver_->transfer_sg (iov, nullptr,
+                                      static_cast<std::size_t> (iovcnt))
+                != os::driver::RETURN_OK)
+              {
+                errno = EIO;
+                return -1;
+              }
+            while (driver_->get_status ().is_tx_busy ())
+              {
+                if (!is_connected_)
+                  {
+                    errno = EIO;
+                    return -1;
+                  }
+                tx_sem_.wait ();
+              }
+            return static_cast<ssize_t> (driver_->get_tx_count ());
+          }
+
+        std::size_t count = 0;
+        std::size_t n = 0;
+        int i = 0;
+          {
+            // ----- Enter critical section -----------------------------------
+            critical_section cs;
+
+            for (; i < iovcnt; ++i)
+              {
+                n = tx_buf_->push_back (
+                    static_cast<const uint8_t*> (iov[i].iov_base),
+                    iov[i].iov_len);
+                count += n;
+                if (n < iov[i].iov_len)
+                  {
+                    break;
+                  }
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        os::driver::serial::Status status;
+          {
+            // ----- Enter critical section -----------------------------------
+            critical_section cs;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waggregate-return"
+            status = driver_->get_status ();
+#pragma GCC diagnostic pop
+
+            // ----- Exit critical section ------------------------------------
+          }
+        if (!status.tx_busy)
+          {
+            uint8_t* pbuf;
+            std::size_t nb;
+              {
+                // ----- Enter critical section -------------------------------
+                critical_section cs;
+
+                nb = tx_buf_->front_contiguous_buffer (&pbuf);
+                // ----- Exit critical section --------------------------------
+              }
+            if (nb > 0)
+              {
+                os::rtos::dcache::prepare_transmit (pbuf, nb);
+                if (driver_->send (pbuf, nb) != os::driver::RETURN_OK)
+                  {
+                    errno = EIO;
+                    return -1;
+                  }
+              }
+          }
+
+        // The buffer is full; wait for space for the remaining bytes.
+        for (; i < iovcnt; ++i, n = 0)
+          {
+            ssize_t ret = do_write (
+                static_cast<const uint8_t*> (iov[i].iov_base) + n,
+                iov[i].iov_len - n);
+            if (ret < 0)
+              {
+                return (count > 0) ? static_cast<ssize_t> (count) : ret;
+              }
+            count += static_cast<std::size_t> (ret);
+          }
+
+        return static_cast<ssize_t> (count);
       }
 
+#if 0
     template<typename CS>
     int
     device_serial_buffered<CS>::do_vioctl (int request, std::va_list args)
@@ -620,15 +1080,76 @@ namespace os
             // After close(), ignore interrupts.
             return;
           }
-        if ((event
+        if (object->rx_circular_
+            && (event
+                & (os::driver::serial::Event::receive_complete
+                    | os::driver::serial::Event::rx_half_complete
+                    | os::driver::serial::Event::rx_framing_error
+                    | os::driver::serial::Event::rx_timeout
+                    | os::driver::serial::Event::rx_idle)))
+          {
+            // The driver keeps receiving; only account for the
+            // bytes stored since the previous event.
+            std::size_t size = object->rx_buf_->size ();
+            std::size_t pos = object->driver_->get_rx_count () % size;
+            std::size_t count;
+            if (pos >= object->rx_count_)
+              {
+                count = pos - object->rx_count_;
+              }
+            else
+              {
+                count = pos + size - object->rx_count_;
+              }
+            if ((count == 0)
+                && (event & os::driver::serial::Event::receive_complete))
+              {
+                // Exactly one full buffer.
+                count = size;
+              }
+            object->rx_complete_ (object->rx_count_, count);
+            std::size_t lines = object->count_eol_ (object->rx_count_, count);
+            object->rx_count_ = pos;
+
+            std::size_t adjust = object->rx_buf_->advance_back (count);
+            if (adjust < count)
+              {
+                // The reader was too slow and the oldest bytes
+                // were overwritten; drop them.
+                object->rx_buf_->advance_front (count - adjust);
+                object->rx_buf_->advance_back (count - adjust);
+              }
+
+            object->rx_lines_ += lines;
+
+            if ((count > 0)
+                && (!object->rx_canonical_ || (lines > 0)
+                    || object->rx_buf_->full ()))
+              {
+                object->rx_sem_.post ();
+                object->poll_notify ();
+              }
+          }
+        else if ((event
             & (os::driver::serial::Event::receive_complete
                 | os::driver::serial::Event::rx_framing_error
-                | os::driver::serial::Event::rx_timeout)))
+                | os::driver::serial::Event::rx_timeout
+                | os::driver::serial::Event::rx_idle)))
           {
             // TODO: process errors and timeouts
             std::size_t tmpCount = object->driver_->get_rx_count ();
             std::size_t count = tmpCount - object->rx_count_;
             object->rx_count_ = tmpCount;
+
+            // The new bytes were stored at the back of the buffer.
+            uint8_t* pback;
+            object->rx_buf_->back_contiguous_buffer (&pback);
+            os::rtos::dcache::complete_receive (pback, count);
+            std::size_t lines = object->count_eol_ (
+                static_cast<std::size_t> (pback - &(*object->rx_buf_)[0]),
+                count);
+            object->rx_lines_ += lines;
+
             std::size_t adjust = object->rx_buf_->advance_back (count);
             assert (count == adjust);
 
@@ -647,6 +1168,7 @@ namespace os
                 assert (nbyte > 0);
 
                 // Read as much as we can.
+                os::rtos::dcache::prepare_receive (pbuf, nbyte);
                 int32_t status;
                 status = object->driver_->receive (pbuf, nbyte);
                 // TODO: implement error processing.
@@ -654,10 +1176,13 @@ namespace os
 
                 object->rx_count_ = 0;
               }
-            if (count > 0)
+            if ((count > 0)
+                && (!object->rx_canonical_ || (lines > 0)
+                    || object->rx_buf_->full ()))
               {
                 // Immediately wake up, do not wait to reach any water mark.
                 object->rx_sem_.post ();
+                object->poll_notify ();
               }
           }
         if (event & os::driver::serial::Event::tx_complete)
@@ -673,6 +1198,7 @@ namespace os
                     &pbuf);
                 if (nbyte > 0)
                   {
+                    os::rtos::dcache::prepare_transmit (pbuf, nbyte);
                     int32_t status;
                     status = object->driver_->send (pbuf, nbyte);
                     // TODO: implement error processing
@@ -686,12 +1212,14 @@ namespace os
                   {
                     // Wake up thread, to come and send more bytes.
                     object->tx_sem_.post ();
+                    object->poll_notify ();
                   }
               }
             else
               {
                 // No buffer, wake up the thread to return from write().
                 object->tx_sem_.post ();
+                object->poll_notify ();
               }
           }
         if (event & os::driver::serial::Event::dcd)
@@ -713,6 +1241,9 @@ namespace os
 
                 // Cancel write.
                 object->tx_sem_.post ();
+
+                // Report the hang-up.
+                object->poll_notify ();
               }
           }
         if (event & os::driver::serial::Event::cts)
@@ -0,0 +1,773 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHE_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/block-device.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class block_device_cache_impl;
+
+    // ========================================================================
+
+    /**
+     * @brief Block device cache class.
+     * @headerfile block-device-cache.h <cmsis-plus/posix-io/block-device-cache.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * A block device that keeps the most recently used blocks of
+     * a parent block device in RAM. Writes are kept in the cache
+     * and written back to the parent when the block is evicted,
+     * on `sync()`, on the last `close()` and, if configured,
+     * when the flush interval expires. Adjacent dirty blocks
+     * are merged into a single multi-block write, extended over
+     * the cached clean blocks to the transfer unit boundaries
+     * of the parent (`BLKIOOPT`).
+     *
+     * Sequential reads can prefetch the following blocks
+     * with a single multi-block read; the window is set with
+     * the `BLKRASET` ioctl.
+     */
+    class block_device_cache : public block_device
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_cache (block_device_impl& impl, const char* name);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_cache (const block_device_cache&) = delete;
+      block_device_cache (block_device_cache&&) = delete;
+      block_device_cache&
+      operator= (const block_device_cache&) = delete;
+      block_device_cache&
+      operator= (block_device_cache&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_cache ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Get the number of reads served from the cache.
+       * @par Parameters
+       *  None.
+       * @return The number of hits.
+       */
+      std::size_t
+      hits (void);
+
+      /**
+       * @brief Get the number of reads forwarded to the parent.
+       * @par Parameters
+       *  None.
+       * @return The number of misses.
+       */
+      std::size_t
+      misses (void);
+
+      /**
+       * @brief Set the interval after which dirty blocks are written back.
+       * @param [in] ticks The interval, in system clock ticks; 0 to disable.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      flush_interval (rtos::clock::duration_t ticks);
+
+      /**
+       * @brief Get the flush interval.
+       * @par Parameters
+       *  None.
+       * @return The interval, in system clock ticks.
+       */
+      rtos::clock::duration_t
+      flush_interval (void);
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      block_device_cache_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    class block_device_cache_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend block_device_cache;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_cache_impl (block_device& parent, std::size_t blocks,
+                               rtos::memory::memory_resource* resource =
+                                   nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_cache_impl (const block_device_cache_impl&) = delete;
+      block_device_cache_impl (block_device_cache_impl&&) = delete;
+      block_device_cache_impl&
+      operator= (const block_device_cache_impl&) = delete;
+      block_device_cache_impl&
+      operator= (block_device_cache_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_cache_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual const void*
+      do_map (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual int
+      do_erase (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      struct entry_t
+      {
+        blknum_t blknum;
+        std::size_t stamp;
+        uint8_t* data;
+        bool valid;
+        bool dirty;
+      };
+
+      entry_t*
+      find_ (blknum_t blknum);
+
+      entry_t*
+      victim_ (void);
+
+      int
+      write_back_ (entry_t& entry);
+
+      int
+      flush_ (void);
+
+      void
+      drop_ (blknum_t blknum, std::size_t nblocks);
+
+      void
+      check_interval_ (void);
+
+      void
+      release_ (void);
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+      static void
+      describe_footprint_ (const void* object, rtos::footprint::item& it);
+
+#endif
+
+      // ----------------------------------------------------------------------
+
+      block_device& parent_;
+
+      rtos::memory::memory_resource* resource_;
+
+      std::size_t cache_blocks_;
+
+      // Allocated on open(), the block buffers, aligned to the cache
+      // line, followed by the entries; entry i always uses buffer i,
+      // so neighbouring slots are contiguous in memory.
+      entry_t* entries_ = nullptr;
+      std::size_t allocated_bytes_ = 0;
+
+      // Incremented on each access, the oldest stamp is evicted first.
+      std::size_t stamp_ = 0;
+
+      std::size_t hits_ = 0;
+      std::size_t misses_ = 0;
+
+      rtos::clock::duration_t flush_interval_ = 0;
+      rtos::clock::timestamp_t dirty_since_ = 0;
+      bool dirty_ = false;
+
+      // Set via BLKRASET; 0 disables read-ahead.
+      std::size_t readahead_blocks_ = 0;
+      // The block following the last one read, to detect sequential reads.
+      blknum_t next_blknum_ = 0;
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+      // The last member, registered when all others are initialised.
+      rtos::footprint::node footprint_node_
+        { "cache", this, describe_footprint_ };
+#endif
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    template<typename T = block_device_cache_impl>
+      class block_device_cache_implementable : public block_device_cache
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_cache_implementable (const char* name,
+                                            block_device& parent,
+                                            Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_cache_implementable (
+            const block_device_cache_implementable&) = delete;
+        block_device_cache_implementable (block_device_cache_implementable&&) = delete;
+        block_device_cache_implementable&
+        operator= (const block_device_cache_implementable&) = delete;
+        block_device_cache_implementable&
+        operator= (block_device_cache_implementable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_cache_implementable ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Include the implementation as a member.
+        value_type impl_instance_;
+
+        /**
+         * @endcond
+         */
+      };
+
+    // ========================================================================
+
+    template<typename T, typename L>
+      class block_device_cache_lockable : public block_device_cache
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+        using lockable_type = L;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_cache_lockable (const char* name, block_device& parent,
+                                       lockable_type& locker, Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_cache_lockable (const block_device_cache_lockable&) = delete;
+        block_device_cache_lockable (block_device_cache_lockable&&) = delete;
+        block_device_cache_lockable&
+        operator= (const block_device_cache_lockable&) = delete;
+        block_device_cache_lockable&
+        operator= (block_device_cache_lockable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_cache_lockable () override;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        virtual int
+        vioctl (int request, std::va_list args) override;
+
+        virtual ssize_t
+        read_block (void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual ssize_t
+        write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual const void*
+        map (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual int
+        discard (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual int
+        erase (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual void
+        sync (void) override;
+
+        // --------------------------------------------------------------------
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Include the implementation as a member.
+        value_type impl_instance_;
+
+        lockable_type& locker_;
+
+        /**
+         * @endcond
+         */
+      };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wweak-template-vtables"
+#endif
+
+    extern template class block_device_cache_implementable<
+        block_device_cache_impl> ;
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline block_device_cache_impl&
+    block_device_cache::impl (void) const
+    {
+      return static_cast<block_device_cache_impl&> (impl_);
+    }
+
+    inline std::size_t
+    block_device_cache::hits (void)
+    {
+      return impl ().hits_;
+    }
+
+    inline std::size_t
+    block_device_cache::misses (void)
+    {
+      return impl ().misses_;
+    }
+
+    inline rtos::clock::duration_t
+    block_device_cache::flush_interval (void)
+    {
+      return impl ().flush_interval_;
+    }
+
+    // ========================================================================
+
+    template<typename T>
+      template<typename ... Args>
+        block_device_cache_implementable<T>::block_device_cache_implementable (
+            const char* name, block_device& parent, Args&&... args) :
+            block_device_cache
+              { impl_instance_, name }, //
+            impl_instance_
+              { parent, std::forward<Args>(args)... }
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+          trace::printf (trace::posix_io_block_device_cache,
+                         "block_device_cache_implementable::%s(\"%s\")=@%p\n",
+                         __func__, name_, this);
+#endif
+        }
+
+    template<typename T>
+      block_device_cache_implementable<T>::~block_device_cache_implementable ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_implementable::%s() @%p %s\n",
+                       __func__, this, name_);
+#endif
+      }
+
+    template<typename T>
+      typename block_device_cache_implementable<T>::value_type&
+      block_device_cache_implementable<T>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+    // ========================================================================
+
+    template<typename T, typename L>
+      template<typename ... Args>
+        block_device_cache_lockable<T, L>::block_device_cache_lockable (
+            const char* name, block_device& parent, lockable_type& locker,
+            Args&&... args) :
+            block_device_cache
+              { impl_instance_, name }, //
+            impl_instance_
+              { parent, std::forward<Args>(args)... }, //
+            locker_ (locker)
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+          trace::printf (trace::posix_io_block_device_cache,
+                         "block_device_cache_lockable::%s(\"%s\")=@%p\n",
+                         __func__, name_, this);
+#endif
+        }
+
+    template<typename T, typename L>
+      block_device_cache_lockable<T, L>::~block_device_cache_lockable ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s() @%p %s\n", __func__,
+                       this, name_);
+#endif
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::vioctl (int request,
+                                                 std::va_list args)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s(%d) @%p\n", __func__,
+                       request, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::vioctl (request, args);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::read_block (void* buf,
+                                                     blknum_t blknum,
+                                                     std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s(%p, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::read_block (buf, blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::write_block (const void* buf,
+                                                      blknum_t blknum,
+                                                      std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s(%p, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::write_block (buf, blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      const void*
+      block_device_cache_lockable<T, L>::map (blknum_t blknum,
+                                              std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::map (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::discard (blknum_t blknum,
+                                                  std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::discard (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::erase (blknum_t blknum,
+                                                std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::erase (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      void
+      block_device_cache_lockable<T, L>::sync (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf (trace::posix_io_block_device_cache,
+                       "block_device_cache_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::sync ();
+      }
+
+    template<typename T, typename L>
+      typename block_device_cache_lockable<T, L>::value_type&
+      block_device_cache_lockable<T, L>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHE_H_ */
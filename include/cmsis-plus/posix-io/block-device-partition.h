@@ -102,6 +102,34 @@ namespace os
       void
       configure (blknum_t offset, blknum_t nblocks);
 
+      /**
+       * @brief Align a block number down to an erase unit of the parent.
+       * @param [in] blknum The partition block number.
+       * @return The first block of the erase unit, clamped to
+       *  the partition start.
+       */
+      blknum_t
+      erase_align_down (blknum_t blknum);
+
+      /**
+       * @brief Align a block number up to an erase unit of the parent.
+       * @param [in] blknum The partition block number.
+       * @return The first block of the next erase unit, if not already
+       *  aligned, clamped to the partition end.
+       */
+      blknum_t
+      erase_align_up (blknum_t blknum);
+
+      /**
+       * @brief Check if a range covers entire erase units of the parent.
+       * @param [in] blknum The first partition block.
+       * @param [in] nblocks The number of blocks.
+       * @retval true Writing the range needs no read-modify-erase-write.
+       * @retval false The range starts or ends inside an erase unit.
+       */
+      bool
+      is_erase_aligned (blknum_t blknum, std::size_t nblocks);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -179,6 +207,15 @@ namespace os
       do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
           override;
 
+      virtual const void*
+      do_map (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual int
+      do_erase (blknum_t blknum, std::size_t nblocks) override;
+
       virtual void
       do_sync (void) override;
 
@@ -363,6 +400,15 @@ namespace os
         write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
             override;
 
+        virtual const void*
+        map (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual int
+        discard (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual int
+        erase (blknum_t blknum, std::size_t nblocks = 1) override;
+
         // --------------------------------------------------------------------
         // Support functions.
 
@@ -432,7 +478,7 @@ namespace os
               { parent, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-          trace::printf (
+          trace::printf (trace::posix_io_block_device_partition, 
               "block_device_partition_implementable::%s(\"%s\")=@%p\n",
               __func__, name_, this);
 #endif
@@ -442,7 +488,8 @@ namespace os
       block_device_partition_implementable<T>::~block_device_partition_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_implementable::%s() @%p %s\n",
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_implementable::%s() @%p %s\n",
                        __func__, this, name_);
 #endif
       }
@@ -468,7 +515,8 @@ namespace os
             locker_ (locker)
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-          trace::printf ("block_device_partition_lockable::%s(\"%s\")=@%p\n",
+          trace::printf (trace::posix_io_block_device_partition,
+                         "block_device_partition_lockable::%s(\"%s\")=@%p\n",
                          __func__, name_, this);
 #endif
 
@@ -478,7 +526,8 @@ namespace os
       block_device_partition_lockable<T, L>::~block_device_partition_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s() @%p %s\n",
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_lockable::%s() @%p %s\n",
                        __func__, this, name_);
 #endif
       }
@@ -491,7 +540,8 @@ namespace os
                                                      std::va_list args)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s(%d) @%p\n",
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_lockable::%s(%d) @%p\n",
                        __func__, request, this);
 #endif
 
@@ -508,7 +558,8 @@ namespace os
                                                          std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
                        __func__, buf, blknum, nblocks, this);
 #endif
 
@@ -525,7 +576,8 @@ namespace os
                                                           std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
                        __func__, buf, blknum, nblocks, this);
 #endif
 
@@ -535,6 +587,57 @@ namespace os
         return block_device_partition::write_block (buf, blknum, nblocks);
       }
 
+    template<typename T, typename L>
+      const void*
+      block_device_partition_lockable<T, L>::map (blknum_t blknum,
+                                                  std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_partition::map (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_partition_lockable<T, L>::discard (blknum_t blknum,
+                                                      std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_partition::discard (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_partition_lockable<T, L>::erase (blknum_t blknum,
+                                                    std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+        trace::printf (trace::posix_io_block_device_partition,
+                       "block_device_partition_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_partition::erase (blknum, nblocks);
+      }
+
     template<typename T, typename L>
       typename block_device_partition_lockable<T, L>::value_type&
       block_device_partition_lockable<T, L>::impl (void) const
@@ -0,0 +1,482 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_QUEUED_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_QUEUED_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/block-device.h>
+
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_BLOCK_DEVICE_QUEUE_URGENT_PRIORITY)
+#define OS_INTEGER_POSIX_IO_BLOCK_DEVICE_QUEUE_URGENT_PRIORITY \
+  (os::rtos::thread::priority::high)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @brief Block device with an ordered request queue.
+     * @headerfile block-device-queued.h <cmsis-plus/posix-io/block-device-queued.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * A lockable block device that, instead of serving the
+     * concurrent `read_block()`/`write_block()` calls in arrival
+     * order, keeps them in a pending queue and dispatches them
+     * in elevator (C-LOOK) order, i.e. ascending by block number
+     * starting from the current position, wrapping to the lowest
+     * pending block. Adjacent requests are thus served back to back.
+     *
+     * Reads issued by threads with a priority of at least
+     * `OS_INTEGER_POSIX_IO_BLOCK_DEVICE_QUEUE_URGENT_PRIORITY`
+     * bypass the elevator and are served first.
+     *
+     * Requests that overlap an earlier pending request, when any
+     * of them is a write, are never moved ahead of it.
+     *
+     * There is no separate I/O thread; the first caller that
+     * finds the queue idle becomes the dispatcher and serves all
+     * pending requests, including those queued by other threads
+     * meanwhile, until the queue is empty.
+     *
+     * All other operations are serialised with the locker, as
+     * in `block_device_lockable`.
+     */
+    template<typename T, typename L>
+      class block_device_queued : public block_device_lockable<T, L>
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+        using lockable_type = L;
+        using blknum_t = block_device::blknum_t;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_queued (const char* name, lockable_type& locker,
+                               Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_queued (const block_device_queued&) = delete;
+        block_device_queued (block_device_queued&&) = delete;
+        block_device_queued&
+        operator= (const block_device_queued&) = delete;
+        block_device_queued&
+        operator= (block_device_queued&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_queued () override;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        virtual ssize_t
+        read_block (void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual ssize_t
+        write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        /**
+         * @brief Get the number of requests served out of arrival order.
+         * @par Parameters
+         *  None.
+         * @return The number of reordered requests.
+         */
+        std::size_t
+        reordered (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        struct request_t
+        {
+          request_t* next;
+          void* buf;
+          blknum_t blknum;
+          std::size_t nblocks;
+          rtos::thread::priority_t prio;
+          bool write;
+          ssize_t result;
+          int error;
+          rtos::semaphore_binary* sem;
+        };
+
+        ssize_t
+        submit_ (request_t& req);
+
+        void
+        dispatch_ (void);
+
+        request_t*
+        pick_ (void);
+
+        bool
+        blocked_ (request_t* req);
+
+        // --------------------------------------------------------------------
+
+        // Pending requests, in arrival order.
+        request_t* head_ = nullptr;
+
+        // The block following the last dispatched request.
+        blknum_t position_ = 0;
+
+        std::size_t reordered_ = 0;
+
+        bool dispatching_ = false;
+
+        /**
+         * @endcond
+         */
+      };
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    template<typename T, typename L>
+      template<typename ... Args>
+        block_device_queued<T, L>::block_device_queued (const char* name,
+                                                        lockable_type& locker,
+                                                        Args&&... args) :
+            block_device_lockable<T, L>
+              { name, locker, std::forward<Args>(args)... }
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+          trace::printf (trace::posix_io_block_device,
+                         "block_device_queued::%s(\"%s\")=@%p\n", __func__,
+                         this->name_, this);
+#endif
+        }
+
+    template<typename T, typename L>
+      block_device_queued<T, L>::~block_device_queued ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_queued::%s() @%p %s\n", __func__, this,
+                       this->name_);
+#endif
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queued<T, L>::read_block (void* buf, blknum_t blknum,
+                                             std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_queued::%s(%p, %u, %u) @%p\n", __func__,
+                       buf, blknum, nblocks, this);
+#endif
+
+        request_t req;
+        req.buf = buf;
+        req.blknum = blknum;
+        req.nblocks = nblocks;
+        req.write = false;
+
+        return submit_ (req);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queued<T, L>::write_block (const void* buf, blknum_t blknum,
+                                              std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_queued::%s(%p, %u, %u) @%p\n", __func__,
+                       buf, blknum, nblocks, this);
+#endif
+
+        request_t req;
+        req.buf = const_cast<void*> (buf);
+        req.blknum = blknum;
+        req.nblocks = nblocks;
+        req.write = true;
+
+        return submit_ (req);
+      }
+
+    template<typename T, typename L>
+      inline std::size_t
+      block_device_queued<T, L>::reordered (void) const
+      {
+        return reordered_;
+      }
+
+    /**
+     * @details
+     * Append the request to the pending queue. If no other thread
+     * is dispatching, the caller becomes the dispatcher, otherwise
+     * it waits for the dispatcher to complete the request.
+     */
+    template<typename T, typename L>
+      ssize_t
+      block_device_queued<T, L>::submit_ (request_t& req)
+      {
+        rtos::semaphore_binary sem
+          { "bdq", 0 };
+
+        req.next = nullptr;
+        req.prio = rtos::this_thread::thread ().priority ();
+        req.result = -1;
+        req.error = 0;
+        req.sem = &sem;
+
+        bool lead;
+          {
+            rtos::scheduler::critical_section scs;
+
+            request_t** pp = &head_;
+            while (*pp != nullptr)
+              {
+                pp = &(*pp)->next;
+              }
+            *pp = &req;
+
+            lead = !dispatching_;
+            dispatching_ = true;
+          }
+
+        if (lead)
+          {
+            // Returns only when the queue is empty, thus
+            // this request was also served.
+            dispatch_ ();
+          }
+        else
+          {
+            sem.wait ();
+          }
+
+        if (req.result < 0)
+          {
+            errno = req.error;
+          }
+        return req.result;
+      }
+
+    template<typename T, typename L>
+      void
+      block_device_queued<T, L>::dispatch_ (void)
+      {
+        for (;;)
+          {
+            request_t* req;
+              {
+                rtos::scheduler::critical_section scs;
+
+                req = pick_ ();
+                if (req == nullptr)
+                  {
+                    dispatching_ = false;
+                    return;
+                  }
+
+                // Unlink it from the pending queue.
+                request_t** pp = &head_;
+                while (*pp != req)
+                  {
+                    pp = &(*pp)->next;
+                  }
+                if (pp != &head_)
+                  {
+                    ++reordered_;
+                  }
+                *pp = req->next;
+
+                position_ = req->blknum + req->nblocks;
+              }
+
+            if (req->write)
+              {
+                req->result = block_device_lockable<T, L>::write_block (
+                    req->buf, req->blknum, req->nblocks);
+              }
+            else
+              {
+                req->result = block_device_lockable<T, L>::read_block (
+                    req->buf, req->blknum, req->nblocks);
+              }
+            req->error = errno;
+
+              {
+                // Prevent the waiter from running, and destroying
+                // the semaphore, before post() returns.
+                rtos::scheduler::critical_section scs;
+
+                req->sem->post ();
+              }
+          }
+      }
+
+    /**
+     * @details
+     * Called with the scheduler locked; returns the next request
+     * to be served, or `nullptr` if the queue is empty.
+     */
+    template<typename T, typename L>
+      typename block_device_queued<T, L>::request_t*
+      block_device_queued<T, L>::pick_ (void)
+      {
+        request_t* urgent = nullptr;
+        request_t* up = nullptr;
+        request_t* low = nullptr;
+
+        for (request_t* p = head_; p != nullptr; p = p->next)
+          {
+            if (blocked_ (p))
+              {
+                continue;
+              }
+
+            if (!p->write
+                && (p->prio
+                    >= OS_INTEGER_POSIX_IO_BLOCK_DEVICE_QUEUE_URGENT_PRIORITY)
+                && (urgent == nullptr || p->prio > urgent->prio))
+              {
+                urgent = p;
+              }
+
+            if (p->blknum >= position_
+                && (up == nullptr || p->blknum < up->blknum))
+              {
+                up = p;
+              }
+
+            if (low == nullptr || p->blknum < low->blknum)
+              {
+                low = p;
+              }
+          }
+
+        if (urgent != nullptr)
+          {
+            return urgent;
+          }
+
+        return (up != nullptr) ? up : low;
+      }
+
+    /**
+     * @details
+     * A request is blocked if it overlaps an earlier pending
+     * request and any of the two is a write.
+     */
+    template<typename T, typename L>
+      bool
+      block_device_queued<T, L>::blocked_ (request_t* req)
+      {
+        for (request_t* p = head_; p != req; p = p->next)
+          {
+            if ((p->write || req->write)
+                && (p->blknum < req->blknum + req->nblocks)
+                && (req->blknum < p->blknum + p->nblocks))
+              {
+                return true;
+              }
+          }
+        return false;
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_QUEUED_H_ */
@@ -0,0 +1,243 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/block-device.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief RAM disk block device implementation.
+     * @headerfile block-device-ram.h <cmsis-plus/posix-io/block-device-ram.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * The blocks are kept in a memory region, either given by the
+     * application (for example a preloaded file system image)
+     * or allocated from a memory resource on the first `open()`
+     * and kept until the object is destroyed.
+     *
+     * `map()` returns pointers inside the region, without copies.
+     *
+     * With lazy zeroing, the device starts with all blocks zero,
+     * but the memory above a high water mark is not touched;
+     * reads there return zeros, and writes or maps first clear
+     * the gap below them. Discarding the blocks up to the top
+     * lowers the mark again.
+     */
+    class block_device_ram_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_ram_impl (void* addr, std::size_t bytes,
+                             std::size_t block_size_bytes = 512,
+                             bool lazy_zero = false);
+
+      block_device_ram_impl (std::size_t blocks, std::size_t block_size_bytes,
+                             rtos::memory::memory_resource* resource = nullptr,
+                             bool lazy_zero = false);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_ram_impl (const block_device_ram_impl&) = delete;
+      block_device_ram_impl (block_device_ram_impl&&) = delete;
+      block_device_ram_impl&
+      operator= (const block_device_ram_impl&) = delete;
+      block_device_ram_impl&
+      operator= (block_device_ram_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_ram_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual const void*
+      do_map (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @brief Get the memory region.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the first block, or `nullptr` if not
+       *  yet allocated.
+       */
+      void*
+      region (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      uint8_t*
+      block_ (blknum_t blknum) const;
+
+      void
+      zero_below_ (blknum_t blknum);
+
+      // ----------------------------------------------------------------------
+
+      uint8_t* region_ = nullptr;
+
+      // Non null only if the region is allocated by the device.
+      rtos::memory::memory_resource* resource_ = nullptr;
+      std::size_t allocated_bytes_ = 0;
+
+      // With lazy zeroing, the blocks from here up were not yet
+      // cleared and read as zeros; otherwise num_blocks_.
+      blknum_t zeroed_blocks_ = 0;
+
+      bool lazy_zero_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    /**
+     * @brief RAM disk block device.
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    using block_device_ram = block_device_implementable<block_device_ram_impl>;
+
+    /**
+     * @brief RAM disk block device with locking.
+     * @ingroup cmsis-plus-posix-io-base
+     * @tparam L Type of the lockable object.
+     */
+    template<typename L>
+      using block_device_ram_lockable = block_device_lockable<block_device_ram_impl, L>;
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline void*
+    block_device_ram_impl::region (void) const
+    {
+      return region_;
+    }
+
+    inline uint8_t*
+    block_device_ram_impl::block_ (blknum_t blknum) const
+    {
+      return region_ + blknum * block_logical_size_bytes_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_ */
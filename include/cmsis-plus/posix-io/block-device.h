@@ -37,6 +37,7 @@
 #endif
 
 #include <cmsis-plus/posix-io/device.h>
+#include <cmsis-plus/posix-io/owner-lock-guard.h>
 
 // ----------------------------------------------------------------------------
 
@@ -117,6 +118,40 @@ namespace os
       virtual ssize_t
       write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1);
 
+      /**
+       * @brief Get the address of memory mapped blocks.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @return Pointer to the contiguous content of the blocks, usable
+       *  for reading, or `nullptr` with `errno` set (`ENODEV` if the
+       *  storage is not memory mapped).
+       */
+      virtual const void*
+      map (blknum_t blknum, std::size_t nblocks = 1);
+
+      /**
+       * @brief Discard blocks whose content is no longer needed.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 The blocks were discarded, or the device
+       *  ignores discards.
+       * @retval -1 Error, with `errno` set.
+       */
+      virtual int
+      discard (blknum_t blknum, std::size_t nblocks = 1);
+
+      /**
+       * @brief Erase blocks.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 The blocks were erased.
+       * @retval -1 Error, with `errno` set (`EINVAL` if the range
+       *  does not cover entire erase units, `ENOSYS` if the device
+       *  cannot erase).
+       */
+      virtual int
+      erase (blknum_t blknum, std::size_t nblocks = 1);
+
       // ----------------------------------------------------------------------
 
       /**
@@ -136,6 +171,37 @@ namespace os
       std::size_t
       block_physical_size_bytes (void);
 
+      /**
+       *
+       * @return The number of blocks in an erase unit (the physical
+       *  block), at least 1.
+       */
+      std::size_t
+      erase_blocks (void);
+
+      /**
+       *
+       * @return The preferred transfer size in bytes, a multiple of
+       *  the physical block; the physical block if not set by the driver.
+       */
+      std::size_t
+      block_optimal_size_bytes (void);
+
+      /**
+       *
+       * @return The number of blocks in a preferred transfer, at least 1.
+       */
+      std::size_t
+      optimal_blocks (void);
+
+      /**
+       *
+       * @return The offset in bytes of block 0 from the start of
+       *  a preferred transfer unit of the underlying device.
+       */
+      std::size_t
+      alignment_offset_bytes (void);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -215,6 +281,12 @@ namespace os
       virtual off_t
       do_lseek (off_t offset, int whence) override;
 
+      virtual ssize_t
+      do_readv (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      do_writev (const struct iovec* iov, int iovcnt) override;
+
       virtual ssize_t
       do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) = 0;
 
@@ -222,6 +294,15 @@ namespace os
       do_write_block (const void* buf, blknum_t blknum,
                       std::size_t nblocks) = 0;
 
+      virtual const void*
+      do_map (blknum_t blknum, std::size_t nblocks);
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks);
+
+      virtual int
+      do_erase (blknum_t blknum, std::size_t nblocks);
+
       /**
        * @}
        */
@@ -233,12 +314,35 @@ namespace os
        * @cond ignore
        */
 
+      ssize_t
+      check_iov_ (const struct iovec* iov, int iovcnt, blknum_t* blknum);
+
+      // Call do_read_block()/do_write_block(), with the cache
+      // maintenance around the transfer if dma_ is set.
+      ssize_t
+      transfer_read_block_ (void* buf, blknum_t blknum, std::size_t nblocks);
+
+      ssize_t
+      transfer_write_block_ (const void* buf, blknum_t blknum,
+                             std::size_t nblocks);
+
       std::size_t block_logical_size_bytes_ = 0;
 
       std::size_t block_physical_size_bytes_ = 0;
 
       blknum_t num_blocks_ = 0;
 
+      // The erase block, or the bus transfer unit; 0 if the same
+      // as the physical block.
+      std::size_t block_optimal_size_bytes_ = 0;
+
+      // Non zero for partitions not starting on a unit boundary.
+      std::size_t alignment_offset_bytes_ = 0;
+
+      // Set by the implementations transferring the blocks with DMA;
+      // the buffers are cleaned and invalidated around the transfers.
+      bool dma_ = false;
+
       /**
        * @endcond
        */
@@ -386,6 +490,9 @@ namespace os
         virtual ssize_t
         read (void* buf, std::size_t nbyte) override;
 
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
         virtual ssize_t
         write (const void* buf, std::size_t nbyte) override;
 
@@ -409,6 +516,15 @@ namespace os
         write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
             override;
 
+        virtual const void*
+        map (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual int
+        discard (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual int
+        erase (blknum_t blknum, std::size_t nblocks = 1) override;
+
         virtual void
         sync (void) override;
 
@@ -418,6 +534,29 @@ namespace os
         value_type&
         impl (void) const;
 
+        /**
+         * @brief Register the only thread using the object.
+         * @param [in] th Pointer to the owner thread, or `nullptr` to
+         *  take the locker again for each call.
+         * @par Returns
+         *  Nothing.
+         *
+         * @details
+         * While an owner is registered, the calls do not take the
+         * locker; debug builds assert that they come from the owner.
+         */
+        void
+        owner (rtos::thread* th);
+
+        /**
+         * @brief Get the owner thread.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the owner thread, or `nullptr`.
+         */
+        rtos::thread*
+        owner (void) const;
+
         /**
          * @}
          */
@@ -433,6 +572,8 @@ namespace os
 
         lockable_type& locker_;
 
+        rtos::thread* owner_ = nullptr;
+
         /**
          * @endcond
          */
@@ -468,6 +609,40 @@ namespace os
       return impl ().block_physical_size_bytes_;
     }
 
+    inline std::size_t
+    block_device::erase_blocks (void)
+    {
+      std::size_t lsz = impl ().block_logical_size_bytes_;
+      std::size_t psz = impl ().block_physical_size_bytes_;
+      return (lsz != 0 && psz > lsz) ? (psz / lsz) : 1;
+    }
+
+    inline std::size_t
+    block_device::block_optimal_size_bytes (void)
+    {
+      std::size_t osz = impl ().block_optimal_size_bytes_;
+      if (osz != 0)
+        {
+          return osz;
+        }
+      std::size_t psz = impl ().block_physical_size_bytes_;
+      return (psz != 0) ? psz : impl ().block_logical_size_bytes_;
+    }
+
+    inline std::size_t
+    block_device::optimal_blocks (void)
+    {
+      std::size_t lsz = impl ().block_logical_size_bytes_;
+      std::size_t osz = block_optimal_size_bytes ();
+      return (lsz != 0 && osz > lsz) ? (osz / lsz) : 1;
+    }
+
+    inline std::size_t
+    block_device::alignment_offset_bytes (void)
+    {
+      return impl ().alignment_offset_bytes_;
+    }
+
     inline block_device_impl&
     block_device::impl (void) const
     {
@@ -486,7 +661,8 @@ namespace os
               { std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-          trace::printf ("block_device_implementable::%s(\"%s\")=@%p\n",
+          trace::printf (trace::posix_io_block_device,
+                         "block_device_implementable::%s(\"%s\")=@%p\n",
                          __func__, name_, this);
 #endif
         }
@@ -495,7 +671,8 @@ namespace os
       block_device_implementable<T>::~block_device_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_implementable::%s() @%p %s\n", __func__,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_implementable::%s() @%p %s\n", __func__,
                        this, name_);
 #endif
       }
@@ -520,7 +697,8 @@ namespace os
             locker_ (locker)
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-          trace::printf ("block_device_lockable::%s(\"%s\")=@%p\n", __func__,
+          trace::printf (trace::posix_io_block_device,
+                         "block_device_lockable::%s(\"%s\")=@%p\n", __func__,
                          name_, this);
 #endif
         }
@@ -529,7 +707,8 @@ namespace os
       block_device_lockable<T, L>::~block_device_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s() @%p %s\n", __func__, this,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s() @%p %s\n", __func__, this,
                        name_);
 #endif
       }
@@ -541,11 +720,12 @@ namespace os
       block_device_lockable<T, L>::close (void)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s() @%p\n", __func__, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::close ();
       }
@@ -555,27 +735,45 @@ namespace os
       block_device_lockable<T, L>::read (void* buf, std::size_t nbyte)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
                        buf, nbyte, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::read (buf, nbyte);
       }
 
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::readv (const struct iovec* iov, int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(0x0%X, %d) @%p\n", __func__,
+                       iov, iovcnt, this);
+#endif
+
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return block_device::readv (iov, iovcnt);
+      }
+
     template<typename T, typename L>
       ssize_t
       block_device_lockable<T, L>::write (const void* buf, std::size_t nbyte)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
                        buf, nbyte, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::write (buf, nbyte);
       }
@@ -585,12 +783,13 @@ namespace os
       block_device_lockable<T, L>::writev (const struct iovec* iov, int iovcnt)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(0x0%X, %d) @%p\n", __func__,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(0x0%X, %d) @%p\n", __func__,
                        iov, iovcnt, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::writev (iov, iovcnt);
       }
@@ -600,12 +799,13 @@ namespace os
       block_device_lockable<T, L>::vfcntl (int cmd, std::va_list args)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%d) @%p\n", __func__, cmd,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%d) @%p\n", __func__, cmd,
                        this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::vfcntl (cmd, args);
       }
@@ -615,12 +815,13 @@ namespace os
       block_device_lockable<T, L>::vioctl (int request, std::va_list args)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%d) @%p\n", __func__, request,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%d) @%p\n", __func__, request,
                        this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::vioctl (request, args);
       }
@@ -630,12 +831,13 @@ namespace os
       block_device_lockable<T, L>::lseek (off_t offset, int whence)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%d, %d) @%p\n", __func__,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%d, %d) @%p\n", __func__,
                        offset, whence, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::lseek (offset, whence);
       }
@@ -646,12 +848,13 @@ namespace os
                                                std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%p, %u, %u) @%p\n", __func__,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%p, %u, %u) @%p\n", __func__,
                        buf, blknum, nblocks, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::read_block (buf, blknum, nblocks);
       }
@@ -663,30 +866,95 @@ namespace os
                                                 std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%p, %u, %u) @%p\n", __func__,
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%p, %u, %u) @%p\n", __func__,
                        buf, blknum, nblocks, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::write_block (buf, blknum, nblocks);
       }
 
+    template<typename T, typename L>
+      const void*
+      block_device_lockable<T, L>::map (blknum_t blknum, std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%u, %u) @%p\n", __func__,
+                       blknum, nblocks, this);
+#endif
+
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return block_device::map (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_lockable<T, L>::discard (blknum_t blknum,
+                                            std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%u, %u) @%p\n", __func__,
+                       blknum, nblocks, this);
+#endif
+
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return block_device::discard (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_lockable<T, L>::erase (blknum_t blknum, std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s(%u, %u) @%p\n", __func__,
+                       blknum, nblocks, this);
+#endif
+
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return block_device::erase (blknum, nblocks);
+      }
+
     template<typename T, typename L>
       void
       block_device_lockable<T, L>::sync (void)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_block_device,
+                       "block_device_lockable::%s() @%p\n", __func__, this);
 #endif
 
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return block_device::sync ();
       }
 
+    template<typename T, typename L>
+      inline void
+      block_device_lockable<T, L>::owner (rtos::thread* th)
+      {
+        owner_ = th;
+      }
+
+    template<typename T, typename L>
+      inline rtos::thread*
+      block_device_lockable<T, L>::owner (void) const
+      {
+        return owner_;
+      }
+
     template<typename T, typename L>
       typename block_device_lockable<T, L>::value_type&
       block_device_lockable<T, L>::impl (void) const
@@ -60,6 +60,9 @@ extern "C"
   clock_t __attribute__((weak, alias ("__posix_clock")))
   clock (void);
 
+  int __attribute__((weak, alias ("__posix_clock_gettime")))
+  clock_gettime (clockid_t clock_id, struct timespec* tp);
+
   int __attribute__((weak, alias ("__posix_close")))
   close (int fildes);
 
@@ -69,6 +72,15 @@ extern "C"
   int __attribute__((weak, alias ("__posix_connect")))
   connect (int socket, const struct sockaddr* address, socklen_t address_len);
 
+  int __attribute__((weak, alias ("__posix_epoll_create")))
+  epoll_create (int size);
+
+  int __attribute__((weak, alias ("__posix_epoll_ctl")))
+  epoll_ctl (int epfd, int op, int fd, struct epoll_event* event);
+
+  int __attribute__((weak, alias ("__posix_epoll_wait")))
+  epoll_wait (int epfd, struct epoll_event* events, int maxevents, int timeout);
+
   int __attribute__((weak, alias ("__posix_execve")))
   execve (const char* path, char* const argv[], char* const envp[]);
 
@@ -131,6 +143,12 @@ extern "C"
   int __attribute__((weak, alias ("__posix_mkdir")))
   mkdir (const char* path, mode_t mode);
 
+  void* __attribute__((weak, alias ("__posix_mmap")))
+  mmap (void* addr, size_t len, int prot, int flags, int fildes, off_t off);
+
+  int __attribute__((weak, alias ("__posix_munmap")))
+  munmap (void* addr, size_t len);
+
   int __attribute__((weak, alias ("__posix_open")))
   open (const char* path, int oflag, ...);
 
@@ -143,6 +161,12 @@ extern "C"
   __attribute__((weak, alias ("__posix_opendir")))
   opendir (const char* dirname);
 
+  int __attribute__((weak, alias ("__posix_pipe")))
+  pipe (int fildes[2]);
+
+  int __attribute__((weak, alias ("__posix_poll")))
+  poll (struct pollfd fds[], nfds_t nfds, int timeout);
+
   int __attribute__((weak, alias ("__posix_raise")))
   raise (int sig);
 
@@ -159,6 +183,9 @@ extern "C"
   ssize_t __attribute__((weak, alias ("__posix_readlink")))
   readlink (const char* path, char* buf, size_t bufsize);
 
+  ssize_t __attribute__((weak, alias ("__posix_readv")))
+  readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t __attribute__((weak, alias ("__posix_recv")))
   recv (int socket, void* buffer, size_t length, int flags);
 
@@ -166,6 +193,10 @@ extern "C"
   recvfrom (int socket, void* buffer, size_t length, int flags,
             struct sockaddr* address, socklen_t* address_len);
 
+  int __attribute__((weak, alias ("__posix_recvmmsg")))
+  recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags, struct timespec* timeout);
+
   ssize_t __attribute__((weak, alias ("__posix_recvmsg")))
   recvmsg (int socket, struct msghdr* message, int flags);
 
@@ -185,6 +216,13 @@ extern "C"
   ssize_t __attribute__((weak, alias ("__posix_send")))
   send (int socket, const void* buffer, size_t length, int flags);
 
+  ssize_t __attribute__((weak, alias ("__posix_sendfile")))
+  sendfile (int out_fd, int in_fd, off_t* offset, size_t count);
+
+  int __attribute__((weak, alias ("__posix_sendmmsg")))
+  sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags);
+
   ssize_t __attribute__((weak, alias ("__posix_sendmsg")))
   sendmsg (int socket, const struct msghdr* message, int flags);
 
@@ -196,6 +234,12 @@ extern "C"
   setsockopt (int socket, int level, int option_name, const void* option_value,
               socklen_t option_len);
 
+  int __attribute__((weak, alias ("__posix_shm_open")))
+  shm_open (const char* name, int oflag, mode_t mode);
+
+  int __attribute__((weak, alias ("__posix_shm_unlink")))
+  shm_unlink (const char* name);
+
   int __attribute__((weak, alias ("__posix_shutdown")))
   shutdown (int socket, int how);
 
@@ -210,6 +254,10 @@ extern "C"
   socketpair (int domain, int type, int protocol, int socket_vector[2]);
 #endif
 
+  ssize_t __attribute__((weak, alias ("__posix_splice")))
+  splice (int fd_in, off_t* off_in, int fd_out, off_t* off_out, size_t len,
+          unsigned int flags);
+
   int __attribute__((weak, alias ("__posix_stat")))
   stat (const char* path, struct stat* buf);
 
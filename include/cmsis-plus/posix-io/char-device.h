@@ -282,7 +282,8 @@ namespace os
               { std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-          trace::printf ("char_device_implementable::%s(\"%s\")=@%p\n",
+          trace::printf (trace::posix_io_char_device,
+                         "char_device_implementable::%s(\"%s\")=@%p\n",
                          __func__, name_, this);
 #endif
         }
@@ -291,7 +292,8 @@ namespace os
       char_device_implementable<T>::~char_device_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-        trace::printf ("char_device_implementable::%s() @%p %s\n", __func__,
+        trace::printf (trace::posix_io_char_device,
+                       "char_device_implementable::%s() @%p %s\n", __func__,
                        this, name_);
 #endif
       }
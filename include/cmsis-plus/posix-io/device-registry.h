@@ -45,6 +45,12 @@
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS)
+#define OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS (16)
+#endif
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -134,6 +140,14 @@ namespace os
         utils::double_list_links, &device::registry_links_, T>;
         static device_list registry_list__;
 
+        // The same devices, hashed by name, for identify_device().
+        using hash_list = utils::intrusive_list<device,
+        utils::double_list_links, &device::hash_links_, T>;
+        static hash_list hash_buckets__[OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+
+        static hash_list&
+        bucket_ (const char* name);
+
         /**
          * @endcond
          */
@@ -151,12 +165,30 @@ namespace os
   {
     // ========================================================================
 
+    /**
+     * @details
+     * The bucket is selected by the FNV-1a hash of the name.
+     */
+    template<typename T>
+      typename device_registry<T>::hash_list&
+      device_registry<T>::bucket_ (const char* name)
+      {
+        uint32_t hash = 2166136261u;
+        for (; *name != '\0'; ++name)
+          {
+            hash = (hash ^ static_cast<uint8_t> (*name)) * 16777619u;
+          }
+        return hash_buckets__[hash % OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+      }
+
     template<typename T>
       void
       device_registry<T>::link (value_type* device)
       {
+        hash_list& bucket = bucket_ (device->name ());
+
 #if defined(DEBUG)
-        for (auto&& d : registry_list__)
+        for (auto&& d : bucket)
           {
             // Validate the device name by checking duplicates.
             if (std::strcmp (device->name (), d.name ()) == 0)
@@ -168,6 +200,7 @@ namespace os
 #endif // DEBUG
 
         registry_list__.link (*device);
+        bucket.link (*device);
 
         trace::printf ("Device '%s%s' linked.\n", value_type::device_prefix (),
                        device->name ());
@@ -175,6 +208,11 @@ namespace os
 
     /**
      * return pointer to device or nullptr if not found.
+     *
+     * @details
+     * Only the devices in the hash bucket of the name are compared;
+     * the full list is walked only if none matches, for devices
+     * that override `match_name()` to accept other names.
      */
     template<typename T>
       T*
@@ -183,16 +221,17 @@ namespace os
         assert(path != nullptr);
 
         auto prefix = value_type::device_prefix ();
-        if (std::strncmp (prefix, path, std::strlen (prefix)) != 0)
+        auto len = std::strlen (prefix);
+        if (std::strncmp (prefix, path, len) != 0)
           {
             // The device prefix does not match, not a device.
             return nullptr;
           }
 
         // The prefix was identified; try to match the rest of the path.
-        auto name = path + std::strlen (prefix);
+        auto name = path + len;
 
-        for (auto&& p : registry_list__)
+        for (auto&& p : bucket_ (name))
           {
             if (p.match_name (name))
               {
@@ -200,6 +239,15 @@ namespace os
               }
           }
 
+        for (auto&& p : registry_list__)
+          {
+            // Most names differ in the first character.
+            if (p.name ()[0] == name[0] && p.match_name (name))
+              {
+                return static_cast<value_type*> (&p);
+              }
+          }
+
         // Not a known device.
         return nullptr;
       }
@@ -218,6 +266,10 @@ namespace os
     template<typename T>
       typename device_registry<T>::device_list device_registry<T>::registry_list__;
 
+    // Initialised to 0 by BSS.
+    template<typename T>
+      typename device_registry<T>::hash_list device_registry<T>::hash_buckets__[OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+
 #pragma GCC diagnostic pop
 
   /**
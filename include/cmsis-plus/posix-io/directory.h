@@ -125,6 +125,20 @@ namespace os
       virtual struct dirent *
       read (void);
 
+      /**
+       * @brief Read several directory entries.
+       * @param [out] buf Pointer to an array of entries.
+       * @param [in] count Number of entries in the array.
+       * @return The number of entries read, 0 at the end of the
+       *  directory, or -1 with `errno` set.
+       *
+       * @details
+       * Similar to `getdents()`; the entries are copied to the
+       * array, so they remain valid after the next read.
+       */
+      virtual ssize_t
+      read_n (struct dirent* buf, std::size_t count);
+
       // http://pubs.opengroup.org/onlinepubs/9699919799/functions/rewinddir.html
       virtual void
       rewind (void);
@@ -243,6 +257,10 @@ namespace os
       virtual struct dirent*
       do_read (void) = 0;
 
+      // By default calls do_read() for each entry.
+      virtual ssize_t
+      do_read_n (struct dirent* buf, std::size_t count);
+
       virtual void
       do_rewind (void) = 0;
 
@@ -411,6 +429,10 @@ namespace os
         virtual struct dirent *
         read (void) override;
 
+        // All the entries are read under one lock.
+        virtual ssize_t
+        read_n (struct dirent* buf, std::size_t count) override;
+
         // http://pubs.opengroup.org/onlinepubs/9699919799/functions/rewinddir.html
         virtual void
         rewind (void) override;
@@ -496,7 +518,8 @@ namespace os
             { fs }
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_implementable::%s()=@%p\n", __func__, this);
+        trace::printf (trace::posix_io_directory,
+                       "directory_implementable::%s()=@%p\n", __func__, this);
 #endif
       }
 
@@ -504,7 +527,8 @@ namespace os
       directory_implementable<T>::~directory_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_implementable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_directory,
+                       "directory_implementable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -527,7 +551,8 @@ namespace os
           locker_ (locker)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s()=@%p\n", __func__, this);
+        trace::printf (trace::posix_io_directory,
+                       "directory_lockable::%s()=@%p\n", __func__, this);
 #endif
       }
 
@@ -535,7 +560,8 @@ namespace os
       directory_lockable<T, L>::~directory_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_directory,
+                       "directory_lockable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -546,7 +572,8 @@ namespace os
       directory_lockable<T, L>::read (void)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_directory,
+                       "directory_lockable::%s() @%p\n", __func__, this);
 #endif
 
         std::lock_guard<L> lock
@@ -555,12 +582,29 @@ namespace os
         return directory::read ();
       }
 
+    template<typename T, typename L>
+      ssize_t
+      directory_lockable<T, L>::read_n (struct dirent* buf, std::size_t count)
+      {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+        trace::printf (trace::posix_io_directory,
+                       "directory_lockable::%s(%p, %u) @%p\n", __func__, buf,
+                       count, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return directory::read_n (buf, count);
+      }
+
     template<typename T, typename L>
       void
       directory_lockable<T, L>::rewind (void)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_directory,
+                       "directory_lockable::%s() @%p\n", __func__, this);
 #endif
 
         std::lock_guard<L> lock
@@ -574,7 +618,8 @@ namespace os
       directory_lockable<T, L>::close (void)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_directory,
+                       "directory_lockable::%s() @%p\n", __func__, this);
 #endif
 
         std::lock_guard<L> lock
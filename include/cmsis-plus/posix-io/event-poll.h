@@ -0,0 +1,398 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_
+#define CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/io.h>
+
+#include <cmsis-plus/posix/sys/epoll.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief An entry of the event poll interest set.
+     * @headerfile event-poll.h <cmsis-plus/posix-io/event-poll.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    struct event_poll_entry
+    {
+      // The next entry in the ready list.
+      event_poll_entry* next;
+
+      event_poll_impl* owner;
+
+      // The watched object, or `nullptr` if the entry is free.
+      class io* target;
+
+      uint32_t events;
+      epoll_data_t data;
+
+      // The wait() that last reported the entry.
+      unsigned int round;
+
+      // In the ready list.
+      bool queued;
+    };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    class event_poll_impl : public io_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class event_poll;
+      friend class io;
+      friend class io_impl;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      event_poll_impl (std::size_t size,
+                       rtos::memory::memory_resource* resource = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      event_poll_impl (const event_poll_impl&) = delete;
+      event_poll_impl (event_poll_impl&&) = delete;
+      event_poll_impl&
+      operator= (const event_poll_impl&) = delete;
+      event_poll_impl&
+      operator= (event_poll_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~event_poll_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_close (void) override;
+
+      virtual int
+      do_poll_register (int events, rtos::semaphore* sem) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      int
+      ctl_ (int op, int fd, struct epoll_event* event);
+
+      int
+      wait_ (struct epoll_event* events, int maxevents, int timeout);
+
+      int
+      collect_ (struct epoll_event* events, int maxevents);
+
+      void
+      push_ (event_poll_entry* entry);
+
+      event_poll_entry*
+      pop_ (void);
+
+      void
+      remove_ (event_poll_entry* entry);
+
+      // Called from io_impl::poll_notify(), possibly in an interrupt.
+      static void
+      notify_ (event_poll_entry* entry);
+
+      // Called from io::close() of a watched object.
+      static void
+      detach_ (event_poll_entry* entry);
+
+      // ----------------------------------------------------------------------
+
+      rtos::memory::memory_resource* resource_;
+
+      std::size_t size_;
+
+      // Allocated on open(), returned on close().
+      event_poll_entry* entries_ = nullptr;
+
+      // The ready list, appended at the tail; accessed in
+      // interrupts critical sections.
+      event_poll_entry* volatile head_ = nullptr;
+      event_poll_entry* volatile tail_ = nullptr;
+
+      // Posted when an entry is pushed to the ready list.
+      rtos::semaphore_binary sem_;
+
+      // Serialises ctl() and wait().
+      rtos::mutex mutex_;
+
+      // Incremented by each collect_(), to report an entry only once.
+      unsigned int round_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    /**
+     * @brief Event poll class.
+     * @headerfile event-poll.h <cmsis-plus/posix-io/event-poll.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * Similar to the Linux `epoll`; keeps a persistent set of
+     * watched descriptors and a list of the ready ones.
+     *
+     * The objects in the set push their entry to the ready list
+     * from their `poll_notify()`, so `wait()` costs only as much
+     * as the number of ready descriptors, regardless of the size
+     * of the set.
+     *
+     * An object can be watched by a single event poll at a time.
+     */
+    class event_poll : public io
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct an event poll object.
+       * @param [in] size The maximum number of watched descriptors.
+       * @param [in] resource Pointer to the memory resource for the
+       *  interest set, or `nullptr` for the default one.
+       */
+      event_poll (std::size_t size, rtos::memory::memory_resource* resource =
+                      nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      event_poll (const event_poll&) = delete;
+      event_poll (event_poll&&) = delete;
+      event_poll&
+      operator= (const event_poll&) = delete;
+      event_poll&
+      operator= (event_poll&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~event_poll ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Create a dynamically allocated event poll.
+       * @param [in] size The maximum number of watched descriptors.
+       * @return Pointer to the opened object, or `nullptr` with
+       *  `errno` set.
+       *
+       * @details
+       * The object is deallocated some time after `close()`.
+       */
+      static event_poll*
+      create (std::size_t size);
+
+      /**
+       * @brief Allocate the interest set and a file descriptor.
+       * @par Parameters
+       *  None.
+       * @return The file descriptor, or -1 with `errno` set.
+       */
+      int
+      open (void);
+
+      virtual int
+      close (void) override;
+
+      /**
+       * @brief Change the interest set.
+       * @param [in] op One of `EPOLL_CTL_ADD`, `EPOLL_CTL_MOD`,
+       *  `EPOLL_CTL_DEL`.
+       * @param [in] fd The watched file descriptor.
+       * @param [in] event Pointer to the events of interest and the
+       *  user data; ignored for `EPOLL_CTL_DEL`.
+       * @retval 0 The set was changed.
+       * @retval -1 An error occurred; `errno` is set.
+       */
+      int
+      ctl (int op, int fd, struct epoll_event* event);
+
+      /**
+       * @brief Wait for events.
+       * @param [out] events Pointer to the array receiving the events.
+       * @param [in] maxevents The size of the array.
+       * @param [in] timeout The timeout in milliseconds, negative for
+       *  infinite.
+       * @return The number of ready descriptors, 0 on timeout, or -1
+       *  with `errno` set.
+       */
+      int
+      wait (struct epoll_event* events, int maxevents, int timeout);
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      event_poll_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      static void
+      deallocate_deferred_ (void);
+
+      event_poll_impl impl_instance_;
+
+      // Set for objects returned by create().
+      bool allocated_ = false;
+
+      // Link in the list of closed objects waiting to be deallocated.
+      event_poll* deferred_next_ = nullptr;
+
+      static event_poll* deferred_list__;
+
+      /**
+       * @endcond
+       */
+    };
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline event_poll_impl&
+    event_poll::impl (void) const
+    {
+      return static_cast<event_poll_impl&> (impl_);
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_ */
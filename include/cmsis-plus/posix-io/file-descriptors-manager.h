@@ -37,8 +37,10 @@
 #endif
 
 #include <cmsis-plus/posix-io/types.h>
+#include <cmsis-plus/posix-io/io.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 
 // ----------------------------------------------------------------------------
@@ -59,6 +61,11 @@ namespace os
      * @brief File descriptors manager static class.
      * @headerfile file-descriptors-manager.h <cmsis-plus/posix-io/file-descriptors-manager.h>
      * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * The free descriptors are kept in a bitmap, so the lowest
+     * free one, as required by POSIX, is found with a count
+     * leading zeros instruction, without scanning the table.
      */
     class file_descriptors_manager
     {
@@ -127,6 +134,14 @@ namespace os
       static size_t
       used (void);
 
+      /**
+       * @brief Get the number of descriptors used by a type of objects.
+       * @param [in] type One of the `io::type` values.
+       * @return The number of descriptors.
+       */
+      static size_t
+      used (io::type_t type);
+
       /**
        * @}
        */
@@ -145,6 +160,26 @@ namespace os
 
       static class io** descriptors_array__;
 
+      static std::size_t
+      type_index__ (io::type_t type);
+
+      static void
+      count__ (class io* io, std::size_t fildes, int delta);
+
+      // One bit per descriptor, set when free; the most significant
+      // bit of each word is the lowest descriptor.
+      static uint32_t* free_bitmap__;
+      static std::size_t bitmap_words__;
+
+      // No word below this one has free bits.
+      static std::size_t first_free_word__;
+
+      static std::size_t used__;
+
+      // One counter for each bit of `io::type`.
+      static constexpr std::size_t types__ = 9;
+      static std::size_t used_by_type__[types__];
+
       /**
        * @endcond
        */
@@ -168,6 +203,12 @@ namespace os
       return size__;
     }
 
+    inline size_t
+    file_descriptors_manager::used (void)
+    {
+      return used__;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
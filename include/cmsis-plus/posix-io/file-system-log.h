@@ -0,0 +1,688 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_LOG_H_
+#define CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_LOG_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/file-system.h>
+#include <cmsis-plus/posix-io/file.h>
+#include <cmsis-plus/posix-io/directory.h>
+#include <cmsis-plus/posix-io/block-device.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_INODES)
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_INODES (16)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_NAME_SIZE)
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_NAME_SIZE (24)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class file_log_impl;
+    class directory_log_impl;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Log structured flash file system implementation.
+     * @headerfile file-system-log.h <cmsis-plus/posix-io/file-system-log.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * The device is divided in segments of one or more erase
+     * units, and all blocks are written once, in sequence, at the
+     * head of the log; nothing is updated in place. Each block
+     * starts with a header with a sequence number and a CRC, and
+     * holds either file data or an inode record (name, parent,
+     * mode, size, time).
+     *
+     * Writing the inode record is the commit point: at mount,
+     * only the data blocks not newer than the last record of
+     * their file are used, so after a power failure each file
+     * is found as it was at its last `fsync()` or `close()`.
+     *
+     * The free segments are reclaimed by copying the live blocks
+     * of the segment with the fewest of them, then erasing it
+     * with `block_device::erase()`, or with `discard()` on devices
+     * which cannot erase; the erase counts are kept in the block
+     * headers, and the new segments are those erased the fewest
+     * times (dynamic wear levelling); the segments with static
+     * data only are not moved.
+     *
+     * The RAM is allocated at mount, 12 bytes per block, plus one
+     * block for each opened file, which keeps the file tail, so
+     * small appends are written to the device once per block.
+     *
+     * Limitations: at most `OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_INODES`
+     * files and folders, including the root; the opened files cannot
+     * be removed; the access time is not kept.
+     */
+    class file_system_log_impl : public file_system_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class file_log_impl;
+      friend class directory_log_impl;
+
+    public:
+
+      using blknum_t = block_device::blknum_t;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      file_system_log_impl (block_device& device,
+                            rtos::memory::memory_resource* resource = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      file_system_log_impl (const file_system_log_impl&) = delete;
+      file_system_log_impl (file_system_log_impl&&) = delete;
+      file_system_log_impl&
+      operator= (const file_system_log_impl&) = delete;
+      file_system_log_impl&
+      operator= (file_system_log_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~file_system_log_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      // The options are the blocks in a segment, a multiple of
+      // the erase unit; 0 for a single erase unit.
+      virtual int
+      do_vmkfs (int options, std::va_list args) override;
+
+      virtual int
+      do_vmount (unsigned int flags, std::va_list args) override;
+
+      virtual int
+      do_umount (unsigned int flags) override;
+
+      virtual file*
+      do_vopen (class file_system& fs, const char* path, int oflag,
+                std::va_list args) override;
+
+      virtual directory*
+      do_opendir (class file_system& fs, const char* dirname) override;
+
+      virtual int
+      do_mkdir (const char* path, mode_t mode) override;
+
+      virtual int
+      do_rmdir (const char* path) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_chmod (const char* path, mode_t mode) override;
+
+      virtual int
+      do_stat (const char* path, struct stat* buf) override;
+
+      virtual int
+      do_truncate (const char* path, off_t length) override;
+
+      virtual int
+      do_rename (const char* existing, const char* _new) override;
+
+      virtual int
+      do_unlink (const char* path) override;
+
+      virtual int
+      do_utime (const char* path, const struct utimbuf* times) override;
+
+      virtual int
+      do_statvfs (struct statvfs* buf) override;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      /**
+       * @brief Get the number of segments.
+       * @return The number of segments, 0 if not mounted.
+       */
+      std::size_t
+      segments (void) const;
+
+      /**
+       * @brief Get the number of blocks in a segment.
+       * @return The number of blocks, 0 if not mounted.
+       */
+      std::size_t
+      segment_blocks (void) const;
+
+      /**
+       * @brief Get how many times a segment was erased.
+       * @param [in] segment The segment number.
+       * @return The erase count.
+       */
+      uint32_t
+      erase_count (std::size_t segment) const;
+
+      /**
+       * @brief Get the number of segments not in use.
+       * @return The number of free segments.
+       */
+      std::size_t
+      free_segments (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      using inum_t = uint16_t;
+
+      static constexpr inum_t no_inode = 0xFFFF;
+      static constexpr uint32_t record_index = 0xFFFFFFFF;
+      static constexpr blknum_t no_block = static_cast<blknum_t> (-1);
+      static constexpr std::size_t inodes =
+          OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_INODES;
+      static constexpr std::size_t name_size =
+          OS_INTEGER_POSIX_IO_FILE_SYSTEM_LOG_NAME_SIZE;
+
+      // On the device, at the beginning of each block.
+      struct header_t
+      {
+        uint32_t magic;
+        uint32_t seq;
+        // The file block, or record_index.
+        uint32_t index;
+        // The erase count of the segment.
+        uint32_t wear;
+        uint16_t inode;
+        uint16_t segment_blocks;
+        // The bytes after the header covered by the CRC.
+        uint16_t length;
+        uint16_t reserved;
+        uint32_t crc;
+      };
+
+      // On the device, after the header of the metadata blocks.
+      struct record_t
+      {
+        // The sequence of the first record of the file; older
+        // data blocks belong to a previous file.
+        uint32_t birth;
+        uint32_t mode;
+        uint32_t size;
+        uint32_t mtime;
+        uint16_t parent;
+        uint16_t flags;
+        char name[name_size];
+      };
+
+      enum state : uint8_t
+      {
+        // Not written since the erase, or unknown.
+        unused = 0,
+        // Committed.
+        live,
+        // Written after the last commit of the file.
+        pending,
+        // Superseded, to be reclaimed.
+        dead
+      };
+
+      struct block_entry_t
+      {
+        uint32_t seq;
+        uint32_t index;
+        inum_t inode;
+        uint8_t state;
+      };
+
+      struct segment_entry_t
+      {
+        uint32_t erase_count;
+        bool written;
+        bool erased;
+      };
+
+      struct node_t
+      {
+        record_t rec;
+        // The sequence of the last record, the commit point.
+        uint32_t commit_seq;
+        // The last record, or the tombstone of a removed file.
+        blknum_t meta_block;
+        uint16_t open_count;
+        bool used;
+        bool dirty;
+        // The file tail, while opened.
+        uint8_t* cache;
+        uint32_t cache_index;
+        bool cache_valid;
+        bool cache_dirty;
+      };
+
+      // ----------------------------------------------------------------------
+
+      int
+      setup_ (std::size_t segment_blocks);
+
+      void
+      teardown_ (void);
+
+      int
+      scan_ (void);
+
+      std::size_t
+      payload_ (void) const;
+
+      std::size_t
+      live_blocks_ (std::size_t segment) const;
+
+      int
+      erase_segment_ (std::size_t segment);
+
+      int
+      open_segment_ (std::size_t segment);
+
+      int
+      collect_ (void);
+
+      int
+      allocate_block_ (blknum_t* blk);
+
+      int
+      program_ (blknum_t blk, inum_t ino, uint32_t index, uint32_t seq,
+                const void* payload, std::size_t length);
+
+      int
+      write_data_ (inum_t ino, uint32_t index, const void* payload);
+
+      int
+      write_record_ (inum_t ino, const record_t& rec);
+
+      int
+      commit_ (inum_t ino);
+
+      blknum_t
+      find_block_ (inum_t ino, uint32_t index) const;
+
+      int
+      flush_cache_ (inum_t ino);
+
+      int
+      load_cache_ (inum_t ino, uint32_t index);
+
+      ssize_t
+      read_ (inum_t ino, std::size_t offset, void* buf, std::size_t nbyte);
+
+      ssize_t
+      write_ (inum_t ino, std::size_t offset, const void* buf,
+              std::size_t nbyte);
+
+      int
+      resize_ (inum_t ino, std::size_t size);
+
+      int
+      zero_fill_ (inum_t ino, uint32_t from, uint32_t to);
+
+      int
+      lookup_ (const char* path, inum_t* ino, inum_t* parent,
+               const char** leaf);
+
+      inum_t
+      find_child_ (inum_t parent, const char* name, std::size_t len) const;
+
+      int
+      create_ (inum_t parent, const char* name, mode_t mode, inum_t* ino);
+
+      int
+      remove_ (inum_t ino);
+
+      void
+      fill_stat_ (inum_t ino, struct stat* buf) const;
+
+      int
+      open_inode_ (inum_t ino);
+
+      void
+      close_inode_ (inum_t ino);
+
+      // ----------------------------------------------------------------------
+
+      rtos::memory::memory_resource* resource_ = nullptr;
+
+      block_entry_t* map_ = nullptr;
+      segment_entry_t* segs_ = nullptr;
+      // One block, to assemble the headers and to read.
+      uint8_t* buf_ = nullptr;
+
+      std::size_t block_size_ = 0;
+      std::size_t blocks_ = 0;
+      std::size_t segment_blocks_ = 0;
+      std::size_t segments_ = 0;
+
+      // The segment being written, and the next free block in it.
+      std::size_t head_seg_ = 0;
+      std::size_t head_pos_ = 0;
+      bool has_head_ = false;
+
+      uint32_t seq_ = 0;
+      bool mounted_ = false;
+
+      node_t nodes_[inodes];
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Log structured file implementation.
+     * @headerfile file-system-log.h <cmsis-plus/posix-io/file-system-log.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class file_log_impl : public file_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class file_system_log_impl;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      file_log_impl (class file_system& fs);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      file_log_impl (const file_log_impl&) = delete;
+      file_log_impl (file_log_impl&&) = delete;
+      file_log_impl&
+      operator= (const file_log_impl&) = delete;
+      file_log_impl&
+      operator= (file_log_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~file_log_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      // With `O_APPEND`, always at the end of the file.
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_fstat (struct stat* buf) override;
+
+      virtual int
+      do_close (void) override;
+
+      virtual int
+      do_ftruncate (off_t length) override;
+
+      // Commit the data written so far.
+      virtual int
+      do_fsync (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      file_system_log_impl&
+      fs_impl_ (void);
+
+      uint16_t inode_ = file_system_log_impl::no_inode;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Log structured directory implementation.
+     * @headerfile file-system-log.h <cmsis-plus/posix-io/file-system-log.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class directory_log_impl : public directory_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class file_system_log_impl;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      directory_log_impl (class file_system& fs);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      directory_log_impl (const directory_log_impl&) = delete;
+      directory_log_impl (directory_log_impl&&) = delete;
+      directory_log_impl&
+      operator= (const directory_log_impl&) = delete;
+      directory_log_impl&
+      operator= (directory_log_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~directory_log_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual struct dirent*
+      do_read (void) override;
+
+      virtual void
+      do_rewind (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      file_system_log_impl&
+      fs_impl_ (void) const;
+
+      uint16_t inode_ = file_system_log_impl::no_inode;
+      // The next inode to check.
+      std::size_t pos_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    using file_system_log = file_system_implementable<file_system_log_impl>;
+
+    using file_log = file_implementable<file_log_impl>;
+
+    using directory_log = directory_implementable<directory_log_impl>;
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline std::size_t
+    file_system_log_impl::segments (void) const
+    {
+      return segments_;
+    }
+
+    inline std::size_t
+    file_system_log_impl::segment_blocks (void) const
+    {
+      return segment_blocks_;
+    }
+
+    inline std::size_t
+    file_system_log_impl::payload_ (void) const
+    {
+      return block_size_ - sizeof(header_t);
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_LOG_H_ */
@@ -0,0 +1,499 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_ROM_H_
+#define CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_ROM_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/file-system.h>
+#include <cmsis-plus/posix-io/file.h>
+#include <cmsis-plus/posix-io/directory.h>
+#include <cmsis-plus/posix-io/block-device.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class file_rom_impl;
+    class directory_rom_impl;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Read-only indexed file system implementation.
+     * @headerfile file-system-rom.h <cmsis-plus/posix-io/file-system-rom.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * The image is built on the host with `scripts/romfs-build.py`;
+     * the children of each folder are consecutive entries of the
+     * index, sorted by name, so a path is found with a binary search
+     * for each name, and each file is stored contiguously, from the
+     * beginning of a block.
+     *
+     * If the device is memory mapped (XIP flash, RAM), the index
+     * is used in place and `file::map()` returns pointers into the
+     * image; otherwise the reads go through a buffer of one block,
+     * allocated at mount.
+     *
+     * All changes fail with `EROFS`.
+     */
+    class file_system_rom_impl : public file_system_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class file_rom_impl;
+      friend class directory_rom_impl;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      file_system_rom_impl (block_device& device,
+                            rtos::memory::memory_resource* resource = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      file_system_rom_impl (const file_system_rom_impl&) = delete;
+      file_system_rom_impl (file_system_rom_impl&&) = delete;
+      file_system_rom_impl&
+      operator= (const file_system_rom_impl&) = delete;
+      file_system_rom_impl&
+      operator= (file_system_rom_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~file_system_rom_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      // The image is created on the host, fails with ENOSYS.
+      virtual int
+      do_vmkfs (int options, std::va_list args) override;
+
+      virtual int
+      do_vmount (unsigned int flags, std::va_list args) override;
+
+      virtual int
+      do_umount (unsigned int flags) override;
+
+      virtual file*
+      do_vopen (class file_system& fs, const char* path, int oflag,
+                std::va_list args) override;
+
+      virtual directory*
+      do_opendir (class file_system& fs, const char* dirname) override;
+
+      virtual int
+      do_mkdir (const char* path, mode_t mode) override;
+
+      virtual int
+      do_rmdir (const char* path) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_chmod (const char* path, mode_t mode) override;
+
+      virtual int
+      do_stat (const char* path, struct stat* buf) override;
+
+      virtual int
+      do_truncate (const char* path, off_t length) override;
+
+      virtual int
+      do_rename (const char* existing, const char* _new) override;
+
+      virtual int
+      do_unlink (const char* path) override;
+
+      virtual int
+      do_utime (const char* path, const struct utimbuf* times) override;
+
+      virtual int
+      do_statvfs (struct statvfs* buf) override;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      /**
+       * @brief Get the address of the mapped image.
+       * @return Pointer to the image, or `nullptr` if the device
+       *  is not memory mapped or the file system is not mounted.
+       */
+      const void*
+      image (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      static constexpr uint32_t no_entry = 0xFFFFFFFF;
+
+      // On the device, little endian.
+      struct header_t
+      {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t image_size;
+        uint32_t index_size;
+        uint32_t entries;
+        uint32_t align;
+        uint32_t index_crc;
+        uint32_t reserved;
+      };
+
+      struct entry_t
+      {
+        uint32_t name;
+        // For folders, the first child.
+        uint32_t offset;
+        // For folders, the number of children.
+        uint32_t size;
+        uint32_t mode;
+        uint32_t mtime;
+      };
+
+      int
+      fetch_ (uint32_t offset, void* buf, std::size_t nbyte);
+
+      int
+      entry_ (uint32_t index, entry_t* e);
+
+      int
+      compare_ (const entry_t& e, const char* name, std::size_t len,
+                int* result);
+
+      int
+      lookup_ (const char* path, uint32_t* index, entry_t* e);
+
+      void
+      fill_stat_ (uint32_t index, const entry_t& e, struct stat* buf) const;
+
+      // ----------------------------------------------------------------------
+
+      rtos::memory::memory_resource* resource_ = nullptr;
+
+      // The image, if the device is memory mapped.
+      const uint8_t* base_ = nullptr;
+      // Otherwise one block, for reads.
+      uint8_t* buf_ = nullptr;
+
+      std::size_t block_size_ = 0;
+      header_t header_
+        { };
+      bool mounted_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Read-only indexed file implementation.
+     * @headerfile file-system-rom.h <cmsis-plus/posix-io/file-system-rom.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class file_rom_impl : public file_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class file_system_rom_impl;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      file_rom_impl (class file_system& fs);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      file_rom_impl (const file_rom_impl&) = delete;
+      file_rom_impl (file_rom_impl&&) = delete;
+      file_rom_impl&
+      operator= (const file_rom_impl&) = delete;
+      file_rom_impl&
+      operator= (file_rom_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~file_rom_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_fstat (struct stat* buf) override;
+
+      virtual int
+      do_close (void) override;
+
+      virtual int
+      do_ftruncate (off_t length) override;
+
+      virtual int
+      do_fsync (void) override;
+
+      // Zero copy, into the mapped image.
+      virtual const void*
+      do_map (off_t offset, std::size_t length) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      file_system_rom_impl&
+      fs_impl_ (void);
+
+      uint32_t index_ = file_system_rom_impl::no_entry;
+      // Copied at open, the file is not changed.
+      uint32_t data_ = 0;
+      uint32_t size_ = 0;
+      uint32_t mtime_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Read-only indexed directory implementation.
+     * @headerfile file-system-rom.h <cmsis-plus/posix-io/file-system-rom.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class directory_rom_impl : public directory_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class file_system_rom_impl;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      directory_rom_impl (class file_system& fs);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      directory_rom_impl (const directory_rom_impl&) = delete;
+      directory_rom_impl (directory_rom_impl&&) = delete;
+      directory_rom_impl&
+      operator= (const directory_rom_impl&) = delete;
+      directory_rom_impl&
+      operator= (directory_rom_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~directory_rom_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual struct dirent*
+      do_read (void) override;
+
+      // Directly into the array, without the copy.
+      virtual ssize_t
+      do_read_n (struct dirent* buf, std::size_t count) override;
+
+      virtual void
+      do_rewind (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      file_system_rom_impl&
+      fs_impl_ (void) const;
+
+      int
+      next_ (struct dirent* de);
+
+      uint32_t first_ = 0;
+      uint32_t count_ = 0;
+      uint32_t pos_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    using file_system_rom = file_system_implementable<file_system_rom_impl>;
+
+    using file_rom = file_implementable<file_rom_impl>;
+
+    using directory_rom = directory_implementable<directory_rom_impl>;
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline const void*
+    file_system_rom_impl::image (void) const
+    {
+      return base_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_ROM_H_ */
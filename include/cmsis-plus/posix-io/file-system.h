@@ -38,6 +38,7 @@
 
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/directory.h>
+#include <cmsis-plus/posix-io/object-pool.h>
 
 #include <cmsis-plus/utils/lists.h>
 
@@ -54,6 +55,28 @@
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+
+#if !defined(OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_SIZE)
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_SIZE (8)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_PATH_SIZE)
+#define OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_PATH_SIZE (64)
+#endif
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE) */
+
+#if !defined(OS_INTEGER_POSIX_IO_FILES_POOL_SIZE)
+#define OS_INTEGER_POSIX_IO_FILES_POOL_SIZE (4)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_DIRECTORIES_POOL_SIZE)
+#define OS_INTEGER_POSIX_IO_DIRECTORIES_POOL_SIZE (2)
+#endif
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -66,6 +89,7 @@ namespace os
     class block_device;
 
     class file_system_impl;
+    class flusher_impl;
 
     /**
      * @ingroup cmsis-plus-posix-io-func
@@ -163,6 +187,10 @@ namespace os
       friend int
       statvfs (const char* path, struct statvfs* buf);
 
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      friend class flusher_impl;
+#endif
+
       /**
        * @endcond
        */
@@ -320,8 +348,96 @@ namespace os
       deferred_directories_list_t&
       deferred_directories_list (void);
 
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+
+      /**
+       * @brief Forget all cached attributes.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * Called after each change of the file system; constant time.
+       */
+      void
+      stat_cache_invalidate (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE) */
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+
+      /**
+       * @brief Record a change not yet written to the device.
+       * @param [in] bytes Number of bytes written; 0 for metadata.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * Called after each change of the file system; wakes the
+       * flusher when the dirty bytes reach its threshold.
+       */
+      void
+      dirty (std::size_t bytes);
+
+      /**
+       * @brief Check if there are changes since the last `sync()`.
+       * @par Parameters
+       *  None.
+       * @retval true There are changes.
+       * @retval false The file system is clean.
+       */
+      bool
+      is_dirty (void) const;
+
+      /**
+       * @brief Get the time of the first change since the last `sync()`.
+       * @par Parameters
+       *  None.
+       * @return The system clock timestamp.
+       */
+      rtos::clock::timestamp_t
+      dirty_since (void) const;
+
+      /**
+       * @brief Get the number of bytes written since the last `sync()`.
+       * @par Parameters
+       *  None.
+       * @return The number of bytes.
+       */
+      std::size_t
+      dirty_bytes (void) const;
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FLUSHER) */
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+      /**
+       * @brief Get the I/O statistics of all files.
+       * @par Parameters
+       *  None.
+       * @return Reference to the counters.
+       */
+      io_statistics&
+      statistics (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // ----------------------------------------------------------------------
 
+      /**
+       * @brief Pool of the file objects of type T.
+       */
+      template<typename T>
+        using files_pool = object_pool<T, OS_INTEGER_POSIX_IO_FILES_POOL_SIZE>;
+
+      /**
+       * @brief Pool of the directory objects of type T.
+       */
+      template<typename T>
+        using directories_pool = object_pool<T,
+        OS_INTEGER_POSIX_IO_DIRECTORIES_POOL_SIZE>;
+
       template<typename T>
         T*
         allocate_file (void);
@@ -376,6 +492,46 @@ namespace os
 
       const char* mounted_path_ = nullptr;
 
+      // Computed once, when mounted.
+      std::size_t mounted_path_length_ = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+
+      // Direct mapped by the path hash. Failed lookups are also
+      // kept, with the errno, to answer repeated probes for
+      // missing files.
+      struct stat_cache_entry_t
+      {
+        uint32_t hash;
+        uint32_t generation;
+        int error;
+        struct stat st;
+        char path[OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_PATH_SIZE];
+      };
+
+      stat_cache_entry_t stat_cache_[OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_SIZE]
+        { };
+
+      // Entries from older generations are invalid; starts at 1
+      // so the cleared entries do not match.
+      uint32_t stat_cache_generation_ = 1;
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE) */
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+
+      // Read by the flusher without locking; a stale value only
+      // delays the write back to the next scan.
+      rtos::clock::timestamp_t dirty_since_ = 0;
+      std::size_t dirty_bytes_ = 0;
+      bool dirty_ = false;
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FLUSHER) */
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      io_statistics statistics_;
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @endcond
        */
@@ -773,12 +929,69 @@ namespace os
   {
     // ========================================================================
 
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+
+    inline void
+    file_system::stat_cache_invalidate (void)
+    {
+      ++stat_cache_generation_;
+      if (stat_cache_generation_ == 0)
+        {
+          // Wrapped; clear the entries explicitly.
+          for (auto& e : stat_cache_)
+            {
+              e.generation = 0;
+            }
+          stat_cache_generation_ = 1;
+        }
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE) */
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+
+    inline bool
+    file_system::is_dirty (void) const
+    {
+      return dirty_;
+    }
+
+    inline rtos::clock::timestamp_t
+    file_system::dirty_since (void) const
+    {
+      return dirty_since_;
+    }
+
+    inline std::size_t
+    file_system::dirty_bytes (void) const
+    {
+      return dirty_bytes_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FLUSHER) */
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    inline io_statistics&
+    file_system::statistics (void)
+    {
+      return statistics_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
     inline const char*
     file_system::name (void) const
     {
       return name_;
     }
 
+    inline const char*
+    file_system::mounted_path (void)
+    {
+      return mounted_path_;
+    }
+
     inline file_system_impl&
     file_system::impl (void) const
     {
@@ -825,7 +1038,7 @@ namespace os
 
         if (deferred_files_list_.empty ())
           {
-            fil = new file_type (*this);
+            fil = files_pool<file_type>::create (*this);
           }
         else
           {
@@ -852,7 +1065,7 @@ namespace os
 
         if (deferred_files_list_.empty ())
           {
-            fil = new file_type (*this, locker);
+            fil = files_pool<file_type>::create (*this, locker);
           }
         else
           {
@@ -881,8 +1094,8 @@ namespace os
             file_type* f =
                 static_cast<file_type*> (deferred_files_list_.unlink_head ());
 
-            // Call the destructor and the deallocator.
-            delete f;
+            // Call the destructor and return the storage.
+            files_pool<file_type>::destroy (f);
           }
       }
 
@@ -896,7 +1109,7 @@ namespace os
 
         if (deferred_directories_list_.empty ())
           {
-            dir = new directory_type (*this);
+            dir = directories_pool<directory_type>::create (*this);
           }
         else
           {
@@ -924,7 +1137,7 @@ namespace os
 
         if (deferred_directories_list_.empty ())
           {
-            dir = new directory_type (*this, locker);
+            dir = directories_pool<directory_type>::create (*this, locker);
           }
         else
           {
@@ -954,8 +1167,8 @@ namespace os
             directory_type* d =
                 static_cast<directory_type*> (deferred_directories_list_.unlink_head ());
 
-            // Call the destructor and the deallocator.
-            delete d;
+            // Call the destructor and return the storage.
+            directories_pool<directory_type>::destroy (d);
           }
       }
 
@@ -979,7 +1192,8 @@ namespace os
               { device, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-          trace::printf ("file_system_implementable::%s(\"%s\")=@%p\n",
+          trace::printf (trace::posix_io_file_system,
+                         "file_system_implementable::%s(\"%s\")=@%p\n",
                          __func__, name_, this);
 #endif
         }
@@ -988,7 +1202,8 @@ namespace os
       file_system_implementable<T>::~file_system_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-        trace::printf ("file_system_implementable::%s() @%p %s\n", __func__,
+        trace::printf (trace::posix_io_file_system,
+                       "file_system_implementable::%s() @%p %s\n", __func__,
                        this, name_);
 #endif
       }
@@ -1014,7 +1229,8 @@ namespace os
               { device, locker, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-          trace::printf ("file_system_lockable::%s()=%p\n", __func__, this);
+          trace::printf (trace::posix_io_file_system,
+                         "file_system_lockable::%s()=%p\n", __func__, this);
 #endif
         }
 
@@ -1022,7 +1238,8 @@ namespace os
       file_system_lockable<T, L>::~file_system_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-        trace::printf ("file_system_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_file_system,
+                       "file_system_lockable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -37,10 +37,12 @@
 #endif
 
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/owner-lock-guard.h>
 #include <cmsis-plus/utils/lists.h>
 #include <cmsis-plus/posix/utime.h>
 #include <cmsis-plus/posix/sys/statvfs.h>
 
+#include <cstdio>
 #include <mutex>
 
 // ----------------------------------------------------------------------------
@@ -120,6 +122,61 @@ namespace os
       virtual int
       close (void) override;
 
+      // Buffered, if a buffer was set with setvbuf().
+      virtual ssize_t
+      read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      readv (const struct iovec* iov, int iovcnt) override;
+
+      // Buffered, if a buffer was set with setvbuf().
+      // Also invalidate the file system attributes cache.
+      virtual ssize_t
+      write (const void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      writev (const struct iovec* iov, int iovcnt) override;
+
+      virtual int
+      fstat (struct stat* buf) override;
+
+      virtual off_t
+      lseek (off_t offset, int whence) override;
+
+      /**
+       * @brief Set the buffering policy.
+       * @param [in] buf Pointer to the buffer, to be kept valid
+       *  until the file is closed, or `nullptr` for `_IONBF`.
+       * @param [in] mode `_IOFBF` (fully buffered), `_IOLBF`
+       *  (line buffered) or `_IONBF` (unbuffered).
+       * @param [in] size The size of the buffer, in bytes.
+       * @retval 0 The policy was set.
+       * @retval -1 The policy was not set, with `errno` set.
+       *
+       * @details
+       * Similar to `setvbuf()`, at the file level. The small writes
+       * are collected in the buffer and passed to the file system
+       * when it is full, on the end of line in `_IOLBF` mode, or by
+       * `flush()`, `fsync()`, `lseek()` and `close()`. The small reads
+       * are served from the buffer, refilled with full size reads.
+       */
+      virtual int
+      setvbuf (void* buf, int mode, std::size_t size);
+
+      /**
+       * @brief Write the buffered data.
+       * @par Parameters
+       *  None.
+       * @retval 0 The buffer was written, or was empty.
+       * @retval -1 Writing failed, with `errno` set.
+       *
+       * @details
+       * Also useful from a periodic maintenance thread, to bound
+       * the time the data stays in the buffer.
+       */
+      virtual int
+      flush (void);
+
       virtual int
       ftruncate (off_t length);
 
@@ -129,6 +186,17 @@ namespace os
       virtual int
       fstatvfs (struct statvfs *buf);
 
+      /**
+       * @brief Get the address of the file content.
+       * @param [in] offset The offset in the file.
+       * @param [in] length The number of bytes to map.
+       * @return Pointer to the content, usable for reading, or
+       *  `nullptr` with `errno` set (`ENODEV` if the file is not
+       *  stored contiguously in memory mapped storage).
+       */
+      virtual const void*
+      map (off_t offset, std::size_t length);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -142,6 +210,25 @@ namespace os
        * @}
        */
 
+      // ----------------------------------------------------------------------
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      // Pass the data to the file system, bypassing the buffer.
+      ssize_t
+      write_ (const void* buf, std::size_t nbyte);
+
+      // Flush the written data, or give back the read ahead data.
+      int
+      sync_buffer_ (void);
+
+      /**
+       * @endcond
+       */
+
       // ----------------------------------------------------------------------
     public:
 
@@ -153,6 +240,26 @@ namespace os
       // deallocation list. Must be public.
       utils::double_list_links deferred_links_;
 
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      uint8_t* buf_ = nullptr;
+      std::size_t buf_size_ = 0;
+      // The written bytes not yet flushed, or the read ahead bytes.
+      std::size_t buf_count_ = 0;
+      // The next read ahead byte.
+      std::size_t buf_pos_ = 0;
+      int buf_mode_ = _IONBF;
+      bool buf_dirty_ = false;
+
       /**
        * @endcond
        */
@@ -223,6 +330,9 @@ namespace os
       virtual int
       do_fsync (void) = 0;
 
+      virtual const void*
+      do_map (off_t offset, std::size_t length);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -383,6 +493,9 @@ namespace os
         virtual ssize_t
         read (void* buf, std::size_t nbyte) override;
 
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
         virtual ssize_t
         write (const void* buf, std::size_t nbyte) override;
 
@@ -404,6 +517,15 @@ namespace os
         virtual int
         fsync (void) override;
 
+        virtual const void*
+        map (off_t offset, std::size_t length) override;
+
+        virtual int
+        setvbuf (void* buf, int mode, std::size_t size) override;
+
+        virtual int
+        flush (void) override;
+
         // fstatvfs() - must not be locked, since will be locked by the
         // file system. (otherwise non-recursive mutexes will fail).
 
@@ -413,6 +535,31 @@ namespace os
         value_type&
         impl (void) const;
 
+        /**
+         * @brief Register the only thread using the object.
+         * @param [in] th Pointer to the owner thread, or `nullptr` to
+         *  take the locker again for each call.
+         * @par Returns
+         *  Nothing.
+         *
+         * @details
+         * While an owner is registered, the calls do not take the
+         * locker; debug builds assert that they come from the owner.
+         * The locker is shared with the file system, so register
+         * an owner only when no other thread uses the file system.
+         */
+        void
+        owner (rtos::thread* th);
+
+        /**
+         * @brief Get the owner thread.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the owner thread, or `nullptr`.
+         */
+        rtos::thread*
+        owner (void) const;
+
         /**
          * @}
          */
@@ -428,6 +575,8 @@ namespace os
 
         lockable_type& locker_;
 
+        rtos::thread* owner_ = nullptr;
+
         /**
          * @endcond
          */
@@ -475,7 +624,8 @@ namespace os
             { fs }
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_implementable::%s()=@%p\n", __func__, this);
+        trace::printf (trace::posix_io_file,
+                       "file_implementable::%s()=@%p\n", __func__, this);
 #endif
       }
 
@@ -483,7 +633,8 @@ namespace os
       file_implementable<T>::~file_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_implementable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_file,
+                       "file_implementable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -506,7 +657,8 @@ namespace os
           locker_ (locker)
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_lockable::%s()=@%p\n", __func__, this);
+        trace::printf (trace::posix_io_file,
+                       "file_lockable::%s()=@%p\n", __func__, this);
 #endif
       }
 
@@ -514,7 +666,8 @@ namespace os
       file_lockable<T, L>::~file_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_file,
+                       "file_lockable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -524,8 +677,8 @@ namespace os
       int
       file_lockable<T, L>::close (void)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::close ();
       }
@@ -534,18 +687,28 @@ namespace os
       ssize_t
       file_lockable<T, L>::read (void* buf, std::size_t nbyte)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::read (buf, nbyte);
       }
 
+    template<typename T, typename L>
+      ssize_t
+      file_lockable<T, L>::readv (const struct iovec* iov, int iovcnt)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return file::readv (iov, iovcnt);
+      }
+
     template<typename T, typename L>
       ssize_t
       file_lockable<T, L>::write (const void* buf, std::size_t nbyte)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::write (buf, nbyte);
       }
@@ -554,8 +717,8 @@ namespace os
       ssize_t
       file_lockable<T, L>::writev (const struct iovec* iov, int iovcnt)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::writev (iov, iovcnt);
       }
@@ -564,8 +727,8 @@ namespace os
       int
       file_lockable<T, L>::vfcntl (int cmd, std::va_list args)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::vfcntl (cmd, args);
       }
@@ -574,8 +737,8 @@ namespace os
       int
       file_lockable<T, L>::fstat (struct stat* buf)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::fstat (buf);
       }
@@ -584,8 +747,8 @@ namespace os
       off_t
       file_lockable<T, L>::lseek (off_t offset, int whence)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::lseek (offset, whence);
       }
@@ -594,8 +757,8 @@ namespace os
       int
       file_lockable<T, L>::ftruncate (off_t length)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::ftruncate (length);
       }
@@ -604,12 +767,56 @@ namespace os
       int
       file_lockable<T, L>::fsync (void)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return file::fsync ();
       }
 
+    template<typename T, typename L>
+      const void*
+      file_lockable<T, L>::map (off_t offset, std::size_t length)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return file::map (offset, length);
+      }
+
+    template<typename T, typename L>
+      int
+      file_lockable<T, L>::setvbuf (void* buf, int mode, std::size_t size)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return file::setvbuf (buf, mode, size);
+      }
+
+    template<typename T, typename L>
+      int
+      file_lockable<T, L>::flush (void)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return file::flush ();
+      }
+
+    template<typename T, typename L>
+      inline void
+      file_lockable<T, L>::owner (rtos::thread* th)
+      {
+        owner_ = th;
+      }
+
+    template<typename T, typename L>
+      inline rtos::thread*
+      file_lockable<T, L>::owner (void) const
+      {
+        return owner_;
+      }
+
     template<typename T, typename L>
       typename file_lockable<T, L>::value_type&
       file_lockable<T, L>::impl (void) const
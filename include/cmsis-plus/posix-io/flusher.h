@@ -0,0 +1,276 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_FLUSHER_H_
+#define CMSIS_PLUS_POSIX_IO_FLUSHER_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/char-device.h>
+#include <cmsis-plus/posix-io/file-system.h>
+
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_FLUSHER_PRIORITY)
+#define OS_INTEGER_POSIX_IO_FLUSHER_PRIORITY (os::rtos::thread::priority::below_normal)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_FLUSHER_STACK_SIZE_BYTES)
+#define OS_INTEGER_POSIX_IO_FLUSHER_STACK_SIZE_BYTES (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_FLUSHER_PERIOD_MS)
+#define OS_INTEGER_POSIX_IO_FLUSHER_PERIOD_MS (500)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_FLUSHER_EXPIRE_MS)
+#define OS_INTEGER_POSIX_IO_FLUSHER_EXPIRE_MS (3000)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_FLUSHER_DIRTY_BYTES)
+#define OS_INTEGER_POSIX_IO_FLUSHER_DIRTY_BYTES (16 * 1024)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Background flusher implementation.
+     * @headerfile flusher.h <cmsis-plus/posix-io/flusher.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * While the device is open, a thread scans the mounted file
+     * systems each period and calls `sync()` on those with changes
+     * older than the expire time, or with more dirty bytes than
+     * the threshold; reaching the threshold also wakes the thread
+     * immediately. Writes thus complete at cache speed, and the
+     * changes lost on a power failure are limited to the expire
+     * time, plus one period.
+     *
+     * The tunables are set with `ioctl()`: `FLSSETPERIOD`,
+     * `FLSSETEXPIRE` (milliseconds), `FLSSETDIRTY` (bytes) and
+     * `FLSSETPRIO`, with the matching `FLSGET*` requests.
+     *
+     * The file systems are synchronised from the flusher thread,
+     * so the application must use the lockable variants if it
+     * accesses them concurrently. The buffers set by
+     * `file::setvbuf()` belong to the application and are not
+     * flushed.
+     *
+     * Only one flusher can be open at a time.
+     */
+    class flusher_impl : public char_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class file_system;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      flusher_impl (void);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      flusher_impl (const flusher_impl&) = delete;
+      flusher_impl (flusher_impl&&) = delete;
+      flusher_impl&
+      operator= (const flusher_impl&) = delete;
+      flusher_impl&
+      operator= (flusher_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~flusher_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      // Starts the thread.
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      // Fails with ENOSYS.
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      // Fails with ENOSYS.
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      // Stops the thread, after the scan in progress.
+      virtual int
+      do_close (void) override;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      /**
+       * @brief Get the number of file systems synchronised.
+       * @par Parameters
+       *  None.
+       * @return The number of `sync()` calls.
+       */
+      std::size_t
+      write_backs (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Called by file_system::dirty().
+      static void
+      notify (file_system& fs);
+
+      static void*
+      run_ (void* args);
+
+      void
+      scan_ (void);
+
+      bool
+      due_ (file_system& fs, rtos::clock::timestamp_t now,
+            rtos::clock::duration_t expire) const;
+
+      // ----------------------------------------------------------------------
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+      using thread_type = rtos::thread_inclusive<OS_INTEGER_POSIX_IO_FLUSHER_STACK_SIZE_BYTES>;
+#else
+      using thread_type = rtos::thread;
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+      // Constructed on open, destroyed on close.
+      std::aligned_storage<sizeof(thread_type), alignof(thread_type)>::type thread_storage_;
+      thread_type* thread_ = nullptr;
+
+      uint32_t period_ms_ = OS_INTEGER_POSIX_IO_FLUSHER_PERIOD_MS;
+      uint32_t expire_ms_ = OS_INTEGER_POSIX_IO_FLUSHER_EXPIRE_MS;
+      std::size_t dirty_bytes_ = OS_INTEGER_POSIX_IO_FLUSHER_DIRTY_BYTES;
+      rtos::thread::priority_t priority_ = OS_INTEGER_POSIX_IO_FLUSHER_PRIORITY;
+
+      std::size_t write_backs_ = 0;
+      volatile bool stop_ = false;
+
+      // The open flusher, if any.
+      static flusher_impl* volatile running__;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    /**
+     * @brief Background flusher device.
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    using flusher = char_device_implementable<flusher_impl>;
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline std::size_t
+    flusher_impl::write_backs (void) const
+    {
+      return write_backs_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FLUSHER) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_FLUSHER_H_ */
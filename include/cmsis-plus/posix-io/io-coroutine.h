@@ -0,0 +1,161 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_IO_COROUTINE_H_
+#define CMSIS_PLUS_POSIX_IO_IO_COROUTINE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/io.h>
+
+// The reads are built on the asynchronous I/O, and the
+// coroutines require C++20.
+#if defined(OS_INCLUDE_POSIX_IO_AIO) && defined(__cpp_impl_coroutine) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    namespace coroutine
+    {
+      // ======================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Awaitable read.
+       * @headerfile io-coroutine.h <cmsis-plus/posix-io/io-coroutine.h>
+       * @ingroup cmsis-plus-posix-io-base
+       *
+       * @details
+       * The read is queued with `io::aio_read()`, and the
+       * completion callback posts the coroutine to its executor.
+       */
+      class read_awaiter : public rtos::coroutine::awaiter
+      {
+      public:
+
+        /**
+         * @brief Read from a file or device.
+         * @param [in] io Reference to the file or device.
+         * @param [out] buf The address where to store the data.
+         * @param [in] nbyte The size of the buffer.
+         * @param [in] offset File offset, ignored by devices that
+         *  cannot seek.
+         */
+        read_awaiter (class io& io, void* buf, std::size_t nbyte,
+                      off_t offset = 0);
+
+        /**
+         * @brief Get the result of the read.
+         * @par Parameters
+         *  None.
+         * @return The number of bytes read, or -1 with `errno` set,
+         *  like `read()`.
+         */
+        ssize_t
+        await_resume (void) noexcept;
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        virtual bool
+        internal_start_ (void) override;
+
+        static void
+        internal_notify_ (aiocb* cb);
+
+        class io& io_;
+        aiocb cb_;
+        int error_ = 0;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @brief Read in a coroutine.
+       * @param [in] io Reference to the file or device.
+       * @param [out] buf The address where to store the data.
+       * @param [in] nbyte The size of the buffer.
+       * @param [in] offset File offset, ignored by devices that
+       *  cannot seek.
+       * @return An awaitable; `co_await` returns the number of
+       *  bytes read, or -1 with `errno` set.
+       */
+      read_awaiter
+      read (class io& io, void* buf, std::size_t nbyte, off_t offset = 0);
+
+    } /* namespace coroutine */
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    namespace coroutine
+    {
+      // ======================================================================
+
+      inline read_awaiter
+      read (class io& io, void* buf, std::size_t nbyte, off_t offset)
+      {
+        return read_awaiter
+          { io, buf, nbyte, offset };
+      }
+
+    } /* namespace coroutine */
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) && defined(__cpp_impl_coroutine) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_IO_COROUTINE_H_ */
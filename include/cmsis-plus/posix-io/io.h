@@ -37,20 +37,53 @@
 #endif
 
 #include <cmsis-plus/posix-io/types.h>
+#include <cmsis-plus/rtos/os-decls.h>
 #include <cmsis-plus/diag/trace.h>
 
 #include <cstddef>
 #include <cstdarg>
+#include <cstdint>
 
 // Needed for ssize_t
 #include <sys/types.h>
 
+// Needed for O_NONBLOCK
+#include <fcntl.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+#if !defined(OS_INTEGER_POSIX_IO_AIO_PRIORITY)
+#define OS_INTEGER_POSIX_IO_AIO_PRIORITY (os::rtos::thread::priority::normal)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_AIO_QUEUE_SIZE)
+#define OS_INTEGER_POSIX_IO_AIO_QUEUE_SIZE (4)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES)
+#define OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
+#if !defined(OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE_BYTES)
+#define OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE_BYTES (128)
+#endif
+
 // ----------------------------------------------------------------------------
 
 struct iovec;
 
 namespace os
 {
+  namespace rtos
+  {
+    class semaphore;
+    class work_queue;
+  } /* namespace rtos */
+
   namespace posix
   {
     // ------------------------------------------------------------------------
@@ -58,9 +91,222 @@ namespace os
     class io;
     class io_impl;
 
+    class device;
     class file_system;
     class socket;
 
+    class event_poll_impl;
+    struct event_poll_entry;
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+    // ========================================================================
+
+    /**
+     * @brief Asynchronous I/O control block.
+     * @headerfile io.h <cmsis-plus/posix-io/io.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * Similar to the POSIX `struct aiocb`, with a completion
+     * callback instead of the signal event. The block must
+     * remain valid until the request completes.
+     */
+    struct aiocb
+    {
+      /**
+       * @brief Type of completion callbacks.
+       */
+      using notify_t = void (*) (aiocb* cb);
+
+      /**
+       * @brief File offset, ignored by devices that cannot seek.
+       */
+      off_t aio_offset = 0;
+
+      /**
+       * @brief Location of the buffer.
+       */
+      void* aio_buf = nullptr;
+
+      /**
+       * @brief Length of the transfer.
+       */
+      std::size_t aio_nbytes = 0;
+
+      /**
+       * @brief Function called on completion, possibly from
+       *  an interrupt; may be `nullptr`.
+       */
+      notify_t aio_notify = nullptr;
+
+      /**
+       * @brief User data, passed through unchanged.
+       */
+      void* aio_notify_args = nullptr;
+
+      /**
+       * @cond ignore
+       */
+
+      // Managed by the implementation; use aio_error()/aio_return().
+      io* aio_io_ = nullptr;
+      ssize_t aio_return_ = -1;
+      volatile int aio_error_ = 0;
+      bool aio_write_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    // ========================================================================
+
+    /**
+     * @brief I/O statistics.
+     * @headerfile io.h <cmsis-plus/posix-io/io.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * Counters kept for each I/O object and for each file system
+     * (all its files). The latencies are measured with `hrclock`,
+     * in CPU cycles.
+     */
+    struct io_statistics
+    {
+      /**
+       * @brief Number of successful read operations.
+       */
+      std::size_t reads = 0;
+
+      /**
+       * @brief Number of successful write operations.
+       */
+      std::size_t writes = 0;
+
+      /**
+       * @brief Number of failed operations.
+       */
+      std::size_t errors = 0;
+
+      /**
+       * @brief Total bytes read.
+       */
+      uint64_t read_bytes = 0;
+
+      /**
+       * @brief Total bytes written.
+       */
+      uint64_t written_bytes = 0;
+
+      /**
+       * @brief Accumulated read latency, in CPU cycles.
+       */
+      uint64_t read_cycles = 0;
+
+      /**
+       * @brief Accumulated write latency, in CPU cycles.
+       */
+      uint64_t write_cycles = 0;
+
+      /**
+       * @brief Longest read, in CPU cycles.
+       */
+      uint64_t read_max_cycles = 0;
+
+      /**
+       * @brief Longest write, in CPU cycles.
+       */
+      uint64_t write_max_cycles = 0;
+
+      /**
+       * @brief Account for an operation.
+       * @param [in] write True for writes.
+       * @param [in] nbyte The result of the operation; negative
+       *  for errors.
+       * @param [in] begin The `hrclock` timestamp of the start.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      record (bool write, ssize_t nbyte, uint64_t begin);
+
+      /**
+       * @brief Get a consistent copy of the counters.
+       * @param [out] buf Reference to the destination.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      snapshot (io_statistics& buf) const;
+
+      /**
+       * @brief Reset all counters.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clear (void);
+
+      /**
+       * @brief Print the counters on the trace channel.
+       * @param [in] name The name to print in front.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      dump (const char* name) const;
+    };
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+    // ========================================================================
+
+    /**
+     * @brief Resolved path.
+     * @headerfile io.h <cmsis-plus/posix-io/io.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * Filled by `resolve()` with the device, or with the mounted
+     * file system and the path relative to its mount point, so that
+     * `open_at()` can skip the device registry and the mount table.
+     * The _path_ points inside the string passed to `resolve()`,
+     * which must remain valid while the handle is used.
+     *
+     * A file system unmounted since `resolve()` is detected; a new
+     * file system mounted over the path is not, so resolve
+     * the path again after `mount()`.
+     */
+    struct path_handle
+    {
+      /**
+       * @brief Pointer to the device, or `nullptr` for a file.
+       */
+      class device* device;
+
+      /**
+       * @brief Pointer to the file system, or `nullptr` for a device.
+       */
+      class file_system* file_system;
+
+      /**
+       * @brief The mount point at the time of `resolve()`.
+       */
+      const char* mounted_path;
+
+      /**
+       * @brief The path passed to `vopen()` of the device or file system.
+       */
+      const char* path;
+    };
+
     /**
      * @ingroup cmsis-plus-posix-io-func
      * @{
@@ -73,6 +319,53 @@ namespace os
     io*
     vopen (const char* path, int oflag, std::va_list args);
 
+    /**
+     * @brief Resolve a path once, for repeated opens.
+     * @param [in] path Pointer to the path, to be kept valid
+     *  while the handle is used.
+     * @param [out] handle Pointer to the handle to fill.
+     * @retval 0 The path was resolved.
+     * @retval -1 The path was not resolved, with `errno` set.
+     */
+    int
+    resolve (const char* path, path_handle* handle);
+
+    /**
+     * @brief Open a resolved path.
+     * @param [in] handle Reference to a handle filled by `resolve()`.
+     * @param [in] oflag The `open()` flags.
+     * @return Pointer to the opened object, or `nullptr` with `errno` set;
+     *  `ESTALE` if the file system was unmounted since `resolve()`.
+     */
+    io*
+    open_at (const path_handle& handle, int oflag, ...);
+
+    io*
+    vopen_at (const path_handle& handle, int oflag, std::va_list args);
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+    /**
+     * @brief Get the status of an asynchronous request.
+     * @param [in] cb Pointer to the control block.
+     * @retval 0 The request completed successfully.
+     * @retval EINPROGRESS The request did not complete yet.
+     * @return The error of the failed request.
+     */
+    int
+    aio_error (const aiocb* cb);
+
+    /**
+     * @brief Get the result of a completed asynchronous request.
+     * @param [in] cb Pointer to the control block.
+     * @return The value the synchronous `read()`/`write()` would have
+     *  returned.
+     */
+    ssize_t
+    aio_return (aiocb* cb);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
     /**
      * @}
      */
@@ -124,7 +417,10 @@ namespace os
         block_device = 1 << 2,
         tty = 1 << 3,
         file = 1 << 4,
-        socket = 1 << 5
+        socket = 1 << 5,
+        event_poll = 1 << 6,
+        pipe = 1 << 7,
+        shared_memory = 1 << 8
       };
 
       /**
@@ -181,12 +477,47 @@ namespace os
       virtual ssize_t
       read (void* buf, std::size_t nbyte);
 
+      virtual ssize_t
+      readv (const struct iovec* iov, int iovcnt);
+
       virtual ssize_t
       write (const void* buf, std::size_t nbyte);
 
       virtual ssize_t
       writev (const struct iovec* iov, int iovcnt);
 
+      /**
+       * @brief Copy data from another object.
+       * @param [in] in Pointer to the object to read from.
+       * @param [in,out] offset Pointer to the offset in _in_ to read
+       *  from, updated on return; if `nullptr`, read from the current
+       *  offset of _in_.
+       * @param [in] count The number of bytes to copy.
+       * @return The number of bytes copied, or -1 with `errno` set.
+       */
+      virtual ssize_t
+      sendfile (io* in, off_t* offset, std::size_t count);
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+      int
+      aio_read (aiocb* cb);
+
+      int
+      aio_write (aiocb* cb);
+
+      /**
+       * @brief Get the shared I/O worker.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the work queue running the requests
+       *  of implementations without native asynchronous I/O.
+       */
+      static rtos::work_queue*
+      aio_queue (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
       int
       fcntl (int cmd, ...);
 
@@ -202,6 +533,30 @@ namespace os
       virtual off_t
       lseek (off_t offset, int whence);
 
+      /**
+       * @brief Register for readiness notifications.
+       * @param [in] events The `POLLIN`/`POLLOUT`/... events of interest.
+       * @param [in] sem Pointer to the semaphore to post when the
+       *  readiness may have changed, or `nullptr` to unregister.
+       * @return The events currently ready, possibly with `POLLHUP`
+       *  or `POLLERR`; `POLLNVAL` if not opened.
+       */
+      int
+      poll_register (int events, rtos::semaphore* sem);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+      /**
+       * @brief Get the I/O statistics.
+       * @par Parameters
+       *  None.
+       * @return Reference to the counters of this object.
+       */
+      io_statistics&
+      statistics (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -248,6 +603,14 @@ namespace os
       io*
       alloc_file_descriptor (void);
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+      // Record in this object and, for files, in the file system.
+      void
+      account_ (bool write, ssize_t nbyte, uint64_t begin);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @}
        */
@@ -276,6 +639,10 @@ namespace os
 
       file_descriptor_t file_descriptor_ = no_file_descriptor;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      io_statistics statistics_;
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @endcond
        */
@@ -288,6 +655,7 @@ namespace os
       // ----------------------------------------------------------------------
 
       friend class io;
+      friend class event_poll_impl;
 
       /**
        * @name Constructors & Destructor
@@ -343,12 +711,28 @@ namespace os
       virtual ssize_t
       do_read (void* buf, std::size_t nbyte) = 0;
 
+      virtual ssize_t
+      do_readv (const struct iovec* iov, int iovcnt);
+
       virtual ssize_t
       do_write (const void* buf, std::size_t nbyte) = 0;
 
       virtual ssize_t
       do_writev (const struct iovec* iov, int iovcnt);
 
+      virtual ssize_t
+      do_sendfile (io& out, io& in, std::size_t count);
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+      virtual int
+      do_aio_read (aiocb* cb);
+
+      virtual int
+      do_aio_write (aiocb* cb);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
       virtual int
       do_vfcntl (int cmd, std::va_list args);
 
@@ -364,6 +748,51 @@ namespace os
       virtual int
       do_close (void) = 0;
 
+      virtual int
+      do_poll_register (int events, rtos::semaphore* sem);
+
+      /**
+       * @brief Notify the registered poller.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * Called by implementations from their receive and transmit
+       * paths, possibly in an interrupt; does nothing when no
+       * poller is registered. An `event_poll` watching the object
+       * is also notified.
+       */
+      void
+      poll_notify (void);
+
+      /**
+       * @brief Get the ready events, keeping the current registration.
+       * @param [in] events The `POLLIN`/`POLLOUT`/... events of interest.
+       * @return The events currently ready.
+       */
+      int
+      poll_ready (int events);
+
+      /**
+       * @brief Wait for the receive or transmit path to progress.
+       * @param [in] sem Reference to the semaphore posted by the
+       *  receive or transmit path.
+       * @param [in] write `true` for the transmit path.
+       * @retval 0 The semaphore was posted; check again.
+       * @retval -1 The caller must not wait, with `errno` set to
+       *  `EAGAIN` if `O_NONBLOCK` is set or the timeout expired,
+       *  or to `EINTR`.
+       *
+       * @details
+       * Called by implementations instead of waiting on their
+       * semaphores directly, so `O_NONBLOCK` and the receive and
+       * send timeouts are honoured uniformly.
+       */
+      int
+      wait_for_io (rtos::semaphore& sem, bool write);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -373,6 +802,52 @@ namespace os
       void
       offset (off_t offset);
 
+      /**
+       * @brief Check if `O_NONBLOCK` is set.
+       * @par Parameters
+       *  None.
+       * @retval true The read and write calls must not block.
+       * @retval false The read and write calls may block.
+       */
+      bool
+      is_nonblocking (void) const;
+
+      /**
+       * @brief Get the receive timeout.
+       * @par Parameters
+       *  None.
+       * @return The number of SysTick ticks, or 0 to wait forever.
+       */
+      rtos::port::clock::duration_t
+      receive_timeout (void) const;
+
+      /**
+       * @brief Set the receive timeout.
+       * @param [in] ticks The number of SysTick ticks, or 0 to wait forever.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      receive_timeout (rtos::port::clock::duration_t ticks);
+
+      /**
+       * @brief Get the send timeout.
+       * @par Parameters
+       *  None.
+       * @return The number of SysTick ticks, or 0 to wait forever.
+       */
+      rtos::port::clock::duration_t
+      send_timeout (void) const;
+
+      /**
+       * @brief Set the send timeout.
+       * @param [in] ticks The number of SysTick ticks, or 0 to wait forever.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      send_timeout (rtos::port::clock::duration_t ticks);
+
       /**
        * @}
        */
@@ -380,12 +855,50 @@ namespace os
       // ----------------------------------------------------------------------
     protected:
 
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+      /**
+       * @brief Complete an asynchronous request.
+       * @param [in] cb Pointer to the control block.
+       * @param [in] ret The transfer result.
+       * @param [in] error The `errno` for a failed transfer, or 0.
+       * @par Returns
+       *  Nothing.
+       */
+      static void
+      aio_complete (aiocb* cb, ssize_t ret, int error);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
       /**
        * @cond ignore
        */
 
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+      static int
+      aio_post_ (aiocb* cb);
+
+      static void
+      aio_run_ (void* args);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
       off_t offset_ = 0;
 
+      // The open() access mode and the fcntl(F_SETFL) status flags.
+      int status_flags_ = 0;
+
+      // In SysTick ticks, 0 to wait forever.
+      rtos::port::clock::duration_t receive_timeout_ = 0;
+      rtos::port::clock::duration_t send_timeout_ = 0;
+
+      // The semaphore of the poll() waiting for this object, if any.
+      rtos::semaphore* volatile poll_sem_ = nullptr;
+
+      // The interest set entry of the event_poll watching this object.
+      event_poll_entry* volatile poll_entry_ = nullptr;
+
       /**
        * @endcond
        */
@@ -439,6 +952,16 @@ namespace os
       return impl_;
     }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    inline io_statistics&
+    io::statistics (void)
+    {
+      return statistics_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
     // ========================================================================
 
     inline off_t
@@ -453,6 +976,42 @@ namespace os
       offset_ = offset;
     }
 
+    inline bool
+    io_impl::is_nonblocking (void) const
+    {
+      return (status_flags_ & O_NONBLOCK) != 0;
+    }
+
+    inline rtos::port::clock::duration_t
+    io_impl::receive_timeout (void) const
+    {
+      return receive_timeout_;
+    }
+
+    inline void
+    io_impl::receive_timeout (rtos::port::clock::duration_t ticks)
+    {
+      receive_timeout_ = ticks;
+    }
+
+    inline rtos::port::clock::duration_t
+    io_impl::send_timeout (void) const
+    {
+      return send_timeout_;
+    }
+
+    inline void
+    io_impl::send_timeout (rtos::port::clock::duration_t ticks)
+    {
+      send_timeout_ = ticks;
+    }
+
+    inline int
+    io_impl::poll_ready (int events)
+    {
+      return do_poll_register (events, poll_sem_);
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
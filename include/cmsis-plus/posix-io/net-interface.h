@@ -36,6 +36,17 @@
 #include <cmsis-plus/os-app-config.h>
 #endif
 
+#include <cmsis-plus/posix-io/pbuf.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_NET_INTERFACE_RING_SIZE)
+#define OS_INTEGER_POSIX_IO_NET_INTERFACE_RING_SIZE (8)
+#endif
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -48,15 +59,40 @@ namespace os
 
     // ========================================================================
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
     /**
      * @brief Network interface class.
      * @headerfile net-interface.h <cmsis-plus/posix-io/net-interface.h>
      * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * The interface passes packet buffers between the network
+     * driver and the network stack via two rings of `pbuf`
+     * pointers, so the payload stays in the buffers filled by the
+     * driver DMA, or by the application.
+     *
+     * The receive ring is fed by the driver, usually from its
+     * interrupt handler, and drained by the stack thread; the
+     * transmit ring is fed by the stack, with its lock held, and
+     * drained by the driver. Each ring has a single producer and a
+     * single consumer, and needs no locks.
      */
     class net_interface
     {
       // ----------------------------------------------------------------------
 
+    public:
+
+      /**
+       * @brief Type of the packet buffers rings.
+       */
+      using ring_type = rtos::spsc_queue<pbuf*,
+      OS_INTEGER_POSIX_IO_NET_INTERFACE_RING_SIZE>;
+
+      // ----------------------------------------------------------------------
+
       /**
        * @name Constructors & Destructor
        * @{
@@ -89,9 +125,219 @@ namespace os
        * @}
        */
 
-      // TODO: add content
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Pass a received packet to the stack.
+       * @param [in] chain Pointer to the packet buffers.
+       * @retval true The packet was queued.
+       * @retval false The receive ring is full; the packet was
+       *  freed and counted as dropped.
+       *
+       * @details
+       * Called by the driver; can be invoked from Interrupt
+       * Service Routines.
+       */
+      bool
+      input (pbuf* chain);
+
+      /**
+       * @brief Get the next received packet, waiting if none.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the packet buffers, owned by the caller,
+       *  or `nullptr` if the wait was interrupted.
+       */
+      pbuf*
+      receive (void);
+
+      /**
+       * @brief Try to get the next received packet.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the packet buffers, owned by the caller,
+       *  or `nullptr` if none.
+       */
+      pbuf*
+      try_receive (void);
+
+      /**
+       * @brief Get the next received packet, waiting at most
+       *  the timeout.
+       * @param [in] timeout Timeout to wait, in sysclock ticks.
+       * @return Pointer to the packet buffers, owned by the caller,
+       *  or `nullptr` if none arrived.
+       */
+      pbuf*
+      timed_receive (rtos::clock::duration_t timeout);
+
+      /**
+       * @brief Queue a packet for transmission.
+       * @param [in] chain Pointer to the packet buffers; on success
+       *  the reference passes to the interface.
+       * @retval 0 The packet was queued and the driver notified.
+       * @retval -1 The transmit ring is full and `errno` is
+       *  `ENOBUFS`; the caller keeps the packet.
+       */
+      int
+      output (pbuf* chain);
+
+      /**
+       * @brief Get the next packet to transmit.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the packet buffers, or `nullptr` if none;
+       *  the driver frees them after the transfer.
+       *
+       * @details
+       * Called by the driver; can be invoked from Interrupt
+       * Service Routines.
+       */
+      pbuf*
+      next_output (void);
+
+      /**
+       * @brief Get the number of dropped received packets.
+       * @par Parameters
+       *  None.
+       * @return The number of packets freed because the
+       *  receive ring was full.
+       */
+      std::size_t
+      rx_dropped (void) const;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      const char*
+      name (void) const;
+
+      net_interface_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      const char* name_ = nullptr;
+
+      net_interface_impl& impl_;
+
+      ring_type rx_ring_;
+      ring_type tx_ring_;
+
+      std::size_t rx_dropped_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    class net_interface_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      net_interface_impl (void);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      net_interface_impl (const net_interface_impl&) = delete;
+      net_interface_impl (net_interface_impl&&) = delete;
+      net_interface_impl&
+      operator= (const net_interface_impl&) = delete;
+      net_interface_impl&
+      operator= (net_interface_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~net_interface_impl ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Notify the driver that packets wait in the
+       *  transmit ring.
+       * @param [in] interface Reference to the interface.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_start_output (net_interface& interface) = 0;
+
+      /**
+       * @}
+       */
     };
 
+#pragma GCC diagnostic pop
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline const char*
+    net_interface::name (void) const
+    {
+      return name_;
+    }
+
+    inline net_interface_impl&
+    net_interface::impl (void) const
+    {
+      return impl_;
+    }
+
+    inline std::size_t
+    net_interface::rx_dropped (void) const
+    {
+      return rx_dropped_;
+    }
+
   } /* namespace posix */
 } /* namespace os */
 
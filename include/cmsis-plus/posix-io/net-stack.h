@@ -37,6 +37,7 @@
 #endif
 
 #include <cmsis-plus/posix-io/socket.h>
+#include <cmsis-plus/posix-io/object-pool.h>
 #include <cmsis-plus/utils/lists.h>
 
 #include <cmsis-plus/diag/trace.h>
@@ -46,6 +47,12 @@
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INTEGER_POSIX_IO_SOCKETS_POOL_SIZE)
+#define OS_INTEGER_POSIX_IO_SOCKETS_POOL_SIZE (4)
+#endif
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -139,6 +146,12 @@ namespace os
 
       // ----------------------------------------------------------------------
 
+      /**
+       * @brief Pool of the socket objects of type T.
+       */
+      template<typename T>
+        using sockets_pool = object_pool<T, OS_INTEGER_POSIX_IO_SOCKETS_POOL_SIZE>;
+
       template<typename T>
         T*
         allocate_socket (void);
@@ -490,7 +503,7 @@ namespace os
 
         if (deferred_sockets_list_.empty ())
           {
-            sock = new socket_type (*this);
+            sock = sockets_pool<socket_type>::create (*this);
           }
         else
           {
@@ -509,8 +522,8 @@ namespace os
                 socket_type* s =
                     static_cast<socket_type*> (deferred_sockets_list_.unlink_head ());
 
-                // Call the destructor and the deallocator.
-                delete s;
+                // Call the destructor and return the storage.
+                sockets_pool<socket_type>::destroy (s);
               }
           }
         return sock;
@@ -526,7 +539,7 @@ namespace os
 
         if (deferred_sockets_list_.empty ())
           {
-            sock = new socket_type (*this, locker);
+            sock = sockets_pool<socket_type>::create (*this, locker);
           }
         else
           {
@@ -545,8 +558,8 @@ namespace os
                 socket_type* s =
                     static_cast<socket_type*> (deferred_sockets_list_.unlink_head ());
 
-                // Call the destructor and the deallocator.
-                delete s;
+                // Call the destructor and return the storage.
+                sockets_pool<socket_type>::destroy (s);
               }
           }
         return sock;
@@ -572,7 +585,8 @@ namespace os
               { interface, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-          trace::printf ("net_stack_implementable::%s(\"%s\")=@%p\n", __func__,
+          trace::printf (trace::posix_io_net_stack,
+                         "net_stack_implementable::%s(\"%s\")=@%p\n", __func__,
                          name_, this);
 #endif
         }
@@ -581,7 +595,8 @@ namespace os
       net_stack_implementable<T>::~net_stack_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-        trace::printf ("net_stack_implementable::%s() @%p %s\n", __func__, this,
+        trace::printf (trace::posix_io_net_stack,
+                       "net_stack_implementable::%s() @%p %s\n", __func__, this,
                        name_);
 #endif
       }
@@ -607,7 +622,8 @@ namespace os
               { interface, locker, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-          trace::printf ("net_stack_lockable::%s()=%p\n", __func__, this);
+          trace::printf (trace::posix_io_net_stack,
+                         "net_stack_lockable::%s()=%p\n", __func__, this);
 #endif
         }
 
@@ -615,7 +631,8 @@ namespace os
       net_stack_lockable<T, L>::~net_stack_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-        trace::printf ("net_stack_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_net_stack,
+                       "net_stack_lockable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -0,0 +1,316 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_OBJECT_POOL_H_
+#define CMSIS_PLUS_POSIX_IO_OBJECT_POOL_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/memory/block-pool.h>
+
+#include <type_traits>
+#include <utility>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @brief Fixed size pool of file, directory or socket objects.
+     * @headerfile object-pool.h <cmsis-plus/posix-io/object-pool.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @tparam T Type of the objects.
+     * @tparam N Number of objects in the pool.
+     *
+     * @details
+     * There is a single pool for each object type, statically
+     * allocated and constructed on first use, so it is
+     * available before the static constructors run.
+     * Objects are taken from the pool in constant time; when
+     * the pool is exhausted, they are allocated on the free store,
+     * and `destroy()` returns each one to where it came from.
+     *
+     * The usage counters are those of the memory resource,
+     * `allocated_chunks()`, `free_chunks()`, `allocations()`,
+     * `deallocations()` and `max_allocated_bytes()`.
+     */
+    template<typename T, std::size_t N>
+      class object_pool : public memory::block_pool_typed_inclusive<T, N>
+      {
+      public:
+
+        using value_type = T;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        object_pool (const char* name);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        object_pool (const object_pool&) = delete;
+        object_pool (object_pool&&) = delete;
+        object_pool&
+        operator= (const object_pool&) = delete;
+        object_pool&
+        operator= (object_pool&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~object_pool () override = default;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        /**
+         * @brief Get the pool of the type.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the pool, constructed on the first call.
+         */
+        static object_pool*
+        get (void);
+
+        /**
+         * @brief Construct an object.
+         * @param [in] args Arguments of the object constructor.
+         * @return Pointer to the object.
+         */
+        template<typename ... Args>
+          static value_type*
+          create (Args&&... args);
+
+        /**
+         * @brief Destruct an object and free its storage.
+         * @param [in] obj Pointer to an object returned by `create()`.
+         * @par Returns
+         *  Nothing.
+         */
+        static void
+        destroy (value_type* obj);
+
+        /**
+         * @brief Check if the storage belongs to the pool.
+         * @param [in] addr Pointer to storage.
+         * @retval true The address is inside the pool.
+         * @retval false The address is elsewhere.
+         */
+        bool
+        owns (const void* addr) const;
+
+        /**
+         * @}
+         */
+      };
+
+    /**
+     * @brief Empty pool, all objects on the free store.
+     * @headerfile object-pool.h <cmsis-plus/posix-io/object-pool.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @tparam T Type of the objects.
+     */
+    template<typename T>
+      class object_pool<T, 0>
+      {
+      public:
+
+        using value_type = T;
+
+        static object_pool*
+        get (void);
+
+        template<typename ... Args>
+          static value_type*
+          create (Args&&... args);
+
+        static void
+        destroy (value_type* obj);
+      };
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    template<typename T, std::size_t N>
+      inline
+      object_pool<T, N>::object_pool (const char* name) :
+          memory::block_pool_typed_inclusive<T, N>
+            { name }
+      {
+        ;
+      }
+
+    template<typename T, std::size_t N>
+      object_pool<T, N>*
+      object_pool<T, N>::get (void)
+      {
+        // Plain storage, cleared with the BSS, not by a constructor.
+        static typename std::aligned_storage<sizeof(object_pool),
+            alignof(object_pool)>::type storage;
+        static bool volatile constructed;
+
+        if (!constructed)
+          {
+            rtos::scheduler::critical_section scs;
+
+            if (!constructed)
+              {
+                new (&storage) object_pool
+                  { "posix-obj" };
+                constructed = true;
+              }
+          }
+        return reinterpret_cast<object_pool*> (&storage);
+      }
+
+    template<typename T, std::size_t N>
+      template<typename ... Args>
+        T*
+        object_pool<T, N>::create (Args&&... args)
+        {
+          object_pool* pool = get ();
+
+          void* p;
+            {
+              rtos::scheduler::critical_section scs;
+
+              p = pool->allocate (sizeof(value_type), alignof(value_type));
+            }
+
+          if (p == nullptr)
+            {
+              // Pool exhausted.
+              return new value_type (std::forward<Args>(args)...);
+            }
+
+          return new (p) value_type (std::forward<Args>(args)...);
+        }
+
+    template<typename T, std::size_t N>
+      void
+      object_pool<T, N>::destroy (value_type* obj)
+      {
+        object_pool* pool = get ();
+
+        if (!pool->owns (obj))
+          {
+            // Call the destructor and the deallocator.
+            delete obj;
+            return;
+          }
+
+        obj->~value_type ();
+
+        rtos::scheduler::critical_section scs;
+
+        pool->deallocate (obj, sizeof(value_type), alignof(value_type));
+      }
+
+    template<typename T, std::size_t N>
+      inline bool
+      object_pool<T, N>::owns (const void* addr) const
+      {
+        const char* p = static_cast<const char*> (addr);
+        const char* begin = static_cast<const char*> (this->pool_addr_);
+
+        return (p >= begin) && (p < begin + sizeof(this->arena_));
+      }
+
+    // ========================================================================
+
+    template<typename T>
+      inline object_pool<T, 0>*
+      object_pool<T, 0>::get (void)
+      {
+        return nullptr;
+      }
+
+    template<typename T>
+      template<typename ... Args>
+        inline T*
+        object_pool<T, 0>::create (Args&&... args)
+        {
+          return new value_type (std::forward<Args>(args)...);
+        }
+
+    template<typename T>
+      inline void
+      object_pool<T, 0>::destroy (value_type* obj)
+      {
+        delete obj;
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_OBJECT_POOL_H_ */
@@ -0,0 +1,163 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_OWNER_LOCK_GUARD_H_
+#define CMSIS_PLUS_POSIX_IO_OWNER_LOCK_GUARD_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @brief Lock guard elided for the owner thread.
+     * @headerfile owner-lock-guard.h <cmsis-plus/posix-io/owner-lock-guard.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @tparam L Type of the lockable object.
+     *
+     * @details
+     * Used by the `*_lockable` classes instead of `std::lock_guard`.
+     * Without an owner, the locker is taken and released as usual.
+     * With an owner registered, the locker is not touched at all,
+     * and debug builds assert that the caller is the owner.
+     */
+    template<typename L>
+      class owner_lock_guard
+      {
+      public:
+
+        using lockable_type = L;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        owner_lock_guard (lockable_type& locker, rtos::thread* owner);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        owner_lock_guard (const owner_lock_guard&) = delete;
+        owner_lock_guard (owner_lock_guard&&) = delete;
+        owner_lock_guard&
+        operator= (const owner_lock_guard&) = delete;
+        owner_lock_guard&
+        operator= (owner_lock_guard&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~owner_lock_guard ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Null when the lock was elided.
+        lockable_type* locker_;
+
+        /**
+         * @endcond
+         */
+      };
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    template<typename L>
+      inline
+      owner_lock_guard<L>::owner_lock_guard (lockable_type& locker,
+                                             rtos::thread* owner) :
+          locker_ (owner == nullptr ? &locker : nullptr)
+      {
+        // The owner must be the only thread using the object.
+        assert(owner == nullptr || owner == &rtos::this_thread::thread ());
+
+        if (locker_ != nullptr)
+          {
+            locker_->lock ();
+          }
+      }
+
+    template<typename L>
+      inline
+      owner_lock_guard<L>::~owner_lock_guard ()
+      {
+        if (locker_ != nullptr)
+          {
+            locker_->unlock ();
+          }
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_OWNER_LOCK_GUARD_H_ */
@@ -0,0 +1,619 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_PBUF_H_
+#define CMSIS_PLUS_POSIX_IO_PBUF_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/memory/block-pool.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class pbuf_pool;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Packet buffer.
+     * @headerfile pbuf.h <cmsis-plus/posix-io/pbuf.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * A segment of a packet, stored in a block of a `pbuf_pool`,
+     * with the payload right after this header. Larger packets are
+     * chains of segments, linked via `next()`.
+     *
+     * Segments are reference counted, so the same packet can be
+     * kept by a network interface ring and by the network stack
+     * at the same time; the block goes back to the pool when
+     * the last reference is dropped with `free()`.
+     *
+     * The chains are handed from the interface to the stack and
+     * to the application without copying the payload.
+     */
+    class pbuf
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pbuf_pool;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    protected:
+
+      pbuf (pbuf_pool& pool);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pbuf (const pbuf&) = delete;
+      pbuf (pbuf&&) = delete;
+      pbuf&
+      operator= (const pbuf&) = delete;
+      pbuf&
+      operator= (pbuf&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~pbuf () = default;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Get the next segment in the chain.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the next segment, or `nullptr` if this
+       *  is the last one.
+       */
+      pbuf*
+      next (void) const;
+
+      /**
+       * @brief Get the segment payload.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the first payload byte.
+       */
+      void*
+      payload (void) const;
+
+      /**
+       * @brief Get the segment payload length.
+       * @par Parameters
+       *  None.
+       * @return The number of valid bytes in this segment.
+       */
+      std::size_t
+      length (void) const;
+
+      /**
+       * @brief Set the segment payload length.
+       * @param [in] nbytes The number of valid bytes; must not
+       *  exceed `capacity()`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      length (std::size_t nbytes);
+
+      /**
+       * @brief Get the segment payload capacity.
+       * @par Parameters
+       *  None.
+       * @return The max number of payload bytes in this segment.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get the length of the chain.
+       * @par Parameters
+       *  None.
+       * @return The sum of the lengths of this segment and
+       *  all the following ones.
+       */
+      std::size_t
+      total_length (void) const;
+
+      /**
+       * @brief Get the number of segments in the chain.
+       * @par Parameters
+       *  None.
+       * @return The number of segments, including this one.
+       */
+      std::size_t
+      segments (void) const;
+
+      /**
+       * @brief Append a chain at the end of this chain.
+       * @param [in] tail Pointer to the first segment of the chain
+       *  to append; the caller reference is passed to this chain.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      cat (pbuf* tail);
+
+      /**
+       * @brief Add a reference to the segment.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      ref (void);
+
+      /**
+       * @brief Copy bytes from the chain.
+       * @param [out] buf Pointer to the destination buffer.
+       * @param [in] nbytes The max number of bytes to copy.
+       * @param [in] offset The chain offset of the first byte.
+       * @return The number of bytes copied.
+       */
+      std::size_t
+      copy_out (void* buf, std::size_t nbytes, std::size_t offset = 0) const;
+
+      /**
+       * @brief Copy bytes into the chain.
+       * @param [in] buf Pointer to the source buffer.
+       * @param [in] nbytes The max number of bytes to copy.
+       * @param [in] offset The chain offset of the first byte.
+       * @return The number of bytes copied.
+       *
+       * @details
+       * Only the existing segment lengths are filled; use
+       * `length(std::size_t)` to extend them beforehand.
+       */
+      std::size_t
+      copy_in (const void* buf, std::size_t nbytes, std::size_t offset = 0);
+
+      /**
+       * @brief Get the pool the segment was allocated from.
+       * @par Parameters
+       *  None.
+       * @return Reference to the pool.
+       */
+      pbuf_pool&
+      pool (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Static Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Drop a reference to a chain.
+       * @param [in] chain Pointer to the first segment; may be
+       *  `nullptr`.
+       * @return The number of segments returned to the pool.
+       *
+       * @details
+       * The reference of the first segment is dropped; if it
+       * was the last one, the segment is returned to its pool and
+       * the process continues with the next segment, which was
+       * referred by it.
+       */
+      static std::size_t
+      free (pbuf* chain);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pbuf* next_ = nullptr;
+
+      pbuf_pool* pool_;
+
+      std::size_t length_ = 0;
+
+      std::size_t volatile refs_ = 1;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pool of packet buffers.
+     * @headerfile pbuf.h <cmsis-plus/posix-io/pbuf.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * A `memory::block_pool` dedicated to the packet buffers,
+     * each block holding a `pbuf` header and a fixed size payload.
+     *
+     * The pool is accessed in interrupts critical sections, so
+     * network drivers can allocate and free buffers from their
+     * interrupt handlers.
+     */
+    class pbuf_pool
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pbuf;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+    public:
+
+      /**
+       * @brief Size of the segment header, in bytes.
+       */
+      static constexpr std::size_t header_size_bytes = (sizeof(pbuf)
+          + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+      /**
+       * @brief Calculate the size of a pool block.
+       * @param [in] payload_size_bytes The segment payload capacity.
+       * @return The block size, in bytes.
+       */
+      static constexpr std::size_t
+      compute_block_size_bytes (std::size_t payload_size_bytes)
+      {
+        return (header_size_bytes + payload_size_bytes
+            + alignof(std::max_align_t) - 1)
+            & ~(alignof(std::max_align_t) - 1);
+      }
+
+      /**
+       * @brief Calculate the size of the pool storage.
+       * @param [in] blocks The number of segments.
+       * @param [in] payload_size_bytes The segment payload capacity.
+       * @return The storage size, in bytes.
+       */
+      static constexpr std::size_t
+      compute_allocated_size_bytes (std::size_t blocks,
+                                    std::size_t payload_size_bytes)
+      {
+        return blocks * compute_block_size_bytes (payload_size_bytes);
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a pool of packet buffers.
+       * @param [in] name Pointer to name.
+       * @param [in] blocks The number of segments.
+       * @param [in] payload_size_bytes The segment payload capacity.
+       * @param [in] addr Pointer to the pool storage, aligned
+       *  to `std::max_align_t`.
+       * @param [in] bytes The size of the pool storage; at least
+       *  `compute_allocated_size_bytes()`.
+       */
+      pbuf_pool (const char* name, std::size_t blocks,
+                 std::size_t payload_size_bytes, void* addr,
+                 std::size_t bytes);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pbuf_pool (const pbuf_pool&) = delete;
+      pbuf_pool (pbuf_pool&&) = delete;
+      pbuf_pool&
+      operator= (const pbuf_pool&) = delete;
+      pbuf_pool&
+      operator= (pbuf_pool&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pbuf_pool ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Allocate a chain of packet buffers.
+       * @param [in] nbytes The packet length.
+       * @return Pointer to the first segment, with the lengths
+       *  set to cover `nbytes`, or `nullptr` if there are not
+       *  enough free segments.
+       *
+       * @details
+       * The chain is allocated entirely or not at all; a zero
+       * length allocates one empty segment.
+       */
+      pbuf*
+      alloc (std::size_t nbytes);
+
+      /**
+       * @brief Get the segment payload capacity.
+       * @par Parameters
+       *  None.
+       * @return The number of payload bytes in each segment.
+       */
+      std::size_t
+      payload_size (void) const;
+
+      /**
+       * @brief Get the number of free segments.
+       * @par Parameters
+       *  None.
+       * @return The number of segments available for allocation.
+       */
+      std::size_t
+      free_segments (void);
+
+      /**
+       * @brief Get the pool name.
+       * @par Parameters
+       *  None.
+       * @return A null terminated string.
+       */
+      const char*
+      name (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      release_ (pbuf* p);
+
+      memory::block_pool blocks_;
+
+      std::size_t payload_size_bytes_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pool of packet buffers, with the storage included.
+     * @headerfile pbuf.h <cmsis-plus/posix-io/pbuf.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @tparam N Number of segments.
+     * @tparam P Segment payload capacity, in bytes.
+     */
+    template<std::size_t N, std::size_t P>
+      class pbuf_pool_inclusive : public pbuf_pool
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a pool of packet buffers.
+         * @param [in] name Pointer to name.
+         */
+        pbuf_pool_inclusive (const char* name = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        pbuf_pool_inclusive (const pbuf_pool_inclusive&) = delete;
+        pbuf_pool_inclusive (pbuf_pool_inclusive&&) = delete;
+        pbuf_pool_inclusive&
+        operator= (const pbuf_pool_inclusive&) = delete;
+        pbuf_pool_inclusive&
+        operator= (pbuf_pool_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~pbuf_pool_inclusive () = default;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        typename std::aligned_storage<
+            compute_allocated_size_bytes (N, P), alignof(std::max_align_t)>::type arena_;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline pbuf*
+    pbuf::next (void) const
+    {
+      return next_;
+    }
+
+    inline void*
+    pbuf::payload (void) const
+    {
+      return const_cast<char*> (reinterpret_cast<const char*> (this))
+          + pbuf_pool::header_size_bytes;
+    }
+
+    inline std::size_t
+    pbuf::length (void) const
+    {
+      return length_;
+    }
+
+    inline pbuf_pool&
+    pbuf::pool (void) const
+    {
+      return *pool_;
+    }
+
+    // ========================================================================
+
+    inline std::size_t
+    pbuf_pool::payload_size (void) const
+    {
+      return payload_size_bytes_;
+    }
+
+    inline const char*
+    pbuf_pool::name (void) const
+    {
+      return blocks_.name ();
+    }
+
+    // ========================================================================
+
+    template<std::size_t N, std::size_t P>
+      pbuf_pool_inclusive<N, P>::pbuf_pool_inclusive (const char* name) :
+          pbuf_pool
+            { name, N, P, &arena_, sizeof(arena_) }
+      {
+        ;
+      }
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_PBUF_H_ */
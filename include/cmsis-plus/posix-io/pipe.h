@@ -0,0 +1,930 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_PIPE_H_
+#define CMSIS_PLUS_POSIX_IO_PIPE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/char-device.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cassert>
+#include <mutex>
+
+#include <cmsis-plus/posix-driver/circular-buffer.h>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES)
+#define OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES (512)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class pipe;
+
+    /**
+     * @ingroup cmsis-plus-posix-io-func
+     * @{
+     */
+
+    /**
+     * @brief Move data between two objects, one of them a pipe.
+     * @param [in] in Pointer to the object to read from.
+     * @param [in,out] off_in Pointer to the offset in _in_, updated
+     *  on return, or `nullptr` for the current offset; must be
+     *  `nullptr` for pipes.
+     * @param [in] out Pointer to the object to write to.
+     * @param [in,out] off_out Pointer to the offset in _out_, updated
+     *  on return, or `nullptr` for the current offset; must be
+     *  `nullptr` for pipes.
+     * @param [in] len The maximum number of bytes to move.
+     * @param [in] flags Reserved, must be 0.
+     * @return The number of bytes moved, 0 at the end of the input,
+     *  or -1 with `errno` set.
+     */
+    ssize_t
+    splice (io* in, off_t* off_in, io* out, off_t* off_out, std::size_t len,
+            unsigned int flags = 0);
+
+    /**
+     * @}
+     */
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Buffer shared by the ends of a pipe or by a FIFO.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class pipe_buffer
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a pipe buffer.
+       * @param [in] storage Pointer to the storage.
+       * @param [in] size The size of the storage, in bytes.
+       */
+      pipe_buffer (void* storage, std::size_t size);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_buffer (const pipe_buffer&) = delete;
+      pipe_buffer (pipe_buffer&&) = delete;
+      pipe_buffer&
+      operator= (const pipe_buffer&) = delete;
+      pipe_buffer&
+      operator= (pipe_buffer&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~pipe_buffer ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Register an opened end.
+       * @param [in] end Reference to the implementation of the end.
+       * @param [in] mode The access mode, `O_RDONLY`, `O_WRONLY`
+       *  or `O_RDWR`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      attach (io_impl& end, int mode);
+
+      /**
+       * @brief Unregister a closed end.
+       * @param [in] end Reference to the implementation of the end.
+       * @param [in] mode The access mode used by `attach()`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      detach (io_impl& end, int mode);
+
+      ssize_t
+      read (io_impl& end, void* buf, std::size_t nbyte);
+
+      ssize_t
+      write (io_impl& end, const void* buf, std::size_t nbyte);
+
+      /**
+       * @brief Write the buffered data to another object.
+       * @param [in] end Reference to the implementation of the
+       *  reading end.
+       * @param [in] out Reference to the object to write to.
+       * @param [in] count The maximum number of bytes to move.
+       * @return The number of bytes moved, 0 at the end of the input,
+       *  or -1 with `errno` set.
+       */
+      ssize_t
+      splice_to (io_impl& end, io& out, std::size_t count);
+
+      /**
+       * @brief Read data from another object into the buffer.
+       * @param [in] end Reference to the implementation of the
+       *  writing end.
+       * @param [in] in Reference to the object to read from.
+       * @param [in] count The maximum number of bytes to move.
+       * @return The number of bytes moved, or -1 with `errno` set.
+       */
+      ssize_t
+      splice_from (io_impl& end, io& in, std::size_t count);
+
+      /**
+       * @brief Get the ready events.
+       * @param [in] events The `POLLIN`/`POLLOUT` events of interest.
+       * @param [in] mode The access mode of the end.
+       * @return The events currently ready.
+       */
+      int
+      poll (int events, int mode);
+
+      /**
+       * @brief Get the buffer of a pipe end or of a FIFO.
+       * @param [in] obj Reference to an I/O object.
+       * @return Pointer to the buffer, or `nullptr` if the object
+       *  is not a pipe end or a FIFO.
+       */
+      static pipe_buffer*
+      of (io& obj);
+
+      /**
+       * @brief Get the number of buffered bytes.
+       * @par Parameters
+       *  None.
+       * @return The number of bytes that can be read without waiting.
+       */
+      std::size_t
+      length (void) const;
+
+      /**
+       * @brief Get the buffer size.
+       * @par Parameters
+       *  None.
+       * @return The size of the storage, in bytes.
+       */
+      std::size_t
+      size (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Wait until the buffer is not empty; called with the mutex locked.
+      int
+      wait_data_ (io_impl& end, std::unique_lock<rtos::mutex>& lock);
+
+      // Wait until the buffer is not full; called with the mutex locked.
+      int
+      wait_space_ (io_impl& end, std::unique_lock<rtos::mutex>& lock);
+
+      // Wake-up the other side and the pollers.
+      void
+      notify_ (void);
+
+      circular_buffer_bytes buffer_;
+
+      // Serialises the access to the buffer; not held while waiting.
+      rtos::mutex mutex_;
+
+      // Posted when data is added and when space is freed.
+      rtos::semaphore_binary rx_sem_;
+      rtos::semaphore_binary tx_sem_;
+
+      // The implementations of the opened ends, for poll_notify().
+      io_impl* ends_[2] =
+        { nullptr, nullptr };
+
+      std::size_t readers_ = 0;
+      std::size_t writers_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Implementation of a pipe end.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class pipe_impl : public io_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class pipe;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe_impl (pipe_buffer& buffer, int mode);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_impl (const pipe_impl&) = delete;
+      pipe_impl (pipe_impl&&) = delete;
+      pipe_impl&
+      operator= (const pipe_impl&) = delete;
+      pipe_impl&
+      operator= (pipe_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pipe_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_sendfile (io& out, io& in, std::size_t count) override;
+
+      virtual int
+      do_fstat (struct stat* buf) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_close (void) override;
+
+      virtual int
+      do_poll_register (int events, rtos::semaphore* sem) override;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      pipe_buffer&
+      buffer (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pipe_buffer& buffer_;
+
+      // O_RDONLY for the read end, O_WRONLY for the write end.
+      int mode_;
+
+      bool opened_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pipe end class.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class pipe_end : public io
+    {
+      // ----------------------------------------------------------------------
+
+      friend class pipe;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe_end (class pipe& owner, pipe_buffer& buffer, int mode);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_end (const pipe_end&) = delete;
+      pipe_end (pipe_end&&) = delete;
+      pipe_end&
+      operator= (const pipe_end&) = delete;
+      pipe_end&
+      operator= (pipe_end&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pipe_end ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      close (void) override;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      pipe_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      class pipe& owner_;
+
+      pipe_impl impl_instance_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pipe class.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * An unnamed pipe, with a read end and a write end, each
+     * with its own file descriptor, sharing a circular buffer.
+     *
+     * Reads block while the pipe is empty and return 0 (end of
+     * file) once the write end is closed; writes block while the
+     * pipe is full and fail with `EPIPE` once the read end is
+     * closed. Both ends honour `O_NONBLOCK`, the receive and send
+     * timeouts, and support `poll()`, `select()` and `event_poll`.
+     *
+     * `splice()` moves data between a pipe and any other
+     * object directly from or to the pipe buffer, and `sendfile()`
+     * to a pipe reads straight into the pipe buffer.
+     */
+    class pipe
+    {
+      // ----------------------------------------------------------------------
+
+      friend class pipe_end;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a pipe.
+       * @param [in] storage Pointer to the buffer storage.
+       * @param [in] size The size of the storage, in bytes.
+       */
+      pipe (void* storage, std::size_t size);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe (const pipe&) = delete;
+      pipe (pipe&&) = delete;
+      pipe&
+      operator= (const pipe&) = delete;
+      pipe&
+      operator= (pipe&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~pipe ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Create a dynamically allocated pipe.
+       * @param [out] fildes Array receiving the file descriptors
+       *  of the read end and of the write end.
+       * @param [in] size The size of the buffer, in bytes.
+       * @return Pointer to the opened pipe, or `nullptr` with
+       *  `errno` set.
+       *
+       * @details
+       * The object and its storage are deallocated some time after
+       * both ends are closed.
+       */
+      static pipe*
+      create (int fildes[2], std::size_t size =
+                  OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES);
+
+      /**
+       * @brief Open both ends.
+       * @param [out] fildes Array receiving the file descriptors
+       *  of the read end and of the write end.
+       * @retval 0 The pipe was opened.
+       * @retval -1 An error occurred; `errno` is set.
+       */
+      int
+      open (int fildes[2]);
+
+      pipe_end&
+      read_end (void);
+
+      pipe_end&
+      write_end (void);
+
+      pipe_buffer&
+      buffer (void);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Called by the ends after close().
+      void
+      closed_ (void);
+
+      static void
+      deallocate_deferred_ (void);
+
+      pipe_buffer buffer_;
+
+      pipe_end read_end_;
+      pipe_end write_end_;
+
+      // Set for objects returned by create(), with the storage
+      // allocated from this resource.
+      rtos::memory::memory_resource* resource_ = nullptr;
+      void* storage_ = nullptr;
+      std::size_t size_ = 0;
+
+      // Link in the list of closed objects waiting to be deallocated.
+      pipe* deferred_next_ = nullptr;
+
+      static pipe* deferred_list__;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Implementation of a FIFO device.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class fifo_impl : public char_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      fifo_impl (void* storage, std::size_t size);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      fifo_impl (const fifo_impl&) = delete;
+      fifo_impl (fifo_impl&&) = delete;
+      fifo_impl&
+      operator= (const fifo_impl&) = delete;
+      fifo_impl&
+      operator= (fifo_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~fifo_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_sendfile (io& out, io& in, std::size_t count) override;
+
+      virtual int
+      do_fstat (struct stat* buf) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      virtual int
+      do_poll_register (int events, rtos::semaphore* sem) override;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      pipe_buffer&
+      buffer (void);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pipe_buffer buffer_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Named FIFO class.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * A char device registered with a name, opened via
+     * `open("/dev/<name>")`, which behaves like a pipe whose
+     * ends are never closed: reads block while it is empty
+     * and writes block while it is full.
+     *
+     * As all devices, all opens share the same file descriptor.
+     */
+    class fifo : public char_device_implementable<fifo_impl>
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a FIFO.
+       * @param [in] name Pointer to the device name.
+       * @param [in] storage Pointer to the buffer storage.
+       * @param [in] size The size of the storage, in bytes.
+       */
+      fifo (const char* name, void* storage, std::size_t size);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      fifo (const fifo&) = delete;
+      fifo (fifo&&) = delete;
+      fifo&
+      operator= (const fifo&) = delete;
+      fifo&
+      operator= (fifo&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~fifo ();
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Named FIFO class template, with included storage.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @tparam N The size of the buffer, in bytes.
+     */
+    template<std::size_t N = OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES>
+      class fifo_inclusive : public fifo
+      {
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        /**
+         * @brief Construct a FIFO.
+         * @param [in] name Pointer to the device name.
+         */
+        fifo_inclusive (const char* name);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        fifo_inclusive (const fifo_inclusive&) = delete;
+        fifo_inclusive (fifo_inclusive&&) = delete;
+        fifo_inclusive&
+        operator= (const fifo_inclusive&) = delete;
+        fifo_inclusive&
+        operator= (fifo_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~fifo_inclusive ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Only the address is used by the base constructor.
+        uint8_t storage_[N];
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline std::size_t
+    pipe_buffer::size (void) const
+    {
+      return buffer_.size ();
+    }
+
+    // ========================================================================
+
+    inline pipe_buffer&
+    pipe_impl::buffer (void) const
+    {
+      return buffer_;
+    }
+
+    // ========================================================================
+
+    inline pipe_impl&
+    pipe_end::impl (void) const
+    {
+      return static_cast<pipe_impl&> (impl_);
+    }
+
+    // ========================================================================
+
+    inline pipe_end&
+    pipe::read_end (void)
+    {
+      return read_end_;
+    }
+
+    inline pipe_end&
+    pipe::write_end (void)
+    {
+      return write_end_;
+    }
+
+    inline pipe_buffer&
+    pipe::buffer (void)
+    {
+      return buffer_;
+    }
+
+    // ========================================================================
+
+    inline pipe_buffer&
+    fifo_impl::buffer (void)
+    {
+      return buffer_;
+    }
+
+    // ========================================================================
+
+    template<std::size_t N>
+      fifo_inclusive<N>::fifo_inclusive (const char* name) :
+          fifo
+            { name, storage_, N }
+      {
+        ;
+      }
+
+    template<std::size_t N>
+      fifo_inclusive<N>::~fifo_inclusive ()
+      {
+        ;
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_PIPE_H_ */
@@ -37,9 +37,13 @@
 #define __posix_chmod chmod
 #define __posix_chown chown
 #define __posix_clock clock
+#define __posix_clock_gettime clock_gettime
 #define __posix_close close
 #define __posix_closedir closedir
 #define __posix_connect connect
+#define __posix_epoll_create epoll_create
+#define __posix_epoll_ctl epoll_ctl
+#define __posix_epoll_wait epoll_wait
 #define __posix_execve execve
 #define __posix_fcntl fcntl
 #define __posix_fork fork
@@ -59,28 +63,39 @@
 #define __posix_listen listen
 #define __posix_lseek lseek
 #define __posix_mkdir mkdir
+#define __posix_mmap mmap
+#define __posix_munmap munmap
 #define __posix_open open
 #define __posix_opendir opendir
+#define __posix_pipe pipe
+#define __posix_poll poll
 #define __posix_raise raise
 #define __posix_read read
 #define __posix_readdir readdir
 #define __posix_readdir_r readdir_r
 #define __posix_readlink readlink
+#define __posix_readv readv
 #define __posix_recv recv
 #define __posix_recvfrom recvfrom
+#define __posix_recvmmsg recvmmsg
 #define __posix_recvmsg recvmsg
 #define __posix_rename rename
 #define __posix_rewinddir rewinddir
 #define __posix_rmdir rmdir
 #define __posix_select select
 #define __posix_send send
+#define __posix_sendfile sendfile
+#define __posix_sendmmsg sendmmsg
 #define __posix_sendmsg sendmsg
 #define __posix_sendto sendto
 #define __posix_setsockopt setsockopt
+#define __posix_shm_open shm_open
+#define __posix_shm_unlink shm_unlink
 #define __posix_shutdown shutdown
 #define __posix_sockatmark sockatmark
 #define __posix_socket socket
 #define __posix_socketpair socketpair
+#define __posix_splice splice
 #define __posix_stat stat
 #define __posix_symlink symlink
 #define __posix_sync sync
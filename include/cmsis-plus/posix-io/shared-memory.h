@@ -0,0 +1,452 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_SHARED_MEMORY_H_
+#define CMSIS_PLUS_POSIX_IO_SHARED_MEMORY_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/utils/lists.h>
+
+#include <cmsis-plus/posix/sys/mman.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class shared_memory;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Shared memory object implementation.
+     * @headerfile shared-memory.h <cmsis-plus/posix-io/shared-memory.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class shared_memory_impl : public io_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class shared_memory;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      shared_memory_impl (void);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      shared_memory_impl (const shared_memory_impl&) = delete;
+      shared_memory_impl (shared_memory_impl&&) = delete;
+      shared_memory_impl&
+      operator= (const shared_memory_impl&) = delete;
+      shared_memory_impl&
+      operator= (shared_memory_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~shared_memory_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual int
+      do_fstat (struct stat* buf) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      uint8_t* region_ = nullptr;
+      std::size_t size_ = 0;
+
+      // The users sharing the file descriptor, as for devices.
+      std::size_t open_count_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Named shared memory object.
+     * @headerfile shared-memory.h <cmsis-plus/posix-io/shared-memory.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * A memory region, allocated from a memory resource, that
+     * subsystems find by name and access directly via `map()`,
+     * to pass large buffers without copying them.
+     *
+     * The objects are either statically declared, like devices,
+     * or created by `open()` with `O_CREAT`. They are registered
+     * by name until `unlink()`; the region is kept, even when no
+     * longer opened or mapped, until then.
+     *
+     * As for devices, all users of an object share a single file
+     * descriptor, closed when the last of them calls `close()`.
+     */
+    class shared_memory : public io
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct and register a shared memory object.
+       * @param [in] name The name, without the leading `/`.
+       * @param [in] resource Pointer to the memory resource of the
+       *  region, or `nullptr` for the default one.
+       */
+      shared_memory (const char* name,
+                     rtos::memory::memory_resource* resource = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      shared_memory (const shared_memory&) = delete;
+      shared_memory (shared_memory&&) = delete;
+      shared_memory&
+      operator= (const shared_memory&) = delete;
+      shared_memory&
+      operator= (shared_memory&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~shared_memory () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Static Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Open a shared memory object.
+       * @param [in] name The name, with the leading `/`.
+       * @param [in] oflag `O_RDONLY` or `O_RDWR`, optionally with
+       *  `O_CREAT`, `O_EXCL` and `O_TRUNC`.
+       * @return Pointer to the opened object, or `nullptr` with
+       *  `errno` set.
+       */
+      static shared_memory*
+      open (const char* name, int oflag);
+
+      /**
+       * @brief Remove the name of a shared memory object.
+       * @param [in] name The name, with the leading `/`.
+       * @retval 0 The name was removed.
+       * @retval -1 An error occurred; `errno` is set.
+       */
+      static int
+      unlink (const char* name);
+
+      /**
+       * @brief Find a registered shared memory object.
+       * @param [in] name The name, with the leading `/`.
+       * @return Pointer to the object, or `nullptr` if not found.
+       */
+      static shared_memory*
+      identify (const char* name);
+
+      /**
+       * @brief Find the shared memory object mapped at an address.
+       * @param [in] addr An address inside a mapping.
+       * @return Pointer to the object, or `nullptr` if not found.
+       */
+      static shared_memory*
+      identify_mapping (const void* addr);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      close (void) override;
+
+      /**
+       * @brief Set the size of the region.
+       * @param [in] length The new size, in bytes.
+       * @retval 0 The region was resized.
+       * @retval -1 An error occurred; `errno` is set.
+       */
+      int
+      ftruncate (off_t length);
+
+      /**
+       * @brief Map the region.
+       * @param [in] length The number of bytes to map.
+       * @param [in] prot The access rights, `PROT_READ` and/or
+       *  `PROT_WRITE`.
+       * @param [in] offset The offset of the first byte.
+       * @return Pointer to the mapped bytes, or `nullptr` with
+       *  `errno` set.
+       */
+      void*
+      map (std::size_t length, int prot, off_t offset = 0);
+
+      /**
+       * @brief Remove a mapping.
+       * @param [in] addr The pointer returned by `map()`.
+       * @param [in] length The number of mapped bytes.
+       * @retval 0 The mapping was removed.
+       * @retval -1 An error occurred; `errno` is set.
+       */
+      int
+      unmap (void* addr, std::size_t length);
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      const char*
+      name (void) const;
+
+      std::size_t
+      size (void) const;
+
+      /**
+       * @brief Get the number of mappings not yet removed.
+       */
+      std::size_t
+      mappings (void) const;
+
+      shared_memory_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      int
+      open_ (int oflag);
+
+      // Free the region and, for created objects, the object,
+      // when no longer registered, opened or mapped.
+      void
+      release_ (void);
+
+      static void
+      deallocate_deferred_ (void);
+
+      shared_memory_impl impl_instance_;
+
+      const char* name_;
+
+      rtos::memory::memory_resource* resource_;
+
+      std::size_t mappings_ = 0;
+
+      bool linked_ = false;
+
+      // Set for objects created by open(), with the name allocated
+      // on the free store.
+      bool allocated_ = false;
+
+      // Link in the list of released objects waiting to be deallocated.
+      shared_memory* deferred_next_ = nullptr;
+
+      static shared_memory* deferred_list__;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // Intrusive node used to link this object to the registry list.
+      // Must be public.
+      utils::double_list_links registry_links_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+extern "C"
+{
+  /**
+   * @brief Hook to set the access rights of a shared memory mapping.
+   * @param [in] addr The address of the mapping.
+   * @param [in] len The size of the mapping, in bytes.
+   * @param [in] prot The access rights, `PROT_NONE` when the
+   *  mapping is removed.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * Called by the thread creating or removing the mapping; on
+   * devices with an MPU it can program a region for that thread.
+   */
+  void
+  os_posix_shm_protect_hook (void* addr, size_t len, int prot);
+}
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline const char*
+    shared_memory::name (void) const
+    {
+      return name_;
+    }
+
+    inline std::size_t
+    shared_memory::size (void) const
+    {
+      return impl ().size_;
+    }
+
+    inline std::size_t
+    shared_memory::mappings (void) const
+    {
+      return mappings_;
+    }
+
+    inline shared_memory_impl&
+    shared_memory::impl (void) const
+    {
+      return static_cast<shared_memory_impl&> (impl_);
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_SHARED_MEMORY_H_ */
@@ -37,6 +37,7 @@
 #endif
 
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/owner-lock-guard.h>
 #include <cmsis-plus/posix/sys/socket.h>
 #include <cmsis-plus/utils/lists.h>
 
@@ -53,6 +54,7 @@ namespace os
     class socket;
     class socket_impl;
     class net_stack;
+    class pbuf;
 
     // ------------------------------------------------------------------------
     /**
@@ -155,6 +157,52 @@ namespace os
       virtual int
       sockatmark (void);
 
+      /**
+       * @brief Receive multiple messages.
+       * @param [in,out] vmessages Array of message headers; on return
+       *  each `msg_len` holds the number of bytes received.
+       * @param [in] vlen Number of entries in the array.
+       * @param [in] flags The `recvmsg()` flags, plus `MSG_WAITFORONE`.
+       * @param [in] timeout Pointer to the maximum time to wait,
+       *  checked after each message, or `nullptr` for no limit.
+       * @return The number of messages received, or -1 with `errno` set.
+       */
+      virtual int
+      recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                struct timespec* timeout);
+
+      /**
+       * @brief Send multiple messages.
+       * @param [in,out] vmessages Array of message headers; on return
+       *  each `msg_len` holds the number of bytes sent.
+       * @param [in] vlen Number of entries in the array.
+       * @param [in] flags The `sendmsg()` flags.
+       * @return The number of messages sent, or -1 with `errno` set.
+       */
+      virtual int
+      sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags);
+
+      /**
+       * @brief Receive a packet without copying it.
+       * @param [out] chain Pointer where to store the first packet buffer;
+       *  the caller must release the chain with `pbuf::free()`.
+       * @param [in] flags The `recv()` flags.
+       * @return The number of bytes in the chain, or -1 with `errno` set.
+       */
+      virtual ssize_t
+      recv_pbuf (pbuf** chain, int flags);
+
+      /**
+       * @brief Send a packet without copying it.
+       * @param [in] chain Pointer to the first packet buffer; on success
+       *  the reference passes to the socket.
+       * @param [in] flags The `send()` flags.
+       * @return The number of bytes queued, or -1 with `errno` set,
+       *  in which case the caller keeps the chain.
+       */
+      virtual ssize_t
+      send_pbuf (pbuf* chain, int flags);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -307,6 +355,19 @@ namespace os
       virtual int
       do_sockatmark (void) = 0;
 
+      virtual ssize_t
+      do_recv_pbuf (pbuf** chain, int flags);
+
+      virtual ssize_t
+      do_send_pbuf (pbuf* chain, int flags);
+
+      virtual int
+      do_recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                   struct timespec* timeout);
+
+      virtual int
+      do_sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags);
+
       /**
        * @}
        */
@@ -498,12 +559,49 @@ namespace os
         virtual int
         sockatmark (void) override;
 
+        virtual ssize_t
+        recv_pbuf (pbuf** chain, int flags) override;
+
+        virtual int
+        recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                  struct timespec* timeout) override;
+
+        virtual int
+        sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags)
+            override;
+
+        virtual ssize_t
+        send_pbuf (pbuf* chain, int flags) override;
+
         // --------------------------------------------------------------------
         // Support functions.
 
         value_type&
         impl (void) const;
 
+        /**
+         * @brief Register the only thread using the object.
+         * @param [in] th Pointer to the owner thread, or `nullptr` to
+         *  take the locker again for each call.
+         * @par Returns
+         *  Nothing.
+         *
+         * @details
+         * While an owner is registered, the calls do not take the
+         * locker; debug builds assert that they come from the owner.
+         */
+        void
+        owner (rtos::thread* th);
+
+        /**
+         * @brief Get the owner thread.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the owner thread, or `nullptr`.
+         */
+        rtos::thread*
+        owner (void) const;
+
         /**
          * @}
          */
@@ -519,6 +617,8 @@ namespace os
 
         lockable_type& locker_;
 
+        rtos::thread* owner_ = nullptr;
+
         /**
          * @endcond
          */
@@ -556,7 +656,8 @@ namespace os
             { impl_instance_, ns }
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_implementable::%s()=@%p\n", __func__, this);
+        trace::printf (trace::posix_io_socket,
+                       "socket_implementable::%s()=@%p\n", __func__, this);
 #endif
       }
 
@@ -564,7 +665,8 @@ namespace os
       socket_implementable<T>::~socket_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_implementable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_socket,
+                       "socket_implementable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -585,7 +687,8 @@ namespace os
           locker_ (locker)
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_lockable::%s()=@%p\n", __func__, this);
+        trace::printf (trace::posix_io_socket,
+                       "socket_lockable::%s()=@%p\n", __func__, this);
 #endif
       }
 
@@ -593,7 +696,8 @@ namespace os
       socket_lockable<T, L>::~socket_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_lockable::%s() @%p\n", __func__, this);
+        trace::printf (trace::posix_io_socket,
+                       "socket_lockable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -603,8 +707,8 @@ namespace os
       int
       socket_lockable<T, L>::close (void)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::close ();
       }
@@ -614,8 +718,8 @@ namespace os
       socket_lockable<T, L>::accept (struct sockaddr* address,
                                      socklen_t* address_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::accept (address, address_len);
       }
@@ -625,8 +729,8 @@ namespace os
       socket_lockable<T, L>::bind (const struct sockaddr* address,
                                    socklen_t address_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::bind (address, address_len);
       }
@@ -636,8 +740,8 @@ namespace os
       socket_lockable<T, L>::connect (const struct sockaddr* address,
                                       socklen_t address_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::connect (address, address_len);
       }
@@ -647,8 +751,8 @@ namespace os
       socket_lockable<T, L>::getpeername (struct sockaddr* address,
                                           socklen_t* address_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::getpeername (address, address_len);
       }
@@ -658,8 +762,8 @@ namespace os
       socket_lockable<T, L>::getsockname (struct sockaddr* address,
                                           socklen_t* address_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::getsockname (address, address_len);
       }
@@ -670,8 +774,8 @@ namespace os
                                          void* option_value,
                                          socklen_t* option_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::getsockopt (level, option_name, option_value, option_len);
       }
@@ -680,8 +784,8 @@ namespace os
       int
       socket_lockable<T, L>::listen (int backlog)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::listen (backlog);
       }
@@ -690,8 +794,8 @@ namespace os
       ssize_t
       socket_lockable<T, L>::recv (void* buffer, size_t length, int flags)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::recv (buffer, length, flags);
       }
@@ -702,8 +806,8 @@ namespace os
                                        struct sockaddr* address,
                                        socklen_t* address_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::recvfrom (buffer, length, flags, address, address_len);
       }
@@ -712,8 +816,8 @@ namespace os
       ssize_t
       socket_lockable<T, L>::recvmsg (struct msghdr* message, int flags)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::recvmsg (message, flags);
       }
@@ -722,8 +826,8 @@ namespace os
       ssize_t
       socket_lockable<T, L>::send (const void* buffer, size_t length, int flags)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::send (buffer, length, flags);
       }
@@ -732,8 +836,8 @@ namespace os
       ssize_t
       socket_lockable<T, L>::sendmsg (const struct msghdr* message, int flags)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::sendmsg (message, flags);
       }
@@ -745,8 +849,8 @@ namespace os
                                      const struct sockaddr* dest_addr,
                                      socklen_t dest_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::sendto (message, length, flags, dest_addr, dest_len);
       }
@@ -757,8 +861,8 @@ namespace os
                                          const void* option_value,
                                          socklen_t option_len)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::setsockopt (level, option_name, option_value, option_len);
       }
@@ -767,8 +871,8 @@ namespace os
       int
       socket_lockable<T, L>::shutdown (int how)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::shutdown (how);
       }
@@ -777,12 +881,77 @@ namespace os
       int
       socket_lockable<T, L>::sockatmark (void)
       {
-        std::lock_guard<L> lock
-          { locker_ };
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
 
         return socket::sockatmark ();
       }
 
+    /**
+     * @details
+     * The lock is taken once for the whole batch, not for each message.
+     */
+    template<typename T, typename L>
+      int
+      socket_lockable<T, L>::recvmmsg (struct mmsghdr* vmessages,
+                                       unsigned int vlen, int flags,
+                                       struct timespec* timeout)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return socket::recvmmsg (vmessages, vlen, flags, timeout);
+      }
+
+    /**
+     * @details
+     * The lock is taken once for the whole batch, not for each message.
+     */
+    template<typename T, typename L>
+      int
+      socket_lockable<T, L>::sendmmsg (struct mmsghdr* vmessages,
+                                       unsigned int vlen, int flags)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return socket::sendmmsg (vmessages, vlen, flags);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      socket_lockable<T, L>::recv_pbuf (pbuf** chain, int flags)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return socket::recv_pbuf (chain, flags);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      socket_lockable<T, L>::send_pbuf (pbuf* chain, int flags)
+      {
+        owner_lock_guard<L> lock
+          { locker_, owner_ };
+
+        return socket::send_pbuf (chain, flags);
+      }
+
+    template<typename T, typename L>
+      inline void
+      socket_lockable<T, L>::owner (rtos::thread* th)
+      {
+        owner_ = th;
+      }
+
+    template<typename T, typename L>
+      inline rtos::thread*
+      socket_lockable<T, L>::owner (void) const
+      {
+        return owner_;
+      }
+
     template<typename T, typename L>
       typename socket_lockable<T, L>::value_type&
       socket_lockable<T, L>::impl (void) const
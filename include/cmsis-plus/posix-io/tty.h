@@ -306,7 +306,8 @@ namespace os
               { std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-          trace::printf ("tty_implementable::%s(\"%s\")=@%p\n", __func__, name_,
+          trace::printf (trace::posix_io_tty,
+                         "tty_implementable::%s(\"%s\")=@%p\n", __func__, name_,
                          this);
 #endif
         }
@@ -315,7 +316,8 @@ namespace os
       tty_implementable<T>::~tty_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-        trace::printf ("tty_implementable::%s() @%p %s\n", __func__, this,
+        trace::printf (trace::posix_io_tty,
+                       "tty_implementable::%s() @%p %s\n", __func__, this,
                        name_);
 #endif
       }
@@ -32,8 +32,13 @@
 
 #include <sys/types.h>
 #include <sys/select.h>
+#include <time.h>
 
 #include <cmsis-plus/posix/dirent.h>
+#include <cmsis-plus/posix/poll.h>
+#include <cmsis-plus/posix/sys/epoll.h>
+#include <cmsis-plus/posix/sys/mman.h>
+#include <cmsis-plus/posix/sys/sendfile.h>
 #include <cmsis-plus/posix/sys/socket.h>
 #include <cmsis-plus/posix/termios.h>
 
@@ -85,6 +90,9 @@ extern "C"
   clock_t __attribute__((weak))
   __posix_clock (void);
 
+  int __attribute__((weak))
+  __posix_clock_gettime (clockid_t clock_id, struct timespec* tp);
+
   int __attribute__((weak))
   __posix_close (int fildes);
 
@@ -95,6 +103,16 @@ extern "C"
   __posix_connect (int socket, const struct sockaddr* address,
                    socklen_t address_len);
 
+  int __attribute__((weak))
+  __posix_epoll_create (int size);
+
+  int __attribute__((weak))
+  __posix_epoll_ctl (int epfd, int op, int fd, struct epoll_event* event);
+
+  int __attribute__((weak))
+  __posix_epoll_wait (int epfd, struct epoll_event* events, int maxevents,
+                      int timeout);
+
   int __attribute__((weak))
   __posix_execve (const char* path, char* const argv[], char* const envp[]);
 
@@ -171,6 +189,13 @@ extern "C"
   int __attribute__((weak))
   __posix_mkdir (const char* path, mode_t mode);
 
+  void* __attribute__((weak))
+  __posix_mmap (void* addr, size_t len, int prot, int flags, int fildes,
+                off_t off);
+
+  int __attribute__((weak))
+  __posix_munmap (void* addr, size_t len);
+
   /**
    * @brief Open file relative to directory file descriptor.
    *
@@ -193,6 +218,12 @@ extern "C"
   __attribute__((weak))
   __posix_opendir (const char* dirname);
 
+  int __attribute__((weak))
+  __posix_pipe (int fildes[2]);
+
+  int __attribute__((weak))
+  __posix_poll (struct pollfd fds[], nfds_t nfds, int timeout);
+
   int __attribute__((weak))
   __posix_raise (int sig);
 
@@ -209,6 +240,9 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_readlink (const char* path, char* buf, size_t bufsize);
 
+  ssize_t __attribute__((weak))
+  __posix_readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t __attribute__((weak))
   __posix_recv (int socket, void* buffer, size_t length, int flags);
 
@@ -219,6 +253,10 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_recvmsg (int socket, struct msghdr* message, int flags);
 
+  int __attribute__((weak))
+  __posix_recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                    int flags, struct timespec* timeout);
+
   int __attribute__((weak))
   __posix_rename (const char* oldfn, const char* newfn);
 
@@ -235,9 +273,16 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_send (int socket, const void* buffer, size_t length, int flags);
 
+  ssize_t __attribute__((weak))
+  __posix_sendfile (int out_fd, int in_fd, off_t* offset, size_t count);
+
   ssize_t __attribute__((weak))
   __posix_sendmsg (int socket, const struct msghdr* message, int flags);
 
+  int __attribute__((weak))
+  __posix_sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                    int flags);
+
   ssize_t __attribute__((weak))
   __posix_sendto (int socket, const void* message, size_t length, int flags,
                   const struct sockaddr* dest_addr, socklen_t dest_len);
@@ -246,6 +291,12 @@ extern "C"
   __posix_setsockopt (int socket, int level, int option_name,
                       const void* option_value, socklen_t option_len);
 
+  int __attribute__((weak))
+  __posix_shm_open (const char* name, int oflag, mode_t mode);
+
+  int __attribute__((weak))
+  __posix_shm_unlink (const char* name);
+
   int __attribute__((weak))
   __posix_shutdown (int socket, int how);
 
@@ -258,6 +309,10 @@ extern "C"
   int __attribute__((weak))
   __posix_socketpair (int domain, int type, int protocol, int socket_vector[2]);
 
+  ssize_t __attribute__((weak))
+  __posix_splice (int fd_in, off_t* off_in, int fd_out, off_t* off_out,
+                  size_t len, unsigned int flags);
+
   int __attribute__((weak))
   __posix_stat (const char* path, struct stat* buf);
 
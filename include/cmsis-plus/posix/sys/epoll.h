@@ -0,0 +1,102 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef POSIX_IO_SYS_EPOLL_H_
+#define POSIX_IO_SYS_EPOLL_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__linux__)
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wgnu-include-next"
+#endif
+#include_next <sys/epoll.h>
+#pragma GCC diagnostic pop
+
+#else
+
+#include <stdint.h>
+
+#include <cmsis-plus/posix/poll.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ----------------------------------------------------------------------------
+
+  typedef union epoll_data
+  {
+    void* ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+  } epoll_data_t;
+
+  struct epoll_event
+  {
+    uint32_t events;    // The event flags.
+    epoll_data_t data;  // User data, returned unchanged.
+  };
+
+// The readiness flags have the same values as the poll() ones.
+#define EPOLLIN     ((uint32_t) POLLIN)
+#define EPOLLPRI    ((uint32_t) POLLPRI)
+#define EPOLLOUT    ((uint32_t) POLLOUT)
+#define EPOLLERR    ((uint32_t) POLLERR)
+#define EPOLLHUP    ((uint32_t) POLLHUP)
+#define EPOLLRDNORM ((uint32_t) POLLRDNORM)
+#define EPOLLWRNORM ((uint32_t) POLLWRNORM)
+#define EPOLLET     ((uint32_t) 1u << 31) // Edge triggered.
+
+#define EPOLL_CTL_ADD 1 // Add a descriptor to the interest set.
+#define EPOLL_CTL_DEL 2 // Remove a descriptor from the interest set.
+#define EPOLL_CTL_MOD 3 // Change the events of a descriptor.
+
+  int
+  epoll_create (int size);
+
+  int
+  epoll_ctl (int epfd, int op, int fd, struct epoll_event* event);
+
+  int
+  epoll_wait (int epfd, struct epoll_event* events, int maxevents,
+              int timeout);
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* defined(__linux__) */
+
+#endif /* POSIX_IO_SYS_EPOLL_H_ */
@@ -109,12 +109,29 @@
 #define _IOW(type,nr,size)  _IOC(_IOC_WRITE,(type),(nr),(_IOC_TYPECHECK(size)))
 #define _IOWR(type,nr,size) _IOC(_IOC_READ|_IOC_WRITE,(type),(nr),(_IOC_TYPECHECK(size)))
 
+#define BLKRASET   _IO(0x12,98) /* set read ahead for block device */
+#define BLKRAGET   _IO(0x12,99) /* get current read ahead setting */
 /* 108-111 have been used for various private purposes. */
 
 #define BLKSSZGET  _IO(0x12,104) /* get block logical device sector size */
 #define BLKGETSIZE64 _IOR(0x12,114,size_t)  /* get device size in bytes (u64 *arg) */
+#define BLKDISCARD _IO(0x12,119) /* discard a byte range (u64 range[2]) */
+#define BLKIOMIN   _IO(0x12,120) /* get minimum I/O size */
+#define BLKIOOPT   _IO(0x12,121) /* get optimal I/O size */
+#define BLKALIGNOFF _IO(0x12,122) /* get alignment offset */
+#define BLKSECDISCARD _IO(0x12,125) /* erase a byte range (u64 range[2]) */
 #define BLKPBSZGET _IO(0x12,123) /* get block physical device sector size */
 
+/* The background flusher (/dev/flusher), times in milliseconds. */
+#define FLSSETPERIOD _IO(0xF1,1) /* set the scan period */
+#define FLSGETPERIOD _IO(0xF1,2) /* get the scan period */
+#define FLSSETEXPIRE _IO(0xF1,3) /* set the age of the written back changes */
+#define FLSGETEXPIRE _IO(0xF1,4) /* get the age of the written back changes */
+#define FLSSETDIRTY  _IO(0xF1,5) /* set the dirty bytes that force a write back */
+#define FLSGETDIRTY  _IO(0xF1,6) /* get the dirty bytes that force a write back */
+#define FLSSETPRIO   _IO(0xF1,7) /* set the thread priority */
+#define FLSGETPRIO   _IO(0xF1,8) /* get the thread priority */
+
 // ----------------------------------------------------------------------------
 
 #endif /* POSIX_SYS_IOCTL_H_ */
@@ -0,0 +1,85 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef POSIX_IO_SYS_MMAN_H_
+#define POSIX_IO_SYS_MMAN_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wgnu-include-next"
+#endif
+#include_next <sys/mman.h>
+#pragma GCC diagnostic pop
+
+#else
+
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ----------------------------------------------------------------------------
+
+#define PROT_NONE   0x0 // Pages cannot be accessed.
+#define PROT_READ   0x1 // Pages can be read.
+#define PROT_WRITE  0x2 // Pages can be written.
+#define PROT_EXEC   0x4 // Pages can be executed.
+
+#define MAP_SHARED  0x01 // Changes are shared.
+#define MAP_PRIVATE 0x02 // Changes are private.
+#define MAP_FIXED   0x10 // Interpret the address exactly.
+
+#define MAP_FAILED  ((void*) -1)
+
+  void*
+  mmap (void* addr, size_t len, int prot, int flags, int fildes, off_t off);
+
+  int
+  munmap (void* addr, size_t len);
+
+  int
+  shm_open (const char* name, int oflag, mode_t mode);
+
+  int
+  shm_unlink (const char* name);
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* defined(__linux__) || defined(__APPLE__) */
+
+#endif /* POSIX_IO_SYS_MMAN_H_ */
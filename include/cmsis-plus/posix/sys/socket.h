@@ -41,9 +41,50 @@
 #include_next <sys/socket.h>
 #pragma GCC diagnostic pop
 
+#if !defined(__linux__)
+
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MSG_WAITFORONE)
+#define MSG_WAITFORONE 0x10000
+#endif
+
+  struct mmsghdr
+  {
+    struct msghdr msg_hdr; // Message header.
+    unsigned int msg_len; // Number of bytes transmitted.
+  };
+
+  int
+  recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags, struct timespec* timeout);
+
+  int
+  sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags);
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !defined(__linux__) */
+
 #else
 
 #include <sys/types.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <cmsis-plus/posix/sys/uio.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -62,6 +103,32 @@ extern "C"
     char sa_data[];  // Socket address (variable-length data).
   };
 
+  struct msghdr
+  {
+    void* msg_name; // Optional address.
+    socklen_t msg_namelen; // Size of address.
+    struct iovec* msg_iov; // Scatter/gather array.
+    int msg_iovlen; // Members in msg_iov.
+    void* msg_control; // Ancillary data.
+    socklen_t msg_controllen; // Ancillary data buffer length.
+    int msg_flags; // Flags on received message.
+  };
+
+  // Non POSIX, as in GNU/Linux.
+  struct mmsghdr
+  {
+    struct msghdr msg_hdr; // Message header.
+    unsigned int msg_len; // Number of bytes transmitted.
+  };
+
+#define MSG_DONTWAIT 0x40
+#define MSG_WAITFORONE 0x10000
+
+#define SOL_SOCKET 0xffff
+
+#define SO_SNDTIMEO 0x1005
+#define SO_RCVTIMEO 0x1006
+
   int
   accept (int socket, struct sockaddr* address, socklen_t* address_len);
 
@@ -91,12 +158,20 @@ extern "C"
   ssize_t
   recvmsg (int socket, struct msghdr* message, int flags);
 
+  int
+  recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags, struct timespec* timeout);
+
   ssize_t
   send (int socket, const void* buffer, size_t length, int flags);
 
   ssize_t
   sendmsg (int socket, const struct msghdr* message, int flags);
 
+  int
+  sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags);
+
   ssize_t
   sendto (int socket, const void* message, size_t length, int flags,
           const struct sockaddr* dest_addr, socklen_t dest_len);
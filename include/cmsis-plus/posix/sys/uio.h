@@ -58,6 +58,9 @@ extern "C"
     size_t iov_len;   // The size of the memory pointed to by iov_base.
   };
 
+  ssize_t
+  readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t
   writev (int fildes, const struct iovec* iov, int iovcnt);
 
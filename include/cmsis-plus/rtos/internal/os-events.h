@@ -0,0 +1,229 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_INTERNAL_OS_EVENTS_H_
+#define CMSIS_PLUS_RTOS_INTERNAL_OS_EVENTS_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef  __cplusplus
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Scheduler and interrupt events, for timeline tools.
+     * @ingroup cmsis-plus-rtos-core
+     *
+     * @details
+     * With @ref OS_INCLUDE_RTOS_EVENTS, the scheduler calls these
+     * functions at each context switch, when threads become ready,
+     * when they start waiting on or are released from a
+     * synchronisation object, and on each clock tick.
+     *
+     * The default implementations are weak and empty; define
+     * @ref OS_USE_RTOS_EVENTS_SEGGER_SYSTEMVIEW to forward them
+     * to SEGGER SystemView, or redefine them in the application.
+     *
+     * Without @ref OS_INCLUDE_RTOS_EVENTS the calls are inlined
+     * to empty bodies.
+     *
+     * All functions are called in critical sections or from
+     * interrupt handlers, so they must be short and must not block.
+     */
+    namespace events
+    {
+      /**
+       * @brief Initialise the events recorder.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * Called by `scheduler::initialize()`.
+       */
+      void
+      initialize (void);
+
+      /**
+       * @brief A different thread was selected to run.
+       * @param [in] from The previous thread.
+       * @param [in] to The new thread.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      thread_switched (thread* from, thread* to);
+
+      /**
+       * @brief The thread was linked to the ready list.
+       * @param [in] th The thread.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      thread_ready (thread* th);
+
+      /**
+       * @brief The thread started to wait on an object.
+       * @param [in] object The address of the object waiting list.
+       * @param [in] th The waiting thread.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      object_wait (const void* object, thread* th);
+
+      /**
+       * @brief The object released a waiting thread.
+       * @param [in] object The address of the object waiting list.
+       * @param [in] th The released thread.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      object_post (const void* object, thread* th);
+
+      /**
+       * @brief An interrupt handler was entered.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * Called by the RTOS handlers; application handlers may
+       * call it too, paired with `isr_exit()`.
+       */
+      void
+      isr_enter (void);
+
+      /**
+       * @brief An interrupt handler is about to return.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      isr_exit (void);
+
+      /**
+       * @brief The system clock ticked.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clock_tick (void);
+
+    } /* namespace events */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+#if !defined(OS_INCLUDE_RTOS_EVENTS)
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace events
+    {
+      // ----------------------------------------------------------------------
+
+      inline void
+      __attribute__((always_inline))
+      initialize (void)
+      {
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      inline void
+      __attribute__((always_inline))
+      thread_switched (thread* from, thread* to)
+      {
+      }
+
+      inline void
+      __attribute__((always_inline))
+      thread_ready (thread* th)
+      {
+      }
+
+      inline void
+      __attribute__((always_inline))
+      object_wait (const void* object, thread* th)
+      {
+      }
+
+      inline void
+      __attribute__((always_inline))
+      object_post (const void* object, thread* th)
+      {
+      }
+
+#pragma GCC diagnostic pop
+
+      inline void
+      __attribute__((always_inline))
+      isr_enter (void)
+      {
+      }
+
+      inline void
+      __attribute__((always_inline))
+      isr_exit (void)
+      {
+      }
+
+      inline void
+      __attribute__((always_inline))
+      clock_tick (void)
+      {
+      }
+
+    } /* namespace events */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* !defined(OS_INCLUDE_RTOS_EVENTS) */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_INTERNAL_OS_EVENTS_H_ */
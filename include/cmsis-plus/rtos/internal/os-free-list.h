@@ -0,0 +1,275 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_INTERNAL_OS_FREE_LIST_H_
+#define CMSIS_PLUS_RTOS_INTERNAL_OS_FREE_LIST_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef  __cplusplus
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace internal
+    {
+
+      // ======================================================================
+
+      /**
+       * @brief Lock free list of free fixed size blocks.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-core
+       *
+       * @details
+       * Used by `memory_pool` and `memory::block_pool` when
+       * `OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE` is defined.
+       *
+       * The list head is a 32-bits word with the index of the
+       * first free block in the lower half and a tag in the upper
+       * half; the tag is incremented by each change, so a block
+       * removed and added back while another context was about
+       * to remove it does not corrupt the list (the ABA problem).
+       *
+       * Both operations use a single compare and swap when not
+       * contended, and never mask interrupts.
+       *
+       * The number of blocks is limited to 65535.
+       */
+      class free_list
+      {
+      public:
+
+        /**
+         * @brief The maximum number of blocks.
+         */
+        static constexpr std::size_t max_blocks = 0xFFFF;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an empty list.
+         */
+        free_list () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        free_list (const free_list&) = delete;
+        free_list (free_list&&) = delete;
+        free_list&
+        operator= (const free_list&) = delete;
+        free_list&
+        operator= (free_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Link all blocks in the list.
+         * @param [in] addr Address of the first block.
+         * @param [in] blocks The number of blocks.
+         * @param [in] block_size_bytes The size of a block, in bytes.
+         * @par Returns
+         *  Nothing.
+         * @warning Not thread safe.
+         */
+        void
+        init (void* addr, std::size_t blocks,
+              std::size_t block_size_bytes) noexcept;
+
+        /**
+         * @brief Remove the first block.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the block, or `nullptr` if empty.
+         */
+        void*
+        pop (void) noexcept;
+
+        /**
+         * @brief Add a block at the beginning of the list.
+         * @param [in] block Pointer to the block.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        push (void* block) noexcept;
+
+        /**
+         * @brief Check if the list is empty.
+         * @par Parameters
+         *  None.
+         * @retval true There are no free blocks.
+         * @retval false There are free blocks.
+         */
+        bool
+        empty (void) const noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        static constexpr uint32_t index_mask = 0xFFFF;
+        static constexpr uint32_t tag_increment = 0x10000;
+
+        char* addr_ = nullptr;
+        std::size_t block_size_bytes_ = 0;
+
+        // Tag in the upper half, 1 based index in the lower half,
+        // 0 for an empty list.
+        uint32_t head_ = 0;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      inline void
+      free_list::init (void* addr, std::size_t blocks,
+                       std::size_t block_size_bytes) noexcept
+      {
+        assert(blocks <= max_blocks);
+        assert(block_size_bytes >= sizeof(uint32_t));
+
+        addr_ = static_cast<char*> (addr);
+        block_size_bytes_ = block_size_bytes;
+
+        // Each block stores the 1 based index of the next one,
+        // or 0 at the end.
+        for (std::size_t i = 0; i < blocks; ++i)
+          {
+            *reinterpret_cast<uint32_t*> (addr_ + i * block_size_bytes_) =
+                (i + 1 < blocks) ? static_cast<uint32_t> (i + 2) : 0;
+          }
+
+        head_ = (blocks > 0) ? 1 : 0;
+      }
+
+      /**
+       * @details
+       * The link is read from the block before the compare and swap;
+       * if the block was taken meanwhile, the link may be wrong,
+       * but the tag changed as well, and the operation is retried.
+       */
+      inline void*
+      free_list::pop (void) noexcept
+      {
+        uint32_t head = __atomic_load_n (&head_, __ATOMIC_ACQUIRE);
+        for (;;)
+          {
+            uint32_t index = head & index_mask;
+            if (index == 0)
+              {
+                return nullptr;
+              }
+
+            char* block = addr_ + (index - 1) * block_size_bytes_;
+            uint32_t next = __atomic_load_n (
+                reinterpret_cast<uint32_t*> (block), __ATOMIC_RELAXED);
+
+            uint32_t new_head = ((head + tag_increment) & ~index_mask)
+                | (next & index_mask);
+            if (__atomic_compare_exchange_n (&head_, &head, new_head, true,
+                                             __ATOMIC_ACQ_REL,
+                                             __ATOMIC_ACQUIRE))
+              {
+                return block;
+              }
+          }
+      }
+
+      inline void
+      free_list::push (void* block) noexcept
+      {
+        uint32_t index = static_cast<uint32_t> ((static_cast<char*> (block)
+            - addr_) / static_cast<std::ptrdiff_t> (block_size_bytes_)) + 1;
+
+        uint32_t head = __atomic_load_n (&head_, __ATOMIC_RELAXED);
+        uint32_t new_head;
+        do
+          {
+            __atomic_store_n (reinterpret_cast<uint32_t*> (block),
+                              head & index_mask, __ATOMIC_RELAXED);
+            new_head = ((head + tag_increment) & ~index_mask) | index;
+          }
+        while (!__atomic_compare_exchange_n (&head_, &head, new_head, true,
+                                             __ATOMIC_RELEASE,
+                                             __ATOMIC_RELAXED));
+      }
+
+      inline bool
+      free_list::empty (void) const noexcept
+      {
+        return (__atomic_load_n (&head_, __ATOMIC_RELAXED) & index_mask) == 0;
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace internal */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_INTERNAL_OS_FREE_LIST_H_ */
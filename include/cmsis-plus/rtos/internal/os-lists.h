@@ -45,6 +45,14 @@ namespace os
   {
     class thread;
 
+    /**
+     * @brief Tag selecting the constant initialised constructors
+     *  of the kernel objects.
+     * @ingroup cmsis-plus-rtos
+     */
+    using utils::static_init_t;
+    using utils::static_init;
+
     namespace internal
     {
       // ======================================================================
@@ -70,6 +78,13 @@ namespace os
          */
         waiting_thread_node (thread& th);
 
+        /**
+         * @brief Construct a node not yet associated with a thread.
+         * @par Parameters
+         *  None.
+         */
+        waiting_thread_node (void);
+
         /**
          * @cond ignore
          */
@@ -106,6 +121,16 @@ namespace os
          */
         rtos::thread* thread_;
 
+        /**
+         * @brief The flags waited for, used by `event_flags`.
+         */
+        uint32_t flags_mask_ = 0;
+
+        /**
+         * @brief The wait mode, used by `event_flags`.
+         */
+        uint32_t flags_mode_ = 0;
+
         /**
          * @}
          */
@@ -446,6 +471,8 @@ namespace os
 
       // ======================================================================
 
+#if !defined(OS_USE_RTOS_READY_THREADS_BITMAP)
+
       /**
        * @brief Priority ordered list of threads waiting too run.
        */
@@ -528,6 +555,145 @@ namespace os
          */
       };
 
+#else
+
+      /**
+       * @brief Priority indexed list of threads waiting to run.
+       *
+       * @details
+       * Each priority level has its own FIFO list and a two level
+       * bitmap keeps track of the levels that might have threads,
+       * so both link() and unlink_head() run in constant time,
+       * regardless of the number of ready threads.
+       */
+      class ready_threads_list
+      {
+      public:
+
+        /**
+         * @brief Number of priority levels.
+         */
+        static constexpr std::size_t levels = 256;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a list of waiting threads.
+         */
+        ready_threads_list ();
+
+        /**
+         * @cond ignore
+         */
+
+        ready_threads_list (const ready_threads_list&) = delete;
+        ready_threads_list (ready_threads_list&&) = delete;
+        ready_threads_list&
+        operator= (const ready_threads_list&) = delete;
+        ready_threads_list&
+        operator= (ready_threads_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the list.
+         */
+        ~ready_threads_list ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a new thread node to the list.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link (waiting_thread_node& node);
+
+        /**
+         * @brief Get list head.
+         * @par Parameters
+         *  None.
+         * @return Casted pointer to the highest priority node,
+         *  or `nullptr` if the list is empty.
+         */
+        volatile waiting_thread_node*
+        head (void) const;
+
+        /**
+         * @brief Remove the top node from the list.
+         * @par Parameters
+         *  None.
+         * @return Pointer to thread.
+         */
+        thread*
+        unlink_head (void);
+
+        /**
+         * @brief Check if the list is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The list has no nodes.
+         * @retval false The list has at least one node.
+         */
+        bool
+        empty (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        class level_list : public utils::static_double_list
+        {
+        public:
+
+          void
+          link (waiting_thread_node& node);
+        };
+
+        static constexpr std::size_t bits_ = 32;
+
+        static std::size_t
+        top_bit_ (uint32_t mask);
+
+        void
+        clear_level_ (std::size_t prio);
+
+        level_list lists_[levels];
+
+        // One bit for each group of `bits_` levels.
+        uint32_t groups_;
+        // One bit for each level.
+        uint32_t map_[levels / bits_];
+
+        /**
+         * @endcond
+         */
+      };
+
+#endif /* !defined(OS_USE_RTOS_READY_THREADS_BITMAP) */
+
       // ======================================================================
 
       /**
@@ -561,6 +727,13 @@ namespace os
          */
         waiting_threads_list ();
 
+        /**
+         * @brief Construct an empty list of waiting threads
+         *  (constant initialised).
+         */
+        constexpr
+        waiting_threads_list (static_init_t);
+
         /**
          * @cond ignore
          */
@@ -630,6 +803,19 @@ namespace os
         void
         resume_all (void);
 
+        /**
+         * @brief Wake-up the threads accepted by a filter.
+         * @param [in] filter Function called for each node, in list
+         *  order; returns true to resume the thread.
+         * @param [in] arg Argument passed to the filter.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        resume_if (bool
+                   (*filter) (waiting_thread_node& node, void* arg),
+                   void* arg);
+
         /**
          * @brief Iterator begin.
          * @return An iterator positioned at the first element.
@@ -651,6 +837,8 @@ namespace os
 
       // ======================================================================
 
+#if !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL)
+
       /**
        * @brief Ordered list of time stamp nodes.
        */
@@ -726,11 +914,263 @@ namespace os
         void
         check_timestamp (port::clock::timestamp_t now);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+        /**
+         * @brief Get the maximum number of nodes expired by one check.
+         * @par Parameters
+         *  None.
+         * @return The number of nodes, since startup or the last reset.
+         */
+        std::size_t
+        max_expired (void) const;
+
+        /**
+         * @brief Reset the maximum number of expired nodes.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        max_expired_reset (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
+
         /**
          * @}
          */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        std::size_t max_expired_;
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
       };
 
+#else
+
+      /**
+       * @brief Hierarchical timing wheel of time stamp nodes.
+       *
+       * @details
+       * The time stamps are distributed in `levels` wheels of
+       * `slots` lists each; the first wheel has one list per
+       * clock tick, each further wheel one list per turn of the
+       * previous wheel; time stamps beyond the last wheel go to
+       * an unordered overflow list.
+       *
+       * Inserting and removing a node take constant time; the
+       * nodes are moved to the lower wheels when their time
+       * approaches, so expiry takes amortised constant time,
+       * regardless of the number of nodes.
+       */
+      class clock_timestamps_list
+      {
+      public:
+
+        /**
+         * @name Types and constants
+         * @{
+         */
+
+        /**
+         * @brief Number of bits of the slot index in each wheel.
+         */
+        static constexpr std::size_t slot_bits =
+            OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS;
+
+        /**
+         * @brief Number of slots in each wheel.
+         */
+        static constexpr std::size_t slots = (1u << slot_bits);
+
+        /**
+         * @brief Number of wheels.
+         */
+        static constexpr std::size_t levels =
+            OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a list of clock time stamps.
+         */
+        clock_timestamps_list ();
+
+        /**
+         * @cond ignore
+         */
+
+        clock_timestamps_list (const clock_timestamps_list&) = delete;
+        clock_timestamps_list (clock_timestamps_list&&) = delete;
+        clock_timestamps_list&
+        operator= (const clock_timestamps_list&) = delete;
+        clock_timestamps_list&
+        operator= (clock_timestamps_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the list.
+         */
+        ~clock_timestamps_list ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a new thread node to the list.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link (timestamp_node& node);
+
+        /**
+         * @brief Get the node with the earliest time stamp.
+         * @par Parameters
+         *  None.
+         * @return Casted pointer to the earliest node,
+         *  or `nullptr` if the list is empty.
+         */
+        volatile timestamp_node*
+        head (void) const;
+
+        /**
+         * @brief Check if the list is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The list has no nodes.
+         * @retval false The list has at least one node.
+         */
+        bool
+        empty (void) const;
+
+        /**
+         * @brief Check list time stamps.
+         * @param [in] now The current clock time stamp.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        check_timestamp (port::clock::timestamp_t now);
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+        /**
+         * @brief Get the maximum number of nodes expired by one check.
+         * @par Parameters
+         *  None.
+         * @return The number of nodes, since startup or the last reset.
+         */
+        std::size_t
+        max_expired (void) const;
+
+        /**
+         * @brief Reset the maximum number of expired nodes.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        max_expired_reset (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        class slot_list : public utils::static_double_list
+        {
+        public:
+
+          void
+          link (timestamp_node& node);
+
+          timestamp_node*
+          earliest (void) const;
+        };
+
+        static_assert(slot_bits <= 5, "the slots must fit a 32-bit map");
+        static_assert(slot_bits * levels < 64, "too many wheels");
+
+        static constexpr std::size_t mask_ = slots - 1;
+
+        static std::size_t
+        first_bit_ (uint32_t mask);
+
+        void
+        place_ (timestamp_node& node);
+
+        void
+        replace_ (slot_list& lst);
+
+        void
+        cascade_ (void);
+
+        port::clock::timestamp_t
+        next_event_ (void);
+
+        void
+        rewind_ (port::clock::timestamp_t now);
+
+        slot_list slots_[levels][slots];
+        slot_list overflow_;
+
+        // One bit for each slot that might have nodes.
+        uint32_t maps_[levels];
+
+        // All time stamps before this one were processed.
+        port::clock::timestamp_t now_;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+        std::size_t max_expired_;
+#endif
+
+        /**
+         * @endcond
+         */
+      };
+
+#endif /* !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL) */
+
       // ======================================================================
 
       /**
@@ -864,6 +1304,13 @@ namespace os
         ;
       }
 
+      inline
+      waiting_thread_node::waiting_thread_node (void) :
+          thread_ (nullptr)
+      {
+        ;
+      }
+
       inline
       waiting_thread_node::~waiting_thread_node ()
       {
@@ -890,6 +1337,8 @@ namespace os
 
       // ======================================================================
 
+#if !defined(OS_USE_RTOS_READY_THREADS_BITMAP)
+
       /**
        * @details
        * The initial list status is empty.
@@ -912,6 +1361,40 @@ namespace os
         return static_cast<volatile waiting_thread_node*> (static_double_list::head ());
       }
 
+#else
+
+      /**
+       * @details
+       * The list is expected to be allocated in BSS, so
+       * the bitmaps are already cleared; the level lists are
+       * initialised when first used.
+       */
+      inline
+      ready_threads_list::ready_threads_list ()
+      {
+        // By all means, do not add any code here.
+      }
+
+      inline
+      ready_threads_list::~ready_threads_list ()
+      {
+        ;
+      }
+
+      inline bool
+      ready_threads_list::empty (void) const
+      {
+        return (head () == nullptr);
+      }
+
+      inline std::size_t
+      ready_threads_list::top_bit_ (uint32_t mask)
+      {
+        return (bits_ - 1) - static_cast<std::size_t> (__builtin_clz (mask));
+      }
+
+#endif /* !defined(OS_USE_RTOS_READY_THREADS_BITMAP) */
+
       // ======================================================================
 
       /**
@@ -924,6 +1407,14 @@ namespace os
         ;
       }
 
+      constexpr
+      waiting_threads_list::waiting_threads_list (static_init_t tag) :
+          double_list
+            { tag }
+      {
+        ;
+      }
+
       inline
       waiting_threads_list::~waiting_threads_list ()
       {
@@ -954,6 +1445,8 @@ namespace os
 
       // ======================================================================
 
+#if !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL)
+
       inline
       clock_timestamps_list::clock_timestamps_list ()
       {
@@ -972,6 +1465,56 @@ namespace os
         return static_cast<volatile timestamp_node*> (double_list::head ());
       }
 
+#else
+
+      /**
+       * @details
+       * The list is expected to be allocated in BSS, so
+       * the maps are already cleared; the slot lists are
+       * initialised when first used.
+       */
+      inline
+      clock_timestamps_list::clock_timestamps_list ()
+      {
+        // By all means, do not add any code here.
+      }
+
+      inline
+      clock_timestamps_list::~clock_timestamps_list ()
+      {
+        ;
+      }
+
+      inline bool
+      clock_timestamps_list::empty (void) const
+      {
+        return (head () == nullptr);
+      }
+
+      inline std::size_t
+      clock_timestamps_list::first_bit_ (uint32_t mask)
+      {
+        return static_cast<std::size_t> (__builtin_ctz (mask));
+      }
+
+#endif /* !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+      inline std::size_t
+      clock_timestamps_list::max_expired (void) const
+      {
+        return max_expired_;
+      }
+
+      inline void
+      clock_timestamps_list::max_expired_reset (void)
+      {
+        max_expired_ = 0;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
+
       // ======================================================================
 
       /**
@@ -0,0 +1,339 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_INTERNAL_OS_SYNC_STATS_H_
+#define CMSIS_PLUS_RTOS_INTERNAL_OS_SYNC_STATS_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef  __cplusplus
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace statistics
+    {
+
+      // ======================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Contention statistics of a synchronisation object.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-core
+       *
+       * @details
+       * Included in mutexes, semaphores, condition variables and
+       * event flags. All durations are in high resolution clock
+       * cycles.
+       *
+       * All live objects are linked in a list, available via
+       * `statistics::sync_objects()`.
+       */
+      class sync
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct and register the statistics of an object.
+         * @param [in] object Pointer to the synchronisation object.
+         */
+        sync (internal::object_named* object);
+
+        /**
+         * @brief Construct the statistics of a constant initialised
+         *  object.
+         * @param [in] object Pointer to the synchronisation object.
+         * @details
+         * The statistics are registered at the first use
+         * of the object.
+         */
+        constexpr
+        sync (static_init_t, internal::object_named* object);
+
+        /**
+         * @cond ignore
+         */
+
+        sync (const sync&) = delete;
+        sync (sync&&) = delete;
+        sync&
+        operator= (const sync&) = delete;
+        sync&
+        operator= (sync&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Unregister the statistics.
+         */
+        ~sync ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the name of the object.
+         * @par Parameters
+         *  None.
+         * @return A null terminated string.
+         */
+        const char*
+        name (void) const;
+
+        /**
+         * @brief Get the object.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the synchronisation object.
+         */
+        internal::object_named*
+        object (void) const;
+
+        /**
+         * @brief Get the number of acquisitions.
+         * @par Parameters
+         *  None.
+         * @return The number of successful locks or waits.
+         */
+        counter_t
+        acquired (void) const;
+
+        /**
+         * @brief Get the number of contended acquisitions.
+         * @par Parameters
+         *  None.
+         * @return The number of locks or waits which had to block.
+         */
+        counter_t
+        contended (void) const;
+
+        /**
+         * @brief Get the total wait time.
+         * @par Parameters
+         *  None.
+         * @return The sum of all wait durations.
+         */
+        duration_t
+        wait_total (void) const;
+
+        /**
+         * @brief Get the maximum wait time.
+         * @par Parameters
+         *  None.
+         * @return The longest wait duration.
+         */
+        duration_t
+        wait_max (void) const;
+
+        /**
+         * @brief Get the maximum hold time.
+         * @par Parameters
+         *  None.
+         * @return The longest duration a mutex was owned; 0 for
+         *  objects without ownership.
+         */
+        duration_t
+        hold_max (void) const;
+
+        /**
+         * @brief Clear all statistics.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        clear (void);
+
+        /**
+         * @}
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        void
+        internal_mark_acquired_ (void);
+
+        port::clock::timestamp_t
+        internal_mark_contended_ (void);
+
+        void
+        internal_mark_waited_ (port::clock::timestamp_t begin);
+
+        void
+        internal_mark_released_ (void);
+
+        /**
+         * @endcond
+         */
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // Intrusive node used to link all live objects.
+        utils::double_list_links links_;
+
+        /**
+         * @endcond
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        internal::object_named* object_;
+
+        counter_t acquired_ = 0;
+        counter_t contended_ = 0;
+        duration_t wait_total_ = 0;
+        duration_t wait_max_ = 0;
+        duration_t hold_max_ = 0;
+        duration_t hold_begin_ = 0;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @brief List of all synchronisation objects statistics.
+       */
+      using sync_list = utils::intrusive_list<sync, utils::double_list_links, &sync::links_>;
+
+      /**
+       * @brief Get the list of all live synchronisation objects.
+       * @par Parameters
+       *  None.
+       * @return Reference to the list.
+       *
+       * @details
+       * Iterate it with the scheduler locked, to prevent objects
+       * to be created or destroyed.
+       */
+      sync_list&
+      sync_objects (void);
+
+    } /* namespace statistics */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace statistics
+    {
+
+      // ======================================================================
+
+      constexpr
+      sync::sync (static_init_t, internal::object_named* object) :
+          object_ (object)
+      {
+        ;
+      }
+
+      inline internal::object_named*
+      sync::object (void) const
+      {
+        return object_;
+      }
+
+      inline counter_t
+      sync::acquired (void) const
+      {
+        return acquired_;
+      }
+
+      inline counter_t
+      sync::contended (void) const
+      {
+        return contended_;
+      }
+
+      inline duration_t
+      sync::wait_total (void) const
+      {
+        return wait_total_;
+      }
+
+      inline duration_t
+      sync::wait_max (void) const
+      {
+        return wait_max_;
+      }
+
+      inline duration_t
+      sync::hold_max (void) const
+      {
+        return hold_max_;
+      }
+
+    } /* namespace statistics */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_SYNC) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_INTERNAL_OS_SYNC_STATS_H_ */
@@ -0,0 +1,822 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_AMPCHANNEL_H_
+#define CMSIS_PLUS_RTOS_OS_AMPCHANNEL_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-semaphore.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Inter-core channel**, for asymmetric multi-core parts.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-ampchannel
+     */
+    class amp_channel : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of variables holding the channel end.
+       * @ingroup cmsis-plus-rtos-ampchannel
+       */
+      using role_t = uint8_t;
+
+      /**
+       * @brief Channel ends.
+       * @ingroup cmsis-plus-rtos-ampchannel
+       */
+      struct role
+      {
+        enum
+          : role_t
+            {
+              /**
+               * @brief The end which sends the messages.
+               */
+              sender = 0,
+
+              /**
+               * @brief The end which receives the messages.
+               */
+              receiver = 1
+        };
+      };
+
+      /**
+       * @brief Type of the doorbell function, which interrupts
+       *  the other core.
+       * @ingroup cmsis-plus-rtos-ampchannel
+       */
+      using doorbell_t = void (*) (void* args);
+
+      /**
+       * @brief Type of the cache maintenance functions.
+       * @ingroup cmsis-plus-rtos-ampchannel
+       */
+      using cache_func_t = void (*) (void* addr, std::size_t bytes);
+
+      // ======================================================================
+
+      /**
+       * @brief Inter-core channel attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-ampchannel
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an inter-core channel attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the inter-core channel attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        /**
+         * @brief Function raising the interrupt on the other core.
+         * @details
+         * Called when the other end waits; the interrupt handler
+         * on the other core must call `interrupt_handler()` on its
+         * channel object. If `nullptr`, the other end is never
+         * woken, and should use the non blocking calls.
+         */
+        doorbell_t ch_doorbell = nullptr;
+
+        /**
+         * @brief Argument passed to the doorbell function.
+         */
+        void* ch_doorbell_args = nullptr;
+
+        /**
+         * @brief Function writing the cached shared data to memory.
+         * @details
+         * If `nullptr`, the shared memory is not cached, or it is
+         * coherent between the cores.
+         */
+        cache_func_t ch_cache_clean = nullptr;
+
+        /**
+         * @brief Function discarding the cached shared data.
+         * @details
+         * If `nullptr`, the shared memory is not cached, or it is
+         * coherent between the cores.
+         */
+        cache_func_t ch_cache_invalidate = nullptr;
+
+        // Add more attributes here.
+
+        /**
+         * @}
+         */
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default inter-core channel initialiser.
+       * @ingroup cmsis-plus-rtos-ampchannel
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @brief Compute the shared memory size.
+       * @param [in] depth The number of messages; must be a power of 2.
+       * @param [in] msg_size_bytes The max message size, in bytes.
+       * @return The number of bytes of shared memory.
+       */
+      static constexpr std::size_t
+      compute_shared_size_bytes (std::size_t depth, std::size_t msg_size_bytes);
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct an inter-core channel object instance.
+       * @param [in] end The channel end, `role::sender` or `role::receiver`.
+       * @param [in] shared Pointer to the shared memory, aligned to
+       *  the cache line.
+       * @param [in] shared_size_bytes The shared memory size, in bytes.
+       * @param [in] msg_size_bytes The max message size, in bytes.
+       * @param [in] attr Reference to attributes.
+       */
+      amp_channel (role_t end, void* shared, std::size_t shared_size_bytes,
+                   std::size_t msg_size_bytes, const attributes& attr =
+                       initializer);
+
+      /**
+       * @brief Construct a named inter-core channel object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] end The channel end, `role::sender` or `role::receiver`.
+       * @param [in] shared Pointer to the shared memory, aligned to
+       *  the cache line.
+       * @param [in] shared_size_bytes The shared memory size, in bytes.
+       * @param [in] msg_size_bytes The max message size, in bytes.
+       * @param [in] attr Reference to attributes.
+       */
+      amp_channel (const char* name, role_t end, void* shared,
+                   std::size_t shared_size_bytes, std::size_t msg_size_bytes,
+                   const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      amp_channel (const amp_channel&) = delete;
+      amp_channel (amp_channel&&) = delete;
+      amp_channel&
+      operator= (const amp_channel&) = delete;
+      amp_channel&
+      operator= (amp_channel&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the inter-core channel object instance.
+       */
+      ~amp_channel ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare channels.
+       * @retval true The given channel is the same as this channel.
+       * @retval false The channels are different.
+       */
+      bool
+      operator== (const amp_channel& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Send a message to the other core.
+       * @param [in] msg The address of the message to enqueue.
+       * @param [in] nbytes The length of the message.
+       * @retval result::ok The message was enqueued.
+       * @retval EPERM Not the sender end, or cannot be invoked from
+       *  an Interrupt Service Routines.
+       * @retval EMSGSIZE The message is larger than the channel
+       *  message size.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      send (const void* msg, std::size_t nbytes);
+
+      /**
+       * @brief Try to send a message to the other core.
+       * @param [in] msg The address of the message to enqueue.
+       * @param [in] nbytes The length of the message.
+       * @retval result::ok The message was enqueued.
+       * @retval EPERM Not the sender end.
+       * @retval EMSGSIZE The message is larger than the channel
+       *  message size.
+       * @retval EWOULDBLOCK The channel is full.
+       */
+      result_t
+      try_send (const void* msg, std::size_t nbytes);
+
+      /**
+       * @brief Send a message to the other core, with timeout.
+       * @param [in] msg The address of the message to enqueue.
+       * @param [in] nbytes The length of the message.
+       * @param [in] timeout The timeout duration.
+       * @retval result::ok The message was enqueued.
+       * @retval EPERM Not the sender end, or cannot be invoked from
+       *  an Interrupt Service Routines.
+       * @retval EMSGSIZE The message is larger than the channel
+       *  message size.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The channel was still full after the timeout.
+       */
+      result_t
+      timed_send (const void* msg, std::size_t nbytes,
+                  clock::duration_t timeout);
+
+      /**
+       * @brief Receive a message from the other core.
+       * @param [out] msg The address where to store the message.
+       * @param [in] nbytes The size of the buffer, at least the
+       *  channel message size.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
+       * @retval result::ok The message was received.
+       * @retval EPERM Not the receiver end, or cannot be invoked from
+       *  an Interrupt Service Routines.
+       * @retval EMSGSIZE The buffer is smaller than the channel
+       *  message size.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      receive (void* msg, std::size_t nbytes, std::size_t* length = nullptr);
+
+      /**
+       * @brief Try to receive a message from the other core.
+       * @param [out] msg The address where to store the message.
+       * @param [in] nbytes The size of the buffer, at least the
+       *  channel message size.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
+       * @retval result::ok The message was received.
+       * @retval EPERM Not the receiver end.
+       * @retval EMSGSIZE The buffer is smaller than the channel
+       *  message size.
+       * @retval EWOULDBLOCK The channel is empty.
+       */
+      result_t
+      try_receive (void* msg, std::size_t nbytes, std::size_t* length =
+                       nullptr);
+
+      /**
+       * @brief Receive a message from the other core, with timeout.
+       * @param [out] msg The address where to store the message.
+       * @param [in] nbytes The size of the buffer, at least the
+       *  channel message size.
+       * @param [in] timeout The timeout duration.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
+       * @retval result::ok The message was received.
+       * @retval EPERM Not the receiver end, or cannot be invoked from
+       *  an Interrupt Service Routines.
+       * @retval EMSGSIZE The buffer is smaller than the channel
+       *  message size.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No message arrived before the timeout.
+       */
+      result_t
+      timed_receive (void* msg, std::size_t nbytes, clock::duration_t timeout,
+                     std::size_t* length = nullptr);
+
+      /**
+       * @brief Allocate a message slot for zero-copy send.
+       * @par Parameters
+       *  None.
+       * @return Pointer to a slot of `msg_size()` bytes in the shared
+       *  memory, or `nullptr` if interrupted.
+       */
+      void*
+      alloc_slot (void);
+
+      /**
+       * @brief Try to allocate a message slot for zero-copy send.
+       * @par Parameters
+       *  None.
+       * @return Pointer to a slot of `msg_size()` bytes in the shared
+       *  memory, or `nullptr` if the channel is full.
+       */
+      void*
+      try_alloc_slot (void);
+
+      /**
+       * @brief Allocate a message slot for zero-copy send, with timeout.
+       * @param [in] timeout The timeout duration.
+       * @return Pointer to a slot of `msg_size()` bytes in the shared
+       *  memory, or `nullptr` if timeout or interrupted.
+       */
+      void*
+      timed_alloc_slot (clock::duration_t timeout);
+
+      /**
+       * @brief Publish an allocated slot as a message.
+       * @param [in] slot Pointer to the slot returned by `alloc_slot()`.
+       * @param [in] nbytes The length of the message.
+       * @retval result::ok The message was enqueued.
+       * @retval EINVAL The pointer is not the allocated slot.
+       * @retval EMSGSIZE The message is larger than the channel
+       *  message size.
+       */
+      result_t
+      commit (void* slot, std::size_t nbytes);
+
+      /**
+       * @brief Receive a reference to a message from the other core.
+       * @param [out] slot The address where to store the pointer
+       *  to the message slot.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
+       * @retval result::ok The message was dequeued.
+       * @retval EPERM Not the receiver end, or cannot be invoked from
+       *  an Interrupt Service Routines.
+       * @retval EBUSY The previous message was not released.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      receive_ref (void** slot, std::size_t* length = nullptr);
+
+      /**
+       * @brief Try to receive a reference to a message from the other core.
+       * @param [out] slot The address where to store the pointer
+       *  to the message slot.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
+       * @retval result::ok The message was dequeued.
+       * @retval EPERM Not the receiver end.
+       * @retval EBUSY The previous message was not released.
+       * @retval EWOULDBLOCK The channel is empty.
+       */
+      result_t
+      try_receive_ref (void** slot, std::size_t* length = nullptr);
+
+      /**
+       * @brief Receive a reference to a message from the other core,
+       *  with timeout.
+       * @param [out] slot The address where to store the pointer
+       *  to the message slot.
+       * @param [in] timeout The timeout duration.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
+       * @retval result::ok The message was dequeued.
+       * @retval EPERM Not the receiver end, or cannot be invoked from
+       *  an Interrupt Service Routines.
+       * @retval EBUSY The previous message was not released.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No message arrived before the timeout.
+       */
+      result_t
+      timed_receive_ref (void** slot, clock::duration_t timeout,
+                         std::size_t* length = nullptr);
+
+      /**
+       * @brief Return a slot to the channel.
+       * @param [in] slot Pointer to a slot returned by `receive_ref()`,
+       *  or by `alloc_slot()` and not committed.
+       * @retval result::ok The slot was released.
+       * @retval EINVAL The pointer is not the slot in use.
+       */
+      result_t
+      release (void* slot);
+
+      /**
+       * @brief Handle the doorbell interrupt from the other core.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      interrupt_handler (void);
+
+      /**
+       * @brief Get the channel end.
+       * @par Parameters
+       *  None.
+       * @return `role::sender` or `role::receiver`.
+       */
+      role_t
+      end (void) const;
+
+      /**
+       * @brief Get the channel capacity.
+       * @par Parameters
+       *  None.
+       * @return The max number of messages in the channel.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get the message size.
+       * @par Parameters
+       *  None.
+       * @return The max message size, in bytes.
+       */
+      std::size_t
+      msg_size (void) const;
+
+      /**
+       * @brief Get the channel length.
+       * @par Parameters
+       *  None.
+       * @return The number of messages in the channel.
+       */
+      std::size_t
+      length (void);
+
+      /**
+       * @brief Check if the channel is empty.
+       * @par Parameters
+       *  None.
+       * @retval true The channel has no messages.
+       * @retval false The channel has some messages.
+       */
+      bool
+      empty (void);
+
+      /**
+       * @brief Check if the channel is full.
+       * @par Parameters
+       *  None.
+       * @retval true The channel is full.
+       * @retval false The channel is not full.
+       */
+      bool
+      full (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // The control block, at the beginning of the shared memory;
+      // the indices and the flags have one writer each and
+      // are in separate cache lines.
+      struct control
+      {
+        uint32_t magic;
+        uint32_t msg_size_bytes;
+        uint32_t slot_size_bytes;
+        uint32_t depth;
+
+        // Free running indices, the difference is the length.
+        // Written only by the receiver.
+        alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) uint32_t head;
+
+        // Written only by the sender.
+        alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) uint32_t tail;
+
+        // Set by the receiver while it waits on an empty channel.
+        alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) uint32_t rx_waiting;
+
+        // Set by the sender while it waits on a full channel.
+        alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) uint32_t tx_waiting;
+      };
+
+      // Before each message, in its slot.
+      struct slot_header
+      {
+        uint32_t length;
+        uint32_t reserved;
+      };
+
+      static constexpr uint32_t magic = 0x414D5043; // 'AMPC'
+
+      using predicate_t = bool (amp_channel::*) (void);
+
+      static constexpr std::size_t
+      internal_round_ (std::size_t bytes);
+
+      /**
+       * @endcond
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_clean_ (void* addr, std::size_t bytes);
+
+      void
+      internal_invalidate_ (void* addr, std::size_t bytes);
+
+      uint32_t
+      internal_load_ (uint32_t* addr);
+
+      void
+      internal_store_ (uint32_t* addr, uint32_t value);
+
+      void
+      internal_ring_ (void);
+
+      uint8_t*
+      internal_slot_ (uint32_t index);
+
+      bool
+      internal_can_send_ (void);
+
+      bool
+      internal_can_receive_ (void);
+
+      result_t
+      internal_wait_ (uint32_t* waiting, predicate_t ready, bool timed,
+                      clock::timestamp_t deadline);
+
+      void*
+      internal_alloc_slot_ (bool timed, clock::duration_t timeout);
+
+      result_t
+      internal_receive_ref_ (void** slot, std::size_t* length, bool timed,
+                             clock::duration_t timeout);
+
+      result_t
+      internal_send_ (const void* msg, std::size_t nbytes, bool timed,
+                      clock::duration_t timeout);
+
+      result_t
+      internal_receive_ (void* msg, std::size_t nbytes, std::size_t* length,
+                         bool timed, clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      // Posted by the doorbell interrupt.
+      semaphore semaphore_;
+
+      control* control_ = nullptr;
+      uint8_t* slots_ = nullptr;
+      clock* clock_ = nullptr;
+
+      doorbell_t doorbell_ = nullptr;
+      void* doorbell_args_ = nullptr;
+      cache_func_t cache_clean_ = nullptr;
+      cache_func_t cache_invalidate_ = nullptr;
+
+      // The slot allocated or received and not yet committed or
+      // released; at most one at a time.
+      uint8_t* loan_ = nullptr;
+
+      std::size_t msg_size_bytes_ = 0;
+      std::size_t slot_size_bytes_ = 0;
+      uint32_t depth_ = 0;
+
+      role_t end_;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    amp_channel::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @cond ignore
+     */
+
+    constexpr std::size_t
+    amp_channel::internal_round_ (std::size_t bytes)
+    {
+      return (bytes + OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES - 1)
+          & ~static_cast<std::size_t> (OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES - 1);
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The control block and each slot (a small header followed by
+     * the message) are rounded up to the cache line size, so that
+     * the cache maintenance of one never affects the others.
+     */
+    constexpr std::size_t
+    amp_channel::compute_shared_size_bytes (std::size_t depth,
+                                            std::size_t msg_size_bytes)
+    {
+      return internal_round_ (sizeof(control))
+          + depth * internal_round_ (sizeof(slot_header) + msg_size_bytes);
+    }
+
+    /**
+     * @details
+     * This constructor shall initialise an anonymous channel end;
+     * for details see the named constructor.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline
+    amp_channel::amp_channel (role_t end, void* shared,
+                              std::size_t shared_size_bytes,
+                              std::size_t msg_size_bytes,
+                              const attributes& attr) :
+        amp_channel
+          { nullptr, end, shared, shared_size_bytes, msg_size_bytes, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Identical channels should have the same memory address.
+     */
+    inline bool
+    amp_channel::operator== (const amp_channel& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline amp_channel::role_t
+    amp_channel::end (void) const
+    {
+      return end_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    amp_channel::capacity (void) const
+    {
+      return depth_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    amp_channel::msg_size (void) const
+    {
+      return msg_size_bytes_;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_AMPCHANNEL_H_ */
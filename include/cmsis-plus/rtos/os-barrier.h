@@ -0,0 +1,473 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_BARRIER_H_
+#define CMSIS_PLUS_RTOS_OS_BARRIER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Barrier**, to synchronise a group of threads in phases.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-barrier
+     */
+    class barrier : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of barrier counter storage.
+       * @ingroup cmsis-plus-rtos-barrier
+       */
+      using count_t = int32_t;
+
+      /**
+       * @brief Type of barrier phase storage.
+       * @ingroup cmsis-plus-rtos-barrier
+       */
+      using phase_t = uint32_t;
+
+      /**
+       * @brief Maximum number of expected arrivals.
+       * @ingroup cmsis-plus-rtos-barrier
+       */
+      static constexpr count_t max_count_value = 0x7FFFFFFF;
+
+      /**
+       * @brief Type of completion function.
+       * @ingroup cmsis-plus-rtos-barrier
+       */
+      using completion_t = void (*) (void* args);
+
+      // ======================================================================
+
+      /**
+       * @brief Barrier attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-barrier
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a barrier attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the barrier attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+        // Add more attributes here.
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default barrier initialiser.
+       * @ingroup cmsis-plus-rtos-barrier
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a barrier object instance.
+       * @param [in] expected The number of arrivals in each phase.
+       * @param [in] attr Reference to attributes.
+       */
+      barrier (count_t expected, const attributes& attr = initializer);
+
+      /**
+       * @brief Construct a named barrier object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] expected The number of arrivals in each phase.
+       * @param [in] attr Reference to attributes.
+       */
+      barrier (const char* name, count_t expected, const attributes& attr =
+                   initializer);
+
+      /**
+       * @brief Construct a named barrier object instance,
+       *  with a completion function.
+       * @param [in] name Pointer to name.
+       * @param [in] expected The number of arrivals in each phase.
+       * @param [in] completion Pointer to function to run
+       *  at the end of each phase; may be `nullptr`.
+       * @param [in] args Pointer to completion function arguments.
+       * @param [in] attr Reference to attributes.
+       */
+      barrier (const char* name, count_t expected, completion_t completion,
+               void* args, const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      barrier (const barrier&) = delete;
+      barrier (barrier&&) = delete;
+      barrier&
+      operator= (const barrier&) = delete;
+      barrier&
+      operator= (barrier&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the barrier object instance.
+       */
+      ~barrier ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare barriers.
+       * @retval true The given barrier is the same as this barrier.
+       * @retval false The barriers are different.
+       */
+      bool
+      operator== (const barrier& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Arrive at the barrier, without waiting.
+       * @param [out] phase Pointer where to store the phase of
+       *  the arrival, to be passed to `wait()`; may be `nullptr`.
+       * @param [in] update The number of arrivals.
+       * @retval result::ok The arrivals were counted.
+       * @retval EINVAL The update is not positive, or larger than
+       *  the number of arrivals still expected in the current phase.
+       */
+      result_t
+      arrive (phase_t* phase = nullptr, count_t update = 1);
+
+      /**
+       * @brief Wait for the end of a phase.
+       * @param [in] phase The phase returned by `arrive()`.
+       * @retval result::ok The phase ended.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      wait (phase_t phase);
+
+      /**
+       * @brief Timed wait for the end of a phase.
+       * @param [in] phase The phase returned by `arrive()`.
+       * @param [in] timeout Timeout to wait.
+       * @retval result::ok The phase ended.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT The phase did not end before
+       *  the specified timeout expired.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_wait (phase_t phase, clock::duration_t timeout);
+
+      /**
+       * @brief Arrive at the barrier and wait for the end of the phase.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The phase ended.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL All arrivals were already counted
+       *  in the current phase.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      arrive_and_wait (void);
+
+      /**
+       * @brief Arrive at the barrier and leave the group.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The arrival was counted and the number
+       *  of arrivals expected in the next phases was decremented.
+       * @retval EINVAL All arrivals were already counted
+       *  in the current phase.
+       */
+      result_t
+      arrive_and_drop (void);
+
+      /**
+       * @brief Get the number of arrivals in each phase.
+       * @par Parameters
+       *  None.
+       * @return The number of arrivals expected in the following phases.
+       */
+      count_t
+      expected (void) const;
+
+      /**
+       * @brief Get the number of arrivals still expected.
+       * @par Parameters
+       *  None.
+       * @return The number of arrivals needed to end
+       *  the current phase.
+       */
+      count_t
+      pending (void) const;
+
+      /**
+       * @brief Get the current phase.
+       * @par Parameters
+       *  None.
+       * @return The number of phases ended since construction,
+       *  modulo the size of `phase_t`.
+       */
+      phase_t
+      phase (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      result_t
+      internal_arrive_ (phase_t* phase, count_t update, count_t drop);
+
+      result_t
+      internal_wait_ (phase_t phase, bool timed, clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list list_;
+      clock* clock_ = nullptr;
+
+      completion_t completion_ = nullptr;
+      void* completion_args_ = nullptr;
+
+      // Can be updated in different thread contexts.
+      volatile count_t expected_ = 0;
+      // Can be updated in different thread contexts.
+      volatile count_t pending_ = 0;
+      // Can be updated in different thread contexts.
+      volatile phase_t phase_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    barrier::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * This constructor shall initialise a barrier object
+     * expecting _expected_ arrivals in each phase,
+     * with attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline
+    barrier::barrier (count_t expected, const attributes& attr) :
+        barrier
+          { nullptr, expected, nullptr, nullptr, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * This constructor shall initialise a named barrier object
+     * expecting _expected_ arrivals in each phase,
+     * with attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline
+    barrier::barrier (const char* name, count_t expected,
+                      const attributes& attr) :
+        barrier
+          { name, expected, nullptr, nullptr, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Identical barriers should have the same memory address.
+     */
+    inline bool
+    barrier::operator== (const barrier& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline barrier::count_t
+    barrier::expected (void) const
+    {
+      return expected_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline barrier::count_t
+    barrier::pending (void) const
+    {
+      return pending_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline barrier::phase_t
+    barrier::phase (void) const
+    {
+      return phase_;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_BARRIER_H_ */
@@ -233,6 +233,42 @@ extern "C"
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+  /**
+   * @brief Update the CPU load averages.
+   * @retval true The sampling period elapsed and the averages
+   *  were updated.
+   * @retval false It is too early, nothing was done.
+   */
+  bool
+  os_sched_stat_sample_cpu_load (void);
+
+  /**
+   * @brief Get the total CPU load.
+   * @param [in] window The averaging window.
+   * @return The average load of all threads except idle,
+   *  in hundredths of a percent.
+   */
+  os_statistics_load_t
+  os_sched_stat_get_cpu_load (os_statistics_load_window_t window);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+  /**
+   * @brief Get the number of coalesced reschedule requests.
+   * @return Integer with the number of reschedule requests
+   *  made by interrupt handlers which were served by an
+   *  already requested switch, since scheduler start.
+   */
+  os_statistics_counter_t
+  os_sched_stat_get_coalesced_reschedules (void);
+
+#endif
+
   /**
    * @}
    */
@@ -253,6 +289,16 @@ extern "C"
   bool
   os_irq_in_handler_mode (void);
 
+  /**
+   * @brief Issue the reschedule requested by an interrupt handler.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_irq_handler_exit (void);
+
   /**
    * @brief Enter an interrupts critical section.
    * @par Parameters
@@ -434,6 +480,58 @@ extern "C"
   os_flags_mask_t
   os_this_thread_flags_get (os_flags_mask_t mask, os_flags_mode_t mode);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) || defined(__DOXYGEN__)
+
+  /**
+   * @brief Wait for a thread notification.
+   * @param [out] ovalue Pointer where to store the notification
+   *  value, before clearing; may be `NULL`.
+   * @param [in] clear The bits to clear in the notification value.
+   * @retval os_ok A notification was received.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EINTR The operation was interrupted.
+   */
+  os_result_t
+  os_this_thread_notify_wait (os_notify_value_t* ovalue,
+                              os_notify_value_t clear);
+
+  /**
+   * @brief Timed wait for a thread notification.
+   * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+   * @param [out] ovalue Pointer where to store the notification
+   *  value, before clearing; may be `NULL`.
+   * @param [in] clear The bits to clear in the notification value.
+   * @retval os_ok A notification was received.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval ETIMEDOUT No notification was received in time.
+   * @retval EINTR The operation was interrupted.
+   */
+  os_result_t
+  os_this_thread_notify_timed_wait (os_clock_duration_t timeout,
+                                    os_notify_value_t* ovalue,
+                                    os_notify_value_t clear);
+
+  /**
+   * @brief Take the thread notification value, as a counter.
+   * @param [in] clear If true, clear the value, otherwise decrement it.
+   * @return The notification value before it was cleared or
+   *  decremented, or zero if interrupted.
+   */
+  os_notify_value_t
+  os_this_thread_notify_take (bool clear);
+
+  /**
+   * @brief Timed take the thread notification value, as a counter.
+   * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+   * @param [in] clear If true, clear the value, otherwise decrement it.
+   * @return The notification value before it was cleared or
+   *  decremented, or zero if the timeout expired or if interrupted.
+   */
+  os_notify_value_t
+  os_this_thread_notify_timed_take (os_clock_duration_t timeout, bool clear);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
   /**
    * @}
    */
@@ -522,8 +620,10 @@ extern "C"
    * @param [in] thread Pointer to thread object instance.
    * @return Null terminated string.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   const char*
   os_thread_get_name (os_thread_t* thread);
+#endif
 
   /**
    * @brief Get the thread current scheduling priority.
@@ -545,6 +645,78 @@ extern "C"
   os_result_t
   os_thread_set_priority (os_thread_t* thread, os_thread_prio_t prio);
 
+  /**
+   * @brief Get the thread preemption threshold.
+   * @param [in] thread Pointer to thread object instance.
+   * @return The thread preemption threshold. May be 0.
+   */
+  os_thread_prio_t
+  os_thread_get_preemption_threshold (os_thread_t* thread);
+
+  /**
+   * @brief Set the thread preemption threshold.
+   * @param [in] thread Pointer to thread object instance.
+   * @param [in] prio New threshold; 0 to disable it.
+   * @retval os_ok The threshold was set.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EINVAL The value of prio is invalid.
+   */
+  os_result_t
+  os_thread_set_preemption_threshold (os_thread_t* thread,
+                                      os_thread_prio_t prio);
+
+  /**
+   * @brief Get the thread affinity mask.
+   * @param [in] thread Pointer to thread object instance.
+   * @return The cores allowed to run the thread; 0 for any.
+   */
+  os_thread_affinity_t
+  os_thread_get_affinity (os_thread_t* thread);
+
+  /**
+   * @brief Set the thread affinity mask.
+   * @param [in] thread Pointer to thread object instance.
+   * @param [in] mask The cores allowed to run the thread; 0 for any.
+   * @retval os_ok The mask was set.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EINVAL The mask has no core available to the scheduler.
+   */
+  os_result_t
+  os_thread_set_affinity (os_thread_t* thread, os_thread_affinity_t mask);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+  /**
+   * @brief Set the thread CPU budget.
+   * @param [in] thread Pointer to thread object instance.
+   * @param [in] cycles The high resolution clock cycles the thread
+   *  may run in each period; 0 to remove the budget.
+   * @param [in] period_ticks The period, in scheduler ticks.
+   * @param [in] action What to do when the budget is exhausted.
+   * @param [in] demoted_prio The priority used until the end of
+   *  the period, for `os_thread_budget_action_demote`.
+   * @retval os_ok The budget was set.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EINVAL The period is 0, the action or the demoted
+   *  priority is invalid.
+   */
+  os_result_t
+  os_thread_set_cpu_budget (os_thread_t* thread,
+                            os_statistics_duration_t cycles,
+                            os_clock_duration_t period_ticks,
+                            os_thread_budget_action_t action,
+                            os_thread_prio_t demoted_prio);
+
+  /**
+   * @brief Get the number of exhausted thread CPU budgets.
+   * @param [in] thread Pointer to thread object instance.
+   * @return The number of periods when the budget was exhausted.
+   */
+  os_statistics_counter_t
+  os_thread_get_cpu_budget_overruns (os_thread_t* thread);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
   /**
    * @brief Wait for thread termination.
    * @param [in] thread Pointer to terminating thread object instance.
@@ -578,6 +750,24 @@ extern "C"
   os_thread_flags_raise (os_thread_t* thread, os_flags_mask_t mask,
                          os_flags_mask_t* oflags);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) || defined(__DOXYGEN__)
+
+  /**
+   * @brief Notify the thread.
+   * @param [in] thread Pointer to thread object instance.
+   * @param [in] value The value used by the action.
+   * @param [in] action How the notification value is updated.
+   * @retval os_ok The thread was notified.
+   * @retval EAGAIN The action is `os_notify_action_no_overwrite`
+   *  and a notification is already pending.
+   * @retval EINVAL The action is not valid.
+   */
+  os_result_t
+  os_thread_notify (os_thread_t* thread, os_notify_value_t value,
+                    os_notify_action_t action);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
   /**
    * @brief Get the thread scheduler state.
    * @param [in] thread Pointer to thread object instance.
@@ -646,6 +836,54 @@ extern "C"
   size_t
   os_thread_stack_set_default_size (size_t size_bytes);
 
+  /**
+   * @brief Get the default stack memory manager.
+   * @par Parameters
+   *  None.
+   * @return Pointer to the memory manager, or `NULL`.
+   */
+  os_memory_t*
+  os_thread_stack_get_default_resource (void);
+
+  /**
+   * @brief Set the default stack memory manager.
+   * @param [in] memory Pointer to the memory manager, or `NULL`.
+   * @return Pointer to the previous memory manager, or `NULL`.
+   */
+  os_memory_t*
+  os_thread_stack_set_default_resource (os_memory_t* memory);
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+
+  /**
+   * @brief Release all cached stacks.
+   * @par Parameters
+   *  None.
+   * @return The number of stacks released.
+   */
+  size_t
+  os_thread_stack_cache_flush (void);
+
+  /**
+   * @brief Get the number of stacks taken from the cache.
+   * @par Parameters
+   *  None.
+   * @return A long integer with the number of hits.
+   */
+  os_statistics_counter_t
+  os_thread_stack_get_cache_hits (void);
+
+  /**
+   * @brief Get the number of stacks not found in the cache.
+   * @par Parameters
+   *  None.
+   * @return A long integer with the number of misses.
+   */
+  os_statistics_counter_t
+  os_thread_stack_get_cache_misses (void);
+
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
+
   /**
    * @brief Get the min stack size.
    * @par Parameters
@@ -695,6 +933,14 @@ extern "C"
   size_t
   os_thread_stack_get_available (os_thread_stack_t* stack);
 
+  /**
+   * @brief Get the peak stack usage, incrementally.
+   * @param [in] stack Pointer to stack object instance.
+   * @return Number of used bytes, at the deepest known level.
+   */
+  size_t
+  os_thread_stack_get_peak (os_thread_stack_t* stack);
+
   /**
    * @brief Check if bottom magic word is still there.
    * @param [in] stack Pointer to stack object instance.
@@ -747,6 +993,88 @@ extern "C"
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+  /**
+   * @brief Get the thread CPU load.
+   * @param [in] thread Pointer to thread object instance.
+   * @param [in] window The averaging window.
+   * @return The average load, in hundredths of a percent.
+   */
+  os_statistics_load_t
+  os_thread_stat_get_cpu_load (os_thread_t* thread,
+                               os_statistics_load_window_t window);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+
+  /**
+   * @brief Get the shortest thread ready to running latency.
+   * @return A long integer with the number of high resolution
+   * clock cycles.
+   */
+  os_statistics_duration_t
+  os_thread_stat_get_ready_latency_min (os_thread_t* thread);
+
+  /**
+   * @brief Get the longest thread ready to running latency.
+   * @return A long integer with the number of high resolution
+   * clock cycles.
+   */
+  os_statistics_duration_t
+  os_thread_stat_get_ready_latency_max (os_thread_t* thread);
+
+  /**
+   * @brief Get the thread ready to running latency histogram.
+   * @return Pointer to an array of
+   * `OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS` counters.
+   */
+  const uint32_t*
+  os_thread_stat_get_ready_latency_histogram (os_thread_t* thread);
+
+  /**
+   * @brief Clear the thread ready to running latency statistics.
+   * @return Nothing.
+   */
+  void
+  os_thread_stat_clear_ready_latency (os_thread_t* thread);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+  /**
+   * @brief Get the number of thread missed deadlines.
+   * @return A long integer with the number of earliest deadline
+   * first jobs completed after their deadline.
+   */
+  os_statistics_counter_t
+  os_thread_stat_get_deadline_misses (os_thread_t* thread);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+  /**
+   * @brief Check if the thread owns a live FPU context.
+   * @retval true The thread context is saved with extended frames.
+   * @retval false The thread did not use the FPU.
+   */
+  bool
+  os_thread_stat_is_fpu_context_live (os_thread_t* thread);
+
+  /**
+   * @brief Get the number of switches with an FPU context.
+   * @return A long integer with the number of times the thread
+   * was switched out with an extended frame.
+   */
+  os_statistics_counter_t
+  os_thread_stat_get_fpu_context_switches (os_thread_t* thread);
+
+#endif
+
   /**
    * @}
    */
@@ -1263,8 +1591,10 @@ extern "C"
    * @param [in] mutex Pointer to mutex object instance.
    * @return Null terminated string.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   const char*
   os_mutex_get_name (os_mutex_t* mutex);
+#endif
 
   /**
    * @brief Lock/acquire the mutex.
@@ -1389,32 +1719,40 @@ extern "C"
    * @param [in] mutex Pointer to mutex object instance.
    * @return Pointer to thread or `NULL` if not owned.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   os_thread_t*
   os_mutex_get_owner (os_mutex_t* mutex);
+#endif
 
   /**
    * @brief Get the mutex type.
    * @param [in] mutex Pointer to mutex object instance.
    * @return An integer encoding the @ref os::rtos::mutex::type.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   os_mutex_type_t
   os_mutex_get_type (os_mutex_t* mutex);
+#endif
 
   /**
    * @brief Get the mutex protocol.
    * @param [in] mutex Pointer to mutex object instance.
    * @return An integer encoding the @ref os::rtos::mutex::protocol.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   os_mutex_protocol_t
   os_mutex_get_protocol (os_mutex_t* mutex);
+#endif
 
   /**
    * @brief Get the mutex robustness.
    * @param [in] mutex Pointer to mutex object instance.
    * @return An integer encoding the @ref os::rtos::mutex::robustness.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   os_mutex_robustness_t
   os_mutex_get_robustness (os_mutex_t* mutex);
+#endif
 
   /**
    * @brief Reset the mutex.
@@ -1798,8 +2136,10 @@ extern "C"
    * @param [in] semaphore Pointer to semaphore object instance.
    * @return Null terminated string.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   const char*
   os_semaphore_get_name (os_semaphore_t* semaphore);
+#endif
 
   /**
    * @brief Post (unlock) the semaphore.
@@ -1863,8 +2203,10 @@ extern "C"
    * @param [in] semaphore Pointer to semaphore object instance.
    * @return The semaphore count value.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   os_semaphore_count_t
   os_semaphore_get_value (os_semaphore_t* semaphore);
+#endif
 
   /**
    * @brief Reset the semaphore.
@@ -1880,16 +2222,20 @@ extern "C"
    * @param [in] semaphore Pointer to semaphore object instance.
    * @return The numeric value set from attributes.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   os_semaphore_count_t
   os_semaphore_get_initial_value (os_semaphore_t* semaphore);
+#endif
 
   /**
    * @brief Get the semaphore maximum count value.
    * @param [in] semaphore Pointer to semaphore object instance.
    * @return The numeric value set from attributes.
    */
+#if !defined(OS_USE_RTOS_C_API_INLINE) || defined(__DOXYGEN__)
   os_semaphore_count_t
   os_semaphore_get_max_value (os_semaphore_t* semaphore);
+#endif
 
   /**
    * @}
@@ -1905,6 +2251,189 @@ extern "C"
 #define os_semaphore_counting_create os_semaphore_counting_construct
 #define os_semaphore_destroy os_semaphore_destruct
 
+  /**
+   * @}
+   */
+
+  /**
+   * @}
+   */
+
+  // --------------------------------------------------------------------------
+  /**
+   * @addtogroup cmsis-plus-rtos-c-rwlock
+   * @{
+   */
+
+  /**
+   * @name Read-Write Lock Attributes Functions
+   * @{
+   */
+
+  /**
+   * @brief Initialise the read-write lock attributes.
+   * @param [in] attr Pointer to read-write lock attributes object instance.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_rwlock_attr_init (os_rwlock_attr_t* attr);
+
+  /**
+   * @}
+   */
+
+  /**
+   * @name Read-Write Lock Creation Functions
+   * @{
+   */
+
+  /**
+   * @brief Construct a statically allocated read-write lock object instance.
+   * @param [in] rwlock Pointer to read-write lock object instance storage.
+   * @param [in] name Pointer to name (may be NULL).
+   * @param [in] attr Pointer to attributes (may be NULL).
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_rwlock_construct (os_rwlock_t* rwlock, const char* name,
+                       const os_rwlock_attr_t* attr);
+
+  /**
+   * @brief Destruct the statically allocated read-write lock object instance.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_rwlock_destruct (os_rwlock_t* rwlock);
+
+  /**
+   * @brief Allocate a read-write lock object instance and construct it.
+   * @param [in] name Pointer to name (may be NULL).
+   * @param [in] attr Pointer to attributes (may be NULL).
+   * @return Pointer to new read-write lock object instance.
+   */
+  os_rwlock_t*
+  os_rwlock_new (const char* name, const os_rwlock_attr_t* attr);
+
+  /**
+   * @brief Destruct the read-write lock object instance and deallocate it.
+   * @param [in] rwlock Pointer to dynamically allocated object instance.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_rwlock_delete (os_rwlock_t* rwlock);
+
+  /**
+   * @}
+   */
+
+  /**
+   * @name Read-Write Lock Functions
+   * @{
+   */
+
+  /**
+   * @brief Get the read-write lock name.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @return Null terminated string.
+   */
+  const char*
+  os_rwlock_get_name (os_rwlock_t* rwlock);
+
+  /**
+   * @brief Lock for reading, possibly waiting.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @retval os_ok The lock was acquired for reading.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EDEADLK The current thread already owns the lock for writing.
+   * @retval EINTR The operation was interrupted.
+   */
+  os_result_t
+  os_rwlock_read_lock (os_rwlock_t* rwlock);
+
+  /**
+   * @brief Try to lock for reading.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @retval os_ok The lock was acquired for reading.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EWOULDBLOCK The lock is owned by a writer, or writers
+   *  are waiting.
+   * @retval EAGAIN The maximum number of readers was reached.
+   */
+  os_result_t
+  os_rwlock_try_read_lock (os_rwlock_t* rwlock);
+
+  /**
+   * @brief Timed lock for reading.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @param [in] timeout Timeout to wait.
+   * @retval os_ok The lock was acquired for reading.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EDEADLK The current thread already owns the lock for writing.
+   * @retval ETIMEDOUT The lock could not be acquired before
+   *  the specified timeout expired.
+   * @retval EINTR The operation was interrupted.
+   */
+  os_result_t
+  os_rwlock_timed_read_lock (os_rwlock_t* rwlock, os_clock_duration_t timeout);
+
+  /**
+   * @brief Lock for writing, possibly waiting.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @retval os_ok The lock was acquired for writing.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EDEADLK The current thread already owns the lock for writing.
+   * @retval EINTR The operation was interrupted.
+   */
+  os_result_t
+  os_rwlock_write_lock (os_rwlock_t* rwlock);
+
+  /**
+   * @brief Try to lock for writing.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @retval os_ok The lock was acquired for writing.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EWOULDBLOCK The lock is owned by readers or by a writer.
+   */
+  os_result_t
+  os_rwlock_try_write_lock (os_rwlock_t* rwlock);
+
+  /**
+   * @brief Timed lock for writing.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @param [in] timeout Timeout to wait.
+   * @retval os_ok The lock was acquired for writing.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+   * @retval EDEADLK The current thread already owns the lock for writing.
+   * @retval ETIMEDOUT The lock could not be acquired before
+   *  the specified timeout expired.
+   * @retval EINTR The operation was interrupted.
+   */
+  os_result_t
+  os_rwlock_timed_write_lock (os_rwlock_t* rwlock, os_clock_duration_t timeout);
+
+  /**
+   * @brief Unlock the read-write lock.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @retval os_ok The lock was released.
+   * @retval EPERM Cannot be invoked from an Interrupt Service Routines;
+   *  or the lock is not owned by the current thread.
+   */
+  os_result_t
+  os_rwlock_unlock (os_rwlock_t* rwlock);
+
+  /**
+   * @brief Get the number of readers.
+   * @param [in] rwlock Pointer to read-write lock object instance.
+   * @return The number of threads owning the lock for reading.
+   */
+  os_rwlock_count_t
+  os_rwlock_get_readers (os_rwlock_t* rwlock);
+
   /**
    * @}
    */
@@ -2039,6 +2568,50 @@ extern "C"
   os_result_t
   os_mempool_free (os_mempool_t* mempool, void* block);
 
+  /**
+   * @brief Allocate a batch of memory blocks.
+   * @param [in] mempool Pointer to memory pool object instance.
+   * @param [in] count The maximum number of blocks to allocate.
+   * @param [out] blocks Array of at least `count` pointers.
+   * @return The number of blocks allocated, or 0 if interrupted.
+   */
+  size_t
+  os_mempool_alloc_n (os_mempool_t* mempool, size_t count, void* blocks[]);
+
+  /**
+   * @brief Try to allocate a batch of memory blocks.
+   * @param [in] mempool Pointer to memory pool object instance.
+   * @param [in] count The maximum number of blocks to allocate.
+   * @param [out] blocks Array of at least `count` pointers.
+   * @return The number of blocks allocated, possibly 0.
+   */
+  size_t
+  os_mempool_try_alloc_n (os_mempool_t* mempool, size_t count,
+                          void* blocks[]);
+
+  /**
+   * @brief Allocate a batch of memory blocks with timeout.
+   * @param [in] mempool Pointer to memory pool object instance.
+   * @param [in] count The maximum number of blocks to allocate.
+   * @param [out] blocks Array of at least `count` pointers.
+   * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+   * @return The number of blocks allocated, or 0 if timeout.
+   */
+  size_t
+  os_mempool_timed_alloc_n (os_mempool_t* mempool, size_t count,
+                            void* blocks[], os_clock_duration_t timeout);
+
+  /**
+   * @brief Free a batch of memory blocks.
+   * @param [in] mempool Pointer to memory pool object instance.
+   * @param [in] count The number of blocks to free.
+   * @param [in] blocks Array of `count` pointers to memory blocks.
+   * @retval os_ok The memory blocks were released.
+   * @retval EINVAL A block does not belong to the memory pool.
+   */
+  os_result_t
+  os_mempool_free_n (os_mempool_t* mempool, size_t count, void* blocks[]);
+
   /**
    * @brief Get memory pool capacity.
    * @param [in] mempool Pointer to memory pool object instance.
@@ -2394,6 +2967,69 @@ extern "C"
   os_result_t
   os_mqueue_reset (os_mqueue_t* mqueue);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+  /**
+   * @brief Get the maximum queue depth.
+   * @param [in] mqueue Pointer to message queue object instance.
+   * @return The largest number of messages ever in the queue.
+   */
+  size_t
+  os_mqueue_stat_get_depth_max (os_mqueue_t* mqueue);
+
+  /**
+   * @brief Get the number of blocked sends.
+   * @param [in] mqueue Pointer to message queue object instance.
+   * @return The number of sends which had to wait.
+   */
+  os_statistics_counter_t
+  os_mqueue_stat_get_send_blocked (os_mqueue_t* mqueue);
+
+  /**
+   * @brief Get the number of blocked receives.
+   * @param [in] mqueue Pointer to message queue object instance.
+   * @return The number of receives which had to wait.
+   */
+  os_statistics_counter_t
+  os_mqueue_stat_get_receive_blocked (os_mqueue_t* mqueue);
+
+  /**
+   * @brief Get the number of received messages.
+   * @param [in] mqueue Pointer to message queue object instance.
+   * @return The number of messages included in the latency.
+   */
+  os_statistics_counter_t
+  os_mqueue_stat_get_received (os_mqueue_t* mqueue);
+
+  /**
+   * @brief Get the total time spent by messages in the queue.
+   * @param [in] mqueue Pointer to message queue object instance.
+   * @return A long integer with the number of high resolution
+   * clock cycles.
+   */
+  os_statistics_duration_t
+  os_mqueue_stat_get_latency_total (os_mqueue_t* mqueue);
+
+  /**
+   * @brief Get the longest time spent by a message in the queue.
+   * @param [in] mqueue Pointer to message queue object instance.
+   * @return A long integer with the number of high resolution
+   * clock cycles.
+   */
+  os_statistics_duration_t
+  os_mqueue_stat_get_latency_max (os_mqueue_t* mqueue);
+
+  /**
+   * @brief Clear the message queue statistics.
+   * @param [in] mqueue Pointer to message queue object instance.
+   * @return Nothing.
+   */
+  void
+  os_mqueue_stat_clear (os_mqueue_t* mqueue);
+
+#endif
+
   /**
    * @}
    */
@@ -2666,6 +3302,36 @@ extern "C"
   os_memory_deallocate (os_memory_t* memory, void* addr, size_t bytes,
                         size_t alignment);
 
+  /**
+   * @brief Allocate a block of memory, using the emergency reserve
+   *  if needed.
+   * @param memory Pointer to a memory resource object instance.
+   * @param bytes Number of bytes to allocate.
+   * @param alignment Integer (power of 2) with alignment constraints.
+   */
+  void*
+  os_memory_allocate_critical (os_memory_t* memory, size_t bytes,
+                               size_t alignment);
+
+  /**
+   * @brief Set the size of the emergency reserve.
+   * @param memory Pointer to a memory resource object instance.
+   * @param bytes Number of bytes, or 0 to release the reserve.
+   * @retval true The reserve was allocated.
+   * @retval false There is not enough memory now.
+   */
+  bool
+  os_memory_set_emergency_reserve (os_memory_t* memory, size_t bytes);
+
+  /**
+   * @brief Ask the registered shrinkers to release memory.
+   * @param memory Pointer to a memory resource object instance.
+   * @param bytes Number of bytes needed.
+   * @return Number of bytes released.
+   */
+  size_t
+  os_memory_reclaim (os_memory_t* memory, size_t bytes);
+
   /**
    * @brief Reset the memory manager to the initial state.
    * @param memory Pointer to a memory resource object instance.
@@ -2736,6 +3402,82 @@ extern "C"
  * @}
  */
 
+  // --------------------------------------------------------------------------
+
+#if defined(OS_USE_RTOS_C_API_INLINE)
+
+  /*
+   * Opaque accessors defined inline, reading directly the C
+   * structures; the layout is checked against the C++ classes
+   * in `os-c-wrapper.cpp`.
+   */
+
+  static inline const char*
+  os_thread_get_name (os_thread_t* thread)
+  {
+    return thread->name;
+  }
+
+  static inline const char*
+  os_mutex_get_name (os_mutex_t* mutex)
+  {
+    return mutex->name;
+  }
+
+  static inline os_thread_t*
+  os_mutex_get_owner (os_mutex_t* mutex)
+  {
+    return (os_thread_t*) mutex->owner;
+  }
+
+  static inline os_mutex_type_t
+  os_mutex_get_type (os_mutex_t* mutex)
+  {
+    return mutex->type;
+  }
+
+  static inline os_mutex_protocol_t
+  os_mutex_get_protocol (os_mutex_t* mutex)
+  {
+    return mutex->protocol;
+  }
+
+  static inline os_mutex_robustness_t
+  os_mutex_get_robustness (os_mutex_t* mutex)
+  {
+    return mutex->robustness;
+  }
+
+  static inline const char*
+  os_semaphore_get_name (os_semaphore_t* semaphore)
+  {
+    return semaphore->name;
+  }
+
+  static inline os_semaphore_count_t
+  os_semaphore_get_value (os_semaphore_t* semaphore)
+  {
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+    return (semaphore->count > 0) ? semaphore->count : 0;
+#else
+    return semaphore->count;
+#endif
+  }
+
+  static inline os_semaphore_count_t
+  os_semaphore_get_initial_value (os_semaphore_t* semaphore)
+  {
+    return semaphore->initial_count;
+  }
+
+  static inline os_semaphore_count_t
+  os_semaphore_get_max_value (os_semaphore_t* semaphore)
+  {
+    return semaphore->max_count;
+  }
+
+#endif /* defined(OS_USE_RTOS_C_API_INLINE) */
+
 // --------------------------------------------------------------------------
 #ifdef  __cplusplus
 }
@@ -50,6 +50,58 @@
 
 // ----------------------------------------------------------------------------
 
+// Must be available to both C and C++, since they size arrays
+// in the thread structures. Keep in sync with os-decls.h.
+#if !defined(OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS)
+#define OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS (16)
+#endif
+
+// The CPU budgets are enforced by the reference scheduler, and the
+// snapshots use its idle thread.
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+#undef OS_INCLUDE_RTOS_THREAD_CPU_BUDGET
+#undef OS_INCLUDE_RTOS_SNAPSHOT
+#endif
+
+// The snapshot grace periods use the thread context switches.
+#if defined(OS_INCLUDE_RTOS_SNAPSHOT) \
+  && !defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES
+#endif
+
+// The CPU load and the CPU budgets use the thread CPU cycles.
+#if (defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) \
+  || defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)) \
+  && !defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES
+#endif
+
+#if !defined(OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS)
+#define OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS        (4)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS)
+#define OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS           (4)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_TLS_SLOTS)
+#define OS_INTEGER_RTOS_THREAD_TLS_SLOTS                    (0)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES)
+#define OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES          (0)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS)
+#define OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS      (0)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCK_SIZE_BYTES)
+#define OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCK_SIZE_BYTES (32)
+#endif
+
+// ----------------------------------------------------------------------------
+
 #ifdef  __cplusplus
 extern "C"
 {
@@ -65,6 +117,18 @@ extern "C"
 
   typedef os_internal_double_list_links_t os_internal_threads_waiting_list_t;
 
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+  typedef struct os_internal_footprint_node_s
+  {
+    os_internal_double_list_links_t links;
+    const char* kind;
+    const void* object;
+    void* describe;
+  } os_internal_footprint_node_t;
+
+#endif
+
   typedef struct os_internal_thread_children_list_s
   {
     os_internal_double_list_links_t links;
@@ -74,11 +138,24 @@ extern "C"
   {
     os_internal_double_list_links_t links;
     void* thread;
+    uint32_t flags_mask;
+    uint32_t flags_mode;
   } os_internal_waiting_thread_node_t;
 
   typedef struct os_internal_clock_timestamps_list_s
   {
+#if !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL)
     os_internal_double_list_links_t links;
+#else
+    os_internal_double_list_links_t slots[OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS][1
+        << OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS];
+    os_internal_double_list_links_t overflow;
+    uint32_t maps[OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS];
+    os_port_clock_timestamp_t now;
+#endif /* !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL) */
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+    size_t max_expired;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
   } os_internal_clock_timestamps_list_t;
 
   /**
@@ -149,6 +226,41 @@ extern "C"
 
   // --------------------------------------------------------------------------
 
+  /**
+   * @brief Type of variables holding thread notification values.
+   *
+   * @see os::rtos::notify::value_t
+   */
+  typedef uint32_t os_notify_value_t;
+
+  /**
+   * @brief Type of variables holding thread notification actions.
+   *
+   * @see os::rtos::notify::action_t
+   */
+  typedef uint8_t os_notify_action_t;
+
+  /**
+   * @brief Thread notification actions.
+   *
+   * @see os::rtos::notify::action
+   */
+  enum
+  {
+    os_notify_action_none = 0, //
+    os_notify_action_set_bits = 1, //
+    os_notify_action_increment = 2, //
+    os_notify_action_overwrite = 3, //
+    os_notify_action_no_overwrite = 4, //
+  };
+
+  /**
+   * Special value to represent all notification bits.
+   */
+#define os_notify_all 0xFFFFFFFF
+
+  // --------------------------------------------------------------------------
+
   /**
    * @brief Type of variables holding scheduler state codes.
    *
@@ -243,6 +355,67 @@ extern "C"
    */
   typedef uint64_t os_statistics_duration_t;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+  /**
+   * @brief Type of variables holding CPU loads, in hundredths of a percent.
+   *
+   * @see os::rtos::statistics::load_t
+   */
+  typedef uint16_t os_statistics_load_t;
+
+  /**
+   * @brief Type of variables holding CPU load window indices.
+   *
+   * @see os::rtos::statistics::load_window_t
+   */
+  typedef uint8_t os_statistics_load_window_t;
+
+  /**
+   * @brief CPU load averaging windows.
+   *
+   * @see os::rtos::statistics::load_window
+   */
+  enum
+  {
+    os_statistics_load_window_one_second = 0,
+    os_statistics_load_window_ten_seconds = 1,
+    os_statistics_load_window_one_minute = 2,
+    os_statistics_load_window_count = 3
+  };
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+  /**
+   * @brief Synchronisation object statistics storage.
+   *
+   * @see os::rtos::statistics::sync
+   */
+  typedef struct os_statistics_sync_s
+  {
+    /**
+     * @cond ignore
+     */
+
+    os_internal_double_list_links_t links;
+    void* object;
+    os_statistics_counter_t acquired;
+    os_statistics_counter_t contended;
+    os_statistics_duration_t wait_total;
+    os_statistics_duration_t wait_max;
+    os_statistics_duration_t hold_max;
+    os_statistics_duration_t hold_begin;
+
+    /**
+     * @endcond
+     */
+
+  } os_statistics_sync_t;
+
+#endif
+
   /**
    * @}
    */
@@ -349,6 +522,38 @@ extern "C"
    */
   typedef uint8_t os_thread_state_t;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+  /**
+   * @brief An enumeration with all possible CPU budget actions.
+   *
+   * @see os::rtos::thread::budget_action
+   */
+  enum
+  {
+    /**
+     * @brief Only count the overrun and call the hook.
+     */
+    os_thread_budget_action_report = 0,
+    /**
+     * @brief Lower the priority until the next period.
+     */
+    os_thread_budget_action_demote = 1,
+    /**
+     * @brief Do not run the thread until the next period.
+     */
+    os_thread_budget_action_suspend = 2
+  };
+
+  /**
+   * @brief Type of variables holding CPU budget actions.
+   *
+   * @see os::rtos::thread::budget_action_t
+   */
+  typedef uint8_t os_thread_budget_action_t;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
   /**
    * @brief Type of variables holding thread priorities.
    *
@@ -363,6 +568,15 @@ extern "C"
    */
   typedef uint8_t os_thread_prio_t;
 
+  /**
+   * @brief Type of variables holding thread affinity masks.
+   * @details
+   * Bit n stands for core n; 0 means any core.
+   *
+   * @see os::rtos::thread::affinity_t
+   */
+  typedef uint32_t os_thread_affinity_t;
+
   // --------------------------------------------------------------------------
 
   /**
@@ -407,6 +621,7 @@ extern "C"
 
     void* stack_addr;
     size_t stack_size_bytes;
+    void* stack_watermark;
 
     /**
      * @endcond
@@ -433,6 +648,10 @@ extern "C"
     os_thread_stack_t stack;
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
     os_port_thread_context_t port;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT)
+    os_statistics_counter_t fpu_context_switches;
+    bool fpu_context_live;
+#endif
 #endif
 
     /**
@@ -442,7 +661,9 @@ extern "C"
   } os_thread_context_t;
 
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
-  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 
   /**
    * @brief Thread statistics.
@@ -468,6 +689,22 @@ extern "C"
     os_statistics_duration_t cpu_cycles;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+    os_statistics_duration_t cpu_load_cycles;
+    uint32_t cpu_load[3];
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+    os_statistics_duration_t ready_timestamp;
+    os_statistics_duration_t ready_latency_min;
+    os_statistics_duration_t ready_latency_max;
+    uint32_t ready_latency_histogram[OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS];
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+    os_statistics_counter_t deadline_misses;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
     /**
      * @endcond
      */
@@ -533,6 +770,62 @@ extern "C"
      */
     os_thread_prio_t th_priority;
 
+    /**
+     * @brief Thread time slice, in scheduler ticks.
+     *
+     * @details
+     * If 0, the thread is not time sliced.
+     *
+     * The default is `OS_INTEGER_RTOS_THREAD_QUANTUM_TICKS`.
+     */
+    os_clock_duration_t th_quantum_ticks;
+
+    /**
+     * @brief Thread preemption threshold.
+     *
+     * @details
+     * While running, the thread can be preempted only by threads
+     * with a priority higher than the threshold.
+     *
+     * If 0, the thread can be preempted by any higher priority thread.
+     */
+    os_thread_prio_t th_preemption_threshold;
+
+    /**
+     * @brief Name of the memory region for the thread stack.
+     */
+    const char* th_stack_region;
+
+    /**
+     * @brief Memory manager for the thread stack.
+     */
+    void* th_stack_resource;
+
+    /**
+     * @brief Thread affinity mask.
+     *
+     * @details
+     * If 0, any core.
+     */
+    os_thread_affinity_t th_affinity;
+
+    /**
+     * @brief Earliest deadline first period, in scheduler ticks.
+     *
+     * @details
+     * If 0, the thread is scheduled by fixed priority only.
+     */
+    os_clock_duration_t th_period_ticks;
+
+    /**
+     * @brief Earliest deadline first relative deadline, in
+     * scheduler ticks.
+     *
+     * @details
+     * If 0, the deadline is the period.
+     */
+    os_clock_duration_t th_deadline_ticks;
+
   } os_thread_attr_t;
 
   /**
@@ -561,6 +854,28 @@ extern "C"
     const char* name;
     int errno_; // Prevent the macro to expand (for example with a prefix).
     os_internal_waiting_thread_node_t ready_node;
+    os_thread_state_t state;
+    os_thread_prio_t prio_assigned;
+    os_thread_prio_t prio_inherited;
+    os_thread_prio_t preemption_threshold;
+    bool interrupted;
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+    os_clock_duration_t quantum_ticks;
+    os_clock_duration_t quantum_remaining;
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+    void* waiting_node;
+    void* clock_node;
+    void* clock;
+    os_internal_evflags_t event_flags;
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+    os_notify_value_t notify_value;
+    bool notify_pending;
+    bool notify_waiting;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+    os_thread_port_data_t port;
+#endif
+    os_thread_context_t context;
     os_thread_func_t func;
     os_thread_func_args_t func_args;
     void* func_result_;
@@ -569,32 +884,49 @@ extern "C"
     os_internal_thread_children_list_t children;
     os_internal_double_list_links_t mutexes;
     void* joiner;
-    void* waiting_node;
-    void* clock_node;
-    void* clock;
     void* allocator;
+    void* allocated_stack_resource;
     void* allocted_stack_address;
-    size_t acquired_mutexes;
     size_t allocated_stack_size_elements;
-    os_thread_state_t state;
-    os_thread_prio_t prio_assigned;
-    os_thread_prio_t prio_inherited;
-    bool interrupted;
-    os_internal_evflags_t event_flags;
+    size_t acquired_mutexes;
+    os_thread_affinity_t affinity;
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+    os_clock_duration_t period_ticks;
+    os_clock_duration_t deadline_ticks;
+    os_clock_timestamp_t deadline;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+    os_internal_double_list_links_t budget_links;
+    os_clock_timestamp_t budget_period_end;
+    os_statistics_duration_t budget_cycles;
+    os_statistics_duration_t budget_used;
+    os_statistics_counter_t budget_overruns;
+    os_clock_duration_t budget_period_ticks;
+    os_thread_prio_t budget_saved_prio;
+    os_thread_prio_t budget_demoted_prio;
+    os_thread_budget_action_t budget_action;
+    bool budget_exhausted;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
 #if defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE)
     os_thread_user_storage_t user_storage; //
 #endif /* defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE) */
 
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+    void* tls[OS_INTEGER_RTOS_THREAD_TLS_SLOTS];
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+    void* allocation_cache[OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS];
+    size_t allocation_cache_count;
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
-  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
     os_thread_statistics_t statistics;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
 
-#if defined(OS_USE_RTOS_PORT_SCHEDULER)
-    os_thread_port_data_t port;
-#endif
-    os_thread_context_t context;
-
     /**
      * @endcond
      */
@@ -639,6 +971,7 @@ extern "C"
     os_internal_clock_timestamps_list_t steady_list;
     os_clock_duration_t sleep_count;
     os_clock_timestamp_t steady_count;
+    uint32_t sequence;
 
     /**
      * @endcond
@@ -743,6 +1076,16 @@ extern "C"
      */
     os_timer_type_t tm_type;
 
+    /**
+     * @brief Run the timer function on the timer daemon thread.
+     */
+    bool tm_run_in_thread;
+
+    /**
+     * @brief Timer slack, in clock units.
+     */
+    os_clock_duration_t tm_slack;
+
   } os_timer_attr_t;
 
   /**
@@ -774,12 +1117,18 @@ extern "C"
     void* clock;
     os_internal_clock_timer_node_t clock_node;
     os_clock_duration_t period;
+    os_clock_duration_t slack;
+    os_clock_timestamp_t deadline;
 #endif
 #if defined(OS_USE_RTOS_PORT_TIMER)
     os_timer_port_data_t port_;
 #endif
     os_timer_type_t type;
     os_timer_state_t state;
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+    bool run_in_thread;
+    bool deferred;
+#endif
 
     /**
      * @endcond
@@ -928,6 +1277,13 @@ extern "C"
      */
     os_mutex_count_t mx_max_count;
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN)
+    /**
+     * @brief Mutex spin count.
+     */
+    uint32_t mx_spin_count;
+#endif
+
   } os_mutex_attr_t;
 
   /**
@@ -973,6 +1329,18 @@ extern "C"
     os_mutex_protocol_t protocol;
     os_mutex_robustness_t robustness;
     os_mutex_count_t max_count;
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+    uint32_t spin_count;
+    uint32_t spin_successes;
+    uint32_t spin_failures;
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+    os_statistics_sync_t sync_statistics;
+#endif
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+    os_internal_footprint_node_t footprint_node;
+#endif
 
     /**
      * @endcond
@@ -1037,7 +1405,11 @@ extern "C"
     const char* name;
 #if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
     os_internal_threads_waiting_list_t list;
-    // void* clock;
+    void* clock;
+    void* mutex;
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+    os_statistics_sync_t sync_statistics;
 #endif
 
     /**
@@ -1125,9 +1497,12 @@ extern "C"
 #if defined(OS_USE_RTOS_PORT_SEMAPHORE)
     os_semaphore_port_data_t port;
 #endif
+    os_semaphore_count_t max_count;
     os_semaphore_count_t initial_count;
     os_semaphore_count_t count;
-    os_semaphore_count_t max_count;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+    os_statistics_sync_t sync_statistics;
+#endif
 
     /**
      * @endcond
@@ -1135,6 +1510,82 @@ extern "C"
 
   } os_semaphore_t;
 
+#pragma GCC diagnostic pop
+
+  /**
+   * @}
+   */
+
+  // ==========================================================================
+  /**
+   * @addtogroup cmsis-plus-rtos-c-rwlock
+   * @{
+   */
+
+  /**
+   * @brief Type of variables holding read-write lock readers counts.
+   *
+   * @see os::rtos::rwlock::count_t
+   */
+  typedef uint16_t os_rwlock_count_t;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  /**
+   * @brief Read-write lock attributes.
+   * @headerfile os-c-api.h <cmsis-plus/rtos/os-c-api.h>
+   *
+   * @details
+   * Initialise this structure with `os_rwlock_attr_init()` and then
+   * set any of the individual members directly.
+   *
+   * @see os::rtos::rwlock::attributes
+   */
+  typedef struct os_rwlock_attr_s
+  {
+    /**
+     * @brief Pointer to clock object instance.
+     */
+    void* clock;
+
+  } os_rwlock_attr_t;
+
+  /**
+   * @brief Read-write lock object storage.
+   * @headerfile os-c-api.h <cmsis-plus/rtos/os-c-api.h>
+   *
+   * @details
+   * This C structure has the same size as the C++ `os::rtos::rwlock`
+   * object and must be initialised with `os_rwlock_construct()`.
+   *
+   * Later on a pointer to it can be used both in C and C++
+   * to refer to the read-write lock object instance.
+   *
+   * The members of this structure are hidden and should not
+   * be used directly, but only through specific functions.
+   *
+   * @see os::rtos::rwlock
+   */
+  typedef struct os_rwlock_s
+  {
+    /**
+     * @cond ignore
+     */
+
+    const char* name;
+    os_internal_threads_waiting_list_t readers_list;
+    os_internal_threads_waiting_list_t writers_list;
+    void* clock;
+    void* writer;
+    os_rwlock_count_t readers;
+
+    /**
+     * @endcond
+     */
+
+  } os_rwlock_t;
+
 #pragma GCC diagnostic pop
 
   /**
@@ -1179,6 +1630,11 @@ extern "C"
      */
     size_t mp_pool_size_bytes;
 
+    /**
+     * @brief Name of the memory region for the memory pool area.
+     */
+    const char* mp_pool_region;
+
   } os_mempool_attr_t;
 
   /**
@@ -1212,6 +1668,7 @@ extern "C"
     void* pool_addr;
     void* allocated_pool_addr;
     void* allocator;
+    void* allocated_pool_resource;
 #if defined(OS_USE_RTOS_PORT_MEMORY_POOL)
     os_mempool_port_data_t port;
 #endif
@@ -1220,7 +1677,16 @@ extern "C"
     os_mempool_size_t blocks;
     os_mempool_size_t block_size_bytes;
     os_mempool_size_t count;
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+    void* free_list_addr;
+    size_t free_list_block_size_bytes;
+    uint32_t free_list_head;
+#else
     void* first;
+#endif
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+    os_internal_footprint_node_t footprint_node;
+#endif
 
     /**
      * @endcond
@@ -1286,8 +1752,47 @@ extern "C"
      */
     size_t mq_queue_size_bytes;
 
+    /**
+     * @brief Store the actual length of each message.
+     */
+    bool mq_store_lengths;
+
+    /**
+     * @brief Name of the memory region for the message queue area.
+     */
+    const char* mq_queue_region;
+
   } os_mqueue_attr_t;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+  /**
+   * @brief Message queue statistics storage.
+   *
+   * @see os::rtos::message_queue::statistics
+   */
+  typedef struct os_mqueue_statistics_s
+  {
+    /**
+     * @cond ignore
+     */
+
+    os_statistics_counter_t send_blocked;
+    os_statistics_counter_t receive_blocked;
+    os_statistics_counter_t received;
+    os_statistics_duration_t latency_total;
+    os_statistics_duration_t latency_max;
+    os_mqueue_size_t depth_max;
+
+    /**
+     * @endcond
+     */
+
+  } os_mqueue_statistics_t;
+
+#endif
+
   /**
    * @brief Message queue object storage.
    * @headerfile os-c-api.h <cmsis-plus/rtos/os-c-api.h>
@@ -1319,12 +1824,17 @@ extern "C"
     os_mqueue_index_t* prev_array;
     os_mqueue_index_t* next_array;
     os_mqueue_prio_t* prio_array;
+    os_mqueue_msg_size_t* len_array;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+    uint32_t* stamp_array;
+#endif
     void* first_free;
 #endif
 
     void* queue_addr;
     void* allocated_queue_addr;
     void* allocator;
+    void* allocated_queue_resource;
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
     os_mqueue_port_data_t port;
@@ -1339,6 +1849,16 @@ extern "C"
     os_mqueue_size_t count;
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
     os_mqueue_index_t head;
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+    uint32_t prio_map[(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES + 31) / 32];
+    os_mqueue_index_t prio_tails[OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES];
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+    os_mqueue_statistics_t statistics;
+#endif
+#endif
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+    os_internal_footprint_node_t footprint_node;
 #endif
 
     /**
@@ -1347,6 +1867,48 @@ extern "C"
 
   } os_mqueue_t;
 
+  /**
+   * @brief Type of mailbox indices and counters.
+   *
+   * @see os::rtos::mailbox_base::index_t
+   */
+  typedef uint16_t os_mailbox_index_t;
+
+  /**
+   * @brief Mailbox object storage.
+   * @headerfile os-c-api.h <cmsis-plus/rtos/os-c-api.h>
+   *
+   * @details
+   * This C structure has the same size as the C++
+   * `os::rtos::mailbox_base` object; it is used by the legacy
+   * CMSIS-RTOS mail queues.
+   *
+   * The members of this structure are hidden and should not
+   * be used directly.
+   *
+   * @see os::rtos::mailbox_base
+   */
+  typedef struct os_mailbox_s
+  {
+    /**
+     * @cond ignore
+     */
+
+    const char* name;
+    os_internal_threads_waiting_list_t send_list;
+    os_internal_threads_waiting_list_t receive_list;
+    void* clock;
+    void** ring;
+    os_mailbox_index_t capacity;
+    os_mailbox_index_t head;
+    os_mailbox_index_t count;
+
+    /**
+     * @endcond
+     */
+
+  } os_mailbox_t;
+
 #pragma GCC diagnostic pop
 
   /**
@@ -1414,6 +1976,9 @@ extern "C"
 #endif
 
     os_internal_evflags_t flags;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+    os_statistics_sync_t sync_statistics;
+#endif
 
     /**
      * @endcond
@@ -1450,6 +2015,23 @@ extern "C"
   void
   os_rtc_handler (void);
 
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+
+  /**
+   * @brief High resolution clock compare channel interrupt handler.
+   */
+  void
+  os_hrclock_compare_handler (void);
+
+#endif
+
+  /**
+   * @brief Account the SysTick ticks lost while sleeping.
+   * @param [in] ticks Number of ticks not counted by the SysTick handler.
+   */
+  void
+  os_systick_update_for_slept_ticks (os_clock_duration_t ticks);
+
   /**
    * @}
    */
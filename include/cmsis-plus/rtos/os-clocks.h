@@ -178,6 +178,9 @@ namespace os
        *  None.
        * @return The clock current steady timestamp (time units from startup).
        */
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+      virtual
+#endif
       timestamp_t
       steady_now (void);
 
@@ -185,12 +188,14 @@ namespace os
        * @brief Sleep for a relative duration.
        * @param [in] duration The number of clock units
        *  (ticks or seconds) to sleep.
+       * @param [in] slack How many clock units the wakeup may be
+       *  delayed, to share it with other timeouts.
        * @retval ETIMEDOUT The sleep lasted the entire duration.
        * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
        * @retval EINTR The sleep was interrupted.
        */
       result_t
-      sleep_for (duration_t duration);
+      sleep_for (duration_t duration, duration_t slack = 0);
 
       /**
        * @brief Sleep until an absolute timestamp.
@@ -205,13 +210,15 @@ namespace os
       /**
        * @brief Timed wait for an event.
        * @param [in] timeout The timeout in clock units.
+       * @param [in] slack How many clock units the timeout may be
+       *  delayed, to share the wakeup with other timeouts.
        * @retval result::ok An event occurred before the timeout.
        * @retval ETIMEDOUT The wait lasted the entire duration.
        * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
        * @retval EINTR The sleep was interrupted.
        */
       result_t
-      wait_for (duration_t timeout);
+      wait_for (duration_t timeout, duration_t slack = 0);
 
       /**
        * @brief Increase the internal count after a deep sleep.
@@ -221,6 +228,41 @@ namespace os
       timestamp_t
       update_for_slept_time (duration_t duration);
 
+      /**
+       * @brief Delay a timestamp to a coalescing boundary.
+       * @param [in] timestamp The absolute moment in time, in clock units.
+       * @param [in] slack How many clock units the timestamp may be
+       *  delayed.
+       * @return The timestamp, rounded up to a multiple of the
+       *  largest power of two not above `slack + 1`.
+       */
+      static timestamp_t
+      coalesce (timestamp_t timestamp, duration_t slack);
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+      /**
+       * @brief Get the maximum number of timeouts expired on one tick.
+       * @par Parameters
+       *  None.
+       * @return The number of thread timeouts and timers expired
+       *  together, since startup or the last reset.
+       */
+      std::size_t
+      max_expired_per_tick (void);
+
+      /**
+       * @brief Reset the maximum number of timeouts expired on one tick.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      max_expired_per_tick_reset (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
+
       /**
        * @cond ignore
        */
@@ -251,6 +293,53 @@ namespace os
       void
       internal_check_timestamps (void);
 
+      timestamp_t
+      internal_steady_duration_to_next (void);
+
+      /**
+       * @brief Start a lock free read of the count.
+       * @par Parameters
+       *  None.
+       * @return The sequence to pass to `internal_read_retry_()`.
+       */
+      uint32_t
+      internal_read_begin_ (void) const;
+
+      /**
+       * @brief Check if the count changed while being read.
+       * @param [in] seq The value returned by `internal_read_begin_()`.
+       * @retval true The read must be repeated.
+       * @retval false The value read is consistent.
+       */
+      bool
+      internal_read_retry_ (uint32_t seq) const;
+
+      /**
+       * @brief Start a change of the count.
+       * @details
+       * Called with interrupts disabled.
+       */
+      void
+      internal_write_begin_ (void);
+
+      /**
+       * @brief End a change of the count.
+       */
+      void
+      internal_write_end_ (void);
+
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+
+      /**
+       * @brief Arm the hardware for the earliest timestamp, if needed.
+       * @details
+       * Called with interrupts disabled, after linking a node.
+       */
+      virtual void
+      internal_program_compare (void);
+
+#endif
+
       /**
        * @endcond
        */
@@ -276,6 +365,18 @@ namespace os
       internal_wait_until_ (timestamp_t timestamp,
                             internal::clock_timestamps_list& list);
 
+      /**
+       * @brief Queue a node of the current thread and wait for it.
+       * @param node Reference to a node with the time stamp set.
+       * @param list Reference to the clock list.
+       * @retval result::ok The wait was performed.
+       */
+      result_t
+      internal_wait_node_ (internal::timeout_thread_node& node,
+                           internal::clock_timestamps_list& list);
+
+      friend class this_thread::periodic;
+
       /**
        * @endcond
        */
@@ -298,6 +399,13 @@ namespace os
        */
       timestamp_t volatile steady_count_ = 0;
 
+      /**
+       * @brief Incremented before and after each change of the count,
+       *  odd while changing; lets readers detect a torn read
+       *  and retry, instead of disabling the interrupts.
+       */
+      uint32_t volatile sequence_ = 0;
+
       /**
        * @endcond
        */
@@ -760,9 +868,46 @@ namespace os
       uint32_t
       input_clock_frequency_hz (void);
 
+      /**
+       * @brief Tell the current time, in nanoseconds.
+       * @par Parameters
+       *  None.
+       * @return The number of nanoseconds since startup, from the
+       *  tick count and the cycles since the last tick, read together.
+       */
+      uint64_t
+      nanoseconds (void);
+
+      /**
+       * @brief Convert a number of input clock cycles to nanoseconds.
+       * @param [in] cycles The number of cycles.
+       * @return The number of nanoseconds.
+       */
+      uint64_t
+      cycles_to_nanoseconds (timestamp_t cycles);
+
       void
       internal_increment_count (void);
 
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+
+      /**
+       * @brief Tell the current time since startup, with cycle resolution.
+       * @par Parameters
+       *  None.
+       * @return The number of input clock cycles since startup.
+       */
+      virtual timestamp_t
+      steady_now (void) override;
+
+      void
+      internal_check_timestamps (void);
+
+      virtual void
+      internal_program_compare (void) override;
+
+#endif
+
       /**
        * @}
        */
@@ -775,10 +920,36 @@ namespace os
        * @{
        */
 
+      /**
+       * @brief Compute the conversion factor for a frequency.
+       * @param [in] hz The input clock frequency.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_update_conversion_ (uint32_t hz);
+
       /**
        * @}
        */
 
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // The frequency the factor was computed for.
+      uint32_t conversion_hz_ = 0;
+
+      // Nanoseconds per cycle, as a 32.32 fixed point value.
+      uint32_t ns_per_cycle_int_ = 0;
+      uint32_t ns_per_cycle_frac_ = 0;
+
+      /**
+       * @endcond
+       */
     };
 
     /**
@@ -812,6 +983,57 @@ namespace os
       ;
     }
 
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * All timestamps with a similar slack are rounded to the same
+     * grid, so independent timeouts that fall in the same window
+     * expire on the same tick and are handled by a single wakeup.
+     * The result is never earlier than `timestamp` and never later
+     * than `timestamp + slack`.
+     */
+    inline clock::timestamp_t
+    clock::coalesce (timestamp_t timestamp, duration_t slack)
+    {
+      timestamp_t granule = 1;
+      while (granule <= (static_cast<timestamp_t> (slack) + 1) / 2)
+        {
+          granule <<= 1;
+        }
+      return (timestamp + granule - 1) & ~(granule - 1);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Each check of the steady list runs in a critical section in
+     * the tick interrupt, so this number bounds the ISR
+     * duration. Only the steady list is accounted.
+     */
+    inline std::size_t
+    clock::max_expired_per_tick (void)
+    {
+      return steady_list_.max_expired ();
+    }
+
+    /**
+     * @cond ignore
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
+
     inline internal::clock_timestamps_list&
     __attribute__((always_inline))
     clock::steady_list (void)
@@ -823,8 +1045,44 @@ namespace os
     __attribute__((always_inline))
     clock::internal_increment_count (void)
     {
+      internal_write_begin_ ();
       // One more tick count passed.
       ++steady_count_;
+      internal_write_end_ ();
+    }
+
+    inline uint32_t
+    __attribute__((always_inline))
+    clock::internal_read_begin_ (void) const
+    {
+      uint32_t seq = sequence_;
+      // Keep the reads of the count after this.
+      __atomic_signal_fence (__ATOMIC_ACQUIRE);
+      return seq;
+    }
+
+    inline bool
+    __attribute__((always_inline))
+    clock::internal_read_retry_ (uint32_t seq) const
+    {
+      __atomic_signal_fence (__ATOMIC_ACQUIRE);
+      return ((seq & 1) != 0) || (seq != sequence_);
+    }
+
+    inline void
+    __attribute__((always_inline))
+    clock::internal_write_begin_ (void)
+    {
+      ++sequence_;
+      __atomic_signal_fence (__ATOMIC_RELEASE);
+    }
+
+    inline void
+    __attribute__((always_inline))
+    clock::internal_write_end_ (void)
+    {
+      __atomic_signal_fence (__ATOMIC_RELEASE);
+      ++sequence_;
     }
 
     inline void
@@ -896,8 +1154,10 @@ namespace os
     __attribute__((always_inline))
     clock_highres::internal_increment_count (void)
     {
+      internal_write_begin_ ();
       // Increment the highres count by SysTick divisor.
       steady_count_ += port::clock_highres::cycles_per_tick ();
+      internal_write_end_ ();
     }
 
     inline uint32_t
@@ -33,6 +33,7 @@
 #if defined(__cplusplus)
 
 #include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-clocks.h>
 
 // ----------------------------------------------------------------------------
 
@@ -152,6 +153,19 @@ namespace os
       condition_variable (const char* name,
                           const attributes& attr = initializer);
 
+#if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+
+      /**
+       * @brief Construct a constant initialised condition variable
+       *  object instance.
+       * @param [in] tag The `static_init` tag.
+       * @param [in] name Pointer to name.
+       */
+      constexpr
+      condition_variable (static_init_t tag, const char* name);
+
+#endif /* !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE) */
+
       /**
        * @cond ignore
        */
@@ -270,6 +284,52 @@ namespace os
       result_t
       timed_wait (mutex& mutex, clock::duration_t timeout);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+      /**
+       * @brief Get the contention statistics.
+       * @par Parameters
+       *  None.
+       * @return Reference to the statistics.
+       */
+      statistics::sync&
+      sync_statistics (void);
+
+#endif
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+#if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+
+      /**
+       * @brief Internal function used to move waiting threads
+       *  to the mutex waiting list.
+       * @param all If true, move all threads, otherwise only one.
+       * @retval true The waiting threads were moved.
+       * @retval false The remaining threads must be resumed.
+       */
+      bool
+      internal_requeue_ (bool all);
+
+#endif
+
+      /**
+       * @endcond
+       */
+
       /**
        * @}
        */
@@ -287,7 +347,14 @@ namespace os
 
 #if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
       internal::waiting_threads_list list_;
-      // clock& clock_;
+      clock* clock_ = nullptr;
+      // The mutex passed by the waiting threads, if any.
+      mutex* mutex_ = nullptr;
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      statistics::sync sync_statistics_
+        { this };
 #endif
 
       /**
@@ -318,6 +385,40 @@ namespace os
 
     // ========================================================================
 
+#if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+
+    /**
+     * @details
+     * This constructor shall initialise a condition variable object
+     * with the default attributes (timeouts on `sysclock`).
+     *
+     * The constructor can be evaluated at compile time; condition
+     * variables with static storage duration constructed with it
+     * are laid out already initialised, and do not run any code
+     * at startup.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    constexpr
+    condition_variable::condition_variable (static_init_t tag,
+                                            const char* name) :
+        object_named_system
+          { name }, //
+        list_
+          { tag }, //
+        clock_
+          { &sysclock }
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+            , //
+        sync_statistics_
+          { tag, this }
+#endif
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE) */
+
     /**
      * @details
      * Identical condition variables should have the same memory address.
@@ -328,6 +429,20 @@ namespace os
       return this == &rhs;
     }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline statistics::sync&
+    condition_variable::sync_statistics (void)
+    {
+      return sync_statistics_;
+    }
+
+#endif
+
   } /* namespace rtos */
 } /* namespace os */
 
@@ -0,0 +1,1271 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_COROUTINE_H_
+#define CMSIS_PLUS_RTOS_OS_COROUTINE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// The coroutines require C++20; with older standards this
+// header is silently ignored.
+#if defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+#include <coroutine>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace coroutine
+    {
+      // ======================================================================
+
+      class executor;
+      class task;
+      class task_promise;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Base of the coroutine **awaitables**.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       *
+       * @details
+       * Awaitables live in the coroutine frame and, while the
+       * coroutine is suspended, their node is linked to the waiting
+       * list of the object, on behalf of the executor thread.
+       * They can be awaited only from coroutines returning `task`.
+       */
+      class awaiter
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an awaiter not associated with an object.
+         * @par Parameters
+         *  None.
+         */
+        awaiter (void);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        awaiter (const awaiter&) = delete;
+        awaiter (awaiter&&) = delete;
+        awaiter&
+        operator= (const awaiter&) = delete;
+        awaiter&
+        operator= (awaiter&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the awaiter.
+         */
+        virtual
+        ~awaiter ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Always go through `await_suspend()`.
+         * @par Parameters
+         *  None.
+         * @retval false Always.
+         */
+        bool
+        await_ready (void) const noexcept;
+
+        /**
+         * @brief Try the operation, and if it would block, hand the
+         *  coroutine to the executor.
+         * @param [in] handle The awaiting coroutine.
+         * @retval true The coroutine is suspended.
+         * @retval false The operation completed, continue at once.
+         */
+        bool
+        await_suspend (std::coroutine_handle<task_promise> handle) noexcept;
+
+        /**
+         * @brief Get the result of the operation.
+         * @par Parameters
+         *  None.
+         * @retval result::ok The operation completed.
+         * @retval ETIMEDOUT The timeout expired.
+         */
+        result_t
+        await_resume (void) const noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class executor;
+
+        // Try the operation without blocking, in a critical section.
+        virtual bool
+        internal_try_ (void);
+
+        // Start operations completed by callbacks, which call
+        // executor::post(); return false if not started.
+        virtual bool
+        internal_start_ (void);
+
+        // Links in the executor lists.
+        utils::double_list_links links_;
+
+        // Linked to the object list, on behalf of the executor thread.
+        internal::waiting_thread_node node_;
+        internal::waiting_threads_list* list_ = nullptr;
+
+        executor* executor_ = nullptr;
+        std::coroutine_handle<> handle_;
+
+        clock::duration_t timeout_ = 0;
+        clock::timestamp_t deadline_ = 0;
+        result_t result_ = result::ok;
+        bool timed_ = false;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Awaitable semaphore wait.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       */
+      class semaphore_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Wait for the semaphore.
+         * @param [in] sem Reference to the semaphore.
+         */
+        semaphore_awaiter (semaphore& sem);
+
+        /**
+         * @brief Wait for the semaphore, with timeout.
+         * @param [in] sem Reference to the semaphore.
+         * @param [in] timeout Timeout to wait, in clock units.
+         */
+        semaphore_awaiter (semaphore& sem, clock::duration_t timeout);
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        virtual bool
+        internal_try_ (void) override;
+
+        semaphore& sem_;
+
+        /**
+         * @endcond
+         */
+      };
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      /**
+       * @brief Awaitable message queue receive.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       */
+      class receive_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Receive a message from the queue.
+         * @param [in] mq Reference to the message queue.
+         * @param [out] msg The address where to store the message.
+         * @param [in] nbytes The size of the buffer.
+         * @param [out] mprio The address where to store the
+         *  message priority; may be `nullptr`.
+         */
+        receive_awaiter (message_queue& mq, void* msg, std::size_t nbytes,
+                         message_queue::priority_t* mprio = nullptr);
+
+        /**
+         * @brief Receive a message from the queue, with timeout.
+         * @param [in] mq Reference to the message queue.
+         * @param [out] msg The address where to store the message.
+         * @param [in] nbytes The size of the buffer.
+         * @param [in] timeout Timeout to wait, in clock units.
+         * @param [out] mprio The address where to store the
+         *  message priority; may be `nullptr`.
+         */
+        receive_awaiter (message_queue& mq, void* msg, std::size_t nbytes,
+                         clock::duration_t timeout,
+                         message_queue::priority_t* mprio = nullptr);
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        virtual bool
+        internal_try_ (void) override;
+
+        message_queue& mq_;
+        void* msg_;
+        std::size_t nbytes_;
+        message_queue::priority_t* mprio_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @brief Awaitable message queue send.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       */
+      class send_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Send a message to the queue.
+         * @param [in] mq Reference to the message queue.
+         * @param [in] msg The address of the message.
+         * @param [in] nbytes The length of the message.
+         * @param [in] mprio The message priority.
+         */
+        send_awaiter (message_queue& mq, const void* msg, std::size_t nbytes,
+                      message_queue::priority_t mprio =
+                          message_queue::default_priority);
+
+        /**
+         * @brief Send a message to the queue, with timeout.
+         * @param [in] mq Reference to the message queue.
+         * @param [in] msg The address of the message.
+         * @param [in] nbytes The length of the message.
+         * @param [in] timeout Timeout to wait, in clock units.
+         * @param [in] mprio The message priority.
+         */
+        send_awaiter (message_queue& mq, const void* msg, std::size_t nbytes,
+                      clock::duration_t timeout,
+                      message_queue::priority_t mprio =
+                          message_queue::default_priority);
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        virtual bool
+        internal_try_ (void) override;
+
+        message_queue& mq_;
+        const void* msg_;
+        std::size_t nbytes_;
+        message_queue::priority_t mprio_;
+
+        /**
+         * @endcond
+         */
+      };
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+      /**
+       * @brief Awaitable event flags wait.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       */
+      class event_flags_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Wait for event flags.
+         * @param [in] evf Reference to the event flags.
+         * @param [in] mask The expected flags (OR-ed bit-mask);
+         *  if `flags::any`, any flag raised will do it.
+         * @param [out] oflags Pointer where to store the current flags;
+         *  may be `nullptr`.
+         * @param [in] mode Mode bits to select if either all or any
+         *  flags are expected, and if the flags should be cleared.
+         */
+        event_flags_awaiter (event_flags& evf, flags::mask_t mask,
+                             flags::mask_t* oflags = nullptr,
+                             flags::mode_t mode = flags::mode::all
+                                 | flags::mode::clear);
+
+        /**
+         * @brief Wait for event flags, with timeout.
+         * @param [in] evf Reference to the event flags.
+         * @param [in] mask The expected flags (OR-ed bit-mask);
+         *  if `flags::any`, any flag raised will do it.
+         * @param [in] timeout Timeout to wait, in clock units.
+         * @param [out] oflags Pointer where to store the current flags;
+         *  may be `nullptr`.
+         * @param [in] mode Mode bits to select if either all or any
+         *  flags are expected, and if the flags should be cleared.
+         */
+        event_flags_awaiter (event_flags& evf, flags::mask_t mask,
+                             clock::duration_t timeout,
+                             flags::mask_t* oflags = nullptr,
+                             flags::mode_t mode = flags::mode::all
+                                 | flags::mode::clear);
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        virtual bool
+        internal_try_ (void) override;
+
+        event_flags& evf_;
+        flags::mask_t mask_;
+        flags::mask_t* oflags_;
+        flags::mode_t mode_;
+
+        /**
+         * @endcond
+         */
+      };
+
+#endif /* !defined(OS_USE_RTOS_PORT_EVENT_FLAGS) */
+
+      /**
+       * @brief Awaitable sleep.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       */
+      class sleep_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Sleep for a duration.
+         * @param [in] duration The number of clock units to sleep.
+         */
+        sleep_awaiter (clock::duration_t duration);
+      };
+
+      // ======================================================================
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Semaphore wait in a coroutine.
+       * @param [in] sem Reference to the semaphore.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      semaphore_awaiter
+      wait (semaphore& sem);
+
+      /**
+       * @brief Timed semaphore wait in a coroutine.
+       * @param [in] sem Reference to the semaphore.
+       * @param [in] timeout Timeout to wait, in clock units.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      semaphore_awaiter
+      timed_wait (semaphore& sem, clock::duration_t timeout);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      /**
+       * @brief Message queue receive in a coroutine.
+       * @param [in] mq Reference to the message queue.
+       * @param [out] msg The address where to store the message.
+       * @param [in] nbytes The size of the buffer.
+       * @param [out] mprio The address where to store the
+       *  message priority; may be `nullptr`.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      receive_awaiter
+      receive (message_queue& mq, void* msg, std::size_t nbytes,
+               message_queue::priority_t* mprio = nullptr);
+
+      /**
+       * @brief Timed message queue receive in a coroutine.
+       * @param [in] mq Reference to the message queue.
+       * @param [out] msg The address where to store the message.
+       * @param [in] nbytes The size of the buffer.
+       * @param [in] timeout Timeout to wait, in clock units.
+       * @param [out] mprio The address where to store the
+       *  message priority; may be `nullptr`.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      receive_awaiter
+      timed_receive (message_queue& mq, void* msg, std::size_t nbytes,
+                     clock::duration_t timeout,
+                     message_queue::priority_t* mprio = nullptr);
+
+      /**
+       * @brief Message queue send in a coroutine.
+       * @param [in] mq Reference to the message queue.
+       * @param [in] msg The address of the message.
+       * @param [in] nbytes The length of the message.
+       * @param [in] mprio The message priority.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      send_awaiter
+      send (message_queue& mq, const void* msg, std::size_t nbytes,
+            message_queue::priority_t mprio = message_queue::default_priority);
+
+      /**
+       * @brief Timed message queue send in a coroutine.
+       * @param [in] mq Reference to the message queue.
+       * @param [in] msg The address of the message.
+       * @param [in] nbytes The length of the message.
+       * @param [in] timeout Timeout to wait, in clock units.
+       * @param [in] mprio The message priority.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      send_awaiter
+      timed_send (message_queue& mq, const void* msg, std::size_t nbytes,
+                  clock::duration_t timeout, message_queue::priority_t mprio =
+                      message_queue::default_priority);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+      /**
+       * @brief Event flags wait in a coroutine.
+       * @param [in] evf Reference to the event flags.
+       * @param [in] mask The expected flags (OR-ed bit-mask).
+       * @param [out] oflags Pointer where to store the current flags;
+       *  may be `nullptr`.
+       * @param [in] mode Mode bits to select if either all or any
+       *  flags are expected, and if the flags should be cleared.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      event_flags_awaiter
+      wait (event_flags& evf, flags::mask_t mask, flags::mask_t* oflags =
+                nullptr,
+            flags::mode_t mode = flags::mode::all | flags::mode::clear);
+
+      /**
+       * @brief Timed event flags wait in a coroutine.
+       * @param [in] evf Reference to the event flags.
+       * @param [in] mask The expected flags (OR-ed bit-mask).
+       * @param [in] timeout Timeout to wait, in clock units.
+       * @param [out] oflags Pointer where to store the current flags;
+       *  may be `nullptr`.
+       * @param [in] mode Mode bits to select if either all or any
+       *  flags are expected, and if the flags should be cleared.
+       * @return An awaitable; `co_await` returns a `result_t`.
+       */
+      event_flags_awaiter
+      timed_wait (event_flags& evf, flags::mask_t mask,
+                  clock::duration_t timeout, flags::mask_t* oflags = nullptr,
+                  flags::mode_t mode = flags::mode::all | flags::mode::clear);
+
+#endif /* !defined(OS_USE_RTOS_PORT_EVENT_FLAGS) */
+
+      /**
+       * @brief Sleep in a coroutine.
+       * @param [in] duration The number of clock units to sleep.
+       * @return An awaitable; like `clock::sleep_for()`,
+       *  `co_await` returns `ETIMEDOUT`.
+       */
+      sleep_awaiter
+      sleep_for (clock::duration_t duration);
+
+      // ======================================================================
+
+      /**
+       * @brief Promise of the coroutine tasks.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       *
+       * @details
+       * The coroutines start suspended and run only after being
+       * passed to `executor::spawn()`; the frames are allocated
+       * from the default memory resource.
+       */
+      class task_promise
+      {
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        task
+        get_return_object (void) noexcept;
+
+        static task
+        get_return_object_on_allocation_failure (void) noexcept;
+
+        std::suspend_always
+        initial_suspend (void) const noexcept;
+
+        std::suspend_always
+        final_suspend (void) const noexcept;
+
+        void
+        return_void (void) const noexcept;
+
+        void
+        unhandled_exception (void) const noexcept;
+
+        static void*
+        operator new (std::size_t bytes) noexcept;
+
+        static void
+        operator delete (void* addr, std::size_t bytes) noexcept;
+
+        /**
+         * @endcond
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class executor;
+        friend class awaiter;
+
+        executor* executor_ = nullptr;
+
+        // Posted by spawn() to start the coroutine.
+        awaiter start_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @brief **Coroutine task**, run by an executor.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       *
+       * @details
+       * The return type of the coroutines; it owns the coroutine
+       * frame until it is passed to `executor::spawn()`.
+       */
+      class task
+      {
+      public:
+
+        /**
+         * @brief Type of the coroutine promise.
+         */
+        using promise_type = task_promise;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Move the coroutine to another task.
+         * @param [in] other The task to move from.
+         */
+        task (task&& other) noexcept;
+
+        /**
+         * @cond ignore
+         */
+
+        task (const task&) = delete;
+        task&
+        operator= (const task&) = delete;
+        task&
+        operator= (task&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the task.
+         * @details
+         * If the task was not spawned, the coroutine is destroyed.
+         */
+        ~task ();
+
+        /**
+         * @}
+         */
+
+        /**
+         * @brief Check if the task has a coroutine.
+         * @par Parameters
+         *  None.
+         * @retval true The task can be spawned.
+         * @retval false The coroutine frame could not be allocated,
+         *  or the task was already spawned.
+         */
+        bool
+        valid (void) const;
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class task_promise;
+        friend class executor;
+
+        explicit
+        task (std::coroutine_handle<task_promise> handle) noexcept;
+
+        std::coroutine_handle<task_promise> handle_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief **Coroutine executor**, running coroutines on a
+       *  single thread.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       */
+      class executor : public internal::object_named_system
+      {
+      public:
+
+        // ====================================================================
+
+        /**
+         * @brief Executor attributes.
+         * @headerfile os.h <cmsis-plus/rtos/os.h>
+         * @ingroup cmsis-plus-rtos-coroutine
+         */
+        class attributes : public internal::attributes_clocked
+        {
+        public:
+
+          /**
+           * @name Constructors & Destructor
+           * @{
+           */
+
+          /**
+           * @brief Construct an executor attributes object instance.
+           * @par Parameters
+           *  None.
+           */
+          constexpr
+          attributes ();
+
+          // The rule of five.
+          attributes (const attributes&) = default;
+          attributes (attributes&&) = default;
+          attributes&
+          operator= (const attributes&) = default;
+          attributes&
+          operator= (attributes&&) = default;
+
+          /**
+           * @brief Destruct the executor attributes object instance.
+           */
+          ~attributes () = default;
+
+          /**
+           * @}
+           */
+
+        public:
+
+          /**
+           * @name Public Member Variables
+           * @{
+           */
+
+          // Public members; no accessors and mutators required.
+
+          /**
+           * @brief Address of the user defined storage for the
+           *  executor thread stack.
+           * @details
+           * If `nullptr`, the default is to dynamically allocate
+           * the stack.
+           */
+          void* th_stack_address = nullptr;
+
+          /**
+           * @brief Size of the executor thread stack, in bytes.
+           * @details
+           * If 0, the default is `thread::stack::default_size()`.
+           */
+          std::size_t th_stack_size_bytes = 0;
+
+          /**
+           * @brief Executor thread priority.
+           */
+          thread::priority_t th_priority =
+              OS_INTEGER_RTOS_COROUTINE_EXECUTOR_PRIORITY;
+
+          // Add more attributes here.
+
+          /**
+           * @}
+           */
+
+        }; /* class attributes */
+
+        /**
+         * @brief Default executor initialiser.
+         */
+        static const attributes initializer;
+
+        // ====================================================================
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an executor object instance.
+         * @param [in] attr Reference to attributes.
+         */
+        executor (const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named executor object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] attr Reference to attributes.
+         */
+        executor (const char* name, const attributes& attr = initializer);
+
+        /**
+         * @cond ignore
+         */
+
+      protected:
+
+        executor (const char* name, void* stack_address,
+                  std::size_t stack_size_bytes, const attributes& attr);
+
+      public:
+
+        // The rule of five.
+        executor (const executor&) = delete;
+        executor (executor&&) = delete;
+        executor&
+        operator= (const executor&) = delete;
+        executor&
+        operator= (executor&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the executor object instance.
+         */
+        virtual
+        ~executor ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Start a coroutine.
+         * @param [in] t The task returned by the coroutine.
+         * @retval result::ok The coroutine will be resumed by the
+         *  executor thread.
+         * @retval ENOMEM The task has no coroutine; the frame could
+         *  not be allocated, or the task was already spawned.
+         */
+        result_t
+        spawn (task&& t);
+
+        /**
+         * @brief Resume a coroutine suspended on an awaiter
+         *  completed by a callback.
+         * @param [in] aw Reference to the awaiter.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        post (awaiter& aw);
+
+        /**
+         * @brief Get the number of coroutines not yet finished.
+         * @par Parameters
+         *  None.
+         * @return The number of coroutines.
+         */
+        std::size_t
+        tasks (void) const;
+
+        /**
+         * @brief Get the executor thread.
+         * @par Parameters
+         *  None.
+         * @return A reference to the executor thread.
+         */
+        thread&
+        worker (void);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class awaiter;
+
+        using awaiters_list = utils::intrusive_list<awaiter,
+        utils::double_list_links, &awaiter::links_>;
+
+        static void*
+        internal_run_ (void* args);
+
+        static thread::attributes
+        internal_thread_attributes_ (const attributes& attr,
+                                     void* stack_address,
+                                     std::size_t stack_size_bytes);
+
+        bool
+        internal_suspend_ (awaiter& aw);
+
+        bool
+        internal_collect_ (clock::timestamp_t now,
+                           clock::timestamp_t* deadline);
+
+        void
+        internal_sleep_ (bool timed, clock::timestamp_t deadline);
+
+        void
+        internal_resume_ready_ (void);
+
+        void
+        internal_destroy_all_ (void);
+
+        /**
+         * @endcond
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        clock* clock_;
+
+        // Accessed only by the executor thread.
+        awaiters_list ready_
+          { true };
+        awaiters_list waiting_
+          { true };
+
+        // Accessed from any context, in critical sections.
+        awaiters_list posted_
+          { true };
+
+        // Where the executor thread sleeps.
+        internal::waiting_threads_list wake_list_;
+        internal::waiting_thread_node wake_node_;
+
+        std::size_t tasks_ = 0;
+        bool volatile stop_ = false;
+
+        // Better be the last one.
+        thread worker_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Template of an executor with inclusive stack.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-coroutine
+       *
+       * @tparam S Executor thread stack size, in bytes.
+       */
+      template<std::size_t S = port::stack::default_size_bytes>
+        class executor_inclusive : public executor
+        {
+        public:
+
+          /**
+           * @brief Local constant based on template definition.
+           */
+          static const std::size_t stack_size_bytes = S;
+
+          /**
+           * @name Constructors & Destructor
+           * @{
+           */
+
+          /**
+           * @brief Construct an executor object instance.
+           * @param [in] attr Reference to attributes.
+           */
+          executor_inclusive (const attributes& attr = initializer);
+
+          /**
+           * @brief Construct a named executor object instance.
+           * @param [in] name Pointer to name.
+           * @param [in] attr Reference to attributes.
+           */
+          executor_inclusive (const char* name, const attributes& attr =
+                                  initializer);
+
+          /**
+           * @cond ignore
+           */
+
+          // The rule of five.
+          executor_inclusive (const executor_inclusive&) = delete;
+          executor_inclusive (executor_inclusive&&) = delete;
+          executor_inclusive&
+          operator= (const executor_inclusive&) = delete;
+          executor_inclusive&
+          operator= (executor_inclusive&&) = delete;
+
+          /**
+           * @endcond
+           */
+
+          /**
+           * @brief Destruct the executor object instance.
+           */
+          virtual
+          ~executor_inclusive ();
+
+          /**
+           * @}
+           */
+
+        protected:
+
+          /**
+           * @cond ignore
+           */
+
+          port::stack::allocation_element_t stack_storage_[(S
+              + sizeof(port::stack::allocation_element_t) - 1)
+              / sizeof(port::stack::allocation_element_t)];
+
+          /**
+           * @endcond
+           */
+
+        };
+
+#pragma GCC diagnostic pop
+
+    } /* namespace coroutine */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace coroutine
+    {
+      // ======================================================================
+
+      inline bool
+      awaiter::await_ready (void) const noexcept
+      {
+        return false;
+      }
+
+      inline result_t
+      awaiter::await_resume (void) const noexcept
+      {
+        return result_;
+      }
+
+      // ======================================================================
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      inline semaphore_awaiter
+      wait (semaphore& sem)
+      {
+        return semaphore_awaiter
+          { sem };
+      }
+
+      inline semaphore_awaiter
+      timed_wait (semaphore& sem, clock::duration_t timeout)
+      {
+        return semaphore_awaiter
+          { sem, timeout };
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      inline receive_awaiter
+      receive (message_queue& mq, void* msg, std::size_t nbytes,
+               message_queue::priority_t* mprio)
+      {
+        return receive_awaiter
+          { mq, msg, nbytes, mprio };
+      }
+
+      inline receive_awaiter
+      timed_receive (message_queue& mq, void* msg, std::size_t nbytes,
+                     clock::duration_t timeout,
+                     message_queue::priority_t* mprio)
+      {
+        return receive_awaiter
+          { mq, msg, nbytes, timeout, mprio };
+      }
+
+      inline send_awaiter
+      send (message_queue& mq, const void* msg, std::size_t nbytes,
+            message_queue::priority_t mprio)
+      {
+        return send_awaiter
+          { mq, msg, nbytes, mprio };
+      }
+
+      inline send_awaiter
+      timed_send (message_queue& mq, const void* msg, std::size_t nbytes,
+                  clock::duration_t timeout, message_queue::priority_t mprio)
+      {
+        return send_awaiter
+          { mq, msg, nbytes, timeout, mprio };
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+      inline event_flags_awaiter
+      wait (event_flags& evf, flags::mask_t mask, flags::mask_t* oflags,
+            flags::mode_t mode)
+      {
+        return event_flags_awaiter
+          { evf, mask, oflags, mode };
+      }
+
+      inline event_flags_awaiter
+      timed_wait (event_flags& evf, flags::mask_t mask,
+                  clock::duration_t timeout, flags::mask_t* oflags,
+                  flags::mode_t mode)
+      {
+        return event_flags_awaiter
+          { evf, mask, timeout, oflags, mode };
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_EVENT_FLAGS) */
+
+      inline sleep_awaiter
+      sleep_for (clock::duration_t duration)
+      {
+        return sleep_awaiter
+          { duration };
+      }
+
+      // ======================================================================
+
+      inline std::suspend_always
+      task_promise::initial_suspend (void) const noexcept
+      {
+        return
+          { };
+      }
+
+      inline std::suspend_always
+      task_promise::final_suspend (void) const noexcept
+      {
+        return
+          { };
+      }
+
+      inline void
+      task_promise::return_void (void) const noexcept
+      {
+        ;
+      }
+
+      // ======================================================================
+
+      inline
+      task::task (std::coroutine_handle<task_promise> handle) noexcept :
+          handle_
+            { handle }
+      {
+        ;
+      }
+
+      inline
+      task::task (task&& other) noexcept :
+          handle_
+            { other.handle_ }
+      {
+        other.handle_ = nullptr;
+      }
+
+      inline bool
+      task::valid (void) const
+      {
+        return static_cast<bool> (handle_);
+      }
+
+      // ======================================================================
+
+      constexpr
+      executor::attributes::attributes ()
+      {
+        ;
+      }
+
+      inline std::size_t
+      executor::tasks (void) const
+      {
+        return tasks_;
+      }
+
+      inline thread&
+      executor::worker (void)
+      {
+        return worker_;
+      }
+
+      // ======================================================================
+
+      template<std::size_t S>
+        inline
+        executor_inclusive<S>::executor_inclusive (const attributes& attr) :
+            executor_inclusive<S>
+              { nullptr, attr }
+        {
+          ;
+        }
+
+      /**
+       * @details
+       * The storage for the executor thread stack is part of the
+       * object; the attributes storage members are ignored.
+       */
+      template<std::size_t S>
+        inline
+        executor_inclusive<S>::executor_inclusive (const char* name,
+                                                   const attributes& attr) :
+            executor
+              { name, stack_storage_, sizeof(stack_storage_), attr }
+        {
+          ;
+        }
+
+      template<std::size_t S>
+        executor_inclusive<S>::~executor_inclusive ()
+        {
+          ;
+        }
+
+    } /* namespace coroutine */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_COROUTINE_H_ */
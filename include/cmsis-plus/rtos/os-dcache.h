@@ -0,0 +1,420 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_DCACHE_H_
+#define CMSIS_PLUS_RTOS_OS_DCACHE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-memory.h>
+#include <cmsis-plus/rtos/os-hooks.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Data cache maintenance for the DMA buffers.
+     * @ingroup cmsis-plus-rtos-dcache
+     *
+     * @details
+     * On devices with a data cache (like the Cortex-M7), the memory
+     * read or written by a DMA controller must be kept coherent with
+     * the cache: the dirty lines must be written back (cleaned)
+     * before a transfer reads the memory, and the stale lines must
+     * be discarded (invalidated) after a transfer writes it.
+     *
+     * With `OS_INCLUDE_RTOS_DCACHE_MAINTENANCE`, the functions call
+     * the `os_dcache_*()` hooks, with the range extended to whole
+     * cache lines; otherwise they are empty and are optimised out.
+     *
+     * Invalidating a line also discards the neighbouring data that
+     * shares it, so the receive buffers should not share cache lines
+     * with other variables; `dma_buffer` and `dcache::allocate()`
+     * provide such buffers.
+     */
+    namespace dcache
+    {
+      /**
+       * @brief The data cache line size, in bytes.
+       */
+      constexpr std::size_t line_size_bytes =
+          OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES;
+
+      /**
+       * @brief Round a size up to a multiple of the cache line.
+       * @param [in] bytes The size, in bytes.
+       * @return The rounded size.
+       */
+      constexpr std::size_t
+      align_size (std::size_t bytes);
+
+      /**
+       * @brief Write back the cache lines of a memory range.
+       * @param [in] addr The range address.
+       * @param [in] bytes The range size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clean (const void* addr, std::size_t bytes);
+
+      /**
+       * @brief Discard the cache lines of a memory range.
+       * @param [in] addr The range address.
+       * @param [in] bytes The range size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      invalidate (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Write back and discard the cache lines of a memory range.
+       * @param [in] addr The range address.
+       * @param [in] bytes The range size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clean_invalidate (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Prepare a buffer to be read by a DMA transfer.
+       * @param [in] addr The buffer address.
+       * @param [in] bytes The buffer size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      prepare_transmit (const void* addr, std::size_t bytes);
+
+      /**
+       * @brief Prepare a buffer to be written by a DMA transfer.
+       * @param [in] addr The buffer address.
+       * @param [in] bytes The buffer size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      prepare_receive (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Complete a DMA transfer that wrote a buffer.
+       * @param [in] addr The address of the received data.
+       * @param [in] bytes The received size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      complete_receive (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Allocate a cache line aligned buffer.
+       * @param [in] bytes The buffer size, in bytes.
+       * @param [in] mr Pointer to the memory resource, or `nullptr`
+       *  for the default one.
+       * @return Pointer to the buffer, or `nullptr` if out of memory.
+       */
+      void*
+      allocate (std::size_t bytes, memory::memory_resource* mr = nullptr);
+
+      /**
+       * @brief Free a buffer allocated by `dcache::allocate()`.
+       * @param [in] addr Pointer to the buffer, or `nullptr`.
+       * @param [in] bytes The buffer size, in bytes.
+       * @param [in] mr Pointer to the memory resource used to
+       *  allocate it, or `nullptr` for the default one.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      deallocate (void* addr, std::size_t bytes,
+                  memory::memory_resource* mr = nullptr);
+
+      // ======================================================================
+
+      /**
+       * @brief Statically allocated **DMA buffer**.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-dcache
+       *
+       * @tparam N The buffer size, in bytes.
+       *
+       * @details
+       * The storage is aligned to the cache line and its size is a
+       * multiple of it, so the maintenance never affects other
+       * variables.
+       */
+      template<std::size_t N>
+        class alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) dma_buffer
+        {
+        public:
+
+          /**
+           * @brief Get the buffer address.
+           * @par Parameters
+           *  None.
+           * @return Pointer to the first byte.
+           */
+          uint8_t*
+          data (void);
+
+          /**
+           * @brief Get the buffer address.
+           * @par Parameters
+           *  None.
+           * @return Pointer to the first byte.
+           */
+          const uint8_t*
+          data (void) const;
+
+          /**
+           * @brief Get the buffer size.
+           * @par Parameters
+           *  None.
+           * @return The size, in bytes.
+           */
+          static constexpr std::size_t
+          size (void);
+
+          /**
+           * @brief Prepare the buffer to be read by a DMA transfer.
+           * @param [in] bytes The number of bytes to be transmitted.
+           * @par Returns
+           *  Nothing.
+           */
+          void
+          prepare_transmit (std::size_t bytes = N) const;
+
+          /**
+           * @brief Prepare the buffer to be written by a DMA transfer.
+           * @param [in] bytes The number of bytes to be received.
+           * @par Returns
+           *  Nothing.
+           */
+          void
+          prepare_receive (std::size_t bytes = N);
+
+          /**
+           * @brief Complete a DMA transfer that wrote the buffer.
+           * @param [in] bytes The number of bytes received.
+           * @par Returns
+           *  Nothing.
+           */
+          void
+          complete_receive (std::size_t bytes = N);
+
+        private:
+
+          /**
+           * @cond ignore
+           */
+
+          uint8_t data_[align_size (N)];
+
+          /**
+           * @endcond
+           */
+        };
+
+    } /* namespace dcache */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace dcache
+    {
+      constexpr std::size_t
+      align_size (std::size_t bytes)
+      {
+        return (bytes + line_size_bytes - 1)
+            & ~static_cast<std::size_t> (line_size_bytes - 1);
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      inline uintptr_t
+      internal_line_start_ (const void* addr)
+      {
+        return reinterpret_cast<uintptr_t> (addr)
+            & ~static_cast<uintptr_t> (line_size_bytes - 1);
+      }
+
+      inline std::size_t
+      internal_line_bytes_ (const void* addr, std::size_t bytes)
+      {
+        return align_size (reinterpret_cast<uintptr_t> (addr) + bytes
+            - internal_line_start_ (addr));
+      }
+
+      /**
+       * @endcond
+       */
+
+      inline void
+      clean (const void* addr __attribute__((unused)),
+             std::size_t bytes __attribute__((unused)))
+      {
+#if defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE)
+        if (bytes != 0)
+          {
+            os_dcache_clean (
+                reinterpret_cast<const void*> (internal_line_start_ (addr)),
+                internal_line_bytes_ (addr, bytes));
+          }
+#endif
+      }
+
+      inline void
+      invalidate (void* addr __attribute__((unused)),
+                  std::size_t bytes __attribute__((unused)))
+      {
+#if defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE)
+        if (bytes != 0)
+          {
+            os_dcache_invalidate (
+                reinterpret_cast<void*> (internal_line_start_ (addr)),
+                internal_line_bytes_ (addr, bytes));
+          }
+#endif
+      }
+
+      inline void
+      clean_invalidate (void* addr __attribute__((unused)),
+                        std::size_t bytes __attribute__((unused)))
+      {
+#if defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE)
+        if (bytes != 0)
+          {
+            os_dcache_clean_invalidate (
+                reinterpret_cast<void*> (internal_line_start_ (addr)),
+                internal_line_bytes_ (addr, bytes));
+          }
+#endif
+      }
+
+      /**
+       * @details
+       * Write back the data, so the transfer reads the content
+       * written by the CPU.
+       */
+      inline void
+      prepare_transmit (const void* addr, std::size_t bytes)
+      {
+        clean (addr, bytes);
+      }
+
+      /**
+       * @details
+       * Write back and discard the lines, so no dirty line is
+       * evicted over the received data during the transfer.
+       */
+      inline void
+      prepare_receive (void* addr, std::size_t bytes)
+      {
+        clean_invalidate (addr, bytes);
+      }
+
+      /**
+       * @details
+       * Discard the lines filled by speculative reads during
+       * the transfer, so the CPU reads the received data.
+       */
+      inline void
+      complete_receive (void* addr, std::size_t bytes)
+      {
+        invalidate (addr, bytes);
+      }
+
+      // ======================================================================
+
+      template<std::size_t N>
+        inline uint8_t*
+        dma_buffer<N>::data (void)
+        {
+          return data_;
+        }
+
+      template<std::size_t N>
+        inline const uint8_t*
+        dma_buffer<N>::data (void) const
+        {
+          return data_;
+        }
+
+      template<std::size_t N>
+        constexpr std::size_t
+        dma_buffer<N>::size (void)
+        {
+          return N;
+        }
+
+      template<std::size_t N>
+        inline void
+        dma_buffer<N>::prepare_transmit (std::size_t bytes) const
+        {
+          dcache::prepare_transmit (data_, bytes);
+        }
+
+      template<std::size_t N>
+        inline void
+        dma_buffer<N>::prepare_receive (std::size_t bytes)
+        {
+          dcache::prepare_receive (data_, bytes);
+        }
+
+      template<std::size_t N>
+        inline void
+        dma_buffer<N>::complete_receive (std::size_t bytes)
+        {
+          dcache::complete_receive (data_, bytes);
+        }
+
+    } /* namespace dcache */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_DCACHE_H_ */
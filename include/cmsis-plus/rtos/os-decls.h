@@ -61,18 +61,39 @@ namespace os
     // ========================================================================
 
     // Forward references.
+    class barrier;
     class clock;
     class clock_rtc;
     class clock_systick;
 
     class condition_variable;
     class event_flags;
+    class latch;
+    class mailbox_base;
     class memory_pool;
+    class memory_pool_set;
     class message_queue;
     class mutex;
+    class rwlock;
     class semaphore;
     class thread;
     class timer;
+    class topic;
+    class wait_set;
+    class work_queue;
+
+    namespace coroutine
+    {
+      class event_flags_awaiter;
+      class receive_awaiter;
+      class semaphore_awaiter;
+      class send_awaiter;
+    } /* namespace coroutine */
+
+    namespace this_thread
+    {
+      class periodic;
+    } /* namespace this_thread */
 
     // ------------------------------------------------------------------------
 
@@ -221,6 +242,61 @@ namespace os
        */
       using duration_t = uint64_t;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+      /**
+       * @brief Type of variables holding CPU loads.
+       * @details
+       * The loads are expressed in hundredths of a percent,
+       * from 0 to `load_full_scale`.
+       */
+      using load_t = uint16_t;
+
+      /**
+       * @brief The load of a fully busy CPU (100.00%).
+       */
+      constexpr load_t load_full_scale = 10000;
+
+      /**
+       * @brief Type of variables holding CPU load window indices.
+       */
+      using load_window_t = uint8_t;
+
+      /**
+       * @brief CPU load averaging windows.
+       */
+      struct load_window
+      {
+        /**
+         * @brief Windows of the exponential moving averages.
+         */
+        enum
+          : load_window_t
+            {
+              /**
+               * @brief Average over about one second.
+               */
+              one_second = 0,
+
+              /**
+               * @brief Average over about ten seconds.
+               */
+              ten_seconds = 1,
+
+              /**
+               * @brief Average over about one minute.
+               */
+              one_minute = 2,
+
+              /**
+               * @brief The number of windows.
+               */
+              count = 3
+        };
+      };
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
     } /* namespace statistics */
 
     // ------------------------------------------------------------------------
@@ -325,6 +401,81 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+    /**
+     * @brief Thread notifications definitions.
+     * @details
+     * A notification is a word in the thread object, updated by
+     * `thread::notify()` and consumed by the `this_thread::notify_*()`
+     * functions, without any separate synchronisation object.
+     */
+    namespace notify
+    {
+      /**
+       * @brief Type of variables holding notification values.
+       */
+      using value_t = uint32_t;
+
+      /**
+       * @brief Type of variables holding notification actions.
+       */
+      using action_t = uint8_t;
+
+      /**
+       * @brief Notification actions.
+       * @details
+       * Container for the ways a notification updates the value.
+       */
+      namespace action
+      {
+        /**
+         * @brief How the notification value is updated.
+         */
+        enum
+          : action_t
+            {
+              /**
+               * @brief Only mark the notification as pending.
+               */
+              none = 0,
+
+              /**
+               * @brief OR the value into the notification value.
+               */
+              set_bits = 1,
+
+              /**
+               * @brief Add the value to the notification value.
+               */
+              increment = 2,
+
+              /**
+               * @brief Set the value, even if a notification is pending.
+               */
+              overwrite = 3,
+
+              /**
+               * @brief Set the value, unless a notification is pending.
+               */
+              no_overwrite = 4
+        };
+      } /* namespace action */
+
+      /**
+       * @brief Notification values with special meaning.
+       */
+      enum
+        : value_t
+          {
+            /**
+             * Special value to represent all bits.
+             */
+            all = 0xFFFFFFFF,
+      };
+
+    } /* namespace notify */
+
+    // ------------------------------------------------------------------------
+
     /**
      * @brief A convenience namespace to access the current running thread.
      * @ingroup cmsis-plus-rtos-thread
@@ -341,6 +492,17 @@ namespace os
     namespace internal
     {
 
+      /**
+       * @cond ignore
+       */
+
+      // Checks the layout of the C structures, in `os-c-wrapper.cpp`.
+      struct c_api_layout;
+
+      /**
+       * @endcond
+       */
+
       // ======================================================================
 
       /**
@@ -359,6 +521,7 @@ namespace os
         /**
          * @brief Construct a named object instance.
          */
+        constexpr
         object_named ();
 
         /**
@@ -366,6 +529,7 @@ namespace os
          * @param [in] name Null terminated name. If `nullptr`,
          * "-" is assigned.
          */
+        constexpr
         object_named (const char* name);
 
         /**
@@ -453,6 +617,7 @@ namespace os
         /**
          * @brief Construct a named system object instance.
          */
+        constexpr
         object_named_system ();
 
         /**
@@ -460,6 +625,7 @@ namespace os
          * @param [in] name Null terminated name. If `nullptr`,
          * "-" is assigned.
          */
+        constexpr
         object_named_system (const char* name);
 
         /**
@@ -749,6 +915,30 @@ namespace os
     {
       // ======================================================================
 
+      constexpr
+      object_named::object_named ()
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * Prefer the given name, otherwise
+       * default to '-'.
+       *
+       * To save space, instead of copying the null terminated string
+       * locally, the pointer to the string
+       * is copied, so the caller must ensure that the pointer
+       * life cycle is at least as long as the object life cycle.
+       * A constant string (stored in flash) is preferred.
+       */
+      constexpr
+      object_named::object_named (const char* name) :
+          name_ (name != nullptr ? name : "-")
+      {
+        ;
+      }
+
       /**
        * @details
        * All objects return a non-null string; anonymous objects
@@ -764,13 +954,13 @@ namespace os
 
       // ======================================================================
 
-      inline
+      constexpr
       object_named_system::object_named_system ()
       {
         ;
       }
 
-      inline
+      constexpr
       object_named_system::object_named_system (const char* name) :
           object_named (name)
       {
@@ -1058,6 +1248,21 @@ namespace os
 
         static uint32_t
         input_clock_frequency_hz (void);
+
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+
+        /**
+         * @brief Program the compare channel.
+         * @param [in] cycles Number of input clock cycles from now,
+         *  less than one tick.
+         * @details
+         * The channel must fire once and its interrupt handler
+         * must call `os_hrclock_compare_handler()`.
+         */
+        static void
+        start_compare (uint32_t cycles);
+
+#endif
       };
 
     // ========================================================================
@@ -1070,6 +1275,8 @@ namespace os
 
 // Must be included after the declarations
 #include <cmsis-plus/rtos/internal/os-lists.h>
+#include <cmsis-plus/rtos/internal/os-sync-stats.h>
+#include <cmsis-plus/rtos/internal/os-events.h>
 
 // ----------------------------------------------------------------------------
 
@@ -1152,6 +1359,126 @@ extern "C"
 #define OS_BOOL_RTOS_SCHEDULER_PREEMPTIVE                   (true)
 #endif
 
+#if !defined(OS_INTEGER_RTOS_WORK_QUEUE_PRIORITY)
+#define OS_INTEGER_RTOS_WORK_QUEUE_PRIORITY                 (os::rtos::thread::priority::high)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_COROUTINE_EXECUTOR_PRIORITY)
+#define OS_INTEGER_RTOS_COROUTINE_EXECUTOR_PRIORITY         (os::rtos::thread::priority::normal)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_SRP_DISPATCHER_PRIORITY)
+#define OS_INTEGER_RTOS_SRP_DISPATCHER_PRIORITY             (os::rtos::thread::priority::high)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_SRP_PRIORITIES)
+#define OS_INTEGER_RTOS_SRP_PRIORITIES                      (8)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY)
+#define OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY               (os::rtos::thread::priority::high)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_TIMER_DAEMON_QUEUE_SIZE)
+#define OS_INTEGER_RTOS_TIMER_DAEMON_QUEUE_SIZE             (8)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES)
+#define OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES       (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS)
+#define OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS               (2)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_DEFERRED_INIT_PRIORITY)
+#define OS_INTEGER_RTOS_DEFERRED_INIT_PRIORITY              (os::rtos::thread::priority::normal)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_DEFERRED_INIT_STACK_SIZE_BYTES)
+#define OS_INTEGER_RTOS_DEFERRED_INIT_STACK_SIZE_BYTES      (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS)
+#define OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS             (2)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_QUANTUM_TICKS)
+#define OS_INTEGER_RTOS_THREAD_QUANTUM_TICKS                (0)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS)
+#define OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS (16)
+#endif
+
+// The CPU budgets are enforced by the reference scheduler, and the
+// snapshots use its idle thread.
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+#undef OS_INCLUDE_RTOS_THREAD_CPU_BUDGET
+#undef OS_INCLUDE_RTOS_SNAPSHOT
+#endif
+
+// The snapshot grace periods use the thread context switches.
+#if defined(OS_INCLUDE_RTOS_SNAPSHOT) \
+  && !defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES
+#endif
+
+// The CPU load and the CPU budgets use the thread CPU cycles.
+#if (defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) \
+  || defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)) \
+  && !defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES
+#endif
+
+#if !defined(OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS)
+#define OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS       (250)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_STACK_WATERMARK_GAP_WORDS)
+#define OS_INTEGER_RTOS_THREAD_STACK_WATERMARK_GAP_WORDS    (16)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_TLS_SLOTS)
+#define OS_INTEGER_RTOS_THREAD_TLS_SLOTS                    (0)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES)
+#define OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES          (0)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS)
+#define OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS      (0)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCK_SIZE_BYTES)
+#define OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCK_SIZE_BYTES (32)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS)
+#define OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_SLOT_BITS        (4)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS)
+#define OS_INTEGER_RTOS_CLOCK_TIMING_WHEEL_LEVELS           (4)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_MEMORY_REGIONS)
+#define OS_INTEGER_RTOS_MEMORY_REGIONS                      (4)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES)
+#define OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES               (32)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_WAIT_SET_MAX_SIZE)
+#define OS_INTEGER_RTOS_WAIT_SET_MAX_SIZE                   (8)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_MEMORY_POOL_SET_MAX_SIZE)
+#define OS_INTEGER_RTOS_MEMORY_POOL_SET_MAX_SIZE            (4)
+#endif
+
 // ----------------------------------------------------------------------------
 
 #endif /* CMSIS_PLUS_RTOS_OS_DECLS_H_ */
@@ -0,0 +1,259 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_DEFERRED_INIT_H_
+#define CMSIS_PLUS_RTOS_OS_DEFERRED_INIT_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Deferred initialisations namespace.
+     * @ingroup cmsis-plus-rtos-deferred-init
+     * @details
+     * Slow initialisations (storage cards, network links) can be
+     * registered with `OS_DEFERRED_INIT()`, instead of being done
+     * in static constructors. After the scheduler starts, the `init`
+     * thread runs them by levels, in increasing order; the functions
+     * with the same level run in parallel, on a thread pool, and
+     * a level starts only after all lower levels completed.
+     *
+     * Meanwhile `os_main()` runs and can use `wait()` to
+     * synchronise with the levels it depends on.
+     */
+    namespace deferred_init
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Type of initialisation levels.
+       */
+      using level_t = uint8_t;
+
+      /**
+       * @brief Type of initialisation functions.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      using func_t = void (*) (void);
+
+      // ======================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Registered initialisation.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-deferred-init
+       *
+       * @details
+       * Usually defined as a static object with `OS_DEFERRED_INIT()`;
+       * the constructor only links it to the list, so it is cheap.
+       */
+      class initializer
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Register an initialisation function.
+         * @param [in] name Pointer to name.
+         * @param [in] level The initialisation level.
+         * @param [in] func Pointer to function.
+         */
+        initializer (const char* name, level_t level, func_t func);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        initializer (const initializer&) = delete;
+        initializer (initializer&&) = delete;
+        initializer&
+        operator= (const initializer&) = delete;
+        initializer&
+        operator= (initializer&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~initializer () = default;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the name.
+         */
+        const char*
+        name (void) const;
+
+        /**
+         * @brief Get the initialisation level.
+         */
+        level_t
+        level (void) const;
+
+        /**
+         * @}
+         */
+
+      private:
+
+        /**
+         * @cond ignore
+         */
+
+        friend void
+        run (void);
+
+        static void
+        internal_run_ (void* args);
+
+        func_t func_;
+        const char* name_;
+        initializer* next_;
+        level_t level_;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+      // ======================================================================
+
+      /**
+       * @brief Run all registered initialisations.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * Called once, by the `init` thread, created by
+       * `os_startup_create_thread_deferred_init()`.
+       */
+      void
+      run (void);
+
+      /**
+       * @brief Wait for the initialisation levels to complete.
+       * @param [in] level The highest level waited for.
+       * @retval result::ok All functions up to and including the
+       *  given level completed.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      wait (level_t level = 0xFF);
+
+      /**
+       * @brief Check if the initialisation levels completed.
+       * @param [in] level The highest level checked.
+       * @retval true All functions up to and including the level
+       *  completed.
+       * @retval false Some functions did not complete yet.
+       */
+      bool
+      completed (level_t level = 0xFF);
+
+    } /* namespace deferred_init */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace deferred_init
+    {
+      // ======================================================================
+
+      inline const char*
+      initializer::name (void) const
+      {
+        return name_;
+      }
+
+      inline level_t
+      initializer::level (void) const
+      {
+        return level_;
+      }
+
+    } /* namespace deferred_init */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#define OS_DEFERRED_INIT_CONCAT_(a, b) a##b
+#define OS_DEFERRED_INIT_CONCAT(a, b) OS_DEFERRED_INIT_CONCAT_(a, b)
+
+/**
+ * @brief Register a function to be run after the scheduler starts.
+ * @param level The initialisation level, lower levels run first.
+ * @param func The function name.
+ */
+#define OS_DEFERRED_INIT(level, func) \
+  static os::rtos::deferred_init::initializer \
+    OS_DEFERRED_INIT_CONCAT(os_deferred_init_, __LINE__) \
+    { #func, (level), (func) }
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_DEFERRED_INIT_H_ */
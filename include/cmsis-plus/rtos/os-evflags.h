@@ -287,6 +287,19 @@ namespace os
       bool
       waiting (void);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+      /**
+       * @brief Get the contention statistics.
+       * @par Parameters
+       *  None.
+       * @return Reference to the statistics.
+       */
+      statistics::sync&
+      sync_statistics (void);
+
+#endif
+
       /**
        * @}
        */
@@ -303,6 +316,8 @@ namespace os
        */
 
 #if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+      friend class wait_set;
+      friend class coroutine::event_flags_awaiter;
       internal::waiting_threads_list list_;
       clock* clock_;
 #endif
@@ -317,6 +332,11 @@ namespace os
        */
       internal::event_flags event_flags_;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      statistics::sync sync_statistics_
+        { this };
+#endif
+
       /**
        * @endcond
        */
@@ -344,6 +364,20 @@ namespace os
       ;
     }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline statistics::sync&
+    event_flags::sync_statistics (void)
+    {
+      return sync_statistics_;
+    }
+
+#endif
+
   } /* namespace rtos */
 } /* namespace os */
 
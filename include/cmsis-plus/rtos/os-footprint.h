@@ -0,0 +1,290 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_FOOTPRINT_H_
+#define CMSIS_PLUS_RTOS_OS_FOOTPRINT_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/utils/lists.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief RAM footprint of the system objects.
+     * @ingroup cmsis-plus-rtos-footprint
+     *
+     * @details
+     * The memory pools, message queues, mutexes and block device
+     * caches register themselves while they exist; together with
+     * the threads, taken from the scheduler lists, and with the
+     * memory resources, they can be enumerated with `for_each()`,
+     * or listed on the trace output with `report()`.
+     *
+     * The sizes are those of the objects and of their storage
+     * areas (stacks, pools, queues, cache buffers), regardless
+     * of where the storage is located; static storage, also
+     * counted by the linker in `.bss`, is included.
+     */
+    namespace footprint
+    {
+      /**
+       * @brief Description of an object.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-footprint
+       */
+      struct item
+      {
+        /**
+         * @brief The object type, like `"thread"` or `"mqueue"`.
+         */
+        const char* kind;
+
+        /**
+         * @brief The object name.
+         */
+        const char* name;
+
+        /**
+         * @brief The object address.
+         */
+        const void* object;
+
+        /**
+         * @brief The size of the object itself, in bytes.
+         */
+        std::size_t object_bytes;
+
+        /**
+         * @brief The size of the storage used by the object, in bytes.
+         */
+        std::size_t storage_bytes;
+
+        /**
+         * @brief The part of the storage currently in use, in bytes.
+         */
+        std::size_t used_bytes;
+
+        /**
+         * @brief The largest part of the storage ever used, in bytes,
+         *  or 0 if not tracked.
+         */
+        std::size_t peak_bytes;
+      };
+
+      /**
+       * @brief Type of functions describing a registered object.
+       * @param [in] object The object address.
+       * @param [out] it The description; the `kind`, `name` and
+       *  `object` members are set by the caller.
+       */
+      using describe_t = void (*) (const void* object, item& it);
+
+      /**
+       * @brief Type of functions called for each object.
+       * @param [in] it The object description.
+       * @param [in] arg The argument given to `for_each()`.
+       */
+      using visit_t = void (*) (const item& it, void* arg);
+
+      // ======================================================================
+
+      /**
+       * @brief Registration **node** of an object.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-footprint
+       *
+       * @details
+       * A member of the registered objects; it is linked by the
+       * constructor and unlinked by the destructor, so it must be
+       * the last member of the object.
+       */
+      class node
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct and register a node.
+         * @param [in] kind The object type.
+         * @param [in] object The object address.
+         * @param [in] describe The function describing the object.
+         */
+        node (const char* kind, const void* object, describe_t describe);
+
+        /**
+         * @brief Construct the node of a constant initialised object.
+         * @param [in] kind The object type.
+         * @param [in] object The object address.
+         * @param [in] describe The function describing the object.
+         *
+         * @details
+         * The node is not registered, and the object is not listed.
+         */
+        constexpr
+        node (utils::static_init_t, const char* kind, const void* object,
+              describe_t describe);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        node (const node&) = delete;
+        node (node&&) = delete;
+        node&
+        operator= (const node&) = delete;
+        node&
+        operator= (node&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Unregister the node.
+         */
+        ~node ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend void
+        for_each (visit_t func, void* arg);
+
+        utils::double_list_links links_;
+
+        const char* kind_;
+        const void* object_;
+        describe_t describe_;
+
+        // All registered objects, possibly created by static
+        // constructors, so it must be in the BSS.
+        using nodes_list = utils::intrusive_list<node,
+        utils::double_list_links, &node::links_>;
+        static nodes_list nodes__;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Enumerate the objects.
+       * @param [in] func Function called for each object.
+       * @param [in] arg Argument passed to the function.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * The threads first, in the order of the scheduler lists,
+       * then the memory resources and the registered objects.
+       *
+       * The scheduler is locked during the enumeration, so
+       * the function must not block.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void
+      for_each (visit_t func, void* arg = nullptr);
+
+      /**
+       * @brief Write the objects on the trace output.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       *
+       * @details
+       * One line for each object, followed by the totals for
+       * each type.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void
+      report (void);
+
+    } /* namespace footprint */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace footprint
+    {
+      constexpr
+      node::node (utils::static_init_t, const char* kind, const void* object,
+                  describe_t describe) :
+          kind_ (kind), //
+          object_ (object), //
+          describe_ (describe)
+      {
+        ;
+      }
+    } /* namespace footprint */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_FOOTPRINT) */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_FOOTPRINT_H_ */
@@ -28,11 +28,57 @@
 #ifndef CMSIS_PLUS_RTOS_OS_HOOKS_H_
 #define CMSIS_PLUS_RTOS_OS_HOOKS_H_
 
+#include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
 
 // ----------------------------------------------------------------------------
 
+/**
+ * @brief Place a variable in the RAM not initialised by the startup.
+ *
+ * @details
+ * The `.noinit` section must be placed by the linker script in a
+ * `NOLOAD` region, outside the .data and .bss regions; the content
+ * is random after power-on and survives the warm resets.
+ */
+#define OS_ATTRIBUTE_NOINIT __attribute__((section(".noinit")))
+
+/**
+ * @brief Place a variable in the RAM cleared on demand.
+ *
+ * @details
+ * The `.bss_lazy` section must be placed by the linker script in a
+ * `NOLOAD` region, delimited by `__bss_lazy_start__` and
+ * `__bss_lazy_end__` or, with multiple RAM sections, in the
+ * `__bss_lazy_regions_array`; the startup does not clear it,
+ * the application calls `os_startup_initialize_lazy_bss()`
+ * before using the variables.
+ */
+#define OS_ATTRIBUTE_BSS_LAZY __attribute__((section(".bss_lazy")))
+
+/**
+ * @brief Place a kernel hot path function in RAM.
+ *
+ * @details
+ * With `OS_USE_RTOS_HOT_PATHS_IN_RAM`, the functions on the context
+ * switch, SysTick and interrupt post paths are placed in the
+ * `.ramfunc` section, which the linker script must place in a
+ * RAM (or ITCM) region loaded from flash and add to the
+ * `__data_regions_array`, to be copied by the startup together
+ * with the initialised variables. Otherwise it is empty.
+ *
+ * The functions are not inlined, so the code always runs
+ * from RAM.
+ */
+#if defined(OS_USE_RTOS_HOT_PATHS_IN_RAM)
+#define OS_ATTRIBUTE_HOT_PATH __attribute__((section(".ramfunc"),noinline))
+#else
+#define OS_ATTRIBUTE_HOT_PATH
+#endif
+
+// ----------------------------------------------------------------------------
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -79,6 +125,71 @@ extern "C"
   void
   os_startup_initialize_hardware (void);
 
+#if defined(OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES)
+
+  /**
+   * @brief Copy a data region with DMA.
+   * @param [in] to Pointer to the RAM region.
+   * @param [in] from Pointer to the initial content.
+   * @param [in] nbytes Region size, in bytes.
+   * @retval true The region was copied.
+   * @retval false The copy must be done by the CPU.
+   *
+   * @details
+   * Called for regions of at least
+   * @ref OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES, before the
+   * .data and .bss are initialised, so it must not use static
+   * variables, and must return only after the transfer completes.
+   */
+  bool
+  os_startup_copy_region_dma (void* to, const void* from, size_t nbytes);
+
+  /**
+   * @brief Clear a bss region with DMA.
+   * @param [in] to Pointer to the RAM region.
+   * @param [in] nbytes Region size, in bytes.
+   * @retval true The region was cleared.
+   * @retval false The clear must be done by the CPU.
+   */
+  bool
+  os_startup_clear_region_dma (void* to, size_t nbytes);
+
+#endif /* defined(OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES) */
+
+  /**
+   * @brief Clear the lazy bss regions.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * Clear the variables defined with `OS_ATTRIBUTE_BSS_LAZY`,
+   * skipped by the startup; it can be called later, when the
+   * boot time is less critical, for example from a low priority
+   * thread, but before using them.
+   */
+  void
+  os_startup_initialize_lazy_bss (void);
+
+#if defined(OS_INCLUDE_STARTUP_CHECKPOINTS)
+
+  /**
+   * @brief Display the startup checkpoints.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * Display on the trace device the cycles counted from the reset
+   * to each startup step, and the slowest static constructors.
+   */
+  void
+  os_startup_report_checkpoints (void);
+
+#endif /* defined(OS_INCLUDE_STARTUP_CHECKPOINTS) */
+
   /**
    * @brief Initialise free store.
    * @param heap_address The first unallocated RAM address (after the BSS).
@@ -107,6 +218,34 @@ extern "C"
   void
   os_startup_create_thread_idle (void);
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+  /**
+   * @brief Create the timer daemon.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_startup_create_thread_timer_daemon (void);
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_DEFERRED_INIT)
+
+  /**
+   * @brief Create the deferred initialisations thread.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_startup_create_thread_deferred_init (void);
+
+#endif
+
   /**
    * @}
    */
@@ -155,6 +294,47 @@ extern "C"
   bool
   os_rtos_idle_enter_power_saving_mode_hook (void);
 
+  /**
+   * @brief Hook to sleep with the SysTick interrupt suppressed.
+   * @param [in] ticks Maximum number of ticks to sleep.
+   * @param [out] slept_ticks Pointer to the number of ticks
+   *  not counted by the SysTick handler.
+   * @retval true The hook entered the tickless sleep.
+   * @retval false The hook did not enter the tickless sleep.
+   */
+  bool
+  os_rtos_idle_enter_tickless_sleep_hook (uint32_t ticks,
+                                          uint32_t* slept_ticks);
+
+#if defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES)
+
+  /**
+   * @brief Hook to select the idle power state.
+   * @param [in] idle_us The time up to the next clock deadline,
+   *  in microseconds.
+   * @param [in] latency_us The strictest latency constraint,
+   *  in microseconds.
+   * @return The power state to enter.
+   */
+  uint8_t
+  os_rtos_idle_select_power_state_hook (uint64_t idle_us,
+                                        uint32_t latency_us);
+
+  /**
+   * @brief Hook to enter a low power state.
+   * @param [in] state The power state, deeper than `sleep`.
+   * @param [in] ticks Maximum number of ticks to stay in the state.
+   * @param [out] slept_ticks Pointer to the number of ticks
+   *  not counted by the SysTick handler.
+   * @retval true The hook entered the power state.
+   * @retval false The hook did not enter the power state.
+   */
+  bool
+  os_rtos_idle_enter_power_state_hook (uint8_t state, uint32_t ticks,
+                                       uint32_t* slept_ticks);
+
+#endif /* defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES) */
+
   /**
    * @brief Hook to handle out of memory in the application free store.
    * @par Parameters
@@ -175,6 +355,76 @@ extern "C"
   void
   os_rtos_system_out_of_memory_hook (void);
 
+  /**
+   * @brief Hook to handle a damaged memory manager.
+   * @param [in] resource Pointer to the memory resource.
+   * @param [in] addr Address of the damaged chunk.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_rtos_memory_corruption_hook (void* resource, const void* addr);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+  /**
+   * @brief Hook to handle a thread that exhausted its CPU budget.
+   * @param [in] thread Pointer to the thread.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * Called by the scheduler, with interrupts disabled, before
+   * the budget action is applied; it must not block.
+   */
+  void
+  os_rtos_thread_cpu_budget_overrun_hook (void* thread);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
+#if defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE)
+
+  /**
+   * @brief Hook to write back the data cache lines of a range.
+   * @param [in] addr The range address, aligned to the cache line.
+   * @param [in] nbytes The range size, a multiple of the cache line.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * On Cortex-M7 it should call `SCB_CleanDCache_by_Addr()`.
+   */
+  void
+  os_dcache_clean (const void* addr, size_t nbytes);
+
+  /**
+   * @brief Hook to discard the data cache lines of a range.
+   * @param [in] addr The range address, aligned to the cache line.
+   * @param [in] nbytes The range size, a multiple of the cache line.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * On Cortex-M7 it should call `SCB_InvalidateDCache_by_Addr()`.
+   */
+  void
+  os_dcache_invalidate (void* addr, size_t nbytes);
+
+  /**
+   * @brief Hook to write back and discard the data cache lines of a range.
+   * @param [in] addr The range address, aligned to the cache line.
+   * @param [in] nbytes The range size, a multiple of the cache line.
+   * @par Returns
+   *  Nothing.
+   *
+   * @details
+   * On Cortex-M7 it should call `SCB_CleanInvalidateDCache_by_Addr()`.
+   */
+  void
+  os_dcache_clean_invalidate (void* addr, size_t nbytes);
+
+#endif /* defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE) */
+
 /**
  * @}
  */
@@ -0,0 +1,375 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_LATCH_H_
+#define CMSIS_PLUS_RTOS_OS_LATCH_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Latch**, a single use count down barrier.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-latch
+     */
+    class latch : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of latch counter storage.
+       * @ingroup cmsis-plus-rtos-latch
+       */
+      using count_t = int32_t;
+
+      /**
+       * @brief Maximum latch initial count.
+       * @ingroup cmsis-plus-rtos-latch
+       */
+      static constexpr count_t max_count_value = 0x7FFFFFFF;
+
+      // ======================================================================
+
+      /**
+       * @brief Latch attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-latch
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a latch attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the latch attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+        // Add more attributes here.
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default latch initialiser.
+       * @ingroup cmsis-plus-rtos-latch
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a latch object instance.
+       * @param [in] expected The initial count.
+       * @param [in] attr Reference to attributes.
+       */
+      latch (count_t expected, const attributes& attr = initializer);
+
+      /**
+       * @brief Construct a named latch object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] expected The initial count.
+       * @param [in] attr Reference to attributes.
+       */
+      latch (const char* name, count_t expected, const attributes& attr =
+                 initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      latch (const latch&) = delete;
+      latch (latch&&) = delete;
+      latch&
+      operator= (const latch&) = delete;
+      latch&
+      operator= (latch&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the latch object instance.
+       */
+      ~latch ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare latches.
+       * @retval true The given latch is the same as this latch.
+       * @retval false The latches are different.
+       */
+      bool
+      operator== (const latch& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Decrement the count, without waiting.
+       * @param [in] update The decrement.
+       * @retval result::ok The count was decremented.
+       * @retval EINVAL The update is negative, or larger than
+       *  the count.
+       */
+      result_t
+      count_down (count_t update = 1);
+
+      /**
+       * @brief Check if the count reached zero.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The count is zero.
+       * @retval EWOULDBLOCK The count is not zero.
+       */
+      result_t
+      try_wait (void);
+
+      /**
+       * @brief Wait for the count to reach zero.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The count is zero.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      wait (void);
+
+      /**
+       * @brief Timed wait for the count to reach zero.
+       * @param [in] timeout Timeout to wait.
+       * @retval result::ok The count is zero.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT The count did not reach zero before
+       *  the specified timeout expired.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_wait (clock::duration_t timeout);
+
+      /**
+       * @brief Decrement the count and wait for it to reach zero.
+       * @param [in] update The decrement.
+       * @retval result::ok The count is zero.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The update is negative, or larger than
+       *  the count.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      arrive_and_wait (count_t update = 1);
+
+      /**
+       * @brief Get the latch count.
+       * @par Parameters
+       *  None.
+       * @return The number of decrements still expected.
+       */
+      count_t
+      count (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      result_t
+      internal_wait_ (bool timed, clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list list_;
+      clock* clock_ = nullptr;
+
+      // Can be updated in different thread contexts.
+      volatile count_t count_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    latch::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * This constructor shall initialise a latch object
+     * with the count _expected_ and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline
+    latch::latch (count_t expected, const attributes& attr) :
+        latch
+          { nullptr, expected, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Identical latches should have the same memory address.
+     */
+    inline bool
+    latch::operator== (const latch& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline latch::count_t
+    latch::count (void) const
+    {
+      return count_;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_LATCH_H_ */
@@ -0,0 +1,774 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_MAILBOX_H_
+#define CMSIS_PLUS_RTOS_OS_MAILBOX_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Mailbox** of pointers, with external storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mailbox
+     *
+     * @details
+     * A FIFO ring of `void*` words; each send stores one word and
+     * each receive loads one word, with no message copies and
+     * no priorities.
+     */
+    class mailbox_base : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of mailbox indices and counters.
+       * @ingroup cmsis-plus-rtos-mailbox
+       */
+      using index_t = uint16_t;
+
+      /**
+       * @brief Maximum mailbox capacity.
+       * @ingroup cmsis-plus-rtos-mailbox
+       */
+      static constexpr index_t max_capacity = 0xFFFF;
+
+      // ======================================================================
+
+      /**
+       * @brief Mailbox attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-mailbox
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a mailbox attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the mailbox attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+        // Add more attributes here.
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default mailbox initialiser.
+       * @ingroup cmsis-plus-rtos-mailbox
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a named mailbox object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] storage Pointer to an array of _capacity_ words.
+       * @param [in] capacity The number of words in the array.
+       * @param [in] attr Reference to attributes.
+       */
+      mailbox_base (const char* name, void** storage, std::size_t capacity,
+                    const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      mailbox_base (const mailbox_base&) = delete;
+      mailbox_base (mailbox_base&&) = delete;
+      mailbox_base&
+      operator= (const mailbox_base&) = delete;
+      mailbox_base&
+      operator= (mailbox_base&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the mailbox object instance.
+       */
+      ~mailbox_base ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare mailboxes.
+       * @retval true The given mailbox is the same as this mailbox.
+       * @retval false The mailboxes are different.
+       */
+      bool
+      operator== (const mailbox_base& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Send a pointer to the mailbox.
+       * @param [in] msg The pointer to send.
+       * @retval result::ok The pointer was stored.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      send (void* msg);
+
+      /**
+       * @brief Try to send a pointer to the mailbox.
+       * @param [in] msg The pointer to send.
+       * @retval result::ok The pointer was stored.
+       * @retval EWOULDBLOCK The mailbox is full.
+       */
+      result_t
+      try_send (void* msg);
+
+      /**
+       * @brief Send a pointer to the mailbox with timeout.
+       * @param [in] msg The pointer to send.
+       * @param [in] timeout The timeout duration.
+       * @retval result::ok The pointer was stored.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The mailbox was still full when the
+       *  timeout expired.
+       */
+      result_t
+      timed_send (void* msg, clock::duration_t timeout);
+
+      /**
+       * @brief Receive a pointer from the mailbox.
+       * @param [out] msg Pointer to location where to store the pointer.
+       * @retval result::ok A pointer was retrieved.
+       * @retval EINVAL A null location was given.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      receive (void** msg);
+
+      /**
+       * @brief Try to receive a pointer from the mailbox.
+       * @param [out] msg Pointer to location where to store the pointer.
+       * @retval result::ok A pointer was retrieved.
+       * @retval EINVAL A null location was given.
+       * @retval EWOULDBLOCK The mailbox is empty.
+       */
+      result_t
+      try_receive (void** msg);
+
+      /**
+       * @brief Receive a pointer from the mailbox with timeout.
+       * @param [out] msg Pointer to location where to store the pointer.
+       * @param [in] timeout The timeout duration.
+       * @retval result::ok A pointer was retrieved.
+       * @retval EINVAL A null location was given.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No pointer arrived before the
+       *  timeout expired.
+       */
+      result_t
+      timed_receive (void** msg, clock::duration_t timeout);
+
+      /**
+       * @brief Get the number of pointers in the mailbox.
+       * @par Parameters
+       *  None.
+       * @return The number of pointers waiting to be received.
+       */
+      std::size_t
+      length (void) const;
+
+      /**
+       * @brief Get the mailbox capacity.
+       * @par Parameters
+       *  None.
+       * @return The maximum number of pointers.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Check if the mailbox is empty.
+       * @par Parameters
+       *  None.
+       * @retval true The mailbox has no pointers.
+       * @retval false The mailbox has at least one pointer.
+       */
+      bool
+      empty (void) const;
+
+      /**
+       * @brief Check if the mailbox is full.
+       * @par Parameters
+       *  None.
+       * @retval true The mailbox is full.
+       * @retval false The mailbox is not full.
+       */
+      bool
+      full (void) const;
+
+      /**
+       * @brief Reset the mailbox.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The mailbox was reset.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      reset (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      internal_try_send_ (void* msg);
+
+      bool
+      internal_try_receive_ (void** msg);
+
+      result_t
+      internal_send_ (void* msg, bool timed, clock::duration_t timeout);
+
+      result_t
+      internal_receive_ (void** msg, bool timed, clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list send_list_;
+      internal::waiting_threads_list receive_list_;
+      clock* clock_ = nullptr;
+
+      void** ring_ = nullptr;
+      index_t capacity_ = 0;
+
+      // Can be updated in different thread contexts.
+      volatile index_t head_ = 0;
+      volatile index_t count_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Template of a **mailbox** with local storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mailbox
+     *
+     * @tparam T Type of messages; only pointer types are supported.
+     * @tparam N Number of messages.
+     *
+     * @details
+     * Only the pointer specialisation `mailbox<T*, N>` is defined.
+     */
+    template<typename T, std::size_t N>
+      class mailbox;
+
+    /**
+     * @brief Template of a **mailbox** of pointers with local storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mailbox
+     *
+     * @tparam T Type of pointed objects.
+     * @tparam N Number of pointers.
+     */
+    template<typename T, std::size_t N>
+      class mailbox<T*, N> : public mailbox_base
+      {
+      public:
+
+        static_assert(N > 0 && N <= max_capacity,
+            "mailbox capacity must be 1 to 65535");
+
+        /**
+         * @brief Type of messages.
+         */
+        using value_type = T*;
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static constexpr std::size_t msgs = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a mailbox object instance.
+         * @param [in] attr Reference to attributes.
+         */
+        mailbox (const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named mailbox object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] attr Reference to attributes.
+         */
+        mailbox (const char* name, const attributes& attr = initializer);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        mailbox (const mailbox&) = delete;
+        mailbox (mailbox&&) = delete;
+        mailbox&
+        operator= (const mailbox&) = delete;
+        mailbox&
+        operator= (mailbox&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the mailbox object instance.
+         */
+        ~mailbox () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Send a typed pointer to the mailbox.
+         * @param [in] msg The pointer to send.
+         * @retval result::ok The pointer was stored.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        send (value_type msg);
+
+        /**
+         * @brief Try to send a typed pointer to the mailbox.
+         * @param [in] msg The pointer to send.
+         * @retval result::ok The pointer was stored.
+         * @retval EWOULDBLOCK The mailbox is full.
+         */
+        result_t
+        try_send (value_type msg);
+
+        /**
+         * @brief Send a typed pointer to the mailbox with timeout.
+         * @param [in] msg The pointer to send.
+         * @param [in] timeout The timeout duration.
+         * @retval result::ok The pointer was stored.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT The mailbox was still full when the
+         *  timeout expired.
+         */
+        result_t
+        timed_send (value_type msg, clock::duration_t timeout);
+
+        /**
+         * @brief Receive a typed pointer from the mailbox.
+         * @param [out] msg Pointer to location where to store the pointer.
+         * @retval result::ok A pointer was retrieved.
+         * @retval EINVAL A null location was given.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        receive (value_type* msg);
+
+        /**
+         * @brief Try to receive a typed pointer from the mailbox.
+         * @param [out] msg Pointer to location where to store the pointer.
+         * @retval result::ok A pointer was retrieved.
+         * @retval EINVAL A null location was given.
+         * @retval EWOULDBLOCK The mailbox is empty.
+         */
+        result_t
+        try_receive (value_type* msg);
+
+        /**
+         * @brief Receive a typed pointer from the mailbox with timeout.
+         * @param [out] msg Pointer to location where to store the pointer.
+         * @param [in] timeout The timeout duration.
+         * @retval result::ok A pointer was retrieved.
+         * @retval EINVAL A null location was given.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT No pointer arrived before the
+         *  timeout expired.
+         */
+        result_t
+        timed_receive (value_type* msg, clock::duration_t timeout);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The ring of words.
+         */
+        void* arena_[msgs];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    mailbox_base::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * Identical mailboxes should have the same memory address.
+     */
+    inline bool
+    mailbox_base::operator== (const mailbox_base& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    mailbox_base::length (void) const
+    {
+      return count_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    mailbox_base::capacity (void) const
+    {
+      return capacity_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline bool
+    mailbox_base::empty (void) const
+    {
+      return (count_ == 0);
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline bool
+    mailbox_base::full (void) const
+    {
+      return (count_ == capacity_);
+    }
+
+    // ========================================================================
+
+    template<typename T, std::size_t N>
+      constexpr std::size_t mailbox<T*, N>::msgs;
+
+    /**
+     * @details
+     * This constructor shall initialise a mailbox object
+     * with storage for _N_ pointers and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline
+      mailbox<T*, N>::mailbox (const attributes& attr) :
+          mailbox_base
+            { nullptr, arena_, msgs, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * This constructor shall initialise a named mailbox object
+     * with storage for _N_ pointers and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline
+      mailbox<T*, N>::mailbox (const char* name, const attributes& attr) :
+          mailbox_base
+            { name, arena_, msgs, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * Wrapper over `mailbox_base::send()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      mailbox<T*, N>::send (value_type msg)
+      {
+        return mailbox_base::send (
+            const_cast<void*> (static_cast<const volatile void*> (msg)));
+      }
+
+    /**
+     * @details
+     * Wrapper over `mailbox_base::try_send()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      mailbox<T*, N>::try_send (value_type msg)
+      {
+        return mailbox_base::try_send (
+            const_cast<void*> (static_cast<const volatile void*> (msg)));
+      }
+
+    /**
+     * @details
+     * Wrapper over `mailbox_base::timed_send()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      mailbox<T*, N>::timed_send (value_type msg, clock::duration_t timeout)
+      {
+        return mailbox_base::timed_send (
+            const_cast<void*> (static_cast<const volatile void*> (msg)),
+            timeout);
+      }
+
+    /**
+     * @details
+     * Wrapper over `mailbox_base::receive()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      mailbox<T*, N>::receive (value_type* msg)
+      {
+        void* p;
+        result_t res = mailbox_base::receive (msg != nullptr ? &p : nullptr);
+        if (res == result::ok)
+          {
+            *msg = static_cast<value_type> (p);
+          }
+        return res;
+      }
+
+    /**
+     * @details
+     * Wrapper over `mailbox_base::try_receive()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      mailbox<T*, N>::try_receive (value_type* msg)
+      {
+        void* p;
+        result_t res = mailbox_base::try_receive (
+            msg != nullptr ? &p : nullptr);
+        if (res == result::ok)
+          {
+            *msg = static_cast<value_type> (p);
+          }
+        return res;
+      }
+
+    /**
+     * @details
+     * Wrapper over `mailbox_base::timed_receive()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      mailbox<T*, N>::timed_receive (value_type* msg,
+                                     clock::duration_t timeout)
+      {
+        void* p;
+        result_t res = mailbox_base::timed_receive (
+            msg != nullptr ? &p : nullptr, timeout);
+        if (res == result::ok)
+          {
+            *msg = static_cast<value_type> (p);
+          }
+        return res;
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_MAILBOX_H_ */
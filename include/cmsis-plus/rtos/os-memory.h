@@ -89,6 +89,7 @@ namespace os
       }
 
       class memory_resource;
+      class shrinker;
 
       // ----------------------------------------------------------------------
 
@@ -131,6 +132,46 @@ namespace os
       void
       init_once_default_resource (void);
 
+      /**
+       * @}
+       */
+
+      /**
+       * @name Memory Regions Functions
+       * @{
+       */
+
+      /**
+       * @brief Register a named memory region.
+       * @param [in] name Pointer to the region name.
+       * @param [in] res Pointer to the memory manager of the region,
+       *  or `nullptr` to remove the region.
+       * @return Pointer to the previous memory manager of the region,
+       *  or `nullptr`.
+       */
+      memory_resource*
+      set_region (const char* name, memory_resource* res) noexcept;
+
+      /**
+       * @brief Get the memory manager of a named memory region.
+       * @param [in] name Pointer to the region name.
+       * @return Pointer to the memory manager, or `nullptr` if
+       *  the region is not registered.
+       */
+      memory_resource*
+      region (const char* name) noexcept;
+
+      /**
+       * @brief Enumerate the registered memory regions.
+       * @param [in] index The index in the regions table, from 0
+       *  to `OS_INTEGER_RTOS_MEMORY_REGIONS - 1`.
+       * @param [out] name Pointer to where to store the region name.
+       * @return Pointer to the memory manager, or `nullptr` if
+       *  the entry is not used.
+       */
+      memory_resource*
+      region_at (std::size_t index, const char** name) noexcept;
+
       /**
        * @}
        */
@@ -261,6 +302,28 @@ namespace os
         bool
         coalesce (void) noexcept;
 
+        /**
+         * @brief Try to resize a block in place.
+         * @param [in] addr Address of a previously allocated block.
+         * @param [in] bytes Number of bytes originally requested
+         *  (may be 0 if unknown).
+         * @param [in] new_bytes The new number of bytes.
+         * @retval true The block was resized and can be used with
+         *  the new size, at the same address.
+         * @retval false The block cannot be resized in place
+         *  and was not changed.
+         */
+        bool
+        try_resize (void* addr, std::size_t bytes, std::size_t new_bytes) noexcept;
+
+        /**
+         * @brief Verify the integrity of some of the managed chunks.
+         * @param chunks Maximum number of chunks to check.
+         * @return Address of the first damaged chunk, or `nullptr`.
+         */
+        const void*
+        verify (std::size_t chunks) noexcept;
+
         /**
          * @brief Get the largest value that can be passed to `allocate()`.
          * @par Parameters
@@ -270,6 +333,45 @@ namespace os
         std::size_t
         max_size (void) const noexcept;
 
+        /**
+         * @brief Allocate a memory block, using the emergency reserve
+         *  if needed.
+         * @param bytes Number of bytes to allocate.
+         * @param alignment Alignment constraint (power of 2).
+         * @return Pointer to newly allocated block, or `nullptr`.
+         */
+        void*
+        allocate_critical (std::size_t bytes,
+                           std::size_t alignment = max_align);
+
+        /**
+         * @brief Ask the registered shrinkers to release memory.
+         * @param bytes Number of bytes needed.
+         * @return Number of bytes released.
+         */
+        std::size_t
+        reclaim (std::size_t bytes);
+
+        /**
+         * @brief Set the size of the emergency reserve.
+         * @param bytes Number of bytes, or 0 to release the reserve.
+         * @retval true The reserve was allocated.
+         * @retval false There is not enough memory now; the reserve
+         *  will be allocated when memory is deallocated.
+         */
+        bool
+        emergency_reserve (std::size_t bytes);
+
+        /**
+         * @brief Get the size of the emergency reserve.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes held in reserve, 0 if none or
+         *  if used by a critical allocation.
+         */
+        std::size_t
+        emergency_reserve (void) const;
+
         /**
          * @brief Set the out of memory handler.
          * @param handler Pointer to new handler.
@@ -339,6 +441,25 @@ namespace os
         std::size_t
         free_chunks (void);
 
+        /**
+         * @brief Get the size of the largest free chunk.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes, or 0 if none or unknown.
+         */
+        std::size_t
+        max_free_chunk (void) noexcept;
+
+        /**
+         * @brief Get the fragmentation index.
+         * @par Parameters
+         *  None.
+         * @return Integer between 0 (all free memory in one
+         *  chunk) and 100.
+         */
+        std::size_t
+        fragmentation (void) noexcept;
+
         /**
          * @brief Get the number of allocations.
          * @par Parameters
@@ -437,6 +558,38 @@ namespace os
         virtual bool
         do_coalesce (void) noexcept;
 
+        /**
+         * @brief Implementation of the function to resize a block in place.
+         * @param [in] addr Address of a previously allocated block.
+         * @param [in] bytes Number of bytes originally requested
+         *  (may be 0 if unknown).
+         * @param [in] new_bytes The new number of bytes.
+         * @retval true The block was resized.
+         * @retval false The block cannot be resized in place.
+         */
+        virtual bool
+        do_try_resize (void* addr, std::size_t bytes,
+                       std::size_t new_bytes) noexcept;
+
+        /**
+         * @brief Implementation of the function to verify the
+         *  integrity of the managed chunks.
+         * @param [in] chunks Maximum number of chunks to check.
+         * @return Address of the first damaged chunk, or `nullptr`.
+         */
+        virtual const void*
+        do_verify (std::size_t chunks) noexcept;
+
+        /**
+         * @brief Implementation of the function to get the size
+         *  of the largest free chunk.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes, or 0 if none or unknown.
+         */
+        virtual std::size_t
+        do_max_free_chunk (void) noexcept;
+
         /**
          * @brief Update statistics after allocation.
          * @param [in] bytes Number of allocated bytes.
@@ -455,6 +608,23 @@ namespace os
         void
         internal_decrease_allocated_statistics (std::size_t bytes) noexcept;
 
+        /**
+         * @cond ignore
+         */
+
+        friend class shrinker;
+
+        void*
+        internal_allocate_ (std::size_t bytes, std::size_t alignment,
+                            bool critical);
+
+        void
+        internal_rearm_reserve_ (void) noexcept;
+
+        /**
+         * @endcond
+         */
+
         /**
          * @}
          */
@@ -467,6 +637,14 @@ namespace os
 
         out_of_memory_handler_t out_of_memory_handler_ = nullptr;
 
+        // Sorted by priority, the highest first.
+        shrinker* shrinkers_ = nullptr;
+
+        // The emergency reserve, a block allocated in advance.
+        void* reserve_ = nullptr;
+        std::size_t reserve_bytes_ = 0;
+        bool reclaiming_ = false;
+
         std::size_t total_bytes_ = 0;
         std::size_t allocated_bytes_ = 0;
         std::size_t free_bytes_ = 0;
@@ -482,6 +660,119 @@ namespace os
 
       };
 
+      // ======================================================================
+
+      /**
+       * @brief Memory **shrinker**, a callback to reclaim memory.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       *
+       * @details
+       * Caches that keep memory only to be faster register a shrinker
+       * with the memory resource they allocate from; when
+       * an allocation fails, the shrinkers are called in priority
+       * order, highest first, and the allocation is retried after
+       * each one that released memory.
+       */
+      class shrinker
+      {
+      public:
+
+        /**
+         * @brief Type of shrinker priorities.
+         */
+        using priority_t = uint8_t;
+
+        /**
+         * @brief Type of reclaim functions.
+         * @param bytes The number of bytes needed.
+         * @param args The pointer given to the constructor.
+         * @return The number of bytes released, or 0.
+         */
+        using reclaim_t = std::size_t (*) (std::size_t bytes, void* args);
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Register a shrinker.
+         * @param [in] mr Reference to the memory resource.
+         * @param [in] func Pointer to the reclaim function.
+         * @param [in] args Pointer to the reclaim function arguments.
+         * @param [in] prio The priority; higher priorities are
+         *  called first.
+         */
+        shrinker (memory_resource& mr, reclaim_t func, void* args = nullptr,
+                  priority_t prio = 0);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        shrinker (const shrinker&) = delete;
+        shrinker (shrinker&&) = delete;
+        shrinker&
+        operator= (const shrinker&) = delete;
+        shrinker&
+        operator= (shrinker&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Unregister the shrinker.
+         */
+        ~shrinker ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the number of bytes released by this shrinker.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes.
+         */
+        std::size_t
+        reclaimed_bytes (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class memory_resource;
+
+        memory_resource& resource_;
+        shrinker* next_ = nullptr;
+
+        reclaim_t func_;
+        void* args_;
+
+        std::size_t reclaimed_bytes_ = 0;
+        priority_t prio_;
+
+        /**
+         * @endcond
+         */
+      };
+
       /**
        * @name Operators
        * @{
@@ -1270,10 +1561,11 @@ namespace os
        *
        * If the storage of the requested size and alignment cannot be
        * obtained:
+       * - if shrinkers are registered, call them and retry;
        * - if the out of memory handler is not set, return `nullptr`;
        * - if the out of memory handler is set, call it and retry.
        *
-       * Equivalent to `return do_allocate(bytes, alignment);`.
+       * Without shrinkers, equivalent to `return do_allocate(bytes, alignment);`.
        *
        * @par Exceptions
        *   The code itself throws nothing, but if the out of memory
@@ -1285,7 +1577,11 @@ namespace os
       memory_resource::allocate (std::size_t bytes, std::size_t alignment)
       {
         ++allocations_;
-        return do_allocate (bytes, alignment);
+        if (shrinkers_ == nullptr)
+          {
+            return do_allocate (bytes, alignment);
+          }
+        return internal_allocate_ (bytes, alignment, false);
       }
 
       /**
@@ -1309,6 +1605,11 @@ namespace os
       {
         ++deallocations_;
         do_deallocate (addr, bytes, alignment);
+
+        if (reserve_ == nullptr && reserve_bytes_ != 0)
+          {
+            internal_rearm_reserve_ ();
+          }
       }
 
       /**
@@ -1347,7 +1648,14 @@ namespace os
       inline void
       memory_resource::reset (void) noexcept
       {
+        // The reserve block is discarded with all other blocks.
+        reserve_ = nullptr;
         do_reset ();
+
+        if (reserve_bytes_ != 0)
+          {
+            internal_rearm_reserve_ ();
+          }
       }
 
       /**
@@ -1366,6 +1674,45 @@ namespace os
         return do_coalesce ();
       }
 
+      /**
+       * @details
+       * Change the size of a block without moving it, either by
+       * returning the unused end to the free space, or by growing
+       * it into the adjacent free space, if available.
+       *
+       * If the operation fails, the block is not changed, and it
+       * is the caller responsibility to allocate a new block, to copy
+       * the content and to deallocate the old block.
+       *
+       * @see do_try_resize();
+       */
+      inline bool
+      memory_resource::try_resize (void* addr, std::size_t bytes,
+                                   std::size_t new_bytes) noexcept
+      {
+        return do_try_resize (addr, bytes, new_bytes);
+      }
+
+      /**
+       * @details
+       * Each call continues from where the previous one stopped,
+       * and checks at most _chunks_ chunks, so the cost of each
+       * call is bounded; after the last chunk, the check starts
+       * again with the first one.
+       *
+       * Call it with the scheduler locked, like the other functions.
+       *
+       * @see do_verify();
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      inline const void*
+      memory_resource::verify (std::size_t chunks) noexcept
+      {
+        return do_verify (chunks);
+      }
+
       /**
        * @details
        *
@@ -1395,6 +1742,26 @@ namespace os
         return out_of_memory_handler_;
       }
 
+      /**
+       * @details
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      inline std::size_t
+      memory_resource::emergency_reserve (void) const
+      {
+        return (reserve_ != nullptr) ? reserve_bytes_ : 0;
+      }
+
+      // ======================================================================
+
+      inline std::size_t
+      shrinker::reclaimed_bytes (void) const
+      {
+        return reclaimed_bytes_;
+      }
+
       inline std::size_t
       memory_resource::total_bytes (void)
       {
@@ -1431,6 +1798,41 @@ namespace os
         return free_chunks_;
       }
 
+      /**
+       * @details
+       * The largest block that can be allocated, with the default
+       * alignment; useful before large allocations, to check
+       * if they will succeed.
+       *
+       * @see do_max_free_chunk();
+       */
+      inline std::size_t
+      memory_resource::max_free_chunk (void) noexcept
+      {
+        return do_max_free_chunk ();
+      }
+
+      /**
+       * @details
+       * Computed as `100 - 100 * max_free_chunk() / free_bytes()`;
+       * 0 means all free memory is in one chunk, values close
+       * to 100 mean the free memory is split in many small chunks.
+       *
+       * If the largest free chunk is not known, the result is 0.
+       */
+      inline std::size_t
+      memory_resource::fragmentation (void) noexcept
+      {
+        std::size_t max = max_free_chunk ();
+        if ((max == 0) || (free_bytes_ == 0) || (max >= free_bytes_))
+          {
+            return 0;
+          }
+        // Round down, so the header of a single free chunk
+        // does not count as fragmentation.
+        return ((free_bytes_ - max) * 100) / free_bytes_;
+      }
+
       inline std::size_t
       memory_resource::allocations (void)
       {
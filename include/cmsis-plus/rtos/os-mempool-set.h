@@ -0,0 +1,613 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_MEMPOOL_SET_H_
+#define CMSIS_PLUS_RTOS_OS_MEMPOOL_SET_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <tuple>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Set of **memory pools** with different block sizes.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mempool
+     */
+    class memory_pool_set : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of size class index.
+       * @ingroup cmsis-plus-rtos-mempool
+       */
+      using index_t = std::size_t;
+
+      /**
+       * @brief Maximum number of pools in a set.
+       * @ingroup cmsis-plus-rtos-mempool
+       */
+      static constexpr index_t max_size =
+          OS_INTEGER_RTOS_MEMORY_POOL_SET_MAX_SIZE;
+
+      // ======================================================================
+
+      /**
+       * @brief Memory pool set attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-mempool
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory pool set attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the memory pool set attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+        // Add more attributes here.
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default memory pool set initialiser.
+       * @ingroup cmsis-plus-rtos-mempool
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @brief Usage counters of a size class.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-mempool
+       */
+      struct usage_counters
+      {
+        /**
+         * @brief Number of blocks allocated from this class.
+         */
+        statistics::counter_t allocations;
+
+        /**
+         * @brief Number of blocks allocated from this class
+         * because the smaller fitting classes were full.
+         */
+        statistics::counter_t fallbacks;
+
+        /**
+         * @brief Maximum number of blocks allocated at the same time.
+         */
+        std::size_t count_max;
+      };
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory pool set object instance.
+       * @param [in] pools Array of pointers to pools, in increasing
+       *  block size order.
+       * @param [in] size The number of pools in the array.
+       * @param [in] attr Reference to attributes.
+       */
+      memory_pool_set (memory_pool* const pools[], index_t size,
+                       const attributes& attr = initializer);
+
+      /**
+       * @brief Construct a named memory pool set object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] pools Array of pointers to pools, in increasing
+       *  block size order.
+       * @param [in] size The number of pools in the array.
+       * @param [in] attr Reference to attributes.
+       */
+      memory_pool_set (const char* name, memory_pool* const pools[],
+                       index_t size, const attributes& attr = initializer);
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Used by the derived classes, which own the pools and
+      // complete the construction later.
+      memory_pool_set (const char* name, const attributes& attr);
+
+      /**
+       * @endcond
+       */
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      memory_pool_set (const memory_pool_set&) = delete;
+      memory_pool_set (memory_pool_set&&) = delete;
+      memory_pool_set&
+      operator= (const memory_pool_set&) = delete;
+      memory_pool_set&
+      operator= (memory_pool_set&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory pool set object instance.
+       */
+      ~memory_pool_set ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare memory pool sets.
+       * @retval true The given memory pool set is the same as this one.
+       * @retval false The memory pool sets are different.
+       */
+      bool
+      operator== (const memory_pool_set& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Allocate a memory block.
+       * @param [in] bytes The requested size, in bytes.
+       * @return Pointer to memory block, or `nullptr` if interrupted
+       *  or if no class fits.
+       */
+      void*
+      alloc (std::size_t bytes);
+
+      /**
+       * @brief Try to allocate a memory block.
+       * @param [in] bytes The requested size, in bytes.
+       * @return Pointer to memory block, or `nullptr` if no memory
+       *  available.
+       */
+      void*
+      try_alloc (std::size_t bytes);
+
+      /**
+       * @brief Allocate a memory block with timeout.
+       * @param [in] bytes The requested size, in bytes.
+       * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+       * @return Pointer to memory block, or `nullptr` if timeout.
+       */
+      void*
+      timed_alloc (std::size_t bytes, clock::duration_t timeout);
+
+      /**
+       * @brief Free the memory block.
+       * @param [in] block Pointer to memory block to free.
+       * @retval result::ok The memory block was released.
+       * @retval EINVAL The block does not belong to any pool in the set.
+       */
+      result_t
+      free (void* block);
+
+      /**
+       * @brief Find the pool owning a memory block.
+       * @param [in] block Pointer to memory block.
+       * @return Pointer to the pool, or `nullptr` if the block does
+       *  not belong to the set.
+       */
+      memory_pool*
+      owner (void* block) const;
+
+      /**
+       * @brief Get the number of size classes.
+       * @par Parameters
+       *  None.
+       * @return The number of pools in the set.
+       */
+      index_t
+      size (void) const;
+
+      /**
+       * @brief Get the pool of a size class.
+       * @param [in] index The size class index.
+       * @return Reference to the pool.
+       */
+      memory_pool&
+      pool (index_t index) const;
+
+      /**
+       * @brief Get the largest block size.
+       * @par Parameters
+       *  None.
+       * @return The block size of the last class, in bytes.
+       */
+      std::size_t
+      max_block_size (void) const;
+
+      /**
+       * @brief Get the usage counters of a size class.
+       * @param [in] index The size class index.
+       * @return Reference to the counters.
+       */
+      const usage_counters&
+      usage (index_t index) const;
+
+      /**
+       * @brief Get the number of failed allocations.
+       * @par Parameters
+       *  None.
+       * @return The number of allocations that returned `nullptr`.
+       */
+      statistics::counter_t
+      failures (void) const;
+
+      /**
+       * @brief Clear the usage counters.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clear_usage (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_construct_ (memory_pool* const pools[], index_t size);
+
+      index_t
+      internal_first_fit_ (std::size_t bytes) const;
+
+      void*
+      internal_try_alloc_ (index_t first);
+
+      void*
+      internal_alloc_ (std::size_t bytes, bool timed,
+                       clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      memory_pool* pools_[max_size];
+      usage_counters usage_[max_size];
+
+      clock* clock_ = nullptr;
+
+      index_t size_ = 0;
+
+      statistics::counter_t failures_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Set of memory pools that includes the pools.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mempool
+     * @tparam Pools Types of the pools, usually `memory_pool_inclusive<>`,
+     *  in increasing block size order.
+     */
+    template<typename ... Pools>
+      class memory_pool_set_inclusive : public memory_pool_set
+      {
+      public:
+
+        static_assert(sizeof...(Pools) > 0, "At least one pool is required");
+        static_assert(sizeof...(Pools) <= memory_pool_set::max_size,
+            "Too many pools, increase OS_INTEGER_RTOS_MEMORY_POOL_SET_MAX_SIZE");
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory pool set object instance.
+         * @param [in] attr Reference to attributes.
+         */
+        memory_pool_set_inclusive (const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named memory pool set object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] attr Reference to attributes.
+         */
+        memory_pool_set_inclusive (const char* name, const attributes& attr =
+                                       initializer);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        memory_pool_set_inclusive (const memory_pool_set_inclusive&) = delete;
+        memory_pool_set_inclusive (memory_pool_set_inclusive&&) = delete;
+        memory_pool_set_inclusive&
+        operator= (const memory_pool_set_inclusive&) = delete;
+        memory_pool_set_inclusive&
+        operator= (memory_pool_set_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory pool set object instance.
+         */
+        ~memory_pool_set_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        template<std::size_t ... I>
+          void
+          internal_construct_pools_ (std::index_sequence<I...>);
+
+        std::tuple<Pools...> storage_;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    memory_pool_set::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * This constructor shall initialise a memory pool set with the
+     * pools referenced by _pools_ and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline
+    memory_pool_set::memory_pool_set (memory_pool* const pools[],
+                                      index_t size, const attributes& attr) :
+        memory_pool_set
+          { nullptr, pools, size, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Identical memory pool sets should have the same memory address.
+     */
+    inline bool
+    memory_pool_set::operator== (const memory_pool_set& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    inline memory_pool_set::index_t
+    memory_pool_set::size (void) const
+    {
+      return size_;
+    }
+
+    inline memory_pool&
+    memory_pool_set::pool (index_t index) const
+    {
+      assert(index < size_);
+      return *pools_[index];
+    }
+
+    inline const memory_pool_set::usage_counters&
+    memory_pool_set::usage (index_t index) const
+    {
+      assert(index < size_);
+      return usage_[index];
+    }
+
+    inline statistics::counter_t
+    memory_pool_set::failures (void) const
+    {
+      return failures_;
+    }
+
+    // ========================================================================
+
+    template<typename ... Pools>
+      memory_pool_set_inclusive<Pools...>::memory_pool_set_inclusive (
+          const attributes& attr) :
+          memory_pool_set_inclusive
+            { nullptr, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * The pools are default constructed, as members of this object,
+     * and are then registered in the set.
+     */
+    template<typename ... Pools>
+      memory_pool_set_inclusive<Pools...>::memory_pool_set_inclusive (
+          const char* name, const attributes& attr) :
+          memory_pool_set
+            { name, attr }
+      {
+        internal_construct_pools_ (std::index_sequence_for<Pools...>
+          { });
+      }
+
+    template<typename ... Pools>
+      memory_pool_set_inclusive<Pools...>::~memory_pool_set_inclusive ()
+      {
+        ;
+      }
+
+    template<typename ... Pools>
+      template<std::size_t ... I>
+        void
+        memory_pool_set_inclusive<Pools...>::internal_construct_pools_ (
+            std::index_sequence<I...>)
+        {
+          memory_pool* const pools[] =
+            { &std::get<I> (storage_)... };
+          internal_construct_ (pools, sizeof...(Pools));
+        }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_MEMPOOL_SET_H_ */
@@ -34,6 +34,8 @@
 
 #include <cmsis-plus/rtos/os-decls.h>
 #include <cmsis-plus/rtos/os-memory.h>
+#include <cmsis-plus/rtos/internal/os-free-list.h>
+#include <cmsis-plus/rtos/os-footprint.h>
 
 #include <cmsis-plus/diag/trace.h>
 
@@ -139,6 +141,16 @@ namespace os
          */
         std::size_t mp_pool_size_bytes = 0;
 
+        /**
+         * @brief Name of the memory region for the memory pool storage.
+         * @details
+         * If not `nullptr` and a resource was registered with
+         * `memory::set_region()` under this name, the storage is
+         * allocated from that resource, otherwise the pool
+         * allocator is used. Ignored if `mp_pool_address` is set.
+         */
+        const char* mp_pool_region = nullptr;
+
         // Add more attributes here.
 
         /**
@@ -324,6 +336,48 @@ namespace os
       result_t
       free (void* block);
 
+      /**
+       * @brief Allocate a batch of memory blocks.
+       * @param [in] count The maximum number of blocks to allocate.
+       * @param [out] blocks Array of at least `count` pointers.
+       * @return The number of blocks allocated, at least one,
+       *  or 0 if interrupted.
+       */
+      std::size_t
+      alloc_n (std::size_t count, void* blocks[]);
+
+      /**
+       * @brief Try to allocate a batch of memory blocks.
+       * @param [in] count The maximum number of blocks to allocate.
+       * @param [out] blocks Array of at least `count` pointers.
+       * @return The number of blocks allocated, possibly 0.
+       */
+      std::size_t
+      try_alloc_n (std::size_t count, void* blocks[]);
+
+      /**
+       * @brief Allocate a batch of memory blocks with timeout.
+       * @param [in] count The maximum number of blocks to allocate.
+       * @param [out] blocks Array of at least `count` pointers.
+       * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+       * @return The number of blocks allocated, at least one,
+       *  or 0 if timeout or interrupted.
+       */
+      std::size_t
+      timed_alloc_n (std::size_t count, void* blocks[],
+                     clock::duration_t timeout);
+
+      /**
+       * @brief Free a batch of memory blocks.
+       * @param [in] count The number of blocks to free.
+       * @param [in] blocks Array of `count` pointers to memory blocks.
+       * @retval result::ok The memory blocks were released.
+       * @retval EINVAL A block does not belong to the memory pool;
+       *  no block was released.
+       */
+      result_t
+      free_n (std::size_t count, void* blocks[]);
+
       /**
        * @brief Get memory pool capacity.
        * @par Parameters
@@ -437,6 +491,31 @@ namespace os
       void*
       internal_try_first_ (void);
 
+      /**
+       * @brief Internal function used to get a batch of linked blocks.
+       * @param [in] count The maximum number of blocks.
+       * @param [out] blocks Array of at least `count` pointers.
+       * @return The number of blocks, possibly 0.
+       */
+      std::size_t
+      internal_try_first_n_ (std::size_t count, void* blocks[]);
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+      static void
+      internal_describe_footprint_ (const void* object, footprint::item& it);
+
+#endif
+
+      /**
+       * @brief Internal function used to check a block address.
+       * @param [in] block Pointer to memory block.
+       * @retval true The block belongs to the memory pool.
+       * @retval false The block is outside the pool storage.
+       */
+      bool
+      internal_is_valid_ (void* block) const;
+
       /**
        * @endcond
        */
@@ -456,7 +535,10 @@ namespace os
        * @cond ignore
        */
 
+      friend class memory_pool_set;
+
 #if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+      friend class wait_set;
       /**
        * @brief List of threads waiting to alloc.
        */
@@ -482,6 +564,11 @@ namespace os
        */
       const void* allocator_ = nullptr;
 
+      /**
+       * @brief Pointer to the region resource used for the pool, if any.
+       */
+      memory::memory_resource* allocated_pool_resource_ = nullptr;
+
 #if defined(OS_USE_RTOS_PORT_MEMORY_POOL)
       friend class port::memory_pool;
       os_mempool_port_data_t port_;
@@ -512,11 +599,28 @@ namespace os
        */
       volatile memory_pool::size_t count_ = 0;
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      /**
+       * @brief The list of free blocks.
+       */
+      internal::free_list free_list_;
+
+#else
+
       /**
        * @brief Pointer to the first free block, or nullptr.
        */
       void* volatile first_ = nullptr;
 
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+      // The last member, registered when all others are initialised.
+      footprint::node footprint_node_
+        { "mempool", this, internal_describe_footprint_ };
+#endif
+
       /**
        * @endcond
        */
@@ -34,6 +34,7 @@
 
 #include <cmsis-plus/rtos/os-decls.h>
 #include <cmsis-plus/rtos/os-memory.h>
+#include <cmsis-plus/rtos/os-footprint.h>
 
 #include <cmsis-plus/diag/trace.h>
 
@@ -132,6 +133,23 @@ namespace os
        */
       static constexpr priority_t max_priority = 0xFF;
 
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      /**
+       * @brief Number of message priorities.
+       * @details
+       * Messages must have priorities lower than this value.
+       * @ingroup cmsis-plus-rtos-mqueue
+       */
+      static constexpr std::size_t priorities =
+      OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES;
+
+      static_assert(priorities > 0 && priorities <= max_priority + 1u,
+          "OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES must be 1-256");
+
+#endif
+
       // ======================================================================
 
       /**
@@ -192,6 +210,21 @@ namespace os
          */
         std::size_t mq_queue_size_bytes = 0;
 
+        /**
+         * @brief Store the actual length of each message.
+         */
+        bool mq_store_lengths = false;
+
+        /**
+         * @brief Name of the memory region for the message queue storage.
+         * @details
+         * If not `nullptr` and a resource was registered with
+         * `memory::set_region()` under this name, the storage is
+         * allocated from that resource, otherwise the queue
+         * allocator is used. Ignored if `mq_queue_address` is set.
+         */
+        const char* mq_queue_region = nullptr;
+
         // Add more attributes here.
 
         /**
@@ -206,6 +239,168 @@ namespace os
        */
       static const attributes initializer;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      // ======================================================================
+
+      /**
+       * @brief Message queue statistics.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-mqueue
+       *
+       * @details
+       * All durations are in high resolution clock cycles.
+       */
+      class statistics
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a message queue statistics object instance.
+         * @par Parameters
+         *  None.
+         */
+        statistics () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        statistics (const statistics&) = delete;
+        statistics (statistics&&) = delete;
+        statistics&
+        operator= (const statistics&) = delete;
+        statistics&
+        operator= (statistics&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the message queue statistics object instance.
+         */
+        ~statistics () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the maximum queue depth.
+         * @par Parameters
+         *  None.
+         * @return The largest number of messages ever in the queue.
+         */
+        std::size_t
+        depth_max (void) const;
+
+        /**
+         * @brief Get the number of blocked sends.
+         * @par Parameters
+         *  None.
+         * @return The number of sends which found the queue full
+         *  and had to wait.
+         */
+        rtos::statistics::counter_t
+        send_blocked (void) const;
+
+        /**
+         * @brief Get the number of blocked receives.
+         * @par Parameters
+         *  None.
+         * @return The number of receives which found the queue empty
+         *  and had to wait.
+         */
+        rtos::statistics::counter_t
+        receive_blocked (void) const;
+
+        /**
+         * @brief Get the number of received messages.
+         * @par Parameters
+         *  None.
+         * @return The number of messages included in the latency.
+         */
+        rtos::statistics::counter_t
+        received (void) const;
+
+        /**
+         * @brief Get the total time spent by messages in the queue.
+         * @par Parameters
+         *  None.
+         * @return The sum of all enqueue to dequeue latencies.
+         */
+        rtos::statistics::duration_t
+        latency_total (void) const;
+
+        /**
+         * @brief Get the longest time spent by a message in the queue.
+         * @par Parameters
+         *  None.
+         * @return The longest enqueue to dequeue latency.
+         */
+        rtos::statistics::duration_t
+        latency_max (void) const;
+
+        /**
+         * @brief Clear all statistics.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        clear (void);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class message_queue;
+
+        rtos::statistics::counter_t send_blocked_ = 0;
+        rtos::statistics::counter_t receive_blocked_ = 0;
+        rtos::statistics::counter_t received_ = 0;
+        rtos::statistics::duration_t latency_total_ = 0;
+        rtos::statistics::duration_t latency_max_ = 0;
+        message_queue::size_t depth_max_ = 0;
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @brief Type of the enqueue timestamps.
+       * @details
+       * The low word of the high resolution clock is enough
+       * for the latency of messages which wait less than
+       * a full wrap.
+       */
+      using stamp_t = uint32_t;
+
+#endif
+
       /**
        * @brief Default RTOS allocator.
        * @ingroup cmsis-plus-rtos-mqueue
@@ -227,19 +422,26 @@ namespace os
           T queue[(msgs * msg_size_bytes + sizeof(T) - 1) / sizeof(T)];
           T links[((2 * msgs) * sizeof(index_t) + sizeof(T) - 1) / sizeof(T)];
           T prios[(msgs * sizeof(priority_t) + sizeof(T) - 1) / sizeof(T)];
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+          T stamps[(msgs * sizeof(stamp_t) + sizeof(T) - 1) / sizeof(T)];
+#endif
         };
 
       /**
        * @brief Calculator for queue storage requirements.
        * @param msgs Number of messages.
        * @param msg_size_bytes Size of message.
+       * @param store_lengths Reserve space for the message lengths
+       *  (see `attributes::mq_store_lengths`).
        * @return Total required storage in bytes, including
        * internal alignment.
        */
       template<typename T>
         constexpr std::size_t
         compute_allocated_size_bytes (std::size_t msgs,
-                                      std::size_t msg_size_bytes)
+                                      std::size_t msg_size_bytes,
+                                      bool store_lengths = false)
         {
           // Align each message
           return (msgs * ((msg_size_bytes + (sizeof(T) - 1)) & ~(sizeof(T) - 1)))
@@ -248,7 +450,19 @@ namespace os
                   & ~(sizeof(T) - 1))
               // Align the priority array
               + ((msgs * sizeof(priority_t) + (sizeof(T) - 1))
-                  & ~(sizeof(T) - 1));
+                  & ~(sizeof(T) - 1))
+              // Align the optional lengths array
+              + (store_lengths ?
+                  ((msgs * sizeof(msg_size_t) + (sizeof(T) - 1))
+                      & ~(sizeof(T) - 1)) :
+                  0)
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+              // Align the timestamps array
+              + ((msgs * sizeof(stamp_t) + (sizeof(T) - 1))
+                  & ~(sizeof(T) - 1))
+#endif
+              ;
         }
 
       // ======================================================================
@@ -417,6 +631,8 @@ namespace os
        *  be lower than the value used when creating the queue.
        * @param [out] mprio The address where to store the message
        *  priority. The default is `nullptr`.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
        * @retval result::ok The message was received.
        * @retval EINVAL A parameter is invalid or outside of a permitted range.
        * @retval EMSGSIZE The specified message length, nbytes, is
@@ -429,7 +645,8 @@ namespace os
        * @retval EINTR The operation was interrupted.
        */
       result_t
-      receive (void* msg, std::size_t nbytes, priority_t* mprio = nullptr);
+      receive (void* msg, std::size_t nbytes, priority_t* mprio = nullptr,
+               std::size_t* length = nullptr);
 
       /**
        * @brief Try to receive a message from the queue.
@@ -438,6 +655,8 @@ namespace os
        *  be lower than the value used when creating the queue.
        * @param [out] mprio The address where to store the message
        *  priority. The default is `nullptr`.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
        * @retval result::ok The message was received.
        * @retval EINVAL A parameter is invalid or outside of a permitted range.
        * @retval EMSGSIZE The specified message length, nbytes, is
@@ -449,7 +668,8 @@ namespace os
        * @retval EWOULDBLOCK The specified message queue is empty.
        */
       result_t
-      try_receive (void* msg, std::size_t nbytes, priority_t* mprio = nullptr);
+      try_receive (void* msg, std::size_t nbytes, priority_t* mprio = nullptr,
+                   std::size_t* length = nullptr);
 
       /**
        * @brief Receive a message from the queue with timeout.
@@ -459,6 +679,8 @@ namespace os
        * @param [in] timeout The timeout duration.
        * @param [out] mprio The address where to store the message
        *  priority. The default is `nullptr`.
+       * @param [out] length The address where to store the message
+       *  length. The default is `nullptr`.
        * @retval result::ok The message was received.
        * @retval EINVAL A parameter is invalid or outside of a permitted range.
        * @retval EMSGSIZE The specified message length, nbytes, is
@@ -474,7 +696,250 @@ namespace os
        */
       result_t
       timed_receive (void* msg, std::size_t nbytes, clock::duration_t timeout,
-                     priority_t* mprio = nullptr);
+                     priority_t* mprio = nullptr, std::size_t* length = nullptr);
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      /**
+       * @brief Allocate a message slot for zero-copy send.
+       * @par Parameters
+       *  None.
+       * @return Pointer to a slot of `msg_size()` bytes in the queue
+       *  storage, or `nullptr` if interrupted.
+       */
+      void*
+      alloc_slot (void);
+
+      /**
+       * @brief Try to allocate a message slot for zero-copy send.
+       * @par Parameters
+       *  None.
+       * @return Pointer to a slot of `msg_size()` bytes in the queue
+       *  storage, or `nullptr` if the queue is full.
+       */
+      void*
+      try_alloc_slot (void);
+
+      /**
+       * @brief Allocate a message slot for zero-copy send, with timeout.
+       * @param [in] timeout The timeout duration.
+       * @return Pointer to a slot of `msg_size()` bytes in the queue
+       *  storage, or `nullptr` if timeout or interrupted.
+       */
+      void*
+      timed_alloc_slot (clock::duration_t timeout);
+
+      /**
+       * @brief Publish an allocated slot as a message.
+       * @param [in] slot Pointer to the slot returned by `alloc_slot()`.
+       * @param [in] mprio The message priority. The default is 0.
+       * @retval result::ok The message was enqueued.
+       * @retval EINVAL The pointer is not a slot of this queue,
+       *  or the priority is not valid.
+       */
+      result_t
+      commit (void* slot, priority_t mprio = default_priority);
+
+      /**
+       * @brief Receive a reference to a message from the queue.
+       * @param [out] slot The address where to store the pointer
+       *  to the message slot.
+       * @param [out] mprio The address where to store the message
+       *  priority. The default is `nullptr`.
+       * @retval result::ok The message was dequeued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      receive_ref (void** slot, priority_t* mprio = nullptr);
+
+      /**
+       * @brief Try to receive a reference to a message from the queue.
+       * @param [out] slot The address where to store the pointer
+       *  to the message slot.
+       * @param [out] mprio The address where to store the message
+       *  priority. The default is `nullptr`.
+       * @retval result::ok The message was dequeued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EWOULDBLOCK The specified message queue is empty.
+       */
+      result_t
+      try_receive_ref (void** slot, priority_t* mprio = nullptr);
+
+      /**
+       * @brief Receive a reference to a message from the queue,
+       *  with timeout.
+       * @param [out] slot The address where to store the pointer
+       *  to the message slot.
+       * @param [in] timeout The timeout duration.
+       * @param [out] mprio The address where to store the message
+       *  priority. The default is `nullptr`.
+       * @retval result::ok The message was dequeued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No message arrived on the queue before the
+       *  specified timeout expired.
+       */
+      result_t
+      timed_receive_ref (void** slot, clock::duration_t timeout,
+                         priority_t* mprio = nullptr);
+
+      /**
+       * @brief Return a slot to the queue.
+       * @param [in] slot Pointer to a slot returned by `receive_ref()`,
+       *  or by `alloc_slot()` and not committed.
+       * @retval result::ok The slot was released.
+       * @retval EINVAL The pointer is not a slot of this queue.
+       */
+      result_t
+      release (void* slot);
+
+      /**
+       * @brief Send several messages to the queue.
+       * @param [in] msgs The address of an array of messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The length of each message, which is
+       *  also the array stride. Must be not
+       *  higher than the value used when creating the queue.
+       * @param [out] sent The address where to store the number
+       *  of messages sent; may be `nullptr`.
+       * @param [in] mprio The priority of all messages. The default is 0.
+       * @retval result::ok At least one message was enqueued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes,
+       *  exceeds the message size attribute of the message queue.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      send_n (const void* msgs, std::size_t count, std::size_t nbytes,
+              std::size_t* sent = nullptr, priority_t mprio =
+                  default_priority);
+
+      /**
+       * @brief Try to send several messages to the queue.
+       * @param [in] msgs The address of an array of messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The length of each message, which is
+       *  also the array stride. Must be not
+       *  higher than the value used when creating the queue.
+       * @param [out] sent The address where to store the number
+       *  of messages sent; may be `nullptr`.
+       * @param [in] mprio The priority of all messages. The default is 0.
+       * @retval result::ok At least one message was enqueued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes,
+       *  exceeds the message size attribute of the message queue.
+       * @retval EWOULDBLOCK The specified message queue is full.
+       */
+      result_t
+      try_send_n (const void* msgs, std::size_t count, std::size_t nbytes,
+                  std::size_t* sent = nullptr, priority_t mprio =
+                      default_priority);
+
+      /**
+       * @brief Send several messages to the queue with timeout.
+       * @param [in] msgs The address of an array of messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The length of each message, which is
+       *  also the array stride. Must be not
+       *  higher than the value used when creating the queue.
+       * @param [in] timeout The timeout duration.
+       * @param [out] sent The address where to store the number
+       *  of messages sent; may be `nullptr`.
+       * @param [in] mprio The priority of all messages. The default is 0.
+       * @retval result::ok At least one message was enqueued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes,
+       *  exceeds the message size attribute of the message queue.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT The message queue stayed full
+       *  until the timeout expired.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_send_n (const void* msgs, std::size_t count, std::size_t nbytes,
+                    clock::duration_t timeout, std::size_t* sent = nullptr,
+                    priority_t mprio = default_priority);
+
+      /**
+       * @brief Receive several messages from the queue.
+       * @param [out] msgs The address of an array where to store
+       *  the dequeued messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The size of each array element. Must
+       *  be lower than the value used when creating the queue.
+       * @param [out] received The address where to store the number
+       *  of messages received; may be `nullptr`.
+       * @param [out] mprios The address of an array of _count_
+       *  elements where to store the message priorities;
+       *  may be `nullptr`.
+       * @retval result::ok At least one message was received.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes, is
+       *  greater than the message size attribute of the message queue.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      receive_n (void* msgs, std::size_t count, std::size_t nbytes,
+                 std::size_t* received = nullptr, priority_t* mprios =
+                     nullptr);
+
+      /**
+       * @brief Try to receive several messages from the queue.
+       * @param [out] msgs The address of an array where to store
+       *  the dequeued messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The size of each array element. Must
+       *  be lower than the value used when creating the queue.
+       * @param [out] received The address where to store the number
+       *  of messages received; may be `nullptr`.
+       * @param [out] mprios The address of an array of _count_
+       *  elements where to store the message priorities;
+       *  may be `nullptr`.
+       * @retval result::ok At least one message was received.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes, is
+       *  greater than the message size attribute of the message queue.
+       * @retval EWOULDBLOCK The specified message queue is empty.
+       */
+      result_t
+      try_receive_n (void* msgs, std::size_t count, std::size_t nbytes,
+                     std::size_t* received = nullptr, priority_t* mprios =
+                         nullptr);
+
+      /**
+       * @brief Receive several messages from the queue with timeout.
+       * @param [out] msgs The address of an array where to store
+       *  the dequeued messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The size of each array element. Must
+       *  be lower than the value used when creating the queue.
+       * @param [in] timeout The timeout duration.
+       * @param [out] received The address where to store the number
+       *  of messages received; may be `nullptr`.
+       * @param [out] mprios The address of an array of _count_
+       *  elements where to store the message priorities;
+       *  may be `nullptr`.
+       * @retval result::ok At least one message was received.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes, is
+       *  greater than the message size attribute of the message queue.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No message arrived on the queue before the
+       *  specified timeout expired.
+       */
+      result_t
+      timed_receive_n (void* msgs, std::size_t count, std::size_t nbytes,
+                       clock::duration_t timeout, std::size_t* received =
+                           nullptr,
+                       priority_t* mprios = nullptr);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
 
       // TODO: check if some kind of peek() is useful.
 
@@ -535,6 +1000,20 @@ namespace os
       result_t
       reset (void);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      /**
+       * @brief Get the message queue statistics.
+       * @par Parameters
+       *  None.
+       * @return Reference to the statistics.
+       */
+      class message_queue::statistics&
+      statistics (void);
+
+#endif
+
       /**
        * @}
        */
@@ -601,10 +1080,189 @@ namespace os
        * @retval false There are not messages in the queue.
        */
       bool
-      internal_try_receive_ (void* msg, std::size_t nbytes, priority_t* mprio);
+      internal_try_receive_ (void* msg, std::size_t nbytes, priority_t* mprio,
+                             std::size_t* length);
+
+      /**
+       * @brief Internal function used to enqueue a message, without
+       *  resuming the receivers.
+       * @param [in] msg The address of the message to enqueue.
+       * @param [in] nbytes The length of the message.
+       * @param [in] mprio The message priority.
+       * @retval true The message was enqueued.
+       * @retval false The message queue is full.
+       */
+      bool
+      internal_enqueue_ (const void* msg, std::size_t nbytes,
+                         priority_t mprio);
+
+      /**
+       * @brief Internal function used to dequeue a message, without
+       *  resuming the senders.
+       * @param [out] msg The address where to store the dequeued message.
+       * @param [in] nbytes The size of the destination buffer.
+       * @param [out] mprio The address where to store the message
+       *  priority.
+       * @retval true The message was dequeued.
+       * @retval false There are not messages in the queue.
+       */
+      bool
+      internal_dequeue_ (void* msg, std::size_t nbytes, priority_t* mprio,
+                         std::size_t* length);
+
+      /**
+       * @brief Internal function used to enqueue several messages,
+       *  resuming the receivers once.
+       * @param [in] msgs The address of an array of messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The length of each message.
+       * @param [in] mprio The priority of all messages.
+       * @return The number of messages enqueued.
+       */
+      std::size_t
+      internal_try_send_n_ (const void* msgs, std::size_t count,
+                            std::size_t nbytes, priority_t mprio);
+
+      /**
+       * @brief Internal function used to dequeue several messages,
+       *  resuming the senders once.
+       * @param [out] msgs The address of an array where to store
+       *  the dequeued messages.
+       * @param [in] count The number of messages in the array.
+       * @param [in] nbytes The size of each array element.
+       * @param [out] mprios The address of an array where to store
+       *  the message priorities; may be `nullptr`.
+       * @return The number of messages dequeued.
+       */
+      std::size_t
+      internal_try_receive_n_ (void* msgs, std::size_t count,
+                               std::size_t nbytes, priority_t* mprios);
+
+      /**
+       * @brief Internal function used to send several messages,
+       *  waiting for space if needed.
+       */
+      result_t
+      internal_send_n_ (const void* msgs, std::size_t count,
+                        std::size_t nbytes, std::size_t* sent,
+                        priority_t mprio, bool timed,
+                        clock::duration_t timeout);
+
+      /**
+       * @brief Internal function used to receive several messages,
+       *  waiting for one if needed.
+       */
+      result_t
+      internal_receive_n_ (void* msgs, std::size_t count, std::size_t nbytes,
+                           std::size_t* received, priority_t* mprios,
+                           bool timed, clock::duration_t timeout);
+
+      /**
+       * @brief Internal function used to take a slot from the free list.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the slot, or `nullptr` if the queue is full.
+       */
+      char*
+      internal_alloc_slot_ (void);
+
+      /**
+       * @brief Internal function used to get the distance between slots.
+       * @par Parameters
+       *  None.
+       * @return The message size, rounded up to a multiple of
+       *  the pointer size.
+       */
+      std::size_t
+      internal_slot_size_ (void) const;
+
+      /**
+       * @brief Internal function used to link a slot to the messages list.
+       * @param [in] slot Pointer to the slot.
+       * @param [in] mprio The message priority.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_commit_slot_ (char* slot, std::size_t nbytes, priority_t mprio);
+
+      /**
+       * @brief Internal function used to unlink the head message.
+       * @param [out] mprio The address where to store the message
+       *  priority.
+       * @return Pointer to the slot, or `nullptr` if the queue is empty.
+       */
+      char*
+      internal_take_head_ (priority_t* mprio);
+
+      /**
+       * @brief Internal function used to return a slot to the free list.
+       * @param [in] slot Pointer to the slot.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_release_slot_ (char* slot);
+
+      /**
+       * @brief Internal function used to check a slot pointer.
+       * @param [in] slot Pointer to the slot.
+       * @retval true The pointer is the beginning of a slot.
+       * @retval false The pointer is not in the queue storage.
+       */
+      bool
+      internal_is_slot_ (const void* slot) const;
+
+      /**
+       * @brief Internal function used to wait for a free slot.
+       * @param [in] timed If true, wait at most _timeout_.
+       * @param [in] timeout The timeout duration.
+       * @return Pointer to the slot, or `nullptr` if timeout or
+       *  interrupted.
+       */
+      void*
+      internal_alloc_slot_wait_ (bool timed, clock::duration_t timeout);
+
+      /**
+       * @brief Internal function used to wait for a message.
+       * @param [out] slot The address where to store the pointer
+       *  to the message slot.
+       * @param [in] timed If true, wait at most _timeout_.
+       * @param [in] timeout The timeout duration.
+       * @param [out] mprio The address where to store the message
+       *  priority.
+       * @retval result::ok The message was dequeued.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No message arrived on the queue before the
+       *  specified timeout expired.
+       */
+      result_t
+      internal_receive_ref_wait_ (void** slot, bool timed,
+                                  clock::duration_t timeout,
+                                  priority_t* mprio);
+
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+
+      /**
+       * @brief Internal function used to find the next priority.
+       * @param [in] mprio The message priority.
+       * @return The lowest priority higher than _mprio_ with messages
+       *  in the queue, or `priorities` if there is none.
+       */
+      std::size_t
+      internal_prio_above_ (priority_t mprio) const;
+
+#endif
 
 #endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
 
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+      static void
+      internal_describe_footprint_ (const void* object, footprint::item& it);
+
+#endif
+
       /**
        * @endcond
        */
@@ -626,6 +1284,9 @@ namespace os
 
       // Keep these in sync with the structure declarations in os-c-decl.h.
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+      friend class wait_set;
+      friend class coroutine::receive_awaiter;
+      friend class coroutine::send_awaiter;
       /**
        * @brief List of threads waiting to send.
        */
@@ -653,6 +1314,17 @@ namespace os
        * @brief Pointer to array of priorities.
        */
       volatile priority_t* prio_array_ = nullptr;
+      /**
+       * @brief Pointer to array of message lengths, or `nullptr`
+       * if lengths are not stored.
+       */
+      volatile msg_size_t* len_array_ = nullptr;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+      /**
+       * @brief Pointer to array of enqueue timestamps.
+       */
+      volatile stamp_t* stamp_array_ = nullptr;
+#endif
 
       /**
        * @brief Pointer to the first free message, or `nullptr`.
@@ -680,6 +1352,10 @@ namespace os
        * @brief Pointer to allocator.
        */
       const void* allocator_ = nullptr;
+      /**
+       * @brief Pointer to the region resource used for the queue, if any.
+       */
+      memory::memory_resource* allocated_queue_resource_ = nullptr;
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
       friend class port::message_queue;
@@ -714,8 +1390,29 @@ namespace os
        * @brief Index of the first message in the queue.
        */
       index_t head_ = 0;
+
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      /**
+       * @brief Bitmap of the priorities with messages in the queue.
+       */
+      uint32_t prio_map_[(priorities + 31) / 32];
+      /**
+       * @brief Index of the last message of each priority.
+       */
+      index_t prio_tails_[priorities];
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+      class statistics statistics_;
+#endif
 #endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
 
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+      // The last member, registered when all others are initialised.
+      footprint::node footprint_node_
+        { "mqueue", this, internal_describe_footprint_ };
+#endif
+
       /**
        * @endcond
        */
@@ -1313,6 +2010,18 @@ namespace os
       return msg_size_bytes_;
     }
 
+    /**
+     * @details
+     * The free slots store the pointer to the next free slot,
+     * so the slots must be large enough and aligned for a pointer;
+     * the storage size computation already assumes this.
+     */
+    inline std::size_t
+    message_queue::internal_slot_size_ (void) const
+    {
+      return (msg_size_bytes_ + (sizeof(void*) - 1)) & ~(sizeof(void*) - 1);
+    }
+
     /**
      * @details
      * @par POSIX compatibility
@@ -1339,6 +2048,81 @@ namespace os
       return (length () == capacity ());
     }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline class message_queue::statistics&
+    message_queue::statistics (void)
+    {
+      return statistics_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    message_queue::statistics::depth_max (void) const
+    {
+      return depth_max_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    message_queue::statistics::send_blocked (void) const
+    {
+      return send_blocked_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    message_queue::statistics::receive_blocked (void) const
+    {
+      return receive_blocked_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    message_queue::statistics::received (void) const
+    {
+      return received_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::duration_t
+    message_queue::statistics::latency_total (void) const
+    {
+      return latency_total_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::duration_t
+    message_queue::statistics::latency_max (void) const
+    {
+      return latency_max_;
+    }
+
+#endif
+
     // ========================================================================
 
     /**
@@ -1428,7 +2212,8 @@ namespace os
             // If no user storage was provided via attributes,
             // allocate it dynamically via the allocator.
             allocated_queue_size_elements_ = (compute_allocated_size_bytes<
-                typename allocator_type::value_type> (msgs, msg_size_bytes)
+                typename allocator_type::value_type> (msgs, msg_size_bytes,
+                                                      attr.mq_store_lengths)
                 + sizeof(typename allocator_type::value_type) - 1)
                 / sizeof(typename allocator_type::value_type);
 
@@ -33,6 +33,8 @@
 #if defined(__cplusplus)
 
 #include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-clocks.h>
+#include <cmsis-plus/rtos/os-footprint.h>
 
 // ----------------------------------------------------------------------------
 
@@ -85,6 +87,10 @@ namespace os
 
               /**
                * @brief Execute at the highest priority.
+               *
+               * @details
+               * The running owner is raised to the ceiling at lock,
+               * without rescheduling, and restored at unlock.
                */
               protect = 2,
 
@@ -287,6 +293,16 @@ namespace os
          */
         count_t mx_max_count = max_count;
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN)
+
+        /**
+         * @brief Attribute with the number of iterations to spin
+         *  while the owner is running, before blocking.
+         */
+        uint32_t mx_spin_count = 0;
+
+#endif
+
         // Add more attributes here.
 
         /**
@@ -368,6 +384,22 @@ namespace os
        */
       mutex (const char* name, const attributes& attr = initializer_normal);
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      /**
+       * @brief Construct a constant initialised mutex object instance.
+       * @param [in] tag The `static_init` tag.
+       * @param [in] name Pointer to name.
+       * @param [in] type The mutex type.
+       * @param [in] protocol The mutex protocol.
+       */
+      constexpr
+      mutex (static_init_t tag, const char* name,
+             type_t type = type::default_,
+             protocol_t protocol = protocol::default_);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
       /**
        * @cond ignore
        */
@@ -583,6 +615,42 @@ namespace os
       robustness_t
       robustness (void);
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      /**
+       * @brief Get the number of successful spins.
+       * @par Parameters
+       *  None.
+       * @return The number of locks acquired while spinning.
+       */
+      uint32_t
+      spin_successes (void) const;
+
+      /**
+       * @brief Get the number of failed spins.
+       * @par Parameters
+       *  None.
+       * @return The number of spins which ended by blocking.
+       */
+      uint32_t
+      spin_failures (void) const;
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+      /**
+       * @brief Get the contention statistics.
+       * @par Parameters
+       *  None.
+       * @return Reference to the statistics.
+       */
+      statistics::sync&
+      sync_statistics (void);
+
+#endif
+
       /**
        * @brief Reset the mutex.
        * @par Parameters
@@ -599,6 +667,8 @@ namespace os
     protected:
 
       friend class thread;
+      friend class condition_variable;
+      friend struct internal::c_api_layout;
 
       /**
        * @name Private Member Functions
@@ -626,6 +696,34 @@ namespace os
       result_t
       internal_try_lock_ (thread* th);
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_FAST_PATH) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      /**
+       * @brief Internal function used to lock a free mutex atomically.
+       * @par th Pointer to thread.
+       * @retval true The mutex was free and is now owned by the thread.
+       * @retval false The slow path must be used.
+       */
+      bool
+      internal_try_lock_fast_ (thread* th);
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      /**
+       * @brief Internal function used to spin while the owner runs.
+       * @par th Pointer to thread.
+       * @retval EWOULDBLOCK The mutex was not locked, block.
+       * @return The result of the lock attempt otherwise.
+       */
+      result_t
+      internal_spin_lock_ (thread* th);
+
+#endif
+
       /**
        * @brief Internal function used to unlock the mutex.
        * @param th Pointer to thread.
@@ -637,6 +735,29 @@ namespace os
       void
       internal_mark_owner_dead_ (void);
 
+      /**
+       * @brief Internal function used to keep the owned mutexes ordered.
+       * @par Parameters
+       *  None.
+       */
+      void
+      internal_link_owned_ (void);
+
+      /**
+       * @brief Internal function used to get the highest boosted priority.
+       * @param th Pointer to the owner thread.
+       * @return The boosted priority of the first owned mutex.
+       */
+      static thread::priority_t
+      internal_owned_max_prio_ (thread* th);
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+      static void
+      internal_describe_footprint_ (const void* object, footprint::item& it);
+
+#endif
+
       /**
        * @endcond
        */
@@ -696,6 +817,24 @@ namespace os
       const robustness_t robustness_; // stalled, robust
       const count_t max_count_;
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+      uint32_t spin_count_ = 0;
+      volatile uint32_t spin_successes_ = 0;
+      volatile uint32_t spin_failures_ = 0;
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      statistics::sync sync_statistics_
+        { this };
+#endif
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+      // The last member, registered when all others are initialised.
+      footprint::node footprint_node_
+        { "mutex", this, internal_describe_footprint_ };
+#endif
+
       // Add more internal data.
 
       /**
@@ -733,6 +872,19 @@ namespace os
       mutex_recursive (const char* name, const attributes& attr =
                            initializer_recursive);
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      /**
+       * @brief Construct a constant initialised recursive mutex
+       *  object instance.
+       * @param [in] tag The `static_init` tag.
+       * @param [in] name Pointer to name.
+       */
+      constexpr
+      mutex_recursive (static_init_t tag, const char* name);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
       /**
        * @cond ignore
        */
@@ -825,6 +977,51 @@ namespace os
 
     // ========================================================================
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+    /**
+     * @details
+     * This constructor shall initialise a mutex object with the
+     * given _type_ and _protocol_, and the other attributes with
+     * their default values (stalled, priority ceiling `highest`,
+     * timeouts on `sysclock`).
+     *
+     * The constructor can be evaluated at compile time; mutexes
+     * with static storage duration constructed with it are laid out
+     * already initialised, and do not run any code at startup.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    constexpr
+    mutex::mutex (static_init_t tag, const char* name, type_t type,
+                  protocol_t protocol) :
+        object_named_system
+          { name }, //
+        list_
+          { tag }, //
+        clock_
+          { &sysclock }, //
+        type_ (type), //
+        protocol_ (protocol), //
+        robustness_ (robustness::default_), //
+        max_count_ ((type == type::recursive) ? max_count : 1)
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+            , //
+        sync_statistics_
+          { tag, this }
+#endif
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+            , //
+        footprint_node_
+          { tag, "mutex", this, internal_describe_footprint_ }
+#endif
+    {
+      assert(type <= type::max_);
+      assert(protocol <= protocol::max_);
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
     /**
      * @details
      * Identical mutexes should have the same memory address.
@@ -879,6 +1076,48 @@ namespace os
       return robustness_;
     }
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+
+    /**
+     * @details
+     * Together with `spin_failures()`, it helps to tune the
+     * `mx_spin_count` attribute.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline uint32_t
+    mutex::spin_successes (void) const
+    {
+      return spin_successes_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline uint32_t
+    mutex::spin_failures (void) const
+    {
+      return spin_failures_;
+    }
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline statistics::sync&
+    mutex::sync_statistics (void)
+    {
+      return sync_statistics_;
+    }
+
+#endif
+
     // ========================================================================
 
     inline
@@ -897,6 +1136,18 @@ namespace os
       ;
     }
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+    constexpr
+    mutex_recursive::mutex_recursive (static_init_t tag, const char* name) :
+        mutex
+          { tag, name, type::recursive }
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
     inline
     mutex_recursive::~mutex_recursive ()
     {
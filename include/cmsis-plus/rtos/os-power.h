@@ -0,0 +1,395 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_POWER_H_
+#define CMSIS_PLUS_RTOS_OS_POWER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/utils/lists.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES)
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Low power states entered by the idle thread.
+     * @ingroup cmsis-plus-rtos-power
+     *
+     * @details
+     * When there is nothing to run, the idle thread selects one of
+     * the low power states, from the time up to the next clock
+     * deadline and from the latency constraints requested by the
+     * threads, and enters it via
+     * `os_rtos_idle_enter_power_state_hook()`.
+     *
+     * A state is eligible if its exit latency does not exceed the
+     * strictest latency constraint and if the idle time is at least
+     * its minimum residency; the deepest eligible state is selected.
+     * The `sleep` state (wait for interrupt) is always eligible.
+     */
+    namespace power
+    {
+      /**
+       * @brief Type of variables holding power state indices.
+       */
+      using state_t = uint8_t;
+
+      /**
+       * @brief Low power states, from the shallowest to the deepest.
+       */
+      struct state
+      {
+        /**
+         * @brief Power states.
+         */
+        enum
+          : state_t
+            {
+              /**
+               * @brief The core is stopped, waiting for an interrupt.
+               */
+              sleep = 0,
+
+              /**
+               * @brief Most clocks are stopped, the RAM is retained.
+               */
+              stop = 1,
+
+              /**
+               * @brief Most of the device is powered off.
+               */
+              standby = 2,
+
+              /**
+               * @brief The number of states.
+               */
+              count = 3
+        };
+      };
+
+      /**
+       * @brief Type of variables holding latencies, in microseconds.
+       */
+      using latency_t = uint32_t;
+
+      /**
+       * @brief The latency of an unconstrained system.
+       */
+      constexpr latency_t no_constraint = static_cast<latency_t> (-1);
+
+      /**
+       * @brief Power state parameters.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-power
+       */
+      struct state_parameters
+      {
+        /**
+         * @brief The time to enter and to leave the state, in microseconds.
+         */
+        latency_t exit_latency_us;
+
+        /**
+         * @brief The shortest idle time worth entering the
+         *  state, in microseconds.
+         */
+        uint32_t min_residency_us;
+      };
+
+      /**
+       * @brief Enable a power state.
+       * @param [in] st The power state.
+       * @param [in] params The state parameters.
+       * @retval result::ok The state was enabled.
+       * @retval EINVAL The state is not valid.
+       */
+      result_t
+      enable_state (state_t st, const state_parameters& params);
+
+      /**
+       * @brief Disable a power state.
+       * @param [in] st The power state.
+       * @retval result::ok The state was disabled.
+       * @retval EINVAL The state is not valid, or is `sleep`.
+       */
+      result_t
+      disable_state (state_t st);
+
+      /**
+       * @brief Get the strictest latency constraint.
+       * @par Parameters
+       *  None.
+       * @return The latency, in microseconds, or `no_constraint`.
+       */
+      latency_t
+      latency_constraint (void);
+
+      /**
+       * @brief Select the power state for an idle interval.
+       * @param [in] idle_us The time up to the next deadline,
+       *  in microseconds.
+       * @param [in] latency_us The latency constraint, in microseconds.
+       * @return The deepest eligible power state.
+       */
+      state_t
+      select_state (uint64_t idle_us, latency_t latency_us);
+
+      // ======================================================================
+
+      /**
+       * @brief Latency constraint **request**.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-power
+       *
+       * @details
+       * While the object exists, the idle thread does not enter power
+       * states with an exit latency longer than the requested one,
+       * similarly to the Linux PM QoS requests.
+       *
+       * @par Example
+       *
+       * @code{.cpp}
+       * {
+       *   // The transfer must be serviced within 50 µs.
+       *   power::latency_request lr { 50 };
+       *   // Do the transfer.
+       * }
+       * @endcode
+       */
+      class latency_request
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct and add a latency request.
+         * @param [in] latency_us The longest acceptable latency,
+         *  in microseconds.
+         */
+        latency_request (latency_t latency_us);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        latency_request (const latency_request&) = delete;
+        latency_request (latency_request&&) = delete;
+        latency_request&
+        operator= (const latency_request&) = delete;
+        latency_request&
+        operator= (latency_request&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Remove the latency request.
+         */
+        ~latency_request ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Change the requested latency.
+         * @param [in] latency_us The longest acceptable latency,
+         *  in microseconds.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        update (latency_t latency_us);
+
+        /**
+         * @brief Get the requested latency.
+         * @par Parameters
+         *  None.
+         * @return The latency, in microseconds.
+         */
+        latency_t
+        latency (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend latency_t
+        latency_constraint (void);
+
+        utils::double_list_links links_;
+
+        latency_t latency_us_;
+
+        // All existing requests, possibly created by static
+        // constructors, so it must be in the BSS.
+        using requests_list = utils::intrusive_list<latency_request,
+        utils::double_list_links, &latency_request::links_>;
+        static requests_list requests__;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Power states statistics.
+       */
+      namespace statistics
+      {
+        /**
+         * @brief Get the number of times a power state was entered.
+         * @param [in] st The power state.
+         * @return A long integer with the number of entries.
+         */
+        rtos::statistics::counter_t
+        entries (state_t st);
+
+        /**
+         * @brief Get the total time spent in a power state.
+         * @param [in] st The power state.
+         * @return A long integer with the number of high resolution
+         *  clock cycles.
+         */
+        rtos::statistics::duration_t
+        residency (state_t st);
+
+        /**
+         * @brief Clear the power states statistics.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        clear (void);
+
+        /**
+         * @cond ignore
+         */
+
+        void
+        internal_record_ (state_t st, rtos::statistics::duration_t cycles);
+
+        extern rtos::statistics::counter_t entries_[state::count];
+        extern rtos::statistics::duration_t residency_[state::count];
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace statistics */
+
+    } /* namespace power */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace power
+    {
+      inline latency_t
+      latency_request::latency (void) const
+      {
+        return latency_us_;
+      }
+
+      namespace statistics
+      {
+        /**
+         * @details
+         * The idle thread counts an entry each time it selects the
+         * state, even if the device was woken up immediately.
+         */
+        inline rtos::statistics::counter_t
+        entries (state_t st)
+        {
+          assert(st < state::count);
+          return entries_[st];
+        }
+
+        /**
+         * @details
+         * The residency is measured with the high resolution clock,
+         * from the moment the state is selected to the moment the
+         * idle thread is back; it includes the interrupt that
+         * woke up the device.
+         */
+        inline rtos::statistics::duration_t
+        residency (state_t st)
+        {
+          assert(st < state::count);
+          return residency_[st];
+        }
+
+      } /* namespace statistics */
+    } /* namespace power */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_POWER_H_ */
@@ -0,0 +1,447 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_RWLOCK_H_
+#define CMSIS_PLUS_RTOS_OS_RWLOCK_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief POSIX compliant **read-write lock**.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-rwlock
+     */
+    class rwlock : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of readers counter storage.
+       * @ingroup cmsis-plus-rtos-rwlock
+       */
+      using count_t = uint16_t;
+
+      /**
+       * @brief Maximum number of concurrent readers.
+       * @ingroup cmsis-plus-rtos-rwlock
+       */
+      static constexpr count_t max_count = 0xFFFF;
+
+      // ======================================================================
+
+      /**
+       * @brief Read-write lock attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-rwlock
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a read-write lock attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the read-write lock attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+        // Add more attributes here.
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default read-write lock initialiser.
+       * @ingroup cmsis-plus-rtos-rwlock
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a read-write lock object instance.
+       * @param [in] attr Reference to attributes.
+       */
+      rwlock (const attributes& attr = initializer);
+
+      /**
+       * @brief Construct a named read-write lock object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] attr Reference to attributes.
+       */
+      rwlock (const char* name, const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      rwlock (const rwlock&) = delete;
+      rwlock (rwlock&&) = delete;
+      rwlock&
+      operator= (const rwlock&) = delete;
+      rwlock&
+      operator= (rwlock&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the read-write lock object instance.
+       */
+      ~rwlock ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare read-write locks.
+       * @retval true The given lock is the same as this lock.
+       * @retval false The locks are different.
+       */
+      bool
+      operator== (const rwlock& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Lock for reading, possibly waiting.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired for reading.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EDEADLK The current thread already owns the lock
+       *  for writing.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      read_lock (void);
+
+      /**
+       * @brief Try to lock for reading.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired for reading.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EWOULDBLOCK The lock is owned by a writer, or writers
+       *  are waiting.
+       * @retval EAGAIN The maximum number of readers was reached.
+       */
+      result_t
+      try_read_lock (void);
+
+      /**
+       * @brief Timed lock for reading.
+       * @param [in] timeout Timeout to wait.
+       * @retval result::ok The lock was acquired for reading.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EDEADLK The current thread already owns the lock
+       *  for writing.
+       * @retval ETIMEDOUT The lock could not be acquired before
+       *  the specified timeout expired.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_read_lock (clock::duration_t timeout);
+
+      /**
+       * @brief Lock for writing, possibly waiting.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired for writing.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EDEADLK The current thread already owns the lock
+       *  for writing.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      write_lock (void);
+
+      /**
+       * @brief Try to lock for writing.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired for writing.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EWOULDBLOCK The lock is owned by readers or by a writer.
+       */
+      result_t
+      try_write_lock (void);
+
+      /**
+       * @brief Timed lock for writing.
+       * @param [in] timeout Timeout to wait.
+       * @retval result::ok The lock was acquired for writing.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EDEADLK The current thread already owns the lock
+       *  for writing.
+       * @retval ETIMEDOUT The lock could not be acquired before
+       *  the specified timeout expired.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_write_lock (clock::duration_t timeout);
+
+      /**
+       * @brief Unlock the read-write lock.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was released.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines;
+       *  or the lock is not owned by the current thread.
+       */
+      result_t
+      unlock (void);
+
+      /**
+       * @brief Get the number of readers.
+       * @par Parameters
+       *  None.
+       * @return The number of threads owning the lock for reading.
+       */
+      count_t
+      readers (void) const;
+
+      /**
+       * @brief Get the writer thread.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the thread owning the lock for writing,
+       *  or `nullptr` if not locked for writing.
+       */
+      thread*
+      writer (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      internal_try_read_lock_ (void);
+
+      bool
+      internal_try_write_lock_ (thread* th);
+
+      result_t
+      internal_lock_ (bool write, bool timed, clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list readers_list_;
+      internal::waiting_threads_list writers_list_;
+      clock* clock_ = nullptr;
+
+      // Can be updated in different thread contexts.
+      thread* volatile writer_ = nullptr;
+
+      // Can be updated in different thread contexts.
+      volatile count_t readers_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    rwlock::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * This constructor shall initialise a read-write lock object
+     * with attributes referenced by _attr_.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_init()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_init.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline
+    rwlock::rwlock (const attributes& attr) :
+        rwlock
+          { nullptr, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Identical read-write locks should have the same memory address.
+     */
+    inline bool
+    rwlock::operator== (const rwlock& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rwlock::count_t
+    rwlock::readers (void) const
+    {
+      return readers_;
+    }
+
+    /**
+     * @details
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline thread*
+    rwlock::writer (void) const
+    {
+      return writer_;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_RWLOCK_H_ */
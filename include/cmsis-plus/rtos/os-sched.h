@@ -37,6 +37,34 @@
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS)
+
+namespace os
+{
+  namespace profile
+  {
+    /**
+     * @cond ignore
+     */
+
+    // Defined in profile.cpp; called with the interrupts disabled,
+    // when entering and leaving the interrupts critical sections.
+    void
+    critical_section_enter_ (void);
+
+    void
+    critical_section_exit_ (void);
+
+    /**
+     * @endcond
+     */
+  } /* namespace profile */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS) */
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace rtos
@@ -158,6 +186,23 @@ namespace os
       void
       internal_switch_threads (void);
 
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      bool
+      internal_check_quantum (void);
+
+      void
+      internal_request_reschedule (void);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+      bool
+      internal_check_cpu_budgets (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
       /**
        * @endcond
        */
@@ -469,6 +514,70 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+        /**
+         * @brief Update the CPU load averages.
+         * @par Parameters
+         *  None.
+         * @retval true The sampling period elapsed and the averages
+         *  were updated.
+         * @retval false It is too early, nothing was done.
+         */
+        bool
+        sample_cpu_load (void);
+
+        /**
+         * @brief Get the total CPU load.
+         * @param [in] window The averaging window.
+         * @return The average load of all threads except idle,
+         *  in hundredths of a percent.
+         */
+        rtos::statistics::load_t
+        cpu_load (rtos::statistics::load_window_t window =
+                      rtos::statistics::load_window::one_second);
+
+        /**
+         * @cond ignore
+         */
+
+        class internal_cpu_load_sampler;
+
+        rtos::statistics::load_t
+        internal_load_scale_ (uint32_t load);
+
+        extern uint32_t cpu_load_[rtos::statistics::load_window::count];
+
+      /**
+       * @endcond
+       */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        /**
+         * @brief Get the number of coalesced reschedule requests.
+         * @return Integer with the number of reschedule requests
+         *  made by interrupt handlers which were served by an
+         *  already requested switch, since scheduler start.
+         */
+        rtos::statistics::counter_t
+        coalesced_reschedules (void);
+
+        /**
+         * @cond ignore
+         */
+
+        extern rtos::statistics::counter_t coalesced_reschedules_;
+
+      /**
+       * @endcond
+       */
+
+#endif
+
       } /* namespace statistics */
     } /* namespace scheduler */
 
@@ -484,6 +593,16 @@ namespace os
       bool
       in_handler_mode (void);
 
+      /**
+       * @brief Issue the reschedule requested by an interrupt handler.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      handler_exit (void);
+
       // ======================================================================
 
       // TODO: define all levels of critical sections
@@ -1073,6 +1192,66 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+        /**
+         * @cond ignore
+         */
+
+        inline rtos::statistics::load_t
+        internal_load_scale_ (uint32_t load)
+        {
+          // From 1/65536 units to hundredths of a percent, rounded.
+          return static_cast<rtos::statistics::load_t> (((load
+              * static_cast<uint64_t> (rtos::statistics::load_full_scale))
+              + 0x8000u) >> 16);
+        }
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @details
+         * The total load is the complement of the idle thread load,
+         * thus it includes the time spent in interrupts.
+         *
+         * @note This function is available only when
+         * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD
+         * is defined.
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        inline rtos::statistics::load_t
+        cpu_load (rtos::statistics::load_window_t window)
+        {
+          assert(window < rtos::statistics::load_window::count);
+          return internal_load_scale_ (cpu_load_[window]);
+        }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        /**
+         * @details
+         * Each interrupt handler which resumes threads requests
+         * a single switch, at its exit; the resumes after the first
+         * one are counted here.
+         *
+         * @note This function is available only when
+         * @ref OS_USE_RTOS_COALESCED_RESCHEDULE
+         * is defined.
+         */
+        inline rtos::statistics::counter_t
+        coalesced_reschedules (void)
+        {
+          return coalesced_reschedules_;
+        }
+
+#endif
+
       } /* namespace statistics */
 
     } /* namespace scheduler */
@@ -1127,7 +1306,13 @@ namespace os
       __attribute__((always_inline))
       critical_section::enter (void)
       {
+#if defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS)
+        state_t state = port::interrupts::critical_section::enter ();
+        os::profile::critical_section_enter_ ();
+        return state;
+#else
         return port::interrupts::critical_section::enter ();
+#endif
       }
 
       /**
@@ -1139,6 +1324,9 @@ namespace os
       __attribute__((always_inline))
       critical_section::exit (state_t state)
       {
+#if defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS)
+        os::profile::critical_section_exit_ ();
+#endif
         port::interrupts::critical_section::exit (state);
       }
 
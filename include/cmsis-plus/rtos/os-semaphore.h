@@ -33,6 +33,7 @@
 #if defined(__cplusplus)
 
 #include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-clocks.h>
 
 // ----------------------------------------------------------------------------
 
@@ -263,6 +264,21 @@ namespace os
        */
       semaphore (const char* name, const attributes& attr = initializer_binary);
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Construct a constant initialised semaphore object instance.
+       * @param [in] tag The `static_init` tag.
+       * @param [in] name Pointer to name.
+       * @param [in] max_value Maximum count value.
+       * @param [in] initial_value Initial count value.
+       */
+      constexpr
+      semaphore (static_init_t tag, const char* name, const count_t max_value,
+                 const count_t initial_value);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     protected:
 
       /**
@@ -423,6 +439,19 @@ namespace os
       count_t
       max_value (void) const;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+      /**
+       * @brief Get the contention statistics.
+       * @par Parameters
+       *  None.
+       * @return Reference to the statistics.
+       */
+      statistics::sync&
+      sync_statistics (void);
+
+#endif
+
       /**
        * @}
        */
@@ -468,7 +497,11 @@ namespace os
        * @cond ignore
        */
 
+      friend struct internal::c_api_layout;
+
 #if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+      friend class wait_set;
+      friend class coroutine::semaphore_awaiter;
       internal::waiting_threads_list list_;
       clock* clock_ = nullptr;
 #endif
@@ -486,6 +519,11 @@ namespace os
       // Can be updated in different contexts (interrupts or threads)
       volatile count_t count_ = 0;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      statistics::sync sync_statistics_
+        { this };
+#endif
+
       // Add more internal data.
 
       /**
@@ -527,6 +565,21 @@ namespace os
        */
       semaphore_binary (const char* name, const count_t initial_value);
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Construct a constant initialised binary semaphore
+       *  object instance.
+       * @param [in] tag The `static_init` tag.
+       * @param [in] name Pointer to name.
+       * @param [in] initial_value Initial count value.
+       */
+      constexpr
+      semaphore_binary (static_init_t tag, const char* name,
+                        const count_t initial_value);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
       /**
        * @cond ignore
        */
@@ -603,6 +656,23 @@ namespace os
       semaphore_counting (const char* name, const count_t max_value,
                           const count_t initial_value);
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Construct a constant initialised counting semaphore
+       *  object instance.
+       * @param [in] tag The `static_init` tag.
+       * @param [in] name Pointer to name.
+       * @param [in] max_value Maximum count value.
+       * @param [in] initial_value Initial count value.
+       */
+      constexpr
+      semaphore_counting (static_init_t tag, const char* name,
+                          const count_t max_value,
+                          const count_t initial_value);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
       /**
        * @cond ignore
        */
@@ -706,6 +776,46 @@ namespace os
 
     // ========================================================================
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+    /**
+     * @details
+     * This constructor shall initialise a semaphore object
+     * with the given _max_value_ and _initial_value_, and the
+     * default attributes (timeouts on `sysclock`).
+     *
+     * The constructor can be evaluated at compile time; semaphores
+     * with static storage duration constructed with it are laid out
+     * already initialised, and do not run any code at startup.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    constexpr
+    semaphore::semaphore (static_init_t tag, const char* name,
+                          const count_t max_value,
+                          const count_t initial_value) :
+        object_named_system
+          { name }, //
+        list_
+          { tag }, //
+        clock_
+          { &sysclock }, //
+        max_value_ (max_value), //
+        initial_value_ (initial_value), //
+        count_ (initial_value)
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+            , //
+        sync_statistics_
+          { tag, this }
+#endif
+    {
+      assert(max_value > 0);
+      assert(initial_value >= 0);
+      assert(initial_value <= max_value);
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     /**
      * @details
      * This constructor shall initialise a generic semaphore object
@@ -777,6 +887,20 @@ namespace os
       return max_value_;
     }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline statistics::sync&
+    semaphore::sync_statistics (void)
+    {
+      return sync_statistics_;
+    }
+
+#endif
+
     // ========================================================================
 
     /**
@@ -832,6 +956,27 @@ namespace os
       ;
     }
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+    /**
+     * @details
+     * The constructor can be evaluated at compile time, to
+     * constant initialise binary semaphores with static storage
+     * duration.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    constexpr
+    semaphore_binary::semaphore_binary (static_init_t tag, const char* name,
+                                        const count_t initial_value) :
+        semaphore
+          { tag, name, 1, initial_value }
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     /**
      * @details
      * This destructor shall destroy the semaphore object; the object
@@ -913,6 +1058,29 @@ namespace os
       ;
     }
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+    /**
+     * @details
+     * The constructor can be evaluated at compile time, to
+     * constant initialise counting semaphores with static storage
+     * duration.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    constexpr
+    semaphore_counting::semaphore_counting (static_init_t tag,
+                                            const char* name,
+                                            const count_t max_value,
+                                            const count_t initial_value) :
+        semaphore
+          { tag, name, max_value, initial_value }
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     /**
      * @details
      * This destructor shall destroy the semaphore object; the object
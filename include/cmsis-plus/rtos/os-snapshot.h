@@ -0,0 +1,694 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_SNAPSHOT_H_
+#define CMSIS_PLUS_RTOS_OS_SNAPSHOT_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_SNAPSHOT)
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Snapshot**, read-mostly shared data, read without locks.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-snapshot
+     *
+     * @details
+     * A few versions of a value; the readers get the current one
+     * with a single load, the writers copy the new value into a
+     * free version and publish it. A replaced version is reused
+     * only after a grace period, when no reader can still use it.
+     */
+    class snapshot : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of snapshot version indices.
+       * @ingroup cmsis-plus-rtos-snapshot
+       */
+      using index_t = uint8_t;
+
+      /**
+       * @brief Type of the update counter.
+       * @ingroup cmsis-plus-rtos-snapshot
+       */
+      using version_t = uint32_t;
+
+      /**
+       * @brief Maximum number of versions.
+       * @ingroup cmsis-plus-rtos-snapshot
+       */
+      static constexpr index_t max_versions = 32;
+
+      // ======================================================================
+
+      /**
+       * @brief Snapshot attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-snapshot
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a snapshot attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the snapshot attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+        // Add more attributes here.
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default snapshot initialiser.
+       * @ingroup cmsis-plus-rtos-snapshot
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a named snapshot object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] storage Pointer to the versions storage.
+       * @param [in] marks Pointer to an array of _versions_ grace
+       *  period marks.
+       * @param [in] value_size_bytes The size of a value.
+       * @param [in] versions The number of versions.
+       * @param [in] initial Pointer to the initial value; may be
+       *  `nullptr` if the storage is already initialised.
+       * @param [in] attr Reference to attributes.
+       */
+      snapshot (const char* name, void* storage,
+                rtos::statistics::counter_t* marks,
+                std::size_t value_size_bytes, std::size_t versions,
+                const void* initial, const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      snapshot (const snapshot&) = delete;
+      snapshot (snapshot&&) = delete;
+      snapshot&
+      operator= (const snapshot&) = delete;
+      snapshot&
+      operator= (snapshot&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the snapshot object instance.
+       */
+      ~snapshot ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare snapshots.
+       * @retval true The given snapshot is the same as this snapshot.
+       * @retval false The snapshots are different.
+       */
+      bool
+      operator== (const snapshot& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Get the current version.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the current value; valid until the
+       *  reader blocks.
+       */
+      const void*
+      read (void) const;
+
+      /**
+       * @brief Publish a new value.
+       * @param [in] value Pointer to the new value.
+       * @param [in] nbytes The size of the value.
+       * @retval result::ok The value was published.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The value is null, or larger than the
+       *  snapshot values.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      update (const void* value, std::size_t nbytes);
+
+      /**
+       * @brief Try to publish a new value.
+       * @param [in] value Pointer to the new value.
+       * @param [in] nbytes The size of the value.
+       * @retval result::ok The value was published.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The value is null, or larger than the
+       *  snapshot values.
+       * @retval EWOULDBLOCK All versions are in use.
+       */
+      result_t
+      try_update (const void* value, std::size_t nbytes);
+
+      /**
+       * @brief Publish a new value, with a timeout.
+       * @param [in] value Pointer to the new value.
+       * @param [in] nbytes The size of the value.
+       * @param [in] timeout Timeout to wait for a free version.
+       * @retval result::ok The value was published.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The value is null, or larger than the
+       *  snapshot values.
+       * @retval ETIMEDOUT No version was freed before the timeout.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_update (const void* value, std::size_t nbytes,
+                    clock::duration_t timeout);
+
+      /**
+       * @brief Wait until the replaced versions are no longer used.
+       * @par Parameters
+       *  None.
+       * @retval result::ok All replaced versions were reclaimed.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      synchronize (void);
+
+      /**
+       * @brief Get the number of updates.
+       * @par Parameters
+       *  None.
+       * @return The number of values published since creation.
+       */
+      version_t
+      version (void) const;
+
+      /**
+       * @brief Get the number of versions waiting for a grace period.
+       * @par Parameters
+       *  None.
+       * @return The replaced versions not yet reclaimed.
+       */
+      std::size_t
+      retired (void) const;
+
+      /**
+       * @brief Get the size of the values.
+       * @par Parameters
+       *  None.
+       * @return The size of a value, in bytes.
+       */
+      std::size_t
+      value_size (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      static rtos::statistics::counter_t
+      internal_quiescent_count_ (void);
+
+      void
+      internal_reclaim_ (void);
+
+      bool
+      internal_try_update_ (const void* value, std::size_t nbytes);
+
+      result_t
+      internal_update_ (const void* value, std::size_t nbytes, bool timed,
+                        clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      // The only member used by the readers.
+      const void* volatile current_ = nullptr;
+
+      clock* clock_ = nullptr;
+
+      char* arena_ = nullptr;
+      // The quiescent count when each version was replaced.
+      rtos::statistics::counter_t* marks_ = nullptr;
+      std::size_t value_size_bytes_ = 0;
+
+      // One bit for each version.
+      volatile uint32_t free_ = 0;
+      volatile uint32_t retired_ = 0;
+
+      volatile version_t version_ = 0;
+      volatile index_t current_index_ = 0;
+      index_t versions_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Template of a snapshot with inclusive storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-snapshot
+     *
+     * @tparam T Type of the value, trivially copyable.
+     * @tparam N Number of versions, including the current one.
+     */
+    template<typename T, std::size_t N = 2>
+      class snapshot_inclusive : public snapshot
+      {
+      public:
+
+        static_assert(N >= 2 && N <= max_versions,
+            "snapshot versions must be 2 to 32");
+        static_assert(std::is_trivially_copyable<T>::value,
+            "snapshot values are copied as bytes");
+
+        /**
+         * @brief Local type of value.
+         */
+        using value_type = T;
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static constexpr std::size_t versions = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a snapshot object instance.
+         * @param [in] initial The initial value.
+         * @param [in] attr Reference to attributes.
+         */
+        snapshot_inclusive (const value_type& initial,
+                            const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named snapshot object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] initial The initial value.
+         * @param [in] attr Reference to attributes.
+         */
+        snapshot_inclusive (const char* name, const value_type& initial,
+                            const attributes& attr = initializer);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        snapshot_inclusive (const snapshot_inclusive&) = delete;
+        snapshot_inclusive (snapshot_inclusive&&) = delete;
+        snapshot_inclusive&
+        operator= (const snapshot_inclusive&) = delete;
+        snapshot_inclusive&
+        operator= (snapshot_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the snapshot object instance.
+         */
+        ~snapshot_inclusive () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the current version.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the current value; valid until the
+         *  reader blocks.
+         */
+        const value_type*
+        read (void) const;
+
+        /**
+         * @brief Publish a new value.
+         * @param [in] value The new value.
+         * @retval result::ok The value was published.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        update (const value_type& value);
+
+        /**
+         * @brief Try to publish a new value.
+         * @param [in] value The new value.
+         * @retval result::ok The value was published.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EWOULDBLOCK All versions are in use.
+         */
+        result_t
+        try_update (const value_type& value);
+
+        /**
+         * @brief Publish a new value, with a timeout.
+         * @param [in] value The new value.
+         * @param [in] timeout Timeout to wait for a free version.
+         * @retval result::ok The value was published.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval ETIMEDOUT No version was freed before the timeout.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        timed_update (const value_type& value, clock::duration_t timeout);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        value_type arena_[versions];
+        rtos::statistics::counter_t marks_[versions];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    snapshot::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * Identical snapshots should have the same memory address.
+     */
+    inline bool
+    snapshot::operator== (const snapshot& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * A single load, with no locks and no counters, so the cost
+     * does not depend on the number of readers. The dependent
+     * accesses through the pointer are ordered after the load,
+     * and the writers publish the pointer with a release store.
+     *
+     * The version remains valid while the reader does not block;
+     * do not keep the pointer across waits or sleeps.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline const void*
+    snapshot::read (void) const
+    {
+      return current_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline snapshot::version_t
+    snapshot::version (void) const
+    {
+      return version_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    snapshot::value_size (void) const
+    {
+      return value_size_bytes_;
+    }
+
+    // ========================================================================
+
+    template<typename T, std::size_t N>
+      constexpr std::size_t snapshot_inclusive<T, N>::versions;
+
+    /**
+     * @details
+     * This constructor shall initialise a snapshot object
+     * with the _initial_ value and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline
+      snapshot_inclusive<T, N>::snapshot_inclusive (const value_type& initial,
+                                                    const attributes& attr) :
+          snapshot_inclusive
+            { nullptr, initial, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * This constructor shall initialise a named snapshot object
+     * with the _initial_ value and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline
+      snapshot_inclusive<T, N>::snapshot_inclusive (const char* name,
+                                                    const value_type& initial,
+                                                    const attributes& attr) :
+          snapshot
+            { name, &arena_, marks_, sizeof(value_type), versions, nullptr,
+                attr }
+      {
+        // After the members were constructed.
+        arena_[0] = initial;
+      }
+
+    /**
+     * @details
+     * Wrapper over `snapshot::read()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline const typename snapshot_inclusive<T, N>::value_type*
+      snapshot_inclusive<T, N>::read (void) const
+      {
+        return static_cast<const value_type*> (snapshot::read ());
+      }
+
+    /**
+     * @details
+     * Wrapper over `snapshot::update()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      snapshot_inclusive<T, N>::update (const value_type& value)
+      {
+        return snapshot::update (&value, sizeof(value_type));
+      }
+
+    /**
+     * @details
+     * Wrapper over `snapshot::try_update()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      snapshot_inclusive<T, N>::try_update (const value_type& value)
+      {
+        return snapshot::try_update (&value, sizeof(value_type));
+      }
+
+    /**
+     * @details
+     * Wrapper over `snapshot::timed_update()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      snapshot_inclusive<T, N>::timed_update (const value_type& value,
+                                              clock::duration_t timeout)
+      {
+        return snapshot::timed_update (&value, sizeof(value_type), timeout);
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_SNAPSHOT) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_SNAPSHOT_H_ */
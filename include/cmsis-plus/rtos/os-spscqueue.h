@@ -0,0 +1,488 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_SPSCQUEUE_H_
+#define CMSIS_PLUS_RTOS_OS_SPSCQUEUE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Lock-free **single producer, single consumer queue**.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-spscqueue
+     *
+     * @tparam T Type of elements.
+     * @tparam N Number of elements; must be a power of 2.
+     *
+     * @details
+     * A fixed size ring of elements, intended for one producer,
+     * usually an interrupt handler, feeding one consumer thread.
+     *
+     * The producer only writes the tail index and the consumer only
+     * writes the head index, so no critical sections are needed;
+     * the two indices are kept in separate cache lines.
+     *
+     * The consumer may also block, via a binary semaphore which is
+     * posted by the producer only when the consumer waits on an
+     * empty queue.
+     */
+    template<typename T, std::size_t N>
+      class spsc_queue
+      {
+      public:
+
+        /**
+         * @brief Type of elements.
+         */
+        using value_type = T;
+
+        /**
+         * @brief Type of indices.
+         */
+        using index_t = std::size_t;
+
+        /**
+         * @brief Number of elements.
+         */
+        static constexpr index_t elements = N;
+
+        static_assert(N > 0 && (N & (N - 1)) == 0,
+            "spsc_queue size must be a power of 2");
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a queue object instance.
+         * @param [in] name Pointer to name.
+         */
+        spsc_queue (const char* name = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        spsc_queue (const spsc_queue&) = delete;
+        spsc_queue (spsc_queue&&) = delete;
+        spsc_queue&
+        operator= (const spsc_queue&) = delete;
+        spsc_queue&
+        operator= (spsc_queue&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the queue object instance.
+         */
+        ~spsc_queue () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Try to add an element, without blocking.
+         * @param [in] value Reference to the element.
+         * @retval true The element was added.
+         * @retval false The queue is full.
+         */
+        bool
+        try_send (const value_type& value);
+
+        /**
+         * @brief Try to remove an element, without blocking.
+         * @param [out] value Pointer where to store the element.
+         * @retval true The element was removed.
+         * @retval false The queue is empty.
+         */
+        bool
+        try_receive (value_type* value);
+
+        /**
+         * @brief Remove an element, waiting if the queue is empty.
+         * @param [out] value Pointer where to store the element.
+         * @retval result::ok The element was removed.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        receive (value_type* value);
+
+        /**
+         * @brief Remove an element, waiting at most the timeout
+         *  if the queue is empty.
+         * @param [out] value Pointer where to store the element.
+         * @param [in] timeout Timeout to wait.
+         * @retval result::ok The element was removed.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval ETIMEDOUT The queue was still empty after the timeout.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        timed_receive (value_type* value, clock::duration_t timeout);
+
+        /**
+         * @brief Get queue capacity.
+         * @par Parameters
+         *  None.
+         * @return The max number of elements that can be in the queue.
+         */
+        constexpr index_t
+        capacity (void) const;
+
+        /**
+         * @brief Get queue length.
+         * @par Parameters
+         *  None.
+         * @return The number of elements in the queue.
+         */
+        index_t
+        length (void) const;
+
+        /**
+         * @brief Check if the queue is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The queue has no elements.
+         * @retval false The queue has some elements.
+         */
+        bool
+        empty (void) const;
+
+        /**
+         * @brief Check if the queue is full.
+         * @par Parameters
+         *  None.
+         * @retval true The queue is full.
+         * @retval false The queue is not full.
+         */
+        bool
+        full (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        result_t
+        internal_receive_ (value_type* value, bool timed,
+                           clock::duration_t timeout);
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Variables
+         * @{
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        // Free running indices, the difference is the length.
+        // Written only by the consumer.
+        alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) index_t head_ = 0;
+
+        // Written only by the producer.
+        alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) index_t tail_ = 0;
+
+        // Set by the consumer while it waits on an empty queue.
+        alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) bool waiting_ = false;
+
+        semaphore_binary semaphore_;
+
+        value_type buffer_[N];
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @}
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    template<typename T, std::size_t N>
+      constexpr typename spsc_queue<T, N>::index_t spsc_queue<T, N>::elements;
+
+    /**
+     * @details
+     * The queue is initially empty.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      spsc_queue<T, N>::spsc_queue (const char* name) :
+          semaphore_
+            { name, 0 }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * Must be called only by the producer. The element is copied
+     * into the ring, and only then the tail is advanced, so the
+     * consumer never sees a partly written element.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      bool
+      spsc_queue<T, N>::try_send (const value_type& value)
+      {
+        index_t tail = __atomic_load_n (&tail_, __ATOMIC_RELAXED);
+        if (tail - __atomic_load_n (&head_, __ATOMIC_ACQUIRE) >= N)
+          {
+            return false;
+          }
+
+        buffer_[tail & (N - 1)] = value;
+        __atomic_store_n (&tail_, tail + 1, __ATOMIC_SEQ_CST);
+
+        // The semaphore is used only if the consumer waits.
+        if (__atomic_load_n (&waiting_, __ATOMIC_SEQ_CST))
+          {
+            __atomic_store_n (&waiting_, false, __ATOMIC_RELAXED);
+            semaphore_.post ();
+          }
+
+        return true;
+      }
+
+    /**
+     * @details
+     * Must be called only by the consumer.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      bool
+      spsc_queue<T, N>::try_receive (value_type* value)
+      {
+        index_t head = __atomic_load_n (&head_, __ATOMIC_RELAXED);
+        if (head == __atomic_load_n (&tail_, __ATOMIC_ACQUIRE))
+          {
+            return false;
+          }
+
+        *value = buffer_[head & (N - 1)];
+        __atomic_store_n (&head_, head + 1, __ATOMIC_RELEASE);
+
+        return true;
+      }
+
+    template<typename T, std::size_t N>
+      result_t
+      spsc_queue<T, N>::internal_receive_ (value_type* value, bool timed,
+                                           clock::duration_t timeout)
+      {
+        // Don't call this from interrupt handlers.
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        for (;;)
+          {
+            if (try_receive (value))
+              {
+                return result::ok;
+              }
+
+            // Announce the wait, then check again, since the producer
+            // may have added an element before seeing the flag.
+            __atomic_store_n (&waiting_, true, __ATOMIC_SEQ_CST);
+            if (try_receive (value))
+              {
+                __atomic_store_n (&waiting_, false, __ATOMIC_RELAXED);
+                return result::ok;
+              }
+
+            // A stale post, left by a previous wait, only causes
+            // one more iteration.
+            result_t res =
+                timed ? semaphore_.timed_wait (timeout) : semaphore_.wait ();
+            if (res != result::ok)
+              {
+                __atomic_store_n (&waiting_, false, __ATOMIC_RELAXED);
+                // Give a last chance, an element might have been
+                // added just before the timeout.
+                if (res == ETIMEDOUT && try_receive (value))
+                  {
+                    return result::ok;
+                  }
+                return res;
+              }
+          }
+      }
+
+    /**
+     * @details
+     * Must be called only by the consumer. If the queue is not
+     * empty, no system call is performed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      spsc_queue<T, N>::receive (value_type* value)
+      {
+        return internal_receive_ (value, false, 0);
+      }
+
+    /**
+     * @details
+     * Must be called only by the consumer. If the queue is not
+     * empty, no system call is performed.
+     *
+     * The timeout is measured with the semaphore clock (the
+     * SysTick clock), and restarts if the thread is resumed but
+     * the queue is still empty.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      spsc_queue<T, N>::timed_receive (value_type* value,
+                                       clock::duration_t timeout)
+      {
+        return internal_receive_ (value, true, timeout);
+      }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      constexpr typename spsc_queue<T, N>::index_t
+      spsc_queue<T, N>::capacity (void) const
+      {
+        return N;
+      }
+
+    /**
+     * @details
+     * The value is exact only when read by the producer or the
+     * consumer; for others it is a snapshot.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline typename spsc_queue<T, N>::index_t
+      spsc_queue<T, N>::length (void) const
+      {
+        return __atomic_load_n (&tail_, __ATOMIC_ACQUIRE)
+            - __atomic_load_n (&head_, __ATOMIC_ACQUIRE);
+      }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline bool
+      spsc_queue<T, N>::empty (void) const
+      {
+        return (length () == 0);
+      }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline bool
+      spsc_queue<T, N>::full (void) const
+      {
+        return (length () >= N);
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_SPSCQUEUE_H_ */
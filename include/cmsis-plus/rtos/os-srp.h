@@ -0,0 +1,756 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_SRP_H_
+#define CMSIS_PLUS_RTOS_OS_SRP_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Stack Resource Policy run-to-completion tasks.
+     * @ingroup cmsis-plus-rtos-srp
+     */
+    namespace srp
+    {
+      // ======================================================================
+
+      class dispatcher;
+
+      /**
+       * @brief Type of task priorities.
+       * @details
+       * From 1 (lowest) to `max_priority`; 0 is the priority
+       * of the idle dispatcher.
+       * @ingroup cmsis-plus-rtos-srp
+       */
+      using priority_t = uint8_t;
+
+      /**
+       * @brief Number of task priority levels.
+       * @ingroup cmsis-plus-rtos-srp
+       */
+      static constexpr priority_t max_priority =
+          OS_INTEGER_RTOS_SRP_PRIORITIES;
+
+      static_assert(max_priority >= 1 && max_priority <= 32,
+          "OS_INTEGER_RTOS_SRP_PRIORITIES must be between 1 and 32");
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief **Run-to-completion task**.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-srp
+       *
+       * @details
+       * A function called by the dispatcher, on the dispatcher
+       * thread stack, once for each `post()`; it must return
+       * and must not block.
+       */
+      class task : public internal::object_named_system
+      {
+      public:
+
+        /**
+         * @brief Type of task functions.
+         * @par Parameters
+         *  Pointer to arguments.
+         * @par Returns
+         *  Nothing.
+         */
+        using func_t = void (*) (void* args);
+
+        /**
+         * @brief Type of task function arguments.
+         */
+        using func_args_t = void*;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a task object instance.
+         * @param [in] disp Reference to the dispatcher.
+         * @param [in] prio The task priority, from 1 to `max_priority`.
+         * @param [in] func Pointer to function to call.
+         * @param [in] args Pointer to function arguments.
+         */
+        task (dispatcher& disp, priority_t prio, func_t func,
+              func_args_t args = nullptr);
+
+        /**
+         * @brief Construct a named task object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] disp Reference to the dispatcher.
+         * @param [in] prio The task priority, from 1 to `max_priority`.
+         * @param [in] func Pointer to function to call.
+         * @param [in] args Pointer to function arguments.
+         */
+        task (const char* name, dispatcher& disp, priority_t prio,
+              func_t func, func_args_t args = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        task (const task&) = delete;
+        task (task&&) = delete;
+        task&
+        operator= (const task&) = delete;
+        task&
+        operator= (task&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the task object instance.
+         */
+        ~task ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Activate the task.
+         * @par Parameters
+         *  None.
+         * @retval result::ok The activation was recorded.
+         */
+        result_t
+        post (void);
+
+        /**
+         * @brief Get the task priority.
+         * @par Parameters
+         *  None.
+         * @return The priority.
+         */
+        priority_t
+        priority (void) const;
+
+        /**
+         * @brief Get the number of activations not yet run.
+         * @par Parameters
+         *  None.
+         * @return The number of activations.
+         */
+        std::size_t
+        pending (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class dispatcher;
+
+        // Links in the dispatcher ready list of the priority.
+        utils::double_list_links links_;
+
+        dispatcher& dispatcher_;
+        func_t func_;
+        func_args_t args_;
+        std::size_t pending_ = 0;
+        priority_t prio_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief **Resource** shared by tasks, with a priority ceiling.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-srp
+       *
+       * @details
+       * The ceiling is the highest priority of the tasks using the
+       * resource; while it is locked, those tasks cannot preempt,
+       * so the lock never blocks. It satisfies the `BasicLockable`
+       * requirements.
+       */
+      class resource
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a resource object instance.
+         * @param [in] disp Reference to the dispatcher.
+         * @param [in] ceiling The highest priority of the tasks
+         *  using the resource.
+         */
+        resource (dispatcher& disp, priority_t ceiling);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        resource (const resource&) = delete;
+        resource (resource&&) = delete;
+        resource&
+        operator= (const resource&) = delete;
+        resource&
+        operator= (resource&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the resource object instance.
+         */
+        ~resource () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Raise the system ceiling to the resource ceiling.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        lock (void);
+
+        /**
+         * @brief Restore the system ceiling, and run the tasks
+         *  posted meanwhile, if they preempt.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        unlock (void);
+
+        /**
+         * @brief Get the resource ceiling.
+         * @par Parameters
+         *  None.
+         * @return The priority ceiling.
+         */
+        priority_t
+        ceiling (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        dispatcher& dispatcher_;
+        priority_t ceiling_;
+        // The system ceiling before lock().
+        priority_t saved_ = 0;
+        bool locked_ = false;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief **Dispatcher** of run-to-completion tasks, on
+       *  a single thread stack.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-srp
+       */
+      class dispatcher : public internal::object_named_system
+      {
+      public:
+
+        // ====================================================================
+
+        /**
+         * @brief Dispatcher attributes.
+         * @headerfile os.h <cmsis-plus/rtos/os.h>
+         * @ingroup cmsis-plus-rtos-srp
+         */
+        class attributes
+        {
+        public:
+
+          /**
+           * @name Constructors & Destructor
+           * @{
+           */
+
+          /**
+           * @brief Construct a dispatcher attributes object instance.
+           * @par Parameters
+           *  None.
+           */
+          constexpr
+          attributes ();
+
+          // The rule of five.
+          attributes (const attributes&) = default;
+          attributes (attributes&&) = default;
+          attributes&
+          operator= (const attributes&) = default;
+          attributes&
+          operator= (attributes&&) = default;
+
+          /**
+           * @brief Destruct the dispatcher attributes object instance.
+           */
+          ~attributes () = default;
+
+          /**
+           * @}
+           */
+
+        public:
+
+          /**
+           * @name Public Member Variables
+           * @{
+           */
+
+          // Public members; no accessors and mutators required.
+
+          /**
+           * @brief Address of the user defined storage for the
+           *  dispatcher thread stack, shared by all tasks.
+           * @details
+           * If `nullptr`, the default is to dynamically allocate
+           * the stack.
+           */
+          void* th_stack_address = nullptr;
+
+          /**
+           * @brief Size of the dispatcher thread stack, in bytes.
+           * @details
+           * If 0, the default is `thread::stack::default_size()`.
+           */
+          std::size_t th_stack_size_bytes = 0;
+
+          /**
+           * @brief Dispatcher thread priority.
+           */
+          thread::priority_t th_priority =
+              OS_INTEGER_RTOS_SRP_DISPATCHER_PRIORITY;
+
+          // Add more attributes here.
+
+          /**
+           * @}
+           */
+
+        }; /* class attributes */
+
+        /**
+         * @brief Default dispatcher initialiser.
+         */
+        static const attributes initializer;
+
+        // ====================================================================
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a dispatcher object instance.
+         * @param [in] attr Reference to attributes.
+         */
+        dispatcher (const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named dispatcher object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] attr Reference to attributes.
+         */
+        dispatcher (const char* name, const attributes& attr = initializer);
+
+        /**
+         * @cond ignore
+         */
+
+      protected:
+
+        dispatcher (const char* name, void* stack_address,
+                    std::size_t stack_size_bytes, const attributes& attr);
+
+      public:
+
+        // The rule of five.
+        dispatcher (const dispatcher&) = delete;
+        dispatcher (dispatcher&&) = delete;
+        dispatcher&
+        operator= (const dispatcher&) = delete;
+        dispatcher&
+        operator= (dispatcher&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the dispatcher object instance.
+         */
+        virtual
+        ~dispatcher ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the priority of the running task.
+         * @par Parameters
+         *  None.
+         * @return The priority, or 0 if no task is running.
+         */
+        priority_t
+        running_priority (void) const;
+
+        /**
+         * @brief Get the system ceiling.
+         * @par Parameters
+         *  None.
+         * @return The highest ceiling of the locked resources,
+         *  or 0 if none is locked.
+         */
+        priority_t
+        ceiling (void) const;
+
+        /**
+         * @brief Get the dispatcher thread.
+         * @par Parameters
+         *  None.
+         * @return A reference to the dispatcher thread.
+         */
+        thread&
+        worker (void);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class task;
+        friend class resource;
+
+        using tasks_list = utils::intrusive_list<task,
+        utils::double_list_links, &task::links_>;
+
+        static void*
+        internal_run_ (void* args);
+
+        static thread::attributes
+        internal_thread_attributes_ (const attributes& attr,
+                                     void* stack_address,
+                                     std::size_t stack_size_bytes);
+
+        void
+        internal_post_ (task& t);
+
+        void
+        internal_unlink_ (task& t);
+
+        void
+        internal_dispatch_ (void);
+
+        bool
+        internal_in_worker_ (void);
+
+        /**
+         * @endcond
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // One FIFO of activated tasks per priority, and a bit
+        // for each non empty list.
+        tasks_list ready_[max_priority];
+        uint32_t ready_mask_ = 0;
+
+        priority_t volatile running_ = 0;
+        priority_t volatile ceiling_ = 0;
+
+        // Better be the last one.
+        thread worker_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Template of a dispatcher with inclusive stack.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-srp
+       *
+       * @tparam S Dispatcher thread stack size, in bytes.
+       */
+      template<std::size_t S = port::stack::default_size_bytes>
+        class dispatcher_inclusive : public dispatcher
+        {
+        public:
+
+          /**
+           * @brief Local constant based on template definition.
+           */
+          static const std::size_t stack_size_bytes = S;
+
+          /**
+           * @name Constructors & Destructor
+           * @{
+           */
+
+          /**
+           * @brief Construct a dispatcher object instance.
+           * @param [in] attr Reference to attributes.
+           */
+          dispatcher_inclusive (const attributes& attr = initializer);
+
+          /**
+           * @brief Construct a named dispatcher object instance.
+           * @param [in] name Pointer to name.
+           * @param [in] attr Reference to attributes.
+           */
+          dispatcher_inclusive (const char* name, const attributes& attr =
+                                    initializer);
+
+          /**
+           * @cond ignore
+           */
+
+          // The rule of five.
+          dispatcher_inclusive (const dispatcher_inclusive&) = delete;
+          dispatcher_inclusive (dispatcher_inclusive&&) = delete;
+          dispatcher_inclusive&
+          operator= (const dispatcher_inclusive&) = delete;
+          dispatcher_inclusive&
+          operator= (dispatcher_inclusive&&) = delete;
+
+          /**
+           * @endcond
+           */
+
+          /**
+           * @brief Destruct the dispatcher object instance.
+           */
+          virtual
+          ~dispatcher_inclusive ();
+
+          /**
+           * @}
+           */
+
+        protected:
+
+          /**
+           * @cond ignore
+           */
+
+          port::stack::allocation_element_t stack_storage_[(S
+              + sizeof(port::stack::allocation_element_t) - 1)
+              / sizeof(port::stack::allocation_element_t)];
+
+          /**
+           * @endcond
+           */
+
+        };
+
+#pragma GCC diagnostic pop
+
+    } /* namespace srp */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace srp
+    {
+      // ======================================================================
+
+      inline priority_t
+      task::priority (void) const
+      {
+        return prio_;
+      }
+
+      inline std::size_t
+      task::pending (void) const
+      {
+        return pending_;
+      }
+
+      // ======================================================================
+
+      inline priority_t
+      resource::ceiling (void) const
+      {
+        return ceiling_;
+      }
+
+      // ======================================================================
+
+      constexpr
+      dispatcher::attributes::attributes ()
+      {
+        ;
+      }
+
+      inline priority_t
+      dispatcher::running_priority (void) const
+      {
+        return running_;
+      }
+
+      inline priority_t
+      dispatcher::ceiling (void) const
+      {
+        return ceiling_;
+      }
+
+      inline thread&
+      dispatcher::worker (void)
+      {
+        return worker_;
+      }
+
+      // ======================================================================
+
+      template<std::size_t S>
+        inline
+        dispatcher_inclusive<S>::dispatcher_inclusive (const attributes& attr) :
+            dispatcher_inclusive<S>
+              { nullptr, attr }
+        {
+          ;
+        }
+
+      /**
+       * @details
+       * The storage for the dispatcher thread stack is part of the
+       * object; the attributes storage members are ignored.
+       */
+      template<std::size_t S>
+        inline
+        dispatcher_inclusive<S>::dispatcher_inclusive (const char* name,
+                                                       const attributes& attr) :
+            dispatcher
+              { name, stack_storage_, sizeof(stack_storage_), attr }
+        {
+          ;
+        }
+
+      template<std::size_t S>
+        dispatcher_inclusive<S>::~dispatcher_inclusive ()
+        {
+          ;
+        }
+
+    } /* namespace srp */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_SRP_H_ */
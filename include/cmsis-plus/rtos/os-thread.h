@@ -55,6 +55,13 @@ namespace
 void
 os_rtos_idle_actions (void);
 
+#if defined(OS_USE_CRASH_DUMP) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+void*
+os_crash_dump_stack_pointer (os::rtos::thread* th);
+
+#endif
+
 /**
  * @endcond
  */
@@ -201,6 +208,65 @@ namespace os
       flags_get (flags::mask_t mask,
                  flags::mode_t mode = flags::mode::all | flags::mode::clear);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      /**
+       * @brief Wait for a thread notification.
+       * @param [out] ovalue Pointer where to store the notification
+       *  value, before clearing; may be `nullptr`.
+       * @param [in] clear The bits to clear in the notification value,
+       *  after reading it.
+       * @retval result::ok A notification was received.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      notify_wait (notify::value_t* ovalue = nullptr,
+                   notify::value_t clear = notify::all);
+
+      /**
+       * @brief Timed wait for a thread notification.
+       * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+       * @param [out] ovalue Pointer where to store the notification
+       *  value, before clearing; may be `nullptr`.
+       * @param [in] clear The bits to clear in the notification value,
+       *  after reading it.
+       * @retval result::ok A notification was received.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT No notification was received during the
+       *  entire timeout duration.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      notify_timed_wait (clock::duration_t timeout, notify::value_t* ovalue =
+                             nullptr,
+                         notify::value_t clear = notify::all);
+
+      /**
+       * @brief Take the thread notification value, as a counter.
+       * @param [in] clear If true, clear the value, otherwise
+       *  decrement it.
+       * @return The notification value before it was cleared or
+       *  decremented, or zero if interrupted or invoked from an
+       *  Interrupt Service Routine.
+       */
+      notify::value_t
+      notify_take (bool clear = true);
+
+      /**
+       * @brief Timed take the thread notification value, as a counter.
+       * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+       * @param [in] clear If true, clear the value, otherwise
+       *  decrement it.
+       * @return The notification value before it was cleared or
+       *  decremented, or zero if the timeout expired, if interrupted,
+       *  or if invoked from an Interrupt Service Routine.
+       */
+      notify::value_t
+      notify_timed_take (clock::duration_t timeout, bool clear = true);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       /**
        * @brief Implementation of the library `__errno()` function.
        * @return Pointer to thread specific `errno`.
@@ -208,6 +274,8 @@ namespace os
       int*
       __errno (void);
 
+      class periodic;
+
     } /* namespace this_thread */
 
     // Forward definitions required by thread friends.
@@ -331,6 +399,15 @@ namespace os
         };
       }; /* struct priority */
 
+      /**
+       * @brief Type of variables holding thread affinity masks.
+       * @details
+       * A bit mask of the cores allowed to run the thread;
+       * bit n stands for core n. 0 means any core.
+       * @ingroup cmsis-plus-rtos-thread
+       */
+      using affinity_t = uint32_t;
+
       /**
        * @brief Type of variables holding thread states.
        */
@@ -380,6 +457,47 @@ namespace os
         /* enum  */
       }; /* struct state */
 
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+      /**
+       * @brief Type of variables holding CPU budget actions.
+       */
+      using budget_action_t = uint8_t;
+
+      /**
+       * @brief CPU budget actions.
+       * @details
+       * The os::rtos::thread::budget_action definition is a container
+       * for the actions taken when a thread exhausts its CPU budget.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-thread
+       */
+      struct budget_action
+      {
+        /**
+         * @brief An enumeration with all possible budget actions.
+         */
+        enum
+          : budget_action_t
+            {
+              /**
+               * @brief Only count the overrun and call the hook.
+               */
+              report = 0, //
+          /**
+           * @brief Lower the priority until the next period.
+           */
+          demote = 1, //
+          /**
+           * @brief Do not run the thread until the next period.
+           */
+          suspend = 2
+        };
+        /* enum  */
+      }; /* struct budget_action */
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
       /**
        * @brief Type of thread function arguments.
        * @details
@@ -517,6 +635,15 @@ namespace os
         stack::element_t*
         top (void);
 
+        /**
+         * @brief Get the stack limit address.
+         * @par Parameters
+         *  None.
+         * @return The lowest address the stack pointer may reach.
+         */
+        stack::element_t*
+        limit (void);
+
         /**
          * @brief Get the stack size.
          * @par Parameters
@@ -555,6 +682,15 @@ namespace os
         std::size_t
         available (void);
 
+        /**
+         * @brief Get the peak stack usage, incrementally.
+         * @par Parameters
+         *  None.
+         * @return Number of used bytes, at the deepest known level.
+         */
+        std::size_t
+        peak (void);
+
         /**
          * @}
          */
@@ -600,6 +736,54 @@ namespace os
         static std::size_t
         default_size (std::size_t size_bytes);
 
+        /**
+         * @brief Get the default stack memory manager.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the memory manager, or `nullptr`.
+         */
+        static memory::memory_resource*
+        default_resource (void);
+
+        /**
+         * @brief Set the default stack memory manager.
+         * @param [in] res Pointer to the memory manager, or `nullptr`.
+         * @return Pointer to the previous memory manager, or `nullptr`.
+         */
+        static memory::memory_resource*
+        default_resource (memory::memory_resource* res);
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+
+        /**
+         * @brief Release all cached stacks.
+         * @par Parameters
+         *  None.
+         * @return The number of stacks released.
+         */
+        static std::size_t
+        cache_flush (void);
+
+        /**
+         * @brief Get the number of stacks taken from the cache.
+         * @par Parameters
+         *  None.
+         * @return A long integer with the number of hits.
+         */
+        static rtos::statistics::counter_t
+        cache_hits (void);
+
+        /**
+         * @brief Get the number of stacks not found in the cache.
+         * @par Parameters
+         *  None.
+         * @return A long integer with the number of misses.
+         */
+        static rtos::statistics::counter_t
+        cache_misses (void);
+
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
+
         /**
          * @}
          */
@@ -614,9 +798,29 @@ namespace os
 
         stack::element_t* bottom_address_;
         std::size_t size_bytes_;
+        // The lowest element known to have been used.
+        stack::element_t* watermark_;
 
         static std::size_t min_size_bytes_;
         static std::size_t default_size_bytes_;
+        static memory::memory_resource* default_resource_;
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+        static stack::element_t*
+        internal_cache_get_ (std::size_t size_elements);
+
+        static bool
+        internal_cache_put_ (stack::element_t* address,
+                             std::size_t size_elements);
+
+        // The stacks of the destroyed threads, allocated with the
+        // default allocator, and their sizes in allocation elements.
+        static stack::element_t* cache_addresses_[OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES];
+        static std::size_t cache_sizes_[OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES];
+        static std::size_t cache_count_;
+        static rtos::statistics::counter_t cache_hits_;
+        static rtos::statistics::counter_t cache_misses_;
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
 
         /**
          * @endcond
@@ -685,6 +889,33 @@ namespace os
         thread::stack&
         stack (void);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        /**
+         * @brief Check if the thread owns a live FPU context.
+         * @par Parameters
+         *  None.
+         * @retval true The thread used the FPU and its context
+         *  is saved and restored with extended frames.
+         * @retval false The thread did not use the FPU; its switches
+         *  use basic frames only.
+         */
+        bool
+        fpu_context_live (void);
+
+        /**
+         * @brief Get the number of switches with an FPU context.
+         * @par Parameters
+         *  None.
+         * @return A long integer with the number of times the
+         *  thread was switched out with an extended frame.
+         */
+        rtos::statistics::counter_t
+        fpu_context_switches (void);
+
+#endif
+
         /**
          * @}
          */
@@ -714,6 +945,11 @@ namespace os
         friend port::stack::element_t*
         port::scheduler::switch_stacks (port::stack::element_t* sp);
 
+#if defined(OS_USE_CRASH_DUMP)
+        friend void*
+        ::os_crash_dump_stack_pointer (thread* th);
+#endif
+
 #endif
         /**
          * @endcond
@@ -746,6 +982,17 @@ namespace os
          */
         port::thread_context_t port_;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT)
+
+        /**
+         * @brief Updated by the port when switching stacks.
+         */
+        rtos::statistics::counter_t fpu_context_switches_ = 0;
+
+        bool fpu_context_live_ = false;
+
+#endif
+
 #endif
 
         /**
@@ -841,6 +1088,80 @@ namespace os
          */
         priority_t th_priority = priority::normal;
 
+        /**
+         * @brief Thread time slice, in scheduler ticks.
+         * @details
+         * When the quantum expires, the running thread is moved to
+         * the back of the threads with the same priority.
+         * If 0, the thread is not time sliced.
+         *
+         * The default is `OS_INTEGER_RTOS_THREAD_QUANTUM_TICKS`.
+         */
+        port::clock::duration_t th_quantum_ticks =
+            OS_INTEGER_RTOS_THREAD_QUANTUM_TICKS;
+
+        /**
+         * @brief Thread preemption threshold.
+         * @details
+         * While running, the thread can be preempted only by
+         * threads with a priority higher than the threshold.
+         * If `priority::none`, or not higher than the thread
+         * priority, the thread can be preempted by any higher
+         * priority thread.
+         */
+        priority_t th_preemption_threshold = priority::none;
+
+        /**
+         * @brief Name of the memory region for the thread stack.
+         * @details
+         * If not `nullptr` and a resource was registered with
+         * `memory::set_region()` under this name, the stack is
+         * allocated from that resource, otherwise the thread
+         * allocator is used. Ignored if `th_stack_address` is set.
+         */
+        const char* th_stack_region = nullptr;
+
+        /**
+         * @brief Memory manager for the thread stack.
+         * @details
+         * If not `nullptr`, the stack is allocated from this memory
+         * manager, for example a pool of stacks; it has precedence
+         * over `th_stack_region` and `thread::stack::default_resource()`.
+         * Ignored if `th_stack_address` is set.
+         */
+        memory::memory_resource* th_stack_resource = nullptr;
+
+        /**
+         * @brief Thread affinity mask.
+         * @details
+         * The cores allowed to run the thread, bit n for core n;
+         * if 0, any core.
+         */
+        affinity_t th_affinity = 0;
+
+        /**
+         * @brief Earliest deadline first period, in scheduler ticks.
+         * @details
+         * If not 0, the thread belongs to the EDF class; among the
+         * ready threads with the same priority, the one with the
+         * earliest absolute deadline runs first.
+         * If 0, the thread is scheduled by fixed priority only.
+         *
+         * Ignored unless `OS_INCLUDE_RTOS_SCHEDULER_EDF` is defined.
+         */
+        port::clock::duration_t th_period_ticks = 0;
+
+        /**
+         * @brief Earliest deadline first relative deadline, in
+         * scheduler ticks.
+         * @details
+         * The absolute deadline of each job is its release time
+         * plus this value. If 0, the deadline is the period.
+         *
+         * Ignored unless `OS_INCLUDE_RTOS_SCHEDULER_EDF` is defined.
+         */
+        port::clock::duration_t th_deadline_ticks = 0;
+
         // Add more attributes here.
 
         /**
@@ -850,7 +1171,9 @@ namespace os
       }; /* class attributes */
 
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
-  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 
       /**
        * @brief Thread statistics.
@@ -931,6 +1254,87 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+        /**
+         * @brief Get the thread CPU load.
+         * @param [in] window The averaging window.
+         * @return The average load, in hundredths of a percent.
+         */
+        rtos::statistics::load_t
+        cpu_load (rtos::statistics::load_window_t window =
+                      rtos::statistics::load_window::one_second);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+
+        /**
+         * @brief Number of bins in the ready latency histogram.
+         */
+        static constexpr std::size_t ready_latency_bins =
+            OS_INTEGER_RTOS_STATISTICS_THREAD_READY_LATENCY_BINS;
+
+        /**
+         * @brief Type of the ready latency histogram counters.
+         */
+        using histogram_counter_t = uint32_t;
+
+        /**
+         * @brief Get the shortest ready to running latency.
+         * @par Parameters
+         *  None.
+         * @return A long integer with the number of high resolution
+         *  clock cycles, or the maximum value if no sample was recorded.
+         */
+        rtos::statistics::duration_t
+        ready_latency_min (void);
+
+        /**
+         * @brief Get the longest ready to running latency.
+         * @par Parameters
+         *  None.
+         * @return A long integer with the number of high resolution
+         *  clock cycles.
+         */
+        rtos::statistics::duration_t
+        ready_latency_max (void);
+
+        /**
+         * @brief Get the ready to running latency histogram.
+         * @par Parameters
+         *  None.
+         * @return Pointer to an array of `ready_latency_bins` counters.
+         */
+        const histogram_counter_t*
+        ready_latency_histogram (void);
+
+        /**
+         * @brief Clear the ready to running latency statistics.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        clear_ready_latency (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+        /**
+         * @brief Get the number of missed deadlines.
+         * @par Parameters
+         *  None.
+         * @return A long integer with the number of EDF jobs
+         *  completed after their absolute deadline.
+         */
+        rtos::statistics::counter_t
+        deadline_misses (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
         /**
          * @}
          */
@@ -944,6 +1348,18 @@ namespace os
         friend void
         rtos::scheduler::internal_switch_threads (void);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+
+        friend class internal::ready_threads_list;
+
+        void
+        internal_mark_ready_ (void);
+
+        void
+        internal_mark_running_ (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
         rtos::statistics::counter_t context_switches_ = 0;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
@@ -952,6 +1368,33 @@ namespace os
         rtos::statistics::duration_t cpu_cycles_ = 0;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+        friend class rtos::scheduler::statistics::internal_cpu_load_sampler;
+
+        // The CPU cycles at the previous sample.
+        rtos::statistics::duration_t cpu_load_cycles_ = 0;
+        // The moving averages, in 1/65536 units.
+        uint32_t cpu_load_[rtos::statistics::load_window::count] =
+          { 0 };
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+        // High resolution timestamp when the thread became ready,
+        // or 0 if not ready or the scheduler was not yet started.
+        rtos::statistics::duration_t ready_timestamp_ = 0;
+        rtos::statistics::duration_t ready_latency_min_ =
+            static_cast<rtos::statistics::duration_t> (-1);
+        rtos::statistics::duration_t ready_latency_max_ = 0;
+        histogram_counter_t ready_latency_histogram_[ready_latency_bins] =
+          { 0 };
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        friend class this_thread::periodic;
+
+        rtos::statistics::counter_t deadline_misses_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
         /**
          * @endcond
          */
@@ -960,45 +1403,333 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
-#pragma GCC diagnostic pop
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
 
       /**
-       * @brief Default thread initialiser.
+       * @brief Thread local storage.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-thread
+       *
+       * @details
+       * A fixed number of pointer slots, stored inline in each
+       * thread. Keys are global; a key identifies the same
+       * slot in all threads.
        */
-      static const attributes initializer;
+      class tls
+      {
+      public:
 
-      // ======================================================================
+        /**
+         * @brief Type of thread local storage keys.
+         * @details
+         * The key is the slot index.
+         */
+        using key_t = std::size_t;
 
-      /**
-       * @brief Default RTOS allocator.
-       */
-      using allocator_type = memory::allocator<stack::allocation_element_t>;
+        /**
+         * @brief Type of slot destructors.
+         * @details
+         * Called at thread exit with the non-null slot value.
+         */
+        using destructor_t = void (*) (void* value);
 
-      /**
-       * @name Constructors & Destructor
-       * @{
-       */
+        /**
+         * @brief Number of slots in each thread.
+         */
+        static constexpr std::size_t slots = OS_INTEGER_RTOS_THREAD_TLS_SLOTS;
 
-      /**
-       * @brief Construct a thread object instance.
-       * @param [in] function Pointer to thread function.
-       * @param [in] args Pointer to thread function arguments.
-       * @param [in] attr Reference to attributes.
-       * @param [in] allocator Reference to allocator. Default a local temporary instance.
-       */
-      thread (func_t function, func_args_t args, const attributes& attr =
-                  initializer,
-              const allocator_type& allocator = allocator_type ());
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
 
-      /**
-       * @brief Construct a named thread object instance.
-       * @param [in] name Pointer to name.
-       * @param [in] function Pointer to thread function.
-       * @param [in] args Pointer to thread function arguments.
-       * @param [in] attr Reference to attributes.
-       * @param [in] allocator Reference to allocator. Default a local temporary instance.
-       */
-      thread (const char* name, func_t function, func_args_t args,
+        /**
+         * @brief Construct a thread local storage object instance.
+         * @par Parameters
+         *  None.
+         */
+        tls () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        tls (const tls&) = delete;
+        tls (tls&&) = delete;
+        tls&
+        operator= (const tls&) = delete;
+        tls&
+        operator= (tls&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the thread local storage object instance.
+         */
+        ~tls () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the value of a slot.
+         * @param [in] key The slot key.
+         * @return The slot value, or `nullptr` if never set.
+         */
+        void*
+        get (key_t key) const;
+
+        /**
+         * @brief Set the value of a slot.
+         * @param [in] key The slot key.
+         * @param [in] value The new slot value.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        set (key_t key, void* value);
+
+        /**
+         * @brief Allocate a key.
+         * @param [out] key Pointer to the location where to store
+         *  the allocated key.
+         * @param [in] destructor Pointer to a function to be called
+         *  at thread exit; may be `nullptr`.
+         * @retval result::ok The key was allocated.
+         * @retval EAGAIN All slots are in use.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         */
+        static result_t
+        create_key (key_t* key, destructor_t destructor = nullptr);
+
+        /**
+         * @brief Release a key.
+         * @param [in] key The slot key.
+         * @retval result::ok The key was released.
+         * @retval EINVAL The key is not allocated.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         */
+        static result_t
+        delete_key (key_t key);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class rtos::thread;
+
+        void
+        internal_run_destructors_ (void);
+
+        void* slots_[slots] =
+          { nullptr };
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+
+      /**
+       * @brief Per thread cache of small memory blocks.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       *
+       * @details
+       * A bounded stack of recently freed small blocks, stored
+       * inline in each thread. The global `operator new()` and the
+       * sized `operator delete()` first try the cache of the current
+       * thread, and only if this fails they lock the scheduler to
+       * access the default memory resource.
+       *
+       * All small allocations are rounded up to the cache block size,
+       * so any cached block can be reused for any small request.
+       *
+       * @warning The cached blocks belong to the default memory
+       * resource; do not change it while caches are not empty.
+       */
+      class allocation_cache
+      {
+      public:
+
+        /**
+         * @brief Maximum number of cached blocks in each thread.
+         */
+        static constexpr std::size_t blocks =
+            OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS;
+
+        /**
+         * @brief Size of the cached blocks, in bytes.
+         */
+        static constexpr std::size_t block_size_bytes =
+            OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCK_SIZE_BYTES;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an allocation cache object instance.
+         * @par Parameters
+         *  None.
+         */
+        allocation_cache () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        allocation_cache (const allocation_cache&) = delete;
+        allocation_cache (allocation_cache&&) = delete;
+        allocation_cache&
+        operator= (const allocation_cache&) = delete;
+        allocation_cache&
+        operator= (allocation_cache&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the allocation cache object instance.
+         */
+        ~allocation_cache () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get a block from the cache.
+         * @param [in] bytes The number of bytes to allocate.
+         * @return Pointer to a block of `block_size_bytes`,
+         *  or `nullptr` if the request is too large or the
+         *  cache is empty.
+         */
+        void*
+        allocate (std::size_t bytes);
+
+        /**
+         * @brief Return a block to the cache.
+         * @param [in] addr Address of a block allocated from the
+         *  default memory resource.
+         * @param [in] bytes The number of bytes originally requested.
+         * @retval true The block was cached.
+         * @retval false The block is not small or the cache is full.
+         */
+        bool
+        deallocate (void* addr, std::size_t bytes);
+
+        /**
+         * @brief Return all cached blocks to the default memory resource.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        flush (void);
+
+        /**
+         * @brief Get the number of cached blocks.
+         * @par Parameters
+         *  None.
+         * @return The number of blocks in the cache.
+         */
+        std::size_t
+        count (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        void* cached_[blocks] =
+          { nullptr };
+
+        std::size_t count_ = 0;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @brief Default thread initialiser.
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @brief Default RTOS allocator.
+       */
+      using allocator_type = memory::allocator<stack::allocation_element_t>;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a thread object instance.
+       * @param [in] function Pointer to thread function.
+       * @param [in] args Pointer to thread function arguments.
+       * @param [in] attr Reference to attributes.
+       * @param [in] allocator Reference to allocator. Default a local temporary instance.
+       */
+      thread (func_t function, func_args_t args, const attributes& attr =
+                  initializer,
+              const allocator_type& allocator = allocator_type ());
+
+      /**
+       * @brief Construct a named thread object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] function Pointer to thread function.
+       * @param [in] args Pointer to thread function arguments.
+       * @param [in] attr Reference to attributes.
+       * @param [in] allocator Reference to allocator. Default a local temporary instance.
+       */
+      thread (const char* name, func_t function, func_args_t args,
               const attributes& attr = initializer,
               const allocator_type& allocator = allocator_type ());
 
@@ -1139,6 +1870,130 @@ namespace os
       priority_t
       priority_inherited (void);
 
+      /**
+       * @brief Set the preemption threshold.
+       * @param [in] prio New threshold; `priority::none` to disable it.
+       * @retval result::ok The threshold was set.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The value of prio is invalid.
+       */
+      result_t
+      preemption_threshold (priority_t prio);
+
+      /**
+       * @brief Get the preemption threshold.
+       * @par Parameters
+       *  None.
+       * @return The thread preemption threshold. May be `priority::none`.
+       */
+      priority_t
+      preemption_threshold (void);
+
+      /**
+       * @brief Set the affinity mask.
+       * @param [in] mask The cores allowed to run the thread; 0 for any.
+       * @retval result::ok The mask was set.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The mask has no core available to the scheduler.
+       */
+      result_t
+      affinity (affinity_t mask);
+
+      /**
+       * @brief Get the affinity mask.
+       * @par Parameters
+       *  None.
+       * @return The cores allowed to run the thread; 0 for any.
+       */
+      affinity_t
+      affinity (void);
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @brief Get the earliest deadline first period.
+       * @par Parameters
+       *  None.
+       * @return The period, in scheduler ticks; 0 for a fixed
+       *  priority thread.
+       */
+      port::clock::duration_t
+      period (void);
+
+      /**
+       * @brief Get the absolute deadline of the current job.
+       * @par Parameters
+       *  None.
+       * @return The scheduler clock time stamp of the deadline;
+       *  the maximum value for a fixed priority thread.
+       */
+      port::clock::timestamp_t
+      deadline (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+      /**
+       * @brief Set the CPU budget.
+       * @param [in] cycles The high resolution clock cycles the thread
+       *  may run in each period; 0 to remove the budget.
+       * @param [in] period_ticks The period, in scheduler ticks.
+       * @param [in] action What to do when the budget is exhausted.
+       * @param [in] demoted_prio The priority used until the end of
+       *  the period, for `budget_action::demote`.
+       * @retval result::ok The budget was set.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The period is 0, the action or the demoted
+       *  priority is invalid.
+       */
+      result_t
+      cpu_budget (rtos::statistics::duration_t cycles,
+                  port::clock::duration_t period_ticks,
+                  budget_action_t action = budget_action::report,
+                  priority_t demoted_prio = priority::low);
+
+      /**
+       * @brief Get the CPU budget.
+       * @par Parameters
+       *  None.
+       * @return The cycles allowed in each period; 0 if there is
+       *  no budget.
+       */
+      rtos::statistics::duration_t
+      cpu_budget (void);
+
+      /**
+       * @brief Get the CPU cycles used in the current period.
+       * @par Parameters
+       *  None.
+       * @return The cycles used since the period started, accounted
+       *  at context switches.
+       */
+      rtos::statistics::duration_t
+      cpu_budget_used (void);
+
+      /**
+       * @brief Get the number of exhausted budgets.
+       * @par Parameters
+       *  None.
+       * @return The number of periods when the budget was exhausted.
+       */
+      rtos::statistics::counter_t
+      cpu_budget_overruns (void);
+
+      /**
+       * @brief Check if the budget of the current period is exhausted.
+       * @par Parameters
+       *  None.
+       * @retval true The budget was exhausted; the action is in effect.
+       * @retval false The thread is within its budget.
+       */
+      bool
+      cpu_budget_exhausted (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
 #if 0
       // ???
       result_t
@@ -1213,6 +2068,32 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE) */
 
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+
+      /**
+       * @brief Get the thread local storage.
+       * @par Parameters
+       *  None.
+       * @return A reference to the thread local storage object instance.
+       */
+      class thread::tls&
+      tls (void);
+
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+
+      /**
+       * @brief Get the allocation cache.
+       * @par Parameters
+       *  None.
+       * @return A reference to the allocation cache object instance.
+       */
+      class thread::allocation_cache&
+      allocation_cache (void);
+
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
       /**
        * @brief Raise thread event flags.
        * @param [in] mask The OR-ed flags to raise.
@@ -1225,6 +2106,23 @@ namespace os
       result_t
       flags_raise (flags::mask_t mask, flags::mask_t* oflags = nullptr);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      /**
+       * @brief Notify the thread.
+       * @param [in] value The value used by the action.
+       * @param [in] action How the notification value is updated.
+       * @retval result::ok The thread was notified.
+       * @retval EAGAIN The action is `notify::action::no_overwrite`
+       *  and a notification is already pending.
+       * @retval EINVAL The action is not valid.
+       */
+      result_t
+      notify (notify::value_t value = 1, notify::action_t action =
+                  notify::action::increment);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
 #if defined(OS_INCLUDE_RTOS_THREAD_PUBLIC_FLAGS_CLEAR)
 
       // This is a kludge required to support CMSIS RTOS V1
@@ -1253,11 +2151,27 @@ namespace os
       stack (void);
 
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
-  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 
       class thread::statistics&
       statistics (void);
 
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      /**
+       * @brief Get the thread context.
+       * @par Parameters
+       *  None.
+       * @return A reference to the context object instance.
+       */
+      class thread::context&
+      context (void);
+
 #endif
 
       /**
@@ -1276,6 +2190,8 @@ namespace os
        */
 
       friend class mutex;
+      friend class internal::timeout_thread_node;
+      friend struct internal::c_api_layout;
 
       friend void
       this_thread::suspend (void);
@@ -1301,6 +2217,25 @@ namespace os
       friend flags::mask_t
       this_thread::flags_get (flags::mask_t mask, flags::mode_t mode);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      friend result_t
+      this_thread::notify_wait (notify::value_t* ovalue,
+                                notify::value_t clear);
+
+      friend result_t
+      this_thread::notify_timed_wait (clock::duration_t timeout,
+                                      notify::value_t* ovalue,
+                                      notify::value_t clear);
+
+      friend notify::value_t
+      this_thread::notify_take (bool clear);
+
+      friend notify::value_t
+      this_thread::notify_timed_take (clock::duration_t timeout, bool clear);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       friend int*
       this_thread::__errno (void);
 
@@ -1326,6 +2261,16 @@ namespace os
       friend void
       scheduler::internal_switch_threads (void);
 
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+      friend bool
+      scheduler::internal_check_quantum (void);
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+      friend bool
+      scheduler::internal_check_cpu_budgets (void);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
       friend void
       port::scheduler::reschedule (void);
 
@@ -1338,6 +2283,11 @@ namespace os
       friend void
       ::os_rtos_idle_actions (void);
 
+#if defined(OS_USE_CRASH_DUMP) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+      friend void*
+      ::os_crash_dump_stack_pointer (thread* th);
+#endif
+
       friend class internal::ready_threads_list;
       friend class internal::thread_children_list;
       friend class internal::waiting_threads_list;
@@ -1348,6 +2298,10 @@ namespace os
       friend class condition_variable;
       friend class mutex;
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+      friend class this_thread::periodic;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
       /**
        * @endcond
        */
@@ -1390,6 +2344,20 @@ namespace os
       void
       internal_suspend_ (void);
 
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      /**
+       * @brief Link this thread to the ready list, without rescheduling.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_make_ready_ (void);
+
+#endif
+
       /**
        * @brief Terminate thread by itself.
        * @param [in] exit_ptr Pointer to object to return (optional).
@@ -1504,6 +2472,40 @@ namespace os
       flags::mask_t
       internal_flags_get_ (flags::mask_t mask, flags::mode_t mode);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      /**
+       * @brief Wait for a notification, or for a non-zero value.
+       * @param [in] take If true, wait for a non-zero value and
+       *  clear or decrement it, otherwise wait for a pending
+       *  notification and clear the given bits.
+       * @param [in] clear For take, if non-zero clear the value,
+       *  otherwise decrement it; for wait, the bits to clear.
+       * @param [out] ovalue Pointer where to store the value before
+       *  clearing; may be `nullptr`.
+       * @param [in] timeout Pointer to the timeout, or `nullptr`
+       *  to wait forever.
+       * @retval result::ok A notification was received.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT The timeout expired.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      internal_notify_wait_ (bool take, notify::value_t clear,
+                             notify::value_t* ovalue,
+                             const clock::duration_t* timeout);
+
+      /**
+       * @brief Consume the notification, if available.
+       * @retval true The notification was consumed.
+       * @retval false Nothing available, the caller must wait.
+       */
+      bool
+      internal_notify_check_ (bool take, notify::value_t clear,
+                              notify::value_t* ovalue);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       /**
        * @brief The actual destructor, also called from exit() and kill().
        * @par Parameters
@@ -1514,46 +2516,175 @@ namespace os
       virtual void
       internal_destroy_ (void);
 
-      /**
-       * @par Parameters
-       *  None.
-       * @par Returns
-       *  Nothing.
-       */
-      void
-      internal_relink_running_ (void);
+      /**
+       * @brief Destroy the thread, if terminated and not yet
+       *  taken by the idle thread.
+       * @par Parameters
+       *  None.
+       * @retval true The thread was destroyed.
+       * @retval false The thread was not terminated, or is
+       *  destroyed by someone else.
+       */
+      bool
+      internal_reclaim_ (void);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE)
+
+      /**
+       * @brief Destroy all terminated threads.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      static void
+      internal_reclaim_terminated_ (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE) */
+
+      /**
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_relink_running_ (void);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+      /**
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_exhaust_cpu_budget_ (void);
+
+      /**
+       * @param [in] now The scheduler clock time stamp.
+       * @retval true The thread became ready or was raised.
+       * @retval false Nothing changed for the scheduler.
+       */
+      bool
+      internal_replenish_cpu_budget_ (port::clock::timestamp_t now);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
+      /**
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_check_stack_ (void);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      // The members are grouped by access frequency: first those
+      // used by the scheduler on each context switch, wakeup and
+      // timeout, which, with the context (that includes the stack
+      // pointer), usually fit in one or two cache lines; then those
+      // used only when the thread is created, joined or destroyed,
+      // or by the optional features.
+
+      // ----- Hot members ----------------------------------------------------
+
+      // TODO: make it fully intrusive with computed offset.
+      internal::waiting_thread_node ready_node_
+        { *this };
+
+      // The thread state is set:
+      // - running - in ready_threads_list::unlink_head()
+      // - ready - in ready_threads_list::link()
+      // - waiting - in clock::internal_wait_until(),
+      //              scheduler::internal_link_node()
+      //              thread::_timed_flags_wait()
+      // - terminated - in state::internal_exit_()
+      // - destroyed - in thread::internal_destroy_()
+      state_t volatile state_ = state::undefined;
+
+      // There are two values used as thread priority. The main one is
+      // assigned via `priority(int)`, and is stored in `prio_assigned_`.
+      // This value is normally used by the scheduler.
+      // However, to prevent priority inversion, mutexes might temporarily
+      // boost priorities via `priority_inherited(int)`; this second
+      // value is stored in `prio_inherited_`.
+
+      // POSIX: While a thread is holding a mutex which has been
+      // initialised with the mutex::protocol::inherit or
+      // mutex::protocol::protect protocol attributes, it shall
+      // not be subject to being moved to the tail of the scheduling
+      // queue at its priority in the event that its original
+      // priority is changed, such as by a POSIX call to sched_setparam().
+      priority_t volatile prio_assigned_ = priority::none;
+      priority_t volatile prio_inherited_ = priority::none;
+
+      // While running, only threads above this priority can preempt.
+      priority_t volatile preemption_threshold_ = priority::none;
+
+      bool volatile interrupted_ = false;
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
 
-      /**
-       * @par Parameters
-       *  None.
-       * @par Returns
-       *  Nothing.
-       */
-      void
-      internal_check_stack_ (void);
+      // Time slice, in ticks, and how much of it is left; the
+      // remaining ticks are reloaded when the thread is switched in.
+      port::clock::duration_t quantum_ticks_ = 0;
+      port::clock::duration_t volatile quantum_remaining_ = 0;
 
-      /**
-       * @endcond
-       */
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
 
-      /**
-       * @}
-       */
+      // Pointer to waiting node (stored on stack)
+      internal::waiting_thread_node* waiting_node_ = nullptr;
 
-    protected:
+      // Pointer to timeout node (stored on stack)
+      internal::timeout_thread_node* clock_node_ = nullptr;
 
       /**
-       * @name Private Member Variables
-       * @{
+       * @brief Pointer to clock to be used for timeouts.
        */
+      clock* clock_ = nullptr;
 
-      /**
-       * @cond ignore
-       */
+      internal::event_flags event_flags_;
 
-      // TODO: make it fully intrusive with computed offset.
-      internal::waiting_thread_node ready_node_
-        { *this };
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+      notify::value_t volatile notify_value_ = 0;
+      bool volatile notify_pending_ = false;
+      // Set only while the thread is suspended in a notify wait;
+      // the notifier resumes it only then.
+      bool volatile notify_waiting_ = false;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
+      // Implementation
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+      friend class port::thread;
+      os_thread_port_data_t port_;
+#endif
+
+      // The stack and the saved stack pointer, used on each context
+      // switch. The large and rarely used members follow it.
+      class context context_;
+
+      // ----- Cold members ---------------------------------------------------
 
       func_t func_ = nullptr;
       func_args_t func_args_ = nullptr;
@@ -1582,21 +2713,15 @@ namespace os
       // Thread waiting to join.
       thread* joiner_ = nullptr;
 
-      // Pointer to waiting node (stored on stack)
-      internal::waiting_thread_node* waiting_node_ = nullptr;
-
-      // Pointer to timeout node (stored on stack)
-      internal::timeout_thread_node* clock_node_ = nullptr;
-
       /**
-       * @brief Pointer to clock to be used for timeouts.
+       * @brief Pointer to allocator.
        */
-      clock* clock_ = nullptr;
+      const void* allocator_ = nullptr;
 
       /**
-       * @brief Pointer to allocator.
+       * @brief Pointer to the region resource used for the stack, if any.
        */
-      const void* allocator_ = nullptr;
+      memory::memory_resource* allocated_stack_resource_ = nullptr;
 
       stack::element_t* allocated_stack_address_ = nullptr;
 
@@ -1605,56 +2730,72 @@ namespace os
       // TODO: Add a list, to properly process robustness.
       std::size_t volatile acquired_mutexes_ = 0;
 
-      // The thread state is set:
-      // - running - in ready_threads_list::unlink_head()
-      // - ready - in ready_threads_list::link()
-      // - waiting - in clock::internal_wait_until(),
-      //              scheduler::internal_link_node()
-      //              thread::_timed_flags_wait()
-      // - terminated - in state::internal_exit_()
-      // - destroyed - in thread::internal_destroy_()
-      state_t volatile state_ = state::undefined;
+      affinity_t affinity_ = 0;
 
-      // There are two values used as thread priority. The main one is
-      // assigned via `priority(int)`, and is stored in `prio_assigned_`.
-      // This value is normally used by the scheduler.
-      // However, to prevent priority inversion, mutexes might temporarily
-      // boost priorities via `priority_inherited(int)`; this second
-      // value is stored in `prio_inherited_`.
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 
-      // POSIX: While a thread is holding a mutex which has been
-      // initialised with the mutex::protocol::inherit or
-      // mutex::protocol::protect protocol attributes, it shall
-      // not be subject to being moved to the tail of the scheduling
-      // queue at its priority in the event that its original
-      // priority is changed, such as by a POSIX call to sched_setparam().
-      priority_t volatile prio_assigned_ = priority::none;
-      priority_t volatile prio_inherited_ = priority::none;
+      // Earliest deadline first parameters, in sysclock ticks; the
+      // fixed priority threads keep the maximum deadline, so they
+      // are ordered after the EDF threads with the same priority.
+      port::clock::duration_t period_ticks_ = 0;
+      port::clock::duration_t deadline_ticks_ = 0;
+      port::clock::timestamp_t volatile deadline_ =
+          static_cast<port::clock::timestamp_t> (-1);
 
-      bool volatile interrupted_ = false;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
 
-      internal::event_flags event_flags_;
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+    public:
+
+      // Intrusive node used to link this thread to the list of
+      // threads with a CPU budget, replenished on SysTick.
+      utils::double_list_links budget_links_;
+
+      using budget_threads_list = utils::intrusive_list<
+      thread, utils::double_list_links, &thread::budget_links_>;
+
+      static budget_threads_list budget_threads__;
+
+    protected:
+
+      // The budget is in high resolution clock cycles, the period
+      // in scheduler ticks; the used cycles are charged at each
+      // context switch, with the CPU cycles statistics.
+      port::clock::timestamp_t budget_period_end_ = 0;
+      rtos::statistics::duration_t budget_cycles_ = 0;
+      rtos::statistics::duration_t volatile budget_used_ = 0;
+      rtos::statistics::counter_t budget_overruns_ = 0;
+      port::clock::duration_t budget_period_ticks_ = 0;
+      priority_t budget_saved_prio_ = priority::none;
+      priority_t budget_demoted_prio_ = priority::none;
+      budget_action_t budget_action_ = budget_action::report;
+      bool volatile budget_exhausted_ = false;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
 
 #if defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE) || defined(__DOXYGEN__)
       os_thread_user_storage_t user_storage_;
 #endif /* defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE) */
 
-#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+      class tls tls_;
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
 
-      class statistics statistics_;
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+      class allocation_cache allocation_cache_;
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
 
-#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 
-      // Add other internal data
+      class statistics statistics_;
 
-      // Implementation
-#if defined(OS_USE_RTOS_PORT_SCHEDULER)
-      friend class port::thread;
-      os_thread_port_data_t port_;
 #endif
 
-      // Better be the last one!
-      context context_;
+      // Add other internal data
 
       /**
        * @endcond
@@ -1844,6 +2985,145 @@ namespace os
 
       };
 
+    namespace this_thread
+    {
+      // ======================================================================
+
+      /**
+       * @brief Periodic release of the current thread.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-thread
+       *
+       * @details
+       * The release times are absolute, multiples of the period
+       * from the moment the object was constructed, so the loop
+       * does not drift. The clock node is part of the object and
+       * is re-armed on each period.
+       *
+       * The object must be constructed and used by the same thread.
+       */
+      class periodic
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a periodic object for the current thread.
+         * @param [in] period The period, in clock units.
+         * @param [in] clk Reference to the steady clock to use.
+         */
+        periodic (clock::duration_t period, clock& clk = sysclock);
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+        /**
+         * @brief Construct a periodic object with the thread period.
+         * @par Parameters
+         *  None.
+         */
+        periodic (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        periodic (const periodic&) = delete;
+        periodic (periodic&&) = delete;
+        periodic&
+        operator= (const periodic&) = delete;
+        periodic&
+        operator= (periodic&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the periodic object.
+         */
+        ~periodic () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Wait for the next release time.
+         * @par Parameters
+         *  None.
+         * @retval result::ok The thread was released on time.
+         * @retval ETIMEDOUT One or more release times already passed;
+         *  they were counted as overruns and skipped.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines,
+         *  with the scheduler locked, or from another thread.
+         * @retval EINTR The wait was interrupted.
+         */
+        result_t
+        wait_next_period (void);
+
+        /**
+         * @brief Get the period.
+         * @par Parameters
+         *  None.
+         * @return The period, in clock units.
+         */
+        clock::duration_t
+        period (void) const;
+
+        /**
+         * @brief Get the last release time.
+         * @par Parameters
+         *  None.
+         * @return The steady time stamp of the last release.
+         */
+        clock::timestamp_t
+        release (void) const;
+
+        /**
+         * @brief Get the number of skipped release times.
+         * @par Parameters
+         *  None.
+         * @return The number of periods missed since construction.
+         */
+        std::size_t
+        overruns (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        clock* clock_;
+        internal::timeout_thread_node node_;
+        clock::duration_t period_;
+        std::size_t overruns_ = 0;
+
+        /**
+         * @endcond
+         */
+      };
+
+    } /* namespace this_thread */
+
 #pragma GCC diagnostic pop
 
   } /* namespace rtos */
@@ -1998,6 +3278,71 @@ namespace os
         return this_thread::thread ().internal_flags_clear_ (mask, oflags);
       }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      /**
+       * @details
+       * If no notification is pending, suspend the calling thread
+       * until `thread::notify()` is called for it; afterwards clear
+       * the pending state and the `clear` bits of the value.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline result_t
+      notify_wait (notify::value_t* ovalue, notify::value_t clear)
+      {
+        return this_thread::thread ().internal_notify_wait_ (false, clear,
+                                                             ovalue, nullptr);
+      }
+
+      /**
+       * @details
+       * Similar to `notify_wait()`, but with a timeout.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline result_t
+      notify_timed_wait (clock::duration_t timeout, notify::value_t* ovalue,
+                         notify::value_t clear)
+      {
+        return this_thread::thread ().internal_notify_wait_ (false, clear,
+                                                             ovalue, &timeout);
+      }
+
+      /**
+       * @details
+       * Used with `notify::action::increment`, the notification
+       * value behaves like a counting (`clear` false) or a binary
+       * (`clear` true) semaphore private to the thread.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline notify::value_t
+      notify_take (bool clear)
+      {
+        notify::value_t value = 0;
+        this_thread::thread ().internal_notify_wait_ (true, clear, &value,
+                                                      nullptr);
+        return value;
+      }
+
+      /**
+       * @details
+       * Similar to `notify_take()`, but with a timeout.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline notify::value_t
+      notify_timed_take (clock::duration_t timeout, bool clear)
+      {
+        notify::value_t value = 0;
+        this_thread::thread ().internal_notify_wait_ (true, clear, &value,
+                                                      &timeout);
+        return value;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       /**
        * @details
        * Terminate the calling thread and make the value _value_ptr_
@@ -2046,6 +3391,12 @@ namespace os
        * The actual C library function, used by newlib,
        * is in `os-core.cpp`.
        *
+       * With the reference scheduler, the slot is reached with a
+       * single load of the current thread pointer, which refers to
+       * a static placeholder until the first thread runs; from
+       * interrupt handlers it is the slot of the interrupted thread,
+       * so handlers that change `errno` should restore it.
+       *
        * @see __errno()
        *
        */
@@ -2053,7 +3404,31 @@ namespace os
       __attribute__ ((always_inline))
       __errno (void)
       {
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+        return &scheduler::current_thread_->errno_;
+#else
         return &this_thread::thread ().errno_;
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+      }
+
+      // ======================================================================
+
+      inline clock::duration_t
+      periodic::period (void) const
+      {
+        return period_;
+      }
+
+      inline clock::timestamp_t
+      periodic::release (void) const
+      {
+        return node_.timestamp;
+      }
+
+      inline std::size_t
+      periodic::overruns (void) const
+      {
+        return overruns_;
       }
 
     } /* namespace this_thread */
@@ -2087,6 +3462,7 @@ namespace os
     {
       bottom_address_ = nullptr;
       size_bytes_ = 0;
+      watermark_ = nullptr;
     }
 
     /**
@@ -2100,6 +3476,7 @@ namespace os
       assert (size_bytes >= min_size_bytes_);
       bottom_address_ = address;
       size_bytes_ = size_bytes;
+      watermark_ = top ();
     }
 
     /**
@@ -2119,9 +3496,31 @@ namespace os
      * @note Can be invoked from Interrupt Service Routines.
      */
     inline thread::stack::element_t*
-    thread::stack::top (void)
+    thread::stack::top (void)
+    {
+      return bottom_address_ + (size_bytes_ / sizeof(element_t));
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    /**
+     * @details
+     * The address to be programmed in the stack limit register
+     * (PSPLIM on ARMv8-M) when the thread is switched in; it is
+     * just above the bottom magic word, aligned to the stack
+     * allocation element (the limit registers ignore the
+     * lower bits).
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline thread::stack::element_t*
+    thread::stack::limit (void)
     {
-      return bottom_address_ + (size_bytes_ / sizeof(element_t));
+      return bottom_address_
+          + (sizeof(stack::allocation_element_t) / sizeof(stack::element_t));
     }
 
     /**
@@ -2208,6 +3607,67 @@ namespace os
       return tmp;
     }
 
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline memory::memory_resource*
+    thread::stack::default_resource (void)
+    {
+      return default_resource_;
+    }
+
+    /**
+     * @details
+     * If set, the stacks of the threads created without a user
+     * defined stack are allocated from this memory manager, usually
+     * a `memory::block_pool` with blocks of the stack size, so that
+     * creating and destroying short lived threads is deterministic
+     * and does not fragment the free store.
+     *
+     * If the memory manager is exhausted, the thread allocator
+     * is used. The memory manager must be able to allocate
+     * stacks of the requested size.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline memory::memory_resource*
+    thread::stack::default_resource (memory::memory_resource* res)
+    {
+      memory::memory_resource* tmp = default_resource_;
+      default_resource_ = res;
+      return tmp;
+    }
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    thread::stack::cache_hits (void)
+    {
+      return cache_hits_;
+    }
+
+    /**
+     * @details
+     * Only the stacks allocated with the default allocator are
+     * counted.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    thread::stack::cache_misses (void)
+    {
+      return cache_misses_;
+    }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
+
     // ========================================================================
 
     /**
@@ -2232,6 +3692,42 @@ namespace os
       return stack_;
     }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+    /**
+     * @details
+     * With lazy FPU stacking, the extended frame (the FPU
+     * registers) is saved and restored only for threads that
+     * actually executed floating point instructions. The flag is
+     * set by the port in `port::scheduler::switch_stacks()` each
+     * time the thread is switched out, from the frame type
+     * reported by the hardware (on Cortex-M, bit 4 of EXC_RETURN).
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline bool
+    thread::context::fpu_context_live (void)
+    {
+      return fpu_context_live_;
+    }
+
+    /**
+     * @details
+     * Integer only threads should report 0 here; a non zero
+     * value identifies the threads that pay the extended frame
+     * cost on context switches.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    thread::context::fpu_context_switches (void)
+    {
+      return fpu_context_switches_;
+    }
+
+#endif
+
     // ========================================================================
 
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
@@ -2280,6 +3776,108 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+    /**
+     * @details
+     * The exponential moving averages are updated by
+     * scheduler::statistics::sample_cpu_load(); the idle thread
+     * load is the share of time the CPU was not busy.
+     *
+     * @note This function is available only when
+     * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD
+     * is defined.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::load_t
+    thread::statistics::cpu_load (rtos::statistics::load_window_t window)
+    {
+      assert(window < rtos::statistics::load_window::count);
+      return rtos::scheduler::statistics::internal_load_scale_ (
+          cpu_load_[window]);
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+
+    /**
+     * @details
+     * The latency is the time between the moment the thread
+     * was linked to the ready list and the moment it was selected
+     * to run, measured with the high resolution clock.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     *
+     * @note This function is available only when
+     * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY
+     * is defined.
+     */
+    inline rtos::statistics::duration_t
+    thread::statistics::ready_latency_min (void)
+    {
+      return ready_latency_min_;
+    }
+
+    /**
+     * @details
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     *
+     * @note This function is available only when
+     * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY
+     * is defined.
+     */
+    inline rtos::statistics::duration_t
+    thread::statistics::ready_latency_max (void)
+    {
+      return ready_latency_max_;
+    }
+
+    /**
+     * @details
+     * The bins have logarithmic widths; bin 0 counts the
+     * latencies of 0 cycles, and bin `n` counts the latencies
+     * between 2^(n-1) and 2^n-1 cycles. The last bin also counts
+     * all longer latencies.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     *
+     * @note This function is available only when
+     * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY
+     * is defined.
+     */
+    inline const thread::statistics::histogram_counter_t*
+    thread::statistics::ready_latency_histogram (void)
+    {
+      return ready_latency_histogram_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+    /**
+     * @details
+     * A job is counted as late when the thread calls
+     * `this_thread::periodic::wait_next_period()` after its
+     * absolute deadline.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     *
+     * @note This function is available only when
+     * @ref OS_INCLUDE_RTOS_SCHEDULER_EDF
+     * is defined.
+     */
+    inline rtos::statistics::counter_t
+    thread::statistics::deadline_misses (void)
+    {
+      return deadline_misses_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
     // ========================================================================
 
     /**
@@ -2328,6 +3926,84 @@ namespace os
       return interrupted_;
     }
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline port::clock::duration_t
+    thread::period (void)
+    {
+      return period_ticks_;
+    }
+
+    /**
+     * @details
+     * The deadline is set when the thread is created and at each
+     * release by `this_thread::periodic::wait_next_period()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline port::clock::timestamp_t
+    thread::deadline (void)
+    {
+      return deadline_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::duration_t
+    thread::cpu_budget (void)
+    {
+      return budget_cycles_;
+    }
+
+    /**
+     * @details
+     * The cycles of the running thread are added at the next
+     * context switch.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::duration_t
+    thread::cpu_budget_used (void)
+    {
+      return budget_used_;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    thread::cpu_budget_overruns (void)
+    {
+      return budget_overruns_;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline bool
+    thread::cpu_budget_exhausted (void)
+    {
+      return budget_exhausted_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
 #if defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE) || defined(__DOXYGEN__)
 
     /**
@@ -2355,6 +4031,100 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE) */
 
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+
+    /**
+     * @details
+     * To reach the slots of the current thread, use
+     * `this_thread::thread ().tls ()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline class thread::tls&
+    thread::tls (void)
+    {
+      return tls_;
+    }
+
+    /**
+     * @details
+     * The access is a simple indexed load from the thread object.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline void*
+    thread::tls::get (key_t key) const
+    {
+      assert(key < slots);
+      return slots_[key];
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline void
+    thread::tls::set (key_t key, void* value)
+    {
+      assert(key < slots);
+      slots_[key] = value;
+    }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+
+    /**
+     * @details
+     * The cache must be used only by the thread itself, which
+     * makes locking unnecessary.
+     */
+    inline class thread::allocation_cache&
+    thread::allocation_cache (void)
+    {
+      return allocation_cache_;
+    }
+
+    /**
+     * @details
+     * Must be called only by the thread owning the cache.
+     */
+    inline void*
+    thread::allocation_cache::allocate (std::size_t bytes)
+    {
+      if ((bytes > block_size_bytes) || (count_ == 0))
+        {
+          return nullptr;
+        }
+      return cached_[--count_];
+    }
+
+    /**
+     * @details
+     * Blocks with unknown size (0) are not cached.
+     *
+     * Must be called only by the thread owning the cache.
+     */
+    inline bool
+    thread::allocation_cache::deallocate (void* addr, std::size_t bytes)
+    {
+      if ((bytes == 0) || (bytes > block_size_bytes) || (count_ >= blocks))
+        {
+          return false;
+        }
+      cached_[count_++] = addr;
+      return true;
+    }
+
+    inline std::size_t
+    thread::allocation_cache::count (void) const
+    {
+      return count_;
+    }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
 
     /**
@@ -2398,7 +4168,10 @@ namespace os
       return context_.stack_;
     }
 
-#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 
     /**
      * @details
@@ -2411,7 +4184,23 @@ namespace os
       return statistics_;
     }
 
-#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline class thread::context&
+    thread::context (void)
+    {
+      return context_;
+    }
+
+#endif
 
 #if defined(OS_INCLUDE_RTOS_THREAD_PUBLIC_FLAGS_CLEAR)
 
@@ -2535,6 +4324,11 @@ namespace os
           }
         else
           {
+#if defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE)
+            // Free the stacks of the terminated threads first.
+            internal_reclaim_terminated_ ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE) */
+
             allocator_ = &allocator;
 
             if (attr.th_stack_size_bytes > stack::min_size ())
@@ -0,0 +1,541 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_THREADPOOL_H_
+#define CMSIS_PLUS_RTOS_OS_THREADPOOL_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <new>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Thread pool** executor.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-threadpool
+     *
+     * @details
+     * A fixed number of worker threads take jobs from a bounded
+     * ring, in FIFO order. Jobs are passed by value, as
+     * `{func, args}` pairs, without any per job allocation.
+     */
+    class thread_pool : public internal::object_named_system
+    {
+    public:
+
+      // ======================================================================
+
+      /**
+       * @brief Type of job functions.
+       * @par Parameters
+       *  Pointer to arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      using func_t = void (*) (void* args);
+
+      /**
+       * @brief Type of job function arguments.
+       */
+      using func_args_t = void*;
+
+      /**
+       * @brief Job.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-threadpool
+       */
+      class job
+      {
+      public:
+
+        /**
+         * @brief Function to call.
+         */
+        func_t func;
+
+        /**
+         * @brief Function arguments.
+         */
+        func_args_t args;
+
+        /**
+         * @brief Optional semaphore posted when the job completes.
+         * @details
+         * Can be used to wait for the job, as a very
+         * lightweight future.
+         */
+        semaphore* done;
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Thread pool attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-threadpool
+       */
+      class attributes
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a thread pool attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the thread pool attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        // Public members; no accessors and mutators required.
+
+        /**
+         * @brief Size of the workers stacks, in bytes.
+         * @details
+         * If 0, the default is `thread::stack::default_size()`.
+         */
+        std::size_t th_stack_size_bytes = 0;
+
+        /**
+         * @brief Workers priority.
+         */
+        thread::priority_t th_priority = thread::priority::normal;
+
+        // Add more attributes here.
+
+        /**
+         * @}
+         */
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default thread pool initialiser.
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a thread pool object instance.
+       * @param [in] workers The number of worker threads.
+       * @param [in] jobs The maximum number of pending jobs.
+       * @param [in] attr Reference to attributes.
+       */
+      thread_pool (std::size_t workers, std::size_t jobs,
+                   const attributes& attr = initializer);
+
+      /**
+       * @brief Construct a named thread pool object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] workers The number of worker threads.
+       * @param [in] jobs The maximum number of pending jobs.
+       * @param [in] attr Reference to attributes.
+       */
+      thread_pool (const char* name, std::size_t workers, std::size_t jobs,
+                   const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+    protected:
+
+      thread_pool (const char* name, std::size_t workers, std::size_t jobs,
+                   void* threads_storage, void* stacks_storage,
+                   std::size_t stack_size_bytes, job* jobs_storage,
+                   const attributes& attr);
+
+    public:
+
+      // The rule of five.
+      thread_pool (const thread_pool&) = delete;
+      thread_pool (thread_pool&&) = delete;
+      thread_pool&
+      operator= (const thread_pool&) = delete;
+      thread_pool&
+      operator= (thread_pool&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the thread pool object instance.
+       */
+      virtual
+      ~thread_pool ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Submit a job, blocking while the ring is full.
+       * @param [in] func Pointer to function to call.
+       * @param [in] args Pointer to function arguments.
+       * @param [in] done Pointer to semaphore to post at completion.
+       * @retval result::ok The job was queued.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The wait was interrupted.
+       */
+      result_t
+      submit (func_t func, func_args_t args = nullptr,
+              semaphore* done = nullptr);
+
+      /**
+       * @brief Try to submit a job.
+       * @param [in] func Pointer to function to call.
+       * @param [in] args Pointer to function arguments.
+       * @param [in] done Pointer to semaphore to post at completion.
+       * @retval result::ok The job was queued.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EWOULDBLOCK The ring is full.
+       */
+      result_t
+      try_submit (func_t func, func_args_t args = nullptr,
+                  semaphore* done = nullptr);
+
+      /**
+       * @brief Submit multiple jobs.
+       * @param [in] jobs Pointer to array of jobs.
+       * @param [in] count Number of jobs in the array.
+       * @return The number of jobs queued; less than
+       *  `count` only if the wait was interrupted.
+       */
+      std::size_t
+      submit_n (const job* jobs, std::size_t count);
+
+      /**
+       * @brief Wait until all submitted jobs completed.
+       * @par Parameters
+       *  None.
+       * @retval result::ok All jobs completed.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      wait_idle (void);
+
+      /**
+       * @brief Get the number of worker threads.
+       * @par Parameters
+       *  None.
+       * @return The number of threads.
+       */
+      std::size_t
+      workers (void) const;
+
+      /**
+       * @brief Get the maximum number of pending jobs.
+       * @par Parameters
+       *  None.
+       * @return The number of jobs.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get the number of jobs not yet completed.
+       * @par Parameters
+       *  None.
+       * @return The number of jobs, queued or running.
+       */
+      std::size_t
+      busy (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      static void*
+      internal_run_ (void* args);
+
+      void
+      internal_put_ (const job& j);
+
+      void
+      internal_stop_ (void);
+
+      /**
+       * @endcond
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      std::size_t workers_;
+      std::size_t size_;
+
+      thread* threads_;
+      job* jobs_;
+
+      thread* allocated_threads_ = nullptr;
+      job* allocated_jobs_ = nullptr;
+
+      // Protected by the mutex.
+      std::size_t head_ = 0;
+      std::size_t tail_ = 0;
+      // Jobs in the ring.
+      std::size_t queued_ = 0;
+      // Queued or running jobs.
+      std::size_t busy_ = 0;
+
+      mutex mutex_;
+      condition_variable idle_cond_;
+      // Free slots in the ring.
+      semaphore_counting slots_;
+      // Queued jobs (plus stop requests).
+      semaphore_counting pending_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Template of a thread pool with inclusive storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-threadpool
+     *
+     * @tparam W Number of worker threads.
+     * @tparam J Maximum number of pending jobs.
+     * @tparam S Workers stack size, in bytes.
+     */
+    template<std::size_t W, std::size_t J,
+        std::size_t S = port::stack::default_size_bytes>
+      class thread_pool_inclusive : public thread_pool
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a thread pool object instance.
+         * @param [in] attr Reference to attributes.
+         */
+        thread_pool_inclusive (const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named thread pool object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] attr Reference to attributes.
+         */
+        thread_pool_inclusive (const char* name, const attributes& attr =
+                                   initializer);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        thread_pool_inclusive (const thread_pool_inclusive&) = delete;
+        thread_pool_inclusive (thread_pool_inclusive&&) = delete;
+        thread_pool_inclusive&
+        operator= (const thread_pool_inclusive&) = delete;
+        thread_pool_inclusive&
+        operator= (thread_pool_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the thread pool object instance.
+         */
+        virtual
+        ~thread_pool_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        using stack_element_t = port::stack::allocation_element_t;
+
+        static constexpr std::size_t stack_elements = (S
+            + sizeof(stack_element_t) - 1) / sizeof(stack_element_t);
+
+        typename std::aligned_storage<sizeof(thread), alignof(thread)>::type threads_storage_[W];
+        stack_element_t stacks_storage_[W * stack_elements];
+        job jobs_storage_[J];
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    constexpr
+    thread_pool::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    inline std::size_t
+    thread_pool::workers (void) const
+    {
+      return workers_;
+    }
+
+    inline std::size_t
+    thread_pool::capacity (void) const
+    {
+      return size_;
+    }
+
+    // ========================================================================
+
+    template<std::size_t W, std::size_t J, std::size_t S>
+      inline
+      thread_pool_inclusive<W, J, S>::thread_pool_inclusive (
+          const attributes& attr) :
+          thread_pool_inclusive<W, J, S>
+            { nullptr, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * The storage for the threads, their stacks and for the jobs
+     * is part of the object; the stack size attribute is ignored.
+     */
+    template<std::size_t W, std::size_t J, std::size_t S>
+      inline
+      thread_pool_inclusive<W, J, S>::thread_pool_inclusive (
+          const char* name, const attributes& attr) :
+          thread_pool
+            { name, W, J, threads_storage_, stacks_storage_,
+                stack_elements * sizeof(stack_element_t), jobs_storage_, attr }
+      {
+        ;
+      }
+
+    template<std::size_t W, std::size_t J, std::size_t S>
+      thread_pool_inclusive<W, J, S>::~thread_pool_inclusive ()
+      {
+        ;
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_THREADPOOL_H_ */
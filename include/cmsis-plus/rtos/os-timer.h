@@ -191,6 +191,24 @@ namespace os
          */
         type_t tm_type = run::once;
 
+        /**
+         * @brief Run the timer function on the timer daemon thread.
+         * @details
+         * If `false`, the function is called from the clock
+         * interrupt; if `true`, the call is deferred to the timer
+         * daemon thread, which requires `OS_INCLUDE_RTOS_TIMER_DAEMON`.
+         */
+        bool tm_run_in_thread = false;
+
+        /**
+         * @brief Timer slack, in clock units.
+         * @details
+         * How much each expiration may be delayed, so that it can be
+         * merged with other timeouts on the same wakeup; see
+         * `clock::coalesce()`.
+         */
+        clock::duration_t tm_slack = 0;
+
         // Add more attributes.
 
         /**
@@ -345,10 +363,42 @@ namespace os
       result_t
       stop (void);
 
+      /**
+       * @brief Get the timer state.
+       * @par Parameters
+       *  None.
+       * @return The timer state, one of `timer::state`.
+       */
+      state_t
+      state (void) const;
+
+      /**
+       * @}
+       */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+      /**
+       * @name Public Static Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Get the timer daemon.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the work queue running the deferred timer
+       *  functions, or `nullptr` if not yet created.
+       */
+      static work_queue*
+      daemon (void);
+
       /**
        * @}
        */
 
+#endif
+
     protected:
 
       /**
@@ -386,6 +436,13 @@ namespace os
       void
       internal_interrupt_service_routine (void);
 
+#endif
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+      static void
+      internal_run_deferred_ (void* args);
+
 #endif
 
       /**
@@ -415,6 +472,9 @@ namespace os
       internal::timer_node timer_node_
         { 0, *this };
       clock::duration_t period_ = 0;
+      clock::duration_t slack_ = 0;
+      // Expiration time before coalescing, to not accumulate drift.
+      clock::timestamp_t deadline_ = 0;
 #endif
 
 #if defined(OS_USE_RTOS_PORT_TIMER)
@@ -425,6 +485,12 @@ namespace os
       type_t type_ = run::once;
       state_t state_ = state::undefined;
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+      bool run_in_thread_ = false;
+      // Set by the clock interrupt, cleared by the daemon.
+      volatile bool deferred_ = false;
+#endif
+
       // Add more internal data.
 
       /**
@@ -490,6 +556,12 @@ namespace os
       return this == &rhs;
     }
 
+    inline timer::state_t
+    timer::state (void) const
+    {
+      return state_;
+    }
+
   } /* namespace rtos */
 } /* namespace os */
 
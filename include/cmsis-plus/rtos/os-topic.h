@@ -0,0 +1,1118 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_TOPIC_H_
+#define CMSIS_PLUS_RTOS_OS_TOPIC_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Topic** of messages, published once to many subscribers.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-topic
+     *
+     * @details
+     * A ring of fixed size messages; each publish copies the message
+     * once into the ring, and each subscriber reads it with its own
+     * cursor.
+     */
+    class topic : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of topic indices and counters.
+       * @ingroup cmsis-plus-rtos-topic
+       */
+      using index_t = uint16_t;
+
+      /**
+       * @brief Type of the message sequence numbers.
+       * @ingroup cmsis-plus-rtos-topic
+       */
+      using sequence_t = uint32_t;
+
+      /**
+       * @brief Maximum topic capacity.
+       * @ingroup cmsis-plus-rtos-topic
+       */
+      static constexpr index_t max_capacity = 0xFFFF;
+
+      /**
+       * @brief Type of the slow subscribers policy.
+       * @ingroup cmsis-plus-rtos-topic
+       */
+      using policy_t = uint8_t;
+
+      /**
+       * @brief What happens when the ring is full.
+       * @ingroup cmsis-plus-rtos-topic
+       */
+      struct policy
+      {
+        /**
+         * @brief Slow subscribers policies.
+         */
+        enum
+          : policy_t
+            {
+              /**
+               * @brief Overwrite the oldest message; the subscribers that
+               *  did not read it skip ahead and count it as lost.
+               */
+              drop_oldest = 0,
+
+              /**
+               * @brief Wait until the slowest subscriber reads the
+               *  oldest message.
+               */
+              block = 1
+        };
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Topic attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-topic
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a topic attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the topic attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        // Public members; no accessors and mutators required.
+        // Warning: must match the type & order of the C file header.
+        /**
+         * @brief Attribute with the slow subscribers policy.
+         */
+        policy_t tp_policy = policy::drop_oldest;
+
+        // Add more attributes here.
+
+        /**
+         * @}
+         */
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default topic initialiser.
+       * @ingroup cmsis-plus-rtos-topic
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @brief Topic **subscriber**, with its own read cursor.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-topic
+       *
+       * @details
+       * A subscriber receives the messages published after it
+       * was constructed, until it is destroyed.
+       */
+      class subscriber
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Subscribe to a topic.
+         * @param [in] tp Reference to the topic.
+         */
+        subscriber (topic& tp);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        subscriber (const subscriber&) = delete;
+        subscriber (subscriber&&) = delete;
+        subscriber&
+        operator= (const subscriber&) = delete;
+        subscriber&
+        operator= (subscriber&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Unsubscribe from the topic.
+         */
+        ~subscriber ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Receive the next message.
+         * @param [out] msg The address where to store the message.
+         * @param [in] nbytes The size of the buffer; must be at
+         *  least `msg_size()`.
+         * @retval result::ok The message was copied.
+         * @retval EINVAL A parameter is invalid or outside of a
+         *  permitted range.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        receive (void* msg, std::size_t nbytes);
+
+        /**
+         * @brief Try to receive the next message.
+         * @param [out] msg The address where to store the message.
+         * @param [in] nbytes The size of the buffer; must be at
+         *  least `msg_size()`.
+         * @retval result::ok The message was copied.
+         * @retval EINVAL A parameter is invalid or outside of a
+         *  permitted range.
+         * @retval EWOULDBLOCK There are no new messages.
+         */
+        result_t
+        try_receive (void* msg, std::size_t nbytes);
+
+        /**
+         * @brief Receive the next message with timeout.
+         * @param [out] msg The address where to store the message.
+         * @param [in] nbytes The size of the buffer; must be at
+         *  least `msg_size()`.
+         * @param [in] timeout The timeout duration.
+         * @retval result::ok The message was copied.
+         * @retval EINVAL A parameter is invalid or outside of a
+         *  permitted range.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT No message was published before the
+         *  timeout expired.
+         */
+        result_t
+        timed_receive (void* msg, std::size_t nbytes,
+                       clock::duration_t timeout);
+
+        /**
+         * @brief Receive a reference to the next message.
+         * @param [out] slot The address where to store the pointer
+         *  to the message in the ring.
+         * @retval result::ok The reference was stored.
+         * @retval EINVAL A null location was given, or a
+         *  reference is already held.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        receive_ref (const void** slot);
+
+        /**
+         * @brief Try to receive a reference to the next message.
+         * @param [out] slot The address where to store the pointer
+         *  to the message in the ring.
+         * @retval result::ok The reference was stored.
+         * @retval EINVAL A null location was given, or a
+         *  reference is already held.
+         * @retval EWOULDBLOCK There are no new messages.
+         */
+        result_t
+        try_receive_ref (const void** slot);
+
+        /**
+         * @brief Receive a reference to the next message with timeout.
+         * @param [out] slot The address where to store the pointer
+         *  to the message in the ring.
+         * @param [in] timeout The timeout duration.
+         * @retval result::ok The reference was stored.
+         * @retval EINVAL A null location was given, or a
+         *  reference is already held.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT No message was published before the
+         *  timeout expired.
+         */
+        result_t
+        timed_receive_ref (const void** slot, clock::duration_t timeout);
+
+        /**
+         * @brief Release the message referenced by `receive_ref()`.
+         * @par Parameters
+         *  None.
+         * @retval result::ok The message was released.
+         * @retval EINVAL No reference is held.
+         * @retval EOVERFLOW The message was overwritten while
+         *  it was referenced.
+         */
+        result_t
+        release (void);
+
+        /**
+         * @brief Get the number of messages waiting to be received.
+         * @par Parameters
+         *  None.
+         * @return The number of messages, up to the topic capacity.
+         */
+        std::size_t
+        available (void) const;
+
+        /**
+         * @brief Get the number of lost messages.
+         * @par Parameters
+         *  None.
+         * @return The number of messages overwritten before being
+         *  received.
+         */
+        std::size_t
+        lost (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        friend class topic;
+
+        void
+        internal_skip_lost_ (void);
+
+        topic& topic_;
+
+        utils::double_list_links links_;
+
+        // Can be updated in different thread contexts.
+        volatile sequence_t next_;
+        volatile sequence_t lost_ = 0;
+
+        bool held_ = false;
+
+        /**
+         * @endcond
+         */
+
+      }; /* class subscriber */
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a named topic object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] storage Pointer to an array of
+       *  _capacity_ * _msg_size_bytes_ bytes.
+       * @param [in] msg_size_bytes The message size, in bytes.
+       * @param [in] capacity The number of messages in the ring.
+       * @param [in] attr Reference to attributes.
+       */
+      topic (const char* name, void* storage, std::size_t msg_size_bytes,
+             std::size_t capacity, const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      topic (const topic&) = delete;
+      topic (topic&&) = delete;
+      topic&
+      operator= (const topic&) = delete;
+      topic&
+      operator= (topic&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the topic object instance.
+       */
+      ~topic ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare topics.
+       * @retval true The given topic is the same as this topic.
+       * @retval false The topics are different.
+       */
+      bool
+      operator== (const topic& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Publish a message to all subscribers.
+       * @param [in] msg The address of the message.
+       * @param [in] nbytes The message size; must be at most
+       *  `msg_size()`.
+       * @retval result::ok The message was published.
+       * @retval EINVAL A parameter is invalid or outside of a
+       *  permitted range.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      publish (const void* msg, std::size_t nbytes);
+
+      /**
+       * @brief Try to publish a message to all subscribers.
+       * @param [in] msg The address of the message.
+       * @param [in] nbytes The message size; must be at most
+       *  `msg_size()`.
+       * @retval result::ok The message was published.
+       * @retval EINVAL A parameter is invalid or outside of a
+       *  permitted range.
+       * @retval EWOULDBLOCK The policy is `policy::block` and the
+       *  slowest subscriber did not read the oldest message.
+       */
+      result_t
+      try_publish (const void* msg, std::size_t nbytes);
+
+      /**
+       * @brief Publish a message to all subscribers with timeout.
+       * @param [in] msg The address of the message.
+       * @param [in] nbytes The message size; must be at most
+       *  `msg_size()`.
+       * @param [in] timeout The timeout duration.
+       * @retval result::ok The message was published.
+       * @retval EINVAL A parameter is invalid or outside of a
+       *  permitted range.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The ring was still full when the
+       *  timeout expired.
+       */
+      result_t
+      timed_publish (const void* msg, std::size_t nbytes,
+                     clock::duration_t timeout);
+
+      /**
+       * @brief Get the topic capacity.
+       * @par Parameters
+       *  None.
+       * @return The number of messages in the ring.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get the message size.
+       * @par Parameters
+       *  None.
+       * @return The message size, in bytes.
+       */
+      std::size_t
+      msg_size (void) const;
+
+      /**
+       * @brief Get the slow subscribers policy.
+       * @par Parameters
+       *  None.
+       * @return The policy from the attributes.
+       */
+      policy_t
+      policy (void) const;
+
+      /**
+       * @brief Get the number of published messages.
+       * @par Parameters
+       *  None.
+       * @return The sequence number of the next message.
+       */
+      sequence_t
+      published (void) const;
+
+      /**
+       * @brief Get the number of subscribers.
+       * @par Parameters
+       *  None.
+       * @return The number of existing subscribers.
+       */
+      std::size_t
+      subscribers (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      friend class subscriber;
+
+      using subscribers_list = utils::intrusive_list<subscriber,
+      utils::double_list_links, &subscriber::links_>;
+
+      bool
+      internal_full_ (void);
+
+      bool
+      internal_try_publish_ (const void* msg, std::size_t nbytes);
+
+      result_t
+      internal_publish_ (const void* msg, std::size_t nbytes, bool timed,
+                         clock::duration_t timeout);
+
+      bool
+      internal_try_receive_ (subscriber& sub, void* msg, std::size_t nbytes,
+                             const void** slot);
+
+      result_t
+      internal_receive_ (subscriber& sub, void* msg, std::size_t nbytes,
+                         const void** slot, bool timed,
+                         clock::duration_t timeout);
+
+      void*
+      internal_slot_ (sequence_t seq) const;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list send_list_;
+      internal::waiting_threads_list receive_list_;
+      clock* clock_ = nullptr;
+
+      subscribers_list subscribers_;
+
+      char* ring_ = nullptr;
+      std::size_t msg_size_bytes_ = 0;
+      index_t capacity_ = 0;
+      policy_t policy_ = policy::drop_oldest;
+
+      // Can be updated in different thread contexts.
+      volatile sequence_t seq_ = 0;
+      // The oldest cursor, updated only when the ring looks full.
+      volatile sequence_t tail_ = 0;
+      volatile index_t count_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Template of a **topic** with message type and local storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-topic
+     *
+     * @tparam T Type of messages; must be trivially copyable.
+     * @tparam N Number of messages in the ring.
+     */
+    template<typename T, std::size_t N>
+      class topic_inclusive : public topic
+      {
+      public:
+
+        static_assert(N > 0 && N <= max_capacity,
+            "topic capacity must be 1 to 65535");
+
+        /**
+         * @brief Local type of message.
+         */
+        using value_type = T;
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static constexpr std::size_t msgs = N;
+
+        // ====================================================================
+
+        /**
+         * @brief Typed topic **subscriber**.
+         * @headerfile os.h <cmsis-plus/rtos/os.h>
+         * @ingroup cmsis-plus-rtos-topic
+         */
+        class subscriber : public topic::subscriber
+        {
+        public:
+
+          /**
+           * @brief Subscribe to a typed topic.
+           * @param [in] tp Reference to the topic.
+           */
+          subscriber (topic_inclusive& tp);
+
+          /**
+           * @cond ignore
+           */
+
+          // The rule of five.
+          subscriber (const subscriber&) = delete;
+          subscriber (subscriber&&) = delete;
+          subscriber&
+          operator= (const subscriber&) = delete;
+          subscriber&
+          operator= (subscriber&&) = delete;
+
+          /**
+           * @endcond
+           */
+
+          /**
+           * @brief Unsubscribe from the topic.
+           */
+          ~subscriber () = default;
+
+          /**
+           * @brief Receive the next typed message.
+           * @param [out] msg The address where to store the message.
+           * @retval result::ok The message was copied.
+           * @retval EPERM Cannot be invoked from an Interrupt Service
+           *  Routines.
+           * @retval EINTR The operation was interrupted.
+           */
+          result_t
+          receive (value_type* msg);
+
+          /**
+           * @brief Try to receive the next typed message.
+           * @param [out] msg The address where to store the message.
+           * @retval result::ok The message was copied.
+           * @retval EWOULDBLOCK There are no new messages.
+           */
+          result_t
+          try_receive (value_type* msg);
+
+          /**
+           * @brief Receive the next typed message with timeout.
+           * @param [out] msg The address where to store the message.
+           * @param [in] timeout The timeout duration.
+           * @retval result::ok The message was copied.
+           * @retval EPERM Cannot be invoked from an Interrupt Service
+           *  Routines.
+           * @retval EINTR The operation was interrupted.
+           * @retval ETIMEDOUT No message was published before the
+           *  timeout expired.
+           */
+          result_t
+          timed_receive (value_type* msg, clock::duration_t timeout);
+
+          /**
+           * @brief Receive a typed reference to the next message.
+           * @param [out] slot The address where to store the pointer
+           *  to the message in the ring.
+           * @retval result::ok The reference was stored.
+           * @retval EPERM Cannot be invoked from an Interrupt Service
+           *  Routines.
+           * @retval EINTR The operation was interrupted.
+           */
+          result_t
+          receive_ref (const value_type** slot);
+        };
+
+        // ====================================================================
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a typed topic object instance.
+         * @param [in] attr Reference to attributes.
+         */
+        topic_inclusive (const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named typed topic object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] attr Reference to attributes.
+         */
+        topic_inclusive (const char* name, const attributes& attr =
+                             initializer);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        topic_inclusive (const topic_inclusive&) = delete;
+        topic_inclusive (topic_inclusive&&) = delete;
+        topic_inclusive&
+        operator= (const topic_inclusive&) = delete;
+        topic_inclusive&
+        operator= (topic_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the typed topic object instance.
+         */
+        ~topic_inclusive () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Publish a typed message to all subscribers.
+         * @param [in] msg The message.
+         * @retval result::ok The message was published.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        publish (const value_type& msg);
+
+        /**
+         * @brief Try to publish a typed message to all subscribers.
+         * @param [in] msg The message.
+         * @retval result::ok The message was published.
+         * @retval EWOULDBLOCK The policy is `policy::block` and the
+         *  slowest subscriber did not read the oldest message.
+         */
+        result_t
+        try_publish (const value_type& msg);
+
+        /**
+         * @brief Publish a typed message to all subscribers with timeout.
+         * @param [in] msg The message.
+         * @param [in] timeout The timeout duration.
+         * @retval result::ok The message was published.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT The ring was still full when the
+         *  timeout expired.
+         */
+        result_t
+        timed_publish (const value_type& msg, clock::duration_t timeout);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The ring of messages.
+         */
+        value_type arena_[msgs];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    topic::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    topic::subscriber::lost (void) const
+    {
+      return lost_;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * Identical topics should have the same memory address.
+     */
+    inline bool
+    topic::operator== (const topic& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    topic::capacity (void) const
+    {
+      return capacity_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    topic::msg_size (void) const
+    {
+      return msg_size_bytes_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline topic::policy_t
+    topic::policy (void) const
+    {
+      return policy_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline topic::sequence_t
+    topic::published (void) const
+    {
+      return seq_;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    topic::subscribers (void) const
+    {
+      return count_;
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    inline void*
+    topic::internal_slot_ (sequence_t seq) const
+    {
+      return ring_ + (seq % capacity_) * msg_size_bytes_;
+    }
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    template<typename T, std::size_t N>
+      constexpr std::size_t topic_inclusive<T, N>::msgs;
+
+    /**
+     * @details
+     * Wrapper over `topic::subscriber::subscriber()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline
+      topic_inclusive<T, N>::subscriber::subscriber (topic_inclusive& tp) :
+          topic::subscriber
+            { tp }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * Wrapper over `topic::subscriber::receive()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      topic_inclusive<T, N>::subscriber::receive (value_type* msg)
+      {
+        return topic::subscriber::receive (msg, sizeof(value_type));
+      }
+
+    /**
+     * @details
+     * Wrapper over `topic::subscriber::try_receive()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      topic_inclusive<T, N>::subscriber::try_receive (value_type* msg)
+      {
+        return topic::subscriber::try_receive (msg, sizeof(value_type));
+      }
+
+    /**
+     * @details
+     * Wrapper over `topic::subscriber::timed_receive()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      topic_inclusive<T, N>::subscriber::timed_receive (
+          value_type* msg, clock::duration_t timeout)
+      {
+        return topic::subscriber::timed_receive (msg, sizeof(value_type),
+                                                 timeout);
+      }
+
+    /**
+     * @details
+     * Wrapper over `topic::subscriber::receive_ref()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      topic_inclusive<T, N>::subscriber::receive_ref (const value_type** slot)
+      {
+        return topic::subscriber::receive_ref (
+            reinterpret_cast<const void**> (slot));
+      }
+
+    /**
+     * @details
+     * This constructor shall initialise a typed topic object
+     * with storage for _N_ messages and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline
+      topic_inclusive<T, N>::topic_inclusive (const attributes& attr) :
+          topic
+            { nullptr, arena_, sizeof(value_type), msgs, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * This constructor shall initialise a named typed topic object
+     * with storage for _N_ messages and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline
+      topic_inclusive<T, N>::topic_inclusive (const char* name,
+                                              const attributes& attr) :
+          topic
+            { name, arena_, sizeof(value_type), msgs, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * Wrapper over `topic::publish()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      topic_inclusive<T, N>::publish (const value_type& msg)
+      {
+        return topic::publish (&msg, sizeof(value_type));
+      }
+
+    /**
+     * @details
+     * Wrapper over `topic::try_publish()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      topic_inclusive<T, N>::try_publish (const value_type& msg)
+      {
+        return topic::try_publish (&msg, sizeof(value_type));
+      }
+
+    /**
+     * @details
+     * Wrapper over `topic::timed_publish()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      topic_inclusive<T, N>::timed_publish (const value_type& msg,
+                                            clock::duration_t timeout)
+      {
+        return topic::timed_publish (&msg, sizeof(value_type), timeout);
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_TOPIC_H_ */
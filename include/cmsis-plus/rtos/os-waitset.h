@@ -0,0 +1,488 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_WAITSET_H_
+#define CMSIS_PLUS_RTOS_OS_WAITSET_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Wait set**, to wait for any of several objects.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-waitset
+     */
+    class wait_set : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of object index.
+       * @ingroup cmsis-plus-rtos-waitset
+       */
+      using index_t = std::size_t;
+
+      /**
+       * @brief Maximum number of objects in a wait set.
+       * @ingroup cmsis-plus-rtos-waitset
+       */
+      static constexpr index_t max_size = OS_INTEGER_RTOS_WAIT_SET_MAX_SIZE;
+
+      // ======================================================================
+
+      /**
+       * @brief Wait set attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-waitset
+       */
+      class attributes : public internal::attributes_clocked
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a wait set attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the wait set attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+        // Add more attributes here.
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default wait set initialiser.
+       * @ingroup cmsis-plus-rtos-waitset
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a wait set object instance.
+       * @param [in] attr Reference to attributes.
+       */
+      wait_set (const attributes& attr = initializer);
+
+      /**
+       * @brief Construct a named wait set object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] attr Reference to attributes.
+       */
+      wait_set (const char* name, const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      wait_set (const wait_set&) = delete;
+      wait_set (wait_set&&) = delete;
+      wait_set&
+      operator= (const wait_set&) = delete;
+      wait_set&
+      operator= (wait_set&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the wait set object instance.
+       */
+      ~wait_set ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare wait sets.
+       * @retval true The given wait set is the same as this wait set.
+       * @retval false The wait sets are different.
+       */
+      bool
+      operator== (const wait_set& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Add a semaphore, ready when its count is positive.
+       * @param [in] sem Reference to the semaphore.
+       * @retval result::ok The semaphore was added.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EAGAIN The wait set is full.
+       * @retval EBUSY A thread is waiting on the wait set.
+       */
+      result_t
+      add (semaphore& sem);
+
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      /**
+       * @brief Add a message queue, ready when it is not empty.
+       * @param [in] mq Reference to the message queue.
+       * @retval result::ok The message queue was added.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EAGAIN The wait set is full.
+       * @retval EBUSY A thread is waiting on the wait set.
+       */
+      result_t
+      add (message_queue& mq);
+
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+      /**
+       * @brief Add an event flags object, ready when the flags are raised.
+       * @param [in] evf Reference to the event flags.
+       * @param [in] mask The expected flags (OR-ed bit-mask);
+       *  if `flags::any`, any flag raised will do it.
+       * @param [in] mode Mode bits to select if either all or any flags
+       *  in the mask are expected; `flags::mode::clear` is ignored.
+       * @retval result::ok The event flags were added.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EAGAIN The wait set is full.
+       * @retval EBUSY A thread is waiting on the wait set.
+       */
+      result_t
+      add (event_flags& evf, flags::mask_t mask, flags::mode_t mode =
+               flags::mode::all);
+
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+
+      /**
+       * @brief Add a memory pool, ready when a block is free.
+       * @param [in] mp Reference to the memory pool.
+       * @retval result::ok The memory pool was added.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EAGAIN The wait set is full.
+       * @retval EBUSY A thread is waiting on the wait set.
+       */
+      result_t
+      add (memory_pool& mp);
+
+#endif
+
+      /**
+       * @brief Remove all objects.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The wait set was cleared.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EBUSY A thread is waiting on the wait set.
+       */
+      result_t
+      clear (void);
+
+      /**
+       * @brief Get the number of objects.
+       * @par Parameters
+       *  None.
+       * @return The number of objects in the wait set.
+       */
+      index_t
+      size (void) const;
+
+      /**
+       * @brief Wait for any object to become ready.
+       * @param [out] index Pointer where to store the index of
+       *  the ready object, in the order it was added; may be `nullptr`.
+       * @retval result::ok An object is ready.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The wait set is empty.
+       * @retval EBUSY Another thread is waiting on the wait set.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      wait (index_t* index = nullptr);
+
+      /**
+       * @brief Check if any object is ready.
+       * @param [out] index Pointer where to store the index of
+       *  the ready object, in the order it was added; may be `nullptr`.
+       * @retval result::ok An object is ready.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The wait set is empty.
+       * @retval EWOULDBLOCK No object is ready.
+       */
+      result_t
+      try_wait (index_t* index = nullptr);
+
+      /**
+       * @brief Timed wait for any object to become ready.
+       * @param [out] index Pointer where to store the index of
+       *  the ready object, in the order it was added; may be `nullptr`.
+       * @param [in] timeout Timeout to wait.
+       * @retval result::ok An object is ready.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The wait set is empty.
+       * @retval EBUSY Another thread is waiting on the wait set.
+       * @retval ETIMEDOUT No object became ready before
+       *  the specified timeout expired.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_wait (index_t* index, clock::duration_t timeout);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Type of object kind.
+       */
+      using kind_t = uint8_t;
+
+      /**
+       * @brief Kinds of objects.
+       */
+      struct kind
+      {
+        enum
+          : kind_t
+            {
+              semaphore = 0,
+              message_queue,
+              event_flags,
+              memory_pool
+            };
+      };
+
+      /**
+       * @brief An object in the set, with its waiting node.
+       */
+      struct entry
+      {
+        internal::waiting_thread_node node;
+        internal::waiting_threads_list* list;
+        void* object;
+        flags::mask_t mask;
+        flags::mode_t mode;
+        kind_t kind;
+      };
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      result_t
+      internal_add_ (kind_t kind, void* object,
+                     internal::waiting_threads_list* list,
+                     flags::mask_t mask, flags::mode_t mode);
+
+      bool
+      internal_check_ready_ (index_t* index);
+
+      result_t
+      internal_wait_ (index_t* index, bool timed, clock::duration_t timeout);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      entry entries_[max_size];
+      clock* clock_ = nullptr;
+
+      // The thread currently waiting, if any.
+      thread* volatile waiter_ = nullptr;
+
+      index_t size_ = 0;
+
+      // Add more internal data.
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    constexpr
+    wait_set::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * This constructor shall initialise an empty wait set
+     * with attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline
+    wait_set::wait_set (const attributes& attr) :
+        wait_set
+          { nullptr, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Identical wait sets should have the same memory address.
+     */
+    inline bool
+    wait_set::operator== (const wait_set& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    /**
+     * @details
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline wait_set::index_t
+    wait_set::size (void) const
+    {
+      return size_;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_WAITSET_H_ */
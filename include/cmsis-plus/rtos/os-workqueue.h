@@ -0,0 +1,524 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_WORKQUEUE_H_
+#define CMSIS_PLUS_RTOS_OS_WORKQUEUE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Deferred **work queue**, serviced by a thread.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-workqueue
+     *
+     * @details
+     * Interrupt handlers post `{func, args}` items to a fixed size
+     * ring, and a worker thread calls them, in order, in
+     * thread context.
+     */
+    class work_queue : public internal::object_named_system
+    {
+    public:
+
+      // ======================================================================
+
+      /**
+       * @brief Type of work functions.
+       * @par Parameters
+       *  Pointer to arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      using func_t = void (*) (void* args);
+
+      /**
+       * @brief Type of work function arguments.
+       */
+      using func_args_t = void*;
+
+      /**
+       * @brief Work item.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-workqueue
+       */
+      class item
+      {
+      public:
+
+        /**
+         * @brief Function to call.
+         */
+        func_t func;
+
+        /**
+         * @brief Function arguments.
+         */
+        func_args_t args;
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Work queue attributes.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @ingroup cmsis-plus-rtos-workqueue
+       */
+      class attributes
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a work queue attributes object instance.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        attributes ();
+
+        // The rule of five.
+        attributes (const attributes&) = default;
+        attributes (attributes&&) = default;
+        attributes&
+        operator= (const attributes&) = default;
+        attributes&
+        operator= (attributes&&) = default;
+
+        /**
+         * @brief Destruct the work queue attributes object instance.
+         */
+        ~attributes () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        // Public members; no accessors and mutators required.
+
+        /**
+         * @brief Address of the user defined storage for the items.
+         * @details
+         * If `nullptr`, the items are dynamically allocated.
+         */
+        item* wq_queue_address = nullptr;
+
+        /**
+         * @brief Address of the user defined storage for the worker
+         *  thread stack.
+         * @details
+         * If `nullptr`, the default is to dynamically allocate the stack.
+         */
+        void* th_stack_address = nullptr;
+
+        /**
+         * @brief Size of the worker thread stack, in bytes.
+         * @details
+         * If 0, the default is `thread::stack::default_size()`.
+         */
+        std::size_t th_stack_size_bytes = 0;
+
+        /**
+         * @brief Worker thread priority.
+         */
+        thread::priority_t th_priority =
+            OS_INTEGER_RTOS_WORK_QUEUE_PRIORITY;
+
+        // Add more attributes here.
+
+        /**
+         * @}
+         */
+
+      }; /* class attributes */
+
+      /**
+       * @brief Default work queue initialiser.
+       */
+      static const attributes initializer;
+
+      // ======================================================================
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a work queue object instance.
+       * @param [in] items The maximum number of pending items.
+       * @param [in] attr Reference to attributes.
+       */
+      work_queue (std::size_t items, const attributes& attr = initializer);
+
+      /**
+       * @brief Construct a named work queue object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] items The maximum number of pending items.
+       * @param [in] attr Reference to attributes.
+       */
+      work_queue (const char* name, std::size_t items,
+                  const attributes& attr = initializer);
+
+      /**
+       * @cond ignore
+       */
+
+    protected:
+
+      work_queue (const char* name, std::size_t items, item* queue,
+                  void* stack_address, std::size_t stack_size_bytes,
+                  const attributes& attr);
+
+    public:
+
+      // The rule of five.
+      work_queue (const work_queue&) = delete;
+      work_queue (work_queue&&) = delete;
+      work_queue&
+      operator= (const work_queue&) = delete;
+      work_queue&
+      operator= (work_queue&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the work queue object instance.
+       */
+      virtual
+      ~work_queue ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Post a work item.
+       * @param [in] func Pointer to function to call.
+       * @param [in] args Pointer to function arguments.
+       * @retval result::ok The item was queued.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EAGAIN The queue is full.
+       */
+      result_t
+      post (func_t func, func_args_t args = nullptr);
+
+      /**
+       * @brief Get the maximum number of pending items.
+       * @par Parameters
+       *  None.
+       * @return The number of items.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get the number of pending items.
+       * @par Parameters
+       *  None.
+       * @return The number of items.
+       */
+      std::size_t
+      length (void) const;
+
+      /**
+       * @brief Check if the queue is empty.
+       * @par Parameters
+       *  None.
+       * @retval true The queue has no pending items.
+       * @retval false The queue has pending items.
+       */
+      bool
+      empty (void) const;
+
+      /**
+       * @brief Get the worker thread.
+       * @par Parameters
+       *  None.
+       * @return A reference to the worker thread.
+       */
+      thread&
+      worker (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      static void*
+      internal_run_ (void* args);
+
+      static thread::attributes
+      internal_thread_attributes_ (const attributes& attr, void* stack_address,
+                                   std::size_t stack_size_bytes);
+
+      static volatile item*
+      internal_allocate_queue_ (std::size_t size, item* queue);
+
+      void
+      internal_drain_ (void);
+
+      /**
+       * @endcond
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Must be set before constructing the worker thread.
+      std::size_t size_;
+      volatile item* queue_;
+      bool allocated_queue_;
+
+      // Written only by the worker.
+      std::size_t volatile head_ = 0;
+      // Written only by the posters, in a critical section.
+      std::size_t volatile tail_ = 0;
+
+      // Better be the last one.
+      thread worker_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Template of a work queue with inclusive storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-workqueue
+     *
+     * @tparam N Maximum number of pending items.
+     * @tparam S Worker thread stack size, in bytes.
+     */
+    template<std::size_t N,
+        std::size_t S = port::stack::default_size_bytes>
+      class work_queue_inclusive : public work_queue
+      {
+      public:
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t items = N;
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t stack_size_bytes = S;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a work queue object instance.
+         * @param [in] attr Reference to attributes.
+         */
+        work_queue_inclusive (const attributes& attr = initializer);
+
+        /**
+         * @brief Construct a named work queue object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] attr Reference to attributes.
+         */
+        work_queue_inclusive (const char* name, const attributes& attr =
+                                  initializer);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        work_queue_inclusive (const work_queue_inclusive&) = delete;
+        work_queue_inclusive (work_queue_inclusive&&) = delete;
+        work_queue_inclusive&
+        operator= (const work_queue_inclusive&) = delete;
+        work_queue_inclusive&
+        operator= (work_queue_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the work queue object instance.
+         */
+        virtual
+        ~work_queue_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // One more slot, always kept free.
+        item queue_storage_[N + 1];
+
+        port::stack::allocation_element_t stack_storage_[(S
+            + sizeof(port::stack::allocation_element_t) - 1)
+            / sizeof(port::stack::allocation_element_t)];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    constexpr
+    work_queue::attributes::attributes ()
+    {
+      ;
+    }
+
+    // ========================================================================
+
+    inline std::size_t
+    work_queue::capacity (void) const
+    {
+      // One slot is always kept free, to tell full from empty.
+      return size_ - 1;
+    }
+
+    inline bool
+    work_queue::empty (void) const
+    {
+      return (head_ == tail_);
+    }
+
+    inline thread&
+    work_queue::worker (void)
+    {
+      return worker_;
+    }
+
+    // ========================================================================
+
+    template<std::size_t N, std::size_t S>
+      inline
+      work_queue_inclusive<N, S>::work_queue_inclusive (
+          const attributes& attr) :
+          work_queue_inclusive<N, S>
+            { nullptr, attr }
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * The storage for the items and for the worker thread stack
+     * is part of the object; the attributes storage members
+     * are ignored.
+     */
+    template<std::size_t N, std::size_t S>
+      inline
+      work_queue_inclusive<N, S>::work_queue_inclusive (
+          const char* name, const attributes& attr) :
+          work_queue
+            { name, N, queue_storage_, stack_storage_,
+                sizeof(stack_storage_), attr }
+      {
+        ;
+      }
+
+    template<std::size_t N, std::size_t S>
+      work_queue_inclusive<N, S>::~work_queue_inclusive ()
+      {
+        ;
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_WORKQUEUE_H_ */
@@ -89,16 +89,34 @@
 
 // Includes a reference to critical sections.
 #include <cmsis-plus/rtos/os-memory.h>
+#include <cmsis-plus/rtos/os-dcache.h>
 
 #include <cmsis-plus/rtos/os-thread.h>
 #include <cmsis-plus/rtos/os-clocks.h>
+#include <cmsis-plus/rtos/os-power.h>
+#include <cmsis-plus/rtos/os-footprint.h>
 #include <cmsis-plus/rtos/os-timer.h>
 #include <cmsis-plus/rtos/os-mutex.h>
 #include <cmsis-plus/rtos/os-condvar.h>
 #include <cmsis-plus/rtos/os-semaphore.h>
 #include <cmsis-plus/rtos/os-mempool.h>
+#include <cmsis-plus/rtos/os-mempool-set.h>
 #include <cmsis-plus/rtos/os-mqueue.h>
+#include <cmsis-plus/rtos/os-mailbox.h>
+#include <cmsis-plus/rtos/os-topic.h>
+#include <cmsis-plus/rtos/os-snapshot.h>
 #include <cmsis-plus/rtos/os-evflags.h>
+#include <cmsis-plus/rtos/os-barrier.h>
+#include <cmsis-plus/rtos/os-latch.h>
+#include <cmsis-plus/rtos/os-rwlock.h>
+#include <cmsis-plus/rtos/os-spscqueue.h>
+#include <cmsis-plus/rtos/os-ampchannel.h>
+#include <cmsis-plus/rtos/os-waitset.h>
+#include <cmsis-plus/rtos/os-workqueue.h>
+#include <cmsis-plus/rtos/os-coroutine.h>
+#include <cmsis-plus/rtos/os-srp.h>
+#include <cmsis-plus/rtos/os-threadpool.h>
+#include <cmsis-plus/rtos/os-deferred-init.h>
 
 #include <cmsis-plus/rtos/os-hooks.h>
 
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_UTILS_COPY_H_
+#define CMSIS_PLUS_UTILS_COPY_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef  __cplusplus
+
+#include <cstdint>
+#include <cstddef>
+
+namespace os
+{
+  namespace utils
+  {
+    // ========================================================================
+
+    /**
+     * @brief Copy a memory block.
+     * @param [out] dest Pointer to the destination.
+     * @param [in] src Pointer to the source.
+     * @param [in] nbytes Number of bytes to copy.
+     * @par Returns
+     *  Nothing.
+     * @ingroup cmsis-plus-utils
+     *
+     * @details
+     * Used by the RTOS for the message payloads, instead of
+     * the byte oriented `memcpy()` in the small C libraries.
+     * The blocks must not overlap.
+     */
+    void
+    copy_bytes (void* dest, const void* src, std::size_t nbytes);
+
+    /**
+     * @brief Fill a memory block.
+     * @param [out] dest Pointer to the destination.
+     * @param [in] value The byte to store.
+     * @param [in] nbytes Number of bytes to fill.
+     * @par Returns
+     *  Nothing.
+     * @ingroup cmsis-plus-utils
+     */
+    void
+    fill_bytes (void* dest, uint8_t value, std::size_t nbytes);
+
+  } /* namespace utils */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_UTILS_COPY_H_ */
@@ -43,6 +43,25 @@ namespace os
   {
     // ========================================================================
 
+    /**
+     * @brief Type of the tag selecting the constant initialised
+     *  constructors.
+     * @headerfile lists.h <cmsis-plus/utils/lists.h>
+     * @ingroup cmsis-plus-utils
+     */
+    struct static_init_t
+    {
+    };
+
+    /**
+     * @brief Tag selecting the constant initialised constructors.
+     * @ingroup cmsis-plus-utils
+     */
+    constexpr static_init_t static_init
+      { };
+
+    // ========================================================================
+
     /**
      * @brief Statically allocated core of a double linked list,
      * pointers to next, previous.
@@ -63,6 +82,15 @@ namespace os
        */
       static_double_list_links ();
 
+      /**
+       * @brief Construct a list node with the given pointers.
+       * @param [in] prev Pointer to the previous node.
+       * @param [in] next Pointer to the next node.
+       */
+      constexpr
+      static_double_list_links (static_double_list_links* prev,
+                                static_double_list_links* next);
+
       /**
        * @cond ignore
        */
@@ -167,6 +195,7 @@ namespace os
       /**
        * @brief Construct a list node (explicitly set to nullptr).
        */
+      constexpr
       double_list_links ();
 
       /**
@@ -364,6 +393,14 @@ namespace os
        */
       static_double_list ();
 
+      /**
+       * @brief Construct an empty list (constant initialised).
+       * @details
+       * The head points to itself, as after `clear()`.
+       */
+      constexpr
+      static_double_list (static_init_t);
+
       /**
        * @cond ignore
        */
@@ -511,6 +548,12 @@ namespace os
        */
       double_list ();
 
+      /**
+       * @brief Construct an empty list (constant initialised).
+       */
+      constexpr
+      double_list (static_init_t);
+
       /**
        * @cond ignore
        */
@@ -837,6 +880,17 @@ namespace os
       ;
     }
 
+    constexpr
+    static_double_list_links::static_double_list_links (
+        static_double_list_links* prev, static_double_list_links* next) :
+        prev_
+          { prev }, //
+        next_
+          { next }
+    {
+      ;
+    }
+
     inline
     static_double_list_links::~static_double_list_links ()
     {
@@ -875,11 +929,12 @@ namespace os
 
     // ========================================================================
 
-    inline
-    double_list_links::double_list_links ()
+    constexpr
+    double_list_links::double_list_links () :
+        static_double_list_links
+          { nullptr, nullptr }
     {
-      prev_ = nullptr;
-      next_ = nullptr;
+      ;
     }
 
     inline
@@ -1011,6 +1066,14 @@ namespace os
       // The constructor was not `default` to benefit from inline.
     }
 
+    constexpr
+    static_double_list::static_double_list (static_init_t) :
+        head_
+          { &head_, &head_ }
+    {
+      ;
+    }
+
     /**
      * @details
      * There must be no nodes in the list.
@@ -1049,6 +1112,22 @@ namespace os
 
     // ========================================================================
 
+    /**
+     * @details
+     * Unlike the default constructor, which calls `clear()`,
+     * this one can be evaluated at compile time, so objects with
+     * static storage duration are laid out already initialised.
+     */
+    constexpr
+    double_list::double_list (static_init_t tag) :
+        static_double_list
+          { tag }
+    {
+      ;
+    }
+
+    // ========================================================================
+
     template<typename T, typename N, N T::* MP, typename U>
       constexpr
       intrusive_list_iterator<T, N, MP, U>::intrusive_list_iterator () :
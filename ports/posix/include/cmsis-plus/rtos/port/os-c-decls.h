@@ -0,0 +1,76 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/*
+ * The synthetic POSIX port, C declarations.
+ *
+ * The threads are ucontext_t contexts of a single process, the
+ * SysTick is the SIGALRM signal of a periodic interval timer and
+ * the interrupts are disabled by blocking the signal.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_PORT_OS_C_DECLS_H_
+#define CMSIS_PLUS_RTOS_PORT_OS_C_DECLS_H_
+
+// ----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// On macOS the ucontext functions require _XOPEN_SOURCE, which
+// must be defined on the command line, before any system header.
+#include <ucontext.h>
+
+// ----------------------------------------------------------------------------
+
+// The host libraries and the signal frames need much more
+// stack than the embedded ones.
+#define OS_INTEGER_RTOS_MIN_STACK_SIZE_BYTES (16 * 1024)
+#define OS_INTEGER_RTOS_DEFAULT_STACK_SIZE_BYTES (32 * 1024)
+
+typedef uint64_t os_port_clock_timestamp_t;
+typedef uint32_t os_port_clock_duration_t;
+typedef int64_t os_port_clock_offset_t;
+
+typedef uint64_t os_port_thread_stack_element_t;
+typedef uint64_t os_port_thread_stack_allocation_element_t;
+
+typedef bool os_port_scheduler_state_t;
+
+// Non zero if the tick signal was blocked.
+typedef uint32_t os_port_irq_state_t;
+
+typedef struct
+{
+  ucontext_t ucontext;
+} os_port_thread_context_t;
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_PORT_OS_C_DECLS_H_ */
@@ -0,0 +1,142 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/*
+ * The synthetic POSIX port, C++ declarations.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_PORT_OS_DECLS_H_
+#define CMSIS_PLUS_RTOS_PORT_OS_DECLS_H_
+
+// ----------------------------------------------------------------------------
+
+#include <cmsis-plus/rtos/port/os-c-decls.h>
+#include <cmsis-plus/rtos/os-c-decls.h>
+
+#if defined(__cplusplus)
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "The synthetic POSIX port uses the µOS++ scheduler"
+#endif
+
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+#error "The synthetic POSIX port has no high resolution compare channel"
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace port
+    {
+      // ----------------------------------------------------------------------
+
+      namespace stack
+      {
+        using element_t = os_port_thread_stack_element_t;
+        using allocation_element_t = os_port_thread_stack_allocation_element_t;
+
+        constexpr element_t magic = 0xEFBEADDE;
+
+        constexpr std::size_t min_size_bytes =
+        OS_INTEGER_RTOS_MIN_STACK_SIZE_BYTES;
+        constexpr std::size_t default_size_bytes =
+        OS_INTEGER_RTOS_DEFAULT_STACK_SIZE_BYTES;
+      } /* namespace stack */
+
+      // ----------------------------------------------------------------------
+
+      namespace interrupts
+      {
+        using state_t = os_port_irq_state_t;
+
+        namespace state
+        {
+          constexpr state_t init = 0;
+        } /* namespace state */
+
+        bool
+        is_priority_valid (void);
+
+        /**
+         * @cond ignore
+         */
+
+        // Non zero while running the tick signal handler.
+        extern volatile uint32_t handler_depth_;
+
+        /**
+         * @endcond
+         */
+      } /* namespace interrupts */
+
+      // ----------------------------------------------------------------------
+
+      namespace scheduler
+      {
+        using state_t = os_port_scheduler_state_t;
+
+        namespace state
+        {
+          constexpr state_t init = false;
+        } /* namespace state */
+
+        /**
+         * @cond ignore
+         */
+
+        extern state_t lock_state;
+
+        /**
+         * @endcond
+         */
+
+        void
+        wait_for_interrupt (void);
+      } /* namespace scheduler */
+
+      // ----------------------------------------------------------------------
+
+      using thread_context_t = os_port_thread_context_t;
+
+    // ------------------------------------------------------------------------
+    } /* namespace port */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(__cplusplus) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_PORT_OS_DECLS_H_ */
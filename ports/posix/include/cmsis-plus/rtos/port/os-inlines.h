@@ -0,0 +1,143 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/*
+ * The synthetic POSIX port, inline implementations.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_PORT_OS_INLINES_H_
+#define CMSIS_PLUS_RTOS_PORT_OS_INLINES_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace port
+    {
+      // ----------------------------------------------------------------------
+
+      namespace interrupts
+      {
+        /**
+         * @details
+         * The tick signal handler is the only interrupt.
+         */
+        inline bool
+        __attribute__((always_inline))
+        in_handler_mode (void)
+        {
+          return handler_depth_ != 0;
+        }
+
+        /**
+         * @details
+         * There are no interrupt priorities.
+         */
+        inline bool
+        __attribute__((always_inline))
+        is_priority_valid (void)
+        {
+          return true;
+        }
+      } /* namespace interrupts */
+
+      // ----------------------------------------------------------------------
+
+      namespace scheduler
+      {
+        inline port::scheduler::state_t
+        __attribute__((always_inline))
+        lock (void)
+        {
+          state_t tmp = lock_state;
+          lock_state = true;
+          return tmp;
+        }
+
+        inline port::scheduler::state_t
+        __attribute__((always_inline))
+        unlock (void)
+        {
+          state_t tmp = lock_state;
+          lock_state = false;
+          return tmp;
+        }
+
+        inline port::scheduler::state_t
+        __attribute__((always_inline))
+        locked (state_t state)
+        {
+          state_t tmp = lock_state;
+          lock_state = state;
+          return tmp;
+        }
+
+        inline bool
+        __attribute__((always_inline))
+        locked (void)
+        {
+          return lock_state;
+        }
+      } /* namespace scheduler */
+
+      // ----------------------------------------------------------------------
+
+      namespace this_thread
+      {
+        /**
+         * @details
+         * The running thread is not in the ready list, nothing
+         * to remove.
+         */
+        inline void
+        __attribute__((always_inline))
+        prepare_suspend (void)
+        {
+          ;
+        }
+      } /* namespace this_thread */
+
+    // ------------------------------------------------------------------------
+    } /* namespace port */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(__cplusplus) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_PORT_OS_INLINES_H_ */
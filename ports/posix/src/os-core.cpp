@@ -0,0 +1,399 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/*
+ * The synthetic POSIX port of the µOS++ scheduler.
+ *
+ * All threads run in a single process, as ucontext_t contexts
+ * switched with swapcontext(). The SysTick is the SIGALRM signal
+ * of a periodic ITIMER_REAL interval timer, and the interrupts
+ * critical sections block it; since the signal mask is part of
+ * the context, each thread has its own interrupts state, as the
+ * context switches happen only with the signal blocked.
+ *
+ * The context switches requested from the signal handler are
+ * deferred to the end of the handler, like the PendSV on Cortex-M.
+ *
+ * The high resolution clock counts nanoseconds of the monotonic
+ * clock since the last tick.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/utsname.h>
+#include <time.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace port
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        constexpr int tick_signal = SIGALRM;
+
+        constexpr uint32_t highres_frequency_hz = 1000000000u;
+
+        // Monotonic clock at the last tick, in nanoseconds.
+        volatile uint64_t tick_ns_;
+
+        // Set by reschedule() when called from the signal handler.
+        volatile bool pending_reschedule_;
+
+        uint64_t
+        monotonic_ns (void)
+        {
+          struct timespec ts;
+          clock_gettime (CLOCK_MONOTONIC, &ts);
+          return static_cast<uint64_t> (ts.tv_sec) * 1000000000u
+              + static_cast<uint64_t> (ts.tv_nsec);
+        }
+
+        void
+        tick_mask (sigset_t* set)
+        {
+          sigemptyset (set);
+          sigaddset (set, tick_signal);
+        }
+
+        void
+        tick_handler (int signum __attribute__((unused)))
+        {
+          tick_ns_ = monotonic_ns ();
+
+          ++interrupts::handler_depth_;
+          os_systick_handler ();
+          --interrupts::handler_depth_;
+
+          if (pending_reschedule_)
+            {
+              pending_reschedule_ = false;
+              scheduler::reschedule ();
+            }
+        }
+
+        // makecontext() passes only int arguments, so the pointers
+        // are split in two halves.
+        void
+        context_entry (unsigned int func_hi, unsigned int func_lo,
+                       unsigned int args_hi, unsigned int args_lo)
+        {
+          uintptr_t func = static_cast<uintptr_t> ((static_cast<uint64_t> (func_hi)
+              << 32) | func_lo);
+          uintptr_t args = static_cast<uintptr_t> ((static_cast<uint64_t> (args_hi)
+              << 32) | args_lo);
+
+          reinterpret_cast<void
+          (*) (void*)> (func) (reinterpret_cast<void*> (args));
+
+          // Threads exit via thread::internal_invoke_with_exit_().
+          std::abort ();
+        }
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      namespace interrupts
+      {
+        volatile uint32_t handler_depth_;
+
+        rtos::interrupts::state_t
+        critical_section::enter (void)
+        {
+          sigset_t set, old;
+          tick_mask (&set);
+          sigprocmask (SIG_BLOCK, &set, &old);
+
+          return sigismember (&old, tick_signal) ? 1 : 0;
+        }
+
+        void
+        critical_section::exit (rtos::interrupts::state_t state)
+        {
+          if (state == 0)
+            {
+              sigset_t set;
+              tick_mask (&set);
+              sigprocmask (SIG_UNBLOCK, &set, nullptr);
+            }
+        }
+
+        rtos::interrupts::state_t
+        uncritical_section::enter (void)
+        {
+          sigset_t set, old;
+          tick_mask (&set);
+          sigprocmask (SIG_UNBLOCK, &set, &old);
+
+          return sigismember (&old, tick_signal) ? 1 : 0;
+        }
+
+        void
+        uncritical_section::exit (rtos::interrupts::state_t state)
+        {
+          if (state != 0)
+            {
+              sigset_t set;
+              tick_mask (&set);
+              sigprocmask (SIG_BLOCK, &set, nullptr);
+            }
+        }
+      } /* namespace interrupts */
+
+      // ----------------------------------------------------------------------
+
+      namespace scheduler
+      {
+        state_t lock_state;
+
+        void
+        greeting (void)
+        {
+          struct utsname name;
+          if (uname (&name) == 0)
+            {
+              trace::printf ("POSIX synthetic, running on %s %s %s",
+                             name.machine, name.sysname, name.release);
+            }
+          else
+            {
+              trace::printf ("POSIX synthetic");
+            }
+          trace::printf ("; preemptive.\n");
+        }
+
+        result_t
+        initialize (void)
+        {
+          return result::ok;
+        }
+
+        /**
+         * @details
+         * The tick signal is already blocked by
+         * `clock_systick::start()`, so the process context is
+         * never saved; the first thread starts with it unblocked.
+         */
+        void
+        start (void)
+        {
+          rtos::scheduler::current_thread_ =
+              rtos::scheduler::ready_threads_list_.unlink_head ();
+
+          setcontext (
+              &rtos::scheduler::current_thread_->context_.port_.ucontext);
+
+          std::abort ();
+        }
+
+        /**
+         * @details
+         * Switch to the top priority ready thread, if different.
+         * When called from the signal handler, the switch is
+         * deferred to the end of the handler.
+         */
+        void
+        reschedule (void)
+        {
+          if (!rtos::scheduler::started ())
+            {
+              return;
+            }
+
+          if (rtos::interrupts::in_handler_mode ())
+            {
+              pending_reschedule_ = true;
+              return;
+            }
+
+          if (locked ())
+            {
+              return;
+            }
+
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          rtos::thread* old_thread = rtos::scheduler::current_thread_;
+
+          rtos::scheduler::internal_switch_threads ();
+
+          rtos::thread* new_thread = rtos::scheduler::current_thread_;
+          if (new_thread != old_thread)
+            {
+              swapcontext (&old_thread->context_.port_.ucontext,
+                           &new_thread->context_.port_.ucontext);
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @details
+         * Wait for the next signal, with the tick signal unblocked.
+         */
+        void
+        wait_for_interrupt (void)
+        {
+          sigset_t set;
+          sigprocmask (SIG_SETMASK, nullptr, &set);
+          sigdelset (&set, tick_signal);
+          sigsuspend (&set);
+        }
+      } /* namespace scheduler */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * The context uses the thread stack, and starts with the
+       * tick signal unblocked.
+       */
+      void
+      context::create (void* context, void* func, void* args)
+      {
+        class rtos::thread::context* th_ctx =
+            static_cast<class rtos::thread::context*> (context);
+        ucontext_t* uc = &th_ctx->port_.ucontext;
+
+        if (getcontext (uc) != 0)
+          {
+            trace::printf ("%s() getcontext failed\n", __func__);
+            std::abort ();
+          }
+
+        uc->uc_stack.ss_sp = th_ctx->stack ().bottom ();
+        uc->uc_stack.ss_size = th_ctx->stack ().size ();
+        uc->uc_stack.ss_flags = 0;
+        uc->uc_link = nullptr;
+        sigdelset (&uc->uc_sigmask, tick_signal);
+
+        uint64_t f = reinterpret_cast<uintptr_t> (func);
+        uint64_t a = reinterpret_cast<uintptr_t> (args);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-function-type"
+        makecontext (uc, reinterpret_cast<func_t> (context_entry), 4,
+                     static_cast<unsigned int> (f >> 32),
+                     static_cast<unsigned int> (f),
+                     static_cast<unsigned int> (a >> 32),
+                     static_cast<unsigned int> (a));
+#pragma GCC diagnostic pop
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * Install the tick signal handler and start the interval
+       * timer. The signal remains blocked until the first thread
+       * starts.
+       */
+      void
+      clock_systick::start (void)
+      {
+        sigset_t set;
+        tick_mask (&set);
+        sigprocmask (SIG_BLOCK, &set, nullptr);
+
+        struct sigaction sa;
+        std::memset (&sa, 0, sizeof(sa));
+        sa.sa_handler = tick_handler;
+        sigemptyset (&sa.sa_mask);
+        // Restart the host system calls interrupted by the ticks.
+        sa.sa_flags = SA_RESTART;
+        sigaction (tick_signal, &sa, nullptr);
+
+        tick_ns_ = monotonic_ns ();
+
+        struct itimerval tv;
+        tv.it_interval.tv_sec = 0;
+        tv.it_interval.tv_usec = 1000000 / rtos::clock_systick::frequency_hz;
+        tv.it_value = tv.it_interval;
+        setitimer (ITIMER_REAL, &tv, nullptr);
+      }
+
+      // ----------------------------------------------------------------------
+
+      void
+      clock_highres::start (void)
+      {
+        ;
+      }
+
+      uint32_t
+      clock_highres::input_clock_frequency_hz (void)
+      {
+        return highres_frequency_hz;
+      }
+
+      uint32_t
+      clock_highres::cycles_per_tick (void)
+      {
+        return highres_frequency_hz / rtos::clock_systick::frequency_hz;
+      }
+
+      /**
+       * @details
+       * Limited to one tick, since the late signals would
+       * otherwise make the clock go backwards.
+       */
+      uint32_t
+      clock_highres::cycles_since_tick (void)
+      {
+        uint64_t cycles = monotonic_ns () - tick_ns_;
+        uint32_t limit = cycles_per_tick () - 1;
+
+        return (cycles < limit) ? static_cast<uint32_t> (cycles) : limit;
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace port */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
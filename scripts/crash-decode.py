@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Decode the crash dump images written when OS_USE_CRASH_DUMP is defined.
+#
+# Usage: crash-decode.py dump.bin
+#
+# The image is the content of the no-init RAM area, read with the
+# debugger, or of the flash partition written by crash_dump::save().
+# Images are assumed to be little endian, with 32-bit words.
+# -----------------------------------------------------------------------------
+
+import struct
+import sys
+
+MAGIC = 0x48535243
+VERSION = 1
+
+HEADER = struct.Struct('<IHHIII5I9I2I')
+THREAD = struct.Struct('<I16sBBHIII')
+
+STATES = ['undefined', 'ready', 'running', 'suspended', 'terminated',
+          'destroyed']
+
+CFSR_BITS = [
+    (0, 'IACCVIOL'), (1, 'DACCVIOL'), (3, 'MUNSTKERR'), (4, 'MSTKERR'),
+    (5, 'MLSPERR'), (7, 'MMARVALID'),
+    (8, 'IBUSERR'), (9, 'PRECISERR'), (10, 'IMPRECISERR'),
+    (11, 'UNSTKERR'), (12, 'STKERR'), (13, 'LSPERR'), (15, 'BFARVALID'),
+    (16, 'UNDEFINSTR'), (17, 'INVSTATE'), (18, 'INVPC'), (19, 'NOCP'),
+    (24, 'UNALIGNED'), (25, 'DIVBYZERO'),
+]
+
+HFSR_BITS = [(1, 'VECTTBL'), (30, 'FORCED'), (31, 'DEBUGEVT')]
+
+
+def bits(value, names):
+    return ' '.join(n for (b, n) in names if value & (1 << b))
+
+
+def decode(data, write):
+    if len(data) < HEADER.size:
+        raise ValueError('image too short')
+    (magic, version, nthreads, size, checksum, timestamp,
+     exc_return, cfsr, hfsr, mmfar, bfar,
+     frame, r0, r1, r2, r3, r12, lr, pc, psr,
+     current, trace_bytes) = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError('no crash dump (magic 0x%08x)' % magic)
+    if version != VERSION:
+        raise ValueError('unsupported version %d' % version)
+    if size > len(data) or size % 4:
+        raise ValueError('bad size %d' % size)
+    words = struct.unpack_from('<%dI' % (size // 4), data, 0)
+    computed = (sum(words) - checksum) & 0xFFFFFFFF
+    if computed != checksum:
+        write('Warning: checksum 0x%08x, expected 0x%08x\n'
+              % (computed, checksum))
+
+    write('Crash dump, at tick %u\n' % timestamp)
+    write('Fault status:\n')
+    write(' EXC_RETURN = %08X (%s stack)\n'
+          % (exc_return, 'process' if exc_return & 4 else 'main'))
+    write(' CFSR = %08X %s\n' % (cfsr, bits(cfsr, CFSR_BITS)))
+    write(' HFSR = %08X %s\n' % (hfsr, bits(hfsr, HFSR_BITS)))
+    if cfsr & (1 << 7):
+        write(' MMFAR= %08X\n' % mmfar)
+    if cfsr & (1 << 15):
+        write(' BFAR = %08X\n' % bfar)
+    write('Stack frame @%08X:\n' % frame)
+    for (name, value) in (('R0', r0), ('R1', r1), ('R2', r2), ('R3', r3),
+                          ('R12', r12), ('LR', lr), ('PC', pc),
+                          ('PSR', psr)):
+        write(' %-4s = %08X\n' % (name, value))
+
+    pos = HEADER.size
+    write('Threads (%d):\n' % nthreads)
+    for _ in range(nthreads):
+        (tid, name, state, prio, nwords, sp, bottom,
+         stack_size) = THREAD.unpack_from(data, pos)
+        pos += THREAD.size
+        name = name.split(b'\0', 1)[0].decode('utf-8', 'replace')
+        state = STATES[state] if state < len(STATES) else str(state)
+        write('%s %08X \'%s\' %s, prio %d, sp %08X, stack %08X+%u\n'
+              % ('*' if tid == current else '-', tid, name, state, prio,
+                 sp, bottom, stack_size))
+        stack = struct.unpack_from('<%dI' % nwords, data, pos)
+        pos += 4 * nwords
+        for i in range(0, nwords, 4):
+            write('   %08X: %s\n' % (sp + 4 * i, ' '.join(
+                '%08X' % w for w in stack[i:i + 4])))
+
+    if trace_bytes:
+        write('Trace:\n')
+        write(data[pos:pos + trace_bytes].decode('utf-8', 'replace'))
+        if not data[pos:pos + trace_bytes].endswith(b'\n'):
+            write('\n')
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write('usage: %s dump.bin\n' % argv[0])
+        return 1
+    with open(argv[1], 'rb') as f:
+        data = f.read()
+    try:
+        decode(data, sys.stdout.write)
+    except ValueError as e:
+        sys.stderr.write('%s: %s\n' % (argv[1], e))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
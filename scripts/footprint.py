@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Break the size of a build down by subsystem, from a GNU ld map file.
+#
+# Usage: footprint.py [-c OLD.csv] [-o NEW.csv] [-b SUBSYSTEM.SECTION=N]...
+#                     file.map
+#
+# Each input section listed in the memory map is charged to the
+# subsystem of its object file, from the path ('src/rtos/' is 'rtos',
+# and so on; libraries and startup code are 'other'); '.text' includes
+# '.rodata' and the other read-only sections, '.data' is counted once,
+# in RAM, and '.bss' includes the '.noinit' and COMMON sections.
+#
+# With '-o' the table is also written as CSV, which can be given to a
+# later run with '-c', to show the growth. Each '-b' sets a budget, in
+# bytes (the whole build is 'total'); if any is exceeded, the exit code
+# is 1, so the script can fail a CI job.
+# -----------------------------------------------------------------------------
+
+import argparse
+import csv
+import re
+import sys
+
+SUBSYSTEMS = ['rtos', 'posix-io', 'memory', 'driver', 'diag', 'other']
+SECTIONS = ['.text', '.data', '.bss']
+
+# The first match wins.
+PATHS = [
+    (re.compile(r'[/\\](rtos|cmsis-plus/rtos)[/\\]'), 'rtos'),
+    (re.compile(r'[/\\](posix-io|posix-driver|posix)[/\\]'), 'posix-io'),
+    (re.compile(r'[/\\](memory|estd)[/\\]'), 'memory'),
+    (re.compile(r'[/\\](driver|usb-device|usb-host)[/\\]'), 'driver'),
+    (re.compile(r'[/\\](diag|semihosting)[/\\]'), 'diag'),
+]
+
+# An input section: ' .text.name 0xADDRESS 0xSIZE object', possibly
+# with the name alone on the previous line, if it is too long.
+SECTION_RE = re.compile(r'^ (\.[^\s]+|COMMON)(?:\s+(0x[0-9a-fA-F]+)'
+                        r'\s+(0x[0-9a-fA-F]+)\s+(.+))?$')
+CONTINUATION_RE = re.compile(r'^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)'
+                             r'\s+(.+)$')
+
+
+def section_kind(name):
+    if name == 'COMMON' or name.startswith(('.bss', '.noinit', '.sbss')):
+        return '.bss'
+    if name.startswith(('.data', '.sdata')):
+        return '.data'
+    if name.startswith(('.text', '.rodata', '.init', '.fini', '.ARM',
+                        '.isr_vector', '.glue', '.vfp11', '.v4_bx',
+                        '.iplt', '.eh_frame', '.gcc_except_table')):
+        return '.text'
+    # Debug information and other sections not loaded.
+    return None
+
+
+def subsystem(path):
+    for (regex, name) in PATHS:
+        if regex.search(path):
+            return name
+    return 'other'
+
+
+def parse(f):
+    sizes = dict((s, dict((k, 0) for k in SECTIONS)) for s in SUBSYSTEMS)
+    in_map = False
+    pending = None
+    for line in f:
+        line = line.rstrip('\n')
+        if not in_map:
+            in_map = line.startswith('Linker script and memory map')
+            continue
+        if line.startswith('/DISCARD/'):
+            break
+        if pending is not None:
+            m = CONTINUATION_RE.match(line)
+            name = pending
+            pending = None
+            if m:
+                (address, size, path) = m.groups()
+            else:
+                continue
+        else:
+            m = SECTION_RE.match(line)
+            if not m:
+                continue
+            (name, address, size, path) = m.groups()
+            if address is None:
+                pending = name
+                continue
+        kind = section_kind(name)
+        if kind is None or int(address, 16) == 0:
+            continue
+        sizes[subsystem(path.strip())][kind] += int(size, 16)
+    return sizes
+
+
+def read_csv(name):
+    sizes = {}
+    with open(name) as f:
+        for row in csv.DictReader(f):
+            sizes[row['subsystem']] = dict((k, int(row[k])) for k in SECTIONS)
+    return sizes
+
+
+def write_csv(sizes, name):
+    with open(name, 'w') as f:
+        w = csv.writer(f)
+        w.writerow(['subsystem'] + SECTIONS)
+        for s in SUBSYSTEMS:
+            w.writerow([s] + [sizes[s][k] for k in SECTIONS])
+
+
+def totals(sizes):
+    return dict((k, sum(sizes[s][k] for s in SUBSYSTEMS)) for k in SECTIONS)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Show the size of a build by subsystem.')
+    parser.add_argument('-c', '--compare', metavar='OLD.csv',
+                        help='show the changes from a previous run')
+    parser.add_argument('-o', '--output', metavar='NEW.csv',
+                        help='also write the table as CSV')
+    parser.add_argument('-b', '--budget', action='append', default=[],
+                        metavar='SUBSYSTEM.SECTION=N',
+                        help='fail if the size is larger than N bytes')
+    parser.add_argument('map')
+    args = parser.parse_args()
+
+    with open(args.map) as f:
+        sizes = parse(f)
+    rows = SUBSYSTEMS + ['total']
+    sizes['total'] = totals(sizes)
+
+    old = read_csv(args.compare) if args.compare else None
+    if old is not None:
+        old['total'] = totals(old)
+
+    print('%-10s' % 'subsystem'
+          + ''.join('%16s' % k for k in SECTIONS))
+    for s in rows:
+        line = '%-10s' % s
+        for k in SECTIONS:
+            cell = '%d' % sizes[s][k]
+            if old is not None:
+                delta = sizes[s][k] - old.get(s, {}).get(k, 0)
+                if delta != 0:
+                    cell += ' (%+d)' % delta
+            line += '%16s' % cell
+        print(line)
+
+    if args.output:
+        write_csv(sizes, args.output)
+
+    failed = False
+    for budget in args.budget:
+        m = re.match(r'^([\w-]+)\.(\w+)=(\d+)$', budget)
+        if not m or m.group(1) not in rows or \
+                ('.' + m.group(2)) not in SECTIONS:
+            sys.exit('%s: invalid budget %s' % (sys.argv[0], budget))
+        (s, k, limit) = (m.group(1), '.' + m.group(2), int(m.group(3)))
+        if sizes[s][k] > limit:
+            print('%s %s is %d bytes, over the budget of %d'
+                  % (s, k, sizes[s][k], limit), file=sys.stderr)
+            failed = True
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Build a read-only image for file_system_rom from a host folder.
+#
+# Usage: romfs-build.py [-a ALIGN] [-n NAME] folder output
+#
+# The output is the binary image, or, if its name ends in '.c', a C
+# source file with the image as a 'const uint8_t NAME[]' array, aligned
+# to ALIGN. ALIGN (default 512) must be the block size of the device,
+# or a multiple of it, so each file starts in its own block and can be
+# mapped in place.
+#
+# Layout, all words little endian, 32-bit:
+#   header:  magic 'ROM1', version, image size, index size, entries,
+#            align, index CRC-32, reserved;
+#   entries: name offset, data offset or first child, size or
+#            children, mode, modification time, 20 bytes each; the
+#            root first, then the children of each folder, sorted by
+#            name, in consecutive entries;
+#   names:   NUL terminated, not including the path;
+#   data:    each file at a multiple of ALIGN.
+# -----------------------------------------------------------------------------
+
+import argparse
+import os
+import stat
+import struct
+import sys
+import zlib
+
+MAGIC = 0x314D4F52  # 'ROM1'
+VERSION = 1
+HEADER_SIZE = 32
+ENTRY_SIZE = 20
+
+S_IFDIR = 0o040000
+S_IFREG = 0o100000
+
+
+class Node(object):
+
+    def __init__(self, name, path):
+        self.name = name
+        self.path = path
+        st = os.stat(path)
+        self.mtime = int(st.st_mtime) & 0xFFFFFFFF
+        self.is_dir = stat.S_ISDIR(st.st_mode)
+        self.children = []
+        self.data = b''
+        if self.is_dir:
+            for entry in sorted(os.listdir(path)):
+                child = os.path.join(path, entry)
+                if os.path.isdir(child) or os.path.isfile(child):
+                    self.children.append(Node(entry, child))
+        else:
+            with open(path, 'rb') as f:
+                self.data = f.read()
+
+
+def build(root, align):
+    # Breadth first, the children of each folder are consecutive.
+    order = [root]
+    i = 0
+    while i < len(order):
+        order.extend(order[i].children)
+        i += 1
+    index = dict((id(n), k) for (k, n) in enumerate(order))
+
+    names = b''
+    name_offsets = []
+    names_start = HEADER_SIZE + ENTRY_SIZE * len(order)
+    for n in order:
+        name_offsets.append(names_start + len(names))
+        names += n.name.encode() + b'\0'
+
+    pos = names_start + len(names)
+    data = b''
+    data_offsets = []
+    for n in order:
+        if n.is_dir:
+            data_offsets.append(0)
+            continue
+        pad = (-pos) % align
+        data += b'\0' * pad
+        pos += pad
+        data_offsets.append(pos)
+        data += n.data
+        pos += len(n.data)
+
+    entries = b''
+    for (k, n) in enumerate(order):
+        if n.is_dir:
+            first = index[id(n.children[0])] if n.children else 0
+            entries += struct.pack('<IIIII', name_offsets[k], first,
+                                   len(n.children), S_IFDIR | 0o555,
+                                   n.mtime)
+        else:
+            entries += struct.pack('<IIIII', name_offsets[k],
+                                   data_offsets[k], len(n.data),
+                                   S_IFREG | 0o444, n.mtime)
+
+    body = entries + names + data
+    size = HEADER_SIZE + len(body)
+    size += (-size) % align
+    body += b'\0' * (size - HEADER_SIZE - len(body))
+    index_size = len(entries) + len(names)
+    crc = zlib.crc32(body[:index_size]) & 0xFFFFFFFF
+    header = struct.pack('<8I', MAGIC, VERSION, size, index_size,
+                         len(order), align, crc, 0)
+    return header + body
+
+
+def write_c(image, name, align, f):
+    f.write('// Generated by romfs-build.py, do not edit.\n\n')
+    f.write('#include <stdint.h>\n\n')
+    f.write('const uint8_t %s[%d] __attribute__((aligned(%d))) =\n  {\n'
+            % (name, len(image), align))
+    for i in range(0, len(image), 12):
+        row = ', '.join('0x%02X' % b for b in image[i:i + 12])
+        f.write('    %s,\n' % row)
+    f.write('  };\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Build a file_system_rom image.')
+    parser.add_argument('-a', '--align', type=int, default=512,
+                        help='file data alignment, the block size')
+    parser.add_argument('-n', '--name', default='rom_image',
+                        help='the C array name')
+    parser.add_argument('folder')
+    parser.add_argument('output')
+    args = parser.parse_args()
+
+    if args.align <= 0 or (args.align & (args.align - 1)) != 0:
+        sys.exit('%s: the alignment must be a power of 2' % sys.argv[0])
+
+    root = Node('', args.folder)
+    if not root.is_dir:
+        sys.exit('%s: %s is not a folder' % (sys.argv[0], args.folder))
+    image = build(root, args.align)
+
+    if args.output.endswith('.c'):
+        with open(args.output, 'w') as f:
+            write_c(image, args.name, args.align, f)
+    else:
+        with open(args.output, 'wb') as f:
+            f.write(image)
+
+
+if __name__ == '__main__':
+    main()
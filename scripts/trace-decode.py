@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Decode the binary trace records written by OS_TRACE_BPRINTF() when
+# OS_USE_TRACE_BINARY is defined.
+#
+# Usage: trace-decode.py app.elf [capture.bin]
+#
+# The capture is the raw trace channel output (for example the SWO or
+# RTT log); the text messages are passed through unchanged and the
+# binary records are formatted with the strings from the ELF file.
+# Records are assumed to be little endian, with 32-bit words.
+# -----------------------------------------------------------------------------
+
+import re
+import struct
+import sys
+
+RECORD_TAG = 0xB7
+MAX_WORDS = 255
+
+# printf() conversion specification.
+SPEC = re.compile(r'%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?'
+                  r'(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGcsp%])')
+
+
+class Elf(object):
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        if data[:4] != b'\x7fELF':
+            raise ValueError('%s: not an ELF file' % path)
+        is64 = (data[4] == 2)
+        end = '<' if data[5] == 1 else '>'
+        if is64:
+            shoff, = struct.unpack_from(end + 'Q', data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(
+                end + 'HHH', data, 0x3A)
+            fmt = end + 'IIQQQQ'
+        else:
+            shoff, = struct.unpack_from(end + 'I', data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(
+                end + 'HHH', data, 0x2E)
+            fmt = end + 'IIIIII'
+        headers = [struct.unpack_from(fmt, data, shoff + i * shentsize)
+                   for i in range(shnum)]
+        names = headers[shstrndx]
+        self.sections = []
+        for (name, type_, flags, addr, offset, size) in headers:
+            if type_ == 8:  # SHT_NOBITS
+                continue
+            start = names[4] + name
+            name = data[start:data.index(b'\0', start)].decode()
+            self.sections.append((name, addr, data[offset:offset + size],
+                                  flags))
+
+    def string(self, addr):
+        # Prefer the format section, its addresses overlap the others.
+        for (name, start, body, flags) in sorted(
+                self.sections, key=lambda s: s[0] != '.trace_fmt'):
+            if name != '.trace_fmt' and not (flags & 0x2):  # SHF_ALLOC
+                continue
+            if start <= addr < start + len(body):
+                off = addr - start
+                end = body.find(b'\0', off)
+                if end < 0:
+                    end = len(body)
+                return body[off:end].decode('utf-8', 'replace')
+        return None
+
+
+def format_record(elf, fmt, words):
+    out = []
+    pos = 0
+    args = list(words)
+
+    def take(n):
+        value = 0
+        for i in range(n):
+            value |= (args.pop(0) if args else 0) << (32 * i)
+        return value
+
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if width == '*':
+            width = str(take(1))
+        if prec == '*':
+            prec = str(take(1))
+        spec = '%' + flags + (width or '') + ('.' + prec if prec else '')
+        if conv in 'eEfFgG':
+            value, = struct.unpack('<d', struct.pack('<Q', take(2)))
+            out.append((spec + conv) % value)
+        elif conv == 's':
+            addr = take(1)
+            s = elf.string(addr)
+            out.append((spec + 's') % (s if s is not None
+                                       else '<0x%08x>' % addr))
+        elif conv == 'p':
+            out.append('0x%08x' % take(1))
+        else:
+            bits = 64 if length in ('ll', 'j') else 32
+            value = take(bits // 32)
+            if conv in 'di' and value & (1 << (bits - 1)):
+                value -= 1 << bits
+            if conv == 'c':
+                out.append((spec + 'c') % chr(value & 0xFF))
+            else:
+                out.append((spec + ('d' if conv in 'diu' else conv)) % value)
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode(elf, data, write):
+    i = 0
+    text_start = 0
+    while i + 8 <= len(data):
+        if (data[i + 3] == RECORD_TAG and data[i + 1] == 0
+                and data[i + 2] == 0 and data[i] <= MAX_WORDS):
+            nwords = data[i]
+            end = i + 8 + 4 * nwords
+            if end <= len(data):
+                fmt_addr, = struct.unpack_from('<I', data, i + 4)
+                fmt = elf.string(fmt_addr)
+                if fmt is not None:
+                    write(data[text_start:i].decode('utf-8', 'replace'))
+                    words = struct.unpack_from('<%dI' % nwords, data, i + 8)
+                    write(format_record(elf, fmt, words))
+                    i = end
+                    text_start = i
+                    continue
+        i += 1
+    write(data[text_start:].decode('utf-8', 'replace'))
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write('usage: %s app.elf [capture.bin]\n' % argv[0])
+        return 1
+    elf = Elf(argv[1])
+    if len(argv) > 2:
+        with open(argv[2], 'rb') as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(elf, data, sys.stdout.write)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
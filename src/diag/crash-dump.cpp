@@ -0,0 +1,334 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/diag/crash-dump.h>
+
+#if defined(OS_USE_CRASH_DUMP)
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_CRASH_DUMP_SIZE_BYTES)
+#define OS_INTEGER_CRASH_DUMP_SIZE_BYTES (2048)
+#endif
+
+#if !defined(OS_INTEGER_CRASH_DUMP_STACK_WORDS)
+#define OS_INTEGER_CRASH_DUMP_STACK_WORDS (32)
+#endif
+
+static_assert((OS_INTEGER_CRASH_DUMP_SIZE_BYTES % 4) == 0,
+    "OS_INTEGER_CRASH_DUMP_SIZE_BYTES must be a multiple of 4.");
+
+// The layout is also known by scripts/crash-decode.py.
+static_assert(sizeof(os::crash_dump::header) == 84, "adjust the decoder");
+static_assert(sizeof(os::crash_dump::thread_record) == 36,
+    "adjust the decoder");
+
+// ----------------------------------------------------------------------------
+
+using namespace os;
+using namespace os::crash_dump;
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  // Not initialised by the startup code, to survive the reset.
+  uint32_t area_[OS_INTEGER_CRASH_DUMP_SIZE_BYTES / sizeof(uint32_t)]
+  OS_ATTRIBUTE_NOINIT;
+
+  inline header*
+  head (void)
+  {
+    return reinterpret_cast<header*> (area_);
+  }
+
+  uint32_t
+  compute_checksum (std::size_t size)
+  {
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i < size / sizeof(uint32_t); ++i)
+      {
+        sum += area_[i];
+      }
+    return sum;
+  }
+
+  inline uint32_t
+  address (const void* p)
+  {
+    return static_cast<uint32_t> (reinterpret_cast<uintptr_t> (p));
+  }
+
+  // Append the records of all threads in the list and their children,
+  // as long as they fit; return the new end of the image.
+  uint8_t*
+  add_threads (rtos::thread::threads_list& list, uint8_t* p,
+               const uint8_t* end, void* frame_sp)
+  {
+    for (auto&& th : list)
+      {
+        if (p + sizeof(thread_record) > end)
+          {
+            break;
+          }
+
+        thread_record* rec = reinterpret_cast<thread_record*> (p);
+        rec->id = address (&th);
+        std::strncpy (rec->name, th.name (), name_size - 1);
+        rec->name[name_size - 1] = '\0';
+        rec->state = th.state ();
+        rec->priority = th.priority ();
+
+        class rtos::thread::stack& stack = th.stack ();
+        rec->stack_bottom = address (stack.bottom ());
+        rec->stack_size = static_cast<uint32_t> (stack.size ());
+
+        // The interrupted thread stack pointer is the exception frame;
+        // the other threads have it saved in their context.
+        void* sp = frame_sp;
+        if (&th != rtos::scheduler::current_thread_ || sp == nullptr)
+          {
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+            sp = os_crash_dump_stack_pointer (&th);
+#else
+            sp = nullptr;
+#endif
+          }
+        rec->stack_pointer = address (sp);
+
+        p += sizeof(thread_record);
+
+        std::size_t words = 0;
+        uint32_t* from = static_cast<uint32_t*> (sp);
+        uint32_t* top = reinterpret_cast<uint32_t*> (stack.top ());
+        if (from != nullptr
+            && from >= reinterpret_cast<uint32_t*> (stack.bottom ())
+            && from < top)
+          {
+            words = static_cast<std::size_t> (top - from);
+            if (words > OS_INTEGER_CRASH_DUMP_STACK_WORDS)
+              {
+                words = OS_INTEGER_CRASH_DUMP_STACK_WORDS;
+              }
+            std::size_t room = static_cast<std::size_t> (end - p)
+                / sizeof(uint32_t);
+            if (words > room)
+              {
+                words = room;
+              }
+            std::memcpy (p, from, words * sizeof(uint32_t));
+          }
+        rec->stack_words = static_cast<uint16_t> (words);
+        p += words * sizeof(uint32_t);
+
+        head ()->threads++;
+
+        p = add_threads (rtos::scheduler::children_threads (&th), p, end,
+                         frame_sp);
+      }
+    return p;
+  }
+}
+
+/**
+ * @endcond
+ */
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+/**
+ * @details
+ * The stack pointer saved by the port at the last context switch.
+ */
+void*
+os_crash_dump_stack_pointer (os::rtos::thread* th)
+{
+#if defined(__ARM_EABI__)
+  return th->context_.port_.stack_ptr;
+#else
+  (void) th;
+  return nullptr;
+#endif
+}
+
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+/**
+ * @details
+ * Write the image to the no-init area; the magic word is written
+ * last, so an image interrupted by a nested fault is not valid.
+ * It takes only a few copies and does not use the trace output,
+ * so it does not delay the reset.
+ */
+void
+os_crash_dump_capture (exception_stack_frame_t* frame, uint32_t exc_return)
+{
+  if (valid ())
+    {
+      // Keep the first fault; the following ones are usually effects.
+      return;
+    }
+
+  header* h = head ();
+  std::memset (h, 0, sizeof(header));
+
+  h->version = version;
+  h->timestamp = static_cast<uint32_t> (rtos::sysclock.now ());
+  h->exc_return = exc_return;
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+  // SCB->CFSR, HFSR, MMFAR, BFAR.
+  h->cfsr = *reinterpret_cast<volatile uint32_t*> (0xE000ED28);
+  h->hfsr = *reinterpret_cast<volatile uint32_t*> (0xE000ED2C);
+  h->mmfar = *reinterpret_cast<volatile uint32_t*> (0xE000ED34);
+  h->bfar = *reinterpret_cast<volatile uint32_t*> (0xE000ED38);
+#endif
+
+  h->frame = address (frame);
+  h->r0 = frame->r0;
+  h->r1 = frame->r1;
+  h->r2 = frame->r2;
+  h->r3 = frame->r3;
+  h->r12 = frame->r12;
+  h->lr = frame->lr;
+  h->pc = frame->pc;
+  h->psr = frame->psr;
+
+  h->current_thread = address (rtos::scheduler::current_thread_);
+
+  uint8_t* p = reinterpret_cast<uint8_t*> (h + 1);
+  const uint8_t* end = reinterpret_cast<uint8_t*> (area_) + sizeof(area_);
+
+  // Bit 2 of EXC_RETURN set means the fault happened in thread mode.
+  void* frame_sp = ((exc_return & 4) != 0) ? frame : nullptr;
+  p = add_threads (rtos::scheduler::children_threads (nullptr), p, end,
+                   frame_sp);
+
+#if defined(TRACE) && defined(OS_USE_TRACE_RING_BUFFER)
+  std::size_t n = trace::snapshot (p, static_cast<std::size_t> (end - p));
+  h->trace_bytes = static_cast<uint32_t> (n);
+  p += (n + 3) & ~static_cast<std::size_t> (3);
+#endif
+
+  h->size = static_cast<uint32_t> (p - reinterpret_cast<uint8_t*> (area_));
+  // The magic, still zero, is accounted as if already written.
+  h->checksum = compute_checksum (h->size) + magic;
+  h->magic = magic;
+}
+
+namespace os
+{
+  namespace crash_dump
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * After a power-on reset the area content is random,
+     * so the size and the checksum are also verified.
+     */
+    bool
+    valid (void)
+    {
+      header* h = head ();
+      if (h->magic != magic || h->version != version)
+        {
+          return false;
+        }
+      if (h->size < sizeof(header) || h->size > sizeof(area_)
+          || (h->size % sizeof(uint32_t)) != 0)
+        {
+          return false;
+        }
+      uint32_t sum = h->checksum;
+      // The magic is part of the checksum, as all other words.
+      h->checksum = 0;
+      uint32_t computed = compute_checksum (h->size);
+      h->checksum = sum;
+      return computed == sum;
+    }
+
+    const header*
+    image (void)
+    {
+      return head ();
+    }
+
+    std::size_t
+    capacity (void)
+    {
+      return sizeof(area_);
+    }
+
+    /**
+     * @details
+     * Write the blocks covering the image, starting at `blknum`;
+     * usually called early after the reset, before clearing it.
+     * The partition must have room for `capacity()` bytes.
+     */
+    ssize_t
+    save (posix::block_device& device, posix::block_device::blknum_t blknum)
+    {
+      if (!valid ())
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      std::size_t bsz = device.block_logical_size_bytes ();
+      if (bsz == 0 || (sizeof(area_) % bsz) != 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      std::size_t nblocks = (head ()->size + bsz - 1) / bsz;
+      return device.write_block (area_, blknum, nblocks);
+    }
+
+    void
+    clear (void)
+    {
+      head ()->magic = 0;
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace crash_dump */
+} /* namespace os */
+
+#endif /* defined(OS_USE_CRASH_DUMP) */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,941 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/diag/format.h>
+
+#include <cstdint>
+#include <climits>
+#include <unistd.h>
+
+#if defined(OS_INCLUDE_FORMAT_FLOAT)
+#include <cmath>
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_FORMAT_DPRINTF_BUFFER_SIZE)
+#define OS_INTEGER_FORMAT_DPRINTF_BUFFER_SIZE (32)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace format
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      enum : unsigned int
+      {
+        flag_left = 1u << 0,
+        flag_plus = 1u << 1,
+        flag_space = 1u << 2,
+        flag_alt = 1u << 3,
+        flag_zero = 1u << 4,
+      };
+
+      struct spec
+      {
+        unsigned int flags;
+        int width;
+        // Negative if not specified.
+        int precision;
+      };
+
+      struct output
+      {
+        sink_t sink;
+        void* ctx;
+        int count;
+        bool failed;
+      };
+
+      void
+      emit (output& out, const char* buf, std::size_t nbyte)
+      {
+        if (out.failed || nbyte == 0)
+          {
+            return;
+          }
+        if (out.sink (out.ctx, buf, nbyte) < 0)
+          {
+            out.failed = true;
+            return;
+          }
+        out.count += static_cast<int> (nbyte);
+      }
+
+      void
+      emit_repeated (output& out, char c, int n)
+      {
+        static const char spaces[] = "                ";
+        static const char zeros[] = "0000000000000000";
+        const char* p = (c == '0') ? zeros : spaces;
+
+        while (n > 0)
+          {
+            int k = (n < 16) ? n : 16;
+            emit (out, p, static_cast<std::size_t> (k));
+            n -= k;
+          }
+      }
+
+      // The prefix (sign, 0x), the leading zeros and the digits,
+      // padded to the width.
+      void
+      emit_field (output& out, const spec& sp, const char* prefix,
+                  std::size_t prefix_len, int zeros, const char* digits,
+                  std::size_t digits_len)
+      {
+        int len = static_cast<int> (prefix_len + digits_len)
+            + ((zeros > 0) ? zeros : 0);
+        int pad = (sp.width > len) ? sp.width - len : 0;
+
+        if (!(sp.flags & flag_left))
+          {
+            if (sp.flags & flag_zero)
+              {
+                zeros += pad;
+              }
+            else
+              {
+                emit_repeated (out, ' ', pad);
+              }
+          }
+        emit (out, prefix, prefix_len);
+        emit_repeated (out, '0', zeros);
+        emit (out, digits, digits_len);
+        if (sp.flags & flag_left)
+          {
+            emit_repeated (out, ' ', pad);
+          }
+      }
+
+      // Store the digits backwards, ending at end.
+      char*
+      convert (char* end, uintmax_t value, unsigned int base, bool upper)
+      {
+        const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+        char* p = end;
+
+        // Use the faster 32-bit divisions when possible.
+        while (value > UINT32_MAX)
+          {
+            *--p = digits[value % base];
+            value /= base;
+          }
+        uint32_t v = static_cast<uint32_t> (value);
+        while (v != 0)
+          {
+            *--p = digits[v % base];
+            v /= base;
+          }
+        return p;
+      }
+
+      void
+      emit_integer (output& out, spec sp, uintmax_t value, bool negative,
+                    char conversion)
+      {
+        unsigned int base = 10;
+        if (conversion == 'o')
+          {
+            base = 8;
+          }
+        else if (conversion == 'x' || conversion == 'X'
+            || conversion == 'p')
+          {
+            base = 16;
+          }
+
+        char buf[24];
+        char* end = buf + sizeof(buf);
+        char* p = convert (end, value, base, conversion == 'X');
+        if (p == end && sp.precision != 0)
+          {
+            *--p = '0';
+          }
+
+        int zeros = 0;
+        if (sp.precision >= 0)
+          {
+            zeros = sp.precision - static_cast<int> (end - p);
+            // The precision makes the 0 flag ignored.
+            sp.flags &= ~flag_zero;
+          }
+
+        char prefix[2];
+        std::size_t prefix_len = 0;
+        if (conversion == 'd' || conversion == 'i')
+          {
+            if (negative)
+              {
+                prefix[prefix_len++] = '-';
+              }
+            else if (sp.flags & flag_plus)
+              {
+                prefix[prefix_len++] = '+';
+              }
+            else if (sp.flags & flag_space)
+              {
+                prefix[prefix_len++] = ' ';
+              }
+          }
+        else if (conversion == 'p'
+            || ((sp.flags & flag_alt) && base == 16 && value != 0))
+          {
+            prefix[prefix_len++] = '0';
+            prefix[prefix_len++] = (conversion == 'X') ? 'X' : 'x';
+          }
+        else if ((sp.flags & flag_alt) && base == 8 && zeros <= 0
+            && (p == end || *p != '0'))
+          {
+            zeros = 1;
+          }
+
+        emit_field (out, sp, prefix, prefix_len, zeros, p,
+                    static_cast<std::size_t> (end - p));
+      }
+
+      void
+      emit_string (output& out, spec sp, const char* s)
+      {
+        if (s == nullptr)
+          {
+            s = "(null)";
+          }
+        std::size_t len = 0;
+        while (s[len] != '\0'
+            && (sp.precision < 0 || len < static_cast<std::size_t> (sp.precision)))
+          {
+            ++len;
+          }
+        sp.flags &= ~flag_zero;
+        emit_field (out, sp, nullptr, 0, 0, s, len);
+      }
+
+#if defined(OS_INCLUDE_FORMAT_FLOAT)
+
+      constexpr int max_decimals = 17;
+
+      constexpr uint64_t
+      pow10 (int n)
+      {
+        return (n == 0) ? 1 : 10 * pow10 (n - 1);
+      }
+
+      // Store the value, rounded to the decimals, as %f;
+      // the value must be below 1e19.
+      std::size_t
+      fixed (char* buf, double value, int decimals, bool point)
+      {
+        uint64_t ip = static_cast<uint64_t> (value);
+        uint64_t scale = pow10 (decimals);
+        double scaled = (value - static_cast<double> (ip))
+            * static_cast<double> (scale);
+        uint64_t fp = static_cast<uint64_t> (scaled);
+
+        // Round half to even, as the C library.
+        double rem = scaled - static_cast<double> (fp);
+        if (rem > 0.5 || (!(rem < 0.5) && (((decimals > 0) ? fp : ip) & 1)))
+          {
+            ++fp;
+          }
+        if (fp >= scale)
+          {
+            fp -= scale;
+            ++ip;
+          }
+
+        char tmp[24];
+        char* end = tmp + sizeof(tmp);
+        char* p = convert (end, ip, 10, false);
+        if (p == end)
+          {
+            *--p = '0';
+          }
+
+        std::size_t n = 0;
+        while (p < end)
+          {
+            buf[n++] = *p++;
+          }
+        if (decimals > 0 || point)
+          {
+            buf[n++] = '.';
+          }
+        p = convert (end, fp, 10, false);
+        for (int i = static_cast<int> (end - p); i < decimals; ++i)
+          {
+            buf[n++] = '0';
+          }
+        while (p < end && decimals > 0)
+          {
+            buf[n++] = *p++;
+          }
+        return n;
+      }
+
+      // Multiply by 10^exp, with few roundings and without
+      // overflowing the intermediate powers.
+      double
+      scale10 (double value, int exp)
+      {
+        static const double powers[] =
+          { 1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256 };
+
+        unsigned int e = static_cast<unsigned int> ((exp < 0) ? -exp : exp);
+        if (e <= 22)
+          {
+            // Exact power, a single rounding.
+            double p = 1.0;
+            for (std::size_t i = 0; e != 0; ++i, e >>= 1)
+              {
+                if (e & 1)
+                  {
+                    p *= powers[i];
+                  }
+              }
+            return (exp < 0) ? value / p : value * p;
+          }
+
+        for (std::size_t i = 0; e != 0 && i < sizeof(powers) / sizeof(powers[0]);
+            ++i, e >>= 1)
+          {
+            if (e & 1)
+              {
+                value = (exp < 0) ? value / powers[i] : value * powers[i];
+              }
+          }
+        return value;
+      }
+
+      // Normalise the value to [1, 10), rounded to the decimals,
+      // and return the exponent.
+      int
+      normalise (double* value, int decimals)
+      {
+        double v = *value;
+        int exp = 0;
+        if (v != 0.0)
+          {
+            // Estimate the exponent from the binary one (log10(2)).
+            int bexp;
+            std::frexp (v, &bexp);
+            int e = (bexp - 1) * 30103;
+            exp = (e >= 0) ? e / 100000 : -((-e + 99999) / 100000);
+
+            v = scale10 (v, -exp);
+            while (v >= 10.0)
+              {
+                v /= 10.0;
+                ++exp;
+              }
+            while (v < 1.0)
+              {
+                v *= 10.0;
+                --exp;
+              }
+            // The rounding may make it 10.
+            if (v + 0.5 / static_cast<double> (pow10 (decimals)) >= 10.0)
+              {
+                v /= 10.0;
+                ++exp;
+              }
+          }
+        *value = v;
+        return exp;
+      }
+
+      // Store the value as %e.
+      std::size_t
+      exponential (char* buf, double value, int decimals, bool point,
+                   bool upper)
+      {
+        int exp = normalise (&value, decimals);
+        std::size_t n = fixed (buf, value, decimals, point);
+        if (buf[0] == '1' && buf[1] == '0')
+          {
+            // Rounded up to 10; the normalisation should prevent it.
+            ++exp;
+            n = fixed (buf, 1.0, decimals, point);
+          }
+        buf[n++] = upper ? 'E' : 'e';
+        buf[n++] = (exp < 0) ? '-' : '+';
+        unsigned int e = static_cast<unsigned int> ((exp < 0) ? -exp : exp);
+        if (e >= 100)
+          {
+            buf[n++] = static_cast<char> ('0' + e / 100);
+          }
+        buf[n++] = static_cast<char> ('0' + (e / 10) % 10);
+        buf[n++] = static_cast<char> ('0' + e % 10);
+        return n;
+      }
+
+      void
+      emit_float (output& out, spec sp, double value, char conversion)
+      {
+        bool upper = (conversion == 'F' || conversion == 'E'
+            || conversion == 'G');
+
+        char prefix[1];
+        std::size_t prefix_len = 0;
+        if (std::signbit (value))
+          {
+            prefix[prefix_len++] = '-';
+            value = -value;
+          }
+        else if (sp.flags & flag_plus)
+          {
+            prefix[prefix_len++] = '+';
+          }
+        else if (sp.flags & flag_space)
+          {
+            prefix[prefix_len++] = ' ';
+          }
+
+        if (std::isnan (value) || std::isinf (value))
+          {
+            const char* s =
+                std::isnan (value) ?
+                    (upper ? "NAN" : "nan") : (upper ? "INF" : "inf");
+            sp.flags &= ~flag_zero;
+            emit_field (out, sp, prefix, prefix_len, 0, s, 3);
+            return;
+          }
+
+        int decimals = (sp.precision < 0) ? 6 : sp.precision;
+        if (decimals > max_decimals)
+          {
+            decimals = max_decimals;
+          }
+        bool alt = (sp.flags & flag_alt);
+
+        char buf[48];
+        std::size_t n;
+        if (conversion == 'f' || conversion == 'F')
+          {
+            if (value < 1e19)
+              {
+                n = fixed (buf, value, decimals, alt);
+              }
+            else
+              {
+                n = exponential (buf, value, decimals, alt, upper);
+              }
+          }
+        else if (conversion == 'e' || conversion == 'E')
+          {
+            n = exponential (buf, value, decimals, alt, upper);
+          }
+        else
+          {
+            int p = (decimals == 0) ? 1 : decimals;
+            double v = value;
+            int exp = normalise (&v, p - 1);
+            if (exp < p && exp >= -4)
+              {
+                int d = p - 1 - exp;
+                n = fixed (buf, value, (d > max_decimals) ? max_decimals : d,
+                           alt);
+              }
+            else
+              {
+                n = exponential (buf, value, p - 1, alt, upper);
+              }
+            if (!alt)
+              {
+                // Remove the trailing zeros of the fraction.
+                std::size_t m = 0;
+                while (m < n && buf[m] != '.')
+                  {
+                    ++m;
+                  }
+                if (m < n)
+                  {
+                    std::size_t e = m;
+                    while (e < n && buf[e] != 'e' && buf[e] != 'E')
+                      {
+                        ++e;
+                      }
+                    std::size_t t = e;
+                    while (t > m + 1 && buf[t - 1] == '0')
+                      {
+                        --t;
+                      }
+                    if (t == m + 1)
+                      {
+                        t = m;
+                      }
+                    for (std::size_t i = e; i < n; ++i)
+                      {
+                        buf[t++] = buf[i];
+                      }
+                    n = t;
+                  }
+              }
+          }
+
+        emit_field (out, sp, prefix, prefix_len, 0, buf, n);
+      }
+
+#endif /* defined(OS_INCLUDE_FORMAT_FLOAT) */
+
+      enum class length
+      {
+        none, hh, h, l, ll, j, z, t, L
+      };
+
+      // Fetch an integer argument, as unsigned, with the sign apart.
+      uintmax_t
+      fetch_signed (std::va_list& args, length len, bool* negative)
+      {
+        intmax_t v;
+        switch (len)
+          {
+          case length::hh:
+            v = static_cast<signed char> (va_arg(args, int));
+            break;
+          case length::h:
+            v = static_cast<short> (va_arg(args, int));
+            break;
+          case length::l:
+            v = va_arg(args, long);
+            break;
+          case length::ll:
+            v = va_arg(args, long long);
+            break;
+          case length::j:
+            v = va_arg(args, intmax_t);
+            break;
+          case length::z:
+            v = va_arg(args, ssize_t);
+            break;
+          case length::t:
+            v = va_arg(args, ptrdiff_t);
+            break;
+          default:
+            v = va_arg(args, int);
+            break;
+          }
+        *negative = (v < 0);
+        // Negate as unsigned, to handle the most negative value.
+        return (v < 0) ? -static_cast<uintmax_t> (v) : static_cast<uintmax_t> (v);
+      }
+
+      uintmax_t
+      fetch_unsigned (std::va_list& args, length len)
+      {
+        switch (len)
+          {
+          case length::hh:
+            return static_cast<unsigned char> (va_arg(args, unsigned int));
+          case length::h:
+            return static_cast<unsigned short> (va_arg(args, unsigned int));
+          case length::l:
+            return va_arg(args, unsigned long);
+          case length::ll:
+            return va_arg(args, unsigned long long);
+          case length::j:
+            return va_arg(args, uintmax_t);
+          case length::z:
+            return va_arg(args, std::size_t);
+          case length::t:
+            return static_cast<uintmax_t> (va_arg(args, ptrdiff_t));
+          default:
+            return va_arg(args, unsigned int);
+          }
+      }
+
+      // ----------------------------------------------------------------------
+
+      struct buffer_context
+      {
+        char* buf;
+        std::size_t size;
+        std::size_t len;
+      };
+
+      ssize_t
+      buffer_sink (void* ctx, const char* buf, std::size_t nbyte)
+      {
+        buffer_context* bc = static_cast<buffer_context*> (ctx);
+        for (std::size_t i = 0; i < nbyte; ++i)
+          {
+            // Keep room for the terminator; count the rest.
+            if (bc->len + 1 < bc->size)
+              {
+                bc->buf[bc->len] = buf[i];
+              }
+            ++bc->len;
+          }
+        return static_cast<ssize_t> (nbyte);
+      }
+
+      struct fd_context
+      {
+        int fd;
+        std::size_t len;
+        char buf[OS_INTEGER_FORMAT_DPRINTF_BUFFER_SIZE];
+      };
+
+      ssize_t
+      fd_flush (fd_context* fc)
+      {
+        std::size_t done = 0;
+        while (done < fc->len)
+          {
+            ssize_t ret = ::write (fc->fd, fc->buf + done, fc->len - done);
+            if (ret <= 0)
+              {
+                return -1;
+              }
+            done += static_cast<std::size_t> (ret);
+          }
+        fc->len = 0;
+        return 0;
+      }
+
+      ssize_t
+      fd_sink (void* ctx, const char* buf, std::size_t nbyte)
+      {
+        fd_context* fc = static_cast<fd_context*> (ctx);
+        for (std::size_t i = 0; i < nbyte; ++i)
+          {
+            if (fc->len == sizeof(fc->buf) && fd_flush (fc) < 0)
+              {
+                return -1;
+              }
+            fc->buf[fc->len++] = buf[i];
+          }
+        return static_cast<ssize_t> (nbyte);
+      }
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The literal text between the conversions and each converted
+     * field are passed to the sink as they are produced. The engine
+     * uses no static variables and no dynamic memory, so it is
+     * reentrant if the sink is.
+     *
+     * The conversions not supported are passed to the output
+     * unchanged.
+     */
+    int
+    vprint (sink_t sink, void* ctx, const char* fmt, std::va_list args)
+    {
+      output out
+        { sink, ctx, 0, false };
+
+      // Copy, to pass it by reference to the helpers on all ABIs.
+      std::va_list ap;
+      va_copy(ap, args);
+
+      while (*fmt != '\0' && !out.failed)
+        {
+          const char* start = fmt;
+          while (*fmt != '\0' && *fmt != '%')
+            {
+              ++fmt;
+            }
+          emit (out, start, static_cast<std::size_t> (fmt - start));
+          if (*fmt == '\0')
+            {
+              break;
+            }
+
+          const char* conv_start = fmt++;
+
+          spec sp
+            { 0, 0, -1 };
+          for (;; ++fmt)
+            {
+              if (*fmt == '-')
+                sp.flags |= flag_left;
+              else if (*fmt == '+')
+                sp.flags |= flag_plus;
+              else if (*fmt == ' ')
+                sp.flags |= flag_space;
+              else if (*fmt == '#')
+                sp.flags |= flag_alt;
+              else if (*fmt == '0')
+                sp.flags |= flag_zero;
+              else
+                break;
+            }
+
+          if (*fmt == '*')
+            {
+              sp.width = va_arg(ap, int);
+              if (sp.width < 0)
+                {
+                  sp.flags |= flag_left;
+                  sp.width = -sp.width;
+                }
+              ++fmt;
+            }
+          else
+            {
+              while (*fmt >= '0' && *fmt <= '9')
+                {
+                  sp.width = sp.width * 10 + (*fmt++ - '0');
+                }
+            }
+
+          if (*fmt == '.')
+            {
+              ++fmt;
+              if (*fmt == '*')
+                {
+                  sp.precision = va_arg(ap, int);
+                  ++fmt;
+                }
+              else
+                {
+                  sp.precision = 0;
+                  while (*fmt >= '0' && *fmt <= '9')
+                    {
+                      sp.precision = sp.precision * 10 + (*fmt++ - '0');
+                    }
+                }
+            }
+          if (sp.flags & flag_left)
+            {
+              sp.flags &= ~flag_zero;
+            }
+
+          length len = length::none;
+          switch (*fmt)
+            {
+            case 'h':
+              len = (fmt[1] == 'h') ? length::hh : length::h;
+              fmt += (len == length::hh) ? 2 : 1;
+              break;
+            case 'l':
+              len = (fmt[1] == 'l') ? length::ll : length::l;
+              fmt += (len == length::ll) ? 2 : 1;
+              break;
+            case 'j':
+              len = length::j;
+              ++fmt;
+              break;
+            case 'z':
+              len = length::z;
+              ++fmt;
+              break;
+            case 't':
+              len = length::t;
+              ++fmt;
+              break;
+            case 'L':
+              len = length::L;
+              ++fmt;
+              break;
+            default:
+              break;
+            }
+
+          char conversion = *fmt;
+          if (conversion == '\0')
+            {
+              // Incomplete conversion at the end.
+              emit (out, conv_start, static_cast<std::size_t> (fmt - conv_start));
+              break;
+            }
+          ++fmt;
+
+          switch (conversion)
+            {
+            case 'd':
+            case 'i':
+              {
+                bool negative;
+                uintmax_t v = fetch_signed (ap, len, &negative);
+                emit_integer (out, sp, v, negative, conversion);
+              }
+              break;
+
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+              emit_integer (out, sp, fetch_unsigned (ap, len), false,
+                            conversion);
+              break;
+
+            case 'p':
+              sp.flags &= ~flag_zero;
+              emit_integer (
+                  out, sp,
+                  reinterpret_cast<uintptr_t> (va_arg(ap, void*)), false,
+                  'p');
+              break;
+
+            case 'c':
+              {
+                char c = static_cast<char> (va_arg(ap, int));
+                sp.flags &= ~flag_zero;
+                emit_field (out, sp, nullptr, 0, 0, &c, 1);
+              }
+              break;
+
+            case 's':
+              emit_string (out, sp, va_arg(ap, const char*));
+              break;
+
+            case '%':
+              emit (out, "%", 1);
+              break;
+
+#if defined(OS_INCLUDE_FORMAT_FLOAT)
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+              if (len == length::L)
+                {
+                  emit_float (out, sp,
+                              static_cast<double> (va_arg(ap, long double)),
+                              conversion);
+                }
+              else
+                {
+                  emit_float (out, sp, va_arg(ap, double), conversion);
+                }
+              break;
+
+#endif /* defined(OS_INCLUDE_FORMAT_FLOAT) */
+
+            default:
+              // Not supported; the argument, if any, cannot be skipped.
+              emit (out, conv_start, static_cast<std::size_t> (fmt - conv_start));
+              break;
+            }
+        }
+
+      va_end(ap);
+
+      return out.failed ? -1 : out.count;
+    }
+
+    int
+    print (sink_t sink, void* ctx, const char* fmt, ...)
+    {
+      std::va_list args;
+      va_start(args, fmt);
+
+      int ret = vprint (sink, ctx, fmt, args);
+
+      va_end(args);
+      return ret;
+    }
+
+    /**
+     * @details
+     * The output is truncated to `size - 1` characters and
+     * terminated, if `size` is not 0.
+     */
+    int
+    vsnprintf (char* buf, std::size_t size, const char* fmt,
+               std::va_list args)
+    {
+      buffer_context bc
+        { buf, size, 0 };
+
+      int ret = vprint (buffer_sink, &bc, fmt, args);
+      if (size > 0)
+        {
+          buf[(bc.len < size) ? bc.len : size - 1] = '\0';
+        }
+      return ret;
+    }
+
+    int
+    snprintf (char* buf, std::size_t size, const char* fmt, ...)
+    {
+      std::va_list args;
+      va_start(args, fmt);
+
+      int ret = vsnprintf (buf, size, fmt, args);
+
+      va_end(args);
+      return ret;
+    }
+
+    /**
+     * @details
+     * The output is collected in a small buffer on the stack
+     * (`OS_INTEGER_FORMAT_DPRINTF_BUFFER_SIZE` bytes), and passed
+     * to `write()` when full and at the end.
+     */
+    int
+    vdprintf (int fd, const char* fmt, std::va_list args)
+    {
+      fd_context fc;
+      fc.fd = fd;
+      fc.len = 0;
+
+      int ret = vprint (fd_sink, &fc, fmt, args);
+      if (ret >= 0 && fd_flush (&fc) < 0)
+        {
+          ret = -1;
+        }
+      return ret;
+    }
+
+    int
+    dprintf (int fd, const char* fmt, ...)
+    {
+      std::va_list args;
+      va_start(args, fmt);
+
+      int ret = vdprintf (fd, fmt, args);
+
+      va_end(args);
+      return ret;
+    }
+
+  } /* namespace format */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
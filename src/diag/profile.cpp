@@ -0,0 +1,316 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/diag/profile.h>
+
+#if defined(OS_INCLUDE_PROFILE_PROBES)
+
+#include <cmsis-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS)
+#if !defined(OS_INTEGER_PROFILE_CRITICAL_SECTIONS_SITES)
+#define OS_INTEGER_PROFILE_CRITICAL_SECTIONS_SITES (64)
+#endif
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace profile
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // The probes that recorded at least one duration.
+      probe* first_;
+    }
+
+    /**
+     * @endcond
+     */
+
+    void
+    initialize (void)
+    {
+#if defined(OS_USE_PROFILE_DWT)
+      // CoreDebug->DEMCR |= TRCENA.
+      *reinterpret_cast<volatile uint32_t*> (0xE000EDFC) |= (1u << 24);
+      // DWT->CTRL |= CYCCNTENA.
+      *reinterpret_cast<volatile uint32_t*> (0xE0001000) |= 1u;
+#endif
+    }
+
+    /**
+     * @details
+     * Can be called from interrupt handlers.
+     */
+    void
+    probe::record (cycles_t cycles)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      if (!linked_)
+        {
+          if (first_ == nullptr)
+            {
+              initialize ();
+            }
+          next_ = first_;
+          first_ = this;
+          linked_ = true;
+        }
+
+      if (count_ == 0 || cycles < min_)
+        {
+          min_ = cycles;
+        }
+      if (cycles > max_)
+        {
+          max_ = cycles;
+        }
+      sum_ += cycles;
+      ++count_;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    void
+    probe::reset (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      sum_ = 0;
+      count_ = 0;
+      min_ = 0;
+      max_ = 0;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    probe*
+    first (void)
+    {
+      return first_;
+    }
+
+    void
+    reset_all (void)
+    {
+      for (probe* p = first_; p != nullptr; p = p->next ())
+        {
+          p->reset ();
+        }
+    }
+
+    void
+    dump (void)
+    {
+      trace::printf ("Profile probes (cycles):\n");
+      for (probe* p = first_; p != nullptr; p = p->next ())
+        {
+          uint32_t count = p->count ();
+          trace::printf ("- %s: %u, min %u, avg %u, max %u\n", p->name (),
+                         count, p->min (),
+                         count == 0 ?
+                             0u : static_cast<uint32_t> (p->sum () / count),
+                         p->max ());
+        }
+    }
+
+#if defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS)
+
+    // ========================================================================
+
+    namespace critical_sections
+    {
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        constexpr std::size_t sites_size_ =
+            OS_INTEGER_PROFILE_CRITICAL_SECTIONS_SITES;
+
+        // The table is only changed with the interrupts disabled.
+        site sites_[sites_size_];
+        cycles_t max_;
+        uint32_t dropped_;
+
+        // The outermost window.
+        uint32_t depth_;
+        cycles_t begin_;
+        const void* pc_;
+
+        // Open addressing, the hash is the address itself, since
+        // the sites are spread over the code.
+        void
+        account (const void* pc, cycles_t cycles)
+        {
+          if (cycles > max_)
+            {
+              max_ = cycles;
+            }
+
+          std::size_t i = (reinterpret_cast<uintptr_t> (pc) >> 1)
+              % sites_size_;
+          for (std::size_t n = 0; n < sites_size_; ++n)
+            {
+              site& s = sites_[i];
+              if (s.pc == pc || s.pc == nullptr)
+                {
+                  s.pc = pc;
+                  ++s.count;
+                  s.sum += cycles;
+                  if (cycles > s.max)
+                    {
+                      s.max = cycles;
+                    }
+                  return;
+                }
+              i = (i + 1) % sites_size_;
+            }
+          ++dropped_;
+        }
+      }
+
+      /**
+       * @endcond
+       */
+
+      const site*
+      sites (void)
+      {
+        return sites_;
+      }
+
+      std::size_t
+      capacity (void)
+      {
+        return sites_size_;
+      }
+
+      cycles_t
+      max (void)
+      {
+        return max_;
+      }
+
+      uint32_t
+      dropped (void)
+      {
+        return dropped_;
+      }
+
+      void
+      reset (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::interrupts::critical_section ics;
+
+        for (std::size_t i = 0; i < sites_size_; ++i)
+          {
+            sites_[i] = site
+              { nullptr, 0, 0, 0 };
+          }
+        max_ = 0;
+        dropped_ = 0;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      dump (void)
+      {
+        trace::printf ("Interrupts critical sections (cycles), max %u:\n",
+                       max_);
+        for (std::size_t i = 0; i < sites_size_; ++i)
+          {
+            const site& s = sites_[i];
+            if (s.pc != nullptr)
+              {
+                trace::printf ("- %p: %u, avg %u, max %u\n", s.pc, s.count,
+                               static_cast<uint32_t> (s.sum / s.count),
+                               s.max);
+              }
+          }
+        if (dropped_ != 0)
+          {
+            trace::printf ("- %u not accounted, the table is full\n",
+                           dropped_);
+          }
+      }
+
+    } /* namespace critical_sections */
+
+    /**
+     * @details
+     * Not inlined, so the return address is in the function
+     * that entered the critical section.
+     */
+    void
+    __attribute__((noinline))
+    critical_section_enter_ (void)
+    {
+      if (critical_sections::depth_++ == 0)
+        {
+          critical_sections::pc_ = __builtin_return_address (0);
+          critical_sections::begin_ = now ();
+        }
+    }
+
+    void
+    __attribute__((noinline))
+    critical_section_exit_ (void)
+    {
+      cycles_t end = now ();
+
+      // An unbalanced exit is ignored.
+      if (critical_sections::depth_ != 0 && --critical_sections::depth_ == 0)
+        {
+          critical_sections::account (critical_sections::pc_,
+                                      end - critical_sections::begin_);
+        }
+    }
+
+#endif /* defined(OS_INCLUDE_PROFILE_CRITICAL_SECTIONS) */
+
+  // --------------------------------------------------------------------------
+  } /* namespace profile */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_PROFILE_PROBES) */
+
+// ----------------------------------------------------------------------------
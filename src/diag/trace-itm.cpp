@@ -73,8 +73,14 @@ namespace os
 #define OS_INTEGER_TRACE_ITM_STIMULUS_PORT     (0)
 #endif
 
+#if defined(OS_USE_TRACE_RING_BUFFER)
+      // Called by drain(), write() stores in the ring buffer.
+      ssize_t
+      write_direct (const void* buf, std::size_t nbyte)
+#else
       ssize_t
       write (const void* buf, std::size_t nbyte)
+#endif
       {
         if (buf == nullptr || nbyte == 0)
           {
@@ -0,0 +1,370 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#if defined(TRACE)
+
+#include <cmsis-plus/os-app-config.h>
+
+#if defined(OS_USE_TRACE_RING_BUFFER)
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES)
+#define OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES (1024)
+#endif
+
+#if !defined(OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES)
+#define OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES (64)
+#endif
+
+// A power of 2, so the free running positions stay consistent
+// when they wrap around.
+static_assert(((OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES
+    & (OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES - 1)) == 0)
+    && (OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES >= 64)
+    && (OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES <= 65536),
+    "OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES must be a power of 2");
+static_assert(OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES
+    < OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES,
+    "OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES too large");
+
+namespace os
+{
+  namespace trace
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // The buffer is a sequence of records, each a header word
+      // followed by the payload, padded to a multiple of 4 bytes.
+      // The header has the lap number of its position in the high
+      // half and the payload length in the low half; it is written
+      // last, so a header with the current lap marks a complete record,
+      // and a stale one (from the previous lap) a record still being
+      // written. This way the records need not be cleared on read.
+      //
+      // The positions are free running byte counters; producers
+      // reserve space with a CAS on head_, the single consumer
+      // (drain()) advances tail_.
+
+      constexpr std::size_t size = OS_INTEGER_TRACE_RING_BUFFER_SIZE_BYTES;
+      constexpr std::size_t record_size =
+      OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES;
+
+      uint32_t buffer_[size / sizeof(uint32_t)];
+
+      std::atomic<uint32_t> head_
+        { 0 };
+      std::atomic<uint32_t> tail_
+        { 0 };
+      std::atomic<uint32_t> dropped_
+        { 0 };
+
+      inline uint32_t
+      header (uint32_t pos, std::size_t len)
+      {
+        return (((pos / size) & 0xFFFF) << 16) | static_cast<uint32_t> (len);
+      }
+
+      inline uint32_t*
+      header_at (uint32_t pos)
+      {
+        return &buffer_[(pos % size) / sizeof(uint32_t)];
+      }
+
+      inline bool
+      is_complete (uint32_t pos, uint32_t hdr)
+      {
+        return (hdr >> 16) == ((pos / size) & 0xFFFF);
+      }
+
+      inline std::size_t
+      length (uint32_t hdr)
+      {
+        return hdr & 0xFFFF;
+      }
+
+      inline std::size_t
+      total (std::size_t len)
+      {
+        return sizeof(uint32_t) + ((len + 3) & ~static_cast<std::size_t> (3));
+      }
+
+      // Copy in at most two segments, around the end of the buffer.
+      void
+      copy_in (uint32_t pos, const uint8_t* p, std::size_t n)
+      {
+        uint8_t* b = reinterpret_cast<uint8_t*> (buffer_);
+        std::size_t i = pos % size;
+        std::size_t first = std::min (n, size - i);
+        std::memcpy (b + i, p, first);
+        std::memcpy (b, p + first, n - first);
+      }
+
+      void
+      copy_out (uint8_t* p, uint32_t pos, std::size_t n)
+      {
+        const uint8_t* b = reinterpret_cast<const uint8_t*> (buffer_);
+        std::size_t i = pos % size;
+        std::size_t first = std::min (n, size - i);
+        std::memcpy (p, b + i, first);
+        std::memcpy (p + first, b, n - first);
+      }
+
+#if defined(OS_USE_TRACE_RING_BUFFER_OVERWRITE)
+
+      // Discard the oldest record, if complete.
+      bool
+      discard_oldest (void)
+      {
+        uint32_t t = tail_.load (std::memory_order_acquire);
+        uint32_t hdr = __atomic_load_n (header_at (t), __ATOMIC_ACQUIRE);
+        if (!is_complete (t, hdr))
+          {
+            // Still being written, nothing can be freed.
+            return false;
+          }
+        if (tail_.compare_exchange_strong (
+            t, static_cast<uint32_t> (t + total (length (hdr))),
+            std::memory_order_acq_rel))
+          {
+            dropped_.fetch_add (1, std::memory_order_relaxed);
+          }
+        // If the CAS failed, the consumer or another producer
+        // freed some space meanwhile; retry anyway.
+        return true;
+      }
+
+#endif /* defined(OS_USE_TRACE_RING_BUFFER_OVERWRITE) */
+
+      // Store a single record.
+      bool
+      put (const uint8_t* p, std::size_t len)
+      {
+        std::size_t need = total (len);
+        uint32_t h = head_.load (std::memory_order_relaxed);
+        for (;;)
+          {
+            uint32_t t = tail_.load (std::memory_order_acquire);
+            if (static_cast<uint32_t> (h + need - t) > size)
+              {
+#if defined(OS_USE_TRACE_RING_BUFFER_OVERWRITE)
+                if (discard_oldest ())
+                  {
+                    h = head_.load (std::memory_order_relaxed);
+                    continue;
+                  }
+#endif
+                dropped_.fetch_add (1, std::memory_order_relaxed);
+                return false;
+              }
+            if (head_.compare_exchange_weak (h,
+                                             static_cast<uint32_t> (h + need),
+                                             std::memory_order_relaxed))
+              {
+                break;
+              }
+          }
+
+        copy_in (static_cast<uint32_t> (h + sizeof(uint32_t)), p, len);
+        // Publish the record.
+        __atomic_store_n (header_at (h), header (h, len), __ATOMIC_RELEASE);
+        return true;
+      }
+    }
+
+    /**
+     * @endcond
+     */
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Store the bytes in the trace ring buffer, without calling
+     * the backend; the call never blocks and can be used from any
+     * thread or interrupt. Writes larger than
+     * @ref OS_INTEGER_TRACE_RING_BUFFER_RECORD_SIZE_BYTES are split
+     * into several records.
+     *
+     * When the buffer is full, the new records are dropped, or,
+     * with @ref OS_USE_TRACE_RING_BUFFER_OVERWRITE, the oldest
+     * ones are discarded to make room.
+     */
+    ssize_t
+    write (const void* buf, std::size_t nbyte)
+    {
+      if (buf == nullptr || nbyte == 0)
+        {
+          return 0;
+        }
+
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+      std::size_t count = 0;
+      while (count < nbyte)
+        {
+          std::size_t n = std::min (nbyte - count, record_size);
+          if (!put (p + count, n))
+            {
+              break;
+            }
+          count += n;
+        }
+      return static_cast<ssize_t> (count);
+    }
+
+    /**
+     * @details
+     * Pass the complete records to the backend, via `write_direct()`,
+     * in order, stopping at the first record still being written.
+     * There must be a single caller, usually the idle thread
+     * or a low priority thread.
+     */
+    std::size_t
+    drain (void)
+    {
+      uint8_t chunk[record_size];
+      std::size_t count = 0;
+      for (;;)
+        {
+          uint32_t t = tail_.load (std::memory_order_acquire);
+          uint32_t hdr = __atomic_load_n (header_at (t), __ATOMIC_ACQUIRE);
+          if (t == head_.load (std::memory_order_acquire)
+              || !is_complete (t, hdr))
+            {
+              break;
+            }
+
+          std::size_t len = std::min (length (hdr), record_size);
+          copy_out (chunk, static_cast<uint32_t> (t + sizeof(uint32_t)), len);
+
+          uint32_t next = static_cast<uint32_t> (t + total (length (hdr)));
+#if defined(OS_USE_TRACE_RING_BUFFER_OVERWRITE)
+          if (!tail_.compare_exchange_strong (t, next,
+                                              std::memory_order_acq_rel))
+            {
+              // Overwritten while copying; the copy is not valid.
+              continue;
+            }
+#else
+          tail_.store (next, std::memory_order_release);
+#endif
+
+          write_direct (chunk, len);
+          count += len;
+        }
+      return count;
+    }
+
+    /**
+     * @details
+     * The counter includes the records dropped because the buffer
+     * was full and, in overwrite mode, the discarded old ones.
+     */
+    std::size_t
+    dropped (void)
+    {
+      return dropped_.load (std::memory_order_relaxed);
+    }
+
+    /**
+     * @details
+     * Copy the payload of the newest complete records, not yet
+     * drained, that fit in the buffer, oldest first. The ring
+     * buffer is not changed.
+     */
+    std::size_t
+    snapshot (void* buf, std::size_t nbyte)
+    {
+      uint32_t t = tail_.load (std::memory_order_acquire);
+      uint32_t h = head_.load (std::memory_order_acquire);
+
+      // Find the total payload of the complete records.
+      std::size_t avail = 0;
+      uint32_t end = t;
+      while (end != h && static_cast<uint32_t> (end - t) < size)
+        {
+          uint32_t hdr = __atomic_load_n (header_at (end), __ATOMIC_ACQUIRE);
+          if (!is_complete (end, hdr))
+            {
+              break;
+            }
+          avail += length (hdr);
+          end = static_cast<uint32_t> (end + total (length (hdr)));
+        }
+
+      // Skip the oldest records that do not fit.
+      while (avail > nbyte && t != end)
+        {
+          std::size_t len = length (*header_at (t));
+          avail -= len;
+          t = static_cast<uint32_t> (t + total (len));
+        }
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t count = 0;
+      while (t != end)
+        {
+          std::size_t len = length (*header_at (t));
+          copy_out (p + count, static_cast<uint32_t> (t + sizeof(uint32_t)),
+                    len);
+          count += len;
+          t = static_cast<uint32_t> (t + total (len));
+        }
+      return count;
+    }
+
+    /**
+     * @details
+     * Used when no backend is configured; discards the output.
+     */
+    ssize_t __attribute__((weak))
+    write_direct (const void* buf __attribute__((unused)), std::size_t nbyte)
+    {
+      return static_cast<ssize_t> (nbyte);
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace trace */
+} /* namespace os */
+
+#endif /* defined(OS_USE_TRACE_RING_BUFFER) */
+#endif /* defined(TRACE) */
+
+// ----------------------------------------------------------------------------
@@ -44,17 +44,87 @@
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS)
+#define OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS (1)
+#endif
+
+#if !defined(OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFER_SIZE_BYTES)
+#define OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFER_SIZE_BYTES (BUFFER_SIZE_UP)
+#endif
+
+#if !defined(OS_INTEGER_TRACE_SEGGER_RTT_MODE)
+#define OS_INTEGER_TRACE_SEGGER_RTT_MODE (SEGGER_RTT_MODE_NO_BLOCK_SKIP)
+#endif
+
+static_assert(OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS
+    <= SEGGER_RTT_MAX_NUM_UP_BUFFERS,
+    "OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS too large");
+
 namespace os
 {
   namespace trace
   {
     // --------------------------------------------------------------------
 
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // Channel 0 keeps the buffer allocated by the SEGGER code;
+      // the other channels use these buffers.
+#if OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS > 1
+      char buffers_[OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS - 1] //
+      [OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFER_SIZE_BYTES];
+#endif
+
+      std::size_t volatile dropped_bytes_;
+
+#if defined(OS_USE_TRACE_SEGGER_RTT_OVERWRITE)
+
+      // Make room for nbyte, by discarding the oldest bytes.
+      // Must be called in a critical section.
+      void
+      make_room (SEGGER_RTT_BUFFER_UP* up, std::size_t nbyte)
+      {
+        unsigned size = up->SizeOfBuffer;
+        unsigned wr = up->WrOff;
+        unsigned rd = up->RdOff;
+        unsigned avail = (rd > wr) ? (rd - wr - 1) : (size - 1 - (wr - rd));
+        if (avail < nbyte)
+          {
+            unsigned need = static_cast<unsigned> (nbyte) - avail;
+            up->RdOff = (rd + need) % size;
+            dropped_bytes_ += need;
+          }
+      }
+
+#endif /* defined(OS_USE_TRACE_SEGGER_RTT_OVERWRITE) */
+    }
+
+    /**
+     * @endcond
+     */
+
+    // --------------------------------------------------------------------
+
     void
     initialize (void)
     {
       SEGGER_RTT_Init ();
 
+      SEGGER_RTT_SetFlagsUpBuffer (0, OS_INTEGER_TRACE_SEGGER_RTT_MODE);
+
+#if OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS > 1
+      for (unsigned i = 1; i < OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS; ++i)
+        {
+          SEGGER_RTT_ConfigUpBuffer (i, "Trace", buffers_[i - 1],
+                                     sizeof(buffers_[i - 1]),
+                                     OS_INTEGER_TRACE_SEGGER_RTT_MODE);
+        }
+#endif
+
       // Clear the SLEEPDEEP.
       // This does not guarantee that the WFI will not prevent
       // the J-Link to read the RTT buffer, but it is the best it
@@ -64,34 +134,87 @@ namespace os
 
     // --------------------------------------------------------------------
 
+    /**
+     * @details
+     * Never waits for the host, unless the mode is
+     * `SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL`. When the buffer is
+     * full, the new bytes are dropped, or, with
+     * @ref OS_USE_TRACE_SEGGER_RTT_OVERWRITE, the oldest ones;
+     * either way they are counted by `dropped_bytes()`.
+     */
     ssize_t
-    write (const void* buf, std::size_t nbyte)
+    write_channel (std::size_t channel, const void* buf, std::size_t nbyte)
     {
       if (buf == nullptr || nbyte == 0)
         {
           return 0;
         }
 
-      if (nbyte > BUFFER_SIZE_UP)
+      if (channel >= OS_INTEGER_TRACE_SEGGER_RTT_UP_BUFFERS)
         {
-          return 0;
+          channel = 0;
         }
 
-      ssize_t ret;
+      const char* p = static_cast<const char*> (buf);
+      std::size_t count = nbyte;
 
+      // ----- Enter critical section -----------------------------------
       rtos::interrupts::critical_section ics;
-      ret = (ssize_t) SEGGER_RTT_WriteNoLock (0, buf, nbyte);
 
-      return ret;
+#if defined(OS_USE_TRACE_SEGGER_RTT_OVERWRITE)
+      SEGGER_RTT_BUFFER_UP* up = &_SEGGER_RTT.aUp[channel];
+      if (count > up->SizeOfBuffer - 1)
+        {
+          // Keep only the most recent bytes.
+          std::size_t skip = count - (up->SizeOfBuffer - 1);
+          dropped_bytes_ += skip;
+          p += skip;
+          count -= skip;
+        }
+      make_room (up, count);
+#endif
+
+      std::size_t written = SEGGER_RTT_WriteNoLock (
+          static_cast<unsigned> (channel), p, static_cast<unsigned> (count));
+      dropped_bytes_ += count - written;
+
+      return static_cast<ssize_t> (written);
+      // ----- Exit critical section ------------------------------------
+    }
+
+#if defined(OS_USE_TRACE_RING_BUFFER)
+    // Called by drain(), write() stores in the ring buffer.
+    ssize_t
+    write_direct (const void* buf, std::size_t nbyte)
+#else
+    ssize_t
+    write (const void* buf, std::size_t nbyte)
+#endif
+    {
+      return write_channel (0, buf, nbyte);
+    }
+
+    std::size_t
+    dropped_bytes (void)
+    {
+      return dropped_bytes_;
     }
 
+    /**
+     * @details
+     * Wait for the host to read channel 0, but only in the
+     * blocking mode; otherwise a detached debugger would stall
+     * the application.
+     */
     void
     flush (void)
     {
+#if (OS_INTEGER_TRACE_SEGGER_RTT_MODE == SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL)
       while (_SEGGER_RTT.aUp[0].WrOff != _SEGGER_RTT.aUp[0].RdOff)
         {
           __NOP ();
         }
+#endif
     }
 
   } /* namespace trace */
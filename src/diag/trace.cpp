@@ -29,6 +29,7 @@
 
 #include <cmsis-plus/os-app-config.h>
 #include <cmsis-plus/diag/trace.h>
+#include <cmsis-plus/diag/format.h>
 
 #include <cstdarg>
 #include <cstdio>
@@ -38,6 +39,14 @@
 #define OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE (200)
 #endif
 
+#ifndef OS_INTEGER_TRACE_CHANNELS_ERROR_MASK
+#define OS_INTEGER_TRACE_CHANNELS_ERROR_MASK (0xFFFFFFFF)
+#endif
+
+#ifndef OS_INTEGER_TRACE_BINARY_MAX_WORDS
+#define OS_INTEGER_TRACE_BINARY_MAX_WORDS (16)
+#endif
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -68,6 +77,19 @@ namespace os
       ;
     }
 
+    ssize_t __attribute__((weak))
+    write_channel (std::size_t channel __attribute__((unused)),
+                   const void* buf, std::size_t nbyte)
+    {
+      return write (buf, nbyte);
+    }
+
+    std::size_t __attribute__((weak))
+    dropped_bytes (void)
+    {
+      return 0;
+    }
+
     // ----------------------------------------------------------------------
 
     int __attribute__((weak))
@@ -82,14 +104,88 @@ namespace os
       return ret;
     }
 
+#if !defined(OS_USE_TRACE_PRINTF_LIBC)
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      struct printf_buffer
+      {
+        std::size_t len;
+        bool failed;
+        char buf[OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE];
+      };
+
+      void
+      printf_flush (printf_buffer* pb)
+      {
+        if (pb->len > 0 && write (pb->buf, pb->len) < 0)
+          {
+            pb->failed = true;
+          }
+        pb->len = 0;
+      }
+
+      ssize_t
+      printf_sink (void* ctx, const char* buf, std::size_t nbyte)
+      {
+        printf_buffer* pb = static_cast<printf_buffer*> (ctx);
+        for (std::size_t i = 0; i < nbyte; ++i)
+          {
+            if (pb->len == sizeof(pb->buf))
+              {
+                printf_flush (pb);
+              }
+            pb->buf[pb->len++] = buf[i];
+          }
+        return pb->failed ? -1 : static_cast<ssize_t> (nbyte);
+      }
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+#endif /* !defined(OS_USE_TRACE_PRINTF_LIBC) */
+
+    /**
+     * @details
+     * The message is formatted by `os::format::vprint()` into a
+     * buffer of `OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE` bytes on
+     * the stack, passed to `write()` when full and at the end, so
+     * longer messages are not truncated, and most messages are
+     * written in a single call. With `OS_USE_TRACE_PRINTF_LIBC`,
+     * the library `vsnprintf()` is used, and the messages are
+     * truncated to the buffer size.
+     */
     int __attribute__((weak))
     vprintf (const char* format, std::va_list args)
     {
+#if !defined(OS_USE_TRACE_PRINTF_LIBC)
+
       // Caution: allocated on the stack!
-      char buf[OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE];
+      printf_buffer pb;
+      pb.len = 0;
+      pb.failed = false;
+
+      int ret = format::vprint (printf_sink, &pb, format, args);
+      if (ret >= 0)
+        {
+          printf_flush (&pb);
+          if (pb.failed)
+            {
+              ret = -1;
+            }
+        }
+      return ret;
 
-      // TODO: possibly rewrite it to no longer use newlib,
-      // (although the nano version is no longer very heavy).
+#else
+
+      // Caution: allocated on the stack!
+      char buf[OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE];
 
       // Print to the local buffer
 #pragma GCC diagnostic push
@@ -102,6 +198,8 @@ namespace os
           ret = static_cast<int> (write (buf, static_cast<size_t> (ret)));
         }
       return ret;
+
+#endif /* !defined(OS_USE_TRACE_PRINTF_LIBC) */
     }
 
     int __attribute__((weak))
@@ -136,6 +234,76 @@ namespace os
         }
     }
 
+#if defined(OS_USE_TRACE_CHANNELS)
+
+    // Only the errors are written by default.
+    uint32_t volatile channels_masks_[levels] =
+      { OS_INTEGER_TRACE_CHANNELS_ERROR_MASK, 0, 0, 0 };
+
+    /**
+     * @details
+     * The masks are updated one by one, so a message racing with
+     * the change may be written with either setting.
+     */
+    void
+    enable (uint32_t channels, level lvl)
+    {
+      for (std::size_t i = 0; i < levels; ++i)
+        {
+          if (i <= static_cast<std::size_t> (lvl))
+            {
+              channels_masks_[i] |= channels;
+            }
+          else
+            {
+              channels_masks_[i] &= ~channels;
+            }
+        }
+    }
+
+    void
+    disable (uint32_t channels)
+    {
+      for (std::size_t i = 0; i < levels; ++i)
+        {
+          channels_masks_[i] &= ~channels;
+        }
+    }
+
+#else
+
+    void
+    enable (uint32_t channels __attribute__((unused)),
+            level lvl __attribute__((unused)))
+    {
+    }
+
+    void
+    disable (uint32_t channels __attribute__((unused)))
+    {
+    }
+
+#endif /* defined(OS_USE_TRACE_CHANNELS) */
+
+    ssize_t __attribute__((weak))
+    write_binary (const char* format, const uint32_t* args,
+                  std::size_t nwords)
+    {
+      // Caution: allocated on the stack!
+      uint32_t buf[OS_INTEGER_TRACE_BINARY_MAX_WORDS + 2];
+
+      if (nwords > OS_INTEGER_TRACE_BINARY_MAX_WORDS)
+        {
+          nwords = OS_INTEGER_TRACE_BINARY_MAX_WORDS;
+        }
+
+      buf[0] = (0xB7u << 24) | static_cast<uint32_t> (nwords);
+      buf[1] = static_cast<uint32_t> (reinterpret_cast<uintptr_t> (format));
+      std::memcpy (&buf[2], args, nwords * sizeof(uint32_t));
+
+      return write (buf, (nwords + 2) * sizeof(uint32_t));
+    }
+
     void __attribute__((weak))
     dump_args (int argc, char* argv[])
     {
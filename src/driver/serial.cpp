@@ -35,6 +35,7 @@
 #include <cmsis-plus/diag/trace.h>
 
 #include <cassert>
+#include <sys/uio.h>
 
 // ----------------------------------------------------------------------------
 
@@ -95,6 +96,8 @@ namespace os
         {
           return RETURN_OK;
         }
+      sg_tx_done_ = 0;
+      sg_rx_done_ = 0;
       return do_send (data, num);
     }
 
@@ -106,6 +109,8 @@ namespace os
         {
           return RETURN_OK;
         }
+      sg_tx_done_ = 0;
+      sg_rx_done_ = 0;
       return do_receive (data, num);
     }
 
@@ -118,9 +123,145 @@ namespace os
         {
           return RETURN_OK;
         }
+      sg_tx_done_ = 0;
+      sg_rx_done_ = 0;
       return do_transfer (data_out, data_in, num);
     }
 
+    return_t
+    Serial::transfer_sg (const struct iovec* out, const struct iovec* in,
+                         std::size_t count) noexcept
+    {
+      assert (out != nullptr || in != nullptr);
+      if (count == 0)
+        {
+          return RETURN_OK;
+        }
+      if (sg_count_ != 0)
+        {
+          return ERROR_BUSY;
+        }
+      if (out != nullptr && in != nullptr)
+        {
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              if (out[i].iov_len != in[i].iov_len)
+                {
+                  return ERROR_PARAMETER;
+                }
+            }
+        }
+      sg_tx_done_ = 0;
+      sg_rx_done_ = 0;
+      return do_transfer_sg (out, in, count);
+    }
+
+    // ----------------------------------------------------------------------
+
+    /**
+     * @details
+     * Segments are started one at a time; each completion event
+     * starts the next one, and only the last is forwarded.
+     */
+    return_t
+    Serial::do_transfer_sg (const struct iovec* out, const struct iovec* in,
+                            std::size_t count) noexcept
+    {
+      sg_out_ = out;
+      sg_in_ = in;
+      sg_index_ = 0;
+      // Skip the empty segments at the end.
+      while (count > 0
+          && (out != nullptr ? out[count - 1].iov_len : in[count - 1].iov_len)
+              == 0)
+        {
+          --count;
+        }
+      if (count == 0)
+        {
+          return RETURN_OK;
+        }
+      sg_count_ = count;
+
+      return_t ret = sg_start_ ();
+      if (ret != RETURN_OK)
+        {
+          sg_count_ = 0;
+        }
+      return ret;
+    }
+
+    return_t
+    Serial::sg_start_ (void) noexcept
+    {
+      // Skip the empty segments; the last one is not empty.
+      std::size_t i = sg_index_;
+      while ((sg_out_ != nullptr ? sg_out_[i].iov_len : sg_in_[i].iov_len)
+          == 0)
+        {
+          ++i;
+        }
+      sg_index_ = i;
+
+      if (sg_in_ == nullptr)
+        {
+          return do_send (sg_out_[i].iov_base, sg_out_[i].iov_len);
+        }
+      else if (sg_out_ == nullptr)
+        {
+          return do_receive (sg_in_[i].iov_base, sg_in_[i].iov_len);
+        }
+      return do_transfer (sg_out_[i].iov_base, sg_in_[i].iov_base,
+                          sg_in_[i].iov_len);
+    }
+
+    event_t
+    Serial::sg_next_ (event_t event) noexcept
+    {
+      event_t done;
+      if (sg_in_ == nullptr)
+        {
+          done = serial::Event::send_complete;
+        }
+      else if (sg_out_ == nullptr)
+        {
+          done = serial::Event::receive_complete;
+        }
+      else
+        {
+          done = serial::Event::transfer_complete;
+        }
+
+      if ((event & done) == 0)
+        {
+          // Not the end of a segment.
+          return event;
+        }
+
+      std::size_t i = sg_index_;
+      std::size_t len =
+          (sg_out_ != nullptr) ? sg_out_[i].iov_len : sg_in_[i].iov_len;
+      if (i + 1 < sg_count_)
+        {
+          sg_tx_done_ += (sg_out_ != nullptr) ? len : 0;
+          sg_rx_done_ += (sg_in_ != nullptr) ? len : 0;
+
+          sg_index_ = i + 1;
+          if (sg_start_ () == RETURN_OK)
+            {
+              return event & ~done;
+            }
+
+          // The driver still reports the counts of this segment.
+          sg_tx_done_ -= (sg_out_ != nullptr) ? len : 0;
+          sg_rx_done_ -= (sg_in_ != nullptr) ? len : 0;
+        }
+
+      // After the last segment, or if the next one failed to start.
+      sg_count_ = 0;
+      return event;
+    }
+
   } /* namespace driver */
 } /* namespace os */
 
@@ -32,6 +32,7 @@
  */
 
 #include <cmsis-plus/driver/usb-device.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <cassert>
 
@@ -54,6 +55,15 @@ namespace os
 
         cb_endpoint_func_ = nullptr;
         cb_endpoint_object_ = nullptr;
+
+        cb_transfers_func_ = nullptr;
+        cb_transfers_object_ = nullptr;
+
+        for (auto& q : queues_)
+          {
+            q.head = q.tail = nullptr;
+            q.active = 0;
+          }
       }
 
       Device::~Device () noexcept
@@ -77,6 +87,14 @@ namespace os
         cb_endpoint_object_ = cb_object;
       }
 
+      void
+      Device::register_transfers_callback (device::signal_transfers_t cb_func,
+                                           const void* cb_object) noexcept
+      {
+        cb_transfers_func_ = cb_func;
+        cb_transfers_object_ = cb_object;
+      }
+
       // ----------------------------------------------------------------------
 
       return_t
@@ -99,6 +117,104 @@ namespace os
 
       // ----------------------------------------------------------------------
 
+      return_t
+      Device::queue_transfer (endpoint_t ep_addr,
+                              device::Transfer* xfer) noexcept
+      {
+        assert (xfer != nullptr);
+        assert (xfer->data != nullptr);
+
+        xfer->count = 0;
+        xfer->status = RETURN_OK;
+        xfer->next = nullptr;
+
+        Queue& q = queue_ (ep_addr);
+
+        // ----- Enter critical section ---------------------------------------
+        rtos::interrupts::critical_section ics;
+
+        if (q.tail != nullptr)
+          {
+            q.tail->next = xfer;
+          }
+        else
+          {
+            q.head = xfer;
+          }
+        q.tail = xfer;
+
+        start_queued_ (ep_addr, q);
+
+        return RETURN_OK;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      return_t
+      Device::abort_queued_transfers (endpoint_t ep_addr) noexcept
+      {
+        Queue& q = queue_ (ep_addr);
+
+        device::Transfer* done;
+        return_t ret;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            ret = do_abort_transfer (ep_addr);
+
+            done = q.head;
+            q.head = q.tail = nullptr;
+            q.active = 0;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        for (device::Transfer* p = done; p != nullptr; p = p->next)
+          {
+            p->status = ERROR;
+          }
+        if (done != nullptr && cb_transfers_func_ != nullptr)
+          {
+            cb_transfers_func_ (cb_transfers_object_, ep_addr, done);
+          }
+        return ret;
+      }
+
+      Device::Queue&
+      Device::queue_ (endpoint_t ep_addr) noexcept
+      {
+        std::size_t n = (ep_addr & ENDPOINT_NUMBER_MASK);
+        assert (n < device::max_endpoints);
+
+        return queues_[n * 2
+            + (((ep_addr & ENDPOINT_DIRECTION_MASK) != 0) ? 1 : 0)];
+      }
+
+      // Called with interrupts disabled.
+      void
+      Device::start_queued_ (endpoint_t ep_addr, Queue& q) noexcept
+      {
+        std::size_t depth = do_get_capabilities ().double_buffering ? 2 : 1;
+
+        device::Transfer* p = q.head;
+        for (std::size_t i = 0; i < q.active && p != nullptr; ++i)
+          {
+            p = p->next;
+          }
+
+        for (; p != nullptr && q.active < depth; p = p->next)
+          {
+            p->status = do_transfer (ep_addr, p->data, p->num);
+            if (p->status != RETURN_OK)
+              {
+                // Not accepted; retried on the next completion.
+                break;
+              }
+            ++q.active;
+          }
+      }
+
+      // ----------------------------------------------------------------------
+
       void
       Device::signal_device_event (event_t event) noexcept
       {
@@ -109,9 +225,58 @@ namespace os
           }
       }
 
+      /**
+       * @details
+       * The completion of a queued transfer starts the next one,
+       * then reports it via the transfers callback; the `in`/`out`
+       * events of endpoints without queued transfers are forwarded
+       * to the endpoint callback.
+       */
       void
       Device::signal_endpoint_event (endpoint_t ep_addr, event_t event) noexcept
       {
+        if ((event & (device::Endpoint_event::in | device::Endpoint_event::out))
+            && ((ep_addr & ENDPOINT_NUMBER_MASK) < device::max_endpoints))
+          {
+            Queue& q = queue_ (ep_addr);
+            device::Transfer* done = nullptr;
+              {
+                // ----- Enter critical section -------------------------------
+                rtos::interrupts::critical_section ics;
+
+                if (q.active > 0)
+                  {
+                    done = q.head;
+                    done->count = do_get_transfer_count (ep_addr);
+                    q.head = done->next;
+                    if (q.head == nullptr)
+                      {
+                        q.tail = nullptr;
+                      }
+                    done->next = nullptr;
+                    --q.active;
+
+                    // Keep the endpoint busy before notifying.
+                    start_queued_ (ep_addr, q);
+                  }
+                // ----- Exit critical section --------------------------------
+              }
+
+            if (done != nullptr)
+              {
+                if (cb_transfers_func_ != nullptr)
+                  {
+                    cb_transfers_func_ (cb_transfers_object_, ep_addr, done);
+                  }
+                event &= ~static_cast<event_t> (device::Endpoint_event::in
+                    | device::Endpoint_event::out);
+                if (event == 0)
+                  {
+                    return;
+                  }
+              }
+          }
+
         if (cb_endpoint_func_ != nullptr)
           {
             // Forward event to registered callback.
@@ -32,6 +32,7 @@
  */
 
 #include <cmsis-plus/driver/usb-host.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <cassert>
 
@@ -54,6 +55,16 @@ namespace os
 
         cb_pipe_func_ = nullptr;
         cb_pipe_object_ = nullptr;
+
+        cb_transfers_func_ = nullptr;
+        cb_transfers_object_ = nullptr;
+
+        for (auto& q : queues_)
+          {
+            q.pipe = 0;
+            q.head = q.tail = nullptr;
+            q.active = 0;
+          }
       }
 
       Host::~Host () noexcept
@@ -77,6 +88,14 @@ namespace os
         cb_pipe_object_ = cb_object;
       }
 
+      void
+      Host::register_transfers_callback (host::signal_transfers_t cb_func,
+                                         const void* cb_object) noexcept
+      {
+        cb_transfers_func_ = cb_func;
+        cb_transfers_object_ = cb_object;
+      }
+
       // ----------------------------------------------------------------------
 
       return_t
@@ -91,6 +110,145 @@ namespace os
         return do_transfer (pipe, packet, data, num);
       }
 
+      /**
+       * @details
+       * The queued transfers are returned first, so the buffers are
+       * no longer used by the controller.
+       */
+      return_t
+      Host::delete_pipe (pipe_t pipe) noexcept
+      {
+        abort_queued_transfers (pipe);
+
+        return do_delete_pipe (pipe);
+      }
+
+      // ----------------------------------------------------------------------
+
+      return_t
+      Host::queue_transfers (pipe_t pipe, host::Transfer* xfers) noexcept
+      {
+        assert (xfers != nullptr);
+
+        host::Transfer* last = xfers;
+        for (host::Transfer* p = xfers; p != nullptr; p = p->next)
+          {
+            assert (p->data != nullptr);
+
+            p->count = 0;
+            p->status = RETURN_OK;
+            last = p;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        rtos::interrupts::critical_section ics;
+
+        Queue* q = queue_ (pipe, true);
+        if (q == nullptr)
+          {
+            return ERROR_BUSY;
+          }
+
+        if (q->tail != nullptr)
+          {
+            q->tail->next = xfers;
+          }
+        else
+          {
+            q->head = xfers;
+          }
+        q->tail = last;
+
+        start_queued_ (pipe, *q);
+
+        return RETURN_OK;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      return_t
+      Host::abort_queued_transfers (pipe_t pipe) noexcept
+      {
+        host::Transfer* done = nullptr;
+        return_t ret = RETURN_OK;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            Queue* q = queue_ (pipe, false);
+            if (q != nullptr)
+              {
+                if (q->active > 0)
+                  {
+                    ret = do_abort_transfer (pipe);
+                  }
+
+                done = q->head;
+                q->head = q->tail = nullptr;
+                q->active = 0;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        for (host::Transfer* p = done; p != nullptr; p = p->next)
+          {
+            p->status = ERROR;
+          }
+        if (done != nullptr && cb_transfers_func_ != nullptr)
+          {
+            cb_transfers_func_ (cb_transfers_object_, pipe, done);
+          }
+        return ret;
+      }
+
+      // Called with interrupts disabled. The pipe handles are opaque,
+      // so the queues are searched; a queue is free when empty.
+      Host::Queue*
+      Host::queue_ (pipe_t pipe, bool create) noexcept
+      {
+        Queue* slot = nullptr;
+        for (auto& q : queues_)
+          {
+            if ((q.head != nullptr) && (q.pipe == pipe))
+              {
+                return &q;
+              }
+            if (create && (q.head == nullptr) && (slot == nullptr))
+              {
+                slot = &q;
+              }
+          }
+        if (slot != nullptr)
+          {
+            slot->pipe = pipe;
+            slot->active = 0;
+          }
+        return slot;
+      }
+
+      // Called with interrupts disabled.
+      void
+      Host::start_queued_ (pipe_t pipe, Queue& q) noexcept
+      {
+        std::size_t depth = do_get_capabilities ().chained_transfers ? 2 : 1;
+
+        host::Transfer* p = q.head;
+        for (std::size_t i = 0; i < q.active && p != nullptr; ++i)
+          {
+            p = p->next;
+          }
+
+        for (; p != nullptr && q.active < depth; p = p->next)
+          {
+            p->status = do_transfer (pipe, p->packet, p->data, p->num);
+            if (p->status != RETURN_OK)
+              {
+                // Not accepted; retried on the next completion.
+                break;
+              }
+            ++q.active;
+          }
+      }
+
       // ----------------------------------------------------------------------
 
       void
@@ -103,9 +261,83 @@ namespace os
           }
       }
 
+      /**
+       * @details
+       * The completion of a queued transfer starts the next one,
+       * then reports it via the transfers callback. A STALL or an
+       * error ends the queue: the failed transfer and the pending ones
+       * are returned with `status` set to `ERROR`, and the event is
+       * also forwarded to the pipe callback, to recover the pipe.
+       * The events of pipes without queued transfers are forwarded
+       * to the pipe callback.
+       */
       void
       Host::signal_pipe_event (pipe_t pipe, event_t event) noexcept
       {
+        constexpr event_t failed = host::Pipe_event::handshake_stall
+            | host::Pipe_event::handshake_err | host::Pipe_event::bus_err;
+
+        if (event & (host::Pipe_event::transfer_complete | failed))
+          {
+            host::Transfer* done = nullptr;
+              {
+                // ----- Enter critical section -------------------------------
+                rtos::interrupts::critical_section ics;
+
+                Queue* q = queue_ (pipe, false);
+                if (q != nullptr && q->active > 0)
+                  {
+                    done = q->head;
+                    done->count = do_get_transfer_count (pipe);
+                    if (event & failed)
+                      {
+                        if (q->active > 1)
+                          {
+                            do_abort_transfer (pipe);
+                          }
+                        // Return all, the stream is broken.
+                        q->head = q->tail = nullptr;
+                        q->active = 0;
+                      }
+                    else
+                      {
+                        q->head = done->next;
+                        if (q->head == nullptr)
+                          {
+                            q->tail = nullptr;
+                          }
+                        done->next = nullptr;
+                        --q->active;
+
+                        // Keep the pipe busy before notifying.
+                        start_queued_ (pipe, *q);
+                      }
+                  }
+                // ----- Exit critical section --------------------------------
+              }
+
+            if (done != nullptr)
+              {
+                if (event & failed)
+                  {
+                    for (host::Transfer* p = done; p != nullptr; p = p->next)
+                      {
+                        p->status = ERROR;
+                      }
+                  }
+                if (cb_transfers_func_ != nullptr)
+                  {
+                    cb_transfers_func_ (cb_transfers_object_, pipe, done);
+                  }
+                event &= ~static_cast<event_t> (
+                    host::Pipe_event::transfer_complete);
+                if (event == 0)
+                  {
+                    return;
+                  }
+              }
+          }
+
         if (cb_pipe_func_ != nullptr)
           {
             // Forward event to registered callback.
@@ -0,0 +1,663 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/driver/usb-msc-device.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cassert>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace driver
+  {
+    namespace usb
+    {
+      // ----------------------------------------------------------------------
+
+      namespace
+      {
+        constexpr uint32_t cbw_signature = 0x43425355; // "USBC"
+        constexpr uint32_t csw_signature = 0x53425355; // "USBS"
+
+        constexpr std::size_t cbw_size = 31;
+        constexpr std::size_t csw_size = 13;
+
+        // CSW status.
+        constexpr uint8_t status_passed = 0;
+        constexpr uint8_t status_failed = 1;
+        constexpr uint8_t status_phase_error = 2;
+
+        // SCSI operation codes.
+        constexpr uint8_t scsi_test_unit_ready = 0x00;
+        constexpr uint8_t scsi_request_sense = 0x03;
+        constexpr uint8_t scsi_inquiry = 0x12;
+        constexpr uint8_t scsi_mode_sense_6 = 0x1A;
+        constexpr uint8_t scsi_start_stop_unit = 0x1B;
+        constexpr uint8_t scsi_prevent_allow_removal = 0x1E;
+        constexpr uint8_t scsi_read_format_capacities = 0x23;
+        constexpr uint8_t scsi_read_capacity_10 = 0x25;
+        constexpr uint8_t scsi_read_10 = 0x28;
+        constexpr uint8_t scsi_write_10 = 0x2A;
+        constexpr uint8_t scsi_verify_10 = 0x2F;
+        constexpr uint8_t scsi_synchronize_cache_10 = 0x35;
+
+        // Sense keys and additional sense codes.
+        constexpr uint8_t sense_not_ready = 0x02;
+        constexpr uint8_t sense_medium_error = 0x03;
+        constexpr uint8_t sense_illegal_request = 0x05;
+
+        constexpr uint8_t asc_write_fault = 0x03;
+        constexpr uint8_t asc_unrecovered_read_error = 0x11;
+        constexpr uint8_t asc_invalid_command = 0x20;
+        constexpr uint8_t asc_lba_out_of_range = 0x21;
+        constexpr uint8_t asc_medium_not_present = 0x3A;
+
+        inline uint32_t
+        get_le32 (const uint8_t* p)
+        {
+          return static_cast<uint32_t> (p[0])
+              | (static_cast<uint32_t> (p[1]) << 8)
+              | (static_cast<uint32_t> (p[2]) << 16)
+              | (static_cast<uint32_t> (p[3]) << 24);
+        }
+
+        inline void
+        put_le32 (uint8_t* p, uint32_t v)
+        {
+          p[0] = static_cast<uint8_t> (v);
+          p[1] = static_cast<uint8_t> (v >> 8);
+          p[2] = static_cast<uint8_t> (v >> 16);
+          p[3] = static_cast<uint8_t> (v >> 24);
+        }
+
+        inline uint32_t
+        get_be32 (const uint8_t* p)
+        {
+          return (static_cast<uint32_t> (p[0]) << 24)
+              | (static_cast<uint32_t> (p[1]) << 16)
+              | (static_cast<uint32_t> (p[2]) << 8)
+              | static_cast<uint32_t> (p[3]);
+        }
+
+        inline void
+        put_be32 (uint8_t* p, uint32_t v)
+        {
+          p[0] = static_cast<uint8_t> (v >> 24);
+          p[1] = static_cast<uint8_t> (v >> 16);
+          p[2] = static_cast<uint8_t> (v >> 8);
+          p[3] = static_cast<uint8_t> (v);
+        }
+
+        // Space padded, not terminated.
+        inline void
+        put_string (uint8_t* p, const char* s, std::size_t n)
+        {
+          std::size_t len = std::strlen (s);
+          for (std::size_t i = 0; i < n; ++i)
+            {
+              p[i] = (i < len) ? static_cast<uint8_t> (s[i]) : ' ';
+            }
+        }
+      }
+
+      // ----------------------------------------------------------------------
+
+      Msc_device::Msc_device (Device& device, posix::block_device& storage,
+                              endpoint_t ep_in, endpoint_t ep_out,
+                              void* buffer, std::size_t buffer_bytes) noexcept :
+          device_ (device), //
+          storage_ (storage), //
+          ep_in_ (ep_in), //
+          ep_out_ (ep_out), //
+          buffer_ (static_cast<uint8_t*> (buffer)), //
+          buffer_bytes_ (buffer_bytes)
+      {
+        trace::printf ("%s() %p\n", __func__, this);
+
+        assert (buffer != nullptr);
+
+        for (auto& s : slots_)
+          {
+            s.busy = false;
+            s.blocks = 0;
+            s.xfer.args = &s;
+          }
+        cmd_slot_.busy = false;
+        cmd_slot_.blocks = 0;
+        cmd_slot_.xfer.args = &cmd_slot_;
+
+        device_.register_transfers_callback (signal_transfers, this);
+      }
+
+      Msc_device::~Msc_device () noexcept
+      {
+        trace::printf ("%s() %p\n", __func__, this);
+
+        device_.register_transfers_callback (nullptr, nullptr);
+      }
+
+      // ----------------------------------------------------------------------
+
+      void
+      Msc_device::identification (const char* vendor, const char* product,
+                                  const char* revision) noexcept
+      {
+        vendor_ = vendor;
+        product_ = product;
+        revision_ = revision;
+      }
+
+      return_t
+      Msc_device::configure (packet_size_t max_packet_size) noexcept
+      {
+        return_t ret = device_.configure_endpoint (ep_in_, Endpoint_type::bulk,
+                                                   max_packet_size);
+        if (ret != RETURN_OK)
+          {
+            return ret;
+          }
+        return device_.configure_endpoint (ep_out_, Endpoint_type::bulk,
+                                           max_packet_size);
+      }
+
+      void
+      Msc_device::stop (void) noexcept
+      {
+        stopped_ = true;
+        abort_ ();
+        completed_.post ();
+      }
+
+      void
+      Msc_device::reset (void) noexcept
+      {
+        reset_ = true;
+        abort_ ();
+        completed_.post ();
+      }
+
+      /**
+       * @details
+       * Called from the endpoint interrupt; it only marks the
+       * transfers as done and wakes `run()`.
+       */
+      void
+      Msc_device::signal_transfers (const void* object,
+                                    endpoint_t ep_addr __attribute__((unused)),
+                                    device::Transfer* done) noexcept
+      {
+        Msc_device* self =
+            static_cast<Msc_device*> (const_cast<void*> (object));
+
+        for (device::Transfer* p = done; p != nullptr; p = p->next)
+          {
+            static_cast<Slot*> (p->args)->busy = false;
+          }
+        self->completed_.post ();
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * Each iteration receives a command block, executes the
+       * command, with its data stage, and sends the status.
+       * After a reset, the command in progress is dropped.
+       */
+      return_t
+      Msc_device::run (void) noexcept
+      {
+        std::size_t bs = storage_.block_logical_size_bytes ();
+        if ((bs == 0) || (buffer_bytes_ < 2 * bs))
+          {
+            trace::printf ("%s() %p no storage\n", __func__, this);
+            return ERROR;
+          }
+
+        stopped_ = false;
+
+        while (!stopped_)
+          {
+            reset_ = false;
+
+            Command cmd;
+            if (!receive_command_ (cmd))
+              {
+                continue;
+              }
+
+            uint32_t residue = 0;
+            uint8_t status = execute_ (cmd, &residue);
+            if (reset_ || stopped_)
+              {
+                continue;
+              }
+
+            send_status_ (cmd.tag, residue, status);
+          }
+
+        abort_ ();
+
+        return RETURN_OK;
+      }
+
+      // ----------------------------------------------------------------------
+
+      bool
+      Msc_device::queue_ (Slot& slot, endpoint_t ep_addr, uint8_t* data,
+                          std::size_t num) noexcept
+      {
+        slot.xfer.data = data;
+        slot.xfer.num = num;
+        slot.busy = true;
+        if (device_.queue_transfer (ep_addr, &slot.xfer) != RETURN_OK)
+          {
+            slot.busy = false;
+            return false;
+          }
+        return true;
+      }
+
+      // Returns false after a reset or stop.
+      bool
+      Msc_device::wait_ (Slot& slot) noexcept
+      {
+        while (slot.busy)
+          {
+            if (reset_ || stopped_)
+              {
+                return false;
+              }
+            completed_.wait ();
+          }
+        return !(reset_ || stopped_);
+      }
+
+      void
+      Msc_device::abort_ (void) noexcept
+      {
+        device_.abort_queued_transfers (ep_in_);
+        device_.abort_queued_transfers (ep_out_);
+      }
+
+      bool
+      Msc_device::receive_command_ (Command& cmd) noexcept
+      {
+        if (!queue_ (cmd_slot_, ep_out_, cmd_buffer_, cbw_size))
+          {
+            // The device is not ready; wait for a reset or stop.
+            completed_.wait ();
+            return false;
+          }
+        if (!wait_ (cmd_slot_))
+          {
+            return false;
+          }
+
+        const uint8_t* p = cmd_buffer_;
+        if ((cmd_slot_.xfer.count != cbw_size)
+            || (get_le32 (p) != cbw_signature))
+          {
+            // Not a valid command block; stall both endpoints, until
+            // the host issues a reset.
+            device_.stall_endpoint (ep_in_, true);
+            device_.stall_endpoint (ep_out_, true);
+            while (!(reset_ || stopped_))
+              {
+                completed_.wait ();
+              }
+            return false;
+          }
+
+        cmd.tag = get_le32 (p + 4);
+        cmd.length = get_le32 (p + 8);
+        cmd.data_in = ((p[12] & 0x80) != 0);
+        std::memcpy (cmd.cb, p + 15, sizeof(cmd.cb));
+
+        return true;
+      }
+
+      void
+      Msc_device::send_status_ (uint32_t tag, uint32_t residue,
+                                uint8_t status) noexcept
+      {
+        uint8_t* p = cmd_buffer_;
+        put_le32 (p, csw_signature);
+        put_le32 (p + 4, tag);
+        put_le32 (p + 8, residue);
+        p[12] = status;
+
+        if (queue_ (cmd_slot_, ep_in_, p, csw_size))
+          {
+            wait_ (cmd_slot_);
+          }
+      }
+
+      uint8_t
+      Msc_device::fail_ (uint8_t key, uint8_t asc) noexcept
+      {
+        sense_key_ = key;
+        sense_asc_ = asc;
+        return status_failed;
+      }
+
+      /**
+       * @details
+       * The response is shortened to the length expected by
+       * the host; the difference is the residue.
+       */
+      uint8_t
+      Msc_device::send_response_ (const Command& cmd, std::size_t bytes,
+                                  uint32_t* residue) noexcept
+      {
+        if (!cmd.data_in)
+          {
+            return status_phase_error;
+          }
+
+        if (bytes > cmd.length)
+          {
+            bytes = cmd.length;
+          }
+        *residue = cmd.length - static_cast<uint32_t> (bytes);
+
+        if (bytes != 0 && queue_ (cmd_slot_, ep_in_, cmd_buffer_, bytes))
+          {
+            wait_ (cmd_slot_);
+          }
+        return status_passed;
+      }
+
+      /**
+       * @details
+       * Commands without data, or with a short response, are
+       * handled here; `READ(10)` and `WRITE(10)` are pipelined.
+       *
+       * A failed command with a data stage stalls the endpoint
+       * of the data stage, as required by the Bulk-Only Transport.
+       */
+      uint8_t
+      Msc_device::execute_ (const Command& cmd, uint32_t* residue) noexcept
+      {
+        uint8_t* r = cmd_buffer_;
+        std::size_t bs = storage_.block_logical_size_bytes ();
+        uint32_t blocks = static_cast<uint32_t> (storage_.blocks ());
+
+        uint8_t status = status_passed;
+        switch (cmd.cb[0])
+          {
+          case scsi_test_unit_ready:
+          case scsi_prevent_allow_removal:
+          case scsi_verify_10:
+            status = (blocks != 0) ?
+                status_passed :
+                fail_ (sense_not_ready, asc_medium_not_present);
+            break;
+
+          case scsi_start_stop_unit:
+          case scsi_synchronize_cache_10:
+            // Write the cached blocks, before an eject.
+            storage_.sync ();
+            break;
+
+          case scsi_request_sense:
+            std::memset (r, 0, 18);
+            r[0] = 0x70; // Current errors, fixed format.
+            r[2] = sense_key_;
+            r[7] = 10; // Additional length.
+            r[12] = sense_asc_;
+            sense_key_ = 0;
+            sense_asc_ = 0;
+            return send_response_ (cmd, 18, residue);
+
+          case scsi_inquiry:
+            std::memset (r, 0, 36);
+            r[1] = 0x80; // Removable.
+            r[2] = 0x02; // SCSI-2.
+            r[3] = 0x02; // Response data format.
+            r[4] = 36 - 5; // Additional length.
+            put_string (r + 8, vendor_, 8);
+            put_string (r + 16, product_, 16);
+            put_string (r + 32, revision_, 4);
+            return send_response_ (cmd, 36, residue);
+
+          case scsi_mode_sense_6:
+            r[0] = 3; // Mode data length.
+            r[1] = 0; // Medium type.
+            r[2] = 0; // Not write protected.
+            r[3] = 0; // No block descriptors.
+            return send_response_ (cmd, 4, residue);
+
+          case scsi_read_format_capacities:
+            std::memset (r, 0, 12);
+            r[3] = 8; // Capacity list length.
+            put_be32 (r + 4, blocks);
+            put_be32 (r + 8, static_cast<uint32_t> (bs));
+            r[8] = 0x02; // Formatted media, over the block length MSB.
+            return send_response_ (cmd, 12, residue);
+
+          case scsi_read_capacity_10:
+            if (blocks == 0)
+              {
+                status = fail_ (sense_not_ready, asc_medium_not_present);
+                break;
+              }
+            put_be32 (r, blocks - 1);
+            put_be32 (r + 4, static_cast<uint32_t> (bs));
+            return send_response_ (cmd, 8, residue);
+
+          case scsi_read_10:
+            return read_ (cmd, residue);
+
+          case scsi_write_10:
+            return write_ (cmd, residue);
+
+          default:
+            status = fail_ (sense_illegal_request, asc_invalid_command);
+            break;
+          }
+
+        if (status != status_passed && cmd.length != 0)
+          {
+            *residue = cmd.length;
+            device_.stall_endpoint (cmd.data_in ? ep_in_ : ep_out_, true);
+          }
+        return status;
+      }
+
+      /**
+       * @details
+       * The blocks are read in chunks of half the buffer; while one
+       * half is sent, the next chunk is read in the other half.
+       */
+      uint8_t
+      Msc_device::read_ (const Command& cmd, uint32_t* residue) noexcept
+      {
+        std::size_t bs = storage_.block_logical_size_bytes ();
+        posix::block_device::blknum_t lba = get_be32 (cmd.cb + 2);
+        std::size_t count = (static_cast<std::size_t> (cmd.cb[7]) << 8)
+            | cmd.cb[8];
+
+        if (!cmd.data_in || cmd.length != count * bs)
+          {
+            return status_phase_error;
+          }
+        if (lba + count > storage_.blocks ())
+          {
+            *residue = cmd.length;
+            device_.stall_endpoint (ep_in_, true);
+            return fail_ (sense_illegal_request, asc_lba_out_of_range);
+          }
+
+        std::size_t half_blocks = (buffer_bytes_ / 2) / bs;
+        std::size_t sent = 0;
+        std::size_t cur = 0;
+        while (sent < count)
+          {
+            Slot& slot = slots_[cur];
+            // The previous transfer from this half must be done.
+            if (!wait_ (slot))
+              {
+                return status_phase_error;
+              }
+
+            std::size_t n = count - sent;
+            if (n > half_blocks)
+              {
+                n = half_blocks;
+              }
+            uint8_t* data = buffer_ + cur * half_blocks * bs;
+            if (storage_.read_block (data, lba + sent, n)
+                != static_cast<ssize_t> (n))
+              {
+                break;
+              }
+            if (!queue_ (slot, ep_in_, data, n * bs))
+              {
+                break;
+              }
+            sent += n;
+            cur ^= 1;
+          }
+
+        for (auto& s : slots_)
+          {
+            if (!wait_ (s))
+              {
+                return status_phase_error;
+              }
+          }
+
+        if (sent < count)
+          {
+            *residue = static_cast<uint32_t> ((count - sent) * bs);
+            device_.stall_endpoint (ep_in_, true);
+            return fail_ (sense_medium_error, asc_unrecovered_read_error);
+          }
+        return status_passed;
+      }
+
+      /**
+       * @details
+       * Both halves are queued to receive; while one is written to
+       * the block device, the next chunk is received in the other
+       * half. After a write error, the data is still received, so
+       * the host sees the failure in the status.
+       */
+      uint8_t
+      Msc_device::write_ (const Command& cmd, uint32_t* residue) noexcept
+      {
+        std::size_t bs = storage_.block_logical_size_bytes ();
+        posix::block_device::blknum_t lba = get_be32 (cmd.cb + 2);
+        std::size_t count = (static_cast<std::size_t> (cmd.cb[7]) << 8)
+            | cmd.cb[8];
+
+        if (cmd.data_in || cmd.length != count * bs)
+          {
+            return status_phase_error;
+          }
+        if (lba + count > storage_.blocks ())
+          {
+            *residue = cmd.length;
+            device_.stall_endpoint (ep_out_, true);
+            return fail_ (sense_illegal_request, asc_lba_out_of_range);
+          }
+
+        std::size_t half_blocks = (buffer_bytes_ / 2) / bs;
+        std::size_t queued = 0;
+        std::size_t written = 0;
+        bool failed = false;
+
+        // Receive in both halves.
+        for (std::size_t i = 0; i < 2 && queued < count; ++i)
+          {
+            std::size_t n = count - queued;
+            if (n > half_blocks)
+              {
+                n = half_blocks;
+              }
+            slots_[i].blocks = n;
+            if (!queue_ (slots_[i], ep_out_, buffer_ + i * half_blocks * bs,
+                         n * bs))
+              {
+                return status_phase_error;
+              }
+            queued += n;
+          }
+
+        std::size_t cur = 0;
+        while (written < count)
+          {
+            Slot& slot = slots_[cur];
+            if (!wait_ (slot))
+              {
+                return status_phase_error;
+              }
+
+            std::size_t n = slot.blocks;
+            uint8_t* data = buffer_ + cur * half_blocks * bs;
+            if (!failed
+                && storage_.write_block (data, lba + written, n)
+                    != static_cast<ssize_t> (n))
+              {
+                failed = true;
+              }
+            written += n;
+
+            if (queued < count)
+              {
+                n = count - queued;
+                if (n > half_blocks)
+                  {
+                    n = half_blocks;
+                  }
+                slot.blocks = n;
+                if (!queue_ (slot, ep_out_, data, n * bs))
+                  {
+                    return status_phase_error;
+                  }
+                queued += n;
+              }
+            cur ^= 1;
+          }
+
+        if (failed)
+          {
+            return fail_ (sense_medium_error, asc_write_fault);
+          }
+        return status_passed;
+      }
+
+    } /* namespace usb */
+  } /* namespace driver */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
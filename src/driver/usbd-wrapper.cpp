@@ -26,6 +26,7 @@
  */
 
 #include <cmsis-plus/driver/usbd-wrapper.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <Driver_USBD.h>
 
@@ -177,10 +178,28 @@ namespace os
       return driver_->EndpointStall (ep_addr, stall);
     }
 
+    /**
+     * @details
+     * The IN buffers are cleaned and the OUT buffers are cleaned
+     * and invalidated before the transfer, for the drivers using
+     * DMA on devices with a data cache; the OUT buffer is
+     * invalidated again by the first `get_transfer_count()`
+     * after the transfer completes.
+     */
     return_t
     usbd_wrapper::do_transfer (usb::endpoint_t ep_addr, uint8_t* data,
                                std::size_t num) noexcept
     {
+      if (ep_addr & usb::ENDPOINT_DIRECTION_MASK)
+        {
+          rtos::dcache::prepare_transmit (data, num);
+        }
+      else
+        {
+          rtos::dcache::prepare_receive (data, num);
+          rx_data_[ep_addr & usb::ENDPOINT_NUMBER_MASK] = data;
+        }
+
       return driver_->EndpointTransfer (ep_addr, data,
                                         static_cast<uint32_t> (num));
     }
@@ -188,7 +207,20 @@ namespace os
     std::size_t
     usbd_wrapper::do_get_transfer_count (usb::endpoint_t ep_addr) noexcept
     {
-      return driver_->EndpointTransferGetResult (ep_addr);
+      std::size_t count = driver_->EndpointTransferGetResult (ep_addr);
+
+      if (!(ep_addr & usb::ENDPOINT_DIRECTION_MASK))
+        {
+          uint8_t*& data = rx_data_[ep_addr & usb::ENDPOINT_NUMBER_MASK];
+          if (data != nullptr)
+            {
+              // Once; later the application may write the buffer.
+              rtos::dcache::complete_receive (data, count);
+              data = nullptr;
+            }
+        }
+
+      return count;
     }
 
     return_t
@@ -26,6 +26,7 @@
  */
 
 #include <cmsis-plus/driver/usbh-wrapper.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <Driver_USBH.h>
 
@@ -182,10 +183,47 @@ namespace os
       return driver_->PipeReset (pipe);
     }
 
+    /**
+     * @details
+     * The SETUP and OUT buffers are cleaned and the IN buffers are
+     * cleaned and invalidated before the transfer, for the drivers
+     * using DMA on devices with a data cache; the IN buffer is
+     * invalidated again by the first `get_transfer_count()`
+     * after the transfer completes.
+     */
     return_t
     usbh_wrapper::do_transfer (usb::pipe_t pipe, uint32_t packet, uint8_t* data,
                                std::size_t num) noexcept
     {
+      if ((packet & ARM_USBH_PACKET_TOKEN_Msk) == ARM_USBH_PACKET_IN)
+        {
+          rtos::dcache::prepare_receive (data, num);
+
+          // Reuse the pipe entry, or take a free one.
+          decltype(&rx_data_[0]) slot = nullptr;
+          for (auto& rx : rx_data_)
+            {
+              if ((rx.data != nullptr) && (rx.pipe == pipe))
+                {
+                  slot = &rx;
+                  break;
+                }
+              if ((rx.data == nullptr) && (slot == nullptr))
+                {
+                  slot = &rx;
+                }
+            }
+          if (slot != nullptr)
+            {
+              slot->pipe = pipe;
+              slot->data = data;
+            }
+        }
+      else
+        {
+          rtos::dcache::prepare_transmit (data, num);
+        }
+
       return driver_->PipeTransfer (pipe, packet, data,
                                     static_cast<uint32_t> (num));
     }
@@ -193,7 +231,20 @@ namespace os
     std::size_t
     usbh_wrapper::do_get_transfer_count (usb::pipe_t pipe) noexcept
     {
-      return driver_->PipeTransferGetResult (pipe);
+      std::size_t count = driver_->PipeTransferGetResult (pipe);
+
+      for (auto& rx : rx_data_)
+        {
+          if ((rx.data != nullptr) && (rx.pipe == pipe))
+            {
+              // Once; later the application may write the buffer.
+              rtos::dcache::complete_receive (rx.data, count);
+              rx.data = nullptr;
+              break;
+            }
+        }
+
+      return count;
     }
 
     return_t
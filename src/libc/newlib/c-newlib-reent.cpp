@@ -31,6 +31,11 @@
 
 #include <cmsis-plus/posix-io/types.h>
 
+#if defined(OS_INTEGER_NEWLIB_REENT_POOL_SIZE)
+#include <cmsis-plus/rtos/os.h>
+#include <reent.h>
+#endif
+
 // ----------------------------------------------------------------------------
 
 extern "C"
@@ -174,5 +179,108 @@ extern "C"
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_INTEGER_NEWLIB_REENT_POOL_SIZE)
+
+#if !(OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+#error "OS_INTEGER_NEWLIB_REENT_POOL_SIZE requires OS_INTEGER_RTOS_THREAD_TLS_SLOTS"
+#endif
+
+using namespace os;
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  // Shared by all threads; a thread gets its own structure only
+  // when it first touches the reentrant data (errno, stdio, strtok(),
+  // etc) and returns it to the pool when it exits.
+  rtos::memory_pool_inclusive<struct _reent,
+      OS_INTEGER_NEWLIB_REENT_POOL_SIZE> reent_pool_
+    { "reent" };
+
+  rtos::thread::tls::key_t reent_key_;
+  bool volatile reent_key_created_;
+
+  void
+  reent_destructor (void* value)
+  {
+    struct _reent* r = static_cast<struct _reent*> (value);
+
+    // Close the thread streams and free the buffers.
+    _reclaim_reent (r);
+
+    reent_pool_.free (r);
+  }
+}
+
+/**
+ * @endcond
+ */
+
+extern "C"
+{
+  struct _reent*
+  __getreent (void);
+}
+
+/**
+ * @brief Get the reentrancy structure of the current thread.
+ *
+ * @details
+ * Called by newlib, when built with `__DYNAMIC_REENT__`, every time
+ * it accesses `_REENT`.
+ *
+ * Interrupt handlers, the code running before the scheduler starts
+ * and the threads that cannot get a structure from the pool use
+ * the global structure, as without this option.
+ */
+struct _reent*
+__getreent (void)
+{
+  if (rtos::interrupts::in_handler_mode () || !rtos::scheduler::started ())
+    {
+      return _global_impure_ptr;
+    }
+
+  if (!reent_key_created_)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::scheduler::critical_section scs;
+
+      if (!reent_key_created_)
+        {
+          if (rtos::thread::tls::create_key (&reent_key_, reent_destructor)
+              != rtos::result::ok)
+            {
+              return _global_impure_ptr;
+            }
+          reent_key_created_ = true;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  class rtos::thread::tls& tls = rtos::this_thread::thread ().tls ();
+  struct _reent* r = static_cast<struct _reent*> (tls.get (reent_key_));
+  if (r == nullptr)
+    {
+      r = static_cast<struct _reent*> (reent_pool_.try_alloc ());
+      if (r == nullptr)
+        {
+          return _global_impure_ptr;
+        }
+
+      _REENT_INIT_PTR(r);
+      tls.set (reent_key_, r);
+    }
+
+  return r;
+}
+
+#endif /* defined(OS_INTEGER_NEWLIB_REENT_POOL_SIZE) */
+
+// ----------------------------------------------------------------------------
+
 #endif /* defined(__ARM_EABI__) */
 
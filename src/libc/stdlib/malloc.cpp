@@ -32,6 +32,10 @@
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/estd/memory_resource>
 
+#if defined(OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES)
+#include <cmsis-plus/memory/first-fit-top.h>
+#endif
+
 #include <malloc.h>
 
 // ----------------------------------------------------------------------------
@@ -40,6 +44,130 @@ using namespace os;
 
 // ----------------------------------------------------------------------------
 
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+#if defined(OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES)
+
+  // A private arena, with its own priority inheritance mutex, so
+  // long allocations delay only the other malloc() users, not
+  // the scheduler; the RTOS objects and `new` still use the
+  // default resource.
+
+#if defined(OS_TYPE_APPLICATION_MEMORY_RESOURCE)
+  using arena_type = OS_TYPE_APPLICATION_MEMORY_RESOURCE;
+#else
+  using arena_type = os::memory::first_fit_top;
+#endif
+
+  template<typename T>
+    using storage_type =
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  storage_type<arena_type> arena_storage_;
+  storage_type<rtos::mutex> mutex_storage_;
+
+  rtos::memory::memory_resource* arena_;
+  rtos::mutex* mutex_;
+
+  // Created on first use, usually by a static constructor,
+  // before the scheduler starts; constructed in place,
+  // to not register any destructor.
+  void
+  initialize_arena (void)
+  {
+    // ----- Begin of critical section ----------------------------------------
+    rtos::scheduler::critical_section scs;
+
+    if (arena_ != nullptr)
+      {
+        return;
+      }
+
+    void* addr = estd::pmr::get_default_resource ()->allocate (
+        OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES);
+    assert(addr != nullptr);
+
+    mutex_ = new (&mutex_storage_) rtos::mutex
+      { "malloc" };
+    arena_ = new (&arena_storage_) arena_type
+      { "malloc", addr, OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES };
+    // ----- End of critical section ------------------------------------------
+  }
+
+  inline rtos::memory::memory_resource*
+  arena (void)
+  {
+    return arena_;
+  }
+
+  class malloc_lock
+  {
+  public:
+
+    malloc_lock ()
+    {
+      if (arena_ == nullptr)
+        {
+          initialize_arena ();
+        }
+
+      // Before the scheduler starts there is a single thread; with
+      // the scheduler locked no other thread can get the mutex, but
+      // it must not be in the middle of an allocation.
+      locked_ = rtos::scheduler::started () && !rtos::scheduler::locked ();
+      if (locked_)
+        {
+          mutex_->lock ();
+        }
+      else
+        {
+          assert(mutex_->owner () == nullptr);
+        }
+    }
+
+    malloc_lock (const malloc_lock&) = delete;
+    malloc_lock (malloc_lock&&) = delete;
+    malloc_lock&
+    operator= (const malloc_lock&) = delete;
+    malloc_lock&
+    operator= (malloc_lock&&) = delete;
+
+    ~malloc_lock ()
+    {
+      if (locked_)
+        {
+          mutex_->unlock ();
+        }
+    }
+
+  private:
+
+    bool locked_;
+  };
+
+#else
+
+  inline rtos::memory::memory_resource*
+  arena (void)
+  {
+    return estd::pmr::get_default_resource ();
+  }
+
+  using malloc_lock = rtos::scheduler::critical_section;
+
+#endif /* defined(OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES) */
+}
+
+/**
+ * @endcond
+ */
+
+// ----------------------------------------------------------------------------
+
 /**
  * @addtogroup cmsis-plus-rtos-c-memres
  * @{
@@ -82,7 +210,8 @@ using namespace os;
  * passed to `free()` shall be returned. Otherwise, it shall return a
  * null pointer and set `errno` to indicate the error.
  *
- * @note In µOS++ this function uses a scheduler critical section
+ * @note In µOS++ this function uses a scheduler critical section,
+ * or, with `OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES`, a mutex,
  * and is thread safe.
  *
  * @par POSIX compatibility
@@ -99,10 +228,10 @@ malloc (size_t bytes)
   void* mem;
     {
       // ----- Begin of critical section --------------------------------------
-      rtos::scheduler::critical_section scs;
+      malloc_lock lock;
 
       errno = 0;
-      mem = estd::pmr::get_default_resource ()->allocate (bytes);
+      mem = arena ()->allocate (bytes);
       if (mem == nullptr)
         {
           errno = ENOMEM;
@@ -149,7 +278,8 @@ malloc (size_t bytes)
  * returned. Otherwise, it shall return a null pointer and set `errno`
  * to indicate the error.
  *
- * @note In µOS++ this function uses a scheduler critical section
+ * @note In µOS++ this function uses a scheduler critical section,
+ * or, with `OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES`, a mutex,
  * and is thread safe.
  *
  * @par POSIX compatibility
@@ -172,9 +302,9 @@ calloc (size_t nelem, size_t elbytes)
   void* mem;
     {
       // ----- Begin of critical section --------------------------------------
-      rtos::scheduler::critical_section scs;
+      malloc_lock lock;
 
-      mem = estd::pmr::get_default_resource ()->allocate (nelem * elbytes);
+      mem = arena ()->allocate (nelem * elbytes);
 
 #if defined(OS_TRACE_LIBC_MALLOC)
       trace::printf ("::%s(%u,%u)=%p\n", __func__, nelem, elbytes, mem);
@@ -248,7 +378,12 @@ calloc (size_t nelem, size_t elbytes)
  * returns a null pointer and `errno` has been set to `ENOMEM`,
  * the memory referenced by _ptr_ shall not be changed.
  *
- * @note In µOS++ this function uses a scheduler critical section
+ * @note In µOS++ the block is first resized in place, if the memory
+ * manager supports it (see `memory_resource::try_resize()`); only if
+ * this fails a new block is allocated and the content copied.
+ *
+ * @note In µOS++ this function uses a scheduler critical section,
+ * or, with `OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES`, a mutex,
  * and is thread safe.
  *
  * @par POSIX compatibility
@@ -266,12 +401,12 @@ realloc (void* ptr, size_t bytes)
 
     {
       // ----- Begin of critical section --------------------------------------
-      rtos::scheduler::critical_section scs;
+      malloc_lock lock;
 
       errno = 0;
       if (ptr == nullptr)
         {
-          mem = estd::pmr::get_default_resource ()->allocate (bytes);
+          mem = arena ()->allocate (bytes);
 #if defined(OS_TRACE_LIBC_MALLOC)
           trace::printf ("::%s(%p,%u)=%p\n", __func__, ptr, bytes, mem);
 #endif
@@ -284,25 +419,28 @@ realloc (void* ptr, size_t bytes)
 
       if (bytes == 0)
         {
-          estd::pmr::get_default_resource ()->deallocate (ptr, 0);
+          arena ()->deallocate (ptr, 0);
 #if defined(OS_TRACE_LIBC_MALLOC)
           trace::printf ("::%s(%p,%u)=0\n", __func__, ptr, bytes);
 #endif
           return nullptr;
         }
 
-#if 0
-      /* TODO: There is chance to shrink the chunk if newly requested
-       * size is much small */
-      if (nano_malloc_usable_size (RCALL ptr) >= bytes)
-      return ptr;
+      // First try to grow or shrink the block in place; this avoids
+      // copying when the adjacent memory is free.
+      if (arena ()->try_resize (ptr, 0, bytes))
+        {
+#if defined(OS_TRACE_LIBC_MALLOC)
+          trace::printf ("::%s(%p,%u)=%p\n", __func__, ptr, bytes, ptr);
 #endif
+          return ptr;
+        }
 
-      mem = estd::pmr::get_default_resource ()->allocate (bytes);
+      mem = arena ()->allocate (bytes);
       if (mem != nullptr)
         {
           memcpy (mem, ptr, bytes);
-          estd::pmr::get_default_resource ()->deallocate (ptr, 0);
+          arena ()->deallocate (ptr, 0);
         }
       else
         {
@@ -339,7 +477,8 @@ realloc (void* ptr, size_t bytes)
  *
  * The `free()` function shall not return a value.
  *
- * @note In µOS++ this function uses a scheduler critical section
+ * @note In µOS++ this function uses a scheduler critical section,
+ * or, with `OS_INTEGER_LIBC_MALLOC_ARENA_SIZE_BYTES`, a mutex,
  * and is thread safe.
  *
  * @par POSIX compatibility
@@ -359,14 +498,14 @@ free (void* ptr)
     }
 
   // ----- Begin of critical section ------------------------------------------
-  rtos::scheduler::critical_section scs;
+  malloc_lock lock;
 
 #if defined(OS_TRACE_LIBC_MALLOC)
   trace::printf ("::%s(%p)\n", __func__, ptr);
 #endif
 
   // Size unknown, pass 0.
-  estd::pmr::get_default_resource ()->deallocate (ptr, 0);
+  arena ()->deallocate (ptr, 0);
   // ----- End of critical section --------------------------------------------
 }
 
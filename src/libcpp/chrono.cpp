@@ -106,18 +106,14 @@ namespace os
       high_resolution_clock::time_point
       high_resolution_clock::now () noexcept
       {
-        auto cycles = rtos::hrclock.now ();
+        // The SysTick ticks plus the cycles since the last tick,
+        // converted with a multiplication, without a division.
+        auto ns = rtos::hrclock.nanoseconds ();
 
-        // The duration is the number of sum of SysTick ticks plus the current
-        // count of CPU cycles (computed from the SysTick counter).
-        // Notice: a more exact solution would be to compute
-        // ticks * divisor + cycles, but this severely reduces the
-        // range of ticks.
         return time_point
           { duration
             { duration
-              { cycles * 1000000000ULL
-                  / rtos::hrclock.input_clock_frequency_hz () }
+              { static_cast<rep> (ns) }
                 + realtime_clock::startup_time_point.time_since_epoch () } //
           };
       }
@@ -0,0 +1,521 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/estd/future>
+
+#include <cmsis-plus/estd/memory_resource>
+#include <cmsis-plus/estd/system_error>
+#include <cmsis-plus/memory/block-pool.h>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_ESTD_ASYNC_WORKERS)
+#define OS_INTEGER_ESTD_ASYNC_WORKERS               (2)
+#endif
+
+#if !defined(OS_INTEGER_ESTD_ASYNC_JOBS)
+#define OS_INTEGER_ESTD_ASYNC_JOBS                  (8)
+#endif
+
+#if !defined(OS_INTEGER_ESTD_ASYNC_STACK_SIZE_BYTES)
+#define OS_INTEGER_ESTD_ASYNC_STACK_SIZE_BYTES      (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#if !defined(OS_INTEGER_ESTD_ASYNC_STATES)
+#define OS_INTEGER_ESTD_ASYNC_STATES                (8)
+#endif
+
+#if !defined(OS_INTEGER_ESTD_ASYNC_STATE_SIZE_BYTES)
+#define OS_INTEGER_ESTD_ASYNC_STATE_SIZE_BYTES      (128)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace estd
+  {
+    namespace internal
+    {
+      namespace
+      {
+        using pool_type = rtos::thread_pool_inclusive<
+        OS_INTEGER_ESTD_ASYNC_WORKERS, OS_INTEGER_ESTD_ASYNC_JOBS,
+        OS_INTEGER_ESTD_ASYNC_STACK_SIZE_BYTES>;
+
+        std::aligned_storage<sizeof(pool_type), alignof(pool_type)>::type //
+        pool_storage_;
+
+        constexpr std::size_t states_align =
+            rtos::memory::memory_resource::max_align;
+
+        constexpr std::size_t state_size_bytes =
+            (OS_INTEGER_ESTD_ASYNC_STATE_SIZE_BYTES + states_align - 1)
+                & ~(states_align - 1);
+
+        constexpr std::size_t states_arena_size_bytes = state_size_bytes
+            * OS_INTEGER_ESTD_ASYNC_STATES;
+
+        alignas(states_align) char states_arena_[states_arena_size_bytes];
+
+        std::aligned_storage<sizeof(memory::block_pool),
+            alignof(memory::block_pool)>::type states_pool_storage_;
+
+        bool volatile initialised_;
+
+        inline rtos::thread_pool&
+        pool (void)
+        {
+          return *reinterpret_cast<pool_type*> (&pool_storage_);
+        }
+
+        inline memory::block_pool&
+        states_pool (void)
+        {
+          return *reinterpret_cast<memory::block_pool*> (&states_pool_storage_);
+        }
+
+        // Created on first use, in place, to not register any
+        // destructor; the workers never terminate.
+        void
+        initialise (void)
+        {
+          // ----- Enter critical section --------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          if (initialised_)
+            {
+              return;
+            }
+
+          new (&pool_storage_) pool_type
+            { "async" };
+
+          new (&states_pool_storage_) memory::block_pool
+            { "async", OS_INTEGER_ESTD_ASYNC_STATES, state_size_bytes,
+                states_arena_, states_arena_size_bytes };
+
+          initialised_ = true;
+          // ----- Exit critical section ---------------------------------------
+        }
+
+        inline bool
+        is_pooled (void* addr)
+        {
+          return (static_cast<char*> (addr) >= states_arena_)
+              && (static_cast<char*> (addr)
+                  < states_arena_ + states_arena_size_bytes);
+        }
+      } /* namespace */
+
+      // ======================================================================
+
+      future_state::~future_state ()
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * The task is submitted to the pool only if the policy
+       * includes `launch::async`; if the deferred policy is also
+       * allowed, the caller does not wait for a free slot in the queue,
+       * but the task is deferred.
+       */
+      void
+      future_state::start (launch policy)
+      {
+        bool may_defer = (policy & launch::deferred) == launch::deferred;
+
+        if ((policy & launch::async) != launch::async
+            || rtos::interrupts::in_handler_mode ())
+          {
+            if (may_defer)
+              {
+                deferred_ = true;
+                return;
+              }
+            // Nothing to wait for, the state can be released.
+            completed_ = true;
+            release (this);
+            os::estd::__throw_cmsis_error (EPERM, "async failed");
+          }
+
+        if (!initialised_)
+          {
+            initialise ();
+          }
+
+        // The job holds a reference until the completion.
+        retain ();
+        joins_ = true;
+
+        rtos::result_t res;
+        if (may_defer)
+          {
+            res = pool ().try_submit (internal_run_, this);
+          }
+        else
+          {
+            res = pool ().submit (internal_run_, this);
+          }
+
+        if (res == rtos::result::ok)
+          {
+            return;
+          }
+
+        joins_ = false;
+        --refs_;
+
+        if (may_defer)
+          {
+            deferred_ = true;
+            return;
+          }
+
+        completed_ = true;
+        release (this);
+        os::estd::__throw_cmsis_error (static_cast<int> (res), "async failed");
+      }
+
+      /**
+       * @details
+       * A deferred task is run in the context of the caller.
+       */
+      void
+      future_state::wait (void)
+      {
+        if (completed_)
+          {
+            return;
+          }
+
+        if (deferred_)
+          {
+            execute ();
+            ready_ = true;
+            completed_ = true;
+            return;
+          }
+
+        rtos::result_t res;
+        while ((res = done_.wait ()) == EINTR)
+          ;
+
+        if (res != rtos::result::ok)
+          {
+            os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                           "future wait failed");
+          }
+        completed_ = true;
+      }
+
+      bool
+      future_state::timed_wait (rtos::clock::duration_t ticks)
+      {
+        if (completed_)
+          {
+            return true;
+          }
+
+        rtos::result_t res;
+        if (ticks == 0)
+          {
+            res = done_.try_wait ();
+          }
+        else
+          {
+            res = done_.timed_wait (ticks);
+          }
+
+        if (res == rtos::result::ok)
+          {
+            completed_ = true;
+            return true;
+          }
+
+        if (res == ETIMEDOUT || res == EWOULDBLOCK || res == EINTR)
+          {
+            return false;
+          }
+
+        os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                       "future wait failed");
+      }
+
+      /**
+       * @details
+       * Run the task and publish the result; the state
+       * is not accessed after the producer reference is released,
+       * and the receiver, if any, is notified last.
+       */
+      void
+      future_state::complete (void)
+      {
+        execute ();
+
+        future_state* next;
+        std::size_t index;
+          {
+            // ----- Enter critical section ------------------------------------
+            rtos::scheduler::critical_section scs;
+
+            ready_ = true;
+            next = next_;
+            index = next_index_;
+            // ----- Exit critical section -------------------------------------
+          }
+
+        done_.post ();
+        release (this);
+
+        if (next != nullptr)
+          {
+            next->notify (index);
+          }
+      }
+
+      /**
+       * @details
+       * The receiver holds a reference until it is notified; if the
+       * source is already ready, it is notified immediately, and
+       * if the source is deferred, the receiver is deferred too.
+       */
+      void
+      future_state::subscribe (future_state* source, future_state* receiver,
+                               std::size_t index)
+      {
+        receiver->retain ();
+
+        bool ready = false;
+          {
+            // ----- Enter critical section ------------------------------------
+            rtos::scheduler::critical_section scs;
+
+            assert(source->next_ == nullptr);
+
+            if (source->ready_)
+              {
+                ready = true;
+              }
+            else if (source->deferred_)
+              {
+                receiver->deferred_ = true;
+              }
+            else
+              {
+                source->next_ = receiver;
+                source->next_index_ = index;
+                return;
+              }
+            // ----- Exit critical section -------------------------------------
+          }
+
+        if (ready)
+          {
+            receiver->notify (index);
+          }
+        else
+          {
+            release (receiver);
+          }
+      }
+
+      void
+      future_state::notify (std::size_t index __attribute__((unused)))
+      {
+        complete ();
+      }
+
+      void
+      future_state::retain (void) noexcept
+      {
+        // ----- Enter critical section ----------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        ++refs_;
+        // ----- Exit critical section -----------------------------------------
+      }
+
+      void
+      future_state::rethrow (void)
+      {
+        if (broken_)
+          {
+#if defined(__EXCEPTIONS)
+            throw std::future_error (std::future_errc::broken_promise);
+#else
+            os::estd::__throw_cmsis_error (ECANCELED, "broken promise");
+#endif
+          }
+
+#if defined(__EXCEPTIONS)
+        if (exception_)
+          {
+            std::rethrow_exception (exception_);
+          }
+#endif
+      }
+
+      void
+      future_state::execute (void)
+      {
+#if defined(__EXCEPTIONS)
+        try
+          {
+            run ();
+          }
+        catch (...)
+          {
+            exception_ = std::current_exception ();
+          }
+#else
+        run ();
+#endif
+      }
+
+      void
+      future_state::internal_run_ (void* args)
+      {
+        static_cast<future_state*> (args)->complete ();
+      }
+
+      // ======================================================================
+
+      /**
+       * @details
+       * Small states are taken from the states pool;
+       * larger ones, or all when the pool is exhausted,
+       * from the default resource.
+       */
+      void*
+      future_state::allocate (std::size_t bytes)
+      {
+        if (!initialised_)
+          {
+            initialise ();
+          }
+
+        void* mem = nullptr;
+        if (bytes <= state_size_bytes)
+          {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+            rtos::scheduler::critical_section scs;
+#endif
+            mem = states_pool ().allocate (bytes);
+          }
+
+        if (mem == nullptr)
+          {
+            // ----- Enter critical section ------------------------------------
+            rtos::scheduler::critical_section scs;
+
+            mem = estd::pmr::get_default_resource ()->allocate (bytes);
+            // ----- Exit critical section -------------------------------------
+          }
+
+        if (mem == nullptr)
+          {
+            estd::__throw_bad_alloc ();
+          }
+        return mem;
+      }
+
+      /**
+       * @details
+       * Drop a reference; the last one destroys the state.
+       */
+      void
+      future_state::release (future_state* state) noexcept
+      {
+        if (state == nullptr)
+          {
+            return;
+          }
+
+          {
+            // ----- Enter critical section ------------------------------------
+            rtos::scheduler::critical_section scs;
+
+            if (--state->refs_ != 0)
+              {
+                return;
+              }
+            // ----- Exit critical section -------------------------------------
+          }
+
+        std::size_t bytes = state->size_bytes_;
+        state->~future_state ();
+
+        if (is_pooled (state))
+          {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+            rtos::scheduler::critical_section scs;
+#endif
+            states_pool ().deallocate (state, bytes);
+          }
+        else
+          {
+            // ----- Enter critical section ------------------------------------
+            rtos::scheduler::critical_section scs;
+
+            estd::pmr::get_default_resource ()->deallocate (state, bytes);
+            // ----- Exit critical section -------------------------------------
+          }
+      }
+
+      /**
+       * @details
+       * Called when the future is destroyed; if the task was
+       * submitted by `async()`, wait for it to complete.
+       */
+      void
+      future_state::abandon (future_state* state) noexcept
+      {
+        if (state == nullptr)
+          {
+            return;
+          }
+
+        if (state->joins_ && !state->completed_)
+          {
+            while (state->done_.wait () == EINTR)
+              ;
+          }
+
+        release (state);
+      }
+
+    } /* namespace internal */
+
+  // --------------------------------------------------------------------------
+  } /* namespace estd */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -41,6 +41,10 @@
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/estd/memory_resource>
 
+#if defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS)
+#include <cmsis-plus/memory/block-pool.h>
+#endif
+
 // ----------------------------------------------------------------------------
 
 using namespace os;
@@ -57,6 +61,248 @@ namespace
    * part of the .bss section.
    */
   std::new_handler new_handler_;
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+
+  /**
+   * @brief Get the allocation cache of the current thread.
+   *
+   * @details
+   * Before the scheduler is started there is no current thread,
+   * and the cache is not used.
+   */
+  inline class rtos::thread::allocation_cache*
+  current_allocation_cache (void)
+  {
+    if (!rtos::scheduler::started ())
+      {
+        return nullptr;
+      }
+    return &rtos::this_thread::thread ().allocation_cache ();
+  }
+
+  /**
+   * @brief Try to allocate from the cache of the current thread.
+   *
+   * @details
+   * Small requests are rounded up to the cache block size, so that
+   * the block can be later cached by `operator delete()`.
+   */
+  inline void*
+  cached_allocate (std::size_t& bytes)
+  {
+    if (bytes > rtos::thread::allocation_cache::block_size_bytes)
+      {
+        return nullptr;
+      }
+
+    bytes = rtos::thread::allocation_cache::block_size_bytes;
+
+    class rtos::thread::allocation_cache* cache = current_allocation_cache ();
+    if (cache == nullptr)
+      {
+        return nullptr;
+      }
+    return cache->allocate (bytes);
+  }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
+#if defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS)
+
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+#error "OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS requires OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE"
+#endif
+
+  // The size classes of the small blocks, in ascending order.
+  constexpr std::size_t small_sizes[] =
+    { 16, 32, 64 };
+  constexpr std::size_t small_classes = sizeof(small_sizes)
+      / sizeof(small_sizes[0]);
+
+  constexpr std::size_t small_max_size_bytes = small_sizes[small_classes - 1];
+  constexpr std::size_t small_arena_size_bytes = (small_sizes[0]
+      + small_sizes[1] + small_sizes[2]) * OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS;
+
+  // All classes share a single arena, so a block is identified
+  // by its address, even by the unsized operator delete().
+  constexpr std::size_t small_align =
+      rtos::memory::memory_resource::max_align;
+
+  alignas(small_align) char small_arena_[small_arena_size_bytes];
+
+  using small_pool_storage_t = std::aligned_storage<sizeof(memory::block_pool),
+  alignof(memory::block_pool)>::type;
+
+  small_pool_storage_t small_pools_storage_[small_classes];
+
+  bool volatile small_pools_initialised_;
+
+  inline memory::block_pool&
+  small_pool (std::size_t index)
+  {
+    return reinterpret_cast<memory::block_pool*> (small_pools_storage_)[index];
+  }
+
+  // Created on first use, since allocations may be requested by
+  // static constructors that run before the pools would be
+  // constructed; constructed in place, to not register any destructor.
+  void
+  initialise_small_pools (void)
+  {
+    // ----- Begin of critical section ----------------------------------------
+    rtos::scheduler::critical_section scs;
+
+    if (small_pools_initialised_)
+      {
+        return;
+      }
+
+    char* addr = small_arena_;
+    for (std::size_t i = 0; i < small_classes; ++i)
+      {
+        std::size_t bytes = small_sizes[i] * OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS;
+        new (&small_pools_storage_[i]) memory::block_pool
+          { "new-small", OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS, small_sizes[i],
+              addr, bytes };
+        addr += bytes;
+      }
+
+    small_pools_initialised_ = true;
+    // ----- End of critical section ------------------------------------------
+  }
+
+  /**
+   * @brief Try to allocate from the small blocks pools.
+   *
+   * @details
+   * The pools are lock free, so the scheduler is not locked;
+   * if the size class is exhausted, the default resource is used.
+   */
+  inline void*
+  small_allocate (std::size_t bytes)
+  {
+    if (bytes > small_max_size_bytes)
+      {
+        return nullptr;
+      }
+
+    if (!small_pools_initialised_)
+      {
+        initialise_small_pools ();
+      }
+
+    for (std::size_t i = 0; i < small_classes; ++i)
+      {
+        if (bytes <= small_sizes[i])
+          {
+            return small_pool (i).allocate (bytes);
+          }
+      }
+    return nullptr;
+  }
+
+  /**
+   * @brief Return a block to the small blocks pools.
+   * @return `true` if the block belongs to a pool.
+   */
+  inline bool
+  small_deallocate (void* ptr)
+  {
+    char* p = static_cast<char*> (ptr);
+    if ((p < small_arena_) || (p >= small_arena_ + small_arena_size_bytes))
+      {
+        return false;
+      }
+
+    char* end = small_arena_;
+    for (std::size_t i = 0; i < small_classes; ++i)
+      {
+        end += small_sizes[i] * OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS;
+        if (p < end)
+          {
+            small_pool (i).deallocate (ptr, small_sizes[i]);
+            break;
+          }
+      }
+    return true;
+  }
+
+#endif /* defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS) */
+
+#if defined(__cpp_aligned_new)
+
+  /**
+   * @brief Allocate an over-aligned block from the default resource.
+   *
+   * @details
+   * The small blocks caches and pools are not used, since their
+   * blocks are aligned only to `max_align`.
+   *
+   * @return Pointer to the block, or `nullptr` if there is
+   * no more memory and no `new_handler`.
+   */
+  void*
+  aligned_allocate (std::size_t bytes, std::size_t alignment)
+  {
+    assert(!rtos::interrupts::in_handler_mode ());
+
+    if (bytes == 0)
+      {
+        bytes = 1;
+      }
+
+    // ----- Begin of critical section ----------------------------------------
+    rtos::scheduler::critical_section scs;
+
+    while (true)
+      {
+        void* mem = estd::pmr::get_default_resource ()->allocate (bytes,
+                                                                  alignment);
+
+        if (mem != nullptr)
+          {
+#if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
+            trace::printf ("::%s(%d,%d)=%p\n", __func__, bytes, alignment, mem);
+#endif
+            return mem;
+          }
+
+        // If allocate() fails and there is a new_handler,
+        // call it to try free up memory.
+        if (new_handler_)
+          {
+            new_handler_ ();
+          }
+        else
+          {
+            return nullptr;
+          }
+      }
+
+    // ----- End of critical section ------------------------------------------
+  }
+
+  void
+  aligned_deallocate (void* ptr, std::size_t bytes, std::size_t alignment)
+  {
+#if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
+    trace::printf ("::%s(%p,%u,%u)\n", __func__, ptr, bytes, alignment);
+#endif
+
+    assert(!rtos::interrupts::in_handler_mode ());
+
+    if (ptr)
+      {
+        // ----- Begin of critical section ------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        estd::pmr::get_default_resource ()->deallocate (ptr, bytes, alignment);
+        // ----- End of critical section --------------------------------------
+      }
+  }
+
+#endif /* defined(__cpp_aligned_new) */
 }
 
 /**
@@ -138,6 +384,10 @@ namespace std
  * or else throw a `bad-alloc` exception. This requirement is
  * binding on a replacement version of this function.
  *
+ * If `OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS` is defined,
+ * small blocks are first taken from the cache of the current
+ * thread, without locking the scheduler.
+ *
  * @note A C++ program may define a function with this function signature
  * that displaces the default version defined by the C++ standard library.
  *
@@ -153,6 +403,28 @@ operator new (std::size_t bytes)
       bytes = 1;
     }
 
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+  void* cached = cached_allocate (bytes);
+  if (cached != nullptr)
+    {
+#if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
+      trace::printf ("::%s(%d)=%p cached\n", __func__, bytes, cached);
+#endif
+      return cached;
+    }
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
+#if defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS)
+  void* small = small_allocate (bytes);
+  if (small != nullptr)
+    {
+#if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
+      trace::printf ("::%s(%d)=%p small\n", __func__, bytes, small);
+#endif
+      return small;
+    }
+#endif /* defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS) */
+
   // ----- Begin of critical section ------------------------------------------
   rtos::scheduler::critical_section scs;
 
@@ -217,6 +489,28 @@ operator new (std::size_t bytes,
       bytes = 1;
     }
 
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+  void* cached = cached_allocate (bytes);
+  if (cached != nullptr)
+    {
+#if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
+      trace::printf ("::%s(%d)=%p cached\n", __func__, bytes, cached);
+#endif
+      return cached;
+    }
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
+#if defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS)
+  void* small = small_allocate (bytes);
+  if (small != nullptr)
+    {
+#if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
+      trace::printf ("::%s(%d)=%p small\n", __func__, bytes, small);
+#endif
+      return small;
+    }
+#endif /* defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS) */
+
   // ----- Begin of critical section ------------------------------------------
   rtos::scheduler::critical_section scs;
 
@@ -332,6 +626,13 @@ operator delete (void* ptr) noexcept
 
   if (ptr)
     {
+#if defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS)
+      if (small_deallocate (ptr))
+        {
+          return;
+        }
+#endif /* defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS) */
+
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
 
@@ -383,6 +684,24 @@ operator delete (void* ptr, std::size_t bytes) noexcept
 
   if (ptr)
     {
+#if defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS)
+      // Pool blocks must not end in the thread cache, which
+      // returns the excess to the default resource.
+      if (small_deallocate (ptr))
+        {
+          return;
+        }
+#endif /* defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS) */
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+      // Only the sized deallocation can identify small blocks.
+      class rtos::thread::allocation_cache* cache = current_allocation_cache ();
+      if ((cache != nullptr) && cache->deallocate (ptr, bytes))
+        {
+          return;
+        }
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
 
@@ -424,6 +743,13 @@ operator delete (void* ptr,
 
   if (ptr)
     {
+#if defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS)
+      if (small_deallocate (ptr))
+        {
+          return;
+        }
+#endif /* defined(OS_INTEGER_LIBCPP_NEW_SMALL_BLOCKS) */
+
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
 
@@ -519,6 +845,206 @@ operator delete[] (void* ptr, const std::nothrow_t& nothrow) noexcept
   ::operator delete (ptr, nothrow);
 }
 
+/**
+ * @}
+ */
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cpp_aligned_new) || defined(__DOXYGEN__)
+
+/**
+ * @name Aligned operators
+ * @{
+ */
+
+/**
+ * @brief Allocate space for a new over-aligned object instance.
+ * @param bytes Number of bytes to allocate.
+ * @param alignment Alignment of the object, a power of 2.
+ * @return Pointer to allocated object.
+ *
+ * @details
+ * The allocation function called by a new-expression for types
+ * with an alignment larger than `__STDCPP_DEFAULT_NEW_ALIGNMENT__`
+ * (C++17). The alignment is passed to the default memory resource.
+ *
+ * @note A C++ program may define a function with this function signature
+ * that displaces the default version defined by the C++ standard library.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void*
+__attribute__((weak))
+operator new (std::size_t bytes, std::align_val_t alignment)
+{
+  void* mem = aligned_allocate (bytes, static_cast<std::size_t> (alignment));
+  if (mem == nullptr)
+    {
+      estd::__throw_bad_alloc ();
+    }
+  return mem;
+}
+
+/**
+ * @brief Allocate space for a new over-aligned object instance (nothrow).
+ * @param bytes Number of bytes to allocate.
+ * @param alignment Alignment of the object, a power of 2.
+ * @param nothrow
+ * @return Pointer to allocated object, or `nullptr`.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void*
+__attribute__((weak))
+operator new (std::size_t bytes, std::align_val_t alignment,
+              const std::nothrow_t& nothrow __attribute__((unused))) noexcept
+{
+  return aligned_allocate (bytes, static_cast<std::size_t> (alignment));
+}
+
+/**
+ * @brief Allocate space for an array of over-aligned object instances.
+ * @param bytes Number of bytes to allocate.
+ * @param alignment Alignment of the objects, a power of 2.
+ * @return Pointer to allocated object.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void*
+__attribute__((weak))
+operator new[] (std::size_t bytes, std::align_val_t alignment)
+{
+  return ::operator new (bytes, alignment);
+}
+
+/**
+ * @brief Allocate space for an array of over-aligned object
+ * instances (nothrow).
+ * @param bytes Number of bytes to allocate.
+ * @param alignment Alignment of the objects, a power of 2.
+ * @param nothrow
+ * @return Pointer to allocated object, or `nullptr`.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void*
+__attribute__((weak))
+operator new[] (std::size_t bytes, std::align_val_t alignment,
+                const std::nothrow_t& nothrow) noexcept
+{
+  return ::operator new (bytes, alignment, nothrow);
+}
+
+/**
+ * @brief Deallocate the dynamically allocated over-aligned object instance.
+ * @param ptr Pointer to object.
+ * @param alignment Alignment used when allocated.
+ * @par Returns
+ *  Nothing.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+__attribute__((weak))
+operator delete (void* ptr, std::align_val_t alignment) noexcept
+{
+  // The unknown size is passed as 0.
+  aligned_deallocate (ptr, 0, static_cast<std::size_t> (alignment));
+}
+
+/**
+ * @brief Deallocate the dynamically allocated over-aligned object instance.
+ * @param ptr Pointer to object.
+ * @param bytes Number of bytes to deallocate.
+ * @param alignment Alignment used when allocated.
+ * @par Returns
+ *  Nothing.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+__attribute__((weak))
+operator delete (void* ptr, std::size_t bytes,
+                 std::align_val_t alignment) noexcept
+{
+  aligned_deallocate (ptr, bytes, static_cast<std::size_t> (alignment));
+}
+
+/**
+ * @brief Deallocate the dynamically allocated over-aligned object
+ * instance (nothrow).
+ * @param ptr Pointer to object.
+ * @param alignment Alignment used when allocated.
+ * @param nothrow
+ * @par Returns
+ *  Nothing.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+__attribute__((weak))
+operator delete (void* ptr, std::align_val_t alignment,
+                 const std::nothrow_t& nothrow __attribute__((unused))) noexcept
+{
+  aligned_deallocate (ptr, 0, static_cast<std::size_t> (alignment));
+}
+
+/**
+ * @brief Deallocate the dynamically allocated array of over-aligned objects.
+ * @param ptr Pointer to array of objects.
+ * @param alignment Alignment used when allocated.
+ * @par Returns
+ *  Nothing.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+__attribute__((weak))
+operator delete[] (void* ptr, std::align_val_t alignment) noexcept
+{
+  ::operator delete (ptr, alignment);
+}
+
+/**
+ * @brief Deallocate the dynamically allocated array of over-aligned objects.
+ * @param ptr Pointer to array of objects.
+ * @param bytes Number of bytes to deallocate.
+ * @param alignment Alignment used when allocated.
+ * @par Returns
+ *  Nothing.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+__attribute__((weak))
+operator delete[] (void* ptr, std::size_t bytes,
+                   std::align_val_t alignment) noexcept
+{
+  ::operator delete (ptr, bytes, alignment);
+}
+
+/**
+ * @brief Deallocate the dynamically allocated array of over-aligned
+ * objects (nothrow).
+ * @param ptr Pointer to array of objects.
+ * @param alignment Alignment used when allocated.
+ * @param nothrow
+ * @par Returns
+ *  Nothing.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+__attribute__((weak))
+operator delete[] (void* ptr, std::align_val_t alignment,
+                   const std::nothrow_t& nothrow) noexcept
+{
+  ::operator delete (ptr, alignment, nothrow);
+}
+
+#endif /* defined(__cpp_aligned_new) */
+
 /**
  * @}
  */
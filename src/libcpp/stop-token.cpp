@@ -0,0 +1,279 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/estd/stop_token>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace estd
+  {
+    namespace internal
+    {
+      // ======================================================================
+
+      bool
+      stop_state::stop_possible (void) const noexcept
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        return requested_ || sources_ != 0;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * The callbacks are invoked by the requesting thread, one
+       * at a time, outside the critical section; if a thread
+       * was attached (by `jthread`), it is interrupted, so its
+       * blocking calls return `EINTR`.
+       */
+      bool
+      stop_state::request_stop (void) noexcept
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::scheduler::critical_section scs;
+
+            if (requested_)
+              {
+                return false;
+              }
+            requested_ = true;
+
+            requester_ =
+                rtos::interrupts::in_handler_mode () ?
+                    nullptr : &rtos::this_thread::thread ();
+
+            if (thread_ != nullptr)
+              {
+                thread_->interrupt ();
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        while (true)
+          {
+            stop_callback_node* node;
+              {
+                // ----- Enter critical section -------------------------------
+                rtos::scheduler::critical_section scs;
+
+                node = head_;
+                running_ = node;
+                if (node == nullptr)
+                  {
+                    break;
+                  }
+
+                head_ = node->next_;
+                if (head_ != nullptr)
+                  {
+                    head_->prev_ = nullptr;
+                  }
+                node->linked_ = false;
+                // ----- Exit critical section --------------------------------
+              }
+
+            bool destroyed = false;
+            node->destroyed_ = &destroyed;
+
+            node->func_ (node);
+
+            if (!destroyed)
+              {
+                node->destroyed_ = nullptr;
+                node->done_ = true;
+              }
+          }
+
+        return true;
+      }
+
+      /**
+       * @details
+       * If the stop was already requested, the node is not
+       * added and the caller must invoke the callback.
+       */
+      bool
+      stop_state::add (stop_callback_node* node) noexcept
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        if (requested_)
+          {
+            return false;
+          }
+
+        node->prev_ = nullptr;
+        node->next_ = head_;
+        if (head_ != nullptr)
+          {
+            head_->prev_ = node;
+          }
+        head_ = node;
+        node->linked_ = true;
+
+        return true;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      stop_state::remove (stop_callback_node* node) noexcept
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::scheduler::critical_section scs;
+
+            if (node->linked_)
+              {
+                if (node->prev_ != nullptr)
+                  {
+                    node->prev_->next_ = node->next_;
+                  }
+                else
+                  {
+                    head_ = node->next_;
+                  }
+                if (node->next_ != nullptr)
+                  {
+                    node->next_->prev_ = node->prev_;
+                  }
+                node->linked_ = false;
+                return;
+              }
+
+            if (running_ != node)
+              {
+                // Already invoked, or never registered.
+                return;
+              }
+
+            if (requester_ == nullptr
+                || requester_ == &rtos::this_thread::thread ())
+              {
+                // Destroyed by its own callback.
+                if (node->destroyed_ != nullptr)
+                  {
+                    *node->destroyed_ = true;
+                  }
+                return;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        // Running in another thread; not expected to take long.
+        while (!node->done_)
+          {
+            rtos::sysclock.sleep_for (1);
+          }
+      }
+
+      /**
+       * @details
+       * Set or clear the thread to be interrupted by the stop
+       * request; if the stop was already requested, it is
+       * interrupted immediately.
+       */
+      void
+      stop_state::interrupt_thread (rtos::thread* th) noexcept
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        thread_ = th;
+        if (thread_ != nullptr && requested_)
+          {
+            thread_->interrupt ();
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      stop_state::retain (stop_state* state, bool source) noexcept
+      {
+        if (state == nullptr)
+          {
+            return;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        ++state->refs_;
+        if (source)
+          {
+            ++state->sources_;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      stop_state::release (stop_state* state, bool source) noexcept
+      {
+        if (state == nullptr)
+          {
+            return;
+          }
+
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::scheduler::critical_section scs;
+
+            if (source)
+              {
+                --state->sources_;
+              }
+            if (--state->refs_ != 0)
+              {
+                return;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        delete state;
+      }
+
+    } /* namespace internal */
+
+    // ========================================================================
+
+    stop_source::stop_source () :
+        state_ (new internal::stop_state)
+    {
+      ;
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace estd */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
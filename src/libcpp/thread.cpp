@@ -35,6 +35,78 @@ namespace os
 
 #include "thread-cpp.h"
 
+    // ========================================================================
+
+    jthread::jthread (jthread&& other) noexcept :
+        ssource_ (std::move (other.ssource_)), //
+        thread_ (std::move (other.thread_))
+    {
+      ;
+    }
+
+    jthread::~jthread ()
+    {
+      if (joinable ())
+        {
+          request_stop ();
+          join ();
+        }
+    }
+
+    jthread&
+    jthread::operator= (jthread&& other) noexcept
+    {
+      if (joinable ())
+        {
+          request_stop ();
+          join ();
+        }
+
+      ssource_ = std::move (other.ssource_);
+      thread_ = std::move (other.thread_);
+      return *this;
+    }
+
+    void
+    jthread::swap (jthread& other) noexcept
+    {
+      ssource_.swap (other.ssource_);
+      thread_.swap (other.thread_);
+    }
+
+    void
+    jthread::join (void)
+    {
+      detach_ ();
+      thread_.join ();
+    }
+
+    void
+    jthread::detach (void)
+    {
+      detach_ ();
+      thread_.detach ();
+    }
+
+    void
+    jthread::attach_ (void) noexcept
+    {
+      if (ssource_.state_ != nullptr)
+        {
+          ssource_.state_->interrupt_thread (thread_.native_handle ());
+        }
+    }
+
+    // The native thread is no longer accessible from this object.
+    void
+    jthread::detach_ (void) noexcept
+    {
+      if (ssource_.state_ != nullptr)
+        {
+          ssource_.state_->interrupt_thread (nullptr);
+        }
+    }
+
   // ==========================================================================
   } /* namespace estd */
 } /* namespace os */
@@ -56,6 +56,31 @@ namespace os
     {
       assert(bytes <= block_size_bytes_);
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      void* p = free_list_.pop ();
+      if (p == nullptr)
+        {
+          return nullptr;
+        }
+
+      __atomic_fetch_add (&count_, 1, __ATOMIC_RELAXED);
+
+      // Update statistics atomically, the caller might be
+      // an interrupt handler.
+      std::size_t allocated = __atomic_add_fetch (&allocated_bytes_,
+                                                  block_size_bytes_,
+                                                  __ATOMIC_RELAXED);
+      if (allocated > max_allocated_bytes_)
+        {
+          max_allocated_bytes_ = allocated;
+        }
+      __atomic_fetch_sub (&free_bytes_, block_size_bytes_, __ATOMIC_RELAXED);
+      __atomic_fetch_add (&allocated_chunks_, 1, __ATOMIC_RELAXED);
+      __atomic_fetch_sub (&free_chunks_, 1, __ATOMIC_RELAXED);
+
+#else
+
       if (first_ == nullptr)
         {
           return nullptr;
@@ -69,6 +94,8 @@ namespace os
       // What is subtracted from free is added to allocated.
       internal_increase_allocated_statistics (block_size_bytes_);
 
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
 #if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
       trace::printf ("%s(%u,%u)=%p,%u @%p %s\n", __func__, bytes, alignment, p,
                      block_size_bytes_, this, name ());
@@ -97,6 +124,21 @@ namespace os
           return;
         }
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      free_list_.push (addr);
+
+      __atomic_fetch_sub (&count_, 1, __ATOMIC_RELAXED);
+
+      // Update statistics atomically.
+      __atomic_fetch_sub (&allocated_bytes_, block_size_bytes_,
+                          __ATOMIC_RELAXED);
+      __atomic_fetch_add (&free_bytes_, block_size_bytes_, __ATOMIC_RELAXED);
+      __atomic_fetch_sub (&allocated_chunks_, 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add (&free_chunks_, 1, __ATOMIC_RELAXED);
+
+#else
+
       // Perform a push_front() on the single linked LIFO list,
       // i.e. add the block to the beginning of the list.
 
@@ -112,6 +154,8 @@ namespace os
       // Update statistics.
       // What is subtracted from allocated is added to free.
       internal_decrease_allocated_statistics (block_size_bytes_);
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
     }
 
 #pragma GCC diagnostic push
@@ -125,6 +169,21 @@ namespace os
       return block_size_bytes_ * blocks_;
     }
 
+    /**
+     * @details
+     * All blocks have the same size, so the memory cannot be
+     * fragmented.
+     */
+    std::size_t
+    block_pool::do_max_free_chunk (void) noexcept
+    {
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+      return (!free_list_.empty ()) ? block_size_bytes_ : 0;
+#else
+      return (first_ != nullptr) ? block_size_bytes_ : 0;
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+    }
+
     /**
      * @details
      */
@@ -181,6 +240,12 @@ namespace os
     void
     block_pool::internal_reset_ (void) noexcept
     {
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      free_list_.init (pool_addr_, blocks_, block_size_bytes_);
+
+#else
+
       // Construct a linked list of blocks. Store the pointer at
       // the beginning of each block. Each block
       // will hold the address of the next free block, or nullptr at the end.
@@ -201,6 +266,8 @@ namespace os
 
       first_ = pool_addr_; // Pointer to first block.
 
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
       count_ = 0; // No allocated blocks.
 
       allocated_bytes_ = 0;
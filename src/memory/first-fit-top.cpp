@@ -37,6 +37,37 @@ namespace os
 
     // ========================================================================
 
+
+    namespace
+    {
+      // Index of the most significant bit set; the argument must be non zero.
+      inline std::size_t
+      fls (std::size_t x) noexcept
+      {
+        return (sizeof(unsigned long) * 8 - 1)
+            - static_cast<std::size_t> (__builtin_clzl (
+                static_cast<unsigned long> (x)));
+      }
+
+      // Index of the least significant bit set; the argument must be non zero.
+      inline std::size_t
+      ffs (uint32_t x) noexcept
+      {
+        return static_cast<std::size_t> (__builtin_ctz (x));
+      }
+    }
+
+    /**
+     * @details
+     * All very large chunks share the last list.
+     */
+    std::size_t
+    first_fit_top::bin_index (std::size_t size) noexcept
+    {
+      std::size_t bin = fls (size);
+      return (bin < bins_count) ? bin : (bins_count - 1);
+    }
+
     /**
      * @details
      */
@@ -65,7 +96,10 @@ namespace os
         {
           assert(res != nullptr);
         }
-      assert((total_bytes_ % chunk_align) == 0);
+
+      // The size of all chunks must be a multiple of the alignment,
+      // to leave room for the flags.
+      total_bytes_ &= ~(chunk_align - 1);
 
       internal_reset_ ();
     }
@@ -76,21 +110,221 @@ namespace os
     void
     first_fit_top::internal_reset_ (void) noexcept
     {
+      bins_bitmap_ = 0;
+      for (std::size_t i = 0; i < bins_count; ++i)
+        {
+          bins_[i] = nullptr;
+        }
+      max_free_size_ = 0;
+      alignment_lost_bytes_ = 0;
+      verify_next_ = nullptr;
+
       // Fill it with the first chunk.
       chunk_t* chunk = reinterpret_cast<chunk_t*> (arena_addr_);
       // Entire arena is a big free chunk.
-      chunk->size = total_bytes_;
-      // Mark the end of the list with a null pointer.
-      chunk->next = nullptr;
+      internal_insert_free_ (chunk, total_bytes_);
 
       allocated_bytes_ = 0;
       max_allocated_bytes_ = 0;
       free_bytes_ = total_bytes_;
       allocated_chunks_ = 0;
       free_chunks_ = 1;
+    }
 
-      // Remember first chunk as list head.
-      free_list_ = chunk;
+    /**
+     * @details
+     * Mark the chunk as free, write the boundary tag at its end,
+     * inform the next chunk that the previous one is free, and
+     * link the chunk at the head of the list for its size.
+     *
+     * The previous chunk is never free, since it would have been
+     * coalesced.
+     */
+    void
+    first_fit_top::internal_insert_free_ (chunk_t* chunk, std::size_t size) noexcept
+    {
+      chunk->size = size | chunk_free_bit;
+
+      char* end = reinterpret_cast<char*> (chunk) + size;
+      *reinterpret_cast<std::size_t*> (end - sizeof(std::size_t)) = size;
+
+      if (end < static_cast<char*> (arena_addr_) + total_bytes_)
+        {
+          reinterpret_cast<chunk_t*> (end)->size |= chunk_prev_free_bit;
+        }
+
+      std::size_t bin = bin_index (size);
+
+      chunk_t* head = bins_[bin];
+      chunk->next = head;
+      chunk->prev = nullptr;
+      if (head != nullptr)
+        {
+          head->prev = chunk;
+        }
+      bins_[bin] = chunk;
+
+      bins_bitmap_ |= (1u << bin);
+
+      if ((max_free_size_ != max_free_unknown) && (size > max_free_size_))
+        {
+          max_free_size_ = size;
+        }
+    }
+
+    /**
+     * @details
+     * Only the list links are updated, the chunk flags are
+     * the caller responsibility.
+     *
+     * If the largest free chunk is removed, its size is recomputed
+     * only when requested.
+     */
+    void
+    first_fit_top::internal_remove_free_ (chunk_t* chunk) noexcept
+    {
+      std::size_t size = chunk_size (chunk);
+      std::size_t bin = bin_index (size);
+
+      chunk_t* next = chunk->next;
+      chunk_t* prev = chunk->prev;
+      if (next != nullptr)
+        {
+          next->prev = prev;
+        }
+      if (prev != nullptr)
+        {
+          prev->next = next;
+        }
+      else
+        {
+          // The chunk was the list head.
+          bins_[bin] = next;
+          if (next == nullptr)
+            {
+              bins_bitmap_ &= ~(1u << bin);
+            }
+        }
+
+      if (size == max_free_size_)
+        {
+          max_free_size_ = max_free_unknown;
+        }
+    }
+
+    /**
+     * @details
+     * If the chunk is much larger than required, it is split in two,
+     * and the top part is returned, while the bottom part goes back
+     * to the free lists; otherwise the entire chunk is returned.
+     */
+    first_fit_top::chunk_t*
+    first_fit_top::internal_split_top_ (chunk_t* chunk, std::size_t alloc_size,
+                                        std::size_t minchunk) noexcept
+    {
+      std::size_t size = chunk_size (chunk);
+      std::size_t rem = size - alloc_size;
+
+      // The next chunk is no longer preceded by a free chunk.
+      char* end = reinterpret_cast<char*> (chunk) + size;
+      if (end < static_cast<char*> (arena_addr_) + total_bytes_)
+        {
+          reinterpret_cast<chunk_t*> (end)->size &= ~chunk_prev_free_bit;
+        }
+
+      if (rem >= minchunk)
+        {
+          // Found a chunk that is much larger than required size
+          // (at least one more chunk is available);
+          // break it into two chunks and return the second one.
+          internal_insert_free_ (chunk, rem);
+
+          chunk = reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+              + rem);
+          chunk->size = alloc_size | chunk_prev_free_bit;
+
+          // Splitting one chunk creates one more chunk.
+          ++free_chunks_;
+        }
+      else
+        {
+          // Found a chunk that is exactly the size or slightly
+          // larger than the requested size; return this chunk.
+          chunk->size = size;
+        }
+
+      return chunk;
+    }
+
+    /**
+     * @details
+     * The aligned chunk is placed as high as possible in the free
+     * chunk, with the payload on the required boundary; the fragments
+     * below and above it go back to the free lists, if large enough
+     * for a free chunk; a fragment too small above it is kept in
+     * the allocated chunk.
+     *
+     * If the fragment below is not empty, but too small for a free
+     * chunk, carving is not possible, and the caller must use
+     * the padding in the chunk.
+     */
+    first_fit_top::chunk_t*
+    first_fit_top::internal_carve_aligned_ (chunk_t* chunk,
+                                            std::size_t alloc_size,
+                                            std::size_t alignment) noexcept
+    {
+      char* begin = reinterpret_cast<char*> (chunk);
+      char* end = begin + chunk_size (chunk);
+
+      uintptr_t payload = (reinterpret_cast<uintptr_t> (end - alloc_size)
+          + chunk_offset) & ~(static_cast<uintptr_t> (alignment) - 1);
+      char* aligned = reinterpret_cast<char*> (payload - chunk_offset);
+
+      if (aligned < begin)
+        {
+          return nullptr;
+        }
+
+      std::size_t lead = static_cast<std::size_t> (aligned - begin);
+      if ((lead != 0) && (lead < chunk_minsize))
+        {
+          return nullptr;
+        }
+
+      std::size_t tail = static_cast<std::size_t> (end - aligned) - alloc_size;
+      if (tail < chunk_minsize)
+        {
+          // Too small for a free chunk, keep it in the allocated chunk.
+          alloc_size += tail;
+          tail = 0;
+
+          // The next chunk is no longer preceded by a free chunk.
+          if (end < static_cast<char*> (arena_addr_) + total_bytes_)
+            {
+              reinterpret_cast<chunk_t*> (end)->size &= ~chunk_prev_free_bit;
+            }
+        }
+      else
+        {
+          internal_insert_free_ (
+              reinterpret_cast<chunk_t*> (aligned + alloc_size), tail);
+
+          ++free_chunks_;
+        }
+
+      std::size_t flags = 0;
+      if (lead != 0)
+        {
+          internal_insert_free_ (chunk, lead);
+          flags = chunk_prev_free_bit;
+
+          ++free_chunks_;
+        }
+
+      chunk = reinterpret_cast<chunk_t*> (aligned);
+      chunk->size = alloc_size | flags;
+
+      return chunk;
     }
 
     /**
@@ -113,14 +347,23 @@ namespace os
     /**
      * @details
      * The allocator tries to be fast and grasps the first block
-     * large enough, possibly splitting large blocks and increasing
+     * large enough from the list of the requested size range;
+     * if there is none, the first block from the next non
+     * empty list is used, without further search.
+     *
+     * Large blocks are split, possibly increasing
      * fragmentation. If the block is only slightly larger
      * (the remaining space is not large enough for a minimum chunk)
      * the block is not split, but left partly unused.
      *
      * When large blocks are split, the top sub-block is returned;
-     * in other words, memory is allocated top-down. This speeds
-     * up deallocation for blocks allocated recently.
+     * in other words, memory is allocated top-down.
+     *
+     * For alignments larger than the chunk alignment, the block is
+     * carved on the required boundary, and the unused fragment below
+     * it is returned to the free lists, instead of being kept as
+     * padding in the allocated chunk. The bytes still allocated in
+     * excess are counted by `alignment_lost_bytes()`.
      *
      * @par Exceptions
      *   Throws nothing by itself, but the out of memory handler may
@@ -130,9 +373,18 @@ namespace os
     first_fit_top::do_allocate (std::size_t bytes, std::size_t alignment)
     {
       std::size_t block_padding = calc_block_padding (alignment);
+
+      // The size of the chunk when the payload is on the required boundary.
+      std::size_t aligned_size = os::rtos::memory::max (
+          rtos::memory::align_size (bytes, chunk_align) + chunk_offset
+              + guard_size,
+          calc_block_minchunk (0));
+
+      // The search must also fit the padding, in the worst case.
       std::size_t alloc_size = rtos::memory::align_size (bytes, chunk_align);
       alloc_size += block_padding;
       alloc_size += chunk_offset;
+      alloc_size += guard_size;
 
       std::size_t block_minchunk = calc_block_minchunk (block_padding);
       alloc_size = os::rtos::memory::max (alloc_size, block_minchunk);
@@ -141,52 +393,29 @@ namespace os
 
       while (true)
         {
-          chunk_t* prev_chunk = free_list_;
-          chunk = prev_chunk;
+          chunk = nullptr;
 
-          while (chunk)
+          std::size_t bin = bin_index (alloc_size);
+
+          // Search the list of the same size range; it may
+          // contain chunks smaller than the requested size.
+          for (chunk_t* c = bins_[bin]; c != nullptr; c = c->next)
             {
-              int rem = static_cast<int> (chunk->size - alloc_size);
-              if (rem >= 0)
+              if (chunk_size (c) >= alloc_size)
                 {
-                  if ((static_cast<std::size_t> (rem)) >= block_minchunk)
-                    {
-                      // Found a chunk that is much larger than required size
-                      // (at least one more chunk is available);
-                      // break it into two chunks and return the second one.
-
-                      chunk->size = static_cast<std::size_t> (rem);
-                      chunk =
-                          reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
-                              + rem);
-                      chunk->size = alloc_size;
-
-                      // Splitting one chunk creates one more chunk.
-                      ++free_chunks_;
-                    }
-                  else
-                    {
-                      // Found a chunk that is exactly the size or slightly
-                      // larger than the requested size; return this chunk.
-
-                      if (prev_chunk == chunk)
-                        {
-                          // This implies p==r==free_list, i.e. the list head.
-                          // The next chunk becomes the first list element.
-                          free_list_ = chunk->next;
-
-                          // If this was the last chunk, the free list is empty.
-                        }
-                      else
-                        {
-                          // Normal case. Remove it from the free_list.
-                          prev_chunk->next = chunk->next;
-                        }
-                    }
+                  chunk = c;
                   break;
                 }
-              prev_chunk = chunk;
-              chunk = chunk->next;
+            }
+
+          if ((chunk == nullptr) && (bin + 1 < bins_count))
+            {
+              // All chunks in the larger lists are large enough.
+              uint32_t map = bins_bitmap_ & (~0u << (bin + 1));
+              if (map != 0)
+                {
+                  chunk = bins_[ffs (map)];
+                }
             }
 
           if (chunk != nullptr)
@@ -214,6 +443,29 @@ namespace os
           // and try again to allocate.
         }
 
+      internal_remove_free_ (chunk);
+
+      chunk_t* aligned_chunk = nullptr;
+      if (block_padding != 0)
+        {
+          aligned_chunk = internal_carve_aligned_ (chunk, aligned_size,
+                                                   alignment);
+        }
+
+      if (aligned_chunk != nullptr)
+        {
+          chunk = aligned_chunk;
+        }
+      else
+        {
+          chunk = internal_split_top_ (chunk, alloc_size, block_minchunk);
+        }
+
+      if (block_padding != 0)
+        {
+          alignment_lost_bytes_ += chunk_size (chunk) - aligned_size;
+        }
+
       void* aligned_payload = internal_align_ (chunk, bytes, alignment);
 
 #if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
@@ -226,14 +478,12 @@ namespace os
 
     /**
      * @details
+     * The boundary tags identify the free chunks physically adjacent
+     * to the deallocated chunk; they are coalesced and the
+     * result is linked to the list for its size. No list is
+     * traversed, so deallocation is deterministic.
      *
-     * Deallocation is not guaranteed to be deterministic, but if
-     * done in strict reverse allocation order, it becomes deterministic,
-     * otherwise a traversal of the free list is required, the older the
-     * block, the more nodes to traverse (the free list is kept in
-     * ascending addresses order).
-     *
-     * If the block is already in the free list, issue a trace message,
+     * If the block is already free, issue a trace message,
      * but otherwise ignore the condition.
      *
      * @par Exceptions
@@ -267,11 +517,29 @@ namespace os
               + static_cast<std::ptrdiff_t> (chunk->size));
         }
 
+      if ((chunk->size & chunk_free_bit) != 0)
+        {
+          // Already freed.
+          trace::printf ("first_fit_top::%s(%p,%u,%u) @%p %s already freed\n",
+                         __func__, addr, bytes, alignment, this, name ());
+
+          return;
+        }
+
+      if (!internal_check_guard_ (chunk))
+        {
+          // The block was written past its end; the chunk is still
+          // freed, the next one may be damaged too.
+          os_rtos_memory_corruption_hook (this, chunk);
+        }
+
+      std::size_t size = chunk_size (chunk);
+
       if (bytes)
         {
           // If size is known, validate.
           // (when called from free(), the size is not known).
-          if (bytes + chunk_offset > chunk->size)
+          if (bytes + chunk_offset > size)
             {
               assert(false);
               return;
@@ -280,120 +548,183 @@ namespace os
 
       // Update statistics.
       // What is subtracted from allocated is added to free.
-      internal_decrease_allocated_statistics (chunk->size);
+      internal_decrease_allocated_statistics (size);
 
-      // If the free list is empty, create it with the current chunk, alone.
-      if (free_list_ == nullptr)
+      if ((chunk->size & chunk_prev_free_bit) != 0)
         {
-          // Mark the end of the list with a null pointer.
-          chunk->next = nullptr;
-
-          // The chunk becomes the first list element.
-          free_list_ = chunk;
-          assert(free_chunks_ == 1);
+          // The chunk to be freed is adjacent to a free chunk before it;
+          // its size is in the boundary tag.
+          std::size_t prev_size =
+              *(reinterpret_cast<std::size_t*> (chunk) - 1);
+          chunk_t* prev_chunk =
+              reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                  - prev_size);
+
+          internal_remove_free_ (prev_chunk);
+          internal_verify_merge_ (chunk, prev_chunk);
+          chunk = prev_chunk;
+          size += prev_size;
 
-          return;
+          // Coalescing means one less chunk.
+          --free_chunks_;
         }
 
-      // The free list exists; is the chunk before the list head?
-      if (chunk < free_list_)
+      char* end = reinterpret_cast<char*> (chunk) + size;
+      if (end < static_cast<char*> (arena_addr_) + total_bytes_)
         {
-          // Is the chunk *right* before the list head?
-          if (reinterpret_cast<char *> (chunk) + chunk->size
-              == reinterpret_cast<char *> (free_list_))
+          chunk_t* next_chunk = reinterpret_cast<chunk_t*> (end);
+          if ((next_chunk->size & chunk_free_bit) != 0)
             {
-              // Coalesce chunk to the list head.
-              chunk->size += free_list_->size;
-              chunk->next = free_list_->next; // May be nullptr
+              // The chunk to be freed is adjacent to a free chunk after it.
+              internal_remove_free_ (next_chunk);
+              internal_verify_merge_ (next_chunk, chunk);
+              size += chunk_size (next_chunk);
 
               // Coalescing means one less chunk.
               --free_chunks_;
             }
-          else
-            {
-              // Insert before the list head.
-              chunk->next = free_list_;
-            }
-          // The chunk becomes the new list head.
-          free_list_ = chunk;
+        }
 
-          return;
+      internal_insert_free_ (chunk, size);
+    }
+
+    /**
+     * @details
+     * When shrinking, the end of the chunk, if large enough, is
+     * split as a free chunk, coalesced with the next chunk
+     * if also free.
+     *
+     * When growing, the next chunk must be free and large enough;
+     * it is merged, and the unused part, if large enough, is
+     * split back as a free chunk.
+     *
+     * Both operations are deterministic, no list is traversed.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    bool
+    first_fit_top::do_try_resize (void* addr, std::size_t bytes,
+                                  std::size_t new_bytes) noexcept
+    {
+      // The address must be inside the arena.
+      if ((addr < arena_addr_)
+          || (addr > (static_cast<char*> (arena_addr_) + total_bytes_)))
+        {
+          assert(false);
+          return false;
         }
 
-      // Walk the free list to find the place to insert,
-      // (the list must be ordered by addresses).
-      // Warning: not deterministic!
+      // Compute the chunk address from the user address.
+      chunk_t* chunk = reinterpret_cast<chunk_t *> (static_cast<char *> (addr)
+          - chunk_offset);
 
-      chunk_t* next_chunk = free_list_;
-      chunk_t* prev_chunk;
-      do
+      // If the block was aligned, the offset appears as size; adjust back.
+      if (static_cast<std::ptrdiff_t> (chunk->size) < 0)
         {
-          prev_chunk = next_chunk;
-          next_chunk = next_chunk->next;
+          chunk = reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+              + static_cast<std::ptrdiff_t> (chunk->size));
         }
-      while (next_chunk != nullptr && next_chunk <= chunk);
 
-      // Now prev_chunk <= chunk and either next_chunk == nullptr or
-      // next_chunk > chunk.
-      // Try to merge with chunks immediately before/after it.
+      if ((chunk->size & chunk_free_bit) != 0)
+        {
+          assert(false);
+          return false;
+        }
 
-      if (reinterpret_cast<char *> (prev_chunk) + prev_chunk->size
-          == reinterpret_cast<char *> (chunk))
+      std::size_t size = chunk_size (chunk);
+      if (bytes + chunk_offset > size)
         {
-          // Chunk to be freed is adjacent to a free chunk before it.
-          prev_chunk->size += chunk->size;
+          assert(false);
+          return false;
+        }
 
-          // Coalescing means one less chunk.
-          --free_chunks_;
+      // The payload offset includes the alignment padding, if any.
+      std::size_t payload_offset = static_cast<std::size_t> (static_cast<char*> (addr)
+          - reinterpret_cast<char*> (chunk));
 
-          // If the merged chunk is also adjacent to the chunk after it,
-          // merge again. Does not match if next_chunk == nullptr.
-          if (reinterpret_cast<char *> (prev_chunk) + prev_chunk->size
-              == reinterpret_cast<char *> (next_chunk))
-            {
-              prev_chunk->size += next_chunk->size;
-              prev_chunk->next = next_chunk->next;
+      std::size_t new_size = rtos::memory::align_size (new_bytes, chunk_align)
+          + payload_offset + guard_size;
+      new_size = os::rtos::memory::max (new_size, calc_block_minchunk (0));
 
-              // Coalescing means one less chunk.
-              --free_chunks_;
+      char* arena_end = static_cast<char*> (arena_addr_) + total_bytes_;
+      char* end = reinterpret_cast<char*> (chunk) + size;
+      chunk_t* next_chunk = nullptr;
+      if ((end < arena_end)
+          && ((reinterpret_cast<chunk_t*> (end)->size & chunk_free_bit) != 0))
+        {
+          next_chunk = reinterpret_cast<chunk_t*> (end);
+        }
+
+      std::size_t avail_size = size;
+      if (new_size > size)
+        {
+          if ((next_chunk == nullptr)
+              || (size + chunk_size (next_chunk) < new_size))
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("first_fit_top::%s(%p,%u,%u)=false @%p %s\n",
+                             __func__, addr, bytes, new_bytes, this, name ());
+#endif
+              return false;
             }
         }
-      else if (reinterpret_cast<char *> (prev_chunk) + prev_chunk->size
-          > reinterpret_cast<char *> (chunk))
+      else if ((size - new_size < chunk_minsize) && (next_chunk == nullptr))
         {
-          // Already freed.
+          // Shrinking with a remaining part too small for a free chunk;
+          // keep the chunk as is.
+          return true;
+        }
 
-          // Revert statistics.
-          // What is subtracted from free is added to allocated.
-          allocated_bytes_ += chunk->size;
-          free_bytes_ -= chunk->size;
-          ++allocated_chunks_;
+      if (next_chunk != nullptr)
+        {
+          // Merge the next free chunk; it will be split back below
+          // if not needed entirely.
+          internal_remove_free_ (next_chunk);
+          internal_verify_merge_ (next_chunk, chunk);
+          avail_size += chunk_size (next_chunk);
           --free_chunks_;
-
-          trace::printf ("first_fit_top::%s(%p,%u,%u) @%p %s already freed\n",
-                         __func__, addr, bytes, alignment, this, name ());
-
-          return;
         }
-      // Does not match if next_chunk == nullptr.
-      else if (reinterpret_cast<char *> (chunk) + chunk->size
-          == reinterpret_cast<char *> (next_chunk))
-        {
-          // The chunk to be freed is adjacent to a free chunk after it.
-          chunk->size += next_chunk->size;
-          chunk->next = next_chunk->next; // May be nullptr.
-          prev_chunk->next = chunk;
 
-          // Coalescing means one less chunk.
-          --free_chunks_;
+      std::size_t rem = avail_size - new_size;
+      if (rem >= chunk_minsize)
+        {
+          // Return the unused end to the free chunks.
+          internal_insert_free_ (
+              reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                  + new_size),
+              rem);
+          ++free_chunks_;
         }
       else
         {
-          // Not adjacent to any chunk. Just insert it.
-          // The result is a new fragment. Not great...
-          chunk->next = next_chunk; // May be nullptr.
-          prev_chunk->next = chunk;
+          new_size = avail_size;
+          end = reinterpret_cast<char*> (chunk) + new_size;
+          if (end < arena_end)
+            {
+              reinterpret_cast<chunk_t*> (end)->size &= ~chunk_prev_free_bit;
+            }
+        }
+
+      // Preserve the flag of the previous chunk.
+      chunk->size = new_size | (chunk->size & chunk_prev_free_bit);
+      internal_set_guard_ (chunk);
+
+      // Update statistics, the difference moves between allocated
+      // and free; the number of allocated chunks is the same.
+      allocated_bytes_ = allocated_bytes_ + new_size - size;
+      free_bytes_ = free_bytes_ + size - new_size;
+      if (allocated_bytes_ > max_allocated_bytes_)
+        {
+          max_allocated_bytes_ = allocated_bytes_;
         }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("first_fit_top::%s(%p,%u,%u)=true,%u @%p %s\n", __func__,
+                     addr, bytes, new_bytes, new_size, this, name ());
+#endif
+
+      return true;
     }
 
     /**
@@ -414,14 +745,15 @@ namespace os
     {
       // Update statistics.
       // The value subtracted from free is added to allocated.
-      internal_increase_allocated_statistics (chunk->size);
+      internal_increase_allocated_statistics (chunk_size (chunk));
 
       // Compute pointer to payload area.
       char* payload = reinterpret_cast<char *> (chunk) + chunk_offset;
 
       // Align it to user provided alignment.
       void* aligned_payload = payload;
-      std::size_t aligned_size = chunk->size - chunk_offset;
+      std::size_t aligned_size = chunk_size (chunk) - chunk_offset
+          - guard_size;
 
       void* res;
       res = std::align (alignment, bytes, aligned_payload, aligned_size);
@@ -443,6 +775,8 @@ namespace os
           adj_chunk->size = static_cast<std::size_t> (-offset);
         }
 
+      internal_set_guard_ (chunk);
+
       assert(
           (reinterpret_cast<uintptr_t> (aligned_payload) & (alignment - 1))
               == 0);
@@ -450,6 +784,250 @@ namespace os
       return aligned_payload;
     }
 
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     * The size is maintained when chunks are freed; only after the
+     * largest chunk is allocated, the list with the largest chunks is
+     * searched, once.
+     *
+     * The result is the size of the largest block that can be
+     * allocated, with the default alignment.
+     */
+    std::size_t
+    first_fit_top::do_max_free_chunk (void) noexcept
+    {
+      if (max_free_size_ == max_free_unknown)
+        {
+          max_free_size_ = 0;
+          if (bins_bitmap_ != 0)
+            {
+              std::size_t bin = fls (bins_bitmap_);
+              for (chunk_t* c = bins_[bin]; c != nullptr; c = c->next)
+                {
+                  std::size_t size = chunk_size (c);
+                  if (size > max_free_size_)
+                    {
+                      max_free_size_ = size;
+                    }
+                }
+            }
+        }
+
+      return (max_free_size_ > (chunk_offset + guard_size)) ?
+          (max_free_size_ - chunk_offset - guard_size) : 0;
+    }
+
+    /**
+     * @details
+     * The chunks are checked in the physical order, starting
+     * with the one after the last chunk checked by the previous call;
+     * after the last chunk in the arena, the check continues with
+     * the first one.
+     *
+     * For each chunk are checked the size, the flags
+     * shared with the next chunk, the boundary tag and the list links
+     * of free chunks, and the guard word of allocated chunks; no list
+     * is traversed, so the duration is proportional to _chunks_.
+     *
+     * After a damaged chunk is found, the next check starts again
+     * with the first chunk.
+     */
+    const void*
+    first_fit_top::do_verify (std::size_t chunks) noexcept
+    {
+      if (arena_addr_ == nullptr)
+        {
+          return nullptr;
+        }
+
+      char* arena_end = static_cast<char*> (arena_addr_) + total_bytes_;
+
+      for (std::size_t i = 0; i < chunks; ++i)
+        {
+          chunk_t* chunk = verify_next_;
+          if (chunk == nullptr)
+            {
+              chunk = reinterpret_cast<chunk_t*> (arena_addr_);
+            }
+
+          if (!internal_verify_chunk_ (chunk))
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("first_fit_top::%s() @%p %s damaged chunk %p\n",
+                             __func__, this, name (), chunk);
+#endif
+              verify_next_ = nullptr;
+              return chunk;
+            }
+
+          char* end = reinterpret_cast<char*> (chunk) + chunk_size (chunk);
+          if (end < arena_end)
+            {
+              verify_next_ = reinterpret_cast<chunk_t*> (end);
+            }
+          else
+            {
+              verify_next_ = nullptr;
+            }
+        }
+
+      return nullptr;
+    }
+
+    /**
+     * @details
+     * Only the chunk and the flags of the chunk after it are
+     * accessed; the list links are followed one step, and only
+     * if inside the arena.
+     */
+    bool
+    first_fit_top::internal_verify_chunk_ (const chunk_t* chunk) const noexcept
+    {
+      const char* begin = static_cast<const char*> (arena_addr_);
+      const char* arena_end = begin + total_bytes_;
+      const char* addr = reinterpret_cast<const char*> (chunk);
+
+      auto inside = [begin, arena_end](const chunk_t* c) -> bool
+        {
+          const char* a = reinterpret_cast<const char*> (c);
+          return (a >= begin) && (a + chunk_minsize <= arena_end)
+          && ((reinterpret_cast<uintptr_t> (a) & (chunk_align - 1)) == 0);
+        };
+
+      std::size_t size = chunk_size (chunk);
+      if ((size < chunk_minsize) || ((size & (chunk_align - 1)) != 0)
+          || (size > static_cast<std::size_t> (arena_end - addr)))
+        {
+          return false;
+        }
+
+      if ((addr == begin) && ((chunk->size & chunk_prev_free_bit) != 0))
+        {
+          // There is nothing before the first chunk.
+          return false;
+        }
+
+      const char* end = addr + size;
+      const chunk_t* next_chunk = nullptr;
+      if (end < arena_end)
+        {
+          next_chunk = reinterpret_cast<const chunk_t*> (end);
+        }
+
+      if ((chunk->size & chunk_free_bit) == 0)
+        {
+          // Allocated.
+          if ((next_chunk != nullptr)
+              && ((next_chunk->size & chunk_prev_free_bit) != 0))
+            {
+              return false;
+            }
+
+          return internal_check_guard_ (chunk);
+        }
+
+      // Free.
+      if (*reinterpret_cast<const std::size_t*> (end - sizeof(std::size_t))
+          != size)
+        {
+          // The boundary tag was overwritten.
+          return false;
+        }
+
+      if (next_chunk != nullptr)
+        {
+          // Adjacent free chunks are always coalesced.
+          if (((next_chunk->size & chunk_prev_free_bit) == 0)
+              || ((next_chunk->size & chunk_free_bit) != 0))
+            {
+              return false;
+            }
+        }
+
+      if (chunk->next != nullptr)
+        {
+          if (!inside (chunk->next) || (chunk->next->prev != chunk))
+            {
+              return false;
+            }
+        }
+
+      if (chunk->prev != nullptr)
+        {
+          if (!inside (chunk->prev) || (chunk->prev->next != chunk))
+            {
+              return false;
+            }
+        }
+      else
+        {
+          // The list head.
+          std::size_t bin = bin_index (size);
+          if ((bins_[bin] != chunk) || ((bins_bitmap_ & (1u << bin)) == 0))
+            {
+              return false;
+            }
+        }
+
+      return true;
+    }
+
+    /**
+     * @details
+     * The chunk the verify position points to may disappear when
+     * coalesced; continue with the chunk that includes it.
+     */
+    void
+    first_fit_top::internal_verify_merge_ (const chunk_t* removed,
+                                           chunk_t* survivor) noexcept
+    {
+      if (verify_next_ == removed)
+        {
+          verify_next_ = survivor;
+        }
+    }
+
+#pragma GCC diagnostic push
+// Needed because 'chunk' is not used without guard words.
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * Used only when `OS_INCLUDE_MEMORY_GUARD_WORDS` is defined.
+     *
+     * The guard word is the last word of the chunk, after the
+     * payload; it also depends on the chunk address, so a block
+     * copied over the next one is detected too.
+     */
+    void
+    first_fit_top::internal_set_guard_ (chunk_t* chunk) noexcept
+    {
+#if defined(OS_INCLUDE_MEMORY_GUARD_WORDS)
+      char* end = reinterpret_cast<char*> (chunk) + chunk_size (chunk);
+      *reinterpret_cast<std::size_t*> (end - guard_size) = guard_magic
+          ^ reinterpret_cast<uintptr_t> (chunk);
+#endif
+    }
+
+    /**
+     * @details
+     * Without guard words, always returns `true`.
+     */
+    bool
+    first_fit_top::internal_check_guard_ (const chunk_t* chunk) const noexcept
+    {
+#if defined(OS_INCLUDE_MEMORY_GUARD_WORDS)
+      const char* end = reinterpret_cast<const char*> (chunk)
+          + chunk_size (chunk);
+      return *reinterpret_cast<const std::size_t*> (end - guard_size)
+          == (guard_magic ^ reinterpret_cast<uintptr_t> (chunk));
+#else
+      return true;
+#endif
+    }
+
 #pragma GCC diagnostic pop
 
   // --------------------------------------------------------------------------
@@ -80,6 +80,7 @@ namespace os
       std::size_t alloc_size = rtos::memory::align_size (bytes, chunk_align);
       alloc_size += block_padding;
       alloc_size += chunk_offset;
+      alloc_size += guard_size;
 
       std::size_t block_minchunk = calc_block_minchunk (block_padding);
       alloc_size = os::rtos::memory::max (alloc_size, block_minchunk);
@@ -89,44 +90,16 @@ namespace os
       while (true)
         {
           // Allocate only from the first block and only if it is
-          // the really first in the arena; this prevents fragmentation.
-          if (free_list_ == reinterpret_cast<chunk_t*> (arena_addr_))
+          // free; this prevents fragmentation.
+          chunk_t* first = reinterpret_cast<chunk_t*> (arena_addr_);
+          if (((first->size & chunk_free_bit) != 0)
+              && (chunk_size (first) >= alloc_size))
             {
-              chunk = free_list_;
-
-              int rem = static_cast<int> (chunk->size - alloc_size);
-              if (rem >= 0)
-                {
-                  if ((static_cast<std::size_t> (rem)) >= block_minchunk)
-                    {
-                      // If the chunk is larger than needed
-                      // (at least one more chunk is available);
-                      // break it into two chunks and return the top one.
-
-                      // Shrink bottom chunk to remaining size.
-                      chunk->size = static_cast<std::size_t> (rem);
-
-                      // Compute where top chunk starts.
-                      chunk =
-                          reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
-                              + rem);
-                      chunk->size = alloc_size;
-
-                      // Splitting one chunk creates one more chunk.
-                      ++free_chunks_;
-                    }
-                  else
-                    {
-                      // Found a chunk that is exactly the size or slightly
-                      // larger than the requested size; return this chunk.
-
-                      // Always at the list head.
-                      // The next chunk becomes the first list element.
-                      free_list_ = chunk->next;
-
-                      // If this was the last chunk, the free list is empty.
-                    }
-                }
+              // If the chunk is larger than needed
+              // (at least one more chunk is available);
+              // break it into two chunks and return the top one.
+              internal_remove_free_ (first);
+              chunk = internal_split_top_ (first, alloc_size, block_minchunk);
             }
 
           if (chunk != nullptr)
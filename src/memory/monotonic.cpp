@@ -0,0 +1,289 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/memory/monotonic.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     * All buffers obtained from upstream are returned.
+     */
+    monotonic::~monotonic ()
+    {
+      trace::printf ("monotonic::%s() @%p %s\n", __func__, this, name ());
+
+      release ();
+    }
+
+    /**
+     * @details
+     */
+    void
+    monotonic::internal_construct_ (void* addr, std::size_t bytes,
+                                    rtos::memory::memory_resource* upstream)
+    {
+      assert((addr != nullptr) || (bytes == 0));
+
+      arena_addr_ = addr;
+      total_bytes_ = bytes;
+      upstream_ = upstream;
+
+      release ();
+    }
+
+    /**
+     * @details
+     * All upstream buffers allocated after the mark are returned,
+     * and the position in the buffer current at the time of the mark
+     * is restored; all memory allocated after the mark can be reused.
+     *
+     * Marks must be released in the reverse order they were
+     * taken; releasing to a mark invalidates all later marks.
+     *
+     * Deterministic when there is no upstream memory resource.
+     */
+    void
+    monotonic::release_to (const mark_t& m) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic::%s(%p) @%p %s\n", __func__, m.position, this,
+                     name ());
+#endif
+
+      while (buffer_ != m.buffer)
+        {
+          // The mark is not in this memory resource.
+          assert(buffer_ != nullptr);
+
+          buffer_t* buffer = buffer_;
+          buffer_ = buffer->prev;
+          upstream_->deallocate (buffer, buffer->size, max_align);
+        }
+
+      if (buffer_ == nullptr)
+        {
+          end_ = static_cast<char*> (arena_addr_) + total_bytes_;
+          next_buffer_size_ = total_bytes_;
+        }
+      else
+        {
+          end_ = reinterpret_cast<char*> (buffer_) + buffer_->size;
+          next_buffer_size_ = buffer_->size * 2;
+        }
+      position_ = m.position;
+
+      allocated_bytes_ = m.allocated_bytes;
+      allocated_chunks_ = m.allocated_chunks;
+      free_bytes_ = static_cast<std::size_t> (end_ - position_);
+      free_chunks_ = (free_bytes_ > 0) ? 1 : 0;
+    }
+
+    /**
+     * @details
+     * All upstream buffers are returned and the entire arena
+     * can be reused.
+     */
+    void
+    monotonic::release (void) noexcept
+    {
+      release_to (mark_t
+        { nullptr, static_cast<char*> (arena_addr_), 0, 0 });
+    }
+
+    /**
+     * @details
+     * Each new buffer is at least twice as large as the previous one,
+     * to keep the number of upstream allocations low.
+     */
+    bool
+    monotonic::internal_grow_ (std::size_t bytes, std::size_t alignment)
+    {
+      std::size_t need = sizeof(buffer_t) + alignment + bytes;
+      std::size_t size = rtos::memory::align_size (
+          (next_buffer_size_ > need) ? next_buffer_size_ : need, max_align);
+
+      void* p = upstream_->allocate (size, max_align);
+      if (p == nullptr)
+        {
+          return false;
+        }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic::%s(%u)=%p,%u @%p %s\n", __func__, bytes, p,
+                     size, this, name ());
+#endif
+
+      buffer_t* buffer = static_cast<buffer_t*> (p);
+      buffer->prev = buffer_;
+      buffer->size = size;
+      buffer_ = buffer;
+
+      // The rest of the previous buffer is abandoned.
+      position_ = reinterpret_cast<char*> (buffer + 1);
+      end_ = static_cast<char*> (p) + size;
+
+      free_bytes_ = static_cast<std::size_t> (end_ - position_);
+      free_chunks_ = 1;
+
+      next_buffer_size_ = size * 2;
+      return true;
+    }
+
+    /**
+     * @details
+     * Reset the memory manager to the initial state, returning
+     * all upstream buffers.
+     */
+    void
+    monotonic::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      release ();
+      max_allocated_bytes_ = 0;
+    }
+
+    /**
+     * @details
+     * The block is taken from the current position, after
+     * aligning it; if the current buffer is exhausted,
+     * a new buffer is requested from upstream.
+     *
+     * Allocations from the existing buffers are deterministic.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    monotonic::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      while (true)
+        {
+          std::size_t pos = reinterpret_cast<std::size_t> (position_);
+          std::size_t padding = rtos::memory::align_size (pos, alignment)
+              - pos;
+          std::size_t avail = static_cast<std::size_t> (end_ - position_);
+
+          if ((position_ != nullptr) && (padding <= avail)
+              && (bytes <= avail - padding))
+            {
+              void* p = position_ + padding;
+              position_ += padding + bytes;
+
+              // Update statistics.
+              allocated_bytes_ += padding + bytes;
+              if (allocated_bytes_ > max_allocated_bytes_)
+                {
+                  max_allocated_bytes_ = allocated_bytes_;
+                }
+              free_bytes_ = avail - padding - bytes;
+              free_chunks_ = (free_bytes_ > 0) ? 1 : 0;
+              ++allocated_chunks_;
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("monotonic::%s(%u,%u)=%p @%p %s\n", __func__,
+                             bytes, alignment, p, this, name ());
+#endif
+              return p;
+            }
+
+          if ((upstream_ != nullptr) && internal_grow_ (bytes, alignment))
+            {
+              continue;
+            }
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("monotonic::%s(%u,%u)=0 @%p %s\n", __func__,
+                             bytes, alignment, this, name ());
+#endif
+
+              return nullptr;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("monotonic::%s(%u,%u) @%p %s out of memory\n",
+                         __func__, bytes, alignment, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+    }
+
+#pragma GCC diagnostic push
+// Needed because the parameters are used only in trace calls.
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * Has no effect; the memory is reclaimed only by
+     * `release_to()`, `release()` or `reset()`.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    void
+    monotonic::do_deallocate (void* addr, std::size_t bytes,
+                              std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic::%s(%p,%u,%u) @%p %s\n", __func__, addr,
+                     bytes, alignment, this, name ());
+#endif
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     * With an upstream memory resource the limit is not known.
+     */
+    std::size_t
+    monotonic::do_max_size (void) const noexcept
+    {
+      return (upstream_ != nullptr) ? 0 : total_bytes_;
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,381 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/memory/pool.h>
+
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The configuration is adjusted to the supported limits.
+     */
+    pool::pool (const char* name, const pool_options& opts,
+                rtos::memory::memory_resource* upstream) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      trace::printf ("pool::%s(%u,%u) @%p %s\n", __func__,
+                     opts.max_blocks_per_chunk,
+                     opts.largest_required_pool_block, this, this->name ());
+
+      options_ = opts;
+      if (options_.max_blocks_per_chunk == 0)
+        {
+          options_.max_blocks_per_chunk = 1;
+        }
+
+      upstream_ =
+          (upstream != nullptr) ?
+              upstream : rtos::memory::get_default_resource ();
+
+      // Count the power of 2 block sizes up to the largest required.
+      pools_count_ = 1;
+      while ((pools_count_ < max_pools)
+          && ((min_block_size_bytes << (pools_count_ - 1))
+              < options_.largest_required_pool_block))
+        {
+          ++pools_count_;
+        }
+      options_.largest_required_pool_block = min_block_size_bytes
+          << (pools_count_ - 1);
+
+      for (std::size_t i = 0; i < max_pools; ++i)
+        {
+          chunks_[i] = nullptr;
+        }
+
+      release ();
+    }
+
+    /**
+     * @details
+     * All chunks are returned to upstream.
+     */
+    pool::~pool ()
+    {
+      trace::printf ("pool::%s() @%p %s\n", __func__, this, name ());
+
+      release ();
+    }
+
+    /**
+     * @details
+     * Blocks larger than the largest required pool block,
+     * allocated directly from upstream, are not affected.
+     */
+    void
+    pool::release (void) noexcept
+    {
+      for (std::size_t i = 0; i < pools_count_; ++i)
+        {
+          chunk_t* chunk = chunks_[i];
+          while (chunk != nullptr)
+            {
+              chunk_t* next = chunk->next;
+
+              chunk_pool (chunk).~block_pool ();
+              upstream_->deallocate (chunk, chunk->size, max_align);
+
+              chunk = next;
+            }
+          chunks_[i] = nullptr;
+
+          // Restart with small chunks.
+          next_blocks_[i] =
+              (options_.max_blocks_per_chunk < 4) ?
+                  options_.max_blocks_per_chunk : 4;
+        }
+
+      total_bytes_ = 0;
+      allocated_bytes_ = 0;
+      free_bytes_ = 0;
+      allocated_chunks_ = 0;
+      free_chunks_ = 0;
+    }
+
+    /**
+     * @details
+     * Deterministic, the block size is the smallest power of 2 not
+     * lower than the number of bytes and the alignment.
+     */
+    std::size_t
+    pool::internal_pool_index_ (std::size_t bytes, std::size_t alignment) const
+        noexcept
+    {
+      if ((bytes > options_.largest_required_pool_block)
+          || (alignment > max_align))
+        {
+          return pools_count_;
+        }
+
+      std::size_t index = 0;
+      std::size_t size = min_block_size_bytes;
+      while ((size < bytes) || (size < alignment))
+        {
+          size <<= 1;
+          ++index;
+        }
+
+      return index;
+    }
+
+    /**
+     * @details
+     * Linear search, the number of chunks is usually small.
+     */
+    pool::chunk_t*
+    pool::internal_find_chunk_ (std::size_t index, void* addr) const noexcept
+    {
+      for (chunk_t* chunk = chunks_[index]; chunk != nullptr; chunk =
+          chunk->next)
+        {
+          char* begin = reinterpret_cast<char*> (chunk)
+              + rtos::memory::align_size (sizeof(chunk_t), max_align);
+          char* end = begin + chunk_pool (chunk).total_bytes ();
+
+          if ((addr >= begin) && (addr < end))
+            {
+              return chunk;
+            }
+        }
+
+      return nullptr;
+    }
+
+    /**
+     * @details
+     * The new chunk is added at the beginning of the list, so
+     * the next allocations find it first.
+     *
+     * Since the header is aligned to `max_align`, all
+     * blocks are aligned to their size, up to `max_align`.
+     */
+    pool::chunk_t*
+    pool::internal_grow_ (std::size_t index)
+    {
+      std::size_t block_size = min_block_size_bytes << index;
+      std::size_t blocks = next_blocks_[index];
+      std::size_t header_size = rtos::memory::align_size (sizeof(chunk_t),
+                                                          max_align);
+      std::size_t size = header_size + blocks * block_size;
+
+      void* p = upstream_->allocate (size, max_align);
+      if (p == nullptr)
+        {
+          return nullptr;
+        }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("pool::%s(%u)=%p,%u*%u @%p %s\n", __func__, block_size, p,
+                     blocks, block_size, this, name ());
+#endif
+
+      chunk_t* chunk = static_cast<chunk_t*> (p);
+      chunk->size = size;
+      new (&chunk->storage) block_pool
+        { blocks, block_size, static_cast<char*> (p) + header_size, blocks
+            * block_size };
+
+      chunk->next = chunks_[index];
+      chunks_[index] = chunk;
+
+      // Double the size of the next chunk.
+      next_blocks_[index] =
+          (blocks * 2 < options_.max_blocks_per_chunk) ?
+              blocks * 2 : options_.max_blocks_per_chunk;
+
+      // Update statistics.
+      total_bytes_ += blocks * block_size;
+      free_bytes_ += blocks * block_size;
+      free_chunks_ += blocks;
+
+      return chunk;
+    }
+
+    /**
+     * @details
+     */
+    void
+    pool::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("pool::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      release ();
+      max_allocated_bytes_ = 0;
+    }
+
+    /**
+     * @details
+     * The chunks of the selected pool are searched for a free block;
+     * if all are full, a new chunk is allocated from upstream.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    pool::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      std::size_t index = internal_pool_index_ (bytes, alignment);
+      void* p;
+
+      while (true)
+        {
+          if (index < pools_count_)
+            {
+              std::size_t block_size = min_block_size_bytes << index;
+
+              chunk_t* chunk = chunks_[index];
+              while ((chunk != nullptr) && (chunk_pool (chunk).free_chunks () == 0))
+                {
+                  chunk = chunk->next;
+                }
+
+              if (chunk == nullptr)
+                {
+                  chunk = internal_grow_ (index);
+                }
+
+              if (chunk != nullptr)
+                {
+                  p = chunk_pool (chunk).allocate (block_size, alignment);
+
+                  // Update statistics.
+                  // What is subtracted from free is added to allocated.
+                  internal_increase_allocated_statistics (block_size);
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+                  trace::printf ("pool::%s(%u,%u)=%p,%u @%p %s\n", __func__,
+                                 bytes, alignment, p, block_size, this,
+                                 name ());
+#endif
+                  return p;
+                }
+            }
+          else
+            {
+              p = upstream_->allocate (bytes, alignment);
+              if (p != nullptr)
+                {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+                  trace::printf ("pool::%s(%u,%u)=%p upstream @%p %s\n",
+                                 __func__, bytes, alignment, p, this, name ());
+#endif
+                  return p;
+                }
+            }
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("pool::%s(%u,%u)=0 @%p %s\n", __func__, bytes,
+                             alignment, this, name ());
+#endif
+
+              return nullptr;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("pool::%s(%u,%u) @%p %s out of memory\n", __func__,
+                         bytes, alignment, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+    }
+
+    /**
+     * @details
+     * The pool is identified by the number of bytes and the alignment;
+     * if the number of bytes is not known, all pools are searched.
+     * Addresses not found in any chunk are forwarded to upstream.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    void
+    pool::do_deallocate (void* addr, std::size_t bytes,
+                         std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("pool::%s(%p,%u,%u) @%p %s\n", __func__, addr, bytes,
+                     alignment, this, name ());
+#endif
+
+      std::size_t first = 0;
+      std::size_t last = pools_count_;
+      if (bytes != 0)
+        {
+          first = internal_pool_index_ (bytes, alignment);
+          last = first + 1;
+        }
+
+      for (std::size_t i = first; i < last && i < pools_count_; ++i)
+        {
+          chunk_t* chunk = internal_find_chunk_ (i, addr);
+          if (chunk != nullptr)
+            {
+              std::size_t block_size = min_block_size_bytes << i;
+              chunk_pool (chunk).deallocate (addr, block_size, alignment);
+
+              // Update statistics.
+              // What is subtracted from allocated is added to free.
+              internal_decrease_allocated_statistics (block_size);
+              return;
+            }
+        }
+
+      upstream_->deallocate (addr, bytes, alignment);
+    }
+
+    /**
+     * @details
+     */
+    std::size_t
+    pool::do_max_size (void) const noexcept
+    {
+      return upstream_->max_size ();
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
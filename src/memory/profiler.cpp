@@ -0,0 +1,369 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/memory/profiler.h>
+
+#if defined(OS_INCLUDE_MEMORY_PROFILER)
+
+#include <cmsis-plus/posix-io/io.h>
+
+#include <cstdio>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     */
+    profiler::profiler (const char* name,
+                        rtos::memory::memory_resource* resource) :
+        rtos::memory::memory_resource
+          { (name != nullptr) ? name : resource->name () }
+    {
+      trace::printf ("profiler::%s(%p) @%p %s\n", __func__, resource, this,
+                     this->name ());
+
+      assert(resource != nullptr);
+      resource_ = resource;
+
+      clear ();
+    }
+
+    /**
+     * @details
+     */
+    profiler::~profiler ()
+    {
+      trace::printf ("profiler::%s() @%p %s\n", __func__, this, name ());
+    }
+
+    /**
+     * @details
+     * The wrapped memory resource is not affected.
+     */
+    void
+    profiler::clear (void) noexcept
+    {
+      rtos::scheduler::critical_section scs;
+
+      records_count_ = 0;
+      for (std::size_t i = 0; i < max_live_allocations; ++i)
+        {
+          live_[i].addr = nullptr;
+        }
+      live_count_ = 0;
+      untracked_count_ = 0;
+    }
+
+    /**
+     * @details
+     */
+    const profiler::record_t&
+    profiler::record (std::size_t index) const
+    {
+      assert(index < records ());
+
+      std::size_t first =
+          (records_count_ < max_records) ? 0 : (records_count_ % max_records);
+      return records_[(first + index) % max_records];
+    }
+
+    /**
+     * @details
+     * The record is stored in the ring buffer, overwriting the
+     * oldest one, and the live allocations table is updated.
+     *
+     * Statistics are copied from the wrapped memory resource.
+     */
+    void
+    profiler::internal_record_ (operation_t operation, void* caller,
+                                void* addr, std::size_t bytes) noexcept
+    {
+      rtos::clock::timestamp_t timestamp = rtos::hrclock.now ();
+
+      rtos::scheduler::critical_section scs;
+
+      record_t& r = records_[records_count_ % max_records];
+      r.timestamp = timestamp;
+      r.caller = caller;
+      r.addr = addr;
+      r.bytes = bytes;
+      r.operation = operation;
+      ++records_count_;
+
+      if (operation == allocation)
+        {
+          std::size_t i;
+          for (i = 0; i < max_live_allocations; ++i)
+            {
+              if (live_[i].addr == nullptr)
+                {
+                  live_[i].timestamp = timestamp;
+                  live_[i].caller = caller;
+                  live_[i].addr = addr;
+                  live_[i].bytes = bytes;
+                  ++live_count_;
+                  break;
+                }
+            }
+          if (i == max_live_allocations)
+            {
+              ++untracked_count_;
+            }
+        }
+      else if (operation == deallocation)
+        {
+          for (std::size_t i = 0; i < max_live_allocations; ++i)
+            {
+              if (live_[i].addr == addr)
+                {
+                  live_[i].addr = nullptr;
+                  --live_count_;
+                  break;
+                }
+            }
+        }
+
+      total_bytes_ = resource_->total_bytes ();
+      allocated_bytes_ = resource_->allocated_bytes ();
+      max_allocated_bytes_ = resource_->max_allocated_bytes ();
+      free_bytes_ = resource_->free_bytes ();
+      allocated_chunks_ = resource_->allocated_chunks ();
+      free_chunks_ = resource_->free_chunks ();
+    }
+
+    /**
+     * @details
+     * Records are formatted as `a|x|d addr bytes caller timestamp`,
+     * for allocations, failed allocations and deallocations,
+     * and live allocations as `L addr bytes caller timestamp`.
+     */
+    int
+    profiler::internal_format_ (char* buf, std::size_t size,
+                                std::size_t index) const
+    {
+      char type;
+      live_t e;
+
+        {
+          rtos::scheduler::critical_section scs;
+
+          if (index < records ())
+            {
+              const record_t& r = record (index);
+              type =
+                  (r.operation == allocation) ? 'a' :
+                  (r.operation == failed_allocation) ? 'x' : 'd';
+              e.timestamp = r.timestamp;
+              e.caller = r.caller;
+              e.addr = r.addr;
+              e.bytes = r.bytes;
+            }
+          else
+            {
+              index -= records ();
+              assert(index < max_live_allocations);
+
+              e = live_[index];
+              if (e.addr == nullptr)
+                {
+                  return 0;
+                }
+              type = 'L';
+            }
+        }
+
+      return snprintf (buf, size, "%c %p %u %p %lu\n", type, e.addr,
+                       static_cast<unsigned int> (e.bytes), e.caller,
+                       static_cast<unsigned long> (e.timestamp));
+    }
+
+    /**
+     * @details
+     * Oldest records are displayed first, followed by the
+     * blocks not yet deallocated.
+     */
+    void
+    profiler::dump (void)
+    {
+      trace::printf ("profiler %s: %u records, %u live, %u untracked\n",
+                     name (), records (), live_allocations (),
+                     untracked_allocations ());
+
+      char buf[80];
+      for (std::size_t i = 0; i < records () + max_live_allocations; ++i)
+        {
+          if (internal_format_ (buf, sizeof(buf), i) > 0)
+            {
+              trace::printf ("%s", buf);
+            }
+        }
+    }
+
+    /**
+     * @details
+     * The same content as displayed by `dump()` is written to
+     * the file, which must be already open.
+     */
+    int
+    profiler::dump (posix::io& out)
+    {
+      char buf[80];
+      int n = snprintf (buf, sizeof(buf),
+                        "profiler %s: %u records, %u live, %u untracked\n",
+                        name (), static_cast<unsigned int> (records ()),
+                        static_cast<unsigned int> (live_allocations ()),
+                        static_cast<unsigned int> (untracked_allocations ()));
+
+      std::size_t i = 0;
+      while (true)
+        {
+          if (n > 0)
+            {
+              if (out.write (buf, static_cast<std::size_t> (n)) < 0)
+                {
+                  return -1;
+                }
+            }
+
+          if (i >= records () + max_live_allocations)
+            {
+              break;
+            }
+          n = internal_format_ (buf, sizeof(buf), i++);
+        }
+
+      return 0;
+    }
+
+    /**
+     * @details
+     */
+    void
+    profiler::do_reset (void) noexcept
+    {
+      resource_->reset ();
+      clear ();
+    }
+
+    /**
+     * @details
+     */
+    void*
+    profiler::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      void* caller = __builtin_return_address (0);
+
+      void* p = resource_->allocate (bytes, alignment);
+
+      internal_record_ ((p != nullptr) ? allocation : failed_allocation,
+                        caller, p, bytes);
+
+      return p;
+    }
+
+    /**
+     * @details
+     */
+    void
+    profiler::do_deallocate (void* addr, std::size_t bytes,
+                             std::size_t alignment) noexcept
+    {
+      void* caller = __builtin_return_address (0);
+
+      resource_->deallocate (addr, bytes, alignment);
+
+      internal_record_ (deallocation, caller, addr, bytes);
+    }
+
+    /**
+     * @details
+     */
+    std::size_t
+    profiler::do_max_size (void) const noexcept
+    {
+      return resource_->max_size ();
+    }
+
+    /**
+     * @details
+     */
+    bool
+    profiler::do_coalesce (void) noexcept
+    {
+      return resource_->coalesce ();
+    }
+
+    /**
+     * @details
+     * A successful resize updates the size of the live allocation.
+     */
+    bool
+    profiler::do_try_resize (void* addr, std::size_t bytes,
+                             std::size_t new_bytes) noexcept
+    {
+      if (!resource_->try_resize (addr, bytes, new_bytes))
+        {
+          return false;
+        }
+
+      rtos::scheduler::critical_section scs;
+
+      for (std::size_t i = 0; i < max_live_allocations; ++i)
+        {
+          if (live_[i].addr == addr)
+            {
+              live_[i].bytes = new_bytes;
+              break;
+            }
+        }
+
+      return true;
+    }
+
+    /**
+     * @details
+     */
+    const void*
+    profiler::do_verify (std::size_t chunks) noexcept
+    {
+      return resource_->verify (chunks);
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_MEMORY_PROFILER) */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,287 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/memory/slab.h>
+#include <memory>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The block pools are constructed in place, so they must be
+     * explicitly destructed.
+     */
+    slab::~slab ()
+    {
+      trace::printf ("slab::%s() @%p %s\n", __func__, this, name ());
+
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          size_class (i).~block_pool ();
+        }
+      count_ = 0;
+    }
+
+    /**
+     * @details
+     * The arena is split in consecutive slices, one for each
+     * size class, each aligned to `max_align`; the size of the
+     * arena must be at least the value returned by
+     * `compute_allocated_size_bytes()`.
+     */
+    void
+    slab::internal_construct_ (const std::size_t* sizes,
+                               const std::size_t* blocks, std::size_t count,
+                               void* addr, std::size_t bytes,
+                               rtos::memory::memory_resource* upstream)
+    {
+      assert(count > 0);
+      assert(count <= max_size_classes);
+      assert(addr != nullptr);
+      assert(upstream != this);
+
+      arena_addr_ = addr;
+      upstream_ = upstream;
+
+      char* p = static_cast<char*> (addr);
+      char* end = p + bytes;
+
+      total_bytes_ = 0;
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          std::size_t size = rtos::memory::align_size (sizes[i],
+                                                       sizeof(void*));
+          // The classes must be in ascending order.
+          assert(i == 0 || size > sizes_[i - 1]);
+
+          p = reinterpret_cast<char*> (rtos::memory::align_size (
+              reinterpret_cast<std::size_t> (p), max_align));
+          std::size_t slice_bytes = size * blocks[i];
+          if (p + slice_bytes > end)
+            {
+              // The arena is too small.
+              assert(false);
+              break;
+            }
+
+          new (&classes_[i]) block_pool
+            { name (), blocks[i], size, p, slice_bytes };
+
+          sizes_[i] = size;
+          p += slice_bytes;
+          ends_[i] = p;
+
+          total_bytes_ += slice_bytes;
+          ++count_;
+        }
+
+      internal_reset_ ();
+    }
+
+    /**
+     * @details
+     */
+    void
+    slab::internal_reset_ (void) noexcept
+    {
+      allocated_bytes_ = 0;
+      max_allocated_bytes_ = 0;
+      free_bytes_ = total_bytes_;
+      allocated_chunks_ = 0;
+      free_chunks_ = 0;
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          free_chunks_ += size_class (i).free_chunks ();
+        }
+    }
+
+    /**
+     * @details
+     * The blocks allocated from the upstream memory resource
+     * are not affected.
+     */
+    void
+    slab::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("slab::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          size_class (i).reset ();
+        }
+
+      internal_reset_ ();
+    }
+
+    /**
+     * @details
+     * The request is routed to the smallest size class that fits
+     * the number of bytes and whose block size is a multiple of the
+     * alignment. If there is no such class, or if the class has no
+     * more free blocks, the request is forwarded to the upstream
+     * memory resource.
+     *
+     * Allocations from the size classes are deterministic.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    slab::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      void* p;
+
+      while (true)
+        {
+          for (std::size_t i = 0; i < count_; ++i)
+            {
+              if ((bytes <= sizes_[i]) && (alignment <= max_align)
+                  && ((sizes_[i] % alignment) == 0))
+                {
+                  p = size_class (i).allocate (bytes, alignment);
+                  if (p != nullptr)
+                    {
+                      // Update statistics.
+                      // What is subtracted from free is added to allocated.
+                      internal_increase_allocated_statistics (sizes_[i]);
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+                      trace::printf ("slab::%s(%u,%u)=%p,%u @%p %s\n",
+                                     __func__, bytes, alignment, p, sizes_[i],
+                                     this, name ());
+#endif
+                      return p;
+                    }
+
+                  // The class is exhausted, do not use larger classes.
+                  break;
+                }
+            }
+
+          if (upstream_ != nullptr)
+            {
+              p = upstream_->allocate (bytes, alignment);
+              if (p != nullptr)
+                {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+                  trace::printf ("slab::%s(%u,%u)=%p upstream @%p %s\n",
+                                 __func__, bytes, alignment, p, this, name ());
+#endif
+                  return p;
+                }
+            }
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("slab::%s(%u,%u)=0 @%p %s\n", __func__, bytes,
+                             alignment, this, name ());
+#endif
+
+              return nullptr;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("slab::%s(%u,%u) @%p %s out of memory\n", __func__,
+                         bytes, alignment, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+    }
+
+    /**
+     * @details
+     * The size class is identified by the block address, so
+     * the number of bytes is not required; addresses outside the
+     * arena are forwarded to the upstream memory resource.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    void
+    slab::do_deallocate (void* addr, std::size_t bytes,
+                         std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("slab::%s(%p,%u,%u) @%p %s\n", __func__, addr, bytes,
+                     alignment, this, name ());
+#endif
+
+      if ((count_ > 0) && (addr >= arena_addr_) && (addr < ends_[count_ - 1]))
+        {
+          for (std::size_t i = 0; i < count_; ++i)
+            {
+              if (addr < ends_[i])
+                {
+                  size_class (i).deallocate (addr, bytes, alignment);
+
+                  // Update statistics.
+                  // What is subtracted from allocated is added to free.
+                  internal_decrease_allocated_statistics (sizes_[i]);
+                  return;
+                }
+            }
+        }
+
+      if (upstream_ != nullptr)
+        {
+          upstream_->deallocate (addr, bytes, alignment);
+          return;
+        }
+
+      // Not from this memory resource.
+      assert(false);
+    }
+
+    /**
+     * @details
+     */
+    std::size_t
+    slab::do_max_size (void) const noexcept
+    {
+      return total_bytes_;
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,571 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/memory/tlsf.h>
+#include <memory>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    namespace
+    {
+      // Index of the most significant bit set; the argument must be non zero.
+      inline std::size_t
+      fls (std::size_t x) noexcept
+      {
+        return 31u
+            - static_cast<std::size_t> (__builtin_clz (
+                static_cast<unsigned int> (x)));
+      }
+
+      // Index of the least significant bit set; the argument must be non zero.
+      inline std::size_t
+      ffs (uint32_t x) noexcept
+      {
+        return static_cast<std::size_t> (__builtin_ctz (x));
+      }
+    }
+
+    // ========================================================================
+
+    /**
+     * @class tlsf
+     * @details
+     * The arena is split in physically contiguous blocks, each with
+     * a small header that links it to the previous physical block;
+     * the size of the next block is computed from the block size.
+     * A zero size, permanently allocated, block terminates the arena.
+     *
+     * Free blocks are kept in segregated lists; the first level
+     * splits sizes in powers of two, and the second level splits
+     * each power of two range in 16 linear sub-ranges. Two bitmaps
+     * keep track of non empty lists, so finding a suitable block
+     * requires only a couple of bit scan instructions.
+     *
+     * When blocks are freed, they are immediately coalesced with
+     * the free neighbours, so there are never two adjacent free blocks.
+     *
+     * Both allocation and deallocation are O(1), and do not depend on
+     * the number of blocks in the arena.
+     *
+     * Blocks larger than 16 MB are not supported.
+     */
+
+    /**
+     * @details
+     */
+    tlsf::~tlsf ()
+    {
+      trace::printf ("tlsf::%s() @%p %s\n", __func__, this, name ());
+    }
+
+    /**
+     * @details
+     */
+    void
+    tlsf::internal_construct_ (void* addr, std::size_t bytes)
+    {
+      assert(bytes > block_minsize + block_offset);
+
+      arena_addr_ = addr;
+      total_bytes_ = bytes;
+
+      // Align address for first block.
+      void* res;
+      // Possibly adjust the last two parameters.
+      res = std::align (block_align, block_minsize + block_offset, arena_addr_,
+                        total_bytes_);
+      // std::align() will fail if it cannot fit the min block.
+      if (res == nullptr)
+        {
+          assert(res != nullptr);
+        }
+
+      // The size of all blocks must be a multiple of the alignment.
+      total_bytes_ &= ~(block_align - 1);
+
+      // Blocks larger than the max size cannot be mapped to a list;
+      // the rest of the arena is not used.
+      if (total_bytes_ > block_maxsize + block_offset)
+        {
+          total_bytes_ = block_maxsize + block_offset;
+        }
+
+      internal_reset_ ();
+    }
+
+    /**
+     * @details
+     */
+    void
+    tlsf::internal_reset_ (void) noexcept
+    {
+      fl_bitmap_ = 0;
+      for (std::size_t fl = 0; fl < fl_index_count; ++fl)
+        {
+          sl_bitmap_[fl] = 0;
+          for (std::size_t sl = 0; sl < sl_index_count; ++sl)
+            {
+              blocks_[fl][sl] = nullptr;
+            }
+        }
+
+      // Entire arena, except the end marker header, is a big free block.
+      block_t* block = static_cast<block_t*> (arena_addr_);
+      block->prev_phys = nullptr;
+      block->size = total_bytes_ - block_offset;
+
+      // The end marker is a zero size allocated block.
+      block_t* last =
+          reinterpret_cast<block_t*> (reinterpret_cast<char*> (block)
+              + block->size);
+      last->prev_phys = block;
+      last->size = 0;
+
+      internal_insert_ (block);
+
+      allocated_bytes_ = 0;
+      max_allocated_bytes_ = 0;
+      free_bytes_ = total_bytes_ - block_offset;
+      allocated_chunks_ = 0;
+      free_chunks_ = 1;
+    }
+
+    /**
+     * @details
+     * Compute the list indices from the block size, set the
+     * free flag and link the block at the list head.
+     */
+    void
+    tlsf::internal_insert_ (block_t* block) noexcept
+    {
+      std::size_t size = block->size;
+      std::size_t fl;
+      std::size_t sl;
+
+      if (size < small_block_size)
+        {
+          fl = 0;
+          sl = size >> block_align_log2;
+        }
+      else
+        {
+          fl = fls (size);
+          sl = (size >> (fl - sl_index_count_log2))
+              ^ (1u << sl_index_count_log2);
+          fl -= (fl_index_shift - 1);
+        }
+
+      block_t* head = blocks_[fl][sl];
+      block->next_free = head;
+      block->prev_free = nullptr;
+      if (head != nullptr)
+        {
+          head->prev_free = block;
+        }
+      blocks_[fl][sl] = block;
+
+      fl_bitmap_ |= (1u << fl);
+      sl_bitmap_[fl] |= (1u << sl);
+
+      block->size |= block_free_bit;
+    }
+
+    /**
+     * @details
+     * Compute the list indices from the block size, unlink the
+     * block and clear the free flag; if the list becomes empty,
+     * update the bitmaps.
+     */
+    void
+    tlsf::internal_remove_ (block_t* block) noexcept
+    {
+      block->size &= ~block_free_bit;
+
+      std::size_t size = block->size;
+      std::size_t fl;
+      std::size_t sl;
+
+      if (size < small_block_size)
+        {
+          fl = 0;
+          sl = size >> block_align_log2;
+        }
+      else
+        {
+          fl = fls (size);
+          sl = (size >> (fl - sl_index_count_log2))
+              ^ (1u << sl_index_count_log2);
+          fl -= (fl_index_shift - 1);
+        }
+
+      block_t* next = block->next_free;
+      block_t* prev = block->prev_free;
+      if (next != nullptr)
+        {
+          next->prev_free = prev;
+        }
+      if (prev != nullptr)
+        {
+          prev->next_free = next;
+        }
+      else
+        {
+          // The block was the list head.
+          blocks_[fl][sl] = next;
+          if (next == nullptr)
+            {
+              sl_bitmap_[fl] &= ~(1u << sl);
+              if (sl_bitmap_[fl] == 0)
+                {
+                  fl_bitmap_ &= ~(1u << fl);
+                }
+            }
+        }
+    }
+
+    /**
+     * @details
+     * The size is rounded up to the next list boundary, so that
+     * any block in the selected list is large enough, then the
+     * bitmaps are searched for the first non empty list, without
+     * walking any list.
+     */
+    tlsf::block_t*
+    tlsf::internal_find_ (std::size_t size) noexcept
+    {
+      std::size_t fl;
+      std::size_t sl;
+
+      if (size < small_block_size)
+        {
+          fl = 0;
+          sl = size >> block_align_log2;
+        }
+      else
+        {
+          size += (1u << (fls (size) - sl_index_count_log2)) - 1;
+
+          fl = fls (size);
+          sl = (size >> (fl - sl_index_count_log2))
+              ^ (1u << sl_index_count_log2);
+          fl -= (fl_index_shift - 1);
+
+          if (fl >= fl_index_count)
+            {
+              return nullptr;
+            }
+        }
+
+      // First search the second level lists for the same first level.
+      uint32_t sl_map = sl_bitmap_[fl] & (~0u << sl);
+      if (sl_map == 0)
+        {
+          // None; search the larger first level lists.
+          uint32_t fl_map = fl_bitmap_ & (~0u << (fl + 1));
+          if (fl_map == 0)
+            {
+              // Out of memory.
+              return nullptr;
+            }
+
+          fl = ffs (fl_map);
+          sl_map = sl_bitmap_[fl];
+        }
+      sl = ffs (sl_map);
+
+      block_t* block = blocks_[fl][sl];
+      assert(block != nullptr);
+
+      internal_remove_ (block);
+      return block;
+    }
+
+    /**
+     * @details
+     * The block must not be free. The second part inherits the
+     * physical links of the initial block.
+     */
+    tlsf::block_t*
+    tlsf::internal_split_ (block_t* block, std::size_t size) noexcept
+    {
+      block_t* rem =
+          reinterpret_cast<block_t*> (reinterpret_cast<char*> (block) + size);
+      rem->prev_phys = block;
+      rem->size = block->size - size;
+
+      block->size = size;
+
+      block_t* next =
+          reinterpret_cast<block_t*> (reinterpret_cast<char*> (rem)
+              + rem->size);
+      next->prev_phys = rem;
+
+      return rem;
+    }
+
+    /**
+     * @details
+     */
+    void
+    tlsf::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("tlsf::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      internal_reset_ ();
+    }
+
+#pragma GCC diagnostic push
+// Needed because 'alignment' is used only in trace calls.
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * The requested size is rounded up to the next list boundary
+     * and the first block from the first non empty list is used;
+     * if the block is large enough, the remaining part is split
+     * and returned to the free lists.
+     *
+     * For alignments larger than the pointer size, the search
+     * is done for a block large enough to accommodate the worst
+     * case padding, and the free space before the aligned payload
+     * is split as a separate free block.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    tlsf::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      std::size_t alloc_size = rtos::memory::align_size (bytes, block_align);
+      alloc_size += block_offset;
+      alloc_size = os::rtos::memory::max (alloc_size, block_minsize);
+
+      std::size_t search_size = alloc_size;
+      if (alignment > block_align)
+        {
+          // Leave space for a free block before the aligned payload.
+          search_size += alignment + block_minsize;
+        }
+
+      block_t* block = nullptr;
+
+      while (true)
+        {
+          if (search_size <= block_maxsize)
+            {
+              block = internal_find_ (search_size);
+              if (block != nullptr)
+                {
+                  break;
+                }
+            }
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("tlsf::%s(%u,%u)=0 @%p %s\n", __func__, bytes,
+                             alignment, this, name ());
+#endif
+
+              return nullptr;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("tlsf::%s(%u,%u) @%p %s out of memory\n", __func__,
+                         bytes, alignment, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+
+      if (alignment > block_align)
+        {
+          uintptr_t payload = reinterpret_cast<uintptr_t> (block)
+              + block_offset;
+          uintptr_t aligned = (payload + alignment - 1) & ~(alignment - 1);
+          if ((aligned != payload) && (aligned - payload < block_minsize))
+            {
+              // The gap is too small for a free block; move further.
+              aligned = (payload + block_minsize + alignment - 1)
+                  & ~(alignment - 1);
+            }
+
+          std::size_t gap = static_cast<std::size_t> (aligned - payload);
+          if (gap != 0)
+            {
+              // The previous physical block is not free, otherwise
+              // it would have been coalesced; no need to merge.
+              block_t* aligned_block = internal_split_ (block, gap);
+              internal_insert_ (block);
+
+              // Splitting one block creates one more block.
+              ++free_chunks_;
+
+              block = aligned_block;
+            }
+        }
+
+      if (block->size - alloc_size >= block_minsize)
+        {
+          // Return the unused part to the free lists.
+          block_t* rem = internal_split_ (block, alloc_size);
+          internal_insert_ (rem);
+
+          // Splitting one block creates one more block.
+          ++free_chunks_;
+        }
+
+      // Update statistics.
+      // The value subtracted from free is added to allocated.
+      internal_increase_allocated_statistics (block->size);
+
+      void* payload = reinterpret_cast<char*> (block) + block_offset;
+
+      assert((reinterpret_cast<uintptr_t> (payload) & (alignment - 1)) == 0);
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("tlsf::%s(%u,%u)=%p,%u @%p %s\n", __func__, bytes,
+                     alignment, payload, block->size, this, name ());
+#endif
+
+      return payload;
+    }
+
+    /**
+     * @details
+     * The block is immediately coalesced with the physically
+     * adjacent free blocks, if any, and the result is linked
+     * to the corresponding free list, in constant time.
+     *
+     * If the block is already free, issue a trace message,
+     * but otherwise ignore the condition.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    void
+    tlsf::do_deallocate (void* addr, std::size_t bytes, std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("tlsf::%s(%p,%u,%u) @%p %s\n", __func__, addr, bytes,
+                     alignment, this, name ());
+#endif
+
+      // The address must be inside the arena; no exceptions.
+      if ((addr < arena_addr_)
+          || (addr > (static_cast<char*> (arena_addr_) + total_bytes_)))
+        {
+          assert(false);
+          return;
+        }
+
+      // Compute the block address from the user address.
+      block_t* block = reinterpret_cast<block_t *> (static_cast<char *> (addr)
+          - block_offset);
+
+      if ((block->size & block_free_bit) != 0)
+        {
+          // Already freed.
+          trace::printf ("tlsf::%s(%p,%u,%u) @%p %s already freed\n", __func__,
+                         addr, bytes, alignment, this, name ());
+
+          return;
+        }
+
+      if (bytes)
+        {
+          // If size is known, validate.
+          // (when called from free(), the size is not known).
+          if (bytes + block_offset > block->size)
+            {
+              assert(false);
+              return;
+            }
+        }
+
+      // Update statistics.
+      // What is subtracted from allocated is added to free.
+      internal_decrease_allocated_statistics (block->size);
+
+      block_t* prev = block->prev_phys;
+      if ((prev != nullptr) && ((prev->size & block_free_bit) != 0))
+        {
+          // Coalesce with the free block before it.
+          internal_remove_ (prev);
+          prev->size += block->size;
+          block = prev;
+
+          // Coalescing means one less block.
+          --free_chunks_;
+        }
+
+      block_t* next = reinterpret_cast<block_t*> (reinterpret_cast<char*> (block)
+          + block->size);
+      if ((next->size & block_free_bit) != 0)
+        {
+          // Coalesce with the free block after it; the end marker
+          // is never free.
+          internal_remove_ (next);
+          block->size += next->size;
+
+          // Coalescing means one less block.
+          --free_chunks_;
+
+          next = reinterpret_cast<block_t*> (reinterpret_cast<char*> (block)
+              + block->size);
+        }
+      next->prev_phys = block;
+
+      internal_insert_ (block);
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     */
+    std::size_t
+    tlsf::do_max_size (void) const noexcept
+    {
+      return total_bytes_;
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
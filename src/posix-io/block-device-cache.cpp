@@ -0,0 +1,651 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/posix-io/block-device-cache.h>
+
+#include <cmsis-plus/diag/trace.h>
+#include <cmsis-plus/posix/sys/ioctl.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    block_device_cache::block_device_cache (block_device_impl& impl,
+                                            const char* name) :
+        block_device
+          { impl, name }
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache::%s(\"%s\")=@%p\n", __func__, name_,
+                     this);
+#endif
+    }
+
+    block_device_cache::~block_device_cache ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache::%s() @%p %s\n", __func__, this,
+                     name_);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * With a non zero interval, dirty blocks older than _ticks_
+     * system clock ticks are written back on the next access,
+     * without waiting for an eviction or an explicit `sync()`.
+     * Zero (the default) disables the interval flush.
+     */
+    void
+    block_device_cache::flush_interval (rtos::clock::duration_t ticks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache::%s(%u) @%p\n", __func__, ticks,
+                     this);
+#endif
+
+      impl ().flush_interval_ = ticks;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The cache memory is not allocated here, since the block size
+     * is known only after the parent is opened; it is allocated
+     * from _resource_ on the first `open()` and returned on the
+     * last `close()`. If _resource_ is `nullptr`, the RTOS default
+     * memory resource is used; it is taken at open time, since
+     * static instances are constructed before the application sets it.
+     */
+    block_device_cache_impl::block_device_cache_impl (
+        block_device& parent, std::size_t blocks,
+        rtos::memory::memory_resource* resource) :
+        parent_ (parent), //
+        resource_ (resource), //
+        cache_blocks_ (blocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(%u)=@%p\n", __func__, blocks,
+                     this);
+#endif
+
+      assert(blocks > 0);
+    }
+
+    block_device_cache_impl::~block_device_cache_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s() @%p\n", __func__, this);
+#endif
+
+      release_ ();
+    }
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+    /**
+     * @details
+     * The buffers are allocated on open(); the name is that of
+     * the cached device.
+     */
+    void
+    block_device_cache_impl::describe_footprint_ (const void* object,
+                                                  rtos::footprint::item& it)
+    {
+      const block_device_cache_impl* self =
+          static_cast<const block_device_cache_impl*> (object);
+
+      it.name = self->parent_.name ();
+      it.object_bytes = sizeof(block_device_cache_impl);
+      it.storage_bytes = self->allocated_bytes_;
+      if (self->entries_ != nullptr)
+        {
+          for (std::size_t i = 0; i < self->cache_blocks_; ++i)
+            {
+              if (self->entries_[i].valid)
+                {
+                  it.used_bytes += self->block_logical_size_bytes_;
+                }
+            }
+        }
+    }
+
+#endif
+
+    // ----------------------------------------------------------------------
+
+    /**
+     * @details
+     * The read-ahead window, in blocks, is set with `BLKRASET`
+     * (passing a `std::size_t` value) and read with `BLKRAGET`
+     * (passing a `std::size_t*`); 0 disables read-ahead. Other
+     * requests are not supported.
+     */
+    int
+    block_device_cache_impl::do_vioctl (int request, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(%d) @%p\n", __func__,
+                     request, this);
+#endif
+
+      switch (static_cast<unsigned int> (request))
+        {
+        case BLKRASET:
+          readahead_blocks_ = va_arg(args, std::size_t);
+          return 0;
+
+        case BLKRAGET:
+          {
+            std::size_t* n = va_arg(args, std::size_t*);
+            if (n == nullptr)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            *n = readahead_blocks_;
+            return 0;
+          }
+
+        default:
+          errno = ENOSYS;
+          return -1;
+        }
+    }
+
+    int
+    block_device_cache_impl::do_vopen (const char* path, int oflag,
+                                       std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(%d) @%p\n", __func__, oflag,
+                     this);
+#endif
+
+      int ret = parent_.vopen (path, oflag, args);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      // Inherit from parent.
+      block_logical_size_bytes_ = parent_.block_logical_size_bytes ();
+      block_physical_size_bytes_ = parent_.block_physical_size_bytes ();
+      block_optimal_size_bytes_ = parent_.block_optimal_size_bytes ();
+      alignment_offset_bytes_ = parent_.alignment_offset_bytes ();
+      num_blocks_ = parent_.blocks ();
+
+      if (resource_ == nullptr)
+        {
+          resource_ = rtos::memory::get_default_resource ();
+        }
+
+      // The blocks come first, aligned to the cache line, since
+      // the device may transfer them with DMA; the entries follow.
+      std::size_t data_bytes = rtos::dcache::align_size (
+          cache_blocks_ * block_logical_size_bytes_);
+      std::size_t bytes = data_bytes + cache_blocks_ * sizeof(entry_t);
+      uint8_t* data = static_cast<uint8_t*> (rtos::dcache::allocate (
+          bytes, resource_));
+      if (data == nullptr)
+        {
+          parent_.close ();
+          errno = ENOMEM;
+          return -1;
+        }
+      allocated_bytes_ = bytes;
+
+      entries_ = reinterpret_cast<entry_t*> (data + data_bytes);
+      for (std::size_t i = 0; i < cache_blocks_; ++i)
+        {
+          entries_[i].blknum = 0;
+          entries_[i].stamp = 0;
+          entries_[i].data = data;
+          entries_[i].valid = false;
+          entries_[i].dirty = false;
+
+          data += block_logical_size_bytes_;
+        }
+      stamp_ = 0;
+      dirty_ = false;
+      next_blknum_ = 0;
+
+      return ret;
+    }
+
+    /**
+     * @details
+     * Each block is served from the cache if present; otherwise
+     * the least recently used entry is written back if dirty
+     * and reused for the block read from the parent.
+     *
+     * When a miss continues the previous read and read-ahead is
+     * enabled, up to the read-ahead window of following blocks
+     * is fetched into consecutive slots with the same
+     * multi-block read.
+     */
+    ssize_t
+    block_device_cache_impl::do_read_block (void* buf, blknum_t blknum,
+                                            std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(0x%X, %u, %u) @%p\n",
+                     __func__, buf, blknum, nblocks, this);
+#endif
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      for (std::size_t i = 0; i < nblocks; ++i, ++blknum)
+        {
+          entry_t* entry = find_ (blknum);
+          if (entry != nullptr)
+            {
+              ++hits_;
+            }
+          else
+            {
+              ++misses_;
+
+              std::size_t n = 1;
+              if (readahead_blocks_ > 0 && blknum == next_blknum_)
+                {
+                  // Sequential access; continue in the slot following
+                  // the previous block, wrapping around at the end.
+                  entry_t* end = &entries_[cache_blocks_];
+                  entry_t* prev = (blknum > 0) ? find_ (blknum - 1) : nullptr;
+                  entry =
+                      (prev != nullptr && prev + 1 < end) ?
+                          &prev[1] : &entries_[0];
+
+                  // Extend the window over clean slots, up to the device
+                  // end and the first block already in the cache.
+                  while (n <= readahead_blocks_ && blknum + n < num_blocks_
+                      && entry + n < end && !entry[n].dirty
+                      && find_ (blknum + n) == nullptr)
+                    {
+                      ++n;
+                    }
+                }
+              else
+                {
+                  entry = victim_ ();
+                }
+
+              if (write_back_ (*entry) < 0)
+                {
+                  return -1;
+                }
+
+              for (std::size_t j = 0; j < n; ++j)
+                {
+                  entry[j].valid = false;
+                }
+              if (parent_.read_block (entry->data, blknum, n) < 0)
+                {
+                  return -1;
+                }
+              for (std::size_t j = 0; j < n; ++j)
+                {
+                  entry[j].blknum = blknum + j;
+                  entry[j].stamp = ++stamp_;
+                  entry[j].valid = true;
+                }
+            }
+
+          entry->stamp = ++stamp_;
+          std::memcpy (p, entry->data, block_logical_size_bytes_);
+          p += block_logical_size_bytes_;
+        }
+      next_blknum_ = blknum;
+
+      check_interval_ ();
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * The blocks are only copied to the cache and marked dirty;
+     * they reach the parent when evicted, on `sync()`, or when
+     * the flush interval expires.
+     */
+    ssize_t
+    block_device_cache_impl::do_write_block (const void* buf, blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(0x%X, %u, %u) @%p\n",
+                     __func__, buf, blknum, nblocks, this);
+#endif
+
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+      for (std::size_t i = 0; i < nblocks; ++i, ++blknum)
+        {
+          entry_t* entry = find_ (blknum);
+          if (entry == nullptr)
+            {
+              // Prefer the slot following the previous block, if clean,
+              // so that sequential writes can be flushed together.
+              entry_t* prev = (blknum > 0) ? find_ (blknum - 1) : nullptr;
+              if (prev != nullptr && prev + 1 < &entries_[cache_blocks_]
+                  && !prev[1].dirty)
+                {
+                  entry = &prev[1];
+                }
+              else
+                {
+                  entry = victim_ ();
+                }
+              if (write_back_ (*entry) < 0)
+                {
+                  return -1;
+                }
+
+              // The entire block is overwritten, no need to read it.
+              entry->blknum = blknum;
+              entry->valid = true;
+            }
+
+          entry->stamp = ++stamp_;
+          std::memcpy (entry->data, p, block_logical_size_bytes_);
+          entry->dirty = true;
+          p += block_logical_size_bytes_;
+        }
+
+      if (!dirty_)
+        {
+          dirty_ = true;
+          dirty_since_ = rtos::sysclock.now ();
+        }
+      check_interval_ ();
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * The dirty blocks are written back first, so the mapped
+     * content is current; the mapping itself is the parent's.
+     */
+    const void*
+    block_device_cache_impl::do_map (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(%u, %u) @%p\n", __func__,
+                     blknum, nblocks, this);
+#endif
+
+      if (flush_ () < 0)
+        {
+          return nullptr;
+        }
+
+      return parent_.map (blknum, nblocks);
+    }
+
+    /**
+     * @details
+     * The cached blocks in the range are dropped without being
+     * written back, then the parent is told to discard them.
+     */
+    int
+    block_device_cache_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(%u, %u) @%p\n", __func__,
+                     blknum, nblocks, this);
+#endif
+
+      drop_ (blknum, nblocks);
+
+      return parent_.discard (blknum, nblocks);
+    }
+
+    int
+    block_device_cache_impl::do_erase (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s(%u, %u) @%p\n", __func__,
+                     blknum, nblocks, this);
+#endif
+
+      drop_ (blknum, nblocks);
+
+      return parent_.erase (blknum, nblocks);
+    }
+
+    void
+    block_device_cache_impl::do_sync (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s() @%p\n", __func__, this);
+#endif
+
+      flush_ ();
+
+      return parent_.sync ();
+    }
+
+    int
+    block_device_cache_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf (trace::posix_io_block_device_cache,
+                     "block_device_cache_impl::%s() @%p\n", __func__, this);
+#endif
+
+      int ret = flush_ ();
+      release_ ();
+
+      int res = parent_.close ();
+      return (ret < 0) ? ret : res;
+    }
+
+    // ------------------------------------------------------------------------
+
+    block_device_cache_impl::entry_t*
+    block_device_cache_impl::find_ (blknum_t blknum)
+    {
+      for (std::size_t i = 0; i < cache_blocks_; ++i)
+        {
+          if (entries_[i].valid && entries_[i].blknum == blknum)
+            {
+              return &entries_[i];
+            }
+        }
+      return nullptr;
+    }
+
+    void
+    block_device_cache_impl::drop_ (blknum_t blknum, std::size_t nblocks)
+    {
+      for (std::size_t i = 0; i < cache_blocks_; ++i)
+        {
+          if (entries_[i].valid && entries_[i].blknum >= blknum
+              && entries_[i].blknum < blknum + nblocks)
+            {
+              entries_[i].valid = false;
+              entries_[i].dirty = false;
+            }
+        }
+    }
+
+    block_device_cache_impl::entry_t*
+    block_device_cache_impl::victim_ (void)
+    {
+      entry_t* oldest = &entries_[0];
+      for (std::size_t i = 0; i < cache_blocks_; ++i)
+        {
+          if (!entries_[i].valid)
+            {
+              return &entries_[i];
+            }
+          if (entries_[i].stamp < oldest->stamp)
+            {
+              oldest = &entries_[i];
+            }
+        }
+      return oldest;
+    }
+
+    /**
+     * @details
+     * The slot buffers are consecutive in memory, so the run of
+     * neighbouring dirty slots holding consecutive blocks around
+     * _entry_ is written to the parent with a single multi-block
+     * call; cached clean blocks are included up to the unit
+     * boundaries, to avoid partial unit writes.
+     */
+    int
+    block_device_cache_impl::write_back_ (entry_t& entry)
+    {
+      if (!entry.valid || !entry.dirty)
+        {
+          return 0;
+        }
+
+      entry_t* first = &entry;
+      while (first > &entries_[0] && first[-1].valid && first[-1].dirty
+          && first[-1].blknum + 1 == first->blknum)
+        {
+          --first;
+        }
+
+      entry_t* last = &entry;
+      while (last + 1 < &entries_[cache_blocks_] && last[1].valid
+          && last[1].dirty && last->blknum + 1 == last[1].blknum)
+        {
+          ++last;
+        }
+
+      // Widen the run over clean neighbours up to the transfer
+      // unit boundaries, so the device gets whole units and does
+      // not have to read back and merge the rest.
+      if (block_optimal_size_bytes_ > block_logical_size_bytes_)
+        {
+          std::size_t n = block_optimal_size_bytes_
+              / block_logical_size_bytes_;
+          blknum_t skew = static_cast<blknum_t> (alignment_offset_bytes_
+              / block_logical_size_bytes_);
+          while (((first->blknum + skew) % n) != 0 && first > &entries_[0]
+              && first[-1].valid && first[-1].blknum + 1 == first->blknum)
+            {
+              --first;
+            }
+          while (((last->blknum + 1 + skew) % n) != 0
+              && last + 1 < &entries_[cache_blocks_] && last[1].valid
+              && last->blknum + 1 == last[1].blknum)
+            {
+              ++last;
+            }
+        }
+
+      std::size_t nblocks = static_cast<std::size_t> (last - first) + 1;
+      if (parent_.write_block (first->data, first->blknum, nblocks) < 0)
+        {
+          return -1;
+        }
+
+      for (entry_t* e = first; e <= last; ++e)
+        {
+          e->dirty = false;
+        }
+      return 0;
+    }
+
+    int
+    block_device_cache_impl::flush_ (void)
+    {
+      int ret = 0;
+      if (entries_ != nullptr)
+        {
+          for (std::size_t i = 0; i < cache_blocks_; ++i)
+            {
+              // Keep going; a failed run remains dirty.
+              if (write_back_ (entries_[i]) < 0)
+                {
+                  ret = -1;
+                }
+            }
+        }
+      if (ret == 0)
+        {
+          dirty_ = false;
+        }
+      return ret;
+    }
+
+    void
+    block_device_cache_impl::check_interval_ (void)
+    {
+      if (dirty_ && flush_interval_ > 0
+          && (rtos::sysclock.now () - dirty_since_) >= flush_interval_)
+        {
+          flush_ ();
+        }
+    }
+
+    void
+    block_device_cache_impl::release_ (void)
+    {
+      if (entries_ != nullptr)
+        {
+          rtos::dcache::deallocate (entries_[0].data, allocated_bytes_,
+                                    resource_);
+          entries_ = nullptr;
+          allocated_bytes_ = 0;
+        }
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -43,7 +43,8 @@ namespace os
           { impl, name }
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition::%s(\"%s\")=@%p\n", __func__,
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition::%s(\"%s\")=@%p\n", __func__,
                      name_, this);
 #endif
     }
@@ -51,7 +52,8 @@ namespace os
     block_device_partition::~block_device_partition ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition::%s() @%p %s\n", __func__, this,
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition::%s() @%p %s\n", __func__, this,
                      name_);
 #endif
     }
@@ -62,13 +64,50 @@ namespace os
     block_device_partition::configure (blknum_t offset, blknum_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition::%s(%u,%u) @%p\n", __func__,
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition::%s(%u,%u) @%p\n", __func__,
                      offset, nblocks, this);
 #endif
 
       impl ().configure (offset, nblocks);
     }
 
+    /**
+     * @details
+     * The partition may start inside an erase unit of the parent,
+     * so the alignment is computed on the parent block numbers.
+     */
+    block_device::blknum_t
+    block_device_partition::erase_align_down (blknum_t blknum)
+    {
+      std::size_t n = erase_blocks ();
+      blknum_t offset = impl ().partition_offset_blocks_;
+
+      blknum_t aligned = ((blknum + offset) / n) * n;
+      return (aligned > offset) ? (aligned - offset) : 0;
+    }
+
+    block_device::blknum_t
+    block_device_partition::erase_align_up (blknum_t blknum)
+    {
+      std::size_t n = erase_blocks ();
+      blknum_t offset = impl ().partition_offset_blocks_;
+
+      blknum_t aligned = ((blknum + offset + n - 1) / n) * n - offset;
+      return (aligned < blocks ()) ? aligned : blocks ();
+    }
+
+    bool
+    block_device_partition::is_erase_aligned (blknum_t blknum,
+                                              std::size_t nblocks)
+    {
+      std::size_t n = erase_blocks ();
+      blknum_t offset = impl ().partition_offset_blocks_;
+
+      return (((blknum + offset) % n) == 0)
+          && (((blknum + offset + nblocks) % n) == 0);
+    }
+
     // ========================================================================
 
     block_device_partition_impl::block_device_partition_impl (
@@ -76,14 +115,16 @@ namespace os
         parent_ (parent)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s()=@%p\n", __func__, this);
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s()=@%p\n", __func__, this);
 #endif
     }
 
     block_device_partition_impl::~block_device_partition_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -105,7 +146,8 @@ namespace os
     block_device_partition_impl::configure (blknum_t offset, blknum_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(%u,%u) @%p\n", __func__,
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s(%u,%u) @%p\n", __func__,
                      offset, nblocks, this);
 #endif
 
@@ -116,6 +158,15 @@ namespace os
       // Inherit from parent.
       block_logical_size_bytes_ = parent_.block_logical_size_bytes ();
       block_physical_size_bytes_ = parent_.block_physical_size_bytes ();
+      block_optimal_size_bytes_ = parent_.block_optimal_size_bytes ();
+
+      // Where the partition starts inside a transfer unit.
+      if (block_optimal_size_bytes_ != 0)
+        {
+          alignment_offset_bytes_ = (parent_.alignment_offset_bytes ()
+              + offset * block_logical_size_bytes_)
+              % block_optimal_size_bytes_;
+        }
     }
 
     int
@@ -123,7 +174,8 @@ namespace os
                                            std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(%d) @%p\n", __func__,
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s(%d) @%p\n", __func__,
                      oflag, this);
 #endif
 
@@ -135,7 +187,8 @@ namespace os
                                                 std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
                      __func__, buf, blknum, nblocks, this);
 #endif
 
@@ -149,7 +202,8 @@ namespace os
                                                  std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
                      __func__, buf, blknum, nblocks, this);
 #endif
 
@@ -157,11 +211,50 @@ namespace os
                                   nblocks);
     }
 
+    const void*
+    block_device_partition_impl::do_map (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s(%u, %u) @%p\n",
+                     __func__, blknum, nblocks, this);
+#endif
+
+      return parent_.map (blknum + partition_offset_blocks_, nblocks);
+    }
+
+    int
+    block_device_partition_impl::do_discard (blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s(%u, %u) @%p\n",
+                     __func__, blknum, nblocks, this);
+#endif
+
+      return parent_.discard (blknum + partition_offset_blocks_, nblocks);
+    }
+
+    int
+    block_device_partition_impl::do_erase (blknum_t blknum,
+                                           std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s(%u, %u) @%p\n",
+                     __func__, blknum, nblocks, this);
+#endif
+
+      return parent_.erase (blknum + partition_offset_blocks_, nblocks);
+    }
+
     void
     block_device_partition_impl::do_sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s() @%p\n", __func__, this);
 #endif
 
       return parent_.sync ();
@@ -171,7 +264,8 @@ namespace os
     block_device_partition_impl::do_close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_block_device_partition,
+                     "block_device_partition_impl::%s() @%p\n", __func__, this);
 #endif
 
       return parent_.close ();
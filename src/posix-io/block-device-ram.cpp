@@ -0,0 +1,306 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/posix-io/block-device-ram.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * The region at _addr_ is used as is, so it may hold a file
+     * system image; with _lazy_zero_ the device starts empty.
+     * The size is rounded down to whole blocks.
+     */
+    block_device_ram_impl::block_device_ram_impl (void* addr,
+                                                  std::size_t bytes,
+                                                  std::size_t block_size_bytes,
+                                                  bool lazy_zero) :
+        region_ (static_cast<uint8_t*> (addr)), //
+        lazy_zero_ (lazy_zero)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s(%p, %u, %u)=@%p\n", __func__,
+                     addr, bytes, block_size_bytes, this);
+#endif
+
+      assert(addr != nullptr);
+      assert(block_size_bytes > 0);
+
+      block_logical_size_bytes_ = block_size_bytes;
+      block_physical_size_bytes_ = block_size_bytes;
+      num_blocks_ = static_cast<blknum_t> (bytes / block_size_bytes);
+
+      zeroed_blocks_ = lazy_zero_ ? 0 : num_blocks_;
+    }
+
+    /**
+     * @details
+     * The region is allocated from _resource_ on the first
+     * `open()`, and kept, with its content, until the object
+     * is destroyed. If _resource_ is `nullptr`, the RTOS default
+     * memory resource is used; it is taken at open time, since
+     * static instances are constructed before the application sets it.
+     */
+    block_device_ram_impl::block_device_ram_impl (
+        std::size_t blocks, std::size_t block_size_bytes,
+        rtos::memory::memory_resource* resource, bool lazy_zero) :
+        resource_ (resource), //
+        lazy_zero_ (lazy_zero)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s(%u, %u)=@%p\n", __func__,
+                     blocks, block_size_bytes, this);
+#endif
+
+      assert(blocks > 0);
+      assert(block_size_bytes > 0);
+
+      block_logical_size_bytes_ = block_size_bytes;
+      block_physical_size_bytes_ = block_size_bytes;
+      num_blocks_ = static_cast<blknum_t> (blocks);
+
+      allocated_bytes_ = blocks * block_size_bytes;
+    }
+
+    block_device_ram_impl::~block_device_ram_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s() @%p\n", __func__, this);
+#endif
+
+      if (resource_ != nullptr && region_ != nullptr)
+        {
+          resource_->deallocate (region_, allocated_bytes_);
+          region_ = nullptr;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    block_device_ram_impl::do_vioctl (int request, std::va_list args)
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    int
+    block_device_ram_impl::do_vopen (const char* path, int oflag,
+                                     std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s(%d) @%p\n", __func__, oflag,
+                     this);
+#endif
+
+      if (region_ != nullptr)
+        {
+          return 0;
+        }
+
+      if (resource_ == nullptr)
+        {
+          resource_ = rtos::memory::get_default_resource ();
+        }
+
+      region_ = static_cast<uint8_t*> (resource_->allocate (allocated_bytes_));
+      if (region_ == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      if (lazy_zero_)
+        {
+          zeroed_blocks_ = 0;
+        }
+      else
+        {
+          std::memset (region_, 0, allocated_bytes_);
+          zeroed_blocks_ = num_blocks_;
+        }
+      return 0;
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     * The part above the high water mark is not read.
+     */
+    ssize_t
+    block_device_ram_impl::do_read_block (void* buf, blknum_t blknum,
+                                          std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s(%p, %u, %u) @%p\n", __func__,
+                     buf, blknum, nblocks, this);
+#endif
+
+      std::size_t n = 0;
+      if (blknum < zeroed_blocks_)
+        {
+          n = zeroed_blocks_ - blknum;
+          if (n > nblocks)
+            {
+              n = nblocks;
+            }
+          std::memcpy (buf, block_ (blknum), n * block_logical_size_bytes_);
+        }
+
+      if (n < nblocks)
+        {
+          std::memset (static_cast<uint8_t*> (buf)
+                           + n * block_logical_size_bytes_,
+                       0, (nblocks - n) * block_logical_size_bytes_);
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    ssize_t
+    block_device_ram_impl::do_write_block (const void* buf, blknum_t blknum,
+                                           std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s(%p, %u, %u) @%p\n", __func__,
+                     buf, blknum, nblocks, this);
+#endif
+
+      zero_below_ (blknum);
+
+      std::memcpy (block_ (blknum), buf, nblocks * block_logical_size_bytes_);
+
+      if (blknum + nblocks > zeroed_blocks_)
+        {
+          zeroed_blocks_ = blknum + nblocks;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * The blocks are returned in place; with lazy zeroing they
+     * are cleared first if above the high water mark.
+     */
+    const void*
+    block_device_ram_impl::do_map (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s(%u, %u) @%p\n", __func__,
+                     blknum, nblocks, this);
+#endif
+
+      zero_below_ (blknum + nblocks);
+
+      return block_ (blknum);
+    }
+
+    /**
+     * @details
+     * Only a range reaching the high water mark has an effect,
+     * it lowers the mark, so the blocks read again as zeros
+     * without clearing them now.
+     */
+    int
+    block_device_ram_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s(%u, %u) @%p\n", __func__,
+                     blknum, nblocks, this);
+#endif
+
+      if (lazy_zero_ && blknum < zeroed_blocks_
+          && blknum + nblocks >= zeroed_blocks_)
+        {
+          zeroed_blocks_ = blknum;
+        }
+      return 0;
+    }
+
+    void
+    block_device_ram_impl::do_sync (void)
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * The content is kept, the device can be opened again.
+     */
+    int
+    block_device_ram_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_ram_impl::%s() @%p\n", __func__, this);
+#endif
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    void
+    block_device_ram_impl::zero_below_ (blknum_t blknum)
+    {
+      if (blknum > zeroed_blocks_)
+        {
+          std::memset (block_ (zeroed_blocks_), 0,
+                       (blknum - zeroed_blocks_) * block_logical_size_bytes_);
+          zeroed_blocks_ = blknum;
+        }
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -27,6 +27,7 @@
 
 #include <cmsis-plus/posix-io/block-device.h>
 #include <cmsis-plus/posix-io/device-registry.h>
+#include <cmsis-plus/rtos/os.h>
 
 #include <cmsis-plus/posix/sys/ioctl.h>
 
@@ -48,7 +49,8 @@ namespace os
           { impl, type::block_device, name, }
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(\"%s\")=@%p\n", __func__, name_, this);
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s(\"%s\")=@%p\n", __func__, name_, this);
 #endif
 
       device_registry<device>::link (this);
@@ -57,7 +59,8 @@ namespace os
     block_device::~block_device ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s() @%p %s\n", __func__, this, name_);
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s() @%p %s\n", __func__, this, name_);
 #endif
     }
 
@@ -67,7 +70,8 @@ namespace os
     block_device::read_block (void* buf, blknum_t blknum, std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
                      blknum, nblocks, this);
 #endif
 
@@ -83,7 +87,18 @@ namespace os
           return -1;
         }
 
-      return impl ().do_read_block (buf, blknum, nblocks);
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().transfer_read_block_ (buf, blknum, nblocks);
+      account_ (false,
+                (ret < 0) ? ret :
+                    static_cast<ssize_t> (static_cast<std::size_t> (ret)
+                        * impl ().block_logical_size_bytes_),
+                begin);
+      return ret;
+#else
+      return impl ().transfer_read_block_ (buf, blknum, nblocks);
+#endif
     }
 
     ssize_t
@@ -91,7 +106,8 @@ namespace os
                                std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
                      blknum, nblocks, this);
 #endif
 
@@ -107,14 +123,123 @@ namespace os
           return -1;
         }
 
-      return impl ().do_write_block (buf, blknum, nblocks);
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().transfer_write_block_ (buf, blknum, nblocks);
+      account_ (true,
+                (ret < 0) ? ret :
+                    static_cast<ssize_t> (static_cast<std::size_t> (ret)
+                        * impl ().block_logical_size_bytes_),
+                begin);
+      return ret;
+#else
+      return impl ().transfer_write_block_ (buf, blknum, nblocks);
+#endif
+    }
+
+    /**
+     * @details
+     * For storage in memory mapped flash or RAM, the content can
+     * be used in place, without copying it to a buffer. The
+     * pointer remains valid while the device is opened; content
+     * written later may be seen only after `sync()`.
+     */
+    const void*
+    block_device::map (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s(%u, %u) @%p\n", __func__, blknum,
+                     nblocks, this);
+#endif
+
+      if ((nblocks == 0) || (blknum + nblocks > impl ().num_blocks_))
+        {
+          errno = EINVAL;
+          return nullptr;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return nullptr;
+        }
+
+      errno = 0;
+
+      return impl ().do_map (blknum, nblocks);
+    }
+
+    /**
+     * @details
+     * Tell the device that the content of the blocks is no longer
+     * needed (like TRIM); flash devices can then erase them in the
+     * background and avoid a read-modify-erase-write cycle when they
+     * are written again. Afterwards the content is undefined.
+     *
+     * File systems should issue discards for the blocks freed when
+     * files are unlinked or truncated.
+     */
+    int
+    block_device::discard (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s(%u, %u) @%p\n", __func__, blknum,
+                     nblocks, this);
+#endif
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      return impl ().do_discard (blknum, nblocks);
+    }
+
+    /**
+     * @details
+     * The range should cover entire erase units, i.e. be aligned to
+     * `erase_blocks()` on the physical device; writes to erased
+     * blocks do not need a read-modify-erase-write cycle.
+     */
+    int
+    block_device::erase (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s(%u, %u) @%p\n", __func__, blknum,
+                     nblocks, this);
+#endif
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      return impl ().do_erase (blknum, nblocks);
     }
 
     int
     block_device::vioctl (int request, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(%d) @%p\n", __func__, request, this);
+      trace::printf (trace::posix_io_block_device,
+                     "block_device::%s(%d) @%p\n", __func__, request, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -131,7 +256,7 @@ namespace os
           // Get logical device sector size (to be used for read/writes).
           {
             std::size_t* sz = va_arg(args, std::size_t*);
-            if (sz == nullptr || impl ().block_logical_size_bytes_ != 0)
+            if (sz == nullptr || impl ().block_logical_size_bytes_ == 0)
               {
                 errno = EINVAL;
                 return -1;
@@ -145,7 +270,7 @@ namespace os
           // Get physical device sector size (internally used for erase).
           {
             std::size_t* sz = va_arg(args, std::size_t*);
-            if (sz == nullptr || impl ().block_physical_size_bytes_ != 0)
+            if (sz == nullptr || impl ().block_physical_size_bytes_ == 0)
               {
                 errno = EINVAL;
                 return -1;
@@ -155,11 +280,38 @@ namespace os
             return 0;
           }
 
+        case BLKIOMIN:
+        case BLKIOOPT:
+        case BLKALIGNOFF:
+          // Get the transfer geometry, as sizes in bytes.
+          {
+            std::size_t* sz = va_arg(args, std::size_t*);
+            if (sz == nullptr || impl ().block_logical_size_bytes_ == 0)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            if (static_cast<unsigned int> (request) == BLKIOMIN)
+              {
+                *sz = erase_blocks () * impl ().block_logical_size_bytes_;
+              }
+            else if (static_cast<unsigned int> (request) == BLKIOOPT)
+              {
+                *sz = block_optimal_size_bytes ();
+              }
+            else
+              {
+                *sz = impl ().alignment_offset_bytes_;
+              }
+            return 0;
+          }
+
         case BLKGETSIZE64:
           // Get device size in bytes.
           {
             uint64_t* sz = va_arg(args, uint64_t*);
-            if (sz == nullptr || impl ().num_blocks_ != 0)
+            if (sz == nullptr || impl ().num_blocks_ == 0)
               {
                 errno = EINVAL;
                 return -1;
@@ -170,6 +322,35 @@ namespace os
             return 0;
           }
 
+        case BLKDISCARD:
+        case BLKSECDISCARD:
+          // Discard or erase a byte range, passed as start and length.
+          {
+            uint64_t* range = va_arg(args, uint64_t*);
+            std::size_t bsz = impl ().block_logical_size_bytes_;
+            if (range == nullptr || bsz == 0 || (range[0] % bsz) != 0
+                || (range[1] % bsz) != 0)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            blknum_t blknum = static_cast<blknum_t> (range[0] / bsz);
+            std::size_t nblocks = static_cast<std::size_t> (range[1] / bsz);
+            if (blknum + nblocks > impl ().num_blocks_)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            // Already locked, do not call the public functions.
+            if (static_cast<unsigned int> (request) == BLKDISCARD)
+              {
+                return impl ().do_discard (blknum, nblocks);
+              }
+            return impl ().do_erase (blknum, nblocks);
+          }
+
         default:
 
           // Execute the implementation specific code.
@@ -182,14 +363,16 @@ namespace os
     block_device_impl::block_device_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s()=@%p\n", __func__, this);
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_impl::%s()=@%p\n", __func__, this);
 #endif
     }
 
     block_device_impl::~block_device_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_impl::%s() @%p\n", __func__, this);
 #endif
 
       block_logical_size_bytes_ = 0;
@@ -202,7 +385,8 @@ namespace os
     block_device_impl::do_lseek (off_t offset, int whence)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s(%d, %d) @%p\n", __func__, offset,
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_impl::%s(%d, %d) @%p\n", __func__, offset,
                      whence, this);
 #endif
 
@@ -235,11 +419,50 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+    /**
+     * @details
+     * The default implementation fails with `ENODEV`; devices
+     * with memory mapped storage should override it and return
+     * the address of the block.
+     */
+    const void*
+    block_device_impl::do_map (blknum_t blknum __attribute__((unused)),
+                               std::size_t nblocks __attribute__((unused)))
+    {
+      errno = ENODEV;
+      return nullptr;
+    }
+
+    /**
+     * @details
+     * Discards are advisory; the default implementation ignores them.
+     */
+    int
+    block_device_impl::do_discard (blknum_t blknum __attribute__((unused)),
+                                   std::size_t nblocks __attribute__((unused)))
+    {
+      return 0;
+    }
+
+    /**
+     * @details
+     * The default implementation fails with `ENOSYS`; flash devices
+     * should override it.
+     */
+    int
+    block_device_impl::do_erase (blknum_t blknum __attribute__((unused)),
+                                 std::size_t nblocks __attribute__((unused)))
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
     ssize_t
     block_device_impl::do_read (void* buf, std::size_t nbyte)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
                      nbyte, this);
 #endif
 
@@ -262,7 +485,7 @@ namespace os
           return -1;
         }
 
-      ssize_t ret = do_read_block (buf, blknum, nblocks);
+      ssize_t ret = transfer_read_block_ (buf, blknum, nblocks);
       if (ret >= 0)
         {
           ret *= block_logical_size_bytes_;
@@ -274,7 +497,8 @@ namespace os
     block_device_impl::do_write (const void* buf, std::size_t nbyte)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
                      nbyte, this);
 #endif
 
@@ -297,7 +521,7 @@ namespace os
           return -1;
         }
 
-      ssize_t ret = do_write_block (buf, blknum, nblocks);
+      ssize_t ret = transfer_write_block_ (buf, blknum, nblocks);
       if (ret >= 0)
         {
           ret *= block_logical_size_bytes_;
@@ -305,6 +529,178 @@ namespace os
       return ret;
     }
 
+    /**
+     * @details
+     * For the devices using DMA, the buffer is cleaned and
+     * invalidated before the read, and invalidated again
+     * after it, so the CPU does not read stale cache lines.
+     */
+    ssize_t
+    block_device_impl::transfer_read_block_ (void* buf, blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+      if (!dma_)
+        {
+          return do_read_block (buf, blknum, nblocks);
+        }
+
+      rtos::dcache::prepare_receive (buf,
+                                     nblocks * block_logical_size_bytes_);
+      ssize_t ret = do_read_block (buf, blknum, nblocks);
+      if (ret > 0)
+        {
+          rtos::dcache::complete_receive (
+              buf,
+              static_cast<std::size_t> (ret) * block_logical_size_bytes_);
+        }
+      return ret;
+    }
+
+    /**
+     * @details
+     * For the devices using DMA, the buffer is cleaned before
+     * the write, so the transfer reads the content written by
+     * the CPU.
+     */
+    ssize_t
+    block_device_impl::transfer_write_block_ (const void* buf, blknum_t blknum,
+                                              std::size_t nblocks)
+    {
+      if (dma_)
+        {
+          rtos::dcache::prepare_transmit (buf,
+                                          nblocks * block_logical_size_bytes_);
+        }
+      return do_write_block (buf, blknum, nblocks);
+    }
+
+    /**
+     * @details
+     * The segments are read into consecutive blocks starting
+     * at the current offset, one `do_read_block()` per segment;
+     * the generic fallback would read all segments from the same
+     * offset. Each segment must be a multiple of the block size.
+     *
+     * Drivers able to scatter natively (DMA descriptor chains)
+     * can override this function and build the chain directly
+     * from the `iovec` array.
+     */
+    ssize_t
+    block_device_impl::do_readv (const struct iovec* iov, int iovcnt)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_impl::%s(%p, %d) @%p\n", __func__, iov,
+                     iovcnt, this);
+#endif
+
+      blknum_t blknum;
+      if (check_iov_ (iov, iovcnt, &blknum) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t total = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          std::size_t nblocks = iov[i].iov_len / block_logical_size_bytes_;
+          ssize_t ret = transfer_read_block_ (iov[i].iov_base, blknum, nblocks);
+          if (ret < 0)
+            {
+              return (total > 0) ? total : ret;
+            }
+          total += ret * static_cast<ssize_t> (block_logical_size_bytes_);
+          if (static_cast<std::size_t> (ret) < nblocks)
+            {
+              break;
+            }
+          blknum += nblocks;
+        }
+      return total;
+    }
+
+    /**
+     * @details
+     * The segments are written to consecutive blocks starting
+     * at the current offset, one `do_write_block()` per segment.
+     * Each segment must be a multiple of the block size.
+     *
+     * Drivers able to gather natively can override this function.
+     */
+    ssize_t
+    block_device_impl::do_writev (const struct iovec* iov, int iovcnt)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf (trace::posix_io_block_device,
+                     "block_device_impl::%s(%p, %d) @%p\n", __func__, iov,
+                     iovcnt, this);
+#endif
+
+      blknum_t blknum;
+      if (check_iov_ (iov, iovcnt, &blknum) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t total = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          std::size_t nblocks = iov[i].iov_len / block_logical_size_bytes_;
+          ssize_t ret = transfer_write_block_ (iov[i].iov_base, blknum, nblocks);
+          if (ret < 0)
+            {
+              return (total > 0) ? total : ret;
+            }
+          total += ret * static_cast<ssize_t> (block_logical_size_bytes_);
+          if (static_cast<std::size_t> (ret) < nblocks)
+            {
+              break;
+            }
+          blknum += nblocks;
+        }
+      return total;
+    }
+
+    /**
+     * @details
+     * Validate the segments and the current offset, and return
+     * the total number of blocks (or -1 with `errno` set to
+     * `EINVAL`); the first block number is stored in _blknum_.
+     */
+    ssize_t
+    block_device_impl::check_iov_ (const struct iovec* iov, int iovcnt,
+                                   blknum_t* blknum)
+    {
+      if ((block_logical_size_bytes_ == 0)
+          || ((static_cast<std::size_t> (offset_) % block_logical_size_bytes_)
+              != 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      std::size_t nblocks = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          if ((iov[i].iov_len % block_logical_size_bytes_) != 0)
+            {
+              errno = EINVAL;
+              return -1;
+            }
+          nblocks += iov[i].iov_len / block_logical_size_bytes_;
+        }
+
+      *blknum = static_cast<std::size_t> (offset_) / block_logical_size_bytes_;
+
+      if (*blknum + nblocks > num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
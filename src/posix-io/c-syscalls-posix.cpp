@@ -38,6 +38,9 @@
 #include <cmsis-plus/posix-io/directory.h>
 #include <cmsis-plus/posix-io/socket.h>
 #include <cmsis-plus/posix-io/net-stack.h>
+#include <cmsis-plus/posix-io/event-poll.h>
+#include <cmsis-plus/posix-io/pipe.h>
+#include <cmsis-plus/posix-io/shared-memory.h>
 
 #include <cmsis-plus/posix/sys/uio.h>
 
@@ -137,6 +140,18 @@ __posix_read (int fildes, void* buf, size_t nbyte)
   return io->read (buf, nbyte);
 }
 
+ssize_t
+__posix_readv (int fildes, const struct iovec* iov, int iovcnt)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->readv (iov, iovcnt);
+}
+
 ssize_t
 __posix_write (int fildes, const void* buf, size_t nbyte)
 {
@@ -166,6 +181,261 @@ __posix_writev (int fildes, const struct iovec* iov, int iovcnt)
   return io->writev (iov, iovcnt);
 }
 
+ssize_t
+__posix_sendfile (int out_fd, int in_fd, off_t* offset, size_t count)
+{
+  auto* const out = posix::file_descriptors_manager::io (out_fd);
+  auto* const in = posix::file_descriptors_manager::io (in_fd);
+  if (out == nullptr || in == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return out->sendfile (in, offset, count);
+}
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  /**
+   * @brief Wait until some descriptors are ready.
+   * @param [in] scan Function registering the semaphore with all
+   *  descriptors and returning the number of ready ones, or -1.
+   * @param [in] release Function unregistering the semaphore.
+   * @param [in] timeout The timeout in milliseconds, negative for
+   *  infinite.
+   * @return The last value returned by _scan_, 0 on timeout or -1
+   *  on error.
+   *
+   * @details
+   * The descriptors post the semaphore when their readiness may
+   * have changed, so the thread sleeps until then, instead of
+   * polling.
+   */
+  template<typename S, typename R>
+    int
+    poll_wait (S scan, R release, int timeout)
+    {
+      rtos::semaphore_binary sem
+        { "poll", 0 };
+
+      rtos::clock::timestamp_t deadline = 0;
+      if (timeout > 0)
+        {
+          deadline = rtos::sysclock.now ()
+              + rtos::clock_systick::ticks_cast (
+                  static_cast<uint64_t> (timeout) * 1000u);
+        }
+
+      int count;
+      for (;;)
+        {
+          count = scan (&sem);
+          if (count != 0 || timeout == 0)
+            {
+              break;
+            }
+
+          rtos::result_t res;
+          if (timeout < 0)
+            {
+              res = sem.wait ();
+            }
+          else
+            {
+              rtos::clock::timestamp_t now = rtos::sysclock.now ();
+              if (now >= deadline)
+                {
+                  break;
+                }
+              res = sem.timed_wait (
+                  static_cast<rtos::clock::duration_t> (deadline - now));
+            }
+
+          if (res == EINTR)
+            {
+              count = -1;
+              errno = EINTR;
+              break;
+            }
+          // On timeout, scan once more; the deadline check ends the loop.
+        }
+
+      release ();
+      return count;
+    }
+}
+
+int
+__posix_poll (struct pollfd fds[], nfds_t nfds, int timeout)
+{
+  if (fds == nullptr && nfds > 0)
+    {
+      errno = EFAULT;
+      return -1;
+    }
+
+  auto scan = [=](rtos::semaphore* sem)
+    {
+      int count = 0;
+      for (nfds_t i = 0; i < nfds; ++i)
+        {
+          fds[i].revents = 0;
+          if (fds[i].fd < 0)
+            {
+              // Negative descriptors are ignored.
+              continue;
+            }
+
+          auto* const io = posix::file_descriptors_manager::io (fds[i].fd);
+          int ready = POLLNVAL;
+          if (io != nullptr)
+            {
+              ready = io->poll_register (fds[i].events, sem);
+            }
+          ready &= (fds[i].events | POLLERR | POLLHUP | POLLNVAL);
+
+          fds[i].revents = static_cast<short> (ready);
+          if (ready != 0)
+            {
+              ++count;
+            }
+        }
+      return count;
+    };
+
+  auto release = [=]()
+    {
+      for (nfds_t i = 0; i < nfds; ++i)
+        {
+          auto* const io = posix::file_descriptors_manager::io (fds[i].fd);
+          if (fds[i].fd >= 0 && io != nullptr)
+            {
+              io->poll_register (0, nullptr);
+            }
+        }
+    };
+
+  return poll_wait (scan, release, timeout);
+}
+
+/**
+ * @details
+ * Implemented on top of the same readiness registration as
+ * `poll()`; exceptional conditions map to `POLLPRI`, `POLLERR`
+ * and `POLLHUP`.
+ */
+int
+__posix_select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* errorfds,
+                struct timeval* timeout)
+{
+  if (nfds < 0 || nfds > FD_SETSIZE)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  int ms = -1;
+  if (timeout != nullptr)
+    {
+      ms = static_cast<int> (timeout->tv_sec * 1000
+          + (timeout->tv_usec + 999) / 1000);
+    }
+
+  fd_set rd, wr, er;
+  auto scan = [&](rtos::semaphore* sem)
+    {
+      FD_ZERO(&rd);
+      FD_ZERO(&wr);
+      FD_ZERO(&er);
+
+      int count = 0;
+      for (int fd = 0; fd < nfds; ++fd)
+        {
+          int events = 0;
+          if (readfds != nullptr && FD_ISSET(fd, readfds))
+            {
+              events |= POLLIN;
+            }
+          if (writefds != nullptr && FD_ISSET(fd, writefds))
+            {
+              events |= POLLOUT;
+            }
+          if (errorfds != nullptr && FD_ISSET(fd, errorfds))
+            {
+              events |= POLLPRI;
+            }
+          if (events == 0)
+            {
+              continue;
+            }
+
+          auto* const io = posix::file_descriptors_manager::io (fd);
+          if (io == nullptr)
+            {
+              errno = EBADF;
+              return -1;
+            }
+
+          int ready = io->poll_register (events, sem);
+          if ((events & POLLIN) && (ready & (POLLIN | POLLHUP | POLLERR)))
+            {
+              FD_SET(fd, &rd);
+              ++count;
+            }
+          if ((events & POLLOUT) && (ready & (POLLOUT | POLLHUP | POLLERR)))
+            {
+              FD_SET(fd, &wr);
+              ++count;
+            }
+          if ((events & POLLPRI) && (ready & (POLLPRI | POLLERR)))
+            {
+              FD_SET(fd, &er);
+              ++count;
+            }
+        }
+      return count;
+    };
+
+  auto release = [&]()
+    {
+      for (int fd = 0; fd < nfds; ++fd)
+        {
+          if ((readfds != nullptr && FD_ISSET(fd, readfds))
+              || (writefds != nullptr && FD_ISSET(fd, writefds))
+              || (errorfds != nullptr && FD_ISSET(fd, errorfds)))
+            {
+              auto* const io = posix::file_descriptors_manager::io (fd);
+              if (io != nullptr)
+                {
+                  io->poll_register (0, nullptr);
+                }
+            }
+        }
+    };
+
+  int count = poll_wait (scan, release, ms);
+  if (count < 0)
+    {
+      return -1;
+    }
+
+  if (readfds != nullptr)
+    {
+      *readfds = rd;
+    }
+  if (writefds != nullptr)
+    {
+      *writefds = wr;
+    }
+  if (errorfds != nullptr)
+    {
+      *errorfds = er;
+    }
+  return count;
+}
+
 int
 __posix_ioctl (int fildes, int request, ...)
 {
@@ -395,6 +665,11 @@ __posix_ftruncate (int fildes, off_t length)
       return -1;
     }
 
+  if (io->get_type () == posix::io::type::shared_memory)
+    {
+      return (static_cast<posix::shared_memory*> (io))->ftruncate (length);
+    }
+
   // Works only on files (Does not work on sockets, pipes or FIFOs...)
   if ((io->get_type () & posix::io::type::file) == 0)
     {
@@ -545,6 +820,182 @@ __posix_closedir (DIR* dirp)
   return dir->close ();
 }
 
+// ----------------------------------------------------------------------------
+// Pipe functions
+
+/**
+ * @details
+ * The buffer has `OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES` bytes,
+ * allocated from the default memory resource.
+ */
+int
+__posix_pipe (int fildes[2])
+{
+  auto* const p = posix::pipe::create (fildes);
+  if (p == nullptr)
+    {
+      return -1;
+    }
+  return 0;
+}
+
+/**
+ * @details
+ * As on Linux, one of the descriptors must be a pipe or a FIFO;
+ * no _flags_ are supported.
+ */
+ssize_t
+__posix_splice (int fd_in, off_t* off_in, int fd_out, off_t* off_out,
+                size_t len, unsigned int flags)
+{
+  auto* const in = posix::file_descriptors_manager::io (fd_in);
+  auto* const out = posix::file_descriptors_manager::io (fd_out);
+  if (in == nullptr || out == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return posix::splice (in, off_in, out, off_out, len, flags);
+}
+
+// ----------------------------------------------------------------------------
+// Shared memory functions
+
+/**
+ * @details
+ * The _mode_ is ignored, there are no permissions.
+ */
+int
+__posix_shm_open (const char* name, int oflag,
+                  mode_t mode __attribute__((unused)))
+{
+  auto* const shm = posix::shared_memory::open (name, oflag);
+  if (shm == nullptr)
+    {
+      return -1;
+    }
+  return shm->file_descriptor ();
+}
+
+int
+__posix_shm_unlink (const char* name)
+{
+  return posix::shared_memory::unlink (name);
+}
+
+/**
+ * @details
+ * Only `MAP_SHARED` mappings of shared memory objects are
+ * supported; the memory is not copied, so _addr_ is only a hint
+ * and `MAP_FIXED` is not supported.
+ */
+void*
+__posix_mmap (void* addr __attribute__((unused)), size_t len, int prot,
+              int flags, int fildes, off_t off)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return MAP_FAILED;
+    }
+  if (io->get_type () != posix::io::type::shared_memory)
+    {
+      errno = ENODEV;
+      return MAP_FAILED;
+    }
+  if ((flags & MAP_FIXED) != 0)
+    {
+      errno = ENOTSUP;
+      return MAP_FAILED;
+    }
+  if ((flags & (MAP_SHARED | MAP_PRIVATE)) != MAP_SHARED)
+    {
+      errno = EINVAL;
+      return MAP_FAILED;
+    }
+
+  void* p = static_cast<posix::shared_memory*> (io)->map (len, prot, off);
+  if (p == nullptr)
+    {
+      return MAP_FAILED;
+    }
+  return p;
+}
+
+int
+__posix_munmap (void* addr, size_t len)
+{
+  auto* const shm = posix::shared_memory::identify_mapping (addr);
+  if (shm == nullptr)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+  return shm->unmap (addr, len);
+}
+
+// ----------------------------------------------------------------------------
+// Event poll functions
+
+/**
+ * @details
+ * The interest set has room for _size_ descriptors; unlike
+ * on Linux, it does not grow.
+ */
+int
+__posix_epoll_create (int size)
+{
+  if (size <= 0)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  auto* const ep = posix::event_poll::create (static_cast<std::size_t> (size));
+  if (ep == nullptr)
+    {
+      return -1;
+    }
+  return ep->file_descriptor ();
+}
+
+int
+__posix_epoll_ctl (int epfd, int op, int fd, struct epoll_event* event)
+{
+  auto* const io = posix::file_descriptors_manager::io (epfd);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  if (io->get_type () != posix::io::type::event_poll)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+  return static_cast<posix::event_poll*> (io)->ctl (op, fd, event);
+}
+
+int
+__posix_epoll_wait (int epfd, struct epoll_event* events, int maxevents,
+                    int timeout)
+{
+  auto* const io = posix::file_descriptors_manager::io (epfd);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  if (io->get_type () != posix::io::type::event_poll)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+  return static_cast<posix::event_poll*> (io)->wait (events, maxevents,
+                                                     timeout);
+}
+
 // ----------------------------------------------------------------------------
 // Socket functions
 
@@ -555,7 +1006,7 @@ __posix_closedir (DIR* dirp)
 // The other are socket specific functions.
 
 // In addition, the following IO functions should work on sockets:
-// close(), read(), write(), writev(), ioctl(), fcntl(), select().
+// close(), read(), readv(), write(), writev(), ioctl(), fcntl(), select().
 
 int
 __posix_socket (int domain, int type, int protocol)
@@ -692,6 +1143,19 @@ __posix_recvfrom (int socket, void* buffer, size_t length, int flags,
   return io->recvfrom (buffer, length, flags, address, address_len);
 }
 
+int
+__posix_recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags, struct timespec* timeout)
+{
+  auto* const io = posix::file_descriptors_manager::socket (socket);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->recvmmsg (vmessages, vlen, flags, timeout);
+}
+
 ssize_t
 __posix_recvmsg (int socket, struct msghdr* message, int flags)
 {
@@ -716,6 +1180,19 @@ __posix_send (int socket, const void* buffer, size_t length, int flags)
   return io->send (buffer, length, flags);
 }
 
+int
+__posix_sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags)
+{
+  auto* const io = posix::file_descriptors_manager::socket (socket);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->sendmmsg (vmessages, vlen, flags);
+}
+
 ssize_t
 __posix_sendmsg (int socket, const struct msghdr* message, int flags)
 {
@@ -811,21 +1288,62 @@ __posix_socketpair (int domain, int type, int protocol, int socket_vector[2])
   return -1;
 }
 
+/**
+ * @details
+ * The high resolution clock is used, with the offset of the
+ * real time clock as the epoch of the startup, so the time
+ * has microseconds resolution.
+ */
 int
 __posix_gettimeofday (struct timeval* ptimeval, void* ptimezone)
 {
-  ptimeval->tv_sec = static_cast<time_t> (os::rtos::rtclock.now ());
-  ptimeval->tv_usec = 0;
+  uint64_t ns = os::rtos::hrclock.nanoseconds ();
+
+  ptimeval->tv_sec = static_cast<time_t> (os::rtos::rtclock.offset ()
+      + ns / 1000000000ull);
+  ptimeval->tv_usec = static_cast<suseconds_t> ((ns % 1000000000ull) / 1000);
 
   return 0;
 }
 
+/**
+ * @details
+ * `CLOCK_MONOTONIC` is the time since startup, from the
+ * high resolution clock (the SysTick ticks plus the cycles
+ * since the last tick), with a conversion without divisions;
+ * `CLOCK_REALTIME` adds the offset of the real time clock.
+ */
 int
-__posix_select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* errorfds,
-                struct timeval* timeout)
+__posix_clock_gettime (clockid_t clock_id, struct timespec* tp)
 {
-  errno = ENOSYS; // Not implemented
-  return -1;
+  if (tp == nullptr)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  uint64_t ns = os::rtos::hrclock.nanoseconds ();
+  time_t secs = static_cast<time_t> (ns / 1000000000ull);
+  long nsecs = static_cast<long> (ns % 1000000000ull);
+
+  if (clock_id == CLOCK_REALTIME)
+    {
+      secs += static_cast<time_t> (os::rtos::rtclock.offset ());
+    }
+#if defined(CLOCK_MONOTONIC)
+  else if (clock_id != CLOCK_MONOTONIC)
+#else
+  else
+#endif
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  tp->tv_sec = secs;
+  tp->tv_nsec = nsecs;
+
+  return 0;
 }
 
 clock_t
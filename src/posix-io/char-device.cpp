@@ -45,7 +45,8 @@ namespace os
           { impl, type::char_device, name }
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device::%s(\"%s\")=@%p\n", __func__, name_, this);
+      trace::printf (trace::posix_io_char_device,
+                     "char_device::%s(\"%s\")=@%p\n", __func__, name_, this);
 #endif
 
       device_registry<device>::link (this);
@@ -54,7 +55,8 @@ namespace os
     char_device::~char_device ()
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device::%s() @%p %s\n", __func__, this, name_);
+      trace::printf (trace::posix_io_char_device,
+                     "char_device::%s() @%p %s\n", __func__, this, name_);
 #endif
 
       registry_links_.unlink ();
@@ -67,14 +69,16 @@ namespace os
     char_device_impl::char_device_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device_impl::%s()=@%p\n", __func__, this);
+      trace::printf (trace::posix_io_char_device,
+                     "char_device_impl::%s()=@%p\n", __func__, this);
 #endif
     }
 
     char_device_impl::~char_device_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_char_device,
+                     "char_device_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
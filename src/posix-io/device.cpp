@@ -48,17 +48,20 @@ namespace os
         name_ (name)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(\"%s\")=%p\n", __func__, name_, this);
+      trace::printf (trace::posix_io_device,
+                     "device::%s(\"%s\")=%p\n", __func__, name_, this);
 #endif
     }
 
     device::~device ()
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_device,
+                     "device::%s() @%p\n", __func__, this);
 #endif
 
       registry_links_.unlink ();
+      hash_links_.unlink ();
 
       name_ = nullptr;
     }
@@ -81,7 +84,8 @@ namespace os
     device::vopen (const char* path, int oflag, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(\"%s\") @%p\n", __func__, path ? path : "",
+      trace::printf (trace::posix_io_device,
+                     "device::%s(\"%s\") @%p\n", __func__, path ? path : "",
                      this);
 #endif
 
@@ -98,6 +102,8 @@ namespace os
               return -1;
             }
 
+          impl ().status_flags_ = oflag & (O_ACCMODE | O_APPEND | O_NONBLOCK);
+
           auto iop = alloc_file_descriptor ();
           if (iop == nullptr)
             {
@@ -108,7 +114,8 @@ namespace os
       ++(impl ().open_count_);
       ret = file_descriptor ();
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(\"%s\")=%p fd=%d\n", __func__,
+      trace::printf (trace::posix_io_device,
+                     "device::%s(\"%s\")=%p fd=%d\n", __func__,
                      path ? path : "", this, ret);
 #endif
 
@@ -119,7 +126,8 @@ namespace os
     device::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_device,
+                     "device::%s() @%p\n", __func__, this);
 #endif
 
       errno = 0;
@@ -155,7 +163,8 @@ namespace os
     device::vioctl (int request, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(%d) @%p\n", __func__, request, this);
+      trace::printf (trace::posix_io_device,
+                     "device::%s(%d) @%p\n", __func__, request, this);
 #endif
 
       if (impl ().open_count_ == 0)
@@ -173,7 +182,8 @@ namespace os
     device::sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_device,
+                     "device::%s() @%p\n", __func__, this);
 #endif
 
       if (impl ().open_count_ == 0)
@@ -201,14 +211,16 @@ namespace os
     device_impl::device_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device_impl::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_device,
+                     "device_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     device_impl::~device_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_device,
+                     "device_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -46,14 +46,16 @@ namespace os
         impl_ (impl)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_directory,
+                     "directory::%s()=%p\n", __func__, this);
 #endif
     }
 
     directory::~directory ()
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_directory,
+                     "directory::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -63,7 +65,8 @@ namespace os
     directory::read (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_directory,
+                     "directory::%s() @%p\n", __func__, this);
 #endif
 
       // assert(file_system_ != nullptr);
@@ -77,11 +80,38 @@ namespace os
       return impl ().do_read ();
     }
 
+    ssize_t
+    directory::read_n (struct dirent* buf, std::size_t count)
+    {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+      trace::printf (trace::posix_io_directory,
+                     "directory::%s(%p, %u) @%p\n", __func__, buf, count,
+                     this);
+#endif
+
+      if (buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      errno = 0;
+
+      if (count == 0)
+        {
+          return 0;
+        }
+
+      // Execute the implementation specific code.
+      return impl ().do_read_n (buf, count);
+    }
+
     void
     directory::rewind (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_directory,
+                     "directory::%s() @%p\n", __func__, this);
 #endif
 
       // assert(file_system_ != nullptr);
@@ -97,7 +127,8 @@ namespace os
     directory::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_directory,
+                     "directory::%s() @%p\n", __func__, this);
 #endif
 
       // assert(file_system_ != nullptr);
@@ -123,7 +154,8 @@ namespace os
         file_system_ (fs)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory_impl::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_directory,
+                     "directory_impl::%s()=%p\n", __func__, this);
 #endif
       memset (&dir_entry_, 0, sizeof(struct dirent));
     }
@@ -131,10 +163,37 @@ namespace os
     directory_impl::~directory_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_directory,
+                     "directory_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
+    /**
+     * @details
+     * If an entry fails after some were read, the entries already
+     * read are returned and the error is left for the next call.
+     */
+    ssize_t
+    directory_impl::do_read_n (struct dirent* buf, std::size_t count)
+    {
+      std::size_t n = 0;
+      while (n < count)
+        {
+          struct dirent* de = do_read ();
+          if (de == nullptr)
+            {
+              if (n == 0 && errno != 0)
+                {
+                  return -1;
+                }
+              break;
+            }
+          buf[n++] = *de;
+        }
+
+      return static_cast<ssize_t> (n);
+    }
+
   // ========================================================================
 
   } /* namespace posix */
@@ -0,0 +1,690 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/posix-io/event-poll.h>
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <mutex>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    event_poll* event_poll::deferred_list__;
+
+    event_poll::event_poll (std::size_t size,
+                            rtos::memory::memory_resource* resource) :
+        io
+          { impl_instance_, type::event_poll }, //
+        impl_instance_
+          { size, resource }
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll::%s(%u)=@%p\n", __func__, size, this);
+#endif
+    }
+
+    event_poll::~event_poll ()
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Objects closed since the previous call are deallocated
+     * first, like the files of a file system, since `close()`
+     * cannot delete the object it runs on.
+     */
+    event_poll*
+    event_poll::create (std::size_t size)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll::%s(%u)\n", __func__, size);
+#endif
+
+      if (size == 0)
+        {
+          errno = EINVAL;
+          return nullptr;
+        }
+
+      deallocate_deferred_ ();
+
+      auto* const ep = new (std::nothrow) event_poll
+        { size };
+      if (ep == nullptr)
+        {
+          errno = ENOMEM;
+          return nullptr;
+        }
+      ep->allocated_ = true;
+
+      if (ep->open () < 0)
+        {
+          delete ep;
+          return nullptr;
+        }
+      return ep;
+    }
+
+    int
+    event_poll::open (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll::%s() @%p\n", __func__, this);
+#endif
+
+      if (impl ().do_is_opened ())
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      event_poll_impl& im = impl ();
+      if (im.resource_ == nullptr)
+        {
+          // Taken here, not in the constructor, to also work with
+          // static objects.
+          im.resource_ = rtos::memory::get_default_resource ();
+        }
+
+      im.entries_ = static_cast<event_poll_entry*> (im.resource_->allocate (
+          im.size_ * sizeof(event_poll_entry), alignof(event_poll_entry)));
+      if (im.entries_ == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      for (std::size_t i = 0; i < im.size_; ++i)
+        {
+          event_poll_entry& e = im.entries_[i];
+          e.next = nullptr;
+          e.owner = &im;
+          e.target = nullptr;
+          e.events = 0;
+          e.data.u64 = 0;
+          e.round = 0;
+          e.queued = false;
+        }
+      im.head_ = nullptr;
+      im.tail_ = nullptr;
+
+      if (alloc_file_descriptor () == nullptr)
+        {
+          return -1;
+        }
+      return file_descriptor ();
+    }
+
+    int
+    event_poll::close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll::%s() @%p\n", __func__, this);
+#endif
+
+      int ret = io::close ();
+
+      if (allocated_ && ret == 0)
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          // Deallocated on the next create().
+          deferred_next_ = deferred_list__;
+          deferred_list__ = this;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return ret;
+    }
+
+    int
+    event_poll::ctl (int op, int fd, struct epoll_event* event)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll::%s(%d, %d, %p) @%p\n", __func__, op, fd,
+                     event, this);
+#endif
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      return impl ().ctl_ (op, fd, event);
+    }
+
+    int
+    event_poll::wait (struct epoll_event* events, int maxevents, int timeout)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll::%s(%p, %d, %d) @%p\n", __func__, events,
+                     maxevents, timeout, this);
+#endif
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (events == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (maxevents <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      errno = 0;
+
+      return impl ().wait_ (events, maxevents, timeout);
+    }
+
+    void
+    event_poll::deallocate_deferred_ (void)
+    {
+      event_poll* list;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          list = deferred_list__;
+          deferred_list__ = nullptr;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      while (list != nullptr)
+        {
+          event_poll* const next = list->deferred_next_;
+          delete list;
+          list = next;
+        }
+    }
+
+    // ========================================================================
+
+    event_poll_impl::event_poll_impl (std::size_t size,
+                                      rtos::memory::memory_resource* resource) :
+        resource_ (resource), //
+        size_ (size), //
+        sem_
+          { "epoll", 0 }, //
+        mutex_
+          { "epoll" }
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll_impl::%s(%u)=@%p\n", __func__, size, this);
+#endif
+    }
+
+    event_poll_impl::~event_poll_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf (trace::posix_io_event_poll,
+                     "event_poll_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    bool
+    event_poll_impl::do_is_opened (void)
+    {
+      return entries_ != nullptr;
+    }
+
+    ssize_t
+    event_poll_impl::do_read (void* buf __attribute__((unused)),
+                              std::size_t nbyte __attribute__((unused)))
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+    ssize_t
+    event_poll_impl::do_write (const void* buf __attribute__((unused)),
+                               std::size_t nbyte __attribute__((unused)))
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+    off_t
+    event_poll_impl::do_lseek (off_t offset __attribute__((unused)),
+                               int whence __attribute__((unused)))
+    {
+      errno = ESPIPE;
+      return -1;
+    }
+
+    /**
+     * @details
+     * All watched objects are detached and the interest set
+     * is returned to the memory resource.
+     */
+    int
+    event_poll_impl::do_close (void)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (entries_[i].target != nullptr)
+            {
+              detach_ (&entries_[i]);
+            }
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          head_ = nullptr;
+          tail_ = nullptr;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      resource_->deallocate (entries_, size_ * sizeof(event_poll_entry),
+                             alignof(event_poll_entry));
+      entries_ = nullptr;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * An event poll is readable when its ready list is not empty,
+     * so it can be watched by `poll()`.
+     */
+    int
+    event_poll_impl::do_poll_register (int events, rtos::semaphore* sem)
+    {
+      poll_sem_ = sem;
+
+      return (head_ != nullptr) ? (events & (POLLIN | POLLRDNORM)) : 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    event_poll_impl::ctl_ (int op, int fd, struct epoll_event* event)
+    {
+      if (op != EPOLL_CTL_DEL && event == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      auto* const target = file_descriptors_manager::io (fd);
+      if (target == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      if (&target->impl () == this)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      event_poll_entry* entry = target->impl ().poll_entry_;
+      if (entry != nullptr && entry->owner != this)
+        {
+          // Already watched by another event poll.
+          errno = EBUSY;
+          return -1;
+        }
+
+      switch (op)
+        {
+        case EPOLL_CTL_ADD:
+          if (entry != nullptr)
+            {
+              errno = EEXIST;
+              return -1;
+            }
+
+          for (std::size_t i = 0; i < size_; ++i)
+            {
+              // Entries detached while in the ready list are reused
+              // only after wait() dropped them.
+              if (entries_[i].target == nullptr && !entries_[i].queued)
+                {
+                  entry = &entries_[i];
+                  break;
+                }
+            }
+          if (entry == nullptr)
+            {
+              errno = ENOSPC;
+              return -1;
+            }
+
+          entry->events = event->events;
+          entry->data = event->data;
+          entry->round = round_;
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              entry->target = target;
+              target->impl ().poll_entry_ = entry;
+              // ----- Exit critical section ----------------------------------
+            }
+          break;
+
+        case EPOLL_CTL_MOD:
+          if (entry == nullptr)
+            {
+              errno = ENOENT;
+              return -1;
+            }
+
+          entry->events = event->events;
+          entry->data = event->data;
+          break;
+
+        case EPOLL_CTL_DEL:
+          if (entry == nullptr)
+            {
+              errno = ENOENT;
+              return -1;
+            }
+
+          detach_ (entry);
+          remove_ (entry);
+          return 0;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
+
+      // The current readiness is checked by the next wait(), which
+      // also drops the entry if not ready.
+      notify_ (entry);
+      return 0;
+    }
+
+    int
+    event_poll_impl::wait_ (struct epoll_event* events, int maxevents,
+                            int timeout)
+    {
+      rtos::clock::timestamp_t deadline = 0;
+      if (timeout > 0)
+        {
+          deadline = rtos::sysclock.now ()
+              + rtos::clock_systick::ticks_cast (
+                  static_cast<uint64_t> (timeout) * 1000u);
+        }
+
+      int count;
+      for (;;)
+        {
+          count = collect_ (events, maxevents);
+          if (count != 0 || timeout == 0)
+            {
+              break;
+            }
+
+          rtos::result_t res;
+          if (timeout < 0)
+            {
+              res = sem_.wait ();
+            }
+          else
+            {
+              rtos::clock::timestamp_t now = rtos::sysclock.now ();
+              if (now >= deadline)
+                {
+                  break;
+                }
+              res = sem_.timed_wait (
+                  static_cast<rtos::clock::duration_t> (deadline - now));
+            }
+
+          if (res == EINTR)
+            {
+              errno = EINTR;
+              return -1;
+            }
+        }
+
+      return count;
+    }
+
+    /**
+     * @details
+     * Only the entries in the ready list are checked. Those still
+     * ready are reported and, unless edge triggered, pushed back,
+     * so the next call sees them again; the others are dropped until
+     * their object notifies again.
+     */
+    int
+    event_poll_impl::collect_ (struct epoll_event* events, int maxevents)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      ++round_;
+
+      int count = 0;
+      while (count < maxevents)
+        {
+          event_poll_entry* const entry = pop_ ();
+          if (entry == nullptr)
+            {
+              break;
+            }
+
+          if (entry->round == round_)
+            {
+              // Back to the first entry pushed back by this call.
+              push_ (entry);
+              break;
+            }
+
+          class io* const target = entry->target;
+          if (target == nullptr)
+            {
+              // Detached.
+              continue;
+            }
+
+          int ready = target->impl ().poll_ready (
+              static_cast<int> (entry->events & ~EPOLLET));
+          ready &= static_cast<int> (entry->events | EPOLLERR | EPOLLHUP);
+          if (ready == 0)
+            {
+              continue;
+            }
+
+          events[count].events = static_cast<uint32_t> (ready);
+          events[count].data = entry->data;
+          ++count;
+
+          if ((entry->events & EPOLLET) == 0)
+            {
+              entry->round = round_;
+              push_ (entry);
+            }
+        }
+
+      return count;
+    }
+
+    // ------------------------------------------------------------------------
+
+    void
+    event_poll_impl::push_ (event_poll_entry* entry)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      if (entry->queued)
+        {
+          return;
+        }
+
+      entry->queued = true;
+      entry->next = nullptr;
+      if (tail_ == nullptr)
+        {
+          head_ = entry;
+        }
+      else
+        {
+          tail_->next = entry;
+        }
+      tail_ = entry;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    event_poll_entry*
+    event_poll_impl::pop_ (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      event_poll_entry* const entry = head_;
+      if (entry != nullptr)
+        {
+          head_ = entry->next;
+          if (head_ == nullptr)
+            {
+              tail_ = nullptr;
+            }
+          entry->queued = false;
+        }
+      return entry;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    void
+    event_poll_impl::remove_ (event_poll_entry* entry)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      if (!entry->queued)
+        {
+          return;
+        }
+
+      event_poll_entry* prev = nullptr;
+      for (event_poll_entry* p = head_; p != nullptr; p = p->next)
+        {
+          if (p == entry)
+            {
+              if (prev == nullptr)
+                {
+                  head_ = p->next;
+                }
+              else
+                {
+                  prev->next = p->next;
+                }
+              if (tail_ == p)
+                {
+                  tail_ = prev;
+                }
+              break;
+            }
+          prev = p;
+        }
+      entry->queued = false;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    void
+    event_poll_impl::notify_ (event_poll_entry* entry)
+    {
+      event_poll_impl* const owner = entry->owner;
+
+      owner->push_ (entry);
+      owner->sem_.post ();
+
+      // For a poll() watching the event poll itself.
+      owner->poll_notify ();
+    }
+
+    void
+    event_poll_impl::detach_ (event_poll_entry* entry)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      class io* const target = entry->target;
+      if (target != nullptr)
+        {
+          target->impl ().poll_entry_ = nullptr;
+          entry->target = nullptr;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -51,6 +51,13 @@ namespace os
 
     io** file_descriptors_manager::descriptors_array__;
 
+    uint32_t* file_descriptors_manager::free_bitmap__;
+    std::size_t file_descriptors_manager::bitmap_words__;
+    std::size_t file_descriptors_manager::first_free_word__;
+
+    std::size_t file_descriptors_manager::used__;
+    std::size_t file_descriptors_manager::used_by_type__[types__];
+
     /**
      * @endcond
      */
@@ -70,13 +77,33 @@ namespace os
         {
           descriptors_array__[i] = nullptr;
         }
+
+      // All free, except the standard files and the bits past the end.
+      bitmap_words__ = (size__ + 31) / 32;
+      free_bitmap__ = new uint32_t[bitmap_words__];
+      for (std::size_t i = 0; i < bitmap_words__; ++i)
+        {
+          free_bitmap__[i] = 0;
+        }
+      for (std::size_t i = reserved__; i < size__; ++i)
+        {
+          free_bitmap__[i / 32] |= (0x80000000u >> (i % 32));
+        }
+      first_free_word__ = reserved__ / 32;
+
+      used__ = reserved__;
+      for (std::size_t i = 0; i < types__; ++i)
+        {
+          used_by_type__[i] = 0;
+        }
     }
 
     file_descriptors_manager::~file_descriptors_manager ()
     {
-      trace::printf ("file_descriptors_manager::%s(%) @%p\n", __func__, this);
+      trace::printf ("file_descriptors_manager::%s() @%p\n", __func__, this);
 
       delete[] descriptors_array__;
+      delete[] free_bitmap__;
       size__ = 0;
     }
 
@@ -108,7 +135,8 @@ namespace os
     file_descriptors_manager::allocate (class io* io)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
-      trace::printf ("file_descriptors_manager::%s(%p)\n", __func__, io);
+      trace::printf (trace::posix_io_file_descriptors_manager,
+                     "file_descriptors_manager::%s(%p)\n", __func__, io);
 #endif
 
       if (io->file_descriptor () >= 0)
@@ -118,23 +146,36 @@ namespace os
           return -1;
         }
 
-      for (std::size_t i = reserved__; i < size__; ++i)
+      // Words below first_free_word__ are full, so the first word
+      // with a bit set holds the lowest free descriptor.
+      std::size_t w = first_free_word__;
+      while (w < bitmap_words__ && free_bitmap__[w] == 0)
         {
-          if (descriptors_array__[i] == nullptr)
-            {
-              descriptors_array__[i] = io;
-              io->file_descriptor (static_cast<int> (i));
-#if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
-              trace::printf ("file_descriptors_manager::%s(%p) fd=%d\n",
-                             __func__, io, i);
-#endif
-              return static_cast<int> (i);
-            }
+          ++w;
+        }
+      first_free_word__ = w;
+
+      if (w == bitmap_words__)
+        {
+          // Too many files open in system.
+          errno = ENFILE;
+          return -1;
         }
 
-      // Too many files open in system.
-      errno = ENFILE;
-      return -1;
+      std::size_t i = w * 32
+          + static_cast<std::size_t> (__builtin_clz (free_bitmap__[w]));
+      free_bitmap__[w] &= ~(0x80000000u >> (i % 32));
+
+      descriptors_array__[i] = io;
+      io->file_descriptor (static_cast<int> (i));
+      count__ (io, i, 1);
+
+#if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
+      trace::printf (trace::posix_io_file_descriptors_manager,
+                     "file_descriptors_manager::%s(%p) fd=%d\n", __func__, io,
+                     i);
+#endif
+      return static_cast<int> (i);
     }
 
     int
@@ -153,8 +194,20 @@ namespace os
           return -1;
         }
 
+      if (descriptors_array__[fildes] != nullptr)
+        {
+          descriptors_array__[fildes]->clear_file_descriptor ();
+          count__ (descriptors_array__[fildes],
+                   static_cast<std::size_t> (fildes), -1);
+        }
+
       descriptors_array__[fildes] = io;
       io->file_descriptor (fildes);
+
+      std::size_t i = static_cast<std::size_t> (fildes);
+      count__ (io, i, 1);
+      free_bitmap__[i / 32] &= ~(0x80000000u >> (i % 32));
+
       return fildes;
     }
 
@@ -162,7 +215,8 @@ namespace os
     file_descriptors_manager::deallocate (int fildes)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
-      trace::printf ("file_descriptors_manager::%s(%d)\n", __func__, fildes);
+      trace::printf (trace::posix_io_file_descriptors_manager,
+                     "file_descriptors_manager::%s(%d)\n", __func__, fildes);
 #endif
 
       if ((fildes < 0) || (static_cast<std::size_t> (fildes) >= size__))
@@ -171,17 +225,35 @@ namespace os
           return -1;
         }
 
-      descriptors_array__[fildes]->clear_file_descriptor ();
+      auto* const io = descriptors_array__[fildes];
+      if (io == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      io->clear_file_descriptor ();
       descriptors_array__[fildes] = nullptr;
+
+      std::size_t i = static_cast<std::size_t> (fildes);
+      count__ (io, i, -1);
+      if (i >= reserved__)
+        {
+          // The standard files are never allocated, only assigned.
+          free_bitmap__[i / 32] |= (0x80000000u >> (i % 32));
+          if (i / 32 < first_free_word__)
+            {
+              first_free_word__ = i / 32;
+            }
+        }
       return 0;
     }
 
     class socket*
     file_descriptors_manager::socket (int fildes)
     {
-      assert((fildes >= 0) && (static_cast<std::size_t> (fildes) < size__));
-      auto* const io = descriptors_array__[fildes];
-      if (io->get_type () != io::type::socket)
+      auto* const io = file_descriptors_manager::io (fildes);
+      if (io == nullptr || io->get_type () != io::type::socket)
         {
           return nullptr;
         }
@@ -189,18 +261,35 @@ namespace os
     }
 
     size_t
-    file_descriptors_manager::used (void)
+    file_descriptors_manager::used (io::type_t type)
     {
-      std::size_t count = reserved__;
-      for (std::size_t i = reserved__; i < file_descriptors_manager::size ();
-          ++i)
+      return used_by_type__[type_index__ (type)];
+    }
+
+    std::size_t
+    file_descriptors_manager::type_index__ (io::type_t type)
+    {
+      // The types are single bits; unknown shares the not_set counter.
+      if (type == 0)
         {
-          if (descriptors_array__[i] != nullptr)
-            {
-              ++count;
-            }
+          return 0;
+        }
+      std::size_t index = static_cast<std::size_t> (__builtin_ctz (type));
+      return (index < types__) ? index : 0;
+    }
+
+    void
+    file_descriptors_manager::count__ (class io* io, std::size_t fildes,
+                                       int delta)
+    {
+      std::size_t& counter = used_by_type__[type_index__ (io->get_type ())];
+      counter += static_cast<std::size_t> (delta);
+
+      // The standard files are always counted as used.
+      if (fildes >= reserved__)
+        {
+          used__ += static_cast<std::size_t> (delta);
         }
-      return count;
     }
 
   // ========================================================================
@@ -0,0 +1,2261 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/file-system-log.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // "LOG1", at the beginning of each valid block.
+      constexpr uint32_t block_magic = 0x31474F4C;
+
+      // The record of a removed file.
+      constexpr uint16_t flag_deleted = 1;
+
+      // CRC-32 (IEEE 802.3), without a table, to keep the RAM low.
+      uint32_t
+      crc32 (uint32_t crc, const void* buf, std::size_t nbyte)
+      {
+        const uint8_t* p = static_cast<const uint8_t*> (buf);
+        crc = ~crc;
+        while (nbyte-- > 0)
+          {
+            crc ^= *p++;
+            for (int k = 0; k < 8; ++k)
+              {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+              }
+          }
+        return ~crc;
+      }
+
+      uint32_t
+      now (void)
+      {
+        return static_cast<uint32_t> (std::time (nullptr));
+      }
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    file_system_log_impl::file_system_log_impl (
+        block_device& device, rtos::memory::memory_resource* resource) :
+        file_system_impl
+          { device }, //
+        resource_ (resource)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_log_impl::%s()=%p\n", __func__, this);
+#endif
+
+      for (auto& nd : nodes_)
+        {
+          nd = node_t
+            { };
+          nd.meta_block = no_block;
+        }
+    }
+
+    file_system_log_impl::~file_system_log_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_log_impl::%s() @%p\n", __func__, this);
+#endif
+
+      teardown_ ();
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * All segments are erased and the erase counts restart from 1;
+     * the file system has only the root folder.
+     */
+    int
+    file_system_log_impl::do_vmkfs (int options,
+                                    std::va_list args __attribute__((unused)))
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_log_impl::%s(%d) @%p\n", __func__, options,
+                     this);
+#endif
+
+      if (mounted_)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      if (options < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (setup_ (static_cast<std::size_t> (options)) < 0)
+        {
+          return -1;
+        }
+
+      int ret = 0;
+      for (std::size_t s = 0; s < segments_; ++s)
+        {
+          ret = erase_segment_ (s);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+
+      // Without erase, the discarded blocks may keep their content,
+      // which mount() would find again; overwrite them.
+      if (ret == 0 && device_.erase (0, segment_blocks_) < 0)
+        {
+          if (errno != ENOSYS)
+            {
+              ret = -1;
+            }
+          else
+            {
+              std::memset (buf_, 0, block_size_);
+              for (blknum_t b = 0; b < blocks_ && ret == 0; ++b)
+                {
+                  if (device_.write_block (buf_, b, 1) != 1)
+                    {
+                      ret = -1;
+                    }
+                }
+            }
+        }
+
+      if (ret == 0)
+        {
+          node_t& root = nodes_[0];
+          root.rec.birth = seq_;
+          root.rec.mode = S_IFDIR | 0777;
+          root.rec.mtime = now ();
+          root.rec.parent = no_inode;
+          root.used = true;
+
+          ret = write_record_ (0, root.rec);
+        }
+
+      if (ret == 0)
+        {
+          device_.sync ();
+        }
+
+      int err = errno;
+      teardown_ ();
+      errno = err;
+
+      return ret;
+    }
+
+    /**
+     * @details
+     * All blocks are read, to rebuild the block map and the
+     * inode table; failed blocks, for example those written when
+     * the power failed, are ignored, and are reclaimed later with
+     * their segment.
+     */
+    int
+    file_system_log_impl::do_vmount (unsigned int flags __attribute__((unused)),
+                                     std::va_list args __attribute__((unused)))
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_log_impl::%s(%u) @%p\n", __func__, flags,
+                     this);
+#endif
+
+      if (mounted_)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      if (setup_ (0) < 0)
+        {
+          return -1;
+        }
+
+      // Find the segment size from the first valid block.
+      int ret = -1;
+      errno = EINVAL; // Not formatted.
+      for (blknum_t b = 0; b < device_.blocks (); ++b)
+        {
+          if (device_.read_block (buf_, b, 1) != 1)
+            {
+              continue;
+            }
+
+          header_t hdr;
+          std::memcpy (&hdr, buf_, sizeof(hdr));
+          if (hdr.magic != block_magic || hdr.segment_blocks == 0)
+            {
+              continue;
+            }
+
+          std::size_t sb = hdr.segment_blocks;
+          if (sb != segment_blocks_)
+            {
+              teardown_ ();
+              if (setup_ (sb) < 0)
+                {
+                  return -1;
+                }
+            }
+          ret = scan_ ();
+          break;
+        }
+
+      if (ret < 0)
+        {
+          int err = errno;
+          teardown_ ();
+          errno = err;
+          return -1;
+        }
+
+      mounted_ = true;
+      return 0;
+    }
+
+    int
+    file_system_log_impl::do_umount (unsigned int flags __attribute__((unused)))
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_log_impl::%s(%u) @%p\n", __func__, flags,
+                     this);
+#endif
+
+      if (!mounted_)
+        {
+          errno = EINVAL; // Not mounted.
+          return -1;
+        }
+
+      // The file system already called do_sync().
+      teardown_ ();
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * The mode is ignored, the new files are readable and
+     * writable by all.
+     */
+    file*
+    file_system_log_impl::do_vopen (class file_system& fs, const char* path,
+                                    int oflag,
+                                    std::va_list args __attribute__((unused)))
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return nullptr;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return nullptr;
+        }
+
+      int acc = oflag & O_ACCMODE;
+      if (ino == no_inode)
+        {
+          if ((oflag & O_CREAT) == 0)
+            {
+              errno = ENOENT;
+              return nullptr;
+            }
+
+          if (create_ (parent, leaf, S_IFREG | 0666, &ino) < 0)
+            {
+              return nullptr;
+            }
+        }
+      else
+        {
+          if ((oflag & (O_CREAT | O_EXCL)) == (O_CREAT | O_EXCL))
+            {
+              errno = EEXIST;
+              return nullptr;
+            }
+
+          if ((nodes_[ino].rec.mode & S_IFMT) == S_IFDIR)
+            {
+              errno = EISDIR;
+              return nullptr;
+            }
+        }
+
+      if (open_inode_ (ino) < 0)
+        {
+          return nullptr;
+        }
+
+      if ((oflag & O_TRUNC) != 0 && acc != O_RDONLY
+          && nodes_[ino].rec.size != 0)
+        {
+          if (resize_ (ino, 0) < 0 || commit_ (ino) < 0)
+            {
+              int err = errno;
+              close_inode_ (ino);
+              errno = err;
+              return nullptr;
+            }
+        }
+
+      file_log* fil = fs.allocate_file<file_log> ();
+      if (fil == nullptr)
+        {
+          close_inode_ (ino);
+          errno = ENOMEM;
+          return nullptr;
+        }
+
+      file_log_impl& im = fil->impl ();
+      im.inode_ = ino;
+      im.offset_ = 0;
+      im.status_flags_ = oflag & (O_ACCMODE | O_APPEND | O_NONBLOCK);
+
+      return fil;
+    }
+
+    directory*
+    file_system_log_impl::do_opendir (class file_system& fs,
+                                      const char* dirname)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return nullptr;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (dirname, &ino, &parent, &leaf) < 0)
+        {
+          return nullptr;
+        }
+
+      if (ino == no_inode)
+        {
+          errno = ENOENT;
+          return nullptr;
+        }
+
+      if ((nodes_[ino].rec.mode & S_IFMT) != S_IFDIR)
+        {
+          errno = ENOTDIR;
+          return nullptr;
+        }
+
+      directory_log* dir = fs.allocate_directory<directory_log> ();
+      if (dir == nullptr)
+        {
+          errno = ENOMEM;
+          return nullptr;
+        }
+
+      dir->impl ().inode_ = ino;
+      dir->impl ().pos_ = 0;
+
+      return dir;
+    }
+
+    int
+    file_system_log_impl::do_mkdir (const char* path, mode_t mode)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (ino != no_inode)
+        {
+          errno = EEXIST;
+          return -1;
+        }
+
+      return create_ (parent, leaf,
+                      static_cast<mode_t> (S_IFDIR | (mode & 0777)), &ino);
+    }
+
+    int
+    file_system_log_impl::do_rmdir (const char* path)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (ino == no_inode)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      if (ino == 0)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      if ((nodes_[ino].rec.mode & S_IFMT) != S_IFDIR)
+        {
+          errno = ENOTDIR;
+          return -1;
+        }
+
+      for (std::size_t i = 1; i < inodes; ++i)
+        {
+          if (nodes_[i].used && nodes_[i].rec.parent == ino)
+            {
+              errno = ENOTEMPTY;
+              return -1;
+            }
+        }
+
+      return remove_ (ino);
+    }
+
+    /**
+     * @details
+     * Commit all files and write the device buffers.
+     */
+    void
+    file_system_log_impl::do_sync (void)
+    {
+      if (!mounted_)
+        {
+          return;
+        }
+
+      for (std::size_t i = 0; i < inodes; ++i)
+        {
+          node_t& nd = nodes_[i];
+          if (nd.used && (nd.dirty || nd.cache_dirty))
+            {
+              commit_ (static_cast<inum_t> (i));
+            }
+        }
+
+      device_.sync ();
+    }
+
+    int
+    file_system_log_impl::do_chmod (const char* path, mode_t mode)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (ino == no_inode)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      record_t& rec = nodes_[ino].rec;
+      rec.mode = (rec.mode & S_IFMT) | (mode & 07777);
+
+      return commit_ (ino);
+    }
+
+    int
+    file_system_log_impl::do_stat (const char* path, struct stat* buf)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (ino == no_inode)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      fill_stat_ (ino, buf);
+      return 0;
+    }
+
+    int
+    file_system_log_impl::do_truncate (const char* path, off_t length)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (ino == no_inode)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      if ((nodes_[ino].rec.mode & S_IFMT) == S_IFDIR)
+        {
+          errno = EISDIR;
+          return -1;
+        }
+
+      if (length < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      // The tail might need to be rewritten, with the file cache.
+      if (open_inode_ (ino) < 0)
+        {
+          return -1;
+        }
+
+      int ret = resize_ (ino, static_cast<std::size_t> (length));
+      if (ret == 0)
+        {
+          ret = commit_ (ino);
+        }
+
+      int err = errno;
+      close_inode_ (ino);
+      errno = err;
+
+      return ret;
+    }
+
+    /**
+     * @details
+     * The new name is written with a single record, so the file
+     * is found either with the old or with the new name; an existing
+     * destination is removed before.
+     */
+    int
+    file_system_log_impl::do_rename (const char* existing, const char* _new)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t src;
+      inum_t src_parent;
+      const char* src_leaf;
+      if (lookup_ (existing, &src, &src_parent, &src_leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (src == no_inode)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      inum_t dst;
+      inum_t dst_parent;
+      const char* dst_leaf;
+      if (lookup_ (_new, &dst, &dst_parent, &dst_leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (src == 0 || dst == 0)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      if (dst == src)
+        {
+          return 0;
+        }
+
+      bool src_dir = ((nodes_[src].rec.mode & S_IFMT) == S_IFDIR);
+      if (src_dir)
+        {
+          // Cannot move a folder inside itself.
+          for (inum_t p = dst_parent; p != no_inode;
+              p = nodes_[p].rec.parent)
+            {
+              if (p == src)
+                {
+                  errno = EINVAL;
+                  return -1;
+                }
+            }
+        }
+
+      if (dst != no_inode)
+        {
+          bool dst_dir = ((nodes_[dst].rec.mode & S_IFMT) == S_IFDIR);
+          if (dst_dir && !src_dir)
+            {
+              errno = EISDIR;
+              return -1;
+            }
+          if (!dst_dir && src_dir)
+            {
+              errno = ENOTDIR;
+              return -1;
+            }
+          if (dst_dir)
+            {
+              for (std::size_t i = 1; i < inodes; ++i)
+                {
+                  if (nodes_[i].used && nodes_[i].rec.parent == dst)
+                    {
+                      errno = ENOTEMPTY;
+                      return -1;
+                    }
+                }
+            }
+          if (remove_ (dst) < 0)
+            {
+              return -1;
+            }
+        }
+
+      record_t& rec = nodes_[src].rec;
+      std::size_t len = std::strcspn (dst_leaf, "/");
+      rec.parent = dst_parent;
+      std::memset (rec.name, 0, sizeof(rec.name));
+      std::memcpy (rec.name, dst_leaf, len);
+
+      return commit_ (src);
+    }
+
+    /**
+     * @details
+     * The opened files cannot be removed (`EBUSY`).
+     */
+    int
+    file_system_log_impl::do_unlink (const char* path)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (ino == no_inode)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      if ((nodes_[ino].rec.mode & S_IFMT) == S_IFDIR)
+        {
+          errno = EISDIR;
+          return -1;
+        }
+
+      return remove_ (ino);
+    }
+
+    int
+    file_system_log_impl::do_utime (const char* path,
+                                    const struct utimbuf* times)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      inum_t ino;
+      inum_t parent;
+      const char* leaf;
+      if (lookup_ (path, &ino, &parent, &leaf) < 0)
+        {
+          return -1;
+        }
+
+      if (ino == no_inode)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      nodes_[ino].rec.mtime = static_cast<uint32_t> (times->modtime);
+
+      return commit_ (ino);
+    }
+
+    /**
+     * @details
+     * The blocks are the file data payload; one segment is kept
+     * in reserve, for reclaiming the space, and is not counted.
+     */
+    int
+    file_system_log_impl::do_statvfs (struct statvfs* buf)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      std::size_t total = (segments_ - 1) * segment_blocks_;
+      std::size_t used = 0;
+      for (std::size_t s = 0; s < segments_; ++s)
+        {
+          used += live_blocks_ (s);
+        }
+
+      std::size_t files = 0;
+      for (auto& nd : nodes_)
+        {
+          if (nd.used)
+            {
+              ++files;
+            }
+        }
+
+      std::memset (buf, 0, sizeof(*buf));
+      buf->f_bsize = payload_ ();
+      buf->f_frsize = payload_ ();
+      buf->f_blocks = total;
+      buf->f_bfree = (used < total) ? (total - used) : 0;
+      buf->f_bavail = buf->f_bfree;
+      buf->f_files = inodes;
+      buf->f_ffree = inodes - files;
+      buf->f_favail = buf->f_ffree;
+      buf->f_namemax = name_size - 1;
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    uint32_t
+    file_system_log_impl::erase_count (std::size_t segment) const
+    {
+      if (segs_ == nullptr || segment >= segments_)
+        {
+          return 0;
+        }
+      return segs_[segment].erase_count;
+    }
+
+    std::size_t
+    file_system_log_impl::free_segments (void) const
+    {
+      std::size_t count = 0;
+      for (std::size_t s = 0; s < segments_; ++s)
+        {
+          if (!segs_[s].written && !(has_head_ && s == head_seg_))
+            {
+              ++count;
+            }
+        }
+      return count;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    int
+    file_system_log_impl::setup_ (std::size_t segment_blocks)
+    {
+      block_size_ = device_.block_logical_size_bytes ();
+      if (block_size_ < sizeof(header_t) + sizeof(record_t)
+          || block_size_ - sizeof(header_t) > 0xFFFF)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      std::size_t eb = device_.erase_blocks ();
+      if (segment_blocks == 0)
+        {
+          segment_blocks = eb;
+        }
+      if ((segment_blocks % eb) != 0 || segment_blocks > 0xFFFF)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      segment_blocks_ = segment_blocks;
+      segments_ = device_.blocks () / segment_blocks_;
+      // The root, the head and the reserve.
+      if (segments_ < 3)
+        {
+          segments_ = 0;
+          errno = EINVAL;
+          return -1;
+        }
+      blocks_ = segments_ * segment_blocks_;
+
+      if (resource_ == nullptr)
+        {
+          resource_ = rtos::memory::get_default_resource ();
+        }
+
+      map_ = static_cast<block_entry_t*> (resource_->allocate (
+          blocks_ * sizeof(block_entry_t), alignof(block_entry_t)));
+      segs_ = static_cast<segment_entry_t*> (resource_->allocate (
+          segments_ * sizeof(segment_entry_t), alignof(segment_entry_t)));
+      buf_ = static_cast<uint8_t*> (resource_->allocate (
+          block_size_, rtos::memory::memory_resource::max_align));
+      if (map_ == nullptr || segs_ == nullptr || buf_ == nullptr)
+        {
+          teardown_ ();
+          errno = ENOMEM;
+          return -1;
+        }
+
+      for (std::size_t b = 0; b < blocks_; ++b)
+        {
+          map_[b] = block_entry_t
+            { 0, 0, no_inode, unused };
+        }
+      for (std::size_t s = 0; s < segments_; ++s)
+        {
+          segs_[s] = segment_entry_t
+            { 0, false, false };
+        }
+      for (auto& nd : nodes_)
+        {
+          nd = node_t
+            { };
+          nd.meta_block = no_block;
+        }
+
+      has_head_ = false;
+      seq_ = 1;
+
+      return 0;
+    }
+
+    void
+    file_system_log_impl::teardown_ (void)
+    {
+      for (auto& nd : nodes_)
+        {
+          if (nd.cache != nullptr)
+            {
+              resource_->deallocate (nd.cache, payload_ (),
+                                     rtos::memory::memory_resource::max_align);
+            }
+          nd = node_t
+            { };
+          nd.meta_block = no_block;
+        }
+
+      if (map_ != nullptr)
+        {
+          resource_->deallocate (map_, blocks_ * sizeof(block_entry_t),
+                                 alignof(block_entry_t));
+          map_ = nullptr;
+        }
+      if (segs_ != nullptr)
+        {
+          resource_->deallocate (segs_, segments_ * sizeof(segment_entry_t),
+                                 alignof(segment_entry_t));
+          segs_ = nullptr;
+        }
+      if (buf_ != nullptr)
+        {
+          resource_->deallocate (buf_, block_size_,
+                                 rtos::memory::memory_resource::max_align);
+          buf_ = nullptr;
+        }
+
+      segments_ = 0;
+      segment_blocks_ = 0;
+      blocks_ = 0;
+      has_head_ = false;
+      mounted_ = false;
+    }
+
+    int
+    file_system_log_impl::scan_ (void)
+    {
+      uint32_t max_seq = 0;
+      bool found = false;
+
+      for (blknum_t b = 0; b < blocks_; ++b)
+        {
+          if (device_.read_block (buf_, b, 1) != 1)
+            {
+              continue;
+            }
+
+          header_t hdr;
+          std::memcpy (&hdr, buf_, sizeof(hdr));
+          if (hdr.magic != block_magic
+              || hdr.segment_blocks != segment_blocks_
+              || hdr.length > payload_ () || hdr.inode >= inodes)
+            {
+              continue;
+            }
+
+          bool is_record = (hdr.index == record_index);
+          if (is_record && hdr.length != sizeof(record_t))
+            {
+              continue;
+            }
+
+          uint32_t crc = hdr.crc;
+          hdr.crc = 0;
+          uint32_t c = crc32 (0, &hdr, sizeof(hdr));
+          c = crc32 (c, buf_ + sizeof(hdr), hdr.length);
+          if (c != crc)
+            {
+              continue;
+            }
+
+          std::size_t s = b / segment_blocks_;
+          segs_[s].written = true;
+          if (hdr.wear > segs_[s].erase_count)
+            {
+              segs_[s].erase_count = hdr.wear;
+            }
+
+          map_[b] = block_entry_t
+            { hdr.seq, hdr.index, hdr.inode, live };
+          if (hdr.seq > max_seq)
+            {
+              max_seq = hdr.seq;
+            }
+
+          if (is_record)
+            {
+              node_t& nd = nodes_[hdr.inode];
+              if (nd.meta_block == no_block || hdr.seq > nd.commit_seq)
+                {
+                  if (nd.meta_block != no_block)
+                    {
+                      map_[nd.meta_block].state = dead;
+                    }
+                  std::memcpy (&nd.rec, buf_ + sizeof(hdr), sizeof(nd.rec));
+                  nd.commit_seq = hdr.seq;
+                  nd.meta_block = b;
+                  nd.used = ((nd.rec.flags & flag_deleted) == 0);
+                  found = true;
+                }
+              else
+                {
+                  map_[b].state = dead;
+                }
+            }
+        }
+
+      if (!found || !nodes_[0].used
+          || (nodes_[0].rec.mode & S_IFMT) != S_IFDIR)
+        {
+          errno = EINVAL; // Not formatted.
+          return -1;
+        }
+
+      // Keep only the committed data of the existing files; in
+      // case of duplicates, the newest. The previous blocks were
+      // already checked.
+      const std::size_t pl = payload_ ();
+      for (blknum_t b = 0; b < blocks_; ++b)
+        {
+          block_entry_t& e = map_[b];
+          if (e.state != live || e.index == record_index)
+            {
+              continue;
+            }
+
+          const node_t& nd = nodes_[e.inode];
+          std::size_t nblocks = (nd.rec.size + pl - 1) / pl;
+          if (!nd.used || e.seq <= nd.rec.birth || e.seq > nd.commit_seq
+              || e.index >= nblocks)
+            {
+              e.state = dead;
+              continue;
+            }
+
+          for (blknum_t k = 0; k < b; ++k)
+            {
+              block_entry_t& o = map_[k];
+              if (o.state == live && o.inode == e.inode && o.index == e.index)
+                {
+                  if (o.seq > e.seq)
+                    {
+                      e.state = dead;
+                    }
+                  else
+                    {
+                      o.state = dead;
+                    }
+                  break;
+                }
+            }
+        }
+
+      // The segments without valid blocks were possibly erased
+      // before the failure; count them with the least used ones.
+      uint32_t min_wear = 0;
+      bool any = false;
+      for (std::size_t s = 0; s < segments_; ++s)
+        {
+          if (segs_[s].written && (!any || segs_[s].erase_count < min_wear))
+            {
+              min_wear = segs_[s].erase_count;
+              any = true;
+            }
+        }
+      for (std::size_t s = 0; s < segments_; ++s)
+        {
+          if (!segs_[s].written)
+            {
+              segs_[s].erase_count = min_wear;
+            }
+        }
+
+      seq_ = max_seq + 1;
+      return 0;
+    }
+
+    std::size_t
+    file_system_log_impl::live_blocks_ (std::size_t segment) const
+    {
+      std::size_t count = 0;
+      const block_entry_t* e = &map_[segment * segment_blocks_];
+      for (std::size_t i = 0; i < segment_blocks_; ++i)
+        {
+          if (e[i].state == live || e[i].state == pending)
+            {
+              ++count;
+            }
+        }
+      return count;
+    }
+
+    int
+    file_system_log_impl::erase_segment_ (std::size_t segment)
+    {
+      blknum_t first = segment * segment_blocks_;
+      if (device_.erase (first, segment_blocks_) < 0)
+        {
+          if (errno != ENOSYS)
+            {
+              return -1;
+            }
+
+          // Managed flash, the controller erases the discarded blocks.
+          if (device_.discard (first, segment_blocks_) < 0)
+            {
+              return -1;
+            }
+        }
+
+      for (std::size_t i = 0; i < segment_blocks_; ++i)
+        {
+          map_[first + i] = block_entry_t
+            { 0, 0, no_inode, unused };
+        }
+
+      segment_entry_t& se = segs_[segment];
+      ++se.erase_count;
+      se.written = false;
+      se.erased = true;
+
+      return 0;
+    }
+
+    int
+    file_system_log_impl::open_segment_ (std::size_t segment)
+    {
+      if (!segs_[segment].erased && erase_segment_ (segment) < 0)
+        {
+          return -1;
+        }
+
+      segs_[segment].written = true;
+      segs_[segment].erased = false;
+
+      head_seg_ = segment;
+      head_pos_ = 0;
+      has_head_ = true;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * Greedy, the segment with the fewest live blocks is copied
+     * to the reserve segment, which becomes the head, and is erased,
+     * becoming the new reserve.
+     */
+    int
+    file_system_log_impl::collect_ (void)
+    {
+      std::size_t victim = segments_;
+      std::size_t victim_live = 0;
+      std::size_t reserve = segments_;
+
+      for (std::size_t s = 0; s < segments_; ++s)
+        {
+          if (has_head_ && s == head_seg_)
+            {
+              continue;
+            }
+          if (!segs_[s].written)
+            {
+              if (reserve == segments_
+                  || segs_[s].erase_count < segs_[reserve].erase_count)
+                {
+                  reserve = s;
+                }
+              continue;
+            }
+
+          std::size_t live = live_blocks_ (s);
+          if (victim == segments_ || live < victim_live
+              || (live == victim_live
+                  && segs_[s].erase_count < segs_[victim].erase_count))
+            {
+              victim = s;
+              victim_live = live;
+            }
+        }
+
+      if (victim == segments_ || reserve == segments_
+          || victim_live >= segment_blocks_)
+        {
+          errno = ENOSPC;
+          return -1;
+        }
+
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_log_impl::%s() seg %u, %u live @%p\n",
+                     __func__, victim, victim_live, this);
+#endif
+
+      if (open_segment_ (reserve) < 0)
+        {
+          return -1;
+        }
+
+      const blknum_t first = victim * segment_blocks_;
+      for (std::size_t i = 0; i < segment_blocks_; ++i)
+        {
+          const blknum_t b = first + i;
+          const block_entry_t e = map_[b];
+          if (e.state != live && e.state != pending)
+            {
+              continue;
+            }
+
+          if (e.index == record_index && !nodes_[e.inode].used)
+            {
+              // A removed file; the tombstone is needed only while
+              // older blocks of the file exist.
+              bool needed = false;
+              for (blknum_t k = 0; k < blocks_ && !needed; ++k)
+                {
+                  needed = (k / segment_blocks_ != victim)
+                      && map_[k].inode == e.inode && map_[k].state != unused;
+                }
+              if (!needed)
+                {
+                  nodes_[e.inode].meta_block = no_block;
+                  continue;
+                }
+            }
+
+          if (device_.read_block (buf_, b, 1) != 1)
+            {
+              return -1;
+            }
+
+          header_t hdr;
+          std::memcpy (&hdr, buf_, sizeof(hdr));
+          hdr.wear = segs_[head_seg_].erase_count;
+          hdr.crc = 0;
+          uint32_t c = crc32 (0, &hdr, sizeof(hdr));
+          hdr.crc = crc32 (c, buf_ + sizeof(hdr), hdr.length);
+          std::memcpy (buf_, &hdr, sizeof(hdr));
+
+          const blknum_t dst = head_seg_ * segment_blocks_ + head_pos_++;
+          if (device_.write_block (buf_, dst, 1) != 1)
+            {
+              return -1;
+            }
+
+          map_[dst] = e;
+          if (e.index == record_index)
+            {
+              nodes_[e.inode].meta_block = dst;
+            }
+        }
+
+      return erase_segment_ (victim);
+    }
+
+    int
+    file_system_log_impl::allocate_block_ (blknum_t* blk)
+    {
+      if (!has_head_ || head_pos_ >= segment_blocks_)
+        {
+          has_head_ = false;
+
+          if (free_segments () > 1)
+            {
+              // The least worn free segment.
+              std::size_t seg = segments_;
+              for (std::size_t s = 0; s < segments_; ++s)
+                {
+                  if (!segs_[s].written
+                      && (seg == segments_
+                          || segs_[s].erase_count < segs_[seg].erase_count))
+                    {
+                      seg = s;
+                    }
+                }
+              if (open_segment_ (seg) < 0)
+                {
+                  return -1;
+                }
+            }
+          else if (collect_ () < 0)
+            {
+              return -1;
+            }
+
+          if (head_pos_ >= segment_blocks_)
+            {
+              errno = ENOSPC;
+              return -1;
+            }
+        }
+
+      *blk = head_seg_ * segment_blocks_ + head_pos_++;
+      return 0;
+    }
+
+    int
+    file_system_log_impl::program_ (blknum_t blk, inum_t ino, uint32_t index,
+                                    uint32_t seq, const void* payload,
+                                    std::size_t length)
+    {
+      header_t hdr;
+      hdr.magic = block_magic;
+      hdr.seq = seq;
+      hdr.index = index;
+      hdr.wear = segs_[blk / segment_blocks_].erase_count;
+      hdr.inode = ino;
+      hdr.segment_blocks = static_cast<uint16_t> (segment_blocks_);
+      hdr.length = static_cast<uint16_t> (length);
+      hdr.reserved = 0;
+      hdr.crc = 0;
+
+      uint32_t c = crc32 (0, &hdr, sizeof(hdr));
+      hdr.crc = crc32 (c, payload, length);
+
+      std::memcpy (buf_, &hdr, sizeof(hdr));
+      std::memcpy (buf_ + sizeof(hdr), payload, length);
+      std::memset (buf_ + sizeof(hdr) + length, 0,
+                   block_size_ - sizeof(hdr) - length);
+
+      if (device_.write_block (buf_, blk, 1) != 1)
+        {
+          if (errno == 0)
+            {
+              errno = EIO;
+            }
+          return -1;
+        }
+      return 0;
+    }
+
+    int
+    file_system_log_impl::write_data_ (inum_t ino, uint32_t index,
+                                       const void* payload)
+    {
+      blknum_t blk;
+      if (allocate_block_ (&blk) < 0)
+        {
+          return -1;
+        }
+
+      uint32_t seq = seq_++;
+      if (program_ (blk, ino, index, seq, payload, payload_ ()) < 0)
+        {
+          map_[blk].state = dead;
+          return -1;
+        }
+
+      // A previous uncommitted version is no longer needed; the
+      // committed one is kept until the next commit.
+      for (blknum_t k = 0; k < blocks_; ++k)
+        {
+          block_entry_t& o = map_[k];
+          if (o.state == pending && o.inode == ino && o.index == index)
+            {
+              o.state = dead;
+            }
+        }
+
+      map_[blk] = block_entry_t
+        { seq, index, ino, pending };
+
+      return 0;
+    }
+
+    int
+    file_system_log_impl::write_record_ (inum_t ino, const record_t& rec)
+    {
+      blknum_t blk;
+      if (allocate_block_ (&blk) < 0)
+        {
+          return -1;
+        }
+
+      uint32_t seq = seq_++;
+      if (program_ (blk, ino, record_index, seq, &rec, sizeof(rec)) < 0)
+        {
+          map_[blk].state = dead;
+          return -1;
+        }
+
+      // Read after the write, the space reclaiming might have
+      // moved the previous record.
+      node_t& nd = nodes_[ino];
+      if (nd.meta_block != no_block)
+        {
+          map_[nd.meta_block].state = dead;
+        }
+
+      map_[blk] = block_entry_t
+        { seq, record_index, ino, live };
+      nd.meta_block = blk;
+      nd.commit_seq = seq;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * The data blocks written since the previous commit become
+     * valid with the new record, and the blocks they replace, or
+     * beyond the end of the file, are released.
+     */
+    int
+    file_system_log_impl::commit_ (inum_t ino)
+    {
+      node_t& nd = nodes_[ino];
+
+      if (flush_cache_ (ino) < 0)
+        {
+          return -1;
+        }
+
+      if (nd.dirty)
+        {
+          nd.rec.mtime = now ();
+        }
+
+      if (write_record_ (ino, nd.rec) < 0)
+        {
+          return -1;
+        }
+      nd.dirty = false;
+
+      const std::size_t pl = payload_ ();
+      const std::size_t nblocks = (nd.rec.size + pl - 1) / pl;
+      for (blknum_t b = 0; b < blocks_; ++b)
+        {
+          block_entry_t& e = map_[b];
+          if (e.inode != ino || e.index == record_index || e.state != pending)
+            {
+              continue;
+            }
+          for (blknum_t k = 0; k < blocks_; ++k)
+            {
+              block_entry_t& o = map_[k];
+              if (o.state == live && o.inode == ino && o.index == e.index)
+                {
+                  o.state = dead;
+                }
+            }
+          e.state = live;
+        }
+
+      for (blknum_t b = 0; b < blocks_; ++b)
+        {
+          block_entry_t& e = map_[b];
+          if (e.inode == ino && e.index != record_index && e.state == live
+              && e.index >= nblocks)
+            {
+              e.state = dead;
+            }
+        }
+
+      return 0;
+    }
+
+    file_system_log_impl::blknum_t
+    file_system_log_impl::find_block_ (inum_t ino, uint32_t index) const
+    {
+      blknum_t found = no_block;
+      for (blknum_t b = 0; b < blocks_; ++b)
+        {
+          const block_entry_t& e = map_[b];
+          if (e.inode == ino && e.index == index)
+            {
+              if (e.state == pending)
+                {
+                  return b;
+                }
+              if (e.state == live)
+                {
+                  found = b;
+                }
+            }
+        }
+      return found;
+    }
+
+    int
+    file_system_log_impl::flush_cache_ (inum_t ino)
+    {
+      node_t& nd = nodes_[ino];
+      if (!nd.cache_valid || !nd.cache_dirty)
+        {
+          return 0;
+        }
+
+      if (write_data_ (ino, nd.cache_index, nd.cache) < 0)
+        {
+          return -1;
+        }
+      nd.cache_dirty = false;
+
+      return 0;
+    }
+
+    int
+    file_system_log_impl::load_cache_ (inum_t ino, uint32_t index)
+    {
+      node_t& nd = nodes_[ino];
+      if (nd.cache_valid && nd.cache_index == index)
+        {
+          return 0;
+        }
+
+      if (flush_cache_ (ino) < 0)
+        {
+          return -1;
+        }
+      nd.cache_valid = false;
+
+      blknum_t blk = find_block_ (ino, index);
+      if (blk == no_block)
+        {
+          std::memset (nd.cache, 0, payload_ ());
+        }
+      else
+        {
+          if (device_.read_block (buf_, blk, 1) != 1)
+            {
+              return -1;
+            }
+          std::memcpy (nd.cache, buf_ + sizeof(header_t), payload_ ());
+        }
+
+      nd.cache_index = index;
+      nd.cache_valid = true;
+      nd.cache_dirty = false;
+
+      return 0;
+    }
+
+    ssize_t
+    file_system_log_impl::read_ (inum_t ino, std::size_t offset, void* buf,
+                                 std::size_t nbyte)
+    {
+      const node_t& nd = nodes_[ino];
+      if (offset >= nd.rec.size)
+        {
+          return 0;
+        }
+      if (nbyte > nd.rec.size - offset)
+        {
+          nbyte = nd.rec.size - offset;
+        }
+
+      const std::size_t pl = payload_ ();
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t done = 0;
+      while (done < nbyte)
+        {
+          uint32_t index = static_cast<uint32_t> ((offset + done) / pl);
+          std::size_t in = (offset + done) % pl;
+          std::size_t n = std::min (pl - in, nbyte - done);
+
+          if (nd.cache_valid && nd.cache_index == index)
+            {
+              std::memcpy (p + done, nd.cache + in, n);
+            }
+          else
+            {
+              blknum_t blk = find_block_ (ino, index);
+              if (blk == no_block)
+                {
+                  // A hole.
+                  std::memset (p + done, 0, n);
+                }
+              else
+                {
+                  if (device_.read_block (buf_, blk, 1) != 1)
+                    {
+                      return (done > 0) ? static_cast<ssize_t> (done) : -1;
+                    }
+                  std::memcpy (p + done, buf_ + sizeof(header_t) + in, n);
+                }
+            }
+          done += n;
+        }
+
+      return static_cast<ssize_t> (done);
+    }
+
+    /**
+     * @details
+     * The partial blocks go to the file cache, which is written
+     * to the device when another block is written, or at commit;
+     * consecutive small writes, like logs, program each block once.
+     */
+    ssize_t
+    file_system_log_impl::write_ (inum_t ino, std::size_t offset,
+                                  const void* buf, std::size_t nbyte)
+    {
+      node_t& nd = nodes_[ino];
+      if (offset + nbyte > 0xFFFFFFFF)
+        {
+          errno = EFBIG;
+          return -1;
+        }
+
+      if (offset > nd.rec.size && resize_ (ino, offset) < 0)
+        {
+          return -1;
+        }
+
+      const std::size_t pl = payload_ ();
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+      std::size_t done = 0;
+      int ret = 0;
+      while (done < nbyte)
+        {
+          uint32_t index = static_cast<uint32_t> ((offset + done) / pl);
+          std::size_t in = (offset + done) % pl;
+          std::size_t n = std::min (pl - in, nbyte - done);
+
+          if (n == pl)
+            {
+              // An entire block, written directly.
+              if (nd.cache_valid && nd.cache_index == index)
+                {
+                  nd.cache_valid = false;
+                  nd.cache_dirty = false;
+                }
+              ret = write_data_ (ino, index, p + done);
+            }
+          else
+            {
+              ret = load_cache_ (ino, index);
+              if (ret == 0)
+                {
+                  std::memcpy (nd.cache + in, p + done, n);
+                  nd.cache_dirty = true;
+                }
+            }
+          if (ret < 0)
+            {
+              break;
+            }
+
+          done += n;
+          if (offset + done > nd.rec.size)
+            {
+              nd.rec.size = static_cast<uint32_t> (offset + done);
+            }
+          nd.dirty = true;
+        }
+
+      if (ret < 0 && done == 0)
+        {
+          return -1;
+        }
+      return static_cast<ssize_t> (done);
+    }
+
+    /**
+     * @details
+     * The bytes after the end of the file in its last block are
+     * always 0, so extending the file only needs to replace the
+     * removed blocks still on the device, which would otherwise be
+     * found again at mount.
+     */
+    int
+    file_system_log_impl::resize_ (inum_t ino, std::size_t size)
+    {
+      node_t& nd = nodes_[ino];
+      if (size > 0xFFFFFFFF)
+        {
+          errno = EFBIG;
+          return -1;
+        }
+
+      const std::size_t pl = payload_ ();
+      const std::size_t old = nd.rec.size;
+      if (size < old)
+        {
+          uint32_t nblocks = static_cast<uint32_t> ((size + pl - 1) / pl);
+          if (nd.cache_valid && nd.cache_index >= nblocks)
+            {
+              nd.cache_valid = false;
+              nd.cache_dirty = false;
+            }
+          if ((size % pl) != 0)
+            {
+              uint32_t tail = static_cast<uint32_t> (size / pl);
+              if (load_cache_ (ino, tail) < 0)
+                {
+                  return -1;
+                }
+              std::memset (nd.cache + (size % pl), 0, pl - (size % pl));
+              nd.cache_dirty = true;
+            }
+        }
+      else if (size > old)
+        {
+          if (zero_fill_ (ino, static_cast<uint32_t> ((old + pl - 1) / pl),
+                          static_cast<uint32_t> ((size + pl - 1) / pl)) < 0)
+            {
+              return -1;
+            }
+        }
+
+      nd.rec.size = static_cast<uint32_t> (size);
+      nd.dirty = true;
+
+      return 0;
+    }
+
+    int
+    file_system_log_impl::zero_fill_ (inum_t ino, uint32_t from, uint32_t to)
+    {
+      const node_t& nd = nodes_[ino];
+      for (uint32_t index = from; index < to; ++index)
+        {
+          bool stale = false;
+          for (blknum_t b = 0; b < blocks_ && !stale; ++b)
+            {
+              const block_entry_t& e = map_[b];
+              stale = (e.state == dead && e.inode == ino && e.index == index
+                  && e.seq > nd.rec.birth);
+            }
+          if (stale && load_cache_ (ino, index) < 0)
+            {
+              return -1;
+            }
+          if (stale)
+            {
+              // The cache is already 0; written when flushed.
+              nodes_[ino].cache_dirty = true;
+            }
+        }
+      return 0;
+    }
+
+    /**
+     * @details
+     * The path is relative to the file system, with or without
+     * the leading slash. If the last name is not found, `ino` is
+     * `no_inode` and `parent` and `leaf` can be used to create it.
+     */
+    int
+    file_system_log_impl::lookup_ (const char* path, inum_t* ino,
+                                   inum_t* parent, const char** leaf)
+    {
+      if (path == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      const char* p = path;
+      while (*p == '/')
+        {
+          ++p;
+        }
+
+      inum_t cur = 0;
+      *parent = no_inode;
+      *leaf = nullptr;
+
+      if (*p == '\0')
+        {
+          *ino = 0;
+          return 0;
+        }
+
+      for (;;)
+        {
+          std::size_t len = std::strcspn (p, "/");
+          if (len >= name_size)
+            {
+              errno = ENAMETOOLONG;
+              return -1;
+            }
+
+          const char* rest = p + len;
+          while (*rest == '/')
+            {
+              ++rest;
+            }
+
+          inum_t child = find_child_ (cur, p, len);
+          if (*rest == '\0')
+            {
+              *ino = child;
+              *parent = cur;
+              *leaf = p;
+              return 0;
+            }
+
+          if (child == no_inode)
+            {
+              errno = ENOENT;
+              return -1;
+            }
+          if ((nodes_[child].rec.mode & S_IFMT) != S_IFDIR)
+            {
+              errno = ENOTDIR;
+              return -1;
+            }
+
+          cur = child;
+          p = rest;
+        }
+    }
+
+    file_system_log_impl::inum_t
+    file_system_log_impl::find_child_ (inum_t parent, const char* name,
+                                       std::size_t len) const
+    {
+      for (std::size_t i = 1; i < inodes; ++i)
+        {
+          const node_t& nd = nodes_[i];
+          if (nd.used && nd.rec.parent == parent
+              && std::strncmp (nd.rec.name, name, len) == 0
+              && nd.rec.name[len] == '\0')
+            {
+              return static_cast<inum_t> (i);
+            }
+        }
+      return no_inode;
+    }
+
+    int
+    file_system_log_impl::create_ (inum_t parent, const char* name,
+                                   mode_t mode, inum_t* ino)
+    {
+      std::size_t i = 1;
+      while (i < inodes && nodes_[i].used)
+        {
+          ++i;
+        }
+      if (i >= inodes)
+        {
+          errno = ENOSPC;
+          return -1;
+        }
+
+      node_t& nd = nodes_[i];
+      std::size_t len = std::strcspn (name, "/");
+
+      nd.rec = record_t
+        { };
+      // The sequence of the record written below.
+      nd.rec.birth = seq_;
+      nd.rec.mode = mode;
+      nd.rec.mtime = now ();
+      nd.rec.parent = parent;
+      std::memcpy (nd.rec.name, name, len);
+
+      nd.used = true;
+      nd.dirty = false;
+      if (write_record_ (static_cast<inum_t> (i), nd.rec) < 0)
+        {
+          nd.used = false;
+          return -1;
+        }
+
+      *ino = static_cast<inum_t> (i);
+      return 0;
+    }
+
+    /**
+     * @details
+     * A record marked deleted is written, to hide the previous
+     * ones still on the device.
+     */
+    int
+    file_system_log_impl::remove_ (inum_t ino)
+    {
+      node_t& nd = nodes_[ino];
+      if (nd.open_count > 0)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      record_t rec = nd.rec;
+      rec.flags |= flag_deleted;
+      if (write_record_ (ino, rec) < 0)
+        {
+          return -1;
+        }
+
+      nd.rec = rec;
+      nd.used = false;
+      nd.dirty = false;
+
+      for (blknum_t b = 0; b < blocks_; ++b)
+        {
+          block_entry_t& e = map_[b];
+          if (e.inode == ino && e.index != record_index
+              && (e.state == live || e.state == pending))
+            {
+              e.state = dead;
+            }
+        }
+
+      return 0;
+    }
+
+    void
+    file_system_log_impl::fill_stat_ (inum_t ino, struct stat* buf) const
+    {
+      const record_t& rec = nodes_[ino].rec;
+
+      std::memset (buf, 0, sizeof(*buf));
+      buf->st_ino = ino;
+      buf->st_mode = static_cast<mode_t> (rec.mode);
+      buf->st_nlink = 1;
+      buf->st_size = static_cast<off_t> (rec.size);
+      buf->st_mtime = static_cast<time_t> (rec.mtime);
+      buf->st_ctime = buf->st_mtime;
+      buf->st_atime = buf->st_mtime;
+    }
+
+    int
+    file_system_log_impl::open_inode_ (inum_t ino)
+    {
+      node_t& nd = nodes_[ino];
+      if (nd.open_count == 0)
+        {
+          nd.cache = static_cast<uint8_t*> (resource_->allocate (
+              payload_ (), rtos::memory::memory_resource::max_align));
+          if (nd.cache == nullptr)
+            {
+              errno = ENOMEM;
+              return -1;
+            }
+          nd.cache_valid = false;
+          nd.cache_dirty = false;
+        }
+      ++nd.open_count;
+
+      return 0;
+    }
+
+    void
+    file_system_log_impl::close_inode_ (inum_t ino)
+    {
+      node_t& nd = nodes_[ino];
+      if (nd.open_count == 0 || --nd.open_count > 0)
+        {
+          return;
+        }
+
+      resource_->deallocate (nd.cache, payload_ (),
+                             rtos::memory::memory_resource::max_align);
+      nd.cache = nullptr;
+      nd.cache_valid = false;
+      nd.cache_dirty = false;
+    }
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    file_log_impl::file_log_impl (class file_system& fs) :
+        file_impl
+          { fs }
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf (trace::posix_io_file, "file_log_impl::%s()=%p\n",
+                     __func__, this);
+#endif
+    }
+
+    file_log_impl::~file_log_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf (trace::posix_io_file, "file_log_impl::%s() @%p\n",
+                     __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    bool
+    file_log_impl::do_is_opened (void)
+    {
+      return inode_ != file_system_log_impl::no_inode;
+    }
+
+    ssize_t
+    file_log_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+      if (!fs.mounted_ || (status_flags_ & O_ACCMODE) == O_WRONLY)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      return fs.read_ (inode_, static_cast<std::size_t> (offset_), buf, nbyte);
+    }
+
+    ssize_t
+    file_log_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+      if (!fs.mounted_ || (status_flags_ & O_ACCMODE) == O_RDONLY)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      if ((status_flags_ & O_APPEND) != 0)
+        {
+          offset_ = static_cast<off_t> (fs.nodes_[inode_].rec.size);
+        }
+
+      return fs.write_ (inode_, static_cast<std::size_t> (offset_), buf,
+                        nbyte);
+    }
+
+    off_t
+    file_log_impl::do_lseek (off_t offset, int whence)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+
+      off_t pos;
+      switch (whence)
+        {
+        case SEEK_SET:
+          pos = offset;
+          break;
+
+        case SEEK_CUR:
+          pos = offset_ + offset;
+          break;
+
+        case SEEK_END:
+          pos = static_cast<off_t> (fs.nodes_[inode_].rec.size) + offset;
+          break;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (pos < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      offset_ = pos;
+      return pos;
+    }
+
+    int
+    file_log_impl::do_fstat (struct stat* buf)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+      if (!fs.mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      fs.fill_stat_ (inode_, buf);
+      return 0;
+    }
+
+    int
+    file_log_impl::do_close (void)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+
+      int ret = 0;
+      if (fs.mounted_)
+        {
+          file_system_log_impl::node_t& nd = fs.nodes_[inode_];
+          if (nd.dirty || nd.cache_dirty)
+            {
+              ret = fs.commit_ (inode_);
+            }
+          int err = errno;
+          fs.close_inode_ (inode_);
+          errno = err;
+        }
+
+      inode_ = file_system_log_impl::no_inode;
+
+      return ret;
+    }
+
+    int
+    file_log_impl::do_ftruncate (off_t length)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+      if (!fs.mounted_ || (status_flags_ & O_ACCMODE) == O_RDONLY)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (fs.resize_ (inode_, static_cast<std::size_t> (length)) < 0)
+        {
+          return -1;
+        }
+
+      return fs.commit_ (inode_);
+    }
+
+    int
+    file_log_impl::do_fsync (void)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+      if (!fs.mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      file_system_log_impl::node_t& nd = fs.nodes_[inode_];
+      if (!nd.dirty && !nd.cache_dirty)
+        {
+          return 0;
+        }
+
+      return fs.commit_ (inode_);
+    }
+
+    file_system_log_impl&
+    file_log_impl::fs_impl_ (void)
+    {
+      return static_cast<file_system_log_impl&> (file_system_.impl ());
+    }
+
+    // ========================================================================
+
+    directory_log_impl::directory_log_impl (class file_system& fs) :
+        directory_impl
+          { fs }
+    {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+      trace::printf (trace::posix_io_directory,
+                     "directory_log_impl::%s()=%p\n", __func__, this);
+#endif
+    }
+
+    directory_log_impl::~directory_log_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+      trace::printf (trace::posix_io_directory,
+                     "directory_log_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    struct dirent*
+    directory_log_impl::do_read (void)
+    {
+      file_system_log_impl& fs = fs_impl_ ();
+      if (!fs.mounted_)
+        {
+          errno = EBADF;
+          return nullptr;
+        }
+
+      while (pos_ < file_system_log_impl::inodes)
+        {
+          std::size_t i = pos_++;
+          const file_system_log_impl::node_t& nd = fs.nodes_[i];
+          if (i != 0 && nd.used && nd.rec.parent == inode_)
+            {
+              dir_entry_.d_ino = static_cast<ino_t> (i);
+              std::strncpy (dir_entry_.d_name, nd.rec.name,
+                            sizeof(dir_entry_.d_name) - 1);
+              dir_entry_.d_name[sizeof(dir_entry_.d_name) - 1] = '\0';
+              return &dir_entry_;
+            }
+        }
+
+      return nullptr;
+    }
+
+    void
+    directory_log_impl::do_rewind (void)
+    {
+      pos_ = 0;
+    }
+
+    int
+    directory_log_impl::do_close (void)
+    {
+      inode_ = file_system_log_impl::no_inode;
+      return 0;
+    }
+
+    file_system_log_impl&
+    directory_log_impl::fs_impl_ (void) const
+    {
+      return static_cast<file_system_log_impl&> (file_system_.impl ());
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
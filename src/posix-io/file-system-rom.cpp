@@ -0,0 +1,933 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/file-system-rom.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // "ROM1", as written by scripts/romfs-build.py.
+      constexpr uint32_t image_magic = 0x314D4F52;
+      constexpr uint32_t image_version = 1;
+
+      // The same as zlib.crc32(), used by the host tool.
+      uint32_t
+      crc32 (uint32_t crc, const void* buf, std::size_t nbyte)
+      {
+        const uint8_t* p = static_cast<const uint8_t*> (buf);
+        crc = ~crc;
+        while (nbyte-- > 0)
+          {
+            crc ^= *p++;
+            for (int k = 0; k < 8; ++k)
+              {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+              }
+          }
+        return ~crc;
+      }
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    file_system_rom_impl::file_system_rom_impl (
+        block_device& device, rtos::memory::memory_resource* resource) :
+        file_system_impl
+          { device }, //
+        resource_ (resource)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_rom_impl::%s()=%p\n", __func__, this);
+#endif
+    }
+
+    file_system_rom_impl::~file_system_rom_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_rom_impl::%s() @%p\n", __func__, this);
+#endif
+
+      if (buf_ != nullptr)
+        {
+          resource_->deallocate (buf_, block_size_,
+                                 rtos::memory::memory_resource::max_align);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    file_system_rom_impl::do_vmkfs (int options __attribute__((unused)),
+                                    std::va_list args __attribute__((unused)))
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    /**
+     * @details
+     * The header and the CRC of the index are checked; the file
+     * content is not.
+     */
+    int
+    file_system_rom_impl::do_vmount (unsigned int flags __attribute__((unused)),
+                                     std::va_list args __attribute__((unused)))
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_rom_impl::%s(%u) @%p\n", __func__, flags,
+                     this);
+#endif
+
+      if (mounted_)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      block_size_ = device_.block_logical_size_bytes ();
+      if (block_size_ < sizeof(header_t))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      const void* m = device_.map (0, 1);
+      if (m != nullptr)
+        {
+          std::memcpy (&header_, m, sizeof(header_));
+        }
+      else
+        {
+          if (resource_ == nullptr)
+            {
+              resource_ = rtos::memory::get_default_resource ();
+            }
+          buf_ = static_cast<uint8_t*> (resource_->allocate (
+              block_size_, rtos::memory::memory_resource::max_align));
+          if (buf_ == nullptr)
+            {
+              errno = ENOMEM;
+              return -1;
+            }
+          if (device_.read_block (buf_, 0, 1) != 1)
+            {
+              do_umount (0);
+              errno = EIO;
+              return -1;
+            }
+          std::memcpy (&header_, buf_, sizeof(header_));
+        }
+
+      const std::size_t capacity = device_.blocks () * block_size_;
+      if (header_.magic != image_magic || header_.version != image_version
+          || header_.image_size > capacity || header_.entries == 0
+          || header_.index_size > header_.image_size - sizeof(header_t)
+          || header_.entries > header_.index_size / sizeof(entry_t))
+        {
+          do_umount (0);
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (m != nullptr)
+        {
+          base_ = static_cast<const uint8_t*> (device_.map (
+              0, (header_.image_size + block_size_ - 1) / block_size_));
+          if (base_ == nullptr)
+            {
+              do_umount (0);
+              return -1;
+            }
+        }
+
+      // The header is checked, the reads are now bounded by the image.
+      mounted_ = true;
+
+      uint32_t crc = 0;
+      uint8_t chunk[64];
+      for (uint32_t done = 0; done < header_.index_size;)
+        {
+          std::size_t n = std::min (sizeof(chunk),
+                                    std::size_t (header_.index_size - done));
+          if (fetch_ (static_cast<uint32_t> (sizeof(header_t) + done), chunk,
+                      n) < 0)
+            {
+              do_umount (0);
+              return -1;
+            }
+          crc = crc32 (crc, chunk, n);
+          done += static_cast<uint32_t> (n);
+        }
+
+      entry_t root;
+      if (crc != header_.index_crc || entry_ (0, &root) < 0
+          || (root.mode & S_IFMT) != S_IFDIR)
+        {
+          do_umount (0);
+          errno = EIO;
+          return -1;
+        }
+
+      return 0;
+    }
+
+    int
+    file_system_rom_impl::do_umount (unsigned int flags __attribute__((unused)))
+    {
+      if (buf_ != nullptr)
+        {
+          resource_->deallocate (buf_, block_size_,
+                                 rtos::memory::memory_resource::max_align);
+          buf_ = nullptr;
+        }
+      base_ = nullptr;
+      mounted_ = false;
+
+      return 0;
+    }
+
+    file*
+    file_system_rom_impl::do_vopen (class file_system& fs, const char* path,
+                                    int oflag,
+                                    std::va_list args __attribute__((unused)))
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return nullptr;
+        }
+
+      if ((oflag & O_ACCMODE) != O_RDONLY || (oflag & O_TRUNC) != 0)
+        {
+          errno = EROFS;
+          return nullptr;
+        }
+
+      uint32_t index;
+      entry_t e;
+      if (lookup_ (path, &index, &e) < 0)
+        {
+          if (errno == ENOENT && (oflag & O_CREAT) != 0)
+            {
+              errno = EROFS;
+            }
+          return nullptr;
+        }
+
+      if ((oflag & (O_CREAT | O_EXCL)) == (O_CREAT | O_EXCL))
+        {
+          errno = EEXIST;
+          return nullptr;
+        }
+
+      if ((e.mode & S_IFMT) == S_IFDIR)
+        {
+          errno = EISDIR;
+          return nullptr;
+        }
+
+      file_rom* fil = fs.allocate_file<file_rom> ();
+      if (fil == nullptr)
+        {
+          errno = ENOMEM;
+          return nullptr;
+        }
+
+      file_rom_impl& im = fil->impl ();
+      im.index_ = index;
+      im.data_ = e.offset;
+      im.size_ = e.size;
+      im.mtime_ = e.mtime;
+      im.offset_ = 0;
+      im.status_flags_ = O_RDONLY | (oflag & O_NONBLOCK);
+
+      return fil;
+    }
+
+    directory*
+    file_system_rom_impl::do_opendir (class file_system& fs,
+                                      const char* dirname)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return nullptr;
+        }
+
+      uint32_t index;
+      entry_t e;
+      if (lookup_ (dirname, &index, &e) < 0)
+        {
+          return nullptr;
+        }
+
+      if ((e.mode & S_IFMT) != S_IFDIR)
+        {
+          errno = ENOTDIR;
+          return nullptr;
+        }
+
+      directory_rom* dir = fs.allocate_directory<directory_rom> ();
+      if (dir == nullptr)
+        {
+          errno = ENOMEM;
+          return nullptr;
+        }
+
+      dir->impl ().first_ = e.offset;
+      dir->impl ().count_ = e.size;
+      dir->impl ().pos_ = 0;
+
+      return dir;
+    }
+
+    int
+    file_system_rom_impl::do_mkdir (const char* path __attribute__((unused)),
+                                    mode_t mode __attribute__((unused)))
+    {
+      errno = EROFS;
+      return -1;
+    }
+
+    int
+    file_system_rom_impl::do_rmdir (const char* path __attribute__((unused)))
+    {
+      errno = EROFS;
+      return -1;
+    }
+
+    void
+    file_system_rom_impl::do_sync (void)
+    {
+      // Nothing to write.
+    }
+
+    int
+    file_system_rom_impl::do_chmod (const char* path __attribute__((unused)),
+                                    mode_t mode __attribute__((unused)))
+    {
+      errno = EROFS;
+      return -1;
+    }
+
+    int
+    file_system_rom_impl::do_stat (const char* path, struct stat* buf)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      uint32_t index;
+      entry_t e;
+      if (lookup_ (path, &index, &e) < 0)
+        {
+          return -1;
+        }
+
+      fill_stat_ (index, e, buf);
+      return 0;
+    }
+
+    int
+    file_system_rom_impl::do_truncate (
+        const char* path __attribute__((unused)),
+        off_t length __attribute__((unused)))
+    {
+      errno = EROFS;
+      return -1;
+    }
+
+    int
+    file_system_rom_impl::do_rename (
+        const char* existing __attribute__((unused)),
+        const char* _new __attribute__((unused)))
+    {
+      errno = EROFS;
+      return -1;
+    }
+
+    int
+    file_system_rom_impl::do_unlink (const char* path __attribute__((unused)))
+    {
+      errno = EROFS;
+      return -1;
+    }
+
+    int
+    file_system_rom_impl::do_utime (
+        const char* path __attribute__((unused)),
+        const struct utimbuf* times __attribute__((unused)))
+    {
+      errno = EROFS;
+      return -1;
+    }
+
+    int
+    file_system_rom_impl::do_statvfs (struct statvfs* buf)
+    {
+      if (!mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      std::memset (buf, 0, sizeof(*buf));
+      buf->f_bsize = block_size_;
+      buf->f_frsize = block_size_;
+      buf->f_blocks = (header_.image_size + block_size_ - 1) / block_size_;
+      buf->f_files = header_.entries;
+      buf->f_flag = ST_RDONLY;
+      buf->f_namemax = sizeof(dirent::d_name) - 1;
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    int
+    file_system_rom_impl::fetch_ (uint32_t offset, void* buf,
+                                  std::size_t nbyte)
+    {
+      if (offset > header_.image_size || nbyte > header_.image_size - offset)
+        {
+          errno = EIO; // Damaged image.
+          return -1;
+        }
+
+      if (base_ != nullptr)
+        {
+          std::memcpy (buf, base_ + offset, nbyte);
+          return 0;
+        }
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      while (nbyte > 0)
+        {
+          block_device::blknum_t blk = offset / block_size_;
+          std::size_t in = offset % block_size_;
+          std::size_t n = std::min (block_size_ - in, nbyte);
+          if (device_.read_block (buf_, blk, 1) != 1)
+            {
+              return -1;
+            }
+          std::memcpy (p, buf_ + in, n);
+          p += n;
+          offset += static_cast<uint32_t> (n);
+          nbyte -= n;
+        }
+      return 0;
+    }
+
+    int
+    file_system_rom_impl::entry_ (uint32_t index, entry_t* e)
+    {
+      if (index >= header_.entries)
+        {
+          errno = EIO; // Damaged image.
+          return -1;
+        }
+      return fetch_ (
+          static_cast<uint32_t> (sizeof(header_t) + index * sizeof(entry_t)),
+          e, sizeof(entry_t));
+    }
+
+    /**
+     * @details
+     * The stored name, NUL terminated, is compared with the first
+     * `len` characters of `name`, as `strcmp()`.
+     */
+    int
+    file_system_rom_impl::compare_ (const entry_t& e, const char* name,
+                                    std::size_t len, int* result)
+    {
+      if (base_ != nullptr)
+        {
+          if (e.name >= header_.image_size)
+            {
+              errno = EIO; // Damaged image.
+              return -1;
+            }
+          const char* s = reinterpret_cast<const char*> (base_ + e.name);
+          std::size_t max = header_.image_size - e.name;
+          int r = std::strncmp (s, name, std::min (len, max));
+          if (r == 0 && len < max)
+            {
+              r = static_cast<unsigned char> (s[len]);
+            }
+          *result = r;
+          return 0;
+        }
+
+      char chunk[32];
+      for (std::size_t pos = 0; pos <= len;)
+        {
+          std::size_t n = std::min (sizeof(chunk), len + 1 - pos);
+          if (e.name + pos + n > header_.image_size)
+            {
+              n = header_.image_size - (e.name + pos);
+            }
+          if (n == 0 || fetch_ (static_cast<uint32_t> (e.name + pos), chunk, n)
+              < 0)
+            {
+              errno = EIO; // Damaged image.
+              return -1;
+            }
+          for (std::size_t i = 0; i < n; ++i, ++pos)
+            {
+              unsigned char c = static_cast<unsigned char> (chunk[i]);
+              unsigned char x =
+                  (pos < len) ? static_cast<unsigned char> (name[pos]) : 0;
+              if (c != x || c == 0)
+                {
+                  *result = c - x;
+                  return 0;
+                }
+            }
+        }
+      *result = 0;
+      return 0;
+    }
+
+    /**
+     * @details
+     * A binary search for each name in the path, in the sorted
+     * children of the folder.
+     */
+    int
+    file_system_rom_impl::lookup_ (const char* path, uint32_t* index,
+                                   entry_t* e)
+    {
+      if (path == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      uint32_t cur = 0;
+      if (entry_ (cur, e) < 0)
+        {
+          return -1;
+        }
+
+      const char* p = path;
+      for (;;)
+        {
+          while (*p == '/')
+            {
+              ++p;
+            }
+          if (*p == '\0')
+            {
+              break;
+            }
+
+          if ((e->mode & S_IFMT) != S_IFDIR)
+            {
+              errno = ENOTDIR;
+              return -1;
+            }
+
+          std::size_t len = std::strcspn (p, "/");
+          uint32_t lo = e->offset;
+          uint32_t hi = e->offset + e->size;
+          bool found = false;
+          while (lo < hi)
+            {
+              uint32_t mid = lo + (hi - lo) / 2;
+              entry_t m;
+              int r;
+              if (entry_ (mid, &m) < 0 || compare_ (m, p, len, &r) < 0)
+                {
+                  return -1;
+                }
+              if (r == 0)
+                {
+                  cur = mid;
+                  *e = m;
+                  found = true;
+                  break;
+                }
+              if (r < 0)
+                {
+                  lo = mid + 1;
+                }
+              else
+                {
+                  hi = mid;
+                }
+            }
+
+          if (!found)
+            {
+              errno = ENOENT;
+              return -1;
+            }
+          p += len;
+        }
+
+      *index = cur;
+      return 0;
+    }
+
+    void
+    file_system_rom_impl::fill_stat_ (uint32_t index, const entry_t& e,
+                                      struct stat* buf) const
+    {
+      std::memset (buf, 0, sizeof(*buf));
+      buf->st_ino = static_cast<ino_t> (index);
+      buf->st_mode = static_cast<mode_t> (e.mode);
+      buf->st_nlink = 1;
+      if ((e.mode & S_IFMT) != S_IFDIR)
+        {
+          buf->st_size = static_cast<off_t> (e.size);
+        }
+      buf->st_mtime = static_cast<time_t> (e.mtime);
+      buf->st_ctime = buf->st_mtime;
+      buf->st_atime = buf->st_mtime;
+    }
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    file_rom_impl::file_rom_impl (class file_system& fs) :
+        file_impl
+          { fs }
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf (trace::posix_io_file, "file_rom_impl::%s()=%p\n",
+                     __func__, this);
+#endif
+    }
+
+    file_rom_impl::~file_rom_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf (trace::posix_io_file, "file_rom_impl::%s() @%p\n",
+                     __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    bool
+    file_rom_impl::do_is_opened (void)
+    {
+      return index_ != file_system_rom_impl::no_entry;
+    }
+
+    ssize_t
+    file_rom_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      file_system_rom_impl& fs = fs_impl_ ();
+      if (!fs.mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      if (offset_ >= static_cast<off_t> (size_))
+        {
+          return 0;
+        }
+
+      std::size_t n = std::min (nbyte,
+                                static_cast<std::size_t> (size_ - offset_));
+      if (fs.fetch_ (data_ + static_cast<uint32_t> (offset_), buf, n) < 0)
+        {
+          return -1;
+        }
+
+      return static_cast<ssize_t> (n);
+    }
+
+    ssize_t
+    file_rom_impl::do_write (const void* buf __attribute__((unused)),
+                             std::size_t nbyte __attribute__((unused)))
+    {
+      errno = EBADF; // Opened for reading.
+      return -1;
+    }
+
+    off_t
+    file_rom_impl::do_lseek (off_t offset, int whence)
+    {
+      off_t pos;
+      switch (whence)
+        {
+        case SEEK_SET:
+          pos = offset;
+          break;
+
+        case SEEK_CUR:
+          pos = offset_ + offset;
+          break;
+
+        case SEEK_END:
+          pos = static_cast<off_t> (size_) + offset;
+          break;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (pos < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      offset_ = pos;
+      return pos;
+    }
+
+    int
+    file_rom_impl::do_fstat (struct stat* buf)
+    {
+      std::memset (buf, 0, sizeof(*buf));
+      buf->st_ino = static_cast<ino_t> (index_);
+      buf->st_mode = S_IFREG | 0444;
+      buf->st_nlink = 1;
+      buf->st_size = static_cast<off_t> (size_);
+      buf->st_mtime = static_cast<time_t> (mtime_);
+      buf->st_ctime = buf->st_mtime;
+      buf->st_atime = buf->st_mtime;
+
+      return 0;
+    }
+
+    int
+    file_rom_impl::do_close (void)
+    {
+      index_ = file_system_rom_impl::no_entry;
+      return 0;
+    }
+
+    int
+    file_rom_impl::do_ftruncate (off_t length __attribute__((unused)))
+    {
+      errno = EINVAL; // Opened for reading.
+      return -1;
+    }
+
+    int
+    file_rom_impl::do_fsync (void)
+    {
+      return 0;
+    }
+
+    /**
+     * @details
+     * The file is contiguous in the image, so any range can be
+     * mapped; fails with `ENODEV` if the device is not memory
+     * mapped.
+     */
+    const void*
+    file_rom_impl::do_map (off_t offset, std::size_t length)
+    {
+      file_system_rom_impl& fs = fs_impl_ ();
+      if (fs.base_ == nullptr)
+        {
+          errno = ENODEV;
+          return nullptr;
+        }
+
+      if (offset > static_cast<off_t> (size_)
+          || length > size_ - static_cast<std::size_t> (offset))
+        {
+          errno = EINVAL;
+          return nullptr;
+        }
+
+      return fs.base_ + data_ + offset;
+    }
+
+    file_system_rom_impl&
+    file_rom_impl::fs_impl_ (void)
+    {
+      return static_cast<file_system_rom_impl&> (file_system_.impl ());
+    }
+
+    // ========================================================================
+
+    directory_rom_impl::directory_rom_impl (class file_system& fs) :
+        directory_impl
+          { fs }
+    {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+      trace::printf (trace::posix_io_directory,
+                     "directory_rom_impl::%s()=%p\n", __func__, this);
+#endif
+    }
+
+    directory_rom_impl::~directory_rom_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+      trace::printf (trace::posix_io_directory,
+                     "directory_rom_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    struct dirent*
+    directory_rom_impl::do_read (void)
+    {
+      if (next_ (&dir_entry_) <= 0)
+        {
+          return nullptr;
+        }
+
+      return &dir_entry_;
+    }
+
+    ssize_t
+    directory_rom_impl::do_read_n (struct dirent* buf, std::size_t count)
+    {
+      std::size_t n = 0;
+      while (n < count)
+        {
+          int ret = next_ (&buf[n]);
+          if (ret < 0 && n == 0)
+            {
+              return -1;
+            }
+          if (ret <= 0)
+            {
+              break;
+            }
+          ++n;
+        }
+
+      return static_cast<ssize_t> (n);
+    }
+
+    void
+    directory_rom_impl::do_rewind (void)
+    {
+      pos_ = 0;
+    }
+
+    int
+    directory_rom_impl::do_close (void)
+    {
+      count_ = 0;
+      return 0;
+    }
+
+    file_system_rom_impl&
+    directory_rom_impl::fs_impl_ (void) const
+    {
+      return static_cast<file_system_rom_impl&> (file_system_.impl ());
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    // 1 if an entry was read, 0 at the end, -1 on error.
+    int
+    directory_rom_impl::next_ (struct dirent* de)
+    {
+      file_system_rom_impl& fs = fs_impl_ ();
+      if (!fs.mounted_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+      if (pos_ >= count_)
+        {
+          return 0;
+        }
+
+      uint32_t index = first_ + pos_++;
+      file_system_rom_impl::entry_t e;
+      if (fs.entry_ (index, &e) < 0)
+        {
+          return -1;
+        }
+      if (e.name >= fs.header_.image_size)
+        {
+          errno = EIO; // Damaged image.
+          return -1;
+        }
+
+      std::size_t n = std::min (sizeof(de->d_name) - 1,
+                                std::size_t (fs.header_.image_size - e.name));
+      if (fs.fetch_ (e.name, de->d_name, n) < 0)
+        {
+          return -1;
+        }
+      de->d_name[n] = '\0';
+      de->d_ino = static_cast<ino_t> (index);
+
+      return 1;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -28,10 +28,12 @@
 #include <cmsis-plus/posix-io/file-system.h>
 #include <cmsis-plus/posix-io/block-device.h>
 #include <cmsis-plus/posix-io/device-registry.h>
+#include <cmsis-plus/posix-io/flusher.h>
 
 #include <cerrno>
 #include <cassert>
 #include <cstring>
+#include <fcntl.h>
 
 // ----------------------------------------------------------------------------
 
@@ -57,6 +59,23 @@ namespace os
 
     class file_system* file_system::mounted_root__;
 
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+
+    // FNV-1a.
+    static uint32_t
+    stat_cache_hash (const char* path)
+    {
+      uint32_t hash = 2166136261u;
+      for (; *path != '\0'; ++path)
+        {
+          hash ^= static_cast<uint8_t> (*path);
+          hash *= 16777619u;
+        }
+      return hash;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE) */
+
     /**
      * @endcond
      */
@@ -66,7 +85,8 @@ namespace os
     mkdir (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %u)\n", __func__, path, mode);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\", %u)\n", __func__, path, mode);
 #endif
 
       if (path == nullptr)
@@ -98,7 +118,8 @@ namespace os
     rmdir (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")\n", __func__, path);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\")\n", __func__, path);
 #endif
 
       if (path == nullptr)
@@ -130,7 +151,7 @@ namespace os
     sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s()\n", __func__);
+      trace::printf (trace::posix_io_file_system, "%s()\n", __func__);
 #endif
 
       // Enumerate all mounted file systems and sync them.
@@ -153,7 +174,8 @@ namespace os
     chmod (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %u)\n", __func__, path, mode);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\", %u)\n", __func__, path, mode);
 #endif
 
       if (path == nullptr)
@@ -184,7 +206,8 @@ namespace os
     stat (const char* path, struct stat* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %p)\n", __func__, path, buf);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\", %p)\n", __func__, path, buf);
 #endif
 
       if ((path == nullptr) || (buf == nullptr))
@@ -215,7 +238,8 @@ namespace os
     truncate (const char* path, off_t length)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %u)\n", __func__, path, length);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\", %u)\n", __func__, path, length);
 #endif
 
       if (path == nullptr)
@@ -252,7 +276,8 @@ namespace os
     rename (const char* existing, const char* _new)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\",\"%s\")\n", __func__, existing, _new);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\",\"%s\")\n", __func__, existing, _new);
 #endif
 
       if ((existing == nullptr) || (_new == nullptr))
@@ -285,7 +310,8 @@ namespace os
     unlink (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")\n", __func__, path);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\")\n", __func__, path);
 #endif
 
       if (path == nullptr)
@@ -316,7 +342,8 @@ namespace os
     utime (const char* path, const struct utimbuf* times)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %p)\n", __func__, path, times);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\", %p)\n", __func__, path, times);
 #endif
 
       if ((path == nullptr) || (times == nullptr))
@@ -347,7 +374,8 @@ namespace os
     statvfs (const char* path, struct statvfs* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %p)\n", __func__, path, buf);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\", %p)\n", __func__, path, buf);
 #endif
 
       if ((path == nullptr) || (buf == nullptr))
@@ -378,7 +406,8 @@ namespace os
     opendir (const char* dirpath)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")\n", __func__, dirpath);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\")\n", __func__, dirpath);
 #endif
 
       if (dirpath == nullptr)
@@ -436,7 +465,8 @@ namespace os
       // Return a valid pointer to an object derived from directory, or nullptr.
 
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")=%p\n", __func__, dirpath, dir);
+      trace::printf (trace::posix_io_file_system,
+                     "%s(\"%s\")=%p\n", __func__, dirpath, dir);
 #endif
       return dir;
     }
@@ -448,7 +478,8 @@ namespace os
         impl_ (impl)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")=%p\n", __func__, name_, this);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\")=%p\n", __func__, name_, this);
 #endif
       deferred_files_list_.clear ();
       deferred_directories_list_.clear ();
@@ -457,7 +488,8 @@ namespace os
     file_system::~file_system ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s() @%p %s\n", __func__, this, name_);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s() @%p %s\n", __func__, this, name_);
 #endif
     }
 
@@ -479,7 +511,8 @@ namespace os
     file_system::vmkfs (int options, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(%u) @%p\n", __func__, options, this);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(%u) @%p\n", __func__, options, this);
 #endif
 
       if (mounted_path_ != nullptr)
@@ -494,6 +527,10 @@ namespace os
       int ret;
       ret = impl ().do_vmkfs (options, args);
 
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
       return ret;
     }
 
@@ -514,7 +551,8 @@ namespace os
                          std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u) @%p\n", __func__,
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\", %u) @%p\n", __func__,
                      path ? path : "nullptr", flags, this);
 #endif
 
@@ -552,6 +590,11 @@ namespace os
       errno = 0;
 
       int ret = impl ().do_vmount (flags, args);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
       if (ret < 0)
         {
           return -1;
@@ -564,8 +607,24 @@ namespace os
         }
       else
         {
-          mounted_list__.link (*this);
           mounted_path_ = path;
+          mounted_path_length_ = std::strlen (path);
+
+          // Keep the list ordered by descending path length, so the
+          // first prefix match is the longest one; the shorter paths
+          // are moved after the new one.
+          mounted_list__.link (*this);
+          auto it = mounted_list__.begin ();
+          while (&(*it) != this)
+            {
+              auto& fs = *it;
+              ++it;
+              if (fs.mounted_path_length_ < mounted_path_length_)
+                {
+                  fs.mount_manager_links_.unlink ();
+                  mounted_list__.link (fs);
+                }
+            }
         }
 
       return 0;
@@ -580,11 +639,13 @@ namespace os
     file_system::umount (int unsigned flags)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(%u) @%p\n", __func__, flags, this);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(%u) @%p\n", __func__, flags, this);
 #endif
 
       mount_manager_links_.unlink ();
       mounted_path_ = nullptr;
+      mounted_path_length_ = 0;
 
       if (this == mounted_root__)
         {
@@ -605,6 +666,16 @@ namespace os
 
       impl ().do_sync ();
       int ret = impl ().do_umount (flags);
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      dirty_ = false;
+      dirty_bytes_ = 0;
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
       return ret;
     }
 
@@ -614,12 +685,15 @@ namespace os
       assert(path1 != nullptr);
       assert(*path1 != nullptr);
 
+      // Ordered by descending path length, the first match
+      // is the longest prefix.
       for (auto&& fs : mounted_list__)
         {
-          auto len = std::strlen (fs.mounted_path_);
+          auto len = fs.mounted_path_length_;
 
           // Check if path1 starts with the mounted path.
-          if (std::strncmp (fs.mounted_path_, *path1, len) == 0)
+          if (fs.mounted_path_[0] == (*path1)[0]
+              && std::strncmp (fs.mounted_path_, *path1, len) == 0)
             {
               // If so, adjust paths to skip over prefix, but keep '/'.
               *path1 = (*path1 + len - 1);
@@ -669,7 +743,8 @@ namespace os
     file_system::vopen (const char* path, int oflag, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, oflag);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\", %u)\n", __func__, path, oflag);
 #endif
 
       if (!device ().is_opened ())
@@ -684,6 +759,22 @@ namespace os
       // Allocation is done by the implementation, where
       // the size is known.
       file* fil = impl ().do_vopen (*this, path, oflag, args);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      if (((oflag & O_ACCMODE) != O_RDONLY) || (oflag & (O_CREAT | O_TRUNC)))
+        {
+          // Might have been created or truncated.
+          stat_cache_invalidate ();
+        }
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (fil != nullptr && (oflag & (O_CREAT | O_TRUNC)) != 0)
+        {
+          dirty (0);
+        }
+#endif
+
       if (fil == nullptr)
         {
           return nullptr;
@@ -699,7 +790,8 @@ namespace os
     file_system::opendir (const char* dirpath)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")\n", __func__, dirpath);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\")\n", __func__, dirpath);
 #endif
 
       if (!device ().is_opened ())
@@ -728,7 +820,8 @@ namespace os
     file_system::mkdir (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, mode);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\", %u)\n", __func__, path, mode);
 #endif
 
       if (path == nullptr)
@@ -751,14 +844,28 @@ namespace os
 
       errno = 0;
 
-      return impl ().do_mkdir (path, mode);
+      int ret = impl ().do_mkdir (path, mode);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
+        {
+          dirty (0);
+        }
+#endif
+
+      return ret;
     }
 
     int
     file_system::rmdir (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")\n", __func__, path);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\")\n", __func__, path);
 #endif
 
       if (path == nullptr)
@@ -781,14 +888,28 @@ namespace os
 
       errno = 0;
 
-      return impl ().do_rmdir (path);
+      int ret = impl ().do_rmdir (path);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
+        {
+          dirty (0);
+        }
+#endif
+
+      return ret;
     }
 
     void
     file_system::sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s() @%p\n", __func__, this);
 #endif
 
       if (!device ().is_opened ())
@@ -799,16 +920,45 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      // Cleared first, the changes made meanwhile are kept.
+      dirty_ = false;
+      dirty_bytes_ = 0;
+#endif
+
       impl ().do_sync ();
     }
 
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+
+    /**
+     * @details
+     * The age is counted from the first change after the last
+     * `sync()`.
+     */
+    void
+    file_system::dirty (std::size_t bytes)
+    {
+      if (!dirty_)
+        {
+          dirty_since_ = rtos::sysclock.now ();
+          dirty_ = true;
+        }
+      dirty_bytes_ += bytes;
+
+      flusher_impl::notify (*this);
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FLUSHER) */
+
     // ------------------------------------------------------------------------
 
     int
     file_system::chmod (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, mode);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\", %u)\n", __func__, path, mode);
 #endif
 
       if (path == nullptr)
@@ -832,14 +982,28 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_chmod (path, mode);
+      int ret = impl ().do_chmod (path, mode);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
+        {
+          dirty (0);
+        }
+#endif
+
+      return ret;
     }
 
     int
     file_system::stat (const char* path, struct stat* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %p)\n", __func__, path, buf);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\", %p)\n", __func__, path, buf);
 #endif
 
       if ((path == nullptr) || (buf == nullptr))
@@ -862,15 +1026,60 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+
+      std::size_t len = std::strlen (path);
+      if (len >= sizeof(stat_cache_[0].path))
+        {
+          // Too long to be cached.
+          return impl ().do_stat (path, buf);
+        }
+
+      uint32_t hash = stat_cache_hash (path);
+      stat_cache_entry_t& e = stat_cache_[hash
+          % OS_INTEGER_POSIX_IO_FILE_SYSTEM_STAT_CACHE_SIZE];
+
+      if ((e.generation == stat_cache_generation_) && (e.hash == hash)
+          && (std::strcmp (e.path, path) == 0))
+        {
+          if (e.error != 0)
+            {
+              errno = e.error;
+              return -1;
+            }
+          *buf = e.st;
+          return 0;
+        }
+
+      // Execute the implementation specific code.
+      int ret = impl ().do_stat (path, buf);
+      if ((ret == 0) || (errno == ENOENT) || (errno == ENOTDIR))
+        {
+          e.hash = hash;
+          e.generation = stat_cache_generation_;
+          e.error = (ret == 0) ? 0 : errno;
+          if (ret == 0)
+            {
+              e.st = *buf;
+            }
+          std::memcpy (e.path, path, len + 1);
+        }
+      return ret;
+
+#else
+
       // Execute the implementation specific code.
       return impl ().do_stat (path, buf);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE) */
     }
 
     int
     file_system::truncate (const char* path, off_t length)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, length);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\", %u)\n", __func__, path, length);
 #endif
 
       if (path == nullptr)
@@ -894,14 +1103,28 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_truncate (path, length);
+      int ret = impl ().do_truncate (path, length);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
+        {
+          dirty (0);
+        }
+#endif
+
+      return ret;
     }
 
     int
     file_system::rename (const char* existing, const char* _new)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\",\"%s\")\n", __func__, existing,
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\",\"%s\")\n", __func__, existing,
                      _new);
 #endif
 
@@ -926,14 +1149,28 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_rename (existing, _new);
+      int ret = impl ().do_rename (existing, _new);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
+        {
+          dirty (0);
+        }
+#endif
+
+      return ret;
     }
 
     int
     file_system::unlink (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")\n", __func__, path);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\")\n", __func__, path);
 #endif
 
       if (path == nullptr)
@@ -957,7 +1194,20 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_unlink (path);
+      int ret = impl ().do_unlink (path);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
+        {
+          dirty (0);
+        }
+#endif
+
+      return ret;
     }
 
     // http://pubs.opengroup.org/onlinepubs/9699919799/functions/utime.html
@@ -965,7 +1215,8 @@ namespace os
     file_system::utime (const char* path, const struct utimbuf* times)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %p)\n", __func__, path, times);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(\"%s\", %p)\n", __func__, path, times);
 #endif
 
       if ((path == nullptr) || (times == nullptr))
@@ -995,13 +1246,24 @@ namespace os
           // of the file shall be set to the current time.
           tmp.actime = time (nullptr);
           tmp.modtime = tmp.actime;
-          return impl ().do_utime (path, &tmp);
+          times = &tmp;
         }
-      else
+
+      // Execute the implementation specific code.
+      int ret = impl ().do_utime (path, times);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
         {
-          // Execute the implementation specific code.
-          return impl ().do_utime (path, times);
+          dirty (0);
         }
+#endif
+
+      return ret;
     }
 
     // http://pubs.opengroup.org/onlinepubs/9699919799/functions/fstatvfs.html
@@ -1009,7 +1271,8 @@ namespace os
     file_system::statvfs (struct statvfs* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(%p)\n", __func__, buf);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system::%s(%p)\n", __func__, buf);
 #endif
 
       if (!device ().is_opened ())
@@ -1018,7 +1281,21 @@ namespace os
           return -1;
         }
 
-      return impl ().do_statvfs (buf);
+      int ret = impl ().do_statvfs (buf);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      // Advertise the preferred transfer size of the device, if it
+      // is a multiple of the file system block.
+      std::size_t osz = device ().block_optimal_size_bytes ();
+      if (buf->f_bsize == 0
+          || (osz > buf->f_bsize && (osz % buf->f_bsize) == 0))
+        {
+          buf->f_bsize = osz;
+        }
+      return ret;
     }
     // TODO: check if the file system should keep a static current path for
     // relative paths.
@@ -1032,14 +1309,16 @@ namespace os
         device_ (device)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system_impl::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     file_system_impl::~file_system_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_file_system,
+                     "file_system_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -30,7 +30,9 @@
 
 #include <cmsis-plus/diag/trace.h>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstring>
 
 // ----------------------------------------------------------------------------
 
@@ -45,42 +47,341 @@ namespace os
           { impl, type::file }
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_file, "file::%s()=%p\n", __func__, this);
 #endif
     }
 
     file::~file ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_file, "file::%s() @%p\n", __func__, this);
 #endif
     }
 
     // ------------------------------------------------------------------------
 
+    /**
+     * @details
+     * The buffered data is written before closing; the buffer
+     * is released, the next open starts unbuffered.
+     */
     int
     file::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_file, "file::%s() @%p\n", __func__, this);
 #endif
 
+      int fret = flush ();
+      int ferr = errno;
+
+      buf_ = nullptr;
+      buf_size_ = 0;
+      buf_count_ = 0;
+      buf_pos_ = 0;
+      buf_mode_ = _IONBF;
+      buf_dirty_ = false;
+
       int ret = io::close ();
 
+      // The directory entry may be updated only now.
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      file_system ().stat_cache_invalidate ();
+#endif
+
       // Note: the constructor is not called here.
 
       // Link the file object to a list kept by the file system.
       // It will be deallocated at the next open.
       file_system ().add_deferred_file (this);
 
+      if (fret < 0 && ret == 0)
+        {
+          errno = ferr;
+          return -1;
+        }
+      return ret;
+    }
+
+    /**
+     * @details
+     * With a buffer, the bytes left from the previous read ahead
+     * are returned first; the rest is read ahead with a single
+     * full buffer read, or directly, if it does not fit the buffer.
+     */
+    ssize_t
+    file::read (void* buf, std::size_t nbyte)
+    {
+      if (buf_mode_ == _IONBF || buf == nullptr || nbyte == 0)
+        {
+          return io::read (buf, nbyte);
+        }
+
+      errno = 0;
+
+      if (buf_dirty_ && flush () < 0)
+        {
+          return -1;
+        }
+
+      auto* p = static_cast<uint8_t*> (buf);
+      std::size_t count = std::min (nbyte, buf_count_ - buf_pos_);
+      std::memcpy (p, buf_ + buf_pos_, count);
+      buf_pos_ += count;
+      if (count == nbyte)
+        {
+          return static_cast<ssize_t> (count);
+        }
+
+      ssize_t ret;
+      if (nbyte - count >= buf_size_)
+        {
+          // Large reads go directly to the file system.
+          ret = io::read (p + count, nbyte - count);
+          if (ret < 0)
+            {
+              return (count > 0) ? static_cast<ssize_t> (count) : -1;
+            }
+          return static_cast<ssize_t> (count) + ret;
+        }
+
+      buf_count_ = 0;
+      buf_pos_ = 0;
+      ret = io::read (buf_, buf_size_);
+      if (ret < 0)
+        {
+          return (count > 0) ? static_cast<ssize_t> (count) : -1;
+        }
+      buf_count_ = static_cast<std::size_t> (ret);
+
+      std::size_t n = std::min (nbyte - count, buf_count_);
+      std::memcpy (p + count, buf_, n);
+      buf_pos_ = n;
+
+      return static_cast<ssize_t> (count + n);
+    }
+
+    ssize_t
+    file::readv (const struct iovec* iov, int iovcnt)
+    {
+      if (sync_buffer_ () < 0)
+        {
+          return -1;
+        }
+
+      return io::readv (iov, iovcnt);
+    }
+
+    /**
+     * @details
+     * With a buffer, the bytes are only copied to it, and passed
+     * to the file system when it is full, or, in `_IOLBF` mode,
+     * when they include an end of line. Writes larger than the
+     * buffer go directly to the file system, after the buffered
+     * bytes. An error while flushing the accepted bytes is
+     * reported by the next `flush()`, `fsync()` or `close()`.
+     */
+    ssize_t
+    file::write (const void* buf, std::size_t nbyte)
+    {
+      if (buf_mode_ == _IONBF || buf == nullptr || nbyte == 0)
+        {
+          return write_ (buf, nbyte);
+        }
+
+      errno = 0;
+
+      if (!buf_dirty_ && sync_buffer_ () < 0)
+        {
+          return -1;
+        }
+
+      if (buf_count_ + nbyte > buf_size_ && flush () < 0)
+        {
+          return -1;
+        }
+
+      if (nbyte >= buf_size_)
+        {
+          return write_ (buf, nbyte);
+        }
+
+      std::memcpy (buf_ + buf_count_, buf, nbyte);
+      buf_count_ += nbyte;
+      buf_dirty_ = true;
+
+      if (buf_mode_ == _IOLBF && std::memchr (buf, '\n', nbyte) != nullptr)
+        {
+          flush ();
+        }
+
+      return static_cast<ssize_t> (nbyte);
+    }
+
+    ssize_t
+    file::writev (const struct iovec* iov, int iovcnt)
+    {
+      if (sync_buffer_ () < 0)
+        {
+          return -1;
+        }
+
+      ssize_t ret = io::writev (iov, iovcnt);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      file_system ().stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret > 0)
+        {
+          file_system ().dirty (static_cast<std::size_t> (ret));
+        }
+#endif
+
+      return ret;
+    }
+
+    int
+    file::fstat (struct stat* buf)
+    {
+      // Update the size.
+      if (flush () < 0)
+        {
+          return -1;
+        }
+
+      return io::fstat (buf);
+    }
+
+    off_t
+    file::lseek (off_t offset, int whence)
+    {
+      // Also moves back over the read ahead bytes, for SEEK_CUR.
+      if (sync_buffer_ () < 0)
+        {
+          return -1;
+        }
+
+      return io::lseek (offset, whence);
+    }
+
+    int
+    file::setvbuf (void* buf, int mode, std::size_t size)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf (trace::posix_io_file, "file::%s(%p, %d, %u) @%p\n",
+                     __func__, buf, mode, size, this);
+#endif
+
+      if ((mode != _IOFBF && mode != _IOLBF && mode != _IONBF)
+          || (mode != _IONBF && (buf == nullptr || size == 0)))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (sync_buffer_ () < 0)
+        {
+          return -1;
+        }
+
+      errno = 0;
+
+      if (mode == _IONBF)
+        {
+          buf = nullptr;
+          size = 0;
+        }
+      buf_ = static_cast<uint8_t*> (buf);
+      buf_size_ = size;
+      buf_count_ = 0;
+      buf_pos_ = 0;
+      buf_mode_ = mode;
+      buf_dirty_ = false;
+
+      return 0;
+    }
+
+    int
+    file::flush (void)
+    {
+      if (!buf_dirty_)
+        {
+          return 0;
+        }
+
+      std::size_t done = 0;
+      while (done < buf_count_)
+        {
+          ssize_t ret = write_ (buf_ + done, buf_count_ - done);
+          if (ret <= 0)
+            {
+              // Keep the bytes not written, for a later retry.
+              std::memmove (buf_, buf_ + done, buf_count_ - done);
+              buf_count_ -= done;
+              if (ret == 0)
+                {
+                  errno = EIO;
+                }
+              return -1;
+            }
+          done += static_cast<std::size_t> (ret);
+        }
+
+      buf_count_ = 0;
+      buf_dirty_ = false;
+
+      return 0;
+    }
+
+    ssize_t
+    file::write_ (const void* buf, std::size_t nbyte)
+    {
+      ssize_t ret = io::write (buf, nbyte);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      file_system ().stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret > 0)
+        {
+          file_system ().dirty (static_cast<std::size_t> (ret));
+        }
+#endif
+
       return ret;
     }
 
+    int
+    file::sync_buffer_ (void)
+    {
+      if (buf_dirty_)
+        {
+          return flush ();
+        }
+
+      std::size_t ahead = buf_count_ - buf_pos_;
+      buf_count_ = 0;
+      buf_pos_ = 0;
+      if (ahead > 0)
+        {
+          // The file system position is after the read ahead bytes.
+          if (io::lseek (-static_cast<off_t> (ahead), SEEK_CUR) < 0)
+            {
+              return -1;
+            }
+        }
+      return 0;
+    }
+
     int
     file::ftruncate (off_t length)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s(%u) @%p\n", __func__, length, this);
+      trace::printf (trace::posix_io_file,
+                     "file::%s(%u) @%p\n", __func__, length, this);
 #endif
 
       if (length < 0)
@@ -89,30 +390,60 @@ namespace os
           return -1;
         }
 
+      if (sync_buffer_ () < 0)
+        {
+          return -1;
+        }
+
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_ftruncate (length);
+      int ret = impl ().do_ftruncate (length);
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      file_system ().stat_cache_invalidate ();
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+      if (ret == 0)
+        {
+          file_system ().dirty (0);
+        }
+#endif
+
+      return ret;
     }
 
     int
     file::fsync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_file, "file::%s() @%p\n", __func__, this);
 #endif
 
+      if (flush () < 0)
+        {
+          return -1;
+        }
+
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_fsync ();
+      int ret = impl ().do_fsync ();
+
+#if defined(OS_INCLUDE_POSIX_IO_FILE_SYSTEM_STAT_CACHE)
+      file_system ().stat_cache_invalidate ();
+#endif
+
+      return ret;
     }
 
     int
     file::fstatvfs (struct statvfs *buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s(%p) @%p\n", __func__, buf, this);
+      trace::printf (trace::posix_io_file,
+                     "file::%s(%p) @%p\n", __func__, buf, this);
 #endif
 
       errno = 0;
@@ -121,20 +452,59 @@ namespace os
       return file_system ().statvfs (buf);
     }
 
+    /**
+     * @details
+     * Similar to a read-only `mmap()`; nothing needs to be
+     * unmapped, the pointer remains valid while the file is
+     * opened and not written.
+     */
+    const void*
+    file::map (off_t offset, std::size_t length)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf (trace::posix_io_file,
+                     "file::%s(%u, %u) @%p\n", __func__, offset, length, this);
+#endif
+
+      if ((offset < 0) || (length == 0))
+        {
+          errno = EINVAL;
+          return nullptr;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return nullptr;
+        }
+
+      if (flush () < 0)
+        {
+          return nullptr;
+        }
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      return impl ().do_map (offset, length);
+    }
+
     // ========================================================================
 
     file_impl::file_impl (class file_system& fs) :
         file_system_ (fs)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file_impl::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_file,
+                     "file_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     file_impl::~file_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_file,
+                     "file_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -159,6 +529,21 @@ namespace os
       return -1;
     }
 
+    /**
+     * @details
+     * The default implementation fails with `ENODEV`. File systems
+     * that store the file in consecutive blocks should override it,
+     * check the range and return `file_system ().device ().map ()`
+     * of the blocks plus the offset inside the first one.
+     */
+    const void*
+    file_impl::do_map (off_t offset __attribute__((unused)),
+                       std::size_t length __attribute__((unused)))
+    {
+      errno = ENODEV;
+      return nullptr;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -0,0 +1,340 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_FLUSHER)
+
+#include <cmsis-plus/posix-io/flusher.h>
+#include <cmsis-plus/posix/sys/ioctl.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @cond ignore
+     */
+
+    flusher_impl* volatile flusher_impl::running__;
+
+    /**
+     * @endcond
+     */
+
+    flusher_impl::flusher_impl (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
+      trace::printf (trace::posix_io_char_device, "flusher_impl::%s()=%p\n",
+                     __func__, this);
+#endif
+    }
+
+    flusher_impl::~flusher_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
+      trace::printf (trace::posix_io_char_device, "flusher_impl::%s() @%p\n",
+                     __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    flusher_impl::do_vopen (const char* path __attribute__((unused)),
+                            int oflag __attribute__((unused)),
+                            std::va_list args __attribute__((unused)))
+    {
+      if (running__ != nullptr)
+        {
+          errno = EBUSY; // Only one flusher.
+          return -1;
+        }
+
+      stop_ = false;
+
+      rtos::thread::attributes attr;
+      attr.th_priority = priority_;
+#if !defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+      attr.th_stack_size_bytes = OS_INTEGER_POSIX_IO_FLUSHER_STACK_SIZE_BYTES;
+#endif
+
+      // Constructed in place, the object is reused after close().
+      thread_ = new (&thread_storage_) thread_type
+        { "flusher", run_, this, attr };
+      running__ = this;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * The values are passed as `std::size_t`, the priority as
+     * `int`; the `FLSGET*` requests take a pointer to a
+     * `std::size_t`, or to a `rtos::thread::priority_t`.
+     */
+    int
+    flusher_impl::do_vioctl (int request, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
+      trace::printf (trace::posix_io_char_device,
+                     "flusher_impl::%s(%d) @%p\n", __func__, request, this);
+#endif
+
+      switch (static_cast<unsigned int> (request))
+        {
+        case FLSSETPERIOD:
+          {
+            std::size_t ms = va_arg(args, std::size_t);
+            if (ms == 0 || ms > 0xFFFFFFFFu / 1000u)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+            period_ms_ = static_cast<uint32_t> (ms);
+            if (thread_ != nullptr)
+              {
+                // Restart the wait with the new period.
+                thread_->flags_raise (1);
+              }
+            return 0;
+          }
+
+        case FLSSETEXPIRE:
+          {
+            std::size_t ms = va_arg(args, std::size_t);
+            if (ms > 0xFFFFFFFFu / 1000u)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+            expire_ms_ = static_cast<uint32_t> (ms);
+            return 0;
+          }
+
+        case FLSSETDIRTY:
+          dirty_bytes_ = va_arg(args, std::size_t);
+          return 0;
+
+        case FLSSETPRIO:
+          {
+            int prio = va_arg(args, int);
+            if (prio <= rtos::thread::priority::idle
+                || prio >= rtos::thread::priority::isr)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+            priority_ = static_cast<rtos::thread::priority_t> (prio);
+            if (thread_ != nullptr)
+              {
+                thread_->priority (priority_);
+              }
+            return 0;
+          }
+
+        case FLSGETPERIOD:
+        case FLSGETEXPIRE:
+        case FLSGETDIRTY:
+          {
+            std::size_t* n = va_arg(args, std::size_t*);
+            if (n == nullptr)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            if (static_cast<unsigned int> (request) == FLSGETPERIOD)
+              {
+                *n = period_ms_;
+              }
+            else if (static_cast<unsigned int> (request) == FLSGETEXPIRE)
+              {
+                *n = expire_ms_;
+              }
+            else
+              {
+                *n = dirty_bytes_;
+              }
+            return 0;
+          }
+
+        case FLSGETPRIO:
+          {
+            rtos::thread::priority_t* p = va_arg(args,
+                                                 rtos::thread::priority_t*);
+            if (p == nullptr)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            *p = priority_;
+            return 0;
+          }
+
+        default:
+          errno = ENOSYS;
+          return -1;
+        }
+    }
+
+    ssize_t
+    flusher_impl::do_read (void* buf __attribute__((unused)),
+                           std::size_t nbyte __attribute__((unused)))
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    ssize_t
+    flusher_impl::do_write (const void* buf __attribute__((unused)),
+                            std::size_t nbyte __attribute__((unused)))
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    int
+    flusher_impl::do_close (void)
+    {
+      if (thread_ != nullptr)
+        {
+          stop_ = true;
+          thread_->flags_raise (1);
+          thread_->join ();
+
+          thread_->~thread_type ();
+          thread_ = nullptr;
+        }
+      running__ = nullptr;
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    flusher_impl::notify (file_system& fs)
+    {
+      flusher_impl* self = running__;
+      if (self != nullptr && self->thread_ != nullptr && self->dirty_bytes_ > 0
+          && fs.dirty_bytes () >= self->dirty_bytes_)
+        {
+          // Under pressure, do not wait for the period.
+          self->thread_->flags_raise (1);
+        }
+    }
+
+    void*
+    flusher_impl::run_ (void* args)
+    {
+      flusher_impl* self = static_cast<flusher_impl*> (args);
+
+      while (!self->stop_)
+        {
+          // Woken early by pressure, a new period or close().
+          rtos::this_thread::flags_timed_wait (
+              1,
+              rtos::clock_systick::ticks_cast (
+                  static_cast<uint64_t> (self->period_ms_) * 1000u));
+          if (self->stop_)
+            {
+              break;
+            }
+
+          self->scan_ ();
+        }
+
+      return nullptr;
+    }
+
+    void
+    flusher_impl::scan_ (void)
+    {
+      rtos::clock::timestamp_t now = rtos::sysclock.now ();
+      rtos::clock::duration_t expire = rtos::clock_systick::ticks_cast (
+          static_cast<uint64_t> (expire_ms_) * 1000u);
+
+      // Like posix::sync(), the root last.
+      for (auto&& fs : file_system::mounted_list__)
+        {
+          if (due_ (fs, now, expire))
+            {
+              fs.sync ();
+              ++write_backs_;
+            }
+        }
+
+      file_system* root = file_system::mounted_root__;
+      if (root != nullptr && due_ (*root, now, expire))
+        {
+          root->sync ();
+          ++write_backs_;
+        }
+    }
+
+    bool
+    flusher_impl::due_ (file_system& fs, rtos::clock::timestamp_t now,
+                        rtos::clock::duration_t expire) const
+    {
+      if (!fs.is_dirty ())
+        {
+          return false;
+        }
+
+      return (now - fs.dirty_since ()) >= expire
+          || (dirty_bytes_ > 0 && fs.dirty_bytes () >= dirty_bytes_);
+    }
+
+    /**
+     * @endcond
+     */
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_FLUSHER) */
+
+// ----------------------------------------------------------------------------
@@ -28,19 +28,47 @@
 #include <cmsis-plus/posix-io/device.h>
 #include <cmsis-plus/posix/sys/uio.h>
 #include <cmsis-plus/posix-io/device-registry.h>
+#include <cmsis-plus/posix-io/event-poll.h>
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/file-descriptors-manager.h>
 #include <cmsis-plus/posix-io/file-system.h>
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/io-coroutine.h>
 
 #include <cmsis-plus/diag/trace.h>
 
+#include <cmsis-plus/rtos/os.h>
+
 #include <cassert>
 #include <cerrno>
 #include <cstdarg>
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#endif
+
+static os::rtos::work_queue* os_aio_queue_;
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+using aio_queue_type = os::rtos::work_queue_inclusive<
+    OS_INTEGER_POSIX_IO_AIO_QUEUE_SIZE, OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES>;
+static std::aligned_storage<sizeof(aio_queue_type), alignof(aio_queue_type)>::type os_aio_queue_storage_;
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+#pragma GCC diagnostic pop
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
+// ----------------------------------------------------------------------------
+
 // Variadic calls are processed in two steps, first prepare a
 // va_list structure, then call implementation functions like doOpen()
 // doIoctl(), that use 'va_list args'.
@@ -72,76 +100,163 @@ namespace os
     vopen (const char* path, int oflag, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(\"%s\")\n", __func__, path ? path : "");
+      trace::printf (trace::posix_io_io,
+                     "io::%s(\"%s\")\n", __func__, path ? path : "");
 #endif
 
-      if (path == nullptr)
+      path_handle handle;
+      if (resolve (path, &handle) < 0)
         {
-          errno = EFAULT;
           return nullptr;
         }
 
+      io* const io = vopen_at (handle, oflag, args);
+
+      // Return a valid pointer to an object derived from io, or nullptr.
+
+#if defined(OS_TRACE_POSIX_IO_IO)
+      if (io != nullptr)
+        {
+          trace::printf (trace::posix_io_io,
+                         "io::%s(\"%s\")=%p fd=%d\n", __func__, path, io,
+                         io->file_descriptor ());
+        }
+#endif
+      return io;
+    }
+
+    /**
+     * @details
+     * Check the device registry first, then the mounted file systems,
+     * exactly as `open()` does, but only once; the file system
+     * specific part of the path is still parsed by each `open_at()`.
+     */
+    int
+    resolve (const char* path, path_handle* handle)
+    {
+      if (path == nullptr || handle == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
       if (*path == '\0')
         {
           errno = ENOENT;
-          return nullptr;
+          return -1;
         }
 
       errno = 0;
 
-      os::posix::io* io;
-      while (true)
+      handle->device = nullptr;
+      handle->file_system = nullptr;
+      handle->mounted_path = nullptr;
+      handle->path = path;
+
+      // Check if path is a device.
+      handle->device = os::posix::device_registry<device>::identify_device (
+          path);
+      if (handle->device != nullptr)
         {
-          // Check if path is a device.
-          io = os::posix::device_registry<device>::identify_device (path);
-          if (io != nullptr)
-            {
-              // If so, use the implementation to open the device.
-              int oret = static_cast<device*> (io)->vopen (path, oflag, args);
-              if (oret < 0)
-                {
-                  // Open failed.
-                  return nullptr;
-                }
-
-              // File descriptor already allocated by device.
-              break;
-            }
+          return 0;
+        }
 
-          // Check if a regular file.
-          auto adjusted_path = path;
-          auto* const fs = os::posix::file_system::identify_mounted (
-              &adjusted_path);
+      // Check if a regular file.
+      auto* const fs = os::posix::file_system::identify_mounted (
+          &handle->path);
 
-          // The manager will return null if there are no file systems
-          // registered, no need to check this condition separately.
-          if (fs == nullptr)
-            {
-              errno = EBADF;
-              return nullptr;
-            }
+      // The manager will return null if there are no file systems
+      // registered, no need to check this condition separately.
+      if (fs == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      handle->file_system = fs;
+      handle->mounted_path = fs->mounted_path ();
+      return 0;
+    }
+
+    io*
+    open_at (const path_handle& handle, int oflag, ...)
+    {
+      // Forward to the variadic version of the function.
+      std::va_list args;
+      va_start(args, oflag);
+      io* const ret = vopen_at (handle, oflag, args);
+      va_end(args);
+
+      return ret;
+    }
 
-          // Use the file system implementation to open the file, using
-          // the adjusted path (mount point prefix removed).
-          io = fs->vopen (adjusted_path, oflag, args);
-          if (io == nullptr)
+    io*
+    vopen_at (const path_handle& handle, int oflag, std::va_list args)
+    {
+      errno = 0;
+
+      if (handle.device != nullptr)
+        {
+          // Use the implementation to open the device.
+          int oret = handle.device->vopen (handle.path, oflag, args);
+          if (oret < 0)
             {
               // Open failed.
               return nullptr;
             }
 
-          break;
+          // File descriptor already allocated by device.
+          return handle.device;
         }
 
-      // Return a valid pointer to an object derived from io, or nullptr.
+      if (handle.file_system == nullptr || handle.mounted_path == nullptr
+          || handle.file_system->mounted_path () != handle.mounted_path)
+        {
+          // Not resolved, or unmounted since.
+          errno = ESTALE;
+          return nullptr;
+        }
 
-#if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(\"%s\")=%p fd=%d\n", __func__, path, io,
-                     io->file_descriptor ());
-#endif
-      return io;
+      // Use the file system implementation to open the file, using
+      // the adjusted path (mount point prefix removed).
+      return handle.file_system->vopen (handle.path, oflag, args);
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+    int
+    aio_error (const aiocb* cb)
+    {
+      if (cb == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+      return cb->aio_error_;
     }
 
+    /**
+     * @details
+     * Like POSIX, it should be called only once per request, after
+     * `aio_error()` no longer returns `EINPROGRESS`.
+     */
+    ssize_t
+    aio_return (aiocb* cb)
+    {
+      if (cb == nullptr || cb->aio_error_ == EINPROGRESS)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+      if (cb->aio_error_ != 0)
+        {
+          errno = cb->aio_error_;
+        }
+      return cb->aio_return_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
     // ========================================================================
 
     io::io (io_impl& impl, type t) :
@@ -149,7 +264,7 @@ namespace os
         type_ (t)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_io, "io::%s()=%p\n", __func__, this);
 #endif
 
       file_descriptor_ = no_file_descriptor;
@@ -158,7 +273,7 @@ namespace os
     io::~io ()
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_io, "io::%s() @%p\n", __func__, this);
 #endif
 
       file_descriptor_ = no_file_descriptor;
@@ -170,7 +285,7 @@ namespace os
     io::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_io, "io::%s() @%p\n", __func__, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -181,6 +296,13 @@ namespace os
 
       errno = 0;
 
+      // Stop being watched by an event poll.
+      event_poll_entry* const entry = impl ().poll_entry_;
+      if (entry != nullptr)
+        {
+          event_poll_impl::detach_ (entry);
+        }
+
       // Execute the implementation specific code.
       int ret = impl ().do_close ();
 
@@ -195,7 +317,7 @@ namespace os
     io::alloc_file_descriptor (void)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_io, "io::%s() @%p\n", __func__, this);
 #endif
 
       int fd = file_descriptors_manager::allocate (this);
@@ -208,7 +330,8 @@ namespace os
         }
 
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p fd=%d\n", __func__, this, fd);
+      trace::printf (trace::posix_io_io,
+                     "io::%s() @%p fd=%d\n", __func__, this, fd);
 #endif
 
       // Return a valid pointer to an object derived from `io`.
@@ -223,7 +346,8 @@ namespace os
     io::read (void* buf, std::size_t nbyte)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p\n", __func__, buf, nbyte, this);
+      trace::printf (trace::posix_io_io,
+                     "io::%s(0x0%X, %u) @%p\n", __func__, buf, nbyte, this);
 #endif
 
       if (buf == nullptr)
@@ -256,6 +380,10 @@ namespace os
           return 0; // Nothing to do.
         }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_read (buf, nbyte);
       if (ret >= 0)
@@ -263,18 +391,75 @@ namespace os
           impl ().offset_ += ret;
         }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account_ (false, ret, begin);
+#endif
+
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p n=%d\n", __func__, buf, nbyte, this,
+      trace::printf (trace::posix_io_io,
+                     "io::%s(0x0%X, %u) @%p n=%d\n", __func__, buf, nbyte, this,
                      ret);
 #endif
       return ret;
     }
 
+    ssize_t
+    io::readv (const struct iovec* iov, int iovcnt)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf (trace::posix_io_io,
+                     "io::%s(0x0%X, %d) @%p\n", __func__, iov, iovcnt, this);
+#endif
+
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (iovcnt <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_readv (iov, iovcnt);
+      if (ret >= 0)
+        {
+          impl ().offset_ += ret;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account_ (false, ret, begin);
+#endif
+      return ret;
+    }
+
     ssize_t
     io::write (const void* buf, std::size_t nbyte)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p\n", __func__, buf, nbyte, this);
+      trace::printf (trace::posix_io_io,
+                     "io::%s(0x0%X, %u) @%p\n", __func__, buf, nbyte, this);
 #endif
 
       if (buf == nullptr)
@@ -309,6 +494,10 @@ namespace os
           return 0; // Nothing to do.
         }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_write (buf, nbyte);
       if (ret >= 0)
@@ -316,8 +505,13 @@ namespace os
           impl ().offset_ += ret;
         }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account_ (true, ret, begin);
+#endif
+
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p n=%d\n", __func__, buf, nbyte, this,
+      trace::printf (trace::posix_io_io,
+                     "io::%s(0x0%X, %u) @%p n=%d\n", __func__, buf, nbyte, this,
                      ret);
 #endif
       return ret;
@@ -327,7 +521,8 @@ namespace os
     io::writev (const struct iovec* iov, int iovcnt)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %d) @%p\n", __func__, iov, iovcnt, this);
+      trace::printf (trace::posix_io_io,
+                     "io::%s(0x0%X, %d) @%p\n", __func__, iov, iovcnt, this);
 #endif
 
       if (iov == nullptr)
@@ -356,15 +551,254 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_writev (iov, iovcnt);
       if (ret >= 0)
         {
           impl ().offset_ += ret;
         }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account_ (true, ret, begin);
+#endif
+      return ret;
+    }
+
+    /**
+     * @details
+     * Similar to the Linux `sendfile()`, but any pair of objects
+     * can be used. If _offset_ is not `nullptr`, the offset of _in_
+     * is restored on return.
+     *
+     * The data goes through `do_sendfile()` of this object, which
+     * implementations can override to avoid the intermediate copy.
+     */
+    ssize_t
+    io::sendfile (io* in, off_t* offset, std::size_t count)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf (trace::posix_io_io,
+                     "io::%s(%p, %p, %u) @%p\n", __func__, in, offset, count,
+                     this);
+#endif
+
+      if (in == nullptr || !in->is_opened ())
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      if (offset != nullptr && *offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      errno = 0;
+
+      if (count == 0)
+        {
+          return 0; // Nothing to do.
+        }
+
+      off_t saved = 0;
+      if (offset != nullptr)
+        {
+          saved = in->lseek (0, SEEK_CUR);
+          if (saved < 0 || in->lseek (*offset, SEEK_SET) < 0)
+            {
+              return -1;
+            }
+        }
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_sendfile (*this, *in, count);
+
+      if (offset != nullptr)
+        {
+          if (ret > 0)
+            {
+              *offset += ret;
+            }
+
+          // Keep the errno of the transfer.
+          int err = errno;
+          in->lseek (saved, SEEK_SET);
+          errno = err;
+        }
+
+      return ret;
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+    /**
+     * @details
+     * Queue a read of `cb->aio_nbytes` bytes at `cb->aio_offset`
+     * into `cb->aio_buf` and return immediately. On completion,
+     * `aio_error()` stops returning `EINPROGRESS` and
+     * `cb->aio_notify`, if set, is called; releasing a semaphore
+     * from it is the usual way to wait for the request.
+     *
+     * @retval 0 The request was queued.
+     * @retval -1 The request was not queued; `errno` is set
+     *  (`EAGAIN` if the queue is full).
+     */
+    int
+    io::aio_read (aiocb* cb)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf (trace::posix_io_io,
+                     "io::%s(%p) @%p\n", __func__, cb, this);
+#endif
+
+      if (cb == nullptr || cb->aio_buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (cb->aio_error_ == EINPROGRESS)
+        {
+          errno = EBUSY; // The control block is in use.
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      cb->aio_io_ = this;
+      cb->aio_write_ = false;
+      cb->aio_return_ = -1;
+      cb->aio_error_ = EINPROGRESS;
+
+      // Execute the implementation specific code.
+      int ret = impl ().do_aio_read (cb);
+      if (ret < 0)
+        {
+          cb->aio_error_ = errno;
+        }
+      return ret;
+    }
+
+    /**
+     * @details
+     * Queue a write of `cb->aio_nbytes` bytes from `cb->aio_buf`
+     * at `cb->aio_offset`; completion is reported as for
+     * `aio_read()`.
+     */
+    int
+    io::aio_write (aiocb* cb)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf (trace::posix_io_io,
+                     "io::%s(%p) @%p\n", __func__, cb, this);
+#endif
+
+      if (cb == nullptr || cb->aio_buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (cb->aio_error_ == EINPROGRESS)
+        {
+          errno = EBUSY; // The control block is in use.
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      cb->aio_io_ = this;
+      cb->aio_write_ = true;
+      cb->aio_return_ = -1;
+      cb->aio_error_ = EINPROGRESS;
+
+      // Execute the implementation specific code.
+      int ret = impl ().do_aio_write (cb);
+      if (ret < 0)
+        {
+          cb->aio_error_ = errno;
+        }
       return ret;
     }
 
+    /**
+     * @details
+     * The worker is created on first use. Its priority, queue size
+     * and stack size are configured by
+     * `OS_INTEGER_POSIX_IO_AIO_PRIORITY`,
+     * `OS_INTEGER_POSIX_IO_AIO_QUEUE_SIZE` and
+     * `OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES`.
+     *
+     * Requests are run in order, so a long transfer delays the
+     * following ones, on all devices.
+     */
+    rtos::work_queue*
+    io::aio_queue (void)
+    {
+      if (os_aio_queue_ == nullptr)
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          if (os_aio_queue_ == nullptr)
+            {
+              rtos::work_queue::attributes attr;
+              attr.th_priority = OS_INTEGER_POSIX_IO_AIO_PRIORITY;
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+              // Constructed in place, to not register any destructor.
+              os_aio_queue_ = new (&os_aio_queue_storage_) aio_queue_type
+                { "aio", attr };
+
+#else
+
+              attr.th_stack_size_bytes =
+                  OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES;
+
+              // Never deallocated; the worker lives as long as the
+              // application.
+              os_aio_queue_ = new rtos::work_queue
+                { "aio", OS_INTEGER_POSIX_IO_AIO_QUEUE_SIZE, attr };
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+      return os_aio_queue_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
     int
     io::fcntl (int cmd, ...)
     {
@@ -377,11 +811,20 @@ namespace os
       return ret;
     }
 
+    /**
+     * @details
+     * `F_GETFL` and `F_SETFL` are handled here, for all types of
+     * objects; only `O_NONBLOCK` can be changed, and the
+     * implementations check it with `is_nonblocking()` or wait
+     * with `wait_for_io()`. The other commands are passed
+     * to the implementation.
+     */
     int
     io::vfcntl (int cmd, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%d) @%p\n", __func__, cmd, this);
+      trace::printf (trace::posix_io_io,
+                     "io::%s(%d) @%p\n", __func__, cmd, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -398,6 +841,20 @@ namespace os
 
       errno = 0;
 
+      switch (cmd)
+        {
+        case F_GETFL:
+          return impl ().status_flags_;
+
+        case F_SETFL:
+          impl ().status_flags_ = (impl ().status_flags_ & ~O_NONBLOCK)
+              | (va_arg(args, int) & O_NONBLOCK);
+          return 0;
+
+        default:
+          break;
+        }
+
       // Execute the implementation specific code.
       return impl ().do_vfcntl (cmd, args);
     }
@@ -416,7 +873,8 @@ namespace os
     io::fstat (struct stat* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%p) @%p\n", __func__, buf, this);
+      trace::printf (trace::posix_io_io,
+                     "io::%s(%p) @%p\n", __func__, buf, this);
 #endif
 
       if (buf == nullptr)
@@ -447,7 +905,8 @@ namespace os
     io::lseek (off_t offset, int whence)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%d, %d) @%p\n", __func__, offset, whence, this);
+      trace::printf (trace::posix_io_io,
+                     "io::%s(%d, %d) @%p\n", __func__, offset, whence, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -462,19 +921,53 @@ namespace os
       return impl ().do_lseek (offset, whence);
     }
 
+    int
+    io::poll_register (int events, rtos::semaphore* sem)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf (trace::posix_io_io,
+                     "io::%s(0x%X, %p) @%p\n", __func__, events, sem, this);
+#endif
+
+      if (!impl ().do_is_opened ())
+        {
+          // Not opened; the poller then needs no notification.
+          impl ().poll_sem_ = nullptr;
+          return POLLNVAL;
+        }
+
+      return impl ().do_poll_register (events, sem);
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    void
+    io::account_ (bool write, ssize_t nbyte, uint64_t begin)
+    {
+      statistics_.record (write, nbyte, begin);
+
+      if (type_ == type::file)
+        {
+          posix::file* fil = static_cast<posix::file*> (this);
+          fil->file_system ().statistics ().record (write, nbyte, begin);
+        }
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
     // ========================================================================
 
     io_impl::io_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io_impl::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_io, "io_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     io_impl::~io_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_io, "io_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -490,6 +983,44 @@ namespace os
       return true;
     }
 
+    /**
+     * @details
+     * The default implementation reads each segment with
+     * `do_read()`, stopping at the first short read.
+     * Implementations that can scatter natively (for example
+     * via DMA descriptor chains, to which the `iovec` array
+     * maps directly) should override it, to perform a single
+     * transaction.
+     */
+    ssize_t
+    io_impl::do_readv (const struct iovec* iov, int iovcnt)
+    {
+      ssize_t total = 0;
+
+      const struct iovec* p = iov;
+      for (int i = 0; i < iovcnt; ++i, ++p)
+        {
+          ssize_t ret = do_read (p->iov_base, p->iov_len);
+          if (ret < 0)
+            {
+              return (total > 0) ? total : ret;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < p->iov_len)
+            {
+              break;
+            }
+        }
+      return total;
+    }
+
+    /**
+     * @details
+     * The default implementation writes each segment with
+     * `do_write()`, stopping at the first short write.
+     * Implementations that can gather natively should override
+     * it, to perform a single transaction.
+     */
     ssize_t
     io_impl::do_writev (const struct iovec* iov, int iovcnt)
     {
@@ -501,13 +1032,286 @@ namespace os
           ssize_t ret = do_write (p->iov_base, p->iov_len);
           if (ret < 0)
             {
-              return ret;
+              return (total > 0) ? total : ret;
             }
           total += ret;
+          if (static_cast<std::size_t> (ret) < p->iov_len)
+            {
+              break;
+            }
+        }
+      return total;
+    }
+
+    /**
+     * @details
+     * The default implementation copies the data through a small
+     * buffer on the stack, using the public `read()` and `write()`
+     * of the two objects, so each chunk takes their locks in turn.
+     * It stops at the end of _in_ or at a short write.
+     *
+     * Implementations that can take the data directly from
+     * the source, like a network stack that queues file pages for
+     * transmission, should override it; they must also update
+     * the offset of _out_.
+     */
+    ssize_t
+    io_impl::do_sendfile (io& out, io& in, std::size_t count)
+    {
+      uint8_t buf[OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE_BYTES];
+
+      ssize_t total = 0;
+      while (count > 0)
+        {
+          std::size_t n = (count < sizeof(buf)) ? count : sizeof(buf);
+          ssize_t rd = in.read (buf, n);
+          if (rd <= 0)
+            {
+              // End of input or error.
+              return (total > 0 || rd == 0) ? total : rd;
+            }
+
+          ssize_t wr = out.write (buf, static_cast<std::size_t> (rd));
+          if (wr < 0)
+            {
+              return (total > 0) ? total : wr;
+            }
+          total += wr;
+
+          if (wr < rd)
+            {
+              // Give back what was read but not written.
+              in.lseek (wr - rd, SEEK_CUR);
+              break;
+            }
+
+          count -= static_cast<std::size_t> (rd);
+          if (static_cast<std::size_t> (rd) < n)
+            {
+              break;
+            }
         }
       return total;
     }
 
+    /**
+     * @details
+     * Implementations with receive and transmit buffers should
+     * store _sem_ (via this function) **before** checking the
+     * buffers, and call `poll_notify()` whenever data arrives or
+     * space is freed, so that no change is lost between the check
+     * and the wait.
+     *
+     * The default implementation reports the object as always
+     * ready, as POSIX requires for regular files; a `read()` or
+     * `write()` on an object without support then blocks as before.
+     *
+     * A single poller is supported per object; a new
+     * registration replaces the previous one.
+     */
+    int
+    io_impl::do_poll_register (int events, rtos::semaphore* sem)
+    {
+      poll_sem_ = sem;
+
+      int ready = events & (POLLIN | POLLRDNORM | POLLOUT | POLLWRNORM);
+      if (!do_is_connected ())
+        {
+          ready |= POLLHUP;
+        }
+      return ready;
+    }
+
+    void
+    io_impl::poll_notify (void)
+    {
+      rtos::semaphore* const sem = poll_sem_;
+      if (sem != nullptr)
+        {
+          sem->post ();
+        }
+
+      event_poll_entry* const entry = poll_entry_;
+      if (entry != nullptr)
+        {
+          event_poll_impl::notify_ (entry);
+        }
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+    /**
+     * @details
+     * The default implementation runs the request with the
+     * synchronous `read()` on the shared I/O worker. Drivers
+     * with DMA should override it, start the transfer and call
+     * `aio_complete()` from the completion interrupt.
+     */
+    int
+    io_impl::do_aio_read (aiocb* cb)
+    {
+      return aio_post_ (cb);
+    }
+
+    /**
+     * @details
+     * The default implementation runs the request with the
+     * synchronous `write()` on the shared I/O worker.
+     */
+    int
+    io_impl::do_aio_write (aiocb* cb)
+    {
+      return aio_post_ (cb);
+    }
+
+    /**
+     * @details
+     * The result is stored before the status, so that a
+     * caller polling `aio_error()` sees a consistent request;
+     * the callback is invoked last.
+     */
+    void
+    io_impl::aio_complete (aiocb* cb, ssize_t ret, int error)
+    {
+      cb->aio_return_ = ret;
+      cb->aio_error_ = error;
+
+      if (cb->aio_notify != nullptr)
+        {
+          cb->aio_notify (cb);
+        }
+    }
+
+    int
+    io_impl::aio_post_ (aiocb* cb)
+    {
+      rtos::work_queue* wq = io::aio_queue ();
+      if (wq == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      rtos::result_t res = wq->post (aio_run_, cb);
+      if (res != rtos::result::ok)
+        {
+          errno = static_cast<int> (res);
+          return -1;
+        }
+      return 0;
+    }
+
+    void
+    io_impl::aio_run_ (void* args)
+    {
+      aiocb* cb = static_cast<aiocb*> (args);
+      io* const p = cb->aio_io_;
+
+      // Devices that cannot seek ignore the offset.
+      p->lseek (cb->aio_offset, SEEK_SET);
+
+      ssize_t ret;
+      if (cb->aio_write_)
+        {
+          ret = p->write (cb->aio_buf, cb->aio_nbytes);
+        }
+      else
+        {
+          ret = p->read (cb->aio_buf, cb->aio_nbytes);
+        }
+
+      aio_complete (cb, ret, (ret >= 0) ? 0 : ((errno != 0) ? errno : EIO));
+    }
+
+#if defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+    namespace coroutine
+    {
+      // ----------------------------------------------------------------------
+
+      read_awaiter::read_awaiter (class io& io, void* buf, std::size_t nbyte,
+                                  off_t offset) :
+          io_ (io)
+      {
+        cb_.aio_offset = offset;
+        cb_.aio_buf = buf;
+        cb_.aio_nbytes = nbyte;
+        cb_.aio_notify = internal_notify_;
+        cb_.aio_notify_args = this;
+      }
+
+      ssize_t
+      read_awaiter::await_resume (void) noexcept
+      {
+        if (error_ != 0)
+          {
+            // Not queued.
+            errno = error_;
+            return -1;
+          }
+        return aio_return (&cb_);
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      read_awaiter::internal_start_ (void)
+      {
+        if (io_.aio_read (&cb_) < 0)
+          {
+            // Continue at once, with the error.
+            error_ = (errno != 0) ? errno : EIO;
+            return false;
+          }
+        return true;
+      }
+
+      // Possibly from an interrupt, for drivers with DMA.
+      void
+      read_awaiter::internal_notify_ (aiocb* cb)
+      {
+        read_awaiter* aw = static_cast<read_awaiter*> (cb->aio_notify_args);
+        aw->executor_->post (*aw);
+      }
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace coroutine */
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_AIO) */
+
+    /**
+     * @details
+     * With `O_NONBLOCK` set, fail immediately; otherwise wait
+     * for the semaphore, at most for the receive or send timeout,
+     * if set. An expired timeout is reported as `EAGAIN`, as for
+     * the `SO_RCVTIMEO` and `SO_SNDTIMEO` socket options.
+     */
+    int
+    io_impl::wait_for_io (rtos::semaphore& sem, bool write)
+    {
+      if (is_nonblocking ())
+        {
+          errno = EAGAIN;
+          return -1;
+        }
+
+      rtos::clock::duration_t ticks = write ? send_timeout_ : receive_timeout_;
+      rtos::result_t res = (ticks == 0) ? sem.wait () : sem.timed_wait (ticks);
+      if (res != rtos::result::ok)
+        {
+          errno = (res == ETIMEDOUT) ? EAGAIN : static_cast<int> (res);
+          return -1;
+        }
+      return 0;
+    }
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
@@ -534,6 +1338,85 @@ namespace os
 
 #pragma GCC diagnostic pop
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    // ========================================================================
+
+    /**
+     * @details
+     * Errors are counted separately; the bytes and the latency
+     * are accumulated only for the successful operations.
+     */
+    void
+    io_statistics::record (bool write, ssize_t nbyte, uint64_t begin)
+    {
+      uint64_t cycles = rtos::hrclock.now () - begin;
+
+      rtos::interrupts::critical_section ics;
+
+      if (nbyte < 0)
+        {
+          ++errors;
+        }
+      else if (write)
+        {
+          ++writes;
+          written_bytes += static_cast<uint64_t> (nbyte);
+          write_cycles += cycles;
+          if (cycles > write_max_cycles)
+            {
+              write_max_cycles = cycles;
+            }
+        }
+      else
+        {
+          ++reads;
+          read_bytes += static_cast<uint64_t> (nbyte);
+          read_cycles += cycles;
+          if (cycles > read_max_cycles)
+            {
+              read_max_cycles = cycles;
+            }
+        }
+    }
+
+    void
+    io_statistics::snapshot (io_statistics& buf) const
+    {
+      rtos::interrupts::critical_section ics;
+
+      buf = *this;
+    }
+
+    void
+    io_statistics::clear (void)
+    {
+      rtos::interrupts::critical_section ics;
+
+      *this = io_statistics
+        { };
+    }
+
+    void
+    io_statistics::dump (const char* name) const
+    {
+      io_statistics s;
+      snapshot (s);
+
+      trace::printf ("%s: %u reads, %u bytes, %u/%u cycles max/total\n",
+                     name, s.reads, static_cast<unsigned int> (s.read_bytes),
+                     static_cast<unsigned int> (s.read_max_cycles),
+                     static_cast<unsigned int> (s.read_cycles));
+      trace::printf ("%s: %u writes, %u bytes, %u/%u cycles max/total\n",
+                     name, s.writes,
+                     static_cast<unsigned int> (s.written_bytes),
+                     static_cast<unsigned int> (s.write_max_cycles),
+                     static_cast<unsigned int> (s.write_cycles));
+      trace::printf ("%s: %u errors\n", name, s.errors);
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -0,0 +1,157 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/net-interface.h>
+
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    net_interface::net_interface (net_interface_impl& impl, const char* name) :
+        name_ (name), //
+        impl_ (impl)
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_STACK)
+      trace::printf (trace::posix_io_net_stack,
+                     "net_interface::%s(\"%s\")=%p\n", __func__, name_, this);
+#endif
+    }
+
+    /**
+     * @details
+     * The packets still in the rings are freed.
+     */
+    net_interface::~net_interface ()
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_STACK)
+      trace::printf (trace::posix_io_net_stack,
+                     "net_interface::%s(\"%s\") %p\n", __func__, name_, this);
+#endif
+
+      pbuf* p;
+      while (rx_ring_.try_receive (&p))
+        {
+          pbuf::free (p);
+        }
+      while (tx_ring_.try_receive (&p))
+        {
+          pbuf::free (p);
+        }
+    }
+
+    bool
+    net_interface::input (pbuf* chain)
+    {
+      if (!rx_ring_.try_send (chain))
+        {
+          pbuf::free (chain);
+          __atomic_add_fetch (&rx_dropped_, 1, __ATOMIC_RELAXED);
+          return false;
+        }
+      return true;
+    }
+
+    pbuf*
+    net_interface::receive (void)
+    {
+      pbuf* p = nullptr;
+      if (rx_ring_.receive (&p) != rtos::result::ok)
+        {
+          return nullptr;
+        }
+      return p;
+    }
+
+    pbuf*
+    net_interface::try_receive (void)
+    {
+      pbuf* p = nullptr;
+      if (!rx_ring_.try_receive (&p))
+        {
+          return nullptr;
+        }
+      return p;
+    }
+
+    pbuf*
+    net_interface::timed_receive (rtos::clock::duration_t timeout)
+    {
+      pbuf* p = nullptr;
+      if (rx_ring_.timed_receive (&p, timeout) != rtos::result::ok)
+        {
+          return nullptr;
+        }
+      return p;
+    }
+
+    int
+    net_interface::output (pbuf* chain)
+    {
+      if (!tx_ring_.try_send (chain))
+        {
+          errno = ENOBUFS;
+          return -1;
+        }
+
+      impl ().do_start_output (*this);
+      return 0;
+    }
+
+    pbuf*
+    net_interface::next_output (void)
+    {
+      pbuf* p = nullptr;
+      if (!tx_ring_.try_receive (&p))
+        {
+          return nullptr;
+        }
+      return p;
+    }
+
+    // ========================================================================
+
+    net_interface_impl::net_interface_impl (void)
+    {
+      ;
+    }
+
+    net_interface_impl::~net_interface_impl ()
+    {
+      ;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
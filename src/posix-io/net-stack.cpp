@@ -83,7 +83,8 @@ namespace os
         impl_ (impl)
     {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-      trace::printf ("net_stack::%s(\"%s\")=%p\n", __func__, name_, this);
+      trace::printf (trace::posix_io_net_stack,
+                     "net_stack::%s(\"%s\")=%p\n", __func__, name_, this);
 #endif
       deferred_sockets_list_.clear ();
     }
@@ -91,7 +92,8 @@ namespace os
     net_stack::~net_stack ()
     {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-      trace::printf ("net_stack::%s(\"%s\") %p\n", __func__, name_, this);
+      trace::printf (trace::posix_io_net_stack,
+                     "net_stack::%s(\"%s\") %p\n", __func__, name_, this);
 #endif
     }
 
@@ -109,14 +111,16 @@ namespace os
         interface_ (interface)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("net_stack_impl::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_file_system,
+                     "net_stack_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     net_stack_impl::~net_stack_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("net_stack_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_file_system,
+                     "net_stack_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
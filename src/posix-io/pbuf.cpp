@@ -0,0 +1,276 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/pbuf.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    pbuf::pbuf (pbuf_pool& pool) :
+        pool_ (&pool)
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Used by the producers, after filling the payload.
+     */
+    void
+    pbuf::length (std::size_t nbytes)
+    {
+      assert(nbytes <= capacity ());
+      length_ = nbytes;
+    }
+
+    std::size_t
+    pbuf::capacity (void) const
+    {
+      return pool_->payload_size ();
+    }
+
+    std::size_t
+    pbuf::total_length (void) const
+    {
+      std::size_t total = 0;
+      for (const pbuf* p = this; p != nullptr; p = p->next_)
+        {
+          total += p->length_;
+        }
+      return total;
+    }
+
+    std::size_t
+    pbuf::segments (void) const
+    {
+      std::size_t count = 0;
+      for (const pbuf* p = this; p != nullptr; p = p->next_)
+        {
+          ++count;
+        }
+      return count;
+    }
+
+    void
+    pbuf::cat (pbuf* tail)
+    {
+      pbuf* p = this;
+      while (p->next_ != nullptr)
+        {
+          p = p->next_;
+        }
+      p->next_ = tail;
+    }
+
+    /**
+     * @details
+     * Can be invoked from Interrupt Service Routines.
+     */
+    void
+    pbuf::ref (void)
+    {
+      __atomic_add_fetch (&refs_, 1, __ATOMIC_RELAXED);
+    }
+
+    std::size_t
+    pbuf::copy_out (void* buf, std::size_t nbytes, std::size_t offset) const
+    {
+      char* out = static_cast<char*> (buf);
+      std::size_t copied = 0;
+      for (const pbuf* p = this; p != nullptr && copied < nbytes; p = p->next_)
+        {
+          if (offset >= p->length_)
+            {
+              offset -= p->length_;
+              continue;
+            }
+          std::size_t n = p->length_ - offset;
+          if (n > nbytes - copied)
+            {
+              n = nbytes - copied;
+            }
+          std::memcpy (out + copied, static_cast<char*> (p->payload ()) + offset,
+                       n);
+          copied += n;
+          offset = 0;
+        }
+      return copied;
+    }
+
+    std::size_t
+    pbuf::copy_in (const void* buf, std::size_t nbytes, std::size_t offset)
+    {
+      const char* in = static_cast<const char*> (buf);
+      std::size_t copied = 0;
+      for (pbuf* p = this; p != nullptr && copied < nbytes; p = p->next_)
+        {
+          if (offset >= p->length_)
+            {
+              offset -= p->length_;
+              continue;
+            }
+          std::size_t n = p->length_ - offset;
+          if (n > nbytes - copied)
+            {
+              n = nbytes - copied;
+            }
+          std::memcpy (static_cast<char*> (p->payload ()) + offset, in + copied,
+                       n);
+          copied += n;
+          offset = 0;
+        }
+      return copied;
+    }
+
+    /**
+     * @details
+     * Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    pbuf::free (pbuf* chain)
+    {
+      std::size_t count = 0;
+      while (chain != nullptr)
+        {
+          if (__atomic_sub_fetch (&chain->refs_, 1, __ATOMIC_ACQ_REL) != 0)
+            {
+              // Still referred, the rest of the chain too.
+              break;
+            }
+          pbuf* next = chain->next_;
+          chain->pool_->release_ (chain);
+          ++count;
+          chain = next;
+        }
+      return count;
+    }
+
+    // ========================================================================
+
+    pbuf_pool::pbuf_pool (const char* name, std::size_t blocks,
+                          std::size_t payload_size_bytes, void* addr,
+                          std::size_t bytes) :
+        blocks_
+          { name, blocks, compute_block_size_bytes (payload_size_bytes), addr,
+              bytes }, //
+        payload_size_bytes_ (payload_size_bytes)
+    {
+      assert(payload_size_bytes > 0);
+      assert(bytes >= compute_allocated_size_bytes (blocks, payload_size_bytes));
+    }
+
+    pbuf_pool::~pbuf_pool ()
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Can be invoked from Interrupt Service Routines.
+     */
+    pbuf*
+    pbuf_pool::alloc (std::size_t nbytes)
+    {
+      std::size_t count =
+          (nbytes == 0) ?
+              1 : (nbytes + payload_size_bytes_ - 1) / payload_size_bytes_;
+      std::size_t block_size = compute_block_size_bytes (payload_size_bytes_);
+
+      pbuf* head = nullptr;
+      pbuf* last = nullptr;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          if (blocks_.free_chunks () < count)
+            {
+              return nullptr;
+            }
+
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              void* block = blocks_.allocate (block_size);
+              assert(block != nullptr);
+
+              pbuf* p = new (block) pbuf
+                { *this };
+              if (last == nullptr)
+                {
+                  head = p;
+                }
+              else
+                {
+                  last->next_ = p;
+                }
+              last = p;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      for (pbuf* p = head; p != nullptr; p = p->next_)
+        {
+          p->length_ =
+              (nbytes > payload_size_bytes_) ? payload_size_bytes_ : nbytes;
+          nbytes -= p->length_;
+        }
+
+      return head;
+    }
+
+    std::size_t
+    pbuf_pool::free_segments (void)
+    {
+      return blocks_.free_chunks ();
+    }
+
+    void
+    pbuf_pool::release_ (pbuf* p)
+    {
+      p->~pbuf ();
+
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      blocks_.deallocate (p, compute_block_size_bytes (payload_size_bytes_));
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,1040 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/pipe.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * Move up to _len_ bytes between two objects, at least one of
+     * them a pipe end or a FIFO, without crossing a user buffer:
+     * the other object reads directly into, or writes directly
+     * from, the pipe buffer.
+     *
+     * The offset of the object that is not a pipe, if given, is
+     * used instead of its file offset and is advanced by the
+     * number of bytes moved, as with `sendfile()`.
+     *
+     * @retval >0 The number of bytes moved.
+     * @retval 0 The input pipe is empty and has no writers.
+     * @retval -1 Nothing was moved; `errno` is set.
+     */
+    ssize_t
+    splice (io* in, off_t* off_in, io* out, off_t* off_out, std::size_t len,
+            unsigned int flags)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "%s(%p, %p, %p, %p, %u, %u)\n",
+                     __func__, in, off_in, out, off_out, len, flags);
+#endif
+
+      if (in == nullptr || out == nullptr || !in->is_opened ()
+          || !out->is_opened ())
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      if (flags != 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      pipe_buffer* const pin = pipe_buffer::of (*in);
+      pipe_buffer* const pout = pipe_buffer::of (*out);
+      if ((pin == nullptr && pout == nullptr) || pin == pout)
+        {
+          // Neither is a pipe, or both ends of the same pipe.
+          errno = EINVAL;
+          return -1;
+        }
+
+      if ((pin != nullptr && off_in != nullptr)
+          || (pout != nullptr && off_out != nullptr))
+        {
+          errno = ESPIPE;
+          return -1;
+        }
+
+      // The object that is not a pipe, with its optional offset.
+      io* const other = (pin != nullptr) ? out : in;
+      off_t* const offset = (pin != nullptr) ? off_out : off_in;
+      if (pin != nullptr && pout != nullptr)
+        {
+          assert (offset == nullptr);
+        }
+
+      if (offset != nullptr && *offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      errno = 0;
+
+      if (len == 0)
+        {
+          return 0; // Nothing to do.
+        }
+
+      off_t saved = 0;
+      if (offset != nullptr)
+        {
+          saved = other->lseek (0, SEEK_CUR);
+          if (saved < 0 || other->lseek (*offset, SEEK_SET) < 0)
+            {
+              return -1;
+            }
+        }
+
+      ssize_t ret;
+      if (pin != nullptr)
+        {
+          ret = pin->splice_to (in->impl (), *out, len);
+        }
+      else
+        {
+          ret = pout->splice_from (out->impl (), *in, len);
+        }
+
+      if (offset != nullptr)
+        {
+          if (ret > 0)
+            {
+              *offset += ret;
+            }
+
+          // Keep the errno of the transfer.
+          int err = errno;
+          other->lseek (saved, SEEK_SET);
+          errno = err;
+        }
+
+      return ret;
+    }
+
+    // ========================================================================
+
+    /**
+     * @class pipe_buffer
+     * @details
+     * The buffer is protected by a mutex, which is released while
+     * waiting; the readers wait on one semaphore and the writers
+     * on the other. Each change that may unblock the other side
+     * posts its semaphore and notifies the pollers of both ends.
+     */
+
+    pipe_buffer::pipe_buffer (void* storage, std::size_t size) :
+        buffer_
+          { static_cast<uint8_t*> (storage), size, size, 0 }, //
+        mutex_
+          { "pipe" }, //
+        rx_sem_
+          { "pipe-rx", 0 }, //
+        tx_sem_
+          { "pipe-tx", 0 }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe_buffer::%s(%p, %u)=@%p\n",
+                     __func__, storage, size, this);
+#endif
+    }
+
+    pipe_buffer::~pipe_buffer ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe_buffer::%s() @%p\n",
+                     __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The buffer is cleared when the first end is attached, so
+     * a FIFO reopened after all its users closed it starts empty.
+     */
+    void
+    pipe_buffer::attach (io_impl& end, int mode)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      if (readers_ == 0 && writers_ == 0)
+        {
+          buffer_.clear ();
+        }
+
+      if ((mode & O_ACCMODE) != O_WRONLY)
+        {
+          ++readers_;
+        }
+      if ((mode & O_ACCMODE) != O_RDONLY)
+        {
+          ++writers_;
+        }
+
+      for (auto& e : ends_)
+        {
+          if (e == nullptr)
+            {
+              e = &end;
+              break;
+            }
+        }
+    }
+
+    /**
+     * @details
+     * The threads waiting on the other side are woken up, to
+     * see the end of file or the broken pipe.
+     */
+    void
+    pipe_buffer::detach (io_impl& end, int mode)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      if ((mode & O_ACCMODE) != O_WRONLY && readers_ > 0)
+        {
+          --readers_;
+        }
+      if ((mode & O_ACCMODE) != O_RDONLY && writers_ > 0)
+        {
+          --writers_;
+        }
+
+      for (auto& e : ends_)
+        {
+          if (e == &end)
+            {
+              e = nullptr;
+            }
+        }
+
+      notify_ ();
+    }
+
+    /**
+     * @details
+     * Block until some data is available, then return as much as
+     * fits in _buf_, without waiting for more.
+     *
+     * @retval 0 The buffer is empty and there are no writers.
+     */
+    ssize_t
+    pipe_buffer::read (io_impl& end, void* buf, std::size_t nbyte)
+    {
+      std::unique_lock<rtos::mutex> lock
+        { mutex_ };
+
+      int ret = wait_data_ (end, lock);
+      if (ret <= 0)
+        {
+          return ret;
+        }
+
+      std::size_t count = buffer_.pop_front (static_cast<uint8_t*> (buf),
+                                             nbyte);
+      notify_ ();
+
+      return static_cast<ssize_t> (count);
+    }
+
+    /**
+     * @details
+     * Block until all bytes are written. If all readers close
+     * the pipe meanwhile, or if a non-blocking or timed write
+     * cannot continue, the number of bytes already written is
+     * returned; if none, -1 with `errno` set to `EPIPE`, `EAGAIN`
+     * or `ETIMEDOUT`.
+     */
+    ssize_t
+    pipe_buffer::write (io_impl& end, const void* buf, std::size_t nbyte)
+    {
+      std::unique_lock<rtos::mutex> lock
+        { mutex_ };
+
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+      std::size_t total = 0;
+      while (total < nbyte)
+        {
+          int ret = wait_space_ (end, lock);
+          if (ret < 0)
+            {
+              return (total > 0) ? static_cast<ssize_t> (total) : -1;
+            }
+
+          total += buffer_.push_back (p + total, nbyte - total);
+          notify_ ();
+        }
+
+      return static_cast<ssize_t> (total);
+    }
+
+    /**
+     * @details
+     * Write the buffered data straight from the buffer memory to
+     * _out_, in at most two contiguous chunks. Only the data
+     * available after the first wait is moved.
+     */
+    ssize_t
+    pipe_buffer::splice_to (io_impl& end, io& out, std::size_t count)
+    {
+      std::unique_lock<rtos::mutex> lock
+        { mutex_ };
+
+      int ret = wait_data_ (end, lock);
+      if (ret <= 0)
+        {
+          return ret;
+        }
+
+      ssize_t total = 0;
+      while (count > 0 && !buffer_.empty ())
+        {
+          uint8_t* chunk;
+          std::size_t n = buffer_.front_contiguous_buffer (&chunk);
+          if (n > count)
+            {
+              n = count;
+            }
+
+          ssize_t wr = out.write (chunk, n);
+          if (wr < 0)
+            {
+              break;
+            }
+
+          buffer_.advance_front (static_cast<std::size_t> (wr));
+          total += wr;
+          count -= static_cast<std::size_t> (wr);
+
+          if (static_cast<std::size_t> (wr) < n)
+            {
+              break;
+            }
+        }
+
+      notify_ ();
+
+      return (total > 0) ? total : -1;
+    }
+
+    /**
+     * @details
+     * Read from _in_ straight into the free space of the buffer,
+     * in at most two contiguous chunks. Only the space available
+     * after the first wait is filled.
+     *
+     * @retval 0 The end of _in_ was reached.
+     */
+    ssize_t
+    pipe_buffer::splice_from (io_impl& end, io& in, std::size_t count)
+    {
+      std::unique_lock<rtos::mutex> lock
+        { mutex_ };
+
+      int ret = wait_space_ (end, lock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ssize_t total = 0;
+      while (count > 0 && !buffer_.full ())
+        {
+          uint8_t* chunk;
+          std::size_t n = buffer_.back_contiguous_buffer (&chunk);
+          if (n > count)
+            {
+              n = count;
+            }
+
+          ssize_t rd = in.read (chunk, n);
+          if (rd < 0)
+            {
+              if (total == 0)
+                {
+                  total = -1;
+                }
+              break;
+            }
+
+          buffer_.advance_back (static_cast<std::size_t> (rd));
+          total += rd;
+          count -= static_cast<std::size_t> (rd);
+
+          if (static_cast<std::size_t> (rd) < n)
+            {
+              // End of input or short read.
+              break;
+            }
+        }
+
+      notify_ ();
+
+      return total;
+    }
+
+    /**
+     * @details
+     * The read side is ready when data is buffered, and reports
+     * `POLLHUP` when empty and without writers. The write side is
+     * ready when space is available, and reports `POLLERR` when
+     * there are no readers.
+     */
+    int
+    pipe_buffer::poll (int events, int mode)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      int ready = 0;
+      if ((mode & O_ACCMODE) != O_WRONLY)
+        {
+          if (!buffer_.empty ())
+            {
+              ready |= POLLIN | POLLRDNORM;
+            }
+          else if (writers_ == 0)
+            {
+              ready |= POLLHUP;
+            }
+        }
+      if ((mode & O_ACCMODE) != O_RDONLY)
+        {
+          if (readers_ == 0)
+            {
+              ready |= POLLERR;
+            }
+          else if (!buffer_.full ())
+            {
+              ready |= POLLOUT | POLLWRNORM;
+            }
+        }
+
+      return ready & (events | POLLHUP | POLLERR);
+    }
+
+    /**
+     * @details
+     * The buffer of a pipe end is the buffer of its pipe; the
+     * buffer of a FIFO is its own.
+     */
+    pipe_buffer*
+    pipe_buffer::of (io& obj)
+    {
+      io::type_t t = obj.get_type ();
+      if ((t & io::type::pipe) == 0)
+        {
+          return nullptr;
+        }
+
+      if ((t & io::type::char_device) != 0)
+        {
+          return &static_cast<fifo&> (obj).impl ().buffer ();
+        }
+      return &static_cast<pipe_end&> (obj).impl ().buffer ();
+    }
+
+    std::size_t
+    pipe_buffer::length (void) const
+    {
+      std::lock_guard<rtos::mutex> lock
+        { const_cast<rtos::mutex&> (mutex_) };
+
+      return buffer_.length ();
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    pipe_buffer::wait_data_ (io_impl& end, std::unique_lock<rtos::mutex>& lock)
+    {
+      while (buffer_.empty ())
+        {
+          if (writers_ == 0)
+            {
+              return 0; // End of file.
+            }
+
+          lock.unlock ();
+          int ret = end.wait_for_io (rx_sem_, false);
+          lock.lock ();
+
+          if (ret < 0 && buffer_.empty ())
+            {
+              return -1;
+            }
+        }
+      return 1;
+    }
+
+    int
+    pipe_buffer::wait_space_ (io_impl& end, std::unique_lock<rtos::mutex>& lock)
+    {
+      while (true)
+        {
+          if (readers_ == 0)
+            {
+              errno = EPIPE;
+              return -1;
+            }
+
+          if (!buffer_.full ())
+            {
+              return 0;
+            }
+
+          lock.unlock ();
+          int ret = end.wait_for_io (tx_sem_, true);
+          lock.lock ();
+
+          if (ret < 0 && buffer_.full ())
+            {
+              return -1;
+            }
+        }
+    }
+
+    void
+    pipe_buffer::notify_ (void)
+    {
+      if (!buffer_.empty () || writers_ == 0)
+        {
+          rx_sem_.post ();
+        }
+      if (!buffer_.full () || readers_ == 0)
+        {
+          tx_sem_.post ();
+        }
+
+      for (auto e : ends_)
+        {
+          if (e != nullptr)
+            {
+              e->poll_notify ();
+            }
+        }
+    }
+
+    // ========================================================================
+
+    pipe_impl::pipe_impl (pipe_buffer& buffer, int mode) :
+        buffer_ (buffer), //
+        mode_ (mode)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe_impl::%s(%d)=@%p\n",
+                     __func__, mode, this);
+#endif
+    }
+
+    pipe_impl::~pipe_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe_impl::%s() @%p\n", __func__,
+                     this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    bool
+    pipe_impl::do_is_opened (void)
+    {
+      return opened_;
+    }
+
+    ssize_t
+    pipe_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      if (mode_ != O_RDONLY)
+        {
+          errno = EBADF; // Not the read end.
+          return -1;
+        }
+
+      return buffer_.read (*this, buf, nbyte);
+    }
+
+    ssize_t
+    pipe_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+      if (mode_ != O_WRONLY)
+        {
+          errno = EBADF; // Not the write end.
+          return -1;
+        }
+
+      return buffer_.write (*this, buf, nbyte);
+    }
+
+    /**
+     * @details
+     * A `sendfile()` to the write end reads _in_ straight into
+     * the pipe buffer.
+     */
+    ssize_t
+    pipe_impl::do_sendfile (io& out, io& in, std::size_t count)
+    {
+      if (mode_ != O_WRONLY)
+        {
+          errno = EBADF; // Not the write end.
+          return -1;
+        }
+
+      if (pipe_buffer::of (in) == &buffer_)
+        {
+          errno = EINVAL; // From the same pipe.
+          return -1;
+        }
+
+      (void) out;
+      return buffer_.splice_from (*this, in, count);
+    }
+
+    int
+    pipe_impl::do_fstat (struct stat* buf)
+    {
+      std::memset (buf, 0, sizeof(*buf));
+      buf->st_mode = S_IFIFO | 0666;
+      buf->st_size = static_cast<off_t> (buffer_.length ());
+
+      return 0;
+    }
+
+    off_t
+    pipe_impl::do_lseek (off_t offset __attribute__((unused)),
+                         int whence __attribute__((unused)))
+    {
+      errno = ESPIPE;
+      return -1;
+    }
+
+    int
+    pipe_impl::do_close (void)
+    {
+      buffer_.detach (*this, mode_);
+      opened_ = false;
+
+      return 0;
+    }
+
+    int
+    pipe_impl::do_poll_register (int events, rtos::semaphore* sem)
+    {
+      poll_sem_ = sem;
+
+      return buffer_.poll (events, mode_);
+    }
+
+    // ========================================================================
+
+    pipe_end::pipe_end (class pipe& owner, pipe_buffer& buffer, int mode) :
+        io
+          { impl_instance_, type::pipe }, //
+        owner_ (owner), //
+        impl_instance_
+          { buffer, mode }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe_end::%s(%d)=@%p\n", __func__,
+                     mode, this);
+#endif
+    }
+
+    pipe_end::~pipe_end ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe_end::%s() @%p\n", __func__,
+                     this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    pipe_end::close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe_end::%s() @%p\n", __func__,
+                     this);
+#endif
+
+      int ret = io::close ();
+      if (ret == 0)
+        {
+          owner_.closed_ ();
+        }
+
+      return ret;
+    }
+
+    // ========================================================================
+
+    pipe* pipe::deferred_list__;
+
+    pipe::pipe (void* storage, std::size_t size) :
+        buffer_
+          { storage, size }, //
+        read_end_
+          { *this, buffer_, O_RDONLY }, //
+        write_end_
+          { *this, buffer_, O_WRONLY }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe::%s(%p, %u)=@%p\n", __func__,
+                     storage, size, this);
+#endif
+    }
+
+    pipe::~pipe ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe::%s() @%p\n", __func__, this);
+#endif
+
+      if (resource_ != nullptr)
+        {
+          resource_->deallocate (storage_, size_, 1);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The pipe and its buffer are allocated from the default
+     * memory resource, and deallocated when both ends are closed.
+     * Pipes closed since the previous call are deallocated first,
+     * since `close()` cannot delete the object it runs on.
+     */
+    pipe*
+    pipe::create (int fildes[2], std::size_t size)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe::%s(%p, %u)\n", __func__,
+                     fildes, size);
+#endif
+
+      if (fildes == nullptr)
+        {
+          errno = EFAULT;
+          return nullptr;
+        }
+
+      if (size == 0)
+        {
+          errno = EINVAL;
+          return nullptr;
+        }
+
+      deallocate_deferred_ ();
+
+      rtos::memory::memory_resource* const res =
+          rtos::memory::get_default_resource ();
+      void* const storage = res->allocate (size, 1);
+      if (storage == nullptr)
+        {
+          errno = ENOMEM;
+          return nullptr;
+        }
+
+      auto* const p = new (std::nothrow) pipe
+        { storage, size };
+      if (p == nullptr)
+        {
+          res->deallocate (storage, size, 1);
+          errno = ENOMEM;
+          return nullptr;
+        }
+      p->resource_ = res;
+      p->storage_ = storage;
+      p->size_ = size;
+
+      if (p->open (fildes) < 0)
+        {
+          int err = errno;
+          delete p;
+          errno = err;
+          return nullptr;
+        }
+      return p;
+    }
+
+    /**
+     * @details
+     * Both ends get file descriptors; `fildes[0]` is the read end
+     * and `fildes[1]` the write end.
+     */
+    int
+    pipe::open (int fildes[2])
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "pipe::%s(%p) @%p\n", __func__,
+                     fildes, this);
+#endif
+
+      if (fildes == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (read_end_.impl ().opened_ || write_end_.impl ().opened_)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      errno = 0;
+
+      for (pipe_end* end :
+        { &read_end_, &write_end_ })
+        {
+          pipe_impl& im = end->impl ();
+          im.opened_ = true;
+          im.status_flags_ = im.mode_;
+          buffer_.attach (im, im.mode_);
+
+          if (end->alloc_file_descriptor () == nullptr)
+            {
+              if (end == &write_end_)
+                {
+                  int err = errno;
+                  read_end_.io::close ();
+                  errno = err;
+                }
+              return -1;
+            }
+        }
+
+      fildes[0] = read_end_.file_descriptor ();
+      fildes[1] = write_end_.file_descriptor ();
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    void
+    pipe::closed_ (void)
+    {
+      if (resource_ == nullptr || read_end_.impl ().opened_
+          || write_end_.impl ().opened_)
+        {
+          return;
+        }
+
+      // ----- Enter critical section -----------------------------------------
+      rtos::scheduler::critical_section scs;
+
+      // Deallocated on the next create().
+      deferred_next_ = deferred_list__;
+      deferred_list__ = this;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    void
+    pipe::deallocate_deferred_ (void)
+    {
+      pipe* list;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          list = deferred_list__;
+          deferred_list__ = nullptr;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      while (list != nullptr)
+        {
+          pipe* const next = list->deferred_next_;
+          delete list;
+          list = next;
+        }
+    }
+
+    // ========================================================================
+
+    fifo::fifo (const char* name, void* storage, std::size_t size) :
+        char_device_implementable
+          { name, storage, size }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "fifo::%s(\"%s\")=@%p\n", __func__,
+                     name_, this);
+#endif
+
+      type_ |= type::pipe;
+    }
+
+    fifo::~fifo ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "fifo::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ========================================================================
+
+    /**
+     * @class fifo_impl
+     * @details
+     * The device has a single descriptor for all its users, so
+     * both sides are attached when it is opened and detached
+     * when the last user closes it; while opened, reads wait for
+     * data and writes wait for space, without end of file or
+     * broken pipe.
+     */
+
+    fifo_impl::fifo_impl (void* storage, std::size_t size) :
+        buffer_
+          { storage, size }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "fifo_impl::%s(%p, %u)=@%p\n",
+                     __func__, storage, size, this);
+#endif
+    }
+
+    fifo_impl::~fifo_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf (trace::posix_io_pipe, "fifo_impl::%s() @%p\n", __func__,
+                     this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    fifo_impl::do_vopen (const char* path __attribute__((unused)),
+                         int oflag __attribute__((unused)),
+                         std::va_list args __attribute__((unused)))
+    {
+      buffer_.attach (*this, O_RDWR);
+
+      return 0;
+    }
+
+    ssize_t
+    fifo_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      return buffer_.read (*this, buf, nbyte);
+    }
+
+    ssize_t
+    fifo_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+      return buffer_.write (*this, buf, nbyte);
+    }
+
+    ssize_t
+    fifo_impl::do_sendfile (io& out, io& in, std::size_t count)
+    {
+      if (pipe_buffer::of (in) == &buffer_)
+        {
+          errno = EINVAL; // From the same FIFO.
+          return -1;
+        }
+
+      (void) out;
+      return buffer_.splice_from (*this, in, count);
+    }
+
+    int
+    fifo_impl::do_fstat (struct stat* buf)
+    {
+      std::memset (buf, 0, sizeof(*buf));
+      buf->st_mode = S_IFIFO | 0666;
+      buf->st_size = static_cast<off_t> (buffer_.length ());
+
+      return 0;
+    }
+
+    off_t
+    fifo_impl::do_lseek (off_t offset __attribute__((unused)),
+                         int whence __attribute__((unused)))
+    {
+      errno = ESPIPE;
+      return -1;
+    }
+
+    int
+    fifo_impl::do_vioctl (int request __attribute__((unused)),
+                          std::va_list args __attribute__((unused)))
+    {
+      errno = ENOSYS; // Not implemented.
+      return -1;
+    }
+
+    void
+    fifo_impl::do_sync (void)
+    {
+      ;
+    }
+
+    int
+    fifo_impl::do_close (void)
+    {
+      buffer_.detach (*this, O_RDWR);
+
+      return 0;
+    }
+
+    int
+    fifo_impl::do_poll_register (int events, rtos::semaphore* sem)
+    {
+      poll_sem_ = sem;
+
+      return buffer_.poll (events, O_RDWR);
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
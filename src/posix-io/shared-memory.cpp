@@ -0,0 +1,714 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/shared-memory.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      using registry_list = utils::intrusive_list<shared_memory,
+      utils::double_list_links, &shared_memory::registry_links_>;
+
+      // Since objects may be constructed statically, so may ask to be
+      // linked here at any time, the list must be in the BSS.
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#endif
+      registry_list registry_list__;
+#pragma GCC diagnostic pop
+
+      // Names are "/name", with a single slash.
+      bool
+      valid_name (const char* name)
+      {
+        return (name != nullptr) && (name[0] == '/') && (name[1] != '\0')
+            && (std::strchr (name + 1, '/') == nullptr);
+      }
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    shared_memory* shared_memory::deferred_list__;
+
+    shared_memory::shared_memory (const char* name,
+                                  rtos::memory::memory_resource* resource) :
+        io
+          { impl_instance_, type::shared_memory }, //
+        name_ (name), //
+        resource_ (resource)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s(\"%s\", %p)=@%p\n", __func__, name_,
+                     resource_, this);
+#endif
+
+      assert(name != nullptr);
+
+      registry_list__.link (*this);
+      linked_ = true;
+    }
+
+    shared_memory::~shared_memory ()
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s() @%p\n", __func__, this);
+#endif
+
+      registry_links_.unlink ();
+
+      shared_memory_impl& im = impl ();
+      if (im.region_ != nullptr)
+        {
+          resource_->deallocate (im.region_, im.size_,
+                                 rtos::memory::memory_resource::max_align);
+        }
+
+      if (allocated_)
+        {
+          delete[] name_;
+        }
+      name_ = nullptr;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * With `O_CREAT`, an object not found is created, with an
+     * empty region from the default memory resource; with
+     * `O_CREAT | O_EXCL` the object must not exist. With `O_RDWR`,
+     * `O_TRUNC` sets the size of the region to 0.
+     *
+     * The objects created and later unlinked, closed and unmapped
+     * are deallocated by the next `open()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    shared_memory*
+    shared_memory::open (const char* name, int oflag)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s(\"%s\", 0x%X)\n", __func__,
+                     name ? name : "", oflag);
+#endif
+
+      int acc = oflag & O_ACCMODE;
+      if (!valid_name (name) || (acc != O_RDONLY && acc != O_RDWR))
+        {
+          errno = EINVAL;
+          return nullptr;
+        }
+
+      deallocate_deferred_ ();
+
+      errno = 0;
+
+      bool created = false;
+      shared_memory* shm = identify (name);
+      if (shm != nullptr)
+        {
+          if ((oflag & (O_CREAT | O_EXCL)) == (O_CREAT | O_EXCL))
+            {
+              errno = EEXIST;
+              return nullptr;
+            }
+        }
+      else
+        {
+          if ((oflag & O_CREAT) == 0)
+            {
+              errno = ENOENT;
+              return nullptr;
+            }
+
+          std::size_t len = std::strlen (name + 1);
+          char* str = new (std::nothrow) char[len + 1];
+          if (str == nullptr)
+            {
+              errno = ENOMEM;
+              return nullptr;
+            }
+          std::memcpy (str, name + 1, len + 1);
+
+          shm = new (std::nothrow) shared_memory
+            { str };
+          if (shm == nullptr)
+            {
+              delete[] str;
+              errno = ENOMEM;
+              return nullptr;
+            }
+          shm->allocated_ = true;
+          created = true;
+        }
+
+      if (shm->open_ (oflag) < 0)
+        {
+          if (created)
+            {
+              int err = errno;
+              delete shm;
+              errno = err;
+            }
+          return nullptr;
+        }
+
+      if ((oflag & O_TRUNC) != 0 && acc == O_RDWR && shm->ftruncate (0) < 0)
+        {
+          int err = errno;
+          shm->close ();
+          errno = err;
+          return nullptr;
+        }
+
+      return shm;
+    }
+
+    /**
+     * @details
+     * The object can no longer be opened by name; the region is
+     * freed when the object is no longer opened or mapped.
+     */
+    int
+    shared_memory::unlink (const char* name)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s(\"%s\")\n", __func__,
+                     name ? name : "");
+#endif
+
+      if (!valid_name (name))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      shared_memory* shm = identify (name);
+      if (shm == nullptr)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      errno = 0;
+
+      // Stays in the list, for unmap(), until deallocated.
+      shm->linked_ = false;
+
+      shm->release_ ();
+
+      return 0;
+    }
+
+    shared_memory*
+    shared_memory::identify (const char* name)
+    {
+      if (!valid_name (name))
+        {
+          return nullptr;
+        }
+
+      for (auto&& p : registry_list__)
+        {
+          if (p.linked_ && std::strcmp (name + 1, p.name_) == 0)
+            {
+              return &p;
+            }
+        }
+      return nullptr;
+    }
+
+    /**
+     * @details
+     * Unlinked objects are also searched, since they remain mapped
+     * after the name is removed.
+     */
+    shared_memory*
+    shared_memory::identify_mapping (const void* addr)
+    {
+      const uint8_t* const p = static_cast<const uint8_t*> (addr);
+      for (auto&& shm : registry_list__)
+        {
+          const shared_memory_impl& im = shm.impl ();
+          if (shm.mappings_ > 0 && p >= im.region_
+              && p < im.region_ + im.size_)
+            {
+              return &shm;
+            }
+        }
+      return nullptr;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The file descriptor is closed by the last user; the region
+     * stays allocated while the object is registered or mapped.
+     */
+    int
+    shared_memory::close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s() @%p\n", __func__, this);
+#endif
+
+      shared_memory_impl& im = impl ();
+      if (im.open_count_ == 0)
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      int ret = 0;
+      if (im.open_count_ == 1)
+        {
+          ret = io::close ();
+        }
+      // Must be after close(), to keep do_is_open() true.
+      --im.open_count_;
+
+      release_ ();
+
+      return ret;
+    }
+
+    /**
+     * @details
+     * The content is preserved up to the smaller of the two sizes;
+     * the new bytes are 0. Since the region is moved, it cannot be
+     * resized while mapped.
+     */
+    int
+    shared_memory::ftruncate (off_t length)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s(%u) @%p\n", __func__, length, this);
+#endif
+
+      shared_memory_impl& im = impl ();
+      if (!im.do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if ((im.status_flags_ & O_ACCMODE) != O_RDWR || length < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      errno = 0;
+
+      std::size_t size = static_cast<std::size_t> (length);
+      if (size == im.size_)
+        {
+          return 0;
+        }
+
+      if (mappings_ > 0)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      if (resource_ == nullptr)
+        {
+          resource_ = rtos::memory::get_default_resource ();
+        }
+
+      uint8_t* region = nullptr;
+      if (size > 0)
+        {
+          region = static_cast<uint8_t*> (resource_->allocate (
+              size, rtos::memory::memory_resource::max_align));
+          if (region == nullptr)
+            {
+              errno = ENOMEM;
+              return -1;
+            }
+
+          std::size_t keep = (size < im.size_) ? size : im.size_;
+          if (keep > 0)
+            {
+              std::memcpy (region, im.region_, keep);
+            }
+          std::memset (region + keep, 0, size - keep);
+        }
+
+      if (im.region_ != nullptr)
+        {
+          resource_->deallocate (im.region_, im.size_,
+                                 rtos::memory::memory_resource::max_align);
+        }
+      im.region_ = region;
+      im.size_ = size;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * All mappings of an object share the same memory; the returned
+     * pointer remains valid until `unmap()`, even if the object is
+     * closed or unlinked meanwhile.
+     *
+     * `os_posix_shm_protect_hook()` is called with the address and
+     * the access rights of the new mapping.
+     */
+    void*
+    shared_memory::map (std::size_t length, int prot, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s(%u, 0x%X, %u) @%p\n", __func__,
+                     length, prot, offset, this);
+#endif
+
+      shared_memory_impl& im = impl ();
+      if (!im.do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return nullptr;
+        }
+
+      if (length == 0 || offset < 0)
+        {
+          errno = EINVAL;
+          return nullptr;
+        }
+
+      if ((prot & PROT_WRITE) != 0 && (im.status_flags_ & O_ACCMODE) != O_RDWR)
+        {
+          errno = EACCES;
+          return nullptr;
+        }
+
+      if (static_cast<std::size_t> (offset) > im.size_
+          || length > im.size_ - static_cast<std::size_t> (offset))
+        {
+          errno = ENXIO;
+          return nullptr;
+        }
+
+      errno = 0;
+
+      void* addr = im.region_ + offset;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          ++mappings_;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      os_posix_shm_protect_hook (addr, length, prot);
+
+      return addr;
+    }
+
+    /**
+     * @details
+     * `os_posix_shm_protect_hook()` is called with `PROT_NONE`, to
+     * revoke the access rights of the mapping.
+     */
+    int
+    shared_memory::unmap (void* addr, std::size_t length)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory::%s(%p, %u) @%p\n", __func__, addr,
+                     length, this);
+#endif
+
+      shared_memory_impl& im = impl ();
+      uint8_t* p = static_cast<uint8_t*> (addr);
+      if (mappings_ == 0 || length == 0 || p < im.region_
+          || p >= im.region_ + im.size_
+          || length > static_cast<std::size_t> (im.region_ + im.size_ - p))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      errno = 0;
+
+      os_posix_shm_protect_hook (addr, length, PROT_NONE);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          --mappings_;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      release_ ();
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    shared_memory::open_ (int oflag)
+    {
+      shared_memory_impl& im = impl ();
+      if (im.open_count_ == 0)
+        {
+          im.status_flags_ = oflag & (O_ACCMODE | O_NONBLOCK);
+          im.offset_ = 0;
+
+          if (alloc_file_descriptor () == nullptr)
+            {
+              return -1;
+            }
+        }
+      else if ((oflag & O_ACCMODE) == O_RDWR)
+        {
+          // The shared descriptor gets the widest access.
+          im.status_flags_ = (im.status_flags_ & ~O_ACCMODE) | O_RDWR;
+        }
+      ++im.open_count_;
+
+      return 0;
+    }
+
+    void
+    shared_memory::release_ (void)
+    {
+      shared_memory_impl& im = impl ();
+      if (linked_ || im.open_count_ > 0 || mappings_ > 0)
+        {
+          return;
+        }
+
+      if (im.region_ != nullptr)
+        {
+          resource_->deallocate (im.region_, im.size_,
+                                 rtos::memory::memory_resource::max_align);
+          im.region_ = nullptr;
+          im.size_ = 0;
+        }
+
+      if (allocated_)
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          // Deallocated on the next open(), since close() and unmap()
+          // cannot delete the object they run on.
+          deferred_next_ = deferred_list__;
+          deferred_list__ = this;
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    void
+    shared_memory::deallocate_deferred_ (void)
+    {
+      shared_memory* list;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          list = deferred_list__;
+          deferred_list__ = nullptr;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      while (list != nullptr)
+        {
+          shared_memory* const next = list->deferred_next_;
+          delete list;
+          list = next;
+        }
+    }
+
+    // ========================================================================
+
+    shared_memory_impl::shared_memory_impl (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory_impl::%s()=@%p\n", __func__, this);
+#endif
+    }
+
+    shared_memory_impl::~shared_memory_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_SHARED_MEMORY)
+      trace::printf (trace::posix_io_shared_memory,
+                     "shared_memory_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    bool
+    shared_memory_impl::do_is_opened (void)
+    {
+      return (open_count_ > 0);
+    }
+
+    ssize_t
+    shared_memory_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      std::size_t pos = static_cast<std::size_t> (offset_);
+      if (pos >= size_)
+        {
+          return 0; // End of file.
+        }
+
+      std::size_t n = (nbyte < size_ - pos) ? nbyte : size_ - pos;
+      std::memcpy (buf, region_ + pos, n);
+
+      return static_cast<ssize_t> (n);
+    }
+
+    /**
+     * @details
+     * The region does not grow; use `ftruncate()` to resize it.
+     */
+    ssize_t
+    shared_memory_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+      std::size_t pos = static_cast<std::size_t> (offset_);
+      if (pos >= size_)
+        {
+          errno = ENOSPC;
+          return -1;
+        }
+
+      std::size_t n = (nbyte < size_ - pos) ? nbyte : size_ - pos;
+      std::memcpy (region_ + pos, buf, n);
+
+      return static_cast<ssize_t> (n);
+    }
+
+    int
+    shared_memory_impl::do_fstat (struct stat* buf)
+    {
+      std::memset (buf, 0, sizeof(*buf));
+      buf->st_mode = S_IFREG | 0666;
+      buf->st_size = static_cast<off_t> (size_);
+
+      return 0;
+    }
+
+    off_t
+    shared_memory_impl::do_lseek (off_t offset, int whence)
+    {
+      off_t tmp;
+      switch (whence)
+        {
+        case SEEK_SET:
+          tmp = offset;
+          break;
+
+        case SEEK_CUR:
+          tmp = offset_ + offset;
+          break;
+
+        case SEEK_END:
+          tmp = static_cast<off_t> (size_) + offset;
+          break;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (tmp < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      offset_ = tmp;
+      return offset_;
+    }
+
+    int
+    shared_memory_impl::do_close (void)
+    {
+      return 0;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @details
+ * The default implementation does nothing; all threads can access
+ * all mappings.
+ */
+void
+__attribute__((weak))
+os_posix_shm_protect_hook (void* addr __attribute__((unused)),
+                           size_t len __attribute__((unused)),
+                           int prot __attribute__((unused)))
+{
+  ;
+}
+
+// ----------------------------------------------------------------------------
@@ -26,10 +26,13 @@
  */
 
 #include <cerrno>
+#include <sys/time.h>
 #include <cmsis-plus/posix/sys/socket.h>
 #include <cmsis-plus/posix-io/net-stack.h>
 
 #include <cmsis-plus/posix-io/socket.h>
+#include <cmsis-plus/posix-io/pbuf.h>
+#include <cmsis-plus/rtos/os.h>
 
 // ----------------------------------------------------------------------------
 
@@ -45,14 +48,16 @@ namespace os
         net_stack_ (&ns)
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket::%s()=@%p\n", __func__, this);
+      trace::printf (trace::posix_io_socket,
+                     "socket::%s()=@%p\n", __func__, this);
 #endif
     }
 
     socket::~socket ()
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_socket,
+                     "socket::%s() @%p\n", __func__, this);
 #endif
 
       net_stack_ = nullptr;
@@ -111,12 +116,39 @@ namespace os
       return impl ().do_getsockname (address, address_len);
     }
 
+    /**
+     * @details
+     * `SO_RCVTIMEO` and `SO_SNDTIMEO` are handled here and
+     * returned with the SysTick resolution.
+     */
     int
     socket::getsockopt (int level, int option_name, void* option_value,
                         socklen_t* option_len)
     {
       errno = 0;
 
+      if (level == SOL_SOCKET
+          && (option_name == SO_RCVTIMEO || option_name == SO_SNDTIMEO))
+        {
+          if (option_value == nullptr || option_len == nullptr
+              || *option_len < sizeof(struct timeval))
+            {
+              errno = EINVAL;
+              return -1;
+            }
+
+          uint64_t microsec = static_cast<uint64_t> (
+              (option_name == SO_RCVTIMEO) ?
+                  impl ().receive_timeout () : impl ().send_timeout ())
+              * 1000000ul / rtos::clock_systick::frequency_hz;
+
+          auto* tv = static_cast<struct timeval*> (option_value);
+          tv->tv_sec = static_cast<time_t> (microsec / 1000000ul);
+          tv->tv_usec = static_cast<suseconds_t> (microsec % 1000000ul);
+          *option_len = sizeof(struct timeval);
+          return 0;
+        }
+
       // Execute the implementation specific code.
       return impl ().do_getsockopt (level, option_name, option_value,
                                     option_len);
@@ -136,8 +168,15 @@ namespace os
     {
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_recv (buffer, length, flags);
+      account_ (false, ret, begin);
+      return ret;
+#else
       // Execute the implementation specific code.
       return impl ().do_recv (buffer, length, flags);
+#endif
     }
 
     ssize_t
@@ -146,8 +185,15 @@ namespace os
     {
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_recvfrom (buffer, length, flags, address, address_len);
+      account_ (false, ret, begin);
+      return ret;
+#else
       // Execute the implementation specific code.
       return impl ().do_recvfrom (buffer, length, flags, address, address_len);
+#endif
     }
 
     ssize_t
@@ -155,8 +201,15 @@ namespace os
     {
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_recvmsg (message, flags);
+      account_ (false, ret, begin);
+      return ret;
+#else
       // Execute the implementation specific code.
       return impl ().do_recvmsg (message, flags);
+#endif
     }
 
     ssize_t
@@ -164,8 +217,15 @@ namespace os
     {
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_send (buffer, length, flags);
+      account_ (true, ret, begin);
+      return ret;
+#else
       // Execute the implementation specific code.
       return impl ().do_send (buffer, length, flags);
+#endif
     }
 
     ssize_t
@@ -173,8 +233,15 @@ namespace os
     {
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_sendmsg (message, flags);
+      account_ (true, ret, begin);
+      return ret;
+#else
       // Execute the implementation specific code.
       return impl ().do_sendmsg (message, flags);
+#endif
     }
 
     ssize_t
@@ -183,16 +250,59 @@ namespace os
     {
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_sendto (message, length, flags, dest_addr, dest_len);
+      account_ (true, ret, begin);
+      return ret;
+#else
       // Execute the implementation specific code.
       return impl ().do_sendto (message, length, flags, dest_addr, dest_len);
+#endif
     }
 
+    /**
+     * @details
+     * `SO_RCVTIMEO` and `SO_SNDTIMEO` are handled here, for all
+     * stacks, which then wait with `wait_for_io()`; the timeouts
+     * are rounded up to SysTick ticks.
+     */
     int
     socket::setsockopt (int level, int option_name, const void* option_value,
                         socklen_t option_len)
     {
       errno = 0;
 
+      if (level == SOL_SOCKET
+          && (option_name == SO_RCVTIMEO || option_name == SO_SNDTIMEO))
+        {
+          if (option_value == nullptr || option_len < sizeof(struct timeval))
+            {
+              errno = EINVAL;
+              return -1;
+            }
+
+          auto* tv = static_cast<const struct timeval*> (option_value);
+          if (tv->tv_sec < 0 || tv->tv_usec < 0 || tv->tv_usec >= 1000000)
+            {
+              errno = EDOM;
+              return -1;
+            }
+
+          rtos::clock::duration_t ticks = rtos::clock_systick::ticks_cast (
+              static_cast<uint64_t> (tv->tv_sec) * 1000000ul
+                  + static_cast<uint64_t> (tv->tv_usec));
+          if (option_name == SO_RCVTIMEO)
+            {
+              impl ().receive_timeout (ticks);
+            }
+          else
+            {
+              impl ().send_timeout (ticks);
+            }
+          return 0;
+        }
+
       // Execute the implementation specific code.
       return impl ().do_setsockopt (level, option_name, option_value,
                                     option_len);
@@ -215,22 +325,296 @@ namespace os
       // Execute the implementation specific code.
       return impl ().do_sockatmark ();
     }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    namespace
+    {
+      ssize_t
+      batch_bytes_ (const struct mmsghdr* vmessages, int count)
+      {
+        if (count < 0)
+          {
+            return count;
+          }
+        ssize_t total = 0;
+        for (int i = 0; i < count; ++i)
+          {
+            total += vmessages[i].msg_len;
+          }
+        return total;
+      }
+    } /* namespace */
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+    /**
+     * @details
+     * The whole batch is passed to the implementation in a single
+     * call, so the stacks that can dequeue several datagrams at once
+     * pay the per call overhead only once; the statistics account
+     * the batch as a single read.
+     */
+    int
+    socket::recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                      struct timespec* timeout)
+    {
+      errno = 0;
+
+      if (vmessages == nullptr && vlen != 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      int ret = impl ().do_recvmmsg (vmessages, vlen, flags, timeout);
+      account_ (false, batch_bytes_ (vmessages, ret), begin);
+      return ret;
+#else
+      // Execute the implementation specific code.
+      return impl ().do_recvmmsg (vmessages, vlen, flags, timeout);
+#endif
+    }
+
+    /**
+     * @details
+     * The whole batch is passed to the implementation in a single
+     * call; the statistics account the batch as a single write.
+     */
+    int
+    socket::sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags)
+    {
+      errno = 0;
+
+      if (vmessages == nullptr && vlen != 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      int ret = impl ().do_sendmmsg (vmessages, vlen, flags);
+      account_ (true, batch_bytes_ (vmessages, ret), begin);
+      return ret;
+#else
+      // Execute the implementation specific code.
+      return impl ().do_sendmmsg (vmessages, vlen, flags);
+#endif
+    }
+
+    /**
+     * @details
+     * The buffers come from the network interface receive ring,
+     * so the application reads the payload in place, as written
+     * by the driver.
+     */
+    ssize_t
+    socket::recv_pbuf (pbuf** chain, int flags)
+    {
+      errno = 0;
+
+      if (chain == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+      *chain = nullptr;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_recv_pbuf (chain, flags);
+      account_ (false, ret, begin);
+      return ret;
+#else
+      // Execute the implementation specific code.
+      return impl ().do_recv_pbuf (chain, flags);
+#endif
+    }
+
+    /**
+     * @details
+     * The buffers are passed to the network interface transmit
+     * ring, so the driver reads the payload in place, as written
+     * by the application.
+     */
+    ssize_t
+    socket::send_pbuf (pbuf* chain, int flags)
+    {
+      errno = 0;
+
+      if (chain == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      uint64_t begin = rtos::hrclock.now ();
+      ssize_t ret = impl ().do_send_pbuf (chain, flags);
+      account_ (true, ret, begin);
+      return ret;
+#else
+      // Execute the implementation specific code.
+      return impl ().do_send_pbuf (chain, flags);
+#endif
+    }
     // ========================================================================
 
     socket_impl::socket_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket_impl::%s()=%p\n", __func__, this);
+      trace::printf (trace::posix_io_socket,
+                     "socket_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     socket_impl::~socket_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_socket,
+                     "socket_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
+    /**
+     * @details
+     * The default implementation fails with `ENOSYS`; the stacks
+     * that keep the received data in packet buffers should
+     * override it.
+     */
+    ssize_t
+    socket_impl::do_recv_pbuf (pbuf** chain __attribute__((unused)),
+                               int flags __attribute__((unused)))
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    /**
+     * @details
+     * The default implementation sends the segments one by one
+     * with `do_send()`, then releases the chain; the stacks that
+     * keep the data in packet buffers should override it,
+     * to queue the chain itself.
+     */
+    ssize_t
+    socket_impl::do_send_pbuf (pbuf* chain, int flags)
+    {
+      ssize_t total = 0;
+      for (pbuf* p = chain; p != nullptr; p = p->next ())
+        {
+          if (p->length () == 0)
+            {
+              continue;
+            }
+          ssize_t ret = do_send (p->payload (), p->length (), flags);
+          if (ret < 0)
+            {
+              if (total == 0)
+                {
+                  // Nothing sent, the caller keeps the chain.
+                  return -1;
+                }
+              break;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < p->length ())
+            {
+              break;
+            }
+        }
+
+      pbuf::free (chain);
+      return total;
+    }
+
+    /**
+     * @details
+     * The default implementation receives the messages one by one
+     * with `do_recvmsg()`; the stacks able to dequeue several
+     * datagrams at once should override it.
+     *
+     * As on GNU/Linux, the loop stops at the first error, which is
+     * reported only if no message was received, `MSG_WAITFORONE`
+     * turns on `MSG_DONTWAIT` after the first message, and the
+     * timeout is checked only after each message.
+     */
+    int
+    socket_impl::do_recvmmsg (struct mmsghdr* vmessages, unsigned int vlen,
+                              int flags, struct timespec* timeout)
+    {
+      rtos::clock::timestamp_t deadline = 0;
+      if (timeout != nullptr)
+        {
+          deadline = rtos::sysclock.now ()
+              + static_cast<rtos::clock::duration_t> (
+                  timeout->tv_sec * rtos::clock_systick::frequency_hz
+                      + (timeout->tv_nsec * rtos::clock_systick::frequency_hz
+                          + 999999999L) / 1000000000L);
+        }
+
+      int msg_flags = flags & ~MSG_WAITFORONE;
+      unsigned int count = 0;
+      for (; count < vlen; ++count)
+        {
+          ssize_t ret = do_recvmsg (&vmessages[count].msg_hdr, msg_flags);
+          if (ret < 0)
+            {
+              break;
+            }
+          vmessages[count].msg_len = static_cast<unsigned int> (ret);
+
+          if ((flags & MSG_WAITFORONE) != 0)
+            {
+              msg_flags |= MSG_DONTWAIT;
+            }
+          if (timeout != nullptr && rtos::sysclock.now () >= deadline)
+            {
+              ++count;
+              break;
+            }
+        }
+
+      if (count == 0 && vlen != 0)
+        {
+          return -1;
+        }
+      errno = 0;
+      return static_cast<int> (count);
+    }
+
+    /**
+     * @details
+     * The default implementation sends the messages one by one
+     * with `do_sendmsg()`, stopping at the first error, which is
+     * reported only if no message was sent.
+     */
+    int
+    socket_impl::do_sendmmsg (struct mmsghdr* vmessages, unsigned int vlen,
+                              int flags)
+    {
+      unsigned int count = 0;
+      for (; count < vlen; ++count)
+        {
+          ssize_t ret = do_sendmsg (&vmessages[count].msg_hdr, flags);
+          if (ret < 0)
+            {
+              break;
+            }
+          vmessages[count].msg_len = static_cast<unsigned int> (ret);
+        }
+
+      if (count == 0 && vlen != 0)
+        {
+          return -1;
+        }
+      errno = 0;
+      return static_cast<int> (count);
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
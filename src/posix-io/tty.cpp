@@ -43,14 +43,16 @@ namespace os
     {
       type_ |= type::tty;
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty::%s(\"%s\")=@%p\n", __func__, name_, this);
+      trace::printf (trace::posix_io_tty,
+                     "tty::%s(\"%s\")=@%p\n", __func__, name_, this);
 #endif
     }
 
     tty::~tty () noexcept
     {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty::%s() @%p %s\n", __func__, this, name_);
+      trace::printf (trace::posix_io_tty,
+                     "tty::%s() @%p %s\n", __func__, this, name_);
 #endif
     }
 
@@ -68,10 +70,27 @@ namespace os
       return impl ().do_tcgetattr (ptio);
     }
 
-    inline int
+    /**
+     * @details
+     * In non-canonical mode, with `VMIN` zero and `VTIME` not zero,
+     * `VTIME` (in tenths of a second) becomes the receive timeout
+     * used by `wait_for_io()`; otherwise the reads wait forever.
+     */
+    int
     tty::tcsetattr (int options, const struct termios *ptio)
     {
-      return impl ().do_tcsetattr (options, ptio);
+      int ret = impl ().do_tcsetattr (options, ptio);
+      if (ret == 0 && ptio != nullptr)
+        {
+          rtos::clock::duration_t ticks = 0;
+          if ((ptio->c_lflag & ICANON) == 0 && ptio->c_cc[VMIN] == 0)
+            {
+              ticks = rtos::clock_systick::ticks_cast (
+                  static_cast<uint32_t> (ptio->c_cc[VTIME]) * 100000u);
+            }
+          impl ().receive_timeout (ticks);
+        }
+      return ret;
     }
 
     inline int
@@ -91,14 +110,16 @@ namespace os
     tty_impl::tty_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty_impl::%s()=@%p\n", __func__, this);
+      trace::printf (trace::posix_io_tty,
+                     "tty_impl::%s()=@%p\n", __func__, this);
 #endif
     }
 
     tty_impl::~tty_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty_impl::%s() @%p\n", __func__, this);
+      trace::printf (trace::posix_io_tty,
+                     "tty_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -0,0 +1,259 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+#if defined(OS_INCLUDE_RTOS_EVENTS)
+
+#if defined(OS_USE_RTOS_EVENTS_SEGGER_SYSTEMVIEW)
+#include <cmsis_device.h>
+#include "SEGGER_SYSVIEW.h"
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_RTOS_EVENTS_SEGGER_SYSTEMVIEW)
+
+extern os::rtos::thread* os_idle_thread;
+
+/**
+ * @details
+ * Used by SystemView when the configuration does not read the
+ * DWT cycle counter directly; the `hrclock` counts the same
+ * input clock cycles.
+ */
+extern "C" U32 __attribute__((weak))
+SEGGER_SYSVIEW_X_GetTimestamp (void)
+{
+  return static_cast<U32> (os::rtos::hrclock.now ());
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace events
+    {
+      // ----------------------------------------------------------------------
+
+#if defined(OS_USE_RTOS_EVENTS_SEGGER_SYSTEMVIEW)
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        enum
+        {
+          event_wait = 0, //
+          event_post = 1, //
+          event_tick = 2, //
+          events_count
+        };
+
+        SEGGER_SYSVIEW_MODULE module_ =
+          {
+            "M=uOS++,"
+            "0 wait obj=%p thread=%p,"
+            "1 post obj=%p thread=%p,"
+            "2 tick", //
+            events_count, //
+            0, //
+            nullptr, //
+            nullptr //
+          };
+
+        inline U32
+        id (const void* p)
+        {
+          return static_cast<U32> (reinterpret_cast<uintptr_t> (p));
+        }
+
+        U64
+        get_time (void)
+        {
+          // Microseconds since startup.
+          return static_cast<U64> (sysclock.now ())
+              * (1000000u / clock_systick::frequency_hz);
+        }
+
+        void
+        send_threads (thread::threads_list& list)
+        {
+          for (auto& th : list)
+            {
+              SEGGER_SYSVIEW_TASKINFO info;
+              info.TaskID = id (&th);
+              info.sName = th.name ();
+              info.Prio = th.priority ();
+              info.StackBase = id (th.stack ().bottom ());
+              info.StackSize = static_cast<U32> (th.stack ().size ());
+              SEGGER_SYSVIEW_SendTaskInfo (&info);
+
+              send_threads (scheduler::children_threads (&th));
+            }
+        }
+
+        void
+        send_task_list (void)
+        {
+          send_threads (scheduler::children_threads (nullptr));
+        }
+
+        const SEGGER_SYSVIEW_OS_API os_api_ =
+          { get_time, send_task_list };
+      }
+
+      /**
+       * @endcond
+       */
+
+      void
+      initialize (void)
+      {
+        SEGGER_SYSVIEW_Init (hrclock.input_clock_frequency_hz (),
+                             SystemCoreClock, &os_api_, nullptr);
+        SEGGER_SYSVIEW_RegisterModule (&module_);
+      }
+
+      void
+      thread_switched (thread* from, thread* to)
+      {
+        thread::state_t state = from->state ();
+        if (state != thread::state::ready && state != thread::state::running)
+          {
+            SEGGER_SYSVIEW_OnTaskStopReady (id (from), 0);
+          }
+        if (to == os_idle_thread)
+          {
+            SEGGER_SYSVIEW_OnIdle ();
+          }
+        else
+          {
+            SEGGER_SYSVIEW_OnTaskStartExec (id (to));
+          }
+      }
+
+      void
+      thread_ready (thread* th)
+      {
+        SEGGER_SYSVIEW_OnTaskStartReady (id (th));
+      }
+
+      void
+      object_wait (const void* object, thread* th)
+      {
+        SEGGER_SYSVIEW_RecordU32x2 (module_.EventOffset + event_wait,
+                                    id (object), id (th));
+      }
+
+      void
+      object_post (const void* object, thread* th)
+      {
+        SEGGER_SYSVIEW_RecordU32x2 (module_.EventOffset + event_post,
+                                    id (object), id (th));
+      }
+
+      void
+      isr_enter (void)
+      {
+        SEGGER_SYSVIEW_RecordEnterISR ();
+      }
+
+      void
+      isr_exit (void)
+      {
+        SEGGER_SYSVIEW_RecordExitISR ();
+      }
+
+      void
+      clock_tick (void)
+      {
+        SEGGER_SYSVIEW_RecordVoid (module_.EventOffset + event_tick);
+      }
+
+#else
+
+      void __attribute__((weak))
+      initialize (void)
+      {
+      }
+
+      void __attribute__((weak))
+      thread_switched (thread* from __attribute__((unused)),
+                       thread* to __attribute__((unused)))
+      {
+      }
+
+      void __attribute__((weak))
+      thread_ready (thread* th __attribute__((unused)))
+      {
+      }
+
+      void __attribute__((weak))
+      object_wait (const void* object __attribute__((unused)),
+                   thread* th __attribute__((unused)))
+      {
+      }
+
+      void __attribute__((weak))
+      object_post (const void* object __attribute__((unused)),
+                   thread* th __attribute__((unused)))
+      {
+      }
+
+      void __attribute__((weak))
+      isr_enter (void)
+      {
+      }
+
+      void __attribute__((weak))
+      isr_exit (void)
+      {
+      }
+
+      void __attribute__((weak))
+      clock_tick (void)
+      {
+      }
+
+#endif /* defined(OS_USE_RTOS_EVENTS_SEGGER_SYSTEMVIEW) */
+
+    // ------------------------------------------------------------------------
+    } /* namespace events */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_EVENTS) */
+
+// ----------------------------------------------------------------------------
@@ -47,7 +47,46 @@ namespace os
 
       // ======================================================================
 
-      void
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @details
+       * Within the same priority, the earliest deadline first
+       * threads are ordered by absolute deadline; the fixed priority
+       * threads have the maximum deadline, so they stay behind.
+       * Equal deadlines keep the FIFO order.
+       */
+      inline static bool
+      earlier_deadline_ (thread* th, thread* other)
+      {
+        return th->deadline () < other->deadline ();
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if !defined(OS_USE_RTOS_READY_THREADS_BITMAP)
+
+      /**
+       * @details
+       * True if the thread must run before the other one.
+       */
+      inline static bool
+      precedes_ (thread* th, thread* other)
+      {
+        thread::priority_t prio = th->priority ();
+        thread::priority_t other_prio = other->priority ();
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        if (prio == other_prio)
+          {
+            return earlier_deadline_ (th, other);
+          }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        return prio > other_prio;
+      }
+
+      void OS_ATTRIBUTE_HOT_PATH
       ready_threads_list::link (waiting_thread_node& node)
       {
         if (head_.prev () == nullptr)
@@ -56,7 +95,9 @@ namespace os
             clear ();
           }
 
+#if defined(OS_TRACE_RTOS_LISTS)
         thread::priority_t prio = node.thread_->priority ();
+#endif
 
         waiting_thread_node* after =
             static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (tail ()));
@@ -68,7 +109,7 @@ namespace os
             trace::printf ("ready %s() empty +%u\n", __func__, prio);
 #endif
           }
-        else if (prio <= after->thread_->priority ())
+        else if (!precedes_ (node.thread_, after->thread_))
           {
             // Insert at the end of the list.
 #if defined(OS_TRACE_RTOS_LISTS)
@@ -76,7 +117,7 @@ namespace os
                            after->thread_->priority (), prio);
 #endif
           }
-        else if (prio > head ()->thread_->priority ())
+        else if (precedes_ (node.thread_, head ()->thread_))
           {
             // Insert at the beginning of the list.
             after =
@@ -91,7 +132,7 @@ namespace os
             // Insert in the middle of the list.
             // The loop is guaranteed to terminate, and not hit the head.
             // The weight is relatively small, priority() is not heavy.
-            while (prio > after->thread_->priority ())
+            while (precedes_ (node.thread_, after->thread_))
               {
                 after =
                     static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (after->prev ()));
@@ -105,13 +146,19 @@ namespace os
         insert_after (node, after);
 
         node.thread_->state_ = thread::state::ready;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+        node.thread_->statistics_.internal_mark_ready_ ();
+#endif
+
+        events::thread_ready (node.thread_);
       }
 
       /**
        * @details
        * Must be called in a critical section.
        */
-      thread*
+      thread* OS_ATTRIBUTE_HOT_PATH
       ready_threads_list::unlink_head (void)
       {
         assert (!empty ());
@@ -131,9 +178,167 @@ namespace os
         // running, it is saver to do it here.
 
         th->state_ = thread::state::running;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+        th->statistics_.internal_mark_running_ ();
+#endif
         return th;
       }
 
+#else
+
+      static_assert(ready_threads_list::levels == (1u << (8 * sizeof(thread::priority_t))),
+          "ready_threads_list::levels must cover all priorities");
+
+      void
+      ready_threads_list::level_list::link (waiting_thread_node& node)
+      {
+        if (uninitialized ())
+          {
+            // If this is the first time, initialise the list to empty.
+            clear ();
+          }
+
+        // Insert at the end of the list, threads with the same
+        // priority are resumed in FIFO order.
+        utils::static_double_list_links* after =
+            const_cast<utils::static_double_list_links *> (tail ());
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        // Earlier deadlines go before the later ones.
+        while (after != &head_
+            && earlier_deadline_ (
+                node.thread_,
+                static_cast<waiting_thread_node*> (after)->thread_))
+          {
+            after =
+                const_cast<utils::static_double_list_links *> (after->prev ());
+          }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        insert_after (node, after);
+      }
+
+      /**
+       * @details
+       * Must be called in a critical section.
+       */
+      void OS_ATTRIBUTE_HOT_PATH
+      ready_threads_list::link (waiting_thread_node& node)
+      {
+        thread::priority_t prio = node.thread_->priority ();
+
+#if defined(OS_TRACE_RTOS_LISTS)
+        trace::printf ("ready %s() +%u\n", __func__, prio);
+#endif
+
+        lists_[prio].link (node);
+
+        map_[prio / bits_] |= (1u << (prio % bits_));
+        groups_ |= (1u << (prio / bits_));
+
+        node.thread_->state_ = thread::state::ready;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+        node.thread_->statistics_.internal_mark_ready_ ();
+#endif
+
+        events::thread_ready (node.thread_);
+      }
+
+      /**
+       * @details
+       * Nodes may be removed from the level lists directly,
+       * via `waiting_thread_node::unlink()`, without updating
+       * the bitmap; such stale bits are skipped here and cleared
+       * lazily in unlink_head().
+       */
+      volatile waiting_thread_node*
+      ready_threads_list::head (void) const
+      {
+        uint32_t groups = groups_;
+        while (groups != 0)
+          {
+            std::size_t group = top_bit_ (groups);
+            uint32_t map = map_[group];
+            while (map != 0)
+              {
+                std::size_t bit = top_bit_ (map);
+                const level_list& lst = lists_[group * bits_ + bit];
+                if (!lst.empty ())
+                  {
+                    return static_cast<volatile waiting_thread_node*> (lst.head ());
+                  }
+                map &= ~(1u << bit);
+              }
+            groups &= ~(1u << group);
+          }
+        return nullptr;
+      }
+
+      void
+      ready_threads_list::clear_level_ (std::size_t prio)
+      {
+        map_[prio / bits_] &= ~(1u << (prio % bits_));
+        if (map_[prio / bits_] == 0)
+          {
+            groups_ &= ~(1u << (prio / bits_));
+          }
+      }
+
+      /**
+       * @details
+       * Must be called in a critical section.
+       */
+      thread* OS_ATTRIBUTE_HOT_PATH
+      ready_threads_list::unlink_head (void)
+      {
+        for (;;)
+          {
+            assert (groups_ != 0);
+
+            std::size_t group = top_bit_ (groups_);
+            std::size_t prio = group * bits_ + top_bit_ (map_[group]);
+
+            level_list& lst = lists_[prio];
+            if (lst.empty ())
+              {
+                // Stale bit, the node was unlinked directly.
+                clear_level_ (prio);
+                continue;
+              }
+
+            waiting_thread_node* node =
+                static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (lst.head ()));
+            thread* th = node->thread_;
+
+#if defined(OS_TRACE_RTOS_LISTS)
+            trace::printf ("ready %s() %p %s\n", __func__, th, th->name ());
+#endif
+
+            node->unlink ();
+            if (lst.empty ())
+              {
+                clear_level_ (prio);
+              }
+
+            assert (th != nullptr);
+
+            // Unlinking is immediately followed by a context switch,
+            // so in order to guarantee that the thread is marked as
+            // running, it is saver to do it here.
+
+            th->state_ = thread::state::running;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+            th->statistics_.internal_mark_running_ ();
+#endif
+            return th;
+          }
+      }
+
+#endif /* !defined(OS_USE_RTOS_READY_THREADS_BITMAP) */
+
       // ======================================================================
 
       /**
@@ -228,6 +433,8 @@ namespace os
           }
 
         insert_after (node, after);
+
+        events::object_wait (this, node.thread_);
       }
 
       /**
@@ -235,7 +442,7 @@ namespace os
        * Atomically get the top thread from the list, remove the node
        * and wake-up the thread.
        */
-      bool
+      bool OS_ATTRIBUTE_HOT_PATH
       waiting_threads_list::resume_one (void)
       {
         thread* th;
@@ -253,6 +460,8 @@ namespace os
             // so that subsequent wakeups to address different threads.
             th = head ()->thread_;
             const_cast<waiting_thread_node*> (head ())->unlink ();
+
+            events::object_post (this, th);
             // ----- Exit critical section ------------------------------------
           }
         assert (th != nullptr);
@@ -272,11 +481,138 @@ namespace os
         return true;
       }
 
+      /**
+       * @details
+       * All waiting threads are moved to the ready list inside a
+       * single critical section, and the scheduler is invoked only
+       * once at the end, not after each thread.
+       */
       void
       waiting_threads_list::resume_all (void)
       {
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+
         while (resume_one ())
           ;
+
+#else
+
+        // Don't call this from high priority interrupts.
+        assert (port::interrupts::is_priority_valid ());
+
+        bool resumed = false;
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            while (!empty ())
+              {
+                thread* th = head ()->thread_;
+                const_cast<waiting_thread_node*> (head ())->unlink ();
+                assert (th != nullptr);
+
+                events::object_post (this, th);
+
+                if (th->state () == thread::state::destroyed)
+                  {
+#if defined(OS_TRACE_RTOS_LISTS)
+                    trace::printf ("%s() gone \n", __func__);
+#endif
+                    continue;
+                  }
+
+#if defined(OS_TRACE_RTOS_THREAD_CONTEXT)
+                trace::printf ("%s() @%p %s %u\n", __func__, th, th->name (),
+                               th->prio_assigned_);
+#endif
+                // If the thread is not already in the ready list, enqueue it.
+                if (th->ready_node_.next () == nullptr)
+                  {
+                    scheduler::ready_threads_list_.link (th->ready_node_);
+                    // state::ready set in above link().
+                  }
+                resumed = true;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        if (resumed)
+          {
+            scheduler::internal_request_reschedule ();
+          }
+
+#endif /* defined(OS_USE_RTOS_PORT_SCHEDULER) */
+      }
+
+      /**
+       * @details
+       * The filter is called inside the critical section, so it
+       * sees a stable list and must be short; the accepted threads
+       * are moved to the ready list and the scheduler is invoked
+       * once at the end, as in `resume_all()`.
+       */
+      void
+      waiting_threads_list::resume_if (
+          bool
+          (*filter) (waiting_thread_node& node, void* arg),
+          void* arg)
+      {
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        // The port resumes the threads one by one; wake them all,
+        // each one checks its own condition.
+        (void) filter;
+        (void) arg;
+        resume_all ();
+
+#else
+
+        // Don't call this from high priority interrupts.
+        assert (port::interrupts::is_priority_valid ());
+
+        bool resumed = false;
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (empty ())
+              {
+                return;
+              }
+
+            auto* node = static_cast<waiting_thread_node*> (head_.next ());
+            while (node != static_cast<waiting_thread_node*> (&head_))
+              {
+                // Unlinking clears the links, advance before.
+                auto* next = static_cast<waiting_thread_node*> (node->next ());
+
+                if (filter (*node, arg))
+                  {
+                    thread* th = node->thread_;
+                    node->unlink ();
+                    assert (th != nullptr);
+
+                    events::object_post (this, th);
+
+                    if (th->state () != thread::state::destroyed
+                        && th->ready_node_.next () == nullptr)
+                      {
+                        scheduler::ready_threads_list_.link (th->ready_node_);
+                        // state::ready set in above link().
+                      }
+                    resumed = true;
+                  }
+                node = next;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        if (resumed)
+          {
+            scheduler::internal_request_reschedule ();
+          }
+
+#endif /* defined(OS_USE_RTOS_PORT_SCHEDULER) */
       }
 
       // ======================================================================
@@ -317,7 +653,7 @@ namespace os
       }
 
       // Must be called in a critical section.
-      void
+      void OS_ATTRIBUTE_HOT_PATH
       timeout_thread_node::action (void)
       {
         rtos::thread* th = &this->thread;
@@ -326,7 +662,13 @@ namespace os
         thread::state_t state = th->state ();
         if (state != thread::state::destroyed)
           {
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
             th->resume ();
+#else
+            // The reschedule is requested by check_timestamp(),
+            // once for all nodes expired together.
+            th->internal_make_ready_ ();
+#endif
           }
       }
 
@@ -366,6 +708,8 @@ namespace os
 
       // ======================================================================
 
+#if !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL)
+
       /**
        * @details
        * The list is kept in ascending time stamp order.
@@ -438,12 +782,19 @@ namespace os
 
       /**
        * @details
-       * With the list ordered, check if the list head time stamp was
-       * reached and run the node action.
+       * With the list ordered, the nodes with overdue time stamps
+       * are all at the beginning; find the last one, detach them
+       * from the list in one step and run their actions, in order.
        *
-       * Repeat for all nodes that have overdue time stamps.
+       * The detached nodes are chained to a local head, so that
+       * each action can unlink its node as usual. Periodic timers
+       * may be linked back with time stamps still overdue, so the
+       * list head is checked again after the batch.
+       *
+       * The threads are only made ready; a single reschedule is
+       * requested at the end, if any node expired.
        */
-      void
+      void OS_ATTRIBUTE_HOT_PATH
       clock_timestamps_list::check_timestamp (clock::timestamp_t now)
       {
         if (head_.next () == nullptr)
@@ -452,34 +803,436 @@ namespace os
             return;
           }
 
-        // Multiple threads can wait for the same time stamp, so
-        // iterate until a node with future time stamp is identified.
+        std::size_t expired = 0;
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            while (!empty () && now >= head ()->timestamp)
+              {
+                utils::static_double_list_links* first = head_.next ();
+                utils::static_double_list_links* last = first;
+                ++expired;
+                while (last->next () != &head_
+                    && now
+                        >= static_cast<timestamp_node*> (last->next ())->timestamp)
+                  {
+                    last = last->next ();
+                    ++expired;
+                  }
+
+                // Detach the overdue nodes.
+                head_.next (last->next ());
+                last->next ()->prev (&head_);
+
+                utils::static_double_list_links batch;
+                batch.next (first);
+                batch.prev (last);
+                first->prev (&batch);
+                last->next (&batch);
+
+#if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
+                trace::printf ("%s() %u \n", __func__,
+                    static_cast<uint32_t> (sysclock.now ()));
+#endif
+                while (batch.next () != &batch)
+                  {
+                    static_cast<timestamp_node*> (batch.next ())->action ();
+                  }
+              }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+            if (expired > max_expired_)
+              {
+                max_expired_ = expired;
+              }
+#endif
+            // ----- Exit critical section ------------------------------------
+          }
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+        if (expired != 0)
+          {
+            scheduler::internal_request_reschedule ();
+          }
+#endif
+      }
+
+#else
+
+      void
+      clock_timestamps_list::slot_list::link (timestamp_node& node)
+      {
+        if (uninitialized ())
+          {
+            // If this is the first time, initialise the list to empty.
+            clear ();
+          }
+
+        insert_after (node,
+                      const_cast<utils::static_double_list_links *> (tail ()));
+      }
+
+      timestamp_node*
+      clock_timestamps_list::slot_list::earliest (void) const
+      {
+        if (empty ())
+          {
+            return nullptr;
+          }
+
+        timestamp_node* res =
+            static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (head ()));
+        for (utils::static_double_list_links* p = res->next (); p != &head_;
+            p = p->next ())
+          {
+            timestamp_node* node = static_cast<timestamp_node*> (p);
+            if (node->timestamp < res->timestamp)
+              {
+                res = node;
+              }
+          }
+        return res;
+      }
+
+      /**
+       * @details
+       * The wheel is selected by the highest group of `slot_bits`
+       * bits where the time stamp differs from the current time,
+       * and the slot by the time stamp bits in that group; thus the
+       * nodes in a lower wheel always expire before the nodes in
+       * a higher wheel, and the first wheel slots have exact
+       * time stamps.
+       *
+       * Time stamps already in the past are placed in the
+       * current slot.
+       *
+       * Must be called in a critical section.
+       */
+      void
+      clock_timestamps_list::place_ (timestamp_node& node)
+      {
+        port::clock::timestamp_t ts =
+            (node.timestamp > now_) ? node.timestamp : now_;
+        port::clock::timestamp_t diff = ts ^ now_;
+
+        for (std::size_t level = 0; level < levels; ++level)
+          {
+            if ((diff >> (slot_bits * (level + 1))) == 0)
+              {
+                std::size_t slot = static_cast<std::size_t> (ts
+                    >> (slot_bits * level)) & mask_;
+                slots_[level][slot].link (node);
+                maps_[level] |= (1u << slot);
+                return;
+              }
+          }
+
+        overflow_.link (node);
+      }
+
+      /**
+       * @details
+       * The nodes are first moved to a temporary list, since
+       * some of them may return to the same list.
+       */
+      void
+      clock_timestamps_list::replace_ (slot_list& lst)
+      {
+        if (lst.empty ())
+          {
+            return;
+          }
+
+        slot_list tmp;
+        tmp.clear ();
+
+        while (!lst.empty ())
+          {
+            timestamp_node* node =
+                static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (lst.head ()));
+            node->unlink ();
+            tmp.link (*node);
+          }
+
+        while (!tmp.empty ())
+          {
+            timestamp_node* node =
+                static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (tmp.head ()));
+            node->unlink ();
+            place_ (*node);
+          }
+      }
+
+      /**
+       * @details
+       * When the current time enters a new slot of a higher wheel,
+       * its nodes are distributed to the lower wheels, starting
+       * with the highest wheel that turned.
+       */
+      void
+      clock_timestamps_list::cascade_ (void)
+      {
+        for (std::size_t level = levels; level > 0; --level)
+          {
+            port::clock::timestamp_t turn =
+                (static_cast<port::clock::timestamp_t> (1)
+                    << (slot_bits * level)) - 1;
+            if ((now_ & turn) != 0)
+              {
+                continue;
+              }
+
+            if (level == levels)
+              {
+                replace_ (overflow_);
+              }
+            else
+              {
+                std::size_t slot = static_cast<std::size_t> (now_
+                    >> (slot_bits * level)) & mask_;
+                maps_[level] &= ~(1u << slot);
+                replace_ (slots_[level][slot]);
+              }
+          }
+      }
+
+      /**
+       * @details
+       * Since the nodes in lower wheels expire first, the
+       * first non empty slot after the current one, in the lowest
+       * wheel, gives the next moment when something must be done:
+       * either run the nodes, or move them to the lower wheels.
+       *
+       * Nodes may be removed from the slots directly,
+       * via `timestamp_node::unlink()`, without updating the maps;
+       * such stale bits are cleared here.
+       *
+       * @return The time stamp, or the largest value if
+       *  there are no nodes.
+       */
+      port::clock::timestamp_t
+      clock_timestamps_list::next_event_ (void)
+      {
+        for (std::size_t level = 0; level < levels; ++level)
+          {
+            std::size_t crt = static_cast<std::size_t> (now_
+                >> (slot_bits * level)) & mask_;
+
+            // Only the slots after the current one.
+            uint32_t map = maps_[level] & ~((2u << crt) - 1);
+            while (map != 0)
+              {
+                std::size_t slot = first_bit_ (map);
+                if (!slots_[level][slot].empty ())
+                  {
+                    std::size_t shift = slot_bits * (level + 1);
+                    return ((now_ >> shift) << shift)
+                        | (static_cast<port::clock::timestamp_t> (slot)
+                            << (slot_bits * level));
+                  }
+
+                // Stale bit, the node was unlinked directly.
+                maps_[level] &= ~(1u << slot);
+                map &= ~(1u << slot);
+              }
+          }
+
+        if (!overflow_.empty ())
+          {
+            std::size_t shift = slot_bits * levels;
+            return ((now_ >> shift) + 1) << shift;
+          }
+
+        return static_cast<port::clock::timestamp_t> (-1);
+      }
+
+      /**
+       * @details
+       * If the time went backwards (an adjustable clock was set
+       * to an earlier moment), all nodes are placed again,
+       * relative to the new time. This is the only operation
+       * that depends on the number of nodes.
+       */
+      void
+      clock_timestamps_list::rewind_ (port::clock::timestamp_t now)
+      {
+#if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
+        trace::printf ("clock %s() %u -> %u\n", __func__,
+            static_cast<uint32_t> (now_), static_cast<uint32_t> (now));
+#endif
+
+        slot_list tmp;
+        tmp.clear ();
+
+        for (std::size_t level = 0; level < levels; ++level)
+          {
+            for (std::size_t slot = 0; slot < slots; ++slot)
+              {
+                slot_list& lst = slots_[level][slot];
+                while (!lst.empty ())
+                  {
+                    timestamp_node* node =
+                        static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (lst.head ()));
+                    node->unlink ();
+                    tmp.link (*node);
+                  }
+              }
+            maps_[level] = 0;
+          }
+
+        now_ = now;
+        replace_ (overflow_);
+
+        while (!tmp.empty ())
+          {
+            timestamp_node* node =
+                static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (tmp.head ()));
+            node->unlink ();
+            place_ (*node);
+          }
+      }
+
+      /**
+       * @details
+       * Must be called in a critical section.
+       */
+      void
+      clock_timestamps_list::link (timestamp_node& node)
+      {
+#if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
+        trace::printf ("clock %s() %u +%u\n", __func__,
+            static_cast<uint32_t> (now_),
+            static_cast<uint32_t> (node.timestamp));
+#endif
+
+        place_ (node);
+      }
+
+      /**
+       * @details
+       * The first non empty slot is searched in the lowest wheel;
+       * only the slots of the higher wheels and the overflow list
+       * are not ordered, and must be traversed.
+       *
+       * Stale bits are skipped, but not cleared.
+       */
+      volatile timestamp_node*
+      clock_timestamps_list::head (void) const
+      {
+        for (std::size_t level = 0; level < levels; ++level)
+          {
+            std::size_t crt = static_cast<std::size_t> (now_
+                >> (slot_bits * level)) & mask_;
+
+            // The current slot only in the first wheel.
+            uint32_t map = maps_[level];
+            if (level == 0)
+              {
+                map &= ~((1u << crt) - 1);
+              }
+            else
+              {
+                map &= ~((2u << crt) - 1);
+              }
+
+            while (map != 0)
+              {
+                std::size_t slot = first_bit_ (map);
+                timestamp_node* node = slots_[level][slot].earliest ();
+                if (node != nullptr)
+                  {
+                    return node;
+                  }
+                map &= ~(1u << slot);
+              }
+          }
+
+        return overflow_.earliest ();
+      }
+
+      /**
+       * @details
+       * Run the nodes in the current slot of the first wheel, if
+       * any, then advance the current time directly to the next
+       * moment when there is something to do, moving the nodes
+       * to the lower wheels if needed; repeat until the given time.
+       *
+       * Each node action and each step are performed in separate
+       * critical sections.
+       */
+      void OS_ATTRIBUTE_HOT_PATH
+      clock_timestamps_list::check_timestamp (port::clock::timestamp_t now)
+      {
+        std::size_t expired = 0;
+
         for (;;)
           {
             // ----- Enter critical section -----------------------------------
             interrupts::critical_section ics;
 
-            if (empty ())
+            if (now + 1 < now_)
+              {
+                // The time went backwards.
+                rewind_ (now);
+              }
+
+            if (now < now_)
               {
                 break;
               }
-            clock::timestamp_t head_ts = head ()->timestamp;
-            if (now >= head_ts)
+
+            std::size_t slot = static_cast<std::size_t> (now_) & mask_;
+            slot_list& lst = slots_[0][slot];
+            if (!lst.empty ())
               {
 #if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
                 trace::printf ("%s() %u \n", __func__,
-                    static_cast<uint32_t> (sysclock.now ()));
+                    static_cast<uint32_t> (now_));
 #endif
-                const_cast<timestamp_node*> (head ())->action ();
+                const_cast<timestamp_node*> (static_cast<volatile timestamp_node*> (lst.head ()))->action ();
+                ++expired;
+                continue;
               }
-            else
+            maps_[0] &= ~(1u << slot);
+
+            port::clock::timestamp_t next = next_event_ ();
+            if (next > now + 1)
               {
+                // Nothing to do up to the given time.
+                now_ = now + 1;
                 break;
               }
+
+            now_ = next;
+            cascade_ ();
+            // ----- Exit critical section ------------------------------------
+          }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (expired > max_expired_)
+              {
+                max_expired_ = expired;
+              }
             // ----- Exit critical section ------------------------------------
           }
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+        if (expired != 0)
+          {
+            scheduler::internal_request_reschedule ();
+          }
+#endif
       }
 
+#endif /* !defined(OS_USE_RTOS_CLOCK_TIMING_WHEEL) */
+
       // ======================================================================
 
       void
@@ -0,0 +1,206 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace statistics
+    {
+      // ----------------------------------------------------------------------
+
+      namespace
+      {
+        // All live synchronisation objects. Statically initialised
+        // to zero, the list is cleared at first use, so objects
+        // can be registered from static constructors too.
+        sync_list sync_objects_;
+      }
+
+      /**
+       * @details
+       * @par Example
+       *
+       * @code{.cpp}
+       * scheduler::critical_section scs;
+       *
+       * for (auto&& st : statistics::sync_objects ())
+       *   {
+       *     trace::printf ("%s %u/%u\n", st.name (),
+       *                    static_cast<unsigned int> (st.contended ()),
+       *                    static_cast<unsigned int> (st.acquired ()));
+       *   }
+       * @endcode
+       */
+      sync_list&
+      sync_objects (void)
+      {
+        return sync_objects_;
+      }
+
+      // ----------------------------------------------------------------------
+
+      sync::sync (internal::object_named* object) :
+          object_ (object)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        sync_objects_.link (*this);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      sync::~sync ()
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        links_.unlink ();
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      const char*
+      sync::name (void) const
+      {
+        return object_->name ();
+      }
+
+      void
+      sync::clear (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        acquired_ = 0;
+        contended_ = 0;
+        wait_total_ = 0;
+        wait_max_ = 0;
+        hold_max_ = 0;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /*
+       * Internal function.
+       * Called when the object is acquired, with or without waiting.
+       */
+      void
+      sync::internal_mark_acquired_ (void)
+      {
+        port::clock::timestamp_t now = hrclock.now ();
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (links_.unlinked ())
+          {
+            // Constant initialised object, register it now.
+            sync_objects_.link (*this);
+          }
+
+        ++acquired_;
+        hold_begin_ = now;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /*
+       * Internal function.
+       * Called before blocking; returns the timestamp when the
+       * wait begins.
+       */
+      port::clock::timestamp_t
+      sync::internal_mark_contended_ (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (links_.unlinked ())
+          {
+            sync_objects_.link (*this);
+          }
+
+        ++contended_;
+        // ----- Exit critical section ----------------------------------------
+
+        return hrclock.now ();
+      }
+
+      /*
+       * Internal function.
+       * Called after a wait which acquired the object.
+       */
+      void
+      sync::internal_mark_waited_ (port::clock::timestamp_t begin)
+      {
+        duration_t delta = static_cast<duration_t> (hrclock.now () - begin);
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        wait_total_ += delta;
+        if (delta > wait_max_)
+          {
+            wait_max_ = delta;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /*
+       * Internal function.
+       * Called when the owner releases the object.
+       */
+      void
+      sync::internal_mark_released_ (void)
+      {
+        port::clock::timestamp_t now = hrclock.now ();
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        duration_t delta = static_cast<duration_t> (now - hold_begin_);
+        if (delta > hold_max_)
+          {
+            hold_max_ = delta;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    // ------------------------------------------------------------------------
+
+    } /* namespace statistics */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_SYNC) */
+
+// ----------------------------------------------------------------------------
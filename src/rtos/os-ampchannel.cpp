@@ -0,0 +1,822 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/utils/copy.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class amp_channel::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts, the doorbell and the cache maintenance
+     * functions) to the channel end.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const amp_channel::attributes amp_channel::initializer;
+
+    constexpr uint32_t amp_channel::magic;
+
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      // The semaphore which waits for the doorbell, on the channel clock.
+      semaphore::attributes_binary
+      doorbell_attributes (const amp_channel::attributes& attr)
+      {
+        semaphore::attributes_binary sattr
+          { 0 };
+        sattr.clock = attr.clock;
+        return sattr;
+      }
+    } /* namespace */
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class amp_channel
+     * @details
+     * On parts where each core runs its own instance of the RTOS,
+     * a channel passes messages in one direction, from a thread
+     * on one core to a thread on the other core; two channels
+     * are needed for both directions.
+     *
+     * The messages are kept in a lock-free ring in a shared memory
+     * area, known to both cores; each core constructs its own
+     * channel object, for its end, on the same area and with the same
+     * message size. The sender only writes the tail index, and the
+     * receiver only writes the head index, so no inter-core locks
+     * are needed.
+     *
+     * When one end waits (the receiver on an empty channel, or
+     * the sender on a full one), it sets a flag in the shared memory
+     * and the other end rings the doorbell (usually a software
+     * interrupt on the other core, or a mailbox peripheral), whose
+     * handler must call `interrupt_handler()`; there are no
+     * interrupts while both ends keep up.
+     *
+     * For shared memory cached and not coherent between the cores,
+     * the cache maintenance functions are called for the control
+     * block and for each message; the control block and the slots
+     * are aligned to the cache line (`OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES`).
+     *
+     * Similar to message queues, the messages can be copied
+     * (`send()`, `receive()`) or, to avoid the copies of large
+     * messages, written and read in place, in the shared memory
+     * (`alloc_slot()`, `commit()`, `receive_ref()`, `release()`);
+     * each end can hold only one slot at a time.
+     *
+     * The sender end formats the shared memory, so it must be
+     * constructed before the receiver uses the channel; a receiver
+     * waiting on a channel not yet formatted is woken by the
+     * sender constructor.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * // In the shared SRAM, known to both cores.
+     * uint8_t shared[amp_channel::compute_shared_size_bytes (8, 64)]
+     *   __attribute__((aligned(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES)));
+     *
+     * // On the first core.
+     * amp_channel tx { "tx", amp_channel::role::sender, shared,
+     *   sizeof(shared), 64, attr_tx };
+     *
+     * // On the second core.
+     * amp_channel rx { "rx", amp_channel::role::receiver, shared,
+     *   sizeof(shared), 64, attr_rx };
+     *
+     * void
+     * IPC_IRQHandler (void)
+     * {
+     *   rx.interrupt_handler ();
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified, but the API
+     *  follows the message queues.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise one end of the channel on
+     * the given shared memory; the number of messages is
+     * the largest power of 2 which fits.
+     *
+     * The sender end also formats the shared memory.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    amp_channel::amp_channel (const char* name, role_t end, void* shared,
+                              std::size_t shared_size_bytes,
+                              std::size_t msg_size_bytes,
+                              const attributes& attr) :
+        object_named_system
+          { name }, //
+        semaphore_
+          { name, doorbell_attributes (attr) }, //
+        end_ (end)
+    {
+#if defined(OS_TRACE_RTOS_AMP_CHANNEL)
+      trace::printf ("%s() @%p %s %u %p %u\n", __func__, this, this->name (),
+                     end, shared, msg_size_bytes);
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      os_assert_throw(end == role::sender || end == role::receiver, EINVAL);
+      os_assert_throw(shared != nullptr, EINVAL);
+      os_assert_throw(
+          (reinterpret_cast<uintptr_t> (shared)
+              & (OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES - 1)) == 0,
+          EINVAL);
+      os_assert_throw(msg_size_bytes > 0, EINVAL);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+      doorbell_ = attr.ch_doorbell;
+      doorbell_args_ = attr.ch_doorbell_args;
+      cache_clean_ = attr.ch_cache_clean;
+      cache_invalidate_ = attr.ch_cache_invalidate;
+
+      std::size_t control_size_bytes = internal_round_ (sizeof(control));
+      control_ = static_cast<control*> (shared);
+      slots_ = static_cast<uint8_t*> (shared) + control_size_bytes;
+
+      msg_size_bytes_ = msg_size_bytes;
+      slot_size_bytes_ = internal_round_ (sizeof(slot_header) + msg_size_bytes);
+
+      std::size_t n = 0;
+      if (shared_size_bytes > control_size_bytes)
+        {
+          n = (shared_size_bytes - control_size_bytes) / slot_size_bytes_;
+        }
+      os_assert_throw(n > 0, ENOMEM);
+
+      // The largest power of 2, for the free running indices.
+      depth_ = 1;
+      while (depth_ * 2 <= n)
+        {
+          depth_ *= 2;
+        }
+
+      if (end == role::sender)
+        {
+          control_->magic = 0;
+          control_->msg_size_bytes = static_cast<uint32_t> (msg_size_bytes_);
+          control_->slot_size_bytes = static_cast<uint32_t> (slot_size_bytes_);
+          control_->depth = depth_;
+          control_->head = 0;
+          control_->tail = 0;
+          control_->rx_waiting = 0;
+          control_->tx_waiting = 0;
+          internal_clean_ (control_, sizeof(control));
+
+          // Publish the control block only when complete.
+          __atomic_thread_fence (__ATOMIC_SEQ_CST);
+          internal_store_ (&control_->magic, magic);
+
+          // Wake a receiver which started waiting before.
+          internal_ring_ ();
+        }
+    }
+
+    /**
+     * @details
+     * The shared memory is not changed; there must be no threads
+     * waiting on this end.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    amp_channel::~amp_channel ()
+    {
+#if defined(OS_TRACE_RTOS_AMP_CHANNEL)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // The slot in use must be returned.
+      assert(loan_ == nullptr);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    amp_channel::internal_clean_ (void* addr, std::size_t bytes)
+    {
+      if (cache_clean_ != nullptr)
+        {
+          cache_clean_ (addr, bytes);
+        }
+    }
+
+    void
+    amp_channel::internal_invalidate_ (void* addr, std::size_t bytes)
+    {
+      if (cache_invalidate_ != nullptr)
+        {
+          cache_invalidate_ (addr, bytes);
+        }
+    }
+
+    uint32_t
+    amp_channel::internal_load_ (uint32_t* addr)
+    {
+      internal_invalidate_ (addr, sizeof(uint32_t));
+      return __atomic_load_n (addr, __ATOMIC_ACQUIRE);
+    }
+
+    void
+    amp_channel::internal_store_ (uint32_t* addr, uint32_t value)
+    {
+      __atomic_store_n (addr, value, __ATOMIC_RELEASE);
+      internal_clean_ (addr, sizeof(uint32_t));
+    }
+
+    void
+    amp_channel::internal_ring_ (void)
+    {
+      if (doorbell_ != nullptr)
+        {
+          doorbell_ (doorbell_args_);
+        }
+    }
+
+    uint8_t*
+    amp_channel::internal_slot_ (uint32_t index)
+    {
+      return slots_ + (index & (depth_ - 1)) * slot_size_bytes_;
+    }
+
+    bool
+    amp_channel::internal_can_send_ (void)
+    {
+      uint32_t tail = __atomic_load_n (&control_->tail, __ATOMIC_RELAXED);
+      return (tail - internal_load_ (&control_->head)) < depth_;
+    }
+
+    bool
+    amp_channel::internal_can_receive_ (void)
+    {
+      // Not formatted yet by the sender.
+      if (internal_load_ (&control_->magic) != magic)
+        {
+          return false;
+        }
+
+      // Both ends must agree on the layout.
+      assert(control_->depth == depth_);
+      assert(control_->slot_size_bytes == slot_size_bytes_);
+
+      uint32_t head = __atomic_load_n (&control_->head, __ATOMIC_RELAXED);
+      return internal_load_ (&control_->tail) != head;
+    }
+
+    result_t
+    amp_channel::internal_wait_ (uint32_t* waiting, predicate_t ready,
+                                 bool timed, clock::timestamp_t deadline)
+    {
+      for (;;)
+        {
+          if ((this->*ready) ())
+            {
+              return result::ok;
+            }
+
+          // Announce the wait, then check again, since the other end
+          // may have made progress before seeing the flag.
+          internal_store_ (waiting, 1);
+          __atomic_thread_fence (__ATOMIC_SEQ_CST);
+          if ((this->*ready) ())
+            {
+              internal_store_ (waiting, 0);
+              return result::ok;
+            }
+
+          // A stale post, left by a previous doorbell, only causes
+          // one more iteration.
+          result_t res;
+          if (timed)
+            {
+              clock::timestamp_t now = clock_->steady_now ();
+              if (now >= deadline)
+                {
+                  res = ETIMEDOUT;
+                }
+              else
+                {
+                  res = semaphore_.timed_wait (
+                      static_cast<clock::duration_t> (deadline - now));
+                }
+            }
+          else
+            {
+              res = semaphore_.wait ();
+            }
+
+          internal_store_ (waiting, 0);
+
+          if (res != result::ok)
+            {
+              // Give a last chance, the other end might have made
+              // progress just before the timeout.
+              if (res == ETIMEDOUT && (this->*ready) ())
+                {
+                  return result::ok;
+                }
+              return res;
+            }
+        }
+    }
+
+    void*
+    amp_channel::internal_alloc_slot_ (bool timed, clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      assert(!interrupts::in_handler_mode ());
+      if (interrupts::in_handler_mode ())
+        {
+          return nullptr;
+        }
+
+      clock::timestamp_t deadline =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      if (end_ != role::sender || loan_ != nullptr
+          || internal_wait_ (&control_->tx_waiting,
+                             &amp_channel::internal_can_send_, timed, deadline)
+              != result::ok)
+        {
+          return nullptr;
+        }
+
+      return try_alloc_slot ();
+    }
+
+    result_t
+    amp_channel::internal_receive_ref_ (void** slot, std::size_t* length,
+                                        bool timed, clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(end_ == role::receiver, EPERM);
+
+      if (loan_ != nullptr)
+        {
+          return EBUSY;
+        }
+
+      clock::timestamp_t deadline =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      result_t res = internal_wait_ (&control_->rx_waiting,
+                                     &amp_channel::internal_can_receive_,
+                                     timed, deadline);
+      if (res != result::ok)
+        {
+          return res;
+        }
+
+      return try_receive_ref (slot, length);
+    }
+
+    result_t
+    amp_channel::internal_send_ (const void* msg, std::size_t nbytes,
+                                 bool timed, clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_AMP_CHANNEL)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg, nbytes, this,
+                     name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(end_ == role::sender, EPERM);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      clock::timestamp_t deadline =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      result_t res = internal_wait_ (&control_->tx_waiting,
+                                     &amp_channel::internal_can_send_, timed,
+                                     deadline);
+      if (res != result::ok)
+        {
+          return res;
+        }
+
+      return try_send (msg, nbytes);
+    }
+
+    result_t
+    amp_channel::internal_receive_ (void* msg, std::size_t nbytes,
+                                    std::size_t* length, bool timed,
+                                    clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_AMP_CHANNEL)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg, nbytes, this,
+                     name ());
+#endif
+
+      os_assert_err(nbytes >= msg_size_bytes_, EMSGSIZE);
+
+      void* slot;
+      std::size_t len;
+      result_t res = internal_receive_ref_ (&slot, &len, timed, timeout);
+      if (res != result::ok)
+        {
+          return res;
+        }
+
+      utils::copy_bytes (msg, slot, len);
+      if (length != nullptr)
+        {
+          *length = len;
+        }
+
+      return release (slot);
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The message is copied into the next slot in the shared
+     * memory, then the tail index is advanced; if the channel is
+     * full, the calling thread waits for the receiver.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::send (const void* msg, std::size_t nbytes)
+    {
+      return internal_send_ (msg, nbytes, false, 0);
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::try_send (const void* msg, std::size_t nbytes)
+    {
+      os_assert_err(end_ == role::sender, EPERM);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      void* slot = try_alloc_slot ();
+      if (slot == nullptr)
+        {
+          return EWOULDBLOCK;
+        }
+
+      utils::copy_bytes (slot, msg, nbytes);
+      return commit (slot, nbytes);
+    }
+
+    /**
+     * @details
+     * Same as `send()`, but waits at most the timeout.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::timed_send (const void* msg, std::size_t nbytes,
+                             clock::duration_t timeout)
+    {
+      return internal_send_ (msg, nbytes, true, timeout);
+    }
+
+    /**
+     * @details
+     * The message is copied from the next slot in the shared
+     * memory, then the slot is returned to the sender; if the
+     * channel is empty, the calling thread waits for the sender.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::receive (void* msg, std::size_t nbytes, std::size_t* length)
+    {
+      return internal_receive_ (msg, nbytes, length, false, 0);
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::try_receive (void* msg, std::size_t nbytes,
+                              std::size_t* length)
+    {
+      os_assert_err(nbytes >= msg_size_bytes_, EMSGSIZE);
+
+      void* slot;
+      std::size_t len;
+      result_t res = try_receive_ref (&slot, &len);
+      if (res != result::ok)
+        {
+          return res;
+        }
+
+      utils::copy_bytes (msg, slot, len);
+      if (length != nullptr)
+        {
+          *length = len;
+        }
+
+      return release (slot);
+    }
+
+    /**
+     * @details
+     * Same as `receive()`, but waits at most the timeout.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::timed_receive (void* msg, std::size_t nbytes,
+                                clock::duration_t timeout, std::size_t* length)
+    {
+      return internal_receive_ (msg, nbytes, length, true, timeout);
+    }
+
+    /**
+     * @details
+     * The slot is the next one in the shared memory; the message
+     * is written in place, then published with `commit()`.
+     * If the channel is full, the calling thread waits for
+     * the receiver.
+     *
+     * Only one slot can be allocated at a time.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void*
+    amp_channel::alloc_slot (void)
+    {
+      return internal_alloc_slot_ (false, 0);
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void*
+    amp_channel::try_alloc_slot (void)
+    {
+      assert(end_ == role::sender);
+      if (end_ != role::sender || loan_ != nullptr || !internal_can_send_ ())
+        {
+          return nullptr;
+        }
+
+      loan_ = internal_slot_ (
+          __atomic_load_n (&control_->tail, __ATOMIC_RELAXED));
+      return loan_ + sizeof(slot_header);
+    }
+
+    /**
+     * @details
+     * Same as `alloc_slot()`, but waits at most the timeout.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void*
+    amp_channel::timed_alloc_slot (clock::duration_t timeout)
+    {
+      return internal_alloc_slot_ (true, timeout);
+    }
+
+    /**
+     * @details
+     * The message is written back from the cache (if needed), then
+     * the tail index is advanced; if the receiver waits, the
+     * doorbell is rung.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::commit (void* slot, std::size_t nbytes)
+    {
+      if (end_ != role::sender || loan_ == nullptr
+          || static_cast<uint8_t*> (slot) != loan_ + sizeof(slot_header))
+        {
+          return EINVAL;
+        }
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      reinterpret_cast<slot_header*> (loan_)->length =
+          static_cast<uint32_t> (nbytes);
+      internal_clean_ (loan_, sizeof(slot_header) + nbytes);
+      loan_ = nullptr;
+
+      internal_store_ (&control_->tail,
+                       __atomic_load_n (&control_->tail, __ATOMIC_RELAXED) + 1);
+
+      // Pairs with the fence in internal_wait_().
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      if (internal_load_ (&control_->rx_waiting) != 0)
+        {
+          internal_ring_ ();
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The message stays in the shared memory, and must be returned
+     * with `release()`; if the channel is empty, the calling thread
+     * waits for the sender.
+     *
+     * Only one message can be referred at a time.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::receive_ref (void** slot, std::size_t* length)
+    {
+      return internal_receive_ref_ (slot, length, false, 0);
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::try_receive_ref (void** slot, std::size_t* length)
+    {
+      os_assert_err(end_ == role::receiver, EPERM);
+
+      if (loan_ != nullptr)
+        {
+          return EBUSY;
+        }
+
+      if (!internal_can_receive_ ())
+        {
+          return EWOULDBLOCK;
+        }
+
+      uint8_t* p = internal_slot_ (
+          __atomic_load_n (&control_->head, __ATOMIC_RELAXED));
+      internal_invalidate_ (p, slot_size_bytes_);
+
+      loan_ = p;
+      *slot = p + sizeof(slot_header);
+      if (length != nullptr)
+        {
+          *length = reinterpret_cast<slot_header*> (p)->length;
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * Same as `receive_ref()`, but waits at most the timeout.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::timed_receive_ref (void** slot, clock::duration_t timeout,
+                                    std::size_t* length)
+    {
+      return internal_receive_ref_ (slot, length, true, timeout);
+    }
+
+    /**
+     * @details
+     * On the receiver end, the head index is advanced; if the
+     * sender waits, the doorbell is rung. On the sender end,
+     * the allocated slot is abandoned, without sending a message.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    amp_channel::release (void* slot)
+    {
+      if (loan_ == nullptr
+          || static_cast<uint8_t*> (slot) != loan_ + sizeof(slot_header))
+        {
+          return EINVAL;
+        }
+
+      loan_ = nullptr;
+      if (end_ == role::sender)
+        {
+          return result::ok;
+        }
+
+      internal_store_ (&control_->head,
+                       __atomic_load_n (&control_->head, __ATOMIC_RELAXED) + 1);
+
+      // Pairs with the fence in internal_wait_().
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      if (internal_load_ (&control_->tx_waiting) != 0)
+        {
+          internal_ring_ ();
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * Must be called by the interrupt handler raised by the doorbell
+     * of the other end; it wakes the thread waiting on this end,
+     * if any.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    amp_channel::interrupt_handler (void)
+    {
+      semaphore_.post ();
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    amp_channel::length (void)
+    {
+      if (internal_load_ (&control_->magic) != magic)
+        {
+          return 0;
+        }
+
+      return internal_load_ (&control_->tail)
+          - internal_load_ (&control_->head);
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    bool
+    amp_channel::empty (void)
+    {
+      return length () == 0;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    bool
+    amp_channel::full (void)
+    {
+      return length () >= depth_;
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
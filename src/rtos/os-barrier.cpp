@@ -0,0 +1,460 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class barrier::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts) to the barrier.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const barrier::attributes barrier::initializer;
+
+    constexpr barrier::count_t barrier::max_count_value;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class barrier
+     * @details
+     * A barrier blocks a group of threads until all of them arrive,
+     * then releases them together and starts a new phase.
+     *
+     * Each phase ends when the expected number of arrivals
+     * (given to the constructor) was counted. The last arrival
+     * runs the optional completion function, then advances
+     * the phase and resumes all waiting threads with a single
+     * pass through the waiting list, without any mutex or
+     * condition variable.
+     *
+     * Threads may also arrive without waiting, for example from
+     * interrupts, and wait later for the phase returned by
+     * `arrive()`, or leave the group with `arrive_and_drop()`.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * barrier bar { "bar", 3 };
+     *
+     * void*
+     * worker (void* args)
+     * {
+     *   for (;;)
+     *     {
+     *       // Process one part of the block.
+     *       bar.arrive_and_wait ();
+     *     }
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  Inspired by `pthread_barrier_t`
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html))
+     *  and by C++20 `std::barrier`.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a named barrier object
+     * expecting _expected_ arrivals in each phase,
+     * with attributes referenced by _attr_.
+     *
+     * The completion function, if not `nullptr`, is called
+     * with _args_ by the last thread arriving in each phase,
+     * before the other threads are resumed. If the last
+     * arrival is from an interrupt, the completion function
+     * also runs in the interrupt context.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_barrier_init()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_barrier_init.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    barrier::barrier (const char* name, count_t expected,
+                      completion_t completion, void* args,
+                      const attributes& attr) :
+        object_named_system
+          { name }, //
+        completion_ (completion), //
+        completion_args_ (args), //
+        expected_ (expected), //
+        pending_ (expected)
+    {
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s() @%p %s %d\n", __func__, this, this->name (),
+                     static_cast<int> (expected));
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      os_assert_throw(expected > 0, EINVAL);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+    }
+
+    /**
+     * @details
+     * It is safe to destroy a barrier upon which no threads
+     * are currently blocked.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_barrier_destroy()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_barrier_destroy.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    barrier::~barrier ()
+    {
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // There must be no threads waiting for this barrier.
+      assert(list_.empty ());
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    result_t
+    barrier::internal_arrive_ (phase_t* phase, count_t update, count_t drop)
+    {
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      phase_t arrival_phase;
+      bool last;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (update <= 0 || update > pending_)
+            {
+              return EINVAL;
+            }
+
+          arrival_phase = phase_;
+          pending_ -= update;
+          expected_ -= drop;
+          last = (pending_ == 0);
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s(%d) @%p %s phase %u%s\n", __func__,
+                     static_cast<int> (update), this, name (),
+                     static_cast<unsigned int> (arrival_phase),
+                     last ? " last" : "");
+#endif
+
+      if (phase != nullptr)
+        {
+          *phase = arrival_phase;
+        }
+
+      if (last)
+        {
+          // All other arrivals are in, the phase cannot change
+          // until it is advanced below.
+          if (completion_ != nullptr)
+            {
+              completion_ (completion_args_);
+            }
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              pending_ = expected_;
+              ++phase_;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          // Resume all waiting threads in a single critical section.
+          list_.resume_all ();
+        }
+
+      return result::ok;
+    }
+
+    result_t
+    barrier::internal_wait_ (phase_t phase, bool timed,
+                             clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (phase_ != phase)
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (phase_ != phase)
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the barrier waiting list, and,
+              // for timed waits, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (list_, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the barrier waiting list,
+          // if not already removed by the last arrival, and from the
+          // clock timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_BARRIER)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+              interrupts::critical_section ics;
+
+              // Give a last chance, the phase might have ended
+              // just before the timeout.
+              if (phase_ != phase)
+                {
+                  return result::ok;
+                }
+
+#if defined(OS_TRACE_RTOS_BARRIER)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Count _update_ arrivals in the current phase and return
+     * at once. If the expected number of arrivals is reached,
+     * the phase ends: the completion function is called,
+     * a new phase starts and all waiting threads are resumed.
+     *
+     * The returned phase can be passed later to `wait()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    barrier::arrive (phase_t* phase, count_t update)
+    {
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s(%d) @%p %s\n", __func__, static_cast<int> (update),
+                     this, name ());
+#endif
+
+      return internal_arrive_ (phase, update, 0);
+    }
+
+    /**
+     * @details
+     * If the given phase already ended, return at once.
+     * Otherwise, the current thread is suspended until
+     * the last arrival of the phase.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    barrier::wait (phase_t phase)
+    {
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (phase), this, name ());
+#endif
+
+      return internal_wait_ (phase, false, 0);
+    }
+
+    /**
+     * @details
+     * If the given phase already ended, return at once.
+     * Otherwise, the current thread is suspended until
+     * the last arrival of the phase, or the timeout expires.
+     *
+     * The timeout does not affect the barrier; the arrival
+     * remains counted.
+     *
+     * The timeout is measured with the clock from the barrier
+     * attributes (by default the SysTick clock).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    barrier::timed_wait (phase_t phase, clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s(%u, %u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (phase),
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_wait_ (phase, true, timeout);
+    }
+
+    /**
+     * @details
+     * Arrive at the barrier and suspend the current thread until
+     * all other threads in the group arrive too.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_barrier_wait()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_barrier_wait.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    barrier::arrive_and_wait (void)
+    {
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      phase_t phase;
+      result_t res = internal_arrive_ (&phase, 1, 0);
+      if (res != result::ok)
+        {
+          return res;
+        }
+
+      return internal_wait_ (phase, false, 0);
+    }
+
+    /**
+     * @details
+     * Count one arrival in the current phase and decrement
+     * the number of arrivals expected in the following phases.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    barrier::arrive_and_drop (void)
+    {
+#if defined(OS_TRACE_RTOS_BARRIER)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      return internal_arrive_ (nullptr, 1, 1);
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
@@ -32,6 +32,7 @@
 
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/rtos/os-c-api.h>
+#include <cmsis-plus/utils/copy.h>
 
 // ----------------------------------------------------------------------------
 
@@ -84,6 +85,13 @@ static_assert(alignof(os_thread_state_t) == alignof(thread::state_t), "adjust al
 static_assert(sizeof(os_thread_prio_t) == sizeof(thread::priority_t), "adjust size of os_thread_prio_t");
 static_assert(alignof(os_thread_prio_t) == alignof(thread::priority_t), "adjust align of os_thread_prio_t");
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+static_assert(sizeof(os_statistics_load_t) == sizeof(rtos::statistics::load_t), "adjust size of os_statistics_load_t");
+static_assert(sizeof(os_statistics_load_window_t) == sizeof(rtos::statistics::load_window_t), "adjust size of os_statistics_load_window_t");
+static_assert(static_cast<rtos::statistics::load_window_t> (os_statistics_load_window_one_minute) == rtos::statistics::load_window::one_minute, "adjust os_statistics_load_window_one_minute");
+static_assert(static_cast<rtos::statistics::load_window_t> (os_statistics_load_window_count) == rtos::statistics::load_window::count, "adjust os_statistics_load_window_count");
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
 static_assert(sizeof(os_timer_func_args_t) == sizeof(timer::func_args_t), "adjust size of os_timer_func_args_t");
 static_assert(alignof(os_timer_func_args_t) == alignof(timer::func_args_t), "adjust align of os_timer_func_args_t");
 
@@ -108,6 +116,9 @@ static_assert(alignof(os_mutex_protocol_t) == alignof(mutex::protocol_t), "adjus
 static_assert(sizeof(os_mutex_robustness_t) == sizeof(mutex::robustness_t), "adjust size of os_mutex_robustness_t");
 static_assert(alignof(os_mutex_robustness_t) == alignof(mutex::robustness_t), "adjust align of os_mutex_robustness_t");
 
+static_assert(sizeof(os_rwlock_count_t) == sizeof(rwlock::count_t), "adjust size of os_rwlock_count_t");
+static_assert(alignof(os_rwlock_count_t) == alignof(rwlock::count_t), "adjust align of os_rwlock_count_t");
+
 static_assert(sizeof(os_semaphore_count_t) == sizeof(semaphore::count_t), "adjust size of os_semaphore_count_t");
 static_assert(alignof(os_semaphore_count_t) == alignof(semaphore::count_t), "adjust align of os_semaphore_count_t");
 
@@ -153,6 +164,12 @@ static_assert(os_thread_state_suspended == thread::state::suspended, "adjust os_
 static_assert(os_thread_state_terminated == thread::state::terminated, "adjust os_thread_state_terminated");
 static_assert(os_thread_state_destroyed == thread::state::destroyed, "adjust os_thread_state_destroyed");
 
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+static_assert(os_thread_budget_action_report == thread::budget_action::report, "adjust os_thread_budget_action_report");
+static_assert(os_thread_budget_action_demote == thread::budget_action::demote, "adjust os_thread_budget_action_demote");
+static_assert(os_thread_budget_action_suspend == thread::budget_action::suspend, "adjust os_thread_budget_action_suspend");
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
 static_assert(os_timer_once == timer::run::once, "adjust os_timer_once");
 static_assert(os_timer_periodic == timer::run::periodic, "adjust os_timer_periodic");
 
@@ -185,10 +202,17 @@ static_assert(sizeof(rtos::thread::attributes) == sizeof(os_thread_attr_t), "adj
 static_assert(offsetof(rtos::thread::attributes, th_stack_address) == offsetof(os_thread_attr_t, th_stack_address), "adjust os_thread_attr_t members");
 static_assert(offsetof(rtos::thread::attributes, th_stack_size_bytes) == offsetof(os_thread_attr_t, th_stack_size_bytes), "adjust os_thread_attr_t members");
 static_assert(offsetof(rtos::thread::attributes, th_priority) == offsetof(os_thread_attr_t, th_priority), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_stack_region) == offsetof(os_thread_attr_t, th_stack_region), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_stack_resource) == offsetof(os_thread_attr_t, th_stack_resource), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_affinity) == offsetof(os_thread_attr_t, th_affinity), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_period_ticks) == offsetof(os_thread_attr_t, th_period_ticks), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_deadline_ticks) == offsetof(os_thread_attr_t, th_deadline_ticks), "adjust os_thread_attr_t members");
 
 static_assert(sizeof(rtos::timer) == sizeof(os_timer_t), "adjust size of os_timer_t");
 static_assert(sizeof(rtos::timer::attributes) == sizeof(os_timer_attr_t), "adjust size of os_timer_attr_t");
 static_assert(offsetof(rtos::timer::attributes, tm_type) == offsetof(os_timer_attr_t, tm_type), "adjust os_timer_attr_t members");
+static_assert(offsetof(rtos::timer::attributes, tm_run_in_thread) == offsetof(os_timer_attr_t, tm_run_in_thread), "adjust os_timer_attr_t members");
+static_assert(offsetof(rtos::timer::attributes, tm_slack) == offsetof(os_timer_attr_t, tm_slack), "adjust os_timer_attr_t members");
 
 static_assert(sizeof(rtos::mutex) == sizeof(os_mutex_t), "adjust size of os_mutex_t");
 static_assert(sizeof(rtos::mutex::attributes) == sizeof(os_mutex_attr_t), "adjust size of os_mutex_attr_t");
@@ -197,10 +221,16 @@ static_assert(offsetof(rtos::mutex::attributes, mx_protocol) == offsetof(os_mute
 static_assert(offsetof(rtos::mutex::attributes, mx_robustness) == offsetof(os_mutex_attr_t, mx_robustness), "adjust os_mutex_attr_t members");
 static_assert(offsetof(rtos::mutex::attributes, mx_type) == offsetof(os_mutex_attr_t, mx_type), "adjust os_mutex_attr_t members");
 static_assert(offsetof(rtos::mutex::attributes, mx_max_count) == offsetof(os_mutex_attr_t, mx_max_count), "adjust os_mutex_attr_t members");
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN)
+static_assert(offsetof(rtos::mutex::attributes, mx_spin_count) == offsetof(os_mutex_attr_t, mx_spin_count), "adjust os_mutex_attr_t members");
+#endif
 
 static_assert(sizeof(rtos::condition_variable) == sizeof(os_condvar_t), "adjust size of os_condvar_t");
 static_assert(sizeof(rtos::condition_variable::attributes) == sizeof(os_condvar_attr_t), "adjust size of os_condvar_attr_t");
 
+static_assert(sizeof(rtos::rwlock) == sizeof(os_rwlock_t), "adjust size of os_rwlock_t");
+static_assert(sizeof(rtos::rwlock::attributes) == sizeof(os_rwlock_attr_t), "adjust size of os_rwlock_attr_t");
+
 static_assert(sizeof(rtos::semaphore) == sizeof(os_semaphore_t), "adjust size of os_semaphore_t");
 static_assert(sizeof(rtos::semaphore::attributes) == sizeof(os_semaphore_attr_t), "adjust size of os_semaphore_attr_t");
 static_assert(offsetof(rtos::semaphore::attributes, sm_initial_value) == offsetof(os_semaphore_attr_t, sm_initial_value), "adjust os_semaphore_attr_t members");
@@ -210,11 +240,16 @@ static_assert(sizeof(rtos::memory_pool) == sizeof(os_mempool_t), "adjust size of
 static_assert(sizeof(rtos::memory_pool::attributes) == sizeof(os_mempool_attr_t), "adjust size of os_mempool_attr_t");
 static_assert(offsetof(rtos::memory_pool::attributes, mp_pool_address) == offsetof(os_mempool_attr_t, mp_pool_address), "adjust os_mempool_attr_t members");
 static_assert(offsetof(rtos::memory_pool::attributes, mp_pool_size_bytes) == offsetof(os_mempool_attr_t, mp_pool_size_bytes), "adjust os_mempool_attr_t members");
+static_assert(offsetof(rtos::memory_pool::attributes, mp_pool_region) == offsetof(os_mempool_attr_t, mp_pool_region), "adjust os_mempool_attr_t members");
 
 static_assert(sizeof(rtos::message_queue) == sizeof(os_mqueue_t), "adjust size of os_mqueue_t");
 static_assert(sizeof(rtos::message_queue::attributes) == sizeof(os_mqueue_attr_t), "adjust size of os_mqueue_attr_t");
 static_assert(offsetof(rtos::message_queue::attributes, mq_queue_address) == offsetof(os_mqueue_attr_t, mq_queue_addr), "adjust os_mqueue_attr_t members");
 static_assert(offsetof(rtos::message_queue::attributes, mq_queue_size_bytes) == offsetof(os_mqueue_attr_t, mq_queue_size_bytes), "adjust os_mqueue_attr_t members");
+static_assert(offsetof(rtos::message_queue::attributes, mq_store_lengths) == offsetof(os_mqueue_attr_t, mq_store_lengths), "adjust os_mqueue_attr_t members");
+static_assert(offsetof(rtos::message_queue::attributes, mq_queue_region) == offsetof(os_mqueue_attr_t, mq_queue_region), "adjust os_mqueue_attr_t members");
+
+static_assert(sizeof(rtos::mailbox_base) == sizeof(os_mailbox_t), "adjust size of os_mailbox_t");
 
 static_assert(sizeof(rtos::event_flags) == sizeof(os_evflags_t), "adjust size of os_evflags_t");
 static_assert(sizeof(rtos::event_flags::attributes) == sizeof(os_evflags_attr_t), "adjust size of os_evflags_attr_t");
@@ -223,12 +258,32 @@ static_assert(sizeof(class thread::stack) == sizeof(os_thread_stack_t), "adjust
 static_assert(sizeof(class thread::context) == sizeof(os_thread_context_t), "adjust size of os_thread_context_t");
 
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
-  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 static_assert(sizeof(class thread::statistics) == sizeof(os_thread_statistics_t), "adjust size of os_thread_statistics_t");
 #endif
 
 static_assert(sizeof(internal::timer_node) == sizeof(os_internal_clock_timer_node_t), "adjust size of os_internal_clock_timer_node_t");
 
+// The members read by the inline C accessors; the class is a friend
+// of the C++ objects, to reach their protected members.
+struct os::rtos::internal::c_api_layout
+{
+  static_assert(offsetof(rtos::thread, name_) == offsetof(os_thread_t, name), "adjust os_thread_t members");
+
+  static_assert(offsetof(rtos::mutex, name_) == offsetof(os_mutex_t, name), "adjust os_mutex_t members");
+  static_assert(offsetof(rtos::mutex, owner_) == offsetof(os_mutex_t, owner), "adjust os_mutex_t members");
+  static_assert(offsetof(rtos::mutex, type_) == offsetof(os_mutex_t, type), "adjust os_mutex_t members");
+  static_assert(offsetof(rtos::mutex, protocol_) == offsetof(os_mutex_t, protocol), "adjust os_mutex_t members");
+  static_assert(offsetof(rtos::mutex, robustness_) == offsetof(os_mutex_t, robustness), "adjust os_mutex_t members");
+
+  static_assert(offsetof(rtos::semaphore, name_) == offsetof(os_semaphore_t, name), "adjust os_semaphore_t members");
+  static_assert(offsetof(rtos::semaphore, max_value_) == offsetof(os_semaphore_t, max_count), "adjust os_semaphore_t members");
+  static_assert(offsetof(rtos::semaphore, initial_value_) == offsetof(os_semaphore_t, initial_count), "adjust os_semaphore_t members");
+  static_assert(offsetof(rtos::semaphore, count_) == offsetof(os_semaphore_t, count), "adjust os_semaphore_t members");
+};
+
 #pragma GCC diagnostic pop
 
 #pragma GCC diagnostic push
@@ -398,6 +453,56 @@ os_sched_stat_get_cpu_cycles (void)
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::scheduler::statistics::sample_cpu_load()
+ */
+bool
+os_sched_stat_sample_cpu_load (void)
+{
+  return scheduler::statistics::sample_cpu_load ();
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::scheduler::statistics::cpu_load()
+ */
+os_statistics_load_t
+os_sched_stat_get_cpu_load (os_statistics_load_window_t window)
+{
+  return static_cast<os_statistics_load_t> (scheduler::statistics::cpu_load (
+      static_cast<rtos::statistics::load_window_t> (window)));
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+/**
+ * @details
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::scheduler::statistics::coalesced_reschedules()
+ */
+os_statistics_counter_t
+os_sched_stat_get_coalesced_reschedules (void)
+{
+  return static_cast<os_statistics_counter_t> (scheduler::statistics::coalesced_reschedules ());
+}
+
+#endif
+
 // ----------------------------------------------------------------------------
 
 /**
@@ -414,6 +519,20 @@ os_irq_in_handler_mode (void)
   return interrupts::in_handler_mode ();
 }
 
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::interrupts::handler_exit()
+ */
+void
+os_irq_handler_exit (void)
+{
+  interrupts::handler_exit ();
+}
+
 // ----------------------------------------------------------------------------
 
 /**
@@ -612,6 +731,69 @@ os_this_thread_flags_get (os_flags_mask_t mask, os_flags_mode_t mode)
   return (os_flags_mask_t) this_thread::flags_get (mask, mode);
 }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::this_thread::notify_wait()
+ */
+os_result_t
+os_this_thread_notify_wait (os_notify_value_t* ovalue,
+                            os_notify_value_t clear)
+{
+  return (os_result_t) this_thread::notify_wait (ovalue, clear);
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::this_thread::notify_timed_wait()
+ */
+os_result_t
+os_this_thread_notify_timed_wait (os_clock_duration_t timeout,
+                                  os_notify_value_t* ovalue,
+                                  os_notify_value_t clear)
+{
+  return (os_result_t) this_thread::notify_timed_wait (timeout, ovalue, clear);
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::this_thread::notify_take()
+ */
+os_notify_value_t
+os_this_thread_notify_take (bool clear)
+{
+  return (os_notify_value_t) this_thread::notify_take (clear);
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::this_thread::notify_timed_take()
+ */
+os_notify_value_t
+os_this_thread_notify_timed_take (os_clock_duration_t timeout, bool clear)
+{
+  return (os_notify_value_t) this_thread::notify_timed_take (timeout, clear);
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
 // ----------------------------------------------------------------------------
 
 /**
@@ -727,6 +909,8 @@ os_thread_delete (os_thread_t* thread)
  * @par For the complete definition, see
  *  @ref os::rtos::thread::name()
  */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
 const char*
 os_thread_get_name (os_thread_t* thread)
 {
@@ -734,6 +918,8 @@ os_thread_get_name (os_thread_t* thread)
   return (reinterpret_cast<rtos::thread&> (*thread)).name ();
 }
 
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
 /**
  * @details
  *
@@ -765,6 +951,106 @@ os_thread_set_priority (os_thread_t* thread, os_thread_prio_t prio)
       prio);
 }
 
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::preemption_threshold()
+ */
+os_thread_prio_t
+os_thread_get_preemption_threshold (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return (os_thread_prio_t) (reinterpret_cast<rtos::thread&> (*thread)).preemption_threshold ();
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::preemption_threshold(priority_t)
+ */
+os_result_t
+os_thread_set_preemption_threshold (os_thread_t* thread, os_thread_prio_t prio)
+{
+  assert (thread != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::thread&> (*thread)).preemption_threshold (
+      prio);
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::affinity()
+ */
+os_thread_affinity_t
+os_thread_get_affinity (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return (os_thread_affinity_t) (reinterpret_cast<rtos::thread&> (*thread)).affinity ();
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::affinity(affinity_t)
+ */
+os_result_t
+os_thread_set_affinity (os_thread_t* thread, os_thread_affinity_t mask)
+{
+  assert (thread != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::thread&> (*thread)).affinity (
+      mask);
+}
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::cpu_budget(rtos::statistics::duration_t, port::clock::duration_t, budget_action_t, priority_t)
+ */
+os_result_t
+os_thread_set_cpu_budget (os_thread_t* thread, os_statistics_duration_t cycles,
+                          os_clock_duration_t period_ticks,
+                          os_thread_budget_action_t action,
+                          os_thread_prio_t demoted_prio)
+{
+  assert (thread != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::thread&> (*thread)).cpu_budget (
+      cycles, period_ticks, action, demoted_prio);
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::cpu_budget_overruns()
+ */
+os_statistics_counter_t
+os_thread_get_cpu_budget_overruns (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return (os_statistics_counter_t) (reinterpret_cast<rtos::thread&> (*thread)).cpu_budget_overruns ();
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
 /**
  * @details
  *
@@ -812,6 +1098,27 @@ os_thread_flags_raise (os_thread_t* thread, os_flags_mask_t mask,
       mask, oflags);
 }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::notify()
+ */
+os_result_t
+os_thread_notify (os_thread_t* thread, os_notify_value_t value,
+                  os_notify_action_t action)
+{
+  assert (thread != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::thread&> (*thread)).notify (
+      value, action);
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
 /**
  * @details
  *
@@ -895,6 +1202,81 @@ os_thread_stack_set_default_size (size_t size_bytes)
   return thread::stack::default_size (size_bytes);
 }
 
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::stack::default_resource()
+ */
+os_memory_t*
+os_thread_stack_get_default_resource (void)
+{
+  return reinterpret_cast<os_memory_t*> (thread::stack::default_resource ());
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::stack::default_resource(memory::memory_resource*)
+ */
+os_memory_t*
+os_thread_stack_set_default_resource (os_memory_t* memory)
+{
+  return reinterpret_cast<os_memory_t*> (thread::stack::default_resource (
+      reinterpret_cast<rtos::memory::memory_resource*> (memory)));
+}
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::stack::cache_flush()
+ */
+size_t
+os_thread_stack_cache_flush (void)
+{
+  return thread::stack::cache_flush ();
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::stack::cache_hits()
+ */
+os_statistics_counter_t
+os_thread_stack_get_cache_hits (void)
+{
+  return static_cast<os_statistics_counter_t> (thread::stack::cache_hits ());
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::stack::cache_misses()
+ */
+os_statistics_counter_t
+os_thread_stack_get_cache_misses (void)
+{
+  return static_cast<os_statistics_counter_t> (thread::stack::cache_misses ());
+}
+
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
+
 /**
  * @details
  *
@@ -983,6 +1365,21 @@ os_thread_stack_get_available (os_thread_stack_t* stack)
   return (reinterpret_cast<class rtos::thread::stack&> (*stack)).available ();
 }
 
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::stack::peak()
+ */
+size_t
+os_thread_stack_get_peak (os_thread_stack_t* stack)
+{
+  assert (stack != nullptr);
+  return (reinterpret_cast<class rtos::thread::stack&> (*stack)).peak ();
+}
+
 /**
  * @details
  *
@@ -1032,26 +1429,165 @@ os_thread_stat_get_context_switches (os_thread_t* thread)
   return static_cast<os_statistics_counter_t> ((reinterpret_cast<rtos::thread&> (*thread)).statistics ().context_switches ());
 }
 
-#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
-
-#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
-
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::statistics::cpu_cycles()
+ */
+os_statistics_duration_t
+os_thread_stat_get_cpu_cycles (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return static_cast<os_statistics_duration_t> ((reinterpret_cast<rtos::thread&> (*thread)).statistics ().cpu_cycles ());
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::statistics::cpu_load()
+ */
+os_statistics_load_t
+os_thread_stat_get_cpu_load (os_thread_t* thread,
+                             os_statistics_load_window_t window)
+{
+  assert (thread != nullptr);
+  return static_cast<os_statistics_load_t> ((reinterpret_cast<rtos::thread&> (*thread)).statistics ().cpu_load (
+      static_cast<rtos::statistics::load_window_t> (window)));
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::statistics::ready_latency_min()
+ */
+os_statistics_duration_t
+os_thread_stat_get_ready_latency_min (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return static_cast<os_statistics_duration_t> ((reinterpret_cast<rtos::thread&> (*thread)).statistics ().ready_latency_min ());
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::statistics::ready_latency_max()
+ */
+os_statistics_duration_t
+os_thread_stat_get_ready_latency_max (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return static_cast<os_statistics_duration_t> ((reinterpret_cast<rtos::thread&> (*thread)).statistics ().ready_latency_max ());
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::statistics::ready_latency_histogram()
+ */
+const uint32_t*
+os_thread_stat_get_ready_latency_histogram (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return (reinterpret_cast<rtos::thread&> (*thread)).statistics ().ready_latency_histogram ();
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::statistics::clear_ready_latency()
+ */
+void
+os_thread_stat_clear_ready_latency (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  (reinterpret_cast<rtos::thread&> (*thread)).statistics ().clear_ready_latency ();
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::statistics::deadline_misses()
+ */
+os_statistics_counter_t
+os_thread_stat_get_deadline_misses (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return static_cast<os_statistics_counter_t> ((reinterpret_cast<rtos::thread&> (*thread)).statistics ().deadline_misses ());
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_FPU_CONTEXT) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::context::fpu_context_live()
+ */
+bool
+os_thread_stat_is_fpu_context_live (os_thread_t* thread)
+{
+  assert (thread != nullptr);
+  return (reinterpret_cast<rtos::thread&> (*thread)).context ().fpu_context_live ();
+}
+
 /**
  * @details
  *
- * @warning Cannot be invoked from Interrupt Service Routines.
+ * @note Can be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::thread::statistics::cpu_cycles()
+ *  @ref os::rtos::thread::context::fpu_context_switches()
  */
-os_statistics_duration_t
-os_thread_stat_get_cpu_cycles (os_thread_t* thread)
+os_statistics_counter_t
+os_thread_stat_get_fpu_context_switches (os_thread_t* thread)
 {
   assert (thread != nullptr);
-  return static_cast<os_statistics_duration_t> ((reinterpret_cast<rtos::thread&> (*thread)).statistics ().cpu_cycles ());
+  return static_cast<os_statistics_counter_t> ((reinterpret_cast<rtos::thread&> (*thread)).context ().fpu_context_switches ());
 }
 
-#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
+#endif
 
 // ----------------------------------------------------------------------------
 
@@ -1719,6 +2255,8 @@ os_mutex_delete (os_mutex_t* mutex)
  * @par For the complete definition, see
  *  @ref os::rtos::mutex::name()
  */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
 const char*
 os_mutex_get_name (os_mutex_t* mutex)
 {
@@ -1726,6 +2264,8 @@ os_mutex_get_name (os_mutex_t* mutex)
   return (reinterpret_cast<rtos::mutex&> (*mutex)).name ();
 }
 
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
 /**
  * @details
  *
@@ -1842,6 +2382,8 @@ os_mutex_mark_consistent (os_mutex_t* mutex)
  * @par For the complete definition, see
  *  @ref os::rtos::mutex::owner()
  */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
 os_thread_t*
 os_mutex_get_owner (os_mutex_t* mutex)
 {
@@ -1849,6 +2391,8 @@ os_mutex_get_owner (os_mutex_t* mutex)
   return (os_thread_t*) (reinterpret_cast<rtos::mutex&> (*mutex)).owner ();
 }
 
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
 /**
  * @details
  *
@@ -1857,6 +2401,8 @@ os_mutex_get_owner (os_mutex_t* mutex)
  * @par For the complete definition, see
  *  @ref os::rtos::mutex::type()
  */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
 os_mutex_type_t
 os_mutex_get_type (os_mutex_t* mutex)
 {
@@ -1864,6 +2410,8 @@ os_mutex_get_type (os_mutex_t* mutex)
   return (reinterpret_cast<rtos::mutex&> (*mutex)).type ();
 }
 
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
 /**
  * @details
  *
@@ -1872,6 +2420,8 @@ os_mutex_get_type (os_mutex_t* mutex)
  * @par For the complete definition, see
  *  @ref os::rtos::mutex::protocol()
  */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
 os_mutex_protocol_t
 os_mutex_get_protocol (os_mutex_t* mutex)
 {
@@ -1879,6 +2429,8 @@ os_mutex_get_protocol (os_mutex_t* mutex)
   return (reinterpret_cast<rtos::mutex&> (*mutex)).protocol ();
 }
 
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
 /**
  * @details
  *
@@ -1887,6 +2439,8 @@ os_mutex_get_protocol (os_mutex_t* mutex)
  * @par For the complete definition, see
  *  @ref os::rtos::mutex::robustness()
  */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
 os_mutex_robustness_t
 os_mutex_get_robustness (os_mutex_t* mutex)
 {
@@ -1894,6 +2448,8 @@ os_mutex_get_robustness (os_mutex_t* mutex)
   return (reinterpret_cast<rtos::mutex&> (*mutex)).robustness ();
 }
 
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
 /**
  * @details
  *
@@ -2280,53 +2836,309 @@ os_semaphore_t*
 os_semaphore_binary_new (const char* name,
                          const os_semaphore_count_t initial_value)
 {
-  return reinterpret_cast<os_semaphore_t*> (new rtos::semaphore_binary
-    { name, initial_value });
+  return reinterpret_cast<os_semaphore_t*> (new rtos::semaphore_binary
+    { name, initial_value });
+}
+
+/**
+ * @details
+ *
+ * Dynamically allocate the counting semaphore object instance using the RTOS
+ * system allocator and construct it.
+ *
+ * @note Equivalent of C++ `new semaphore_counting(...)`.
+ * @note Must be paired with `os_semaphore_delete()`.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore_counting
+ */
+os_semaphore_t*
+os_semaphore_counting_new (const char* name,
+                           const os_semaphore_count_t max_value,
+                           const os_semaphore_count_t initial_value)
+{
+  return reinterpret_cast<os_semaphore_t*> (new rtos::semaphore_counting
+    { name, max_value, initial_value });
+}
+
+/**
+ * @details
+ *
+ * Destruct the semaphore and deallocate the dynamically allocated
+ * space using the RTOS system allocator.
+ *
+ * @note Equivalent of C++ `delete ptr_semaphore`.
+ * @note Must be paired with `os_semaphore_new()` or
+ * `os_semaphore_binary_new()` or `os_semaphore_counting_new()`.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore
+ */
+void
+os_semaphore_delete (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  delete reinterpret_cast<rtos::semaphore*> (semaphore);
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::name()
+ */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
+const char*
+os_semaphore_get_name (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (reinterpret_cast<rtos::semaphore&> (*semaphore)).name ();
+}
+
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::post()
+ */
+os_result_t
+os_semaphore_post (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).post ();
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::wait()
+ */
+os_result_t
+os_semaphore_wait (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).wait ();
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::try_wait()
+ */
+os_result_t
+os_semaphore_try_wait (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).try_wait ();
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::timed_wait()
+ */
+os_result_t
+os_semaphore_timed_wait (os_semaphore_t* semaphore, os_clock_duration_t timeout)
+{
+  assert (semaphore != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).timed_wait (
+      timeout);
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::value()
+ */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
+os_semaphore_count_t
+os_semaphore_get_value (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (os_semaphore_count_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).value ();
+}
+
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::reset()
+ */
+os_result_t
+os_semaphore_reset (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).reset ();
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::initial_value()
+ */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
+os_semaphore_count_t
+os_semaphore_get_initial_value (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (os_semaphore_count_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).initial_value ();
+}
+
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::semaphore::max_value()
+ */
+#if !defined(OS_USE_RTOS_C_API_INLINE)
+
+os_semaphore_count_t
+os_semaphore_get_max_value (os_semaphore_t* semaphore)
+{
+  assert (semaphore != nullptr);
+  return (os_semaphore_count_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).max_value ();
+}
+
+#endif /* !defined(OS_USE_RTOS_C_API_INLINE) */
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::rwlock::attributes
+ */
+void
+os_rwlock_attr_init (os_rwlock_attr_t* attr)
+{
+  assert (attr != nullptr);
+  new (attr) rwlock::attributes
+    { };
+}
+
+/**
+ * @details
+ *
+ * @note Must be paired with `os_rwlock_destruct()`.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::rwlock
+ */
+void
+os_rwlock_construct (os_rwlock_t* rwlock, const char* name,
+                     const os_rwlock_attr_t* attr)
+{
+  assert (rwlock != nullptr);
+  if (attr == nullptr)
+    {
+      attr = (const os_rwlock_attr_t*) &rwlock::initializer;
+    }
+  new (rwlock) rtos::rwlock
+    { name, (const rwlock::attributes&) *attr };
+}
+
+/**
+ * @details
+ *
+ * @note Must be paired with `os_rwlock_construct()`.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::rwlock
+ */
+void
+os_rwlock_destruct (os_rwlock_t* rwlock)
+{
+  assert (rwlock != nullptr);
+  (reinterpret_cast<rtos::rwlock&> (*rwlock)).~rwlock ();
 }
 
 /**
  * @details
  *
- * Dynamically allocate the counting semaphore object instance using the RTOS
+ * Dynamically allocate the read-write lock object instance using the RTOS
  * system allocator and construct it.
  *
- * @note Equivalent of C++ `new semaphore_counting(...)`.
- * @note Must be paired with `os_semaphore_delete()`.
+ * @note Equivalent of C++ `new rwlock(...)`.
+ * @note Must be paired with `os_rwlock_delete()`.
  *
  * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore_counting
+ *  @ref os::rtos::rwlock
  */
-os_semaphore_t*
-os_semaphore_counting_new (const char* name,
-                           const os_semaphore_count_t max_value,
-                           const os_semaphore_count_t initial_value)
+os_rwlock_t*
+os_rwlock_new (const char* name, const os_rwlock_attr_t* attr)
 {
-  return reinterpret_cast<os_semaphore_t*> (new rtos::semaphore_counting
-    { name, max_value, initial_value });
+  if (attr == nullptr)
+    {
+      attr = (const os_rwlock_attr_t*) &rwlock::initializer;
+    }
+  return reinterpret_cast<os_rwlock_t*> (new rtos::rwlock
+    { name, (const rwlock::attributes&) *attr });
 }
 
 /**
  * @details
  *
- * Destruct the semaphore and deallocate the dynamically allocated
+ * Destruct the read-write lock and deallocate the dynamically allocated
  * space using the RTOS system allocator.
  *
- * @note Equivalent of C++ `delete ptr_semaphore`.
- * @note Must be paired with `os_semaphore_new()` or
- * `os_semaphore_binary_new()` or `os_semaphore_counting_new()`.
+ * @note Equivalent of C++ `delete ptr_rwlock`.
+ * @note Must be paired with `os_rwlock_new()`.
  *
  * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore
+ *  @ref os::rtos::rwlock
  */
 void
-os_semaphore_delete (os_semaphore_t* semaphore)
+os_rwlock_delete (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  delete reinterpret_cast<rtos::semaphore*> (semaphore);
+  assert (rwlock != nullptr);
+  delete reinterpret_cast<rtos::rwlock*> (rwlock);
 }
 
 /**
@@ -2335,28 +3147,28 @@ os_semaphore_delete (os_semaphore_t* semaphore)
  * @note Can be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::name()
+ *  @ref os::rtos::rwlock::name()
  */
 const char*
-os_semaphore_get_name (os_semaphore_t* semaphore)
+os_rwlock_get_name (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  return (reinterpret_cast<rtos::semaphore&> (*semaphore)).name ();
+  assert (rwlock != nullptr);
+  return (reinterpret_cast<rtos::rwlock&> (*rwlock)).name ();
 }
 
 /**
  * @details
  *
- * @note Can be invoked from Interrupt Service Routines.
+ * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::post()
+ *  @ref os::rtos::rwlock::read_lock()
  */
 os_result_t
-os_semaphore_post (os_semaphore_t* semaphore)
+os_rwlock_read_lock (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).post ();
+  assert (rwlock != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).read_lock ();
 }
 
 /**
@@ -2365,28 +3177,28 @@ os_semaphore_post (os_semaphore_t* semaphore)
  * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::wait()
+ *  @ref os::rtos::rwlock::try_read_lock()
  */
 os_result_t
-os_semaphore_wait (os_semaphore_t* semaphore)
+os_rwlock_try_read_lock (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).wait ();
+  assert (rwlock != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).try_read_lock ();
 }
 
 /**
  * @details
  *
- * @note Can be invoked from Interrupt Service Routines.
+ * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::try_wait()
+ *  @ref os::rtos::rwlock::write_lock()
  */
 os_result_t
-os_semaphore_try_wait (os_semaphore_t* semaphore)
+os_rwlock_write_lock (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).try_wait ();
+  assert (rwlock != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).write_lock ();
 }
 
 /**
@@ -2395,29 +3207,28 @@ os_semaphore_try_wait (os_semaphore_t* semaphore)
  * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::timed_wait()
+ *  @ref os::rtos::rwlock::try_write_lock()
  */
 os_result_t
-os_semaphore_timed_wait (os_semaphore_t* semaphore, os_clock_duration_t timeout)
+os_rwlock_try_write_lock (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).timed_wait (
-      timeout);
+  assert (rwlock != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).try_write_lock ();
 }
 
 /**
  * @details
  *
- * @note Can be invoked from Interrupt Service Routines.
+ * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::value()
+ *  @ref os::rtos::rwlock::unlock()
  */
-os_semaphore_count_t
-os_semaphore_get_value (os_semaphore_t* semaphore)
+os_result_t
+os_rwlock_unlock (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  return (os_semaphore_count_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).value ();
+  assert (rwlock != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).unlock ();
 }
 
 /**
@@ -2426,28 +3237,30 @@ os_semaphore_get_value (os_semaphore_t* semaphore)
  * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::reset()
+ *  @ref os::rtos::rwlock::timed_read_lock()
  */
 os_result_t
-os_semaphore_reset (os_semaphore_t* semaphore)
+os_rwlock_timed_read_lock (os_rwlock_t* rwlock, os_clock_duration_t timeout)
 {
-  assert (semaphore != nullptr);
-  return (os_result_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).reset ();
+  assert (rwlock != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).timed_read_lock (
+      timeout);
 }
 
 /**
  * @details
  *
- * @note Can be invoked from Interrupt Service Routines.
+ * @warning Cannot be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::initial_value()
+ *  @ref os::rtos::rwlock::timed_write_lock()
  */
-os_semaphore_count_t
-os_semaphore_get_initial_value (os_semaphore_t* semaphore)
+os_result_t
+os_rwlock_timed_write_lock (os_rwlock_t* rwlock, os_clock_duration_t timeout)
 {
-  assert (semaphore != nullptr);
-  return (os_semaphore_count_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).initial_value ();
+  assert (rwlock != nullptr);
+  return (os_result_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).timed_write_lock (
+      timeout);
 }
 
 /**
@@ -2456,13 +3269,13 @@ os_semaphore_get_initial_value (os_semaphore_t* semaphore)
  * @note Can be invoked from Interrupt Service Routines.
  *
  * @par For the complete definition, see
- *  @ref os::rtos::semaphore::max_value()
+ *  @ref os::rtos::rwlock::readers()
  */
-os_semaphore_count_t
-os_semaphore_get_max_value (os_semaphore_t* semaphore)
+os_rwlock_count_t
+os_rwlock_get_readers (os_rwlock_t* rwlock)
 {
-  assert (semaphore != nullptr);
-  return (os_semaphore_count_t) (reinterpret_cast<rtos::semaphore&> (*semaphore)).max_value ();
+  assert (rwlock != nullptr);
+  return (os_rwlock_count_t) (reinterpret_cast<rtos::rwlock&> (*rwlock)).readers ();
 }
 
 // ----------------------------------------------------------------------------
@@ -2644,6 +3457,71 @@ os_mempool_free (os_mempool_t* mempool, void* block)
   return (os_result_t) (reinterpret_cast<memory_pool&> (*mempool)).free (block);
 }
 
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory_pool::alloc_n()
+ */
+size_t
+os_mempool_alloc_n (os_mempool_t* mempool, size_t count, void* blocks[])
+{
+  assert (mempool != nullptr);
+  return (reinterpret_cast<memory_pool&> (*mempool)).alloc_n (count, blocks);
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory_pool::try_alloc_n()
+ */
+size_t
+os_mempool_try_alloc_n (os_mempool_t* mempool, size_t count, void* blocks[])
+{
+  assert (mempool != nullptr);
+  return (reinterpret_cast<memory_pool&> (*mempool)).try_alloc_n (count,
+                                                                  blocks);
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory_pool::timed_alloc_n()
+ */
+size_t
+os_mempool_timed_alloc_n (os_mempool_t* mempool, size_t count, void* blocks[],
+                          os_clock_duration_t timeout)
+{
+  assert (mempool != nullptr);
+  return (reinterpret_cast<memory_pool&> (*mempool)).timed_alloc_n (count,
+                                                                    blocks,
+                                                                    timeout);
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory_pool::free_n()
+ */
+os_result_t
+os_mempool_free_n (os_mempool_t* mempool, size_t count, void* blocks[])
+{
+  assert (mempool != nullptr);
+  return (os_result_t) (reinterpret_cast<memory_pool&> (*mempool)).free_n (
+      count, blocks);
+}
+
 /**
  * @details
  *
@@ -3060,6 +3938,116 @@ os_mqueue_reset (os_mqueue_t* mqueue)
   return (os_result_t) (reinterpret_cast<message_queue&> (*mqueue)).reset ();
 }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::message_queue::statistics::depth_max()
+ */
+size_t
+os_mqueue_stat_get_depth_max (os_mqueue_t* mqueue)
+{
+  assert (mqueue != nullptr);
+  return static_cast<size_t> ((reinterpret_cast<message_queue&> (*mqueue)).statistics ().depth_max ());
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::message_queue::statistics::send_blocked()
+ */
+os_statistics_counter_t
+os_mqueue_stat_get_send_blocked (os_mqueue_t* mqueue)
+{
+  assert (mqueue != nullptr);
+  return static_cast<os_statistics_counter_t> ((reinterpret_cast<message_queue&> (*mqueue)).statistics ().send_blocked ());
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::message_queue::statistics::receive_blocked()
+ */
+os_statistics_counter_t
+os_mqueue_stat_get_receive_blocked (os_mqueue_t* mqueue)
+{
+  assert (mqueue != nullptr);
+  return static_cast<os_statistics_counter_t> ((reinterpret_cast<message_queue&> (*mqueue)).statistics ().receive_blocked ());
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::message_queue::statistics::received()
+ */
+os_statistics_counter_t
+os_mqueue_stat_get_received (os_mqueue_t* mqueue)
+{
+  assert (mqueue != nullptr);
+  return static_cast<os_statistics_counter_t> ((reinterpret_cast<message_queue&> (*mqueue)).statistics ().received ());
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::message_queue::statistics::latency_total()
+ */
+os_statistics_duration_t
+os_mqueue_stat_get_latency_total (os_mqueue_t* mqueue)
+{
+  assert (mqueue != nullptr);
+  return static_cast<os_statistics_duration_t> ((reinterpret_cast<message_queue&> (*mqueue)).statistics ().latency_total ());
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::message_queue::statistics::latency_max()
+ */
+os_statistics_duration_t
+os_mqueue_stat_get_latency_max (os_mqueue_t* mqueue)
+{
+  assert (mqueue != nullptr);
+  return static_cast<os_statistics_duration_t> ((reinterpret_cast<message_queue&> (*mqueue)).statistics ().latency_max ());
+}
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::message_queue::statistics::clear()
+ */
+void
+os_mqueue_stat_clear (os_mqueue_t* mqueue)
+{
+  assert (mqueue != nullptr);
+  (reinterpret_cast<message_queue&> (*mqueue)).statistics ().clear ();
+}
+
+#endif
+
 // --------------------------------------------------------------------------
 
 /**
@@ -3347,6 +4335,58 @@ os_memory_deallocate (os_memory_t* memory, void* addr, size_t bytes,
       addr, bytes, alignment);
 }
 
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ * @warning Not thread safe, use a scheduler critical section to protect it.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory::memory_resource::allocate_critical()
+ */
+void*
+os_memory_allocate_critical (os_memory_t* memory, size_t bytes,
+                             size_t alignment)
+{
+  assert (memory != nullptr);
+  return (reinterpret_cast<rtos::memory::memory_resource&> (*memory)).allocate_critical (
+      bytes, alignment);
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ * @warning Not thread safe, use a scheduler critical section to protect it.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory::memory_resource::emergency_reserve()
+ */
+bool
+os_memory_set_emergency_reserve (os_memory_t* memory, size_t bytes)
+{
+  assert (memory != nullptr);
+  return (reinterpret_cast<rtos::memory::memory_resource&> (*memory)).emergency_reserve (
+      bytes);
+}
+
+/**
+ * @details
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ * @warning Not thread safe, use a scheduler critical section to protect it.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory::memory_resource::reclaim()
+ */
+size_t
+os_memory_reclaim (os_memory_t* memory, size_t bytes)
+{
+  assert (memory != nullptr);
+  return (reinterpret_cast<rtos::memory::memory_resource&> (*memory)).reclaim (
+      bytes);
+}
+
 /**
  * @details
  *
@@ -3462,6 +4502,10 @@ os_memory_get_free_chunks (os_memory_t* memory)
 // ****************************************************************************
 // ***** Legacy CMSIS RTOS implementation *****
 
+// The CMSIS-RTOS v2 API, implemented in os-cmsis-os2.cpp,
+// shares many names with the legacy API.
+#if !defined(OS_USE_CMSIS_OS2)
+
 #include <cmsis-plus/legacy/cmsis_os.h>
 
 // ----------------------------------------------------------------------------
@@ -4566,8 +5610,8 @@ osPoolCAlloc (osPoolId pool_id)
   ret = (reinterpret_cast<memory_pool&> (*pool_id)).try_alloc ();
   if (ret != nullptr)
     {
-      memset (ret, 0,
-              (reinterpret_cast<memory_pool&> (*pool_id)).block_size ());
+      os::utils::fill_bytes (
+          ret, 0, (reinterpret_cast<memory_pool&> (*pool_id)).block_size ());
     }
 
   return ret;
@@ -4863,12 +5907,11 @@ osMailCreate (const osMailQDef_t* mail_def,
       mail_def->name, (std::size_t) mail_def->items,
       (std::size_t) mail_def->pool_item_sz, pool_attr);
 
-  message_queue::attributes queue_attr;
-  queue_attr.mq_queue_address = mail_def->queue;
-  queue_attr.mq_queue_size_bytes = mail_def->queue_sz;
-  new ((void*) &mail_def->data->queue) message_queue (
-      mail_def->name, (std::size_t) mail_def->items,
-      (std::size_t) mail_def->queue_item_sz, queue_attr);
+  // The mailbox has no dynamic storage, the array of pointers
+  // is always part of the definition.
+  new ((void*) &mail_def->data->mailbox) mailbox_base (
+      mail_def->name, static_cast<void**> (mail_def->queue),
+      (std::size_t) mail_def->items);
 
   return (osMailQId) (mail_def->data);
 }
@@ -4964,8 +6007,9 @@ osMailCAlloc (osMailQId mail_id, uint32_t millisec)
     {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstrict-aliasing"
-      memset (ret, 0,
-              (reinterpret_cast<memory_pool&> (mail_id->pool)).block_size ());
+      os::utils::fill_bytes (
+          ret, 0,
+          (reinterpret_cast<memory_pool&> (mail_id->pool)).block_size ());
 #pragma GCC diagnostic pop
     }
   return ret;
@@ -4976,6 +6020,9 @@ osMailCAlloc (osMailQId mail_id, uint32_t millisec)
  * Put the memory block specified with mail into the mail queue
  * specified by queue.
  *
+ * Only the address of the block is passed, through the mailbox;
+ * the content is not copied.
+ *
  * @note Can be invoked from Interrupt Service Routines.
  */
 osStatus
@@ -5002,8 +6049,7 @@ osMailPut (osMailQId mail_id, void* mail)
   result_t res;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstrict-aliasing"
-  res = (reinterpret_cast<message_queue&> (mail_id->queue)).try_send (
-      (const char*) &mail, sizeof(void*), 0);
+  res = (reinterpret_cast<mailbox_base&> (mail_id->mailbox)).try_send (mail);
 #pragma GCC diagnostic pop
   if (res == result::ok)
     {
@@ -5056,14 +6102,14 @@ osMailGet (osMailQId mail_id, uint32_t millisec)
           event.status = osErrorParameter;
           return event;
         }
-      res = (reinterpret_cast<message_queue&> ((mail_id->queue))).receive (
-          (char*) &event.value.p, sizeof(void*), nullptr);
+      res = (reinterpret_cast<mailbox_base&> (mail_id->mailbox)).receive (
+          &event.value.p);
       // osEventMail for ok,
     }
   else if (millisec == 0)
     {
-      res = (reinterpret_cast<message_queue&> (mail_id->queue)).try_receive (
-          (char*) &event.value.p, sizeof(void*), nullptr);
+      res = (reinterpret_cast<mailbox_base&> (mail_id->mailbox)).try_receive (
+          &event.value.p);
       // osEventMail for ok,
     }
   else
@@ -5073,9 +6119,9 @@ osMailGet (osMailQId mail_id, uint32_t millisec)
           event.status = osErrorParameter;
           return event;
         }
-      res = (reinterpret_cast<message_queue&> (mail_id->queue)).timed_receive (
-          (char*) &event.value.p, sizeof(void*),
-          clock_systick::ticks_cast ((uint64_t) (millisec * 1000u)), nullptr);
+      res = (reinterpret_cast<mailbox_base&> (mail_id->mailbox)).timed_receive (
+          &event.value.p,
+          clock_systick::ticks_cast ((uint64_t) (millisec * 1000u)));
       // osEventMail for ok, osEventTimeout
     }
 
@@ -5132,6 +6178,8 @@ osMailFree (osMailQId mail_id, void* mail)
 
 #endif /* Mail Queues available */
 
+#endif /* !defined(OS_USE_CMSIS_OS2) */
+
 // ----------------------------------------------------------------------------
 
 #pragma GCC diagnostic pop
@@ -26,6 +26,7 @@
  */
 
 #include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/profile.h>
 
 // ----------------------------------------------------------------------------
 
@@ -34,15 +35,28 @@ using namespace os::rtos;
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INCLUDE_RTOS_REALTIME_CLOCK_DRIVER)
+
+// Ticks left up to the next simulated RTC second.
+static uint32_t rtc_ticks_ = clock_systick::frequency_hz;
+
+#endif /* !defined(OS_INCLUDE_RTOS_REALTIME_CLOCK_DRIVER) */
+
+// ----------------------------------------------------------------------------
+
 /**
  * @details
  * Must be called from the physical interrupt handler.
  */
-void
+void OS_ATTRIBUTE_HOT_PATH
 os_systick_handler (void)
 {
   using namespace os::rtos;
 
+  events::isr_enter ();
+
+  OS_PROFILE_SCOPE("os_systick_handler");
+
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
   // Prevent scheduler actions before starting it.
   if (scheduler::started ())
@@ -55,6 +69,8 @@ os_systick_handler (void)
   trace::putchar ('.');
 #endif
 
+  events::clock_tick ();
+
     {
       // ----- Enter critical section -----------------------------------------
       interrupts::critical_section ics;
@@ -69,11 +85,9 @@ os_systick_handler (void)
 #if !defined(OS_INCLUDE_RTOS_REALTIME_CLOCK_DRIVER)
 
   // Simulate an RTC driver.
-  static uint32_t ticks = clock_systick::frequency_hz;
-
-  if (--ticks == 0)
+  if (--rtc_ticks_ == 0)
     {
-      ticks = clock_systick::frequency_hz;
+      rtc_ticks_ = clock_systick::frequency_hz;
 
       os_rtc_handler ();
     }
@@ -82,15 +96,101 @@ os_systick_handler (void)
 
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
 
-  port::scheduler::reschedule ();
+  // Threads woken by timeouts already requested a reschedule;
+  // here the running thread is rotated only when its
+  // time slice expired.
+  if (scheduler::internal_check_quantum ())
+    {
+      scheduler::internal_request_reschedule ();
+    }
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+  // New periods may resume or raise threads, and the running
+  // thread may have used its budget.
+  if (scheduler::internal_check_cpu_budgets ())
+    {
+      scheduler::internal_request_reschedule ();
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
 
 #endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
 
 #if defined(OS_TRACE_RTOS_SYSCLOCK_TICK)
   trace::putchar (',');
 #endif
+
+  // A single reschedule for all threads woken on this tick.
+  interrupts::handler_exit ();
+
+  events::isr_exit ();
 }
 
+/**
+ * @details
+ * Must be called after the SysTick interrupt was suppressed for
+ * a while, for example by the tickless idle, with the number of
+ * ticks that were not counted.
+ *
+ * All clocks driven by the SysTick are advanced at once,
+ * and the timestamps they reached are processed once.
+ */
+void
+os_systick_update_for_slept_ticks (os_clock_duration_t ticks)
+{
+  using namespace os::rtos;
+
+  if (ticks == 0)
+    {
+      return;
+    }
+
+  sysclock.update_for_slept_time (ticks);
+  hrclock.update_for_slept_time (
+      ticks * static_cast<clock::duration_t> (port::clock_highres::cycles_per_tick ()));
+
+#if !defined(OS_INCLUDE_RTOS_REALTIME_CLOCK_DRIVER)
+
+  // Account the RTC seconds lost during the sleep.
+  while (ticks >= rtc_ticks_)
+    {
+      ticks -= rtc_ticks_;
+      rtc_ticks_ = clock_systick::frequency_hz;
+
+      os_rtc_handler ();
+    }
+  rtc_ticks_ -= ticks;
+
+#endif /* !defined(OS_INCLUDE_RTOS_REALTIME_CLOCK_DRIVER) */
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+  port::scheduler::reschedule ();
+
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+}
+
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+
+/**
+ * @details
+ * Must be called from the interrupt handler of the high resolution
+ * compare channel, programmed by
+ * `port::clock_highres::start_compare()`.
+ */
+void
+os_hrclock_compare_handler (void)
+{
+  using namespace os::rtos;
+
+  hrclock.internal_check_timestamps ();
+
+  interrupts::handler_exit ();
+}
+
+#endif /* defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE) */
+
 /**
  * @details
  * Must be called from the physical RTC interrupt handler.
@@ -120,6 +220,8 @@ os_rtc_handler (void)
     }
 
   rtclock.internal_check_timestamps ();
+
+  interrupts::handler_exit ();
 }
 
 // ----------------------------------------------------------------------------
@@ -168,12 +270,18 @@ namespace os
     clock::timestamp_t
     clock::now (void)
     {
-      // ----- Enter critical section -----------------------------------------
-      interrupts::critical_section ics;
+      // Retry if a tick changed the count while being read;
+      // the interrupts need not be disabled.
+      timestamp_t ts;
+      uint32_t seq;
+      do
+        {
+          seq = internal_read_begin_ ();
+          ts = steady_count_;
+        }
+      while (internal_read_retry_ (seq));
 
-      // Prevent inconsistent values using the critical section.
-      return steady_count_;
-      // ----- Exit critical section ------------------------------------------
+      return ts;
     }
 
     /**
@@ -184,25 +292,34 @@ namespace os
     clock::timestamp_t
     clock::steady_now (void)
     {
-      // ----- Enter critical section -----------------------------------------
-      interrupts::critical_section ics;
+      timestamp_t ts;
+      uint32_t seq;
+      do
+        {
+          seq = internal_read_begin_ ();
+          ts = steady_count_;
+        }
+      while (internal_read_retry_ (seq));
 
-      // Prevent inconsistent values using the critical section.
-      return steady_count_;
-      // ----- Exit critical section ------------------------------------------
+      return ts;
     }
 
     /**
      * @details
+     * With a non zero `slack`, the wakeup is delayed to the
+     * boundary computed by `coalesce()`, so that it can share
+     * the tick with other timeouts (and, in tickless idle, leave
+     * the device asleep longer).
      *
      * @warning Cannot be invoked from Interrupt Service Routines.
      */
     result_t
-    clock::sleep_for (duration_t duration)
+    clock::sleep_for (duration_t duration, duration_t slack)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("%s(%u) %p %s\n", __func__,
+      trace::printf ("%s(%u,%u) %p %s\n", __func__,
                      static_cast<unsigned int> (duration),
+                     static_cast<unsigned int> (slack),
                      &this_thread::thread (), this_thread::thread ().name ());
 #endif
 
@@ -211,7 +328,8 @@ namespace os
       // Don't call this from critical regions.
       os_assert_err(!scheduler::locked (), EPERM);
 
-      clock::timestamp_t timestamp = steady_now () + duration;
+      clock::timestamp_t timestamp = coalesce (steady_now () + duration,
+                                               slack);
       for (;;)
         {
           result_t res;
@@ -283,10 +401,12 @@ namespace os
      * @warning Cannot be invoked from Interrupt Service Routines.
      */
     result_t
-    clock::wait_for (duration_t timeout)
+    clock::wait_for (duration_t timeout, duration_t slack)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("%s(%u)\n", __func__, static_cast<unsigned int> (timeout));
+      trace::printf ("%s(%u,%u)\n", __func__,
+                     static_cast<unsigned int> (timeout),
+                     static_cast<unsigned int> (slack));
 #endif
 
       // Don't call this from interrupt handlers.
@@ -294,7 +414,7 @@ namespace os
       // Don't call this from critical regions.
       os_assert_err(!scheduler::locked (), EPERM);
 
-      clock::timestamp_t timestamp = steady_now () + timeout;
+      clock::timestamp_t timestamp = coalesce (steady_now () + timeout, slack);
 
       result_t res;
       res = internal_wait_until_ (timestamp, steady_list_);
@@ -330,7 +450,9 @@ namespace os
       // ----- Enter critical section -----------------------------------------
       interrupts::critical_section ics;
 
+      internal_write_begin_ ();
       steady_count_ += duration;
+      internal_write_end_ ();
 
       internal_check_timestamps ();
       return steady_count_;
@@ -341,6 +463,62 @@ namespace os
      * @cond ignore
      */
 
+    /**
+     * @details
+     * Used by the tickless idle to compute how long the tick
+     * interrupt can be suppressed.
+     *
+     * @return The steady duration up to the earliest timestamp, 0 if
+     *  it is already due, or the largest value if there are no timestamps.
+     */
+    clock::timestamp_t
+    clock::internal_steady_duration_to_next (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (steady_list_.empty ())
+        {
+          return static_cast<timestamp_t> (-1);
+        }
+
+      timestamp_t next = steady_list_.head ()->timestamp;
+      if (next <= steady_count_)
+        {
+          return 0;
+        }
+      return next - steady_count_;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+    void
+    clock::max_expired_per_tick_reset (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      steady_list_.max_expired_reset ();
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
+
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+
+    /**
+     * @details
+     * Clocks driven only by the SysTick have nothing to program.
+     */
+    void
+    clock::internal_program_compare (void)
+    {
+      ;
+    }
+
+#endif
+
     clock::offset_t
     clock::offset (void)
     {
@@ -357,13 +535,26 @@ namespace os
     clock::internal_wait_until_ (timestamp_t timestamp,
                                  internal::clock_timestamps_list& list)
     {
-      thread& crt_thread = this_thread::thread ();
-
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
       internal::timeout_thread_node node
-        { timestamp, crt_thread };
+        { timestamp, this_thread::thread () };
+
+      return internal_wait_node_ (node, list);
+    }
+
+    /**
+     * @details
+     * The node must refer to the current thread; it is linked to
+     * the list, the thread is suspended, and when it resumes, for
+     * any reason, the node is unlinked, so it can be used again.
+     */
+    result_t
+    clock::internal_wait_node_ (internal::timeout_thread_node& node,
+                                internal::clock_timestamps_list& list)
+    {
+      thread& crt_thread = node.thread;
 
         {
           // ----- Enter critical section -------------------------------------
@@ -374,6 +565,9 @@ namespace os
 
           // Add this thread to the clock waiting list.
           list.link (node);
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+          internal_program_compare ();
+#endif
           crt_thread.clock_node_ = &node;
           crt_thread.state_ = thread::state::suspended;
           // ----- Exit critical section --------------------------------------
@@ -418,15 +612,20 @@ namespace os
     clock::timestamp_t
     adjustable_clock::now (void)
     {
-      // Prevent inconsistent values.
-      // ----- Enter critical section -----------------------------------------
-      interrupts::critical_section ics;
-
+      // The offset is changed under the same sequence as the count.
+      timestamp_t ts;
+      uint32_t seq;
+      do
+        {
+          seq = internal_read_begin_ ();
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wsign-conversion"
-      return steady_count_ + offset_;
+          ts = steady_count_ + offset_;
 #pragma GCC diagnostic pop
-      // ----- Exit critical section ------------------------------------------
+        }
+      while (internal_read_retry_ (seq));
+
+      return ts;
     }
 
     /**
@@ -494,7 +693,9 @@ namespace os
 
       offset_t tmp;
       tmp = offset_;
+      internal_write_begin_ ();
       offset_ = value;
+      internal_write_end_ ();
 
       return tmp;
       // ----- Exit critical section ------------------------------------------
@@ -754,18 +955,148 @@ namespace os
 #endif
 
       port::clock_highres::start ();
+
+      internal_update_conversion_ (
+          port::clock_highres::input_clock_frequency_hz ());
     }
 
+    /**
+     * @details
+     * The count and the cycles since the last tick are read
+     * together, and read again if a tick occurred meanwhile.
+     */
     clock::timestamp_t
     clock_highres::now (void)
+    {
+      timestamp_t ts;
+      uint32_t seq;
+      do
+        {
+          seq = internal_read_begin_ ();
+          ts = steady_count_ + port::clock_highres::cycles_since_tick ();
+        }
+      while (internal_read_retry_ (seq));
+
+      return ts;
+    }
+
+    /**
+     * @details
+     * The conversion uses the factor computed in advance, so there
+     * is no division.
+     */
+    uint64_t
+    clock_highres::nanoseconds (void)
+    {
+      return cycles_to_nanoseconds (now ());
+    }
+
+    /**
+     * @details
+     * The cycles are multiplied by the number of nanoseconds per
+     * cycle, a 32.32 fixed point value; the fractional part is
+     * multiplied separately with each half of the cycles, so there
+     * is no overflow, and the result is monotonic, with a relative
+     * error below 2^-32 of a nanosecond per cycle.
+     *
+     * If the input clock frequency changed (or the clock was not
+     * yet started), the factor is computed again.
+     */
+    uint64_t
+    clock_highres::cycles_to_nanoseconds (timestamp_t cycles)
+    {
+      uint32_t hz = port::clock_highres::input_clock_frequency_hz ();
+      if (hz != conversion_hz_)
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          internal_update_conversion_ (hz);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      uint64_t hi = cycles >> 32;
+      uint64_t lo = cycles & 0xFFFFFFFFull;
+
+      return cycles * ns_per_cycle_int_ + hi * ns_per_cycle_frac_
+          + ((lo * ns_per_cycle_frac_) >> 32);
+    }
+
+    /**
+     * @details
+     * The only division is done here, once for each frequency.
+     */
+    void
+    clock_highres::internal_update_conversion_ (uint32_t hz)
+    {
+      if (hz == 0)
+        {
+          return;
+        }
+
+      uint64_t factor = (1000000000ull << 32) / hz;
+      ns_per_cycle_int_ = static_cast<uint32_t> (factor >> 32);
+      ns_per_cycle_frac_ = static_cast<uint32_t> (factor);
+      conversion_hz_ = hz;
+    }
+
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+
+    /**
+     * @details
+     * Unlike the other clocks, the timeouts and the timers on
+     * the high resolution clock start from the exact current
+     * cycle, not from the last tick.
+     */
+    clock::timestamp_t
+    clock_highres::steady_now (void)
+    {
+      return now ();
+    }
+
+    /**
+     * @details
+     * Called both on each SysTick and from the compare channel
+     * interrupt.
+     */
+    void
+    clock_highres::internal_check_timestamps (void)
     {
       // ----- Enter critical section -----------------------------------------
       interrupts::critical_section ics;
 
-      return steady_count_ + port::clock_highres::cycles_since_tick ();
+      steady_list_.check_timestamp (now ());
+      internal_program_compare ();
       // ----- Exit critical section ------------------------------------------
     }
 
+    /**
+     * @details
+     * Only deadlines inside the current tick need the compare
+     * channel; the later ones are first seen by a SysTick, and
+     * programmed from there.
+     */
+    void
+    clock_highres::internal_program_compare (void)
+    {
+      if (steady_list_.empty ())
+        {
+          return;
+        }
+
+      timestamp_t next = steady_list_.head ()->timestamp;
+      if (next >= steady_count_ + port::clock_highres::cycles_per_tick ())
+        {
+          return;
+        }
+
+      timestamp_t nw = now ();
+      port::clock_highres::start_compare (
+          next > nw ? static_cast<uint32_t> (next - nw) : 1);
+    }
+
+#endif /* defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE) */
+
   // --------------------------------------------------------------------------
 
   } /* namespace rtos */
@@ -0,0 +1,2198 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * The code provides an implementation of the CMSIS-RTOS v2 API
+ * for the µOS++, using directly the CMSIS++ RTOS objects.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+#if defined(OS_USE_CMSIS_OS2)
+
+#include <cmsis-plus/legacy/cmsis_os2.h>
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  // The control block was allocated by the osXxxNew() function.
+  constexpr uint32_t cb_dynamic = 0x00000001;
+  // The thread was created with osThreadJoinable and was not
+  // yet joined or detached.
+  constexpr uint32_t cb_joinable = 0x00000002;
+
+  // Generic control block, the C++ object followed by the flags.
+  template<typename T>
+    struct object_cb
+    {
+      template<typename ... Args>
+        object_cb (uint32_t cb_flags, Args&&... args) :
+            object (std::forward<Args> (args)...), //
+            flags (cb_flags)
+        {
+          ;
+        }
+
+      T object;
+      uint32_t flags;
+    };
+
+  using timer_cb = object_cb<timer>;
+  using evflags_cb = object_cb<event_flags>;
+  using mutex_cb = object_cb<mutex>;
+  using semaphore_cb = object_cb<semaphore>;
+  using mempool_cb = object_cb<memory_pool>;
+  using mqueue_cb = object_cb<message_queue>;
+
+  void*
+  thread_trampoline (void* args);
+
+  // The thread control block also keeps the CMSIS function
+  // (which does not return a value) and links all threads created
+  // by osThreadNew(), to be able to reclaim them.
+  struct thread_cb
+  {
+    thread_cb (uint32_t cb_flags, const char* name, osThreadFunc_t function,
+               void* args, const thread::attributes& attr) :
+        object (name, thread_trampoline, this, attr), //
+        func (function), //
+        argument (args), //
+        next (nullptr), //
+        flags (cb_flags)
+    {
+      ;
+    }
+
+    thread object;
+    osThreadFunc_t func;
+    void* argument;
+    thread_cb* next;
+    uint32_t flags;
+  };
+
+  // Validate the C control blocks sizes & alignment.
+
+  static_assert(sizeof(os_cmsis2_thread_cb_t) == sizeof(thread_cb), "adjust size of os_cmsis2_thread_cb_t");
+  static_assert(alignof(os_cmsis2_thread_cb_t) == alignof(thread_cb), "adjust align of os_cmsis2_thread_cb_t");
+
+  static_assert(sizeof(os_cmsis2_timer_cb_t) == sizeof(timer_cb), "adjust size of os_cmsis2_timer_cb_t");
+  static_assert(alignof(os_cmsis2_timer_cb_t) == alignof(timer_cb), "adjust align of os_cmsis2_timer_cb_t");
+
+  static_assert(sizeof(os_cmsis2_evflags_cb_t) == sizeof(evflags_cb), "adjust size of os_cmsis2_evflags_cb_t");
+  static_assert(alignof(os_cmsis2_evflags_cb_t) == alignof(evflags_cb), "adjust align of os_cmsis2_evflags_cb_t");
+
+  static_assert(sizeof(os_cmsis2_mutex_cb_t) == sizeof(mutex_cb), "adjust size of os_cmsis2_mutex_cb_t");
+  static_assert(alignof(os_cmsis2_mutex_cb_t) == alignof(mutex_cb), "adjust align of os_cmsis2_mutex_cb_t");
+
+  static_assert(sizeof(os_cmsis2_semaphore_cb_t) == sizeof(semaphore_cb), "adjust size of os_cmsis2_semaphore_cb_t");
+  static_assert(alignof(os_cmsis2_semaphore_cb_t) == alignof(semaphore_cb), "adjust align of os_cmsis2_semaphore_cb_t");
+
+  static_assert(sizeof(os_cmsis2_mempool_cb_t) == sizeof(mempool_cb), "adjust size of os_cmsis2_mempool_cb_t");
+  static_assert(alignof(os_cmsis2_mempool_cb_t) == alignof(mempool_cb), "adjust align of os_cmsis2_mempool_cb_t");
+
+  static_assert(sizeof(os_cmsis2_mqueue_cb_t) == sizeof(mqueue_cb), "adjust size of os_cmsis2_mqueue_cb_t");
+  static_assert(alignof(os_cmsis2_mqueue_cb_t) == alignof(mqueue_cb), "adjust align of os_cmsis2_mqueue_cb_t");
+
+  // All threads created by osThreadNew() and not yet reclaimed.
+  thread_cb* threads_list_ = nullptr;
+
+  void*
+  thread_trampoline (void* args)
+  {
+    thread_cb* cb = static_cast<thread_cb*> (args);
+    cb->func (cb->argument);
+
+    return nullptr;
+  }
+
+  // Return the storage for a control block, either the user
+  // supplied one, if large enough and properly aligned, or
+  // dynamically allocated.
+  template<typename T>
+    void*
+    allocate_cb (void* cb_mem, uint32_t cb_size, uint32_t& cb_flags)
+    {
+      if (cb_mem == nullptr)
+        {
+          if (cb_size != 0)
+            {
+              return nullptr;
+            }
+          cb_flags = cb_dynamic;
+          return ::operator new (sizeof(T), std::nothrow);
+        }
+
+      if (cb_size < sizeof(T)
+          || (reinterpret_cast<uintptr_t> (cb_mem) & (alignof(T) - 1)) != 0)
+        {
+          return nullptr;
+        }
+      cb_flags = 0;
+      return cb_mem;
+    }
+
+  template<typename T>
+    void
+    destroy_cb (T* cb)
+    {
+      bool dynamic = ((cb->flags & cb_dynamic) != 0);
+      cb->~T ();
+      if (dynamic)
+        {
+          ::operator delete (cb);
+        }
+    }
+
+  // Must be called with the scheduler locked.
+  thread_cb*
+  find_thread_cb (thread* th)
+  {
+    for (thread_cb* cb = threads_list_; cb != nullptr; cb = cb->next)
+      {
+        if (&cb->object == th)
+          {
+            return cb;
+          }
+      }
+    return nullptr;
+  }
+
+  // Reclaim the control blocks of the detached threads that
+  // were destroyed; the joinable ones are reclaimed by osThreadJoin().
+  void
+  reclaim_threads (void)
+  {
+    thread_cb* dead = nullptr;
+      {
+        // ----- Enter critical section ---------------------------------------
+        scheduler::critical_section scs;
+
+        thread_cb** link = &threads_list_;
+        while (*link != nullptr)
+          {
+            thread_cb* cb = *link;
+            if ((cb->flags & cb_joinable) == 0
+                && cb->object.state () == thread::state::destroyed)
+              {
+                *link = cb->next;
+                cb->next = dead;
+                dead = cb;
+              }
+            else
+              {
+                link = &cb->next;
+              }
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    while (dead != nullptr)
+      {
+        thread_cb* cb = dead;
+        dead = cb->next;
+        destroy_cb (cb);
+      }
+  }
+
+  uint32_t
+  enumerate_threads (thread::threads_list& list, osThreadId_t* thread_array,
+                     uint32_t array_items, uint32_t count)
+  {
+    for (auto&& th : list)
+      {
+        if (thread_array != nullptr)
+          {
+            if (count >= array_items)
+              {
+                break;
+              }
+            thread_array[count] = &th;
+          }
+        ++count;
+
+        count = enumerate_threads (scheduler::children_threads (&th),
+                                   thread_array, array_items, count);
+      }
+    return count;
+  }
+
+  // CMSIS priorities are 8 levels of 8 sub-levels (from osPriorityLow
+  // to osPriorityRealtime7), mapped linearly over the user range,
+  // such that osPriorityLow is priority::low, osPriorityNormal
+  // is priority::normal, and so on.
+  constexpr uint32_t priority_step = (2u << thread::priority::range) / 8;
+
+  bool
+  is_valid_priority (osPriority_t priority)
+  {
+    return (priority == osPriorityIdle)
+        || (priority >= osPriorityLow && priority <= osPriorityRealtime7);
+  }
+
+  thread::priority_t
+  to_priority (osPriority_t priority)
+  {
+    if (priority == osPriorityIdle)
+      {
+        return thread::priority::idle;
+      }
+    return static_cast<thread::priority_t> (static_cast<uint32_t> (priority)
+        * priority_step);
+  }
+
+  osPriority_t
+  to_cmsis_priority (thread::priority_t prio)
+  {
+    if (prio <= thread::priority::idle)
+      {
+        return osPriorityIdle;
+      }
+    if (prio > thread::priority::highest)
+      {
+        return osPriorityISR;
+      }
+
+    uint32_t p = prio / priority_step;
+    if (p < osPriorityLow)
+      {
+        p = osPriorityLow;
+      }
+    else if (p > osPriorityRealtime7)
+      {
+        p = osPriorityRealtime7;
+      }
+    return static_cast<osPriority_t> (p);
+  }
+
+  osStatus_t
+  to_status (result_t res)
+  {
+    if (res == result::ok)
+      {
+        return osOK;
+      }
+    else if (res == ETIMEDOUT)
+      {
+        return osErrorTimeout;
+      }
+    else if (res == EWOULDBLOCK || res == EAGAIN || res == EBUSY
+        || res == EDEADLK || res == EPERM)
+      {
+        return osErrorResource;
+      }
+    else if (res == EINVAL || res == EMSGSIZE)
+      {
+        return osErrorParameter;
+      }
+    else if (res == ENOMEM)
+      {
+        return osErrorNoMemory;
+      }
+    return osError;
+  }
+
+  uint32_t
+  to_flags_error (result_t res)
+  {
+    if (res == ETIMEDOUT)
+      {
+        return osFlagsErrorTimeout;
+      }
+    else if (res == EWOULDBLOCK || res == EAGAIN)
+      {
+        return osFlagsErrorResource;
+      }
+    else if (res == EINVAL)
+      {
+        return osFlagsErrorParameter;
+      }
+    return osFlagsErrorUnknown;
+  }
+
+  flags::mode_t
+  to_flags_mode (uint32_t options)
+  {
+    flags::mode_t mode =
+        ((options & osFlagsWaitAll) != 0) ? flags::mode::all : flags::mode::any;
+    if ((options & osFlagsNoClear) == 0)
+      {
+        mode |= flags::mode::clear;
+      }
+    return mode;
+  }
+}
+
+/**
+ * @endcond
+ */
+
+// ----------------------------------------------------------------------------
+//  ==== Kernel Management Functions ====
+
+/**
+ * @details
+ * In µOS++ the scheduler is initialised before `main()`, which
+ * is already running as a thread; in this case the function
+ * does nothing.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osKernelInitialize (void)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (!scheduler::started ())
+    {
+      scheduler::initialize ();
+    }
+  return osOK;
+}
+
+/**
+ * @details
+ * The API version is `osCMSIS`, the kernel version is the µOS++
+ * version and the identification string is `osKernelSystemId`.
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osKernelGetInfo (osVersion_t* version, char* id_buf, uint32_t id_size)
+{
+  if (version != nullptr)
+    {
+      version->api = osCMSIS;
+      version->kernel = osCMSIS_KERNEL;
+    }
+
+  if (id_buf != nullptr && id_size != 0)
+    {
+      std::strncpy (id_buf, osKernelSystemId, id_size - 1);
+      id_buf[id_size - 1] = '\0';
+    }
+
+  return osOK;
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+osKernelState_t
+osKernelGetState (void)
+{
+  if (!scheduler::started ())
+    {
+      return osKernelReady;
+    }
+  return scheduler::locked () ? osKernelLocked : osKernelRunning;
+}
+
+/**
+ * @details
+ * If the scheduler is already running, as it is the case when
+ * called from `main()`, the function returns `osOK`
+ * and the caller continues as a thread.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osKernelStart (void)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (scheduler::started ())
+    {
+      return osOK;
+    }
+
+  scheduler::start ();
+  // Does not return.
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+int32_t
+osKernelLock (void)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  return scheduler::lock () ? 1 : 0;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+int32_t
+osKernelUnlock (void)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  return scheduler::unlock () ? 1 : 0;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+int32_t
+osKernelRestoreLock (int32_t lock)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+  if (lock != 0 && lock != 1)
+    {
+      return osErrorParameter;
+    }
+
+  scheduler::locked (lock != 0);
+  return scheduler::locked () ? 1 : 0;
+}
+
+/**
+ * @details
+ * Tick-less operation is not supported, the system clock
+ * keeps running; the function always returns 0.
+ */
+uint32_t
+osKernelSuspend (void)
+{
+  return 0;
+}
+
+/**
+ * @details
+ * Tick-less operation is not supported; the function does nothing.
+ */
+void
+osKernelResume (uint32_t sleep_ticks __attribute__((unused)))
+{
+  ;
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osKernelGetTickCount (void)
+{
+  return static_cast<uint32_t> (sysclock.now ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osKernelGetTickFreq (void)
+{
+  return clock_systick::frequency_hz;
+}
+
+/**
+ * @details
+ * The system timer is the high resolution clock.
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osKernelGetSysTimerCount (void)
+{
+  return static_cast<uint32_t> (hrclock.now ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osKernelGetSysTimerFreq (void)
+{
+  return hrclock.input_clock_frequency_hz ();
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Thread Management Functions ====
+
+/**
+ * @details
+ * If `attr->cb_mem` is given, the thread control block is
+ * constructed there, otherwise it is dynamically allocated;
+ * if `attr->stack_mem` is given, it is used as the thread stack,
+ * otherwise the stack is allocated by the thread.
+ *
+ * The control blocks of the detached threads that terminated
+ * are reclaimed on the next call.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osThreadId_t
+osThreadNew (osThreadFunc_t func, void* argument, const osThreadAttr_t* attr)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return nullptr;
+    }
+
+  if (func == nullptr)
+    {
+      return nullptr;
+    }
+
+  reclaim_threads ();
+
+  static const osThreadAttr_t default_attr
+    { };
+  if (attr == nullptr)
+    {
+      attr = &default_attr;
+    }
+
+  thread::attributes th_attr;
+  if (attr->priority != osPriorityNone)
+    {
+      if (!is_valid_priority (attr->priority))
+        {
+          return nullptr;
+        }
+      th_attr.th_priority = to_priority (attr->priority);
+    }
+
+  if (attr->stack_mem != nullptr)
+    {
+      if (attr->stack_size == 0
+          || (reinterpret_cast<uintptr_t> (attr->stack_mem)
+              & (alignof(thread::stack::allocation_element_t) - 1)) != 0)
+        {
+          return nullptr;
+        }
+      th_attr.th_stack_address = attr->stack_mem;
+    }
+  th_attr.th_stack_size_bytes = attr->stack_size;
+
+  uint32_t cb_flags;
+  void* mem = allocate_cb<thread_cb> (attr->cb_mem, attr->cb_size, cb_flags);
+  if (mem == nullptr)
+    {
+      return nullptr;
+    }
+  if ((attr->attr_bits & osThreadJoinable) != 0)
+    {
+      cb_flags |= cb_joinable;
+    }
+
+  thread_cb* cb;
+    {
+      // ----- Enter critical section -----------------------------------------
+      // The new thread must not run before the control block is complete.
+      scheduler::critical_section scs;
+
+      if (find_thread_cb (static_cast<thread*> (mem)) != nullptr)
+        {
+          // The control block is still in use.
+          return nullptr;
+        }
+
+      cb = new (mem) thread_cb (cb_flags, attr->name, func, argument, th_attr);
+
+      cb->next = threads_list_;
+      threads_list_ = cb;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  return &cb->object;
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+const char*
+osThreadGetName (osThreadId_t thread_id)
+{
+  if (thread_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<thread*> (thread_id))->name ();
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+osThreadId_t
+osThreadGetId (void)
+{
+  return &this_thread::thread ();
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+osThreadState_t
+osThreadGetState (osThreadId_t thread_id)
+{
+  if (thread_id == nullptr)
+    {
+      return osThreadError;
+    }
+
+  switch ((static_cast<thread*> (thread_id))->state ())
+    {
+    case thread::state::ready:
+      return osThreadReady;
+
+    case thread::state::running:
+      return osThreadRunning;
+
+    case thread::state::suspended:
+      return osThreadBlocked;
+
+    case thread::state::terminated:
+    case thread::state::destroyed:
+      return osThreadTerminated;
+
+    default:
+      return osThreadInactive;
+    }
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadGetStackSize (osThreadId_t thread_id)
+{
+  if (thread_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<thread*> (thread_id))->stack ().size ());
+}
+
+/**
+ * @details
+ * The stack space is computed from the untouched area at
+ * the stack bottom.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadGetStackSpace (osThreadId_t thread_id)
+{
+  if (interrupts::in_handler_mode () || thread_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<thread*> (thread_id))->stack ().available ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osThreadSetPriority (osThreadId_t thread_id, osPriority_t priority)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (thread_id == nullptr || !is_valid_priority (priority))
+    {
+      return osErrorParameter;
+    }
+
+  return to_status (
+      (static_cast<thread*> (thread_id))->priority (to_priority (priority)));
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osPriority_t
+osThreadGetPriority (osThreadId_t thread_id)
+{
+  if (interrupts::in_handler_mode () || thread_id == nullptr)
+    {
+      return osPriorityError;
+    }
+
+  return to_cmsis_priority ((static_cast<thread*> (thread_id))->priority ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osThreadYield (void)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  this_thread::yield ();
+  return osOK;
+}
+
+/**
+ * @details
+ * µOS++ threads can suspend only themselves, so the only
+ * supported thread is the current one; for other threads
+ * the function returns `osErrorResource`.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osThreadSuspend (osThreadId_t thread_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (thread_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  if (thread_id != &this_thread::thread ())
+    {
+      return osErrorResource;
+    }
+
+  this_thread::suspend ();
+  return osOK;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osThreadResume (osThreadId_t thread_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (thread_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  thread* th = static_cast<thread*> (thread_id);
+  if (th->state () != thread::state::suspended)
+    {
+      return osErrorResource;
+    }
+
+  th->resume ();
+  return osOK;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osThreadDetach (osThreadId_t thread_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (thread_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  thread* th = static_cast<thread*> (thread_id);
+    {
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      thread_cb* cb = find_thread_cb (th);
+      if (cb != nullptr)
+        {
+          if ((cb->flags & cb_joinable) == 0)
+            {
+              return osErrorResource;
+            }
+          cb->flags &= ~cb_joinable;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  return to_status (th->detach ());
+}
+
+/**
+ * @details
+ * After the thread terminated, its control block is reclaimed.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osThreadJoin (osThreadId_t thread_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (thread_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  thread* th = static_cast<thread*> (thread_id);
+  if (th == &this_thread::thread ())
+    {
+      return osErrorResource;
+    }
+
+  thread_cb* cb;
+    {
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      cb = find_thread_cb (th);
+      if (cb != nullptr && (cb->flags & cb_joinable) == 0)
+        {
+          return osErrorResource;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  result_t res = th->join ();
+  if (res != result::ok)
+    {
+      return to_status (res);
+    }
+
+  if (cb != nullptr)
+    {
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          thread_cb** link = &threads_list_;
+          while (*link != cb)
+            {
+              link = &(*link)->next;
+            }
+          *link = cb->next;
+          // ----- Exit critical section --------------------------------------
+        }
+      destroy_cb (cb);
+    }
+
+  return osOK;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+osThreadExit (void)
+{
+  this_thread::exit ();
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osThreadTerminate (osThreadId_t thread_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (thread_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  thread* th = static_cast<thread*> (thread_id);
+  if (th == &this_thread::thread ())
+    {
+      this_thread::exit ();
+    }
+
+  if (th->state () == thread::state::terminated
+      || th->state () == thread::state::destroyed)
+    {
+      return osErrorResource;
+    }
+
+  return to_status (th->kill ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadGetCount (void)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return 0;
+    }
+
+  // ----- Enter critical section ---------------------------------------------
+  scheduler::critical_section scs;
+
+  return enumerate_threads (scheduler::children_threads (nullptr), nullptr, 0,
+                            0);
+  // ----- Exit critical section ----------------------------------------------
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadEnumerate (osThreadId_t* thread_array, uint32_t array_items)
+{
+  if (interrupts::in_handler_mode () || thread_array == nullptr
+      || array_items == 0)
+    {
+      return 0;
+    }
+
+  // ----- Enter critical section ---------------------------------------------
+  scheduler::critical_section scs;
+
+  return enumerate_threads (scheduler::children_threads (nullptr),
+                            thread_array, array_items, 0);
+  // ----- Exit critical section ----------------------------------------------
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Thread Flags Functions ====
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadFlagsSet (osThreadId_t thread_id, uint32_t flags)
+{
+  if (thread_id == nullptr || (flags & osFlagsError) != 0)
+    {
+      return osFlagsErrorParameter;
+    }
+
+  flags::mask_t oflags;
+  result_t res = (static_cast<thread*> (thread_id))->flags_raise (flags,
+                                                                  &oflags);
+  if (res != result::ok)
+    {
+      return to_flags_error (res);
+    }
+  return oflags | flags;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadFlagsClear (uint32_t flags)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osFlagsErrorISR;
+    }
+  if ((flags & osFlagsError) != 0)
+    {
+      return osFlagsErrorParameter;
+    }
+
+  flags::mask_t oflags;
+  result_t res = this_thread::flags_clear (flags, &oflags);
+  if (res != result::ok)
+    {
+      return to_flags_error (res);
+    }
+  return oflags;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadFlagsGet (void)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return 0;
+    }
+
+  return this_thread::flags_get (0, 0);
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osThreadFlagsWait (uint32_t flags, uint32_t options, uint32_t timeout)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osFlagsErrorISR;
+    }
+  if ((flags & osFlagsError) != 0)
+    {
+      return osFlagsErrorParameter;
+    }
+
+  flags::mode_t mode = to_flags_mode (options);
+  flags::mask_t oflags = 0;
+  result_t res;
+  if (timeout == 0)
+    {
+      res = this_thread::flags_try_wait (flags, &oflags, mode);
+    }
+  else if (timeout == osWaitForever)
+    {
+      res = this_thread::flags_wait (flags, &oflags, mode);
+    }
+  else
+    {
+      res = this_thread::flags_timed_wait (flags, timeout, &oflags, mode);
+    }
+
+  if (res != result::ok)
+    {
+      return to_flags_error (res);
+    }
+  return oflags;
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Generic Wait Functions ====
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osDelay (uint32_t ticks)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (ticks == 0)
+    {
+      return osOK;
+    }
+
+  result_t res = sysclock.sleep_for (ticks);
+  return (res == ETIMEDOUT) ? osOK : osError;
+}
+
+/**
+ * @details
+ * The time is compared with the lower 32-bits of the system
+ * clock; times in the past, or more than 2^31 ticks in the
+ * future, are rejected.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osDelayUntil (uint32_t ticks)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  uint32_t delta = ticks - static_cast<uint32_t> (sysclock.now ());
+  if (delta == 0 || delta > 0x7FFFFFFF)
+    {
+      return osErrorParameter;
+    }
+
+  result_t res = sysclock.sleep_for (delta);
+  return (res == ETIMEDOUT) ? osOK : osError;
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Timer Management Functions ====
+
+/**
+ * @details
+ * When the timer daemon is available, the callbacks are
+ * deferred to it, as required by CMSIS; otherwise they
+ * are called from the clock interrupt.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osTimerId_t
+osTimerNew (osTimerFunc_t func, osTimerType_t type, void* argument,
+            const osTimerAttr_t* attr)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return nullptr;
+    }
+
+  if (func == nullptr || (type != osTimerOnce && type != osTimerPeriodic))
+    {
+      return nullptr;
+    }
+
+  static const osTimerAttr_t default_attr
+    { };
+  if (attr == nullptr)
+    {
+      attr = &default_attr;
+    }
+
+  timer::attributes tm_attr;
+  tm_attr.tm_type = (type == osTimerPeriodic) ? timer::run::periodic : timer::run::once;
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+  tm_attr.tm_run_in_thread = true;
+#endif
+
+  uint32_t cb_flags;
+  void* mem = allocate_cb<timer_cb> (attr->cb_mem, attr->cb_size, cb_flags);
+  if (mem == nullptr)
+    {
+      return nullptr;
+    }
+
+  return new (mem) timer_cb (cb_flags, attr->name, func, argument, tm_attr);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+const char*
+osTimerGetName (osTimerId_t timer_id)
+{
+  if (timer_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<timer_cb*> (timer_id))->object.name ();
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osTimerStart (osTimerId_t timer_id, uint32_t ticks)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (timer_id == nullptr || ticks == 0)
+    {
+      return osErrorParameter;
+    }
+
+  return to_status ((static_cast<timer_cb*> (timer_id))->object.start (ticks));
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osTimerStop (osTimerId_t timer_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (timer_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  return to_status ((static_cast<timer_cb*> (timer_id))->object.stop ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osTimerIsRunning (osTimerId_t timer_id)
+{
+  if (interrupts::in_handler_mode () || timer_id == nullptr)
+    {
+      return 0;
+    }
+
+  return ((static_cast<timer_cb*> (timer_id))->object.state ()
+      == timer::state::running) ? 1 : 0;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osTimerDelete (osTimerId_t timer_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (timer_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  destroy_cb (static_cast<timer_cb*> (timer_id));
+  return osOK;
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Event Flags Management Functions ====
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osEventFlagsId_t
+osEventFlagsNew (const osEventFlagsAttr_t* attr)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return nullptr;
+    }
+
+  static const osEventFlagsAttr_t default_attr
+    { };
+  if (attr == nullptr)
+    {
+      attr = &default_attr;
+    }
+
+  uint32_t cb_flags;
+  void* mem = allocate_cb<evflags_cb> (attr->cb_mem, attr->cb_size, cb_flags);
+  if (mem == nullptr)
+    {
+      return nullptr;
+    }
+
+  return new (mem) evflags_cb (cb_flags, attr->name);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+const char*
+osEventFlagsGetName (osEventFlagsId_t ef_id)
+{
+  if (ef_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<evflags_cb*> (ef_id))->object.name ();
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osEventFlagsSet (osEventFlagsId_t ef_id, uint32_t flags)
+{
+  if (ef_id == nullptr || (flags & osFlagsError) != 0)
+    {
+      return osFlagsErrorParameter;
+    }
+
+  flags::mask_t oflags;
+  result_t res = (static_cast<evflags_cb*> (ef_id))->object.raise (flags,
+                                                                   &oflags);
+  if (res != result::ok)
+    {
+      return to_flags_error (res);
+    }
+  return oflags | flags;
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osEventFlagsClear (osEventFlagsId_t ef_id, uint32_t flags)
+{
+  if (ef_id == nullptr || (flags & osFlagsError) != 0)
+    {
+      return osFlagsErrorParameter;
+    }
+
+  flags::mask_t oflags;
+  result_t res = (static_cast<evflags_cb*> (ef_id))->object.clear (flags,
+                                                                   &oflags);
+  if (res != result::ok)
+    {
+      return to_flags_error (res);
+    }
+  return oflags;
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osEventFlagsGet (osEventFlagsId_t ef_id)
+{
+  if (ef_id == nullptr)
+    {
+      return 0;
+    }
+
+  return (static_cast<evflags_cb*> (ef_id))->object.get (0, 0);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines,
+ * with a zero timeout.
+ */
+uint32_t
+osEventFlagsWait (osEventFlagsId_t ef_id, uint32_t flags, uint32_t options,
+                  uint32_t timeout)
+{
+  if (ef_id == nullptr || (flags & osFlagsError) != 0)
+    {
+      return osFlagsErrorParameter;
+    }
+  if (interrupts::in_handler_mode () && timeout != 0)
+    {
+      return osFlagsErrorParameter;
+    }
+
+  event_flags& ef = (static_cast<evflags_cb*> (ef_id))->object;
+  flags::mode_t mode = to_flags_mode (options);
+  flags::mask_t oflags = 0;
+  result_t res;
+  if (timeout == 0)
+    {
+      res = ef.try_wait (flags, &oflags, mode);
+    }
+  else if (timeout == osWaitForever)
+    {
+      res = ef.wait (flags, &oflags, mode);
+    }
+  else
+    {
+      res = ef.timed_wait (flags, timeout, &oflags, mode);
+    }
+
+  if (res != result::ok)
+    {
+      return to_flags_error (res);
+    }
+  return oflags;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osEventFlagsDelete (osEventFlagsId_t ef_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (ef_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  destroy_cb (static_cast<evflags_cb*> (ef_id));
+  return osOK;
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Mutex Management Functions ====
+
+/**
+ * @details
+ * Non recursive CMSIS mutexes are µOS++ error checking mutexes,
+ * such that relocking them fails instead of deadlocking.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osMutexId_t
+osMutexNew (const osMutexAttr_t* attr)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return nullptr;
+    }
+
+  static const osMutexAttr_t default_attr
+    { };
+  if (attr == nullptr)
+    {
+      attr = &default_attr;
+    }
+
+  mutex::attributes mx_attr;
+  mx_attr.mx_type =
+      ((attr->attr_bits & osMutexRecursive) != 0) ?
+          mutex::type::recursive : mutex::type::errorcheck;
+  mx_attr.mx_protocol =
+      ((attr->attr_bits & osMutexPrioInherit) != 0) ?
+          mutex::protocol::inherit : mutex::protocol::none;
+  mx_attr.mx_robustness =
+      ((attr->attr_bits & osMutexRobust) != 0) ?
+          mutex::robustness::robust : mutex::robustness::stalled;
+
+  uint32_t cb_flags;
+  void* mem = allocate_cb<mutex_cb> (attr->cb_mem, attr->cb_size, cb_flags);
+  if (mem == nullptr)
+    {
+      return nullptr;
+    }
+
+  return new (mem) mutex_cb (cb_flags, attr->name, mx_attr);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+const char*
+osMutexGetName (osMutexId_t mutex_id)
+{
+  if (mutex_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<mutex_cb*> (mutex_id))->object.name ();
+}
+
+/**
+ * @details
+ * A robust mutex whose owner terminated is made consistent and
+ * acquired.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osMutexAcquire (osMutexId_t mutex_id, uint32_t timeout)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (mutex_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  mutex& mx = (static_cast<mutex_cb*> (mutex_id))->object;
+  result_t res;
+  if (timeout == 0)
+    {
+      res = mx.try_lock ();
+    }
+  else if (timeout == osWaitForever)
+    {
+      res = mx.lock ();
+    }
+  else
+    {
+      res = mx.timed_lock (timeout);
+    }
+
+  if (res == EOWNERDEAD)
+    {
+      res = mx.consistent ();
+    }
+  return to_status (res);
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osMutexRelease (osMutexId_t mutex_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (mutex_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  return to_status ((static_cast<mutex_cb*> (mutex_id))->object.unlock ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osThreadId_t
+osMutexGetOwner (osMutexId_t mutex_id)
+{
+  if (interrupts::in_handler_mode () || mutex_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<mutex_cb*> (mutex_id))->object.owner ();
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osMutexDelete (osMutexId_t mutex_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (mutex_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  destroy_cb (static_cast<mutex_cb*> (mutex_id));
+  return osOK;
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Semaphore Management Functions ====
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osSemaphoreId_t
+osSemaphoreNew (uint32_t max_count, uint32_t initial_count,
+                const osSemaphoreAttr_t* attr)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return nullptr;
+    }
+
+  if (max_count == 0 || max_count > semaphore::max_count_value
+      || initial_count > max_count)
+    {
+      return nullptr;
+    }
+
+  static const osSemaphoreAttr_t default_attr
+    { };
+  if (attr == nullptr)
+    {
+      attr = &default_attr;
+    }
+
+  semaphore::attributes sm_attr;
+  sm_attr.sm_max_value = static_cast<semaphore::count_t> (max_count);
+  sm_attr.sm_initial_value = static_cast<semaphore::count_t> (initial_count);
+
+  uint32_t cb_flags;
+  void* mem = allocate_cb<semaphore_cb> (attr->cb_mem, attr->cb_size,
+                                         cb_flags);
+  if (mem == nullptr)
+    {
+      return nullptr;
+    }
+
+  return new (mem) semaphore_cb (cb_flags, attr->name, sm_attr);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+const char*
+osSemaphoreGetName (osSemaphoreId_t semaphore_id)
+{
+  if (semaphore_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<semaphore_cb*> (semaphore_id))->object.name ();
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines,
+ * with a zero timeout.
+ */
+osStatus_t
+osSemaphoreAcquire (osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+  if (semaphore_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+  if (interrupts::in_handler_mode () && timeout != 0)
+    {
+      return osErrorParameter;
+    }
+
+  semaphore& sm = (static_cast<semaphore_cb*> (semaphore_id))->object;
+  result_t res;
+  if (timeout == 0)
+    {
+      res = sm.try_wait ();
+    }
+  else if (timeout == osWaitForever)
+    {
+      res = sm.wait ();
+    }
+  else
+    {
+      res = sm.timed_wait (timeout);
+    }
+  return to_status (res);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osSemaphoreRelease (osSemaphoreId_t semaphore_id)
+{
+  if (semaphore_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  return to_status ((static_cast<semaphore_cb*> (semaphore_id))->object.post ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osSemaphoreGetCount (osSemaphoreId_t semaphore_id)
+{
+  if (semaphore_id == nullptr)
+    {
+      return 0;
+    }
+
+  semaphore::count_t count =
+      (static_cast<semaphore_cb*> (semaphore_id))->object.value ();
+  return (count > 0) ? static_cast<uint32_t> (count) : 0;
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osSemaphoreDelete (osSemaphoreId_t semaphore_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (semaphore_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  destroy_cb (static_cast<semaphore_cb*> (semaphore_id));
+  return osOK;
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Memory Pool Management Functions ====
+
+/**
+ * @details
+ * If `attr->mp_mem` is given, it must have at least
+ * `osMemoryPoolMemSize(block_count, block_size)` bytes,
+ * otherwise the storage is dynamically allocated.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osMemoryPoolId_t
+osMemoryPoolNew (uint32_t block_count, uint32_t block_size,
+                 const osMemoryPoolAttr_t* attr)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return nullptr;
+    }
+
+  if (block_count == 0 || block_count > memory_pool::max_size
+      || block_size == 0 || block_size > memory_pool::max_size)
+    {
+      return nullptr;
+    }
+
+  static const osMemoryPoolAttr_t default_attr
+    { };
+  if (attr == nullptr)
+    {
+      attr = &default_attr;
+    }
+
+  memory_pool::attributes mp_attr;
+  if (attr->mp_mem != nullptr)
+    {
+      if (attr->mp_size < osMemoryPoolMemSize(block_count, block_size))
+        {
+          return nullptr;
+        }
+      mp_attr.mp_pool_address = attr->mp_mem;
+      mp_attr.mp_pool_size_bytes = attr->mp_size;
+    }
+  else if (attr->mp_size != 0)
+    {
+      return nullptr;
+    }
+
+  uint32_t cb_flags;
+  void* mem = allocate_cb<mempool_cb> (attr->cb_mem, attr->cb_size, cb_flags);
+  if (mem == nullptr)
+    {
+      return nullptr;
+    }
+
+  return new (mem) mempool_cb (cb_flags, attr->name, block_count, block_size,
+                               mp_attr);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+const char*
+osMemoryPoolGetName (osMemoryPoolId_t mp_id)
+{
+  if (mp_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<mempool_cb*> (mp_id))->object.name ();
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines,
+ * with a zero timeout.
+ */
+void*
+osMemoryPoolAlloc (osMemoryPoolId_t mp_id, uint32_t timeout)
+{
+  if (mp_id == nullptr)
+    {
+      return nullptr;
+    }
+  if (interrupts::in_handler_mode () && timeout != 0)
+    {
+      return nullptr;
+    }
+
+  memory_pool& mp = (static_cast<mempool_cb*> (mp_id))->object;
+  if (timeout == 0)
+    {
+      return mp.try_alloc ();
+    }
+  else if (timeout == osWaitForever)
+    {
+      return mp.alloc ();
+    }
+  return mp.timed_alloc (timeout);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osMemoryPoolFree (osMemoryPoolId_t mp_id, void* block)
+{
+  if (mp_id == nullptr || block == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  return to_status ((static_cast<mempool_cb*> (mp_id))->object.free (block));
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMemoryPoolGetCapacity (osMemoryPoolId_t mp_id)
+{
+  if (mp_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<mempool_cb*> (mp_id))->object.capacity ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMemoryPoolGetBlockSize (osMemoryPoolId_t mp_id)
+{
+  if (mp_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<mempool_cb*> (mp_id))->object.block_size ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMemoryPoolGetCount (osMemoryPoolId_t mp_id)
+{
+  if (mp_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<mempool_cb*> (mp_id))->object.count ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMemoryPoolGetSpace (osMemoryPoolId_t mp_id)
+{
+  if (mp_id == nullptr)
+    {
+      return 0;
+    }
+
+  memory_pool& mp = (static_cast<mempool_cb*> (mp_id))->object;
+  return static_cast<uint32_t> (mp.capacity () - mp.count ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osMemoryPoolDelete (osMemoryPoolId_t mp_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (mp_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  destroy_cb (static_cast<mempool_cb*> (mp_id));
+  return osOK;
+}
+
+// ----------------------------------------------------------------------------
+//  ==== Message Queue Management Functions ====
+
+/**
+ * @details
+ * If `attr->mq_mem` is given, it must have at least
+ * `osMessageQueueMemSize(msg_count, msg_size)` bytes,
+ * otherwise the storage is dynamically allocated.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osMessageQueueId_t
+osMessageQueueNew (uint32_t msg_count, uint32_t msg_size,
+                   const osMessageQueueAttr_t* attr)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return nullptr;
+    }
+
+  if (msg_count == 0 || msg_count > message_queue::max_size || msg_size == 0
+      || msg_size > message_queue::max_msg_size)
+    {
+      return nullptr;
+    }
+
+  static const osMessageQueueAttr_t default_attr
+    { };
+  if (attr == nullptr)
+    {
+      attr = &default_attr;
+    }
+
+  message_queue::attributes mq_attr;
+  if (attr->mq_mem != nullptr)
+    {
+      if (attr->mq_size < osMessageQueueMemSize(msg_count, msg_size))
+        {
+          return nullptr;
+        }
+      mq_attr.mq_queue_address = attr->mq_mem;
+      mq_attr.mq_queue_size_bytes = attr->mq_size;
+    }
+  else if (attr->mq_size != 0)
+    {
+      return nullptr;
+    }
+
+  uint32_t cb_flags;
+  void* mem = allocate_cb<mqueue_cb> (attr->cb_mem, attr->cb_size, cb_flags);
+  if (mem == nullptr)
+    {
+      return nullptr;
+    }
+
+  return new (mem) mqueue_cb (cb_flags, attr->name, msg_count, msg_size,
+                              mq_attr);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+const char*
+osMessageQueueGetName (osMessageQueueId_t mq_id)
+{
+  if (mq_id == nullptr)
+    {
+      return nullptr;
+    }
+
+  return (static_cast<mqueue_cb*> (mq_id))->object.name ();
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines,
+ * with a zero timeout.
+ */
+osStatus_t
+osMessageQueuePut (osMessageQueueId_t mq_id, const void* msg_ptr,
+                   uint8_t msg_prio, uint32_t timeout)
+{
+  if (mq_id == nullptr || msg_ptr == nullptr)
+    {
+      return osErrorParameter;
+    }
+  if (interrupts::in_handler_mode () && timeout != 0)
+    {
+      return osErrorParameter;
+    }
+
+  message_queue& mq = (static_cast<mqueue_cb*> (mq_id))->object;
+  result_t res;
+  if (timeout == 0)
+    {
+      res = mq.try_send (msg_ptr, mq.msg_size (), msg_prio);
+    }
+  else if (timeout == osWaitForever)
+    {
+      res = mq.send (msg_ptr, mq.msg_size (), msg_prio);
+    }
+  else
+    {
+      res = mq.timed_send (msg_ptr, mq.msg_size (), timeout, msg_prio);
+    }
+  return to_status (res);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines,
+ * with a zero timeout.
+ */
+osStatus_t
+osMessageQueueGet (osMessageQueueId_t mq_id, void* msg_ptr, uint8_t* msg_prio,
+                   uint32_t timeout)
+{
+  if (mq_id == nullptr || msg_ptr == nullptr)
+    {
+      return osErrorParameter;
+    }
+  if (interrupts::in_handler_mode () && timeout != 0)
+    {
+      return osErrorParameter;
+    }
+
+  message_queue& mq = (static_cast<mqueue_cb*> (mq_id))->object;
+  result_t res;
+  if (timeout == 0)
+    {
+      res = mq.try_receive (msg_ptr, mq.msg_size (), msg_prio);
+    }
+  else if (timeout == osWaitForever)
+    {
+      res = mq.receive (msg_ptr, mq.msg_size (), msg_prio);
+    }
+  else
+    {
+      res = mq.timed_receive (msg_ptr, mq.msg_size (), timeout, msg_prio);
+    }
+  return to_status (res);
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMessageQueueGetCapacity (osMessageQueueId_t mq_id)
+{
+  if (mq_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<mqueue_cb*> (mq_id))->object.capacity ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMessageQueueGetMsgSize (osMessageQueueId_t mq_id)
+{
+  if (mq_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<mqueue_cb*> (mq_id))->object.msg_size ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMessageQueueGetCount (osMessageQueueId_t mq_id)
+{
+  if (mq_id == nullptr)
+    {
+      return 0;
+    }
+
+  return static_cast<uint32_t> ((static_cast<mqueue_cb*> (mq_id))->object.length ());
+}
+
+/**
+ * @note Can be invoked from Interrupt Service Routines.
+ */
+uint32_t
+osMessageQueueGetSpace (osMessageQueueId_t mq_id)
+{
+  if (mq_id == nullptr)
+    {
+      return 0;
+    }
+
+  message_queue& mq = (static_cast<mqueue_cb*> (mq_id))->object;
+  return static_cast<uint32_t> (mq.capacity () - mq.length ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osMessageQueueReset (osMessageQueueId_t mq_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (mq_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  return to_status ((static_cast<mqueue_cb*> (mq_id))->object.reset ());
+}
+
+/**
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+osStatus_t
+osMessageQueueDelete (osMessageQueueId_t mq_id)
+{
+  if (interrupts::in_handler_mode ())
+    {
+      return osErrorISR;
+    }
+
+  if (mq_id == nullptr)
+    {
+      return osErrorParameter;
+    }
+
+  destroy_cb (static_cast<mqueue_cb*> (mq_id));
+  return osOK;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_USE_CMSIS_OS2) */
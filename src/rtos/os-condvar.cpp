@@ -258,7 +258,7 @@ namespace os
      *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
      */
     condition_variable::condition_variable (
-        const char* name, const attributes& attr __attribute__((unused))) :
+        const char* name, const attributes& attr) :
         object_named_system
           { name }
     {
@@ -268,6 +268,12 @@ namespace os
 
       // Don't call this from interrupt handlers.
       os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+#if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+#else
+      (void) attr;
+#endif
     }
 
     /**
@@ -342,7 +348,12 @@ namespace os
       // Don't call this from interrupt handlers.
       os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
-      list_.resume_one ();
+      // If the mutex is held, the waiting thread is moved directly
+      // to the mutex list, it will be resumed by the mutex unlock.
+      if (!internal_requeue_ (false))
+        {
+          list_.resume_one ();
+        }
 
       return result::ok;
     }
@@ -412,10 +423,16 @@ namespace os
       // Don't call this from interrupt handlers.
       os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
-      // Wake-up all threads, if any.
-      // Need not be inside the critical section,
-      // the list is protected by inner `resume_one()`.
-      list_.resume_all ();
+      // Move the waiting threads to the mutex list, except the
+      // one that can acquire the mutex now, if it is free; this
+      // avoids waking up all threads only to block again on the mutex.
+      if (!internal_requeue_ (true))
+        {
+          // Wake-up all remaining threads, if any.
+          // Need not be inside the critical section,
+          // the list is protected by inner `resume_all()`.
+          list_.resume_all ();
+        }
 
       return result::ok;
     }
@@ -522,30 +539,54 @@ namespace os
       internal::waiting_thread_node node
         { crt_thread };
 
-      // TODO: validate
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
 
       result_t res;
-      res = mutex.unlock ();
 
-      if (res != result::ok)
         {
-          return res;
+          // ----- Enter critical section -----------------------------------
+          // Keep the scheduler locked, so that unlocking the mutex and
+          // queuing on the condition variable are atomic for other threads.
+          scheduler::critical_section scs;
+
+          res = mutex.unlock ();
+
+          if (res != result::ok)
+            {
+              return res;
+            }
+
+            {
+              // ----- Enter critical section -----------------------------
+              interrupts::critical_section ics;
+
+              mutex_ = &mutex;
+
+              // Add this thread to the condition variable waiting list.
+              scheduler::internal_link_node (list_, node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ------------------------------
+            }
+          // ----- Exit critical section -------------------------------------
         }
 
-        {
-          // Add this thread to the condition variable waiting list.
-          list_.link (node);
-          node.thread_->waiting_node_ = &node;
+      port::scheduler::reschedule ();
 
-          res = mutex.lock ();
+      // Remove the thread from the condition variable or mutex
+      // waiting list, if not already removed.
+      scheduler::internal_unlink_node (node);
 
-          // Remove the thread from the node waiting list,
-          // if not already removed.
-          node.thread_->waiting_node_ = nullptr;
-          node.unlink ();
-        }
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      // For condition variables the waits are always contended.
+      sync_statistics_.internal_mark_waited_ (wait_begin);
+      sync_statistics_.internal_mark_acquired_ ();
+#endif
 
-      return res;
+      // The mutex must be reacquired, regardless of the reason.
+      return mutex.lock ();
     }
 
     /**
@@ -668,30 +709,160 @@ namespace os
       internal::waiting_thread_node node
         { crt_thread };
 
-      // TODO: validate
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
 
       result_t res;
-      res = mutex.unlock ();
+
+        {
+          // ----- Enter critical section -----------------------------------
+          // Keep the scheduler locked, so that unlocking the mutex and
+          // queuing on the condition variable are atomic for other threads.
+          scheduler::critical_section scs;
+
+          res = mutex.unlock ();
+
+          if (res != result::ok)
+            {
+              return res;
+            }
+
+            {
+              // ----- Enter critical section -----------------------------
+              interrupts::critical_section ics;
+
+              mutex_ = &mutex;
+
+              // Add this thread to the condition variable waiting list,
+              // and the clock timeout list.
+              scheduler::internal_link_node (list_, node, clock_list,
+                                             timeout_node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ------------------------------
+            }
+          // ----- Exit critical section -------------------------------------
+        }
+
+      port::scheduler::reschedule ();
+
+      // Remove the thread from the condition variable or mutex
+      // waiting list, if not already removed, and from the clock
+      // timeout list, if not already removed by the timer.
+      scheduler::internal_unlink_node (node, timeout_node);
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      // For condition variables the waits are always contended.
+      sync_statistics_.internal_mark_waited_ (wait_begin);
+      sync_statistics_.internal_mark_acquired_ ();
+#endif
+
+      // The mutex must be reacquired, even after a timeout.
+      res = mutex.lock ();
 
       if (res != result::ok)
         {
           return res;
         }
 
+      if (clock_->steady_now () >= timeout_timestamp)
         {
-          // Add this thread to the condition variable waiting list.
-          list_.link (node);
-          node.thread_->waiting_node_ = &node;
+#if defined(OS_TRACE_RTOS_CONDVAR)
+          trace::printf ("%s(%u) ETIMEDOUT @%p %s\n", __func__,
+                         static_cast<unsigned int> (timeout), this, name ());
+#endif
+          return ETIMEDOUT;
+        }
 
-          res = mutex.timed_lock (timeout);
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * Wait morphing: if the mutex used by the waiting threads is
+     * currently owned, waking up the threads is useless, they would
+     * only run to block again on the mutex. Instead, they are
+     * moved directly to the mutex waiting list, still suspended, and
+     * will be resumed one at a time by `mutex::unlock()`.
+     *
+     * If the mutex is free, the highest priority thread is left
+     * on the condition variable list, to be resumed by the caller,
+     * and, for broadcast, all other threads are moved.
+     *
+     * Only mutexes without a priority protocol are handled, since
+     * for the others the owner priority depends on the waiting list;
+     * for these the caller falls back to resume the threads.
+     */
+    bool
+    condition_variable::internal_requeue_ (bool all)
+    {
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (list_.empty ())
+        {
+          return true;
+        }
+
+      class mutex* mx = mutex_;
+      if (mx == nullptr || mx->protocol_ != mutex::protocol::none)
+        {
+          return false;
+        }
 
-          // Remove the thread from the node waiting list,
-          // if not already removed.
-          node.thread_->waiting_node_ = nullptr;
-          node.unlink ();
+      internal::waiting_thread_node* keep = nullptr;
+      if (mx->owner_ == nullptr)
+        {
+          if (!all)
+            {
+              return false;
+            }
+
+          // Keep the top thread, it will acquire the mutex.
+          keep = const_cast<internal::waiting_thread_node*> (list_.head ());
+          keep->unlink ();
         }
 
-      return res;
+      while (!list_.empty ())
+        {
+          internal::waiting_thread_node* node =
+              const_cast<internal::waiting_thread_node*> (list_.head ());
+          node->unlink ();
+
+          // The thread remains suspended, only the list changes.
+          mx->list_.link (*node);
+
+          if (!all)
+            {
+              break;
+            }
+        }
+
+      if (keep != nullptr)
+        {
+          list_.link (*keep);
+          return false;
+        }
+
+      return true;
+      // ----- Exit critical section ------------------------------------------
+
+#else
+
+      (void) all;
+      return false;
+
+#endif
     }
 
   // --------------------------------------------------------------------------
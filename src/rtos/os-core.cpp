@@ -96,6 +96,14 @@ namespace os
 
       bool is_preemptive_ = false;
 
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE)
+
+      // Set by the interrupt handlers which resumed threads,
+      // cleared by interrupts::handler_exit().
+      static bool volatile reschedule_pending_ = false;
+
+#endif /* defined(OS_USE_RTOS_COALESCED_RESCHEDULE) */
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpadded"
       // A small kludge to provide a temporary errno before
@@ -163,6 +171,8 @@ namespace os
         // Don't call this from interrupt handlers.
         os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
+        events::initialize ();
+
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
 
         return port::scheduler::initialize ();
@@ -208,6 +218,13 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        scheduler::statistics::coalesced_reschedules_ = 0;
+
+#endif
+
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
         is_preemptive_ = OS_BOOL_RTOS_SCHEDULER_PREEMPTIVE;
 #endif /* defined(OS_USE_RTOS_PORT_SCHEDULER) */
@@ -400,7 +417,38 @@ namespace os
 
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
 
-      void
+      /**
+       * @details
+       * A running thread with a preemption threshold keeps
+       * the CPU while the highest priority ready thread is above
+       * its own priority but not above the threshold.
+       *
+       * Threads with the same priority are not affected, so
+       * yields and time slicing still rotate them.
+       */
+      static bool
+      internal_is_preemption_blocked_ (void)
+      {
+        thread* crt = scheduler::current_thread_;
+        if (crt->state () != thread::state::running)
+          {
+            return false;
+          }
+
+        thread::priority_t threshold = crt->preemption_threshold ();
+        thread::priority_t prio = crt->priority ();
+        if (threshold <= prio || scheduler::ready_threads_list_.empty ())
+          {
+            return false;
+          }
+
+        thread::priority_t top =
+            scheduler::ready_threads_list_.head ()->thread_->priority ();
+
+        return (top > prio) && (top <= threshold);
+      }
+
+      void OS_ATTRIBUTE_HOT_PATH
       internal_switch_threads (void)
       {
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
@@ -420,25 +468,57 @@ namespace os
         // Accumulate durations to old thread.
         scheduler::current_thread_->statistics_.cpu_cycles_ += delta;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+        // Charge the budget of the current period.
+        scheduler::current_thread_->budget_used_ += delta;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
         // Remember the timestamp for the next context switch.
         scheduler::statistics::switch_timestamp_ = now;
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+        thread* old_thread = scheduler::current_thread_;
+
         // The very core of the scheduler, if not locked, re-link the
         // current thread and return the top priority thread.
-        if (!locked ())
+        if (!locked () && !internal_is_preemption_blocked_ ())
           {
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+            // A running thread that used its budget is demoted or
+            // suspended before being re-linked.
+            if (old_thread->budget_cycles_ != 0
+                && old_thread->state_ == thread::state::running
+                && old_thread->budget_used_ >= old_thread->budget_cycles_
+                && !old_thread->budget_exhausted_)
+              {
+                old_thread->internal_exhaust_cpu_budget_ ();
+              }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
             // Normally the old running thread must be re-linked to ready.
             scheduler::current_thread_->internal_relink_running_ ();
 
             // The top of the ready list gives the next thread to run.
             scheduler::current_thread_ =
                 scheduler::ready_threads_list_.unlink_head ();
+
+            // Start a new time slice.
+            scheduler::current_thread_->quantum_remaining_ =
+                scheduler::current_thread_->quantum_ticks_;
           }
 
         // ***** Pointer switched to new thread! *****
 
+        if (scheduler::current_thread_ != old_thread)
+          {
+            events::thread_switched (old_thread, scheduler::current_thread_);
+          }
+
         // The new thread was marked as running in unlink_head(),
         // so in case the handler is re-entered immediately,
         // the relink_running() will simply reschedule it,
@@ -456,6 +536,76 @@ namespace os
 
       }
 
+      /**
+       * @details
+       * Called from the SysTick handler, to account the current
+       * tick to the time slice of the running thread.
+       *
+       * Threads with a zero quantum are not time sliced, and
+       * a reschedule is requested on every tick, as before.
+       *
+       * @return true if the scheduler must run.
+       */
+      bool
+      internal_check_quantum (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        thread* th = scheduler::current_thread_;
+        if (th == nullptr || th->quantum_ticks_ == 0)
+          {
+            return true;
+          }
+
+        if (th->quantum_remaining_ > 1)
+          {
+            --th->quantum_remaining_;
+            return false;
+          }
+
+        // Time slice expired, the thread will be re-linked behind
+        // the ready threads with the same priority.
+        th->quantum_remaining_ = 0;
+        return true;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * Called after threads were made ready. From thread context,
+       * the port reschedule is requested at once; from interrupt
+       * handlers, if `OS_USE_RTOS_COALESCED_RESCHEDULE` is defined,
+       * it is only marked as needed, and all requests done until
+       * the handler exit are served by a single switch.
+       */
+      void
+      internal_request_reschedule (void)
+      {
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE)
+
+        if (interrupts::in_handler_mode ())
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (reschedule_pending_)
+              {
+                ++statistics::coalesced_reschedules_;
+              }
+            else
+              {
+                reschedule_pending_ = true;
+              }
+            return;
+            // ----- Exit critical section ------------------------------------
+          }
+
+#endif /* defined(OS_USE_RTOS_COALESCED_RESCHEDULE) */
+
+        port::scheduler::reschedule ();
+      }
+
 #endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
 
       namespace statistics
@@ -473,6 +623,13 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        rtos::statistics::counter_t coalesced_reschedules_;
+
+#endif
+
       } /* namespace statistics */
 
     /**
@@ -566,6 +723,48 @@ namespace os
 
 #endif /* defined(OS_HAS_INTERRUPTS_STACK) */
 
+      /**
+       * @details
+       * When `OS_USE_RTOS_COALESCED_RESCHEDULE` is defined, the
+       * threads resumed by interrupt handlers (semaphore posts,
+       * message queue sends, event flags raises, etc) do not
+       * request a reschedule each, but only mark it as needed;
+       * an interrupt handler which may resume threads must call
+       * this function as its last action, to issue a single
+       * reschedule for all of them.
+       *
+       * When nested, any exit issues the pending reschedule; on
+       * Cortex-M ports the PendSV runs after the outermost handler
+       * anyway.
+       *
+       * Otherwise the function does nothing.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      void
+      handler_exit (void)
+      {
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        bool pending;
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            pending = scheduler::reschedule_pending_;
+            scheduler::reschedule_pending_ = false;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        if (pending)
+          {
+            port::scheduler::reschedule ();
+          }
+
+#endif
+      }
+
       ;
     // Avoid formatter bug.
     }
@@ -594,31 +793,6 @@ namespace os
        * string (stored in flash) is preferred.
        */
 
-      /**
-       *
-       */
-      object_named::object_named ()
-      {
-        ;
-      }
-
-      /**
-       * @details
-       * Prefer the given name, otherwise
-       * default to '-'.
-       *
-       * To save space, instead of copying the null terminated string
-       * locally, the pointer to the string
-       * is copied, so the caller must ensure that the pointer
-       * life cycle is at least as long as the object life cycle.
-       * A constant string (stored in flash) is preferred.
-       */
-      object_named::object_named (const char* name) :
-          name_ (name != nullptr ? name : "-")
-      {
-        ;
-      }
-
     } /* namespace internal */
 
   // ==========================================================================
@@ -640,9 +814,15 @@ __errno (void);
  * Standard C libraries define `errno` as a macro to a function returning
  * a pointer. This function returns such a pointer, specific to each
  * thread.
+ *
+ * The value is kept in the thread object, not in the newlib
+ * reentrancy structure, so it does not require one to be allocated;
+ * with the reference scheduler the pointer is computed with a
+ * single load.
+ *
  * @return Pointer to per-thread errno value.
  */
-int*
+int* OS_ATTRIBUTE_HOT_PATH
 __errno (void)
 {
   return os::rtos::this_thread::__errno ();
@@ -0,0 +1,826 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// The coroutines require C++20.
+#if defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+#include <cstdlib>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace coroutine
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class awaiter
+       * @details
+       * While the coroutine is suspended, the awaiter node is
+       * linked to the waiting list of the object, like the node
+       * of a thread waiting for it, except that it points to the
+       * executor thread; when the object is posted, the node is
+       * unlinked and the executor thread is resumed, and it tries
+       * the operation again, on behalf of the coroutine.
+       *
+       * Since the awaiters live in the coroutine frame, no memory is
+       * allocated to wait.
+       */
+
+      awaiter::awaiter (void)
+      {
+        ;
+      }
+
+      awaiter::~awaiter ()
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * Called by the compiler when the coroutine is suspended;
+       * if the operation can be completed without blocking,
+       * the coroutine continues at once.
+       */
+      bool
+      awaiter::await_suspend (std::coroutine_handle<task_promise> handle) noexcept
+      {
+        executor_ = handle.promise ().executor_;
+        handle_ = handle;
+
+        return executor_->internal_suspend_ (*this);
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      awaiter::internal_try_ (void)
+      {
+        return false;
+      }
+
+      bool
+      awaiter::internal_start_ (void)
+      {
+        return true;
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      semaphore_awaiter::semaphore_awaiter (semaphore& sem) :
+          sem_ (sem)
+      {
+        list_ = &sem.list_;
+      }
+
+      semaphore_awaiter::semaphore_awaiter (semaphore& sem,
+                                            clock::duration_t timeout) :
+          semaphore_awaiter
+            { sem }
+      {
+        timeout_ = timeout;
+        timed_ = true;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      semaphore_awaiter::internal_try_ (void)
+      {
+        return (sem_.try_wait () == result::ok);
+      }
+
+      /**
+       * @endcond
+       */
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
+      // ----------------------------------------------------------------------
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      receive_awaiter::receive_awaiter (message_queue& mq, void* msg,
+                                        std::size_t nbytes,
+                                        message_queue::priority_t* mprio) :
+          mq_ (mq), //
+          msg_ (msg), //
+          nbytes_ (nbytes), //
+          mprio_ (mprio)
+      {
+        list_ = &mq.receive_list_;
+      }
+
+      receive_awaiter::receive_awaiter (message_queue& mq, void* msg,
+                                        std::size_t nbytes,
+                                        clock::duration_t timeout,
+                                        message_queue::priority_t* mprio) :
+          receive_awaiter
+            { mq, msg, nbytes, mprio }
+      {
+        timeout_ = timeout;
+        timed_ = true;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      receive_awaiter::internal_try_ (void)
+      {
+        return (mq_.try_receive (msg_, nbytes_, mprio_) == result::ok);
+      }
+
+      /**
+       * @endcond
+       */
+
+      send_awaiter::send_awaiter (message_queue& mq, const void* msg,
+                                  std::size_t nbytes,
+                                  message_queue::priority_t mprio) :
+          mq_ (mq), //
+          msg_ (msg), //
+          nbytes_ (nbytes), //
+          mprio_ (mprio)
+      {
+        list_ = &mq.send_list_;
+      }
+
+      send_awaiter::send_awaiter (message_queue& mq, const void* msg,
+                                  std::size_t nbytes,
+                                  clock::duration_t timeout,
+                                  message_queue::priority_t mprio) :
+          send_awaiter
+            { mq, msg, nbytes, mprio }
+      {
+        timeout_ = timeout;
+        timed_ = true;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      send_awaiter::internal_try_ (void)
+      {
+        return (mq_.try_send (msg_, nbytes_, mprio_) == result::ok);
+      }
+
+      /**
+       * @endcond
+       */
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+      // ----------------------------------------------------------------------
+
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+      event_flags_awaiter::event_flags_awaiter (event_flags& evf,
+                                                flags::mask_t mask,
+                                                flags::mask_t* oflags,
+                                                flags::mode_t mode) :
+          evf_ (evf), //
+          mask_ (mask), //
+          oflags_ (oflags), //
+          mode_ (mode)
+      {
+        list_ = &evf.list_;
+
+        // Used by raise() to wake only the awaiters with
+        // the condition true.
+        node_.flags_mask_ = mask;
+        node_.flags_mode_ = mode;
+      }
+
+      event_flags_awaiter::event_flags_awaiter (event_flags& evf,
+                                                flags::mask_t mask,
+                                                clock::duration_t timeout,
+                                                flags::mask_t* oflags,
+                                                flags::mode_t mode) :
+          event_flags_awaiter
+            { evf, mask, oflags, mode }
+      {
+        timeout_ = timeout;
+        timed_ = true;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      event_flags_awaiter::internal_try_ (void)
+      {
+        return (evf_.try_wait (mask_, oflags_, mode_) == result::ok);
+      }
+
+      /**
+       * @endcond
+       */
+
+#endif /* !defined(OS_USE_RTOS_PORT_EVENT_FLAGS) */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * The awaiter is not linked to any object, and the
+       * coroutine is resumed only by the timeout.
+       */
+      sleep_awaiter::sleep_awaiter (clock::duration_t duration)
+      {
+        timeout_ = duration;
+        timed_ = true;
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class task_promise
+       * @details
+       * Without exceptions, if the frame cannot be allocated,
+       * the coroutine returns an invalid task, and `spawn()`
+       * fails with `ENOMEM`.
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      task
+      task_promise::get_return_object (void) noexcept
+      {
+        return task
+          { std::coroutine_handle<task_promise>::from_promise (*this) };
+      }
+
+      task
+      task_promise::get_return_object_on_allocation_failure (void) noexcept
+      {
+        return task
+          { std::coroutine_handle<task_promise>
+            { } };
+      }
+
+      void
+      task_promise::unhandled_exception (void) const noexcept
+      {
+        abort ();
+      }
+
+      void*
+      task_promise::operator new (std::size_t bytes) noexcept
+      {
+        return memory::get_default_resource ()->allocate (bytes);
+      }
+
+      void
+      task_promise::operator delete (void* addr, std::size_t bytes) noexcept
+      {
+        memory::get_default_resource ()->deallocate (addr, bytes);
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      task::~task ()
+      {
+        if (handle_)
+          {
+            // Never spawned.
+            handle_.destroy ();
+          }
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class executor::attributes
+       * @details
+       * Allow to define the executor thread characteristics and
+       * the clock used for the timeouts.
+       */
+
+      /**
+       * @details
+       * This variable is used by the default constructor.
+       */
+      const executor::attributes executor::initializer;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class executor
+       * @details
+       * The executor thread runs coroutines which would otherwise
+       * each need a thread and a stack, only to wait for an object;
+       * the coroutines suspend when awaiting, and only their frames,
+       * usually some tens of bytes, are kept, so many state machines
+       * can share a single stack.
+       *
+       * The awaiters are linked to the object waiting lists on
+       * behalf of the executor thread, so the objects are posted
+       * as usual, from threads or interrupt handlers; the executor
+       * thread is resumed and it completes the operations for the
+       * coroutines, then resumes them, in order.
+       *
+       * The coroutines must not call blocking functions, since
+       * they would block all coroutines.
+       *
+       * @par Example
+       *
+       * @code{.cpp}
+       * semaphore sem { "sem" };
+       *
+       * coroutine::task
+       * blink (void)
+       * {
+       *   for (;;)
+       *     {
+       *       co_await coroutine::wait (sem);
+       *       led.toggle ();
+       *       co_await coroutine::sleep_for (100);
+       *     }
+       * }
+       *
+       * coroutine::executor_inclusive<2048> ex { "ex" };
+       *
+       * ex.spawn (blink ());
+       * @endcode
+       *
+       * @par POSIX compatibility
+       *  No POSIX similar functionality identified.
+       */
+
+      /**
+       * @details
+       * This constructor shall initialise an executor object
+       * with attributes referenced by _attr_.
+       * If the attributes specified by _attr_ are modified later,
+       * the executor attributes shall not be affected.
+       *
+       * The executor thread is created and started.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      executor::executor (const attributes& attr) :
+          executor
+            { nullptr, attr }
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * This constructor shall initialise a named executor object
+       * with attributes referenced by _attr_.
+       * If the attributes specified by _attr_ are modified later,
+       * the executor attributes shall not be affected.
+       *
+       * The executor thread is created and started.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      executor::executor (const char* name, const attributes& attr) :
+          executor
+            { name, attr.th_stack_address, attr.th_stack_size_bytes, attr }
+      {
+        ;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      executor::executor (const char* name, void* stack_address,
+                          std::size_t stack_size_bytes,
+                          const attributes& attr) :
+          object_named_system
+            { name }, //
+          clock_ (attr.clock != nullptr ? attr.clock : &sysclock), //
+          worker_
+            { name, internal_run_, this, internal_thread_attributes_ (
+                attr, stack_address, stack_size_bytes) }
+      {
+#if defined(OS_TRACE_RTOS_COROUTINE)
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+#endif
+      }
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @details
+       * The executor thread is stopped; the suspended coroutines
+       * are removed from the object lists and destroyed.
+       *
+       * @warning The coroutines waiting for callbacks, like
+       * the asynchronous reads, must complete before.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      executor::~executor ()
+      {
+#if defined(OS_TRACE_RTOS_COROUTINE)
+        trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+        stop_ = true;
+        wake_list_.resume_one ();
+
+        worker_.join ();
+      }
+
+      /**
+       * @details
+       * The executor takes the ownership of the coroutine, and
+       * resumes it for the first time from the executor thread;
+       * when the coroutine returns, the frame is destroyed.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      result_t
+      executor::spawn (task&& t)
+      {
+#if defined(OS_TRACE_RTOS_COROUTINE)
+        trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+        if (!t.valid ())
+          {
+            return ENOMEM;
+          }
+
+        std::coroutine_handle<task_promise> handle = t.handle_;
+        t.handle_ = nullptr;
+
+        task_promise& promise = handle.promise ();
+        promise.executor_ = this;
+        promise.start_.executor_ = this;
+        promise.start_.handle_ = handle;
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            ++tasks_;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        post (promise.start_);
+
+        return result::ok;
+      }
+
+      /**
+       * @details
+       * Used by the awaiters completed outside the objects, for
+       * example from the callbacks of the asynchronous I/O; the
+       * coroutine is resumed from the executor thread.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      void
+      executor::post (awaiter& aw)
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            posted_.link (aw);
+            // ----- Exit critical section ------------------------------------
+          }
+
+        wake_list_.resume_one ();
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      thread::attributes
+      executor::internal_thread_attributes_ (const attributes& attr,
+                                             void* stack_address,
+                                             std::size_t stack_size_bytes)
+      {
+        thread::attributes th_attr;
+
+        th_attr.th_stack_address = stack_address;
+        th_attr.th_stack_size_bytes = stack_size_bytes;
+        th_attr.th_priority = attr.th_priority;
+
+        return th_attr;
+      }
+
+      void*
+      executor::internal_run_ (void* args)
+      {
+        executor* ex = static_cast<executor*> (args);
+
+        ex->wake_node_.thread_ = &this_thread::thread ();
+
+        while (!ex->stop_)
+          {
+            clock::timestamp_t deadline = 0;
+            bool timed = ex->internal_collect_ (ex->clock_->steady_now (),
+                                                &deadline);
+
+            if (!ex->ready_.empty ())
+              {
+                ex->internal_resume_ready_ ();
+                continue;
+              }
+
+            ex->internal_sleep_ (timed, deadline);
+          }
+
+        ex->internal_destroy_all_ ();
+
+        return nullptr;
+      }
+
+      // Called from the coroutine, on the executor thread.
+      bool
+      executor::internal_suspend_ (awaiter& aw)
+      {
+        aw.result_ = result::ok;
+        if (aw.timed_)
+          {
+            aw.deadline_ = clock_->steady_now () + aw.timeout_;
+          }
+
+        if (aw.list_ != nullptr)
+          {
+            aw.node_.thread_ = &worker_;
+
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (aw.internal_try_ ())
+              {
+                return false;
+              }
+
+            // From now on, a post unlinks the node and
+            // resumes the executor thread.
+            aw.list_->link (aw.node_);
+            // ----- Exit critical section ------------------------------------
+          }
+        else if (!aw.timed_)
+          {
+            // Completed by a callback, which calls post().
+            return aw.internal_start_ ();
+          }
+
+        waiting_.link (aw);
+        return true;
+      }
+
+      // Move the completed awaiters to the ready list; return true
+      // if there are timed awaiters left, with the nearest deadline.
+      bool
+      executor::internal_collect_ (clock::timestamp_t now,
+                                   clock::timestamp_t* deadline)
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            while (!posted_.empty ())
+              {
+                ready_.link (*posted_.unlink_head ());
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        bool timed = false;
+        for (auto it = waiting_.begin (); it != waiting_.end ();)
+          {
+            awaiter* aw = &(*it);
+            ++it;
+
+            bool done = false;
+              {
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                if (aw->list_ != nullptr && aw->node_.unlinked ())
+                  {
+                    // Posted, but another waiter may have been faster.
+                    if (aw->internal_try_ ())
+                      {
+                        done = true;
+                      }
+                    else
+                      {
+                        aw->list_->link (aw->node_);
+                      }
+                  }
+
+                if (!done && aw->timed_ && now >= aw->deadline_)
+                  {
+                    aw->result_ = ETIMEDOUT;
+                    if (aw->list_ != nullptr)
+                      {
+                        aw->node_.unlink ();
+
+                        // Give a last chance, the object might have
+                        // been posted just before the timeout.
+                        if (aw->internal_try_ ())
+                          {
+                            aw->result_ = result::ok;
+                          }
+                      }
+                    done = true;
+                  }
+                // ----- Exit critical section --------------------------------
+              }
+
+            if (done)
+              {
+                aw->links_.unlink ();
+                ready_.link (*aw);
+              }
+            else if (aw->timed_ && (!timed || aw->deadline_ < *deadline))
+              {
+                *deadline = aw->deadline_;
+                timed = true;
+              }
+          }
+
+        return timed;
+      }
+
+      void
+      executor::internal_sleep_ (bool timed, clock::timestamp_t deadline)
+      {
+        internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+
+        // Prepare a timeout node pointing to the executor thread.
+        internal::timeout_thread_node timeout_node
+          { deadline, worker_ };
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            // Check again, the objects might have been posted
+            // after the scan.
+            if (stop_ || !posted_.empty ())
+              {
+                return;
+              }
+            for (auto it = waiting_.begin (); it != waiting_.end (); ++it)
+              {
+                if (it->list_ != nullptr && it->node_.unlinked ())
+                  {
+                    return;
+                  }
+              }
+
+            if (timed)
+              {
+                scheduler::internal_link_node (wake_list_, wake_node_,
+                                               clock_list, timeout_node);
+              }
+            else
+              {
+                scheduler::internal_link_node (wake_list_, wake_node_);
+              }
+            // state::suspended set in above link().
+            // ----- Exit critical section ------------------------------------
+          }
+
+        port::scheduler::reschedule ();
+
+        if (timed)
+          {
+            scheduler::internal_unlink_node (wake_node_, timeout_node);
+          }
+        else
+          {
+            scheduler::internal_unlink_node (wake_node_);
+          }
+      }
+
+      void
+      executor::internal_resume_ready_ (void)
+      {
+        while (!ready_.empty ())
+          {
+            awaiter* aw = ready_.unlink_head ();
+
+            // The awaiter is part of the frame, do not use it
+            // after resume().
+            std::coroutine_handle<> handle = aw->handle_;
+            handle.resume ();
+
+            if (handle.done ())
+              {
+                handle.destroy ();
+
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                --tasks_;
+                // ----- Exit critical section --------------------------------
+              }
+          }
+      }
+
+      void
+      executor::internal_destroy_all_ (void)
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            for (auto it = waiting_.begin (); it != waiting_.end (); ++it)
+              {
+                it->node_.unlink ();
+              }
+            while (!posted_.empty ())
+              {
+                ready_.link (*posted_.unlink_head ());
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        awaiters_list* lists[] =
+          { &ready_, &waiting_ };
+        for (awaiters_list* list : lists)
+          {
+            while (!list->empty ())
+              {
+                awaiter* aw = list->unlink_head ();
+                aw->handle_.destroy ();
+
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                --tasks_;
+                // ----- Exit critical section --------------------------------
+              }
+          }
+      }
+
+      /**
+       * @endcond
+       */
+
+    // ------------------------------------------------------------------------
+    } /* namespace coroutine */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,330 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+namespace os
+{
+  namespace rtos
+  {
+    // ========================================================================
+
+    /**
+     * @cond ignore
+     */
+
+    // All threads with a budget; in the BSS, so usable before
+    // the static constructors.
+    thread::budget_threads_list thread::budget_threads__;
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Limit the CPU time the thread may use in each period, to keep
+     * a runaway thread from starving the lower priority ones.
+     *
+     * The cycles are measured with the high resolution clock, at
+     * each context switch, as the CPU cycles statistics; the SysTick
+     * handler also requests a switch when the running thread reached
+     * its budget, so the overrun is at most one tick.
+     *
+     * When the budget is exhausted, the overrun is counted and
+     * `os_rtos_thread_cpu_budget_overrun_hook()` is called; then,
+     * until the end of the period, the thread either keeps running
+     * (`budget_action::report`), runs with the `demoted_prio`
+     * priority (`budget_action::demote`), or does not run
+     * (`budget_action::suspend`). The budget is replenished by
+     * the SysTick handler, when the period ends.
+     *
+     * While the scheduler is locked, the action is postponed until
+     * the first context switch after the unlock. Mutexes owned by
+     * a suspended thread remain locked until the next period, so
+     * the threads that share them should use `demote` or `report`.
+     *
+     * Setting a new budget, or removing it, cancels the action
+     * of the current period.
+     *
+     * @par POSIX compatibility
+     *  Inspired by `SCHED_SPORADIC` from
+     *  [`<sched.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/sched.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::cpu_budget (rtos::statistics::duration_t cycles,
+                        port::clock::duration_t period_ticks,
+                        budget_action_t action, priority_t demoted_prio)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      trace::printf ("%s(%u,%u,%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (cycles),
+                     static_cast<unsigned int> (period_ticks), action, this,
+                     name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err((cycles == 0) || (period_ticks > 0), EINVAL);
+      os_assert_err(action <= budget_action::suspend, EINVAL);
+      // Check the priority, it is not in the allowed range.
+      os_assert_err(demoted_prio < priority::error, EINVAL);
+      os_assert_err(demoted_prio != priority::none, EINVAL);
+
+      bool changed;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          port::clock::timestamp_t now = sysclock.now ();
+
+          // End the current period, to undo the action.
+          budget_period_end_ = 0;
+          changed = internal_replenish_cpu_budget_ (now);
+
+          budget_cycles_ = cycles;
+          budget_period_ticks_ = period_ticks;
+          budget_action_ = action;
+          budget_demoted_prio_ = demoted_prio;
+          budget_period_end_ = now + period_ticks;
+          budget_used_ = 0;
+
+          if (cycles == 0)
+            {
+              budget_links_.unlink ();
+            }
+          else if (budget_links_.unlinked ())
+            {
+              budget_threads__.link (*this);
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (changed)
+        {
+          // The thread was resumed or raised, it might preempt.
+          this_thread::yield ();
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     * Called by the scheduler, for the running thread that is
+     * about to be switched out, if the budget of the current period
+     * is used and the scheduler is not locked.
+     *
+     * The thread is not yet re-linked to the ready list, so
+     * changing the priority or the state here is enough.
+     */
+    void
+    thread::internal_exhaust_cpu_budget_ (void)
+    {
+      budget_exhausted_ = true;
+      ++budget_overruns_;
+
+      os_rtos_thread_cpu_budget_overrun_hook (this);
+
+      if (budget_action_ == budget_action::demote)
+        {
+          if (prio_assigned_ > budget_demoted_prio_)
+            {
+              budget_saved_prio_ = prio_assigned_;
+              prio_assigned_ = budget_demoted_prio_;
+            }
+        }
+      else if (budget_action_ == budget_action::suspend)
+        {
+          // Not re-linked to ready by the scheduler.
+          state_ = state::suspended;
+        }
+    }
+
+    /**
+     * @details
+     * Called with interrupts disabled, on SysTick, for all threads
+     * with a budget.
+     */
+    bool
+    thread::internal_replenish_cpu_budget_ (port::clock::timestamp_t now)
+    {
+      if (now < budget_period_end_)
+        {
+          return false;
+        }
+
+      budget_period_end_ += budget_period_ticks_;
+      if (budget_period_end_ <= now)
+        {
+          // Periods were missed, for example by the tickless idle.
+          budget_period_end_ = now + budget_period_ticks_;
+        }
+      budget_used_ = 0;
+
+      if (!budget_exhausted_)
+        {
+          return false;
+        }
+      budget_exhausted_ = false;
+
+      if (budget_action_ == budget_action::demote)
+        {
+          priority_t prio = budget_saved_prio_;
+          budget_saved_prio_ = priority::none;
+
+          // Skip if the priority was changed meanwhile.
+          if (prio == priority::none || prio_assigned_ != budget_demoted_prio_)
+            {
+              return false;
+            }
+
+          prio_assigned_ = prio;
+          if (state_ == state::ready)
+            {
+              // Reinsert according to the restored priority.
+              ready_node_.unlink ();
+              scheduler::ready_threads_list_.link (ready_node_);
+            }
+          return true;
+        }
+      else if (budget_action_ == budget_action::suspend)
+        {
+          // Skip if resumed meanwhile, and then waiting for
+          // something else.
+          if (state_ != state::suspended || waiting_node_ != nullptr
+              || clock_node_ != nullptr)
+            {
+              return false;
+            }
+
+          internal_make_ready_ ();
+          return true;
+        }
+
+      return false;
+    }
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    namespace scheduler
+    {
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @details
+       * Called from the SysTick handler, to start the new periods
+       * of the threads with a budget, and to check the budget of
+       * the running thread, which is charged only at context switches.
+       *
+       * @return true if the scheduler must run.
+       */
+      bool
+      internal_check_cpu_budgets (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        bool reschedule = false;
+
+        port::clock::timestamp_t now = sysclock.now ();
+        for (auto&& th : thread::budget_threads__)
+          {
+            if (th.internal_replenish_cpu_budget_ (now))
+              {
+                reschedule = true;
+              }
+          }
+
+        thread* crt = current_thread_;
+        if (crt != nullptr && crt->budget_cycles_ != 0
+            && !crt->budget_exhausted_)
+          {
+            rtos::statistics::duration_t running =
+                static_cast<rtos::statistics::duration_t> (hrclock.now ()
+                    - statistics::switch_timestamp_);
+            if (crt->budget_used_ + running >= crt->budget_cycles_)
+              {
+                // Account it now, the switch applies the action.
+                reschedule = true;
+              }
+          }
+
+        return reschedule;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace scheduler */
+
+  // --------------------------------------------------------------------------
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @details
+ * The default implementation only displays the thread; the
+ * application may redefine it to log the event or to restart
+ * the faulty component.
+ */
+void
+__attribute__((weak))
+os_rtos_thread_cpu_budget_overrun_hook (void* thread)
+{
+#if defined(OS_TRACE_RTOS_THREAD)
+  os::trace::printf ("%s() @%p %s\n", __func__, thread,
+                     static_cast<os::rtos::thread*> (thread)->name ());
+#else
+  (void) thread;
+#endif
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
+// ----------------------------------------------------------------------------
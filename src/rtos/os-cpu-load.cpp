@@ -0,0 +1,315 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+/**
+ * @cond ignore
+ */
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+extern os::rtos::thread* os_idle_thread;
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+/**
+ * @endcond
+ */
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace scheduler
+    {
+      namespace statistics
+      {
+        // --------------------------------------------------------------------
+
+        /**
+         * @cond ignore
+         */
+
+        static_assert(OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS > 0
+            && OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS <= 1000,
+            "the CPU load period must not exceed the shortest window");
+
+        namespace
+        {
+          // The averages are fixed point numbers, in 1/65536 units.
+          constexpr uint32_t one = 1u << 16;
+
+          // exp(-x), for 0 < x <= 1, from the Taylor series; used only
+          // at compile time, to compute the decay factors.
+          constexpr double
+          exp_neg (double x)
+          {
+            double sum = 1.0;
+            double term = 1.0;
+            for (int i = 1; i < 20; ++i)
+              {
+                term *= -x / i;
+                sum += term;
+              }
+            return sum;
+          }
+
+          constexpr uint32_t
+          decay_factor (uint32_t window_ms)
+          {
+            return static_cast<uint32_t> (exp_neg (
+                static_cast<double> (OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS)
+                    / window_ms) * one + 0.5);
+          }
+
+          // The weight of the old average, for each window.
+          constexpr uint32_t decay_factors[rtos::statistics::load_window::count] =
+            { decay_factor (1000), decay_factor (10000), decay_factor (60000) };
+
+          constexpr clock::duration_t period_ticks =
+              static_cast<clock::duration_t> ((OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS
+                  * static_cast<uint64_t> (clock_systick::frequency_hz) + 999)
+                  / 1000);
+
+          static_assert(period_ticks > 0, "the CPU load period is too short");
+
+          // The system clock timestamp of the previous sample.
+          clock::timestamp_t sample_timestamp;
+
+          // The scheduler CPU cycles at the previous sample.
+          rtos::statistics::duration_t sample_cycles;
+
+          inline uint32_t
+          average (uint32_t old_load, uint32_t load, uint32_t decay)
+          {
+            return static_cast<uint32_t> ((static_cast<uint64_t> (old_load)
+                * decay + static_cast<uint64_t> (load) * (one - decay)
+                + (one / 2)) >> 16);
+          }
+
+        } /* namespace */
+
+        uint32_t cpu_load_[rtos::statistics::load_window::count];
+
+        // A friend of the thread statistics, to update the averages.
+        class internal_cpu_load_sampler
+        {
+        public:
+
+          internal_cpu_load_sampler (clock::duration_t periods);
+
+          void
+          update (thread::threads_list& list);
+
+          void
+          update_total (void);
+
+        protected:
+
+          uint32_t
+          load_of (rtos::statistics::duration_t cycles);
+
+          rtos::statistics::duration_t total_;
+          uint32_t decay_[rtos::statistics::load_window::count];
+          uint32_t idle_load_;
+        };
+
+        internal_cpu_load_sampler::internal_cpu_load_sampler (
+            clock::duration_t periods)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              // Account the current slice of the running thread,
+              // as a context switch would do.
+              clock::timestamp_t now = hrclock.now ();
+              rtos::statistics::duration_t delta =
+                  static_cast<rtos::statistics::duration_t> (now
+                      - switch_timestamp_);
+              cpu_cycles_ += delta;
+              scheduler::current_thread_->statistics ().cpu_cycles_ += delta;
+              switch_timestamp_ = now;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          total_ = cpu_cycles_ - sample_cycles;
+          sample_cycles = cpu_cycles_;
+
+          // The decay over all elapsed periods; it quickly reaches 0,
+          // when the function was not called for a long time.
+          for (std::size_t w = 0; w < rtos::statistics::load_window::count;
+              ++w)
+            {
+              uint32_t decay = decay_factors[w];
+              for (clock::duration_t i = 1; (i < periods) && (decay != 0);
+                  ++i)
+                {
+                  decay = static_cast<uint32_t> ((static_cast<uint64_t> (decay)
+                      * decay_factors[w] + (one / 2)) >> 16);
+                }
+              decay_[w] = decay;
+            }
+
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+          // Without an idle thread, the CPU is considered fully busy.
+          idle_load_ = 0;
+#else
+          // Set when the idle thread is found.
+          idle_load_ = (total_ != 0) ? 0 : one;
+#endif /* defined(OS_USE_RTOS_PORT_SCHEDULER) */
+        }
+
+        uint32_t
+        internal_cpu_load_sampler::load_of (rtos::statistics::duration_t cycles)
+        {
+          if (total_ == 0)
+            {
+              return 0;
+            }
+          if (cycles >= total_)
+            {
+              return one;
+            }
+          return static_cast<uint32_t> ((cycles << 16) / total_);
+        }
+
+        // Recursive, like the tree of threads, which is usually shallow.
+        void
+        internal_cpu_load_sampler::update (thread::threads_list& list)
+        {
+          for (auto&& th : list)
+            {
+              class thread::statistics& st = th.statistics ();
+              uint32_t load = load_of (st.cpu_cycles_ - st.cpu_load_cycles_);
+              st.cpu_load_cycles_ = st.cpu_cycles_;
+
+              for (std::size_t w = 0; w < rtos::statistics::load_window::count;
+                  ++w)
+                {
+                  st.cpu_load_[w] = average (st.cpu_load_[w], load, decay_[w]);
+                }
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+              if (&th == os_idle_thread)
+                {
+                  idle_load_ = load;
+                }
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+              update (children_threads (&th));
+            }
+        }
+
+        // The total is the complement of the idle load.
+        void
+        internal_cpu_load_sampler::update_total (void)
+        {
+          for (std::size_t w = 0; w < rtos::statistics::load_window::count;
+              ++w)
+            {
+              cpu_load_[w] = average (cpu_load_[w], one - idle_load_, decay_[w]);
+            }
+        }
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @details
+         * Compute, for each thread, the share of the CPU cycles used
+         * since the previous sample, and merge it into three
+         * exponential moving averages, with time constants of
+         * 1 s, 10 s and 60 s, similar to the Unix load averages.
+         * The total load is the complement of the idle thread load.
+         *
+         * The function must be called periodically, for example from
+         * a monitor thread or a periodic timer; the averages are
+         * updated only once every
+         * @ref OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS
+         * milliseconds, and calling it more often is harmless. If
+         * several periods were missed, the decay of all of them is
+         * applied, with the load averaged over the entire interval.
+         * As for the Unix load averages, the averages start from 0,
+         * so they settle only after a few windows.
+         *
+         * The cost is proportional to the number of threads; all
+         * computations use integers.
+         *
+         * @note This function is available only when
+         * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD
+         * is defined.
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        bool
+        sample_cpu_load (void)
+        {
+          os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+          if (!scheduler::started ())
+            {
+              return false;
+            }
+
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          clock::duration_t elapsed =
+              static_cast<clock::duration_t> (sysclock.now ()
+                  - sample_timestamp);
+          if (elapsed < period_ticks)
+            {
+              return false;
+            }
+
+          clock::duration_t periods = elapsed / period_ticks;
+          sample_timestamp += periods * period_ticks;
+
+          internal_cpu_load_sampler sampler
+            { periods };
+          sampler.update (children_threads (nullptr));
+          sampler.update_total ();
+
+          return true;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // ----------------------------------------------------------------------
+
+      } /* namespace statistics */
+    } /* namespace scheduler */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD) */
+
+// ----------------------------------------------------------------------------
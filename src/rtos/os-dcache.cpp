@@ -0,0 +1,165 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace dcache
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        // The aligned buffer is preceded by the address returned by
+        // the memory resource, which does not have to honour
+        // alignments larger than max_align.
+        constexpr std::size_t
+        total_bytes (std::size_t bytes)
+        {
+          return align_size (bytes) + line_size_bytes + sizeof(void*);
+        }
+      } /* namespace */
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @details
+       * The buffer starts on a cache line and its size is rounded
+       * up to a multiple of it, so it can be used for DMA transfers
+       * without affecting the neighbouring data.
+       *
+       * The overhead is one cache line plus one pointer.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void*
+      allocate (std::size_t bytes, memory::memory_resource* mr)
+      {
+        if (mr == nullptr)
+          {
+            mr = memory::get_default_resource ();
+          }
+
+        void* raw = mr->allocate (total_bytes (bytes), alignof(void*));
+        if (raw == nullptr)
+          {
+            return nullptr;
+          }
+
+        uintptr_t aligned = (reinterpret_cast<uintptr_t> (raw) + sizeof(void*)
+            + line_size_bytes - 1)
+            & ~static_cast<uintptr_t> (line_size_bytes - 1);
+
+        reinterpret_cast<void**> (aligned)[-1] = raw;
+
+        return reinterpret_cast<void*> (aligned);
+      }
+
+      /**
+       * @details
+       * The size and the memory resource must be those used
+       * to allocate the buffer.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void
+      deallocate (void* addr, std::size_t bytes, memory::memory_resource* mr)
+      {
+        if (addr == nullptr)
+          {
+            return;
+          }
+
+        if (mr == nullptr)
+          {
+            mr = memory::get_default_resource ();
+          }
+
+        mr->deallocate (static_cast<void**> (addr)[-1], total_bytes (bytes),
+                        alignof(void*));
+      }
+
+    } /* namespace dcache */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE)
+
+/**
+ * @details
+ * The default implementation does nothing, for the devices
+ * without a data cache or with the DMA buffers in a non
+ * cacheable region.
+ */
+void
+__attribute__((weak))
+os_dcache_clean (const void* addr __attribute__((unused)),
+                 size_t nbytes __attribute__((unused)))
+{
+  ;
+}
+
+/**
+ * @details
+ * The default implementation does nothing.
+ */
+void
+__attribute__((weak))
+os_dcache_invalidate (void* addr __attribute__((unused)),
+                      size_t nbytes __attribute__((unused)))
+{
+  ;
+}
+
+/**
+ * @details
+ * The default implementation does nothing.
+ */
+void
+__attribute__((weak))
+os_dcache_clean_invalidate (void* addr __attribute__((unused)),
+                            size_t nbytes __attribute__((unused)))
+{
+  ;
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE) */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,296 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wc++98-compat"
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace deferred_init
+    {
+      // ----------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_DEFERRED_INIT)
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        // Constant initialised, so the registrations do not depend
+        // on the static constructors order.
+        initializer* first_;
+
+        // The highest completed level, or -1.
+        int completed_level_ = -1;
+        bool completed_all_;
+
+        mutex mx_
+          { "init" };
+        condition_variable cv_
+          { "init" };
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+        using pool_type = thread_pool_inclusive<
+        OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS,
+        OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS,
+        OS_INTEGER_RTOS_DEFERRED_INIT_STACK_SIZE_BYTES>;
+        std::aligned_storage<sizeof(pool_type), alignof(pool_type)>::type //
+        pool_storage_;
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+        void
+        signal_completed (int level, bool all)
+        {
+          mx_.lock ();
+          completed_level_ = level;
+          completed_all_ = all;
+          cv_.broadcast ();
+          mx_.unlock ();
+        }
+      }
+
+      /**
+       * @endcond
+       */
+
+      void
+      initializer::internal_run_ (void* args)
+      {
+        initializer* p = static_cast<initializer*> (args);
+#if defined(OS_TRACE_RTOS_THREADPOOL)
+        trace::printf ("%s() %s @%u\n", __func__, p->name_, p->level_);
+#endif
+        p->func_ ();
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_DEFERRED_INIT) */
+
+      // ======================================================================
+
+      /**
+       * @class initializer
+       * @details
+       * Without @ref OS_INCLUDE_RTOS_DEFERRED_INIT, the function is
+       * called right away, by the constructor, as before.
+       */
+
+      initializer::initializer (const char* name, level_t level, func_t func) :
+          func_ (func), //
+          name_ (name), //
+          next_ (nullptr), //
+          level_ (level)
+      {
+#if defined(OS_INCLUDE_RTOS_DEFERRED_INIT)
+        // Called by the static constructors, with a single thread.
+        next_ = first_;
+        first_ = this;
+#else
+        func_ ();
+#endif
+      }
+
+      // ======================================================================
+
+      /**
+       * @details
+       * For each level in use, in increasing order, submit all
+       * its functions to a pool of
+       * @ref OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS threads, and wait
+       * for them to complete, before passing to the next level.
+       */
+      void
+      run (void)
+      {
+#if defined(OS_INCLUDE_RTOS_DEFERRED_INIT)
+
+        thread_pool::attributes attr;
+        attr.th_priority = OS_INTEGER_RTOS_DEFERRED_INIT_PRIORITY;
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+        thread_pool* pool = new (&pool_storage_) pool_type
+          { "init", attr };
+#else
+        attr.th_stack_size_bytes =
+            OS_INTEGER_RTOS_DEFERRED_INIT_STACK_SIZE_BYTES;
+        thread_pool* pool = new thread_pool
+          { "init", OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS,
+              OS_INTEGER_RTOS_DEFERRED_INIT_WORKERS, attr };
+#endif
+
+        int level = -1;
+        for (;;)
+          {
+            // Find the next level in use.
+            int next = 0x100;
+            for (initializer* p = first_; p != nullptr; p = p->next_)
+              {
+                if (p->level_ > level && p->level_ < next)
+                  {
+                    next = p->level_;
+                  }
+              }
+            if (next == 0x100)
+              {
+                break;
+              }
+            level = next;
+
+            for (initializer* p = first_; p != nullptr; p = p->next_)
+              {
+                if (p->level_ == level)
+                  {
+                    pool->submit (initializer::internal_run_, p);
+                  }
+              }
+            pool->wait_idle ();
+
+            signal_completed (level, false);
+          }
+
+        // The workers are no longer needed.
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+        static_cast<pool_type*> (pool)->~pool_type ();
+#else
+        delete pool;
+#endif
+
+        signal_completed (level, true);
+
+#endif /* defined(OS_INCLUDE_RTOS_DEFERRED_INIT) */
+      }
+
+      /**
+       * @details
+       * The levels not used by any function complete with the
+       * next used level.
+       */
+      result_t
+      wait (level_t level __attribute__((unused)))
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+#if defined(OS_INCLUDE_RTOS_DEFERRED_INIT)
+
+        mx_.lock ();
+        while (!completed_all_ && completed_level_ < level)
+          {
+            cv_.wait (mx_);
+          }
+        mx_.unlock ();
+
+#endif /* defined(OS_INCLUDE_RTOS_DEFERRED_INIT) */
+
+        return result::ok;
+      }
+
+      bool
+      completed (level_t level __attribute__((unused)))
+      {
+#if defined(OS_INCLUDE_RTOS_DEFERRED_INIT)
+        return completed_all_ || completed_level_ >= level;
+#else
+        return true;
+#endif
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace deferred_init */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_DEFERRED_INIT)
+
+using namespace os::rtos;
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  void*
+  deferred_init_trampoline (void* args __attribute__((unused)))
+  {
+    deferred_init::run ();
+    return nullptr;
+  }
+}
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+using deferred_init_thread = thread_inclusive<
+OS_INTEGER_RTOS_DEFERRED_INIT_STACK_SIZE_BYTES>;
+static std::aligned_storage<sizeof(deferred_init_thread),
+    alignof(deferred_init_thread)>::type os_deferred_init_thread_storage_;
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+/**
+ * @endcond
+ */
+
+void
+__attribute__((weak))
+os_startup_create_thread_deferred_init (void)
+{
+  thread::attributes attr = thread::initializer;
+  attr.th_priority = OS_INTEGER_RTOS_DEFERRED_INIT_PRIORITY;
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+  // Constructed in place, to not register any destructor.
+  new (&os_deferred_init_thread_storage_) deferred_init_thread
+    { "init", deferred_init_trampoline, nullptr, attr };
+
+#else
+
+  // Never deallocated; it terminates after running the functions.
+  new thread
+    { "init", deferred_init_trampoline, nullptr, attr };
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_DEFERRED_INIT) */
+
+// ----------------------------------------------------------------------------
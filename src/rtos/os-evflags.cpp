@@ -261,12 +261,20 @@ namespace os
 #if defined(OS_TRACE_RTOS_EVFLAGS)
               trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask, mode,
                              this, name (), event_flags_.mask ());
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+              sync_statistics_.internal_mark_acquired_ ();
 #endif
               return result::ok;
             }
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -275,6 +283,10 @@ namespace os
       internal::waiting_thread_node node
         { crt_thread };
 
+      // Tell raise() what to wait for.
+      node.flags_mask_ = mask;
+      node.flags_mode_ = mode;
+
       for (;;)
         {
             {
@@ -286,6 +298,10 @@ namespace os
 #if defined(OS_TRACE_RTOS_EVFLAGS)
                   trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask,
                                  mode, this, name (), event_flags_.mask ());
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+                  sync_statistics_.internal_mark_waited_ (wait_begin);
+                  sync_statistics_.internal_mark_acquired_ ();
 #endif
                   return result::ok;
                 }
@@ -362,6 +378,9 @@ namespace os
 #if defined(OS_TRACE_RTOS_EVFLAGS)
               trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask, mode,
                              this, name (), event_flags_.mask ());
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+              sync_statistics_.internal_mark_acquired_ ();
 #endif
               return result::ok;
             }
@@ -449,12 +468,20 @@ namespace os
               trace::printf ("%s(0x%X,%u,%u) @%p %s >0x%X\n", __func__, mask,
                              timeout, mode, this, name (),
                              event_flags_.mask ());
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+              sync_statistics_.internal_mark_acquired_ ();
 #endif
               return result::ok;
             }
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -463,6 +490,10 @@ namespace os
       internal::waiting_thread_node node
         { crt_thread };
 
+      // Tell raise() what to wait for.
+      node.flags_mask_ = mask;
+      node.flags_mode_ = mode;
+
       internal::clock_timestamps_list& clock_list = clock_->steady_list ();
       clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
 
@@ -482,6 +513,10 @@ namespace os
                   trace::printf ("%s(0x%X,%u,%u) @%p %s >0x%X\n", __func__,
                                  mask, timeout, mode, this, name (),
                                  event_flags_.mask ());
+#endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+                  sync_statistics_.internal_mark_waited_ (wait_begin);
+                  sync_statistics_.internal_mark_acquired_ ();
 #endif
                   return result::ok;
                 }
@@ -526,11 +561,49 @@ namespace os
 #endif
     }
 
+    // Called by raise() for each waiting thread, with the flags
+    // still available; the flags a thread will clear are no longer
+    // available to the following ones.
+    static bool
+    match_waiter_ (internal::waiting_thread_node& node, void* arg)
+    {
+      flags::mask_t* avail = static_cast<flags::mask_t*> (arg);
+      flags::mask_t mask = node.flags_mask_;
+      flags::mode_t mode = node.flags_mode_;
+
+      flags::mask_t taken;
+      if (mask == flags::any)
+        {
+          taken = *avail;
+        }
+      else if ((mode & flags::mode::all) != 0)
+        {
+          taken = ((*avail & mask) == mask) ? mask : 0;
+        }
+      else
+        {
+          taken = *avail & mask;
+        }
+
+      if (taken == 0)
+        {
+          return false;
+        }
+
+      if ((mode & flags::mode::clear) != 0)
+        {
+          *avail &= ~taken;
+        }
+      return true;
+    }
+
     /**
      * @details
      * Set more bits in the thread current signal mask.
      * Use OR at bit-mask level.
-     * Wake-up all waiting threads, if any.
+     * Wake-up the waiting threads whose condition is satisfied,
+     * inside a single critical section; the others are not
+     * switched in only to wait again.
      *
      * @note Can be invoked from Interrupt Service Routines.
      */
@@ -552,10 +625,9 @@ namespace os
 
       result_t res = event_flags_.raise (mask, oflags);
 
-      // Wake-up all threads, if any.
-      // Need not be inside the critical section,
-      // the list is protected by inner `resume_one()`.
-      list_.resume_all ();
+      // Wake-up only the threads whose condition is now true.
+      flags::mask_t avail = event_flags_.mask ();
+      list_.resume_if (match_waiter_, &avail);
 
 #if defined(OS_TRACE_RTOS_EVFLAGS)
       trace::printf ("%s(0x%X) @%p %s >0x%X\n", __func__, mask, this, name (),
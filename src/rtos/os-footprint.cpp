@@ -0,0 +1,263 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+#include <cstring>
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace footprint
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      node::nodes_list node::nodes__;
+
+      namespace
+      {
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        void
+        for_each_thread (thread* parent, visit_t func, void* arg)
+        {
+          for (auto&& th : scheduler::children_threads (parent))
+            {
+              class thread::stack& stk = th.stack ();
+
+              item it;
+              it.kind = "thread";
+              it.name = th.name ();
+              it.object = &th;
+              it.object_bytes = sizeof(thread);
+              it.storage_bytes = stk.size ();
+              it.used_bytes = stk.peak ();
+              it.peak_bytes = it.used_bytes;
+              func (it, arg);
+
+              for_each_thread (&th, func, arg);
+            }
+        }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+        void
+        visit_resource (const char* kind, memory::memory_resource* res,
+                        visit_t func, void* arg)
+        {
+          item it;
+          it.kind = kind;
+          it.name = res->name ();
+          it.object = res;
+          it.object_bytes = 0;
+          it.storage_bytes = res->total_bytes ();
+          it.used_bytes = res->allocated_bytes ();
+          it.peak_bytes = res->max_allocated_bytes ();
+          func (it, arg);
+        }
+
+        // Up to this number of types are totalled by report().
+        constexpr std::size_t max_kinds = 12;
+
+        struct totals
+        {
+          const char* kind;
+          std::size_t count;
+          std::size_t object_bytes;
+          std::size_t storage_bytes;
+        };
+
+        void
+        report_item (const item& it, void* arg)
+        {
+          trace::printf ("%-8s %-16s %6u %8u %8u %8u\n", it.kind,
+                         it.name != nullptr ? it.name : "-",
+                         static_cast<unsigned int> (it.object_bytes),
+                         static_cast<unsigned int> (it.storage_bytes),
+                         static_cast<unsigned int> (it.used_bytes),
+                         static_cast<unsigned int> (it.peak_bytes));
+
+          totals* t = static_cast<totals*> (arg);
+          for (std::size_t i = 0; i < max_kinds; ++i)
+            {
+              if (t[i].kind == nullptr)
+                {
+                  t[i].kind = it.kind;
+                }
+              if (std::strcmp (t[i].kind, it.kind) == 0)
+                {
+                  ++t[i].count;
+                  t[i].object_bytes += it.object_bytes;
+                  t[i].storage_bytes += it.storage_bytes;
+                  break;
+                }
+            }
+        }
+      } /* namespace */
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      node::node (const char* kind, const void* object, describe_t describe) :
+          kind_ (kind), //
+          object_ (object), //
+          describe_ (describe)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        nodes__.link (*this);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      node::~node ()
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        links_.unlink ();
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * The memory resources are the default one, the separate
+       * ones used for the system objects, if any, and the
+       * registered regions.
+       *
+       * Objects with a storage allocated from a memory resource
+       * are counted twice in the totals, once as part of the
+       * resource.
+       */
+      void
+      for_each (visit_t func, void* arg)
+      {
+        os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+        // ----- Enter critical section ---------------------------------------
+        scheduler::critical_section scs;
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+        for_each_thread (nullptr, func, arg);
+#endif
+
+        memory::memory_resource* heaps[] =
+          { memory::get_default_resource (), memory::resource_thread,
+              memory::resource_condition_variable,
+              memory::resource_event_flags, memory::resource_memory_pool,
+              memory::resource_message_queue, memory::resource_mutex,
+              memory::resource_semaphore, memory::resource_timer };
+        for (std::size_t i = 0; i < sizeof(heaps) / sizeof(heaps[0]); ++i)
+          {
+            bool seen = (heaps[i] == nullptr);
+            for (std::size_t j = 0; j < i && !seen; ++j)
+              {
+                seen = (heaps[j] == heaps[i]);
+              }
+            if (!seen)
+              {
+                visit_resource ("heap", heaps[i], func, arg);
+              }
+          }
+
+        for (std::size_t i = 0; i < OS_INTEGER_RTOS_MEMORY_REGIONS; ++i)
+          {
+            const char* name;
+            memory::memory_resource* res = memory::region_at (i, &name);
+            if (res != nullptr)
+              {
+                visit_resource ("region", res, func, arg);
+              }
+          }
+
+        for (auto&& n : node::nodes__)
+          {
+            item it;
+            it.kind = n.kind_;
+            it.name = nullptr;
+            it.object = n.object_;
+            it.object_bytes = 0;
+            it.storage_bytes = 0;
+            it.used_bytes = 0;
+            it.peak_bytes = 0;
+            n.describe_ (n.object_, it);
+            func (it, arg);
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * The object sizes are those of the base classes; the
+       * columns are the object size, the storage size, the
+       * storage currently used and the peak usage, in bytes.
+       */
+      void
+      report (void)
+      {
+        totals t[max_kinds];
+        std::memset (t, 0, sizeof(t));
+
+        trace::printf ("%-8s %-16s %6s %8s %8s %8s\n", "kind", "name",
+                       "object", "storage", "used", "peak");
+        for_each (report_item, t);
+
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < max_kinds && t[i].kind != nullptr; ++i)
+          {
+            trace::printf ("%-8s %u objects, %u + %u bytes\n", t[i].kind,
+                           static_cast<unsigned int> (t[i].count),
+                           static_cast<unsigned int> (t[i].object_bytes),
+                           static_cast<unsigned int> (t[i].storage_bytes));
+            sum += t[i].object_bytes;
+          }
+        trace::printf ("objects  %u bytes\n", static_cast<unsigned int> (sum));
+      }
+
+    } /* namespace footprint */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_FOOTPRINT) */
+
+// ----------------------------------------------------------------------------
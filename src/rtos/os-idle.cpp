@@ -65,6 +65,176 @@ os_rtos_idle_enter_power_saving_mode_hook (void)
   return false;
 }
 
+/**
+ * @details
+ * Used only when `OS_INCLUDE_RTOS_TICKLESS_IDLE` is defined.
+ *
+ * It is called by the idle thread in a critical section, with the
+ * number of ticks up to the earliest clock timestamp. The
+ * implementation must stop the SysTick, program a one-shot
+ * wake-up after at most `ticks` ticks, enter sleep (in such a way
+ * that pending interrupts still wake up the device), and, when
+ * back, restart the SysTick aligned to the tick boundary.
+ *
+ * The number of complete ticks elapsed during sleep must
+ * be returned via `slept_ticks`; the clocks are updated and the
+ * timestamps are processed after the hook returns.
+ *
+ * The default implementation does nothing and returns `false`,
+ * which makes the idle thread sleep as usual, waiting for
+ * the next interrupt.
+ */
+bool
+__attribute__((weak))
+os_rtos_idle_enter_tickless_sleep_hook (uint32_t ticks __attribute__((unused)),
+                                        uint32_t* slept_ticks __attribute__((unused)))
+{
+  return false;
+}
+
+#if (defined(OS_INCLUDE_RTOS_TICKLESS_IDLE) || defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES)) \
+  && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP)
+
+/**
+ * @cond ignore
+ */
+
+// Must be called in an interrupts critical section.
+static clock::timestamp_t
+os_rtos_idle_ticks_to_next (void)
+{
+  clock::timestamp_t ticks = sysclock.internal_steady_duration_to_next ();
+
+  // The high resolution clock counts cycles, but its timestamps
+  // are also checked only on ticks; round up.
+  clock::timestamp_t cycles = hrclock.internal_steady_duration_to_next ();
+  clock::timestamp_t cycles_per_tick = port::clock_highres::cycles_per_tick ();
+  if (cycles / cycles_per_tick < ticks)
+    {
+      ticks = (cycles + cycles_per_tick - 1) / cycles_per_tick;
+    }
+
+  return ticks;
+}
+
+/**
+ * @endcond
+ */
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_TICKLESS_IDLE) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP)
+
+/**
+ * @cond ignore
+ */
+
+static bool
+os_rtos_idle_tickless_sleep (void)
+{
+  // ----- Enter critical section ---------------------------------------------
+  interrupts::critical_section ics;
+
+  clock::timestamp_t ticks = os_rtos_idle_ticks_to_next ();
+
+  if (ticks < OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS)
+    {
+      return false;
+    }
+
+  if (ticks > UINT32_MAX)
+    {
+      ticks = UINT32_MAX;
+    }
+
+  uint32_t slept_ticks = 0;
+  if (!os_rtos_idle_enter_tickless_sleep_hook (static_cast<uint32_t> (ticks),
+                                               &slept_ticks))
+    {
+      return false;
+    }
+
+  // Advance the clocks and process the timestamps, only once.
+  os_systick_update_for_slept_ticks (slept_ticks);
+
+  return true;
+  // ----- Exit critical section ----------------------------------------------
+}
+
+/**
+ * @endcond
+ */
+
+#endif /* defined(OS_INCLUDE_RTOS_TICKLESS_IDLE) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP) */
+
+#if defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP)
+
+/**
+ * @cond ignore
+ */
+
+static void
+os_rtos_idle_power_state_sleep (void)
+{
+  clock::timestamp_t begin = hrclock.now ();
+
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      clock::timestamp_t ticks = os_rtos_idle_ticks_to_next ();
+      if (ticks > UINT32_MAX)
+        {
+          ticks = UINT32_MAX;
+        }
+
+      // Without timestamps, far in the future.
+      uint64_t idle_us = ticks * 1000000ULL / clock_systick::frequency_hz;
+
+      power::state_t st = os_rtos_idle_select_power_state_hook (
+          idle_us, power::latency_constraint ());
+
+      uint32_t slept_ticks = 0;
+      if (st != power::state::sleep && st < power::state::count
+          && os_rtos_idle_enter_power_state_hook (
+              st, static_cast<uint32_t> (ticks), &slept_ticks))
+        {
+          // Advance the clocks and process the timestamps, only once.
+          os_systick_update_for_slept_ticks (slept_ticks);
+
+          power::statistics::internal_record_ (
+              st,
+              static_cast<rtos::statistics::duration_t> (hrclock.now ()
+                  - begin));
+          return;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#if defined(OS_INCLUDE_RTOS_TICKLESS_IDLE)
+  if (!os_rtos_idle_tickless_sleep ())
+#endif /* defined(OS_INCLUDE_RTOS_TICKLESS_IDLE) */
+    {
+      port::scheduler::wait_for_interrupt ();
+    }
+
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      power::statistics::internal_record_ (
+          power::state::sleep,
+          static_cast<rtos::statistics::duration_t> (hrclock.now () - begin));
+      // ----- Exit critical section ------------------------------------------
+    }
+}
+
+/**
+ * @endcond
+ */
+
+#endif /* defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP) */
+
 void
 __attribute__((weak))
 os_rtos_idle_actions (void)
@@ -85,15 +255,52 @@ os_rtos_idle_actions (void)
       this_thread::yield ();
     }
 
+#if defined(TRACE) && defined(OS_USE_TRACE_RING_BUFFER)
+  // Pass the buffered trace messages to the backend.
+  trace::drain ();
+#endif
+
 #if defined(OS_HAS_INTERRUPTS_STACK)
   // Simple test to verify that the interrupts
   // did not underflow the stack.
   assert(rtos::interrupts::stack ()->check_bottom_magic ());
 #endif
 
+#if defined(OS_INTEGER_MEMORY_IDLE_VERIFY_CHUNKS) \
+  && !defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+    {
+      // Check a few chunks of the free store on each iteration,
+      // so the entire heap is checked in the background.
+      rtos::memory::memory_resource* mr = rtos::memory::get_default_resource ();
+      const void* addr;
+        {
+          // ----- Enter critical section ---------------------------------
+          scheduler::critical_section scs;
+          addr = mr->verify (OS_INTEGER_MEMORY_IDLE_VERIFY_CHUNKS);
+          // ----- Exit critical section ----------------------------------
+        }
+      if (addr != nullptr)
+        {
+          os_rtos_memory_corruption_hook (mr, addr);
+        }
+    }
+#endif
+
   if (!os_rtos_idle_enter_power_saving_mode_hook ())
     {
+#if defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP)
+      os_rtos_idle_power_state_sleep ();
+#else
+
+#if defined(OS_INCLUDE_RTOS_TICKLESS_IDLE) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP)
+      if (os_rtos_idle_tickless_sleep ())
+        {
+          return;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_TICKLESS_IDLE) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP) */
+
       port::scheduler::wait_for_interrupt ();
+#endif /* defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES) && !defined(OS_EXCLUDE_RTOS_IDLE_SLEEP) */
     }
 }
 
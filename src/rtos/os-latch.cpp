@@ -0,0 +1,380 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class latch::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts) to the latch.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const latch::attributes latch::initializer;
+
+    constexpr latch::count_t latch::max_count_value;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class latch
+     * @details
+     * A latch is a downward counter, initialised with the number of
+     * expected events; threads may block until the counter reaches
+     * zero. Unlike barriers, latches cannot be reused.
+     *
+     * When the count reaches zero, all waiting threads are resumed
+     * with a single pass through the waiting list.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * latch ready { "ready", 3 };
+     *
+     * void*
+     * worker (void* args)
+     * {
+     *   // Initialise.
+     *   ready.count_down ();
+     *   // ...
+     * }
+     *
+     * void
+     * func (void)
+     * {
+     *   // Start 3 workers.
+     *   ready.wait ();
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified, but inspired
+     *  by C++20 `std::latch`.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a named latch object
+     * with the count _expected_ and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    latch::latch (const char* name, count_t expected, const attributes& attr) :
+        object_named_system
+          { name }, //
+        count_ (expected)
+    {
+#if defined(OS_TRACE_RTOS_LATCH)
+      trace::printf ("%s() @%p %s %d\n", __func__, this, this->name (),
+                     static_cast<int> (expected));
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      os_assert_throw(expected >= 0, EINVAL);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+    }
+
+    /**
+     * @details
+     * It is safe to destroy a latch upon which no threads
+     * are currently blocked.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    latch::~latch ()
+    {
+#if defined(OS_TRACE_RTOS_LATCH)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // There must be no threads waiting for this latch.
+      assert(list_.empty ());
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    result_t
+    latch::internal_wait_ (bool timed, clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (count_ == 0)
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (count_ == 0)
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the latch waiting list, and,
+              // for timed waits, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (list_, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the latch waiting list,
+          // if not already removed by count_down(), and from the
+          // clock timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_LATCH)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+              interrupts::critical_section ics;
+
+              // Give a last chance, the count might have reached
+              // zero just before the timeout.
+              if (count_ == 0)
+                {
+                  return result::ok;
+                }
+
+#if defined(OS_TRACE_RTOS_LATCH)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Decrement the count by _update_; when it reaches zero,
+     * all waiting threads are resumed.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::count_down (count_t update)
+    {
+#if defined(OS_TRACE_RTOS_LATCH)
+      trace::printf ("%s(%d) @%p %s\n", __func__, static_cast<int> (update),
+                     this, name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (update < 0 || update > count_)
+            {
+              return EINVAL;
+            }
+
+          count_ -= update;
+          if (count_ != 0 || update == 0)
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Resume all waiting threads in a single critical section.
+      list_.resume_all ();
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * Check the count without blocking.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::try_wait (void)
+    {
+      if (count_ == 0)
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+    }
+
+    /**
+     * @details
+     * If the count is zero, return at once. Otherwise, the current
+     * thread is suspended until the count reaches zero.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::wait (void)
+    {
+#if defined(OS_TRACE_RTOS_LATCH)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      return internal_wait_ (false, 0);
+    }
+
+    /**
+     * @details
+     * If the count is zero, return at once. Otherwise, the current
+     * thread is suspended until the count reaches zero, or
+     * the timeout expires.
+     *
+     * The timeout is measured with the clock from the latch
+     * attributes (by default the SysTick clock).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::timed_wait (clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_LATCH)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_wait_ (true, timeout);
+    }
+
+    /**
+     * @details
+     * Decrement the count by _update_ and suspend the current
+     * thread until the count reaches zero.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::arrive_and_wait (count_t update)
+    {
+#if defined(OS_TRACE_RTOS_LATCH)
+      trace::printf ("%s(%d) @%p %s\n", __func__, static_cast<int> (update),
+                     this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      result_t res = count_down (update);
+      if (res != result::ok)
+        {
+          return res;
+        }
+
+      return internal_wait_ (false, 0);
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
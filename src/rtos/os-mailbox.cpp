@@ -0,0 +1,578 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class mailbox_base::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts) to the mailbox.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const mailbox_base::attributes mailbox_base::initializer;
+
+    constexpr mailbox_base::index_t mailbox_base::max_capacity;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class mailbox_base
+     * @details
+     * A mailbox is a lightweight alternative to message queues
+     * for the common case when the messages are pointers.
+     *
+     * Instead of the message queue per message links, priorities
+     * and buffer copies, the mailbox is a plain ring of words;
+     * sending is a single word store and receiving a single word
+     * load, both in a short critical section. Threads may block
+     * when the mailbox is full or empty.
+     *
+     * Usually the storage is provided by the `mailbox<T*, N>`
+     * template.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * mailbox<my_msg_t*, 4> mb { "mb" };
+     *
+     * void
+     * producer (my_msg_t* msg)
+     * {
+     *   mb.send (msg);
+     * }
+     *
+     * void
+     * consumer (void)
+     * {
+     *   my_msg_t* msg;
+     *   mb.receive (&msg);
+     *   // ...
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified; inspired by
+     *  the mailboxes found in most small RTOSes.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a named mailbox object
+     * with the ring of _capacity_ words at _storage_ and attributes
+     * referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    mailbox_base::mailbox_base (const char* name, void** storage,
+                                std::size_t capacity,
+                                const attributes& attr) :
+        object_named_system
+          { name }, //
+        ring_ (storage), //
+        capacity_ (static_cast<index_t> (capacity))
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s() @%p %s %u\n", __func__, this, this->name (),
+                     static_cast<unsigned int> (capacity));
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      os_assert_throw(storage != nullptr, EINVAL);
+      os_assert_throw(capacity > 0 && capacity <= max_capacity, EINVAL);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+    }
+
+    /**
+     * @details
+     * It is safe to destroy a mailbox upon which no threads
+     * are currently blocked.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    mailbox_base::~mailbox_base ()
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // There must be no threads waiting for this mailbox.
+      assert(send_list_.empty ());
+      assert(receive_list_.empty ());
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    mailbox_base::internal_try_send_ (void* msg)
+    {
+      if (count_ >= capacity_)
+        {
+          return false;
+        }
+
+      std::size_t tail = static_cast<std::size_t> (head_) + count_;
+      if (tail >= capacity_)
+        {
+          tail -= capacity_;
+        }
+      ring_[tail] = msg;
+      ++count_;
+
+      // Wake-up one thread, if any.
+      receive_list_.resume_one ();
+
+      return true;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    mailbox_base::internal_try_receive_ (void** msg)
+    {
+      if (count_ == 0)
+        {
+          return false;
+        }
+
+      index_t head = head_;
+      *msg = ring_[head];
+      if (++head >= capacity_)
+        {
+          head = 0;
+        }
+      head_ = head;
+      --count_;
+
+      // Wake-up one thread, if any.
+      send_list_.resume_one ();
+
+      return true;
+    }
+
+    result_t
+    mailbox_base::internal_send_ (void* msg, bool timed,
+                                  clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_send_ (msg))
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_try_send_ (msg))
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the mailbox send waiting list,
+              // and, for timed sends, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (send_list_, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (send_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the mailbox send waiting list,
+          // if not already removed by receive(), and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    result_t
+    mailbox_base::internal_receive_ (void** msg, bool timed,
+                                     clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msg != nullptr, EINVAL);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_receive_ (msg))
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_try_receive_ (msg))
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the mailbox receive waiting list,
+              // and, for timed receives, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (receive_list_, node,
+                                                 clock_list, timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (receive_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the mailbox receive waiting list,
+          // if not already removed by send(), and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Store the pointer _msg_ at the mailbox tail. If the mailbox
+     * is full, the current thread is suspended until a pointer
+     * is received by another thread.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mailbox_base::send (void* msg)
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s(%p) @%p %s\n", __func__, msg, this, name ());
+#endif
+
+      return internal_send_ (msg, false, 0);
+    }
+
+    /**
+     * @details
+     * Store the pointer _msg_ at the mailbox tail, or
+     * return `EWOULDBLOCK` if the mailbox is full.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mailbox_base::try_send (void* msg)
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s(%p) @%p %s\n", __func__, msg, this, name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (internal_try_send_ (msg))
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Identical to `send()`, but, if the mailbox is full,
+     * wait at most _timeout_ for space to become available.
+     *
+     * The timeout is measured with the clock from the mailbox
+     * attributes (by default the SysTick clock).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mailbox_base::timed_send (void* msg, clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_send_ (msg, true, timeout);
+    }
+
+    /**
+     * @details
+     * Load the pointer at the mailbox head into the location
+     * referenced by _msg_. If the mailbox is empty, the current
+     * thread is suspended until a pointer is sent.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mailbox_base::receive (void** msg)
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      return internal_receive_ (msg, false, 0);
+    }
+
+    /**
+     * @details
+     * Load the pointer at the mailbox head, or
+     * return `EWOULDBLOCK` if the mailbox is empty.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mailbox_base::try_receive (void** msg)
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      os_assert_err(msg != nullptr, EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (internal_try_receive_ (msg))
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Identical to `receive()`, but, if the mailbox is empty,
+     * wait at most _timeout_ for a pointer to arrive.
+     *
+     * The timeout is measured with the clock from the mailbox
+     * attributes (by default the SysTick clock).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mailbox_base::timed_receive (void** msg, clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_receive_ (msg, true, timeout);
+    }
+
+    /**
+     * @details
+     * Discard all pointers and resume all threads waiting
+     * to send.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mailbox_base::reset (void)
+    {
+#if defined(OS_TRACE_RTOS_MAILBOX)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          head_ = 0;
+          count_ = 0;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      send_list_.resume_all ();
+
+      return result::ok;
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
@@ -38,6 +38,9 @@
 #include <cmsis-plus/memory/malloc.h>
 #include <cmsis-plus/memory/null.h>
 
+#include <cstdlib>
+#include <cstring>
+
 // ----------------------------------------------------------------------------
 
 using namespace os;
@@ -217,6 +220,134 @@ namespace os
 
       // ----------------------------------------------------------------------
 
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        // The registered memory regions; not used entries have
+        // a null name.
+        struct
+        {
+          const char* name;
+          memory_resource* resource;
+        } regions[OS_INTEGER_RTOS_MEMORY_REGIONS];
+      }
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @details
+       * The memory regions allow threads, message queues and memory
+       * pools to place their storage in specific memory areas, like
+       * the fast core coupled memory or the external SDRAM, by naming
+       * the region in the attributes, instead of using the default
+       * RTOS memory manager.
+       *
+       * Usually called during the system startup, from
+       * `os_startup_initialize_free_store()`, with the memory
+       * managers of each area.
+       *
+       * The name is not copied, it must be a static string.
+       *
+       * At most `OS_INTEGER_RTOS_MEMORY_REGIONS` regions can
+       * be registered.
+       *
+       * @warning This function is not thread safe.
+       */
+      memory_resource*
+      set_region (const char* name, memory_resource* res) noexcept
+      {
+        trace::printf ("rtos::memory::%s(\"%s\",%p) \n", __func__, name, res);
+
+        assert(name != nullptr);
+
+        std::size_t free_index = OS_INTEGER_RTOS_MEMORY_REGIONS;
+        for (std::size_t i = 0; i < OS_INTEGER_RTOS_MEMORY_REGIONS; ++i)
+          {
+            if (regions[i].name == nullptr)
+              {
+                if (free_index == OS_INTEGER_RTOS_MEMORY_REGIONS)
+                  {
+                    free_index = i;
+                  }
+              }
+            else if (std::strcmp (regions[i].name, name) == 0)
+              {
+                memory_resource* old = regions[i].resource;
+                if (res != nullptr)
+                  {
+                    regions[i].resource = res;
+                  }
+                else
+                  {
+                    regions[i].name = nullptr;
+                    regions[i].resource = nullptr;
+                  }
+                return old;
+              }
+          }
+
+        if (res != nullptr)
+          {
+            // Increase OS_INTEGER_RTOS_MEMORY_REGIONS.
+            assert(free_index < OS_INTEGER_RTOS_MEMORY_REGIONS);
+
+            if (free_index < OS_INTEGER_RTOS_MEMORY_REGIONS)
+              {
+                regions[free_index].name = name;
+                regions[free_index].resource = res;
+              }
+          }
+
+        return nullptr;
+      }
+
+      /**
+       * @details
+       * Linear search, the number of regions is small.
+       */
+      memory_resource*
+      region (const char* name) noexcept
+      {
+        if (name == nullptr)
+          {
+            return nullptr;
+          }
+
+        for (std::size_t i = 0; i < OS_INTEGER_RTOS_MEMORY_REGIONS; ++i)
+          {
+            if ((regions[i].name != nullptr)
+                && (std::strcmp (regions[i].name, name) == 0))
+              {
+                return regions[i].resource;
+              }
+          }
+
+        return nullptr;
+      }
+
+      memory_resource*
+      region_at (std::size_t index, const char** name) noexcept
+      {
+        if ((index >= OS_INTEGER_RTOS_MEMORY_REGIONS)
+            || (regions[index].name == nullptr))
+          {
+            return nullptr;
+          }
+
+        if (name != nullptr)
+          {
+            *name = regions[index].name;
+          }
+        return regions[index].resource;
+      }
+
+      // ----------------------------------------------------------------------
+
       /**
        * @details
        * On bare metal applications, this function is called
@@ -472,6 +603,63 @@ namespace os
         return false;
       }
 
+      /**
+       * @details
+       * The default implementation of this virtual function returns
+       * 0, meaning the size is not known.
+       *
+       * Override this function to return the actual size; to
+       * be fast, the value should be maintained incrementally.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      std::size_t
+      memory_resource::do_max_free_chunk (void) noexcept
+      {
+        return 0;
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      /**
+       * @details
+       * The default implementation of this virtual function returns
+       * false, meaning the block cannot be resized in place.
+       *
+       * Override this function to perform the action.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      bool
+      memory_resource::do_try_resize (void* addr, std::size_t bytes,
+                                      std::size_t new_bytes) noexcept
+      {
+        return false;
+      }
+
+      /**
+       * @details
+       * The default implementation of this virtual function returns
+       * `nullptr`, meaning no damage was found, since there is
+       * nothing to check.
+       *
+       * Override this function to check the memory manager
+       * structures incrementally.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      const void*
+      memory_resource::do_verify (std::size_t chunks) noexcept
+      {
+        return nullptr;
+      }
+
+#pragma GCC diagnostic pop
+
       void
       memory_resource::internal_increase_allocated_statistics (
           std::size_t bytes) noexcept
@@ -501,6 +689,225 @@ namespace os
 
       }
 
+      /**
+       * @details
+       * Identical to `allocate()`, but, if the memory cannot be
+       * obtained even after calling the shrinkers, the emergency
+       * reserve is returned to the free space and the allocation
+       * is retried, before calling the out of memory handler.
+       *
+       * Use it for the allocations that must not fail, such as the
+       * ones needed to report or to recover from the out of memory
+       * condition.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      void*
+      memory_resource::allocate_critical (std::size_t bytes,
+                                          std::size_t alignment)
+      {
+        ++allocations_;
+        return internal_allocate_ (bytes, alignment, true);
+      }
+
+      /**
+       * @details
+       * Call the shrinkers in priority order, highest first,
+       * until at least _bytes_ were released, or all were called.
+       *
+       * It is called automatically when an allocation fails, but
+       * it can also be called early, when the application detects
+       * low memory.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      std::size_t
+      memory_resource::reclaim (std::size_t bytes)
+      {
+        bool reclaiming = reclaiming_;
+        reclaiming_ = true;
+
+        std::size_t total = 0;
+        for (shrinker* s = shrinkers_; s != nullptr && total < bytes;
+            s = s->next_)
+          {
+            std::size_t freed = s->func_ (bytes - total, s->args_);
+            s->reclaimed_bytes_ += freed;
+            total += freed;
+          }
+
+        reclaiming_ = reclaiming;
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+        trace::printf ("%s(%u)=%u @%p %s\n", __func__, bytes, total, this,
+                       name ());
+#endif
+
+        return total;
+      }
+
+      /**
+       * @details
+       * The reserve is a block of _bytes_ allocated in advance and
+       * kept aside; only `allocate_critical()` may return it to the
+       * free space, when everything else failed. After it is used,
+       * or if it cannot be allocated now, it is allocated again
+       * as soon as enough memory is deallocated.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      bool
+      memory_resource::emergency_reserve (std::size_t bytes)
+      {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+        trace::printf ("%s(%u) @%p %s\n", __func__, bytes, this, name ());
+#endif
+
+        if (reserve_ != nullptr)
+          {
+            do_deallocate (reserve_, reserve_bytes_, max_align);
+            reserve_ = nullptr;
+          }
+
+        reserve_bytes_ = bytes;
+        if (bytes == 0)
+          {
+            return true;
+          }
+
+        internal_rearm_reserve_ ();
+        return (reserve_ != nullptr);
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      void*
+      memory_resource::internal_allocate_ (std::size_t bytes,
+                                           std::size_t alignment,
+                                           bool critical)
+      {
+        // The handler is called only after all other attempts failed.
+        out_of_memory_handler_t handler = out_of_memory_handler_;
+        out_of_memory_handler_ = nullptr;
+
+        void* p = do_allocate (bytes, alignment);
+
+        bool reclaiming = reclaiming_;
+        reclaiming_ = true;
+
+        for (shrinker* s = shrinkers_; p == nullptr && s != nullptr;
+            s = s->next_)
+          {
+            std::size_t freed = s->func_ (bytes, s->args_);
+            if (freed != 0)
+              {
+                s->reclaimed_bytes_ += freed;
+                p = do_allocate (bytes, alignment);
+              }
+          }
+
+        if (p == nullptr && critical && reserve_ != nullptr)
+          {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+            trace::printf ("%s(%u,%u) @%p %s use reserve\n", __func__, bytes,
+                           alignment, this, name ());
+#endif
+            do_deallocate (reserve_, reserve_bytes_, max_align);
+            reserve_ = nullptr;
+
+            p = do_allocate (bytes, alignment);
+          }
+
+        reclaiming_ = reclaiming;
+        out_of_memory_handler_ = handler;
+
+        if (p == nullptr && handler != nullptr)
+          {
+            // Call the handler and retry, as usual.
+            p = do_allocate (bytes, alignment);
+          }
+
+        return p;
+      }
+
+      void
+      memory_resource::internal_rearm_reserve_ (void) noexcept
+      {
+        if (reclaiming_)
+          {
+            // Not with the memory released for a failing allocation.
+            return;
+          }
+
+        // Do not call the handler just for the reserve.
+        out_of_memory_handler_t handler = out_of_memory_handler_;
+        out_of_memory_handler_ = nullptr;
+
+        reserve_ = do_allocate (reserve_bytes_, max_align);
+
+        out_of_memory_handler_ = handler;
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ======================================================================
+
+      /**
+       * @details
+       * The shrinker is linked to the memory resource after the
+       * shrinkers with the same or higher priority.
+       *
+       * The reclaim function is called in the context of the failing
+       * allocation; it may deallocate memory from the same resource,
+       * but it must not allocate from it, and must not destroy
+       * the shrinker.
+       */
+      shrinker::shrinker (memory_resource& mr, reclaim_t func, void* args,
+                          priority_t prio) :
+          resource_ (mr), //
+          func_ (func), //
+          args_ (args), //
+          prio_ (prio)
+      {
+        assert(func != nullptr);
+
+        // ----- Enter critical section ---------------------------------------
+        scheduler::critical_section scs;
+
+        shrinker** link = &mr.shrinkers_;
+        while (*link != nullptr && (*link)->prio_ >= prio)
+          {
+            link = &(*link)->next_;
+          }
+        next_ = *link;
+        *link = this;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      shrinker::~shrinker ()
+      {
+        // ----- Enter critical section ---------------------------------------
+        scheduler::critical_section scs;
+
+        for (shrinker** link = &resource_.shrinkers_; *link != nullptr;
+            link = &(*link)->next_)
+          {
+            if (*link == this)
+              {
+                *link = next_;
+                break;
+              }
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
     // ------------------------------------------------------------------------
 
     } /* namespace memory */
@@ -547,3 +954,22 @@ namespace os
 } /* namespace os */
 
 // ----------------------------------------------------------------------------
+
+/**
+ * @details
+ * Called when a damaged chunk is found, either when a block is
+ * freed, if its guard word was overwritten, or by `verify()`.
+ *
+ * The memory manager cannot be trusted after this, so the default
+ * implementation displays the address and aborts; the application
+ * may redefine it to log the event and restart.
+ */
+void
+__attribute__((weak))
+os_rtos_memory_corruption_hook (void* resource, const void* addr)
+{
+  trace::printf ("memory corruption @%p in resource @%p\n", addr, resource);
+  abort ();
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,578 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class memory_pool_set::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts) to the memory pool set.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const memory_pool_set::attributes memory_pool_set::initializer;
+
+    constexpr memory_pool_set::index_t memory_pool_set::max_size;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class memory_pool_set
+     * @details
+     * A memory pool set groups several memory pools with different
+     * block sizes (size classes), and allocates variable size
+     * requests from the smallest class that fits. When that class
+     * is full, the next larger classes are tried, in order.
+     *
+     * The pools must be registered in increasing block size order,
+     * up to `OS_INTEGER_RTOS_MEMORY_POOL_SET_MAX_SIZE` pools.
+     * The blocks are freed via the set, which finds the owning
+     * pool by address range.
+     *
+     * The blocking calls wait on all the classes that fit; the
+     * thread is linked to the waiting lists of all these pools
+     * and is resumed by the first block freed in any of them.
+     *
+     * Per class usage counters (allocations, fallbacks to a larger
+     * class, maximum number of blocks in use) help tuning the pool
+     * sizes.
+     *
+     * The pools can be external, or can be included in the set,
+     * via `memory_pool_set_inclusive<>`.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * typedef struct { uint8_t data[64]; } small_blk_t;
+     * typedef struct { uint8_t data[256]; } medium_blk_t;
+     * typedef struct { uint8_t data[1536]; } large_blk_t;
+     *
+     * memory_pool_set_inclusive<
+     *     memory_pool_inclusive<small_blk_t, 32>,
+     *     memory_pool_inclusive<medium_blk_t, 16>,
+     *     memory_pool_inclusive<large_blk_t, 4>> pkt_pools { "pkt" };
+     *
+     * void
+     * func (void)
+     * {
+     *   void* p = pkt_pools.timed_alloc (200, 10);
+     *   if (p != nullptr)
+     *     {
+     *       // ...
+     *       pkt_pools.free (p);
+     *     }
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a named memory pool set with
+     * the pools referenced by _pools_ and attributes referenced
+     * by _attr_.
+     *
+     * The pools must have increasing block sizes, and must exist
+     * for as long as the set.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    memory_pool_set::memory_pool_set (const char* name,
+                                      memory_pool* const pools[],
+                                      index_t size, const attributes& attr) :
+        memory_pool_set
+          { name, attr }
+    {
+      internal_construct_ (pools, size);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    memory_pool_set::memory_pool_set (const char* name,
+                                      const attributes& attr) :
+        object_named_system
+          { name }
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+    }
+
+    void
+    memory_pool_set::internal_construct_ (memory_pool* const pools[],
+                                          index_t size)
+    {
+      assert(pools != nullptr);
+      assert(size > 0);
+      assert(size <= max_size);
+
+      for (index_t i = 0; i < size; ++i)
+        {
+          assert(pools[i] != nullptr);
+          // The classes must be sorted by increasing block size.
+          assert(i == 0 || pools[i - 1]->block_size () < pools[i]->block_size ());
+
+          pools_[i] = pools[i];
+        }
+      size_ = size;
+
+      clear_usage ();
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * It is safe to destroy a memory pool set on which no thread is
+     * waiting. The pools are not affected.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    memory_pool_set::~memory_pool_set ()
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    memory_pool_set::index_t
+    memory_pool_set::internal_first_fit_ (std::size_t bytes) const
+    {
+      for (index_t i = 0; i < size_; ++i)
+        {
+          if (pools_[i]->block_size () >= bytes)
+            {
+              return i;
+            }
+        }
+      return size_;
+    }
+
+    /*
+     * Internal function used to allocate a block from the first
+     * class that has free blocks, starting with `first`.
+     * Should be called from an interrupts critical section.
+     */
+    void*
+    memory_pool_set::internal_try_alloc_ (index_t first)
+    {
+      for (index_t i = first; i < size_; ++i)
+        {
+          void* p = pools_[i]->try_alloc ();
+          if (p != nullptr)
+            {
+              usage_counters& u = usage_[i];
+              ++u.allocations;
+              if (i != first)
+                {
+                  ++u.fallbacks;
+                }
+              std::size_t count = pools_[i]->count ();
+              if (count > u.count_max)
+                {
+                  u.count_max = count;
+                }
+              return p;
+            }
+        }
+      return nullptr;
+    }
+
+    void*
+    memory_pool_set::internal_alloc_ (std::size_t bytes, bool timed,
+                                      clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_throw(!scheduler::locked (), EPERM);
+
+      void* p;
+
+      index_t first = internal_first_fit_ (bytes);
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (first >= size_)
+            {
+              // No class can ever satisfy the request, do not wait.
+              ++failures_;
+              return nullptr;
+            }
+
+          p = internal_try_alloc_ (first);
+          if (p != nullptr)
+            {
+              return p;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare one list node per fitting class, pointing to the
+      // current thread. Do not worry for being on stack, they are
+      // temporarily linked to the lists and guaranteed to be removed
+      // before this function returns.
+      internal::waiting_thread_node nodes[max_size];
+      for (index_t i = first; i < size_; ++i)
+        {
+          nodes[i].thread_ = &crt_thread;
+        }
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              p = internal_try_alloc_ (first);
+              if (p != nullptr)
+                {
+                  return p;
+                }
+
+              // Add this thread to the first fitting pool waiting list,
+              // and, for timed waits, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (pools_[first]->list_,
+                                                 nodes[first], clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (pools_[first]->list_,
+                                                 nodes[first]);
+                }
+              // state::suspended set in above link().
+
+              // Add this thread to the larger pools waiting lists.
+              for (index_t i = first + 1; i < size_; ++i)
+                {
+                  pools_[i]->list_.link (nodes[i]);
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              // Remove the thread from the larger pools waiting lists,
+              // if not already removed by a free().
+              for (index_t i = first + 1; i < size_; ++i)
+                {
+                  nodes[i].unlink ();
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          // Remove the thread from the first waiting list,
+          // if not already removed, and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (nodes[first], timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (nodes[first]);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s() INTR @%p %s\n", __func__, this, name ());
+#endif
+              p = nullptr;
+              break;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s() TMO @%p %s\n", __func__, this, name ());
+#endif
+              // Give a last chance, a block might have been freed
+              // just before the timeout.
+              interrupts::critical_section ics;
+              p = internal_try_alloc_ (first);
+              break;
+            }
+        }
+
+#else
+
+      // The port pools do not expose their waiting lists; wait
+      // only on the first fitting class.
+      p = timed ? pools_[first]->timed_alloc (timeout) : pools_[first]->alloc ();
+      if (p != nullptr)
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          usage_counters& u = usage_[first];
+          ++u.allocations;
+          if (pools_[first]->count () > u.count_max)
+            {
+              u.count_max = pools_[first]->count ();
+            }
+          return p;
+          // ----- Exit critical section --------------------------------------
+        }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MEMORY_POOL) */
+
+      if (p == nullptr)
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          ++failures_;
+          // ----- Exit critical section --------------------------------------
+        }
+      return p;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The `alloc()` function shall allocate a block of at least
+     * _bytes_ bytes from the smallest size class that fits and
+     * has free blocks.
+     *
+     * If all fitting classes are full, `alloc()` shall block
+     * until a block is freed in any of them, or until
+     * it is cancelled/interrupted.
+     *
+     * If _bytes_ is larger than the largest block size, `alloc()`
+     * shall immediately return `nullptr`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void*
+    memory_pool_set::alloc (std::size_t bytes)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (bytes), this, name ());
+#endif
+
+      return internal_alloc_ (bytes, false, 0);
+    }
+
+    /**
+     * @details
+     * Try to allocate a block of at least _bytes_ bytes from the
+     * smallest size class that fits and has free blocks; if all
+     * fitting classes are full, return `nullptr`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void*
+    memory_pool_set::try_alloc (std::size_t bytes)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (bytes), this, name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      index_t first = internal_first_fit_ (bytes);
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      void* p = (first < size_) ? internal_try_alloc_ (first) : nullptr;
+      if (p == nullptr)
+        {
+          ++failures_;
+        }
+      return p;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * The `timed_alloc()` function shall allocate a block as
+     * `alloc()`, but the wait shall be terminated when the specified
+     * timeout expires.
+     *
+     * Under no circumstance shall the operation fail with a timeout
+     * if a block can be allocated immediately from any of the fitting
+     * classes.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void*
+    memory_pool_set::timed_alloc (std::size_t bytes,
+                                  clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%u, %u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (bytes),
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_alloc_ (bytes, true, timeout);
+    }
+
+    /**
+     * @details
+     * Return a block previously allocated by `alloc()` to the pool
+     * that owns it, found by address range.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    memory_pool_set::free (void* block)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%p) @%p %s\n", __func__, block, this, name ());
+#endif
+
+      memory_pool* mp = owner (block);
+      if (mp == nullptr)
+        {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+          trace::printf ("%s(%p) EINVAL @%p %s\n", __func__, block, this,
+                         name ());
+#endif
+          return EINVAL;
+        }
+
+      return mp->free (block);
+    }
+
+    /**
+     * @details
+     * The pools are checked in order, with the same address range
+     * test used by `memory_pool::free()`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    memory_pool*
+    memory_pool_set::owner (void* block) const
+    {
+      for (index_t i = 0; i < size_; ++i)
+        {
+          if (pools_[i]->internal_is_valid_ (block))
+            {
+              return pools_[i];
+            }
+        }
+      return nullptr;
+    }
+
+    /**
+     * @details
+     * The largest request that can be satisfied by the set.
+     */
+    std::size_t
+    memory_pool_set::max_block_size (void) const
+    {
+      return (size_ > 0) ? pools_[size_ - 1]->block_size () : 0;
+    }
+
+    /**
+     * @details
+     * The maximum counts restart from the current number of
+     * blocks in use.
+     */
+    void
+    memory_pool_set::clear_usage (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      for (index_t i = 0; i < size_; ++i)
+        {
+          usage_[i].allocations = 0;
+          usage_[i].fallbacks = 0;
+          usage_[i].count_max = pools_[i]->count ();
+        }
+      failures_ = 0;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
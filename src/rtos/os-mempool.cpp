@@ -257,6 +257,10 @@ namespace os
      * the storage is dynamically allocated using the RTOS specific allocator
      * (`rtos::memory::allocator`).
      *
+     * If `mp_pool_region` names a registered memory region
+     * (see `memory::set_region()`), the storage is allocated from
+     * that region instead.
+     *
      * @warning Cannot be invoked from Interrupt Service Routines.
      */
     memory_pool::memory_pool (const char* name, std::size_t blocks,
@@ -287,9 +291,26 @@ namespace os
               + sizeof(typename allocator_type::value_type) - 1)
               / sizeof(typename allocator_type::value_type);
 
-          allocated_pool_addr_ =
-              const_cast<allocator_type&> (allocator).allocate (
-                  allocated_pool_size_elements_);
+          memory::memory_resource* res =
+              (attr.mp_pool_region != nullptr) ?
+                  memory::region (attr.mp_pool_region) : nullptr;
+          if (res != nullptr)
+            {
+              allocated_pool_resource_ = res;
+
+              scheduler::critical_section scs;
+
+              allocated_pool_addr_ = res->allocate (
+                  allocated_pool_size_elements_
+                      * sizeof(typename allocator_type::value_type),
+                  alignof(typename allocator_type::value_type));
+            }
+          else
+            {
+              allocated_pool_addr_ =
+                  const_cast<allocator_type&> (allocator).allocate (
+                      allocated_pool_size_elements_);
+            }
 
           internal_construct_ (
               blocks,
@@ -406,7 +427,17 @@ namespace os
 
       typedef typename std::allocator_traits<allocator_type>::pointer pointer;
 
-      if (allocated_pool_addr_ != nullptr)
+      if (allocated_pool_resource_ != nullptr)
+        {
+          scheduler::critical_section scs;
+
+          allocated_pool_resource_->deallocate (
+              allocated_pool_addr_,
+              allocated_pool_size_elements_
+                  * sizeof(typename allocator_type::value_type),
+              alignof(typename allocator_type::value_type));
+        }
+      else if (allocated_pool_addr_ != nullptr)
         {
           static_cast<allocator_type*> (const_cast<void*> (allocator_))->deallocate (
               static_cast<pointer> (allocated_pool_addr_),
@@ -418,6 +449,23 @@ namespace os
      * @cond ignore
      */
 
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+    void
+    memory_pool::internal_describe_footprint_ (const void* object,
+                                               footprint::item& it)
+    {
+      const memory_pool* mp = static_cast<const memory_pool*> (object);
+
+      it.name = mp->name ();
+      it.object_bytes = sizeof(memory_pool);
+      it.storage_bytes = mp->pool_size_bytes_;
+      it.used_bytes = static_cast<std::size_t> (mp->count_)
+          * mp->block_size_bytes_;
+    }
+
+#endif
+
     /*
      * Construct the linked list of blocks and initialise the
      * internal pointers and counters.
@@ -425,6 +473,12 @@ namespace os
     void
     memory_pool::internal_init_ (void)
     {
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      free_list_.init (pool_addr_, blocks_, block_size_bytes_);
+
+#else
+
       // Construct a linked list of blocks. Store the pointer at
       // the beginning of each block. Each block
       // will hold the address of the next free block, or nullptr at the end.
@@ -445,17 +499,31 @@ namespace os
 
       first_ = pool_addr_; // Pointer to first block.
 
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
       count_ = 0; // No allocated blocks.
     }
 
     /*
      * Internal function used to return the first block in the
      * free list.
-     * Should be called from an interrupts critical section.
+     * Should be called from an interrupts critical section,
+     * unless the free list is lock free.
      */
     void*
     memory_pool::internal_try_first_ (void)
     {
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      void* p = free_list_.pop ();
+      if (p != nullptr)
+        {
+          __atomic_fetch_add (&count_, 1, __ATOMIC_RELAXED);
+        }
+      return p;
+
+#else
+
       if (first_ != nullptr)
         {
           void* p = static_cast<void*> (first_);
@@ -465,6 +533,64 @@ namespace os
         }
 
       return nullptr;
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+    }
+
+    /*
+     * Internal function used to return a batch of blocks from the
+     * free list; the blocks are taken from the head of the list
+     * in a single pass, and the list head is updated only once.
+     * Should be called from an interrupts critical section,
+     * unless the free list is lock free.
+     */
+    std::size_t
+    memory_pool::internal_try_first_n_ (std::size_t count, void* blocks[])
+    {
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      // The lock free list has no splice operation, the blocks
+      // are popped one by one.
+      std::size_t n = 0;
+      while (n < count)
+        {
+          void* p = free_list_.pop ();
+          if (p == nullptr)
+            {
+              break;
+            }
+          blocks[n++] = p;
+        }
+      if (n > 0)
+        {
+          __atomic_fetch_add (&count_, n, __ATOMIC_RELAXED);
+        }
+      return n;
+
+#else
+
+      std::size_t n = 0;
+      void* p = first_;
+      while (n < count && p != nullptr)
+        {
+          blocks[n++] = p;
+          p = *(static_cast<void**> (p));
+        }
+
+      first_ = p;
+      count_ += n;
+
+      return n;
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+    }
+
+    bool
+    memory_pool::internal_is_valid_ (void* block) const
+    {
+      return (block >= pool_addr_)
+          && (block
+              < (static_cast<char*> (pool_addr_) + blocks_ * block_size_bytes_));
     }
 
     /**
@@ -507,8 +633,10 @@ namespace os
       // Extra test before entering the loop, with its inherent weight.
       // Trade size for speed.
         {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
+#endif
 
           p = internal_try_first_ ();
           if (p != nullptr)
@@ -584,6 +712,10 @@ namespace os
      * This function uses a critical section to protect against simultaneous
      * access from other threads or interrupts.
      *
+     * When `OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE` is defined, the
+     * block is removed from a lock free list and interrupts are
+     * not masked.
+     *
      * @note Can be invoked from Interrupt Service Routines.
      */
     void*
@@ -598,8 +730,10 @@ namespace os
 
       void* p;
         {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
+#endif
 
           p = internal_try_first_ ();
           // ----- Exit critical section --------------------------------------
@@ -670,8 +804,10 @@ namespace os
       // Extra test before entering the loop, with its inherent weight.
       // Trade size for speed.
         {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
+#endif
 
           p = internal_try_first_ ();
           if (p != nullptr)
@@ -758,6 +894,10 @@ namespace os
      * It uses a critical section to protect simultaneous access from
      * other threads or interrupts.
      *
+     * When `OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE` is defined, the
+     * block is added to a lock free list, and the critical section
+     * is entered only if there are waiting threads.
+     *
      * @note Can be invoked from Interrupt Service Routines.
      */
     result_t
@@ -771,9 +911,7 @@ namespace os
       assert(port::interrupts::is_priority_valid ());
 
       // Validate pointer.
-      if ((block < pool_addr_)
-          || (block
-              >= (static_cast<char*> (pool_addr_) + blocks_ * block_size_bytes_)))
+      if (!internal_is_valid_ (block))
         {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
           trace::printf ("%s(%p) EINVAL @%p %s\n", __func__, block, this,
@@ -782,6 +920,24 @@ namespace os
           return EINVAL;
         }
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      // Add the block to the lock free list; this is safe against
+      // waiters, which check the list and link to the waiting list
+      // in the same interrupts critical section, thus either they
+      // get the block, or the waiting list is already not empty below.
+      free_list_.push (block);
+      __atomic_fetch_sub (&count_, 1, __ATOMIC_RELAXED);
+
+      // Enter the critical section only if there are waiting threads.
+      if (!list_.empty ())
+        {
+          // Wake-up one thread.
+          list_.resume_one ();
+        }
+
+#else
+
         {
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
@@ -803,6 +959,402 @@ namespace os
       // Wake-up one thread, if any.
       list_.resume_one ();
 
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The `alloc_n()` function shall allocate up to `count`
+     * fixed size memory blocks from the memory pool, and store
+     * their addresses in the `blocks` array.
+     *
+     * If the memory pool is empty, `alloc_n()` shall block,
+     * as `alloc()`, until at least one block is freed or until
+     * `alloc_n()` is cancelled/interrupted; it then returns all the
+     * available blocks, up to `count`, without waiting for more.
+     *
+     * All blocks are taken from the free list in a single
+     * critical section, which is entered once per call, not once
+     * per block.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    memory_pool::alloc_n (std::size_t count, void* blocks[])
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (count), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_throw(!scheduler::locked (), EPERM);
+
+      assert(blocks != nullptr || count == 0);
+
+      if (count == 0)
+        {
+          return 0;
+        }
+
+      std::size_t n;
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+#endif
+
+          n = internal_try_first_n_ (count, blocks);
+          if (n > 0)
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s()=%u @%p %s\n", __func__,
+                             static_cast<unsigned int> (n), this, name ());
+#endif
+              return n;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              n = internal_try_first_n_ (count, blocks);
+              if (n > 0)
+                {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+                  trace::printf ("%s()=%u @%p %s\n", __func__,
+                                 static_cast<unsigned int> (n), this,
+                                 name ());
+#endif
+                  return n;
+                }
+
+              // Add this thread to the memory pool waiting list.
+              scheduler::internal_link_node (list_, node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the memory pool waiting list,
+          // if not already removed by free().
+          scheduler::internal_unlink_node (node);
+
+          if (this_thread::thread ().interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s() INTR @%p %s\n", __func__, this, name ());
+#endif
+              return 0;
+            }
+        }
+
+      /* NOTREACHED */
+    }
+
+    /**
+     * @details
+     * Try to allocate up to `count` fixed size memory blocks from
+     * the memory pool, and store their addresses in the `blocks`
+     * array. If fewer blocks are available, all of them are
+     * returned; if the pool is empty, return 0 immediately.
+     *
+     * All blocks are taken from the free list in a single
+     * critical section.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    memory_pool::try_alloc_n (std::size_t count, void* blocks[])
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (count), this, name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      assert(blocks != nullptr || count == 0);
+
+      std::size_t n;
+        {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+#endif
+
+          n = internal_try_first_n_ (count, blocks);
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s()=%u @%p %s\n", __func__,
+                     static_cast<unsigned int> (n), this, name ());
+#endif
+      return n;
+    }
+
+    /**
+     * @details
+     * The `timed_alloc_n()` function shall allocate up to `count`
+     * fixed size memory blocks from the memory pool, as `alloc_n()`,
+     * but the wait for the first block shall be terminated when
+     * the specified timeout expires, as for `timed_alloc()`.
+     *
+     * Under no circumstance shall the operation fail with a timeout
+     * if at least one block can be allocated immediately.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    memory_pool::timed_alloc_n (std::size_t count, void* blocks[],
+                                clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%u, %u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (count),
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_throw(!scheduler::locked (), EPERM);
+
+      assert(blocks != nullptr || count == 0);
+
+      if (count == 0)
+        {
+          return 0;
+        }
+
+      std::size_t n;
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+#if !defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+#endif
+
+          n = internal_try_first_n_ (count, blocks);
+          if (n > 0)
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s()=%u @%p %s\n", __func__,
+                             static_cast<unsigned int> (n), this, name ());
+#endif
+              return n;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              n = internal_try_first_n_ (count, blocks);
+              if (n > 0)
+                {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+                  trace::printf ("%s()=%u @%p %s\n", __func__,
+                                 static_cast<unsigned int> (n), this,
+                                 name ());
+#endif
+                  return n;
+                }
+
+              // Add this thread to the memory pool waiting list,
+              // and the clock timeout list.
+              scheduler::internal_link_node (list_, node, clock_list,
+                                             timeout_node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the memory pool waiting list,
+          // if not already removed by free() and from the clock
+          // timeout list, if not already removed by the timer.
+          scheduler::internal_unlink_node (node, timeout_node);
+
+          if (this_thread::thread ().interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s() INTR @%p %s\n", __func__, this, name ());
+#endif
+              return 0;
+            }
+
+          if (clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s() TMO @%p %s\n", __func__, this, name ());
+#endif
+              return 0;
+            }
+        }
+
+      /* NOTREACHED */
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // Filter used by free_n() to resume at most as many waiting
+      // threads as blocks were released.
+      bool
+      mempool_resume_filter (internal::waiting_thread_node& node, void* arg)
+      {
+        (void) node;
+        std::size_t* remaining = static_cast<std::size_t*> (arg);
+        if (*remaining == 0)
+          {
+            return false;
+          }
+        --(*remaining);
+        return true;
+      }
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Return `count` memory blocks previously allocated by `alloc()`
+     * or `alloc_n()` back to the memory pool.
+     *
+     * All addresses are validated first; if any of them does not
+     * belong to the pool, no block is released.
+     *
+     * The blocks are chained together outside the critical section,
+     * and the chain is spliced in front of the free list in a single
+     * critical section. The waiting threads, at most one per
+     * released block, are resumed together, with a single
+     * reschedule.
+     *
+     * When `OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE` is defined, the
+     * blocks are pushed one by one to the lock free list.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    memory_pool::free_n (std::size_t count, void* blocks[])
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (count), this, name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      if (count == 0)
+        {
+          return result::ok;
+        }
+
+      assert(blocks != nullptr);
+
+      // Validate all pointers before changing anything.
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          if (!internal_is_valid_ (blocks[i]))
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              trace::printf ("%s(%p) EINVAL @%p %s\n", __func__, blocks[i],
+                             this, name ());
+#endif
+              return EINVAL;
+            }
+        }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE)
+
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          free_list_.push (blocks[i]);
+        }
+      __atomic_fetch_sub (&count_, count, __ATOMIC_RELAXED);
+
+      // Enter the critical section only if there are waiting threads.
+      if (list_.empty ())
+        {
+          return result::ok;
+        }
+
+#else
+
+      // Chain the blocks together; they are owned by the caller,
+      // so this needs no protection.
+      for (std::size_t i = 0; i + 1 < count; ++i)
+        {
+          *(static_cast<void**> (blocks[i])) = blocks[i + 1];
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          // Splice the chain in front of the free list.
+          *(static_cast<void**> (blocks[count - 1])) = first_;
+          first_ = blocks[0];
+
+          count_ -= count;
+          // ----- Exit critical section --------------------------------------
+        }
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_POOL_LOCK_FREE) */
+
+      // Wake-up at most one thread per released block, if any.
+      std::size_t remaining = count;
+      list_.resume_if (mempool_resume_filter, &remaining);
+
       return result::ok;
     }
 
@@ -26,6 +26,8 @@
  */
 
 #include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/profile.h>
+#include <cmsis-plus/utils/copy.h>
 
 // ----------------------------------------------------------------------------
 
@@ -73,12 +75,33 @@ namespace os
      * checked, but it is recommended to leave it zero.
      */
 
+    /**
+     * @var bool message_queue::attributes::mq_store_lengths
+     * @details
+     * Set this variable to `true` to store the actual length of
+     * each message; `send()` then no longer fills the unused part
+     * of shorter messages with zeros, `receive()` copies only the
+     * actual message and can return its length.
+     *
+     * The lengths need an extra array in the queue storage; for user
+     * provided storage, compute its size with
+     * `compute_allocated_size_bytes()` with _store_lengths_ set.
+     * The `message_queue_inclusive` storage does not include this array.
+     *
+     * The default value is `false`.
+     */
+
     /**
      * @details
      * This variable is used by the default constructor.
      */
     const message_queue::attributes message_queue::initializer;
 
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+    constexpr std::size_t message_queue::priorities;
+#endif
+
     // ------------------------------------------------------------------------
 
     /**
@@ -412,6 +435,10 @@ namespace os
      * the storage is dynamically allocated using the RTOS specific allocator
      * (`rtos::memory::allocator`).
      *
+     * If `mq_queue_region` names a registered memory region
+     * (see `memory::set_region()`), the storage is allocated from
+     * that region instead.
+     *
      * @warning Cannot be invoked from Interrupt Service Routines.
      */
     message_queue::message_queue (const char* name, std::size_t msgs,
@@ -438,13 +465,31 @@ namespace os
           // If no user storage was provided via attributes,
           // allocate it dynamically via the allocator.
           allocated_queue_size_elements_ = (compute_allocated_size_bytes<
-              typename allocator_type::value_type> (msgs, msg_size_bytes)
+              typename allocator_type::value_type> (msgs, msg_size_bytes,
+                                                    attr.mq_store_lengths)
               + sizeof(typename allocator_type::value_type) - 1)
               / sizeof(typename allocator_type::value_type);
 
-          allocated_queue_addr_ =
-              const_cast<allocator_type&> (allocator).allocate (
-                  allocated_queue_size_elements_);
+          memory::memory_resource* res =
+              (attr.mq_queue_region != nullptr) ?
+                  memory::region (attr.mq_queue_region) : nullptr;
+          if (res != nullptr)
+            {
+              allocated_queue_resource_ = res;
+
+              scheduler::critical_section scs;
+
+              allocated_queue_addr_ = res->allocate (
+                  allocated_queue_size_elements_
+                      * sizeof(typename allocator_type::value_type),
+                  alignof(typename allocator_type::value_type));
+            }
+          else
+            {
+              allocated_queue_addr_ =
+                  const_cast<allocator_type&> (allocator).allocate (
+                      allocated_queue_size_elements_);
+            }
 
           internal_construct_ (
               msgs,
@@ -484,7 +529,17 @@ namespace os
 
 #endif
 
-      if (allocated_queue_addr_ != nullptr)
+      if (allocated_queue_resource_ != nullptr)
+        {
+          scheduler::critical_section scs;
+
+          allocated_queue_resource_->deallocate (
+              allocated_queue_addr_,
+              allocated_queue_size_elements_
+                  * sizeof(typename allocator_type::value_type),
+              alignof(typename allocator_type::value_type));
+        }
+      else if (allocated_queue_addr_ != nullptr)
         {
           typedef typename std::allocator_traits<allocator_type>::pointer pointer;
 
@@ -504,6 +559,23 @@ namespace os
      * @cond ignore
      */
 
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+    void
+    message_queue::internal_describe_footprint_ (const void* object,
+                                                 footprint::item& it)
+    {
+      const message_queue* mq = static_cast<const message_queue*> (object);
+
+      it.name = mq->name ();
+      it.object_bytes = sizeof(message_queue);
+      it.storage_bytes = mq->queue_size_bytes_;
+      it.used_bytes = static_cast<std::size_t> (mq->count_)
+          * mq->msg_size_bytes_;
+    }
+
+#endif
+
     void
     message_queue::internal_construct_ (std::size_t msgs,
                                         std::size_t msg_size_bytes,
@@ -547,7 +619,7 @@ namespace os
 
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
       std::size_t storage_size = compute_allocated_size_bytes<void*> (
-          msgs, msg_size_bytes);
+          msgs, msg_size_bytes, attr.mq_store_lengths);
 #endif
       if (queue_addr_ != nullptr)
         {
@@ -590,11 +662,34 @@ namespace os
           reinterpret_cast<priority_t*> (reinterpret_cast<char*> (const_cast<index_t*> (next_array_))
               + msgs * sizeof(index_t));
 
-#if !defined(NDEBUG)
       char* p =
           reinterpret_cast<char*> (reinterpret_cast<char*> (const_cast<priority_t*> (prio_array_))
               + msgs * sizeof(priority_t));
 
+      if (attr.mq_store_lengths)
+        {
+          // The optional array of lengths follows the priorities array,
+          // aligned to the length type.
+          p = reinterpret_cast<char*> ((reinterpret_cast<std::uintptr_t> (p)
+              + (sizeof(msg_size_t) - 1)) & ~(sizeof(msg_size_t) - 1));
+          len_array_ = reinterpret_cast<msg_size_t*> (p);
+          p += msgs * sizeof(msg_size_t);
+        }
+      else
+        {
+          len_array_ = nullptr;
+        }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+      // The array of enqueue timestamps is the last one.
+      p = reinterpret_cast<char*> ((reinterpret_cast<std::uintptr_t> (p)
+          + (sizeof(stamp_t) - 1)) & ~(sizeof(stamp_t) - 1));
+      stamp_array_ = reinterpret_cast<stamp_t*> (p);
+      p += msgs * sizeof(stamp_t);
+#endif
+
+#if !defined(NDEBUG)
+
       assert(
           p - static_cast<char*> (queue_addr_)
               <= static_cast<ptrdiff_t> (queue_size_bytes_));
@@ -619,7 +714,7 @@ namespace os
       for (std::size_t i = 1; i < msgs_; ++i)
         {
           // Compute the address of the next block;
-          char* pn = p + msg_size_bytes_;
+          char* pn = p + internal_slot_size_ ();
 
           // Make this block point to the next one.
           *(static_cast<void**> (static_cast<void*> (p))) = pn;
@@ -634,6 +729,17 @@ namespace os
 
       head_ = no_index;
 
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      for (auto& w : prio_map_)
+        {
+          w = 0;
+        }
+      for (auto& t : prio_tails_)
+        {
+          t = no_index;
+        }
+#endif
+
       // Need not be inside the critical section,
       // the lists are protected by inner `resume_one()`.
 
@@ -651,47 +757,46 @@ namespace os
      * Internal function.
      * Should be called from an interrupts critical section.
      */
-    bool
-    message_queue::internal_try_send_ (const void* msg, std::size_t nbytes,
-                                       priority_t mprio)
+    char*
+    message_queue::internal_alloc_slot_ (void)
     {
       if (first_free_ == nullptr)
         {
           // No available space to send the message.
-          return false;
+          return nullptr;
         }
 
-      // The first step is to remove the free block from the list,
+      // Remove the free block from the list,
       // so another concurrent call will not get it too.
 
-      // Get the address where the message will be copied.
       // This is the first free memory block.
-      char* dest = static_cast<char*> (first_free_);
+      char* slot = static_cast<char*> (first_free_);
 
       // Update to next free, if any (the last one has nullptr).
       first_free_ = *(static_cast<void**> (first_free_));
 
-      // The second step is to copy the message from the user buffer.
-        {
-          // ----- Enter uncritical section -----------------------------------
-          // interrupts::uncritical_section iucs;
-
-          // Copy message from user buffer to queue storage.
-          std::memcpy (dest, msg, nbytes);
-          if (nbytes < msg_size_bytes_)
-            {
-              // Fill in the remaining space with 0x00.
-              std::memset (dest + nbytes, 0x00, msg_size_bytes_ - nbytes);
-            }
-          // ----- Exit uncritical section ------------------------------------
-        }
-
-      // The third step is to link the buffer to the list.
+      return slot;
+    }
 
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    void
+    message_queue::internal_commit_slot_ (char* slot, std::size_t nbytes,
+                                          priority_t mprio)
+    {
       // Using the address, compute the index in the array.
-      std::size_t msg_ix = (static_cast<std::size_t> (dest
-          - static_cast<char*> (queue_addr_)) / msg_size_bytes_);
+      std::size_t msg_ix = (static_cast<std::size_t> (slot
+          - static_cast<char*> (queue_addr_)) / internal_slot_size_ ());
       prio_array_[msg_ix] = mprio;
+      if (len_array_ != nullptr)
+        {
+          len_array_[msg_ix] = static_cast<msg_size_t> (nbytes);
+        }
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+      stamp_array_[msg_ix] = static_cast<stamp_t> (hrclock.now ());
+#endif
 
       if (head_ == no_index)
         {
@@ -704,6 +809,26 @@ namespace os
       else
         {
           std::size_t ix;
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+          // Insert after the last message with the same priority or,
+          // if there is none, after the last message of the closest
+          // higher priority; if there is none either, the new
+          // message becomes the new head, inserted after the tail.
+          ix = prio_tails_[mprio];
+          if (ix == no_index)
+            {
+              std::size_t above = internal_prio_above_ (mprio);
+              if (above < priorities)
+                {
+                  ix = prio_tails_[above];
+                }
+              else
+                {
+                  ix = prev_array_[head_];
+                  head_ = static_cast<index_t> (msg_ix);
+                }
+            }
+#else
           // Arrange to insert between head and tail.
           ix = prev_array_[head_];
           // Check if the priority is higher than the head priority.
@@ -722,6 +847,7 @@ namespace os
                   ix = prev_array_[ix];
                 }
             }
+#endif
           prev_array_[msg_ix] = static_cast<index_t> (ix);
           next_array_[msg_ix] = next_array_[ix];
 
@@ -731,40 +857,60 @@ namespace os
           prev_array_[tmp_ix] = static_cast<index_t> (msg_ix);
         }
 
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      // The new message is the last one of its priority.
+      prio_tails_[mprio] = static_cast<index_t> (msg_ix);
+      prio_map_[mprio / 32] |= (1u << (mprio % 32));
+#endif
+
       // One more message added to the queue.
       ++count_;
 
-      // Wake-up one thread, if any.
-      receive_list_.resume_one ();
-
-      return true;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+      if (count_ > statistics_.depth_max_)
+        {
+          statistics_.depth_max_ = count_;
+        }
+#endif
     }
 
-#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
-
-#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
-
     /*
      * Internal function.
      * Should be called from an interrupts critical section.
      */
-    bool
-    message_queue::internal_try_receive_ (void* msg, std::size_t nbytes,
-                                          priority_t* mprio)
+    char*
+    message_queue::internal_take_head_ (priority_t* mprio)
     {
-
       if (head_ == no_index)
         {
-          return false;
+          return nullptr;
         }
 
       // Compute the message source address.
-      char* src = static_cast<char*> (queue_addr_) + head_ * msg_size_bytes_;
-      priority_t prio = prio_array_[head_];
+      char* slot = static_cast<char*> (queue_addr_)
+          + head_ * internal_slot_size_ ();
+      *mprio = prio_array_[head_];
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+      // The subtraction on the low word is correct across wraps.
+      rtos::statistics::duration_t latency =
+          static_cast<stamp_t> (static_cast<stamp_t> (hrclock.now ())
+              - stamp_array_[head_]);
+      ++statistics_.received_;
+      statistics_.latency_total_ += latency;
+      if (latency > statistics_.latency_max_)
+        {
+          statistics_.latency_max_ = latency;
+        }
+#endif
 
-#if defined(OS_TRACE_RTOS_MQUEUE_)
-      trace::printf ("%s(%p,%u) @%p %s src %p %p\n", __func__, msg, nbytes,
-          this, name (), src, first_free_);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      if (prio_tails_[*mprio] == head_)
+        {
+          // This was the only message left with this priority.
+          prio_tails_[*mprio] = no_index;
+          prio_map_[*mprio / 32] &= ~(1u << (*mprio % 32));
+        }
 #endif
 
       // Unlink it from the list, so another concurrent call will
@@ -786,31 +932,153 @@ namespace os
 
       --count_;
 
-      // Copy to destination
+      return slot;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    void
+    message_queue::internal_release_slot_ (char* slot)
+    {
+      // Perform a push_front() on the single linked LIFO list,
+      // i.e. add the block to the beginning of the list.
+
+      // Link previous list to this block; may be null, but it does
+      // not matter.
+      *(static_cast<void**> (static_cast<void*> (slot))) = first_free_;
+
+      // Now this block is the first one.
+      first_free_ = slot;
+    }
+
+    bool
+    message_queue::internal_is_slot_ (const void* slot) const
+    {
+      const char* p = static_cast<const char*> (slot);
+      const char* begin = static_cast<const char*> (queue_addr_);
+
+      if (p < begin || p >= begin + msgs_ * internal_slot_size_ ())
+        {
+          return false;
+        }
+
+      return (static_cast<std::size_t> (p - begin) % internal_slot_size_ ())
+          == 0;
+    }
+
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     *
+     * The number of words is a small constant, so the search
+     * takes constant time.
+     */
+    std::size_t
+    message_queue::internal_prio_above_ (priority_t mprio) const
+    {
+      std::size_t first = static_cast<std::size_t> (mprio) + 1;
+      for (std::size_t w = first / 32; w < (priorities + 31) / 32; ++w)
+        {
+          uint32_t bits = prio_map_[w];
+          if (w == first / 32)
+            {
+              // Ignore the priorities up to mprio.
+              bits &= ~((1u << (first % 32)) - 1u);
+            }
+          if (bits != 0)
+            {
+              return w * 32
+                  + static_cast<std::size_t> (__builtin_ctz (bits));
+            }
+        }
+
+      return priorities;
+    }
+
+#endif
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    message_queue::internal_try_send_ (const void* msg, std::size_t nbytes,
+                                       priority_t mprio)
+    {
+      if (!internal_enqueue_ (msg, nbytes, mprio))
+        {
+          return false;
+        }
+
+      // Wake-up one thread, if any.
+      receive_list_.resume_one ();
+
+      return true;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    message_queue::internal_enqueue_ (const void* msg, std::size_t nbytes,
+                                      priority_t mprio)
+    {
+      // The first step is to remove the free block from the list,
+      // so another concurrent call will not get it too.
+
+      // Get the address where the message will be copied.
+      char* dest = internal_alloc_slot_ ();
+      if (dest == nullptr)
+        {
+          // No available space to send the message.
+          return false;
+        }
+
+      // The second step is to copy the message from the user buffer.
         {
           // ----- Enter uncritical section -----------------------------------
-          interrupts::uncritical_section iucs;
+          // interrupts::uncritical_section iucs;
 
-          // Copy message from queue to user buffer.
-          memcpy (msg, src, nbytes);
-          if (mprio != nullptr)
+          // Copy message from user buffer to queue storage.
+          utils::copy_bytes (dest, msg, nbytes);
+          // When the lengths are stored, the padding is not needed.
+          if (nbytes < msg_size_bytes_ && len_array_ == nullptr)
             {
-              *mprio = prio;
+              // Fill in the remaining space with 0x00.
+              utils::fill_bytes (dest + nbytes, 0x00,
+                                 msg_size_bytes_ - nbytes);
             }
           // ----- Exit uncritical section ------------------------------------
         }
 
-      // After the message was copied, the block can be released.
+      // The third step is to link the buffer to the list.
+      internal_commit_slot_ (dest, nbytes, mprio);
 
-      // Perform a push_front() on the single linked LIFO list,
-      // i.e. add the block to the beginning of the list.
+      return true;
+    }
 
-      // Link previous list to this block; may be null, but it does
-      // not matter.
-      *(static_cast<void**> (static_cast<void*> (src))) = first_free_;
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
 
-      // Now this block is the first one.
-      first_free_ = src;
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    message_queue::internal_try_receive_ (void* msg, std::size_t nbytes,
+                                          priority_t* mprio,
+                                          std::size_t* length)
+    {
+      if (!internal_dequeue_ (msg, nbytes, mprio, length))
+        {
+          return false;
+        }
 
       // Wake-up one thread, if any.
       send_list_.resume_one ();
@@ -818,6 +1086,62 @@ namespace os
       return true;
     }
 
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    message_queue::internal_dequeue_ (void* msg, std::size_t nbytes,
+                                      priority_t* mprio, std::size_t* length)
+    {
+      priority_t prio;
+
+      // Unlink the head message, so another concurrent call will
+      // not get it too.
+      char* src = internal_take_head_ (&prio);
+      if (src == nullptr)
+        {
+          return false;
+        }
+
+#if defined(OS_TRACE_RTOS_MQUEUE_)
+      trace::printf ("%s(%p,%u) @%p %s src %p %p\n", __func__, msg, nbytes,
+          this, name (), src, first_free_);
+#endif
+
+      // Copy to destination
+        {
+          // ----- Enter uncritical section -----------------------------------
+          interrupts::uncritical_section iucs;
+
+          std::size_t len = nbytes;
+          if (len_array_ != nullptr)
+            {
+              // Copy only the actual message.
+              std::size_t msg_ix = (static_cast<std::size_t> (src
+                  - static_cast<char*> (queue_addr_)) / internal_slot_size_ ());
+              len = len_array_[msg_ix];
+            }
+
+          // Copy message from queue to user buffer.
+          utils::copy_bytes (msg, src, len < nbytes ? len : nbytes);
+          if (mprio != nullptr)
+            {
+              *mprio = prio;
+            }
+          if (length != nullptr)
+            {
+              *length = len;
+            }
+          // ----- Exit uncritical section ------------------------------------
+        }
+
+      // After the message was copied, the block can be released.
+      internal_release_slot_ (src);
+
+      return true;
+    }
+
 #endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
 
     /**
@@ -840,7 +1164,9 @@ namespace os
      * larger numeric value of _mprio_ shall be inserted before messages
      * with lower values of _mprio_. A message shall be inserted after
      * other messages in the queue, if any, with equal _mprio_. The
-     * value of _mprio_ shall be less than `message_queue::max_priority`.
+     * value of _mprio_ shall be less than `message_queue::max_priority`
+     * or, if `OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES` is defined,
+     * less than `message_queue::priorities`.
      *
      * If the specified message queue is full, `send()`
      * shall block
@@ -865,6 +1191,8 @@ namespace os
     result_t
     message_queue::send (const void* msg, std::size_t nbytes, priority_t mprio)
     {
+      OS_PROFILE_SCOPE("mqueue::send");
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
       trace::printf ("%s(%p,%d,%d) @%p %s\n", __func__, msg, nbytes, mprio,
                      this, name ());
@@ -877,6 +1205,10 @@ namespace os
 
       os_assert_err(msg != nullptr, EINVAL);
       os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+      os_assert_err(mprio < priorities, EINVAL);
+#endif
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
@@ -895,6 +1227,13 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.send_blocked_;
+        }
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -958,7 +1297,9 @@ namespace os
      * larger numeric value of _mprio_ shall be inserted before messages
      * with lower values of _mprio_. A message shall be inserted after
      * other messages in the queue, if any, with equal _mprio_. The
-     * value of _mprio_ shall be less than `message_queue::max_priority`.
+     * value of _mprio_ shall be less than `message_queue::max_priority`
+     * or, if `OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES` is defined,
+     * less than `message_queue::priorities`.
      *
      * If the message queue is full, the message shall
      * not be queued and `try_send()` shall return an error.
@@ -977,6 +1318,8 @@ namespace os
     message_queue::try_send (const void* msg, std::size_t nbytes,
                              priority_t mprio)
     {
+      OS_PROFILE_SCOPE("mqueue::try_send");
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
       trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msg, nbytes, mprio,
                      this, name ());
@@ -984,6 +1327,10 @@ namespace os
 
       os_assert_err(msg != nullptr, EINVAL);
       os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+      os_assert_err(mprio < priorities, EINVAL);
+#endif
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
@@ -1026,7 +1373,9 @@ namespace os
      * larger numeric value of _mprio_ shall be inserted before messages
      * with lower values of _mprio_. A message shall be inserted after
      * other messages in the queue, if any, with equal _mprio_. The
-     * value of _mprio_ shall be less than `message_queue::max_priority`.
+     * value of _mprio_ shall be less than `message_queue::max_priority`
+     * or, if `OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES` is defined,
+     * less than `message_queue::priorities`.
      *
      * If the message queue is full, the wait for sufficient
      * room in the queue shall be terminated when the specified timeout
@@ -1073,6 +1422,10 @@ namespace os
 
       os_assert_err(msg != nullptr, EINVAL);
       os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES) \
+  && !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+      os_assert_err(mprio < priorities, EINVAL);
+#endif
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
@@ -1093,6 +1446,13 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.send_blocked_;
+        }
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -1177,6 +1537,11 @@ namespace os
      * If the argument _mprio_ is not nullptr, the priority of the selected
      * message shall be stored in the location referenced by _mprio_.
      *
+     * If the argument _length_ is not nullptr, the length of the
+     * selected message shall be stored in the location referenced
+     * by _length_; this is the actual length sent when the queue
+     * was created with `mq_store_lengths`, otherwise _nbytes_.
+     *
      * If the message queue is empty, `receive()` shall block
      * until a message is enqueued on the message queue or until
      * `receive()` is cancelled/interrupted. If more than one thread
@@ -1195,7 +1560,8 @@ namespace os
      * @warning Cannot be invoked from Interrupt Service Routines.
      */
     result_t
-    message_queue::receive (void* msg, std::size_t nbytes, priority_t* mprio)
+    message_queue::receive (void* msg, std::size_t nbytes, priority_t* mprio,
+                            std::size_t* length)
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
       trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg, nbytes, this,
@@ -1212,6 +1578,12 @@ namespace os
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
+      // The port does not store the lengths.
+      if (length != nullptr)
+        {
+          *length = nbytes;
+        }
+
       return port::message_queue::receive (this, msg, nbytes, mprio);
 
 #else
@@ -1222,13 +1594,20 @@ namespace os
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
 
-          if (internal_try_receive_ (msg, nbytes, mprio))
+          if (internal_try_receive_ (msg, nbytes, mprio, length))
             {
               return result::ok;
             }
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.receive_blocked_;
+        }
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -1243,7 +1622,7 @@ namespace os
               // ----- Enter critical section ---------------------------------
               interrupts::critical_section ics;
 
-              if (internal_try_receive_ (msg, nbytes, mprio))
+              if (internal_try_receive_ (msg, nbytes, mprio, length))
                 {
                   return result::ok;
                 }
@@ -1293,6 +1672,11 @@ namespace os
      * If the argument _mprio_ is not nullptr, the priority of the selected
      * message shall be stored in the location referenced by _mprio_.
      *
+     * If the argument _length_ is not nullptr, the length of the
+     * selected message shall be stored in the location referenced
+     * by _length_; this is the actual length sent when the queue
+     * was created with `mq_store_lengths`, otherwise _nbytes_.
+     *
      * If the message queue is empty, no message shall be removed
      * from the queue, and `try_receive()` shall return an error.
      *
@@ -1308,7 +1692,7 @@ namespace os
      */
     result_t
     message_queue::try_receive (void* msg, std::size_t nbytes,
-                                priority_t* mprio)
+                                priority_t* mprio, std::size_t* length)
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
       trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg, nbytes, this,
@@ -1320,6 +1704,12 @@ namespace os
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
+      // The port does not store the lengths.
+      if (length != nullptr)
+        {
+          *length = nbytes;
+        }
+
       return port::message_queue::try_receive (this, msg, nbytes, mprio);
 
 #else
@@ -1331,7 +1721,7 @@ namespace os
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
 
-          if (internal_try_receive_ (msg, nbytes, mprio))
+          if (internal_try_receive_ (msg, nbytes, mprio, length))
             {
               return result::ok;
             }
@@ -1362,6 +1752,11 @@ namespace os
      * If the argument _mprio_ is not nullptr, the priority of the selected
      * message shall be stored in the location referenced by _mprio_.
      *
+     * If the argument _length_ is not nullptr, the length of the
+     * selected message shall be stored in the location referenced
+     * by _length_; this is the actual length sent when the queue
+     * was created with `mq_store_lengths`, otherwise _nbytes_.
+     *
      * If the message queue is empty, `timed_receive()` shall block
      * until a message is enqueued on the message queue or until
      * `timed_receive()` is cancelled/interrupted. If more than one thread
@@ -1406,7 +1801,8 @@ namespace os
      */
     result_t
     message_queue::timed_receive (void* msg, std::size_t nbytes,
-                                  clock::duration_t timeout, priority_t* mprio)
+                                  clock::duration_t timeout, priority_t* mprio,
+                                  std::size_t* length)
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
       trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msg, nbytes, timeout,
@@ -1423,6 +1819,12 @@ namespace os
 
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
+      // The port does not store the lengths.
+      if (length != nullptr)
+        {
+          *length = nbytes;
+        }
+
       return port::message_queue::timed_receive (this, msg, nbytes,
           timeout, mprio);
 
@@ -1434,13 +1836,20 @@ namespace os
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
 
-          if (internal_try_receive_ (msg, nbytes, mprio))
+          if (internal_try_receive_ (msg, nbytes, mprio, length))
             {
               return result::ok;
             }
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.receive_blocked_;
+        }
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -1462,7 +1871,7 @@ namespace os
               // ----- Enter critical section ---------------------------------
               interrupts::critical_section ics;
 
-              if (internal_try_receive_ (msg, nbytes, mprio))
+              if (internal_try_receive_ (msg, nbytes, mprio, length))
                 {
                   return result::ok;
                 }
@@ -1507,6 +1916,1104 @@ namespace os
 #endif
     }
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @cond ignore
+     */
+
+    void*
+    message_queue::internal_alloc_slot_wait_ (bool timed,
+                                              clock::duration_t timeout)
+    {
+      void* slot;
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          slot = internal_alloc_slot_ ();
+          if (slot != nullptr)
+            {
+              return slot;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.send_blocked_;
+        }
+#endif
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              slot = internal_alloc_slot_ ();
+              if (slot != nullptr)
+                {
+                  return slot;
+                }
+
+              // Add this thread to the message queue send waiting list,
+              // and, for timed waits, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (send_list_, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (send_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue send waiting list,
+          // if not already removed by a release, and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return nullptr;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return nullptr;
+            }
+        }
+
+      /* NOTREACHED */
+      return nullptr;
+    }
+
+    result_t
+    message_queue::internal_receive_ref_wait_ (void** slot, bool timed,
+                                               clock::duration_t timeout,
+                                               priority_t* mprio)
+    {
+      priority_t prio;
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          *slot = internal_take_head_ (&prio);
+          if (*slot != nullptr)
+            {
+              if (mprio != nullptr)
+                {
+                  *mprio = prio;
+                }
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.receive_blocked_;
+        }
+#endif
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              *slot = internal_take_head_ (&prio);
+              if (*slot != nullptr)
+                {
+                  if (mprio != nullptr)
+                    {
+                      *mprio = prio;
+                    }
+                  return result::ok;
+                }
+
+              // Add this thread to the message queue receive waiting list,
+              // and, for timed waits, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (receive_list_, node,
+                                                 clock_list, timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (receive_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue receive waiting list,
+          // if not already removed by a send, and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The `alloc_slot()` function takes a free slot from the queue
+     * storage and returns its address, so the message can be
+     * built in place, without an intermediate buffer. The slot has
+     * `msg_size()` bytes and is not initialised.
+     *
+     * If the queue is full, the current thread is suspended
+     * until a slot is released.
+     *
+     * The slot must later be either published with `commit()`,
+     * or returned with `release()`. Until then it counts as used,
+     * so the queue accepts one less message.
+     *
+     * Slots allocated when the queue is reset become invalid.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void*
+    message_queue::alloc_slot (void)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_throw(!scheduler::locked (), EPERM);
+
+      return internal_alloc_slot_wait_ (false, 0);
+    }
+
+    /**
+     * @details
+     * Identical to `alloc_slot()`, but, if the queue is full,
+     * return `nullptr` at once.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void*
+    message_queue::try_alloc_slot (void)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      return internal_alloc_slot_ ();
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Identical to `alloc_slot()`, but, if the queue is full,
+     * wait at most _timeout_ for a slot to be released.
+     *
+     * The timeout is measured with the clock from the message queue
+     * attributes (by default the SysTick clock).
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void*
+    message_queue::timed_alloc_slot (clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_throw(!scheduler::locked (), EPERM);
+
+      return internal_alloc_slot_wait_ (true, timeout);
+    }
+
+    /**
+     * @details
+     * The `commit()` function links a slot obtained with
+     * `alloc_slot()` to the messages list, at the position
+     * indicated by the _mprio_ argument, exactly like `send()`
+     * does after copying a message, and resumes one receiving
+     * thread, if any.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::commit (void* slot, priority_t mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, slot, mprio, this,
+                     name ());
+#endif
+
+      os_assert_err(internal_is_slot_ (slot), EINVAL);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      os_assert_err(mprio < priorities, EINVAL);
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      internal_commit_slot_ (static_cast<char*> (slot), msg_size_bytes_, mprio);
+
+      // Wake-up one thread, if any.
+      receive_list_.resume_one ();
+
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * The `receive_ref()` function removes the oldest of the highest
+     * priority messages from the queue and stores the address of
+     * its slot at the location referenced by _slot_, without
+     * copying the message.
+     *
+     * If the queue is empty, the current thread is suspended
+     * until a message is sent.
+     *
+     * The slot remains owned by the caller until it is returned
+     * with `release()`; until then the queue accepts one less message.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::receive_ref (void** slot, priority_t* mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(slot != nullptr, EINVAL);
+
+      return internal_receive_ref_wait_ (slot, false, 0, mprio);
+    }
+
+    /**
+     * @details
+     * Identical to `receive_ref()`, but, if the queue is empty,
+     * return `EWOULDBLOCK` at once.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::try_receive_ref (void** slot, priority_t* mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      os_assert_err(slot != nullptr, EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      priority_t prio;
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      *slot = internal_take_head_ (&prio);
+      if (*slot == nullptr)
+        {
+          return EWOULDBLOCK;
+        }
+
+      if (mprio != nullptr)
+        {
+          *mprio = prio;
+        }
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Identical to `receive_ref()`, but, if the queue is empty,
+     * wait at most _timeout_ for a message to be sent.
+     *
+     * The timeout is measured with the clock from the message queue
+     * attributes (by default the SysTick clock).
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::timed_receive_ref (void** slot, clock::duration_t timeout,
+                                      priority_t* mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(slot != nullptr, EINVAL);
+
+      return internal_receive_ref_wait_ (slot, true, timeout, mprio);
+    }
+
+    /**
+     * @details
+     * The `release()` function returns a slot obtained with
+     * `receive_ref()`, or obtained with `alloc_slot()` and not
+     * committed, to the free list, and resumes one sending
+     * thread, if any.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::release (void* slot)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p) @%p %s\n", __func__, slot, this, name ());
+#endif
+
+      os_assert_err(internal_is_slot_ (slot), EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      internal_release_slot_ (static_cast<char*> (slot));
+
+      // Wake-up one thread, if any.
+      send_list_.resume_one ();
+
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    std::size_t
+    message_queue::internal_try_send_n_ (const void* msgs, std::size_t count,
+                                         std::size_t nbytes, priority_t mprio)
+    {
+      const char* msg = static_cast<const char*> (msgs);
+      std::size_t n = 0;
+      while (n < count && internal_enqueue_ (msg, nbytes, mprio))
+        {
+          msg += nbytes;
+          ++n;
+        }
+
+      // Wake-up the receivers once for the whole batch; with more
+      // than one message, all of them, since each may take one.
+      if (n == 1)
+        {
+          receive_list_.resume_one ();
+        }
+      else if (n > 1)
+        {
+          receive_list_.resume_all ();
+        }
+
+      return n;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    std::size_t
+    message_queue::internal_try_receive_n_ (void* msgs, std::size_t count,
+                                            std::size_t nbytes,
+                                            priority_t* mprios)
+    {
+      char* msg = static_cast<char*> (msgs);
+      std::size_t n = 0;
+      while (n < count
+          && internal_dequeue_ (msg, nbytes,
+                                mprios != nullptr ? &mprios[n] : nullptr,
+                                nullptr))
+        {
+          msg += nbytes;
+          ++n;
+        }
+
+      // Wake-up the senders once for the whole batch.
+      if (n == 1)
+        {
+          send_list_.resume_one ();
+        }
+      else if (n > 1)
+        {
+          send_list_.resume_all ();
+        }
+
+      return n;
+    }
+
+    result_t
+    message_queue::internal_send_n_ (const void* msgs, std::size_t count,
+                                     std::size_t nbytes, std::size_t* sent,
+                                     priority_t mprio, bool timed,
+                                     clock::duration_t timeout)
+    {
+      std::size_t n;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          n = internal_try_send_n_ (msgs, count, nbytes, mprio);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (sent != nullptr)
+        {
+          *sent = n;
+        }
+
+      if (n > 0)
+        {
+          return result::ok;
+        }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.send_blocked_;
+        }
+#endif
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              n = internal_try_send_n_ (msgs, count, nbytes, mprio);
+              if (n > 0)
+                {
+                  if (sent != nullptr)
+                    {
+                      *sent = n;
+                    }
+                  return result::ok;
+                }
+
+              // Add this thread to the message queue send waiting list,
+              // and, for timed sends, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (send_list_, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (send_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue send waiting list,
+          // if not already removed by receive(), and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    result_t
+    message_queue::internal_receive_n_ (void* msgs, std::size_t count,
+                                        std::size_t nbytes,
+                                        std::size_t* received,
+                                        priority_t* mprios, bool timed,
+                                        clock::duration_t timeout)
+    {
+      std::size_t n;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          n = internal_try_receive_n_ (msgs, count, nbytes, mprios);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (received != nullptr)
+        {
+          *received = n;
+        }
+
+      if (n > 0)
+        {
+          return result::ok;
+        }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+        {
+          interrupts::critical_section ics;
+          ++statistics_.receive_blocked_;
+        }
+#endif
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              n = internal_try_receive_n_ (msgs, count, nbytes, mprios);
+              if (n > 0)
+                {
+                  if (received != nullptr)
+                    {
+                      *received = n;
+                    }
+                  return result::ok;
+                }
+
+              // Add this thread to the message queue receive waiting list,
+              // and, for timed receives, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (receive_list_, node,
+                                                 clock_list, timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (receive_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue receive waiting list,
+          // if not already removed by send(), and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The `send_n()` function adds up to _count_ messages,
+     * stored consecutively at _msgs_, each _nbytes_ long,
+     * to the queue, all with the priority _mprio_, in a single
+     * interrupts critical section, and resumes the waiting
+     * receivers once for the whole batch.
+     *
+     * If the queue is full, the current thread is suspended
+     * until at least one message can be enqueued. The call returns
+     * after as many messages as fit were enqueued, which may be less
+     * than _count_; the number is stored at the location
+     * referenced by _sent_.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::send_n (const void* msgs, std::size_t count,
+                           std::size_t nbytes, std::size_t* sent,
+                           priority_t mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p,%u,%u,%u) @%p %s\n", __func__, msgs, count, nbytes,
+                     mprio, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msgs != nullptr && count > 0, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      os_assert_err(mprio < priorities, EINVAL);
+#endif
+
+      return internal_send_n_ (msgs, count, nbytes, sent, mprio, false, 0);
+    }
+
+    /**
+     * @details
+     * Identical to `send_n()`, but, if the queue is full,
+     * return `EWOULDBLOCK` at once.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::try_send_n (const void* msgs, std::size_t count,
+                               std::size_t nbytes, std::size_t* sent,
+                               priority_t mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p,%u,%u,%u) @%p %s\n", __func__, msgs, count, nbytes,
+                     mprio, this, name ());
+#endif
+
+      os_assert_err(msgs != nullptr && count > 0, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      os_assert_err(mprio < priorities, EINVAL);
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      std::size_t n;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          n = internal_try_send_n_ (msgs, count, nbytes, mprio);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (sent != nullptr)
+        {
+          *sent = n;
+        }
+
+      if (n == 0)
+        {
+          return EWOULDBLOCK;
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * Identical to `send_n()`, but, if the queue is full,
+     * wait at most _timeout_ for space to become available.
+     *
+     * The timeout is measured with the clock from the message queue
+     * attributes (by default the SysTick clock).
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::timed_send_n (const void* msgs, std::size_t count,
+                                 std::size_t nbytes, clock::duration_t timeout,
+                                 std::size_t* sent, priority_t mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p,%u,%u,%u,%u) @%p %s\n", __func__, msgs, count,
+                     nbytes, timeout, mprio, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msgs != nullptr && count > 0, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+#if defined(OS_INTEGER_RTOS_MESSAGE_QUEUE_PRIORITIES)
+      os_assert_err(mprio < priorities, EINVAL);
+#endif
+
+      return internal_send_n_ (msgs, count, nbytes, sent, mprio, true,
+                               timeout);
+    }
+
+    /**
+     * @details
+     * The `receive_n()` function removes up to _count_ messages
+     * from the queue, in the same order as `receive()`, and stores
+     * them consecutively at _msgs_, each in a _nbytes_ element,
+     * in a single interrupts critical section; the waiting
+     * senders are resumed once for the whole batch.
+     *
+     * If the queue is empty, the current thread is suspended
+     * until at least one message arrives. The call returns with
+     * the messages available at that moment, which may be less
+     * than _count_; the number is stored at the location
+     * referenced by _received_.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::receive_n (void* msgs, std::size_t count,
+                              std::size_t nbytes, std::size_t* received,
+                              priority_t* mprios)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msgs, count, nbytes,
+                     this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msgs != nullptr && count > 0, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      return internal_receive_n_ (msgs, count, nbytes, received, mprios, false,
+                                  0);
+    }
+
+    /**
+     * @details
+     * Identical to `receive_n()`, but, if the queue is empty,
+     * return `EWOULDBLOCK` at once.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::try_receive_n (void* msgs, std::size_t count,
+                                  std::size_t nbytes, std::size_t* received,
+                                  priority_t* mprios)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msgs, count, nbytes,
+                     this, name ());
+#endif
+
+      os_assert_err(msgs != nullptr && count > 0, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      std::size_t n;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          n = internal_try_receive_n_ (msgs, count, nbytes, mprios);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (received != nullptr)
+        {
+          *received = n;
+        }
+
+      if (n == 0)
+        {
+          return EWOULDBLOCK;
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * Identical to `receive_n()`, but, if the queue is empty,
+     * wait at most _timeout_ for a message to arrive.
+     *
+     * The timeout is measured with the clock from the message queue
+     * attributes (by default the SysTick clock).
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::timed_receive_n (void* msgs, std::size_t count,
+                                    std::size_t nbytes,
+                                    clock::duration_t timeout,
+                                    std::size_t* received, priority_t* mprios)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      trace::printf ("%s(%p,%u,%u,%u) @%p %s\n", __func__, msgs, count, nbytes,
+                     timeout, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msgs != nullptr && count > 0, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      return internal_receive_n_ (msgs, count, nbytes, received, mprios, true,
+                                  timeout);
+    }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+
+    /**
+     * @details
+     * Intended for periodic reports; read the values, possibly
+     * with the scheduler locked, then clear them to start a new
+     * measurement interval.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    message_queue::statistics::clear (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      send_blocked_ = 0;
+      receive_blocked_ = 0;
+      received_ = 0;
+      latency_total_ = 0;
+      latency_max_ = 0;
+      depth_max_ = 0;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#endif
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
     /**
      * @details
      * Clear both send and receive counter and return the queue to the
@@ -485,6 +485,11 @@ namespace os
       clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
 #endif
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+      spin_count_ = attr.mx_spin_count;
+#endif
+
       os_assert_throw(attr.mx_priority_ceiling >= thread::priority::lowest,
                       EINVAL);
       os_assert_throw(attr.mx_priority_ceiling <= thread::priority::highest,
@@ -546,6 +551,20 @@ namespace os
      * @cond ignore
      */
 
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+    void
+    mutex::internal_describe_footprint_ (const void* object,
+                                         footprint::item& it)
+    {
+      const mutex* mx = static_cast<const mutex*> (object);
+
+      it.name = mx->name ();
+      it.object_bytes = sizeof(mutex);
+    }
+
+#endif
+
     void
     mutex::internal_init_ (void)
     {
@@ -568,6 +587,64 @@ namespace os
 #endif
     }
 
+    /*
+     * Internal function.
+     * Should be called from a scheduler critical section.
+     *
+     * The mutexes owned by a thread are kept ordered by decreasing
+     * boosted priority, so the highest one is always the first;
+     * (re)link this mutex at its place, after its boosted
+     * priority changed.
+     * The walk happens only when locking with contention, or
+     * when a waiter gives up; unlocking takes the top of the list.
+     */
+    void
+    mutex::internal_link_owned_ (void)
+    {
+      // Ineffective if not linked.
+      owner_links_.unlink ();
+
+      mutexes_list* th_list =
+          reinterpret_cast<mutexes_list*> (&owner_->mutexes_);
+
+      for (auto&& mx : *th_list)
+        {
+          if (mx.boosted_prio_ < boosted_prio_)
+            {
+              // Insert before the first mutex with a lower priority.
+              utils::static_double_list_links* before = &mx.owner_links_;
+              utils::static_double_list_links* after = before->prev ();
+
+              owner_links_.prev (after);
+              owner_links_.next (before);
+
+              // The order is important.
+              before->prev (&owner_links_);
+              after->next (&owner_links_);
+              return;
+            }
+        }
+
+      // Lowest priority, add to the end of the list.
+      th_list->link (*this);
+    }
+
+    /*
+     * Internal function.
+     * Should be called from a scheduler critical section.
+     */
+    thread::priority_t
+    mutex::internal_owned_max_prio_ (thread* th)
+    {
+      mutexes_list* th_list = reinterpret_cast<mutexes_list*> (&th->mutexes_);
+      if (th_list->empty ())
+        {
+          return thread::priority::none;
+        }
+
+      return (*th_list->begin ()).boosted_prio_;
+    }
+
     /*
      * Internal function.
      * Should be called from a scheduler critical section.
@@ -581,27 +658,10 @@ namespace os
       // First lock.
       if (owner_ == nullptr)
         {
-          // If the mutex has no owner, own it.
-          owner_ = th;
-
-          // For recursive mutexes, initialise counter.
-          count_ = 1;
-
-          // Add mutex to the thread list.
-          mutexes_list* th_list =
-              reinterpret_cast<mutexes_list*> (&owner_->mutexes_);
-          th_list->link (*this);
-
-          // Count the number of mutexes acquired by the thread.
-          ++(owner_->acquired_mutexes_);
-
           if (protocol_ == protocol::protect)
             {
               if (th->priority () > prio_ceiling_)
                 {
-                  // No need to keep the lock.
-                  owner_ = nullptr;
-
                   // Prio ceiling must be at least the priority of the
                   // highest priority thread.
                   return EINVAL;
@@ -614,10 +674,47 @@ namespace os
               // owned by this thread and initialised with this
               // attribute, regardless of whether other threads are
               // blocked on any of these robust mutexes or not.
-
-              // Boost priority.
               boosted_prio_ = prio_ceiling_;
-              if (boosted_prio_ > owner_->priority_inherited ())
+            }
+          else if (protocol_ == protocol::inherit && !list_.empty ())
+            {
+              // Other threads are still waiting; the new owner
+              // inherits the priority of the highest, which is
+              // the first in the ordered list.
+              boosted_prio_ = list_.head ()->thread_->priority ();
+            }
+          else
+            {
+              boosted_prio_ = thread::priority::none;
+            }
+
+          // If the mutex has no owner, own it.
+          owner_ = th;
+
+          // For recursive mutexes, initialise counter.
+          count_ = 1;
+
+          // Add mutex to the thread list.
+          internal_link_owned_ ();
+
+          // Count the number of mutexes acquired by the thread.
+          ++(owner_->acquired_mutexes_);
+
+          // Boost priority.
+          if (boosted_prio_ > owner_->priority_inherited ())
+            {
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+              if (protocol_ == protocol::protect
+                  && owner_->state_ == thread::state::running)
+                {
+                  // Immediate ceiling: the running thread is not in the
+                  // ready list and raising its priority cannot cause a
+                  // preemption, so a single store is enough, no relink
+                  // and no reschedule; unlock restores it.
+                  owner_->prio_inherited_ = boosted_prio_;
+                }
+              else
+#endif
                 {
                   // ----- Enter uncritical section ---------------------------
                   scheduler::uncritical_section sucs;
@@ -627,6 +724,10 @@ namespace os
                 }
             }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+          sync_statistics_.internal_mark_acquired_ ();
+#endif
+
 #if defined(OS_TRACE_RTOS_MUTEX)
           trace::printf ("%s() @%p %s by %p %s LCK\n", __func__, this, name (),
                          th, th->name ());
@@ -706,13 +807,15 @@ namespace os
           if (protocol_ == protocol::inherit)
             {
               thread::priority_t prio = th->priority ();
-              boosted_prio_ = prio;
-
-              if (owner_links_.unlinked ())
+              if (prio > boosted_prio_ || owner_links_.unlinked ())
                 {
-                  mutexes_list* th_list =
-                      reinterpret_cast<mutexes_list*> (&owner_->mutexes_);
-                  th_list->link (*this);
+                  // The cached priority only grows while waiters are
+                  // added; keep the owner list ordered.
+                  if (prio > boosted_prio_)
+                    {
+                      boosted_prio_ = prio;
+                    }
+                  internal_link_owned_ ();
                 }
 
               // Boost owner priority.
@@ -738,6 +841,112 @@ namespace os
       return EWOULDBLOCK;
     }
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_FAST_PATH) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+
+    /*
+     * Internal function.
+     * Must be called without any critical section.
+     *
+     * Only plain mutexes (not recursive, no protocol, not robust)
+     * are eligible; for them the owner list of the thread is not
+     * used (no boosted priority, no owner dead processing), so
+     * the mutex need not be linked to it.
+     *
+     * On single core devices, the exclusive monitor is cleared
+     * on exception entry, so the compare and swap fails if the
+     * thread is preempted in the middle; the slow path, which
+     * modifies the owner only in a scheduler critical section,
+     * cannot interleave with it.
+     */
+    bool
+    mutex::internal_try_lock_fast_ (thread* th)
+    {
+      if (type_ == type::recursive || protocol_ != protocol::none
+          || robustness_ != robustness::stalled)
+        {
+          return false;
+        }
+
+      thread* expected = nullptr;
+      if (!__atomic_compare_exchange_n (&owner_, &expected, th, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+          // Contention, or a relock by the same thread.
+          return false;
+        }
+
+      count_ = 1;
+
+      // Count the number of mutexes acquired by the thread;
+      // only the owner modifies this counter.
+      ++(th->acquired_mutexes_);
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      sync_statistics_.internal_mark_acquired_ ();
+#endif
+
+#if defined(OS_TRACE_RTOS_MUTEX)
+      trace::printf ("%s() @%p %s by %p %s LCK\n", __func__, this, name (),
+                     th, th->name ());
+#endif
+      return true;
+    }
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN) \
+  && !defined(OS_USE_RTOS_PORT_MUTEX)
+
+    /*
+     * Internal function.
+     * Must be called without any critical section.
+     *
+     * Spinning makes sense only while the owner is running, on
+     * another core, and is expected to release the mutex soon;
+     * if the owner is not running (on single core devices this is
+     * always the case), give up at once and block.
+     */
+    result_t
+    mutex::internal_spin_lock_ (thread* th)
+    {
+      if (spin_count_ == 0)
+        {
+          return EWOULDBLOCK;
+        }
+
+      for (uint32_t i = 0; i < spin_count_; ++i)
+        {
+          thread* owner = owner_;
+          if (owner == nullptr)
+            {
+              // ----- Enter critical section ---------------------------------
+              scheduler::critical_section scs;
+
+              result_t res = internal_try_lock_ (th);
+              if (res != EWOULDBLOCK)
+                {
+                  if (res == result::ok)
+                    {
+                      ++spin_successes_;
+                    }
+                  return res;
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+          else if (owner->state () != thread::state::running)
+            {
+              break;
+            }
+        }
+
+      ++spin_failures_;
+
+      return EWOULDBLOCK;
+    }
+
+#endif
+
     result_t
     mutex::internal_unlock_ (thread* th)
     {
@@ -771,37 +980,25 @@ namespace os
 
               if (boosted_prio_ != thread::priority::none)
                 {
-                  mutexes_list* thread_mutexes =
-                      reinterpret_cast<mutexes_list*> (&owner_->mutexes_);
+                  // If the owner thread has no more mutexes,
+                  // clear the inherited priority, and the assigned
+                  // priority will take precedence; otherwise the
+                  // maximum boosted priority is that of the first
+                  // mutex in the ordered list, no need to scan.
+                  boosted_prio_ = thread::priority::none;
 
-                  if (thread_mutexes->empty ())
-                    {
-                      // If the owner thread has no more mutexes,
-                      // clear the inherited priority,
-                      // and the assigned priority will take precedence.
-                      boosted_prio_ = thread::priority::none;
-                    }
-                  else
-                    {
-                      // If the owner thread acquired other mutexes too,
-                      // compute the maximum boosted priority.
-                      thread::priority_t max_prio = 0;
-                      for (auto&& mx : *thread_mutexes)
-                        {
-                          if (mx.boosted_prio_ > max_prio)
-                            {
-                              max_prio = mx.boosted_prio_;
-                            }
-                        }
-                      boosted_prio_ = max_prio;
-                    }
                   // Delayed until end of critical section.
-                  owner_->priority_inherited (boosted_prio_);
+                  owner_->priority_inherited (
+                      internal_owned_max_prio_ (owner_));
                 }
 
               // Delayed until end of critical section.
               list_.resume_one ();
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+              sync_statistics_.internal_mark_released_ ();
+#endif
+
               // Finally release the mutex.
               owner_ = nullptr;
               count_ = 0;
@@ -940,6 +1137,15 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_FAST_PATH)
+
+      if (internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+
+#endif
+
       result_t res;
         {
           // ----- Enter critical section -------------------------------------
@@ -953,6 +1159,26 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
+
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN)
+
+      // The owner may run on another core and release the mutex soon;
+      // spinning is cheaper than two context switches.
+      res = internal_spin_lock_ (&crt_thread);
+      if (res != EWOULDBLOCK)
+        {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+          sync_statistics_.internal_mark_waited_ (wait_begin);
+#endif
+          return res;
+        }
+
+#endif
+
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
@@ -968,6 +1194,9 @@ namespace os
               res = internal_try_lock_ (&crt_thread);
               if (res != EWOULDBLOCK)
                 {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+                  sync_statistics_.internal_mark_waited_ (wait_begin);
+#endif
                   return res;
                 }
 
@@ -1059,6 +1288,15 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_FAST_PATH)
+
+      if (internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+
+#endif
+
         {
           // ----- Enter critical section -------------------------------------
           scheduler::critical_section scs;
@@ -1138,6 +1376,15 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+#if defined(OS_INCLUDE_RTOS_MUTEX_FAST_PATH)
+
+      if (internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+
+#endif
+
       result_t res;
 
       // Extra test before entering the loop, with its inherent weight.
@@ -1154,6 +1401,26 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
+
+#if defined(OS_INCLUDE_RTOS_MUTEX_SPIN)
+
+      // The owner may run on another core and release the mutex soon;
+      // spinning is cheaper than two context switches.
+      res = internal_spin_lock_ (&crt_thread);
+      if (res != EWOULDBLOCK)
+        {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+          sync_statistics_.internal_mark_waited_ (wait_begin);
+#endif
+          return res;
+        }
+
+#endif
+
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
@@ -1176,6 +1443,9 @@ namespace os
               res = internal_try_lock_ (&crt_thread);
               if (res != EWOULDBLOCK)
                 {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+                  sync_statistics_.internal_mark_waited_ (wait_begin);
+#endif
                   return res;
                 }
 
@@ -1219,27 +1489,30 @@ namespace os
             }
           if (res != result::ok)
             {
-              if (boosted_prio_ != thread::priority::none)
+              if (protocol_ == protocol::inherit)
                 {
-                  // If the priority was boosted, it must be restored
-                  // to the highest priority of the waiting threads, if any.
-
-                  thread::priority_t max_prio = thread::priority::none;
+                  // ----- Enter critical section -----------------------------
+                  scheduler::critical_section scs;
 
-                  for (auto&& th : list_)
+                  // If the priority was boosted by this thread, it must be
+                  // restored to the highest priority of the remaining
+                  // waiting threads, which is the first in the list.
+                  thread::priority_t prio = thread::priority::none;
+                  if (!list_.empty ())
                     {
-                      thread::priority_t prio = th.priority ();
-                      if (prio > max_prio)
-                        {
-                          max_prio = prio;
-                        }
+                      prio = list_.head ()->thread_->priority ();
                     }
 
-                  if (max_prio != thread::priority::none)
+                  if (owner_ != nullptr && prio < boosted_prio_)
                     {
-                      boosted_prio_ = max_prio;
-                      owner_->priority (boosted_prio_);
+                      boosted_prio_ = prio;
+                      internal_link_owned_ ();
+
+                      // Delayed until end of critical section.
+                      owner_->priority_inherited (
+                          internal_owned_max_prio_ (owner_));
                     }
+                  // ----- Exit critical section ------------------------------
                 }
               return res;
             }
@@ -0,0 +1,284 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES)
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace power
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        // Only `sleep` is enabled by default, with no latency.
+        // All in the BSS, usable before the static constructors.
+        state_parameters parameters[state::count];
+        bool enabled[state::count];
+      } /* namespace */
+
+      latency_request::requests_list latency_request::requests__;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @details
+       * The state parameters are usually taken from the device data
+       * sheet; the exit latency should include the time to restore
+       * the clocks.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      enable_state (state_t st, const state_parameters& params)
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        if (st >= state::count)
+          {
+            return EINVAL;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        parameters[st] = params;
+        enabled[st] = true;
+
+        return result::ok;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * The `sleep` state is always enabled.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      disable_state (state_t st)
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        if (st == state::sleep || st >= state::count)
+          {
+            return EINVAL;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        enabled[st] = false;
+
+        return result::ok;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * The strictest constraint is the shortest latency of all
+       * existing `latency_request` objects.
+       */
+      latency_t
+      latency_constraint (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        latency_t latency_us = no_constraint;
+        for (auto&& req : latency_request::requests__)
+          {
+            if (req.latency_us_ < latency_us)
+              {
+                latency_us = req.latency_us_;
+              }
+          }
+        return latency_us;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * This is the default policy, used by the weak
+       * `os_rtos_idle_select_power_state_hook()`.
+       */
+      state_t
+      select_state (uint64_t idle_us, latency_t latency_us)
+      {
+        for (state_t st = state::count - 1; st > state::sleep; --st)
+          {
+            if (enabled[st] && parameters[st].exit_latency_us <= latency_us
+                && parameters[st].min_residency_us <= idle_us)
+              {
+                return st;
+              }
+          }
+        return state::sleep;
+      }
+
+      // ======================================================================
+
+      /**
+       * @details
+       * The request is effective immediately; if the idle thread is
+       * already in a deeper state, it is not woken up.
+       */
+      latency_request::latency_request (latency_t latency_us) :
+          latency_us_ (latency_us)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        requests__.link (*this);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      latency_request::~latency_request ()
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        links_.unlink ();
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      latency_request::update (latency_t latency_us)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        latency_us_ = latency_us;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      // ======================================================================
+
+      namespace statistics
+      {
+        /**
+         * @cond ignore
+         */
+
+        rtos::statistics::counter_t entries_[state::count];
+        rtos::statistics::duration_t residency_[state::count];
+
+        void
+        internal_record_ (state_t st, rtos::statistics::duration_t cycles)
+        {
+          ++entries_[st];
+          residency_[st] += cycles;
+        }
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @details
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        void
+        clear (void)
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          for (std::size_t i = 0; i < state::count; ++i)
+            {
+              entries_[i] = 0;
+              residency_[i] = 0;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      } /* namespace statistics */
+
+    // ------------------------------------------------------------------------
+
+    } /* namespace power */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @details
+ * The hook implements the idle policy; the default one selects
+ * the deepest enabled state compatible with the idle time and
+ * the latency constraint.
+ *
+ * It is called by the idle thread in a critical section.
+ */
+uint8_t
+__attribute__((weak))
+os_rtos_idle_select_power_state_hook (uint64_t idle_us, uint32_t latency_us)
+{
+  return os::rtos::power::select_state (idle_us, latency_us);
+}
+
+/**
+ * @details
+ * It is called by the idle thread in a critical section, with the
+ * state selected by `os_rtos_idle_select_power_state_hook()` and
+ * the number of ticks up to the earliest clock timestamp.
+ * The implementation must program a wake-up after at most `ticks`
+ * ticks, enter the state (in such a way that pending interrupts
+ * still wake up the device), and, when back, restore the clocks
+ * and restart the SysTick aligned to the tick boundary.
+ *
+ * As for the tickless sleep, the number of complete ticks elapsed
+ * in the state must be returned via `slept_ticks`.
+ *
+ * The default implementation does nothing and returns `false`,
+ * which makes the idle thread use the `sleep` state.
+ */
+bool
+__attribute__((weak))
+os_rtos_idle_enter_power_state_hook (uint8_t state __attribute__((unused)),
+                                     uint32_t ticks __attribute__((unused)),
+                                     uint32_t* slept_ticks __attribute__((unused)))
+{
+  return false;
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES) */
+
+// ----------------------------------------------------------------------------
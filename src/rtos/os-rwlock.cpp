@@ -0,0 +1,592 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class rwlock::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts) to the read-write lock.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     *
+     * @par POSIX compatibility
+     *  Inspired by `pthread_rwlockattr_t`
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const rwlock::attributes rwlock::initializer;
+
+    constexpr rwlock::count_t rwlock::max_count;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class rwlock
+     * @details
+     * A read-write lock allows concurrent read access to a shared
+     * object, while write access is exclusive.
+     *
+     * Multiple threads can own the lock for reading at the same time,
+     * but only one thread can own it for writing, and only when
+     * there are no readers.
+     *
+     * Writers are preferred: while a writer waits, new readers are
+     * blocked, so a steady flow of readers cannot starve the writers.
+     * As a consequence, a thread which already owns the lock for
+     * reading must not try to acquire it again for reading, since
+     * it may deadlock if a writer is waiting in the meantime.
+     *
+     * Waiting readers and writers are kept in separate lists, ordered
+     * by priority. When a writer releases the lock, one waiting writer
+     * is resumed, or, if there are none, all waiting readers.
+     *
+     * @par POSIX compatibility
+     *  Inspired by `pthread_rwlock_t`
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a named read-write lock object
+     * with attributes referenced by _attr_.
+     * If the attributes specified by _attr_ are modified later,
+     * the lock attributes shall not be affected.
+     *
+     * Only the lock object itself may be used for performing
+     * synchronisation. It is not allowed to make copies of
+     * read-write lock objects.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_init()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_init.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    rwlock::rwlock (const char* name, const attributes& attr) :
+        object_named_system
+          { name }
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+    }
+
+    /**
+     * @details
+     * This destructor shall destroy the read-write lock object.
+     *
+     * It is safe to destroy an unlocked read-write lock upon which
+     * no threads are currently blocked. The effect of destroying
+     * a lock which is owned or upon which other threads are
+     * currently blocked is undefined.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_destroy()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_destroy.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    rwlock::~rwlock ()
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // There must be no threads waiting for this lock.
+      assert(readers_list_.empty ());
+      assert(writers_list_.empty ());
+
+      // The lock must not be owned.
+      assert(writer_ == nullptr);
+      assert(readers_ == 0);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    rwlock::internal_try_read_lock_ (void)
+    {
+      // Writers are preferred; do not enter while they wait.
+      if (writer_ == nullptr && writers_list_.empty ()
+          && readers_ < max_count)
+        {
+          ++readers_;
+#if defined(OS_TRACE_RTOS_RWLOCK)
+          trace::printf ("%s() @%p %s >%u\n", __func__, this, name (),
+                         readers_);
+#endif
+          return true;
+        }
+
+      return false;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    rwlock::internal_try_write_lock_ (thread* th)
+    {
+      if (writer_ == nullptr && readers_ == 0)
+        {
+          writer_ = th;
+#if defined(OS_TRACE_RTOS_RWLOCK)
+          trace::printf ("%s() @%p %s by %p %s\n", __func__, this, name (),
+                         th, th->name ());
+#endif
+          return true;
+        }
+
+      return false;
+    }
+
+    result_t
+    rwlock::internal_lock_ (bool write, bool timed, clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      thread& crt_thread = this_thread::thread ();
+
+      internal::waiting_threads_list& list =
+          write ? writers_list_ : readers_list_;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (writer_ == &crt_thread)
+            {
+              return EDEADLK;
+            }
+
+          if (write ?
+              internal_try_write_lock_ (&crt_thread) :
+              internal_try_read_lock_ ())
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (write ?
+                  internal_try_write_lock_ (&crt_thread) :
+                  internal_try_read_lock_ ())
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the lock waiting list, and,
+              // for timed locks, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (list, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (list, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the lock waiting list,
+          // if not already removed by unlock() and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          result_t res = result::ok;
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              res = EINTR;
+            }
+          else if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              res = ETIMEDOUT;
+            }
+
+          if (res != result::ok)
+            {
+              if (write)
+                {
+                  // Readers blocked only by this waiting writer
+                  // may proceed now.
+                  readers_list_.resume_all ();
+                }
+              return res;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The calling thread acquires the read lock if a writer does
+     * not hold the lock and there are no writers blocked on the lock.
+     * Otherwise the calling thread shall block until it can
+     * acquire the lock.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_rdlock()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_rdlock.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::read_lock (void)
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      return internal_lock_ (false, false, 0);
+    }
+
+    /**
+     * @details
+     * Apply a read lock as in `read_lock()`, with the exception
+     * that the function shall fail if the equivalent `read_lock()`
+     * call would have blocked the calling thread.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_tryrdlock()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_tryrdlock.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *  <br>Differences from the standard:
+     *  - for consistency reasons, EWOULDBLOCK is used, instead of EBUSY
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::try_read_lock (void)
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_read_lock_ ())
+            {
+              return result::ok;
+            }
+
+          if (readers_ >= max_count)
+            {
+              return EAGAIN;
+            }
+
+          return EWOULDBLOCK;
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    /**
+     * @details
+     * Apply a read lock as in `read_lock()`, except that if the
+     * lock cannot be acquired without waiting for the writers,
+     * the wait shall be terminated when the specified timeout expires.
+     *
+     * The clock used for timeouts can be specified via the `clock`
+     * attribute. By default, the clock derived from the scheduler
+     * timer is used, and the durations are expressed in ticks.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_timedrdlock()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_timedrdlock.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *  <br>Differences from the standard:
+     *  - the timeout is not expressed as an absolute time point, but
+     * as a relative number of timer ticks (by default, the SysTick
+     * clock for CMSIS).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::timed_read_lock (clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_lock_ (false, true, timeout);
+    }
+
+    /**
+     * @details
+     * The calling thread acquires the write lock if no thread
+     * (reader or writer) holds the lock. Otherwise the calling
+     * thread shall block until it can acquire the lock.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_wrlock()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_wrlock.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::write_lock (void)
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      return internal_lock_ (true, false, 0);
+    }
+
+    /**
+     * @details
+     * Apply a write lock as in `write_lock()`, with the exception
+     * that the function shall fail if any thread currently holds
+     * the lock (for reading or writing).
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_trywrlock()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_trywrlock.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *  <br>Differences from the standard:
+     *  - for consistency reasons, EWOULDBLOCK is used, instead of EBUSY
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::try_write_lock (void)
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      thread& crt_thread = this_thread::thread ();
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_write_lock_ (&crt_thread))
+            {
+              return result::ok;
+            }
+
+          return EWOULDBLOCK;
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    /**
+     * @details
+     * Apply a write lock as in `write_lock()`, except that if the
+     * lock cannot be acquired without waiting for other threads to
+     * unlock it, the wait shall be terminated when the specified
+     * timeout expires.
+     *
+     * The clock used for timeouts can be specified via the `clock`
+     * attribute. By default, the clock derived from the scheduler
+     * timer is used, and the durations are expressed in ticks.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_timedwrlock()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_timedwrlock.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *  <br>Differences from the standard:
+     *  - the timeout is not expressed as an absolute time point, but
+     * as a relative number of timer ticks (by default, the SysTick
+     * clock for CMSIS).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::timed_write_lock (clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_lock_ (true, true, timeout);
+    }
+
+    /**
+     * @details
+     * Release a lock held by the calling thread,
+     * either for reading or for writing.
+     *
+     * When the last reader releases the lock, one waiting writer,
+     * if any, is resumed. When the writer releases the lock, one
+     * waiting writer is resumed or, if there are none, all
+     * waiting readers are resumed.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_unlock()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_rwlock_unlock.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::unlock (void)
+    {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      thread& crt_thread = this_thread::thread ();
+
+      bool was_writer;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (writer_ == &crt_thread)
+            {
+              writer_ = nullptr;
+              was_writer = true;
+            }
+          else if (writer_ == nullptr && readers_ > 0)
+            {
+              --readers_;
+              if (readers_ > 0)
+                {
+                  // Other readers still own the lock.
+                  return result::ok;
+                }
+              was_writer = false;
+            }
+          else
+            {
+#if defined(OS_TRACE_RTOS_RWLOCK)
+              trace::printf ("%s() EPERM @%p %s\n", __func__, this, name ());
+#endif
+              return EPERM;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Wake-up one writer; if none and the lock was released
+      // by a writer, wake-up all readers.
+      if (!writers_list_.resume_one () && was_writer)
+        {
+          readers_list_.resume_all ();
+        }
+
+      return result::ok;
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
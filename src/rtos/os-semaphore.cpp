@@ -269,6 +269,9 @@ namespace os
       if (count_ > 0)
         {
           --count_;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+          sync_statistics_.internal_mark_acquired_ ();
+#endif
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
           trace::printf ("%s() @%p %s >%u\n", __func__, this, name (), count_);
 #endif
@@ -323,7 +326,7 @@ namespace os
      *
      * @warning Applications using these functions may be subject to priority inversion.
      */
-    result_t
+    result_t OS_ATTRIBUTE_HOT_PATH
     semaphore::post (void)
     {
 
@@ -340,6 +343,46 @@ namespace os
       // Don't call this from high priority interrupts.
       assert(port::interrupts::is_priority_valid ());
 
+#if defined(OS_INCLUDE_RTOS_SEMAPHORE_FAST_PATH)
+
+      // Increment the count atomically; this is safe against waiters,
+      // which check the count and link to the list in the same
+      // interrupts critical section, thus either they see the new
+      // count, or the list is already not empty below.
+      count_t count = __atomic_load_n (&count_, __ATOMIC_RELAXED);
+      do
+        {
+          if (count >= this->max_value_)
+            {
+#if defined(OS_TRACE_RTOS_SEMAPHORE)
+              trace::printf ("%s() @%p %s EAGAIN\n", __func__, this, name ());
+#endif
+              return EAGAIN;
+            }
+        }
+      while (!__atomic_compare_exchange_n (&count_, &count,
+                                           static_cast<count_t> (count + 1),
+                                           true, __ATOMIC_SEQ_CST,
+                                           __ATOMIC_RELAXED));
+
+#if defined(OS_TRACE_RTOS_SEMAPHORE)
+      trace::printf ("%s() @%p %s count %u\n", __func__, this, name (),
+                     count + 1);
+#endif
+
+      // Enter the critical section only if there are waiting threads;
+      // the count may already be above one, if the previously resumed
+      // threads did not run yet, so do not check for the zero crossing.
+      if (!list_.empty ())
+        {
+          // Wake-up one thread.
+          list_.resume_one ();
+        }
+
+      return result::ok;
+
+#else
+
         {
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
@@ -365,6 +408,8 @@ namespace os
 
       return result::ok;
 
+#endif /* defined(OS_INCLUDE_RTOS_SEMAPHORE_FAST_PATH) */
+
 #endif
     }
 
@@ -427,6 +472,11 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -443,6 +493,9 @@ namespace os
 
               if (internal_try_wait_ ())
                 {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+                  sync_statistics_.internal_mark_waited_ (wait_begin);
+#endif
                   return result::ok;
                 }
 
@@ -596,6 +649,11 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+      port::clock::timestamp_t wait_begin =
+          sync_statistics_.internal_mark_contended_ ();
+#endif
+
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -619,6 +677,9 @@ namespace os
 
               if (internal_try_wait_ ())
                 {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+                  sync_statistics_.internal_mark_waited_ (wait_begin);
+#endif
                   return result::ok;
                 }
 
@@ -0,0 +1,453 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/utils/copy.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_SNAPSHOT)
+
+/**
+ * @cond ignore
+ */
+
+extern os::rtos::thread* os_idle_thread;
+
+/**
+ * @endcond
+ */
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class snapshot::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts) to the snapshot.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const snapshot::attributes snapshot::initializer;
+
+    constexpr snapshot::index_t snapshot::max_versions;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class snapshot
+     * @details
+     * A snapshot shares a read-mostly value, like a routing table
+     * or a configuration, between many reader threads, without the
+     * readers taking a mutex to copy it.
+     *
+     * The value is kept in a few versions; `read()` returns the
+     * current one with a single load, and the reader uses it in
+     * place. `update()` copies the new value into a free version and
+     * publishes it; the replaced version is retired, and reused
+     * only after a grace period.
+     *
+     * The readers do not block while using a version, so a grace
+     * period ends when all threads were blocked at the same time,
+     * which is when the idle thread runs; this is tracked with the
+     * context switches of the idle thread, and costs nothing on the
+     * read side. The versions replaced before the scheduler starts
+     * are reclaimed at once.
+     *
+     * When all versions are in use, the writers sleep one tick at
+     * a time, which lets the system reach the idle thread, until
+     * a version is reclaimed. A system that never idles never
+     * completes a grace period, so the high priority writers should
+     * use `try_update()` or `timed_update()`.
+     *
+     * Concurrent writers do not wait for each other; the last
+     * published value wins.
+     *
+     * Usually the storage is provided by the `snapshot_inclusive<T, N>`
+     * template.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * snapshot_inclusive<my_routes_t, 3> routes { "routes", initial_routes };
+     *
+     * void
+     * forward (packet& pkt)
+     * {
+     *   const my_routes_t* r = routes.read ();
+     *   // Use r, without blocking.
+     * }
+     *
+     * void
+     * reconfigure (const my_routes_t& new_routes)
+     * {
+     *   routes.update (new_routes);
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified, but inspired
+     *  by the Linux read-copy-update (RCU).
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a named snapshot object
+     * with _versions_ values of _value_size_bytes_ each, at _storage_,
+     * the first one a copy of _initial_, and attributes
+     * referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    snapshot::snapshot (const char* name, void* storage,
+                        rtos::statistics::counter_t* marks,
+                        std::size_t value_size_bytes, std::size_t versions,
+                        const void* initial, const attributes& attr) :
+        object_named_system
+          { name }, //
+        arena_ (static_cast<char*> (storage)), //
+        marks_ (marks), //
+        value_size_bytes_ (value_size_bytes), //
+        versions_ (static_cast<index_t> (versions))
+    {
+#if defined(OS_TRACE_RTOS_SNAPSHOT)
+      trace::printf ("%s() @%p %s %u %u\n", __func__, this, this->name (),
+                     static_cast<unsigned int> (versions),
+                     static_cast<unsigned int> (value_size_bytes));
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      os_assert_throw(storage != nullptr, EINVAL);
+      os_assert_throw(marks != nullptr, EINVAL);
+      os_assert_throw(value_size_bytes > 0, EINVAL);
+      os_assert_throw(versions >= 2 && versions <= max_versions, EINVAL);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+
+      if (initial != nullptr)
+        {
+          utils::copy_bytes (arena_, initial, value_size_bytes);
+        }
+
+      // The first version is the current one, the others are free.
+      free_ = static_cast<uint32_t> ((1ull << versions) - 2);
+      current_ = arena_;
+    }
+
+    /**
+     * @details
+     * It is safe to destroy a snapshot when no threads use it;
+     * the retired versions need no reclaiming.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    snapshot::~snapshot ()
+    {
+#if defined(OS_TRACE_RTOS_SNAPSHOT)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     * Increments when the idle thread is switched in, which happens
+     * only when all other threads are blocked.
+     */
+    rtos::statistics::counter_t
+    snapshot::internal_quiescent_count_ (void)
+    {
+      return os_idle_thread->statistics ().context_switches ();
+    }
+
+    /**
+     * @details
+     * Called in a scheduler critical section.
+     */
+    void
+    snapshot::internal_reclaim_ (void)
+    {
+      if (retired_ == 0)
+        {
+          return;
+        }
+
+      if (!scheduler::started () || os_idle_thread == nullptr)
+        {
+          // No thread ran, so no reader can use the versions.
+          free_ |= retired_;
+          retired_ = 0;
+          return;
+        }
+
+      rtos::statistics::counter_t now = internal_quiescent_count_ ();
+      for (index_t i = 0; i < versions_; ++i)
+        {
+          uint32_t bit = 1u << i;
+          if ((retired_ & bit) != 0 && marks_[i] != now)
+            {
+              // The idle thread ran since this version was replaced.
+              retired_ &= ~bit;
+              free_ |= bit;
+            }
+        }
+    }
+
+    bool
+    snapshot::internal_try_update_ (const void* value, std::size_t nbytes)
+    {
+      index_t slot;
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          internal_reclaim_ ();
+          if (free_ == 0)
+            {
+              return false;
+            }
+
+          // Reserve the version.
+          slot = static_cast<index_t> (__builtin_ctz (free_));
+          free_ &= ~(1u << slot);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Not yet visible to the readers, copy without locks.
+      char* p = arena_ + slot * value_size_bytes_;
+      utils::copy_bytes (p, value, nbytes);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          index_t old = current_index_;
+          marks_[old] =
+              scheduler::started () && os_idle_thread != nullptr ?
+                  internal_quiescent_count_ () : 0;
+          retired_ |= (1u << old);
+
+          current_index_ = slot;
+          // The copy must be complete before the readers see it.
+          __atomic_store_n (&current_, static_cast<const void*> (p),
+                            __ATOMIC_RELEASE);
+          ++version_;
+
+          internal_reclaim_ ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return true;
+    }
+
+    result_t
+    snapshot::internal_update_ (const void* value, std::size_t nbytes,
+                                bool timed, clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(value != nullptr, EINVAL);
+      os_assert_err(nbytes <= value_size_bytes_, EINVAL);
+
+      clock::timestamp_t begin = clock_->steady_now ();
+      for (;;)
+        {
+          if (internal_try_update_ (value, nbytes))
+            {
+              return result::ok;
+            }
+
+          if (timed
+              && static_cast<clock::duration_t> (clock_->steady_now ()
+                  - begin) >= timeout)
+            {
+#if defined(OS_TRACE_RTOS_SNAPSHOT)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+
+          // Let the readers reach a quiescent state.
+          if (clock_->sleep_for (1) == EINTR)
+            {
+              return EINTR;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Copy _nbytes_ from _value_ into a free version and make it
+     * the current one; the replaced version is reused after a grace
+     * period. If all versions are in use, the current thread sleeps,
+     * one tick at a time, until one is reclaimed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    snapshot::update (const void* value, std::size_t nbytes)
+    {
+#if defined(OS_TRACE_RTOS_SNAPSHOT)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, value,
+                     static_cast<unsigned int> (nbytes), this, name ());
+#endif
+
+      return internal_update_ (value, nbytes, false, 0);
+    }
+
+    /**
+     * @details
+     * Identical to `update()`, but, if all versions are in use,
+     * return `EWOULDBLOCK`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    snapshot::try_update (const void* value, std::size_t nbytes)
+    {
+#if defined(OS_TRACE_RTOS_SNAPSHOT)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, value,
+                     static_cast<unsigned int> (nbytes), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      os_assert_err(value != nullptr, EINVAL);
+      os_assert_err(nbytes <= value_size_bytes_, EINVAL);
+
+      if (internal_try_update_ (value, nbytes))
+        {
+          return result::ok;
+        }
+      return EWOULDBLOCK;
+    }
+
+    /**
+     * @details
+     * Identical to `update()`, but wait for a free version at most
+     * _timeout_ ticks of the snapshot clock.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    snapshot::timed_update (const void* value, std::size_t nbytes,
+                            clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_SNAPSHOT)
+      trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, value,
+                     static_cast<unsigned int> (nbytes),
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_update_ (value, nbytes, true, timeout);
+    }
+
+    /**
+     * @details
+     * Wait for the grace periods of all retired versions, for
+     * example before changing data referred by the old values.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    snapshot::synchronize (void)
+    {
+#if defined(OS_TRACE_RTOS_SNAPSHOT)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              scheduler::critical_section scs;
+
+              internal_reclaim_ ();
+              if (retired_ == 0)
+                {
+                  return result::ok;
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          // Let the readers reach a quiescent state.
+          if (clock_->sleep_for (1) == EINTR)
+            {
+              return EINTR;
+            }
+        }
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    snapshot::retired (void) const
+    {
+      return static_cast<std::size_t> (__builtin_popcount (retired_));
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_SNAPSHOT) */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,503 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace srp
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class task
+       * @details
+       * Tasks are functions called by a dispatcher, on the
+       * dispatcher thread stack, like in RTIC or in the QP
+       * QK kernel; a task runs to completion, and can be preempted
+       * only by tasks with a higher priority, as nested calls on
+       * the same stack, so the stack must be large enough for the
+       * deepest task of each priority level, not for each task.
+       *
+       * The tasks must not block; to exchange data with regular
+       * threads they use the non blocking calls of the existing
+       * objects, like `message_queue::try_send()`, or the resources.
+       */
+
+      /**
+       * @details
+       * The task is not activated.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      task::task (dispatcher& disp, priority_t prio, func_t func,
+                  func_args_t args) :
+          task
+            { nullptr, disp, prio, func, args }
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * The task is not activated.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      task::task (const char* name, dispatcher& disp, priority_t prio,
+                  func_t func, func_args_t args) :
+          object_named_system
+            { name }, //
+          dispatcher_ (disp), //
+          func_ (func), //
+          args_ (args), //
+          prio_ (prio)
+      {
+#if defined(OS_TRACE_RTOS_SRP)
+        trace::printf ("%s() @%p %s %u\n", __func__, this, this->name (),
+                       prio);
+#endif
+
+        assert(func != nullptr);
+        assert(prio >= 1 && prio <= max_priority);
+      }
+
+      /**
+       * @details
+       * The activations not yet run are discarded.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      task::~task ()
+      {
+#if defined(OS_TRACE_RTOS_SRP)
+        trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+        dispatcher_.internal_unlink_ (*this);
+      }
+
+      /**
+       * @details
+       * The activation is counted, and the task function is called
+       * once for each activation.
+       *
+       * If invoked from a task and the activated task has a priority
+       * higher than the running task and than the system ceiling,
+       * it runs before `post()` returns; otherwise, it
+       * runs when the priority conditions allow it.
+       *
+       * From interrupts and from other threads, the dispatcher
+       * thread is notified; the task starts when the running task,
+       * if any, completes, or at its next `post()` or
+       * `resource::unlock()`.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      result_t
+      task::post (void)
+      {
+#if defined(OS_TRACE_RTOS_SRP)
+        trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+        dispatcher_.internal_post_ (*this);
+
+        return result::ok;
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class resource
+       * @details
+       * With the Stack Resource Policy, a task starts only if its
+       * priority is higher than the priority of the running task
+       * and than the system ceiling, the highest ceiling of the
+       * locked resources. Once started, a task never blocks on
+       * a resource, since all tasks which might hold it are
+       * either finished or preempted, and cannot run until
+       * the task completes.
+       *
+       * Resources must be locked and unlocked in LIFO order, and only
+       * by tasks of the dispatcher; the tasks must unlock all the
+       * resources before returning.
+       *
+       * @par Example
+       *
+       * @code{.cpp}
+       * srp::dispatcher_inclusive<1024> disp { "disp" };
+       * srp::resource res { disp, 2 };
+       *
+       * void
+       * low (void* args)
+       * {
+       *   std::lock_guard<srp::resource> lock { res };
+       *   // Access the shared data.
+       * }
+       *
+       * srp::task t1 { "low", disp, 1, low };
+       * srp::task t2 { "high", disp, 2, high };
+       * @endcode
+       */
+
+      /**
+       * @details
+       * The _ceiling_ must be the highest priority of the tasks
+       * using the resource.
+       */
+      resource::resource (dispatcher& disp, priority_t ceiling) :
+          dispatcher_ (disp), //
+          ceiling_ (ceiling)
+      {
+        assert(ceiling >= 1 && ceiling <= max_priority);
+      }
+
+      /**
+       * @details
+       * Preempting tasks with priorities up to the ceiling are
+       * postponed until `unlock()`; the function never blocks.
+       *
+       * @warning Can be invoked only from the dispatcher tasks.
+       */
+      void
+      resource::lock (void)
+      {
+        assert(dispatcher_.internal_in_worker_ ());
+        // The ceiling must cover the tasks using the resource.
+        assert(dispatcher_.running_ <= ceiling_);
+        assert(!locked_);
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        saved_ = dispatcher_.ceiling_;
+        if (ceiling_ > saved_)
+          {
+            dispatcher_.ceiling_ = ceiling_;
+          }
+        locked_ = true;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * The tasks activated while the resource was locked and
+       * which now preempt the running task run before the function
+       * returns.
+       *
+       * @warning Can be invoked only from the dispatcher tasks.
+       */
+      void
+      resource::unlock (void)
+      {
+        assert(dispatcher_.internal_in_worker_ ());
+        assert(locked_);
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            locked_ = false;
+            dispatcher_.ceiling_ = saved_;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        dispatcher_.internal_dispatch_ ();
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class dispatcher::attributes
+       * @details
+       * Allow to define the dispatcher thread characteristics.
+       */
+
+      /**
+       * @details
+       * This variable is used by the default constructor.
+       */
+      const dispatcher::attributes dispatcher::initializer;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @class dispatcher
+       * @details
+       * A dispatcher runs many short run-to-completion tasks on
+       * the stack of a single thread, instead of a thread and a stack
+       * for each of them; switching tasks is a function call.
+       *
+       * The highest priority activated task runs first; tasks with
+       * the same priority run in the order of the activations.
+       *
+       * The dispatcher thread priority is the priority of all tasks
+       * relative to the regular threads.
+       *
+       * @par POSIX compatibility
+       *  No POSIX similar functionality identified.
+       */
+
+      /**
+       * @details
+       * This constructor shall initialise a dispatcher object
+       * with attributes referenced by _attr_.
+       * If the attributes specified by _attr_ are modified later,
+       * the dispatcher attributes shall not be affected.
+       *
+       * The dispatcher thread is created and started.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      dispatcher::dispatcher (const attributes& attr) :
+          dispatcher
+            { nullptr, attr }
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * This constructor shall initialise a named dispatcher object
+       * with attributes referenced by _attr_.
+       * If the attributes specified by _attr_ are modified later,
+       * the dispatcher attributes shall not be affected.
+       *
+       * The dispatcher thread is created and started.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      dispatcher::dispatcher (const char* name, const attributes& attr) :
+          dispatcher
+            { name, attr.th_stack_address, attr.th_stack_size_bytes, attr }
+      {
+        ;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      dispatcher::dispatcher (const char* name, void* stack_address,
+                              std::size_t stack_size_bytes,
+                              const attributes& attr) :
+          object_named_system
+            { name }, //
+          worker_
+            { name, internal_run_, this, internal_thread_attributes_ (
+                attr, stack_address, stack_size_bytes) }
+      {
+#if defined(OS_TRACE_RTOS_SRP)
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+#endif
+
+        // The lists are used only after the tasks are created.
+        for (auto& list : ready_)
+          {
+            list.clear ();
+          }
+      }
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @details
+       * The dispatcher thread is killed; the activations not yet
+       * run are discarded.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      dispatcher::~dispatcher ()
+      {
+#if defined(OS_TRACE_RTOS_SRP)
+        trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+        worker_.kill ();
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      thread::attributes
+      dispatcher::internal_thread_attributes_ (const attributes& attr,
+                                               void* stack_address,
+                                               std::size_t stack_size_bytes)
+      {
+        thread::attributes th_attr;
+
+        th_attr.th_stack_address = stack_address;
+        th_attr.th_stack_size_bytes = stack_size_bytes;
+        th_attr.th_priority = attr.th_priority;
+
+        return th_attr;
+      }
+
+      void*
+      dispatcher::internal_run_ (void* args)
+      {
+        dispatcher* disp = static_cast<dispatcher*> (args);
+
+        while (true)
+          {
+            // Wait for activations, the flags are raised by post().
+            this_thread::flags_wait (1);
+
+            disp->internal_dispatch_ ();
+          }
+
+        return nullptr;
+      }
+
+      bool
+      dispatcher::internal_in_worker_ (void)
+      {
+        return !interrupts::in_handler_mode ()
+            && (&this_thread::thread () == &worker_);
+      }
+
+      void
+      dispatcher::internal_post_ (task& t)
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (t.pending_++ == 0)
+              {
+                ready_[t.prio_ - 1].link (t);
+                ready_mask_ |= (1u << (t.prio_ - 1));
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        if (internal_in_worker_ ())
+          {
+            // From a task; if the new task preempts, call it now.
+            internal_dispatch_ ();
+          }
+        else
+          {
+            worker_.flags_raise (1);
+          }
+      }
+
+      void
+      dispatcher::internal_unlink_ (task& t)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (t.pending_ != 0)
+          {
+            t.links_.unlink ();
+            t.pending_ = 0;
+            if (ready_[t.prio_ - 1].empty ())
+              {
+                ready_mask_ &= ~(1u << (t.prio_ - 1));
+              }
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      // Call the activated tasks with the priority higher than the
+      // running task and than the system ceiling; returns when none
+      // is left, and this is the only place where the tasks run.
+      void
+      dispatcher::internal_dispatch_ (void)
+      {
+        while (true)
+          {
+            task* t;
+            priority_t prev;
+              {
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                if (ready_mask_ == 0)
+                  {
+                    return;
+                  }
+
+                priority_t prio = static_cast<priority_t> (32
+                    - __builtin_clz (ready_mask_));
+                priority_t threshold = (running_ > ceiling_) ? running_ : ceiling_;
+                if (prio <= threshold)
+                  {
+                    return;
+                  }
+
+                tasks_list& list = ready_[prio - 1];
+                t = list.unlink_head ();
+                if (--t->pending_ != 0)
+                  {
+                    // Let the other tasks with the same priority run.
+                    list.link (*t);
+                  }
+                else if (list.empty ())
+                  {
+                    ready_mask_ &= ~(1u << (prio - 1));
+                  }
+
+                prev = running_;
+                running_ = prio;
+                // ----- Exit critical section --------------------------------
+              }
+
+#if defined(OS_TRACE_RTOS_SRP)
+            trace::printf ("%s() %s %u\n", __func__, t->name (), t->prio_);
+#endif
+
+            priority_t ceiling = ceiling_;
+            t->func_ (t->args_);
+
+            // All resources locked by the task must be unlocked.
+            assert(ceiling_ == ceiling);
+            (void) ceiling;
+
+            running_ = prev;
+          }
+      }
+
+      /**
+       * @endcond
+       */
+
+    // ------------------------------------------------------------------------
+    } /* namespace srp */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
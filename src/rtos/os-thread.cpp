@@ -26,6 +26,7 @@
  */
 
 #include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/estd/memory_resource>
 
 #include <memory>
 #include <stdexcept>
@@ -47,6 +48,97 @@ namespace os
     std::size_t thread::stack::default_size_bytes_ =
         port::stack::default_size_bytes;
 
+    memory::memory_resource* thread::stack::default_resource_ = nullptr;
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+
+    thread::stack::element_t* thread::stack::cache_addresses_[OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES];
+    std::size_t thread::stack::cache_sizes_[OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES];
+    std::size_t thread::stack::cache_count_ = 0;
+    rtos::statistics::counter_t thread::stack::cache_hits_ = 0;
+    rtos::statistics::counter_t thread::stack::cache_misses_ = 0;
+
+    // Take a cached stack of exactly the same size, if any.
+    thread::stack::element_t*
+    thread::stack::internal_cache_get_ (std::size_t size_elements)
+    {
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      for (std::size_t i = cache_count_; i > 0; --i)
+        {
+          if (cache_sizes_[i - 1] == size_elements)
+            {
+              element_t* address = cache_addresses_[i - 1];
+
+              // Keep the other entries compact.
+              --cache_count_;
+              cache_addresses_[i - 1] = cache_addresses_[cache_count_];
+              cache_sizes_[i - 1] = cache_sizes_[cache_count_];
+
+              ++cache_hits_;
+              return address;
+            }
+        }
+
+      ++cache_misses_;
+      return nullptr;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    // Keep the stack for a future thread; false if the cache is full.
+    bool
+    thread::stack::internal_cache_put_ (element_t* address,
+                                        std::size_t size_elements)
+    {
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      if (cache_count_ >= OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES)
+        {
+          return false;
+        }
+
+      cache_addresses_[cache_count_] = address;
+      cache_sizes_[cache_count_] = size_elements;
+      ++cache_count_;
+
+      return true;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Return the cached stacks to the default allocator, for example
+     * before a large allocation, or to check for memory leaks.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    thread::stack::cache_flush (void)
+    {
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      std::size_t count = cache_count_;
+
+      thread::allocator_type allocator;
+      while (cache_count_ > 0)
+        {
+          --cache_count_;
+          allocator.deallocate (
+              reinterpret_cast<allocation_element_t*> (cache_addresses_[cache_count_]),
+              cache_sizes_[cache_count_]);
+        }
+
+      return count;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
+
     /**
      * @endcond
      */
@@ -175,6 +267,8 @@ namespace os
       // Compute the actual size. The -1 is to leave space for the magic.
       size_bytes_ = ((static_cast<std::size_t> (p - bottom_address_) - 1)
           * sizeof(element_t));
+
+      watermark_ = top ();
     }
 
     /**
@@ -200,9 +294,58 @@ namespace os
           ++p;
         }
 
+      // Remember it, for the incremental scans.
+      if (p < watermark_)
+        {
+          watermark_ = p;
+        }
+
       return count;
     }
 
+    /**
+     * @details
+     * The scan resumes from the deepest level found by the previous
+     * calls and stops after a run of
+     * `OS_INTEGER_RTOS_THREAD_STACK_WATERMARK_GAP_WORDS` words with
+     * the magic still there, so the cost is proportional to the
+     * stack growth since the previous call, not to the stack size;
+     * in the steady state it is a few words.
+     *
+     * Areas deeper than the gap, left unwritten (for example large
+     * local arrays not fully used), are not detected; use
+     * `available()` for an exact value.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    thread::stack::peak (void)
+    {
+      element_t* p = watermark_;
+      element_t* q = p;
+      std::size_t gap = 0;
+
+      // The bottom word is the guard, not part of the stack.
+      while (q > bottom_address_ + 1
+          && gap < OS_INTEGER_RTOS_THREAD_STACK_WATERMARK_GAP_WORDS)
+        {
+          --q;
+          if (*q == magic)
+            {
+              ++gap;
+            }
+          else
+            {
+              gap = 0;
+              p = q;
+            }
+        }
+
+      watermark_ = p;
+
+      return static_cast<std::size_t> (top () - p) * sizeof(element_t);
+    }
+
     /**
      * @cond ignore
      */
@@ -349,6 +492,19 @@ namespace os
      * the stack is dynamically allocated using the RTOS specific allocator
      * (`rtos::memory::allocator`).
      *
+     * If `th_stack_resource` is set, or `th_stack_region` names a
+     * registered memory region (see `memory::set_region()`), or
+     * a default stack memory manager was set with
+     * `thread::stack::default_resource()`, the stack is allocated
+     * from that memory manager instead, for example to place it
+     * in CCM or TCM, or to take it from a pool of stacks; if that
+     * memory manager is exhausted, the allocator is used.
+     *
+     * When `OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES` is not 0, the
+     * stacks allocated with the allocator are not freed when the
+     * threads are destroyed, but are kept in a small cache, and
+     * are reused by the next threads with the same stack size.
+     *
      * @par POSIX compatibility
      *  Inspired by [`pthread_create()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_create.html)
      *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
@@ -374,6 +530,11 @@ namespace os
         }
       else
         {
+#if defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE)
+          // Free the stacks of the terminated threads first.
+          internal_reclaim_terminated_ ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE) */
+
           using allocator_type2 = memory::allocator<stack::allocation_element_t>;
 
           if (attr.th_stack_size_bytes > stack::min_size ())
@@ -389,9 +550,49 @@ namespace os
                   / sizeof(stack::allocation_element_t);
             }
 
-          allocated_stack_address_ =
-              reinterpret_cast<stack::element_t*> (const_cast<allocator_type2&> (allocator).allocate (
-                  allocated_stack_size_elements_));
+          // The explicit memory manager has precedence over the
+          // region, and the region over the default stack manager.
+          memory::memory_resource* res = attr.th_stack_resource;
+          if ((res == nullptr) && (attr.th_stack_region != nullptr))
+            {
+              res = memory::region (attr.th_stack_region);
+            }
+          if (res == nullptr)
+            {
+              res = stack::default_resource ();
+            }
+
+          if (res != nullptr)
+            {
+              scheduler::critical_section scs;
+
+              allocated_stack_address_ =
+                  static_cast<stack::element_t*> (res->allocate (
+                      allocated_stack_size_elements_
+                          * sizeof(stack::allocation_element_t),
+                      alignof(stack::allocation_element_t)));
+              if (allocated_stack_address_ != nullptr)
+                {
+                  allocated_stack_resource_ = res;
+                }
+            }
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+          if (allocated_stack_address_ == nullptr)
+            {
+              // Reuse the stack of a destroyed thread.
+              allocated_stack_address_ = stack::internal_cache_get_ (
+                  allocated_stack_size_elements_);
+            }
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
+
+          if (allocated_stack_address_ == nullptr)
+            {
+              // No memory manager, or exhausted; use the allocator.
+              allocated_stack_address_ =
+                  reinterpret_cast<stack::element_t*> (const_cast<allocator_type2&> (allocator).allocate (
+                      allocated_stack_size_elements_));
+            }
 
           // Stack allocation failed.
           assert(allocated_stack_address_ != nullptr);
@@ -422,6 +623,10 @@ namespace os
       assert(function != nullptr);
       // Don't forget to set the thread priority.
       assert(attr.th_priority != priority::none);
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+      // The reference scheduler runs only on core 0.
+      assert((attr.th_affinity == 0) || ((attr.th_affinity & 1u) != 0));
+#endif
 
       clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
 
@@ -456,6 +661,25 @@ namespace os
 
           // Get attributes from user structure.
           prio_assigned_ = attr.th_priority;
+          preemption_threshold_ = attr.th_preemption_threshold;
+          affinity_ = attr.th_affinity;
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+          quantum_ticks_ = attr.th_quantum_ticks;
+          quantum_remaining_ = quantum_ticks_;
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+          period_ticks_ = attr.th_period_ticks;
+          if (period_ticks_ != 0)
+            {
+              // The first job is released when the thread is created.
+              deadline_ticks_ =
+                  (attr.th_deadline_ticks != 0) ?
+                      attr.th_deadline_ticks : period_ticks_;
+              deadline_ = sysclock.now () + deadline_ticks_;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
 
           func_ = function;
           func_args_ = args;
@@ -547,7 +771,7 @@ namespace os
      *
      * @note Can be invoked from Interrupt Service Routines.
      */
-    void
+    void OS_ATTRIBUTE_HOT_PATH
     thread::resume (void)
     {
 #if defined(OS_TRACE_RTOS_THREAD_CONTEXT)
@@ -568,6 +792,24 @@ namespace os
 
 #else
 
+      internal_make_ready_ ();
+
+      scheduler::internal_request_reschedule ();
+
+#endif
+
+    }
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+    /**
+     * @details
+     * Used by the clock check, which requests a single
+     * reschedule for all threads woken on the same tick.
+     */
+    void
+    thread::internal_make_ready_ (void)
+    {
       // Don't call this from high priority interrupts.
       assert(port::interrupts::is_priority_valid ());
 
@@ -583,13 +825,10 @@ namespace os
             }
           // ----- Exit critical section --------------------------------------
         }
-
-      port::scheduler::reschedule ();
+    }
 
 #endif
 
-    }
-
     /**
      * @details
      *
@@ -782,6 +1021,119 @@ namespace os
       return res;
     }
 
+    /**
+     * @details
+     * While the thread is running, ready threads with a priority
+     * higher than the thread priority, but not higher than the
+     * threshold, do not preempt it; they run when the thread
+     * blocks, yields or lowers the threshold.
+     *
+     * This is useful for groups of cooperating threads, which can
+     * run up to a hand-off point without switching contexts on
+     * each resume.
+     *
+     * The threshold is honoured only by the reference scheduler.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::preemption_threshold (priority_t prio)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      trace::printf ("%s(%u) @%p %s\n", __func__, prio, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Check the priority, it is not in the allowed range.
+      os_assert_err(prio < priority::error, EINVAL);
+
+      if (prio == preemption_threshold_)
+        {
+          // Optimise, if threshold did not change.
+          return result::ok;
+        }
+
+      priority_t old = preemption_threshold_;
+      preemption_threshold_ = prio;
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      if (prio < old)
+        {
+          // Lowering the threshold might enable pending preemptions.
+          this_thread::yield ();
+        }
+
+#endif
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    thread::priority_t
+    thread::preemption_threshold (void)
+    {
+      return preemption_threshold_;
+    }
+
+    /**
+     * @details
+     * Restrict the cores allowed to run the thread, bit n for
+     * core n; 0 allows any core.
+     *
+     * The reference scheduler runs all threads on core 0, so the
+     * mask must include it; the value is kept for multi-core ports.
+     *
+     * @par POSIX compatibility
+     *  Inspired by `pthread_setaffinity_np()` (GNU extension).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::affinity (affinity_t mask)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      trace::printf ("%s(0x%X) @%p %s\n", __func__, mask, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+      // The reference scheduler runs only on core 0.
+      os_assert_err((mask == 0) || ((mask & 1u) != 0), EINVAL);
+#endif
+
+      affinity_ = mask;
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     *
+     * @par POSIX compatibility
+     *  Inspired by `pthread_getaffinity_np()` (GNU extension).
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    thread::affinity_t
+    thread::affinity (void)
+    {
+      return affinity_;
+    }
+
     /**
      * @details
      * Indicate to the implementation that storage for the thread
@@ -841,6 +1193,10 @@ namespace os
      * `join()` is cancelled, then the target thread shall not be
      * detached.
      *
+     * The resources of the terminated thread (like the stack) are
+     * released by the calling thread, without waiting for the
+     * idle thread to run.
+     *
      * @par POSIX compatibility
      *  Inspired by [`pthread_join()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_join.html)
      *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
@@ -872,7 +1228,21 @@ namespace os
 
       while (state_ != state::destroyed)
         {
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+          // Do not wait for the idle thread, which may not run
+          // for a long time if the CPU is busy.
+          if (internal_reclaim_ ())
+            {
+              continue;
+            }
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
           joiner_ = this_thread::_thread ();
+          if (state_ == state::terminated)
+            {
+              // Terminated after the check above.
+              continue;
+            }
           this_thread::_thread ()->internal_suspend_ ();
         }
 
@@ -987,6 +1357,14 @@ namespace os
       // Don't call this from interrupt handlers.
       assert(!interrupts::in_handler_mode ());
 
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+
+      // Destructors run in the context of the exiting thread,
+      // with the scheduler unlocked.
+      tls_.internal_run_destructors_ ();
+
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
+
         {
           // ----- Enter critical section -------------------------------------
           scheduler::critical_section scs;
@@ -1023,6 +1401,15 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+      if (joiner_ != nullptr)
+        {
+          // Let the joiner destroy the thread, without waiting
+          // for the idle thread.
+          joiner_->resume ();
+        }
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
 
       port::thread::destroy_this (this);
@@ -1073,17 +1460,59 @@ namespace os
 
       internal_check_stack_ ();
 
-      if (allocated_stack_address_ != nullptr)
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          // No longer replenished.
+          budget_links_.unlink ();
+          budget_cycles_ = 0;
+          // ----- Exit critical section --------------------------------------
+        }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
+      if (allocated_stack_resource_ != nullptr)
+        {
+          scheduler::critical_section scs;
+
+          allocated_stack_resource_->deallocate (
+              allocated_stack_address_,
+              allocated_stack_size_elements_
+                  * sizeof(stack::allocation_element_t),
+              alignof(stack::allocation_element_t));
+
+          allocated_stack_resource_ = nullptr;
+          allocated_stack_address_ = nullptr;
+        }
+      else if (allocated_stack_address_ != nullptr)
         {
-          typedef typename std::allocator_traits<allocator_type>::pointer pointer;
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+          // Keep the stack for the next thread of the same size.
+          if (!stack::internal_cache_put_ (allocated_stack_address_,
+                                           allocated_stack_size_elements_))
+#endif /* (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0) */
+            {
+              typedef typename std::allocator_traits<allocator_type>::pointer pointer;
 
-          static_cast<allocator_type*> (const_cast<void*> (allocator_))->deallocate (
-              reinterpret_cast<pointer> (allocated_stack_address_),
-              allocated_stack_size_elements_);
+              static_cast<allocator_type*> (const_cast<void*> (allocator_))->deallocate (
+                  reinterpret_cast<pointer> (allocated_stack_address_),
+                  allocated_stack_size_elements_);
+            }
 
           allocated_stack_address_ = nullptr;
         }
 
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+
+      // The thread is no longer running, so it is safe
+      // to access its cache from here.
+      allocation_cache_.flush ();
+
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
         {
           // ----- Enter critical section -------------------------------------
           scheduler::critical_section scs;
@@ -1109,6 +1538,59 @@ namespace os
         }
     }
 
+    // Called from join(). The terminated threads are taken from
+    // the list in a critical section, so the idle thread and the
+    // joiner never destroy the same thread.
+    bool
+    thread::internal_reclaim_ (void)
+    {
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (state_ != state::terminated || ready_node_.unlinked ())
+            {
+              return false;
+            }
+          ready_node_.unlink ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // The joiner is the current thread, there is no one to resume.
+      joiner_ = nullptr;
+      internal_destroy_ ();
+
+      return true;
+    }
+
+#if defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE)
+
+    // Called before allocating a new thread stack.
+    void
+    thread::internal_reclaim_terminated_ (void)
+    {
+      while (true)
+        {
+          internal::waiting_thread_node* node;
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (scheduler::terminated_threads_list_.empty ())
+                {
+                  return;
+                }
+              node =
+                  const_cast<internal::waiting_thread_node*> (scheduler::terminated_threads_list_.head ());
+              node->unlink ();
+              // ----- Exit critical section ----------------------------------
+            }
+          node->thread_->internal_destroy_ ();
+        }
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE) */
+
     /**
      * @endcond
      */
@@ -1222,8 +1704,73 @@ namespace os
       return res;
     }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
     /**
-     * @cond ignore
+     * @details
+     * Update the thread notification value as requested by _action_
+     * and mark the notification as pending.
+     *
+     * Unlike `flags_raise()`, the thread is resumed only if it waits
+     * for a notification, and then it is linked directly to the
+     * ready list; there is no waiting list to walk and no separate
+     * synchronisation object, so this is the fastest way for an
+     * interrupt handler to wake its driver thread.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::notify (notify::value_t value, notify::action_t action)
+    {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      trace::printf ("%s(0x%X,%u) @%p %s\n", __func__, value, action, this,
+                     name ());
+#endif
+
+      os_assert_err(action <= notify::action::no_overwrite, EINVAL);
+
+      bool waiting;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (action == notify::action::set_bits)
+            {
+              notify_value_ = notify_value_ | value;
+            }
+          else if (action == notify::action::increment)
+            {
+              notify_value_ = notify_value_ + value;
+            }
+          else if (action == notify::action::overwrite
+              || (action == notify::action::no_overwrite && !notify_pending_))
+            {
+              notify_value_ = value;
+            }
+          else if (action == notify::action::no_overwrite)
+            {
+              return EAGAIN;
+            }
+
+          notify_pending_ = true;
+
+          waiting = notify_waiting_;
+          notify_waiting_ = false;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (waiting)
+        {
+          resume ();
+        }
+
+      return result::ok;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
+    /**
+     * @cond ignore
      */
 
     result_t
@@ -1440,6 +1987,127 @@ namespace os
       return ENOTRECOVERABLE;
     }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    thread::internal_notify_check_ (bool take, notify::value_t clear,
+                                    notify::value_t* ovalue)
+    {
+      notify::value_t value = notify_value_;
+      if (take ? (value == 0) : !notify_pending_)
+        {
+          return false;
+        }
+
+      if (ovalue != nullptr)
+        {
+          *ovalue = value;
+        }
+
+      if (take)
+        {
+          notify_value_ = (clear != 0) ? 0 : value - 1;
+        }
+      else
+        {
+          notify_value_ = value & ~clear;
+        }
+      notify_pending_ = false;
+
+      return true;
+    }
+
+    /*
+     * The check and the suspend are done in the same critical
+     * section, and the notifier resumes the thread only if it
+     * found `notify_waiting_` set, so no notification is lost
+     * and no spurious resume is done.
+     */
+    result_t
+    thread::internal_notify_wait_ (bool take, notify::value_t clear,
+                                   notify::value_t* ovalue,
+                                   const clock::duration_t* timeout)
+    {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      trace::printf ("%s(%u) @%p %s\n", __func__, take, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          (timeout != nullptr) ? clock_->steady_now () + *timeout : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, *this };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_notify_check_ (take, clear, ovalue))
+                {
+                  return result::ok;
+                }
+
+              if (timeout != nullptr
+                  && clock_->steady_now () >= timeout_timestamp)
+                {
+                  return ETIMEDOUT;
+                }
+
+              // Remove this thread from the ready list, if there.
+              port::this_thread::prepare_suspend ();
+
+              if (timeout != nullptr)
+                {
+                  // Add this thread to the clock timeout list.
+                  clock_list.link (timeout_node);
+                  timeout_node.thread.clock_node_ = &timeout_node;
+                }
+
+              notify_waiting_ = true;
+              state_ = state::suspended;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              notify_waiting_ = false;
+
+              // Remove the thread from the clock timeout list,
+              // if not already removed by the timer.
+              timeout_node.thread.clock_node_ = nullptr;
+              timeout_node.unlink ();
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+        }
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
     /**
      * @details
      * Select the requested bits from the thread current flags mask
@@ -1500,6 +2168,238 @@ namespace os
      * @endcond
      */
 
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+
+    // ------------------------------------------------------------------------
+
+    constexpr std::size_t thread::tls::slots;
+
+    namespace
+    {
+      // Keys are global, shared by all threads.
+      bool tls_keys_used_[thread::tls::slots];
+      thread::tls::destructor_t tls_destructors_[thread::tls::slots];
+    } /* namespace */
+
+    /**
+     * @details
+     * The key must be allocated before being used with
+     * `get()` and `set()` in any thread. The slot is initially
+     * `nullptr` in all threads.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::tls::create_key (key_t* key, destructor_t destructor)
+    {
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      assert(key != nullptr);
+
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      for (key_t k = 0; k < slots; ++k)
+        {
+          if (!tls_keys_used_[k])
+            {
+              tls_keys_used_[k] = true;
+              tls_destructors_[k] = destructor;
+              *key = k;
+              return result::ok;
+            }
+        }
+      return EAGAIN;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * The slot values are not changed and the destructor is
+     * not called; it is the application responsibility to
+     * release the data before deleting the key.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::tls::delete_key (key_t key)
+    {
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(key < slots, EINVAL);
+
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      if (!tls_keys_used_[key])
+        {
+          return EINVAL;
+        }
+      tls_keys_used_[key] = false;
+      tls_destructors_[key] = nullptr;
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    thread::tls::internal_run_destructors_ (void)
+    {
+      for (key_t k = 0; k < slots; ++k)
+        {
+          void* value = slots_[k];
+          if (value != nullptr)
+            {
+              slots_[k] = nullptr;
+              destructor_t destructor = tls_destructors_[k];
+              if (tls_keys_used_[k] && destructor != nullptr)
+                {
+                  destructor (value);
+                }
+            }
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+
+    // ------------------------------------------------------------------------
+
+    constexpr std::size_t thread::allocation_cache::blocks;
+    constexpr std::size_t thread::allocation_cache::block_size_bytes;
+
+    /**
+     * @details
+     * Called automatically when the thread is destroyed; it can
+     * also be called by the thread itself, for example before a
+     * long period of inactivity, to make the blocks available to
+     * other threads.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void
+    thread::allocation_cache::flush (void)
+    {
+      assert(!interrupts::in_handler_mode ());
+
+      if (count_ == 0)
+        {
+          return;
+        }
+
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      while (count_ > 0)
+        {
+          estd::pmr::get_default_resource ()->deallocate (cached_[--count_],
+                                                          block_size_bytes);
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY)
+
+    // ------------------------------------------------------------------------
+
+    constexpr std::size_t thread::statistics::ready_latency_bins;
+
+    /**
+     * @details
+     * Reset the minimum, the maximum and the histogram, for
+     * example after a firmware update or a change of load, to
+     * measure only the following interval.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void
+    thread::statistics::clear_ready_latency (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      ready_latency_min_ = static_cast<rtos::statistics::duration_t> (-1);
+      ready_latency_max_ = 0;
+      for (std::size_t i = 0; i < ready_latency_bins; ++i)
+        {
+          ready_latency_histogram_[i] = 0;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     * Called from `ready_threads_list::link()`, in a critical section.
+     */
+    void
+    thread::statistics::internal_mark_ready_ (void)
+    {
+      if (scheduler::started ())
+        {
+          ready_timestamp_ = hrclock.now ();
+        }
+      else
+        {
+          // The high resolution clock may not be running yet.
+          ready_timestamp_ = 0;
+        }
+    }
+
+    /**
+     * @details
+     * Called from `ready_threads_list::unlink_head()`, in a
+     * critical section, just before the thread is switched in.
+     */
+    void
+    thread::statistics::internal_mark_running_ (void)
+    {
+      if (ready_timestamp_ == 0)
+        {
+          return;
+        }
+
+      rtos::statistics::duration_t latency =
+          static_cast<rtos::statistics::duration_t> (hrclock.now ()
+              - ready_timestamp_);
+      ready_timestamp_ = 0;
+
+      if (latency < ready_latency_min_)
+        {
+          ready_latency_min_ = latency;
+        }
+      if (latency > ready_latency_max_)
+        {
+          ready_latency_max_ = latency;
+        }
+
+      // The bin is the number of significant bits of the latency.
+      std::size_t bin = 0;
+      while (latency != 0 && bin < (ready_latency_bins - 1))
+        {
+          latency >>= 1;
+          ++bin;
+        }
+      ++ready_latency_histogram_[bin];
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_READY_LATENCY) */
+
     // ------------------------------------------------------------------------
     /**
      * @details
@@ -1593,6 +2493,153 @@ namespace os
 #endif
       }
 
+      // ======================================================================
+
+      /**
+       * @class periodic
+       * @details
+       * Replaces the usual pattern:
+       *
+       * @code{.cpp}
+       * clock::timestamp_t next = sysclock.steady_now ();
+       * for (;;)
+       *   {
+       *     next += period;
+       *     sysclock.sleep_until (next);
+       *     // ...
+       *   }
+       * @endcode
+       *
+       * with:
+       *
+       * @code{.cpp}
+       * this_thread::periodic p { period };
+       * for (;;)
+       *   {
+       *     p.wait_next_period ();
+       *     // ...
+       *   }
+       * @endcode
+       */
+
+      /**
+       * @details
+       * The first release is one period after the construction.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      periodic::periodic (clock::duration_t period, clock& clk) :
+          clock_ (&clk), //
+          node_
+            { clk.steady_now (), this_thread::thread () }, //
+          period_ (period != 0 ? period : 1)
+      {
+        ;
+      }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @details
+       * The period is the earliest deadline first period of the
+       * current thread, in scheduler ticks; if the thread is
+       * scheduled by fixed priority only, the period is 1 tick.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      periodic::periodic (void) :
+          periodic
+            { this_thread::thread ().period (), sysclock }
+      {
+        ;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+      /**
+       * @details
+       * If the thread is late, the releases already passed are
+       * counted as overruns and skipped, so the following ones
+       * keep the original phase.
+       *
+       * The clock node is linked back with the new time stamp; the
+       * clock is read only once before and once after the wait.
+       *
+       * For earliest deadline first threads using the scheduler
+       * clock, the call completes the current job; if it is
+       * later than the job deadline, the thread
+       * `deadline_misses()` statistic is incremented. The deadline
+       * of the next job is set before waiting, so the thread is
+       * made ready already ordered by it.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      periodic::wait_next_period (void)
+      {
+        // Don't call this from interrupt handlers.
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        // Don't call this from critical regions.
+        os_assert_err(!scheduler::locked (), EPERM);
+        // Only the thread that created the object can use it.
+        os_assert_err(&node_.thread == &this_thread::thread (), EPERM);
+
+        result_t res = result::ok;
+
+        clock::timestamp_t next = node_.timestamp + period_;
+        clock::timestamp_t nw = clock_->steady_now ();
+        if (nw >= next)
+          {
+            std::size_t missed = static_cast<std::size_t> ((nw - next)
+                / period_ + 1);
+            overruns_ += missed;
+            next += missed * period_;
+            res = ETIMEDOUT;
+          }
+        node_.timestamp = next;
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        rtos::thread& th = node_.thread;
+        if (th.period_ticks_ != 0 && clock_ == &sysclock)
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (nw > th.deadline_)
+              {
+                th.statistics_.deadline_misses_++;
+              }
+            th.deadline_ = next + th.deadline_ticks_;
+            // ----- Exit critical section ------------------------------------
+          }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        for (;;)
+          {
+            result_t r;
+#if defined(OS_USE_RTOS_PORT_CLOCK_SYSTICK_WAIT_FOR)
+            r = clock_->internal_wait_until_ (next, clock_->steady_list ());
+#else
+            r = clock_->internal_wait_node_ (node_, clock_->steady_list ());
+#endif
+
+            if (clock_->steady_now () >= next)
+              {
+                return res;
+              }
+
+            if (this_thread::thread ().interrupted ())
+              {
+                return EINTR;
+              }
+
+            if (r != result::ok)
+              {
+                return r;
+              }
+          }
+      }
+
     } /* namespace this_thread */
 
   // --------------------------------------------------------------------------
@@ -0,0 +1,487 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class thread_pool::attributes
+     * @details
+     * Allow to define the characteristics of the worker threads.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const thread_pool::attributes thread_pool::initializer;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class thread_pool
+     * @details
+     * A thread pool runs short jobs on a fixed set of worker
+     * threads, without creating a thread for each job.
+     *
+     * Jobs are `{func, args, done}` triplets, copied into a bounded
+     * ring; no memory is allocated for each job. Idle workers wait
+     * on a counting semaphore, so each submitted job wakes
+     * exactly one worker.
+     *
+     * The optional `done` semaphore is posted after the job
+     * function returns, and can be used to wait for a specific job.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * thread_pool_inclusive<2, 8> pool { "pool" };
+     *
+     * void
+     * work (void* args)
+     * {
+     *   // Process args.
+     * }
+     *
+     * void
+     * func (void)
+     * {
+     *   semaphore_binary done { "done", 0 };
+     *
+     *   pool.submit (work, nullptr, &done);
+     *   done.wait ();
+     *
+     *   pool.wait_idle ();
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a thread pool object
+     * with attributes referenced by _attr_.
+     *
+     * The worker threads and the jobs ring are dynamically allocated,
+     * and the workers are started.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    thread_pool::thread_pool (std::size_t workers, std::size_t jobs,
+                              const attributes& attr) :
+        thread_pool
+          { nullptr, workers, jobs, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * This constructor shall initialise a named thread pool object
+     * with attributes referenced by _attr_.
+     *
+     * The worker threads and the jobs ring are dynamically allocated,
+     * and the workers are started.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    thread_pool::thread_pool (const char* name, std::size_t workers,
+                              std::size_t jobs, const attributes& attr) :
+        thread_pool
+          { name, workers, jobs, nullptr, nullptr, attr.th_stack_size_bytes,
+              nullptr, attr }
+    {
+      ;
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    thread_pool::thread_pool (const char* name, std::size_t workers,
+                              std::size_t jobs, void* threads_storage,
+                              void* stacks_storage,
+                              std::size_t stack_size_bytes, job* jobs_storage,
+                              const attributes& attr) :
+        object_named_system
+          { name }, //
+        workers_ (workers), //
+        size_ (jobs), //
+        threads_ (static_cast<thread*> (threads_storage)), //
+        jobs_ (jobs_storage), //
+        mutex_
+          { name }, //
+        idle_cond_
+          { name }, //
+        slots_
+          { name, static_cast<semaphore::count_t> (jobs),
+              static_cast<semaphore::count_t> (jobs) }, //
+        pending_
+          { name, static_cast<semaphore::count_t> (jobs + workers), 0 }
+    {
+#if defined(OS_TRACE_RTOS_THREADPOOL)
+      trace::printf ("%s() @%p %s %u %u\n", __func__, this, this->name (),
+                     workers, jobs);
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      assert(workers > 0);
+      assert(jobs > 0);
+      assert((jobs + workers) <= semaphore::max_count_value);
+
+#if !defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+      if (jobs_ == nullptr)
+        {
+          allocated_jobs_ = memory::allocator<job> ().allocate (size_);
+          jobs_ = allocated_jobs_;
+        }
+
+      if (threads_ == nullptr)
+        {
+          allocated_threads_ = memory::allocator<thread> ().allocate (
+              workers_);
+          threads_ = allocated_threads_;
+        }
+
+#endif /* !defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+      assert(jobs_ != nullptr);
+      assert(threads_ != nullptr);
+
+      thread::attributes th_attr;
+      th_attr.th_priority = attr.th_priority;
+      th_attr.th_stack_size_bytes = stack_size_bytes;
+
+      for (std::size_t i = 0; i < workers_; ++i)
+        {
+          if (stacks_storage != nullptr)
+            {
+              th_attr.th_stack_address = static_cast<char*> (stacks_storage)
+                  + i * stack_size_bytes;
+            }
+          new (&threads_[i]) thread
+            { name, internal_run_, this, th_attr };
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The jobs already submitted are completed, then the worker
+     * threads are terminated and destroyed. If the storage was
+     * dynamically allocated, it is deallocated.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    thread_pool::~thread_pool ()
+    {
+#if defined(OS_TRACE_RTOS_THREADPOOL)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      internal_stop_ ();
+
+#if !defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+      if (allocated_threads_ != nullptr)
+        {
+          memory::allocator<thread> ().deallocate (allocated_threads_,
+                                                   workers_);
+        }
+
+      if (allocated_jobs_ != nullptr)
+        {
+          memory::allocator<job> ().deallocate (allocated_jobs_, size_);
+        }
+
+#endif /* !defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+    }
+
+    /**
+     * @details
+     * If the ring is full, the calling thread is blocked until
+     * a worker takes a job out.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread_pool::submit (func_t func, func_args_t args, semaphore* done)
+    {
+#if defined(OS_TRACE_RTOS_THREADPOOL)
+      trace::printf ("%s(%p,%p) @%p %s\n", __func__, func, args, this,
+                     name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(func != nullptr, EINVAL);
+
+      result_t res = slots_.wait ();
+      if (res != result::ok)
+        {
+          return res;
+        }
+
+      mutex_.lock ();
+      internal_put_ (job
+        { func, args, done });
+      mutex_.unlock ();
+
+      pending_.post ();
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * If the ring is full, the function returns `EWOULDBLOCK`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread_pool::try_submit (func_t func, func_args_t args, semaphore* done)
+    {
+#if defined(OS_TRACE_RTOS_THREADPOOL)
+      trace::printf ("%s(%p,%p) @%p %s\n", __func__, func, args, this,
+                     name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(func != nullptr, EINVAL);
+
+      if (slots_.try_wait () != result::ok)
+        {
+          return EWOULDBLOCK;
+        }
+
+      mutex_.lock ();
+      internal_put_ (job
+        { func, args, done });
+      mutex_.unlock ();
+
+      pending_.post ();
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The function waits for at least one free slot, then takes
+     * all the free slots available, up to the number of jobs left,
+     * and copies the jobs in a single locked section.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    thread_pool::submit_n (const job* jobs, std::size_t count)
+    {
+#if defined(OS_TRACE_RTOS_THREADPOOL)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, jobs, count, this,
+                     name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), 0);
+      os_assert_err(jobs != nullptr, 0);
+
+      std::size_t n = 0;
+      while (n < count)
+        {
+          if (slots_.wait () != result::ok)
+            {
+              break;
+            }
+
+          std::size_t k = 1;
+          while ((n + k) < count && slots_.try_wait () == result::ok)
+            {
+              ++k;
+            }
+
+          mutex_.lock ();
+          for (std::size_t i = 0; i < k; ++i)
+            {
+              assert(jobs[n + i].func != nullptr);
+              internal_put_ (jobs[n + i]);
+            }
+          mutex_.unlock ();
+
+          for (std::size_t i = 0; i < k; ++i)
+            {
+              pending_.post ();
+            }
+
+          n += k;
+        }
+
+      return n;
+    }
+
+    /**
+     * @details
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread_pool::wait_idle (void)
+    {
+#if defined(OS_TRACE_RTOS_THREADPOOL)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      mutex_.lock ();
+      while (busy_ != 0)
+        {
+          idle_cond_.wait (mutex_);
+        }
+      mutex_.unlock ();
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    thread_pool::busy (void) const
+    {
+      return busy_;
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    // Must be called with the mutex locked.
+    void
+    thread_pool::internal_put_ (const job& j)
+    {
+      jobs_[tail_] = j;
+      if (++tail_ == size_)
+        {
+          tail_ = 0;
+        }
+      ++queued_;
+      ++busy_;
+    }
+
+    void
+    thread_pool::internal_stop_ (void)
+    {
+      // One stop request for each worker; they are served
+      // after all queued jobs.
+      for (std::size_t i = 0; i < workers_; ++i)
+        {
+          pending_.post ();
+        }
+
+      for (std::size_t i = 0; i < workers_; ++i)
+        {
+          threads_[i].join ();
+          threads_[i].~thread ();
+        }
+    }
+
+    void*
+    thread_pool::internal_run_ (void* args)
+    {
+      thread_pool* tp = static_cast<thread_pool*> (args);
+
+      while (true)
+        {
+          if (tp->pending_.wait () != result::ok)
+            {
+              continue;
+            }
+
+          tp->mutex_.lock ();
+          if (tp->queued_ == 0)
+            {
+              // No job, a stop request.
+              tp->mutex_.unlock ();
+              break;
+            }
+
+          job j = tp->jobs_[tp->head_];
+          if (++tp->head_ == tp->size_)
+            {
+              tp->head_ = 0;
+            }
+          --tp->queued_;
+          tp->mutex_.unlock ();
+
+          tp->slots_.post ();
+
+          j.func (j.args);
+
+          if (j.done != nullptr)
+            {
+              j.done->post ();
+            }
+
+          tp->mutex_.lock ();
+          if (--tp->busy_ == 0)
+            {
+              tp->idle_cond_.broadcast ();
+            }
+          tp->mutex_.unlock ();
+        }
+
+      return nullptr;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
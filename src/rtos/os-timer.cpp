@@ -29,6 +29,20 @@
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#endif
+
+static os::rtos::work_queue* os_timer_daemon_;
+
+#pragma GCC diagnostic pop
+
+#endif
+
 namespace os
 {
   namespace rtos
@@ -183,8 +197,16 @@ namespace os
       func_ = function;
       func_args_ = args;
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+      run_in_thread_ = attr.tm_run_in_thread;
+#else
+      // Deferred timer functions require the timer daemon.
+      os_assert_throw(!attr.tm_run_in_thread, ENOTSUP);
+#endif
+
 #if !defined(OS_USE_RTOS_PORT_TIMER)
       clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+      slack_ = attr.tm_slack;
 #endif
 
 #if defined(OS_USE_RTOS_PORT_TIMER)
@@ -232,6 +254,19 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+
+      // A deferred call still in the daemon queue refers to this
+      // object; mark it as stopped, so the call is dropped, and wait
+      // for the daemon to pass over it.
+      state_ = state::stopped;
+      while (deferred_)
+        {
+          sysclock.sleep_for (1);
+        }
+
+#endif
+
 #endif
       state_ = state::destroyed;
     }
@@ -268,7 +303,8 @@ namespace os
 
       period_ = period;
 
-      timer_node_.timestamp = clock_->steady_now () + period;
+      deadline_ = clock_->steady_now () + period;
+      timer_node_.timestamp = clock::coalesce (deadline_, slack_);
 
         {
           // ----- Enter critical section -------------------------------------
@@ -278,6 +314,9 @@ namespace os
           timer_node_.unlink ();
 
           clock_->steady_list ().link (timer_node_);
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE)
+          clock_->internal_program_compare ();
+#endif
           // ----- Exit critical section --------------------------------------
         }
       res = result::ok;
@@ -350,8 +389,10 @@ namespace os
 
       if (type_ == run::periodic)
         {
-          // Re-arm the timer for the next period.
-          timer_node_.timestamp += period_;
+          // Re-arm the timer for the next period, from the
+          // nominal deadline, so the slack does not add up.
+          deadline_ += period_;
+          timer_node_.timestamp = clock::coalesce (deadline_, slack_);
 
           // No need for critical section in ISR.
           clock_->steady_list ().link (timer_node_);
@@ -365,17 +406,135 @@ namespace os
       trace::puts (name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+
+      if (run_in_thread_)
+        {
+          // Defer the call to the daemon thread; expirations that
+          // occur while a call is still pending are merged into it.
+          if (!deferred_ && os_timer_daemon_ != nullptr
+              && os_timer_daemon_->post (internal_run_deferred_, this)
+                  == result::ok)
+            {
+              deferred_ = true;
+            }
+          return;
+        }
+
+#endif
+
       // Call the user function.
       func_ (func_args_);
     }
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+
+    /**
+     * @details
+     * Runs on the daemon thread, for the items posted by the
+     * clock interrupt. The timer members are read before clearing
+     * the pending flag, since afterwards the destructor may
+     * return and the object may be gone.
+     */
+    void
+    timer::internal_run_deferred_ (void* args)
+    {
+      timer* tm = static_cast<timer*> (args);
+
+      bool run = (tm->state_ != state::stopped);
+      func_t func = tm->func_;
+      func_args_t func_args = tm->func_args_;
+
+      tm->deferred_ = false;
+
+      if (run)
+        {
+          func (func_args);
+        }
+    }
+
+#endif
+
   /**
    * @endcond
    */
 
+#endif
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+    /**
+     * @details
+     * The daemon is a work queue, created at startup, right after
+     * the idle thread; its worker runs the functions of the timers
+     * created with `tm_run_in_thread`, in expiration order, and
+     * all expirations pending when it wakes up are handled in
+     * a single batch.
+     *
+     * Its priority, queue size and stack size are configured by
+     * `OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY`,
+     * `OS_INTEGER_RTOS_TIMER_DAEMON_QUEUE_SIZE` and
+     * `OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES`.
+     *
+     * If the queue is full, the expiration is lost for that period.
+     */
+    work_queue*
+    timer::daemon (void)
+    {
+      return os_timer_daemon_;
+    }
+
 #endif
 
   // --------------------------------------------------------------------------
 
   } /* namespace rtos */
 } /* namespace os */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+using namespace os::rtos;
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#pragma clang diagnostic ignored "-Wmissing-variable-declarations"
+#endif
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+using timer_daemon = work_queue_inclusive<
+    OS_INTEGER_RTOS_TIMER_DAEMON_QUEUE_SIZE,
+    OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES>;
+static std::aligned_storage<sizeof(timer_daemon), alignof(timer_daemon)>::type os_timer_daemon_storage_;
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+#pragma GCC diagnostic pop
+
+void
+__attribute__((weak))
+os_startup_create_thread_timer_daemon (void)
+{
+  work_queue::attributes attr;
+  attr.th_priority = OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY;
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+  // Constructed in place, to not register any destructor.
+  os_timer_daemon_ = new (&os_timer_daemon_storage_) timer_daemon
+    { "timer", attr };
+
+#else
+
+  attr.th_stack_size_bytes = OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES;
+
+  // Never deallocated; the daemon lives as long as the scheduler.
+  os_timer_daemon_ = new work_queue
+    { "timer", OS_INTEGER_RTOS_TIMER_DAEMON_QUEUE_SIZE, attr };
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+}
+
+#endif
@@ -0,0 +1,869 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/utils/copy.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class topic::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts, or the slow subscribers policy) to the topic.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @var topic::policy_t topic::attributes::tp_policy
+     * @details
+     * With `policy::drop_oldest` (the default) publishing never waits
+     * and the subscribers that fall behind by more than the capacity
+     * lose the oldest messages; with `policy::block` the publishers
+     * wait for the slowest subscriber.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const topic::attributes topic::initializer;
+
+    constexpr topic::index_t topic::max_capacity;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class topic
+     * @details
+     * A topic delivers each message to all its subscribers, for example
+     * the same sensor readings to a logger, to the network and to the
+     * display, without one message queue and one copy per consumer.
+     *
+     * The messages are stored in a ring; publishing copies the message
+     * once, at the position given by a sequence number, and wakes up
+     * all waiting subscribers in one batch, so the cost does not
+     * depend on the number of subscribers. Each subscriber keeps
+     * the sequence number of the next message to read, and can
+     * copy the message out or reference it in place until `release()`.
+     *
+     * When the ring is full, the `tp_policy` attribute selects between
+     * dropping the oldest message, counted as lost by the subscribers
+     * that did not read it, and blocking the publisher until the
+     * slowest subscriber reads it. Only the blocking policy needs
+     * to know the slowest cursor, and it is searched only when
+     * the ring looks full.
+     *
+     * Usually the storage is provided by the `topic_inclusive<T, N>`
+     * template.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * topic_inclusive<my_sample_t, 8> tp { "sensor" };
+     *
+     * void
+     * producer (const my_sample_t& sample)
+     * {
+     *   tp.publish (sample);
+     * }
+     *
+     * void
+     * logger (void)
+     * {
+     *   topic_inclusive<my_sample_t, 8>::subscriber sub { tp };
+     *   my_sample_t sample;
+     *   for (;;)
+     *     {
+     *       sub.receive (&sample);
+     *       // ...
+     *     }
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a named topic object
+     * with the ring of _capacity_ messages of _msg_size_bytes_ each,
+     * at _storage_, and attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    topic::topic (const char* name, void* storage, std::size_t msg_size_bytes,
+                  std::size_t capacity, const attributes& attr) :
+        object_named_system
+          { name }, //
+        ring_ (static_cast<char*> (storage)), //
+        msg_size_bytes_ (msg_size_bytes), //
+        capacity_ (static_cast<index_t> (capacity)), //
+        policy_ (attr.tp_policy)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s() @%p %s %u %u\n", __func__, this, this->name (),
+                     static_cast<unsigned int> (capacity),
+                     static_cast<unsigned int> (msg_size_bytes));
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      os_assert_throw(storage != nullptr, EINVAL);
+      os_assert_throw(msg_size_bytes > 0, EINVAL);
+      os_assert_throw(capacity > 0 && capacity <= max_capacity, EINVAL);
+      os_assert_throw(attr.tp_policy <= policy::block, EINVAL);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+
+      // The intrusive list is not initialised by its constructor.
+      subscribers_.clear ();
+    }
+
+    /**
+     * @details
+     * It is safe to destroy a topic which has no subscribers and
+     * upon which no threads are currently blocked.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    topic::~topic ()
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // There must be no subscribers and no threads waiting for this topic.
+      assert(subscribers_.empty ());
+      assert(send_list_.empty ());
+      assert(receive_list_.empty ());
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    topic::internal_full_ (void)
+    {
+      if (policy_ != policy::block || count_ == 0)
+        {
+          return false;
+        }
+
+      if (static_cast<sequence_t> (seq_ - tail_) < capacity_)
+        {
+          return false;
+        }
+
+      // The cached cursor may be old, search the slowest subscriber.
+      sequence_t lag = 0;
+      for (auto&& sub : subscribers_)
+        {
+          sequence_t l = static_cast<sequence_t> (seq_ - sub.next_);
+          if (l > lag)
+            {
+              lag = l;
+            }
+        }
+      tail_ = static_cast<sequence_t> (seq_ - lag);
+
+      return (lag >= capacity_);
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    topic::internal_try_publish_ (const void* msg, std::size_t nbytes)
+    {
+      if (internal_full_ ())
+        {
+          return false;
+        }
+
+      sequence_t seq = seq_;
+      utils::copy_bytes (internal_slot_ (seq), msg, nbytes);
+      seq_ = static_cast<sequence_t> (seq + 1);
+
+      // Wake-up all waiting subscribers, with a single reschedule.
+      receive_list_.resume_all ();
+
+      return true;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    topic::internal_try_receive_ (subscriber& sub, void* msg,
+                                  std::size_t nbytes, const void** slot)
+    {
+      sub.internal_skip_lost_ ();
+
+      if (sub.next_ == seq_)
+        {
+          return false;
+        }
+
+      if (slot != nullptr)
+        {
+          // The cursor advances in release().
+          *slot = internal_slot_ (sub.next_);
+          sub.held_ = true;
+
+          return true;
+        }
+
+      utils::copy_bytes (msg, internal_slot_ (sub.next_),
+                         nbytes < msg_size_bytes_ ? nbytes : msg_size_bytes_);
+      sub.next_ = static_cast<sequence_t> (sub.next_ + 1);
+
+      if (policy_ == policy::block)
+        {
+          // Wake-up one publisher, if any; it checks again if the
+          // slowest subscriber advanced.
+          send_list_.resume_one ();
+        }
+
+      return true;
+    }
+
+    result_t
+    topic::internal_publish_ (const void* msg, std::size_t nbytes, bool timed,
+                              clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msg != nullptr, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EINVAL);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_publish_ (msg, nbytes))
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_try_publish_ (msg, nbytes))
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the topic send waiting list,
+              // and, for timed publishes, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (send_list_, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (send_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the topic send waiting list,
+          // if not already removed by a subscriber, and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_TOPIC)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_TOPIC)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    result_t
+    topic::internal_receive_ (subscriber& sub, void* msg, std::size_t nbytes,
+                              const void** slot, bool timed,
+                              clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_receive_ (sub, msg, nbytes, slot))
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_try_receive_ (sub, msg, nbytes, slot))
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the topic receive waiting list,
+              // and, for timed receives, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (receive_list_, node,
+                                                 clock_list, timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (receive_list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the topic receive waiting list,
+          // if not already removed by publish(), and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_TOPIC)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_TOPIC)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Copy _nbytes_ from _msg_ into the next slot of the ring and
+     * make it available to all subscribers. With `policy::block`,
+     * if the slowest subscriber did not read the oldest message,
+     * the current thread is suspended until it does.
+     *
+     * Without subscribers, the message is stored but nobody
+     * will receive it.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::publish (const void* msg, std::size_t nbytes)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg,
+                     static_cast<unsigned int> (nbytes), this, name ());
+#endif
+
+      return internal_publish_ (msg, nbytes, false, 0);
+    }
+
+    /**
+     * @details
+     * Identical to `publish()`, but, if the publisher would
+     * have to wait, return `EWOULDBLOCK`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::try_publish (const void* msg, std::size_t nbytes)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg,
+                     static_cast<unsigned int> (nbytes), this, name ());
+#endif
+
+      os_assert_err(msg != nullptr, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (internal_try_publish_ (msg, nbytes))
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Identical to `publish()`, but, if the publisher has to wait,
+     * wait at most _timeout_ for the slowest subscriber.
+     *
+     * The timeout is measured with the clock from the topic
+     * attributes (by default the SysTick clock).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::timed_publish (const void* msg, std::size_t nbytes,
+                          clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msg,
+                     static_cast<unsigned int> (nbytes),
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_publish_ (msg, nbytes, true, timeout);
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The subscriber starts with the next published message;
+     * the messages already in the ring are not received.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    topic::subscriber::subscriber (class topic& tp) :
+        topic_ (tp)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s() @%p %s\n", __func__, this, tp.name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      next_ = tp.seq_;
+      if (tp.count_ == 0)
+        {
+          tp.tail_ = next_;
+        }
+      tp.subscribers_.link (*this);
+      tp.count_ = static_cast<index_t> (tp.count_ + 1);
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * With `policy::block`, the publishers waiting for this
+     * subscriber are resumed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    topic::subscriber::~subscriber ()
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s() @%p %s\n", __func__, this, topic_.name ());
+#endif
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          links_.unlink ();
+          topic_.count_ = static_cast<index_t> (topic_.count_ - 1);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (topic_.policy_ == policy::block)
+        {
+          topic_.send_list_.resume_all ();
+        }
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    void
+    topic::subscriber::internal_skip_lost_ (void)
+    {
+      sequence_t lag = static_cast<sequence_t> (topic_.seq_ - next_);
+      if (lag > topic_.capacity_)
+        {
+          // The oldest messages were overwritten.
+          lost_ = static_cast<sequence_t> (lost_ + lag - topic_.capacity_);
+          next_ = static_cast<sequence_t> (topic_.seq_ - topic_.capacity_);
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Copy the next message into the buffer at _msg_. If there
+     * are no new messages, the current thread is suspended until
+     * a message is published.
+     *
+     * With `policy::drop_oldest`, if the subscriber fell behind
+     * by more than the capacity, the oldest messages are skipped
+     * and added to `lost()`.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::subscriber::receive (void* msg, std::size_t nbytes)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg,
+                     static_cast<unsigned int> (nbytes), this,
+                     topic_.name ());
+#endif
+
+      os_assert_err(msg != nullptr, EINVAL);
+      os_assert_err(nbytes >= topic_.msg_size_bytes_, EINVAL);
+      os_assert_err(!held_, EINVAL);
+
+      return topic_.internal_receive_ (*this, msg, nbytes, nullptr, false, 0);
+    }
+
+    /**
+     * @details
+     * Copy the next message into the buffer at _msg_, or
+     * return `EWOULDBLOCK` if there are no new messages.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::subscriber::try_receive (void* msg, std::size_t nbytes)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg,
+                     static_cast<unsigned int> (nbytes), this,
+                     topic_.name ());
+#endif
+
+      os_assert_err(msg != nullptr, EINVAL);
+      os_assert_err(nbytes >= topic_.msg_size_bytes_, EINVAL);
+      os_assert_err(!held_, EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (topic_.internal_try_receive_ (*this, msg, nbytes, nullptr))
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Identical to `receive()`, but, if there are no new messages,
+     * wait at most _timeout_ for a message to be published.
+     *
+     * The timeout is measured with the clock from the topic
+     * attributes (by default the SysTick clock).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::subscriber::timed_receive (void* msg, std::size_t nbytes,
+                                      clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msg,
+                     static_cast<unsigned int> (nbytes),
+                     static_cast<unsigned int> (timeout), this,
+                     topic_.name ());
+#endif
+
+      os_assert_err(msg != nullptr, EINVAL);
+      os_assert_err(nbytes >= topic_.msg_size_bytes_, EINVAL);
+      os_assert_err(!held_, EINVAL);
+
+      return topic_.internal_receive_ (*this, msg, nbytes, nullptr, true,
+                                       timeout);
+    }
+
+    /**
+     * @details
+     * Store into _slot_ the address of the next message, in the
+     * ring, without copying it. The message remains the next one
+     * until `release()`; with `policy::block` it is not overwritten,
+     * with `policy::drop_oldest` `release()` tells if it was.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::subscriber::receive_ref (const void** slot)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s() @%p %s\n", __func__, this, topic_.name ());
+#endif
+
+      os_assert_err(slot != nullptr, EINVAL);
+      os_assert_err(!held_, EINVAL);
+
+      return topic_.internal_receive_ (*this, nullptr, 0, slot, false, 0);
+    }
+
+    /**
+     * @details
+     * Store into _slot_ the address of the next message, or
+     * return `EWOULDBLOCK` if there are no new messages.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::subscriber::try_receive_ref (const void** slot)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s() @%p %s\n", __func__, this, topic_.name ());
+#endif
+
+      os_assert_err(slot != nullptr, EINVAL);
+      os_assert_err(!held_, EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (topic_.internal_try_receive_ (*this, nullptr, 0, slot))
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Identical to `receive_ref()`, but, if there are no new messages,
+     * wait at most _timeout_ for a message to be published.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::subscriber::timed_receive_ref (const void** slot,
+                                          clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this,
+                     topic_.name ());
+#endif
+
+      os_assert_err(slot != nullptr, EINVAL);
+      os_assert_err(!held_, EINVAL);
+
+      return topic_.internal_receive_ (*this, nullptr, 0, slot, true,
+                                       timeout);
+    }
+
+    /**
+     * @details
+     * Advance the cursor past the referenced message. With
+     * `policy::drop_oldest`, `EOVERFLOW` tells that a publisher
+     * overwrote the message while it was referenced, and its
+     * content cannot be trusted.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::subscriber::release (void)
+    {
+#if defined(OS_TRACE_RTOS_TOPIC)
+      trace::printf ("%s() @%p %s\n", __func__, this, topic_.name ());
+#endif
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (!held_)
+        {
+          return EINVAL;
+        }
+      held_ = false;
+
+      bool overwritten = static_cast<sequence_t> (topic_.seq_ - next_)
+          > topic_.capacity_;
+      next_ = static_cast<sequence_t> (next_ + 1);
+
+      if (topic_.policy_ == policy::block)
+        {
+          topic_.send_list_.resume_one ();
+        }
+
+      if (overwritten)
+        {
+          return EOVERFLOW;
+        }
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    topic::subscriber::available (void) const
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      sequence_t lag = static_cast<sequence_t> (topic_.seq_ - next_);
+      return lag < topic_.capacity_ ? lag : topic_.capacity_;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
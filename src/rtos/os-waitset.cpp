@@ -0,0 +1,576 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class wait_set::attributes
+     * @details
+     * Allow to assign a name and custom attributes (like the clock
+     * used for timeouts) to the wait set.
+     *
+     * To simplify access, the member variables are public and do not
+     * require accessors or mutators.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const wait_set::attributes wait_set::initializer;
+
+    constexpr wait_set::index_t wait_set::max_size;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class wait_set
+     * @details
+     * A wait set allows a single thread to wait for any of several
+     * objects, instead of using one thread per object, or polling
+     * them with `try_*()` calls.
+     *
+     * Semaphores, message queues, event flags and memory pools can
+     * be added to the set, up to `OS_INTEGER_RTOS_WAIT_SET_MAX_SIZE`
+     * objects. While waiting, the thread is linked to the waiting
+     * list of each object, via nodes stored in the wait set,
+     * and is resumed by the first object that is posted.
+     *
+     * The wait set only reports which object is ready, it does
+     * not consume anything; the caller must then use the non blocking
+     * call of that object (`try_wait()`, `try_receive()`,
+     * `try_alloc()`), which may still fail if another thread was faster.
+     * When several objects are ready, the one added first is reported.
+     *
+     * Only one thread at a time may wait on a wait set, and objects
+     * cannot be added while waiting.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * semaphore_binary sem { "sem", 0 };
+     * message_queue_typed<uint32_t> mq { "mq", 4 };
+     *
+     * void
+     * func (void)
+     * {
+     *   wait_set ws { "ws" };
+     *   ws.add (sem);
+     *   ws.add (mq);
+     *
+     *   wait_set::index_t index;
+     *   for (;;)
+     *     {
+     *       ws.wait (&index);
+     *       if (index == 0)
+     *         {
+     *           sem.try_wait ();
+     *           // ...
+     *         }
+     *       else
+     *         {
+     *           uint32_t msg;
+     *           mq.try_receive (&msg);
+     *           // ...
+     *         }
+     *     }
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified, but inspired
+     *  by `poll()`.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise an empty named wait set
+     * with attributes referenced by _attr_.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    wait_set::wait_set (const char* name, const attributes& attr) :
+        object_named_system
+          { name }
+    {
+#if defined(OS_TRACE_RTOS_WAITSET)
+      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
+    }
+
+    /**
+     * @details
+     * It is safe to destroy a wait set on which no thread is
+     * waiting. The objects are not affected.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    wait_set::~wait_set ()
+    {
+#if defined(OS_TRACE_RTOS_WAITSET)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // There must be no thread waiting on this wait set.
+      assert(waiter_ == nullptr);
+    }
+
+    result_t
+    wait_set::internal_add_ (kind_t kind, void* object,
+                             internal::waiting_threads_list* list,
+                             flags::mask_t mask, flags::mode_t mode)
+    {
+#if defined(OS_TRACE_RTOS_WAITSET)
+      trace::printf ("%s(%p) @%p %s\n", __func__, object, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (waiter_ != nullptr)
+        {
+          return EBUSY;
+        }
+
+      if (size_ >= max_size)
+        {
+          return EAGAIN;
+        }
+
+      entry& e = entries_[size_];
+      e.list = list;
+      e.object = object;
+      e.mask = mask;
+      e.mode = mode;
+      e.kind = kind;
+
+      // Used by event_flags::raise() to skip unrelated waiters.
+      e.node.flags_mask_ = mask;
+      e.node.flags_mode_ = mode;
+
+      ++size_;
+
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+    /**
+     * @details
+     * The semaphore is ready when its count is positive, i.e. when
+     * `semaphore::try_wait()` would succeed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::add (semaphore& sem)
+    {
+      return internal_add_ (kind::semaphore, &sem, &sem.list_, 0, 0);
+    }
+
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @details
+     * The message queue is ready when it is not empty, i.e. when
+     * `message_queue::try_receive()` would succeed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::add (message_queue& mq)
+    {
+      return internal_add_ (kind::message_queue, &mq, &mq.receive_list_, 0,
+                            0);
+    }
+
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+    /**
+     * @details
+     * The event flags object is ready when the expected flags are
+     * raised, i.e. when `event_flags::try_wait()` with the same
+     * _mask_ and _mode_ would succeed.
+     *
+     * The flags are never cleared by the wait set.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::add (event_flags& evf, flags::mask_t mask, flags::mode_t mode)
+    {
+      return internal_add_ (
+          kind::event_flags, &evf, &evf.list_, mask,
+          static_cast<flags::mode_t> (mode & ~flags::mode::clear));
+    }
+
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+
+    /**
+     * @details
+     * The memory pool is ready when it has free blocks, i.e. when
+     * `memory_pool::try_alloc()` would succeed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::add (memory_pool& mp)
+    {
+      return internal_add_ (kind::memory_pool, &mp, &mp.list_, 0, 0);
+    }
+
+#endif
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::clear (void)
+    {
+#if defined(OS_TRACE_RTOS_WAITSET)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (waiter_ != nullptr)
+        {
+          return EBUSY;
+        }
+
+      size_ = 0;
+
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Must be called from inside an interrupts critical section.
+     */
+    bool
+    wait_set::internal_check_ready_ (index_t* index)
+    {
+      for (index_t i = 0; i < size_; ++i)
+        {
+          entry& e = entries_[i];
+          bool ready = false;
+
+          switch (e.kind)
+            {
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+            case kind::semaphore:
+              ready = (static_cast<semaphore*> (e.object)->value () > 0);
+              break;
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+            case kind::message_queue:
+              ready = !static_cast<message_queue*> (e.object)->empty ();
+              break;
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+            case kind::event_flags:
+              ready =
+                  static_cast<event_flags*> (e.object)->event_flags_.check_raised (
+                      e.mask, nullptr, e.mode);
+              break;
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+            case kind::memory_pool:
+              ready = !static_cast<memory_pool*> (e.object)->full ();
+              break;
+#endif
+
+            default:
+              break;
+            }
+
+          if (ready)
+            {
+              if (index != nullptr)
+                {
+                  *index = i;
+                }
+              return true;
+            }
+        }
+
+      return false;
+    }
+
+    result_t
+    wait_set::internal_wait_ (index_t* index, bool timed,
+                              clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      thread& crt_thread = this_thread::thread ();
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (size_ == 0)
+            {
+              return EINVAL;
+            }
+
+          if (waiter_ != nullptr)
+            {
+              return EBUSY;
+            }
+
+          if (internal_check_ready_ (index))
+            {
+              return result::ok;
+            }
+
+          waiter_ = &crt_thread;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // The waiting nodes are stored in the wait set, one per object;
+      // the first one is registered in the thread, the others are
+      // only linked to the object lists.
+      for (index_t i = 0; i < size_; ++i)
+        {
+          entries_[i].node.thread_ = &crt_thread;
+        }
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp =
+          timed ? (clock_->steady_now () + timeout) : 0;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      result_t res = result::ok;
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_check_ready_ (index))
+                {
+                  waiter_ = nullptr;
+                  return result::ok;
+                }
+
+              // Add this thread to the first object waiting list, and,
+              // for timed waits, to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (*entries_[0].list,
+                                                 entries_[0].node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (*entries_[0].list,
+                                                 entries_[0].node);
+                }
+              // state::suspended set in above link().
+
+              // Add this thread to all other waiting lists.
+              for (index_t i = 1; i < size_; ++i)
+                {
+                  entries_[i].list->link (entries_[i].node);
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              // Remove the thread from the other waiting lists,
+              // if not already removed by a post.
+              for (index_t i = 1; i < size_; ++i)
+                {
+                  entries_[i].node.unlink ();
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          // Remove the thread from the first waiting list,
+          // if not already removed, and from the clock
+          // timeout list, if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (entries_[0].node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (entries_[0].node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_WAITSET)
+              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+#endif
+              res = EINTR;
+              break;
+            }
+
+          if (timed && clock_->steady_now () >= timeout_timestamp)
+            {
+              interrupts::critical_section ics;
+
+              // Give a last chance, the object might have been posted
+              // just before the timeout.
+              if (internal_check_ready_ (index))
+                {
+                  break;
+                }
+
+#if defined(OS_TRACE_RTOS_WAITSET)
+              trace::printf ("%s() ETIMEDOUT @%p %s\n", __func__, this,
+                             name ());
+#endif
+              res = ETIMEDOUT;
+              break;
+            }
+        }
+
+      waiter_ = nullptr;
+      return res;
+    }
+
+    /**
+     * @details
+     * If one of the objects is ready, return its index at once.
+     * Otherwise, the current thread is suspended until any of the
+     * objects is posted.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::wait (index_t* index)
+    {
+#if defined(OS_TRACE_RTOS_WAITSET)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      return internal_wait_ (index, false, 0);
+    }
+
+    /**
+     * @details
+     * Check the objects without blocking.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::try_wait (index_t* index)
+    {
+#if defined(OS_TRACE_RTOS_WAITSET)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (size_ == 0)
+        {
+          return EINVAL;
+        }
+
+      if (internal_check_ready_ (index))
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * If one of the objects is ready, return its index at once.
+     * Otherwise, the current thread is suspended until any of the
+     * objects is posted, or the timeout expires.
+     *
+     * The timeout is measured with the clock from the wait set
+     * attributes (by default the SysTick clock).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::timed_wait (index_t* index, clock::duration_t timeout)
+    {
+#if defined(OS_TRACE_RTOS_WAITSET)
+      trace::printf ("%s(%u) @%p %s\n", __func__,
+                     static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      return internal_wait_ (index, true, timeout);
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
@@ -0,0 +1,337 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class work_queue::attributes
+     * @details
+     * Allow to define the storage and the worker thread
+     * characteristics.
+     */
+
+    /**
+     * @details
+     * This variable is used by the default constructor.
+     */
+    const work_queue::attributes work_queue::initializer;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class work_queue
+     * @details
+     * A work queue allows interrupt handlers to defer the
+     * non urgent part of their processing (the _bottom half_)
+     * to a thread, keeping the handlers short.
+     *
+     * Handlers post `{func, args}` items with `post()`, in constant
+     * time; the worker thread takes them out of the ring in FIFO
+     * order, in batches, and calls them in thread context.
+     *
+     * A single work queue can be shared by multiple drivers,
+     * replacing multiple dedicated threads and their stacks.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * work_queue_inclusive<16> wq { "wq" };
+     *
+     * void
+     * rx_done (void* args)
+     * {
+     *   // Process the received data.
+     * }
+     *
+     * void
+     * USART1_IRQHandler (void)
+     * {
+     *   // Acknowledge the interrupt...
+     *   wq.post (rx_done, &usart1);
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified.
+     */
+
+    /**
+     * @details
+     * This constructor shall initialise a work queue object
+     * with attributes referenced by _attr_.
+     * If the attributes specified by _attr_ are modified later,
+     * the work queue attributes shall not be affected.
+     *
+     * The worker thread is created and started.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    work_queue::work_queue (std::size_t items, const attributes& attr) :
+        work_queue
+          { nullptr, items, attr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * This constructor shall initialise a named work queue object
+     * with attributes referenced by _attr_.
+     * If the attributes specified by _attr_ are modified later,
+     * the work queue attributes shall not be affected.
+     *
+     * The worker thread is created and started.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    work_queue::work_queue (const char* name, std::size_t items,
+                            const attributes& attr) :
+        work_queue
+          { name, items, attr.wq_queue_address, attr.th_stack_address,
+              attr.th_stack_size_bytes, attr }
+    {
+      ;
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    work_queue::work_queue (const char* name, std::size_t items, item* queue,
+                            void* stack_address, std::size_t stack_size_bytes,
+                            const attributes& attr) :
+        object_named_system
+          { name }, //
+        size_ (items + 1), //
+        queue_ (internal_allocate_queue_ (items + 1, queue)), //
+        allocated_queue_ (queue == nullptr), //
+        worker_
+          { name, internal_run_, this, internal_thread_attributes_ (
+              attr, stack_address, stack_size_bytes) }
+    {
+#if defined(OS_TRACE_RTOS_WORKQUEUE)
+      trace::printf ("%s() @%p %s %u\n", __func__, this, this->name (),
+                     items);
+#endif
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The worker thread is killed; pending items are discarded.
+     * If the items storage was dynamically allocated, it is
+     * deallocated.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    work_queue::~work_queue ()
+    {
+#if defined(OS_TRACE_RTOS_WORKQUEUE)
+      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      worker_.kill ();
+
+      if (allocated_queue_)
+        {
+          memory::allocator<item> ().deallocate (
+              const_cast<item*> (queue_), size_);
+        }
+    }
+
+    /**
+     * @details
+     * Add the item at the end of the ring and notify the worker
+     * thread. The function does not block, and if the ring is
+     * full, it returns `EAGAIN`.
+     *
+     * The ring is written only by the posters, in a very short
+     * critical section, and read only by the worker thread, without
+     * locking.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    work_queue::post (func_t func, func_args_t args)
+    {
+#if defined(OS_TRACE_RTOS_WORKQUEUE)
+      trace::printf ("%s(%p,%p) @%p %s\n", __func__, func, args, this,
+                     name ());
+#endif
+
+      os_assert_err(func != nullptr, EINVAL);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          std::size_t tail = tail_;
+          std::size_t next = tail + 1;
+          if (next == size_)
+            {
+              next = 0;
+            }
+
+          if (next == head_)
+            {
+              return EAGAIN;
+            }
+
+          queue_[tail].func = func;
+          queue_[tail].args = args;
+
+          // Publish the item only after it is complete.
+          tail_ = next;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      worker_.flags_raise (1);
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    work_queue::length (void) const
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      std::size_t tail = tail_;
+      std::size_t head = head_;
+
+      return (tail >= head) ? (tail - head) : (tail + size_ - head);
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    thread::attributes
+    work_queue::internal_thread_attributes_ (const attributes& attr,
+                                             void* stack_address,
+                                             std::size_t stack_size_bytes)
+    {
+      thread::attributes th_attr;
+
+      th_attr.th_stack_address = stack_address;
+      th_attr.th_stack_size_bytes = stack_size_bytes;
+      th_attr.th_priority = attr.th_priority;
+
+      return th_attr;
+    }
+
+    volatile work_queue::item*
+    work_queue::internal_allocate_queue_ (std::size_t size, item* queue)
+    {
+      if (queue != nullptr)
+        {
+          return queue;
+        }
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+      assert(queue != nullptr);
+      return nullptr;
+
+#else
+
+      return memory::allocator<item> ().allocate (size);
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+    }
+
+    void*
+    work_queue::internal_run_ (void* args)
+    {
+      work_queue* wq = static_cast<work_queue*> (args);
+
+      while (true)
+        {
+          // Wait for items, the flags are raised by post().
+          this_thread::flags_wait (1);
+
+          wq->internal_drain_ ();
+        }
+
+      return nullptr;
+    }
+
+    void
+    work_queue::internal_drain_ (void)
+    {
+      // Process all items posted so far, including those posted
+      // while processing the batch.
+      while (head_ != tail_)
+        {
+          std::size_t head = head_;
+          std::size_t tail = tail_;
+
+          while (head != tail)
+            {
+              func_t func = queue_[head].func;
+              func_args_t args = queue_[head].args;
+
+              if (++head == size_)
+                {
+                  head = 0;
+                }
+              // Free the slot before calling the function,
+              // it might post again.
+              head_ = head;
+
+              func (args);
+            }
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
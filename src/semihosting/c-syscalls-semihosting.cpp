@@ -81,12 +81,41 @@
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+
+#if !defined(OS_INTEGER_SEMIHOSTING_BUFFERS)
+#define OS_INTEGER_SEMIHOSTING_BUFFERS (4)
+#endif
+
+// Buffer used to group the small reads and writes of a file,
+// each host call halts the core until the debugger services it.
+// It holds either data to be written (pending) or data read
+// ahead (len - next bytes not yet consumed).
+struct fdbuf
+{
+  bool used;
+  bool writing;
+  bool tty;
+  size_t len;
+  size_t next;
+  char data[OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES];
+};
+
+static struct fdbuf buffers[OS_INTEGER_SEMIHOSTING_BUFFERS];
+
+#endif /* defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES) */
+
 // Struct used to keep track of the file position, just so we
 // can implement fseek(fh,x,SEEK_CUR).
 struct fdent
 {
   int handle;
   int pos;
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  // The position is the one seen by the application; with
+  // data read ahead, the host position is further.
+  struct fdbuf* buf;
+#endif
 };
 
 /*
@@ -184,6 +213,140 @@ __semihosting_checkerror (int result)
   return result;
 }
 
+// Read from the host, at the current host position.
+static ssize_t
+__semihosting_host_read (int handle, void* buf, size_t nbyte)
+{
+  int block[3];
+  block[0] = handle;
+  block[1] = (int) buf;
+  block[2] = nbyte;
+
+  int res;
+  // Returns the number of bytes *not* read.
+  res = __semihosting_checkerror (call_host (SEMIHOSTING_SYS_READ, block));
+  if (res == -1)
+    {
+      return res;
+    }
+
+  /* res == nbyte is not an error,
+   at least if we want feof() to work.  */
+  return nbyte - res;
+}
+
+// Write to the host, at the current host position.
+static ssize_t
+__semihosting_host_write (int handle, const void* buf, size_t nbyte)
+{
+  int block[3];
+
+  block[0] = handle;
+  block[1] = (int) buf;
+  block[2] = nbyte;
+
+  // Returns the number of bytes *not* written.
+  int res;
+  res = __semihosting_checkerror (call_host (SEMIHOSTING_SYS_WRITE, block));
+  /* Clearly an error. */
+  if (res < 0)
+    {
+      return -1;
+    }
+
+  // Did we write 0 bytes?
+  // Retrieve errno for just in case.
+  if ((nbyte - res) == 0)
+    {
+      return __semihosting_error (0);
+    }
+
+  return (nbyte - res);
+}
+
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+
+// Get a free buffer, or nullptr if all are used; the file
+// is then unbuffered.
+static struct fdbuf*
+__semihosting_newbuf (int handle)
+{
+  for (int i = 0; i < OS_INTEGER_SEMIHOSTING_BUFFERS; i++)
+    {
+      struct fdbuf* b = &buffers[i];
+      if (!b->used)
+        {
+          b->used = true;
+          b->writing = false;
+          b->len = 0;
+          b->next = 0;
+          b->tty = (call_host (SEMIHOSTING_SYS_ISTTY, &handle) == 1);
+          return b;
+        }
+    }
+  return nullptr;
+}
+
+// Write the pending data to the host, or drop the data read
+// ahead, moving the host position back to the file position.
+static int
+__semihosting_flush (struct fdent* pfd)
+{
+  struct fdbuf* b = pfd->buf;
+  if (b == nullptr)
+    {
+      return 0;
+    }
+
+  int res = 0;
+  if (b->writing)
+    {
+      const char* p = b->data;
+      size_t n = b->len;
+      while (n > 0)
+        {
+          ssize_t ret = __semihosting_host_write (pfd->handle, p, n);
+          if (ret <= 0)
+            {
+              res = -1;
+              break;
+            }
+          p += ret;
+          n -= ret;
+        }
+    }
+  else if ((b->next < b->len) && !b->tty)
+    {
+      int block[2];
+      block[0] = pfd->handle;
+      block[1] = pfd->pos;
+      res = __semihosting_checkerror (call_host (SEMIHOSTING_SYS_SEEK, block));
+      if (res > 0)
+        {
+          res = 0;
+        }
+    }
+
+  b->len = 0;
+  b->next = 0;
+  return res;
+}
+
+// Flush all buffers, for sync() and exit.
+static void
+__semihosting_flush_all (void)
+{
+  for (int i = 0; i < OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES; i++)
+    {
+      if (openfiles[i].handle != -1)
+        {
+          __semihosting_flush (&openfiles[i]);
+        }
+    }
+}
+
+#endif /* defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES) */
+
 /* fd, is a user file descriptor. */
 static int
 __semihosting_lseek (int fd, int ptr, int dir)
@@ -198,6 +361,13 @@ __semihosting_lseek (int fd, int ptr, int dir)
       return -1;
     }
 
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  if (__semihosting_flush (pfd) == -1)
+    {
+      return -1;
+    }
+#endif
+
   /* Valid whence? */
   if ((dir != SEEK_CUR) && (dir != SEEK_SET) && (dir != SEEK_END))
     {
@@ -264,6 +434,14 @@ __semihosting_stat (int fd, struct stat* st)
       return -1;
     }
 
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  // The size must include the pending data.
+  if (__semihosting_flush (pfd) == -1)
+    {
+      return -1;
+    }
+#endif
+
   /* Always assume a character device,
    with 1024 byte blocks. */
   st->st_mode |= S_IFCHR;
@@ -359,6 +537,9 @@ __posix_open (const char* path, int oflag, ...)
     {
       openfiles[fd].handle = fh;
       openfiles[fd].pos = 0;
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+      openfiles[fd].buf = __semihosting_newbuf (fh);
+#endif
       return fd;
     }
   else
@@ -378,6 +559,16 @@ __posix_close (int fildes)
       return -1;
     }
 
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  if (pfd->buf != nullptr)
+    {
+      // The data is lost anyway, the error is not reported.
+      __semihosting_flush (pfd);
+      pfd->buf->used = false;
+      pfd->buf = nullptr;
+    }
+#endif
+
   // Handle stderr == stdout.
   if ((fildes == 1 || fildes == 2)
       && (openfiles[1].handle == openfiles[2].handle))
@@ -419,24 +610,60 @@ __posix_read (int fildes, void* buf, size_t nbyte)
       return -1;
     }
 
-  int block[3];
-  block[0] = pfd->handle;
-  block[1] = (int) buf;
-  block[2] = nbyte;
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
 
-  int res;
-  // Returns the number of bytes *not* written.
-  res = __semihosting_checkerror (call_host (SEMIHOSTING_SYS_READ, block));
+  struct fdbuf* b = pfd->buf;
+  if (b != nullptr)
+    {
+      if (b->writing)
+        {
+          if (__semihosting_flush (pfd) == -1)
+            {
+              return -1;
+            }
+          b->writing = false;
+        }
+
+      // Terminal input is not read ahead, it would wait for
+      // more lines than requested; large requests go directly
+      // to the user buffer.
+      if ((b->next == b->len) && !b->tty
+          && (nbyte < OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES))
+        {
+          ssize_t ret = __semihosting_host_read (pfd->handle, b->data,
+                                                 sizeof(b->data));
+          if (ret == -1)
+            {
+              return -1;
+            }
+          b->len = ret;
+          b->next = 0;
+        }
+
+      if (b->next < b->len)
+        {
+          size_t n = b->len - b->next;
+          if (n > nbyte)
+            {
+              n = nbyte;
+            }
+          memcpy (buf, &b->data[b->next], n);
+          b->next += n;
+          pfd->pos += n;
+          return n;
+        }
+    }
+
+#endif /* defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES) */
+
+  ssize_t res = __semihosting_host_read (pfd->handle, buf, nbyte);
   if (res == -1)
     {
       return res;
     }
 
-  pfd->pos += nbyte - res;
-
-  /* res == nbyte is not an error,
-   at least if we want feof() to work.  */
-  return nbyte - res;
+  pfd->pos += res;
+  return res;
 }
 
 ssize_t
@@ -450,31 +677,60 @@ __posix_write (int fildes, const void* buf, size_t nbyte)
       return -1;
     }
 
-  int block[3];
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
 
-  block[0] = pfd->handle;
-  block[1] = (int) buf;
-  block[2] = nbyte;
-
-  // Returns the number of bytes *not* written.
-  int res;
-  res = __semihosting_checkerror (call_host (SEMIHOSTING_SYS_WRITE, block));
-  /* Clearly an error. */
-  if (res < 0)
+  struct fdbuf* b = pfd->buf;
+  if (b != nullptr)
     {
-      return -1;
+      if (!b->writing)
+        {
+          // Drop the data read ahead.
+          if (__semihosting_flush (pfd) == -1)
+            {
+              return -1;
+            }
+          b->writing = true;
+        }
+
+      if ((b->len + nbyte) > sizeof(b->data))
+        {
+          if (__semihosting_flush (pfd) == -1)
+            {
+              return -1;
+            }
+        }
+
+      // Data that does not fit in the buffer is written directly.
+      if (nbyte < sizeof(b->data))
+        {
+          memcpy (&b->data[b->len], buf, nbyte);
+          b->len += nbyte;
+          pfd->pos += nbyte;
+
+          // Terminals are line buffered.
+          if ((b->len == sizeof(b->data))
+              || (b->tty && (memchr (buf, '\n', nbyte) != nullptr)))
+            {
+              // Errors are reported, even if the data was accepted.
+              if (__semihosting_flush (pfd) == -1)
+                {
+                  return -1;
+                }
+            }
+          return nbyte;
+        }
     }
 
-  pfd->pos += nbyte - res;
+#endif /* defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES) */
 
-  // Did we write 0 bytes?
-  // Retrieve errno for just in case.
-  if ((nbyte - res) == 0)
+  ssize_t res = __semihosting_host_write (pfd->handle, buf, nbyte);
+  if (res == -1)
     {
-      return __semihosting_error (0);
+      return res;
     }
 
-  return (nbyte - res);
+  pfd->pos += res;
+  return res;
 }
 
 off_t
@@ -630,6 +886,40 @@ __posix_clock (void)
   return timeval;
 }
 
+int
+__posix_clock_gettime (clockid_t clock_id, struct timespec* tp)
+{
+  if (tp == NULL)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  if (clock_id == CLOCK_REALTIME)
+    {
+      // Ask the host for the seconds since the Unix epoch.
+      tp->tv_sec = call_host (SEMIHOSTING_SYS_TIME, NULL);
+      tp->tv_nsec = 0;
+
+      return 0;
+    }
+
+#if defined(CLOCK_MONOTONIC)
+  if (clock_id == CLOCK_MONOTONIC)
+    {
+      // The host clock ticks at 100Hz.
+      clock_t cs = (clock_t) call_host (SEMIHOSTING_SYS_CLOCK, NULL);
+      tp->tv_sec = cs / 100;
+      tp->tv_nsec = (cs % 100) * 10000000L;
+
+      return 0;
+    }
+#endif
+
+  errno = EINVAL;
+  return -1;
+}
+
 clock_t
 __posix_times (struct tms* buf)
 {
@@ -682,7 +972,11 @@ __posix_rmdir (const char* path)
 void
 __posix_sync (void)
 {
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  __semihosting_flush_all ();
+#else
   errno = ENOSYS; // Not implemented
+#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -822,6 +1116,14 @@ __posix_recvfrom (int socket, void* buffer, size_t length, int flags,
   return -1;
 }
 
+int
+__posix_recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags, struct timespec* timeout)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
 ssize_t
 __posix_recvmsg (int socket, struct msghdr* message, int flags)
 {
@@ -836,6 +1138,14 @@ __posix_send (int socket, const void* buffer, size_t length, int flags)
   return -1;
 }
 
+int
+__posix_sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
 ssize_t
 __posix_sendmsg (int socket, const struct msghdr* message, int flags)
 {
@@ -955,8 +1265,20 @@ __posix_ftruncate (int fildes, off_t length)
 int
 __posix_fsync (int fildes)
 {
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  struct fdent *pfd;
+  pfd = __semihosting_findslot (fildes);
+  if (pfd == NULL)
+    {
+      errno = EBADF;
+      return -1;
+    }
+
+  return __semihosting_flush (pfd);
+#else
   errno = ENOSYS; // Not implemented
   return -1;
+#endif
 }
 
 int
@@ -1123,6 +1445,9 @@ os_terminate (int code __attribute__((unused)))
    signum, so that the SWI handler can distinguish the two calls.
    Note: The RDI implementation of _kill throws away both its
    arguments.  */
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  __semihosting_flush_all ();
+#endif
   report_exception (
       code == 0 ? ADP_Stopped_ApplicationExit : ADP_Stopped_RunTimeError);
   /* NOTREACHED */
@@ -1288,6 +1613,21 @@ initialise_monitor_handles (void)
   openfiles[1].pos = 0;
   openfiles[2].handle = monitor_stderr;
   openfiles[2].pos = 0;
+
+#if defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE_BYTES)
+  for (int i = 0; i < OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES; i++)
+    {
+      openfiles[i].buf = nullptr;
+    }
+  for (int i = 0; i < OS_INTEGER_SEMIHOSTING_BUFFERS; i++)
+    {
+      buffers[i].used = false;
+    }
+
+  // As in standard C, stderr is not buffered.
+  openfiles[0].buf = __semihosting_newbuf (monitor_stdin);
+  openfiles[1].buf = __semihosting_newbuf (monitor_stdout);
+#endif
 }
 
 // ----------------------------------------------------------------------------
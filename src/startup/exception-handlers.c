@@ -36,6 +36,7 @@
 #include <cmsis-plus/arm/semihosting.h>
 #include <cmsis-plus/diag/trace.h>
 #include <cmsis-plus/cortexm/exception-handlers.h>
+#include <cmsis-plus/diag/crash-dump.h>
 
 #include <string.h>
 
@@ -78,6 +79,20 @@ extern unsigned int __stack;
 void __attribute__ ((section(".after_vectors"),noreturn,weak))
 Reset_Handler (void)
 {
+#if defined(OS_INCLUDE_STARTUP_CHECKPOINTS)
+  // Start counting the cycles for the startup checkpoints.
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+  // No DWT, use SysTick, free running, without interrupts.
+  SysTick->LOAD = 0x00FFFFFF;
+  SysTick->VAL = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+#endif
+#endif /* defined(OS_INCLUDE_STARTUP_CHECKPOINTS) */
+
   // Fill the main stack with a pattern, to detect usage and underflow.
   for (unsigned int* p = &_Heap_Limit; p < &__stack;)
     {
@@ -432,6 +447,10 @@ HardFault_Handler_C (exception_stack_frame_t* frame __attribute__((unused)),
 
 #endif /* semihosting */
 
+#if defined(OS_USE_CRASH_DUMP)
+  os_crash_dump_capture (frame, lr);
+#endif /* defined(OS_USE_CRASH_DUMP) */
+
 #if defined(TRACE)
   trace_printf ("[HardFault]\n");
   dump_exception_stack (frame, cfsr, mmfar, bfar, lr);
@@ -495,6 +514,10 @@ HardFault_Handler_C (exception_stack_frame_t* frame __attribute__((unused)),
     // There is no semihosting support for Cortex-M0, since on ARMv6-M
     // faults are fatal and it is not possible to return from the handler.
 
+#if defined(OS_USE_CRASH_DUMP)
+    os_crash_dump_capture (frame, lr);
+#endif /* defined(OS_USE_CRASH_DUMP) */
+
 #if defined(TRACE)
     trace_printf ("[HardFault]\n");
     dump_exception_stack (frame, lr);
@@ -563,6 +586,10 @@ void __attribute__ ((section(".after_vectors"),weak,used))
 BusFault_Handler_C (exception_stack_frame_t* frame __attribute__((unused)),
                     uint32_t lr __attribute__((unused)))
 {
+#if defined(OS_USE_CRASH_DUMP)
+  os_crash_dump_capture (frame, lr);
+#endif /* defined(OS_USE_CRASH_DUMP) */
+
 #if defined(TRACE)
   uint32_t mmfar = SCB->MMFAR; // MemManage Fault Address
   uint32_t bfar = SCB->BFAR; // Bus Fault Address
@@ -630,8 +657,21 @@ UsageFault_Handler_C (exception_stack_frame_t* frame __attribute__((unused)),
 
 #endif /* defined(OS_DEBUG_SEMIHOSTING_FAULTS) */
 
+#if defined(OS_USE_CRASH_DUMP)
+  os_crash_dump_capture (frame, lr);
+#endif /* defined(OS_USE_CRASH_DUMP) */
+
 #if defined(TRACE)
   trace_printf ("[UsageFault]\n");
+#if defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+  if ((cfsr & (1UL << 20)) != 0) // STKOF
+    {
+      // The stack limit was reached; the faulting stack is the
+      // current thread one if the fault happened in thread mode.
+      trace_printf ("Stack overflow, %s stack.\n",
+                    ((lr & 4) != 0) ? "thread" : "interrupts");
+    }
+#endif
   dump_exception_stack (frame, cfsr, mmfar, bfar, lr);
 #endif /* defined(TRACE) */
 
@@ -32,7 +32,9 @@
 #include <cmsis-plus/rtos/os-hooks.h>
 #include <cmsis-plus/memory/first-fit-top.h>
 #include <cmsis-plus/memory/lifo.h>
+#include <cmsis-plus/memory/tlsf.h>
 #include <cmsis-plus/memory/block-pool.h>
+#include <cmsis-plus/memory/profiler.h>
 #include <cmsis-plus/estd/memory_resource>
 
 // ----------------------------------------------------------------------------
@@ -65,6 +67,30 @@ sbrk (ptrdiff_t incr);
 static std::aligned_storage<sizeof(application_memory_resource),
     alignof(application_memory_resource)>::type application_free_store;
 
+#if defined(OS_INCLUDE_MEMORY_PROFILER)
+
+// Reserve storage for the application memory resource profiler.
+static std::aligned_storage<sizeof(os::memory::profiler),
+    alignof(os::memory::profiler)>::type application_profiler;
+
+#endif /* defined(OS_INCLUDE_MEMORY_PROFILER) */
+
+/**
+ * @brief Wrap a system memory resource in a profiler, if enabled.
+ * @param [in] mr Pointer to the memory resource.
+ * @return Pointer to the memory resource to be used.
+ */
+static inline rtos::memory::memory_resource*
+profiled_resource (rtos::memory::memory_resource* mr)
+{
+#if defined(OS_INCLUDE_MEMORY_PROFILER)
+  return new os::memory::profiler
+    { mr };
+#else
+  return mr;
+#endif /* defined(OS_INCLUDE_MEMORY_PROFILER) */
+}
+
 #endif /* !defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
 
 /**
@@ -99,10 +125,24 @@ os_startup_initialize_free_store (void* heap_address,
   reinterpret_cast<rtos::memory::memory_resource*> (&application_free_store)->out_of_memory_handler (
       os_rtos_application_out_of_memory_hook);
 
+#if defined(OS_INCLUDE_MEMORY_PROFILER)
+
+  // Record all operations performed on the application free store.
+  new (&application_profiler) os::memory::profiler
+    { reinterpret_cast<rtos::memory::memory_resource*> (&application_free_store) };
+
+  // Set the application free store memory manager.
+  estd::pmr::set_default_resource (
+      reinterpret_cast<estd::pmr::memory_resource*> (&application_profiler));
+
+#else
+
   // Set the application free store memory manager.
   estd::pmr::set_default_resource (
       reinterpret_cast<estd::pmr::memory_resource*> (&application_free_store));
 
+#endif /* defined(OS_INCLUDE_MEMORY_PROFILER) */
+
   // Adjust sbrk() to prevent it overlapping the free store.
   sbrk (
       static_cast<char*> (static_cast<char*> (heap_address) + heap_size_bytes)
@@ -124,14 +164,13 @@ os_startup_initialize_free_store (void* heap_address,
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
       // Set RTOS system memory manager.
-      rtos::memory::set_default_resource (mr);
+      rtos::memory::set_default_resource (profiled_resource (mr));
     }
 
 #else
 
   // The RTOS system memory manager is identical with the application one.
-  rtos::memory::set_default_resource (
-      reinterpret_cast<rtos::memory::memory_resource*> (&application_free_store));
+  rtos::memory::set_default_resource (estd::pmr::get_default_resource ());
 
 #endif /* defined(OS_INTEGER_RTOS_DYNAMIC_MEMORY_SIZE_BYTES) */
 
@@ -147,7 +186,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::thread> (mr);
+      rtos::memory::set_resource_typed<rtos::thread> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_THREAD_POOL_SIZE) */
@@ -164,7 +203,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::condition_variable> (mr);
+      rtos::memory::set_resource_typed<rtos::condition_variable> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_CONDITION_VARIABLE_POOL_SIZE) */
@@ -181,7 +220,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::event_flags> (mr);
+      rtos::memory::set_resource_typed<rtos::event_flags> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_EVENT_FLAGS_POOL_SIZE) */
@@ -198,7 +237,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::memory_pool> (mr);
+      rtos::memory::set_resource_typed<rtos::memory_pool> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_MEMORY_POOL_POOL_SIZE) */
@@ -215,7 +254,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::message_queue> (mr);
+      rtos::memory::set_resource_typed<rtos::message_queue> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_MESSAGE_QUEUE_POOL_SIZE) */
@@ -232,7 +271,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::mutex> (mr);
+      rtos::memory::set_resource_typed<rtos::mutex> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_MUTEX_POOL_SIZE) */
@@ -249,7 +288,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::semaphore> (mr);
+      rtos::memory::set_resource_typed<rtos::semaphore> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_SEMAPHORE_POOL_SIZE) */
@@ -266,7 +305,7 @@ os_startup_initialize_free_store (void* heap_address,
       // Configure the memory manager to throw an exception when out of memory.
       mr->out_of_memory_handler (os_rtos_system_out_of_memory_hook);
 
-      rtos::memory::set_resource_typed<rtos::timer> (mr);
+      rtos::memory::set_resource_typed<rtos::timer> (profiled_resource (mr));
     }
 
 #endif /* defined(OS_INTEGER_RTOS_ALLOC_TIMER_POOL_SIZE) */
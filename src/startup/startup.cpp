@@ -101,6 +101,16 @@ extern unsigned int __bss_regions_array_start;
 extern unsigned int __bss_regions_array_end;
 #endif
 
+// The regions cleared on demand, not by the startup; optional, if not
+// defined by the linker script they are empty.
+#if !defined(OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS)
+extern unsigned int __bss_lazy_start__ __attribute__((weak));
+extern unsigned int __bss_lazy_end__ __attribute__((weak));
+#else
+extern unsigned int __bss_lazy_regions_array_start __attribute__((weak));
+extern unsigned int __bss_lazy_regions_array_end __attribute__((weak));
+#endif
+
 extern unsigned int _Heap_Begin;
 extern unsigned long int _Heap_Limit;
 extern unsigned long int __stack;
@@ -134,14 +144,43 @@ os_run_fini_array (void);
 
 // ----------------------------------------------------------------------------
 
+// The regions are processed in blocks of 8 words, with pairs of
+// 4 registers LDM/STM instructions (only low registers, to be
+// usable on ARMv6-M too), and the remaining words one by one.
+// Huge regions can be passed to the application DMA hooks.
+
 inline __attribute__((always_inline))
 void
 os_initialize_data (unsigned int* from, unsigned int* region_begin,
                     unsigned int* region_end)
 {
-  // Iterate and copy word by word.
   // It is assumed that the pointers are word aligned.
   unsigned int *p = region_begin;
+
+#if defined(OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES)
+  size_t nbytes = (size_t) ((char*) region_end - (char*) region_begin);
+  if (nbytes >= OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES
+      && os_startup_copy_region_dma (region_begin, from, nbytes))
+    {
+      return;
+    }
+#endif /* defined(OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES) */
+
+  while (region_end - p >= 8)
+    {
+      asm volatile (
+          " ldmia %[from]!, {r3, r4, r5, r6} \n"
+          " stmia %[to]!, {r3, r4, r5, r6}   \n"
+          " ldmia %[from]!, {r3, r4, r5, r6} \n"
+          " stmia %[to]!, {r3, r4, r5, r6}   \n"
+
+          : [from] "+l" (from), [to] "+l" (p) /* Outputs */
+          : /* Inputs */
+          : "r3", "r4", "r5", "r6", "memory" /* Clobbers */
+      );
+    }
+
+  // Copy the remaining words one by one.
   while (p < region_end)
     {
       *p++ = *from++;
@@ -152,9 +191,39 @@ inline __attribute__((always_inline))
 void
 os_initialize_bss (unsigned int* region_begin, unsigned int* region_end)
 {
-  // Iterate and clear word by word.
   // It is assumed that the pointers are word aligned.
   unsigned int *p = region_begin;
+
+#if defined(OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES)
+  size_t nbytes = (size_t) ((char*) region_end - (char*) region_begin);
+  if (nbytes >= OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES
+      && os_startup_clear_region_dma (region_begin, nbytes))
+    {
+      return;
+    }
+#endif /* defined(OS_INTEGER_STARTUP_DMA_THRESHOLD_BYTES) */
+
+  unsigned int n = (unsigned int) ((region_end - p) / 8);
+  if (n > 0)
+    {
+      asm volatile (
+          " movs r3, #0                    \n"
+          " movs r4, #0                    \n"
+          " movs r5, #0                    \n"
+          " movs r6, #0                    \n"
+          "1:                              \n"
+          " stmia %[to]!, {r3, r4, r5, r6} \n"
+          " stmia %[to]!, {r3, r4, r5, r6} \n"
+          " subs %[n], #1                  \n"
+          " bne 1b                         \n"
+
+          : [to] "+l" (p), [n] "+l" (n) /* Outputs */
+          : /* Inputs */
+          : "r3", "r4", "r5", "r6", "cc", "memory" /* Clobbers */
+      );
+    }
+
+  // Clear the remaining words one by one.
   while (p < region_end)
     {
       *p++ = 0;
@@ -175,6 +244,125 @@ extern void
 extern void
 (*__fini_array_end[]) (void) __attribute__((weak));
 
+#if defined(OS_INCLUDE_STARTUP_CHECKPOINTS)
+
+#if !defined(OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS)
+#define OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS (8)
+#endif
+
+enum
+{
+  STARTUP_CHECKPOINT_START,
+  STARTUP_CHECKPOINT_HARDWARE_EARLY,
+  STARTUP_CHECKPOINT_DATA,
+  STARTUP_CHECKPOINT_BSS,
+  STARTUP_CHECKPOINT_HARDWARE,
+  STARTUP_CHECKPOINT_FREE_STORE,
+  STARTUP_CHECKPOINT_INIT_ARRAY,
+  STARTUP_CHECKPOINT_MAIN,
+  STARTUP_CHECKPOINTS
+};
+
+// The checkpoints are kept in the no-init RAM, since .data and .bss
+// are initialised between them.
+static struct
+{
+  uint32_t cycles[STARTUP_CHECKPOINTS];
+  // The slowest init array functions, in descending order.
+  struct
+  {
+    void
+    (*func) (void);
+    uint32_t cycles;
+  } constructors[OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS];
+} os_startup_checkpoints_ OS_ATTRIBUTE_NOINIT;
+
+// The cycles counter, started by Reset_Handler(); the DWT cycles counter
+// on ARMv7-M, or SysTick, down counting on 24-bits, on ARMv6-M.
+inline __attribute__((always_inline))
+uint32_t
+os_startup_cycles (void)
+{
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+  return DWT->CYCCNT;
+#else
+  return 0x00FFFFFF - SysTick->VAL;
+#endif
+}
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define STARTUP_CYCLES_MASK (0xFFFFFFFF)
+#else
+#define STARTUP_CYCLES_MASK (0x00FFFFFF)
+#endif
+
+#define OS_STARTUP_CHECKPOINT(id) \
+  (os_startup_checkpoints_.cycles[(id)] = os_startup_cycles ())
+
+static void
+os_startup_account_constructor (void (*func) (void), uint32_t cycles)
+{
+  // Insert into the array sorted by the number of cycles.
+  int i = OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS;
+  while (i > 0 && os_startup_checkpoints_.constructors[i - 1].cycles < cycles)
+    {
+      if (i < OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS)
+        {
+          os_startup_checkpoints_.constructors[i] =
+              os_startup_checkpoints_.constructors[i - 1];
+        }
+      --i;
+    }
+  if (i < OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS)
+    {
+      os_startup_checkpoints_.constructors[i].func = func;
+      os_startup_checkpoints_.constructors[i].cycles = cycles;
+    }
+}
+
+/**
+ * @details
+ * The checkpoints remain valid until the next reset, so they can
+ * also be displayed later, for example after the scheduler started;
+ * the constructor addresses can be resolved with `addr2line`.
+ */
+void
+os_startup_report_checkpoints (void)
+{
+  static const char* const names[STARTUP_CHECKPOINTS] =
+    { "reset handler", "hardware early", "data", "bss", "hardware",
+        "free store", "static objects", "main" };
+
+  trace_printf ("Startup checkpoints (cycles, at %u Hz):\n",
+                SystemCoreClock);
+  uint32_t prev = 0;
+  for (int i = 0; i < STARTUP_CHECKPOINTS; ++i)
+    {
+      uint32_t c = os_startup_checkpoints_.cycles[i];
+      trace_printf ("- %-14s %10u +%u\n", names[i], c,
+                    (c - prev) & STARTUP_CYCLES_MASK);
+      prev = c;
+    }
+
+  trace_printf ("Slowest static constructors:\n");
+  for (int i = 0; i < OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS; ++i)
+    {
+      if (os_startup_checkpoints_.constructors[i].func == nullptr)
+        {
+          break;
+        }
+      trace_printf ("- %p %u\n",
+                    (void*) os_startup_checkpoints_.constructors[i].func,
+                    os_startup_checkpoints_.constructors[i].cycles);
+    }
+}
+
+#else
+
+#define OS_STARTUP_CHECKPOINT(id)
+
+#endif /* defined(OS_INCLUDE_STARTUP_CHECKPOINTS) */
+
 // Iterate over all the preinit/init routines (mainly static constructors).
 inline __attribute__((always_inline))
 void
@@ -196,7 +384,15 @@ os_run_init_array (void)
   count = __init_array_end - __init_array_start;
   for (int i = 0; i < count; i++)
     {
+#if defined(OS_INCLUDE_STARTUP_CHECKPOINTS)
+      uint32_t begin = os_startup_cycles ();
+      __init_array_start[i] ();
+      os_startup_account_constructor (
+          __init_array_start[i],
+          (os_startup_cycles () - begin) & STARTUP_CYCLES_MASK);
+#else
       __init_array_start[i] ();
+#endif
     }
 }
 
@@ -260,6 +456,15 @@ _start (void)
   // After Reset the Cortex-M processor is in Thread mode,
   // priority is Privileged, and the Stack is set to Main.
 
+#if defined(OS_INCLUDE_STARTUP_CHECKPOINTS)
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_START);
+  for (int i = 0; i < OS_INTEGER_STARTUP_CHECKPOINTS_CONSTRUCTORS; ++i)
+    {
+      os_startup_checkpoints_.constructors[i].func = nullptr;
+      os_startup_checkpoints_.constructors[i].cycles = 0;
+    }
+#endif
+
   // --------------------------------------------------------------------------
 
   // Initialise hardware right after reset, to switch clock to higher
@@ -272,6 +477,7 @@ _start (void)
   // initialised before filling the BSS section.
 
   os_startup_initialize_hardware_early ();
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_HARDWARE_EARLY);
 
   // Use Old Style DATA and BSS section initialisation,
   // that will manage a single BSS sections.
@@ -303,6 +509,8 @@ _start (void)
 
 #endif
 
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_DATA);
+
 #if defined(DEBUG) && (OS_BOOL_STARTUP_GUARD_CHECKS)
 
   if ((__data_begin_guard != DATA_BEGIN_GUARD_VALUE)
@@ -341,6 +549,8 @@ _start (void)
 
 #endif
 
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_BSS);
+
 #if defined(DEBUG) && (OS_BOOL_STARTUP_GUARD_CHECKS)
 
   if ((__bss_begin_guard != 0) || (__bss_end_guard != 0))
@@ -356,6 +566,7 @@ _start (void)
   // Hook to continue the initialisations. Usually compute and store the
   // clock frequency in the global CMSIS variable, cleared above.
   os_startup_initialize_hardware ();
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_HARDWARE);
 
   // Initialise the trace output device. From this moment on,
   // trace_printf() calls are available (including in static constructors).
@@ -366,6 +577,7 @@ _start (void)
 
   os_startup_initialize_free_store (
       &_Heap_Begin, (size_t) ((char*) (&_Heap_Limit) - (char*) (&_Heap_Begin)));
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_FREE_STORE);
 
   // Get the argc/argv (useful in semihosting configurations).
   int argc;
@@ -375,12 +587,24 @@ _start (void)
   // Call the standard library initialisation (mandatory for C++ to
   // execute the constructors for the static objects).
   os_run_init_array ();
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_INIT_ARRAY);
   trace_printf ("Static objects constructed.\n");
 
 #if defined(OS_HAS_INTERRUPTS_STACK)
   os::rtos::interrupts::stack ()->set(&_Heap_Limit,  (size_t) ((char*) (&__stack) - (char*) (&_Heap_Limit)));
+
+#if defined(OS_USE_RTOS_THREAD_STACK_LIMIT) \
+  && (defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__))
+  // Overflowing the interrupts stack is now a UsageFault.
+  __set_MSPLIM ((uint32_t) os::rtos::interrupts::stack ()->limit ());
+#endif
 #endif /* defined(OS_HAS_INTERRUPTS_STACK) */
 
+#if defined(OS_INCLUDE_STARTUP_CHECKPOINTS)
+  OS_STARTUP_CHECKPOINT(STARTUP_CHECKPOINT_MAIN);
+  os_startup_report_checkpoints ();
+#endif
+
   // Call the main entry point, and save the exit code.
   int code = main (argc, argv);
 
@@ -392,6 +616,34 @@ _start (void)
 
 // ----------------------------------------------------------------------------
 
+/**
+ * @details
+ * The startup skips the `.bss_lazy` regions, so the boot does not
+ * wait for large buffers to be cleared; this function clears them,
+ * with the same code as the .bss.
+ */
+void
+os_startup_initialize_lazy_bss (void)
+{
+#if !defined(OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS)
+
+  os_initialize_bss (&__bss_lazy_start__, &__bss_lazy_end__);
+
+#else
+
+  for (unsigned int *p = &__bss_lazy_regions_array_start;
+      p < &__bss_lazy_regions_array_end;)
+    {
+      unsigned int* region_begin = (unsigned int*) (*p++);
+      unsigned int* region_end = (unsigned int*) (*p++);
+      os_initialize_bss (region_begin, region_end);
+    }
+
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
 #if !defined(OS_USE_SEMIHOSTING_SYSCALLS)
 
 // Semihosting uses a more elaborate version of os_startup_initialize_args()
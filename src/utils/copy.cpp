@@ -0,0 +1,233 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/os-app-config.h>
+#include <cmsis-plus/utils/copy.h>
+
+#include <cstring>
+
+#if defined(__ARM_FEATURE_MVE) && !defined(OS_USE_UTILS_LIBC_COPY)
+#include <arm_mve.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+// Prevent the compiler from replacing the loops with calls
+// to the library functions, which are the ones to be avoided.
+#define OS_ATTRIBUTE_NO_LIBCALLS \
+  __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+namespace os
+{
+  namespace utils
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      typedef uint32_t __attribute__((may_alias)) word_t;
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The implementation is selected at build time:
+     * - with `OS_USE_UTILS_LIBC_COPY`, the library `memcpy()`,
+     *   for libraries with optimised versions;
+     * - on ARMv8.1-M with the Helium extension, 16 bytes vector
+     *   loads and stores, the tail with a predicated one;
+     * - otherwise, if the blocks have the same word alignment,
+     *   blocks of 4 words (with LDM/STM on ARM), followed by
+     *   words and bytes; unaligned blocks are copied byte by byte.
+     */
+    void
+    OS_ATTRIBUTE_NO_LIBCALLS
+    copy_bytes (void* dest, const void* src, std::size_t nbytes)
+    {
+#if defined(OS_USE_UTILS_LIBC_COPY)
+
+      std::memcpy (dest, src, nbytes);
+
+#elif defined(__ARM_FEATURE_MVE)
+
+      uint8_t* d = static_cast<uint8_t*> (dest);
+      const uint8_t* s = static_cast<const uint8_t*> (src);
+
+      while (nbytes >= 16)
+        {
+          vst1q_u8 (d, vld1q_u8 (s));
+          d += 16;
+          s += 16;
+          nbytes -= 16;
+        }
+      if (nbytes > 0)
+        {
+          mve_pred16_t p = vctp8q (static_cast<uint32_t> (nbytes));
+          vst1q_p_u8 (d, vld1q_z_u8 (s, p), p);
+        }
+
+#else
+
+      uint8_t* d = static_cast<uint8_t*> (dest);
+      const uint8_t* s = static_cast<const uint8_t*> (src);
+
+      if (((reinterpret_cast<uintptr_t> (d) ^ reinterpret_cast<uintptr_t> (s))
+          & (sizeof(word_t) - 1)) == 0)
+        {
+          // Same alignment; copy the bytes up to the word boundary.
+          while (((reinterpret_cast<uintptr_t> (d) & (sizeof(word_t) - 1))
+              != 0) && (nbytes > 0))
+            {
+              *d++ = *s++;
+              --nbytes;
+            }
+
+          word_t* wd = reinterpret_cast<word_t*> (d);
+          const word_t* ws = reinterpret_cast<const word_t*> (s);
+
+          while (nbytes >= 4 * sizeof(word_t))
+            {
+#if defined(__ARM_ARCH_ISA_THUMB)
+              // Only low registers, to be usable on ARMv6-M too.
+              asm volatile (
+                  " ldmia %[from]!, {r3, r4, r5, r6} \n"
+                  " stmia %[to]!, {r3, r4, r5, r6}   \n"
+
+                  : [from] "+l" (ws), [to] "+l" (wd) /* Outputs */
+                  : /* Inputs */
+                  : "r3", "r4", "r5", "r6", "memory" /* Clobbers */
+              );
+#else
+              wd[0] = ws[0];
+              wd[1] = ws[1];
+              wd[2] = ws[2];
+              wd[3] = ws[3];
+              wd += 4;
+              ws += 4;
+#endif
+              nbytes -= 4 * sizeof(word_t);
+            }
+
+          while (nbytes >= sizeof(word_t))
+            {
+              *wd++ = *ws++;
+              nbytes -= sizeof(word_t);
+            }
+
+          d = reinterpret_cast<uint8_t*> (wd);
+          s = reinterpret_cast<const uint8_t*> (ws);
+        }
+
+      while (nbytes > 0)
+        {
+          *d++ = *s++;
+          --nbytes;
+        }
+
+#endif
+    }
+
+    /**
+     * @details
+     * The implementation is selected as for `copy_bytes()`;
+     * the words are stored with the byte replicated.
+     */
+    void
+    OS_ATTRIBUTE_NO_LIBCALLS
+    fill_bytes (void* dest, uint8_t value, std::size_t nbytes)
+    {
+#if defined(OS_USE_UTILS_LIBC_COPY)
+
+      std::memset (dest, value, nbytes);
+
+#elif defined(__ARM_FEATURE_MVE)
+
+      uint8_t* d = static_cast<uint8_t*> (dest);
+      uint8x16_t v = vdupq_n_u8 (value);
+
+      while (nbytes >= 16)
+        {
+          vst1q_u8 (d, v);
+          d += 16;
+          nbytes -= 16;
+        }
+      if (nbytes > 0)
+        {
+          vst1q_p_u8 (d, v, vctp8q (static_cast<uint32_t> (nbytes)));
+        }
+
+#else
+
+      uint8_t* d = static_cast<uint8_t*> (dest);
+
+      while (((reinterpret_cast<uintptr_t> (d) & (sizeof(word_t) - 1)) != 0)
+          && (nbytes > 0))
+        {
+          *d++ = value;
+          --nbytes;
+        }
+
+      word_t w = value * 0x01010101u;
+      word_t* wd = reinterpret_cast<word_t*> (d);
+
+      while (nbytes >= 4 * sizeof(word_t))
+        {
+          wd[0] = w;
+          wd[1] = w;
+          wd[2] = w;
+          wd[3] = w;
+          wd += 4;
+          nbytes -= 4 * sizeof(word_t);
+        }
+
+      while (nbytes >= sizeof(word_t))
+        {
+          *wd++ = w;
+          nbytes -= sizeof(word_t);
+        }
+
+      d = reinterpret_cast<uint8_t*> (wd);
+      while (nbytes > 0)
+        {
+          *d++ = value;
+          --nbytes;
+        }
+
+#endif
+    }
+
+  } /* namespace utils */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,736 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Benchmark of the memory resources, with synthetic allocation
+ * patterns and with recorded traces.
+ *
+ * Each pattern is a deterministic sequence of allocations and
+ * deallocations; all resources get exactly the same sequence, in
+ * an arena of the same size (except the malloc resource, which
+ * uses the system heap).
+ *
+ * The results are printed as CSV lines, after a header line
+ * starting with `csv,`:
+ *
+ *   csv,resource,pattern,operations,allocations,failed,
+ *     alloc-min,alloc-avg,alloc-p50,alloc-p99,alloc-max,
+ *     free-min,free-avg,free-p50,free-p99,free-max,
+ *     peak-fragmentation,peak-live-bytes
+ *
+ * The durations are in hrclock cycles, with the cost of reading
+ * the clock subtracted; the percentiles are the upper limits of
+ * the power of two histogram bins, so they are only approximate.
+ * The fragmentation is the maximum `fragmentation()`
+ * index during the run (0 if the resource does not know
+ * its largest free chunk).
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cmsis-plus/memory/block-pool.h>
+#include <cmsis-plus/memory/first-fit-top.h>
+#include <cmsis-plus/memory/lifo.h>
+#include <cmsis-plus/memory/malloc.h>
+#include <cmsis-plus/memory/slab.h>
+#include <cmsis-plus/memory/tlsf.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <test.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t arena_size_bytes = 16 * 1024;
+
+  // The maximum number of blocks allocated at the same time.
+  constexpr std::size_t max_slots = 128;
+
+  alignas(std::max_align_t) char arena[arena_size_bytes];
+
+  clock::duration_t overhead_;
+
+  // --------------------------------------------------------------------------
+
+  // Statistics of the durations, with a power of two histogram.
+  class stats
+  {
+  public:
+
+    static constexpr std::size_t bins = 32;
+
+    void
+    add (clock::timestamp_t begin, clock::timestamp_t end)
+    {
+      clock::duration_t d = static_cast<clock::duration_t> (end - begin);
+      d = (d > overhead_) ? (d - overhead_) : 0;
+
+      if (count_ == 0 || d < min_)
+        {
+          min_ = d;
+        }
+      if (d > max_)
+        {
+          max_ = d;
+        }
+      sum_ += d;
+      ++count_;
+
+      std::size_t bin = 0;
+      while ((bin < bins - 1) && ((d >> bin) > 1))
+        {
+          ++bin;
+        }
+      ++histogram_[bin];
+    }
+
+    // The upper limit of the bin including the given percentile.
+    unsigned long
+    percentile (unsigned int pc) const
+    {
+      uint64_t threshold = (static_cast<uint64_t> (count_) * pc + 99) / 100;
+      uint64_t acc = 0;
+      for (std::size_t bin = 0; bin < bins; ++bin)
+        {
+          acc += histogram_[bin];
+          if (acc >= threshold && acc > 0)
+            {
+              return (2ul << bin) - 1;
+            }
+        }
+      return 0;
+    }
+
+    void
+    print (void) const
+    {
+      printf ("%lu,%lu,%lu,%lu,%lu", static_cast<unsigned long> (min_),
+              static_cast<unsigned long> (count_ ? (sum_ / count_) : 0),
+              percentile (50), percentile (99),
+              static_cast<unsigned long> (max_));
+    }
+
+  private:
+
+    clock::duration_t min_ = 0;
+    clock::duration_t max_ = 0;
+    uint64_t sum_ = 0;
+    unsigned int count_ = 0;
+    unsigned int histogram_[bins] =
+      { };
+  };
+
+  // --------------------------------------------------------------------------
+
+  // A step of a pattern; deallocations of slots whose allocation
+  // failed are skipped.
+  struct step
+  {
+    bool allocate;
+    std::size_t slot;
+    std::size_t bytes;
+  };
+
+  class pattern
+  {
+  public:
+
+    pattern (const char* name, std::size_t max_bytes) :
+        name_ (name), max_bytes_ (max_bytes)
+    {
+      ;
+    }
+
+    virtual
+    ~pattern () = default;
+
+    // Restart the sequence from the beginning.
+    virtual void
+    rewind (void) = 0;
+
+    // Get the next step; return false at the end.
+    virtual bool
+    next (step& s) = 0;
+
+    const char*
+    name (void) const
+    {
+      return name_;
+    }
+
+    // The size of the largest request.
+    std::size_t
+    max_bytes (void) const
+    {
+      return max_bytes_;
+    }
+
+  protected:
+
+    const char* name_;
+    std::size_t max_bytes_;
+  };
+
+  // A simple deterministic pseudo random generator (xorshift32).
+  class random
+  {
+  public:
+
+    void
+    seed (uint32_t value)
+    {
+      state_ = value ? value : 1;
+    }
+
+    uint32_t
+    next (void)
+    {
+      state_ ^= state_ << 13;
+      state_ ^= state_ >> 17;
+      state_ ^= state_ << 5;
+      return state_;
+    }
+
+    std::size_t
+    range (std::size_t low, std::size_t high)
+    {
+      return low + next () % (high - low + 1);
+    }
+
+  private:
+
+    uint32_t state_ = 1;
+  };
+
+  // Random slots, allocated if empty, deallocated otherwise,
+  // so about half of the slots are in use. With the probability
+  // `large_pc`, the request is from the large sizes range.
+  class random_pattern : public pattern
+  {
+  public:
+
+    random_pattern (const char* name, std::size_t operations,
+                    std::size_t slots, std::size_t small_min,
+                    std::size_t small_max, std::size_t large_min,
+                    std::size_t large_max, unsigned int large_pc) :
+        pattern
+          { name, large_pc ? large_max : small_max }, //
+        operations_ (operations), //
+        slots_ (slots), //
+        small_min_ (small_min), //
+        small_max_ (small_max), //
+        large_min_ (large_min), //
+        large_max_ (large_max), //
+        large_pc_ (large_pc)
+    {
+      rewind ();
+    }
+
+    virtual void
+    rewind (void) override
+    {
+      rnd_.seed (0x12345678);
+      std::memset (used_, 0, sizeof(used_));
+      count_ = 0;
+    }
+
+    virtual bool
+    next (step& s) override
+    {
+      if (count_ >= operations_)
+        {
+          return false;
+        }
+      ++count_;
+
+      s.slot = rnd_.next () % slots_;
+      s.allocate = !used_[s.slot];
+      used_[s.slot] = s.allocate;
+      if (s.allocate)
+        {
+          if ((rnd_.next () % 100) < large_pc_)
+            {
+              s.bytes = rnd_.range (large_min_, large_max_);
+            }
+          else
+            {
+              s.bytes = rnd_.range (small_min_, small_max_);
+            }
+        }
+      return true;
+    }
+
+  private:
+
+    random rnd_;
+    std::size_t operations_;
+    std::size_t slots_;
+    std::size_t small_min_;
+    std::size_t small_max_;
+    std::size_t large_min_;
+    std::size_t large_max_;
+    unsigned int large_pc_;
+    std::size_t count_ = 0;
+    bool used_[max_slots];
+  };
+
+  // Producer/consumer lifetimes: the messages are deallocated
+  // in the order they were allocated, when the ring is full;
+  // every fourth step is a short lived, larger buffer,
+  // deallocated on the next step.
+  class fifo_pattern : public pattern
+  {
+  public:
+
+    static constexpr std::size_t ring = 32;
+    static constexpr std::size_t scratch_slot = ring;
+
+    fifo_pattern (const char* name, std::size_t operations) :
+        pattern
+          { name, 512 }, //
+        operations_ (operations)
+    {
+      static_assert(ring + 1 <= max_slots, "too many slots");
+      rewind ();
+    }
+
+    virtual void
+    rewind (void) override
+    {
+      rnd_.seed (0x9E3779B9);
+      count_ = 0;
+      head_ = 0;
+      live_ = 0;
+      scratch_ = false;
+    }
+
+    virtual bool
+    next (step& s) override
+    {
+      if (count_ >= operations_)
+        {
+          return false;
+        }
+      ++count_;
+
+      if (scratch_)
+        {
+          s.allocate = false;
+          s.slot = scratch_slot;
+          scratch_ = false;
+        }
+      else if ((count_ % 4) == 0)
+        {
+          s.allocate = true;
+          s.slot = scratch_slot;
+          s.bytes = rnd_.range (256, 512);
+          scratch_ = true;
+        }
+      else if (live_ == ring)
+        {
+          // Consume the oldest message.
+          s.allocate = false;
+          s.slot = (head_ + ring - live_) % ring;
+          --live_;
+        }
+      else
+        {
+          // Produce a new message.
+          s.allocate = true;
+          s.slot = head_;
+          s.bytes = rnd_.range (16, 128);
+          head_ = (head_ + 1) % ring;
+          ++live_;
+        }
+      return true;
+    }
+
+  private:
+
+    random rnd_;
+    std::size_t operations_;
+    std::size_t count_ = 0;
+    std::size_t head_ = 0;
+    std::size_t live_ = 0;
+    bool scratch_ = false;
+  };
+
+  // The allocations and deallocations recorded by the profiler,
+  // in the order they were performed. The addresses are mapped
+  // to slots; the records of the live blocks are ignored.
+  class replay_pattern : public pattern
+  {
+  public:
+
+    replay_pattern (const char* name) :
+        pattern
+          { name, 0 }
+    {
+      ;
+    }
+
+    bool
+    load (const char* path)
+    {
+      FILE* f = std::fopen (path, "r");
+      if (f == nullptr)
+        {
+          printf ("# Cannot open '%s'.\n", path);
+          return false;
+        }
+
+      void* addrs[max_slots] =
+        { };
+      char line[128];
+      while (std::fgets (line, sizeof(line), f) != nullptr)
+        {
+          char type;
+          void* addr;
+          unsigned int bytes;
+          if (std::sscanf (line, "%c %p %u", &type, &addr, &bytes) != 3)
+            {
+              continue;
+            }
+
+          step s;
+          if (type == 'a' || type == 'x')
+            {
+              s.allocate = true;
+              s.bytes = bytes;
+              if (s.bytes > max_bytes_)
+                {
+                  max_bytes_ = s.bytes;
+                }
+
+              if (!find_ (addrs, nullptr, s.slot))
+                {
+                  printf ("# Too many live blocks, trace truncated.\n");
+                  break;
+                }
+              if (type == 'a')
+                {
+                  addrs[s.slot] = addr;
+                }
+              else
+                {
+                  // The allocation failed when recorded; if it
+                  // succeeds now, release it immediately.
+                  steps_.push_back (s);
+                  s.allocate = false;
+                }
+            }
+          else if (type == 'd')
+            {
+              s.allocate = false;
+              if (addr == nullptr || !find_ (addrs, addr, s.slot))
+                {
+                  // Allocated before the first record.
+                  continue;
+                }
+              addrs[s.slot] = nullptr;
+            }
+          else
+            {
+              continue;
+            }
+          steps_.push_back (s);
+        }
+      std::fclose (f);
+
+      return !steps_.empty ();
+    }
+
+    virtual void
+    rewind (void) override
+    {
+      index_ = 0;
+    }
+
+    virtual bool
+    next (step& s) override
+    {
+      if (index_ >= steps_.size ())
+        {
+          return false;
+        }
+      s = steps_[index_++];
+      return true;
+    }
+
+  private:
+
+    static bool
+    find_ (void* const* addrs, void* addr, std::size_t& slot)
+    {
+      for (std::size_t i = 0; i < max_slots; ++i)
+        {
+          if (addrs[i] == addr)
+            {
+              slot = i;
+              return true;
+            }
+        }
+      return false;
+    }
+
+    std::vector<step> steps_;
+    std::size_t index_ = 0;
+  };
+
+  // --------------------------------------------------------------------------
+
+  void
+  run (const char* name, rtos::memory::memory_resource* mr, pattern& pt)
+  {
+    struct
+    {
+      void* addr;
+      std::size_t bytes;
+    } blocks[max_slots] =
+      { };
+
+    stats alloc_stats;
+    stats free_stats;
+    unsigned int operations = 0;
+    unsigned int allocations = 0;
+    unsigned int failed = 0;
+    std::size_t fragmentation = 0;
+    std::size_t live_bytes = 0;
+    std::size_t peak_live_bytes = 0;
+
+    pt.rewind ();
+
+    step s;
+    while (pt.next (s))
+      {
+        ++operations;
+        if (s.allocate)
+          {
+            ++allocations;
+
+            clock::timestamp_t begin = hrclock.now ();
+            void* p = mr->allocate (s.bytes);
+            clock::timestamp_t end = hrclock.now ();
+            alloc_stats.add (begin, end);
+
+            if (p == nullptr)
+              {
+                ++failed;
+                continue;
+              }
+            blocks[s.slot].addr = p;
+            blocks[s.slot].bytes = s.bytes;
+
+            live_bytes += s.bytes;
+            if (live_bytes > peak_live_bytes)
+              {
+                peak_live_bytes = live_bytes;
+              }
+          }
+        else
+          {
+            void* p = blocks[s.slot].addr;
+            if (p == nullptr)
+              {
+                continue;
+              }
+
+            clock::timestamp_t begin = hrclock.now ();
+            mr->deallocate (p, blocks[s.slot].bytes);
+            clock::timestamp_t end = hrclock.now ();
+            free_stats.add (begin, end);
+
+            live_bytes -= blocks[s.slot].bytes;
+            blocks[s.slot].addr = nullptr;
+          }
+
+        std::size_t fr = mr->fragmentation ();
+        if (fr > fragmentation)
+          {
+            fragmentation = fr;
+          }
+      }
+
+    // Return all blocks, for the next run.
+    for (auto& b : blocks)
+      {
+        if (b.addr != nullptr)
+          {
+            mr->deallocate (b.addr, b.bytes);
+          }
+      }
+
+    printf ("csv,%s,%s,%u,%u,%u,", name, pt.name (), operations, allocations,
+            failed);
+    alloc_stats.print ();
+    printf (",");
+    free_stats.print ();
+    printf (",%u,%u\n", static_cast<unsigned int> (fragmentation),
+            static_cast<unsigned int> (peak_live_bytes));
+  }
+
+  void
+  run_all (pattern& pt)
+  {
+      {
+        os::memory::first_fit_top mr
+          { "first-fit-top", arena, sizeof(arena) };
+        run (mr.name (), &mr, pt);
+      }
+
+      {
+        os::memory::lifo mr
+          { "lifo", arena, sizeof(arena) };
+        run (mr.name (), &mr, pt);
+      }
+
+      {
+        os::memory::tlsf mr
+          { "tlsf", arena, sizeof(arena) };
+        run (mr.name (), &mr, pt);
+      }
+
+      {
+        // All blocks large enough for the largest request.
+        std::size_t size = rtos::memory::align_size (pt.max_bytes (),
+                                                     sizeof(void*));
+        os::memory::block_pool mr
+          { "block-pool", sizeof(arena) / size, size, arena, sizeof(arena) };
+        run (mr.name (), &mr, pt);
+      }
+
+      {
+        // Size classes up to the largest request, each with
+        // about the same share of the arena.
+        static const std::size_t all_sizes[] =
+          { 16, 32, 64, 128, 256, 512, 1024, 2048 };
+        std::size_t sizes[os::memory::slab::max_size_classes];
+        std::size_t blocks[os::memory::slab::max_size_classes];
+        std::size_t count = 0;
+        for (auto size : all_sizes)
+          {
+            if (count == os::memory::slab::max_size_classes)
+              {
+                break;
+              }
+            sizes[count++] = size;
+            if (size >= pt.max_bytes ())
+              {
+                break;
+              }
+          }
+        std::size_t share = sizeof(arena) / count
+            - rtos::memory::memory_resource::max_align;
+        for (std::size_t i = 0; i < count; ++i)
+          {
+            blocks[i] = share / sizes[i];
+          }
+
+        os::memory::slab mr
+          { "slab", sizes, blocks, count, arena, sizeof(arena) };
+        run (mr.name (), &mr, pt);
+      }
+
+    run ("malloc", rtos::memory::malloc_resource (), pt);
+  }
+
+  void
+  measure_overhead (void)
+  {
+    clock::duration_t min = 0;
+    for (unsigned int i = 0; i < 100; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        clock::timestamp_t end = hrclock.now ();
+        clock::duration_t d = static_cast<clock::duration_t> (end - begin);
+        if (i == 0 || d < min)
+          {
+            min = d;
+          }
+      }
+    overhead_ = min;
+  }
+
+} /* namespace */
+
+// ----------------------------------------------------------------------------
+
+int
+run_tests (unsigned int operations, const char* trace_path)
+{
+  measure_overhead ();
+
+  printf ("# %u operations, %u bytes arena, hrclock %u Hz.\n", operations,
+          static_cast<unsigned int> (arena_size_bytes),
+          static_cast<unsigned int> (hrclock.input_clock_frequency_hz ()));
+  printf ("csv,resource,pattern,operations,allocations,failed,"
+          "alloc-min,alloc-avg,alloc-p50,alloc-p99,alloc-max,"
+          "free-min,free-avg,free-p50,free-p99,free-max,"
+          "peak-fragmentation,peak-live-bytes\n");
+
+    {
+      random_pattern pt
+        { "uniform", operations, 64, 8, 256, 0, 0, 0 };
+      run_all (pt);
+    }
+
+    {
+      random_pattern pt
+        { "bimodal", operations, 64, 8, 32, 256, 1024, 15 };
+      run_all (pt);
+    }
+
+    {
+      fifo_pattern pt
+        { "producer-consumer", operations };
+      run_all (pt);
+    }
+
+  if (trace_path != nullptr)
+    {
+      replay_pattern pt
+        { "replay" };
+      if (pt.load (trace_path))
+        {
+          run_all (pt);
+        }
+    }
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,907 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Benchmarks of the kernel primitives, in hrclock cycles.
+ *
+ * The results are printed as CSV lines, after a header line
+ * starting with `csv,`:
+ *
+ *   csv,name,param,iterations,min,avg,max
+ *
+ * where `param` is the benchmark parameter (like the message size,
+ * or 0 if not used) and min/avg/max are per iteration, with the
+ * cost of reading the clock subtracted. Lines not starting
+ * with `csv,` are comments, and should be ignored by the tools
+ * comparing the results between releases.
+ *
+ * The throughput benchmarks are printed separately, after a
+ * header line starting with `csv-tput,`:
+ *
+ *   csv-tput,name,size,depth,prios,producers,consumers,messages,
+ *     cycles,cycles-per-message,messages-per-second
+ *
+ * where `cycles` is the total duration of the run, from releasing
+ * the threads until all of them are done.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <test.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // Statistics of the measured iterations.
+  class stats
+  {
+  public:
+
+    stats (clock::duration_t overhead = 0) :
+        overhead_ (overhead)
+    {
+      ;
+    }
+
+    void
+    add (clock::timestamp_t begin, clock::timestamp_t end)
+    {
+      clock::duration_t d = static_cast<clock::duration_t> (end - begin);
+      d = (d > overhead_) ? (d - overhead_) : 0;
+
+      if (count_ == 0 || d < min_)
+        {
+          min_ = d;
+        }
+      if (d > max_)
+        {
+          max_ = d;
+        }
+      sum_ += d;
+      ++count_;
+    }
+
+    clock::duration_t
+    min (void) const
+    {
+      return min_;
+    }
+
+    void
+    print (const char* name, unsigned int param) const
+    {
+      printf ("csv,%s,%u,%u,%lu,%lu,%lu\n", name, param, count_,
+              static_cast<unsigned long> (min_),
+              static_cast<unsigned long> (count_ ? (sum_ / count_) : 0),
+              static_cast<unsigned long> (max_));
+    }
+
+  private:
+
+    clock::duration_t overhead_;
+    clock::duration_t min_ = 0;
+    clock::duration_t max_ = 0;
+    uint64_t sum_ = 0;
+    unsigned int count_ = 0;
+  };
+
+  unsigned int iterations_;
+  clock::duration_t overhead_;
+
+  // The partner threads run at a higher priority than the
+  // main thread, so they run as soon as they are made ready.
+  thread::attributes
+  partner_attributes (void)
+  {
+    thread::attributes attr;
+    attr.th_priority = thread::priority::above_normal;
+    return attr;
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  bench_overhead (void)
+  {
+    stats st;
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+
+    // The minimum is subtracted from all subsequent measurements.
+    overhead_ = st.min ();
+    st.print ("hrclock-now", 0);
+  }
+
+  // --------------------------------------------------------------------------
+
+  volatile bool yield_done;
+
+  void*
+  yield_partner (void* args __attribute__((unused)))
+  {
+    while (!yield_done)
+      {
+        this_thread::yield ();
+      }
+    return nullptr;
+  }
+
+  void
+  bench_context_switch (void)
+  {
+    // Two threads with the same priority, yielding to each other;
+    // each iteration is a round trip, i.e. two context switches.
+    yield_done = false;
+
+    thread_inclusive<> th
+      { "bench-yield", yield_partner, nullptr };
+
+    stats st
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        this_thread::yield ();
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+
+    yield_done = true;
+    th.join ();
+
+    st.print ("context-switch-yield", 2);
+  }
+
+  // --------------------------------------------------------------------------
+
+  semaphore_binary* sem_ping;
+  semaphore_binary* sem_pong;
+
+  void*
+  sem_partner (void* args __attribute__((unused)))
+  {
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        sem_ping->wait ();
+        sem_pong->post ();
+      }
+    return nullptr;
+  }
+
+  void
+  bench_semaphore (void)
+  {
+    semaphore_binary ping
+      { "bench-ping", 0 };
+    semaphore_binary pong
+      { "bench-pong", 0 };
+    sem_ping = &ping;
+    sem_pong = &pong;
+
+    thread_inclusive<> th
+      { "bench-sem", sem_partner, nullptr, partner_attributes () };
+
+    stats st
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        ping.post ();
+        pong.wait ();
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+
+    th.join ();
+    st.print ("semaphore-ping-pong", 0);
+
+    // Uncontended post/wait, in the same thread.
+    stats st2
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        ping.post ();
+        ping.wait ();
+        clock::timestamp_t end = hrclock.now ();
+        st2.add (begin, end);
+      }
+    st2.print ("semaphore-post-wait", 0);
+  }
+
+  // --------------------------------------------------------------------------
+
+  mutex* mx_contended;
+  semaphore_binary* mx_go;
+  semaphore_binary* mx_done;
+
+  void*
+  mutex_partner (void* args __attribute__((unused)))
+  {
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        mx_go->wait ();
+        mx_contended->lock ();
+        mx_contended->unlock ();
+        mx_done->post ();
+      }
+    return nullptr;
+  }
+
+  void
+  bench_mutex (void)
+  {
+    mutex mx
+      { "bench-mx" };
+
+    stats st
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        mx.lock ();
+        mx.unlock ();
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+    st.print ("mutex-lock-unlock", 0);
+
+    // Contended: the partner blocks on the locked mutex, and the
+    // measurement covers the unlock and the hand over to the
+    // partner, until it releases the mutex.
+    semaphore_binary go
+      { "bench-go", 0 };
+    semaphore_binary done
+      { "bench-done", 0 };
+    mx_contended = &mx;
+    mx_go = &go;
+    mx_done = &done;
+
+    thread_inclusive<> th
+      { "bench-mx", mutex_partner, nullptr, partner_attributes () };
+
+    stats st2
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        mx.lock ();
+        go.post ();
+
+        clock::timestamp_t begin = hrclock.now ();
+        mx.unlock ();
+        clock::timestamp_t end = hrclock.now ();
+        st2.add (begin, end);
+
+        done.wait ();
+      }
+
+    th.join ();
+    st2.print ("mutex-contended", 0);
+  }
+
+  // --------------------------------------------------------------------------
+
+  template<std::size_t N>
+    struct message
+    {
+      char data[N];
+    };
+
+  template<std::size_t N>
+    void
+    bench_message_queue (void)
+    {
+      message_queue_inclusive<message<N>, 1> mq
+        { "bench-mq" };
+      message<N> msg
+        { };
+
+      stats st
+        { overhead_ };
+      for (unsigned int i = 0; i < iterations_; ++i)
+        {
+          clock::timestamp_t begin = hrclock.now ();
+          mq.send (&msg);
+          mq.receive (&msg);
+          clock::timestamp_t end = hrclock.now ();
+          st.add (begin, end);
+        }
+      st.print ("message-queue-send-receive", N);
+    }
+
+  // --------------------------------------------------------------------------
+
+  event_flags* ef_ping;
+  event_flags* ef_pong;
+
+  void*
+  evflags_partner (void* args __attribute__((unused)))
+  {
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        ef_ping->wait (1, nullptr);
+        ef_pong->raise (1);
+      }
+    return nullptr;
+  }
+
+  void
+  bench_event_flags (void)
+  {
+    event_flags ping
+      { "bench-ping" };
+    event_flags pong
+      { "bench-pong" };
+
+    stats st
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        ping.raise (1);
+        ping.wait (1, nullptr);
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+    st.print ("event-flags-raise-wait", 0);
+
+    ef_ping = &ping;
+    ef_pong = &pong;
+
+    thread_inclusive<> th
+      { "bench-ef", evflags_partner, nullptr, partner_attributes () };
+
+    stats st2
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        ping.raise (1);
+        pong.wait (1, nullptr);
+        clock::timestamp_t end = hrclock.now ();
+        st2.add (begin, end);
+      }
+
+    th.join ();
+    st2.print ("event-flags-ping-pong", 0);
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  timer_func (void* args __attribute__((unused)))
+  {
+    ;
+  }
+
+  void
+  bench_timer (void)
+  {
+    timer tm
+      { "bench-tm", timer_func, nullptr };
+
+    stats st
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        tm.start (1000);
+        tm.stop ();
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+    st.print ("timer-start-stop", 0);
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  bench_allocator (std::size_t bytes)
+  {
+    memory::memory_resource* mr = memory::get_default_resource ();
+
+    stats st
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        void* p = mr->allocate (bytes);
+        mr->deallocate (p, bytes);
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+    st.print ("default-resource-alloc-free",
+              static_cast<unsigned int> (bytes));
+  }
+
+  void
+  bench_memory_pool (void)
+  {
+    memory_pool_inclusive<message<32>, 4> mp
+      { "bench-mp" };
+
+    stats st
+      { overhead_ };
+    for (unsigned int i = 0; i < iterations_; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        auto* p = mp.alloc ();
+        mp.free (p);
+        clock::timestamp_t end = hrclock.now ();
+        st.add (begin, end);
+      }
+    st.print ("memory-pool-alloc-free", 32);
+  }
+
+  // --------------------------------------------------------------------------
+
+  // Throughput benchmarks; a number of producer threads pass
+  // messages to a number of consumer threads, in one of the modes:
+  enum class mode
+  {
+    // Copy the messages in and out of the queue.
+    copy,
+    // Fill the queue slots in place, with alloc_slot()/commit(),
+    // and read them in place, with receive_ref()/release().
+    zero_copy,
+    // Send and receive batches of messages, with send_n()/receive_n().
+    batch,
+    // Allocate the messages from a memory pool, and pass
+    // only the pointers through the queue.
+    pool
+  };
+
+  constexpr std::size_t max_threads = 2;
+  constexpr std::size_t max_batch = 8;
+
+  struct tput_run
+  {
+    mode md;
+    std::size_t size;
+    std::size_t depth;
+    message_queue::priority_t prios;
+    std::size_t batch;
+
+    message_queue* mq;
+    memory_pool* mp;
+    semaphore_counting* start;
+  };
+
+  struct tput_thread
+  {
+    tput_run* run;
+    std::size_t messages;
+    char* buffer;
+    // Keep the consumers from being optimised out.
+    unsigned int checksum;
+  };
+
+  void*
+  tput_producer (void* args)
+  {
+    tput_thread* self = static_cast<tput_thread*> (args);
+    tput_run& r = *self->run;
+
+    r.start->wait ();
+
+    std::size_t i = 0;
+    while (i < self->messages)
+      {
+        message_queue::priority_t prio =
+            static_cast<message_queue::priority_t> (i % r.prios);
+        switch (r.md)
+          {
+          case mode::copy:
+            std::memset (self->buffer, static_cast<int> (i), r.size);
+            r.mq->send (self->buffer, r.size, prio);
+            ++i;
+            break;
+
+          case mode::zero_copy:
+            {
+              void* slot = r.mq->alloc_slot ();
+              std::memset (slot, static_cast<int> (i), r.size);
+              r.mq->commit (slot, prio);
+              ++i;
+            }
+            break;
+
+          case mode::batch:
+            {
+              std::size_t n = self->messages - i;
+              if (n > r.batch)
+                {
+                  n = r.batch;
+                }
+              std::memset (self->buffer, static_cast<int> (i), n * r.size);
+              std::size_t sent = 0;
+              r.mq->send_n (self->buffer, n, r.size, &sent, prio);
+              i += sent;
+            }
+            break;
+
+          case mode::pool:
+            {
+              void* block = r.mp->alloc ();
+              std::memset (block, static_cast<int> (i), r.size);
+              r.mq->send (&block, sizeof(block), prio);
+              ++i;
+            }
+            break;
+          }
+      }
+    return nullptr;
+  }
+
+  void*
+  tput_consumer (void* args)
+  {
+    tput_thread* self = static_cast<tput_thread*> (args);
+    tput_run& r = *self->run;
+
+    r.start->wait ();
+
+    unsigned int checksum = 0;
+    std::size_t i = 0;
+    while (i < self->messages)
+      {
+        switch (r.md)
+          {
+          case mode::copy:
+            r.mq->receive (self->buffer, r.size);
+            checksum += static_cast<unsigned char> (self->buffer[r.size - 1]);
+            ++i;
+            break;
+
+          case mode::zero_copy:
+            {
+              void* slot;
+              r.mq->receive_ref (&slot);
+              checksum += static_cast<unsigned char*> (slot)[r.size - 1];
+              r.mq->release (slot);
+              ++i;
+            }
+            break;
+
+          case mode::batch:
+            {
+              std::size_t n = self->messages - i;
+              if (n > r.batch)
+                {
+                  n = r.batch;
+                }
+              std::size_t received = 0;
+              r.mq->receive_n (self->buffer, n, r.size, &received);
+              for (std::size_t j = 0; j < received; ++j)
+                {
+                  checksum += static_cast<unsigned char> (self->buffer[(j + 1)
+                      * r.size - 1]);
+                }
+              i += received;
+            }
+            break;
+
+          case mode::pool:
+            {
+              void* block;
+              r.mq->receive (&block, sizeof(block));
+              checksum += static_cast<unsigned char*> (block)[r.size - 1];
+              r.mp->free (block);
+              ++i;
+            }
+            break;
+          }
+      }
+    self->checksum = checksum;
+    return nullptr;
+  }
+
+  const char*
+  tput_name (mode md)
+  {
+    switch (md)
+      {
+      case mode::copy:
+        return "message-queue-copy";
+      case mode::zero_copy:
+        return "message-queue-zero-copy";
+      case mode::batch:
+        return "message-queue-batch";
+      case mode::pool:
+        return "message-queue-pool";
+      }
+    return "?";
+  }
+
+  void
+  tput_print (const char* name, std::size_t size, std::size_t depth,
+              std::size_t prios, std::size_t producers, std::size_t consumers,
+              std::size_t messages, clock::duration_t cycles)
+  {
+    uint64_t freq = hrclock.input_clock_frequency_hz ();
+    printf ("csv-tput,%s,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu\n", name,
+            static_cast<unsigned int> (size), static_cast<unsigned int> (depth),
+            static_cast<unsigned int> (prios),
+            static_cast<unsigned int> (producers),
+            static_cast<unsigned int> (consumers),
+            static_cast<unsigned int> (messages),
+            static_cast<unsigned long> (cycles),
+            static_cast<unsigned long> (cycles / messages),
+            static_cast<unsigned long> (
+                cycles ? (messages * freq / cycles) : 0));
+  }
+
+  void
+  bench_message_queue_throughput (mode md, std::size_t size, std::size_t depth,
+                                  message_queue::priority_t prios,
+                                  std::size_t producers, std::size_t consumers)
+  {
+    tput_run r;
+    r.md = md;
+    r.size = size;
+    r.depth = depth;
+    r.prios = prios;
+    r.batch = (md == mode::batch) ? std::min (depth, max_batch) : 1;
+
+    // Split the messages evenly, in full batches.
+    std::size_t chunk = r.batch * producers * consumers;
+    std::size_t messages = ((iterations_ + chunk - 1) / chunk) * chunk;
+
+    // The messages use `prios` different priorities, in turn.
+    message_queue mq
+      { "bench-mq", depth, (md == mode::pool) ? sizeof(void*) : size };
+    r.mq = &mq;
+
+    memory_pool* mp = nullptr;
+    if (md == mode::pool)
+      {
+        mp = new memory_pool
+          { "bench-mp", depth + producers, size };
+      }
+    r.mp = mp;
+
+    semaphore_counting start
+      { "bench-start", static_cast<semaphore::count_t> (producers + consumers),
+          0 };
+    r.start = &start;
+
+    tput_thread args[2 * max_threads];
+    thread* th[2 * max_threads];
+    std::size_t n = producers + consumers;
+    for (std::size_t i = 0; i < n; ++i)
+      {
+        bool is_producer = (i < producers);
+        args[i].run = &r;
+        args[i].messages = messages / (is_producer ? producers : consumers);
+        args[i].buffer = new char[r.batch * size];
+        args[i].checksum = 0;
+
+        th[i] = new thread
+          { is_producer ? "bench-prod" : "bench-cons",
+              is_producer ? tput_producer : tput_consumer, &args[i],
+              partner_attributes () };
+      }
+
+    // The threads wait for the start semaphore; release all of them
+    // at once, with the scheduler locked, so that none starts
+    // before all are ready.
+    clock::timestamp_t begin = hrclock.now ();
+      {
+        scheduler::critical_section scs;
+
+        for (std::size_t i = 0; i < n; ++i)
+          {
+            start.post ();
+          }
+      }
+
+    for (std::size_t i = 0; i < n; ++i)
+      {
+        th[i]->join ();
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    for (std::size_t i = 0; i < n; ++i)
+      {
+        delete th[i];
+        delete[] args[i].buffer;
+      }
+    delete mp;
+
+    tput_print (tput_name (md), size, depth, prios, producers, consumers,
+                messages, static_cast<clock::duration_t> (end - begin));
+  }
+
+  void
+  bench_message_queue_throughput (void)
+  {
+    static const std::size_t sizes[] =
+      { 4, 16, 64, 256, 1024 };
+    static const std::size_t depths[] =
+      { 1, 4, 16 };
+    static const message_queue::priority_t prios[] =
+      { 1, 4 };
+    static const mode modes[] =
+      { mode::copy, mode::zero_copy, mode::batch, mode::pool };
+
+    for (auto md : modes)
+      {
+        for (auto size : sizes)
+          {
+            for (auto depth : depths)
+              {
+                for (auto prio : prios)
+                  {
+                    for (std::size_t t = 1; t <= max_threads; ++t)
+                      {
+                        bench_message_queue_throughput (md, size, depth, prio,
+                                                        t, t);
+                      }
+                  }
+              }
+          }
+      }
+  }
+
+  // --------------------------------------------------------------------------
+
+  memory_pool* mp_shared;
+
+  void*
+  pool_worker (void* args)
+  {
+    tput_thread* self = static_cast<tput_thread*> (args);
+
+    self->run->start->wait ();
+
+    for (std::size_t i = 0; i < self->messages; ++i)
+      {
+        void* block = mp_shared->alloc ();
+        static_cast<char*> (block)[0] = static_cast<char> (i);
+        mp_shared->free (block);
+      }
+    return nullptr;
+  }
+
+  void
+  bench_memory_pool_throughput (std::size_t size, std::size_t threads)
+  {
+    std::size_t messages = ((iterations_ + threads - 1) / threads) * threads;
+
+    memory_pool mp
+      { "bench-mp", threads, size };
+    mp_shared = &mp;
+
+    semaphore_counting start
+      { "bench-start", static_cast<semaphore::count_t> (threads), 0 };
+
+    tput_run r;
+    r.start = &start;
+
+    tput_thread args[2 * max_threads];
+    thread* th[2 * max_threads];
+    for (std::size_t i = 0; i < threads; ++i)
+      {
+        args[i].run = &r;
+        args[i].messages = messages / threads;
+        args[i].buffer = nullptr;
+        args[i].checksum = 0;
+
+        th[i] = new thread
+          { "bench-pool", pool_worker, &args[i], partner_attributes () };
+      }
+
+    clock::timestamp_t begin = hrclock.now ();
+      {
+        scheduler::critical_section scs;
+
+        for (std::size_t i = 0; i < threads; ++i)
+          {
+            start.post ();
+          }
+      }
+
+    for (std::size_t i = 0; i < threads; ++i)
+      {
+        th[i]->join ();
+        delete th[i];
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    tput_print ("memory-pool-alloc-free", size, threads, 1, threads, 0,
+                messages, static_cast<clock::duration_t> (end - begin));
+  }
+
+  void
+  bench_memory_pool_throughput (void)
+  {
+    static const std::size_t sizes[] =
+      { 4, 64, 1024 };
+
+    for (auto size : sizes)
+      {
+        for (std::size_t t = 1; t <= 2 * max_threads; t *= 2)
+          {
+            bench_memory_pool_throughput (size, t);
+          }
+      }
+  }
+
+} /* namespace */
+
+// ----------------------------------------------------------------------------
+
+int
+run_tests (unsigned int iterations)
+{
+  iterations_ = iterations;
+
+  printf ("# %u iterations, hrclock %u Hz.\n", iterations,
+          static_cast<unsigned int> (hrclock.input_clock_frequency_hz ()));
+  printf ("csv,name,param,iterations,min,avg,max\n");
+
+  bench_overhead ();
+  bench_context_switch ();
+  bench_semaphore ();
+  bench_mutex ();
+
+  bench_message_queue<4> ();
+  bench_message_queue<16> ();
+  bench_message_queue<64> ();
+
+  bench_event_flags ();
+  bench_timer ();
+
+  bench_allocator (16);
+  bench_allocator (64);
+  bench_allocator (256);
+  bench_memory_pool ();
+
+  printf ("csv-tput,name,size,depth,prios,producers,consumers,messages,"
+          "cycles,cycles-per-message,messages-per-second\n");
+
+  bench_message_queue_throughput ();
+  bench_memory_pool_throughput ();
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
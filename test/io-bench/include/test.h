@@ -0,0 +1,59 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <cstddef>
+
+namespace os
+{
+  namespace posix
+  {
+    class block_device;
+  } /* namespace posix */
+} /* namespace os */
+
+int
+run_tests (std::size_t kilobytes);
+
+/**
+ * @brief Get the SD card block device, if any.
+ * @par Parameters
+ *  None.
+ * @return Pointer to the block device, or `nullptr`.
+ *
+ * @details
+ * The default (weak) definition returns `nullptr`; the board
+ * support code can redefine it, to also run the benchmarks
+ * on a real card. All data on the card is lost.
+ */
+os::posix::block_device*
+test_sd_block_device (void);
+
+#endif /* TEST_H_ */
@@ -0,0 +1,577 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Throughput of the block devices and of the files.
+ *
+ * The block devices are tested raw, via a partition and via
+ * a cache (with read-ahead), with sequential and random
+ * transfers of several sizes; the files are tested on a FAT
+ * file system, on the raw and on the cached device.
+ *
+ * The devices are two RAM disks, one without delays, to measure
+ * the software overhead, and one with delays similar to those
+ * of an SD card, to measure the benefit of the cache; if
+ * `test_sd_block_device()` is redefined, the SD card
+ * is also tested.
+ *
+ * The results are printed as CSV lines, after a header line
+ * starting with `csv,`:
+ *
+ *   csv,device,layer,test,transfer,bytes,ops,cycles,kib-per-s,ops-per-s
+ *
+ * where `transfer` is the size of each read or write, in bytes,
+ * and `cycles` is the total duration, in hrclock cycles.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/posix-io/block-device-cache.h>
+#include <cmsis-plus/posix-io/block-device-partition.h>
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+#include <cmsis-plus/posix/sys/ioctl.h>
+
+#if !defined(TEST_EXCLUDE_CHAN_FATFS)
+#include <cmsis-plus/posix-io/chan-fatfs-file-system.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <test.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+// A RAM disk, with optional delays, in microseconds,
+// for each command and for each block.
+class ram_disk_impl : public posix::block_device_impl
+{
+public:
+
+  ram_disk_impl (std::size_t bsize, std::size_t nblocks,
+                 uint32_t command_us, uint32_t block_us);
+
+  // The rule of five.
+  ram_disk_impl (const ram_disk_impl&) = delete;
+  ram_disk_impl (ram_disk_impl&&) = delete;
+  ram_disk_impl&
+  operator= (const ram_disk_impl&) = delete;
+  ram_disk_impl&
+  operator= (ram_disk_impl&&) = delete;
+
+  virtual
+  ~ram_disk_impl () override;
+
+  virtual int
+  do_vopen (const char* path, int oflag, std::va_list args) override;
+
+  virtual ssize_t
+  do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+  virtual ssize_t
+  do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+      override;
+
+  virtual int
+  do_vioctl (int request, std::va_list args) override;
+
+  virtual void
+  do_sync (void) override;
+
+  virtual int
+  do_close (void) override;
+
+protected:
+
+  void
+  delay_ (std::size_t nblocks);
+
+  uint8_t* arena_;
+  clock::duration_t command_cycles_;
+  clock::duration_t block_cycles_;
+};
+
+ram_disk_impl::ram_disk_impl (std::size_t bsize, std::size_t nblocks,
+                              uint32_t command_us, uint32_t block_us)
+{
+  num_blocks_ = nblocks;
+  block_logical_size_bytes_ = bsize;
+  block_physical_size_bytes_ = bsize;
+
+  uint64_t freq = hrclock.input_clock_frequency_hz ();
+  command_cycles_ = static_cast<clock::duration_t> (command_us * freq
+      / 1000000u);
+  block_cycles_ = static_cast<clock::duration_t> (block_us * freq / 1000000u);
+
+  arena_ = new uint8_t[nblocks * bsize];
+  std::memset (arena_, 0xFF, nblocks * bsize);
+}
+
+ram_disk_impl::~ram_disk_impl ()
+{
+  delete[] arena_;
+}
+
+void
+ram_disk_impl::delay_ (std::size_t nblocks)
+{
+  clock::duration_t cycles = command_cycles_
+      + static_cast<clock::duration_t> (nblocks * block_cycles_);
+  if (cycles == 0)
+    {
+      return;
+    }
+
+  // Busy wait, as most drivers do for short transfers.
+  clock::timestamp_t begin = hrclock.now ();
+  while (static_cast<clock::duration_t> (hrclock.now () - begin) < cycles)
+    {
+      ;
+    }
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+int
+ram_disk_impl::do_vopen (const char* path, int oflag, std::va_list args)
+{
+  return 0;
+}
+
+ssize_t
+ram_disk_impl::do_read_block (void* buf, blknum_t blknum,
+                              std::size_t nblocks)
+{
+  delay_ (nblocks);
+  std::memcpy (buf, &arena_[blknum * block_logical_size_bytes_],
+               nblocks * block_logical_size_bytes_);
+  return static_cast<ssize_t> (nblocks);
+}
+
+ssize_t
+ram_disk_impl::do_write_block (const void* buf, blknum_t blknum,
+                               std::size_t nblocks)
+{
+  delay_ (nblocks);
+  std::memcpy (&arena_[blknum * block_logical_size_bytes_], buf,
+               nblocks * block_logical_size_bytes_);
+  return static_cast<ssize_t> (nblocks);
+}
+
+int
+ram_disk_impl::do_vioctl (int request, std::va_list args)
+{
+  errno = ENOSYS;
+  return -1;
+}
+
+void
+ram_disk_impl::do_sync (void)
+{
+  ;
+}
+
+int
+ram_disk_impl::do_close (void)
+{
+  return 0;
+}
+
+#pragma GCC diagnostic pop
+
+// Explicit template instantiation.
+template class posix::block_device_implementable<ram_disk_impl>;
+template class posix::block_device_partition_implementable<>;
+template class posix::block_device_cache_implementable<>;
+
+namespace
+{
+  // Used to allocate the file descriptors.
+  posix::file_descriptors_manager descriptors_manager
+    { 8 };
+
+  using ram_disk = posix::block_device_implementable<ram_disk_impl>;
+  using partition = posix::block_device_partition_implementable<>;
+  using cache = posix::block_device_cache_implementable<>;
+
+  // --------------------------------------------------------------------------
+
+  constexpr std::size_t block_size = 512;
+  // 64 KB, large enough for a FAT12 file system.
+  constexpr std::size_t disk_blocks = 128;
+  // The partition skips the first blocks, as a partition table would.
+  constexpr std::size_t partition_offset = 8;
+  constexpr std::size_t cache_blocks = 16;
+  constexpr std::size_t readahead_blocks = 8;
+
+  constexpr std::size_t max_transfer = 16 * block_size;
+
+  std::size_t total_bytes_;
+  uint8_t buffer_[max_transfer];
+
+  // A simple deterministic pseudo random generator (xorshift32).
+  uint32_t random_state_;
+
+  uint32_t
+  random (void)
+  {
+    random_state_ ^= random_state_ << 13;
+    random_state_ ^= random_state_ >> 17;
+    random_state_ ^= random_state_ << 5;
+    return random_state_;
+  }
+
+  void
+  print (const char* device, const char* layer, const char* test,
+         std::size_t transfer, std::size_t bytes, std::size_t ops,
+         clock::duration_t cycles)
+  {
+    uint64_t freq = hrclock.input_clock_frequency_hz ();
+    unsigned long kibps = 0;
+    unsigned long opsps = 0;
+    if (cycles != 0)
+      {
+        kibps = static_cast<unsigned long> (bytes * freq / cycles / 1024);
+        opsps = static_cast<unsigned long> (ops * freq / cycles);
+      }
+    printf ("csv,%s,%s,%s,%u,%u,%u,%lu,%lu,%lu\n", device, layer, test,
+            static_cast<unsigned int> (transfer),
+            static_cast<unsigned int> (bytes), static_cast<unsigned int> (ops),
+            static_cast<unsigned long> (cycles), kibps, opsps);
+  }
+
+  // --------------------------------------------------------------------------
+
+  enum class access
+  {
+    sequential, random
+  };
+
+  void
+  bench_blocks (const char* device, const char* layer, posix::block_device& bd,
+                access acc, bool write, std::size_t nblocks)
+  {
+    std::size_t blocks = bd.blocks ();
+    if (blocks < nblocks)
+      {
+        return;
+      }
+
+    std::size_t transfer = nblocks * bd.block_logical_size_bytes ();
+    std::size_t ops = (total_bytes_ + transfer - 1) / transfer;
+    std::size_t slots = blocks / nblocks;
+
+    std::memset (buffer_, 0x5A, transfer);
+    random_state_ = 0x12345678;
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (std::size_t i = 0; i < ops; ++i)
+      {
+        std::size_t slot =
+            (acc == access::sequential) ? (i % slots) : (random () % slots);
+        posix::block_device::blknum_t blknum = slot * nblocks;
+        ssize_t ret;
+        if (write)
+          {
+            ret = bd.write_block (buffer_, blknum, nblocks);
+          }
+        else
+          {
+            ret = bd.read_block (buffer_, blknum, nblocks);
+          }
+        if (ret != static_cast<ssize_t> (nblocks))
+          {
+            printf ("# %s %s: transfer failed, errno=%d\n", device, layer,
+                    errno);
+            return;
+          }
+      }
+    if (write)
+      {
+        // Cached writes count only when they reach the device.
+        bd.sync ();
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    const char* test =
+        (acc == access::sequential) ?
+            (write ? "seq-write" : "seq-read") :
+            (write ? "rand-write" : "rand-read");
+    print (device, layer, test, transfer, ops * transfer, ops,
+           static_cast<clock::duration_t> (end - begin));
+  }
+
+  void
+  bench_block_device (const char* device, const char* layer,
+                      posix::block_device& bd)
+  {
+    if (bd.open () < 0)
+      {
+        printf ("# %s %s: open failed, errno=%d\n", device, layer, errno);
+        return;
+      }
+
+    static const std::size_t sizes[] =
+      { 1, 4, 16 };
+    for (auto nblocks : sizes)
+      {
+        bench_blocks (device, layer, bd, access::sequential, true, nblocks);
+        bench_blocks (device, layer, bd, access::sequential, false, nblocks);
+        bench_blocks (device, layer, bd, access::random, true, nblocks);
+        bench_blocks (device, layer, bd, access::random, false, nblocks);
+      }
+
+    bd.close ();
+  }
+
+  // --------------------------------------------------------------------------
+
+#if !defined(TEST_EXCLUDE_CHAN_FATFS)
+
+  const char* file_name = "/bench.bin";
+
+  void
+  bench_file (const char* device, const char* layer, posix::file_system& fs,
+              access acc, bool write, std::size_t transfer,
+              std::size_t file_bytes)
+  {
+    posix::file* f = fs.open (file_name, write ? O_RDWR : O_RDONLY);
+    if (f == nullptr)
+      {
+        printf ("# %s %s: file open failed, errno=%d\n", device, layer, errno);
+        return;
+      }
+
+    std::size_t ops = (total_bytes_ + transfer - 1) / transfer;
+    std::size_t slots = file_bytes / transfer;
+
+    std::memset (buffer_, 0xA5, transfer);
+    random_state_ = 0x87654321;
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (std::size_t i = 0; i < ops; ++i)
+      {
+        std::size_t slot =
+            (acc == access::sequential) ? (i % slots) : (random () % slots);
+        if (acc == access::random || slot == 0)
+          {
+            f->lseek (static_cast<off_t> (slot * transfer), SEEK_SET);
+          }
+        ssize_t ret;
+        if (write)
+          {
+            ret = f->write (buffer_, transfer);
+          }
+        else
+          {
+            ret = f->read (buffer_, transfer);
+          }
+        if (ret != static_cast<ssize_t> (transfer))
+          {
+            printf ("# %s %s: file transfer failed, errno=%d\n", device,
+                    layer, errno);
+            break;
+          }
+      }
+    // The data must reach the device.
+    f->close ();
+    if (write)
+      {
+        fs.sync ();
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    const char* test =
+        (acc == access::sequential) ?
+            (write ? "file-seq-write" : "file-seq-read") :
+            (write ? "file-rand-write" : "file-rand-read");
+    print (device, layer, test, transfer, ops * transfer, ops,
+           static_cast<clock::duration_t> (end - begin));
+  }
+
+  void
+  bench_file_system (const char* device, const char* layer,
+                     posix::block_device& bd)
+  {
+    posix::chan_fatfs_file_system fs
+      { "bench-fat", bd };
+
+    static constexpr std::size_t work_size = FF_MAX_SS + 4;
+    uint8_t* work = new uint8_t[work_size];
+
+    int res = fs.device ().open ();
+    if (res >= 0)
+      {
+        res = fs.mkfs (FM_FAT | FM_SFD, 0, 0, work, work_size);
+        fs.device ().close ();
+      }
+    delete[] work;
+
+    if (res != 0 || fs.mount () != 0)
+      {
+        printf ("# %s %s: file system failed, errno=%d\n", device, layer,
+                errno);
+        return;
+      }
+
+    // Half of the disk, so it fits with the file system structures.
+    std::size_t file_bytes = bd.blocks () * bd.block_logical_size_bytes ()
+        / 2;
+
+    // Create the file, with its full size, so the random writes
+    // do not extend it.
+    posix::file* f = fs.open (file_name, O_WRONLY | O_CREAT);
+    if (f != nullptr)
+      {
+        std::memset (buffer_, 0, max_transfer);
+        for (std::size_t i = 0; i < file_bytes; i += max_transfer)
+          {
+            f->write (buffer_, max_transfer);
+          }
+        f->close ();
+      }
+
+    static const std::size_t sizes[] =
+      { 512, 4096, max_transfer };
+    for (auto transfer : sizes)
+      {
+        bench_file (device, layer, fs, access::sequential, true, transfer,
+                    file_bytes);
+        bench_file (device, layer, fs, access::sequential, false, transfer,
+                    file_bytes);
+        bench_file (device, layer, fs, access::random, true, transfer,
+                    file_bytes);
+        bench_file (device, layer, fs, access::random, false, transfer,
+                    file_bytes);
+      }
+
+    fs.umount ();
+  }
+
+#endif /* !defined(TEST_EXCLUDE_CHAN_FATFS) */
+
+  // --------------------------------------------------------------------------
+
+  void
+  bench_device (const char* device, posix::block_device& bd)
+  {
+    bench_block_device (device, "raw", bd);
+
+      {
+        partition part
+          { "bench-part", bd };
+        if (bd.open () >= 0)
+          {
+            part.configure (partition_offset, bd.blocks () - partition_offset);
+            bd.close ();
+            bench_block_device (device, "partition", part);
+          }
+      }
+
+      {
+        cache ch
+          { "bench-cache", bd, cache_blocks };
+        if (ch.open () >= 0)
+          {
+            ch.ioctl (BLKRASET, readahead_blocks);
+            ch.close ();
+          }
+        bench_block_device (device, "cache", ch);
+      }
+
+#if !defined(TEST_EXCLUDE_CHAN_FATFS)
+
+    bench_file_system (device, "raw", bd);
+
+      {
+        cache ch
+          { "bench-cache", bd, cache_blocks };
+        if (ch.open () >= 0)
+          {
+            ch.ioctl (BLKRASET, readahead_blocks);
+            ch.close ();
+          }
+        bench_file_system (device, "cache", ch);
+      }
+
+#endif /* !defined(TEST_EXCLUDE_CHAN_FATFS) */
+  }
+
+} /* namespace */
+
+// ----------------------------------------------------------------------------
+
+posix::block_device*
+__attribute__((weak))
+test_sd_block_device (void)
+{
+  return nullptr;
+}
+
+int
+run_tests (std::size_t kilobytes)
+{
+  total_bytes_ = kilobytes * 1024;
+
+  printf ("# %u KB per test, hrclock %u Hz.\n",
+          static_cast<unsigned int> (kilobytes),
+          static_cast<unsigned int> (hrclock.input_clock_frequency_hz ()));
+  printf ("csv,device,layer,test,transfer,bytes,ops,cycles,"
+          "kib-per-s,ops-per-s\n");
+
+    {
+      ram_disk disk
+        { "bench-ram", block_size, disk_blocks, 0u, 0u };
+      bench_device ("ram", disk);
+    }
+
+    {
+      // About the delays of an SD card on a 4-bit bus at 25 MHz.
+      ram_disk disk
+        { "bench-ram-sd", block_size, disk_blocks, 100u, 50u };
+      bench_device ("ram-sd", disk);
+    }
+
+  posix::block_device* sd = test_sd_block_device ();
+  if (sd != nullptr)
+    {
+      bench_device ("sd", *sd);
+    }
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
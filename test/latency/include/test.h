@@ -0,0 +1,74 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <cstdint>
+
+int
+run_tests (uint32_t period_cycles, unsigned int duration_ms);
+
+// ----------------------------------------------------------------------------
+
+// The latency timer is device specific, and must be provided by
+// the application; without it, only the critical sections are
+// measured.
+
+extern "C"
+{
+  /**
+   * Start a periodic timer interrupt, clocked by the CPU clock,
+   * and return true if started.
+   */
+  bool
+  latency_timer_start (uint32_t period_cycles);
+
+  /**
+   * Stop the timer interrupt.
+   */
+  void
+  latency_timer_stop (void);
+
+  /**
+   * Return the number of CPU cycles since the timer event, usually
+   * the timer counter value; called first in the interrupt handler.
+   */
+  uint32_t
+  latency_timer_elapsed (void);
+
+  /**
+   * Defined by the test, must be called from the timer interrupt
+   * handler, after clearing the interrupt request.
+   */
+  void
+  latency_timer_isr (void);
+}
+
+#endif /* TEST_H_ */
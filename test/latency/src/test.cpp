@@ -0,0 +1,578 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/*
+ * Interrupt latency and critical sections measurements.
+ *
+ * A device timer fires an interrupt every `period_cycles` CPU
+ * cycles, while a background load runs kernel operations; for each
+ * load, the handler entry latency (the cycles from the timer event
+ * to the handler, as reported by `latency_timer_elapsed()`) and
+ * the intervals between consecutive handlers are recorded, together
+ * with the longest interrupts critical sections, measured with
+ * OS_INCLUDE_PROFILE_CRITICAL_SECTIONS.
+ *
+ * The results are printed as CSV lines, in CPU cycles:
+ *
+ *   csv,latency,load,count,min,avg,max
+ *   csv,interval,load,count,min,max
+ *   csv,histogram,load,from,count
+ *   csv,critical,load,pc,count,avg,max
+ *
+ * The histogram buckets are `bucket_cycles` wide, and only the
+ * non empty ones are printed; the last bucket also counts all
+ * longer latencies. The jitter is the difference between the
+ * maximum and the minimum interval. The critical sections
+ * addresses can be resolved with `addr2line -f -e app.elf`.
+ * Lines not starting with `csv,` are comments.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+#include <cmsis-plus/diag/profile.h>
+
+#include <cstdio>
+
+#include <test.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t buckets = 64;
+  constexpr uint32_t bucket_cycles = 8;
+
+  // The number of critical sections printed for each load.
+  constexpr std::size_t worst_sites = 8;
+
+  // Updated by the interrupt handler.
+  class histogram
+  {
+  public:
+
+    void
+    reset (void)
+    {
+      for (std::size_t i = 0; i < buckets; ++i)
+        {
+          counts_[i] = 0;
+        }
+      min_ = 0;
+      max_ = 0;
+      sum_ = 0;
+      count_ = 0;
+    }
+
+    void
+    add (uint32_t cycles)
+    {
+      std::size_t i = cycles / bucket_cycles;
+      ++counts_[i < buckets ? i : buckets - 1];
+
+      if (count_ == 0 || cycles < min_)
+        {
+          min_ = cycles;
+        }
+      if (cycles > max_)
+        {
+          max_ = cycles;
+        }
+      sum_ += cycles;
+      ++count_;
+    }
+
+    void
+    print (const char* name) const
+    {
+      printf ("csv,latency,%s,%u,%u,%u,%u\n", name, count_, min_,
+              count_ ? static_cast<uint32_t> (sum_ / count_) : 0u, max_);
+      for (std::size_t i = 0; i < buckets; ++i)
+        {
+          if (counts_[i] != 0)
+            {
+              printf ("csv,histogram,%s,%u,%u\n", name,
+                      static_cast<uint32_t> (i * bucket_cycles), counts_[i]);
+            }
+        }
+    }
+
+  private:
+
+    uint32_t counts_[buckets];
+    uint32_t min_;
+    uint32_t max_;
+    uint64_t sum_;
+    uint32_t count_;
+  };
+
+  histogram latency_;
+
+  // The intervals between consecutive interrupts.
+  uint32_t interval_min_;
+  uint32_t interval_max_;
+  uint32_t interval_count_;
+  profile::cycles_t last_;
+
+  volatile bool measuring_;
+  bool has_timer_;
+  clock::duration_t duration_;
+
+  void
+  reset_stats (void)
+  {
+    // ----- Enter critical section -------------------------------------------
+    interrupts::critical_section ics;
+
+    latency_.reset ();
+    interval_min_ = 0;
+    interval_max_ = 0;
+    interval_count_ = 0;
+    last_ = 0;
+    // ----- Exit critical section --------------------------------------------
+  }
+
+  // --------------------------------------------------------------------------
+
+  // Print the longest critical sections, with a snapshot taken
+  // at once, since the table changes while printing.
+  void
+  print_critical_sections (const char* name)
+  {
+    profile::critical_sections::site worst[worst_sites] =
+      { };
+    std::size_t n = 0;
+
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      const profile::critical_sections::site* sites =
+          profile::critical_sections::sites ();
+      for (std::size_t i = 0; i < profile::critical_sections::capacity ();
+          ++i)
+        {
+          const profile::critical_sections::site& s = sites[i];
+          if (s.pc == nullptr)
+            {
+              continue;
+            }
+
+          // Insert in the list ordered by the longest window.
+          std::size_t j = (n < worst_sites) ? n++ : worst_sites;
+          while (j > 0 && worst[j - 1].max < s.max)
+            {
+              if (j < worst_sites)
+                {
+                  worst[j] = worst[j - 1];
+                }
+              --j;
+            }
+          if (j < worst_sites)
+            {
+              worst[j] = s;
+            }
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    for (std::size_t i = 0; i < n; ++i)
+      {
+        printf ("csv,critical,%s,%p,%u,%u,%u\n", name, worst[i].pc,
+                worst[i].count,
+                static_cast<uint32_t> (worst[i].sum / worst[i].count),
+                worst[i].max);
+      }
+  }
+
+  using load_t = void (*) (clock::timestamp_t deadline);
+
+  void
+  run_load (const char* name, load_t load)
+  {
+    reset_stats ();
+    profile::critical_sections::reset ();
+
+    measuring_ = true;
+    load (sysclock.now () + duration_);
+    measuring_ = false;
+
+    if (has_timer_)
+      {
+        latency_.print (name);
+        printf ("csv,interval,%s,%u,%u,%u\n", name, interval_count_,
+                interval_min_, interval_max_);
+      }
+    print_critical_sections (name);
+  }
+
+  // --------------------------------------------------------------------------
+
+  volatile bool running_;
+
+  // The partner threads run at a higher priority than the
+  // main thread, so they run as soon as they are made ready.
+  thread::attributes
+  partner_attributes (void)
+  {
+    thread::attributes attr;
+    attr.th_priority = thread::priority::above_normal;
+    return attr;
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  load_idle (clock::timestamp_t deadline)
+  {
+    // The idle thread runs, with the core possibly sleeping.
+    sysclock.sleep_until (deadline);
+  }
+
+  // --------------------------------------------------------------------------
+
+  void*
+  yield_partner (void* args __attribute__((unused)))
+  {
+    while (running_)
+      {
+        this_thread::yield ();
+      }
+    return nullptr;
+  }
+
+  void
+  load_yield (clock::timestamp_t deadline)
+  {
+    running_ = true;
+    thread_inclusive<> th
+      { "lat-yield", yield_partner, nullptr };
+
+    while (sysclock.now () < deadline)
+      {
+        this_thread::yield ();
+      }
+
+    running_ = false;
+    th.join ();
+  }
+
+  // --------------------------------------------------------------------------
+
+  semaphore_binary* sem_ping;
+  semaphore_binary* sem_pong;
+
+  void*
+  sem_partner (void* args __attribute__((unused)))
+  {
+    for (;;)
+      {
+        sem_ping->wait ();
+        if (!running_)
+          {
+            break;
+          }
+        sem_pong->post ();
+      }
+    return nullptr;
+  }
+
+  void
+  load_semaphore (clock::timestamp_t deadline)
+  {
+    semaphore_binary ping
+      { "lat-ping", 0 };
+    semaphore_binary pong
+      { "lat-pong", 0 };
+    sem_ping = &ping;
+    sem_pong = &pong;
+
+    running_ = true;
+    thread_inclusive<> th
+      { "lat-sem", sem_partner, nullptr, partner_attributes () };
+
+    while (sysclock.now () < deadline)
+      {
+        ping.post ();
+        pong.wait ();
+      }
+
+    running_ = false;
+    ping.post ();
+    th.join ();
+  }
+
+  // --------------------------------------------------------------------------
+
+  mutex* mx_shared;
+
+  void*
+  mutex_partner (void* args __attribute__((unused)))
+  {
+    // Wake up on each tick and take the mutex, usually owned by
+    // the lower priority main thread, which inherits the priority.
+    while (running_)
+      {
+        mx_shared->lock ();
+        mx_shared->unlock ();
+        sysclock.sleep_for (1);
+      }
+    return nullptr;
+  }
+
+  void
+  load_mutex (clock::timestamp_t deadline)
+  {
+    mutex mx
+      { "lat-mx" };
+    mx_shared = &mx;
+
+    running_ = true;
+    thread_inclusive<> th
+      { "lat-mx", mutex_partner, nullptr, partner_attributes () };
+
+    while (sysclock.now () < deadline)
+      {
+        mx.lock ();
+        mx.unlock ();
+      }
+
+    running_ = false;
+    th.join ();
+  }
+
+  // --------------------------------------------------------------------------
+
+  using mq_type = message_queue_inclusive<uint32_t, 4>;
+  mq_type* mq_shared;
+
+  void*
+  mq_partner (void* args __attribute__((unused)))
+  {
+    for (;;)
+      {
+        uint32_t v;
+        mq_shared->receive (&v);
+        if (v == 0)
+          {
+            break;
+          }
+      }
+    return nullptr;
+  }
+
+  void
+  load_message_queue (clock::timestamp_t deadline)
+  {
+    mq_type mq
+      { "lat-mq" };
+    mq_shared = &mq;
+
+    thread_inclusive<> th
+      { "lat-mq", mq_partner, nullptr, partner_attributes () };
+
+    uint32_t v = 1;
+    while (sysclock.now () < deadline)
+      {
+        mq.send (&v);
+      }
+
+    v = 0;
+    mq.send (&v);
+    th.join ();
+  }
+
+  // --------------------------------------------------------------------------
+
+  event_flags* ef_shared;
+
+  void*
+  evflags_partner (void* args __attribute__((unused)))
+  {
+    for (;;)
+      {
+        flags::mask_t f;
+        ef_shared->wait (0x3, &f, flags::mode::any | flags::mode::clear);
+        if (f & 0x2)
+          {
+            break;
+          }
+      }
+    return nullptr;
+  }
+
+  void
+  load_event_flags (clock::timestamp_t deadline)
+  {
+    event_flags ef
+      { "lat-ef" };
+    ef_shared = &ef;
+
+    thread_inclusive<> th
+      { "lat-ef", evflags_partner, nullptr, partner_attributes () };
+
+    while (sysclock.now () < deadline)
+      {
+        ef.raise (0x1);
+      }
+
+    ef.raise (0x2);
+    th.join ();
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  timer_func (void* args __attribute__((unused)))
+  {
+    ;
+  }
+
+  void
+  load_timer (clock::timestamp_t deadline)
+  {
+    timer tm
+      { "lat-tm", timer_func, nullptr };
+
+    while (sysclock.now () < deadline)
+      {
+        tm.start (1);
+        tm.stop ();
+      }
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  load_allocator (clock::timestamp_t deadline)
+  {
+    memory::memory_resource* mr = memory::get_default_resource ();
+
+    while (sysclock.now () < deadline)
+      {
+        void* p = mr->allocate (64);
+        mr->deallocate (p, 64);
+      }
+  }
+
+} /* namespace */
+
+// ----------------------------------------------------------------------------
+
+// Default definitions, for devices without a latency timer.
+
+bool
+__attribute__((weak))
+latency_timer_start (uint32_t period_cycles __attribute__((unused)))
+{
+  return false;
+}
+
+void
+__attribute__((weak))
+latency_timer_stop (void)
+{
+  ;
+}
+
+uint32_t
+__attribute__((weak))
+latency_timer_elapsed (void)
+{
+  return 0;
+}
+
+void
+latency_timer_isr (void)
+{
+  uint32_t elapsed = latency_timer_elapsed ();
+  profile::cycles_t now = profile::now ();
+
+  if (!measuring_)
+    {
+      return;
+    }
+
+  latency_.add (elapsed);
+
+  if (last_ != 0)
+    {
+      uint32_t interval = now - last_;
+      if (interval_count_ == 0 || interval < interval_min_)
+        {
+          interval_min_ = interval;
+        }
+      if (interval > interval_max_)
+        {
+          interval_max_ = interval;
+        }
+      ++interval_count_;
+    }
+  last_ = now;
+}
+
+// ----------------------------------------------------------------------------
+
+int
+run_tests (uint32_t period_cycles, unsigned int duration_ms)
+{
+  profile::initialize ();
+
+  duration_ = sysclock.ticks_cast (duration_ms * 1000u);
+  has_timer_ = latency_timer_start (period_cycles);
+
+  if (has_timer_)
+    {
+      printf ("# Timer period %u cycles, %u ms for each load.\n",
+              period_cycles, duration_ms);
+    }
+  else
+    {
+      printf ("# No latency timer, only the critical sections are "
+              "measured, %u ms for each load.\n",
+              duration_ms);
+    }
+
+  run_load ("idle", load_idle);
+  run_load ("yield", load_yield);
+  run_load ("semaphore", load_semaphore);
+  run_load ("mutex", load_mutex);
+  run_load ("message-queue", load_message_queue);
+  run_load ("event-flags", load_event_flags);
+  run_load ("timer", load_timer);
+  run_load ("allocator", load_allocator);
+
+  latency_timer_stop ();
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
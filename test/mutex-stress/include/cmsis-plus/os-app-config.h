@@ -41,6 +41,9 @@
 
 #define OS_INTEGER_RTOS_MAIN_STACK_SIZE_BYTES               (2*os::rtos::port::stack::default_size_bytes)
 
+// Lock free mutexes without the scheduler critical section.
+#define OS_INCLUDE_RTOS_MUTEX_FAST_PATH
+
 // ----------------------------------------------------------------------------
 
 #if defined(USE_FREERTOS)
@@ -30,8 +30,19 @@
 
 #include <cstdint>
 
+// From the command line.
+struct soak_config_t
+{
+  // 0 runs forever.
+  unsigned int seconds;
+  unsigned int threads;
+  unsigned int interval_seconds;
+  // The workers are spread over consecutive priorities above normal.
+  unsigned int priority_levels;
+};
+
 int
-run_tests (unsigned int seconds);
+run_tests (const soak_config_t& config);
 
 void
 busy_wait (unsigned int micros);
@@ -80,10 +80,16 @@ busy_wait (unsigned int micros)
 int
 os_main (int argc, char* argv[])
 {
-  unsigned int seconds = 30;
-  if (argc > 1)
+  // mutex-stress [seconds [threads [interval [priority-levels]]]]
+  soak_config_t config
+    { 30, 10, 5, 1 };
+  unsigned int* args[] =
+    { &config.seconds, &config.threads, &config.interval_seconds,
+        &config.priority_levels };
+  for (int i = 1; i < argc && i <= static_cast<int> (sizeof(args)
+      / sizeof(args[0])); ++i)
     {
-      seconds = static_cast<unsigned int> (atoi (argv[1]));
+      *args[i - 1] = static_cast<unsigned int> (atoi (argv[i]));
     }
 
   printf ("\nMutex stress & uniformity test.\n");
@@ -107,7 +113,7 @@ os_main (int argc, char* argv[])
 
   srand (seed);
 
-  status = run_tests (seconds);
+  status = run_tests (config);
   return status;
 }
 
@@ -49,7 +49,7 @@ class mutex_test
 {
 public:
 
-  mutex_test (const char* name);
+  mutex_test (unsigned int index, thread::priority_t prio);
 
   void*
   object_main (void);
@@ -73,22 +73,42 @@ protected:
   unsigned int accumulated_count_ = 0;
   unsigned int count_ = 0;
 
+  // The longest wait for the mutex, in high resolution clock
+  // cycles, since the last report and since the start.
+  clock::timestamp_t max_wait_ = 0;
+  clock::timestamp_t worst_wait_ = 0;
+
+  thread::priority_t prio_;
+  char name_[8];
+
   rtos::thread th_;
 };
 
 #pragma GCC diagnostic pop
 
-mutex_test::mutex_test (const char* name) :
+static const char*
+thread_name (char* buf, std::size_t size, unsigned int index)
+{
+  snprintf (buf, size, "t%u", index);
+  return buf;
+}
+
+mutex_test::mutex_test (unsigned int index, thread::priority_t prio) :
+    prio_ (prio), //
+    name_
+      { }, //
     th_
-      { name, [](void* attr)-> void*
+      { thread_name (name_, sizeof(name_), index), [](void* attr)-> void*
         { return static_cast<mutex_test*> (attr)->object_main ();}, this }
 {
-  trace::printf ("%s @%p %s\n", __func__, this, name);
+  trace::printf ("%s @%p %s\n", __func__, this, name_);
 }
 
 void*
 mutex_test::object_main (void)
 {
+  th_.priority (prio_);
+
   while (!thread ().interrupted ())
     {
       unsigned int nbusy = (static_cast<unsigned int> (rand ())
@@ -103,8 +123,24 @@ mutex_test::object_main (void)
       sysclock.sleep_for (nsleep);
       ticks_ += nsleep;
 
+      clock::timestamp_t begin = hrclock.now ();
       mx.lock ();
         {
+          clock::timestamp_t wait = hrclock.now () - begin;
+            {
+              // The reporting thread reads and clears them.
+              scheduler::critical_section scs;
+
+              if (wait > max_wait_)
+                {
+                  max_wait_ = wait;
+                }
+              if (wait > worst_wait_)
+                {
+                  worst_wait_ = wait;
+                }
+            }
+
           nbusy = (static_cast<unsigned int> (rand ())
               % (max_micros_ / 10 - min_micros_ / 10)) + min_micros_ / 10;
           nsleep = (static_cast<unsigned int> (rand ())
@@ -127,11 +163,14 @@ mutex_test::object_main (void)
 
 // ----------------------------------------------------------------------------
 
+constexpr unsigned int max_threads = 32;
+
 #pragma GCC diagnostic push
 #if defined(__clang__)
 #pragma clang diagnostic ignored "-Wmissing-variable-declarations"
 #endif
-mutex_test* mt[10];
+mutex_test* mt[max_threads];
+unsigned int mt_count;
 #pragma GCC diagnostic pop
 
 // ----------------------------------------------------------------------------
@@ -139,10 +178,13 @@ mutex_test* mt[10];
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpadded"
 
+// Prints one CSV record for each interval, and a summary at the end,
+// with the status: heap drift after the first interval and stacks
+// with the bottom magic overwritten are errors.
 class periodic
 {
 public:
-  periodic (unsigned int seconds);
+  periodic (const soak_config_t& config);
 
   void*
   object_main (void);
@@ -153,15 +195,22 @@ public:
     return th_;
   }
 
+  int
+  status (void) const
+  {
+    return status_;
+  }
+
 protected:
-  unsigned int seconds_;
+  const soak_config_t& config_;
+  int status_ = 0;
   rtos::thread th_;
 };
 
 #pragma GCC diagnostic pop
 
-periodic::periodic (unsigned int seconds) :
-    seconds_ (seconds), //
+periodic::periodic (const soak_config_t& config) :
+    config_ (config), //
     th_
       { "P", [](void* attr)-> void*
         { return static_cast<periodic*> (attr)->object_main ();}, this }
@@ -169,46 +218,76 @@ periodic::periodic (unsigned int seconds) :
   trace::printf ("%s @%p\n", __func__, this);
 }
 
+static unsigned int
+to_micros (clock::timestamp_t cycles)
+{
+  return static_cast<unsigned int> (cycles * 1000000
+      / hrclock.input_clock_frequency_hz ());
+}
+
 void*
 periodic::object_main (void)
 {
   th_.priority (thread::priority::above_normal);
 
+  printf ("soak,test,time_s,ops,ops_per_s,delta_min_pct,delta_max_pct,"
+          "wait_max_us,wait_worst_us,heap_used_bytes,stack_free_min_bytes\n");
+
+  std::size_t heap_first = 0;
+  std::size_t stack_first = 0;
+  std::size_t heap = 0;
+  std::size_t stack_free = 0;
+  clock::timestamp_t worst_wait = 0;
+  unsigned int previous = 0;
+  unsigned int sum = 0;
+
   unsigned int t = 0;
   while (true)
     {
-      //realtime_clock.sleep_for (5);
-      sysclock.sleep_for (5000);
-      t += 5;
+      sysclock.sleep_for (config_.interval_seconds * clock_systick::frequency_hz);
+      t += config_.interval_seconds;
+
+      int min = 0;
+      int max = 0;
+      int average;
+      clock::timestamp_t max_wait = 0;
+      stack_free = static_cast<std::size_t> (-1);
+      bool stack_ok = true;
 
         {
           // ----- Enter critical section -------------------------------------
           scheduler::critical_section scs;
 
-          printf ("[%3us] ", t);
-
-          unsigned int sum = 0;
-          for (auto m : mt)
+          sum = 0;
+          for (unsigned int i = 0; i < mt_count; ++i)
             {
-              unsigned int cnt = m->accumulated_count_;
-
-              sum += cnt;
-
-              //os::core::timer::ticks_t ticks = pTask->getTicks();
-              printf ("%s:%-4u ", m->thread ().name (), cnt);
+              mutex_test* m = mt[i];
+              sum += m->accumulated_count_;
+              if (m->max_wait_ > max_wait)
+                {
+                  max_wait = m->max_wait_;
+                }
+              m->max_wait_ = 0;
+              if (m->worst_wait_ > worst_wait)
+                {
+                  worst_wait = m->worst_wait_;
+                }
+
+              std::size_t available = m->thread ().stack ().available ();
+              if (available < stack_free)
+                {
+                  stack_free = available;
+                }
+              if (!m->thread ().stack ().check_bottom_magic ())
+                {
+                  stack_ok = false;
+                }
             }
-          int average = static_cast<int> ((sum
-              + ((sizeof(mt) / sizeof(mt[0])) / 2))
-              / (sizeof(mt) / sizeof(mt[0])));
-
-          printf ("sum=%u, avg=%u", sum, average);
-
-          int min = 0;
-          int max = 0;
+          average = static_cast<int> ((sum + mt_count / 2) / mt_count);
 
-          for (auto m : mt)
+          for (unsigned int i = 0; i < mt_count; ++i)
             {
-              int delta = static_cast<int> (m->accumulated_count_);
+              int delta = static_cast<int> (mt[i]->accumulated_count_);
               delta -= average;
 
               if (delta < min)
@@ -218,62 +297,163 @@ periodic::object_main (void)
                 max = delta;
             }
 
-          printf (", delta in [%d,%d] [%d%%,%d%%]", min, max,
-                  (min * 100 + average / 2) / average,
-                  (max * 100 + average / 2) / average);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      heap = rtos::memory::get_default_resource ()->allocated_bytes ();
+      if (t == config_.interval_seconds)
+        {
+          heap_first = heap;
+          stack_first = stack_free;
+        }
 
-          puts ("");
+      unsigned int ops = sum - previous;
+      previous = sum;
 
-          // ----- Exit critical section --------------------------------------
+      if (average == 0)
+        {
+          // Too short an interval.
+          average = 1;
+        }
+      printf ("soak,mutex,%u,%u,%u,%d,%d,%u,%u,%u,%u\n", t, ops,
+              ops / config_.interval_seconds,
+              (min * 100 + average / 2) / average,
+              (max * 100 + average / 2) / average, to_micros (max_wait),
+              to_micros (worst_wait), static_cast<unsigned int> (heap),
+              static_cast<unsigned int> (stack_free));
+
+      if (!stack_ok)
+        {
+          printf ("soak-error,mutex,%u,stack overflow\n", t);
+          status_ = 1;
+          break;
         }
 
-      if (seconds_ != 0 && t > seconds_)
+      if (config_.seconds != 0 && t >= config_.seconds)
         break;
     }
 
-  for (auto m : mt)
+  for (unsigned int i = 0; i < mt_count; ++i)
     {
-      m->thread ().interrupt ();
-      m->thread ().join ();
+      mt[i]->thread ().interrupt ();
+      mt[i]->thread ().join ();
     }
+
+  int heap_drift = static_cast<int> (heap - heap_first);
+  int stack_drift = static_cast<int> (stack_first - stack_free);
+  if (heap_drift > 0)
+    {
+      status_ = 1;
+    }
+
+  printf ("soak-summary,test,result,ops,wait_worst_us,heap_drift_bytes,"
+          "stack_drift_bytes\n");
+  printf ("soak-summary,mutex,%s,%u,%u,%d,%d\n",
+          status_ == 0 ? "pass" : "fail", sum, to_micros (worst_wait),
+          heap_drift, stack_drift);
+
   return nullptr;
 }
 
 // ----------------------------------------------------------------------------
 
-int
-run_tests (unsigned int seconds)
+// Measure the cost of uncontended lock/unlock pairs. The plain mutex
+// can use the fast path, the inherit mutex always uses the regular path.
+static void
+run_uncontended_benchmark (void)
 {
-#if 1
-  mutex_test mt0 ("t0");
-  mutex_test mt1 ("t1");
-  mutex_test mt2 ("t2");
-  mutex_test mt3 ("t3");
-  mutex_test mt4 ("t4");
-  mutex_test mt5 ("t5");
-  mutex_test mt6 ("t6");
-  mutex_test mt7 ("t7");
-  mutex_test mt8 ("t8");
-  mutex_test mt9 ("t9");
-
-  mt[0] = &mt0;
-  mt[1] = &mt1;
-  mt[2] = &mt2;
-  mt[3] = &mt3;
-  mt[4] = &mt4;
-  mt[5] = &mt5;
-  mt[6] = &mt6;
-  mt[7] = &mt7;
-  mt[8] = &mt8;
-  mt[9] = &mt9;
-#endif
+  constexpr unsigned int iterations = 10000;
 
-  periodic pm
-    { seconds };
+  mutex::attributes attr;
+  attr.mx_protocol = mutex::protocol::inherit;
+  mutex mx_inherit
+    { "mx-inherit", attr };
 
-  pm.thread ().join ();
+  mutex* mutexes[] =
+    { &mx, &mx_inherit };
 
-  puts ("Done.");
-  return 0;
+  for (auto m : mutexes)
+    {
+      clock::timestamp_t begin = hrclock.now ();
+      for (unsigned int i = 0; i < iterations; ++i)
+        {
+          m->lock ();
+          m->unlock ();
+        }
+      clock::timestamp_t end = hrclock.now ();
+
+      printf ("%s: %u lock/unlock in %u cycles, %u cycles each\n",
+              m->name () != nullptr ? m->name () : "mx", iterations,
+              static_cast<unsigned int> (end - begin),
+              static_cast<unsigned int> ((end - begin) / iterations));
+    }
 }
 
+int
+run_tests (const soak_config_t& config)
+{
+  run_uncontended_benchmark ();
+
+  soak_config_t c = config;
+  if (c.threads == 0 || c.threads > max_threads)
+    {
+      c.threads = max_threads;
+    }
+  if (c.interval_seconds == 0)
+    {
+      c.interval_seconds = 1;
+    }
+  // Keep the reporting thread above all workers.
+  constexpr unsigned int max_levels = thread::priority::above_normal
+      - thread::priority::normal;
+  if (c.priority_levels == 0)
+    {
+      c.priority_levels = 1;
+    }
+  else if (c.priority_levels > max_levels)
+    {
+      c.priority_levels = max_levels;
+    }
+
+  printf ("%u threads, %u priority levels, %u s reports, %u s\n", c.threads,
+          c.priority_levels, c.interval_seconds, c.seconds);
+
+  rtos::memory::memory_resource* heap = rtos::memory::get_default_resource ();
+  std::size_t heap_before = heap->allocated_bytes ();
+
+  for (unsigned int i = 0; i < c.threads; ++i)
+    {
+      mt[i] = new mutex_test (
+          i,
+          static_cast<thread::priority_t> (thread::priority::normal
+              + i % c.priority_levels));
+    }
+  mt_count = c.threads;
+
+  int status;
+    {
+      periodic pm
+        { c };
+
+      pm.thread ().join ();
+      status = pm.status ();
+    }
+
+  for (unsigned int i = 0; i < mt_count; ++i)
+    {
+      delete mt[i];
+    }
+  mt_count = 0;
+
+  // The threads and their stacks must be returned to the heap.
+  if (heap->allocated_bytes () != heap_before)
+    {
+      printf ("soak-error,mutex,%u bytes leaked\n",
+              static_cast<unsigned int> (heap->allocated_bytes ()
+                  - heap_before));
+      status = 1;
+    }
+
+  puts (status == 0 ? "Done." : "Failed.");
+  return status;
+}
@@ -0,0 +1,959 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Overhead of the POSIX I/O socket layer.
+ *
+ * The sockets belong to a loopback network stack, which queues
+ * each message as a packet buffer chain on a loopback network
+ * interface, and receives it back from the same interface; the
+ * implementation is kept minimal, so the differences between the
+ * layers show the cost added by each of them:
+ *
+ *   impl        - the `socket_impl` functions, called directly;
+ *   socket      - the `socket` functions (argument checks, virtual
+ *                 dispatch to the implementation);
+ *   lockable    - the `socket_lockable` functions, with a mutex;
+ *   fd          - the `__posix_*()` functions, which also look up
+ *                 the file descriptor;
+ *   fd-lockable - the same, on the lockable socket.
+ *
+ * Each test sends a batch of messages and receives them back, with
+ * `send()`/`recv()`, `sendmsg()`/`recvmsg()` (two segments),
+ * `sendmmsg()`/`recvmmsg()` (the whole batch in one call) and
+ * `send_pbuf()`/`recv_pbuf()` (no copies).
+ *
+ * The results are printed as CSV lines, after a header line
+ * starting with `csv,`:
+ *
+ *   csv,layer,test,transfer,bytes,ops,cycles,cycles-per-op,kib-per-s,ops-per-s
+ *
+ * where an operation is a message sent and received, `transfer`
+ * is the size of each message, in bytes, and `cycles` is the total
+ * duration, in hrclock cycles.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+#include <cmsis-plus/posix-io/net-interface.h>
+#include <cmsis-plus/posix-io/net-stack.h>
+#include <cmsis-plus/posix-io/pbuf.h>
+#include <cmsis-plus/posix-io/socket.h>
+#include <cmsis-plus/posix-io/types.h>
+#include <cmsis-plus/posix/sys/socket.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <test.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // The messages in flight, at most the interface rings.
+  constexpr std::size_t batch = 4;
+  constexpr std::size_t payload_size = 512;
+  constexpr std::size_t max_transfer = 1024;
+
+  // Loopback network driver, the transmitted packets are received back.
+  class loopback_impl : public posix::net_interface_impl
+  {
+  public:
+
+    virtual void
+    do_start_output (posix::net_interface& interface) override;
+  };
+
+  void
+  loopback_impl::do_start_output (posix::net_interface& interface)
+  {
+    posix::pbuf* p;
+    while ((p = interface.next_output ()) != nullptr)
+      {
+        interface.input (p);
+      }
+  }
+
+  loopback_impl lo_impl;
+
+  posix::net_interface lo
+    { lo_impl, "lo" };
+
+  // A batch in each ring.
+  constexpr std::size_t pbuf_segments = 2 * batch * (max_transfer
+      / payload_size);
+
+  posix::pbuf_pool_inclusive<pbuf_segments, payload_size> pbufs
+    { "pbufs" };
+
+  // Used to allocate the file descriptors.
+  posix::file_descriptors_manager descriptors_manager
+    { 8 };
+
+} /* namespace */
+
+// ----------------------------------------------------------------------------
+
+// Datagram socket on the loopback interface; each message is a
+// packet buffer chain.
+class loopback_socket_impl : public posix::socket_impl
+{
+public:
+
+  loopback_socket_impl (void) = default;
+
+  // The rule of five.
+  loopback_socket_impl (const loopback_socket_impl&) = delete;
+  loopback_socket_impl (loopback_socket_impl&&) = delete;
+  loopback_socket_impl&
+  operator= (const loopback_socket_impl&) = delete;
+  loopback_socket_impl&
+  operator= (loopback_socket_impl&&) = delete;
+
+  virtual
+  ~loopback_socket_impl () override = default;
+
+  virtual bool
+  do_is_opened (void) override;
+
+  virtual ssize_t
+  do_read (void* buf, std::size_t nbyte) override;
+
+  virtual ssize_t
+  do_write (const void* buf, std::size_t nbyte) override;
+
+  virtual off_t
+  do_lseek (off_t offset, int whence) override;
+
+  virtual int
+  do_close (void) override;
+
+  virtual class posix::socket*
+  do_accept (struct sockaddr* address, socklen_t* address_len) override;
+
+  virtual int
+  do_bind (const struct sockaddr* address, socklen_t address_len) override;
+
+  virtual int
+  do_connect (const struct sockaddr* address, socklen_t address_len) override;
+
+  virtual int
+  do_getpeername (struct sockaddr* address, socklen_t* address_len) override;
+
+  virtual int
+  do_getsockname (struct sockaddr* address, socklen_t* address_len) override;
+
+  virtual int
+  do_getsockopt (int level, int option_name, void* option_value,
+                 socklen_t* option_len) override;
+
+  virtual int
+  do_listen (int backlog) override;
+
+  virtual ssize_t
+  do_recv (void* buffer, size_t length, int flags) override;
+
+  virtual ssize_t
+  do_recvfrom (void* buffer, size_t length, int flags,
+               struct sockaddr* address, socklen_t* address_len) override;
+
+  virtual ssize_t
+  do_recvmsg (struct msghdr* message, int flags) override;
+
+  virtual ssize_t
+  do_send (const void* buffer, size_t length, int flags) override;
+
+  virtual ssize_t
+  do_sendmsg (const struct msghdr* message, int flags) override;
+
+  virtual ssize_t
+  do_sendto (const void* message, size_t length, int flags,
+             const struct sockaddr* dest_addr, socklen_t dest_len) override;
+
+  virtual int
+  do_setsockopt (int level, int option_name, const void* option_value,
+                 socklen_t option_len) override;
+
+  virtual int
+  do_shutdown (int how) override;
+
+  virtual int
+  do_sockatmark (void) override;
+
+  virtual ssize_t
+  do_recv_pbuf (posix::pbuf** chain, int flags) override;
+
+  virtual ssize_t
+  do_send_pbuf (posix::pbuf* chain, int flags) override;
+
+protected:
+
+  ssize_t
+  output_ (posix::pbuf* chain);
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+bool
+loopback_socket_impl::do_is_opened (void)
+{
+  return true;
+}
+
+ssize_t
+loopback_socket_impl::do_read (void* buf, std::size_t nbyte)
+{
+  return do_recv (buf, nbyte, 0);
+}
+
+ssize_t
+loopback_socket_impl::do_write (const void* buf, std::size_t nbyte)
+{
+  return do_send (buf, nbyte, 0);
+}
+
+off_t
+loopback_socket_impl::do_lseek (off_t offset, int whence)
+{
+  errno = ESPIPE;
+  return -1;
+}
+
+int
+loopback_socket_impl::do_close (void)
+{
+  // Drop the messages not received.
+  posix::pbuf* p;
+  while ((p = lo.try_receive ()) != nullptr)
+    {
+      posix::pbuf::free (p);
+    }
+  return 0;
+}
+
+class posix::socket*
+loopback_socket_impl::do_accept (struct sockaddr* address,
+                                 socklen_t* address_len)
+{
+  errno = EOPNOTSUPP;
+  return nullptr;
+}
+
+int
+loopback_socket_impl::do_bind (const struct sockaddr* address,
+                               socklen_t address_len)
+{
+  return 0;
+}
+
+int
+loopback_socket_impl::do_connect (const struct sockaddr* address,
+                                  socklen_t address_len)
+{
+  return 0;
+}
+
+int
+loopback_socket_impl::do_getpeername (struct sockaddr* address,
+                                      socklen_t* address_len)
+{
+  errno = ENOTCONN;
+  return -1;
+}
+
+int
+loopback_socket_impl::do_getsockname (struct sockaddr* address,
+                                      socklen_t* address_len)
+{
+  errno = ENOSYS;
+  return -1;
+}
+
+int
+loopback_socket_impl::do_getsockopt (int level, int option_name,
+                                     void* option_value,
+                                     socklen_t* option_len)
+{
+  errno = ENOPROTOOPT;
+  return -1;
+}
+
+int
+loopback_socket_impl::do_listen (int backlog)
+{
+  errno = EOPNOTSUPP;
+  return -1;
+}
+
+ssize_t
+loopback_socket_impl::do_recv (void* buffer, size_t length, int flags)
+{
+  posix::pbuf* p = lo.try_receive ();
+  if (p == nullptr)
+    {
+      errno = EAGAIN;
+      return -1;
+    }
+  std::size_t n = p->copy_out (buffer, length);
+  posix::pbuf::free (p);
+  return static_cast<ssize_t> (n);
+}
+
+ssize_t
+loopback_socket_impl::do_recvfrom (void* buffer, size_t length, int flags,
+                                   struct sockaddr* address,
+                                   socklen_t* address_len)
+{
+  if (address_len != nullptr)
+    {
+      *address_len = 0;
+    }
+  return do_recv (buffer, length, flags);
+}
+
+ssize_t
+loopback_socket_impl::do_recvmsg (struct msghdr* message, int flags)
+{
+  posix::pbuf* p = lo.try_receive ();
+  if (p == nullptr)
+    {
+      errno = EAGAIN;
+      return -1;
+    }
+
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < static_cast<std::size_t> (message->msg_iovlen);
+      ++i)
+    {
+      total += p->copy_out (message->msg_iov[i].iov_base,
+                            message->msg_iov[i].iov_len, total);
+    }
+  message->msg_flags = (total < p->total_length ()) ? MSG_TRUNC : 0;
+  posix::pbuf::free (p);
+  return static_cast<ssize_t> (total);
+}
+
+ssize_t
+loopback_socket_impl::output_ (posix::pbuf* chain)
+{
+  std::size_t total = chain->total_length ();
+  if (lo.output (chain) < 0)
+    {
+      return -1;
+    }
+  return static_cast<ssize_t> (total);
+}
+
+ssize_t
+loopback_socket_impl::do_send (const void* buffer, size_t length, int flags)
+{
+  posix::pbuf* p = pbufs.alloc (length);
+  if (p == nullptr)
+    {
+      errno = ENOBUFS;
+      return -1;
+    }
+  p->copy_in (buffer, length);
+
+  ssize_t ret = output_ (p);
+  if (ret < 0)
+    {
+      posix::pbuf::free (p);
+    }
+  return ret;
+}
+
+ssize_t
+loopback_socket_impl::do_sendmsg (const struct msghdr* message, int flags)
+{
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < static_cast<std::size_t> (message->msg_iovlen);
+      ++i)
+    {
+      length += message->msg_iov[i].iov_len;
+    }
+
+  posix::pbuf* p = pbufs.alloc (length);
+  if (p == nullptr)
+    {
+      errno = ENOBUFS;
+      return -1;
+    }
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < static_cast<std::size_t> (message->msg_iovlen);
+      ++i)
+    {
+      offset += p->copy_in (message->msg_iov[i].iov_base,
+                            message->msg_iov[i].iov_len, offset);
+    }
+
+  ssize_t ret = output_ (p);
+  if (ret < 0)
+    {
+      posix::pbuf::free (p);
+    }
+  return ret;
+}
+
+ssize_t
+loopback_socket_impl::do_sendto (const void* message, size_t length,
+                                 int flags, const struct sockaddr* dest_addr,
+                                 socklen_t dest_len)
+{
+  return do_send (message, length, flags);
+}
+
+int
+loopback_socket_impl::do_setsockopt (int level, int option_name,
+                                     const void* option_value,
+                                     socklen_t option_len)
+{
+  errno = ENOPROTOOPT;
+  return -1;
+}
+
+int
+loopback_socket_impl::do_shutdown (int how)
+{
+  return 0;
+}
+
+int
+loopback_socket_impl::do_sockatmark (void)
+{
+  return 0;
+}
+
+ssize_t
+loopback_socket_impl::do_recv_pbuf (posix::pbuf** chain, int flags)
+{
+  *chain = lo.try_receive ();
+  if (*chain == nullptr)
+    {
+      errno = EAGAIN;
+      return -1;
+    }
+  return static_cast<ssize_t> ((*chain)->total_length ());
+}
+
+ssize_t
+loopback_socket_impl::do_send_pbuf (posix::pbuf* chain, int flags)
+{
+  // On failure the caller keeps the chain.
+  return output_ (chain);
+}
+
+#pragma GCC diagnostic pop
+
+// ----------------------------------------------------------------------------
+
+// The protocol selects the socket class.
+constexpr int protocol_lockable = 1;
+
+class loopback_stack_impl : public posix::net_stack_impl
+{
+public:
+
+  loopback_stack_impl (posix::net_interface& interface);
+
+  // The rule of five.
+  loopback_stack_impl (const loopback_stack_impl&) = delete;
+  loopback_stack_impl (loopback_stack_impl&&) = delete;
+  loopback_stack_impl&
+  operator= (const loopback_stack_impl&) = delete;
+  loopback_stack_impl&
+  operator= (loopback_stack_impl&&) = delete;
+
+  virtual
+  ~loopback_stack_impl () override = default;
+
+  virtual class posix::socket*
+  do_socket (int domain, int type, int protocol) override;
+};
+
+loopback_stack_impl::loopback_stack_impl (posix::net_interface& interface) :
+    posix::net_stack_impl
+      { interface }
+{
+}
+
+// Explicit template instantiation.
+template class posix::socket_implementable<loopback_socket_impl>;
+template class posix::socket_lockable<loopback_socket_impl, rtos::mutex>;
+template class posix::net_stack_implementable<loopback_stack_impl>;
+
+namespace
+{
+  using loopback_socket = posix::socket_implementable<loopback_socket_impl>;
+  using loopback_socket_lockable = posix::socket_lockable<
+  loopback_socket_impl, rtos::mutex>;
+  using loopback_stack = posix::net_stack_implementable<loopback_stack_impl>;
+
+  loopback_stack stack
+    { "lo", lo };
+
+  rtos::mutex socket_mutex
+    { "socket" };
+
+} /* namespace */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+class posix::socket*
+loopback_stack_impl::do_socket (int domain, int type, int protocol)
+{
+  if (protocol == protocol_lockable)
+    {
+      return stack.allocate_socket<loopback_socket_lockable> (socket_mutex);
+    }
+  return stack.allocate_socket<loopback_socket> ();
+}
+
+#pragma GCC diagnostic pop
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  enum class layer
+  {
+    impl, socket, fd
+  };
+
+  std::size_t messages_;
+  uint8_t out_[max_transfer];
+  uint8_t in_[max_transfer];
+  bool failed_;
+
+  void
+  print (const char* lname, const char* test, std::size_t transfer,
+         std::size_t ops, clock::duration_t cycles)
+  {
+    uint64_t freq = hrclock.input_clock_frequency_hz ();
+    std::size_t bytes = ops * transfer;
+    unsigned long per_op = 0;
+    unsigned long kibps = 0;
+    unsigned long opsps = 0;
+    if (cycles != 0 && ops != 0)
+      {
+        per_op = static_cast<unsigned long> (cycles / ops);
+        kibps = static_cast<unsigned long> (bytes * freq / cycles / 1024);
+        opsps = static_cast<unsigned long> (ops * freq / cycles);
+      }
+    printf ("csv,%s,%s,%u,%u,%u,%lu,%lu,%lu,%lu\n", lname, test,
+            static_cast<unsigned int> (transfer),
+            static_cast<unsigned int> (bytes), static_cast<unsigned int> (ops),
+            static_cast<unsigned long> (cycles), per_op, kibps, opsps);
+  }
+
+  bool
+  check (const char* lname, const char* test, ssize_t ret, ssize_t expected)
+  {
+    if (ret != expected)
+      {
+        printf ("# %s %s: failed, ret=%d, errno=%d\n", lname, test,
+                static_cast<int> (ret), errno);
+        failed_ = true;
+        return false;
+      }
+    return true;
+  }
+
+  // --------------------------------------------------------------------------
+
+  ssize_t
+  send_one (layer l, class posix::socket& s, int fd, std::size_t transfer)
+  {
+    switch (l)
+      {
+      case layer::impl:
+        return s.impl ().do_send (out_, transfer, 0);
+      case layer::socket:
+        return s.send (out_, transfer, 0);
+      default:
+        return __posix_send (fd, out_, transfer, 0);
+      }
+  }
+
+  ssize_t
+  recv_one (layer l, class posix::socket& s, int fd, std::size_t transfer)
+  {
+    switch (l)
+      {
+      case layer::impl:
+        return s.impl ().do_recv (in_, transfer, 0);
+      case layer::socket:
+        return s.recv (in_, transfer, 0);
+      default:
+        return __posix_recv (fd, in_, transfer, 0);
+      }
+  }
+
+  void
+  bench_send_recv (const char* lname, layer l, class posix::socket& s, int fd,
+                   std::size_t transfer)
+  {
+    const char* test = "send-recv";
+    ssize_t expected = static_cast<ssize_t> (transfer);
+    std::size_t ops = 0;
+
+    clock::timestamp_t begin = hrclock.now ();
+    while (ops < messages_)
+      {
+        for (std::size_t i = 0; i < batch; ++i)
+          {
+            if (!check (lname, test, send_one (l, s, fd, transfer), expected))
+              {
+                return;
+              }
+          }
+        for (std::size_t i = 0; i < batch; ++i)
+          {
+            if (!check (lname, test, recv_one (l, s, fd, transfer), expected))
+              {
+                return;
+              }
+          }
+        ops += batch;
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    print (lname, test, transfer, ops,
+           static_cast<clock::duration_t> (end - begin));
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  init_msg (struct msghdr* msg, struct iovec* iov, uint8_t* buf,
+            std::size_t transfer)
+  {
+    iov[0].iov_base = buf;
+    iov[0].iov_len = transfer / 2;
+    iov[1].iov_base = buf + transfer / 2;
+    iov[1].iov_len = transfer - transfer / 2;
+
+    std::memset (msg, 0, sizeof(*msg));
+    msg->msg_iov = iov;
+    msg->msg_iovlen = 2;
+  }
+
+  void
+  bench_sendmsg_recvmsg (const char* lname, layer l, class posix::socket& s, int fd,
+                         std::size_t transfer)
+  {
+    const char* test = "sendmsg-recvmsg";
+    ssize_t expected = static_cast<ssize_t> (transfer);
+
+    struct iovec out_iov[2];
+    struct msghdr out_msg;
+    init_msg (&out_msg, out_iov, out_, transfer);
+    struct iovec in_iov[2];
+    struct msghdr in_msg;
+    init_msg (&in_msg, in_iov, in_, transfer);
+
+    std::size_t ops = 0;
+    clock::timestamp_t begin = hrclock.now ();
+    while (ops < messages_)
+      {
+        for (std::size_t i = 0; i < batch; ++i)
+          {
+            ssize_t ret;
+            switch (l)
+              {
+              case layer::impl:
+                ret = s.impl ().do_sendmsg (&out_msg, 0);
+                break;
+              case layer::socket:
+                ret = s.sendmsg (&out_msg, 0);
+                break;
+              default:
+                ret = __posix_sendmsg (fd, &out_msg, 0);
+                break;
+              }
+            if (!check (lname, test, ret, expected))
+              {
+                return;
+              }
+          }
+        for (std::size_t i = 0; i < batch; ++i)
+          {
+            ssize_t ret;
+            switch (l)
+              {
+              case layer::impl:
+                ret = s.impl ().do_recvmsg (&in_msg, 0);
+                break;
+              case layer::socket:
+                ret = s.recvmsg (&in_msg, 0);
+                break;
+              default:
+                ret = __posix_recvmsg (fd, &in_msg, 0);
+                break;
+              }
+            if (!check (lname, test, ret, expected))
+              {
+                return;
+              }
+          }
+        ops += batch;
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    print (lname, test, transfer, ops,
+           static_cast<clock::duration_t> (end - begin));
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  bench_mmsg (const char* lname, layer l, class posix::socket& s, int fd,
+              std::size_t transfer)
+  {
+    const char* test = "sendmmsg-recvmmsg";
+    ssize_t expected = static_cast<ssize_t> (batch);
+
+    // All messages of a batch use the same buffers.
+    struct iovec out_iov[batch][2];
+    struct mmsghdr out_msgs[batch];
+    struct iovec in_iov[batch][2];
+    struct mmsghdr in_msgs[batch];
+    for (std::size_t i = 0; i < batch; ++i)
+      {
+        init_msg (&out_msgs[i].msg_hdr, out_iov[i], out_, transfer);
+        init_msg (&in_msgs[i].msg_hdr, in_iov[i], in_, transfer);
+      }
+
+    std::size_t ops = 0;
+    clock::timestamp_t begin = hrclock.now ();
+    while (ops < messages_)
+      {
+        ssize_t ret;
+        switch (l)
+          {
+          case layer::impl:
+            ret = s.impl ().do_sendmmsg (out_msgs, batch, 0);
+            break;
+          case layer::socket:
+            ret = s.sendmmsg (out_msgs, batch, 0);
+            break;
+          default:
+            ret = __posix_sendmmsg (fd, out_msgs, batch, 0);
+            break;
+          }
+        if (!check (lname, test, ret, expected))
+          {
+            return;
+          }
+
+        switch (l)
+          {
+          case layer::impl:
+            ret = s.impl ().do_recvmmsg (in_msgs, batch, 0, nullptr);
+            break;
+          case layer::socket:
+            ret = s.recvmmsg (in_msgs, batch, 0, nullptr);
+            break;
+          default:
+            ret = __posix_recvmmsg (fd, in_msgs, batch, 0, nullptr);
+            break;
+          }
+        if (!check (lname, test, ret, expected))
+          {
+            return;
+          }
+        ops += batch;
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    print (lname, test, transfer, ops,
+           static_cast<clock::duration_t> (end - begin));
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  bench_pbuf (const char* lname, layer l, class posix::socket& s, int fd,
+              std::size_t transfer)
+  {
+    const char* test = "pbuf";
+    ssize_t expected = static_cast<ssize_t> (transfer);
+
+    // There are no C functions; the `fd` layer does the same lookup
+    // as the other `__posix_*()` functions.
+    std::size_t ops = 0;
+    clock::timestamp_t begin = hrclock.now ();
+    while (ops < messages_)
+      {
+        for (std::size_t i = 0; i < batch; ++i)
+          {
+            // The application writes the payload in place.
+            posix::pbuf* p = pbufs.alloc (transfer);
+            if (p == nullptr)
+              {
+                check (lname, test, -1, expected);
+                return;
+              }
+
+            ssize_t ret;
+            switch (l)
+              {
+              case layer::impl:
+                ret = s.impl ().do_send_pbuf (p, 0);
+                break;
+              case layer::socket:
+                ret = s.send_pbuf (p, 0);
+                break;
+              default:
+                ret = posix::file_descriptors_manager::socket (fd)->send_pbuf (
+                    p, 0);
+                break;
+              }
+            if (!check (lname, test, ret, expected))
+              {
+                posix::pbuf::free (p);
+                return;
+              }
+          }
+        for (std::size_t i = 0; i < batch; ++i)
+          {
+            posix::pbuf* p = nullptr;
+            ssize_t ret;
+            switch (l)
+              {
+              case layer::impl:
+                ret = s.impl ().do_recv_pbuf (&p, 0);
+                break;
+              case layer::socket:
+                ret = s.recv_pbuf (&p, 0);
+                break;
+              default:
+                ret = posix::file_descriptors_manager::socket (fd)->recv_pbuf (
+                    &p, 0);
+                break;
+              }
+            // The application reads the payload in place.
+            posix::pbuf::free (p);
+            if (!check (lname, test, ret, expected))
+              {
+                return;
+              }
+          }
+        ops += batch;
+      }
+    clock::timestamp_t end = hrclock.now ();
+
+    print (lname, test, transfer, ops,
+           static_cast<clock::duration_t> (end - begin));
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  bench_layer (const char* lname, layer l, class posix::socket& s, int fd)
+  {
+    static const std::size_t sizes[] =
+      { 16, 256, max_transfer };
+    for (auto transfer : sizes)
+      {
+        bench_send_recv (lname, l, s, fd, transfer);
+        bench_sendmsg_recvmsg (lname, l, s, fd, transfer);
+        bench_mmsg (lname, l, s, fd, transfer);
+        bench_pbuf (lname, l, s, fd, transfer);
+      }
+  }
+
+} /* namespace */
+
+// ----------------------------------------------------------------------------
+
+int
+run_tests (std::size_t messages)
+{
+  // Whole batches.
+  messages_ = ((messages + batch - 1) / batch) * batch;
+  failed_ = false;
+
+  for (std::size_t i = 0; i < max_transfer; ++i)
+    {
+      out_[i] = static_cast<uint8_t> (i);
+    }
+
+  printf ("# %u messages per test, hrclock %u Hz.\n",
+          static_cast<unsigned int> (messages_),
+          static_cast<unsigned int> (hrclock.input_clock_frequency_hz ()));
+  printf ("csv,layer,test,transfer,bytes,ops,cycles,cycles-per-op,"
+          "kib-per-s,ops-per-s\n");
+
+  class posix::socket* plain = stack.socket (AF_INET, SOCK_DGRAM, 0);
+  class posix::socket* lockable = stack.socket (AF_INET, SOCK_DGRAM,
+                                          protocol_lockable);
+  if (plain == nullptr || lockable == nullptr)
+    {
+      printf ("# socket failed, errno=%d\n", errno);
+      return 1;
+    }
+
+  int plain_fd = posix::file_descriptors_manager::allocate (plain);
+  int lockable_fd = posix::file_descriptors_manager::allocate (lockable);
+  if (plain_fd < 0 || lockable_fd < 0)
+    {
+      printf ("# file descriptors failed, errno=%d\n", errno);
+      return 1;
+    }
+
+  bench_layer ("impl", layer::impl, *plain, plain_fd);
+  bench_layer ("socket", layer::socket, *plain, plain_fd);
+  bench_layer ("lockable", layer::socket, *lockable, lockable_fd);
+  bench_layer ("fd", layer::fd, *plain, plain_fd);
+  bench_layer ("fd-lockable", layer::fd, *lockable, lockable_fd);
+
+  __posix_close (plain_fd);
+  __posix_close (lockable_fd);
+
+  if (pbufs.free_segments () != pbuf_segments)
+    {
+      printf ("# %u packet buffers leaked\n",
+              static_cast<unsigned int> (pbuf_segments
+                  - pbufs.free_segments ()));
+      failed_ = true;
+    }
+
+  return failed_ ? 1 : 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -64,10 +64,49 @@
 
 #define OS_USE_TRACE_POSIX_STDOUT
 
+// The test functions have several inclusive objects on their frames,
+// with default size stacks, so main needs more than the default.
+#define OS_INTEGER_RTOS_MAIN_STACK_SIZE_BYTES               (256*1024)
+
 #endif /* defined(__ARM_EABI__) */
 
 #define OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES  (1)
 #define OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES        (1)
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD
+#define OS_INTEGER_RTOS_STATISTICS_CPU_LOAD_PERIOD_MS       (50)
+#define OS_INCLUDE_RTOS_STATISTICS_SYNC                     (1)
+#define OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE            (1)
+
+#define OS_INCLUDE_RTOS_DCACHE_MAINTENANCE
+
+#define OS_INCLUDE_RTOS_IDLE_POWER_STATES
+
+#define OS_INCLUDE_RTOS_FOOTPRINT
+
+#define OS_INCLUDE_FORMAT_FLOAT
+
+#if !defined(USE_FREERTOS)
+#define OS_INCLUDE_RTOS_SCHEDULER_EDF                       (1)
+#define OS_INCLUDE_RTOS_THREAD_CPU_BUDGET
+#define OS_INCLUDE_RTOS_SNAPSHOT
+#define OS_USE_RTOS_COALESCED_RESCHEDULE
+#endif /* !defined(USE_FREERTOS) */
+
+#define OS_INTEGER_RTOS_THREAD_TLS_SLOTS                    (4)
+#define OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS
+#define OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES          (2)
+#define OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE
+#define OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS      (4)
+
+#define OS_INCLUDE_MEMORY_PROFILER
+#define OS_INTEGER_MEMORY_PROFILER_RECORDS                  (16)
+#define OS_INTEGER_MEMORY_IDLE_VERIFY_CHUNKS                (4)
+
+// sendfile() between the test block devices needs a full block.
+#define OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE_BYTES      (512)
+
+#define OS_INCLUDE_POSIX_IO_STATISTICS
+#define OS_INCLUDE_POSIX_IO_FLUSHER
 
 // ----------------------------------------------------------------------------
 
@@ -131,13 +170,17 @@
 #define OS_TRACE_POSIX_IO_CHAR_DEVICE
 #define OS_TRACE_POSIX_IO_BLOCK_DEVICE
 #define OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION
+#define OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE
 #define OS_TRACE_POSIX_IO_DIRECTORY
+#define OS_TRACE_POSIX_IO_EVENT_POLL
 #define OS_TRACE_POSIX_IO_FILE
 #define OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER
 #define OS_TRACE_POSIX_IO_FILE_SYSTEM
 #define OS_TRACE_POSIX_IO_IO
 #define OS_TRACE_POSIX_IO_NET_INTERFACE
 #define OS_TRACE_POSIX_IO_NET_STACK
+#define OS_TRACE_POSIX_IO_PIPE
+#define OS_TRACE_POSIX_IO_SHARED_MEMORY
 #define OS_TRACE_POSIX_IO_SOCKET
 #define OS_TRACE_POSIX_IO_TTY
 #define OS_TRACE_POSIX_IO_CHAN_FATFS
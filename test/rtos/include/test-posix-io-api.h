@@ -65,6 +65,12 @@ extern "C"
     do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
         override;
 
+    virtual const void*
+    do_map (blknum_t blknum, std::size_t nblocks) override;
+
+    virtual int
+    do_erase (blknum_t blknum, std::size_t nblocks) override;
+
     virtual int
     do_vioctl (int request, std::va_list args) override;
 
@@ -74,6 +80,19 @@ extern "C"
     virtual int
     do_close (void) override;
 
+    // Set the preferred transfer size, to check the geometry.
+    void
+    optimal_size (std::size_t bytes)
+    {
+      block_optimal_size_bytes_ = bytes;
+    }
+
+    // Number of do_write_block() calls, to check write coalescing.
+    std::size_t write_calls = 0;
+    // The last written run.
+    blknum_t last_write_blknum = 0;
+    std::size_t last_write_nblocks = 0;
+
   private:
     using elem_t = void*;
     elem_t* arena_;
@@ -81,6 +81,7 @@ static const char* thread_state[] =
  * To compute thread percentages, use totals provided by:
  * - os_sched_stat_get_context_switches();
  * - os_sched_stat_get_cpu_cycles();
+ * or, for the moving averages, os_sched_stat_get_cpu_load().
  */
 void
 iterate_threads (os_thread_t* th, unsigned int depth)
@@ -114,6 +115,16 @@ iterate_threads (os_thread_t* th, unsigned int depth)
               thread_state[st], (unsigned int) thread_switches,
               (unsigned int) thread_cpu_cycles);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+      printf ("load %u/%u/%u\n",
+              (unsigned int) os_thread_stat_get_cpu_load (
+                  p, os_statistics_load_window_one_second),
+              (unsigned int) os_thread_stat_get_cpu_load (
+                  p, os_statistics_load_window_ten_seconds),
+              (unsigned int) os_thread_stat_get_cpu_load (
+                  p, os_statistics_load_window_one_minute));
+#endif
+
       // Go down one level.
       iterate_threads (p, depth + 1);
 
@@ -274,6 +285,10 @@ test_c_api (void)
       // Restore main thread priority.
       os_thread_set_priority (os_this_thread (), os_thread_priority_normal);
 
+      os_thread_affinity_t mask;
+      mask = os_thread_get_affinity (os_this_thread ());
+      os_thread_set_affinity (os_this_thread (), mask);
+
       os_thread_destruct (&th3);
     }
 
@@ -299,6 +314,9 @@ test_c_api (void)
 
       os_thread_stack_check_bottom_magic (stack);
       os_thread_stack_check_top_magic (stack);
+
+      os_thread_stack_get_available (stack);
+      os_thread_stack_get_peak (stack);
     }
 
   // ==========================================================================
@@ -318,6 +336,30 @@ test_c_api (void)
       os_this_thread_flags_timed_wait (0x3, 10, NULL, os_flags_mode_all);
     }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+  // ==========================================================================
+
+  printf ("\n%s - Thread notifications.\n", test_name);
+
+    {
+      os_notify_value_t value;
+
+      os_thread_notify (os_this_thread (), 0x3, os_notify_action_set_bits);
+      os_this_thread_notify_wait (&value, os_notify_all);
+
+      os_thread_notify (os_this_thread (), 0x3, os_notify_action_overwrite);
+      os_this_thread_notify_timed_wait (10, &value, os_notify_all);
+
+      os_thread_notify (os_this_thread (), 1, os_notify_action_increment);
+      os_this_thread_notify_take (true);
+
+      os_thread_notify (os_this_thread (), 1, os_notify_action_increment);
+      os_this_thread_notify_timed_take (10, true);
+    }
+
+#endif
+
   // ==========================================================================
 
   printf ("\n%s - Timers.\n", test_name);
@@ -469,6 +511,56 @@ test_c_api (void)
 
   // ==========================================================================
 
+  printf ("\n%s - Read-write locks.\n", test_name);
+
+    {
+      os_rwlock_t rw1;
+      os_rwlock_construct (&rw1, "rw1", NULL);
+
+      os_rwlock_read_lock (&rw1);
+      os_rwlock_try_read_lock (&rw1);
+      os_rwlock_get_readers (&rw1);
+      os_rwlock_unlock (&rw1);
+      os_rwlock_unlock (&rw1);
+
+      os_rwlock_timed_read_lock (&rw1, 1);
+      os_rwlock_unlock (&rw1);
+
+      os_rwlock_write_lock (&rw1);
+      os_rwlock_unlock (&rw1);
+
+      os_rwlock_try_write_lock (&rw1);
+      os_rwlock_unlock (&rw1);
+
+      os_rwlock_timed_write_lock (&rw1, 1);
+      os_rwlock_unlock (&rw1);
+
+      name = os_rwlock_get_name (&rw1);
+
+      os_rwlock_destruct (&rw1);
+    }
+
+    {
+      // Custom read-write lock.
+      os_rwlock_attr_t arw2;
+      os_rwlock_attr_init (&arw2);
+
+      arw2.clock = os_clock_get_rtclock ();
+
+      os_rwlock_t rw2;
+      os_rwlock_construct (&rw2, "rw2", &arw2);
+
+      os_rwlock_destruct (&rw2);
+    }
+
+    {
+      // Dynamically allocated read-write lock.
+      os_rwlock_t* rw3 = os_rwlock_new ("rw3", NULL);
+      os_rwlock_delete (rw3);
+    }
+
+  // ==========================================================================
+
   printf ("\n%s - Semaphores.\n", test_name);
 
     {
@@ -562,6 +654,17 @@ test_c_api (void)
       blk = os_mempool_timed_alloc (&p1, 1);
       os_mempool_free (&p1, blk);
 
+      void* blks[3];
+      size_t n;
+      n = os_mempool_alloc_n (&p1, 2, blks);
+      os_mempool_free_n (&p1, n, blks);
+
+      n = os_mempool_try_alloc_n (&p1, 3, blks);
+      os_mempool_free_n (&p1, n, blks);
+
+      n = os_mempool_timed_alloc_n (&p1, 3, blks, 1);
+      os_mempool_free_n (&p1, n, blks);
+
       os_mempool_destruct (&p1);
     }
 
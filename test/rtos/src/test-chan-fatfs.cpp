@@ -447,6 +447,72 @@ test_fs (posix::file_system& fs, uint8_t* buff, std::size_t buff_size)
           res = f->close ();
           assert(res == 0);
 
+          // --------------------------
+
+          // Attributes, repeated lookups may come from the cache.
+          struct stat st;
+          res = fs.stat (DIR1_NAME FILE2_NAME, &st);
+          assert(res == 0);
+          assert(st.st_size == static_cast<off_t> (strlen (TEST2_TEXT)));
+          res = fs.stat (DIR1_NAME FILE2_NAME, &st);
+          assert(res == 0);
+          assert(st.st_size == static_cast<off_t> (strlen (TEST2_TEXT)));
+
+          // Missing files must be seen after they are created,
+          // and not after they are removed.
+          res = fs.stat (DIR1_NAME FILE1_NAME, &st);
+          assert((res == -1) && (errno == ENOENT));
+
+          f = fs.open (DIR1_NAME FILE1_NAME, O_WRONLY | O_CREAT);
+          assert(f != nullptr);
+          sres = f->write (TEST1_TEXT, strlen (TEST1_TEXT));
+          assert(sres == strlen (TEST1_TEXT));
+          res = f->close ();
+          assert(res == 0);
+
+          res = fs.stat (DIR1_NAME FILE1_NAME, &st);
+          assert(res == 0);
+          assert(st.st_size == static_cast<off_t> (strlen (TEST1_TEXT)));
+
+          res = fs.unlink (DIR1_NAME FILE1_NAME);
+          assert(res == 0);
+          res = fs.stat (DIR1_NAME FILE1_NAME, &st);
+          assert((res == -1) && (errno == ENOENT));
+
+          // Small records, buffered, read back in small pieces.
+            {
+              static uint8_t vbuf[64];
+
+              f = fs.open (DIR1_NAME FILE1_NAME, O_RDWR | O_CREAT);
+              assert(f != nullptr);
+              res = f->setvbuf (vbuf, _IOFBF, sizeof(vbuf));
+              assert(res == 0);
+
+              for (int i = 0; i < 10; ++i)
+                {
+                  sres = f->write (TEST1_TEXT, strlen (TEST1_TEXT));
+                  assert(sres == strlen (TEST1_TEXT));
+                }
+
+              assert(f->lseek (0, SEEK_SET) == 0);
+              for (int i = 0; i < 10; ++i)
+                {
+                  sres = f->read (buff, strlen (TEST1_TEXT));
+                  assert(sres == strlen (TEST1_TEXT));
+                  assert(memcmp (buff, TEST1_TEXT, strlen (TEST1_TEXT)) == 0);
+                }
+
+              res = f->close ();
+              assert(res == 0);
+
+              res = fs.stat (DIR1_NAME FILE1_NAME, &st);
+              assert(res == 0);
+              assert(st.st_size == static_cast<off_t> (10 * strlen (TEST1_TEXT)));
+
+              res = fs.unlink (DIR1_NAME FILE1_NAME);
+              assert(res == 0);
+            }
+
 #if !(defined(__APPLE__) || defined(__linux__))
 
           // Fails with clang :-(
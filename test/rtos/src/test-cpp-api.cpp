@@ -18,11 +18,20 @@
 
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/memory/block-pool.h>
+#include <cmsis-plus/memory/first-fit-top.h>
 #include <cmsis-plus/memory/lifo.h>
+#include <cmsis-plus/memory/monotonic.h>
+#include <cmsis-plus/memory/pool.h>
+#include <cmsis-plus/memory/profiler.h>
+#include <cmsis-plus/memory/slab.h>
+#include <cmsis-plus/memory/tlsf.h>
+#include <cmsis-plus/utils/copy.h>
+#include <cmsis-plus/diag/format.h>
 #include <cmsis-plus/estd/memory_resource>
 #include <cmsis-plus/estd/mutex>
 
 #include <algorithm>
+#include <cstring>
 
 #include <test-cpp-api.h>
 
@@ -70,6 +79,338 @@ tmfunc (void* args __attribute__((unused)))
   printf ("%s\n", __func__);
 }
 
+typedef struct evflags_waiter_s
+{
+  event_flags* ev;
+  flags::mask_t mask;
+  flags::mask_t got;
+} evflags_waiter_t;
+
+void*
+evflags_waiter (void* args);
+
+void*
+evflags_waiter (void* args)
+{
+  evflags_waiter_t* w = static_cast<evflags_waiter_t*> (args);
+  w->ev->wait (w->mask, &w->got);
+
+  return nullptr;
+}
+
+typedef struct mempool_batch_waiter_s
+{
+  memory_pool* mp;
+  void* blocks[4];
+  std::size_t got;
+} mempool_batch_waiter_t;
+
+void*
+mempool_batch_waiter (void* args);
+
+void*
+mempool_batch_waiter (void* args)
+{
+  mempool_batch_waiter_t* w = static_cast<mempool_batch_waiter_t*> (args);
+  w->got = w->mp->alloc_n (4, w->blocks);
+
+  return nullptr;
+}
+
+typedef struct mempool_set_waiter_s
+{
+  memory_pool_set* mps;
+  void* block;
+} mempool_set_waiter_t;
+
+void*
+mempool_set_waiter (void* args);
+
+void*
+mempool_set_waiter (void* args)
+{
+  mempool_set_waiter_t* w = static_cast<mempool_set_waiter_t*> (args);
+  w->block = w->mps->alloc (1);
+
+  return nullptr;
+}
+
+typedef struct cache_s
+{
+  os::rtos::memory::memory_resource* mr;
+  void* blocks[4];
+  std::size_t count;
+} cache_t;
+
+std::size_t
+cache_reclaim (std::size_t bytes, void* args);
+
+std::size_t
+cache_reclaim (std::size_t bytes, void* args)
+{
+  cache_t* c = static_cast<cache_t*> (args);
+  std::size_t freed = 0;
+  while (c->count > 0 && freed < bytes)
+    {
+      c->mr->deallocate (c->blocks[--c->count], 150, 8);
+      freed += 150;
+    }
+
+  return freed;
+}
+
+typedef struct topic_reader_s
+{
+  topic::subscriber* sub;
+  int value;
+} topic_reader_t;
+
+void*
+topic_reader (void* args);
+
+void*
+topic_reader (void* args)
+{
+  topic_reader_t* r = static_cast<topic_reader_t*> (args);
+  r->sub->receive (&r->value, sizeof(r->value));
+
+  return nullptr;
+}
+
+void*
+sem_waiter (void* args);
+
+void*
+sem_waiter (void* args)
+{
+  static_cast<semaphore*> (args)->wait ();
+
+  return nullptr;
+}
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+void*
+notify_waiter (void* args);
+
+void*
+notify_waiter (void* args)
+{
+  *static_cast<notify::value_t*> (args) = this_thread::notify_take ();
+
+  return nullptr;
+}
+
+void
+tm_notify (void* args);
+
+void
+tm_notify (void* args)
+{
+  static_cast<thread*> (args)->notify (0x40, notify::action::set_bits);
+}
+
+#endif
+
+void
+tm_post3 (void* args);
+
+void
+tm_post3 (void* args)
+{
+  // Like a DMA handler feeding three consumers.
+  semaphore* sems = static_cast<semaphore*> (args);
+  for (int i = 0; i < 3; ++i)
+    {
+      sems[i].post ();
+    }
+}
+
+#if defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+static std::size_t co_done;
+
+static coroutine::task
+co_sem_waiter (semaphore& sem)
+{
+  result_t res = co_await coroutine::wait (sem);
+  assert(res == result::ok);
+  ++co_done;
+}
+
+static coroutine::task
+co_timeouts (semaphore& sem)
+{
+  result_t res = co_await coroutine::timed_wait (sem, 2);
+  assert(res == ETIMEDOUT);
+  res = co_await coroutine::sleep_for (2);
+  assert(res == ETIMEDOUT);
+  ++co_done;
+}
+
+static coroutine::task
+co_mq_echo (message_queue& in, message_queue& out)
+{
+  my_msg_t msg;
+  result_t res = co_await coroutine::receive (in, &msg, sizeof(msg));
+  assert(res == result::ok);
+  ++msg.i;
+  res = co_await coroutine::send (out, &msg, sizeof(msg));
+  assert(res == result::ok);
+  ++co_done;
+}
+
+static coroutine::task
+co_evflags_waiter (event_flags& ev, flags::mask_t* got)
+{
+  result_t res = co_await coroutine::wait (ev, 0x3, got);
+  assert(res == result::ok);
+  ++co_done;
+}
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+typedef struct srp_ctx_s
+{
+  srp::resource* res;
+  srp::task* mid;
+  srp::task* high;
+  message_queue* mq;
+  char trace[16];
+  std::size_t len;
+  std::size_t count;
+} srp_ctx_t;
+
+static void
+srp_mark (srp_ctx_t* ctx, char c)
+{
+  if (ctx->len < sizeof(ctx->trace) - 1)
+    {
+      ctx->trace[ctx->len++] = c;
+    }
+}
+
+static void
+srp_low (void* args)
+{
+  srp_ctx_t* ctx = static_cast<srp_ctx_t*> (args);
+
+  srp_mark (ctx, 'l');
+  ctx->res->lock ();
+  // Below the ceiling, both are postponed.
+  ctx->high->post ();
+  ctx->mid->post ();
+  srp_mark (ctx, 'L');
+  ctx->res->unlock ();
+
+  // Preempts at once.
+  ctx->high->post ();
+  srp_mark (ctx, 'e');
+}
+
+static void
+srp_mid (void* args)
+{
+  srp_mark (static_cast<srp_ctx_t*> (args), 'm');
+}
+
+static void
+srp_high (void* args)
+{
+  srp_ctx_t* ctx = static_cast<srp_ctx_t*> (args);
+
+  srp_mark (ctx, 'h');
+  int v = static_cast<int> (ctx->len);
+  ctx->mq->try_send (&v, sizeof(v));
+}
+
+static void
+srp_count (void* args)
+{
+  ++static_cast<srp_ctx_t*> (args)->count;
+}
+
+static bool deferred_init_done;
+
+void
+deferred_init_func (void);
+
+void
+deferred_init_func (void)
+{
+  deferred_init_done = true;
+}
+
+OS_DEFERRED_INIT(10, deferred_init_func);
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE) && !defined(OS_USE_RTOS_PORT_MUTEX) \
+  && !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+
+// Constant initialised, no constructors run at startup.
+static semaphore_counting static_sp
+  { static_init, "static-sp", 3, 1 };
+static mutex_recursive static_mx
+  { static_init, "static-mx" };
+static condition_variable static_cv
+  { static_init, "static-cv" };
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE)
+
+// There is no cache on the test platforms; count the calls.
+static std::size_t dcache_cleaned;
+static std::size_t dcache_invalidated;
+static uintptr_t dcache_last_addr;
+static std::size_t dcache_last_bytes;
+
+void
+os_dcache_clean (const void* addr, size_t nbytes)
+{
+  ++dcache_cleaned;
+  dcache_last_addr = reinterpret_cast<uintptr_t> (addr);
+  dcache_last_bytes = nbytes;
+}
+
+void
+os_dcache_invalidate (void* addr, size_t nbytes)
+{
+  ++dcache_invalidated;
+  dcache_last_addr = reinterpret_cast<uintptr_t> (addr);
+  dcache_last_bytes = nbytes;
+}
+
+void
+os_dcache_clean_invalidate (void* addr, size_t nbytes)
+{
+  ++dcache_cleaned;
+  ++dcache_invalidated;
+  dcache_last_addr = reinterpret_cast<uintptr_t> (addr);
+  dcache_last_bytes = nbytes;
+}
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES)
+
+// There are no low power states on the test platforms; count the
+// requests and let the idle thread fall back to sleep.
+static std::size_t power_stop_requests;
+
+bool
+os_rtos_idle_enter_power_state_hook (uint8_t state,
+                                     uint32_t ticks __attribute__((unused)),
+                                     uint32_t* slept_ticks __attribute__((unused)))
+{
+  if (state == power::state::stop)
+    {
+      ++power_stop_requests;
+    }
+  return false;
+}
+
+#endif
+
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
 
 void
@@ -239,111 +580,431 @@ test_cpp_api (void)
       bp3.deallocate (b2, 0, 1);
     }
 
-  // ==========================================================================
+    {
+      static char arena[1024];
 
-  printf ("\n%s - Threads.\n", test_name);
+      // The first fit manager, with explicit separate arena.
+      os::memory::first_fit_top ff1
+        { "ff1", arena, sizeof(arena) };
 
-    {
-      // Static threads with allocated stacks.
-      thread th1
-        { func, nullptr };
-      thread th2
-        { "th2", func, nullptr };
+      void* b1;
+      b1 = ff1.allocate (10, 8);
 
-      th1.join ();
-      th2.join ();
+      void* b2;
+      b2 = ff1.allocate (100, 8);
+
+      void* b3;
+      b3 = ff1.allocate (50, 8);
+
+      // Shrink in place.
+      bool ok = ff1.try_resize (b3, 50, 20);
+      assert(ok);
+
+      // Allocation is top-down, so b1 is right after b2;
+      // once freed, b2 can grow into it.
+      ff1.deallocate (b1, 10, 8);
+      ok = ff1.try_resize (b2, 100, 110);
+      assert(ok);
+
+      ff1.deallocate (b2, 110, 8);
+      ff1.deallocate (b3, 20, 8);
+
+      assert(ff1.allocated_chunks () == 0);
+      assert(ff1.free_chunks () == 1);
+
+      // A single free chunk, the entire arena can be allocated.
+      assert(ff1.fragmentation () == 0);
+      assert(ff1.max_free_chunk () > 0);
+      assert(ff1.max_free_chunk () < ff1.free_bytes ());
+
+      // A large alignment is carved from the free chunk,
+      // the fragment below it remains free.
+      void* b4;
+      b4 = ff1.allocate (64, 256);
+      assert((reinterpret_cast<uintptr_t> (b4) & 255) == 0);
+      assert(ff1.allocated_bytes () < 64 + 256);
+
+      ff1.deallocate (b4, 64, 256);
+      assert(ff1.free_chunks () == 1);
     }
 
     {
-      // Dynamically allocated threads with allocated stacks.
-      thread* th3 = new thread
-        { "th3", func, nullptr };
+      static char arena[1024];
 
-      th3->join ();
-      delete th3;
-    }
+      os::memory::first_fit_top ff2
+        { "ff2", arena, sizeof(arena) };
 
-    {
-      // Dynamically allocated threads with allocated stacks.
-      std::unique_ptr<thread> th4
-        { new thread
-          { "th4", func, nullptr } };
+      // A cache of reclaimable blocks, and its shrinker.
+      cache_t cache
+        { &ff2, { }, 0 };
+      while (cache.count < 4)
+        {
+          cache.blocks[cache.count++] = ff2.allocate (150, 8);
+        }
+      os::rtos::memory::shrinker sh1
+        { ff2, cache_reclaim, &cache, 10 };
 
-      th4->join ();
-    }
+      bool ok = ff2.emergency_reserve (100);
+      assert(ok);
+      assert(ff2.emergency_reserve () == 100);
 
-    {
-      auto th5 = std::make_unique<thread> ("th5", func, nullptr);
+      // Fails, then the cache is released and the allocation retried.
+      void* b1;
+      b1 = ff2.allocate (400, 8);
+      assert(b1 != nullptr);
+      assert(sh1.reclaimed_bytes () > 0);
 
-      th5->join ();
+      // Only the critical allocations may use the reserve.
+      void* b2;
+      b2 = ff2.allocate (ff2.max_free_chunk () + 50, 8);
+      assert(b2 == nullptr);
+      b2 = ff2.allocate_critical (ff2.max_free_chunk () + 50, 8);
+      assert(b2 != nullptr);
+      assert(ff2.emergency_reserve () == 0);
+
+      // Allocated again after memory is returned.
+      ff2.deallocate (b2, 0, 8);
+      assert(ff2.emergency_reserve () == 100);
+
+      ff2.deallocate (b1, 400, 8);
+      ff2.emergency_reserve (0);
+      assert(ff2.allocated_chunks () == 0);
     }
 
     {
-      // Dynamically allocated threads with allocated stacks.
-      // The smart pointer internal data is allocated with the
-      // application allocator, but the thread is allocated with
-      // the system allocator.
-      std::shared_ptr<thread> th6
-        { new thread
-          { "th6", func, nullptr } };
+      static char arena[1024];
 
-      th6->join ();
-    }
+      os::memory::first_fit_top ff3
+        { "ff3", arena, sizeof(arena) };
 
-    {
-      // Warning, the thread is not allocated with the system allocator,
-      // but with the application allocator.
-      auto th7 = std::make_shared<thread> ("th7", func, nullptr);
+      void* b1;
+      b1 = ff3.allocate (40, 8);
+      void* b2;
+      b2 = ff3.allocate (40, 8);
+      void* b3;
+      b3 = ff3.allocate (40, 8);
 
-      th7->join ();
-    }
+      // A free chunk between two allocated chunks.
+      ff3.deallocate (b2, 40, 8);
 
-    {
-      auto th8 = std::allocate_shared<thread> (
-          rtos::memory::allocator<thread> (), "th8", func, nullptr);
+      // A few chunks at a time, several times around the arena.
+      for (int i = 0; i < 10; ++i)
+        {
+          const void* bad = ff3.verify (2);
+          assert(bad == nullptr);
+        }
 
-      th8->join ();
+#if defined(OS_INCLUDE_MEMORY_GUARD_WORDS)
+      // Write past the end of the block, over the guard word.
+      char saved[sizeof(std::size_t)];
+      char* past = static_cast<char*> (b1) + 40;
+      std::memcpy (saved, past, sizeof(saved));
+      std::memset (past, 0x55, sizeof(saved));
+
+      const void* bad = nullptr;
+      for (int i = 0; (i < 10) && (bad == nullptr); ++i)
+        {
+          bad = ff3.verify (2);
+        }
+      assert(bad != nullptr);
+      assert(bad < b1);
+
+      // Repaired, before it is freed.
+      std::memcpy (past, saved, sizeof(saved));
+      assert(ff3.verify (8) == nullptr);
+#endif
+
+      ff3.deallocate (b3, 40, 8);
+      ff3.deallocate (b1, 40, 8);
+      assert(ff3.free_chunks () == 1);
+      assert(ff3.verify (8) == nullptr);
     }
 
     {
-      auto th9 = rtos::make_shared<thread> ("th9", func, nullptr);
+      // The TLSF manager, with an included arena.
+      os::memory::tlsf_inclusive<1024> tm1
+        { "tm1" };
 
-      th9->join ();
+      void* b1;
+      b1 = tm1.allocate (10, 8);
+
+      void* b2;
+      b2 = tm1.allocate (100, 16);
+      assert((reinterpret_cast<uintptr_t> (b2) & 15) == 0);
+
+      void* b3;
+      b3 = tm1.allocate (50, 8);
+
+      void* b4;
+      b4 = tm1.allocate (2000, 8);
+      if (b4 == nullptr)
+        {
+          assert(b4 == nullptr);
+        }
+
+      // Deallocate in random order, to exercise coalescing.
+      tm1.deallocate (b2, 100, 16);
+      tm1.deallocate (b1, 10, 8);
+      tm1.deallocate (b3, 50, 8);
+
+      assert(tm1.allocated_chunks () == 0);
+      assert(tm1.free_chunks () == 1);
     }
 
     {
-      // Smart pointer to thread. Allocated with the mutex allocator (pool).
-      rtos::memory::unique_ptr<thread> th =
-          rtos::memory::allocate_unique<thread> (
-              rtos::memory::allocator_typed<thread> (), "th10", func, nullptr);
+      // The slab manager, with small sizes from block pools and
+      // large sizes from an upstream manager.
+      os::memory::tlsf_inclusive<1024> tm2
+        { "tm2" };
 
-      th->join ();
+      static constexpr std::size_t sizes[] =
+        { 16, 32, 64 };
+      static constexpr std::size_t blocks[] =
+        { 2, 2, 2 };
+      static char arena[os::memory::slab::compute_allocated_size_bytes (
+          sizes, blocks, 3)];
 
-      auto th2 = rtos::memory::allocate_unique<thread> (
-          rtos::memory::allocator_typed<thread> (), "th11", func, nullptr);
+      os::memory::slab sm1
+        { "sm1", sizes, blocks, 3, arena, sizeof(arena), &tm2 };
 
-      th2->join ();
-    }
+      void* b1;
+      b1 = sm1.allocate (10, 8);
 
-  // --------------------------------------------------------------------------
+      void* b2;
+      b2 = sm1.allocate (40, 8);
 
-  using my_thread = thread_allocated<rtos::memory::allocator<thread::stack::allocation_element_t>>;
+      // Too large for the size classes, served by the upstream manager.
+      void* b3;
+      b3 = sm1.allocate (200, 8);
 
-    {
-      // Static threads with custom allocated stacks.
-      my_thread ath1
-        { func, nullptr };
-      my_thread ath2
-        { "ath2", func, nullptr };
+      assert(sm1.size_class (0).allocated_chunks () == 1);
+      assert(sm1.size_class (2).allocated_chunks () == 1);
+      assert(tm2.allocated_chunks () == 1);
 
-      ath1.join ();
-      ath2.join ();
-    }
+      sm1.deallocate (b3, 200, 8);
+      sm1.deallocate (b1, 10, 8);
+      sm1.deallocate (b2, 40, 8);
 
-  // --------------------------------------------------------------------------
+      assert(sm1.allocated_chunks () == 0);
+      assert(tm2.allocated_chunks () == 0);
+    }
 
     {
-#pragma GCC diagnostic push
+      // The monotonic manager, with overflow buffers from an
+      // upstream manager, released back to a mark.
+      os::memory::tlsf_inclusive<1024> tm3
+        { "tm3" };
+
+      os::memory::monotonic_inclusive<128> mm1
+        { "mm1", &tm3 };
+
+      void* b1;
+      b1 = mm1.allocate (10, 8);
+
+      os::memory::monotonic::mark_t m = mm1.mark ();
+
+      void* b2;
+      b2 = mm1.allocate (100, 8);
+
+      // The arena is exhausted, served from an upstream buffer.
+      void* b3;
+      b3 = mm1.allocate (100, 8);
+
+      assert(tm3.allocated_chunks () == 1);
+
+      // Has no effect.
+      mm1.deallocate (b3, 100, 8);
+      mm1.deallocate (b2, 100, 8);
+
+      mm1.release_to (m);
+      assert(mm1.allocated_chunks () == 1);
+      assert(tm3.allocated_chunks () == 0);
+
+      // Used via the standard polymorphic allocator.
+      estd::pmr::polymorphic_allocator<int> a
+        { &mm1 };
+      int* p = a.allocate (4);
+      a.deallocate (p, 4);
+
+      mm1.deallocate (b1, 10, 8);
+      mm1.release ();
+      assert(mm1.allocated_chunks () == 0);
+    }
+
+    {
+      // The synchronized pool manager, with chunks grown from
+      // an upstream manager.
+      os::memory::tlsf_inclusive<2048> tm4
+        { "tm4" };
+
+      estd::pmr::synchronized_pool_resource pm1
+        { "pm1", estd::pmr::pool_options
+          { 4, 64 },
+          &tm4 };
+
+      void* b1;
+      b1 = pm1.allocate (10, 8);
+
+      void* b2;
+      b2 = pm1.allocate (12, 4);
+
+      // Too large for the pools, served by the upstream manager.
+      void* b3;
+      b3 = pm1.allocate (200, 8);
+
+      assert(pm1.allocated_chunks () == 2);
+      assert(tm4.allocated_chunks () == 2);
+
+      pm1.deallocate (b3, 200, 8);
+      pm1.deallocate (b1, 10, 8);
+      // Unknown size, all pools are searched.
+      pm1.deallocate (b2, 0, 4);
+
+      assert(pm1.allocated_chunks () == 0);
+
+      pm1.release ();
+      assert(tm4.allocated_chunks () == 0);
+    }
+
+#if defined(OS_INCLUDE_MEMORY_PROFILER)
+
+    {
+      // The profiler, recording the operations on another manager.
+      os::memory::tlsf_inclusive<1024> tm5
+        { "tm5" };
+
+      os::memory::profiler pr1
+        { "pr1", &tm5 };
+
+      void* b1;
+      b1 = pr1.allocate (10, 8);
+
+      void* b2;
+      b2 = pr1.allocate (20, 8);
+
+      pr1.deallocate (b1, 10, 8);
+
+      assert(pr1.records () == 3);
+      assert(pr1.record (0).operation == os::memory::profiler::allocation);
+      assert(pr1.record (2).addr == b1);
+
+      // The block not yet deallocated.
+      assert(pr1.live_allocations () == 1);
+      assert(pr1.allocated_chunks () == tm5.allocated_chunks ());
+
+      pr1.dump ();
+
+      pr1.deallocate (b2, 20, 8);
+      assert(pr1.live_allocations () == 0);
+    }
+
+#endif /* defined(OS_INCLUDE_MEMORY_PROFILER) */
+
+  // ==========================================================================
+
+  printf ("\n%s - Threads.\n", test_name);
+
+    {
+      // Static threads with allocated stacks.
+      thread th1
+        { func, nullptr };
+      thread th2
+        { "th2", func, nullptr };
+
+      th1.join ();
+      th2.join ();
+    }
+
+    {
+      // Dynamically allocated threads with allocated stacks.
+      thread* th3 = new thread
+        { "th3", func, nullptr };
+
+      th3->join ();
+      delete th3;
+    }
+
+    {
+      // Dynamically allocated threads with allocated stacks.
+      std::unique_ptr<thread> th4
+        { new thread
+          { "th4", func, nullptr } };
+
+      th4->join ();
+    }
+
+    {
+      auto th5 = std::make_unique<thread> ("th5", func, nullptr);
+
+      th5->join ();
+    }
+
+    {
+      // Dynamically allocated threads with allocated stacks.
+      // The smart pointer internal data is allocated with the
+      // application allocator, but the thread is allocated with
+      // the system allocator.
+      std::shared_ptr<thread> th6
+        { new thread
+          { "th6", func, nullptr } };
+
+      th6->join ();
+    }
+
+    {
+      // Warning, the thread is not allocated with the system allocator,
+      // but with the application allocator.
+      auto th7 = std::make_shared<thread> ("th7", func, nullptr);
+
+      th7->join ();
+    }
+
+    {
+      auto th8 = std::allocate_shared<thread> (
+          rtos::memory::allocator<thread> (), "th8", func, nullptr);
+
+      th8->join ();
+    }
+
+    {
+      auto th9 = rtos::make_shared<thread> ("th9", func, nullptr);
+
+      th9->join ();
+    }
+
+    {
+      // Smart pointer to thread. Allocated with the mutex allocator (pool).
+      rtos::memory::unique_ptr<thread> th =
+          rtos::memory::allocate_unique<thread> (
+              rtos::memory::allocator_typed<thread> (), "th10", func, nullptr);
+
+      th->join ();
+
+      auto th2 = rtos::memory::allocate_unique<thread> (
+          rtos::memory::allocator_typed<thread> (), "th11", func, nullptr);
+
+      th2->join ();
+    }
+
+  // --------------------------------------------------------------------------
+
+  using my_thread = thread_allocated<rtos::memory::allocator<thread::stack::allocation_element_t>>;
+
+    {
+      // Static threads with custom allocated stacks.
+      my_thread ath1
+        { func, nullptr };
+      my_thread ath2
+        { "ath2", func, nullptr };
+
+      ath1.join ();
+      ath2.join ();
+    }
+
+  // --------------------------------------------------------------------------
+
+    {
+#pragma GCC diagnostic push
 #if defined(__clang__)
 #pragma clang diagnostic ignored "-Wexit-time-destructors"
 #endif
@@ -358,6 +1019,194 @@ test_cpp_api (void)
       sth2.join ();
     }
 
+    {
+      // Time sliced threads with the same priority.
+      thread::attributes attr;
+      attr.th_quantum_ticks = 5;
+
+      thread th1
+        { "th1", func, nullptr, attr };
+      thread th2
+        { "th2", func, nullptr, attr };
+
+      th1.join ();
+      th2.join ();
+    }
+
+    {
+      // Short lived threads with the stacks from a pool.
+      struct stack_block_t
+      {
+        thread::stack::allocation_element_t stack[port::stack::default_size_bytes
+            / sizeof(thread::stack::allocation_element_t)];
+      };
+      static os::memory::block_pool_typed_inclusive<stack_block_t, 2> sp1
+        { "sp1" };
+
+      thread::attributes attr;
+      attr.th_stack_size_bytes = sizeof(stack_block_t);
+      attr.th_stack_resource = &sp1;
+
+      for (int i = 0; i < 3; ++i)
+        {
+          thread th
+            { "th", func, nullptr, attr };
+          assert(sp1.allocated_chunks () == 1);
+
+          th.join ();
+        }
+      assert(sp1.allocated_chunks () == 0);
+    }
+
+#if (OS_INTEGER_RTOS_THREAD_STACK_CACHE_ENTRIES > 0)
+
+    {
+      // Short lived threads reusing the cached stacks.
+      thread::stack::cache_flush ();
+
+      thread::attributes attr;
+      attr.th_stack_size_bytes = thread::stack::default_size () + 1024;
+
+      statistics::counter_t hits = thread::stack::cache_hits ();
+      statistics::counter_t misses = thread::stack::cache_misses ();
+
+      for (int i = 0; i < 3; ++i)
+        {
+          thread th
+            { "th", func, nullptr, attr };
+          th.join ();
+        }
+      assert(thread::stack::cache_misses () == misses + 1);
+      assert(thread::stack::cache_hits () == hits + 2);
+
+      assert(thread::stack::cache_flush () == 1);
+      assert(thread::stack::cache_flush () == 0);
+    }
+
+#endif
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+    {
+      // Higher priority threads, which terminate before the
+      // idle thread has a chance to run.
+      thread::attributes attr;
+      attr.th_priority = thread::priority::high;
+
+      thread th1
+        { "th1", func, nullptr, attr };
+      assert(th1.state () == thread::state::terminated);
+
+      // Destroyed by the joiner.
+      th1.join ();
+      assert(th1.state () == thread::state::destroyed);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_RECLAIM_ON_CREATE)
+
+      thread th2
+        { "th2", func, nullptr, attr };
+      assert(th2.state () == thread::state::terminated);
+
+      // Destroyed when the next thread is created.
+      thread th3
+        { "th3", func, nullptr, attr };
+      assert(th2.state () == thread::state::destroyed);
+
+      th2.join ();
+      th3.join ();
+
+#endif
+    }
+
+#endif
+
+  // ==========================================================================
+
+#if (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0)
+
+  printf ("\n%s - Thread local storage.\n", test_name);
+
+    {
+      thread::tls::key_t key;
+      thread::tls::create_key (&key, nullptr);
+
+      static int value;
+      this_thread::thread ().tls ().set (key, &value);
+      this_thread::thread ().tls ().get (key);
+
+      thread::tls::delete_key (key);
+    }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_TLS_SLOTS > 0) */
+
+  // ==========================================================================
+
+#if (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0)
+
+  printf ("\n%s - Thread allocation cache.\n", test_name);
+
+    {
+      class thread::allocation_cache& cache =
+          this_thread::thread ().allocation_cache ();
+      cache.flush ();
+
+      // Only the sized deallocation can cache blocks.
+      void* p1 = ::operator new (sizeof(int));
+      ::operator delete (p1, sizeof(int));
+      assert(cache.count () == 1);
+
+      // The block is reused from the cache.
+      void* p2 = ::operator new (sizeof(int));
+      assert(p2 == p1);
+      assert(cache.count () == 0);
+      ::operator delete (p2, sizeof(int));
+
+      cache.flush ();
+      assert(cache.count () == 0);
+    }
+
+#endif /* (OS_INTEGER_RTOS_THREAD_ALLOCATION_CACHE_BLOCKS > 0) */
+
+  // ==========================================================================
+
+  printf ("\n%s - Thread affinity.\n", test_name);
+
+    {
+      thread& th = this_thread::thread ();
+      thread::affinity_t mask = th.affinity ();
+
+      assert (th.affinity (1u) == result::ok);
+      assert (th.affinity () == 1u);
+
+      th.affinity (mask);
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Thread errno.\n", test_name);
+
+    {
+      // Each thread has its own slot.
+      int* p = this_thread::__errno ();
+      assert (p == &this_thread::thread ().errno_);
+      *p = EINVAL;
+
+      thread th
+        { "th_errno", [](void* args) -> void*
+          {
+            int* e = this_thread::__errno ();
+            assert (*e == 0);
+            *e = EBADF;
+            return (e != args) ? e : nullptr;
+          }, p };
+
+      void* res;
+      th.join (&res);
+      assert (res != nullptr);
+      assert (*p == EINVAL);
+      *p = 0;
+    }
+
   // ==========================================================================
 
   printf ("\n%s - Thread stack.\n", test_name);
@@ -379,8 +1228,132 @@ test_cpp_api (void)
 
       stack.check_bottom_magic ();
       stack.check_top_magic ();
+
+      // The full scan also sets the watermark, so the incremental
+      // peak is at least as deep.
+      std::size_t used = stack.size () - stack.available ();
+      n = stack.peak ();
+      assert (n >= used);
+      assert (n <= stack.size ());
+      assert (stack.peak () >= n);
+    }
+
+    {
+      // Periodic release, two ticks apart.
+      this_thread::periodic pr
+        { 2 };
+      clock::timestamp_t start = pr.release ();
+
+      pr.wait_next_period ();
+      pr.wait_next_period ();
+      // Skipped releases keep the phase.
+      assert(pr.release () == start + pr.period () * (2 + pr.overruns ()));
+    }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+    {
+      // Earliest deadline first jobs in the same band run by
+      // deadline, not by creation order.
+      static int order_ids[2] =
+        { 0, 1 };
+      static int order[2];
+      static int count;
+      count = 0;
+
+      thread::attributes attr;
+      attr.th_priority = thread::priority::below_normal;
+
+      attr.th_period_ticks = 20;
+      thread th_late
+        { "th_late", [](void* args) -> void*
+          {
+            order[count++] = *static_cast<int*>(args);
+            return nullptr;
+          }, &order_ids[1], attr };
+
+      attr.th_period_ticks = 5;
+      thread th_early
+        { "th_early", [](void* args) -> void*
+          {
+            order[count++] = *static_cast<int*>(args);
+            return nullptr;
+          }, &order_ids[0], attr };
+
+      assert(th_early.deadline () < th_late.deadline ());
+
+      th_late.join ();
+      th_early.join ();
+
+      assert(count == 2);
+      assert(order[0] == 0);
+      assert(order[1] == 1);
+    }
+
+    {
+      // A job completed after its deadline is counted.
+      thread::attributes attr;
+      attr.th_period_ticks = 2;
+      attr.th_deadline_ticks = 1;
+
+      thread th
+        { "th_miss", [](void* args) -> void*
+          {
+            this_thread::periodic pr;
+            sysclock.sleep_for (3);
+            pr.wait_next_period ();
+            return args;
+          }, nullptr, attr };
+
+      th.join ();
+      assert(th.statistics ().deadline_misses () == 1);
+      assert(th.period () == 2);
     }
 
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET)
+
+    {
+      // A runaway high priority thread is suspended when its budget
+      // is used, so the main thread still runs.
+      static volatile bool stop;
+      stop = false;
+
+      thread::attributes attr;
+      attr.th_priority = thread::priority::high;
+
+      thread th
+        { "th_budget", [](void* args) -> void*
+          {
+            sysclock.sleep_for (1);
+            clock::timestamp_t begin = sysclock.now ();
+            while (!stop && (sysclock.now () - begin) < 200)
+              ;
+            return stop ? args : nullptr;
+          }, &attr, attr };
+
+      rtos::statistics::duration_t tick_cycles =
+          hrclock.input_clock_frequency_hz () / sysclock.frequency_hz;
+      assert(th.cpu_budget (tick_cycles, 4, thread::budget_action::suspend)
+          == result::ok);
+      assert(th.cpu_budget () == tick_cycles);
+
+      // Runs only when the busy thread is suspended.
+      sysclock.sleep_for (2);
+      stop = true;
+
+      void* res;
+      th.join (&res);
+      assert(res == &attr);
+      assert(th.cpu_budget_overruns () >= 1);
+
+      assert(th.cpu_budget (0, 0) == result::ok);
+      assert(th.cpu_budget () == 0);
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_CPU_BUDGET) */
+
   // ==========================================================================
 
   printf ("\n%s - Thread event flags.\n", test_name);
@@ -398,6 +1371,58 @@ test_cpp_api (void)
       this_thread::flags_timed_wait (0x3, 10);
     }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+  // ==========================================================================
+
+  printf ("\n%s - Thread notifications.\n", test_name);
+
+    {
+      thread& th = this_thread::thread ();
+      notify::value_t value = 0;
+
+      th.notify (0x5, notify::action::set_bits);
+      th.notify (0x2, notify::action::set_bits);
+      assert(this_thread::notify_wait (&value, 0x1) == result::ok);
+      assert(value == 0x7);
+      // Consumed, but the bits not cleared remain.
+      assert(this_thread::notify_timed_wait (1, &value) == ETIMEDOUT);
+      assert(this_thread::notify_take () == 0x6);
+
+      th.notify ();
+      th.notify ();
+      th.notify ();
+      assert(this_thread::notify_take (false) == 3);
+      assert(this_thread::notify_take (true) == 2);
+      assert(this_thread::notify_timed_take (1) == 0);
+
+      th.notify (7, notify::action::overwrite);
+      assert(th.notify (8, notify::action::no_overwrite) == EAGAIN);
+      assert(this_thread::notify_wait (&value) == result::ok);
+      assert(value == 7);
+      assert(th.notify (9, notify::action::no_overwrite) == result::ok);
+      this_thread::notify_wait ();
+    }
+
+    {
+      // From the clock interrupt, to a waiting thread.
+      notify::value_t got = 0;
+      thread th
+        { "ntfw", notify_waiter, &got };
+
+      // Let it block.
+      sysclock.sleep_for (2);
+
+      timer tm
+        { "tm-ntf", tm_notify, &th };
+      tm.start (1);
+
+      th.join ();
+      assert(got == 0x40);
+    }
+
+#endif
+
   // ==========================================================================
 
   printf ("\n%s - Message queues.\n", test_name);
@@ -569,6 +1594,244 @@ test_cpp_api (void)
 
     }
 
+  // --------------------------------------------------------------------------
+
+    {
+      // Zero-copy send and receive.
+      message_queue zq1
+        { "zq1", 2, sizeof(my_msg_t) };
+
+      void* slot = zq1.alloc_slot ();
+      static_cast<my_msg_t*> (slot)->i = 1;
+      zq1.commit (slot, 2);
+
+      slot = zq1.try_alloc_slot ();
+      zq1.commit (slot);
+
+      // Full, both slots are used.
+      zq1.try_alloc_slot ();
+      zq1.timed_alloc_slot (1);
+
+      void* ref;
+      message_queue::priority_t prio;
+      zq1.receive_ref (&ref, &prio);
+      zq1.release (ref);
+
+      zq1.try_receive_ref (&ref);
+      zq1.release (ref);
+
+      zq1.timed_receive_ref (&ref, 1);
+
+      // Return an uncommitted slot.
+      slot = zq1.try_alloc_slot ();
+      zq1.release (slot);
+    }
+
+  // --------------------------------------------------------------------------
+
+    {
+      // Batched send and receive.
+      message_queue bq1
+        { "bq1", 4, sizeof(my_msg_t) };
+
+      my_msg_t msgs_out[3];
+      my_msg_t msgs_in[3];
+      message_queue::priority_t prios[3];
+      std::size_t n;
+
+      bq1.send_n (msgs_out, 3, sizeof(my_msg_t), &n);
+      // Only one slot left.
+      bq1.try_send_n (msgs_out, 3, sizeof(my_msg_t), &n);
+      // Full.
+      bq1.timed_send_n (msgs_out, 3, sizeof(my_msg_t), 1, &n);
+
+      bq1.receive_n (msgs_in, 3, sizeof(my_msg_t), &n, prios);
+      bq1.try_receive_n (msgs_in, 3, sizeof(my_msg_t), &n);
+      // Empty.
+      bq1.timed_receive_n (msgs_in, 3, sizeof(my_msg_t), 1, &n);
+    }
+
+  // --------------------------------------------------------------------------
+
+    {
+      // Variable length messages, without padding.
+      message_queue::attributes lattr;
+      lattr.mq_store_lengths = true;
+
+      message_queue lq1
+        { "lq1", 2, sizeof(my_msg_t), lattr };
+
+      lq1.send (&msg_out, sizeof(msg_out.i));
+      lq1.try_send (&msg_out, sizeof(my_msg_t));
+
+      std::size_t len;
+      lq1.receive (&msg_in, sizeof(my_msg_t), nullptr, &len);
+      lq1.try_receive (&msg_in, sizeof(my_msg_t), nullptr, &len);
+      // Empty.
+      lq1.timed_receive (&msg_in, sizeof(my_msg_t), 1, nullptr, &len);
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Mailboxes.\n", test_name);
+
+    {
+      mailbox<my_msg_t*, 2> mb1;
+      mailbox<my_msg_t*, 2> mb2
+        { "mb2" };
+
+      mb1.send (&msg_out);
+      mb1.try_send (&msg_out);
+      // Full.
+      mb1.try_send (&msg_out);
+      mb1.timed_send (&msg_out, 1);
+
+      my_msg_t* pmsg;
+      mb1.receive (&pmsg);
+      mb1.try_receive (&pmsg);
+      // Empty.
+      mb1.try_receive (&pmsg);
+      mb1.timed_receive (&pmsg, 1);
+
+      mb2.send (&msg_out);
+      mb2.reset ();
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Topics.\n", test_name);
+
+    {
+      // One copy, received by all subscribers.
+      topic_inclusive<int, 4> tp1
+        { "tp1" };
+      topic_inclusive<int, 4>::subscriber sub1
+        { tp1 };
+      topic_inclusive<int, 4>::subscriber sub2
+        { tp1 };
+      assert(tp1.subscribers () == 2);
+
+      int v = 0;
+      tp1.publish (1);
+      tp1.try_publish (2);
+      assert(sub1.available () == 2);
+
+      sub1.receive (&v);
+      assert(v == 1);
+      sub1.try_receive (&v);
+      assert(v == 2);
+      // Empty.
+      assert(sub1.try_receive (&v) == EWOULDBLOCK);
+      assert(sub1.timed_receive (&v, 1) == ETIMEDOUT);
+
+      const int* pv;
+      sub2.receive_ref (&pv);
+      assert(*pv == 1);
+      assert(sub2.release () == result::ok);
+      sub2.timed_receive (&v, 1);
+      assert(v == 2);
+
+      // Drop the oldest; the slow subscriber skips ahead.
+      for (int i = 3; i <= 8; ++i)
+        {
+          tp1.publish (i);
+        }
+      assert(sub1.available () == 4);
+      sub1.receive (&v);
+      assert(v == 5);
+      assert(sub1.lost () == 2);
+
+      // Overwritten while referenced.
+      sub2.receive_ref (&pv);
+      tp1.publish (9);
+      assert(sub2.release () == EOVERFLOW);
+    }
+
+    {
+      // Back-pressure from the slowest subscriber.
+      topic::attributes attr;
+      attr.tp_policy = topic::policy::block;
+      topic_inclusive<int, 2> tp2
+        { "tp2", attr };
+      topic_inclusive<int, 2>::subscriber sub1
+        { tp2 };
+
+      int v;
+      tp2.publish (1);
+      tp2.publish (2);
+      // Full.
+      assert(tp2.try_publish (3) == EWOULDBLOCK);
+      assert(tp2.timed_publish (3, 1) == ETIMEDOUT);
+      sub1.receive (&v);
+      assert(tp2.try_publish (3) == result::ok);
+      assert(tp2.published () == 3);
+    }
+
+    {
+      // The waiting subscriber is resumed by the publisher.
+      topic_inclusive<int, 2> tp3
+        { "tp3" };
+      topic_inclusive<int, 2>::subscriber sub1
+        { tp3 };
+      topic_reader_t r
+        { &sub1, 0 };
+      thread th1
+        { "tpr1", topic_reader, &r };
+
+      // Let it block.
+      sysclock.sleep_for (2);
+
+      tp3.publish (42);
+      th1.join ();
+      assert(r.value == 42);
+    }
+
+#if defined(OS_INCLUDE_RTOS_SNAPSHOT)
+
+  // ==========================================================================
+
+  printf ("\n%s - Snapshots.\n", test_name);
+
+    {
+      struct cfg_t
+      {
+        int rate;
+        int gain;
+      };
+
+      snapshot_inclusive<cfg_t, 2> snap
+        { "snap", cfg_t
+          { 1, 2 } };
+
+      assert(snap.read ()->rate == 1);
+      assert(snap.version () == 0);
+      assert(snap.retired () == 0);
+
+      const cfg_t* old = snap.read ();
+      assert(snap.try_update (cfg_t
+        { 3, 4 }) == result::ok);
+      assert(snap.read ()->rate == 3);
+      assert(snap.read () != old);
+      assert(snap.version () == 1);
+
+      // The idle thread did not run, the old version is still in use.
+      assert(snap.retired () == 1);
+      assert(snap.try_update (cfg_t
+        { 5, 6 }) == EWOULDBLOCK);
+      assert(old->rate == 1);
+
+      // Waits for a grace period.
+      assert(snap.update (cfg_t
+        { 5, 6 }) == result::ok);
+      assert(snap.read ()->gain == 6);
+      assert(snap.version () == 2);
+
+      assert(snap.synchronize () == result::ok);
+      assert(snap.retired () == 0);
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SNAPSHOT) */
+
   // ==========================================================================
 
   printf ("\n%s - Memory pools.\n", test_name);
@@ -645,6 +1908,33 @@ test_cpp_api (void)
       cp2->free (blk);
     }
 
+    {
+      // Pool storage allocated from a named memory region.
+      os::memory::first_fit_top_inclusive<512> rm1
+        { "rm1" };
+
+      rtos::memory::set_region ("rm1", &rm1);
+      assert(rtos::memory::region ("rm1") == &rm1);
+
+      memory_pool::attributes attr;
+      attr.mp_pool_region = "rm1";
+
+        {
+          memory_pool cp7
+            { "cp7", 3, sizeof(my_blk_t), attr };
+
+          assert(rm1.allocated_chunks () == 1);
+
+          blk = static_cast<my_blk_t*> (cp7.alloc ());
+          cp7.free (blk);
+        }
+
+      assert(rm1.allocated_chunks () == 0);
+
+      rtos::memory::set_region ("rm1", nullptr);
+      assert(rtos::memory::region ("rm1") == nullptr);
+    }
+
   // --------------------------------------------------------------------------
 
   // Template usage; block size and cast are supplied automatically.
@@ -970,6 +2260,36 @@ test_cpp_api (void)
       mx2->unlock ();
     }
 
+    {
+      // Priority ceiling mutexes; the running owner is raised
+      // immediately and restored by unlock.
+      thread& th = this_thread::thread ();
+      thread::priority_t prio = th.priority ();
+
+      mutex::attributes attr;
+      attr.mx_protocol = mutex::protocol::protect;
+      attr.mx_priority_ceiling = thread::priority::above_normal;
+
+      mutex mx1
+        { "mx-pc1", attr };
+
+      attr.mx_priority_ceiling = thread::priority::high;
+      mutex mx2
+        { "mx-pc2", attr };
+
+      mx1.lock ();
+      assert(th.priority () == thread::priority::above_normal);
+
+      mx2.lock ();
+      assert(th.priority () == thread::priority::high);
+
+      mx2.unlock ();
+      assert(th.priority () == thread::priority::above_normal);
+
+      mx1.unlock ();
+      assert(th.priority () == prio);
+    }
+
   // Unique pointer handling test.
     {
       std::unique_ptr<mutex> mx;
@@ -998,6 +2318,42 @@ test_cpp_api (void)
 
   // ==========================================================================
 
+  printf ("\n%s - Read-write locks.\n", test_name);
+
+    {
+      // Unnamed read-write lock.
+      rwlock rw;
+      rw.read_lock ();
+      rw.unlock ();
+    }
+
+    {
+      // Named read-write lock.
+      rwlock rw
+        { "rw2" };
+
+      rw.read_lock ();
+      rw.try_read_lock ();
+      rw.readers ();
+      rw.unlock ();
+      rw.unlock ();
+
+      rw.timed_read_lock (1);
+      rw.unlock ();
+
+      rw.write_lock ();
+      rw.writer ();
+      rw.unlock ();
+
+      rw.try_write_lock ();
+      rw.unlock ();
+
+      rw.timed_write_lock (1);
+      rw.unlock ();
+    }
+
+  // ==========================================================================
+
   printf ("\n%s - Semaphores.\n", test_name);
 
     {
@@ -1032,46 +2388,488 @@ test_cpp_api (void)
       sp.post ();
     }
 
-    {
-      // Raw pointer to semaphore. Allocated with the system allocator.
-      semaphore* sp;
-      sp = new semaphore
-        { "sp4" };
+    {
+      // Raw pointer to semaphore. Allocated with the system allocator.
+      semaphore* sp;
+      sp = new semaphore
+        { "sp4" };
+
+      sp->post ();
+
+      // Mandatory delete.
+      delete sp;
+    }
+
+    {
+      // Smart pointer to semaphore. Allocated with the system allocator.
+      std::unique_ptr<semaphore> sp = std::make_unique<semaphore> ("sp5");
+
+      sp->post ();
+
+      // No delete needed.
+    }
+
+    {
+      // Uninitialised smart pointer.
+      rtos::memory::unique_ptr<semaphore> sp0;
+      if (sp0 != nullptr)
+        {
+          sp0->post ();
+        }
+
+      // Smart pointer to semaphore. Allocated with the
+      // semaphore allocator (pool).
+      rtos::memory::unique_ptr<semaphore> sp = rtos::memory::allocate_unique<
+          semaphore> (rtos::memory::allocator_typed<semaphore> (), "sp6");
+
+      sp->post ();
+
+      auto sp2 = rtos::memory::allocate_unique<semaphore> (
+          rtos::memory::allocator_typed<semaphore> (), "sp7");
+
+      sp2->post ();
+    }
+
+  // ==========================================================================
+
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE) && !defined(OS_USE_RTOS_PORT_MUTEX) \
+  && !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+
+  printf ("\n%s - Constant initialised objects.\n", test_name);
+
+    {
+      assert(strcmp (static_sp.name (), "static-sp") == 0);
+      assert(static_sp.max_value () == 3);
+      assert(static_sp.value () == 1);
+
+      static_sp.post ();
+      assert(static_sp.value () == 2);
+      static_sp.wait ();
+      static_sp.wait ();
+      assert(static_sp.try_wait () == EWOULDBLOCK);
+      assert(static_sp.timed_wait (1) == ETIMEDOUT);
+
+      assert(static_sp.reset () == result::ok);
+      assert(static_sp.value () == 1);
+
+      assert(static_mx.type () == mutex::type::recursive);
+      static_mx.lock ();
+      static_mx.lock ();
+      assert(static_mx.owner () == &this_thread::thread ());
+      static_mx.unlock ();
+      static_mx.unlock ();
+      assert(static_mx.owner () == nullptr);
+
+      static_mx.lock ();
+      assert(static_cv.timed_wait (static_mx, 1) == ETIMEDOUT);
+      static_mx.unlock ();
+      static_cv.signal ();
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+      // Registered at the first use.
+      bool found = false;
+        {
+          scheduler::critical_section scs;
+
+          for (auto&& st : statistics::sync_objects ())
+            {
+              if (&st == &static_mx.sync_statistics ())
+                {
+                  found = true;
+                }
+            }
+        }
+      assert(found);
+      assert(static_mx.sync_statistics ().acquired () > 0);
+
+#endif
+    }
+
+  // ==========================================================================
+
+#endif
+
+  printf ("\n%s - Data cache maintenance.\n", test_name);
+
+    {
+      static_assert(dcache::align_size (1) == dcache::line_size_bytes, "");
+      static_assert(dcache::align_size (dcache::line_size_bytes)
+          == dcache::line_size_bytes, "");
+      static_assert(sizeof(dcache::dma_buffer<10>) == dcache::line_size_bytes,
+          "");
+
+      dcache::dma_buffer<100> db;
+      assert(db.size () == 100);
+      assert(
+          (reinterpret_cast<uintptr_t> (db.data ()) % dcache::line_size_bytes)
+              == 0);
+
+      uint8_t* p = static_cast<uint8_t*> (dcache::allocate (100));
+      assert(p != nullptr);
+      assert((reinterpret_cast<uintptr_t> (p) % dcache::line_size_bytes) == 0);
+      memset (p, 0x55, dcache::align_size (100));
+      dcache::deallocate (p, 100);
+
+      dcache::deallocate (nullptr, 100);
+
+#if defined(OS_INCLUDE_RTOS_DCACHE_MAINTENANCE)
+
+      dcache_cleaned = 0;
+      dcache_invalidated = 0;
+
+      db.prepare_transmit (10);
+      assert(dcache_cleaned == 1);
+      assert(dcache_invalidated == 0);
+      assert(dcache_last_addr == reinterpret_cast<uintptr_t> (db.data ()));
+      assert(dcache_last_bytes == dcache::line_size_bytes);
+
+      db.prepare_receive ();
+      assert(dcache_cleaned == 2);
+      assert(dcache_invalidated == 1);
+      assert(dcache_last_bytes == dcache::align_size (100));
+
+      // A range crossing a line boundary is extended to both lines.
+      db.complete_receive (1);
+      dcache::complete_receive (db.data () + dcache::line_size_bytes - 1, 2);
+      assert(dcache_invalidated == 3);
+      assert(dcache_last_addr == reinterpret_cast<uintptr_t> (db.data ()));
+      assert(dcache_last_bytes == 2 * dcache::line_size_bytes);
+
+      // Empty ranges are ignored.
+      dcache::clean (db.data (), 0);
+      assert(dcache_cleaned == 2);
+
+#endif
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Memory copy.\n", test_name);
+
+    {
+      uint8_t src[80];
+      uint8_t dst[80];
+      for (std::size_t i = 0; i < sizeof(src); ++i)
+        {
+          src[i] = static_cast<uint8_t> (i + 1);
+        }
+
+      // All alignments and the short, word and block tails.
+      for (std::size_t so = 0; so < 4; ++so)
+        {
+          for (std::size_t doff = 0; doff < 4; ++doff)
+            {
+              for (std::size_t n = 0; n <= 67; n += 7)
+                {
+                  memset (dst, 0xEE, sizeof(dst));
+                  utils::copy_bytes (dst + doff, src + so, n);
+                  assert(memcmp (dst + doff, src + so, n) == 0);
+                  assert(doff == 0 || dst[doff - 1] == 0xEE);
+                  assert(dst[doff + n] == 0xEE);
+                }
+            }
+        }
+
+      for (std::size_t doff = 0; doff < 4; ++doff)
+        {
+          for (std::size_t n = 0; n <= 67; n += 5)
+            {
+              memset (dst, 0xEE, sizeof(dst));
+              utils::fill_bytes (dst + doff, 0x5A, n);
+              for (std::size_t i = 0; i < n; ++i)
+                {
+                  assert(dst[doff + i] == 0x5A);
+                }
+              assert(doff == 0 || dst[doff - 1] == 0xEE);
+              assert(dst[doff + n] == 0xEE);
+            }
+        }
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Formatted output.\n", test_name);
+
+    {
+      char buf[64];
+
+      assert(format::snprintf (buf, sizeof(buf), "%d|%5d|%-5d|%05d|%+d|% d", -42,
+              42, 42, -42, 7, 7) == 27);
+      assert(strcmp (buf, "-42|   42|42   |-0042|+7| 7") == 0);
+
+      format::snprintf (buf, sizeof(buf), "%x %#X %o %#o %.3u %.0d|", 0xbeefu,
+                        0xbeefu, 8u, 8u, 5u, 0);
+      assert(strcmp (buf, "beef 0XBEEF 10 010 005 |") == 0);
+
+      format::snprintf (buf, sizeof(buf), "%lld %llu %zu %hhd", -9000000000LL,
+                        18446744073709551615ULL, static_cast<std::size_t> (9),
+                        300);
+      assert(strcmp (buf, "-9000000000 18446744073709551615 9 44") == 0);
+
+      format::snprintf (buf, sizeof(buf), "[%s][%6.2s][%-3c][%*d][%%]", "abc",
+                        "abc", 'z', 4, 1);
+      assert(strcmp (buf, "[abc][    ab][z  ][   1][%]") == 0);
+
+      // Truncated, but the entire length is returned.
+      char small[5];
+      assert(format::snprintf (small, sizeof(small), "%s", "abcdefgh") == 8);
+      assert(strcmp (small, "abcd") == 0);
+
+#if defined(OS_INCLUDE_FORMAT_FLOAT)
+
+      format::snprintf (buf, sizeof(buf), "%.2f %.0f %.0f %e %g %g %G",
+                        3.14159, 0.5, 1.5, 12345.678, 0.0001, 1e20, 1e-10);
+      assert(strcmp (buf, "3.14 0 2 1.234568e+04 0.0001 1e+20 1E-10") == 0);
+
+      format::snprintf (buf, sizeof(buf), "%08.3f|%-8.1f|%+.1e", -1.5, 2.25,
+                        0.0);
+      assert(strcmp (buf, "-001.500|2.2     |+0.0e+00") == 0);
+
+#endif
+
+      // A sink error stops the formatting.
+      auto failing_sink = [](void*, const char*, std::size_t) -> ssize_t
+        { return -1;};
+      assert(format::print (failing_sink, nullptr, "%d", 1) == -1);
+    }
+
+  // ==========================================================================
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_LOAD)
+
+  printf ("\n%s - CPU load.\n", test_name);
+
+    {
+      thread& self = this_thread::thread ();
+      bool sampled = false;
+
+      // Keep the CPU busy for a while.
+      clock::timestamp_t begin = sysclock.now ();
+      while (sysclock.now () - begin < 300)
+        {
+          sampled |= scheduler::statistics::sample_cpu_load ();
+        }
+      assert(sampled);
+
+      statistics::load_t busy = self.statistics ().cpu_load (
+          statistics::load_window::one_second);
+      assert(busy > 0);
+      assert(busy <= statistics::load_full_scale);
+      assert(scheduler::statistics::cpu_load () > 0);
+
+      // Let the idle thread run.
+      for (int i = 0; i < 10; ++i)
+        {
+          sysclock.sleep_for (50);
+          scheduler::statistics::sample_cpu_load ();
+        }
+      assert(self.statistics ().cpu_load () < busy);
+      assert(
+          self.statistics ().cpu_load (statistics::load_window::one_minute)
+              <= statistics::load_full_scale);
+
+      printf ("total %u/%u/%u\n",
+              static_cast<unsigned int> (scheduler::statistics::cpu_load (
+                  statistics::load_window::one_second)),
+              static_cast<unsigned int> (scheduler::statistics::cpu_load (
+                  statistics::load_window::ten_seconds)),
+              static_cast<unsigned int> (scheduler::statistics::cpu_load (
+                  statistics::load_window::one_minute)));
+    }
+
+  // ==========================================================================
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_IDLE_POWER_STATES)
+
+  printf ("\n%s - Low power states.\n", test_name);
+
+    {
+      assert(power::select_state (10000, power::no_constraint)
+          == power::state::sleep);
+
+      assert(power::enable_state (power::state::stop,
+            { 100, 1000 }) == result::ok);
+      assert(power::enable_state (power::state::count,
+            { 0, 0 }) == EINVAL);
+      assert(power::disable_state (power::state::sleep) == EINVAL);
+
+      assert(power::select_state (2000, power::no_constraint)
+          == power::state::stop);
+      assert(power::select_state (500, power::no_constraint)
+          == power::state::sleep);
+      assert(power::select_state (2000, 50) == power::state::sleep);
+
+      assert(power::latency_constraint () == power::no_constraint);
+        {
+          power::latency_request lr1
+            { 50 };
+          assert(power::latency_constraint () == 50);
+          lr1.update (20);
+
+          power::latency_request lr2
+            { 30 };
+          assert(power::latency_constraint () == 20);
+          assert(lr2.latency () == 30);
+        }
+      assert(power::latency_constraint () == power::no_constraint);
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      // The idle thread selects stop, the hook declines it.
+      power::statistics::clear ();
+      power_stop_requests = 0;
+      sysclock.sleep_for (20);
+      assert(power_stop_requests > 0);
+      assert(power::statistics::entries (power::state::stop) == 0);
+      assert(power::statistics::entries (power::state::sleep) > 0);
+      assert(power::statistics::residency (power::state::sleep) > 0);
+
+        {
+          // Too strict for stop.
+          power::latency_request lr
+            { 10 };
+          power_stop_requests = 0;
+          sysclock.sleep_for (20);
+          assert(power_stop_requests == 0);
+        }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+      power::disable_state (power::state::stop);
+    }
+
+  // ==========================================================================
 
-      sp->post ();
+#endif
 
-      // Mandatory delete.
-      delete sp;
-    }
+  printf ("\n%s - Single producer, single consumer queues.\n", test_name);
 
     {
-      // Smart pointer to semaphore. Allocated with the system allocator.
-      std::unique_ptr<semaphore> sp = std::make_unique<semaphore> ("sp5");
+      spsc_queue<uint32_t, 4> sq
+        { "sq" };
 
-      sp->post ();
+      uint32_t val;
+      sq.try_send (1);
+      sq.try_receive (&val);
 
-      // No delete needed.
+      sq.try_send (2);
+      sq.receive (&val);
+
+      sq.timed_receive (&val, 1);
+
+      sq.length ();
+      sq.capacity ();
     }
 
+  // ==========================================================================
+
+  printf ("\n%s - Inter-core channels.\n", test_name);
+
     {
-      // Uninitialised smart pointer.
-      rtos::memory::unique_ptr<semaphore> sp0;
-      if (sp0 != nullptr)
+      // Both ends on the same core, the doorbells call the
+      // handler of the other end directly.
+      static constexpr std::size_t shared_size =
+          amp_channel::compute_shared_size_bytes (4, 16);
+      alignas(OS_INTEGER_RTOS_CACHE_LINE_SIZE_BYTES) static uint8_t shared[shared_size];
+
+      // The receiver end, rung by the sender.
+      static amp_channel* peer = nullptr;
+
+      amp_channel::attributes attr_tx;
+      attr_tx.ch_doorbell = [](void* args __attribute__((unused)))
         {
-          sp0->post ();
+          if (peer != nullptr)
+            {
+              peer->interrupt_handler ();
+            }
+        };
+
+      amp_channel tx
+        { "tx", amp_channel::role::sender, shared, sizeof(shared), 16, attr_tx };
+      amp_channel rx
+        { "rx", amp_channel::role::receiver, shared, sizeof(shared), 16 };
+      peer = &rx;
+
+      assert (tx.capacity () == 4);
+      assert (rx.empty ());
+
+      char buf[16];
+      std::size_t len;
+      assert (tx.try_send ("abc", 4) == result::ok);
+      assert (rx.length () == 1);
+      assert (rx.try_receive (buf, sizeof(buf), &len) == result::ok);
+      assert (len == 4 && std::strcmp (buf, "abc") == 0);
+      assert (rx.try_receive (buf, sizeof(buf)) == EWOULDBLOCK);
+
+      // Zero-copy.
+      void* slot = tx.alloc_slot ();
+      assert (slot != nullptr);
+      std::memcpy (slot, "xyz", 4);
+      assert (tx.commit (slot, 4) == result::ok);
+      assert (rx.receive_ref (&slot, &len) == result::ok);
+      assert (len == 4 && std::strcmp (static_cast<char*> (slot), "xyz") == 0);
+      assert (rx.release (slot) == result::ok);
+
+      for (int i = 0; i < 4; ++i)
+        {
+          assert (tx.try_send ("f", 2) == result::ok);
+        }
+      assert (tx.full ());
+      assert (tx.try_send ("f", 2) == EWOULDBLOCK);
+      assert (tx.timed_send ("f", 2, 1) == ETIMEDOUT);
+      while (rx.try_receive (buf, sizeof(buf)) == result::ok)
+        {
+          ;
         }
+      assert (rx.timed_receive (buf, sizeof(buf), 1) == ETIMEDOUT);
+
+      // A blocking receive, woken by the doorbell.
+      thread th
+        { "amp", [](void* args) -> void*
+          {
+            sysclock.sleep_for (2);
+            static_cast<amp_channel*> (args)->send ("w", 2);
+            return nullptr;
+          }, &tx };
+      assert (rx.receive (buf, sizeof(buf)) == result::ok);
+      assert (buf[0] == 'w');
+      th.join ();
+
+      peer = nullptr;
+    }
 
-      // Smart pointer to semaphore. Allocated with the
-      // semaphore allocator (pool).
-      rtos::memory::unique_ptr<semaphore> sp = rtos::memory::allocate_unique<
-          semaphore> (rtos::memory::allocator_typed<semaphore> (), "sp6");
+  // ==========================================================================
 
-      sp->post ();
+  printf ("\n%s - Clocks.\n", test_name);
 
-      auto sp2 = rtos::memory::allocate_unique<semaphore> (
-          rtos::memory::allocator_typed<semaphore> (), "sp7");
+    {
+      // Read across several ticks; the lock free reads never go back.
+      clock::timestamp_t t0 = sysclock.now ();
+      clock::timestamp_t h0 = hrclock.now ();
+      uint64_t ns0 = hrclock.nanoseconds ();
+      while (sysclock.now () < t0 + 3)
+        {
+          clock::timestamp_t h = hrclock.now ();
+          assert(h >= h0);
+          h0 = h;
 
-      sp2->post ();
+          uint64_t ns = hrclock.nanoseconds ();
+          assert(ns >= ns0);
+          ns0 = ns;
+        }
+      assert(sysclock.steady_now () >= t0 + 3);
+      assert(rtclock.now () >= rtclock.steady_now ());
+
+      // The fixed point conversion, one second and a long uptime
+      // (over an hour at 1 GHz), where cycles * 10^9 would overflow.
+      uint32_t hz = hrclock.input_clock_frequency_hz ();
+      uint64_t ns = hrclock.cycles_to_nanoseconds (hz);
+      assert((ns <= 1000000000ull) && (ns >= 1000000000ull - 1));
+      ns = hrclock.cycles_to_nanoseconds (static_cast<uint64_t> (hz) * 4000);
+      assert((ns <= 4000000000000ull) && (ns >= 4000000000000ull - 4000));
     }
 
   // ==========================================================================
@@ -1178,6 +2976,686 @@ test_cpp_api (void)
       tm2->stop ();
     }
 
+    {
+      // Periodic timer allowed to be delayed, to share wakeups.
+      assert(clock::coalesce (13, 0) == 13);
+      assert(clock::coalesce (13, 7) == 16);
+      assert(clock::coalesce (16, 10) == 16);
+
+      timer::attributes attr
+        { timer::periodic_initializer };
+      attr.tm_slack = 3;
+
+      timer tm
+        { "tm10", tmfunc, nullptr, attr };
+      sysclock.sleep_for (1); // Sync
+      tm.start (2);
+
+      sysclock.sleep_for (4, 3);
+      tm.stop ();
+    }
+
+#if defined(OS_USE_RTOS_CLOCK_HIGHRES_COMPARE) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+    {
+      // Single-shot timer on the high resolution clock, half a tick.
+      timer::attributes attr;
+      attr.clock = &hrclock;
+
+      timer tm
+        { "tm11", tmfunc, nullptr, attr };
+      sysclock.sleep_for (1); // Sync
+      tm.start (port::clock_highres::cycles_per_tick () / 2);
+
+      hrclock.sleep_for (port::clock_highres::cycles_per_tick ());
+      tm.stop ();
+    }
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+    {
+      // Periodic timer with the function called by the timer daemon.
+      timer::attributes attr
+        { timer::periodic_initializer };
+      attr.tm_run_in_thread = true;
+
+      timer tm
+        { "tm9", tmfunc, nullptr, attr };
+      assert(timer::daemon () != nullptr);
+      sysclock.sleep_for (1); // Sync
+      tm.start (1);
+
+      sysclock.sleep_for (3);
+      tm.stop ();
+    }
+
+#endif
+
+#if defined(OS_USE_RTOS_COALESCED_RESCHEDULE) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+    {
+      // The timer function runs in the clock interrupt; the three
+      // resumes are served by a single reschedule.
+      semaphore sems[3];
+      thread th1
+        { "semw1", sem_waiter, &sems[0] };
+      thread th2
+        { "semw2", sem_waiter, &sems[1] };
+      thread th3
+        { "semw3", sem_waiter, &sems[2] };
+
+      // Let all block.
+      sysclock.sleep_for (2);
+
+      statistics::counter_t coalesced =
+          scheduler::statistics::coalesced_reschedules ();
+
+      timer tm
+        { "tm10", tm_post3, sems };
+      tm.start (1);
+
+      th1.join ();
+      th2.join ();
+      th3.join ();
+      assert(scheduler::statistics::coalesced_reschedules () >= coalesced + 2);
+    }
+
+#endif
+
+  // ==========================================================================
+
+  printf ("\n%s - Barriers.\n", test_name);
+
+    {
+      // A single thread in the group, each arrival ends the phase.
+      barrier br1
+        { 1 };
+      br1.arrive_and_wait ();
+
+      barrier br2
+        { "br2", 2, tmfunc, nullptr };
+      barrier::phase_t phase;
+      br2.arrive (&phase);
+      br2.arrive ();
+      br2.wait (phase);
+      br2.phase ();
+
+      br2.arrive (&phase);
+      br2.timed_wait (phase, 1);
+      br2.arrive_and_drop ();
+      br2.expected ();
+      br2.pending ();
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Latches.\n", test_name);
+
+    {
+      latch lt1
+        { 1 };
+      lt1.try_wait ();
+      lt1.arrive_and_wait ();
+
+      latch lt2
+        { "lt2", 2 };
+      lt2.count_down ();
+      lt2.timed_wait (1);
+      lt2.count_down ();
+      lt2.wait ();
+      lt2.count ();
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Wait sets.\n", test_name);
+
+    {
+      semaphore sp
+        { "sp6" };
+      event_flags ev
+        { "ev6" };
+      message_queue mq
+        { "mq6", 3, sizeof(my_msg_t) };
+      memory_pool mp
+        { "mp6", 3, sizeof(my_blk_t) };
+
+      wait_set ws
+        { "ws" };
+      ws.add (sp);
+      ws.add (ev, 0x1);
+      ws.add (mq);
+      ws.add (mp);
+
+      wait_set::index_t index;
+      ws.try_wait (&index);
+
+      sp.post ();
+      ws.wait (&index);
+      sp.try_wait ();
+
+      ev.raise (0x1);
+      ws.timed_wait (&index, 1);
+
+      ws.clear ();
+      ws.size ();
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Event flags wakeups.\n", test_name);
+
+    {
+      event_flags ev
+        { "ev8" };
+
+      evflags_waiter_t w1
+        { &ev, 0x1, 0 };
+      evflags_waiter_t w2
+        { &ev, 0x2, 0 };
+
+      thread th1
+        { "evw1", evflags_waiter, &w1 };
+      thread th2
+        { "evw2", evflags_waiter, &w2 };
+
+      // Let both block.
+      sysclock.sleep_for (2);
+      assert(ev.waiting ());
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
+      statistics::counter_t switches = th1.statistics ().context_switches ();
+#endif
+
+      // Only the thread waiting for 0x2 is resumed.
+      ev.raise (0x2);
+      th2.join ();
+      assert(w2.got == 0x2);
+      assert(w1.got == 0);
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
+      assert(th1.statistics ().context_switches () == switches);
+#endif
+
+      ev.raise (0x1);
+      th1.join ();
+      assert(w1.got == 0x1);
+      assert(!ev.waiting ());
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Work queues.\n", test_name);
+
+    {
+      // Work queue with allocated items and worker stack.
+      work_queue wq1
+        { 4 };
+      wq1.post (tmfunc, nullptr);
+
+      work_queue wq2
+        { "wq2", 4 };
+      wq2.post (tmfunc);
+
+      sysclock.sleep_for (1);
+    }
+
+    {
+      // Work queue with inclusive storage.
+      work_queue_inclusive<4> wq3
+        { "wq3" };
+      for (std::size_t i = 0; i < wq3.capacity (); ++i)
+        {
+          wq3.post (tmfunc, nullptr);
+        }
+
+      sysclock.sleep_for (1);
+    }
+
+  // ==========================================================================
+
+#if defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+  printf ("\n%s - Coroutines.\n", test_name);
+
+    {
+      coroutine::executor_inclusive<> ex
+        { "ex" };
+
+      // Many coroutines waiting on a single stack.
+      semaphore_counting sem
+        { "co-sem", 32, 0 };
+      co_done = 0;
+      for (int i = 0; i < 16; ++i)
+        {
+          result_t res = ex.spawn (co_sem_waiter (sem));
+          assert(res == result::ok);
+        }
+      sysclock.sleep_for (1);
+      assert(ex.tasks () == 16);
+      assert(co_done == 0);
+
+      for (int i = 0; i < 16; ++i)
+        {
+          sem.post ();
+        }
+      sysclock.sleep_for (1);
+      assert(co_done == 16);
+      assert(ex.tasks () == 0);
+
+      // Already available, does not suspend.
+      sem.post ();
+      ex.spawn (co_sem_waiter (sem));
+      sysclock.sleep_for (1);
+      assert(co_done == 17);
+
+      // Timeouts.
+      ex.spawn (co_timeouts (sem));
+      sysclock.sleep_for (8);
+      assert(co_done == 18);
+
+      // Message queues, both directions.
+      message_queue mq1
+        { "co-mq1", 1, sizeof(my_msg_t) };
+      message_queue mq2
+        { "co-mq2", 1, sizeof(my_msg_t) };
+      my_msg_t msg
+        { 1, "co" };
+      mq2.send (&msg, sizeof(msg));
+      ex.spawn (co_mq_echo (mq1, mq2));
+      mq1.send (&msg, sizeof(msg));
+      sysclock.sleep_for (1);
+      // Full, waiting to send.
+      assert(co_done == 18);
+      mq2.receive (&msg, sizeof(msg));
+      mq2.receive (&msg, sizeof(msg));
+      assert(msg.i == 2);
+      sysclock.sleep_for (1);
+      assert(co_done == 19);
+
+      // Event flags, resumed only when all are raised.
+      event_flags ev
+        { "co-ev" };
+      flags::mask_t got = 0;
+      ex.spawn (co_evflags_waiter (ev, &got));
+      ev.raise (0x1);
+      sysclock.sleep_for (1);
+      assert(co_done == 19);
+      ev.raise (0x2);
+      sysclock.sleep_for (1);
+      assert(co_done == 20);
+      assert(got == 0x3);
+
+        {
+          // Destroyed with the executor, the semaphore remains.
+          coroutine::executor ex2
+            { "ex2" };
+          ex2.spawn (co_sem_waiter (sem));
+          sysclock.sleep_for (1);
+          assert(ex2.tasks () == 1);
+        }
+      // No node left in the semaphore list.
+      sem.post ();
+      assert(sem.value () == 1);
+    }
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+  // ==========================================================================
+
+  printf ("\n%s - SRP tasks.\n", test_name);
+
+    {
+      srp::dispatcher_inclusive<> disp
+        { "srp" };
+      message_queue mq
+        { "srp-mq", 4, sizeof(int) };
+
+      srp_ctx_t ctx
+        { };
+      srp::resource res
+        { disp, 3 };
+      srp::task low
+        { "low", disp, 1, srp_low, &ctx };
+      srp::task mid
+        { "mid", disp, 2, srp_mid, &ctx };
+      srp::task high
+        { "high", disp, 3, srp_high, &ctx };
+      srp::task cnt
+        { "cnt", disp, 1, srp_count, &ctx };
+      ctx.res = &res;
+      ctx.mid = &mid;
+      ctx.high = &high;
+      ctx.mq = &mq;
+
+      // From a thread, on the dispatcher stack.
+      low.post ();
+      sysclock.sleep_for (1);
+      assert(strcmp (ctx.trace, "lLhmhe") == 0);
+      assert(disp.running_priority () == 0);
+      assert(disp.ceiling () == 0);
+
+      // The tasks talk to the threads through the queues.
+      int v;
+      assert(mq.timed_receive (&v, sizeof(v), 10) == result::ok);
+      assert(v == 3);
+      assert(mq.timed_receive (&v, sizeof(v), 10) == result::ok);
+      assert(v == 5);
+
+      // One call for each activation.
+      cnt.post ();
+      cnt.post ();
+      cnt.post ();
+      sysclock.sleep_for (1);
+      assert(ctx.count == 3);
+      assert(cnt.pending () == 0);
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Deferred initialisations.\n", test_name);
+
+    {
+      deferred_init::wait (10);
+      assert(deferred_init::completed (10));
+      assert(deferred_init_done);
+    }
+
+  // ==========================================================================
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK)
+
+  printf ("\n%s - Clock statistics.\n", test_name);
+
+    {
+      sysclock.max_expired_per_tick_reset ();
+      sysclock.sleep_for (1);
+      assert(sysclock.max_expired_per_tick () >= 1);
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK) */
+
+  // ==========================================================================
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_SYNC)
+
+  printf ("\n%s - Synchronisation statistics.\n", test_name);
+
+    {
+      mutex mx
+        { "mx-st" };
+      mx.lock ();
+      mx.unlock ();
+
+      semaphore sp
+        { "sp-st" };
+      sp.post ();
+      sp.wait ();
+
+      mx.sync_statistics ().acquired ();
+      sp.sync_statistics ().wait_max ();
+
+        {
+          scheduler::critical_section scs;
+
+          for (auto&& st : statistics::sync_objects ())
+            {
+              trace::printf ("%s %u/%u %u\n", st.name (),
+                             static_cast<unsigned int> (st.contended ()),
+                             static_cast<unsigned int> (st.acquired ()),
+                             static_cast<unsigned int> (st.hold_max ()));
+            }
+        }
+
+      mx.sync_statistics ().clear ();
+    }
+
+  // ==========================================================================
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MESSAGE_QUEUE)
+
+  printf ("\n%s - Message queue statistics.\n", test_name);
+
+    {
+      message_queue mq
+        { "mq-st", 2, sizeof(my_msg_t) };
+
+      mq.send (&msg_out, sizeof(my_msg_t));
+      mq.send (&msg_out, sizeof(my_msg_t));
+      mq.receive (&msg_in, sizeof(my_msg_t));
+      mq.receive (&msg_in, sizeof(my_msg_t));
+
+      auto& st = mq.statistics ();
+      trace::printf ("%s %u %u/%u %u/%u\n", mq.name (),
+                     static_cast<unsigned int> (st.depth_max ()),
+                     static_cast<unsigned int> (st.send_blocked ()),
+                     static_cast<unsigned int> (st.receive_blocked ()),
+                     static_cast<unsigned int> (st.latency_max ()),
+                     static_cast<unsigned int> (st.received ()));
+      st.latency_total ();
+
+      st.clear ();
+    }
+
+  // ==========================================================================
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_FOOTPRINT)
+
+  printf ("\n%s - Memory footprint.\n", test_name);
+
+    {
+      struct found_t
+      {
+        const void* object;
+        std::size_t storage_bytes;
+        std::size_t used_bytes;
+        unsigned int threads;
+        unsigned int pools;
+      };
+
+      auto find = [] (const footprint::item& it, void* arg)
+        {
+          found_t* f = static_cast<found_t*> (arg);
+          if (std::strcmp (it.kind, "thread") == 0)
+            {
+              ++f->threads;
+              assert(it.storage_bytes > 0);
+            }
+          if (std::strcmp (it.kind, "mempool") == 0)
+            {
+              ++f->pools;
+            }
+          if (it.object == f->object)
+            {
+              f->storage_bytes = it.storage_bytes;
+              f->used_bytes = it.used_bytes;
+              f->object = nullptr;
+            }
+        };
+
+      found_t f0 { nullptr, 0, 0, 0, 0 };
+      footprint::for_each (find, &f0);
+
+        {
+          memory_pool mp
+            { "mp-fp", 4, sizeof(my_blk_t) };
+          message_queue mq
+            { "mq-fp", 2, sizeof(my_msg_t) };
+          mutex mx
+            { "mx-fp" };
+
+          void* blk = mp.try_alloc ();
+          assert(blk != nullptr);
+          mq.send (&msg_out, sizeof(my_msg_t));
+
+          found_t f { &mp, 0, 0, 0, 0 };
+          footprint::for_each (find, &f);
+          assert(f.object == nullptr);
+          assert(f.storage_bytes >= 4 * sizeof(my_blk_t));
+          assert(f.used_bytes == mp.block_size ());
+          // At least main and idle.
+          assert(f.threads >= 2);
+          assert(f.pools == f0.pools + 1);
+
+          f = { &mq, 0, 0, 0, 0 };
+          footprint::for_each (find, &f);
+          assert(f.object == nullptr);
+          assert(f.used_bytes == sizeof(my_msg_t));
+
+          f = { &mx, 0, 0, 0, 0 };
+          footprint::for_each (find, &f);
+          assert(f.object == nullptr);
+
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+          // Constant initialised, not registered.
+          f = { &static_mx, 0, 0, 0, 0 };
+          footprint::for_each (find, &f);
+          assert(f.object != nullptr);
+#endif
+
+          footprint::report ();
+
+          mp.free (blk);
+        }
+
+      // Unregistered by the destructors.
+      found_t f { nullptr, 0, 0, 0, 0 };
+      footprint::for_each (find, &f);
+      assert(f.pools == f0.pools);
+    }
+
+  // ==========================================================================
+
+#endif
+
+  printf ("\n%s - Memory pool batches.\n", test_name);
+
+    {
+      memory_pool mp
+        { "mp-n", 8, sizeof(my_blk_t) };
+
+      void* blks[8];
+      assert(mp.try_alloc_n (5, blks) == 5);
+      assert(mp.try_alloc_n (5, &blks[5]) == 3);
+      assert(mp.full ());
+      assert(mp.try_alloc_n (1, blks) == 0);
+      assert(mp.timed_alloc_n (1, blks, 1) == 0);
+
+      // An invalid address rejects the whole batch.
+      void* bad[2] =
+        { blks[0], &blks };
+      assert(mp.free_n (2, bad) == EINVAL);
+      assert(mp.count () == 8);
+
+      assert(mp.free_n (8, blks) == result::ok);
+      assert(mp.empty ());
+
+      assert(mp.alloc_n (6, blks) == 6);
+
+      mempool_batch_waiter_t w
+        { &mp, {}, 0 };
+      assert(mp.alloc_n (2, &blks[6]) == 2);
+
+      thread th
+        { "mpw", mempool_batch_waiter, &w };
+
+      // Let it block.
+      sysclock.sleep_for (2);
+      assert(w.got == 0);
+
+      // The waiter gets both blocks released by the batch.
+      assert(mp.free_n (2, &blks[6]) == result::ok);
+      th.join ();
+      assert(w.got == 2);
+
+      assert(mp.free_n (w.got, w.blocks) == result::ok);
+      assert(mp.free_n (6, blks) == result::ok);
+      assert(mp.empty ());
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Memory pool sets.\n", test_name);
+
+    {
+      typedef struct
+      {
+        uint8_t data[16];
+      } small_blk_t;
+      typedef struct
+      {
+        uint8_t data[64];
+      } large_blk_t;
+
+      memory_pool_set_inclusive<memory_pool_inclusive<small_blk_t, 2>,
+          memory_pool_inclusive<large_blk_t, 1>> mps
+        { "mps" };
+
+      assert(mps.size () == 2);
+      assert(mps.max_block_size () == sizeof(large_blk_t));
+
+      void* s1 = mps.alloc (10);
+      void* s2 = mps.try_alloc (16);
+      assert(mps.owner (s1) == &mps.pool (0));
+      assert(mps.owner (s2) == &mps.pool (0));
+
+      // The small class is full, fall back to the large one.
+      void* l1 = mps.timed_alloc (8, 1);
+      assert(mps.owner (l1) == &mps.pool (1));
+      assert(mps.usage (1).fallbacks == 1);
+      assert(mps.usage (0).count_max == 2);
+
+      // Nothing left, and nothing that large.
+      assert(mps.try_alloc (1) == nullptr);
+      assert(mps.timed_alloc (1, 1) == nullptr);
+      assert(mps.alloc (sizeof(large_blk_t) + 1) == nullptr);
+      assert(mps.failures () == 3);
+
+      assert(mps.free (&mps) == EINVAL);
+
+      // A waiter for a small block is woken by a large block.
+      mempool_set_waiter_t w
+        { &mps, nullptr };
+      thread th
+        { "mpsw", mempool_set_waiter, &w };
+
+      sysclock.sleep_for (2);
+      assert(w.block == nullptr);
+
+      assert(mps.free (l1) == result::ok);
+      th.join ();
+      assert(mps.owner (w.block) == &mps.pool (1));
+
+      mps.free (w.block);
+      mps.free (s2);
+      mps.free (s1);
+      assert(mps.pool (0).empty () && mps.pool (1).empty ());
+
+      mps.clear_usage ();
+      assert(mps.usage (1).allocations == 0);
+
+      // A set of external pools.
+      memory_pool mp1
+        { "mp1", 2, 8 };
+      memory_pool mp2
+        { "mp2", 2, 32 };
+      memory_pool* const pools[] =
+        { &mp1, &mp2 };
+      memory_pool_set eps
+        { "eps", pools, 2 };
+
+      void* e = eps.alloc (20);
+      assert(eps.owner (e) == &mp2);
+      assert(eps.free (e) == result::ok);
+    }
+
   // ==========================================================================
 
   printf ("\n%s - Done.\n", test_name);
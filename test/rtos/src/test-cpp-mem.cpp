@@ -28,6 +28,9 @@
 #include <cmsis-plus/rtos/os.h>
 #include <test-cpp-mem.h>
 #include <cmsis-plus/estd/memory_resource>
+#include <cmsis-plus/estd/pmr_containers>
+
+#include <cstdio>
 
 #pragma GCC diagnostic push
 #if defined(__clang__)
@@ -82,5 +85,27 @@ test_cpp_mem (void)
 
   a.deallocate (p5, 20);
 #endif
+
+    {
+      // Containers with the memory from a local arena.
+      static char arena[512];
+      os::estd::pmr::monotonic_buffer_resource mr
+        { arena, sizeof(arena) };
+
+      os::estd::pmr::vector<os::estd::pmr::string> v
+        { &mr };
+      v.emplace_back ("a string too long for the small string buffer");
+
+      os::estd::pmr::map<int, int> m
+        { &mr };
+      m[1] = 2;
+
+      if (v.back ().get_allocator ().resource () != &mr
+          || mr.allocated_bytes () == 0)
+        {
+          printf ("pmr containers not using the resource\n");
+        }
+    }
+
   return 0;
 }
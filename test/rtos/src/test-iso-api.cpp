@@ -27,12 +27,18 @@
 
 #include <cstdio>
 #include <cstdint>
+#include <cassert>
+#include <limits>
 
 #include <test-iso-api.h>
 #include <cmsis-plus/estd/chrono>
 #include <cmsis-plus/estd/condition_variable>
 #include <cmsis-plus/estd/mutex>
 #include <cmsis-plus/estd/thread>
+#include <cmsis-plus/estd/barrier>
+#include <cmsis-plus/estd/latch>
+#include <cmsis-plus/estd/future>
+#include <cmsis-plus/estd/stop_token>
 #include <type_traits>
 #include <atomic>
 
@@ -454,6 +460,111 @@ test_iso_api (bool extra)
 
   // ==========================================================================
 
+  printf ("\n%s - Stop tokens.\n", test_name);
+    {
+      estd::mutex mx;
+      estd::condition_variable_any cv;
+      bool flag = false;
+      int stopped = 0;
+
+      estd::jthread jt11
+        { [&](estd::stop_token st)
+          {
+            std::unique_lock<estd::mutex> lk (mx);
+            if (!cv.wait (lk, st, [&flag]()
+                    { return flag;}))
+              {
+                ++stopped;
+              }
+          } };
+
+      estd::stop_callback<std::function<void ()>> cb11
+        { jt11.get_stop_token (), [&stopped]()
+          { ++stopped;} };
+
+      estd::this_thread::sleep_for (5_ticks);
+      jt11.request_stop ();
+      jt11.join ();
+
+      if (stopped != 2)
+        {
+          printf ("wrong stop count\n");
+        }
+
+      estd::jthread jt12
+        { [](int n)
+          { (void)n;}, 7 };
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Barriers & latches.\n", test_name);
+    {
+      int phases = 0;
+      auto on_phase = [&phases]()
+        { ++phases;};
+      estd::barrier<decltype(on_phase)> br11
+        { 1, on_phase };
+      br11.arrive_and_wait ();
+      br11.wait (br11.arrive ());
+
+      estd::barrier<> br12
+        { 1 };
+      br12.arrive_and_drop ();
+
+      estd::latch lt11
+        { 2 };
+      lt11.count_down ();
+      lt11.try_wait ();
+      lt11.arrive_and_wait ();
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Async.\n", test_name);
+    {
+      auto fu11 = estd::async (estd::launch::async, [](int a, int b)
+        { return a + b;}, 1, 2);
+      auto fu12 = estd::async (estd::launch::deferred, []()
+        { return 7;});
+      auto fu13 = estd::async ([]()
+        { ;});
+
+      if (fu12.wait_for (1ms) != estd::future_status::deferred)
+        {
+          printf ("deferred task not deferred\n");
+        }
+
+      fu13.wait ();
+      if (fu11.get () + fu12.get () != 10)
+        {
+          printf ("wrong async result\n");
+        }
+
+      estd::promise<int> pr21;
+      auto fu21 = pr21.get_future ().then ([](estd::future<int> f)
+        { return f.get () * 2;});
+      auto fu22 = estd::when_all (std::move (fu21),
+          estd::async (estd::launch::async, []()
+            { return 1;}));
+      auto fu23 = estd::when_any (
+          estd::async (estd::launch::deferred, []()
+            { return 2;}));
+
+      pr21.set_value (3);
+      auto all = fu22.get ();
+      if (std::get<0> (all).get () + std::get<1> (all).get () != 7)
+        {
+          printf ("wrong when_all result\n");
+        }
+      if (fu23.get ().index != 0)
+        {
+          printf ("wrong when_any result\n");
+        }
+    }
+
+  // ==========================================================================
+
   printf ("\n%s - Chrono.\n", test_name);
 
 #pragma GCC diagnostic push
@@ -513,6 +624,24 @@ test_iso_api (bool extra)
       estd::this_thread::sleep_for<estd::chrono::realtime_clock> (5001ms);
     }
 
+    {
+      // The conversions to ticks, rounded up, with compile time ratios.
+      assert(ceil_count<systicks> (5ms) == 5);
+      assert(ceil_count<systicks> (2s) == 2000);
+      assert(ceil_count<systicks> (5001us) == 6);
+      assert(ceil_count<systicks> (3002000001ns) == 3003);
+      assert(ceil_count<systicks> (nanoseconds (1)) == 1);
+      assert(ceil_count<systicks> (nanoseconds (0)) == 0);
+      assert(ceil_count<systicks> (nanoseconds (-1)) == 0);
+      // Above 32-bits, the reciprocal is used.
+      assert(ceil_count<systicks> (nanoseconds (5000000000001ll)) == 5000001);
+      // Saturated.
+      using ticks32 = duration<uint32_t, systicks::period>;
+      assert(ceil_count<ticks32> (hours (2000000))
+          == std::numeric_limits<uint32_t>::max ());
+      assert(ceil_count<systicks> (duration<double, std::milli> (2.5)) == 3);
+    }
+
   estd::this_thread::sleep_until (estd::chrono::system_clock::now () + 1000us);
   estd::this_thread::sleep_until (estd::chrono::system_clock::now () + 1ms);
 
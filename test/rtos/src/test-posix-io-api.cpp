@@ -33,7 +33,22 @@
 #include <cmsis-plus/posix-io/char-device.h>
 #include <cmsis-plus/posix-io/block-device.h>
 #include <cmsis-plus/posix-io/block-device-partition.h>
+#include <cmsis-plus/posix-io/block-device-cache.h>
+#include <cmsis-plus/posix-io/block-device-queued.h>
+#include <cmsis-plus/posix-io/block-device-ram.h>
+#include <cmsis-plus/posix-io/device-registry.h>
+#include <cmsis-plus/posix-io/event-poll.h>
 #include <cmsis-plus/posix-io/file-descriptors-manager.h>
+#include <cmsis-plus/posix-io/file-system-log.h>
+#include <cmsis-plus/posix-io/file-system-rom.h>
+#include <cmsis-plus/posix-io/flusher.h>
+#include <cmsis-plus/posix-io/io-coroutine.h>
+#include <cmsis-plus/posix-io/net-interface.h>
+#include <cmsis-plus/posix-io/object-pool.h>
+#include <cmsis-plus/posix-io/pbuf.h>
+#include <cmsis-plus/posix-io/pipe.h>
+#include <cmsis-plus/posix-io/shared-memory.h>
+#include <cmsis-plus/posix/sys/ioctl.h>
 
 #include <stdio.h>
 #include <string.h>
@@ -228,11 +243,32 @@ my_block_impl::do_write_block (const void* buf,
                                posix::block_device::blknum_t blknum,
                                std::size_t nblocks)
 {
+  ++write_calls;
+  last_write_blknum = blknum;
+  last_write_nblocks = nblocks;
   my_memcpy (&arena_[blknum * block_logical_size_bytes_ / sizeof(elem_t)], buf,
              nblocks * block_logical_size_bytes_);
   return static_cast<ssize_t> (nblocks);
 }
 
+// The arena is in RAM, so it can be mapped.
+const void*
+my_block_impl::do_map (posix::block_device::blknum_t blknum,
+                       std::size_t nblocks)
+{
+  return &arena_[blknum * block_logical_size_bytes_ / sizeof(elem_t)];
+}
+
+// Like flash, erased blocks read as 0xFF.
+int
+my_block_impl::do_erase (posix::block_device::blknum_t blknum,
+                         std::size_t nblocks)
+{
+  memset (&arena_[blknum * block_logical_size_bytes_ / sizeof(elem_t)], 0xFF,
+          nblocks * block_logical_size_bytes_);
+  return 0;
+}
+
 int
 my_block_impl::do_vioctl (int request, std::va_list args)
 {
@@ -311,6 +347,140 @@ static rtos::mutex mx2
 static my_partition2 p2
   { "mb-p2", mb, mx2 };
 
+// Explicit template instantiation.
+template class posix::block_device_cache_implementable<>;
+using my_cache = posix::block_device_cache_implementable<>;
+
+// /dev/mb-c2
+// Fewer entries than the partition blocks, to force evictions.
+static my_cache c2
+  { "mb-c2", p2, 2u };
+
+// Explicit template instantiation.
+template class posix::block_device_queued<my_block_impl, os::rtos::mutex>;
+using my_queued = posix::block_device_queued<my_block_impl, os::rtos::mutex>;
+
+static os::rtos::mutex mx3
+  { "mx3" };
+
+// /dev/mq
+static my_queued mq
+  { "mq", mx3, 512u, 512u, 4u };
+
+static uint8_t rd_image[4 * 512];
+
+// /dev/rd, in a static region, lazily zeroed.
+static posix::block_device_ram rd
+  { "rd", rd_image, sizeof(rd_image), 512u, true };
+
+// /dev/rd2, allocated on the first open.
+static posix::block_device_ram rd2
+  { "rd2", 2u, 512u };
+
+// /dev/ff
+static posix::fifo_inclusive<16> ff
+  { "ff" };
+
+// /frames, from the default memory resource.
+static posix::shared_memory frames
+  { "frames" };
+
+// /dev/lfd, 8 segments of 4 blocks once formatted.
+static posix::block_device_ram lfd
+  { "lfd", 32u, 256u };
+
+static posix::file_system_log lfs
+  { "lfs", lfd };
+
+// The same device, mounted after a simulated power failure.
+static posix::file_system_log lfs2
+  { "lfs2", lfd };
+
+// /dev/romd, with index.html, css/site.css and an empty img/, built
+// with `scripts/romfs-build.py -a 64 -n rom_image folder rom.c`.
+static uint8_t rom_image[320] __attribute__((aligned(64))) =
+  {
+    0x52, 0x4F, 0x4D, 0x31, 0x01, 0x00, 0x00, 0x00, 0x40, 0x01, 0x00, 0x00,
+    0x81, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00,
+    0x0D, 0xAA, 0x8F, 0xDF, 0x00, 0x00, 0x00, 0x00, 0x84, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x6D, 0x41, 0x00, 0x00,
+    0x00, 0x7A, 0x49, 0x5A, 0x85, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x6D, 0x41, 0x00, 0x00, 0x00, 0x7A, 0x49, 0x5A,
+    0x89, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6D, 0x41, 0x00, 0x00, 0x00, 0x7A, 0x49, 0x5A, 0x8D, 0x00, 0x00, 0x00,
+    0xC0, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x24, 0x81, 0x00, 0x00,
+    0x00, 0x7A, 0x49, 0x5A, 0x98, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x15, 0x00, 0x00, 0x00, 0x24, 0x81, 0x00, 0x00, 0x00, 0x7A, 0x49, 0x5A,
+    0x00, 0x63, 0x73, 0x73, 0x00, 0x69, 0x6D, 0x67, 0x00, 0x69, 0x6E, 0x64,
+    0x65, 0x78, 0x2E, 0x68, 0x74, 0x6D, 0x6C, 0x00, 0x73, 0x69, 0x74, 0x65,
+    0x2E, 0x63, 0x73, 0x73, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3C, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x68, 0x65, 0x6C, 0x6C, 0x6F, 0x3C,
+    0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x62, 0x6F, 0x64, 0x79, 0x20, 0x7B, 0x20, 0x63,
+    0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x72, 0x65, 0x64, 0x3B, 0x20, 0x7D,
+    0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  };
+
+static posix::block_device_ram romd
+  { "romd", rom_image, sizeof(rom_image), 64u };
+
+static posix::file_system_rom roms
+  { "roms", romd };
+
+// /dev/flusher, syncs the test file systems in the background.
+static posix::flusher flush
+  { "flusher" };
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO) && defined(__cpp_impl_coroutine) \
+  && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+static ssize_t co_read_result;
+
+static rtos::coroutine::task
+co_reader (posix::io& io, void* buf, std::size_t nbyte, off_t offset)
+{
+  co_read_result = co_await posix::coroutine::read (io, buf, nbyte, offset);
+}
+
+#endif
+
+// ----------
+
+// Loopback network driver, the transmitted packets are received back.
+class my_loopback_impl : public posix::net_interface_impl
+{
+public:
+
+  virtual void
+  do_start_output (posix::net_interface& interface) override;
+};
+
+void
+my_loopback_impl::do_start_output (posix::net_interface& interface)
+{
+  posix::pbuf* p;
+  while ((p = interface.next_output ()) != nullptr)
+    {
+      interface.input (p);
+    }
+}
+
+static my_loopback_impl lo_impl;
+
+static posix::net_interface lo
+  { lo_impl, "lo" };
+
+static posix::pbuf_pool_inclusive<16, 64> pbufs
+  { "pbufs" };
+
 // ----------
 
 // Used to allocate the C file descriptors.
@@ -361,6 +531,55 @@ test_posix_io_api (bool extra __attribute__((unused)))
       p2.configure (bks - nr, nr);
     }
 
+  printf ("\n%s - Block device geometry - C++ API.\n", test_name);
+    {
+      posix::block_device::blknum_t p1_blocks = p1.blocks ();
+      posix::block_device::blknum_t p2_offset = mb.blocks () - p2.blocks ();
+
+      // Transfer units of two blocks, p1 starting in the middle of one.
+      mb.impl ().optimal_size (2 * bsz);
+      p1.configure (1, p1_blocks - 1);
+
+      res = p1.open ();
+      assert(res >= 0);
+
+      std::size_t sz = 0;
+      assert(p1.ioctl (BLKIOMIN, &sz) == 0 && sz == bsz);
+      assert(p1.ioctl (BLKIOOPT, &sz) == 0 && sz == 2 * bsz);
+      assert(p1.ioctl (BLKALIGNOFF, &sz) == 0 && sz == bsz);
+      assert(p1.optimal_blocks () == 2);
+      assert(p1.ioctl (BLKIOOPT, nullptr) == -1 && errno == EINVAL);
+
+      res = p1.close ();
+      assert(res >= 0);
+
+      // p2 starts on a unit boundary.
+      p2.configure (p2_offset, p2.blocks ());
+      res = c2.open ();
+      assert(res >= 0);
+      assert(c2.alignment_offset_bytes () == 0);
+      assert(c2.optimal_blocks () == 2);
+
+      // A flush of block 1 alone takes the clean block 0 along,
+      // to write a whole unit.
+      res = c2.read_block (buff, 0);
+      assert(res >= 0);
+      res = c2.read_block (buff, 1);
+      assert(res >= 0);
+      res = c2.write_block (buff, 1);
+      assert(res >= 0);
+      c2.sync ();
+      assert(mb.impl ().last_write_blknum == p2_offset);
+      assert(mb.impl ().last_write_nblocks == 2);
+
+      res = c2.close ();
+      assert(res >= 0);
+
+      mb.impl ().optimal_size (0);
+      p1.configure (0, p1_blocks);
+      p2.configure (p2_offset, p2.blocks ());
+    }
+
   printf ("\n%s - Block device locked - C++ API.\n", test_name);
     {
       res = p2.open ();
@@ -391,18 +610,387 @@ test_posix_io_api (bool extra __attribute__((unused)))
       res = p2.write_block (buff, p2.blocks ());
       assert(res == -1);
 
+      // Scatter the first two blocks into separate buffers.
+      static uint8_t buff2[512];
+      struct iovec iov[2] =
+        {
+          { buff, bsz },
+          { buff2, bsz } };
+
+      res = p2.lseek (0, SEEK_SET);
+      assert(res == 0);
+      res = p2.readv (iov, 2);
+      assert(res == static_cast<ssize_t> (2 * bsz));
+      assert(buff[0] == 0);
+      assert(buff2[0] == 1);
+
+      // Segments must be multiples of the block size.
+      iov[1].iov_len = bsz - 1;
+      res = p2.readv (iov, 2);
+      assert(res == -1);
+
+#if defined(OS_INCLUDE_POSIX_IO_AIO)
+
+      // Read the second block on the I/O worker.
+      static rtos::semaphore_binary aio_sem
+        { "aio", 0 };
+      posix::aiocb cb;
+      cb.aio_offset = static_cast<off_t> (bsz);
+      cb.aio_buf = buff2;
+      cb.aio_nbytes = bsz;
+      cb.aio_notify = [](posix::aiocb* p)
+        {
+          static_cast<rtos::semaphore_binary*> (p->aio_notify_args)->post ();
+        };
+      cb.aio_notify_args = &aio_sem;
+
+      buff2[0] = 0xFF;
+      res = p2.aio_read (&cb);
+      assert(res == 0);
+      aio_sem.wait ();
+      assert(posix::aio_error (&cb) == 0);
+      assert(posix::aio_return (&cb) == static_cast<ssize_t> (bsz));
+      assert(buff2[0] == 1);
+
+#if defined(__cpp_impl_coroutine) && !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+        {
+          // The same read, from a coroutine.
+          rtos::coroutine::executor ex
+            { "aio-ex" };
+
+          buff2[0] = 0xFF;
+          co_read_result = 0;
+          ex.spawn (co_reader (p2, buff2, bsz, static_cast<off_t> (bsz)));
+          while (ex.tasks () != 0)
+            {
+              rtos::sysclock.sleep_for (1);
+            }
+          assert(co_read_result == static_cast<ssize_t> (bsz));
+          assert(buff2[0] == 1);
+        }
+
+#endif
+
+#endif
+
       p2.close ();
     }
 
+  printf ("\n%s - Block device owner - C++ API.\n", test_name);
+    {
+      res = mb.open ();
+      assert(res >= 0);
+
+      mb.owner (&os::rtos::this_thread::thread ());
+      assert(mb.owner () == &os::rtos::this_thread::thread ());
+
+      // The owner does not take the locker, even when it is busy.
+      assert(mx1.lock () == os::rtos::result::ok);
+      res = mb.read_block (buff, 0);
+      assert(res >= 0);
+      assert(mx1.unlock () == os::rtos::result::ok);
+
+      mb.owner (nullptr);
+
+      res = mb.close ();
+      assert(res >= 0);
+    }
+
   printf ("\n%s - Block device unlocked - C++ API.\n", test_name);
     {
+      assert(p1.poll_register (POLLIN, nullptr) == POLLNVAL);
+
       res = p1.open ();
       assert(res >= 0);
 
+      // Block devices are always ready.
+      assert(p1.poll_register (POLLIN | POLLOUT, nullptr) == (POLLIN | POLLOUT));
+
       res = p1.close ();
       assert(res >= 0);
     }
 
+  printf ("\n%s - Device registry - C++ API.\n", test_name);
+    {
+      using registry = posix::device_registry<posix::device>;
+
+      assert(registry::identify_device ("/dev/mc") == &mc);
+      assert(registry::identify_device ("/dev/mc2") == &mc2);
+      assert(registry::identify_device ("/dev/mb-p1") == &p1);
+      assert(registry::identify_device ("/dev/mb") == &mb);
+      assert(registry::identify_device ("/dev/none") == nullptr);
+      assert(registry::identify_device ("/mc") == nullptr);
+
+      // Resolve once, open many times.
+      posix::path_handle handle;
+      assert(posix::resolve ("/dev/mb-p1", &handle) == 0);
+      assert(handle.device == &p1);
+      for (int i = 0; i < 3; ++i)
+        {
+          assert(posix::open_at (handle, 0) == &p1);
+          res = p1.close ();
+          assert(res >= 0);
+        }
+
+      posix::path_handle stale
+        { nullptr, nullptr, nullptr, "/f" };
+      assert(posix::open_at (stale, 0) == nullptr && errno == ESTALE);
+    }
+
+  printf ("\n%s - Object pool - C++ API.\n", test_name);
+    {
+      struct pooled
+      {
+        pooled (int v) :
+            value (v)
+        {
+          ;
+        }
+
+        int value;
+        void* link;
+      };
+
+      using pool_type = posix::object_pool<pooled, 2>;
+      pool_type* pool = pool_type::get ();
+      assert(pool == pool_type::get ());
+
+      pooled* o1 = pool_type::create (1);
+      pooled* o2 = pool_type::create (2);
+      // The pool is exhausted, the third one is on the free store.
+      pooled* o3 = pool_type::create (3);
+      assert(o1->value == 1 && o2->value == 2 && o3->value == 3);
+      assert(pool->owns (o1) && pool->owns (o2) && !pool->owns (o3));
+      assert(pool->allocated_chunks () == 2);
+      assert(pool->free_chunks () == 0);
+
+      pool_type::destroy (o3);
+      pool_type::destroy (o1);
+      assert(pool->allocated_chunks () == 1);
+
+      // The freed block is reused.
+      pooled* o4 = pool_type::create (4);
+      assert(o4 == o1);
+
+      pool_type::destroy (o4);
+      pool_type::destroy (o2);
+      assert(pool->allocated_chunks () == 0);
+      assert(pool->allocations () == 4 && pool->deallocations () == 3);
+    }
+
+  printf ("\n%s - Event poll - C++ API.\n", test_name);
+    {
+      posix::event_poll ep
+        { 2 };
+
+      int epfd = ep.open ();
+      assert(epfd >= 0);
+
+      int fd = p1.open ();
+      assert(fd >= 0);
+
+      struct epoll_event ev;
+      ev.events = EPOLLIN;
+      ev.data.u32 = 7;
+      assert(ep.ctl (EPOLL_CTL_ADD, fd, &ev) == 0);
+      assert(ep.ctl (EPOLL_CTL_ADD, fd, &ev) == -1 && errno == EEXIST);
+
+      // Level triggered, reported by each wait.
+      struct epoll_event out[2];
+      assert(ep.wait (out, 2, 0) == 1);
+      assert(out[0].events == EPOLLIN && out[0].data.u32 == 7);
+      assert(ep.wait (out, 2, 0) == 1);
+
+      ev.events = EPOLLIN | EPOLLET;
+      assert(ep.ctl (EPOLL_CTL_MOD, fd, &ev) == 0);
+      assert(ep.wait (out, 2, 0) == 1);
+      // Edge triggered, reported only once.
+      assert(ep.wait (out, 2, 0) == 0);
+
+      assert(ep.ctl (EPOLL_CTL_DEL, fd, nullptr) == 0);
+      assert(ep.ctl (EPOLL_CTL_DEL, fd, nullptr) == -1 && errno == ENOENT);
+
+      res = p1.close ();
+      assert(res >= 0);
+
+      res = ep.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Non-blocking I/O - C++ API.\n", test_name);
+    {
+      int fd = p1.open (nullptr, O_RDWR | O_NONBLOCK);
+      assert(fd >= 0);
+
+      assert((p1.fcntl (F_GETFL) & O_NONBLOCK) != 0);
+      assert(p1.impl ().is_nonblocking ());
+
+      // Even a posted semaphore is not waited for.
+      os::rtos::semaphore_binary sem
+        { "nb", 1 };
+      assert(p1.impl ().wait_for_io (sem, false) == -1 && errno == EAGAIN);
+
+      assert(p1.fcntl (F_SETFL, 0) == 0);
+      assert((p1.fcntl (F_GETFL) & O_NONBLOCK) == 0);
+      assert((p1.fcntl (F_GETFL) & O_ACCMODE) == O_RDWR);
+      assert(p1.impl ().wait_for_io (sem, false) == 0);
+
+      // An expired timeout is reported as EAGAIN.
+      p1.impl ().receive_timeout (2);
+      assert(p1.impl ().wait_for_io (sem, false) == -1 && errno == EAGAIN);
+      p1.impl ().receive_timeout (0);
+
+      res = p1.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - File descriptors - C++ API.\n", test_name);
+    {
+      std::size_t used = posix::file_descriptors_manager::used ();
+
+      // Also opens the parent device.
+      int fd1 = p1.open ();
+      assert(fd1 >= 0);
+
+      std::size_t used1 = posix::file_descriptors_manager::used ();
+      std::size_t blocks1 = posix::file_descriptors_manager::used (
+          posix::io::type::block_device);
+
+      int fd2 = p2.open ();
+      assert(fd2 > fd1);
+      assert(posix::file_descriptors_manager::used () == used1 + 1);
+      assert(
+          posix::file_descriptors_manager::used (posix::io::type::block_device)
+              == blocks1 + 1);
+
+      // The lowest free descriptor is reused.
+      res = p1.close ();
+      assert(res >= 0);
+      assert(p1.open () == fd1);
+
+      p2.close ();
+      p1.close ();
+      assert(posix::file_descriptors_manager::used () == used);
+    }
+
+  printf ("\n%s - Block device map - C++ API.\n", test_name);
+    {
+      assert(p2.map (0) == nullptr && errno == EBADF);
+
+      res = p2.open ();
+      assert(res >= 0);
+
+      // Through the partition offset, to the parent arena.
+      auto* const q = static_cast<const uint8_t*> (p2.map (1));
+      assert(q != nullptr);
+      assert(q[0] == 1);
+      assert(q[bsz - 1] == 1);
+
+      assert(p2.map (p2.blocks ()) == nullptr && errno == EINVAL);
+
+      p2.close ();
+    }
+
+  printf ("\n%s - Block device queue - C++ API.\n", test_name);
+    {
+      res = mq.open ();
+      assert(res >= 0);
+
+      static uint8_t qbuf[512];
+      memset (qbuf, 0x5A, sizeof(qbuf));
+      res = mq.write_block (qbuf, 2);
+      assert(res == 1);
+
+      memset (qbuf, 0, sizeof(qbuf));
+      res = mq.read_block (qbuf, 2);
+      assert(res == 1);
+      assert(qbuf[0] == 0x5A);
+      assert(qbuf[bsz - 1] == 0x5A);
+
+      // The validation errors are passed back to the caller.
+      res = mq.read_block (qbuf, mq.blocks ());
+      assert(res == -1 && errno == EINVAL);
+
+      // A single thread never has requests reordered.
+      assert(mq.reordered () == 0);
+
+      mq.close ();
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+  printf ("\n%s - I/O statistics - C++ API.\n", test_name);
+    {
+      res = mq.open ();
+      assert(res >= 0);
+
+      mq.statistics ().clear ();
+
+      static uint8_t sbuf[512];
+      res = mq.write_block (sbuf, 1, 2);
+      assert(res == 2);
+      res = mq.lseek (0, SEEK_SET);
+      assert(res == 0);
+      res = mq.read (sbuf, bsz);
+      assert(res == static_cast<ssize_t> (bsz));
+
+      posix::io_statistics st;
+      mq.statistics ().snapshot (st);
+      assert(st.writes == 1);
+      assert(st.written_bytes == 2 * bsz);
+      assert(st.reads == 1);
+      assert(st.read_bytes == bsz);
+      assert(st.errors == 0);
+      assert(st.read_max_cycles <= st.read_cycles);
+
+      mq.statistics ().dump ("mq");
+
+      mq.close ();
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+  printf ("\n%s - Block device sendfile - C++ API.\n", test_name);
+    {
+      res = p1.open ();
+      assert(res >= 0);
+      res = p2.open ();
+      assert(res >= 0);
+
+      static uint8_t saved[512];
+      res = p1.read_block (saved, 0);
+      assert(res >= 0);
+
+      assert(p1.sendfile (nullptr, nullptr, bsz) == -1 && errno == EBADF);
+
+      // Copy block 1 of p2 to block 0 of p1.
+      off_t off = static_cast<off_t> (bsz);
+      res = p1.lseek (0, SEEK_SET);
+      assert(res == 0);
+      res = p2.lseek (0, SEEK_SET);
+      assert(res == 0);
+      res = p1.sendfile (&p2, &off, bsz);
+      assert(res == static_cast<ssize_t> (bsz));
+      assert(off == static_cast<off_t> (2 * bsz));
+
+      // The input offset is preserved, the output one advanced.
+      assert(p2.lseek (0, SEEK_CUR) == 0);
+      assert(p1.lseek (0, SEEK_CUR) == static_cast<off_t> (bsz));
+
+      memset (buff, 0xFF, bsz);
+      res = p1.read_block (buff, 0);
+      assert(res >= 0);
+      assert(buff[0] == 1);
+      assert(buff[bsz - 1] == 1);
+
+      res = p1.write_block (saved, 0);
+      assert(res >= 0);
+
+      p2.close ();
+      p1.close ();
+    }
+
   printf ("\n%s - Block device - intermixed opens - C++ API.\n", test_name);
     {
       int res1 = p1.open ();
@@ -421,6 +1009,810 @@ test_posix_io_api (bool extra __attribute__((unused)))
       assert(res2 >= 0);
     }
 
+  printf ("\n%s - Block device cache - C++ API.\n", test_name);
+    {
+      res = c2.open ();
+      assert(res >= 0);
+      assert(c2.blocks () == p2.blocks ());
+
+      std::size_t writes = mb.impl ().write_calls;
+      std::size_t last = c2.blocks () - 1;
+      for (std::size_t i = 0; i < c2.blocks (); ++i)
+        {
+          memset (buff, 0, bsz);
+          buff[0] = static_cast<uint8_t> (i);
+          buff[bsz - 1] = static_cast<uint8_t> (0x80 | i);
+          res = c2.write_block (buff, i);
+          assert(res >= 0);
+        }
+
+      // Evicting the first block wrote both cached blocks in one call.
+      assert(mb.impl ().write_calls == writes + 1);
+
+      // The last block was not yet written back.
+      res = p2.open ();
+      assert(res >= 0);
+      res = p2.read_block (buff, last);
+      assert(res >= 0);
+      assert(buff[bsz - 1] == last);
+
+      c2.sync ();
+
+      res = p2.read_block (buff, last);
+      assert(res >= 0);
+      assert(buff[bsz - 1] == (0x80 | last));
+
+      // The first block was evicted and is read again from the parent.
+      std::size_t misses = c2.misses ();
+      res = c2.read_block (buff, 0);
+      assert(res >= 0);
+      assert(buff[bsz - 1] == 0x80);
+      assert(c2.misses () == misses + 1);
+
+      std::size_t hits = c2.hits ();
+      res = c2.read_block (buff, 0);
+      assert(res >= 0);
+      assert(c2.hits () == hits + 1);
+
+      res = c2.close ();
+      assert(res >= 0);
+      res = p2.close ();
+      assert(res >= 0);
+
+      // Reopen with an empty cache and a read-ahead of one block.
+      res = c2.open ();
+      assert(res >= 0);
+      res = c2.ioctl (BLKRASET, static_cast<std::size_t> (1));
+      assert(res == 0);
+
+      misses = c2.misses ();
+      res = c2.read_block (buff, 0);
+      assert(res >= 0);
+      assert(c2.misses () == misses + 1);
+
+      // Block 1 was fetched together with block 0.
+      res = c2.read_block (buff, 1);
+      assert(res >= 0);
+      assert(buff[bsz - 1] == 0x81);
+      assert(c2.misses () == misses + 1);
+
+      // Discarded dirty blocks are not written back.
+      std::size_t writes2 = mb.impl ().write_calls;
+      res = c2.write_block (buff, 0);
+      assert(res >= 0);
+      res = c2.discard (0);
+      assert(res == 0);
+      c2.sync ();
+      assert(mb.impl ().write_calls == writes2);
+
+      // Erase through the cache and the partition, in bytes.
+      uint64_t range[2] =
+        { 0, bsz };
+      res = c2.ioctl (BLKSECDISCARD, range);
+      assert(res == 0);
+      res = c2.read_block (buff, 0);
+      assert(res >= 0);
+      assert(buff[0] == 0xFF && buff[bsz - 1] == 0xFF);
+
+      range[1] = bsz - 1;
+      res = c2.ioctl (BLKDISCARD, range);
+      assert(res == -1 && errno == EINVAL);
+
+      // The erase units are one block, any range is aligned.
+      assert(p2.erase_blocks () == 1);
+      assert(p2.is_erase_aligned (1, 1));
+      assert(p2.erase_align_up (1) == 1);
+
+      res = c2.close ();
+      assert(res >= 0);
+    }
+
+  // ==========================================================================
+
+  printf ("\n%s - Block device RAM - C++ API.\n", test_name);
+    {
+      memset (rd_image, 0xAA, sizeof(rd_image));
+
+      res = rd.open ();
+      assert(res >= 0);
+      assert(rd.blocks () == 4);
+      assert(rd.block_logical_size_bytes () == 512);
+
+      // Lazily zeroed, the region is not touched by reads.
+      memset (buff, 0xFF, 512);
+      res = rd.read_block (buff, 2);
+      assert(res == 1);
+      assert(buff[0] == 0 && buff[511] == 0);
+      assert(rd_image[2 * 512] == 0xAA);
+
+      // A write clears the blocks below it.
+      memset (buff, 0x11, 512);
+      res = rd.write_block (buff, 1);
+      assert(res == 1);
+      assert(rd_image[0] == 0 && rd_image[511] == 0);
+      assert(rd_image[512] == 0x11);
+      assert(rd_image[2 * 512] == 0xAA);
+
+      // Mapped in place.
+      const uint8_t* m = static_cast<const uint8_t*> (rd.map (1, 3));
+      assert(m == &rd_image[512]);
+      assert(m[0] == 0x11 && m[2 * 512] == 0 && m[3 * 512 - 1] == 0);
+
+      // Discarding up to the top reads back zeros.
+      res = rd.discard (1, 3);
+      assert(res == 0);
+      res = rd.read_block (buff, 1);
+      assert(res == 1);
+      assert(buff[0] == 0);
+
+      res = rd.close ();
+      assert(res >= 0);
+
+      // The allocated region keeps its content between opens.
+      res = rd2.open ();
+      assert(res >= 0);
+      assert(rd2.impl ().region () != nullptr);
+      memset (buff, 0x22, 512);
+      res = rd2.write_block (buff, 1);
+      assert(res == 1);
+      res = rd2.close ();
+      assert(res >= 0);
+
+      res = rd2.open ();
+      assert(res >= 0);
+      memset (buff, 0, 512);
+      res = rd2.read_block (buff, 1);
+      assert(res == 1);
+      assert(buff[0] == 0x22);
+      res = rd2.read_block (buff, 0);
+      assert(res == 1);
+      assert(buff[0] == 0);
+      res = rd2.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Pipes - C++ API.\n", test_name);
+    {
+      std::size_t used = posix::file_descriptors_manager::used ();
+
+      int fds[2];
+      assert(posix::pipe::create (nullptr) == nullptr && errno == EFAULT);
+      posix::pipe* pp = posix::pipe::create (fds, 16);
+      assert(pp != nullptr);
+      assert(fds[1] > fds[0]);
+      posix::io* prd = posix::file_descriptors_manager::io (fds[0]);
+      posix::io* pwr = posix::file_descriptors_manager::io (fds[1]);
+      assert(prd == &pp->read_end () && pwr == &pp->write_end ());
+      assert(
+          posix::file_descriptors_manager::used (posix::io::type::pipe) == 2);
+
+      // Each end works only in its own direction.
+      char pbuf[32];
+      assert(prd->write ("x", 1) == -1 && errno == EBADF);
+      assert(pwr->read (pbuf, 1) == -1 && errno == EBADF);
+      assert(prd->lseek (0, SEEK_SET) == -1 && errno == ESPIPE);
+
+      assert(prd->impl ().poll_ready (POLLIN) == 0);
+      assert(pwr->impl ().poll_ready (POLLOUT) == POLLOUT);
+
+      assert(pwr->write ("hello", 5) == 5);
+      assert(prd->impl ().poll_ready (POLLIN) == POLLIN);
+
+      struct stat st;
+      assert(prd->fstat (&st) == 0);
+      assert((st.st_mode & S_IFMT) == S_IFIFO && st.st_size == 5);
+
+      // A read returns what is available, without waiting for more.
+      assert(prd->read (pbuf, sizeof(pbuf)) == 5);
+      assert(memcmp (pbuf, "hello", 5) == 0);
+
+      // A full pipe stops a non-blocking writer.
+      assert(pwr->fcntl (F_SETFL, O_NONBLOCK) == 0);
+      memset (pbuf, 'a', sizeof(pbuf));
+      assert(pwr->write (pbuf, sizeof(pbuf)) == 16);
+      assert(pwr->write (pbuf, 1) == -1 && errno == EAGAIN);
+      assert(pwr->impl ().poll_ready (POLLOUT) == 0);
+      assert(prd->read (pbuf, sizeof(pbuf)) == 16);
+
+      // Without writers, the drained pipe reports the end of file.
+      assert(pwr->write ("bye", 3) == 3);
+      res = pwr->close ();
+      assert(res == 0);
+      assert(prd->impl ().poll_ready (POLLIN) == POLLIN);
+      assert(prd->read (pbuf, sizeof(pbuf)) == 3);
+      assert(prd->impl ().poll_ready (POLLIN) == POLLHUP);
+      assert(prd->read (pbuf, sizeof(pbuf)) == 0);
+      res = prd->close ();
+      assert(res == 0);
+      assert(posix::file_descriptors_manager::used () == used);
+
+      // Without readers, the write fails.
+      pp = posix::pipe::create (fds, 16);
+      assert(pp != nullptr);
+      pp->read_end ().close ();
+      assert(pp->write_end ().impl ().poll_ready (POLLOUT) == POLLERR);
+      assert(pp->write_end ().write ("x", 1) == -1 && errno == EPIPE);
+      pp->write_end ().close ();
+
+      // A named FIFO, shared by writers and readers.
+      posix::io* fio = posix::open ("/dev/ff", O_RDWR);
+      assert(fio == &ff);
+      assert(posix::pipe_buffer::of (*fio) == &ff.impl ().buffer ());
+      assert(fio->write ("abc", 3) == 3);
+      assert(fio->read (pbuf, sizeof(pbuf)) == 3);
+      assert(memcmp (pbuf, "abc", 3) == 0);
+      assert(fio->lseek (0, SEEK_SET) == -1 && errno == ESPIPE);
+      res = fio->close ();
+      assert(res == 0);
+
+      // Zero copy between a pipe and a block device.
+      res = rd.open ();
+      assert(res >= 0);
+      memset (buff, 0x33, 512);
+      res = rd.write_block (buff, 3);
+      assert(res == 1);
+
+      pp = posix::pipe::create (fds, 2 * 512);
+      assert(pp != nullptr);
+      posix::pipe_end& wr = pp->write_end ();
+      posix::pipe_end& rde = pp->read_end ();
+
+      // Neither is a pipe, or an offset for the pipe.
+      assert(posix::splice (&rd, nullptr, &rd, nullptr, 512) == -1
+          && errno == EINVAL);
+      off_t off = 0;
+      assert(posix::splice (&rd, nullptr, &wr, &off, 512) == -1
+          && errno == ESPIPE);
+
+      // Block 3 to the pipe, without changing the device offset.
+      off = 3 * 512;
+      assert(rd.lseek (0, SEEK_SET) == 0);
+      res = posix::splice (&rd, &off, &wr, nullptr, 512);
+      assert(res == 512);
+      assert(off == 4 * 512);
+      assert(rd.lseek (0, SEEK_CUR) == 0);
+      assert(pp->buffer ().length () == 512);
+
+      // From the pipe to block 0.
+      off = 0;
+      res = posix::splice (&rde, nullptr, &rd, &off, 512);
+      assert(res == 512);
+      assert(pp->buffer ().length () == 0);
+      memset (buff, 0, 512);
+      res = rd.read_block (buff, 0);
+      assert(res == 1);
+      assert(buff[0] == 0x33 && buff[511] == 0x33);
+
+      // sendfile() to the write end reads into the pipe buffer.
+      off = 3 * 512;
+      res = wr.sendfile (&rd, &off, 512);
+      assert(res == 512);
+      assert(rde.read (buff, 512) == 512);
+      assert(buff[0] == 0x33 && buff[511] == 0x33);
+
+      wr.close ();
+      rde.close ();
+      rd.close ();
+      assert(posix::file_descriptors_manager::used () == used);
+    }
+
+  printf ("\n%s - Shared memory - C++ API.\n", test_name);
+    {
+      std::size_t used = posix::file_descriptors_manager::used ();
+
+      assert(posix::shared_memory::open ("frames", O_RDWR) == nullptr
+          && errno == EINVAL);
+      assert(posix::shared_memory::open ("/none", O_RDWR) == nullptr
+          && errno == ENOENT);
+      assert(posix::shared_memory::open ("/frames", O_RDWR | O_CREAT | O_EXCL)
+          == nullptr && errno == EEXIST);
+
+      // The statically declared object, shared by all users.
+      posix::shared_memory* shm = posix::shared_memory::open ("/frames",
+                                                              O_RDWR);
+      assert(shm == &frames);
+      int fd = shm->file_descriptor ();
+      assert(fd >= 0);
+      assert(posix::shared_memory::open ("/frames", O_RDONLY) == shm);
+      assert(shm->file_descriptor () == fd);
+      assert(
+          posix::file_descriptors_manager::used (
+              posix::io::type::shared_memory) == 1);
+
+      assert(shm->map (16, PROT_READ) == nullptr && errno == ENXIO);
+      assert(shm->ftruncate (64) == 0);
+      assert(shm->size () == 64);
+
+      auto* wp = static_cast<uint8_t*> (shm->map (64, PROT_READ | PROT_WRITE));
+      assert(wp != nullptr);
+      assert(wp[0] == 0 && wp[63] == 0);
+      auto* rp = static_cast<uint8_t*> (shm->map (32, PROT_READ, 32));
+      assert(rp == wp + 32);
+      assert(shm->mappings () == 2);
+
+      // Zero copy, the same memory.
+      wp[32] = 0x5A;
+      assert(rp[0] == 0x5A);
+
+      // Mapped regions are not moved.
+      assert(shm->ftruncate (128) == -1 && errno == EBUSY);
+      assert(posix::shared_memory::identify_mapping (rp) == shm);
+
+      struct stat st;
+      assert(shm->fstat (&st) == 0 && st.st_size == 64);
+
+      // The descriptor is closed by the last user.
+      res = shm->close ();
+      assert(res == 0);
+      assert(shm->is_opened ());
+      res = shm->close ();
+      assert(res == 0);
+      assert(!shm->is_opened ());
+
+      // The region stays, while the object is registered.
+      assert(shm->unmap (rp, 32) == 0);
+      assert(shm->unmap (wp, 64) == 0);
+      assert(shm->unmap (wp, 64) == -1 && errno == EINVAL);
+      shm = posix::shared_memory::open ("/frames", O_RDONLY);
+      assert(shm == &frames && shm->size () == 64);
+      rp = static_cast<uint8_t*> (shm->map (64, PROT_READ));
+      assert(rp != nullptr && rp[32] == 0x5A);
+      assert(shm->map (64, PROT_WRITE) == nullptr && errno == EACCES);
+      assert(shm->unmap (rp, 64) == 0);
+      shm->close ();
+
+      // A created object, released after unlink(), close() and unmap().
+      shm = posix::shared_memory::open ("/tmp", O_RDWR | O_CREAT);
+      assert(shm != nullptr && shm != &frames);
+      assert(shm->ftruncate (16) == 0);
+      assert(shm->write ("shared", 6) == 6);
+      assert(shm->lseek (0, SEEK_SET) == 0);
+      char sbuf[8];
+      assert(shm->read (sbuf, sizeof(sbuf)) == 8);
+      assert(memcmp (sbuf, "shared", 6) == 0);
+      void* tp = shm->map (16, PROT_READ);
+      assert(tp != nullptr);
+      assert(posix::shared_memory::unlink ("/tmp") == 0);
+      assert(posix::shared_memory::identify ("/tmp") == nullptr);
+      assert(posix::shared_memory::unlink ("/tmp") == -1 && errno == ENOENT);
+      shm->close ();
+      assert(posix::shared_memory::identify_mapping (tp) == shm);
+      assert(shm->unmap (tp, 16) == 0);
+      assert(posix::shared_memory::identify_mapping (tp) == nullptr);
+
+      // O_TRUNC empties the static object.
+      shm = posix::shared_memory::open ("/frames", O_RDWR | O_TRUNC);
+      assert(shm == &frames && shm->size () == 0);
+      shm->close ();
+
+      assert(posix::file_descriptors_manager::used () == used);
+    }
+
+  printf ("\n%s - Log file system - C++ API.\n", test_name);
+    {
+      std::size_t used = posix::file_descriptors_manager::used ();
+
+      res = lfd.open ();
+      assert(res >= 0);
+
+      // Not formatted.
+      assert(lfs.mount ("/lfs/") == -1 && errno == EINVAL);
+
+      res = lfs.mkfs (4);
+      assert(res == 0);
+      res = lfs.mount ("/lfs/");
+      assert(res == 0);
+      assert(lfs.impl ().segments () == 8);
+
+      // Small appends, kept in the file tail.
+      posix::io* f = posix::open ("/lfs/log.txt",
+                                  O_WRONLY | O_CREAT | O_APPEND);
+      assert(f != nullptr);
+      for (int i = 0; i < 20; ++i)
+        {
+          char line[16];
+          snprintf (line, sizeof(line), "line %02d\n", i);
+          assert(f->write (line, 8) == 8);
+        }
+      res = f->close ();
+      assert(res == 0);
+
+      struct stat st;
+      res = posix::stat ("/lfs/log.txt", &st);
+      assert(res == 0 && st.st_size == 160);
+
+      f = posix::open ("/lfs/log.txt", O_RDONLY);
+      assert(f != nullptr);
+      char rbuf[160];
+      assert(f->read (rbuf, sizeof(rbuf)) == 160);
+      assert(memcmp (rbuf, "line 00\n", 8) == 0);
+      assert(memcmp (rbuf + 152, "line 19\n", 8) == 0);
+      assert(f->read (rbuf, sizeof(rbuf)) == 0);
+      assert(f->write ("x", 1) == -1 && errno == EBADF);
+      f->close ();
+
+      // Folders and renames.
+      res = posix::mkdir ("/lfs/d", 0777);
+      assert(res == 0);
+      assert(posix::mkdir ("/lfs/d", 0777) == -1 && errno == EEXIST);
+      f = posix::open ("/lfs/d/a", O_RDWR | O_CREAT);
+      assert(f != nullptr);
+      assert(f->write ("abc", 3) == 3);
+      f->close ();
+      assert(posix::rmdir ("/lfs/d") == -1 && errno == ENOTEMPTY);
+      res = posix::rename ("/lfs/d/a", "/lfs/b");
+      assert(res == 0);
+      assert(posix::stat ("/lfs/d/a", &st) == -1 && errno == ENOENT);
+      assert(posix::stat ("/lfs/b", &st) == 0 && st.st_size == 3);
+
+      posix::directory* dir = posix::opendir ("/lfs/");
+      assert(dir != nullptr);
+      int entries = 0;
+      while (dir->read () != nullptr)
+        {
+          ++entries;
+        }
+      assert(entries == 3);
+
+      // The default, one entry at a time.
+      struct dirent ents[2];
+      dir->rewind ();
+      assert(dir->read_n (ents, 2) == 2);
+      assert(dir->read_n (ents, 2) == 1);
+      assert(dir->read_n (ents, 2) == 0);
+      dir->close ();
+
+      res = posix::unlink ("/lfs/b");
+      assert(res == 0);
+      assert(posix::stat ("/lfs/b", &st) == -1 && errno == ENOENT);
+      res = posix::rmdir ("/lfs/d");
+      assert(res == 0);
+
+      // Not committed data is not seen after a power failure.
+      f = posix::open ("/lfs/log.txt", O_WRONLY | O_APPEND);
+      assert(f != nullptr);
+      memset (buff, 0x55, 512);
+      assert(f->write (buff, 512) == 512);
+      res = lfs2.mount ("/lfs2/");
+      assert(res == 0);
+      assert(posix::stat ("/lfs2/log.txt", &st) == 0 && st.st_size == 160);
+      assert(posix::stat ("/lfs2/b", &st) == -1 && errno == ENOENT);
+      res = lfs2.umount ();
+      assert(res == 0);
+      res = f->close ();
+      assert(res == 0);
+      res = lfs2.mount ("/lfs2/");
+      assert(res == 0);
+      assert(posix::stat ("/lfs2/log.txt", &st) == 0 && st.st_size == 672);
+      res = lfs2.umount ();
+      assert(res == 0);
+
+      // Rewrites reclaim the space and spread the erases.
+      f = posix::open ("/lfs/data", O_RDWR | O_CREAT | O_TRUNC);
+      assert(f != nullptr);
+      for (int i = 0; i < 40; ++i)
+        {
+          memset (buff, i, 512);
+          assert(f->lseek (0, SEEK_SET) == 0);
+          assert(f->write (buff, 500) == 500);
+          assert(static_cast<posix::file*> (f)->fsync () == 0);
+        }
+      uint8_t b0;
+      assert(f->lseek (499, SEEK_SET) == 499);
+      assert(f->read (&b0, 1) == 1 && b0 == 39);
+      assert(static_cast<posix::file*> (f)->ftruncate (100) == 0);
+      assert(static_cast<posix::file*> (f)->ftruncate (400) == 0);
+      assert(f->lseek (99, SEEK_SET) == 99);
+      assert(f->read (&b0, 1) == 1 && b0 == 39);
+      assert(f->read (&b0, 1) == 1 && b0 == 0);
+      f->close ();
+
+      // The segments with static data, like the root, are not moved.
+      uint32_t erases = 0;
+      std::size_t worn = 0;
+      for (std::size_t s = 0; s < lfs.impl ().segments (); ++s)
+        {
+          erases += lfs.impl ().erase_count (s);
+          worn += (lfs.impl ().erase_count (s) > 4) ? 1 : 0;
+        }
+      assert(erases > 16);
+      assert(worn >= 4);
+      assert(lfs.impl ().free_segments () >= 1);
+
+      struct statvfs sv;
+      res = lfs.statvfs (&sv);
+      assert(res == 0 && sv.f_blocks == 28 && sv.f_bfree < sv.f_blocks);
+
+      // Everything is found again after mount.
+      res = lfs.umount ();
+      assert(res == 0);
+      res = lfs.mount ("/lfs/");
+      assert(res == 0);
+      assert(posix::stat ("/lfs/log.txt", &st) == 0 && st.st_size == 672);
+      f = posix::open ("/lfs/data", O_RDONLY);
+      assert(f != nullptr);
+      assert(f->read (buff, 512) == 400);
+      assert(buff[0] == 39 && buff[99] == 39 && buff[100] == 0
+          && buff[399] == 0);
+      f->close ();
+
+      res = lfs.umount ();
+      assert(res == 0);
+
+      // Formatting again forgets everything, even without erase.
+      res = lfs.mkfs (4);
+      assert(res == 0);
+      res = lfs.mount ("/lfs/");
+      assert(res == 0);
+      assert(posix::stat ("/lfs/log.txt", &st) == -1 && errno == ENOENT);
+      assert(lfs.impl ().free_segments () >= 1);
+      res = lfs.umount ();
+      assert(res == 0);
+
+      res = lfd.close ();
+      assert(res >= 0);
+
+      assert(posix::file_descriptors_manager::used () == used);
+    }
+
+  printf ("\n%s - ROM file system - C++ API.\n", test_name);
+    {
+      std::size_t used = posix::file_descriptors_manager::used ();
+
+      res = romd.open ();
+      assert(res >= 0);
+
+      // A damaged index is not mounted.
+      rom_image[0x98] ^= 0x20;
+      assert(roms.mount ("/rom/") == -1 && errno == EIO);
+      rom_image[0x98] ^= 0x20;
+
+      res = roms.mount ("/rom/");
+      assert(res == 0);
+      assert(roms.impl ().image () == rom_image);
+
+      posix::io* f = posix::open ("/rom/index.html", O_RDONLY);
+      assert(f != nullptr);
+      char rbuf[32];
+      assert(f->read (rbuf, sizeof(rbuf)) == 19);
+      assert(memcmp (rbuf, "<html>hello</html>\n", 19) == 0);
+      assert(f->read (rbuf, sizeof(rbuf)) == 0);
+      assert(f->write ("x", 1) == -1 && errno == EBADF);
+
+      // Zero copy, in the image.
+      const char* p =
+          static_cast<const char*> (static_cast<posix::file*> (f)->map (6,
+                                                                        5));
+      assert(p == reinterpret_cast<const char*> (rom_image) + 0xC0 + 6);
+      assert(memcmp (p, "hello", 5) == 0);
+      assert(static_cast<posix::file*> (f)->map (16, 8) == nullptr
+          && errno == EINVAL);
+      f->close ();
+
+      struct stat st;
+      assert(posix::stat ("/rom/css/site.css", &st) == 0
+          && st.st_size == 21 && S_ISREG(st.st_mode));
+      assert(posix::stat ("/rom/img", &st) == 0 && S_ISDIR(st.st_mode));
+      assert(posix::stat ("/rom/nope", &st) == -1 && errno == ENOENT);
+      assert(posix::stat ("/rom/index.html/x", &st) == -1
+          && errno == ENOTDIR);
+
+      f = posix::open ("/rom/css/site.css", O_RDONLY);
+      assert(f != nullptr);
+      assert(f->lseek (7, SEEK_SET) == 7);
+      assert(f->read (rbuf, 5) == 5 && memcmp (rbuf, "color", 5) == 0);
+      f->close ();
+
+      // Sorted by name.
+      posix::directory* dir = posix::opendir ("/rom/");
+      assert(dir != nullptr);
+      assert(strcmp (dir->read ()->d_name, "css") == 0);
+      assert(strcmp (dir->read ()->d_name, "img") == 0);
+      assert(strcmp (dir->read ()->d_name, "index.html") == 0);
+      assert(dir->read () == nullptr);
+      dir->close ();
+      dir = posix::opendir ("/rom/img");
+      assert(dir != nullptr && dir->read () == nullptr);
+      dir->close ();
+
+      // Several at once.
+      struct dirent ents[2];
+      dir = posix::opendir ("/rom/");
+      assert(dir != nullptr);
+      assert(dir->read_n (ents, 2) == 2);
+      assert(strcmp (ents[0].d_name, "css") == 0);
+      assert(strcmp (ents[1].d_name, "img") == 0);
+      assert(dir->read_n (ents, 2) == 1);
+      assert(strcmp (ents[0].d_name, "index.html") == 0);
+      assert(dir->read_n (ents, 2) == 0);
+      dir->rewind ();
+      assert(dir->read_n (ents, 0) == 0);
+      assert(dir->read_n (nullptr, 2) == -1 && errno == EFAULT);
+      assert(dir->read_n (ents, 1) == 1);
+      assert(strcmp (ents[0].d_name, "css") == 0);
+      dir->close ();
+
+      // Nothing can be changed.
+      assert(posix::open ("/rom/index.html", O_RDWR) == nullptr
+          && errno == EROFS);
+      assert(posix::open ("/rom/new", O_WRONLY | O_CREAT) == nullptr
+          && errno == EROFS);
+      assert(posix::open ("/rom/new", O_RDONLY) == nullptr
+          && errno == ENOENT);
+      assert(posix::open ("/rom/css", O_RDONLY) == nullptr
+          && errno == EISDIR);
+      assert(posix::mkdir ("/rom/d", 0777) == -1 && errno == EROFS);
+      assert(posix::unlink ("/rom/index.html") == -1 && errno == EROFS);
+
+      struct statvfs sv;
+      res = roms.statvfs (&sv);
+      assert(res == 0 && (sv.f_flag & ST_RDONLY) != 0 && sv.f_bfree == 0
+          && sv.f_files == 5);
+
+      res = roms.umount ();
+      assert(res == 0);
+      assert(roms.mkfs (0) == -1 && errno == ENOSYS);
+      res = romd.close ();
+      assert(res >= 0);
+
+      assert(posix::file_descriptors_manager::used () == used);
+    }
+
+  printf ("\n%s - Flusher - C++ API.\n", test_name);
+    {
+      std::size_t used = posix::file_descriptors_manager::used ();
+
+      res = lfd.open ();
+      assert(res >= 0);
+      res = lfs.mkfs (4);
+      assert(res == 0);
+      res = lfs.mount ("/lfs/");
+      assert(res == 0);
+
+      posix::device* fl = static_cast<posix::device*> (posix::open (
+          "/dev/flusher", O_RDWR));
+      assert(fl != nullptr);
+
+      std::size_t val;
+      assert(fl->ioctl (FLSGETEXPIRE, &val) == 0
+          && val == OS_INTEGER_POSIX_IO_FLUSHER_EXPIRE_MS);
+      assert(fl->ioctl (FLSSETPERIOD, static_cast<std::size_t> (0)) == -1
+          && errno == EINVAL);
+      assert(fl->ioctl (FLSSETPRIO,
+                        static_cast<int> (rtos::thread::priority::isr)) == -1
+          && errno == EINVAL);
+      res = fl->ioctl (FLSSETPRIO,
+                       static_cast<int> (rtos::thread::priority::normal));
+      assert(res == 0);
+      rtos::thread::priority_t prio;
+      assert(fl->ioctl (FLSGETPRIO, &prio) == 0
+          && prio == rtos::thread::priority::normal);
+
+      // By age.
+      assert(fl->ioctl (FLSSETDIRTY, static_cast<std::size_t> (0)) == 0);
+      assert(fl->ioctl (FLSSETEXPIRE, static_cast<std::size_t> (10)) == 0);
+      assert(fl->ioctl (FLSSETPERIOD, static_cast<std::size_t> (5)) == 0);
+      assert(fl->ioctl (FLSGETPERIOD, &val) == 0 && val == 5);
+
+      posix::io* f = posix::open ("/lfs/aged", O_WRONLY | O_CREAT);
+      assert(f != nullptr);
+      memset (buff, 0x11, 100);
+      assert(f->write (buff, 100) == 100);
+      assert(lfs.is_dirty () && lfs.dirty_bytes () == 100);
+      rtos::sysclock.sleep_for (50);
+      assert(!lfs.is_dirty ());
+      assert(flush.impl ().write_backs () >= 1);
+
+      // Written while the file is still open.
+      struct stat st;
+      res = lfs2.mount ("/lfs2/");
+      assert(res == 0);
+      assert(posix::stat ("/lfs2/aged", &st) == 0 && st.st_size == 100);
+      res = lfs2.umount ();
+      assert(res == 0);
+
+      // By pressure, long before the expire time.
+      assert(fl->ioctl (FLSSETDIRTY, static_cast<std::size_t> (256)) == 0);
+      assert(fl->ioctl (FLSSETEXPIRE, static_cast<std::size_t> (60000))
+          == 0);
+      assert(fl->ioctl (FLSSETPERIOD, static_cast<std::size_t> (60000))
+          == 0);
+      rtos::sysclock.sleep_for (5);
+
+      std::size_t write_backs = flush.impl ().write_backs ();
+      assert(f->write (buff, 100) == 100);
+      rtos::sysclock.sleep_for (20);
+      assert(lfs.is_dirty ());
+      assert(flush.impl ().write_backs () == write_backs);
+      assert(f->write (buff, 200) == 200);
+      rtos::sysclock.sleep_for (20);
+      assert(!lfs.is_dirty ());
+      assert(flush.impl ().write_backs () == write_backs + 1);
+
+      res = f->close ();
+      assert(res == 0);
+
+      // The thread is stopped.
+      res = fl->close ();
+      assert(res == 0);
+      f = posix::open ("/lfs/aged", O_WRONLY | O_APPEND);
+      assert(f != nullptr);
+      assert(f->write (buff, 300) == 300);
+      rtos::sysclock.sleep_for (20);
+      assert(lfs.is_dirty ());
+      f->close ();
+      posix::sync ();
+      assert(!lfs.is_dirty ());
+
+      res = lfs.umount ();
+      assert(res == 0);
+      res = lfd.close ();
+      assert(res >= 0);
+
+      assert(posix::file_descriptors_manager::used () == used);
+    }
+
+  printf ("\n%s - Packet buffers - C++ API.\n", test_name);
+
+    {
+      // A packet longer than a segment is a chain.
+      posix::pbuf* p = pbufs.alloc (150);
+      assert(p != nullptr);
+      assert(p->segments () == 3);
+      assert(p->length () == 64);
+      assert(p->total_length () == 150);
+      assert(pbufs.free_segments () == 13);
+
+      char out[150];
+      for (std::size_t i = 0; i < sizeof(out); ++i)
+        {
+          out[i] = static_cast<char> (i);
+        }
+      assert(p->copy_in (out, sizeof(out)) == sizeof(out));
+
+      char in[150];
+      assert(p->copy_out (in, sizeof(in)) == sizeof(in));
+      assert(memcmp (in, out, sizeof(in)) == 0);
+      assert(p->copy_out (in, 10, 140) == 10);
+      assert(in[0] == out[140]);
+
+      // The extra reference keeps the chain.
+      p->ref ();
+      assert(posix::pbuf::free (p) == 0);
+      assert(posix::pbuf::free (p) == 3);
+      assert(pbufs.free_segments () == 16);
+
+      // All or nothing.
+      assert(pbufs.alloc (17 * 64) == nullptr);
+      assert(pbufs.free_segments () == 16);
+
+      // Zero copy through the interface rings.
+      p = pbufs.alloc (100);
+      p->copy_in (out, 100);
+      assert(lo.output (p) == 0);
+      posix::pbuf* r = lo.try_receive ();
+      assert(r == p);
+      assert(r->copy_out (in, 100) == 100);
+      assert(memcmp (in, out, 100) == 0);
+      posix::pbuf::free (r);
+      assert(lo.try_receive () == nullptr);
+
+      // A full receive ring drops the packet.
+      std::size_t ring = posix::net_interface::ring_type::elements;
+      for (std::size_t i = 0; i <= ring; ++i)
+        {
+          posix::pbuf* q = pbufs.alloc (0);
+          assert(q != nullptr);
+          assert(lo.output (q) == 0);
+        }
+      assert(lo.rx_dropped () == 1);
+      while ((r = lo.try_receive ()) != nullptr)
+        {
+          posix::pbuf::free (r);
+        }
+      assert(pbufs.free_segments () == 16);
+    }
+
 #if defined(OS_IS_CROSS_BUILD) && !defined(OS_USE_SEMIHOSTING_SYSCALLS)
 
   printf ("\n%s - Block device - C API.\n", test_name);
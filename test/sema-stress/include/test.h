@@ -28,6 +28,8 @@
 #ifndef TEST_H_
 #define TEST_H_
 
+#include <cmsis-plus/rtos/os.h>
+
 class Hw_timer
 {
 public:
@@ -49,8 +51,18 @@ public:
 
 extern Hw_timer tmr;
 
+// From the command line.
+struct soak_config_t
+{
+  // 0 runs forever.
+  unsigned int iterations;
+  unsigned int load_threads;
+  // Of the thread waiting for the semaphore.
+  os::rtos::thread::priority_t priority;
+};
+
 int
-run_tests ();
+run_tests (unsigned int iteration, const soak_config_t& config);
 
 extern void
 (*tim_callback) (void);
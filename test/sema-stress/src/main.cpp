@@ -27,6 +27,8 @@
 
 #include <stm32f4xx_hal.h>
 
+#include <cstdlib>
+
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 
@@ -37,8 +39,24 @@ using namespace os;
 RNG_HandleTypeDef hrng;
 
 int
-os_main (int argc __attribute__((unused)), char* argv[] __attribute__((unused)))
+os_main (int argc, char* argv[])
 {
+  // sema-stress [iterations [load-threads [priority]]]
+  soak_config_t config
+    { 0, 1, rtos::thread::priority::normal };
+  if (argc > 1)
+    {
+      config.iterations = static_cast<unsigned int> (atoi (argv[1]));
+    }
+  if (argc > 2)
+    {
+      config.load_threads = static_cast<unsigned int> (atoi (argv[2]));
+    }
+  if (argc > 3)
+    {
+      config.priority = static_cast<rtos::thread::priority_t> (atoi (argv[3]));
+    }
+
   printf ("\nSemaphore stress test.\n");
 #if defined(__clang__)
   printf ("Built with clang " __VERSION__ ".\n");
@@ -57,21 +75,23 @@ os_main (int argc __attribute__((unused)), char* argv[] __attribute__((unused)))
   uint32_t seed;
 
   int status;
-  for (int i = 0;; ++i)
+  for (unsigned int i = 0; config.iterations == 0 || i < config.iterations;
+      ++i)
     {
       HAL_RNG_GenerateRandomNumber (&hrng, &seed);
 
-      printf ("\nIteration %d\n", i);
+      printf ("\nIteration %u\n", i);
       printf ("Seed %lu\n", seed);
 
       srand (seed);
 
-      status = run_tests ();
+      status = run_tests (i, config);
       if (status)
         {
           return status;
         }
     }
+  return 0;
 }
 
 Hw_timer tmr;
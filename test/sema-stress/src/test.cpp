@@ -30,6 +30,9 @@ using namespace os::rtos;
 static void
 sema (uint32_t divisor);
 
+static unsigned int
+to_micros (uint32_t cycles);
+
 void*
 sleep_stress (void* args);
 
@@ -45,15 +48,45 @@ sleep_stress (void* args __attribute__((unused)))
   return nullptr;
 }
 
+constexpr unsigned int max_load_threads = 8;
+
+// The results of the last run.
+static unsigned int last_events;
+static unsigned int last_events_per_s;
+static unsigned int last_late;
+static uint32_t last_latency;
+
+// The worst latency, since the start, and the values after the first
+// iteration, to check the drift.
+static uint32_t worst_latency;
+static std::size_t heap_first;
+static std::size_t stack_first;
+
 int
-run_tests ()
+run_tests (unsigned int iteration, const soak_config_t& config)
 {
+  if (iteration == 0)
+    {
+      printf ("soak,test,iteration,period_cy,rate_khz,events,events_per_s,"
+              "late_max,latency_max_us,latency_worst_us\n");
+    }
+
+  // The waiting thread; the load threads run below normal.
+  this_thread::thread ().priority (config.priority);
+
 #if 0
   sema (tmr.in_clk_hz ()/20);
 #else
 
-  thread low
-    { "low", sleep_stress, nullptr };
+  unsigned int nload =
+      config.load_threads < max_load_threads ?
+          config.load_threads : max_load_threads;
+  thread* load[max_load_threads];
+  for (unsigned int j = 0; j < nload; ++j)
+    {
+      load[j] = new thread
+        { "load", sleep_stress, nullptr };
+    }
 
   int i = 1;
   for (;; i *= 2)
@@ -66,6 +99,10 @@ run_tests ()
         }
 
       sema (period);
+      printf ("soak,sema,%u,%lu,%lu,%u,%u,%u,%u,%u\n", iteration, period,
+              tmr.in_clk_hz () / period / 1000, last_events,
+              last_events_per_s, last_late, to_micros (last_latency),
+              to_micros (worst_latency));
     }
 
   puts ("\n\nRandom");
@@ -79,11 +116,51 @@ run_tests ()
       uint64_t period = r * (to - from) / RAND_MAX + from;
 
       sema ((uint32_t) period);
+      printf ("soak,sema,%u,%lu,%lu,%u,%u,%u,%u,%u\n", iteration,
+              (uint32_t) period, tmr.in_clk_hz () / (uint32_t) period / 1000,
+              last_events, last_events_per_s, last_late,
+              to_micros (last_latency), to_micros (worst_latency));
+    }
+
+  std::size_t stack_free = this_thread::thread ().stack ().available ();
+  bool stack_ok = this_thread::thread ().stack ().check_bottom_magic ();
+  for (unsigned int j = 0; j < nload; ++j)
+    {
+      std::size_t available = load[j]->stack ().available ();
+      if (available < stack_free)
+        {
+          stack_free = available;
+        }
+      stack_ok = stack_ok && load[j]->stack ().check_bottom_magic ();
+
+      load[j]->interrupt ();
+      load[j]->join ();
+      delete load[j];
     }
 #endif
 
-  puts ("Done.");
-  return 0;
+  // The load threads were destroyed, the heap must be back where it
+  // was after the first iteration.
+  std::size_t heap = rtos::memory::get_default_resource ()->allocated_bytes ();
+  if (iteration == 0)
+    {
+      heap_first = heap;
+      stack_first = stack_free;
+    }
+
+  int status = (heap > heap_first || !stack_ok) ? 1 : 0;
+  printf ("soak-iteration,test,iteration,result,latency_worst_us,"
+          "heap_used_bytes,heap_drift_bytes,stack_free_min_bytes,"
+          "stack_drift_bytes\n");
+  printf ("soak-iteration,sema,%u,%s,%u,%u,%d,%u,%d\n", iteration,
+          status == 0 ? "pass" : "fail", to_micros (worst_latency),
+          static_cast<unsigned int> (heap),
+          static_cast<int> (heap - heap_first),
+          static_cast<unsigned int> (stack_free),
+          static_cast<int> (stack_first - stack_free));
+
+  puts (status == 0 ? "Done." : "Failed.");
+  return status;
 }
 
 constexpr std::size_t max_count = 1000;
@@ -92,6 +169,8 @@ uint32_t volatile buf[max_count + 10];
 uint32_t volatile cnt;
 uint32_t volatile delayed;
 uint32_t volatile max_delayed;
+// The high resolution clock at each post, in the interrupt.
+uint32_t volatile posted[max_count + 10];
 
 semaphore_counting sem { max_count, 0 };
 
@@ -99,6 +178,7 @@ static void
 sema_cb (void)
 {
   buf[cnt] = cnt;
+  posted[cnt] = static_cast<uint32_t> (hrclock.now ());
   ++cnt;
   delayed = 0;
   max_delayed = 0;
@@ -127,7 +207,8 @@ sema (uint32_t cycles)
 
   tim_callback = sema_cb;
 
-  printf ("%7lu cy %4lu kHz ", cycles, tmr.in_clk_hz () / cycles / 1000);
+  last_latency = 0;
+  clock::timestamp_t begin = hrclock.now ();
 
   tmr.start (cycles);
 
@@ -138,6 +219,13 @@ sema (uint32_t cycles)
       result_t res = sem.timed_wait (rtos::clock_systick::frequency_hz);
       assert(res == result::ok);
 
+      // From the post in the interrupt to the waiting thread.
+      uint32_t latency = static_cast<uint32_t> (hrclock.now ()) - posted[i];
+      if (latency > last_latency)
+        {
+          last_latency = latency;
+        }
+
       trace_putchar ('-');
       assert(buf[i] == i);
       delayed++;
@@ -152,14 +240,25 @@ sema (uint32_t cycles)
   ;
 #endif
 
+  clock::timestamp_t elapsed = hrclock.now () - begin;
+
   // systick_clock.sleep_for (10);
   max_delayed--;
-  if (max_delayed > 0)
-    {
-      printf ("%4lu late \n", max_delayed);
-    }
-  else
+
+  last_events = max_count;
+  last_events_per_s = static_cast<unsigned int> (
+      static_cast<uint64_t> (max_count) * hrclock.input_clock_frequency_hz ()
+          / (elapsed != 0 ? elapsed : 1));
+  last_late = max_delayed;
+  if (last_latency > worst_latency)
     {
-      puts ("");
+      worst_latency = last_latency;
     }
 }
+
+unsigned int
+to_micros (uint32_t cycles)
+{
+  return static_cast<unsigned int> (static_cast<uint64_t> (cycles) * 1000000
+      / hrclock.input_clock_frequency_hz ());
+}
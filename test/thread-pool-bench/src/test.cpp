@@ -0,0 +1,219 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstdio>
+
+#include <test.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+static constexpr std::size_t workers = 4;
+static constexpr std::size_t depth = 16;
+
+static volatile unsigned int done_count;
+
+static void
+job_func (void* args);
+
+static void
+job_func (void* args __attribute__((unused)))
+{
+  // Keep the job short, to measure the dispatch overhead.
+  ++done_count;
+}
+
+// ----------------------------------------------------------------------------
+
+// The ad-hoc pattern: a message queue of jobs and
+// a set of threads receiving from it.
+
+typedef struct
+{
+  thread_pool::func_t func;
+  thread_pool::func_args_t args;
+} adhoc_msg_t;
+
+static void*
+adhoc_worker (void* args);
+
+static void*
+adhoc_worker (void* args)
+{
+  message_queue* mq = static_cast<message_queue*> (args);
+
+  while (true)
+    {
+      adhoc_msg_t msg;
+      if (mq->receive (&msg, sizeof(msg)) != result::ok)
+        {
+          continue;
+        }
+      if (msg.func == nullptr)
+        {
+          break;
+        }
+
+      msg.func (msg.args);
+    }
+
+  return nullptr;
+}
+
+static clock::duration_t
+run_adhoc (unsigned int jobs)
+{
+  message_queue_inclusive<adhoc_msg_t, depth> mq
+    { "adhoc" };
+
+  thread* threads[workers];
+  for (std::size_t i = 0; i < workers; ++i)
+    {
+      threads[i] = new thread
+        { "adhoc", adhoc_worker, &mq };
+    }
+
+  done_count = 0;
+  clock::timestamp_t begin = hrclock.now ();
+
+  for (unsigned int i = 0; i < jobs; ++i)
+    {
+      adhoc_msg_t msg
+        { job_func, nullptr };
+      mq.send (&msg, sizeof(msg));
+    }
+
+  while (done_count < jobs)
+    {
+      this_thread::yield ();
+    }
+
+  clock::timestamp_t end = hrclock.now ();
+
+  for (std::size_t i = 0; i < workers; ++i)
+    {
+      adhoc_msg_t msg
+        { nullptr, nullptr };
+      mq.send (&msg, sizeof(msg));
+    }
+  for (std::size_t i = 0; i < workers; ++i)
+    {
+      threads[i]->join ();
+      delete threads[i];
+    }
+
+  return static_cast<clock::duration_t> (end - begin);
+}
+
+// ----------------------------------------------------------------------------
+
+static clock::duration_t
+run_pool (unsigned int jobs)
+{
+  thread_pool_inclusive<workers, depth> pool
+    { "pool" };
+
+  done_count = 0;
+  clock::timestamp_t begin = hrclock.now ();
+
+  for (unsigned int i = 0; i < jobs; ++i)
+    {
+      pool.submit (job_func);
+    }
+  pool.wait_idle ();
+
+  clock::timestamp_t end = hrclock.now ();
+
+  assert(done_count == jobs);
+
+  return static_cast<clock::duration_t> (end - begin);
+}
+
+static clock::duration_t
+run_pool_batched (unsigned int jobs)
+{
+  thread_pool_inclusive<workers, depth> pool
+    { "pool-n" };
+
+  thread_pool::job batch[depth];
+  for (std::size_t i = 0; i < depth; ++i)
+    {
+      batch[i] =
+        { job_func, nullptr, nullptr };
+    }
+
+  done_count = 0;
+  clock::timestamp_t begin = hrclock.now ();
+
+  for (unsigned int i = 0; i < jobs; i += depth)
+    {
+      std::size_t n = ((jobs - i) < depth) ? (jobs - i) : depth;
+      pool.submit_n (batch, n);
+    }
+  pool.wait_idle ();
+
+  clock::timestamp_t end = hrclock.now ();
+
+  assert(done_count == jobs);
+
+  return static_cast<clock::duration_t> (end - begin);
+}
+
+// ----------------------------------------------------------------------------
+
+int
+run_tests (unsigned int jobs)
+{
+  printf ("%u jobs, %u workers, %u slots.\n", jobs,
+          static_cast<unsigned int> (workers),
+          static_cast<unsigned int> (depth));
+
+  clock::duration_t adhoc = run_adhoc (jobs);
+  printf ("message_queue + threads: %u cycles, %u cycles/job\n",
+          static_cast<unsigned int> (adhoc),
+          static_cast<unsigned int> (adhoc / jobs));
+
+  clock::duration_t pool = run_pool (jobs);
+  printf ("thread_pool::submit():   %u cycles, %u cycles/job\n",
+          static_cast<unsigned int> (pool),
+          static_cast<unsigned int> (pool / jobs));
+
+  clock::duration_t batched = run_pool_batched (jobs);
+  printf ("thread_pool::submit_n(): %u cycles, %u cycles/job\n",
+          static_cast<unsigned int> (batched),
+          static_cast<unsigned int> (batched / jobs));
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------